@@ -33,15 +33,19 @@
 #include "Main.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Audio/MIDIPlayer.h"
+#include "Batch.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/ColourConfiguration.h"
 #include "General/Console.h"
 #include "General/Executables.h"
+#include "General/Jobs.h"
 #include "General/KeyBind.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
 #include "General/SAction.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
@@ -53,7 +57,6 @@
 #include "SLADEWxApp.h"
 #include "Scripting/Lua.h"
 #include "Scripting/ScriptManager.h"
-#include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
 #include "UI/Dialogs/SetupWizard/SetupWizardDialog.h"
 #include "UI/SBrush.h"
@@ -62,6 +65,7 @@
 #include "Utility/Tokenizer.h"
 #include "thirdparty/dumb/dumb.h"
 #include <filesystem>
+#include <future>
 
 using namespace slade;
 
@@ -323,8 +327,14 @@ vector<string> processCommandLine(vector<string>& args)
 	vector<string> to_open;
 
 	// Process command line args (except the first as it is normally the executable name)
-	for (auto& arg : args)
+	for (unsigned a = 0; a < args.size(); a++)
 	{
+		auto& arg = args[a];
+
+		// Batch mode parameters (see Batch.cpp)
+		if (batch::processArg(args, a))
+			continue;
+
 		// -nosplash: Disable splash window
 		if (strutil::equalCI(arg, "-nosplash"))
 			ui::enableSplash(false);
@@ -336,17 +346,117 @@ vector<string> processCommandLine(vector<string>& args)
 			log::info("Debugging stuff enabled");
 		}
 
-		// Other (no dash), open as archive
+		// Other (no dash), open as archive (or process, in batch mode)
 		else if (!strutil::startsWith(arg, '-'))
-			to_open.push_back(arg);
+		{
+			if (batch::isEnabled())
+				batch::addArchive(arg);
+			else
+				to_open.push_back(arg);
+		}
 
 		// Unknown parameter
 		else
 			log::warning("Unknown command line parameter: \"{}\"", arg);
 	}
 
+	// No UI in batch mode
+	if (batch::isEnabled())
+		ui::enableSplash(false);
+
 	return to_open;
 }
+
+// -----------------------------------------------------------------------------
+// Runs initialisation phase [name] ([func]) and logs the time it took
+// -----------------------------------------------------------------------------
+void initPhase(const char* name, const std::function<void()>& func)
+{
+	wxStopWatch phase_timer;
+	func();
+	log::info(2, "Init phase \"{}\" took {}ms", name, phase_timer.Time());
+}
+
+// -----------------------------------------------------------------------------
+// Runs initialisation phase [name] ([func]) on a worker thread.
+// Returns a future to wait on for the phase to complete
+// -----------------------------------------------------------------------------
+std::future<void> initPhaseAsync(const char* name, const std::function<void()>& func)
+{
+	auto task   = std::make_shared<std::packaged_task<void()>>([name, func]() { initPhase(name, func); });
+	auto result = task->get_future();
+	threadpool::enqueue([task]() { (*task)(); });
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Shuts down and cleans everything up.
+// If [save_config] is true, saves all configuration related files
+// -----------------------------------------------------------------------------
+void shutdown(bool save_config)
+{
+	exiting = true;
+
+	if (save_config)
+	{
+		// Save configuration
+		saveConfigFile();
+
+		// Save text style configuration
+		StyleSet::saveCurrent();
+
+		// Save colour configuration
+		MemChunk ccfg;
+		colourconfig::writeConfiguration(ccfg);
+		ccfg.exportFile(app::path("colours.cfg", app::Dir::User));
+
+		// Save game exes
+		wxFile f;
+		f.Open(app::path("executables.cfg", app::Dir::User), wxFile::write);
+		f.Write(executables::writeExecutables());
+		f.Close();
+
+		// Save custom special presets
+		game::saveCustomSpecialPresets();
+
+#ifdef USE_LUA
+		// Save custom scripts
+		scriptmanager::saveUserScripts();
+#endif
+	}
+
+	// Cancel any archives still being opened and close all open archives
+	archive_manager.cancelAsyncOpens();
+	archive_manager.closeAll();
+
+	// Clean up (cancel queued jobs first so the thread pool doesn't run them)
+	jobs::cancelAll();
+	threadpool::shutdown();
+	drawing::cleanupFonts();
+	gl::Texture::clearAll();
+
+	// Clear temp folder
+	std::error_code error;
+	for (auto& item : std::filesystem::directory_iterator{ app::path("", app::Dir::Temp) })
+	{
+		if (!item.is_regular_file())
+			continue;
+
+		if (!std::filesystem::remove(item, error))
+			log::warning("Could not clean up temporary file \"{}\": {}", item.path().string(), error.message());
+	}
+
+#ifdef USE_LUA
+	// Close lua
+	lua::close();
+#endif
+
+	// Close DUMB
+	dumb_exit();
+
+	// Finish writing the log file
+	log::close();
+}
 } // namespace slade::app
 
 // -----------------------------------------------------------------------------
@@ -443,17 +553,25 @@ bool app::init(vector<string>& args, double ui_scale)
 
 	// Load configuration file
 	log::info("Loading configuration");
-	readConfigFile();
+	initPhase("Configuration", readConfigFile);
 
 	// Init entry types
-	EntryDataFormat::initBuiltinFormats();
-	EntryType::initTypes();
+	initPhase("Entry types", [] {
+		EntryDataFormat::initBuiltinFormats();
+		EntryType::initTypes();
+	});
 
 	// Check that SLADE.pk3 can be found
 	log::info("Loading resources");
-	archive_manager.init();
+	initPhase("Program resource", [] { archive_manager.init(); });
 	if (!archive_manager.resArchiveOK())
 	{
+		if (batch::isEnabled())
+		{
+			log::error("Unable to find slade.pk3, make sure it exists in the same directory as the SLADE executable");
+			return false;
+		}
+
 		wxMessageBox(
 			"Unable to find slade.pk3, make sure it exists in the same directory as the "
 			"SLADE executable",
@@ -462,13 +580,23 @@ bool app::init(vector<string>& args, double ui_scale)
 		return false;
 	}
 
+	// Load configs that only depend on slade.pk3 in the background. Their entry
+	// data is loaded here first (in case the archive was opened lazily), so the
+	// worker threads only read it
+	for (auto path : { "config/nodebuilders.cfg", "config/executables.cfg" })
+		if (auto entry = archive_manager.programResourceArchive()->entryAtPath(path))
+			entry->data();
+	vector<std::future<void>> config_phases;
+	config_phases.push_back(initPhaseAsync("Node builders", nodebuilders::init));
+	config_phases.push_back(initPhaseAsync("Executables", executables::init));
+
 	// Init SActions
 	SAction::setBaseWxId(26000);
-	SAction::initActions();
+	initPhase("Actions", SAction::initActions);
 
 #ifdef USE_LUA
 	// Init lua
-	lua::init();
+	initPhase("Lua", lua::init);
 #endif
 
 	// Init UI
@@ -478,63 +606,77 @@ bool app::init(vector<string>& args, double ui_scale)
 	ui::showSplash("Starting up...");
 
 	// Init palettes
-	if (!palette_manager.init())
+	bool palettes_ok = false;
+	initPhase("Palettes", [&palettes_ok] { palettes_ok = palette_manager.init(); });
+	if (!palettes_ok)
 	{
 		log::error("Failed to initialise palettes");
+		for (auto& phase : config_phases)
+			phase.wait();
 		return false;
 	}
 
 	// Init SImage formats
-	SIFormat::initFormats();
+	initPhase("Image formats", SIFormat::initFormats);
+
+	// Batch mode only needs what is used to open and process archives, the
+	// editor UI (and everything only it uses) isn't initialised
+	if (batch::isEnabled())
+	{
+		initPhase("Entry type definitions", EntryType::loadEntryTypes);
+		for (auto& phase : config_phases)
+			phase.get();
+		initPhase("Base resource", [] { archive_manager.initBaseResource(); });
+		initPhase("Game configurations", game::init);
+
+		init_ok = true;
+		log::info("SLADE Initialisation OK (batch mode, {}ms)", timer.Time());
+		return true;
+	}
 
 	// Init brushes
-	SBrush::initBrushes();
+	initPhase("Brushes", SBrush::initBrushes);
 
-	// Load program icons
-	log::info("Loading icons");
-	icons::loadIcons();
+	// Find program icon sets (icons are loaded on first use)
+	initPhase("Icons", icons::loadIcons);
 
 	// Load program fonts
-	drawing::initFonts();
+	initPhase("Fonts", drawing::initFonts);
 
 	// Load entry types
 	log::info("Loading entry types");
-	EntryType::loadEntryTypes();
-
-	// Load text languages
-	log::info("Loading text languages");
-	TextLanguage::loadLanguages();
-
-	// Init text stylesets
-	log::info("Loading text style sets");
-	StyleSet::loadResourceStyles();
-	StyleSet::loadCustomStyles();
+	initPhase("Entry type definitions", EntryType::loadEntryTypes);
 
 	// Init colour configuration
 	log::info("Loading colour configuration");
-	colourconfig::init();
-
-	// Init nodebuilders
-	nodebuilders::init();
+	initPhase("Colour configuration", colourconfig::init);
 
-	// Init game executables
-	executables::init();
+	// Wait for background config loading to finish, the main editor uses them
+	{
+		wxStopWatch wait_timer;
+		for (auto& phase : config_phases)
+			phase.get();
+		log::info(2, "Waited {}ms for background init phases", wait_timer.Time());
+	}
 
 	// Init main editor
-	maineditor::init();
+	initPhase("Main editor", [] { maineditor::init(); });
+
+	// Init MIDI player (its soundfont is loaded in the background)
+	audio::midiPlayer();
 
 	// Init base resource
 	log::info("Loading base resource");
-	archive_manager.initBaseResource();
+	initPhase("Base resource", [] { archive_manager.initBaseResource(); });
 	log::info("Base resource loaded");
 
 	// Init game configuration
 	log::info("Loading game configurations");
-	game::init();
+	initPhase("Game configurations", game::init);
 
 #ifdef USE_LUA
 	// Init script manager
-	scriptmanager::init();
+	initPhase("Script manager", scriptmanager::init);
 #endif
 
 	// Show the main window
@@ -550,7 +692,7 @@ bool app::init(vector<string>& args, double ui_scale)
 	ui::hideSplash();
 
 	init_ok = true;
-	log::info("SLADE Initialisation OK");
+	log::info("SLADE Initialisation OK ({}ms)", timer.Time());
 
 	// Show Setup Wizard if needed
 	if (!setup_wizard_run)
@@ -635,66 +777,23 @@ void app::saveConfigFile()
 // -----------------------------------------------------------------------------
 void app::exit(bool save_config)
 {
-	exiting = true;
-
-	if (save_config)
-	{
-		// Save configuration
-		saveConfigFile();
-
-		// Save text style configuration
-		StyleSet::saveCurrent();
-
-		// Save colour configuration
-		MemChunk ccfg;
-		colourconfig::writeConfiguration(ccfg);
-		ccfg.exportFile(app::path("colours.cfg", app::Dir::User));
-
-		// Save game exes
-		wxFile f;
-		f.Open(app::path("executables.cfg", app::Dir::User), wxFile::write);
-		f.Write(executables::writeExecutables());
-		f.Close();
-
-		// Save custom special presets
-		game::saveCustomSpecialPresets();
-
-#ifdef USE_LUA
-		// Save custom scripts
-		scriptmanager::saveUserScripts();
-#endif
-	}
-
-	// Close all open archives
-	archive_manager.closeAll();
-
-	// Clean up
-	drawing::cleanupFonts();
-	gl::Texture::clearAll();
-
-	// Clear temp folder
-	std::error_code error;
-	for (auto& item : std::filesystem::directory_iterator{ app::path("", app::Dir::Temp) })
-	{
-		if (!item.is_regular_file())
-			continue;
-
-		if (!std::filesystem::remove(item, error))
-			log::warning("Could not clean up temporary file \"{}\": {}", item.path().string(), error.message());
-	}
-
-#ifdef USE_LUA
-	// Close lua
-	lua::close();
-#endif
-
-	// Close DUMB
-	dumb_exit();
+	shutdown(save_config);
 
 	// Exit wx Application
 	wxGetApp().Exit();
 }
 
+// -----------------------------------------------------------------------------
+// Runs batch mode (on all archives given on the command line) then shuts down
+// without saving any configuration. Returns the process exit status
+// -----------------------------------------------------------------------------
+int app::runBatch()
+{
+	auto status = batch::run();
+	shutdown(false);
+	return status;
+}
+
 
 // ----------------------------------------------------------------------------
 // Returns the current version of SLADE
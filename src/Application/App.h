@@ -24,6 +24,7 @@ namespace app
 	bool init(vector<string>& args, double ui_scale = 1.);
 	void saveConfigFile();
 	void exit(bool save_config);
+	int  runBatch();
 
 	// Version
 	struct Version
@@ -0,0 +1,433 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Batch.cpp
+// Description: Headless batch mode, for running built-in operations and Lua
+//              scripts on archives from the command line (eg. in build
+//              pipelines) without the editor UI
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Batch.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "General/Benchmark.h"
+#include "MainEditor/ArchiveOperations.h"
+#include "MainEditor/EntryOperations.h"
+#include "Scripting/Lua.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A built-in batch operation
+struct Operation
+{
+	string                                               name;
+	string                                               params; // Parameter names (for usage)
+	unsigned                                             n_params;
+	string                                               description;
+	std::function<bool(Archive&, const vector<string>&)> run;
+};
+
+// An operation to run on each archive, with its parameters
+struct QueuedOperation
+{
+	const Operation* operation;
+	vector<string>   params;
+};
+
+bool                    batch_enabled  = false;
+bool                    invalid_params = false;
+string                  script_file;
+bool                    save_archives = false;
+vector<QueuedOperation> queued_operations;
+vector<string>          archive_paths;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns all entries in [archive] of type [type_id], or any type if empty
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> allEntries(Archive& archive, string_view type_id = {})
+{
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+
+	vector<ArchiveEntry*> matching;
+	for (auto entry : entries)
+	{
+		if (entry->type() == EntryType::folderType())
+			continue;
+
+		// Loading the data also detects the entry type if it was deferred
+		entry->data();
+		if (type_id.empty() || entry->type()->id() == type_id)
+			matching.push_back(entry);
+	}
+
+	return matching;
+}
+
+// -----------------------------------------------------------------------------
+// Parses integer parameter [param] into [value], logging an error if it isn't
+// an integer
+// -----------------------------------------------------------------------------
+bool intParam(const string& param, int& value)
+{
+	if (strutil::toInt(param, value))
+		return true;
+
+	log::error("Invalid number \"{}\"", param);
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the list of built-in batch operations. These must not show any UI
+// -----------------------------------------------------------------------------
+const vector<Operation>& operations()
+{
+	static vector<Operation> ops = {
+		{ "replace-things",
+		  "OLD,NEW",
+		  2,
+		  "Replace thing type OLD with NEW in all maps",
+		  [](Archive& archive, const vector<string>& params) {
+			  int old_type, new_type;
+			  if (!intParam(params[0], old_type) || !intParam(params[1], new_type))
+				  return false;
+			  archiveoperations::replaceThings(&archive, old_type, new_type);
+			  return true;
+		  } },
+
+		{ "replace-specials",
+		  "OLD,NEW",
+		  2,
+		  "Replace line/thing special OLD with NEW in all maps",
+		  [](Archive& archive, const vector<string>& params) {
+			  int old_special, new_special;
+			  if (!intParam(params[0], old_special) || !intParam(params[1], new_special))
+				  return false;
+			  archiveoperations::replaceSpecials(&archive, old_special, new_special);
+			  return true;
+		  } },
+
+		{ "replace-textures",
+		  "OLD,NEW",
+		  2,
+		  "Replace texture/flat OLD with NEW in all maps",
+		  [](Archive& archive, const vector<string>& params) {
+			  archiveoperations::replaceTextures(&archive, params[0], params[1], true, true, true, true, true);
+			  return true;
+		  } },
+
+		{ "find-text",
+		  "TEXT",
+		  1,
+		  "List all lines in text entries containing TEXT",
+		  [](Archive& archive, const vector<string>& params) {
+			  for (const auto& match : archiveoperations::findText(&archive, params[0]))
+				  fmt::print("{}:{}: {}\n", match.entry->path(true), match.line, match.line_text);
+			  return true;
+		  } },
+
+		{ "convert-textures",
+		  "",
+		  0,
+		  "Convert TEXTUREx/PNAMES texture definitions to a ZDoom TEXTURES entry",
+		  [](Archive& archive, const vector<string>&) {
+			  auto entries = allEntries(archive, "texturex");
+			  return entries.empty() || entryoperations::convertTextures(entries);
+		  } },
+
+		{ "optimize-png",
+		  "",
+		  0,
+		  "Optimize all PNG entries with the configured PNG tools",
+		  [](Archive& archive, const vector<string>&) {
+			  auto report = entryoperations::optimizePNG(allEntries(archive, "png"));
+			  report.logSummary("optimize-png");
+			  return report.nFailed() == 0;
+		  } },
+
+		{ "export-png",
+		  "DIR",
+		  1,
+		  "Export all graphics entries to DIR as PNG",
+		  [](Archive& archive, const vector<string>& params) {
+			  vector<ArchiveEntry*> entries;
+			  vector<string>        filenames;
+			  for (auto entry : allEntries(archive))
+				  if (entry->type()->editor() == "gfx")
+				  {
+					  entries.push_back(entry);
+					  filenames.push_back(fmt::format("{}/{}.png", params[0], entry->nameNoExt()));
+				  }
+
+			  auto report = entryoperations::exportAsPNG(entries, filenames);
+			  report.logSummary("export-png");
+			  return report.nFailed() == 0;
+		  } },
+
+		{ "benchmark",
+		  "FILE",
+		  1,
+		  "Run benchmarks over the contents of each archive, writing the results to FILE as JSON",
+		  [](Archive& archive, const vector<string>& params) {
+			  // Results for all archives processed so far are written each time
+			  static vector<benchmark::Report> reports;
+			  reports.push_back(benchmark::run(archive));
+			  benchmark::logReport(reports.back());
+			  if (!benchmark::writeJSON(params[0], reports))
+			  {
+				  log::error("Unable to write benchmark results to \"{}\"", params[0]);
+				  return false;
+			  }
+			  return true;
+		  } },
+	};
+
+	return ops;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the operation described by [spec] (name[:param1,param2,...]) to the
+// queue of operations to run on each archive
+// -----------------------------------------------------------------------------
+bool queueOperation(string_view spec)
+{
+	auto colon = spec.find(':');
+	auto name  = spec.substr(0, colon);
+
+	vector<string> params;
+	if (colon != string_view::npos)
+		params = strutil::split(spec.substr(colon + 1), ',');
+
+	for (const auto& op : operations())
+	{
+		if (!strutil::equalCI(op.name, name))
+			continue;
+
+		if (params.size() != op.n_params)
+		{
+			log::error("Batch operation \"{}\" expects parameters: {}", op.name, op.params);
+			return false;
+		}
+
+		queued_operations.push_back({ &op, params });
+		return true;
+	}
+
+	log::error("Unknown batch operation \"{}\"", name);
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Opens the archive at [path], runs all queued operations and the script (if
+// any) on it, then saves (if enabled and anything changed) and closes it.
+// Returns false if anything failed
+// -----------------------------------------------------------------------------
+bool processArchive(const string& path, const string& script)
+{
+	auto archive = app::archiveManager().openArchive(path, true, true);
+	if (!archive)
+	{
+		log::error("Unable to open archive \"{}\": {}", path, global::error);
+		return false;
+	}
+
+	bool ok = true;
+	for (const auto& queued : queued_operations)
+	{
+		log::info("Running {} on \"{}\"", queued.operation->name, path);
+		if (!queued.operation->run(*archive, queued.params))
+		{
+			log::error("Batch operation {} failed on \"{}\"", queued.operation->name, path);
+			ok = false;
+		}
+	}
+
+#ifdef USE_LUA
+	if (!script.empty())
+	{
+		log::info("Running script \"{}\" on \"{}\"", script_file, path);
+		if (!lua::runArchiveScript(script, archive.get()))
+			ok = false;
+	}
+#endif
+
+	if (ok && save_archives && archive->isModified() && !archive->save())
+	{
+		log::error("Unable to save archive \"{}\": {}", path, global::error);
+		ok = false;
+	}
+
+	app::archiveManager().closeArchive(archive.get());
+
+	return ok;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// batch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if batch mode was requested in command line [args]
+// -----------------------------------------------------------------------------
+bool batch::requested(const vector<string>& args)
+{
+	return std::any_of(args.begin(), args.end(), [](const string& arg) { return strutil::equalCI(arg, "-batch"); });
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if batch mode is enabled
+// -----------------------------------------------------------------------------
+bool batch::isEnabled()
+{
+	return batch_enabled;
+}
+
+// -----------------------------------------------------------------------------
+// Processes the batch mode command line option at [index] in [args], advancing
+// [index] past any values it takes. Returns false if it isn't a batch option
+// -----------------------------------------------------------------------------
+bool batch::processArg(const vector<string>& args, unsigned& index)
+{
+	const auto& arg       = args[index];
+	auto        has_value = index + 1 < args.size();
+
+	// -batch: Enable batch mode
+	if (strutil::equalCI(arg, "-batch"))
+		batch_enabled = true;
+
+	// -save: Save archives after processing
+	else if (strutil::equalCI(arg, "-save"))
+		save_archives = true;
+
+	// -script <file>: Lua archive script to run
+	else if (strutil::equalCI(arg, "-script") && has_value)
+		script_file = args[++index];
+
+	// -op <operation>: Built-in operation to run
+	else if (strutil::equalCI(arg, "-op") && has_value)
+	{
+		if (!queueOperation(args[++index]))
+			invalid_params = true;
+	}
+
+	else
+		return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the archive at [path] to be processed
+// -----------------------------------------------------------------------------
+void batch::addArchive(string_view path)
+{
+	archive_paths.emplace_back(path);
+}
+
+// -----------------------------------------------------------------------------
+// Processes all archives given on the command line. Returns the exit status
+// -----------------------------------------------------------------------------
+int batch::run()
+{
+	if (invalid_params || archive_paths.empty() || queued_operations.empty() && script_file.empty())
+	{
+		printUsage();
+		return InvalidParams;
+	}
+
+	// Load script
+	string script;
+	if (!script_file.empty())
+	{
+#ifdef USE_LUA
+		if (!fileutil::readFileToString(script_file, script))
+		{
+			log::error("Unable to read script file \"{}\"", script_file);
+			fmt::print(stderr, "Unable to read script file \"{}\"\n", script_file);
+			return InvalidParams;
+		}
+#else
+		fmt::print(stderr, "Scripts are not supported in this build of SLADE\n");
+		return InvalidParams;
+#endif
+	}
+
+	// Process archives
+	auto status = Success;
+	for (const auto& path : archive_paths)
+	{
+		auto ok = processArchive(path, script);
+		fmt::print("{}: {}\n", path, ok ? "OK" : "FAILED (see log for details)");
+		if (!ok)
+			status = Failed;
+	}
+
+	return status;
+}
+
+// -----------------------------------------------------------------------------
+// Prints batch mode usage information
+// -----------------------------------------------------------------------------
+void batch::printUsage()
+{
+	fmt::print(
+		"Usage: slade -batch [-op <operation>]... [-script <file.lua>] [-save] <archive>...\n\n"
+		"Runs the given operations (in order), then the Execute(archive) function of\n"
+		"the given Lua script on each archive. Exits with status 0 if all succeeded,\n"
+		"1 if anything failed, or 2 if the parameters were invalid.\n\n"
+		"Operations (parameters are given as name:param1,param2):\n");
+	for (const auto& op : operations())
+	{
+		auto usage = op.params.empty() ? op.name : fmt::format("{}:{}", op.name, op.params);
+		fmt::print("  {:<26} {}\n", usage, op.description);
+	}
+}
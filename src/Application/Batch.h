@@ -0,0 +1,29 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+
+// Headless batch mode, enabled with the -batch command line option. Instead
+// of opening the editor UI, the archives given on the command line are each
+// opened, processed with built-in operations (-op) and/or a Lua archive script
+// (-script), optionally saved (-save) and closed, then SLADE exits with a
+// status code (see batch::Status)
+namespace batch
+{
+	enum Status
+	{
+		Success       = 0,
+		Failed        = 1, // An archive couldn't be opened, processed or saved
+		InvalidParams = 2
+	};
+
+	bool requested(const vector<string>& args);
+	bool isEnabled();
+	bool processArg(const vector<string>& args, unsigned& index);
+	void addArchive(string_view path);
+
+	int  run();
+	void printUsage();
+} // namespace batch
+} // namespace slade
@@ -33,6 +33,7 @@
 #include "SLADEWxApp.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Batch.h"
 #include "General/Console.h"
 #include "General/Web.h"
 #include "MainEditor/MainEditor.h"
@@ -60,7 +61,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::global
 {
-string error;
+thread_local string error; // Per-thread, so archives etc. can be opened on worker threads
 
 #ifdef GIT_DESCRIPTION
 string sc_rev = GIT_DESCRIPTION;
@@ -498,8 +499,17 @@ bool SLADEWxApp::singleInstanceCheck()
 // -----------------------------------------------------------------------------
 bool SLADEWxApp::OnInit()
 {
+	// Get command line arguments
+	vector<string> args;
+	for (int a = 1; a < argc; a++)
+		args.push_back(argv[a].ToStdString());
+
+	// Batch mode runs alongside any other instances (including other batch
+	// mode instances, for processing archives in parallel)
+	batch_mode_ = batch::requested(args);
+
 	// Check if an instance of SLADE is already running
-	if (!singleInstanceCheck())
+	if (!batch_mode_ && !singleInstanceCheck())
 	{
 		printf("Found active instance. Quitting.\n");
 		return false;
@@ -509,8 +519,11 @@ bool SLADEWxApp::OnInit()
 	wxSocketBase::Initialize();
 
 	// Start up file listener
-	file_listener_ = new MainAppFileListener();
-	file_listener_->Create("SLADE_MAFL");
+	if (!batch_mode_)
+	{
+		file_listener_ = new MainAppFileListener();
+		file_listener_->Create("SLADE_MAFL");
+	}
 
 	// Setup system options
 	wxSystemOptions::SetOption("mac.listctrl.always_use_generic", 1);
@@ -535,10 +548,14 @@ bool SLADEWxApp::OnInit()
 	const double ui_scale = 1.0;
 #else // !__APPLE__
 	// Calculate scaling factor (from system ppi)
-	wxMemoryDC dc;
-	double     ui_scale = (double)(dc.GetPPI().x) / 96.0;
-	if (ui_scale < 1.)
-		ui_scale = 1.;
+	double ui_scale = 1.;
+	if (!batch_mode_)
+	{
+		wxMemoryDC dc;
+		ui_scale = (double)(dc.GetPPI().x) / 96.0;
+		if (ui_scale < 1.)
+			ui_scale = 1.;
+	}
 #endif // __APPLE__
 
 	// Get Windows version
@@ -550,15 +567,14 @@ bool SLADEWxApp::OnInit()
 	// Reroute wx log messages
 	wxLog::SetActiveTarget(new SLADELog());
 
-	// Get command line arguments
-	vector<string> args;
-	for (int a = 1; a < argc; a++)
-		args.push_back(argv[a].ToStdString());
-
 	// Init application
 	if (!app::init(args, ui_scale))
 		return false;
 
+	// Batch mode is run from OnRun
+	if (batch_mode_)
+		return true;
+
 		// Check for updates
 #ifdef __WXMSW__
 	wxHTTP::Initialize();
@@ -574,6 +590,18 @@ bool SLADEWxApp::OnInit()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Runs the application main loop, or batch mode (without a main loop) if it
+// was requested on the command line
+// -----------------------------------------------------------------------------
+int SLADEWxApp::OnRun()
+{
+	if (batch_mode_)
+		return app::runBatch();
+
+	return wxApp::OnRun();
+}
+
 // -----------------------------------------------------------------------------
 // Application shutdown, run when program is closed
 // -----------------------------------------------------------------------------
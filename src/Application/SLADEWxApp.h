@@ -10,6 +10,7 @@ public:
 	~SLADEWxApp() = default;
 
 	bool OnInit() override;
+	int  OnRun() override;
 	int  OnExit() override;
 	void OnFatalException() override;
 
@@ -27,6 +28,7 @@ public:
 private:
 	wxSingleInstanceChecker* single_instance_checker_ = nullptr;
 	MainAppFileListener*     file_listener_           = nullptr;
+	bool                     batch_mode_              = false;
 };
 
 DECLARE_APP(SLADEWxApp)
@@ -31,6 +31,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Archive.h"
+#include "General/Profiler.h"
+#include "General/ThreadPool.h"
 #include "General/UndoRedo.h"
 #include "Utility/FileUtils.h"
 #include "Utility/Parser.h"
@@ -47,8 +49,13 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Bool, archive_load_data, false, CVar::Flag::Save)
 CVAR(Bool, backup_archives, true, CVar::Flag::Save)
+CVAR(Bool, archive_mmap_open, false, CVar::Flag::Save)
 bool                  Archive::save_backup = true;
 vector<ArchiveFormat> Archive::formats_;
+namespace
+{
+constexpr uint32_t export_chunk_size = 1024 * 1024; // Max bytes read at once when streaming entry data to a file
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -454,9 +461,11 @@ string Archive::filename(bool full) const
 // -----------------------------------------------------------------------------
 bool Archive::open(string_view filename)
 {
-	// Read the file into a MemChunk
+	PROFILE_ZONE("Archive::open");
+
+	// Map the file into memory if enabled, otherwise (or if mapping fails) read the file into a MemChunk
 	MemChunk mc;
-	if (!mc.importFile(filename))
+	if (!(archive_mmap_open && mc.importFileMapped(filename)) && !mc.importFile(filename))
 	{
 		global::error = "Unable to open file. Make sure it isn't in use by another program.";
 		return false;
@@ -466,11 +475,18 @@ bool Archive::open(string_view filename)
 	const auto backupname = filename_;
 	filename_             = filename;
 	file_modified_        = fileutil::fileModifiedTime(filename);
+	file_size_            = fileutil::fileSize(filename);
 
 	// Load from MemChunk
 	const sf::Clock timer;
 	if (open(mc))
 	{
+		// Keep the file mapping, so entries can continue to reference it and unmodified entry data can
+		// be loaded directly from it without copying
+		mapped_data_.clear();
+		if (mc.isMapped())
+			mapped_data_.importShared(mc, 0, mc.size());
+
 		log::info(2, "Archive::open took {}ms", timer.getElapsedTime().asMilliseconds());
 		on_disk_ = true;
 		return true;
@@ -488,7 +504,9 @@ bool Archive::open(string_view filename)
 // -----------------------------------------------------------------------------
 bool Archive::open(ArchiveEntry* entry)
 {
-	// Load from entry's data
+	// Load from entry's data. Archive formats reference the data (eg. as entry
+	// data views) rather than copying it where possible, so this doesn't
+	// duplicate the parent entry data in memory
 	auto sp_entry = entry->getShared();
 	if (sp_entry && open(sp_entry->data()))
 	{
@@ -530,6 +548,104 @@ bool Archive::checkEntry(ArchiveEntry* entry) const
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Loads the data for [entry] (at [offset] in the archive file) as a view of the
+// memory-mapped archive file, if it is mapped. No data is copied.
+// Returns false if the archive file isn't mapped or the entry data can't be
+// referenced from it (eg. if the entry has been modified)
+// -----------------------------------------------------------------------------
+bool Archive::loadMappedEntryData(ArchiveEntry* entry, uint32_t offset) const
+{
+	if (!mapped_data_.isMapped() || entry->state() != ArchiveEntry::State::Unmodified
+		|| offset + entry->size() > mapped_data_.size())
+		return false;
+
+	if (!entry->importMemChunk(mapped_data_, offset, entry->size()))
+		return false;
+
+	entry->setLoaded();
+	entry->setState(ArchiveEntry::State::Unmodified);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [size] bytes at [offset] in the archive file to [file], reading it in
+// bounded chunks rather than all at once (or directly from the mapped file if
+// it is mapped).
+// Returns false if the archive file couldn't be read
+// -----------------------------------------------------------------------------
+bool Archive::exportFileData(uint32_t offset, uint32_t size, wxFile& file) const
+{
+	// Write directly from the mapped file if possible
+	if (mapped_data_.isMapped())
+	{
+		if (offset + size > mapped_data_.size())
+			return false;
+
+		return file.Write(mapped_data_.data() + offset, size) == size;
+	}
+
+	// Open archive file
+	wxFile in(filename_);
+	if (!in.IsOpened() || in.Seek(offset, wxFromStart) == wxInvalidOffset)
+		return false;
+
+	// Copy data in chunks
+	vector<uint8_t> buffer(std::min<uint32_t>(size, export_chunk_size));
+	while (size > 0)
+	{
+		const auto count = std::min<uint32_t>(size, export_chunk_size);
+		if (in.Read(buffer.data(), count) != static_cast<ssize_t>(count) || file.Write(buffer.data(), count) != count)
+			return false;
+
+		size -= count;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Releases the archive file mapping (if any). Entry data referencing the
+// mapping is copied into memory if it is modified (or archive_load_data is
+// set), otherwise it is unloaded to be loaded again from the file when needed.
+// Returns false if anything else still references the mapping afterwards (so
+// the file is still mapped)
+// -----------------------------------------------------------------------------
+bool Archive::releaseMappedData()
+{
+	if (!mapped_data_.isMapped())
+		return true;
+
+	auto mapping = mapped_data_.mappedFile();
+
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
+	for (auto entry : entries)
+	{
+		if (!entry->data_.isMapped())
+			continue;
+
+		if (archive_load_data || entry->state() != ArchiveEntry::State::Unmodified)
+			entry->data_.detach();
+		else
+		{
+			entry->data_.clear();
+			entry->setLoaded(false);
+		}
+	}
+
+	mapped_data_.clear();
+
+	if (!mapping.expired())
+	{
+		log::warning("Archive file {} is still in use ({} references)", filename_, mapping.use_count());
+		return false;
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry matching [name] within [dir].
 // If no dir is given the root dir is used
@@ -652,6 +768,20 @@ bool Archive::save(string_view filename)
 		return false;
 	}
 
+	// The file can't be written while it is mapped into memory, so don't
+	// overwrite it if the mapping is still referenced after releasing it
+	if (!releaseMappedData())
+	{
+		std::error_code ec;
+		if (filename.empty() || std::filesystem::equivalent(filename_, string{ filename }, ec))
+		{
+			global::error = "Archive file data is still in use";
+			if (archive_mmap_open)
+				mapped_data_.importFileMapped(filename_);
+			return false;
+		}
+	}
+
 	// If the archive has a parent ArchiveEntry, just write it to that
 	if (auto parent = parent_.lock())
 	{
@@ -671,6 +801,7 @@ bool Archive::save(string_view filename)
 			// Update variables
 			on_disk_       = true;
 			file_modified_ = fileutil::fileModifiedTime(filename_);
+			file_size_     = fileutil::fileSize(filename_);
 		}
 		else if (!filename_.empty())
 		{
@@ -691,6 +822,7 @@ bool Archive::save(string_view filename)
 			// Update variables
 			on_disk_       = true;
 			file_modified_ = fileutil::fileModifiedTime(filename_);
+			file_size_     = fileutil::fileSize(filename_);
 		}
 	}
 
@@ -701,6 +833,10 @@ bool Archive::save(string_view filename)
 		signals_.saved(*this);
 	}
 
+	// Map the (new) file again if needed
+	if (archive_mmap_open && on_disk_ && !parent_.lock())
+		mapped_data_.importFileMapped(filename_);
+
 	return success;
 }
 
@@ -719,6 +855,7 @@ void Archive::close()
 {
 	// Clear the root dir
 	dir_root_->clear();
+	mapped_data_.clear();
 
 	// Announce
 	signals_.closed(*this);
@@ -1255,34 +1392,85 @@ bool Archive::importDir(string_view directory)
 		if (item.is_regular_file())
 			files.push_back(item.path().string());
 
-	// Go through files
-	for (const auto& file : files)
+	// Read all files in parallel (the entries aren't added to the archive yet,
+	// so this doesn't touch any shared state)
+	vector<shared_ptr<ArchiveEntry>> entries(files.size());
+	vector<string>                   entry_dirs(files.size());
+	threadpool::parallelFor(
+		files.size(),
+		[&](size_t a) {
+			strutil::Path fn{ strutil::replace(files[a], directory, "") }; // Remove directory from entry name
+
+			// Split filename into dir+name
+			auto edir = fn.path();
+
+			// Remove beginning \ or / from dir
+			if (strutil::startsWith(edir, '\\') || strutil::startsWith(edir, '/'))
+				edir.remove_prefix(1);
+			entry_dirs[a] = edir;
+
+			// Create the entry and load its data
+			entries[a] = std::make_shared<ArchiveEntry>(fn.fileName());
+			entries[a]->importFile(files[a]);
+		},
+		4);
+
+	// Add the entries (in a single pass, without announcing each addition)
+	const ArchiveModSignalBlocker sig_blocker{ *this };
+	for (unsigned a = 0; a < entries.size(); a++)
 	{
-		strutil::Path fn{ strutil::replace(file, directory, "") }; // Remove directory from entry name
-
-		// Split filename into dir+name
-		const auto ename = fn.fileName();
-		auto       edir  = fn.path();
-
-		// Remove beginning \ or / from dir
-		if (strutil::startsWith(edir, '\\') || strutil::startsWith(edir, '/'))
-			edir.remove_prefix(1);
-
-		// Add the entry
-		auto dir   = createDir(edir);
-		auto entry = addNewEntry(ename, dir->numEntries() + 1, dir.get());
-
-		// Load data
-		entry->importFile(file);
+		auto dir = createDir(entry_dirs[a]);
+		addEntry(entries[a], dir->numEntries() + 1, dir.get());
 
 		// Set unmodified
-		entry->setState(ArchiveEntry::State::Unmodified);
+		entries[a]->setState(ArchiveEntry::State::Unmodified);
 		dir->dirEntry()->setState(ArchiveEntry::State::Unmodified);
 	}
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Imports all [files] into [dir] (or the root dir if null), starting at
+// [position], using the filenames as entry names.
+// Files are read and their types detected in parallel, with all new entries
+// added to the archive in a single pass in between.
+// Returns the newly added entries
+// -----------------------------------------------------------------------------
+vector<shared_ptr<ArchiveEntry>> Archive::importFiles(const vector<string>& files, unsigned position, ArchiveDir* dir)
+{
+	if (read_only_ || files.empty())
+		return {};
+
+	// Read all files in parallel
+	vector<shared_ptr<ArchiveEntry>> entries(files.size());
+	threadpool::parallelFor(
+		files.size(),
+		[&](size_t a) {
+			entries[a] = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(files[a]));
+			entries[a]->importFile(files[a]);
+		},
+		4);
+
+	// Add the entries to the archive
+	vector<ArchiveEntry*> added;
+	for (const auto& entry : entries)
+	{
+		if (!addEntry(entry, position, dir))
+			continue;
+
+		added.push_back(entry.get());
+		if (position != 0xFFFFFFFF)
+			position++;
+	}
+
+	// Detect types now the entries are in the archive (detection can depend
+	// on the archive format)
+	EntryType::detectEntryTypes(added);
+
+	return entries;
+}
+
 // -----------------------------------------------------------------------------
 // Reverts [entry] to the data it contained at the last time the archive was
 // saved.
@@ -1385,8 +1573,8 @@ ArchiveEntry* Archive::findFirst(SearchOptions& options)
 		if (!options.match_name.empty())
 		{
 			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
+			const auto check_name = options.ignore_ext ? entry->nameNoExt() : string_view{ entry->name() };
+			if (!strutil::matchesCI(check_name, options.match_name))
 				continue;
 		}
 
@@ -1455,8 +1643,8 @@ ArchiveEntry* Archive::findLast(SearchOptions& options)
 		if (!options.match_name.empty())
 		{
 			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
+			const auto check_name = options.ignore_ext ? entry->nameNoExt() : string_view{ entry->name() };
+			if (!strutil::matchesCI(check_name, options.match_name))
 				continue;
 		}
 
@@ -1525,8 +1713,8 @@ vector<ArchiveEntry*> Archive::findAll(SearchOptions& options)
 		if (!options.match_name.empty())
 		{
 			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
+			const auto check_name = options.ignore_ext ? entry->nameNoExt() : string_view{ entry->name() };
+			if (!strutil::matchesCI(check_name, options.match_name))
 				continue;
 		}
 
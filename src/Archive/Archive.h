@@ -60,6 +60,7 @@ public:
 	bool                   isReadOnly() const { return read_only_; }
 	virtual bool           isWritable() { return true; }
 	time_t                 fileModifiedTime() const { return file_modified_; }
+	uint64_t               fileSize() const { return file_size_; }
 
 	void setModified(bool modified);
 	void setFilename(string_view filename) { filename_ = filename; }
@@ -89,6 +90,7 @@ public:
 
 	// Misc
 	virtual bool     loadEntryData(ArchiveEntry* entry) = 0;
+	virtual bool     exportEntryData(ArchiveEntry* entry, wxFile& file) { return false; }
 	virtual unsigned numEntries();
 	virtual void     close();
 	void             entryStateChanged(ArchiveEntry* entry);
@@ -119,6 +121,10 @@ public:
 		unsigned    position = 0xFFFFFFFF,
 		ArchiveDir* dir      = nullptr);
 	virtual shared_ptr<ArchiveEntry> addNewEntry(string_view name, string_view add_namespace);
+	vector<shared_ptr<ArchiveEntry>> importFiles(
+		const vector<string>& files,
+		unsigned              position = 0xFFFFFFFF,
+		ArchiveDir*           dir      = nullptr);
 	virtual bool                     removeEntry(ArchiveEntry* entry);
 
 	// Entry moving
@@ -186,9 +192,16 @@ protected:
 	string                 format_;
 	string                 filename_;
 	weak_ptr<ArchiveEntry> parent_;
-	bool   on_disk_       = false; // Specifies whether the archive exists on disk (as opposed to being newly created)
-	bool   read_only_     = false; // If true, the archive cannot be modified
-	time_t file_modified_ = 0;
+	bool     on_disk_       = false; // Specifies whether the archive exists on disk (as opposed to being newly created)
+	bool     read_only_     = false; // If true, the archive cannot be modified
+	time_t   file_modified_ = 0;
+	uint64_t file_size_     = 0; // Size of the archive file when it was last opened/saved
+
+	// The archive file mapped into memory (if opened with archive_mmap_open)
+	MemChunk mapped_data_;
+
+	bool loadMappedEntryData(ArchiveEntry* entry, uint32_t offset) const;
+	bool exportFileData(uint32_t offset, uint32_t size, wxFile& file) const;
 
 private:
 	bool                   modified_ = true;
@@ -196,6 +209,8 @@ private:
 	Signals                signals_;
 
 	static vector<ArchiveFormat> formats_;
+
+	bool releaseMappedData();
 };
 
 // Base class for list-based archive formats
@@ -40,6 +40,9 @@ using namespace slade;
 
 namespace
 {
+// Directories with at least this many entries get a name lookup index
+constexpr size_t name_index_min_entries = 64;
+
 void buildEntryList(vector<shared_ptr<ArchiveEntry>>& list, ArchiveDir const* dir)
 {
 	for (const auto& subdir : dir->subdirs())
@@ -223,6 +226,10 @@ ArchiveEntry* ArchiveDir::entry(string_view name, bool cut_ext) const
 	if (name.empty())
 		return nullptr;
 
+	// Use name index if built
+	if (name_index_enabled_)
+		return indexedEntry(name, cut_ext);
+
 	// Go through entries
 	for (auto& entry : entries_)
 	{
@@ -245,6 +252,13 @@ shared_ptr<ArchiveEntry> ArchiveDir::sharedEntry(string_view name, bool cut_ext)
 	if (name.empty())
 		return nullptr;
 
+	// Use name index if built
+	if (name_index_enabled_)
+	{
+		const auto entry = indexedEntry(name, cut_ext);
+		return entry ? entries_[entryIndex(entry)] : nullptr;
+	}
+
 	// Go through entries
 	for (auto& entry : entries_)
 	{
@@ -310,6 +324,16 @@ bool ArchiveDir::addEntry(shared_ptr<ArchiveEntry> entry, unsigned index)
 	else
 		entries_.insert(entries_.begin() + index, entry); // Add it at index
 
+	// Update name index (or build it if there are now enough entries)
+	if (name_index_enabled_)
+		addToNameIndex(entry.get());
+	else if (entries_.size() >= name_index_min_entries)
+	{
+		name_index_enabled_ = true;
+		for (const auto& e : entries_)
+			addToNameIndex(e.get());
+	}
+
 	// Check entry name if duplicate names aren't allowed
 	if (!allow_duplicate_names_)
 		ensureUniqueName(entry.get());
@@ -329,6 +353,8 @@ bool ArchiveDir::removeEntry(unsigned index)
 
 	// De-parent entry
 	entries_[index]->parent_ = nullptr;
+	if (name_index_enabled_)
+		removeFromNameIndex(entries_[index].get(), entries_[index]->name_);
 
 	// Remove it from the entry list
 	entries_.erase(entries_.begin() + index);
@@ -452,6 +478,9 @@ void ArchiveDir::clear()
 {
 	entries_.clear();
 	subdirs_.clear();
+	name_index_.clear();
+	name_index_noext_.clear();
+	name_index_enabled_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -543,6 +572,80 @@ void ArchiveDir::ensureUniqueName(ArchiveEntry* entry)
 		entry->setName(name);
 }
 
+// -----------------------------------------------------------------------------
+// Adds [entry] to the name lookup index
+// -----------------------------------------------------------------------------
+void ArchiveDir::addToNameIndex(ArchiveEntry* entry)
+{
+	name_index_[entry->name_.hashCI()].push_back(entry);
+	name_index_noext_[entry->name_.hashCINoExt()].push_back(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the name lookup index, where it was added with [name]
+// -----------------------------------------------------------------------------
+void ArchiveDir::removeFromNameIndex(ArchiveEntry* entry, const ArchiveEntry::Name& name)
+{
+	auto remove = [entry](NameIndex& index, uint32_t key) {
+		const auto i = index.find(key);
+		if (i == index.end())
+			return;
+
+		auto& list = i->second;
+		list.erase(std::remove(list.begin(), list.end(), entry), list.end());
+		if (list.empty())
+			index.erase(i);
+	};
+
+	remove(name_index_, name.hashCI());
+	remove(name_index_noext_, name.hashCINoExt());
+}
+
+// -----------------------------------------------------------------------------
+// Called when [entry] in this directory has been renamed from [old_name],
+// updates the name lookup index
+// -----------------------------------------------------------------------------
+void ArchiveDir::entryRenamed(ArchiveEntry* entry, const ArchiveEntry::Name& old_name)
+{
+	if (!name_index_enabled_)
+		return;
+
+	removeFromNameIndex(entry, old_name);
+	addToNameIndex(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the first entry matching [name] (case-insensitive) via the name
+// lookup index, or null if no entries match
+// -----------------------------------------------------------------------------
+ArchiveEntry* ArchiveDir::indexedEntry(string_view name, bool cut_ext) const
+{
+	const auto& index = cut_ext ? name_index_noext_ : name_index_;
+	const auto  i     = index.find(ArchiveEntry::Name::hashCI(name));
+	if (i == index.end())
+		return nullptr;
+
+	// Find the entry with the name that comes first in the directory (there
+	// may be multiple entries with the name, and other names with the same
+	// hash)
+	ArchiveEntry* first       = nullptr;
+	int           first_index = 0;
+	for (auto entry : i->second)
+	{
+		if (!strutil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
+			continue;
+
+		const auto entry_index = entryIndex(entry);
+		if (!first || entry_index < first_index)
+		{
+			first       = entry;
+			first_index = entry_index;
+		}
+	}
+
+	return first;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "ArchiveEntry.h"
+#include <unordered_map>
 
 namespace slade
 {
 class ArchiveDir
 {
 	friend class Archive;
+	friend class ArchiveEntry;
 
 public:
 	ArchiveDir(string_view name, const shared_ptr<ArchiveDir>& parent = nullptr, Archive* archive = nullptr);
@@ -85,6 +87,18 @@ private:
 	vector<shared_ptr<ArchiveDir>>   subdirs_;
 	bool                             allow_duplicate_names_ = true;
 
-	void ensureUniqueName(ArchiveEntry* entry);
+	// Case-insensitive name lookup index, only built for directories with many
+	// entries. Keyed by the entries' case-folded name hashes (see
+	// ArchiveEntry::Name), so lookups must still check the names match
+	using NameIndex = std::unordered_map<uint32_t, vector<ArchiveEntry*>>;
+	NameIndex name_index_;       // Name hash -> entries
+	NameIndex name_index_noext_; // Name without extension hash -> entries
+	bool      name_index_enabled_ = false;
+
+	void          ensureUniqueName(ArchiveEntry* entry);
+	void          addToNameIndex(ArchiveEntry* entry);
+	void          removeFromNameIndex(ArchiveEntry* entry, const ArchiveEntry::Name& name);
+	void          entryRenamed(ArchiveEntry* entry, const ArchiveEntry::Name& old_name);
+	ArchiveEntry* indexedEntry(string_view name, bool cut_ext) const;
 };
 } // namespace slade
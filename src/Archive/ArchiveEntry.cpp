@@ -35,8 +35,10 @@
 #include "Main.h"
 #include "ArchiveEntry.h"
 #include "Archive.h"
+#include "EntryDataStore.h"
 #include "General/Misc.h"
 #include "Utility/StringUtils.h"
+#include <mutex>
 
 using namespace slade;
 
@@ -47,6 +49,53 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, wad_force_uppercase, true, CVar::Flag::Save)
+namespace
+{
+std::atomic<uint64_t> data_access_counter{ 0 };
+
+// Deferred type detection is done by one thread at a time (recursive since
+// detection itself requests the entry type), see detectDeferredType
+std::recursive_mutex                    deferred_type_mutex;
+thread_local const slade::ArchiveEntry* detecting_entry = nullptr;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveEntry::Name Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Sets the name to [name] and updates the case-folded hashes
+// -----------------------------------------------------------------------------
+void ArchiveEntry::Name::set(string_view name)
+{
+	name_ = name;
+
+	// The 'no extension' hash is the hash of the name up to the first '.'
+	// (the same as the full hash if there is no extension)
+	auto ext_pos   = name.find('.');
+	hash_ci_noext_ = hashCI(name.substr(0, ext_pos));
+	hash_ci_       = ext_pos == string_view::npos ? hash_ci_noext_ : hashCI(name);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a (32-bit FNV-1a) hash of [name] converted to uppercase, so that
+// names differing only by case have the same hash
+// -----------------------------------------------------------------------------
+uint32_t ArchiveEntry::Name::hashCI(string_view name)
+{
+	uint32_t hash = 2166136261u;
+	for (auto c : name)
+	{
+		hash ^= static_cast<unsigned char>(toupper(c));
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
 
 
 // -----------------------------------------------------------------------------
@@ -61,11 +110,9 @@ CVAR(Bool, wad_force_uppercase, true, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 ArchiveEntry::ArchiveEntry(string_view name, uint32_t size) :
 	name_{ name },
-	upper_name_{ name },
 	size_{ size },
 	type_{ EntryType::unknownType() }
 {
-	strutil::upperIP(upper_name_);
 }
 
 // -----------------------------------------------------------------------------
@@ -76,24 +123,26 @@ ArchiveEntry::ArchiveEntry(ArchiveEntry& copy)
 	// Initialise (copy) attributes
 	parent_      = nullptr;
 	name_        = copy.name_;
-	upper_name_  = copy.upper_name_;
 	size_        = copy.size_;
 	data_loaded_ = true;
-	type_        = copy.type_;
+	type_        = copy.type();
 	locked_      = false;
 	reliability_ = copy.reliability_;
 	encrypted_   = copy.encrypted_;
 	index_guess_ = 0;
 
-	// Copy data
-	data_.importMem(copy.rawData(true), copy.size());
+	// Copy data (shared until either entry is modified). Data referencing a
+	// mapped archive file is copied, since only the archive's own entries can
+	// reference its mapping
+	data_.importMem(copy.data(true));
+	if (data_.isMapped())
+		data_.detach();
 
 	// Copy extra properties
 	ex_props_ = copy.exProps();
 
-	// Clear properties that shouldn't be copied
-	ex_props_.remove("ZipIndex");
-	ex_props_.remove("Offset");
+	// Clear properties that shouldn't be copied (storage info isn't copied,
+	// the copy isn't stored in any archive file yet)
 	ex_props_.remove("filePath");
 
 	// Set entry state
@@ -106,23 +155,30 @@ ArchiveEntry::ArchiveEntry(ArchiveEntry& copy)
 // -----------------------------------------------------------------------------
 string_view ArchiveEntry::nameNoExt() const
 {
-	auto ext_pos = name_.find('.');
+	auto& name    = name_.str();
+	auto  ext_pos = name.find('.');
 	if (ext_pos != string::npos)
-		return { name_.data(), ext_pos };
+		return { name.data(), ext_pos };
 
-	return name_;
+	return name;
 }
 
 // -----------------------------------------------------------------------------
-// Returns the entry name in uppercase with no file extension
+// Returns the entry name in uppercase.
+// Uppercase names aren't stored, so for comparisons use the strutil CI
+// functions on name() instead where possible
 // -----------------------------------------------------------------------------
-string_view ArchiveEntry::upperNameNoExt() const
+string ArchiveEntry::upperName() const
 {
-	auto ext_pos = upper_name_.find('.');
-	if (ext_pos != string::npos)
-		return { upper_name_.data(), ext_pos };
+	return strutil::upper(name_.str());
+}
 
-	return upper_name_;
+// -----------------------------------------------------------------------------
+// Returns the entry name in uppercase with no file extension
+// -----------------------------------------------------------------------------
+string ArchiveEntry::upperNameNoExt() const
+{
+	return strutil::upper(nameNoExt());
 }
 
 // -----------------------------------------------------------------------------
@@ -165,7 +221,7 @@ string ArchiveEntry::path(bool include_name) const
 const uint8_t* ArchiveEntry::rawData(bool allow_load)
 {
 	// Return entry data
-	return data(allow_load).data();
+	return std::as_const(data(allow_load)).data();
 }
 
 // -----------------------------------------------------------------------------
@@ -177,11 +233,20 @@ MemChunk& ArchiveEntry::data(bool allow_load)
 	// Get parent archive
 	auto parent_archive = parent();
 
+	// Record access
+	last_access_.store(++data_access_counter, std::memory_order_relaxed);
+
 	// Load the data if needed (and possible)
 	if (allow_load && !isLoaded() && parent_archive && size_ > 0)
 	{
-		data_loaded_ = parent_archive->loadEntryData(this);
+		// Loading data resets the entry type, so do any deferred type detection after loading
+		const auto detect_type = detect_type_deferred_.load();
+		data_loaded_           = parent_archive->loadEntryData(this);
 		setState(State::Unmodified);
+		if (data_loaded_)
+			entrydatastore::share(data_);
+		if (detect_type)
+			detectDeferredType();
 	}
 
 	return data_;
@@ -228,8 +293,24 @@ int ArchiveEntry::index()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setName(string_view name)
 {
-	name_       = name;
-	upper_name_ = strutil::upper(name);
+	const auto old_name = name_;
+	name_.set(name);
+
+	// Update parent dir name index if needed
+	if (parent_ && (name_.hashCI() != old_name.hashCI() || name_.hashCINoExt() != old_name.hashCINoExt()))
+		parent_->entryRenamed(this, old_name);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the entry's type to [type], with reliability [r]. This also cancels any
+// deferred type detection, unless it is what is setting the type
+// -----------------------------------------------------------------------------
+void ArchiveEntry::setType(EntryType* type, int r)
+{
+	type_        = type;
+	reliability_ = r;
+	if (detecting_entry != this)
+		detect_type_deferred_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -251,6 +332,19 @@ void ArchiveEntry::setState(State state, bool silent)
 		stateChanged();
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the entry's data is shared with anything other than the
+// entry data store (eg. another entry, a cache or a background task)
+// -----------------------------------------------------------------------------
+bool ArchiveEntry::isDataShared() const
+{
+	auto count = data_.shareCount();
+	if (count > 1 && entrydatastore::isStored(data_))
+		count--;
+
+	return count > 1;
+}
+
 // -----------------------------------------------------------------------------
 // 'Unloads' entry data from memory
 // -----------------------------------------------------------------------------
@@ -300,37 +394,32 @@ void ArchiveEntry::unlock()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::formatName(const ArchiveFormat& format)
 {
-	bool changed = false;
+	const auto old_name = name_;
 
 	// Perform character substitution if needed
-	name_ = misc::fileNameToLumpName(name_);
+	auto name = misc::fileNameToLumpName(name_.str());
 
 	// Max length
-	if (format.max_name_length > 0 && static_cast<int>(name_.size()) > format.max_name_length)
-	{
-		strutil::truncateIP(name_, format.max_name_length);
-		changed = true;
-	}
+	if (format.max_name_length > 0 && static_cast<int>(name.size()) > format.max_name_length)
+		strutil::truncateIP(name, format.max_name_length);
 
 	// Uppercase
 	if (format.prefer_uppercase && wad_force_uppercase)
-		strutil::upperIP(name_);
+		strutil::upperIP(name);
 
 	// Remove \ or / if the format supports folders
-	if (format.supports_dirs && (name_.find('/') != string::npos || name_.find('\\') != string::npos))
-	{
-		name_   = misc::lumpNameToFileName(name_);
-		changed = true;
-	}
+	if (format.supports_dirs && (name.find('/') != string::npos || name.find('\\') != string::npos))
+		name = misc::lumpNameToFileName(name);
 
 	// Remove extension if the format doesn't have them
 	if (!format.names_extensions)
-		if (const auto pos = name_.find('.'); pos != string::npos)
-			strutil::truncateIP(name_, pos);
+		if (const auto pos = name.find('.'); pos != string::npos)
+			strutil::truncateIP(name, pos);
 
-	// Update upper name
-	if (changed)
-		upper_name_ = strutil::upper(name_);
+	// Update name (and parent dir name index if needed)
+	name_.set(name);
+	if (parent_ && (name_.hashCI() != old_name.hashCI() || name_.hashCINoExt() != old_name.hashCINoExt()))
+		parent_->entryRenamed(this, old_name);
 }
 
 // -----------------------------------------------------------------------------
@@ -434,13 +523,55 @@ bool ArchiveEntry::importMemChunk(MemChunk& mc)
 	// Check that the given MemChunk has data
 	if (mc.hasData())
 	{
-		// Copy the data from the MemChunk into the entry
-		return importMem(mc.data(), mc.size());
+		// Share the data from the MemChunk with the entry (copy if it
+		// references a mapped archive file)
+		if (!importMemChunk(mc, 0, mc.size()))
+			return false;
+		if (data_.isMapped())
+			data_.detach();
+
+		return true;
 	}
 
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Imports [size] bytes at [offset] in [mc] into the entry, clearing any
+// currently existing data. The entry will reference the data within [mc] (or
+// the file mapping it references) rather than copying it, until either is
+// modified.
+// Returns false if the given range is outside of [mc], true otherwise
+// -----------------------------------------------------------------------------
+bool ArchiveEntry::importMemChunk(const MemChunk& mc, uint32_t offset, uint32_t size)
+{
+	// Check if locked
+	if (locked_)
+	{
+		global::error = "Entry is locked";
+		return false;
+	}
+
+	// Check range
+	if (offset + size > mc.size())
+		return false;
+
+	// Clear any current data
+	clearData();
+
+	// Share (or copy) the data
+	if (!data_.importShared(mc, offset, size))
+		return false;
+
+	// Update attributes
+	size_ = size;
+	setLoaded();
+	setType(EntryType::unknownType());
+	setState(State::Modified);
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Loads a portion of a file into the entry, overwriting any existing data
 // currently in the entry. A size of 0 means load from the offset to the end of
@@ -531,8 +662,8 @@ bool ArchiveEntry::importEntry(ArchiveEntry* entry)
 	if (!entry)
 		return false;
 
-	// Copy entry data
-	importMem(entry->rawData(), entry->size());
+	// Copy entry data (shared until either entry is modified)
+	importMemChunk(entry->data());
 
 	return true;
 }
@@ -553,6 +684,18 @@ bool ArchiveEntry::exportFile(string_view filename)
 		return false;
 	}
 
+	// If the data isn't loaded, stream it directly from the parent archive to the
+	// file if possible rather than loading it all into memory first
+	const auto parent_archive = parent();
+	if (!data_loaded_ && parent_archive)
+	{
+		if (parent_archive->exportEntryData(this, file))
+			return true;
+
+		// Start again from the beginning of the file if that failed part-way
+		file.Seek(0, wxFromStart);
+	}
+
 	// Write entry data to the file, if any
 	auto data = rawData();
 	if (data)
@@ -632,10 +775,10 @@ void ArchiveEntry::setExtensionByType()
 		return;
 
 	// Convert name to wxFileName for processing
-	strutil::Path fn(name_);
+	strutil::Path fn(name_.str());
 
 	// Set new extension
-	fn.setExtension(type_->extension());
+	fn.setExtension(type()->extension());
 
 	// Rename
 	auto parent_archive = parent();
@@ -681,3 +824,37 @@ ArchiveEntry* ArchiveEntry::relativeEntry(string_view at_path, bool allow_absolu
 
 	return include;
 }
+
+// -----------------------------------------------------------------------------
+// Detects the entry's type if detection was deferred when its parent archive
+// was opened. The entry data is unloaded again afterwards if it wasn't already
+// loaded
+// -----------------------------------------------------------------------------
+void ArchiveEntry::detectDeferredType() const
+{
+	// This can be called from worker threads (eg. via type() during map checks
+	// or image decoding), so only one thread does the detection. Any others
+	// wait here until it is done, since the deferred flag is only cleared
+	// afterwards. Requests for the type during detection (on the same thread)
+	// just get the current type
+	std::lock_guard lock(deferred_type_mutex);
+	if (!detect_type_deferred_ || detecting_entry == this)
+		return;
+
+	// Entries are never const objects, this is only const so it can be done
+	// transparently from type()
+	auto       self       = const_cast<ArchiveEntry*>(this);
+	const auto prev_entry = detecting_entry;
+	detecting_entry       = this;
+
+	// Load data first (loading resets the entry type)
+	const auto was_loaded = data_loaded_;
+	self->data();
+
+	EntryType::detectEntryType(*self);
+	if (!was_loaded)
+		self->unloadData();
+
+	detecting_entry             = prev_entry;
+	self->detect_type_deferred_ = false;
+}
@@ -2,6 +2,7 @@
 
 #include "EntryType/EntryType.h"
 #include "Utility/Property.h"
+#include <atomic>
 
 namespace slade
 {
@@ -13,6 +14,7 @@ class ArchiveEntry
 {
 	friend class ArchiveDir;
 	friend class Archive;
+	friend class EntryTypeCache;
 
 public:
 	enum class Encryption
@@ -30,16 +32,58 @@ public:
 		New // Newly created (not saved on disk yet)
 	};
 
+	// Format-specific info about where/how the entry is stored in its archive
+	// file, used by the archive formats' read/write code. Kept as typed fields
+	// rather than ex props so those paths don't need string-keyed lookups
+	struct StorageInfo
+	{
+		static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+		uint32_t offset    = NONE; // Offset of the entry data in the archive file
+		uint32_t full_size = NONE; // Full (eg. decompressed) size, if different from the stored size
+		uint32_t index     = NONE; // Index of the entry in the archive file's directory (eg. zip)
+		uint8_t  method    = 0;    // Format-specific compression method
+		uint8_t  type      = 0;    // Format-specific type code
+
+		bool hasOffset() const { return offset != NONE; }
+		bool hasFullSize() const { return full_size != NONE; }
+		bool hasIndex() const { return index != NONE; }
+	};
+
+	// The entry's name, stored once (short lump names fit in the string's
+	// small buffer, so don't need an allocation), along with cached hashes of
+	// the case-folded name with and without its extension. These are used as
+	// the keys for ArchiveDir's name lookup index, so no uppercase copies of
+	// entry names need to be kept
+	class Name
+	{
+	public:
+		Name(string_view name = {}) { set(name); }
+
+		const string& str() const { return name_; }
+		uint32_t      hashCI() const { return hash_ci_; }
+		uint32_t      hashCINoExt() const { return hash_ci_noext_; }
+
+		void set(string_view name);
+
+		static uint32_t hashCI(string_view name);
+
+	private:
+		string   name_;
+		uint32_t hash_ci_       = 0;
+		uint32_t hash_ci_noext_ = 0;
+	};
+
 	// Constructor/Destructor
 	ArchiveEntry(string_view name = "", uint32_t size = 0);
 	ArchiveEntry(ArchiveEntry& copy);
 	~ArchiveEntry() = default;
 
 	// Accessors
-	const string&            name() const { return name_; }
+	const string&            name() const { return name_.str(); }
 	string_view              nameNoExt() const;
-	const string&            upperName() const { return upper_name_; }
-	string_view              upperNameNoExt() const;
+	string                   upperName() const;
+	string                   upperNameNoExt() const;
 	uint32_t                 size() const { return data_loaded_ ? data_.size() : size_; }
 	MemChunk&                data(bool allow_load = true);
 	const uint8_t*           rawData(bool allow_load = true);
@@ -47,7 +91,14 @@ public:
 	Archive*                 parent() const;
 	Archive*                 topParent() const;
 	string                   path(bool name = false) const;
-	EntryType*               type() const { return type_; }
+	EntryType*               type() const
+	{
+		if (detect_type_deferred_)
+			detectDeferredType();
+		return type_;
+	}
+	StorageInfo&             storage() { return storage_; }
+	const StorageInfo&       storage() const { return storage_; }
 	PropertyList&            exProps() { return ex_props_; }
 	const PropertyList&      exProps() const { return ex_props_; }
 	Property&                exProp(const string& key) { return ex_props_[key]; }
@@ -55,6 +106,8 @@ public:
 	State                    state() const { return state_; }
 	bool                     isLocked() const { return locked_; }
 	bool                     isLoaded() const { return data_loaded_; }
+	bool                     isDataShared() const;
+	uint64_t                 lastAccess() const { return last_access_; }
 	Encryption               encryption() const { return encrypted_; }
 	ArchiveEntry*            nextEntry();
 	ArchiveEntry*            prevEntry();
@@ -64,11 +117,8 @@ public:
 	// Modifiers (won't change entry state, except setState of course :P)
 	void setName(string_view name);
 	void setLoaded(bool loaded = true) { data_loaded_ = loaded; }
-	void setType(EntryType* type, int r = 0)
-	{
-		type_        = type;
-		reliability_ = r;
-	}
+	void setType(EntryType* type, int r = 0);
+	void setTypeDeferred() { detect_type_deferred_ = true; }
 	void setState(State state, bool silent = false);
 	void setEncryption(Encryption enc) { encrypted_ = enc; }
 	void unloadData();
@@ -89,6 +139,7 @@ public:
 	// Data import
 	bool importMem(const void* data, uint32_t size);
 	bool importMemChunk(MemChunk& mc);
+	bool importMemChunk(const MemChunk& mc, uint32_t offset, uint32_t size);
 	bool importFile(string_view filename, uint32_t offset = 0, uint32_t size = 0);
 	bool importFileStream(wxFile& file, uint32_t len = 0);
 	bool importEntry(ArchiveEntry* entry);
@@ -104,21 +155,21 @@ public:
 
 	// Misc
 	string        sizeString() const;
-	string        typeString() const { return type_ ? type_->name() : "Unknown"; }
+	string        typeString() const { return type() ? type()->name() : "Unknown"; }
 	void          stateChanged();
 	void          setExtensionByType();
-	int           typeReliability() const { return (type_ ? (type()->reliability() * reliability_ / 255) : 0); }
+	int           typeReliability() const { return (type() ? (type()->reliability() * reliability_ / 255) : 0); }
 	bool          isInNamespace(string_view ns);
 	ArchiveEntry* relativeEntry(string_view path, bool allow_absolute_path = true) const;
 
 private:
 	// Entry Info
-	string       name_;
-	string       upper_name_;
+	Name         name_;
 	uint32_t     size_ = 0;
 	MemChunk     data_;
 	EntryType*   type_   = nullptr;
 	ArchiveDir*  parent_ = nullptr;
+	StorageInfo  storage_;
 	PropertyList ex_props_;
 
 	// Entry status
@@ -128,9 +179,20 @@ private:
 	bool       data_loaded_  = true;             // True if the entry's data is currently loaded into the data MemChunk
 	Encryption encrypted_    = Encryption::None; // Is there some encrypting on the archive?
 
+	// If true, type detection was skipped when loading and will be done the
+	// first time the type is requested (possibly from a worker thread). Only
+	// cleared once detection has finished
+	std::atomic<bool> detect_type_deferred_{ false };
+
+	// Value of a global counter at the last time the entry's data was
+	// accessed, used to find the least recently used data to unload
+	std::atomic<uint64_t> last_access_{ 0 };
+
 	// Misc stuff
 	int    reliability_ = 0; // The reliability of the entry's identification
 	size_t index_guess_ = 0; // for speed
+
+	void detectDeferredType() const;
 };
 
 template<typename T> T ArchiveEntry::exProp(const string& key)
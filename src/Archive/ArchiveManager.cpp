@@ -33,9 +33,12 @@
 #include "Main.h"
 #include "ArchiveManager.h"
 #include "App.h"
+#include "EntryDataStore.h"
 #include "Formats/All.h"
 #include "Formats/DirArchive.h"
 #include "General/Console.h"
+#include "General/EntryPrefetch.h"
+#include "General/Jobs.h"
 #include "General/ResourceManager.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
@@ -52,6 +55,159 @@ using namespace slade;
 CVAR(Int, base_resource, -1, CVar::Flag::Save)
 CVAR(Int, max_recent_files, 25, CVar::Flag::Save)
 CVAR(Bool, auto_open_wads_root, false, CVar::Flag::Save)
+CVAR(Int, archive_data_budget, 0, CVar::Flag::Save) // Max MB of loaded entry data to keep (0 = unlimited)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the uppercase name (without extension) to look up in the resource
+// name index for a search with [options], or nothing if the search isn't for a
+// specific name (no name or wildcards given)
+// -----------------------------------------------------------------------------
+std::optional<string> indexSearchName(const Archive::SearchOptions& options)
+{
+	const auto& name = options.match_name;
+	if (name.empty() || name.find_first_of("*?") != string::npos)
+		return {};
+
+	return strutil::upper(string_view{ name }.substr(0, name.find('.')));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total size of all loaded entry data in [archive]. If [entries]
+// is given, all entries in the archive with loaded data are added to it
+// -----------------------------------------------------------------------------
+uint64_t loadedDataSize(const Archive& archive, vector<ArchiveEntry*>* entries = nullptr)
+{
+	vector<ArchiveEntry*> all_entries;
+	archive.putEntryTreeAsList(all_entries);
+
+	uint64_t total = 0;
+	for (auto entry : all_entries)
+	{
+		if (!entry->isLoaded() || entry->type() == EntryType::folderType())
+			continue;
+
+		total += entry->size();
+		if (entries)
+			entries->push_back(entry);
+	}
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the approximate memory used by all entries in [archive], excluding
+// entry data - the entry objects themselves, name storage (names too long for
+// the string's small buffer) and extra properties.
+// [num_entries] is set to the number of entries in the archive
+// -----------------------------------------------------------------------------
+uint64_t entryOverheadSize(const Archive& archive, unsigned& num_entries)
+{
+	vector<ArchiveEntry*> all_entries;
+	archive.putEntryTreeAsList(all_entries);
+	num_entries = static_cast<unsigned>(all_entries.size());
+
+	static const auto sso_capacity = string{}.capacity();
+
+	uint64_t total = 0;
+	for (auto entry : all_entries)
+	{
+		total += sizeof(ArchiveEntry);
+		if (entry->name().capacity() > sso_capacity)
+			total += entry->name().capacity() + 1;
+		total += entry->exProps().properties().size() * sizeof(PropertyList::Entry);
+	}
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Creates an (unopened) archive of the appropriate format for the file at
+// [filename], or a DirArchive if it is a directory.
+// Returns nullptr if the format is unsupported
+// -----------------------------------------------------------------------------
+shared_ptr<Archive> createArchive(string_view filename)
+{
+	if (fileutil::dirExists(filename))
+		return std::make_shared<DirArchive>();
+
+	string std_fn{ filename };
+	if (WadArchive::isWadArchive(std_fn))
+		return std::make_shared<WadArchive>();
+	else if (ZipArchive::isZipArchive(std_fn))
+		return std::make_shared<ZipArchive>();
+	else if (ResArchive::isResArchive(std_fn))
+		return std::make_shared<ResArchive>();
+	else if (DatArchive::isDatArchive(std_fn))
+		return std::make_shared<DatArchive>();
+	else if (LibArchive::isLibArchive(std_fn))
+		return std::make_shared<LibArchive>();
+	else if (PakArchive::isPakArchive(std_fn))
+		return std::make_shared<PakArchive>();
+	else if (BSPArchive::isBSPArchive(std_fn))
+		return std::make_shared<BSPArchive>();
+	else if (GrpArchive::isGrpArchive(std_fn))
+		return std::make_shared<GrpArchive>();
+	else if (RffArchive::isRffArchive(std_fn))
+		return std::make_shared<RffArchive>();
+	else if (GobArchive::isGobArchive(std_fn))
+		return std::make_shared<GobArchive>();
+	else if (LfdArchive::isLfdArchive(std_fn))
+		return std::make_shared<LfdArchive>();
+	else if (HogArchive::isHogArchive(std_fn))
+		return std::make_shared<HogArchive>();
+	else if (ADatArchive::isADatArchive(std_fn))
+		return std::make_shared<ADatArchive>();
+	else if (Wad2Archive::isWad2Archive(std_fn))
+		return std::make_shared<Wad2Archive>();
+	else if (WadJArchive::isWadJArchive(std_fn))
+		return std::make_shared<WadJArchive>();
+	else if (WolfArchive::isWolfArchive(std_fn))
+		return std::make_shared<WolfArchive>();
+	else if (GZipArchive::isGZipArchive(std_fn))
+		return std::make_shared<GZipArchive>();
+	else if (BZip2Archive::isBZip2Archive(std_fn))
+		return std::make_shared<BZip2Archive>();
+	else if (TarArchive::isTarArchive(std_fn))
+		return std::make_shared<TarArchive>();
+	else if (DiskArchive::isDiskArchive(std_fn))
+		return std::make_shared<DiskArchive>();
+	else if (PodArchive::isPodArchive(std_fn))
+		return std::make_shared<PodArchive>();
+	else if (ChasmBinArchive::isChasmBinArchive(std_fn))
+		return std::make_shared<ChasmBinArchive>();
+	else if (SiNArchive::isSiNArchive(std_fn))
+		return std::make_shared<SiNArchive>();
+
+	// Unsupported format
+	global::error = "Unsupported or invalid Archive format";
+	return nullptr;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveOpenTask Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the current progress message from opening the archive
+// -----------------------------------------------------------------------------
+string ArchiveOpenTask::progressMessage() const
+{
+	std::lock_guard lock(mutex_);
+	return progress_message_;
+}
 
 
 // -----------------------------------------------------------------------------
@@ -195,6 +351,9 @@ bool ArchiveManager::addArchive(shared_ptr<Archive> archive)
 		// Announce the addition
 		signals_.archive_added(open_archives_.size() - 1);
 
+		// Add to resource name index
+		addArchiveToResourceIndex(archive.get());
+
 		// Add to resource manager
 		app::resources().addArchive(archive.get());
 
@@ -270,6 +429,8 @@ shared_ptr<Archive> ArchiveManager::getArchive(ArchiveEntry* parent)
 // -----------------------------------------------------------------------------
 shared_ptr<Archive> ArchiveManager::openArchive(string_view filename, bool manage, bool silent)
 {
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Archive);
+
 	// Check for directory
 	if (fileutil::dirExists(filename))
 		return openDirArchive(filename, manage, silent);
@@ -289,59 +450,9 @@ shared_ptr<Archive> ArchiveManager::openArchive(string_view filename, bool manag
 	}
 
 	// Determine file format
-	string std_fn{ filename };
-	if (WadArchive::isWadArchive(std_fn))
-		new_archive = std::make_shared<WadArchive>();
-	else if (ZipArchive::isZipArchive(std_fn))
-		new_archive = std::make_shared<ZipArchive>();
-	else if (ResArchive::isResArchive(std_fn))
-		new_archive = std::make_shared<ResArchive>();
-	else if (DatArchive::isDatArchive(std_fn))
-		new_archive = std::make_shared<DatArchive>();
-	else if (LibArchive::isLibArchive(std_fn))
-		new_archive = std::make_shared<LibArchive>();
-	else if (PakArchive::isPakArchive(std_fn))
-		new_archive = std::make_shared<PakArchive>();
-	else if (BSPArchive::isBSPArchive(std_fn))
-		new_archive = std::make_shared<BSPArchive>();
-	else if (GrpArchive::isGrpArchive(std_fn))
-		new_archive = std::make_shared<GrpArchive>();
-	else if (RffArchive::isRffArchive(std_fn))
-		new_archive = std::make_shared<RffArchive>();
-	else if (GobArchive::isGobArchive(std_fn))
-		new_archive = std::make_shared<GobArchive>();
-	else if (LfdArchive::isLfdArchive(std_fn))
-		new_archive = std::make_shared<LfdArchive>();
-	else if (HogArchive::isHogArchive(std_fn))
-		new_archive = std::make_shared<HogArchive>();
-	else if (ADatArchive::isADatArchive(std_fn))
-		new_archive = std::make_shared<ADatArchive>();
-	else if (Wad2Archive::isWad2Archive(std_fn))
-		new_archive = std::make_shared<Wad2Archive>();
-	else if (WadJArchive::isWadJArchive(std_fn))
-		new_archive = std::make_shared<WadJArchive>();
-	else if (WolfArchive::isWolfArchive(std_fn))
-		new_archive = std::make_shared<WolfArchive>();
-	else if (GZipArchive::isGZipArchive(std_fn))
-		new_archive = std::make_shared<GZipArchive>();
-	else if (BZip2Archive::isBZip2Archive(std_fn))
-		new_archive = std::make_shared<BZip2Archive>();
-	else if (TarArchive::isTarArchive(std_fn))
-		new_archive = std::make_shared<TarArchive>();
-	else if (DiskArchive::isDiskArchive(std_fn))
-		new_archive = std::make_shared<DiskArchive>();
-	else if (PodArchive::isPodArchive(std_fn))
-		new_archive = std::make_shared<PodArchive>();
-	else if (ChasmBinArchive::isChasmBinArchive(std_fn))
-		new_archive = std::make_shared<ChasmBinArchive>();
-	else if (SiNArchive::isSiNArchive(std_fn))
-		new_archive = std::make_shared<SiNArchive>();
-	else
-	{
-		// Unsupported format
-		global::error = "Unsupported or invalid Archive format";
+	new_archive = createArchive(filename);
+	if (!new_archive)
 		return nullptr;
-	}
 
 	// If it opened successfully, add it to the list if needed & return it,
 	// Otherwise, delete it and return nullptr
@@ -380,6 +491,8 @@ shared_ptr<Archive> ArchiveManager::openArchive(ArchiveEntry* entry, bool manage
 	if (!entry)
 		return nullptr;
 
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Archive);
+
 	// Check if the entry is already opened
 	for (auto& open_archive : open_archives_)
 	{
@@ -487,6 +600,8 @@ shared_ptr<Archive> ArchiveManager::openArchive(ArchiveEntry* entry, bool manage
 // -----------------------------------------------------------------------------
 shared_ptr<Archive> ArchiveManager::openDirArchive(string_view dir, bool manage, bool silent)
 {
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Archive);
+
 	auto new_archive = getArchive(dir);
 
 	log::info("Opening directory {} as archive", dir);
@@ -531,6 +646,157 @@ shared_ptr<Archive> ArchiveManager::openDirArchive(string_view dir, bool manage,
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Opens the archive file (or directory) at [filename] on a background thread.
+// Progress is reported via the archive_open_progress signal, and the archive is
+// only added to the list once it has been fully opened, after which the
+// archive_open_finished signal is emitted (also if opening failed or was
+// cancelled). Multiple archives can be opened at the same time.
+// Returns a handle to the task, which can be used to check progress or cancel
+// opening
+// -----------------------------------------------------------------------------
+shared_ptr<ArchiveOpenTask> ArchiveManager::openArchiveAsync(string_view filename, bool silent)
+{
+	// Check if the archive is already being opened
+	for (const auto& task : open_tasks_)
+		if (strutil::Path::filePathsMatch(task->filename_, filename))
+			return task;
+
+	auto task = std::make_shared<ArchiveOpenTask>(filename, silent);
+	open_tasks_.push_back(task);
+
+	// If the archive is already open, just finish with it
+	if (getArchive(filename))
+	{
+		wxTheApp->CallAfter([this, task] { finishAsyncOpen(task); });
+		return task;
+	}
+
+	log::info("Opening archive {} in the background", filename);
+
+	task->thread_ = std::thread([this, task] {
+		// Pass progress updates from opening the archive to the task (and on to
+		// the main thread via the archive_open_progress signal)
+		ui::setThreadProgressHandler([this, task](float progress, string_view message) {
+			task->progress_ = progress;
+			{
+				std::lock_guard lock(task->mutex_);
+				if (task->progress_message_ != message)
+					task->progress_message_ = message;
+			}
+
+			if (!task->progress_pending_.exchange(true))
+				wxTheApp->CallAfter([this, task] {
+					task->progress_pending_ = false;
+					if (!task->isFinished())
+						signals_.archive_open_progress(*task);
+				});
+
+			return !task->cancelled_;
+		});
+
+		// Open the archive
+		shared_ptr<Archive> archive;
+		try
+		{
+			archive = createArchive(task->filename_);
+			if (archive && !archive->open(task->filename_))
+				archive.reset();
+		}
+		catch (const ui::TaskCancelled&)
+		{
+			archive.reset();
+		}
+
+		ui::setThreadProgressHandler(nullptr);
+
+		{
+			std::lock_guard lock(task->mutex_);
+			task->opened_archive_ = archive;
+			if (!archive)
+				task->error_ = global::error;
+		}
+
+		// Add the opened archive on the main thread
+		wxTheApp->CallAfter([this, task] { finishAsyncOpen(task); });
+	});
+
+	return task;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels all archives currently being opened in the background and waits for
+// their threads to finish
+// -----------------------------------------------------------------------------
+void ArchiveManager::cancelAsyncOpens()
+{
+	auto tasks = std::move(open_tasks_);
+	open_tasks_.clear();
+
+	for (const auto& task : tasks)
+	{
+		task->cancel();
+		if (task->thread_.joinable())
+			task->thread_.join();
+		task->opened_archive_.reset();
+		task->status_ = ArchiveOpenTask::Status::Cancelled;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Called on the main thread when the background open [task] is done. Adds the
+// opened archive to the list (if it was opened successfully and not cancelled)
+// -----------------------------------------------------------------------------
+void ArchiveManager::finishAsyncOpen(const shared_ptr<ArchiveOpenTask>& task)
+{
+	// Ignore if the task was already cancelled via cancelAsyncOpens
+	const auto i = std::find(open_tasks_.begin(), open_tasks_.end(), task);
+	if (i == open_tasks_.end())
+		return;
+	open_tasks_.erase(i);
+
+	if (task->thread_.joinable())
+		task->thread_.join();
+
+	auto existing = getArchive(task->filename_);
+	auto archive  = std::move(task->opened_archive_);
+	if (task->cancelled_)
+	{
+		log::info("Cancelled opening {}", task->filename_);
+		task->status_ = ArchiveOpenTask::Status::Cancelled;
+	}
+	else if (existing)
+	{
+		// Already open (possibly opened again while this task was running)
+		task->archive_ = existing;
+		task->status_  = ArchiveOpenTask::Status::Opened;
+		if (!task->silent_)
+			signals_.archive_opened(archiveIndex(existing.get()));
+	}
+	else if (archive)
+	{
+		// Add the archive
+		auto index = open_archives_.size();
+		addArchive(archive);
+		task->archive_ = archive;
+		task->status_  = ArchiveOpenTask::Status::Opened;
+
+		// Announce open
+		if (!task->silent_)
+			signals_.archive_opened(index);
+
+		// Add to recent files
+		addRecentFile(task->filename_);
+	}
+	else
+	{
+		log::error(task->error_);
+		task->status_ = ArchiveOpenTask::Status::Failed;
+	}
+
+	signals_.archive_open_finished(*task);
+}
+
 // -----------------------------------------------------------------------------
 // Creates a new archive of the specified format and adds it to the list of open
 // archives. Returns the created archive, or nullptr if an invalid archive type
@@ -582,8 +848,9 @@ bool ArchiveManager::closeArchive(int index)
 	// Delete any bookmarked entries contained in the archive
 	deleteBookmarksInArchive(open_archives_[index].archive.get());
 
-	// Remove from resource manager
+	// Remove from resource manager and name index
 	app::resources().removeArchive(open_archives_[index].archive.get());
+	removeArchiveFromResourceIndex(open_archives_[index].archive.get());
 
 	// Close any open child archives
 	// Clear out the open_children vector first, lest the children try to remove themselves from it
@@ -630,6 +897,11 @@ bool ArchiveManager::closeArchive(int index)
 	// Announce closed
 	signals_.archive_closed(index);
 
+	// Release any prefetched or deduplicated entry data the closed archive was
+	// using
+	entryprefetch::clear();
+	entrydatastore::purge();
+
 	return true;
 }
 
@@ -800,6 +1072,70 @@ vector<shared_ptr<Archive>> ArchiveManager::allArchives(bool resource_only)
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+// Unloads the least recently used entry data in all open archives until the
+// total size of loaded entry data is within the archive_data_budget cvar.
+// Only unmodified, unlocked entries (which can be reloaded from the archive
+// when needed) whose data isn't shared with anything else are unloaded.
+// Nothing is unloaded while any background work is running, since it may be
+// using entry data (eg. map checks, texture decoding, opening archives).
+// Returns the number of entries unloaded
+// -----------------------------------------------------------------------------
+unsigned ArchiveManager::enforceDataBudget()
+{
+	if (archive_data_budget <= 0)
+		return 0;
+
+	// Wait until background work is done
+	if (!open_tasks_.empty() || threadpool::numBusy() > 0 || jobs::numActive() > 0)
+		return 0;
+
+	// Get all loaded entries
+	vector<ArchiveEntry*> entries;
+	uint64_t              total = 0;
+	for (const auto& oa : open_archives_)
+		total += loadedDataSize(*oa.archive, &entries);
+	if (base_resource_archive_)
+		total += loadedDataSize(*base_resource_archive_, &entries);
+
+	const auto budget = static_cast<uint64_t>(archive_data_budget) * 1024 * 1024;
+	if (total <= budget)
+		return 0;
+
+	// Unload least recently used entries first
+	std::sort(entries.begin(), entries.end(), [](ArchiveEntry* left, ArchiveEntry* right) {
+		return left->lastAccess() < right->lastAccess();
+	});
+	unsigned n_unloaded = 0;
+	for (auto entry : entries)
+	{
+		if (total <= budget)
+			break;
+		if (entry->state() != ArchiveEntry::State::Unmodified || entry->isLocked())
+			continue;
+
+		// Unloading data that is still shared frees nothing, and it may be in use
+		if (entry->isDataShared())
+			continue;
+
+		const auto size = entry->size();
+		entry->unloadData();
+		if (!entry->isLoaded())
+		{
+			total -= size;
+			n_unloaded++;
+		}
+	}
+
+	if (n_unloaded > 0)
+	{
+		entrydatastore::purge();
+		log::info(2, "Unloaded data for {} entries to stay within memory budget", n_unloaded);
+	}
+
+	return n_unloaded;
+}
+
 // -----------------------------------------------------------------------------
 // Returns a shared_ptr to the given [archive], or nullptr if it isn't open in
 // the archive manager
@@ -890,6 +1226,7 @@ bool ArchiveManager::openBaseResource(int index)
 	if (base_resource_archive_)
 	{
 		app::resources().removeArchive(base_resource_archive_.get());
+		removeArchiveFromResourceIndex(base_resource_archive_.get());
 		base_resource_archive_ = nullptr;
 	}
 
@@ -917,6 +1254,7 @@ bool ArchiveManager::openBaseResource(int index)
 		base_resource = index;
 		ui::hideSplash();
 		app::resources().addArchive(base_resource_archive_.get());
+		addArchiveToResourceIndex(base_resource_archive_.get());
 		signals_.base_res_current_changed(index);
 		return true;
 	}
@@ -932,28 +1270,43 @@ bool ArchiveManager::openBaseResource(int index)
 // -----------------------------------------------------------------------------
 ArchiveEntry* ArchiveManager::getResourceEntry(string_view name, Archive* ignore)
 {
-	// Go through all open archives
-	for (auto& open_archive : open_archives_)
+	if (name.empty())
+		return nullptr;
+
+	const auto upper_name = strutil::upper(name);
+	const auto i          = resource_index_.find(upper_name.substr(0, upper_name.find('.')));
+	if (i == resource_index_.end())
+		return nullptr;
+
+	// Go through indexed entries with the name (in archive priority order),
+	// looking for the first matching entry in the root dir of the first
+	// resource archive containing one
+	Archive*      found_archive = nullptr;
+	ArchiveEntry* found_entry   = nullptr;
+	for (const auto& res : i->second)
 	{
-		// If it isn't a resource archive, skip it
-		if (!open_archive.resource)
+		if (found_archive && res.archive != found_archive)
+			break;
+
+		// Check the entry is still valid and a resource
+		auto entry = res.entry.lock();
+		if (!entry || entry->parent() != res.archive || !resourceSearchable(res.archive, ignore))
 			continue;
 
-		// If it's being ignored, skip it
-		if (open_archive.archive.get() == ignore)
+		// Check it's a full name match in the root dir
+		auto root = res.archive->rootDir().get();
+		if (entry->parentDir() != root || entry->upperName() != upper_name)
 			continue;
 
-		// Try to find the entry in the archive
-		auto entry = open_archive.archive->entry(name);
-		if (entry)
-			return entry;
+		// Use the first one in the dir if there are multiple matches
+		if (!found_entry || root->entryIndex(entry.get()) < root->entryIndex(found_entry))
+		{
+			found_archive = res.archive;
+			found_entry   = entry.get();
+		}
 	}
 
-	// If entry isn't found yet, search the base resource archive
-	if (base_resource_archive_)
-		return base_resource_archive_->entry(name);
-
-	return nullptr;
+	return found_entry;
 }
 
 // -----------------------------------------------------------------------------
@@ -961,6 +1314,10 @@ ArchiveEntry* ArchiveManager::getResourceEntry(string_view name, Archive* ignore
 // -----------------------------------------------------------------------------
 ArchiveEntry* ArchiveManager::findResourceEntry(Archive::SearchOptions& options, Archive* ignore)
 {
+	// If searching for a specific name, only archives with an entry of that
+	// name in the resource index need to be searched
+	const auto name_noext = indexSearchName(options);
+
 	// Go through all open archives
 	for (auto& open_archive : open_archives_)
 	{
@@ -972,6 +1329,10 @@ ArchiveEntry* ArchiveManager::findResourceEntry(Archive::SearchOptions& options,
 		if (open_archive.archive.get() == ignore)
 			continue;
 
+		// If it has no entries with the name, skip it
+		if (name_noext && !resourceIndexHasName(open_archive.archive.get(), *name_noext))
+			continue;
+
 		// Try to find the entry in the archive
 		auto entry = open_archive.archive->findLast(options);
 		if (entry)
@@ -979,7 +1340,7 @@ ArchiveEntry* ArchiveManager::findResourceEntry(Archive::SearchOptions& options,
 	}
 
 	// If entry isn't found yet, search the base resource archive
-	if (base_resource_archive_)
+	if (base_resource_archive_ && (!name_noext || resourceIndexHasName(base_resource_archive_.get(), *name_noext)))
 		return base_resource_archive_->findLast(options);
 
 	return nullptr;
@@ -992,8 +1353,12 @@ vector<ArchiveEntry*> ArchiveManager::findAllResourceEntries(Archive::SearchOpti
 {
 	vector<ArchiveEntry*> ret;
 
+	// If searching for a specific name, only archives with an entry of that
+	// name in the resource index need to be searched
+	const auto name_noext = indexSearchName(options);
+
 	// Search the base resource archive first
-	if (base_resource_archive_)
+	if (base_resource_archive_ && (!name_noext || resourceIndexHasName(base_resource_archive_.get(), *name_noext)))
 	{
 		auto vec = base_resource_archive_->findAll(options);
 		ret.insert(ret.end(), vec.begin(), vec.end());
@@ -1010,6 +1375,10 @@ vector<ArchiveEntry*> ArchiveManager::findAllResourceEntries(Archive::SearchOpti
 		if (open_archive.archive.get() == ignore)
 			continue;
 
+		// If it has no entries with the name, skip it
+		if (name_noext && !resourceIndexHasName(open_archive.archive.get(), *name_noext))
+			continue;
+
 		// Add matching entries from this archive
 		auto vec = open_archive.archive->findAll(options);
 		ret.insert(ret.end(), vec.begin(), vec.end());
@@ -1018,6 +1387,158 @@ vector<ArchiveEntry*> ArchiveManager::findAllResourceEntries(Archive::SearchOpti
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the search priority of [archive] for resources (lower is searched
+// first), or -1 if it isn't an open or base resource archive
+// -----------------------------------------------------------------------------
+int ArchiveManager::resourcePriority(Archive* archive)
+{
+	if (archive && archive == base_resource_archive_.get())
+		return static_cast<int>(open_archives_.size());
+
+	return archiveIndex(archive);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if resources in [archive] should be included in resource
+// searches ignoring [ignore]
+// -----------------------------------------------------------------------------
+bool ArchiveManager::resourceSearchable(Archive* archive, Archive* ignore)
+{
+	// The base resource archive is always searched
+	if (archive == base_resource_archive_.get())
+		return true;
+
+	if (archive == ignore)
+		return false;
+
+	return archiveIsResource(archive);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all entries in [archive] to the resource name index and keeps them
+// updated when the archive is modified
+// -----------------------------------------------------------------------------
+void ArchiveManager::addArchiveToResourceIndex(Archive* archive)
+{
+	vector<shared_ptr<ArchiveEntry>> entries;
+	archive->putEntryTreeAsList(entries);
+	for (const auto& entry : entries)
+		addToResourceIndex(archive, entry);
+
+	// Update index when entries are added/removed/renamed, until the archive is
+	// removed from the index
+	auto& connections = resource_index_connections_[archive];
+	connections.connections.clear();
+	connections += archive->signals().entry_added.connect([this](Archive& archive, ArchiveEntry& entry) {
+		if (resourcePriority(&archive) >= 0)
+			addToResourceIndex(&archive, entry.getShared());
+	});
+	connections += archive->signals().entry_removed.connect([this](Archive& archive, ArchiveDir&, ArchiveEntry& entry) {
+		removeFromResourceIndex(&archive, &entry, entry.upperName());
+	});
+	connections += archive->signals().entry_renamed.connect(
+		[this](Archive& archive, ArchiveEntry& entry, string_view prev_name) {
+			removeFromResourceIndex(&archive, &entry, strutil::upper(prev_name));
+			if (resourcePriority(&archive) >= 0)
+				addToResourceIndex(&archive, entry.getShared());
+		});
+	connections += archive->signals().dir_removed.connect([this](Archive& archive, ArchiveDir&, ArchiveDir& dir) {
+		vector<shared_ptr<ArchiveEntry>> removed;
+		archive.putEntryTreeAsList(removed, &dir);
+		for (const auto& entry : removed)
+			removeFromResourceIndex(&archive, entry.get(), entry->upperName());
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Removes all entries in [archive] from the resource name index and stops
+// updating it for the archive
+// -----------------------------------------------------------------------------
+void ArchiveManager::removeArchiveFromResourceIndex(Archive* archive)
+{
+	resource_index_connections_.erase(archive);
+
+	for (auto i = resource_index_.begin(); i != resource_index_.end();)
+	{
+		auto& list = i->second;
+		list.erase(
+			std::remove_if(
+				list.begin(),
+				list.end(),
+				[archive](const IndexedResource& res) { return res.archive == archive || res.entry.expired(); }),
+			list.end());
+
+		if (list.empty())
+			i = resource_index_.erase(i);
+		else
+			++i;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds [entry] in [archive] to the resource name index. Entries with the same
+// name are kept in archive priority order
+// -----------------------------------------------------------------------------
+void ArchiveManager::addToResourceIndex(Archive* archive, const shared_ptr<ArchiveEntry>& entry)
+{
+	if (!entry)
+		return;
+
+	auto&      list     = resource_index_[string{ entry->upperNameNoExt() }];
+	const auto priority = resourcePriority(archive);
+
+	// Insert after any entries from archives with the same or higher priority
+	auto pos = list.end();
+	while (pos != list.begin() && std::prev(pos)->archive != archive
+		   && resourcePriority(std::prev(pos)->archive) > priority)
+		--pos;
+
+	list.insert(pos, { archive, entry });
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] in [archive] from the resource name index, where it was
+// added with [upper_name]
+// -----------------------------------------------------------------------------
+void ArchiveManager::removeFromResourceIndex(Archive* archive, ArchiveEntry* entry, string_view upper_name)
+{
+	const auto i = resource_index_.find(string{ upper_name.substr(0, upper_name.find('.')) });
+	if (i == resource_index_.end())
+		return;
+
+	auto& list = i->second;
+	list.erase(
+		std::remove_if(
+			list.begin(),
+			list.end(),
+			[archive, entry](const IndexedResource& res) {
+				auto res_entry = res.entry.lock();
+				return !res_entry || (res.archive == archive && res_entry.get() == entry);
+			}),
+		list.end());
+
+	if (list.empty())
+		resource_index_.erase(i);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [archive] has any entries named [name_noext] (uppercase,
+// without extension) in the resource name index
+// -----------------------------------------------------------------------------
+bool ArchiveManager::resourceIndexHasName(Archive* archive, const string& name_noext)
+{
+	const auto i = resource_index_.find(name_noext);
+	if (i == resource_index_.end())
+		return false;
+
+	for (const auto& res : i->second)
+		if (res.archive == archive && !res.entry.expired())
+			return true;
+
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the recent file path at [index]
 // -----------------------------------------------------------------------------
@@ -1320,6 +1841,51 @@ CONSOLE_COMMAND(list_archives, 0, true)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Lists the amount of loaded entry data in each open archive, and the memory
+// used by the entries themselves (excluding data)
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(entry_data_usage, 0, true)
+{
+	vector<Archive*> archives;
+	for (const auto& archive : app::archiveManager().allArchives())
+		archives.push_back(archive.get());
+	if (app::archiveManager().baseResourceArchive())
+		archives.push_back(app::archiveManager().baseResourceArchive());
+
+	uint64_t total          = 0;
+	uint64_t total_overhead = 0;
+	unsigned total_entries  = 0;
+	for (auto archive : archives)
+	{
+		vector<ArchiveEntry*> entries;
+		const auto            size = loadedDataSize(*archive, &entries);
+		total += size;
+
+		unsigned   num_entries = 0;
+		const auto overhead    = entryOverheadSize(*archive, num_entries);
+		total_overhead += overhead;
+		total_entries += num_entries;
+
+		log::console(fmt::format(
+			"{}: {} entries loaded ({:1.2f}mb), {} entries total ({:1.2f}mb overhead, {} bytes/entry)",
+			archive->filename(false),
+			entries.size(),
+			size / 1048576.0,
+			num_entries,
+			overhead / 1048576.0,
+			num_entries > 0 ? overhead / num_entries : 0));
+	}
+
+	log::console(fmt::format(
+		"Total: {:1.2f}mb data, {:1.2f}mb entry overhead ({} entries)",
+		total / 1048576.0,
+		total_overhead / 1048576.0,
+		total_entries));
+	if (archive_data_budget > 0)
+		log::console(fmt::format("Budget: {}mb", *archive_data_budget));
+}
+
 // -----------------------------------------------------------------------------
 // Attempts to open each given argument (filenames)
 // -----------------------------------------------------------------------------
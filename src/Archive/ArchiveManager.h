@@ -1,9 +1,56 @@
 #pragma once
 
 #include "Archive.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace slade
 {
+// Handle to an archive being opened in the background, returned by
+// ArchiveManager::openArchiveAsync
+class ArchiveOpenTask
+{
+public:
+	enum class Status
+	{
+		Opening,
+		Opened,
+		Failed,
+		Cancelled
+	};
+
+	ArchiveOpenTask(string_view filename, bool silent) : filename_{ filename }, silent_{ silent } {}
+	~ArchiveOpenTask() = default;
+
+	const string&       filename() const { return filename_; }
+	Status              status() const { return status_; }
+	bool                isFinished() const { return status_ != Status::Opening; }
+	float               progress() const { return progress_; }
+	string              progressMessage() const;
+	const string&       error() const { return error_; }
+	shared_ptr<Archive> archive() const { return archive_; }
+
+	void cancel() { cancelled_ = true; }
+
+private:
+	string              filename_;
+	bool                silent_;
+	std::atomic<Status> status_{ Status::Opening };
+	std::atomic<float>  progress_{ 0.0f };
+	std::atomic<bool>   cancelled_{ false };
+	std::atomic<bool>   progress_pending_{ false };
+	mutable std::mutex  mutex_;
+	string              progress_message_;
+	string              error_;
+	shared_ptr<Archive> opened_archive_; // Set by the worker thread when done
+	shared_ptr<Archive> archive_;        // Set once the archive is added to the ArchiveManager
+	std::thread         thread_;
+
+	friend class ArchiveManager;
+};
+
 class ArchiveManager
 {
 public:
@@ -21,6 +68,8 @@ public:
 	shared_ptr<Archive>         openArchive(string_view filename, bool manage = true, bool silent = false);
 	shared_ptr<Archive>         openArchive(ArchiveEntry* entry, bool manage = true, bool silent = false);
 	shared_ptr<Archive>         openDirArchive(string_view dir, bool manage = true, bool silent = false);
+	shared_ptr<ArchiveOpenTask> openArchiveAsync(string_view filename, bool silent = false);
+	void                        cancelAsyncOpens();
 	shared_ptr<Archive>         newArchive(string_view format);
 	bool                        closeArchive(int index);
 	bool                        closeArchive(string_view filename);
@@ -35,6 +84,7 @@ public:
 	void                        setArchiveResource(Archive* archive, bool resource = true);
 	vector<shared_ptr<Archive>> allArchives(bool resource_only = false);
 	shared_ptr<Archive>         shareArchive(Archive* archive);
+	unsigned                    enforceDataBudget();
 
 	// General access
 	const vector<string>&                 recentFiles() const { return recent_files_; }
@@ -88,6 +138,8 @@ public:
 		sigslot::signal<>                             recent_files_changed;
 		sigslot::signal<ArchiveEntry*>                bookmark_added;
 		sigslot::signal<const vector<ArchiveEntry*>&> bookmarks_removed;
+		sigslot::signal<const ArchiveOpenTask&>       archive_open_progress;
+		sigslot::signal<const ArchiveOpenTask&>       archive_open_finished;
 	};
 	Signals& signals() { return signals_; }
 
@@ -107,10 +159,33 @@ private:
 	vector<string>                 recent_files_;
 	vector<weak_ptr<ArchiveEntry>> bookmarks_;
 
+	// Archives currently being opened asynchronously
+	vector<shared_ptr<ArchiveOpenTask>> open_tasks_;
+
+	// Resource name index (uppercase name without extension -> entries, in
+	// archive priority order)
+	struct IndexedResource
+	{
+		Archive*               archive;
+		weak_ptr<ArchiveEntry> entry;
+	};
+	std::unordered_map<string, vector<IndexedResource>> resource_index_;
+	std::unordered_map<Archive*, ScopedConnectionList>  resource_index_connections_; // Per indexed archive
+
 	// Signals
 	Signals signals_;
 
 	bool initArchiveFormats() const;
 	void getDependentArchivesInternal(Archive* archive, vector<shared_ptr<Archive>>& vec);
+	void finishAsyncOpen(const shared_ptr<ArchiveOpenTask>& task);
+
+	// Resource name index
+	int  resourcePriority(Archive* archive);
+	bool resourceSearchable(Archive* archive, Archive* ignore);
+	void addArchiveToResourceIndex(Archive* archive);
+	void removeArchiveFromResourceIndex(Archive* archive);
+	void addToResourceIndex(Archive* archive, const shared_ptr<ArchiveEntry>& entry);
+	void removeFromResourceIndex(Archive* archive, ArchiveEntry* entry, string_view upper_name);
+	bool resourceIndexHasName(Archive* archive, const string& name_noext);
 };
 } // namespace slade
@@ -0,0 +1,225 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryDataStore.cpp
+// Description: A content-addressed store of loaded entry data, keyed by size
+//              and hash. Identical unmodified entry data loaded in any open
+//              archive shares a single (copy-on-write) buffer
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryDataStore.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "General/Console.h"
+#include <mutex>
+#include <unordered_set>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, archive_dedup_data, false, CVar::Flag::Save)
+namespace slade::entrydatastore
+{
+constexpr uint32_t min_size        = 64;   // Smaller data isn't worth hashing
+constexpr size_t   min_purge_count = 1024; // Don't check for unused data until this many buffers are stored
+
+std::map<std::pair<uint32_t, uint64_t>, vector<MemChunk>> stored;      // Keyed by size+hash
+std::unordered_set<const uint8_t*>                         stored_data; // Data of all stored buffers
+std::mutex                                                 stored_mutex;
+size_t                                                     num_stored = 0;
+size_t                                                     purge_at   = min_purge_count;
+} // namespace slade::entrydatastore
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryDataStore Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace slade::entrydatastore
+{
+// -----------------------------------------------------------------------------
+// Removes all stored buffers that are no longer used by anything other than
+// the store. Must be called with [stored_mutex] locked
+// -----------------------------------------------------------------------------
+void removeUnused()
+{
+	for (auto i = stored.begin(); i != stored.end();)
+	{
+		auto& chunks = i->second;
+		for (unsigned a = 0; a < chunks.size();)
+		{
+			if (chunks[a].isShared())
+				a++;
+			else
+			{
+				stored_data.erase(std::as_const(chunks[a]).data());
+				chunks.erase(chunks.begin() + a);
+				num_stored--;
+			}
+		}
+
+		if (chunks.empty())
+			i = stored.erase(i);
+		else
+			++i;
+	}
+
+	purge_at = std::max(min_purge_count, num_stored * 2);
+}
+} // namespace slade::entrydatastore
+
+// -----------------------------------------------------------------------------
+// Makes [data] (freshly loaded, unmodified entry data) share its buffer with
+// any identical data already in the store, or adds it to the store if there is
+// none. Does nothing if deduplication is disabled, or [data] is too small or
+// mapped from a file.
+// Returns true if [data] now shares a buffer that was already stored
+// -----------------------------------------------------------------------------
+bool entrydatastore::share(MemChunk& data)
+{
+	if (!archive_dedup_data || data.size() < min_size || data.isMapped())
+		return false;
+
+	const auto      key = std::make_pair(data.size(), data.hash());
+	std::lock_guard lock(stored_mutex);
+
+	// Check for identical stored data (compared in full in case of a hash
+	// collision)
+	auto& chunks = stored[key];
+	for (const auto& chunk : chunks)
+	{
+		if (chunk.sharesData(data))
+			return true;
+
+		if (memcmp(chunk.data(), std::as_const(data).data(), data.size()) == 0)
+		{
+			data.importMem(chunk);
+			return true;
+		}
+	}
+
+	// Not stored yet, add it
+	stored_data.insert(std::as_const(chunks.emplace_back(data)).data());
+	if (++num_stored >= purge_at)
+		removeUnused();
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [data] shares a buffer held by the store
+// -----------------------------------------------------------------------------
+bool entrydatastore::isStored(const MemChunk& data)
+{
+	if (!data.isShared())
+		return false;
+
+	std::lock_guard lock(stored_mutex);
+	return stored_data.count(data.data()) > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all stored data that is no longer used by any entry
+// -----------------------------------------------------------------------------
+void entrydatastore::purge()
+{
+	std::lock_guard lock(stored_mutex);
+	removeUnused();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Lists how much loaded entry data is shared via the store for each open
+// archive, and the total memory saved
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(entry_data_store, 0, true)
+{
+	if (!archive_dedup_data)
+		log::console("Entry data deduplication is disabled (archive_dedup_data)");
+
+	// Get use count of each stored buffer
+	std::unordered_map<const uint8_t*, long> share_counts;
+	uint64_t                                 saved = 0;
+	{
+		std::lock_guard lock(entrydatastore::stored_mutex);
+		entrydatastore::removeUnused();
+		for (const auto& [key, chunks] : entrydatastore::stored)
+			for (const auto& chunk : chunks)
+			{
+				// Don't count the store's own reference
+				const auto users           = chunk.shareCount() - 1;
+				share_counts[chunk.data()] = users;
+				if (users > 1)
+					saved += static_cast<uint64_t>(users - 1) * chunk.size();
+			}
+
+		log::console(fmt::format("{} buffers stored", entrydatastore::num_stored));
+	}
+
+	// List shared data for each open archive
+	auto& manager = app::archiveManager();
+	for (int a = 0; a < manager.numArchives(); a++)
+	{
+		auto archive = manager.getArchive(a);
+
+		vector<ArchiveEntry*> entries;
+		archive->putEntryTreeAsList(entries);
+		unsigned n_shared     = 0;
+		uint64_t shared_bytes = 0;
+		for (auto entry : entries)
+		{
+			if (!entry->isLoaded())
+				continue;
+
+			const auto i = share_counts.find(std::as_const(entry->data(false)).data());
+			if (i != share_counts.end() && i->second > 1)
+			{
+				n_shared++;
+				shared_bytes += entry->size();
+			}
+		}
+
+		log::console(fmt::format(
+			"{}: {} entries ({:1.2f}mb) sharing data", archive->filename(false), n_shared, shared_bytes / 1048576.0));
+	}
+
+	log::console(fmt::format("Total memory saved: {:1.2f}mb", saved / 1048576.0));
+}
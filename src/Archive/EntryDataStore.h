@@ -0,0 +1,13 @@
+#pragma once
+
+namespace slade
+{
+class MemChunk;
+
+namespace entrydatastore
+{
+	bool share(MemChunk& data);
+	bool isStored(const MemChunk& data);
+	void purge();
+} // namespace entrydatastore
+} // namespace slade
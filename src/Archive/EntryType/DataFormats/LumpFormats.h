@@ -6,7 +6,7 @@ public:
 	TextureXDataFormat() : EntryDataFormat("texturex"){};
 	~TextureXDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() < 4)
@@ -29,7 +29,7 @@ public:
 	PNamesDataFormat() : EntryDataFormat("pnames"){};
 	~PNamesDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// It's a pretty simple format alright
 		uint32_t number = mc.readL32(0);
@@ -47,7 +47,7 @@ public:
 	BoomAnimatedDataFormat() : EntryDataFormat("animated"){};
 	~BoomAnimatedDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() > sizeof(AnimatedEntry))
 		{
@@ -71,7 +71,7 @@ public:
 	BoomSwitchesDataFormat() : EntryDataFormat("switches"){};
 	~BoomSwitchesDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() > sizeof(SwitchesEntry))
 		{
@@ -91,7 +91,7 @@ public:
 	ZNodesDataFormat() : EntryDataFormat("znod"){};
 	~ZNodesDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -110,7 +110,7 @@ public:
 	ZGLNodesDataFormat() : EntryDataFormat("zgln"){};
 	~ZGLNodesDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -129,7 +129,7 @@ public:
 	ZGLNodes2DataFormat() : EntryDataFormat("zgl2"){};
 	~ZGLNodes2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -148,7 +148,7 @@ public:
 	XNodesDataFormat() : EntryDataFormat("xnod"){};
 	~XNodesDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -167,7 +167,7 @@ public:
 	XGLNodesDataFormat() : EntryDataFormat("xgln"){};
 	~XGLNodesDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -186,7 +186,7 @@ public:
 	XGLNodes2DataFormat() : EntryDataFormat("xgl2"){};
 	~XGLNodes2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -205,7 +205,7 @@ public:
 	ACS0DataFormat() : EntryDataFormat("acs0"){};
 	~ACS0DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 15)
@@ -234,7 +234,7 @@ public:
 	ACSeDataFormat() : EntryDataFormat("acsl"){};
 	~ACSeDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -271,7 +271,7 @@ public:
 	ACSEDataFormat() : EntryDataFormat("acse"){};
 	~ACSEDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 32)
@@ -35,10 +35,16 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "General/Console.h"
+#include "General/Profiler.h"
+#include "General/ThreadPool.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <map>
+#include <mutex>
 
 using namespace slade;
 
@@ -58,7 +64,48 @@ EntryType* etype_unknown = nullptr; // The default, 'unknown' entry type
 EntryType* etype_folder  = nullptr; // Folder entry type
 EntryType* etype_marker  = nullptr; // Marker entry type
 EntryType* etype_map     = nullptr; // Map marker type
+
+// Type detection index. Detectable types are split up by archive format and by
+// required extension, so each entry only needs to be checked against the types
+// that could possibly match it
+struct DetectIndex
+{
+	vector<EntryType*>                                any_ext; // Types that don't require a specific extension
+	std::map<string, vector<EntryType*>, std::less<>> by_ext;  // Types that require a specific extension
+};
+
+// Per-type detection stats (see type_stats console command)
+struct DetectStats
+{
+	std::atomic<uint64_t> checks{ 0 };
+	std::atomic<uint64_t> matches{ 0 };
+	std::atomic<uint64_t> time_ns{ 0 };
+};
+
+// The detection index and stats for the current entry types. This is never
+// modified once built, a new one is built and swapped in when the types change
+// so detection already running on other threads can keep using the old one
+struct DetectData
+{
+	std::map<string, DetectIndex, std::less<>> index; // Keyed by archive entry format ("" for any other)
+	unique_ptr<DetectStats[]>                  stats;
+	size_t                                     n_stats = 0;
+};
+shared_ptr<const DetectData> detect_data;
+std::atomic<bool>            detect_index_valid = false;
+std::mutex                   detect_index_mutex;
+
+// -----------------------------------------------------------------------------
+// Returns the current type detection index and stats (can be null if the index
+// hasn't been built yet)
+// -----------------------------------------------------------------------------
+shared_ptr<const DetectData> detectData()
+{
+	std::lock_guard lock(detect_index_mutex);
+	return detect_data;
+}
 } // namespace
+CVAR(Bool, etype_detect_stats, false, CVar::Flag::Secret)
 
 
 // -----------------------------------------------------------------------------
@@ -182,27 +229,6 @@ int EntryType::isThisType(ArchiveEntry& entry)
 			return EntryDataFormat::MATCH_FALSE;
 	}
 
-	// Check for data format match if needed
-	int r = EntryDataFormat::MATCH_TRUE;
-	if (format_ == EntryDataFormat::textFormat())
-	{
-		// Hack for identifying ACS script sources despite DB2 apparently appending
-		// two null bytes to them, which make the memchr test fail.
-		size_t end = entry.size() - 1;
-		if (end > 3)
-			end -= 2;
-		// Text is a special case, as other data formats can sometimes be detected as 'text',
-		// we'll only check for it if text data is specified in the entry type
-		if (entry.size() > 0 && memchr(entry.rawData(), 0, end) != nullptr)
-			return EntryDataFormat::MATCH_FALSE;
-	}
-	else if (format_ != EntryDataFormat::anyFormat() && entry.size() > 0)
-	{
-		r = format_->isThisFormat(entry.data());
-		if (r == EntryDataFormat::MATCH_FALSE)
-			return EntryDataFormat::MATCH_FALSE;
-	}
-
 	// Check for size multiple match if needed
 	if (!size_multiple_.empty())
 	{
@@ -231,9 +257,10 @@ int EntryType::isThisType(ArchiveEntry& entry)
 	// Entry name related stuff
 	if (!match_name_.empty() || !match_extension_.empty())
 	{
-		// Get entry name (lowercase), find extension separator
-		const string_view fn      = entry.upperName();
-		const size_t      ext_sep = fn.find_last_of('.');
+		// Get entry name (uppercase), find extension separator
+		const auto        upper_name = entry.upperName();
+		const string_view fn         = upper_name;
+		const size_t      ext_sep    = fn.find_last_of('.');
 
 		// Check for name match if needed
 		if (!match_name_.empty())
@@ -280,6 +307,28 @@ int EntryType::isThisType(ArchiveEntry& entry)
 		}
 	}
 
+	// Check for data format match if needed (done last since it's the most
+	// expensive check)
+	int r = EntryDataFormat::MATCH_TRUE;
+	if (format_ == EntryDataFormat::textFormat())
+	{
+		// Hack for identifying ACS script sources despite DB2 apparently appending
+		// two null bytes to them, which make the memchr test fail.
+		size_t end = entry.size() - 1;
+		if (end > 3)
+			end -= 2;
+		// Text is a special case, as other data formats can sometimes be detected as 'text',
+		// we'll only check for it if text data is specified in the entry type
+		if (entry.size() > 0 && memchr(entry.rawData(), 0, end) != nullptr)
+			return EntryDataFormat::MATCH_FALSE;
+	}
+	else if (format_ != EntryDataFormat::anyFormat() && entry.size() > 0)
+	{
+		r = format_->isThisFormat(entry.data());
+		if (r == EntryDataFormat::MATCH_FALSE)
+			return EntryDataFormat::MATCH_FALSE;
+	}
+
 	// Check for entry section match if needed
 	if (!section_.empty())
 	{
@@ -348,6 +397,8 @@ void slade::EntryType::initTypes()
 	etype_map           = et_map.get();
 	etype_map->index_   = static_cast<int>(entry_types.size());
 	entry_types.push_back(std::move(et_map));
+
+	detect_index_valid = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -518,6 +569,9 @@ bool EntryType::readEntryTypeDefinition(MemChunk& mc, string_view source)
 		entry_types.push_back(std::move(ntype));
 	}
 
+	// Types have changed, rebuild the detection index when next needed
+	detect_index_valid = false;
+
 	return true;
 }
 
@@ -584,11 +638,71 @@ bool EntryType::loadEntryTypes()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Builds the type detection index from the current list of entry types
+// -----------------------------------------------------------------------------
+void EntryType::buildDetectIndex()
+{
+	std::lock_guard lock(detect_index_mutex);
+	if (detect_index_valid)
+		return;
+
+	auto data = std::make_shared<DetectData>();
+
+	// Get all archive formats that types are restricted to ("" for any other)
+	vector<string> archive_formats{ "" };
+	for (const auto& type : entry_types)
+		for (const auto& format : type->match_archive_)
+			if (std::find(archive_formats.begin(), archive_formats.end(), format) == archive_formats.end())
+				archive_formats.push_back(format);
+
+	// Add candidate types for each archive format
+	for (const auto& format : archive_formats)
+	{
+		auto& index = data->index[format];
+		for (const auto& type : entry_types)
+		{
+			if (!type->detectable_)
+				continue;
+
+			// Check archive format
+			if (!type->match_archive_.empty()
+				&& std::find(type->match_archive_.begin(), type->match_archive_.end(), format)
+					   == type->match_archive_.end())
+				continue;
+
+			// Types that must match an extension only need to be checked for
+			// entries with one of those extensions
+			const bool ext_or_name = type->match_ext_or_name_ && !type->match_name_.empty();
+			if (!type->match_extension_.empty() && !ext_or_name)
+			{
+				for (const auto& ext : type->match_extension_)
+				{
+					auto& ext_types = index.by_ext[ext];
+					if (ext_types.empty() || ext_types.back() != type.get())
+						ext_types.push_back(type.get());
+				}
+			}
+			else
+				index.any_ext.push_back(type.get());
+		}
+	}
+
+	// Reset detection stats
+	data->n_stats = entry_types.size();
+	data->stats   = std::make_unique<DetectStats[]>(data->n_stats);
+
+	detect_data        = std::move(data);
+	detect_index_valid = true;
+}
+
 // -----------------------------------------------------------------------------
 // Attempts to detect the given entry's type
 // -----------------------------------------------------------------------------
 bool EntryType::detectEntryType(ArchiveEntry& entry)
 {
+	PROFILE_ZONE("EntryType::detectEntryType");
+
 	// Do nothing if the entry is a folder or a map marker
 	if (entry.type() == etype_folder || entry.type() == etype_map)
 		return false;
@@ -603,20 +717,72 @@ bool EntryType::detectEntryType(ArchiveEntry& entry)
 	// Reset entry type
 	entry.setType(etype_unknown);
 
-	// Go through all registered types
-	const size_t entry_types_size = entry_types.size();
-	for (size_t a = 0; a < entry_types_size; a++)
+	// Build the detection index if needed
+	if (!detect_index_valid)
+		buildDetectIndex();
+	const auto detect = detectData();
+	if (!detect)
+		return false;
+
+	// Get the candidate types for the entry's archive format
+	auto index = detect->index.find(entry.parent() ? entry.parent()->formatDesc().entry_format : "");
+	if (index == detect->index.end())
+		index = detect->index.find("");
+	if (index == detect->index.end())
+		return false;
+	const auto& any_ext = index->second.any_ext;
+
+	// Get the candidate types for the entry's extension (if any)
+	const vector<EntryType*>* ext_types = nullptr;
+	const auto&               name      = entry.name();
+	const auto                ext_sep   = name.find_last_of('.');
+	if (ext_sep != string::npos)
+	{
+		const auto ext = index->second.by_ext.find(strutil::upper(string_view{ name }.substr(ext_sep + 1)));
+		if (ext != index->second.by_ext.end())
+			ext_types = &ext->second;
+	}
+
+	// Go through all candidate types, in the order they were registered
+	const bool   record_stats = etype_detect_stats;
+	const size_t n_any        = any_ext.size();
+	const size_t n_ext        = ext_types ? ext_types->size() : 0;
+	size_t       i_any        = 0;
+	size_t       i_ext        = 0;
+	while (i_any < n_any || i_ext < n_ext)
 	{
+		EntryType* type;
+		if (i_ext >= n_ext || (i_any < n_any && any_ext[i_any]->index_ < (*ext_types)[i_ext]->index_))
+			type = any_ext[i_any++];
+		else
+			type = (*ext_types)[i_ext++];
+
 		// If the current type is more 'reliable' than this one, skip it
-		if (entry.typeReliability() >= entry_types[a]->reliability())
+		if (entry.typeReliability() >= type->reliability())
 			continue;
 
 		// Check for possible type match
-		const int r = entry_types[a]->isThisType(entry);
+		int r;
+		if (record_stats && static_cast<size_t>(type->index_) < detect->n_stats)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			r                = type->isThisType(entry);
+			const auto time  = std::chrono::steady_clock::now() - start;
+
+			auto& stats = detect->stats[type->index_];
+			stats.checks.fetch_add(1, std::memory_order_relaxed);
+			stats.time_ns.fetch_add(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(), std::memory_order_relaxed);
+			if (r > 0)
+				stats.matches.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+			r = type->isThisType(entry);
+
 		if (r > 0)
 		{
 			// Type matches, set it
-			entry.setType(entry_types[a].get(), r);
+			entry.setType(type, r);
 
 			// No need to continue if the identification is 100% reliable
 			if (entry.typeReliability() >= 255)
@@ -628,6 +794,29 @@ bool EntryType::detectEntryType(ArchiveEntry& entry)
 	return entry.type() != etype_unknown;
 }
 
+// -----------------------------------------------------------------------------
+// Attempts to detect the types of all given [entries], split up over the
+// worker thread pool.
+// Entry data is loaded (if needed) on the calling thread beforehand, since
+// loading from the parent archive isn't thread-safe
+// -----------------------------------------------------------------------------
+void EntryType::detectEntryTypes(const vector<ArchiveEntry*>& entries)
+{
+	// Load entry data
+	for (auto entry : entries)
+		if (entry)
+			entry->data();
+
+	// Detect types
+	threadpool::parallelFor(
+		entries.size(),
+		[&entries](size_t index) {
+			if (entries[index])
+				detectEntryType(*entries[index]);
+		},
+		8);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry type with the given id, or etype_unknown if no id match is
 // found
@@ -815,3 +1004,102 @@ CONSOLE_COMMAND(size, 0, true)
 	}
 	log::info("{}: {} bytes", meep->name(), meep->size());
 }
+
+// -----------------------------------------------------------------------------
+// Command to list entry type detection stats (number of checks, matches and
+// time spent) for each type, most expensive first. Stats are only recorded
+// while the etype_detect_stats cvar is enabled. Use 'type_stats reset' to clear
+// the current stats
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(type_stats, 0, true)
+{
+	const auto detect = detectData();
+	if (!detect)
+	{
+		log::console("No entry types have been detected yet");
+		return;
+	}
+	const auto& detect_stats = detect->stats;
+
+	if (!args.empty() && strutil::equalCI(args[0], "reset"))
+	{
+		for (size_t a = 0; a < detect->n_stats; a++)
+		{
+			detect_stats[a].checks  = 0;
+			detect_stats[a].matches = 0;
+			detect_stats[a].time_ns = 0;
+		}
+		log::console("Entry type detection stats reset");
+		return;
+	}
+
+	if (!etype_detect_stats)
+		log::console("Note: detection stats are only recorded while etype_detect_stats is enabled");
+
+	// Get types that have been checked, sorted by time spent
+	auto               all_types = EntryType::allTypes();
+	vector<EntryType*> checked;
+	for (auto type : all_types)
+		if (static_cast<size_t>(type->index()) < detect->n_stats && detect_stats[type->index()].checks > 0)
+			checked.push_back(type);
+	std::sort(
+		checked.begin(),
+		checked.end(),
+		[&detect_stats](EntryType* a, EntryType* b)
+		{ return detect_stats[a->index()].time_ns > detect_stats[b->index()].time_ns; });
+
+	uint64_t total_ns = 0;
+	for (auto type : checked)
+	{
+		const auto& stats = detect_stats[type->index()];
+		total_ns += stats.time_ns;
+		log::console(fmt::format(
+			"{}: {} checks, {} matches, {:.2f}ms",
+			type->id(),
+			stats.checks.load(),
+			stats.matches.load(),
+			static_cast<double>(stats.time_ns) / 1000000.0));
+	}
+	log::console(
+		fmt::format("{} types checked, {:.2f}ms total", checked.size(), static_cast<double>(total_ns) / 1000000.0));
+}
+
+// -----------------------------------------------------------------------------
+// Command to check that type detection leaves memory-mapped entry data alone.
+// Re-detects the type of each mapped entry in the current archive and reports
+// any entry whose data was copied out of the mapping in the process (ie. a
+// format check that went through a non-const MemChunk accessor)
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(type_check_mapped, 0, false)
+{
+	auto archive = maineditor::currentArchive();
+	if (!archive)
+	{
+		log::console("No archive open");
+		return;
+	}
+
+	vector<ArchiveEntry*> entries;
+	archive->putEntryTreeAsList(entries);
+
+	unsigned n_mapped = 0;
+	unsigned n_copied = 0;
+	for (auto entry : entries)
+	{
+		const MemChunk& data = entry->data();
+		if (!data.isMapped() || data.size() == 0)
+			continue;
+
+		// Detection must not allocate a copy of the data
+		++n_mapped;
+		const auto mapped = data.data();
+		EntryType::detectEntryType(*entry);
+		if (!data.isMapped() || data.data() != mapped)
+		{
+			log::console(fmt::format("{}: data was copied during type detection", entry->path(true)));
+			++n_copied;
+		}
+	}
+
+	log::console(fmt::format("{} mapped entries checked, {} copied during type detection", n_mapped, n_copied));
+}
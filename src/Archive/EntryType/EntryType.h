@@ -39,6 +39,7 @@ public:
 	static bool               readEntryTypeDefinition(MemChunk& mc, string_view source);
 	static bool               loadEntryTypes();
 	static bool               detectEntryType(ArchiveEntry& entry);
+	static void               detectEntryTypes(const vector<ArchiveEntry*>& entries);
 	static EntryType*         fromId(string_view id);
 	static EntryType*         unknownType();
 	static EntryType*         folderType();
@@ -80,5 +81,7 @@ private:
 	vector<string> section_;       // The 'section' of the archive the entry must be in, eg "sprites" for entries
 								   // between SS_START/SS_END in a wad, or the 'sprites' folder in a zip
 	vector<string> match_archive_; // The types of archive the entry can be found in (e.g., wad or zip)
+
+	static void buildDetectIndex();
 };
 } // namespace slade
@@ -0,0 +1,387 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryTypeCache.cpp
+// Description: EntryTypeCache class. Stores the detected entry types of an
+//              archive file in the user dir, keyed by the file's path, size
+//              and modification time, so type detection can be skipped the
+//              next time the same file is opened
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryTypeCache.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "EntryType.h"
+#include "Utility/FileUtils.h"
+#include <filesystem>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, etype_detect_cache, true, CVar::Flag::Save)
+CVAR(Int, etype_detect_cache_max_size, 64, CVar::Flag::Save) // Maximum total size of cache files (MB)
+namespace
+{
+constexpr uint32_t cache_magic   = 0x43544C53; // "SLTC"
+constexpr uint32_t cache_version = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the 64-bit FNV-1a hash of [data], continuing from [hash]
+// -----------------------------------------------------------------------------
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ull)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t a = 0; a < size; a++)
+	{
+		hash ^= bytes[a];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of all currently defined entry types, so cached types are
+// discarded if the type definitions change
+// -----------------------------------------------------------------------------
+uint64_t typesSignature()
+{
+	uint64_t hash = fnv1a(nullptr, 0);
+	for (auto type : EntryType::allTypes())
+	{
+		hash           = fnv1a(type->id().data(), type->id().size(), hash);
+		const auto rel = type->reliability();
+		hash           = fnv1a(&rel, 1, hash);
+	}
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Helper functions for writing cache data to [buf]
+// -----------------------------------------------------------------------------
+template<typename T> void writeValue(vector<uint8_t>& buf, T value)
+{
+	auto bytes = reinterpret_cast<const uint8_t*>(&value);
+	buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+void writeString(vector<uint8_t>& buf, string_view str, size_t max_length)
+{
+	const auto length = std::min(str.size(), max_length);
+	if (max_length > 255)
+		writeValue(buf, static_cast<uint16_t>(length));
+	else
+		writeValue(buf, static_cast<uint8_t>(length));
+	buf.insert(buf.end(), str.begin(), str.begin() + length);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryTypeCache Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// EntryTypeCache class constructor.
+// The cache is only used if [archive_file] exists on disk and is [data_size]
+// bytes, in which case any previously cached types for it are loaded
+// -----------------------------------------------------------------------------
+EntryTypeCache::EntryTypeCache(string_view archive_file, uint64_t data_size) : archive_file_{ archive_file }
+{
+	if (!etype_detect_cache || archive_file_.empty() || !fileutil::fileExists(archive_file_))
+		return;
+
+	// Check the file on disk matches the data being opened
+	std::error_code ec;
+	file_size_ = std::filesystem::file_size(archive_file_, ec);
+	if (ec || file_size_ != data_size)
+		return;
+	file_time_ = fileutil::fileModifiedTime(archive_file_);
+
+	// Get cache file path (named by a hash of the archive path)
+	const auto path_hash = fnv1a(archive_file_.data(), archive_file_.size());
+	cache_file_          = app::path(fmt::format("typecache/{:016x}.dat", path_hash), app::Dir::User);
+
+	enabled_         = true;
+	types_signature_ = typesSignature();
+	loaded_          = load();
+}
+
+// -----------------------------------------------------------------------------
+// Loads cached types for the archive from the cache file.
+// Returns false if there is no (valid) cache for the archive as it currently
+// is on disk
+// -----------------------------------------------------------------------------
+bool EntryTypeCache::load()
+{
+	MemChunk mc;
+	if (!fileutil::fileExists(cache_file_) || !mc.importFile(cache_file_))
+		return false;
+
+	// Check header
+	uint32_t magic, version;
+	uint64_t signature, file_size;
+	int64_t  file_time;
+	mc.seek(0, SEEK_SET);
+	if (!mc.read(&magic, 4) || !mc.read(&version, 4) || !mc.read(&signature, 8) || !mc.read(&file_size, 8)
+		|| !mc.read(&file_time, 8))
+		return false;
+	if (magic != cache_magic || version != cache_version || signature != types_signature_ || file_size != file_size_
+		|| file_time != file_time_)
+		return false;
+
+	// Check archive path (in case of a hash collision)
+	uint16_t path_length;
+	string   path;
+	if (!mc.read(&path_length, 2))
+		return false;
+	path.resize(path_length);
+	if (!mc.read(path.data(), path_length) || path != archive_file_)
+		return false;
+
+	// Read type table
+	uint16_t           num_types;
+	vector<EntryType*> types;
+	if (!mc.read(&num_types, 2))
+		return false;
+	for (unsigned a = 0; a < num_types; a++)
+	{
+		uint8_t length;
+		char    id[256];
+		if (!mc.read(&length, 1) || !mc.read(id, length))
+			return false;
+		types.push_back(EntryType::fromId({ id, length }));
+	}
+
+	// Read cached entries
+	uint32_t num_entries;
+	if (!mc.read(&num_entries, 4))
+		return false;
+	cached_.reserve(num_entries);
+	for (unsigned a = 0; a < num_entries; a++)
+	{
+		uint32_t key, size;
+		uint16_t type, name_length;
+		uint8_t  reliability;
+		string   name;
+		if (!mc.read(&key, 4) || !mc.read(&size, 4) || !mc.read(&type, 2) || !mc.read(&reliability, 1)
+			|| !mc.read(&name_length, 2) || type >= types.size())
+		{
+			cached_.clear();
+			return false;
+		}
+		name.resize(name_length);
+		if (!mc.read(name.data(), name_length))
+		{
+			cached_.clear();
+			return false;
+		}
+
+		auto& cached       = cached_[key];
+		cached.name        = std::move(name);
+		cached.size        = size;
+		cached.type        = types[type];
+		cached.reliability = reliability;
+	}
+
+	// Mark the cache file as recently used (see prune)
+	std::error_code ec;
+	std::filesystem::last_write_time(cache_file_, std::filesystem::file_time_type::clock::now(), ec);
+
+	log::info(2, "Loaded {} cached entry types for {}", cached_.size(), archive_file_);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the type of [entry] from the cache, if a type was cached for an entry
+// with the same [key] (eg. offset or index in the archive file), name and size.
+// Returns true if the type was set
+// -----------------------------------------------------------------------------
+bool EntryTypeCache::apply(ArchiveEntry& entry, uint32_t key) const
+{
+	if (!loaded_)
+		return false;
+
+	const auto i = cached_.find(key);
+	if (i == cached_.end() || i->second.size != entry.size() || i->second.name != entry.name())
+		return false;
+
+	entry.setType(i->second.type, i->second.reliability);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [entry] with [key] to be written to the cache on save.
+// The entry's type is read when saving, so this can be called before its type
+// has been detected
+// -----------------------------------------------------------------------------
+void EntryTypeCache::add(ArchiveEntry* entry, uint32_t key)
+{
+	if (enabled_)
+		entries_.emplace_back(key, entry);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the types of all added entries to the cache file, if anything has
+// changed since it was loaded. Entries whose type detection is still deferred
+// are skipped
+// -----------------------------------------------------------------------------
+void EntryTypeCache::save() const
+{
+	if (!enabled_)
+		return;
+
+	vector<std::pair<uint32_t, ArchiveEntry*>> entries;
+	entries.reserve(entries_.size());
+	for (const auto& [key, entry] : entries_)
+		if (!entry->detect_type_deferred_)
+			entries.emplace_back(key, entry);
+	if (entries.empty())
+		return;
+
+	// Check if anything changed
+	bool changed = !loaded_ || entries.size() != cached_.size();
+	for (unsigned a = 0; !changed && a < entries.size(); a++)
+	{
+		const auto entry = entries[a].second;
+		const auto i     = cached_.find(entries[a].first);
+		if (i == cached_.end() || i->second.type != entry->type() || i->second.reliability != entry->reliability_
+			|| i->second.name != entry->name() || i->second.size != entry->size())
+			changed = true;
+	}
+	if (!changed)
+		return;
+
+	// Build type table
+	vector<EntryType*>                       types;
+	std::unordered_map<EntryType*, uint16_t> type_index;
+	for (const auto& [key, entry] : entries)
+		if (type_index.find(entry->type()) == type_index.end())
+		{
+			type_index[entry->type()] = static_cast<uint16_t>(types.size());
+			types.push_back(entry->type());
+		}
+
+	// Write header
+	vector<uint8_t> buf;
+	buf.reserve(64 + archive_file_.size() + entries.size() * 24);
+	writeValue(buf, cache_magic);
+	writeValue(buf, cache_version);
+	writeValue(buf, types_signature_);
+	writeValue(buf, file_size_);
+	writeValue(buf, file_time_);
+	writeString(buf, archive_file_, 65535);
+
+	// Write type table
+	writeValue(buf, static_cast<uint16_t>(types.size()));
+	for (auto type : types)
+		writeString(buf, type->id(), 255);
+
+	// Write entries
+	writeValue(buf, static_cast<uint32_t>(entries.size()));
+	for (const auto& [key, entry] : entries)
+	{
+		writeValue(buf, key);
+		writeValue(buf, static_cast<uint32_t>(entry->size()));
+		writeValue(buf, type_index[entry->type()]);
+		writeValue(buf, static_cast<uint8_t>(std::clamp(entry->reliability_, 0, 255)));
+		writeString(buf, entry->name(), 65535);
+	}
+
+	// Write to file
+	const auto cache_dir = app::path("typecache", app::Dir::User);
+	if (!fileutil::dirExists(cache_dir))
+		fileutil::createDir(cache_dir);
+	{
+		SFile file(cache_file_, SFile::Mode::Write);
+		if (!file.isOpen() || !file.write(buf.data(), buf.size()))
+		{
+			log::warning("Unable to write entry type cache file {}", cache_file_);
+			file.close();
+			fileutil::removeFile(cache_file_);
+			return;
+		}
+	}
+
+	prune();
+}
+
+// -----------------------------------------------------------------------------
+// Removes the least recently used cache files until the total size of all
+// cache files is within etype_detect_cache_max_size
+// -----------------------------------------------------------------------------
+void EntryTypeCache::prune() const
+{
+	namespace fs = std::filesystem;
+
+	struct CacheFile
+	{
+		fs::path           path;
+		uintmax_t          size;
+		fs::file_time_type time;
+	};
+	vector<CacheFile> files;
+	uintmax_t         total = 0;
+	std::error_code   ec;
+	for (const auto& file : fs::directory_iterator(app::path("typecache", app::Dir::User), ec))
+	{
+		if (!file.is_regular_file(ec))
+			continue;
+
+		files.push_back({ file.path(), file.file_size(ec), file.last_write_time(ec) });
+		total += files.back().size;
+	}
+
+	// Remove oldest first
+	auto max_size = static_cast<uintmax_t>(std::max(0, static_cast<int>(etype_detect_cache_max_size))) * 1024 * 1024;
+	std::sort(files.begin(), files.end(), [](const CacheFile& l, const CacheFile& r) { return l.time < r.time; });
+	for (const auto& file : files)
+	{
+		if (total <= max_size)
+			break;
+
+		fs::remove(file.path, ec);
+		total -= file.size;
+	}
+}
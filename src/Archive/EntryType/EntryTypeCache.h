@@ -0,0 +1,44 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class EntryType;
+
+// Persistent on-disk cache of the detected entry types in an archive file, so
+// type detection can be skipped when the same (unchanged) file is opened again
+class EntryTypeCache
+{
+public:
+	EntryTypeCache(string_view archive_file, uint64_t data_size);
+	~EntryTypeCache() = default;
+
+	bool apply(ArchiveEntry& entry, uint32_t key) const;
+	void add(ArchiveEntry* entry, uint32_t key);
+	void save() const;
+
+	bool isEnabled() const { return enabled_; }
+
+private:
+	struct CachedType
+	{
+		string     name;
+		uint32_t   size        = 0;
+		EntryType* type        = nullptr;
+		uint8_t    reliability = 0;
+	};
+
+	bool                                       enabled_ = false;
+	bool                                       loaded_  = false;
+	string                                     archive_file_;
+	string                                     cache_file_;
+	uint64_t                                   file_size_       = 0;
+	int64_t                                    file_time_       = 0;
+	uint64_t                                   types_signature_ = 0;
+	std::unordered_map<uint32_t, CachedType>   cached_;
+	vector<std::pair<uint32_t, ArchiveEntry*>> entries_;
+
+	bool load();
+	void prune() const;
+};
+} // namespace slade
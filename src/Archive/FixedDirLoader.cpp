@@ -0,0 +1,268 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    FixedDirLoader.cpp
+// Description: FixedDirLoader class - shared loader for simple archive formats
+//              with a directory of fixed-size records (grp, pak, gob, etc.),
+//              reading the directory straight from the archive data and
+//              leaving entry data to be loaded when needed
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "FixedDirLoader.h"
+#include "Archive.h"
+#include "EntryType/EntryTypeCache.h"
+#include "General/UI.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr size_t   type_detect_batch_size = 64 * 1024 * 1024; // Max. entry data to reference at once for type detection
+constexpr unsigned splash_update_interval = 500;              // No. of records to read between splash progress updates
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Bool, archive_load_data)
+
+
+// -----------------------------------------------------------------------------
+//
+// FixedDirLoader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// FixedDirLoader class constructor, for loading entries into [archive] from
+// its file [data], with directory records described by [format]
+// -----------------------------------------------------------------------------
+FixedDirLoader::FixedDirLoader(Archive& archive, const MemChunk& data, const RecordFormat& format) :
+	archive_{ archive },
+	data_{ data },
+	format_{ format }
+{
+}
+
+// -----------------------------------------------------------------------------
+// Reads [num_records] directory records starting at [dir_offset] in the
+// archive data (for DataLayout::Inline, records are read until the end of the
+// data instead). Entries are added to [dir], or the archive root if null.
+// If [read_record] is given it is called for each record and is responsible
+// for adding its entry (via addEntry), otherwise entries are added as-is.
+// Returns false if the directory is invalid or [read_record] returned false
+// -----------------------------------------------------------------------------
+bool FixedDirLoader::readDirectory(
+	uint32_t          dir_offset,
+	uint32_t          num_records,
+	const RecordFunc& read_record,
+	ArchiveDir*       dir)
+{
+	const uint64_t data_size   = data_.size();
+	const uint64_t record_size = format_.size;
+	const bool     inline_data = format_.layout == DataLayout::Inline;
+
+	// Check the directory is within the data
+	if (!inline_data && dir_offset + num_records * record_size > data_size)
+		return invalid("directory goes past end of file");
+
+	if (!dir)
+		dir = archive_.rootDir().get();
+
+	uint64_t pos       = dir_offset;
+	uint64_t data_next = dir_offset + num_records * record_size; // For DataLayout::AfterDirectory
+	for (unsigned index = 0; inline_data ? pos < data_size : index < num_records; ++index)
+	{
+		// Update splash window progress
+		if (index % splash_update_interval == 0)
+			ui::setSplashProgress(
+				inline_data ? static_cast<float>(pos) / data_size : static_cast<float>(index) / num_records);
+
+		if (pos + record_size > data_size)
+			return invalid(fmt::format("entry {} goes past end of file", index));
+
+		// Read record info
+		Record record;
+		record.index = index;
+		record.data  = data_.data() + pos;
+		record.size  = readValue(pos + format_.size_pos);
+		record.dir   = dir;
+
+		// Name ('\0'-padded)
+		auto name = reinterpret_cast<const char*>(record.data + format_.name_pos);
+		record.name.assign(name, std::find(name, name + format_.name_length, '\0'));
+
+		// Data offset
+		switch (format_.layout)
+		{
+		case DataLayout::Offset: record.offset = readValue(pos + format_.offset_pos); break;
+		case DataLayout::AfterDirectory:
+			record.offset = static_cast<uint32_t>(data_next);
+			data_next += record.size;
+			break;
+		case DataLayout::Inline: record.offset = static_cast<uint32_t>(pos + record_size); break;
+		}
+
+		// Next record
+		pos = inline_data ? record.offset + static_cast<uint64_t>(record.size) : pos + record_size;
+
+		// Add entry
+		if (read_record)
+		{
+			if (!read_record(record))
+				return false;
+		}
+		else if (!addEntry(record))
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Creates an entry for [record] and adds it to the record's directory (or a
+// subdirectory of it if the format has paths in entry names).
+// The entry data isn't loaded, see detectEntryTypes.
+// Returns the added entry, or null if the record is invalid
+// -----------------------------------------------------------------------------
+ArchiveEntry* FixedDirLoader::addEntry(const Record& record)
+{
+	// Check the entry data is within the archive data
+	if (static_cast<uint64_t>(record.offset) + record.size > data_.size())
+	{
+		invalid(fmt::format("entry {}: {} data goes past end of file", record.index, record.name));
+		return nullptr;
+	}
+
+	// Get directory (and name within it)
+	auto        dir  = record.dir ? record.dir : archive_.rootDir().get();
+	string_view name = record.name;
+	if (format_.name_paths)
+	{
+		dir  = archive_.createDir(strutil::Path::pathOf(name, false), ArchiveDir::getShared(dir)).get();
+		name = strutil::Path::fileNameOf(name);
+	}
+
+	// Create & setup entry
+	auto entry = std::make_shared<ArchiveEntry>(name, record.size);
+	entry->setLoaded(false);
+	entry->storage().offset = record.offset;
+	entry->setState(ArchiveEntry::State::Unmodified);
+
+	// Add to directory
+	dir->addEntry(entry);
+	entries_.push_back(entry.get());
+
+	return entry.get();
+}
+
+// -----------------------------------------------------------------------------
+// Detects the types of all entries added by the loader. Types cached from the
+// last time the archive file was opened are used where possible, leaving the
+// entry unloaded. Otherwise the entry references its data in the archive data
+// (rather than copying it) and types are detected in batches.
+// Entries with data already loaded (eg. decoded by the format) are detected
+// from that data
+// -----------------------------------------------------------------------------
+void FixedDirLoader::detectEntryTypes()
+{
+	EntryTypeCache        type_cache(archive_.filename(), data_.size());
+	vector<ArchiveEntry*> batch;
+	size_t                batch_size   = 0;
+	auto                  detect_batch = [&batch, &batch_size]() {
+		EntryType::detectEntryTypes(batch);
+		for (auto entry : batch)
+			entry->setState(ArchiveEntry::State::Unmodified);
+		batch.clear();
+		batch_size = 0;
+	};
+
+	ui::setSplashProgressMessage("Detecting entry types");
+	for (size_t a = 0; a < entries_.size(); a++)
+	{
+		// Update splash window progress
+		if (a % splash_update_interval == 0)
+			ui::setSplashProgress(static_cast<float>(a) / entries_.size());
+
+		auto       entry  = entries_[a];
+		const auto offset = entry->storage().offset;
+
+		// Use cached type if available, no need to reference the entry data
+		// unless all data is to be loaded
+		const bool cacheable = entry->size() > 0 && !entry->isLoaded()
+							   && entry->encryption() == ArchiveEntry::Encryption::None;
+		if (cacheable)
+		{
+			type_cache.add(entry, offset);
+			if (!archive_load_data && type_cache.apply(*entry, offset))
+				continue;
+		}
+
+		// Reference the entry data if it isn't zero-sized
+		if (entry->size() > 0 && !entry->isLoaded())
+			entry->importMemChunk(data_, offset, entry->size());
+
+		// Add to type detection batch
+		batch.push_back(entry);
+		batch_size += entry->size();
+		if (batch_size >= type_detect_batch_size)
+			detect_batch();
+	}
+	detect_batch();
+	type_cache.save();
+}
+
+// -----------------------------------------------------------------------------
+// Reads a 32-bit value (in the format's byte order) at [pos] in the data
+// -----------------------------------------------------------------------------
+uint32_t FixedDirLoader::readValue(uint32_t pos) const
+{
+	return format_.big_endian ? data_.readB32(pos) : data_.readL32(pos);
+}
+
+// -----------------------------------------------------------------------------
+// Logs and sets the global error message for an invalid archive, with the
+// given [reason]. Always returns false
+// -----------------------------------------------------------------------------
+bool FixedDirLoader::invalid(string_view reason) const
+{
+	log::error("{} archive is invalid or corrupt ({})", archive_.formatId(), reason);
+	global::error = fmt::format("Archive is invalid and/or corrupt ({})", reason);
+	return false;
+}
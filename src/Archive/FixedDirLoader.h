@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+
+namespace slade
+{
+class Archive;
+class ArchiveDir;
+class ArchiveEntry;
+
+// Shared loader for the simple 'legacy' archive formats that store a list of
+// fixed-size directory records (eg. grp, pak, gob, wad2), driven by a
+// per-format RecordFormat description.
+//
+// Records are parsed directly from the archive data rather than via MemChunk
+// reads, and entry data is never copied while opening - entries either
+// reference the archive data (as views, so nothing is read from a mapped file
+// until it is accessed) or are left unloaded if their type could be taken from
+// the EntryTypeCache.
+//
+// Usage: create the loader in the format's open function after checking the
+// header, call readDirectory (with a function to handle any format-specific
+// record fields if needed), then detectEntryTypes
+class FixedDirLoader
+{
+public:
+	// Where the entry data for each record is
+	enum class DataLayout
+	{
+		Offset,         // Each record contains the offset of its entry data
+		AfterDirectory, // Entry data is stored consecutively after the directory, in record order
+		Inline          // Each record is directly followed by its entry data (no separate directory)
+	};
+
+	// Describes the layout of a format's directory records. Positions are
+	// byte offsets within a record
+	struct RecordFormat
+	{
+		unsigned   size        = 0; // Size of a record in bytes
+		unsigned   name_pos    = 0;
+		unsigned   name_length = 0; // Max. name length ('\0'-terminated if shorter)
+		unsigned   offset_pos  = 0; // Only used with DataLayout::Offset
+		unsigned   size_pos    = 0;
+		DataLayout layout      = DataLayout::Offset;
+		bool       big_endian  = false;
+		bool       name_paths  = false; // Names include a path, entries are added to subdirectories
+	};
+
+	// A parsed directory record
+	struct Record
+	{
+		unsigned       index  = 0;
+		const uint8_t* data   = nullptr; // Raw record data (for format-specific fields)
+		string         name;
+		uint32_t       offset = 0; // Entry data offset
+		uint32_t       size   = 0; // Entry data size
+		ArchiveDir*    dir    = nullptr;
+	};
+
+	// Called for each record read by readDirectory, should add the entry for
+	// [record] with addEntry (after modifying the record if needed) unless it
+	// is to be skipped. Returning false aborts reading the directory (the
+	// function should set global::error)
+	using RecordFunc = std::function<bool(Record& record)>;
+
+	FixedDirLoader(Archive& archive, const MemChunk& data, const RecordFormat& format);
+	~FixedDirLoader() = default;
+
+	const MemChunk& data() const { return data_; }
+
+	bool readDirectory(
+		uint32_t          dir_offset,
+		uint32_t          num_records,
+		const RecordFunc& read_record = {},
+		ArchiveDir*       dir         = nullptr);
+	ArchiveEntry* addEntry(const Record& record);
+	void          detectEntryTypes();
+
+private:
+	Archive&              archive_;
+	const MemChunk&       data_;
+	RecordFormat          format_;
+	vector<ArchiveEntry*> entries_; // All entries added while loading, in order
+
+	uint32_t readValue(uint32_t pos) const;
+	bool     invalid(string_view reason) const;
+};
+} // namespace slade
@@ -122,8 +122,8 @@ bool ADatArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry                = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), compsize);
-		entry->exProp("Offset")   = (int)offset;
-		entry->exProp("FullSize") = (int)decsize;
+		entry->storage().offset    = offset;
+		entry->storage().full_size = decsize;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -148,9 +148,9 @@ bool ADatArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->storage().offset, entry->size());
 			MemChunk xdata;
-			if (compression::zlibInflate(edata, xdata, entry->exProp<int>("FullSize")))
+			if (compression::zlibInflate(edata, xdata, entry->storage().full_size))
 				entry->importMemChunk(xdata);
 			else
 			{
@@ -229,7 +229,7 @@ bool ADatArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 
 		///////////////////////////////////
@@ -334,7 +334,7 @@ bool ADatArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -353,7 +353,7 @@ bool ADatArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Anachronox dat archive
 // -----------------------------------------------------------------------------
-bool ADatArchive::isADatArchive(MemChunk& mc)
+bool ADatArchive::isADatArchive(const MemChunk& mc)
 {
 	// Check it opened ok
 	if (mc.size() < 16)
@@ -364,11 +364,10 @@ bool ADatArchive::isADatArchive(MemChunk& mc)
 	long dir_offset;
 	long dir_size;
 	long version;
-	mc.seek(0, SEEK_SET);
-	mc.read(magic, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
-	mc.read(&version, 4);
+	mc.read(0, magic, 4);
+	mc.read(4, &dir_offset, 4);
+	mc.read(8, &dir_size, 4);
+	mc.read(12, &version, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -32,6 +32,7 @@
 #include "Main.h"
 #include "BZip2Archive.h"
 #include "Utility/Compression.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -45,23 +46,21 @@ using namespace slade;
 
 
 // -----------------------------------------------------------------------------
-// Reads bzip2 format data from a MemChunk
-// Returns true if successful, false otherwise
+// Returns true if [header] (the first 4 bytes of a file) is a valid bzip2
+// header
 // -----------------------------------------------------------------------------
-bool BZip2Archive::open(MemChunk& mc)
+bool BZip2Archive::checkHeader(const uint8_t* header)
 {
-	size_t size = mc.size();
-	if (size < 14)
-		return false;
-
-	// Read header
-	uint8_t header[4];
-	mc.read(header, 4);
-
 	// Check for BZip2 header (reject BZip1 headers)
-	if (!(header[0] == 'B' && header[1] == 'Z' && header[2] == 'h' && (header[3] >= '1' && header[3] <= '9')))
-		return false;
+	return header[0] == 'B' && header[1] == 'Z' && header[2] == 'h' && (header[3] >= '1' && header[3] <= '9');
+}
 
+// -----------------------------------------------------------------------------
+// Creates the archive's single entry from the decompressed [data], with a name
+// built from the archive filename
+// -----------------------------------------------------------------------------
+void BZip2Archive::createEntry(MemChunk& data)
+{
 	// Build name from filename
 	strutil::Path fn(filename(false));
 	auto          ext = fn.extension();
@@ -72,23 +71,80 @@ bool BZip2Archive::open(MemChunk& mc)
 
 	// Let's create the entry
 	ArchiveModSignalBlocker sig_blocker{ *this };
-	auto                    entry = std::make_shared<ArchiveEntry>(fn.fileName(), size);
-	MemChunk                xdata;
-	if (compression::bzip2Decompress(mc, xdata))
-		entry->importMemChunk(xdata);
-	else
-		return false;
+	auto                    entry = std::make_shared<ArchiveEntry>(fn.fileName());
+	entry->importMemChunk(data);
 	rootDir()->addEntry(entry);
 	EntryType::detectEntryType(*entry);
 	entry->setState(ArchiveEntry::State::Unmodified);
 
 	sig_blocker.unblock();
 	setModified(false);
+}
+
+// -----------------------------------------------------------------------------
+// Reads bzip2 format data from a MemChunk
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool BZip2Archive::open(MemChunk& mc)
+{
+	size_t size = mc.size();
+	if (size < 14)
+		return false;
+
+	// Read header
+	uint8_t header[4];
+	mc.read(header, 4);
+	if (!checkHeader(header))
+		return false;
+
+	MemChunk xdata;
+	if (!compression::bzip2Decompress(mc, xdata))
+		return false;
+	createEntry(xdata);
 
 	// Finish
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads a bzip2 file from disk, decompressing it as it is read rather than
+// loading the whole compressed file into memory first
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool BZip2Archive::open(string_view filename)
+{
+	// Check header
+	uint8_t header[4];
+	{
+		SFile file(filename);
+		if (!file.isOpen())
+		{
+			global::error = "Unable to open file. Make sure it isn't in use by another program.";
+			return false;
+		}
+		if (file.size() < 14 || !file.read(header, 4) || !checkHeader(header))
+			return false;
+	}
+
+	// Update filename before opening (the entry name comes from it)
+	const auto backupname = filename_;
+	filename_             = filename;
+
+	// Decompress directly from the file
+	MemChunk xdata;
+	if (!compression::bzip2DecompressFile(filename_, xdata))
+	{
+		filename_ = backupname;
+		return false;
+	}
+	createEntry(xdata);
+
+	file_modified_ = fileutil::fileModifiedTime(filename);
+	on_disk_       = true;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Writes the BZip2 archive to a MemChunk
 // Returns true if successful, false otherwise
@@ -101,6 +157,27 @@ bool BZip2Archive::write(MemChunk& mc, bool update)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the BZip2 archive to a file, compressing the entry data directly to
+// the file rather than to an intermediate MemChunk
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool BZip2Archive::write(string_view filename, bool update)
+{
+	if (numEntries() != 1)
+		return false;
+
+	// Get entry data (if we're overwriting the archive's own file, it must be
+	// loaded before the file is truncated)
+	auto& data = entryAt(0)->data();
+
+	SFile file(filename, SFile::Mode::Write);
+	if (!file.isOpen())
+		return false;
+
+	return compression::bzip2CompressToFile(data.data(), data.size(), file);
+}
+
 // -----------------------------------------------------------------------------
 // Loads an entry's data from the BZip2 file
 // Returns true if successful, false otherwise
@@ -212,7 +289,7 @@ vector<ArchiveEntry*> BZip2Archive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid BZip2 archive
 // -----------------------------------------------------------------------------
-bool BZip2Archive::isBZip2Archive(MemChunk& mc)
+bool BZip2Archive::isBZip2Archive(const MemChunk& mc)
 {
 	size_t size = mc.size();
 	if (size < 14)
@@ -220,7 +297,7 @@ bool BZip2Archive::isBZip2Archive(MemChunk& mc)
 
 	// Read header
 	uint8_t header[4];
-	mc.read(header, 4);
+	mc.read(0, header, 4);
 
 	// Check for BZip2 header (reject BZip1 headers)
 	if (header[0] == 'B' && header[1] == 'Z' && header[2] == 'h' && (header[3] >= '1' && header[3] <= '9'))
@@ -11,10 +11,12 @@ public:
 	~BZip2Archive() = default;
 
 	// Opening
-	bool open(MemChunk& mc) override;
+	bool open(string_view filename) override; // Open from File
+	bool open(MemChunk& mc) override;         // Open from MemChunk
 
 	// Writing/Saving
-	bool write(MemChunk& mc, bool update = true) override;
+	bool write(MemChunk& mc, bool update = true) override;         // Write to MemChunk
+	bool write(string_view filename, bool update = true) override; // Write to File
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
@@ -49,7 +51,11 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isBZip2Archive(MemChunk& mc);
+	static bool isBZip2Archive(const MemChunk& mc);
 	static bool isBZip2Archive(const string& filename);
+
+private:
+	static bool checkHeader(const uint8_t* header);
+	void        createEntry(MemChunk& data);
 };
 } // namespace slade
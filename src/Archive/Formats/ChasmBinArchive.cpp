@@ -135,7 +135,7 @@ bool ChasmBinArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(name, size);
-		entry->exProp("Offset") = static_cast<int>(offset);
+		entry->storage().offset = offset;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -148,8 +148,6 @@ bool ChasmBinArchive::open(MemChunk& mc)
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
 
-	MemChunk edata;
-
 	for (size_t i = 0; i < all_entries.size(); ++i)
 	{
 		// Update splash window progress
@@ -162,8 +160,7 @@ bool ChasmBinArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
+			entry->importMemChunk(mc, entry->storage().offset, entry->size());
 		}
 
 		// Detect entry type
@@ -233,7 +230,7 @@ bool ChasmBinArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = static_cast<int>(offset);
+			entry->storage().offset = offset;
 		}
 
 		// Check entry name
@@ -306,7 +303,7 @@ bool ChasmBinArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -325,7 +322,7 @@ bool ChasmBinArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Chasm bin archive
 // -----------------------------------------------------------------------------
-bool ChasmBinArchive::isChasmBinArchive(MemChunk& mc)
+bool ChasmBinArchive::isChasmBinArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	if (mc.size() < HEADER_SIZE)
@@ -335,7 +332,7 @@ bool ChasmBinArchive::isChasmBinArchive(MemChunk& mc)
 
 	// Read bin header and check it
 	char magic[4] = {};
-	mc.read(magic, sizeof magic);
+	mc.read(0, magic, sizeof magic);
 
 	if (magic[0] != 'C' || magic[1] != 'S' || magic[2] != 'i' || magic[3] != 'd')
 	{
@@ -343,7 +340,7 @@ bool ChasmBinArchive::isChasmBinArchive(MemChunk& mc)
 	}
 
 	uint16_t num_entries = 0;
-	mc.read(&num_entries, sizeof num_entries);
+	mc.read(sizeof magic, &num_entries, sizeof num_entries);
 	num_entries = wxUINT16_SWAP_ON_BE(num_entries);
 
 	return num_entries > MAX_ENTRY_COUNT || (HEADER_SIZE + ENTRY_SIZE * MAX_ENTRY_COUNT) <= mc.size();
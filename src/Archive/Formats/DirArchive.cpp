@@ -34,10 +34,13 @@
 #include "Main.h"
 #include "DirArchive.h"
 #include "App.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 #include "WadArchive.h"
+#include <deque>
+#include <filesystem>
 
 using namespace slade;
 
@@ -50,6 +53,14 @@ using namespace slade;
 EXTERN_CVAR(Bool, archive_load_data)
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, dir_archive_lazy_open, false, CVar::Flag::Save)
+
+
 // -----------------------------------------------------------------------------
 //
 // DirArchive Class Functions
@@ -73,7 +84,10 @@ DirArchive::DirArchive() : Archive("folder")
 }
 
 // -----------------------------------------------------------------------------
-// Reads files from the directory [filename] into the archive
+// Reads files from the directory [filename] into the archive.
+// Files are read (or just checked for size and modification time if
+// dir_archive_lazy_open is enabled) in parallel. In lazy mode file data isn't
+// read and type detection is deferred until each entry is first accessed.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
 bool DirArchive::open(string_view filename)
@@ -88,44 +102,64 @@ bool DirArchive::open(string_view filename)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	const ArchiveModSignalBlocker sig_blocker{ *this };
 
+	// Create entries for all files in parallel (entries aren't added to the
+	// archive yet, so this doesn't touch any shared state)
 	ui::setSplashProgressMessage("Reading files");
-	for (unsigned a = 0; a < files.size(); a++)
-	{
-		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(files.size()));
-
-		// Cut off directory to get entry name + relative path
-		auto name = files[a];
-		name.erase(0, filename.size());
-		if (strutil::startsWith(name, separator_))
-			name.erase(0, 1);
-
-		// log::info(3, fn.GetPath(true, wxPATH_UNIX));
+	const bool                       lazy = dir_archive_lazy_open && !archive_load_data;
+	vector<shared_ptr<ArchiveEntry>> new_entries(files.size());
+	vector<string>                   entry_paths(files.size());
+	vector<time_t>                   mtimes(files.size());
+	threadpool::parallelFor(
+		files.size(),
+		[&](size_t a) {
+			// Cut off directory to get entry name + relative path
+			auto name = files[a];
+			name.erase(0, filename.size());
+			if (strutil::startsWith(name, separator_))
+				name.erase(0, 1);
+			const auto fn  = strutil::Path{ name };
+			entry_paths[a] = fn.path();
+			mtimes[a]      = wxFileModificationTime(files[a]);
 
-		// Create entry
-		auto fn        = strutil::Path{ name };
-		auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName());
+			// Create entry
+			std::error_code ec;
+			const auto      size  = lazy ? std::filesystem::file_size(files[a], ec) : 0;
+			auto            entry = std::make_shared<ArchiveEntry>(fn.fileName(), ec ? 0 : static_cast<uint32_t>(size));
+			entry->exProp("filePath") = files[a];
 
-		// Setup entry info
-		new_entry->setLoaded(false);
-		new_entry->exProp("filePath") = files[a];
+			if (lazy)
+			{
+				// Don't read the file, detect its type when first needed
+				entry->setLoaded(false);
+				entry->setTypeDeferred();
+			}
+			else
+			{
+				// Read entry data and detect type
+				entry->importFile(files[a]);
+				entry->setLoaded(true);
+				EntryType::detectEntryType(*entry);
+			}
 
-		// Add entry and directory to directory tree
-		auto ndir = createDir(fn.path());
-		ndir->addEntry(new_entry);
-		ndir->dirEntry()->exProp("filePath") = fmt::format("{}{}", filename, fn.path());
+			new_entries[a] = entry;
+		},
+		16);
 
-		// Read entry data
-		new_entry->importFile(files[a]);
-		new_entry->setLoaded(true);
+	// Add entries and directories to directory tree
+	for (unsigned a = 0; a < files.size(); a++)
+	{
+		if (a % 256 == 0)
+			ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(files.size()));
 
-		file_modification_times_[new_entry.get()] = wxFileModificationTime(files[a]);
+		auto ndir = createDir(entry_paths[a]);
+		ndir->addEntry(new_entries[a]);
+		ndir->dirEntry()->exProp("filePath") = fmt::format("{}{}", filename, entry_paths[a]);
 
-		// Detect entry type
-		EntryType::detectEntryType(*new_entry);
+		file_modification_times_[new_entries[a].get()] = mtimes[a];
 
 		// Unload data if needed
 		if (!archive_load_data)
-			new_entry->unloadData();
+			new_entries[a]->unloadData();
 	}
 
 	// Add empty directories
@@ -627,6 +661,8 @@ void DirArchive::updateChangedEntries(vector<DirEntryChange>& changes)
 		if (change.action == DirEntryChange::Action::Updated)
 		{
 			auto entry = entryAtPath(change.entry_path);
+			if (!entry)
+				continue;
 			entry->importFile(change.file_path);
 			EntryType::detectEntryType(*entry);
 			file_modification_times_[entry] = wxFileModificationTime(change.file_path);
@@ -732,3 +768,85 @@ bool DirArchive::shouldIgnoreEntryChange(DirEntryChange& change)
 	// and an unmodified file will never change mtime.)
 	return (old_change.mtime == change.mtime);
 }
+
+// -----------------------------------------------------------------------------
+// Returns a list of changes to apply to the archive from the current state of
+// the files/directories at [file_paths] on disk (eg. paths reported as changed
+// by a file system watcher), without rescanning the whole directory.
+// The contents of any newly added directories are also included
+// -----------------------------------------------------------------------------
+vector<DirEntryChange> DirArchive::changedEntries(const vector<string>& file_paths)
+{
+	vector<DirEntryChange> changes;
+	std::deque<string>     to_check(file_paths.begin(), file_paths.end());
+	std::set<string>       checked;
+	std::set<string>       listed_dirs;
+
+	auto add_change = [&](DirEntryChange change) {
+		if (!shouldIgnoreEntryChange(change))
+			changes.push_back(change);
+	};
+
+	while (!to_check.empty())
+	{
+		auto file_path = to_check.front();
+		to_check.pop_front();
+
+		// Ignore anything already checked or outside the archive directory
+		if (!checked.insert(file_path).second)
+			continue;
+		if (file_path.size() <= filename_.size() + 1 || !strutil::startsWith(file_path, filename_)
+			|| file_path[filename_.size()] != separator_)
+			continue;
+
+		// Ignore files removed from archive since last save
+		if (VECTOR_EXISTS(removed_files_, file_path))
+			continue;
+
+		// Find matching entry or directory in the archive
+		auto path = file_path.substr(filename_.size() + 1);
+		std::replace(path.begin(), path.end(), '\\', '/');
+		auto entry = entryAtPath(path);
+		auto dir   = entry ? nullptr : dirAtPath(path);
+		if (entry && entry->exProps().getOr<string>("filePath", "") != file_path)
+			entry = nullptr;
+
+		// Directory
+		if (wxDirExists(file_path))
+		{
+			if (dir)
+				continue;
+
+			add_change(DirEntryChange(DirEntryChange::Action::AddedDir, file_path, "", wxDateTime::Now().GetTicks()));
+
+			// Check the new directory's contents too
+			if (listed_dirs.count(file_path) == 0)
+			{
+				vector<string>      files, dirs;
+				DirArchiveTraverser traverser(files, dirs);
+				wxDir(file_path).Traverse(traverser, "", wxDIR_FILES | wxDIR_DIRS);
+				listed_dirs.insert(dirs.begin(), dirs.end());
+				to_check.insert(to_check.end(), dirs.begin(), dirs.end());
+				to_check.insert(to_check.end(), files.begin(), files.end());
+			}
+		}
+
+		// File
+		else if (wxFileExists(file_path))
+		{
+			const auto mtime = wxFileModificationTime(file_path);
+			if (!entry)
+				add_change(DirEntryChange(DirEntryChange::Action::AddedFile, file_path, "", mtime));
+			else if (mtime > file_modification_times_[entry])
+				add_change(DirEntryChange(DirEntryChange::Action::Updated, file_path, entry->path(true), mtime));
+		}
+
+		// Deleted
+		else if (entry)
+			add_change(DirEntryChange(DirEntryChange::Action::DeletedFile, file_path, entry->path(true)));
+		else if (dir && dir->dirEntry()->exProps().getOr<string>("filePath", "") == file_path)
+			add_change(DirEntryChange(DirEntryChange::Action::DeletedDir, file_path, dir->path()));
+	}
+
+	return changes;
+}
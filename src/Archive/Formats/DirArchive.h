@@ -74,9 +74,10 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// DirArchive-specific
-	void ignoreChangedEntries(vector<DirEntryChange>& changes);
-	void updateChangedEntries(vector<DirEntryChange>& changes);
-	bool shouldIgnoreEntryChange(DirEntryChange& change);
+	void                   ignoreChangedEntries(vector<DirEntryChange>& changes);
+	void                   updateChangedEntries(vector<DirEntryChange>& changes);
+	bool                   shouldIgnoreEntryChange(DirEntryChange& change);
+	vector<DirEntryChange> changedEntries(const vector<string>& file_paths);
 
 private:
 	char                            separator_;
@@ -25,7 +25,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isDiskArchive(MemChunk& mc);
+	static bool isDiskArchive(const MemChunk& mc);
 	static bool isDiskArchive(const string& filename);
 };
 } // namespace slade
@@ -33,6 +33,7 @@
 #include "GZipArchive.h"
 #include "General/Misc.h"
 #include "Utility/Compression.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -46,19 +47,22 @@ using namespace slade;
 
 
 // -----------------------------------------------------------------------------
-// Reads gzip format data from a MemChunk
-// Returns true if successful, false otherwise
+// Reads the gzip header from [mc], which is the start of a gzip file of
+// [file_size] bytes. [name] is set to the stored (or extrapolated) entry name.
+// On success, [mc] is positioned at the start of the deflate stream.
+// Returns false if the header is invalid or incomplete
 // -----------------------------------------------------------------------------
-bool GZipArchive::open(MemChunk& mc)
+bool GZipArchive::readHeader(MemChunk& mc, size_t file_size, string& name)
 {
 	// Minimal metadata size is 18: 10 for header, 8 for footer
 	size_t mds  = 18;
-	size_t size = mc.size();
-	if (mds > size)
+	size_t size = file_size;
+	if (mds > size || mc.size() < 10)
 		return false;
 
 	// Read header
 	uint8_t header[4];
+	mc.seek(0, SEEK_SET);
 	mc.read(header, 4);
 
 	// Check for GZip header; we'll only accept deflated gzip files
@@ -66,7 +70,6 @@ bool GZipArchive::open(MemChunk& mc)
 	if ((!(header[0] == ID1 && header[1] == ID2 && header[2] == DEFLATE)) || (header[3] & FLG_FUNKN))
 		return false;
 
-	bool ftext = (header[3] & FLG_FTEXT) != 0;
 	bool fhcrc = (header[3] & FLG_FHCRC) != 0;
 	bool fxtra = (header[3] & FLG_FXTRA) != 0;
 	bool fname = (header[3] & FLG_FNAME) != 0;
@@ -83,23 +86,25 @@ bool GZipArchive::open(MemChunk& mc)
 	if (fxtra)
 	{
 		uint16_t xlen;
-		mc.read(&xlen, 2);
+		if (!mc.read(&xlen, 2))
+			return false;
 		xlen = wxUINT16_SWAP_ON_BE(xlen);
 		mds += xlen + 2;
-		if (mds > size)
+		if (mds > size || mc.currentPos() + xlen > mc.size())
 			return false;
 		mc.exportMemChunk(xtra_, mc.currentPos(), xlen);
 		mc.seek(xlen, SEEK_CUR);
 	}
 
 	// Skip past name, if any
-	string name;
+	name.clear();
 	if (fname)
 	{
 		char c;
 		do
 		{
-			mc.read(&c, 1);
+			if (!mc.read(&c, 1))
+				return false;
 			if (c)
 				name += c;
 			++mds;
@@ -118,12 +123,14 @@ bool GZipArchive::open(MemChunk& mc)
 	}
 
 	// Skip past comment
+	comment_.clear();
 	if (fcmnt)
 	{
 		char c;
 		do
 		{
-			mc.read(&c, 1);
+			if (!mc.read(&c, 1))
+				return false;
 			if (c)
 				comment_ += c;
 			++mds;
@@ -134,12 +141,10 @@ bool GZipArchive::open(MemChunk& mc)
 	// Skip past CRC 16 check
 	if (fhcrc)
 	{
-		uint8_t* crcbuffer = new uint8_t[mc.currentPos()];
-		memcpy(crcbuffer, mc.data(), mc.currentPos());
-		uint32_t fullcrc = misc::crc(crcbuffer, mc.currentPos());
-		delete[] crcbuffer;
+		uint32_t fullcrc = misc::crc(mc.data(), mc.currentPos());
 		uint16_t hcrc;
-		mc.read(&hcrc, 2);
+		if (!mc.read(&hcrc, 2))
+			return false;
 		hcrc = wxUINT16_SWAP_ON_BE(hcrc);
 		mds += 2;
 		if (hcrc != (fullcrc & 0x0000FFFF))
@@ -149,28 +154,162 @@ bool GZipArchive::open(MemChunk& mc)
 	}
 
 	// Header is over
-	if (mds > size || mc.currentPos() + 8 > size)
-		return false;
+	return !(mds > size || mc.currentPos() + 8 > size);
+}
 
-	// Let's create the entry
+// -----------------------------------------------------------------------------
+// Writes the gzip header (for the current entry and flags) to [mc]
+// -----------------------------------------------------------------------------
+void GZipArchive::writeHeader(MemChunk& mc)
+{
+	// zlib would only give us a minimal header, so we make our own
+	uint8_t header[4];
+	header[0] = ID1;
+	header[1] = ID2;
+	header[2] = DEFLATE;
+	header[3] = flags_;
+	mc.write(header, 4);
+
+	// Update mtime if the file was modified
+	if (entryAt(0)->state() != ArchiveEntry::State::Unmodified)
+	{
+		mtime_ = ::wxGetLocalTime();
+	}
+
+	// Write mtime
+	uint32_t working = wxUINT32_SWAP_ON_BE(mtime_);
+	mc.write(&working, 4);
+
+	// Write other stuff
+	mc.write(&xfl_, 1);
+	mc.write(&os_, 1);
+
+	// Any extra content that may have been there
+	if (flags_ & FLG_FXTRA)
+	{
+		uint16_t xlen = wxUINT16_SWAP_ON_BE(xtra_.size());
+		mc.write(&xlen, 2);
+		mc.write(xtra_.data(), xtra_.size());
+	}
+
+	// File name, if not extrapolated from archive name
+	if (flags_ & FLG_FNAME)
+	{
+		mc.write(entryAt(0)->name().data(), entryAt(0)->name().size());
+		uint8_t zero = 0;
+		mc.write(&zero, 1); // Terminate string
+	}
+
+	// Comment, if there were actually one
+	if (flags_ & FLG_FCMNT)
+	{
+		mc.write(comment_.data(), comment_.size());
+		uint8_t zero = 0;
+		mc.write(&zero, 1); // Terminate string
+	}
+
+	// And finally, the half CRC, which we recalculate
+	if (flags_ & FLG_FHCRC)
+	{
+		uint32_t fullcrc = misc::crc(mc.data(), mc.size());
+		uint16_t hcrc    = (fullcrc & 0x0000FFFF);
+		hcrc             = wxUINT16_SWAP_ON_BE(hcrc);
+		mc.write(&hcrc, 2);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Creates the archive's single entry named [name] from the inflated [data]
+// -----------------------------------------------------------------------------
+void GZipArchive::createEntry(const string& name, MemChunk& data)
+{
 	ArchiveModSignalBlocker sig_blocker{ *this };
-	auto                    entry = std::make_shared<ArchiveEntry>(name, size - mds);
-	MemChunk                xdata;
-	if (compression::gzipInflate(mc, xdata))
-		entry->importMemChunk(xdata);
-	else
-		return false;
+	auto                    entry = std::make_shared<ArchiveEntry>(name);
+	entry->importMemChunk(data);
 	rootDir()->addEntry(entry);
 	EntryType::detectEntryType(*entry);
 	entry->setState(ArchiveEntry::State::Unmodified);
 
 	sig_blocker.unblock();
 	setModified(false);
+}
+
+// -----------------------------------------------------------------------------
+// Reads gzip format data from a MemChunk
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool GZipArchive::open(MemChunk& mc)
+{
+	string name;
+	if (!readHeader(mc, mc.size(), name))
+		return false;
+
+	// Let's create the entry
+	MemChunk xdata;
+	if (!compression::gzipInflate(mc, xdata))
+		return false;
+	createEntry(name, xdata);
 
 	// Finish
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads a gzip file from disk, inflating it as it is read rather than loading
+// the whole compressed file into memory first
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool GZipArchive::open(string_view filename)
+{
+	SFile file(filename);
+	if (!file.isOpen())
+	{
+		global::error = "Unable to open file. Make sure it isn't in use by another program.";
+		return false;
+	}
+
+	// Read the header (the name and comment fields are unbounded, but a header
+	// won't realistically be larger than this)
+	auto     size = file.size();
+	MemChunk header;
+	if (!file.read(header, std::min<unsigned>(size, 65536)))
+		return false;
+
+	// Update filename before opening (the entry name may come from it)
+	const auto backupname = filename_;
+	filename_             = filename;
+
+	string name;
+	if (!readHeader(header, size, name))
+	{
+		filename_ = backupname;
+
+		// Fall back to reading the whole file if the header didn't fit
+		return header.size() < size ? Archive::open(filename) : false;
+	}
+
+	// Get the inflated size (mod 2^32) from the footer, to size the output buffer
+	uint32_t isize = 0;
+	file.seekFromStart(size - 4);
+	file.read(&isize, 4);
+	isize = wxUINT32_SWAP_ON_BE(isize);
+	file.close();
+
+	// Inflate directly from the file
+	MemChunk xdata;
+	if (!compression::gzipInflateFile(filename_, xdata, isize))
+	{
+		filename_ = backupname;
+		return false;
+	}
+	createEntry(name, xdata);
+
+	file_modified_ = fileutil::fileModifiedTime(filename);
+	on_disk_       = true;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Writes the gzip archive to a MemChunk
 // Returns true if successful, false otherwise
@@ -185,66 +324,12 @@ bool GZipArchive::write(MemChunk& mc, bool update)
 		MemChunk stream;
 		if (compression::gzipDeflate(entryAt(0)->data(), stream, 9))
 		{
-			auto     data = stream.data();
-			uint32_t working;
-			size_t   size = stream.size();
+			auto   data = stream.data();
+			size_t size = stream.size();
 			if (size < 18)
 				return false;
 
-			// zlib will have given us a minimal header, so we make our own
-			uint8_t header[4];
-			header[0] = ID1;
-			header[1] = ID2;
-			header[2] = DEFLATE;
-			header[3] = flags_;
-			mc.write(header, 4);
-
-			// Update mtime if the file was modified
-			if (entryAt(0)->state() != ArchiveEntry::State::Unmodified)
-			{
-				mtime_ = ::wxGetLocalTime();
-			}
-
-			// Write mtime
-			working = wxUINT32_SWAP_ON_BE(mtime_);
-			mc.write(&working, 4);
-
-			// Write other stuff
-			mc.write(&xfl_, 1);
-			mc.write(&os_, 1);
-
-			// Any extra content that may have been there
-			if (flags_ & FLG_FXTRA)
-			{
-				uint16_t xlen = wxUINT16_SWAP_ON_BE(xtra_.size());
-				mc.write(&xlen, 2);
-				mc.write(xtra_.data(), xtra_.size());
-			}
-
-			// File name, if not extrapolated from archive name
-			if (flags_ & FLG_FNAME)
-			{
-				mc.write(entryAt(0)->name().data(), entryAt(0)->name().size());
-				uint8_t zero = 0;
-				mc.write(&zero, 1); // Terminate string
-			}
-
-			// Comment, if there were actually one
-			if (flags_ & FLG_FCMNT)
-			{
-				mc.write(comment_.data(), comment_.size());
-				uint8_t zero = 0;
-				mc.write(&zero, 1); // Terminate string
-			}
-
-			// And finally, the half CRC, which we recalculate
-			if (flags_ & FLG_FHCRC)
-			{
-				uint32_t fullcrc = misc::crc(mc.data(), mc.size());
-				uint16_t hcrc    = (fullcrc & 0x0000FFFF);
-				hcrc             = wxUINT16_SWAP_ON_BE(hcrc);
-				mc.write(&hcrc, 2);
-			}
+			writeHeader(mc);
 
 			// Now that the pleasantries are dispensed with,
 			// let's get with the meat of the matter
@@ -254,6 +339,36 @@ bool GZipArchive::write(MemChunk& mc, bool update)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the gzip archive to a file, compressing the entry data directly to
+// the file rather than to an intermediate MemChunk
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool GZipArchive::write(string_view filename, bool update)
+{
+	if (numEntries() != 1)
+		return false;
+
+	// Get entry data (if we're overwriting the archive's own file, it must be
+	// loaded before the file is truncated)
+	auto& data = entryAt(0)->data();
+
+	MemChunk header;
+	writeHeader(header);
+
+	SFile file(filename, SFile::Mode::Write);
+	if (!file.isOpen() || !file.write(header.data(), header.size()))
+		return false;
+
+	// Raw deflate stream (negative windowbits), followed by the CRC-32 and size footer
+	if (!compression::deflateToFile(data.data(), data.size(), file, 9, -15))
+		return false;
+
+	uint32_t footer[2];
+	footer[0] = wxUINT32_SWAP_ON_BE(compression::crc(data.data(), data.size()));
+	footer[1] = wxUINT32_SWAP_ON_BE(static_cast<uint32_t>(data.size()));
+	return file.write(footer, 8);
+}
 
 // -----------------------------------------------------------------------------
 // Renames the entry and set the fname flag
@@ -383,7 +498,7 @@ vector<ArchiveEntry*> GZipArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid GZip archive
 // -----------------------------------------------------------------------------
-bool GZipArchive::isGZipArchive(MemChunk& mc)
+bool GZipArchive::isGZipArchive(const MemChunk& mc)
 {
 	// Minimal metadata size is 18: 10 for header, 8 for footer
 	size_t mds  = 18;
@@ -393,7 +508,7 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 
 	// Read header
 	uint8_t header[4];
-	mc.read(header, 4);
+	mc.read(0, header, 4);
 
 	// Check for GZip header; we'll only accept deflated gzip files
 	// and reject any field using unknown flags
@@ -406,36 +521,28 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	bool fname = (header[3] & FLG_FNAME) != 0;
 	bool fcmnt = (header[3] & FLG_FCMNT) != 0;
 
-	uint32_t mtime;
-	mc.read(&mtime, 4);
-
-	uint8_t xfl;
-	mc.read(&xfl, 1);
-	uint8_t os;
-	mc.read(&os, 1);
+	// Skip mtime, xfl and os
+	size_t pos = 10;
 
 	// Skip extra fields which may be there
 	if (fxtra)
 	{
 		uint16_t xlen;
-		mc.read(&xlen, 2);
+		mc.read(pos, &xlen, 2);
 		xlen = wxUINT16_SWAP_ON_BE(xlen);
 		mds += xlen + 2;
 		if (mds > size)
 			return false;
-		mc.seek(xlen, SEEK_CUR);
+		pos += xlen + 2;
 	}
 
 	// Skip past name, if any
 	if (fname)
 	{
-		string name;
-		char   c;
+		uint8_t c;
 		do
 		{
-			mc.read(&c, 1);
-			if (c)
-				name += c;
+			c = pos < size ? mc[pos++] : 0;
 			++mds;
 		} while (c != 0 && size > mds);
 	}
@@ -443,13 +550,10 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	// Skip past comment
 	if (fcmnt)
 	{
-		string comment;
-		char   c;
+		uint8_t c;
 		do
 		{
-			mc.read(&c, 1);
-			if (c)
-				comment += c;
+			c = pos < size ? mc[pos++] : 0;
 			++mds;
 		} while (c != 0 && size > mds);
 	}
@@ -457,13 +561,12 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	// Skip past CRC 16 check
 	if (fhcrc)
 	{
-		uint16_t hcrc;
-		mc.read(&hcrc, 2);
+		pos += 2;
 		mds += 2;
 	}
 
 	// Header is over
-	if (mds > size || mc.currentPos() + 8 > size)
+	if (mds > size || pos + 8 > size)
 		return false;
 
 	// If it's passed to here it's probably a gzip file
@@ -11,10 +11,12 @@ public:
 	~GZipArchive() = default;
 
 	// Opening
-	bool open(MemChunk& mc) override;
+	bool open(string_view filename) override; // Open from File
+	bool open(MemChunk& mc) override;         // Open from MemChunk
 
 	// Writing/Saving
-	bool write(MemChunk& mc, bool update = true) override;
+	bool write(MemChunk& mc, bool update = true) override;         // Write to MemChunk
+	bool write(string_view filename, bool update = true) override; // Write to File
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
@@ -49,7 +51,7 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isGZipArchive(MemChunk& mc);
+	static bool isGZipArchive(const MemChunk& mc);
 	static bool isGZipArchive(const string& filename);
 
 private:
@@ -69,5 +71,9 @@ private:
 	static const int FLG_FNAME = 0x08;
 	static const int FLG_FCMNT = 0x10;
 	static const int FLG_FUNKN = 0xE0;
+
+	bool readHeader(MemChunk& mc, size_t file_size, string& name);
+	void writeHeader(MemChunk& mc);
+	void createEntry(const string& name, MemChunk& data);
 };
 } // namespace slade
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GobArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -39,10 +40,14 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Directory record: offset (4), size (4), name (13, max. 12 characters)
+const FixedDirLoader::RecordFormat dir_format{ 21, 8, 12, 0, 4 };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -61,7 +66,7 @@ uint32_t GobArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -73,7 +78,7 @@ void GobArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -119,73 +124,13 @@ bool GobArchive::open(MemChunk& mc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
 	// Read the directory
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading gob archive data");
-	for (uint32_t d = 0; d < num_lumps; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
-
-		// Read lump info
-		uint32_t offset   = 0;
-		uint32_t size     = 0;
-		char     name[13] = "";
-
-		mc.read(&offset, 4); // Offset
-		mc.read(&size, 4);   // Size
-		mc.read(name, 13);   // Name
-		name[12] = '\0';
-
-		// Byteswap values for big endian if needed
-		size = wxINT32_SWAP_ON_BE(size);
-
-		// If the lump data goes past the end of the file,
-		// the gobfile is invalid
-		if (offset + size > mc.size())
-		{
-			log::error("GobArchive::open: gob archive is invalid or corrupt");
-			global::error = "Archive is invalid and/or corrupt";
-			return false;
-		}
-
-		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(name, size);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-		nlump->setState(ArchiveEntry::State::Unmodified);
-
-		// Add to entry list
-		rootDir()->addEntry(nlump);
-	}
+	if (!loader.readDirectory(dir_offset + 4, num_lumps))
+		return false;
 
 	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
-
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	loader.detectEntryTypes();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -250,7 +195,7 @@ bool GobArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 	}
 
@@ -275,6 +220,10 @@ bool GobArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, getEntryOffset(entry)))
+		return true;
+
 	// Open gobfile
 	wxFile file(filename_);
 
@@ -298,7 +247,7 @@ bool GobArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Dark Forces gob archive
 // -----------------------------------------------------------------------------
-bool GobArchive::isGobArchive(MemChunk& mc)
+bool GobArchive::isGobArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -310,8 +259,7 @@ bool GobArchive::isGobArchive(MemChunk& mc)
 
 	// Get directory offset
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&dir_offset, 4);
+	mc.read(4, &dir_offset, 4);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
 
 	// Check size
@@ -320,8 +268,7 @@ bool GobArchive::isGobArchive(MemChunk& mc)
 
 	// Get number of lumps
 	uint32_t num_lumps = 0;
-	mc.seek(dir_offset, SEEK_SET);
-	mc.read(&num_lumps, 4);
+	mc.read(dir_offset, &num_lumps, 4);
 	num_lumps = wxINT32_SWAP_ON_BE(num_lumps);
 
 	// Compute directory size
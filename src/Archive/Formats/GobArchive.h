@@ -22,7 +22,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isGobArchive(MemChunk& mc);
+	static bool isGobArchive(const MemChunk& mc);
 	static bool isGobArchive(const string& filename);
 };
 } // namespace slade
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GrpArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -39,10 +40,14 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Directory record: name (12), size (4)
+const FixedDirLoader::RecordFormat dir_format{ 16, 0, 12, 0, 12, FixedDirLoader::DataLayout::AfterDirectory };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -61,7 +66,7 @@ uint32_t GrpArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -73,7 +78,7 @@ void GrpArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -110,79 +115,15 @@ bool GrpArchive::open(MemChunk& mc)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
-	// The header takes as much space as a directory entry
-	uint32_t entryoffset = 16 * (1 + num_lumps);
-
-	// Read the directory
+	// Read the directory (records directly follow the header, which takes as
+	// much space as a directory record. Entry data follows the directory)
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading grp archive data");
-	for (uint32_t d = 0; d < num_lumps; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
-
-		// Read lump info
-		char     name[13] = "";
-		uint32_t offset   = entryoffset;
-		uint32_t size     = 0;
-
-		mc.read(name, 12); // Name
-		mc.read(&size, 4); // Size
-		name[12] = '\0';
-
-		// Byteswap values for big endian if needed
-		size = wxINT32_SWAP_ON_BE(size);
-
-		// Increase offset of next entry by this entry's size
-		entryoffset += size;
-
-		// If the lump data goes past the end of the file,
-		// the grpfile is invalid
-		if (offset + size > mc.size())
-		{
-			log::error("GrpArchive::open: grp archive is invalid or corrupt");
-			global::error = "Archive is invalid and/or corrupt";
-			return false;
-		}
-
-		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(name, size);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-		nlump->setState(ArchiveEntry::State::Unmodified);
-
-		// Add to entry list
-		rootDir()->addEntry(nlump);
-	}
+	if (!loader.readDirectory(16, num_lumps))
+		return false;
 
 	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
-
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	loader.detectEntryTypes();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -227,7 +168,7 @@ bool GrpArchive::write(MemChunk& mc, bool update)
 		{
 			long offset = getEntryOffset(entry);
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 	}
 
@@ -259,6 +200,10 @@ bool GrpArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, getEntryOffset(entry)))
+		return true;
+
 	// Open grpfile
 	wxFile file(filename_);
 
@@ -282,7 +227,7 @@ bool GrpArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Duke Nukem 3D grp archive
 // -----------------------------------------------------------------------------
-bool GrpArchive::isGrpArchive(MemChunk& mc)
+bool GrpArchive::isGrpArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 16)
@@ -291,9 +236,8 @@ bool GrpArchive::isGrpArchive(MemChunk& mc)
 	// Get number of lumps
 	uint32_t num_lumps     = 0;
 	char     ken_magic[13] = "";
-	mc.seek(0, SEEK_SET);
-	mc.read(ken_magic, 12); // "KenSilverman"
-	mc.read(&num_lumps, 4); // No. of lumps in grp
+	mc.read(0, ken_magic, 12);  // "KenSilverman"
+	mc.read(12, &num_lumps, 4); // No. of lumps in grp
 
 	// Byteswap values for big endian if needed
 	num_lumps = wxINT32_SWAP_ON_BE(num_lumps);
@@ -310,8 +254,7 @@ bool GrpArchive::isGrpArchive(MemChunk& mc)
 	uint32_t size      = 0;
 	for (uint32_t a = 0; a < num_lumps; ++a)
 	{
-		mc.read(ken_magic, 12);
-		mc.read(&size, 4);
+		mc.read(28 + a * 16, &size, 4);
 		totalsize += size;
 	}
 
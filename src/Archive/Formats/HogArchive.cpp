@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "HogArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -40,10 +41,14 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Entry header (directly before the entry data): name (13), size (4)
+const FixedDirLoader::RecordFormat entry_format{ 17, 0, 13, 0, 13, FixedDirLoader::DataLayout::Inline };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -128,7 +133,7 @@ uint32_t HogArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -140,7 +145,7 @@ void HogArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -165,83 +170,35 @@ bool HogArchive::open(MemChunk& mc)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
-	// Iterate through files to see if the size seems okay
+	// Read entries (each entry's data is preceded by its header)
+	FixedDirLoader loader(*this, mc, entry_format);
 	ui::setSplashProgressMessage("Reading hog archive data");
-	size_t   iter_offset = 3;
-	uint32_t num_lumps   = 0;
-	while (iter_offset < archive_size)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)iter_offset / (float)archive_size));
-
-		// If the lump data goes past the end of the file,
-		// the hogfile is invalid
-		if (iter_offset + 17 > archive_size)
-		{
-			log::error("HogArchive::open: hog archive is invalid or corrupt");
-			global::error = "Archive is invalid and/or corrupt";
+	auto read_entry = [&loader](FixedDirLoader::Record& record) {
+		auto entry = loader.addEntry(record);
+		if (!entry)
 			return false;
-		}
-
-		// Setup variables
-		num_lumps++;
-		size_t offset   = iter_offset + 17;
-		size_t size     = mc.readL32(iter_offset + 13);
-		char   name[14] = "";
-		mc.seek(iter_offset, SEEK_SET);
-		mc.read(name, 13);
-		name[13] = 0;
-
-		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(name, size);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Handle txb/ctb as archive level encryption. This is not strictly
 		// correct, but since we're not making a proper Descent editor this
 		// prevents needless complication on loading text data.
-		if (shouldEncodeTxb(nlump->name()))
-			nlump->setEncryption(ArchiveEntry::Encryption::TXB);
-
-		// Add to entry list
-		rootDir()->addEntry(nlump);
-
-		// Update entry size to compute next offset
-		iter_offset = offset + size;
-	}
-
-	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
-
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
+		if (shouldEncodeTxb(entry->name()))
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			if (entry->encryption() == ArchiveEntry::Encryption::TXB)
-				decodeTxb(edata);
+			entry->setEncryption(ArchiveEntry::Encryption::TXB);
+
+			// Decode the data now, so it isn't referenced from the archive as-is
+			MemChunk edata;
+			loader.data().exportMemChunk(edata, record.offset, record.size);
+			decodeTxb(edata);
 			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
+		return true;
+	};
+	if (!loader.readDirectory(3, 0, read_entry))
+		return false;
 
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	// Detect all entry types
+	loader.detectEntryTypes();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -269,7 +226,7 @@ bool HogArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 		offset += entry->size();
 	}
@@ -326,6 +283,11 @@ bool HogArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	// (txb entries are decoded when opened, so can't reference it as-is)
+	if (entry->encryption() == ArchiveEntry::Encryption::None && loadMappedEntryData(entry, getEntryOffset(entry)))
+		return true;
+
 	// Open hogfile
 	wxFile file(filename_);
 
@@ -400,7 +362,7 @@ bool HogArchive::renameEntry(ArchiveEntry* entry, string_view name)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Descent hog archive
 // -----------------------------------------------------------------------------
-bool HogArchive::isHogArchive(MemChunk& mc)
+bool HogArchive::isHogArchive(const MemChunk& mc)
 {
 	// Check size
 	size_t size = mc.size();
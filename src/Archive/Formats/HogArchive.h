@@ -32,7 +32,7 @@ public:
 	bool renameEntry(ArchiveEntry* entry, string_view name) override;
 
 	// Static functions
-	static bool isHogArchive(MemChunk& mc);
+	static bool isHogArchive(const MemChunk& mc);
 	static bool isHogArchive(const string& filename);
 };
 } // namespace slade
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "LfdArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -40,10 +41,14 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Entry header (directly before the entry data): type (4), name (8), size (4)
+const FixedDirLoader::RecordFormat entry_format{ 16, 4, 8, 0, 12, FixedDirLoader::DataLayout::Inline };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -62,7 +67,7 @@ uint32_t LfdArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -74,7 +79,7 @@ void LfdArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -111,89 +116,27 @@ bool LfdArchive::open(MemChunk& mc)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
-	// Read each entry
+	// Read entries (each entry's data is preceded by its header, the same as
+	// its directory record)
+	FixedDirLoader loader(*this, mc, entry_format);
 	ui::setSplashProgressMessage("Reading lfd archive data");
-	size_t offset = dir_len + 16;
-	size_t size   = mc.size();
-	for (uint32_t d = 0; offset < size; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
-
-		// Read lump info
-		uint32_t length  = 0;
-		char     type[5] = "";
-		char     name[9] = "";
-
-		mc.read(type, 4);    // Type
-		mc.read(name, 8);    // Name
-		mc.read(&length, 4); // Size
-		name[8] = '\0';
-		type[4] = 0;
-
-		// Move past the header
-		offset += 16;
-
-		// Byteswap values for big endian if needed
-		length = wxINT32_SWAP_ON_BE(length);
-
-		// If the lump data goes past the end of the file,
-		// the gobfile is invalid
-		if (offset + length > size)
-		{
-			log::error("LfdArchive::open: lfd archive is invalid or corrupt");
-			global::error = "Archive is invalid and/or corrupt";
-			return false;
-		}
-
-		// Create & setup lump
-		strutil::Path fn(name);
-		fn.setExtension(type);
-		auto nlump = std::make_shared<ArchiveEntry>(fn.fileName(), length);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-		nlump->setState(ArchiveEntry::State::Unmodified);
-
-		// Add to entry list
-		rootDir()->addEntry(nlump);
-
-		// Move to next entry
-		offset += length;
-		mc.seek(offset, SEEK_SET);
-	}
+	auto read_entry = [&loader](FixedDirLoader::Record& record) {
+		// Use the type as the entry name extension
+		auto          type = reinterpret_cast<const char*>(record.data);
+		strutil::Path fn(record.name);
+		fn.setExtension(string_view{ type, static_cast<size_t>(std::find(type, type + 4, '\0') - type) });
+		record.name = fn.fileName();
+
+		return loader.addEntry(record) != nullptr;
+	};
+	if (!loader.readDirectory(dir_len + 16, 0, read_entry))
+		return false;
 
 	if (num_lumps != numEntries())
 		log::warning("Computed {} lumps, but actually {} entries", num_lumps, numEntries());
 
 	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
-
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	loader.detectEntryTypes();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -222,7 +165,7 @@ bool LfdArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)total_size;
+			entry->storage().offset = total_size;
 		}
 		total_size += entry->size();
 	}
@@ -305,6 +248,10 @@ bool LfdArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, getEntryOffset(entry)))
+		return true;
+
 	// Open lfdfile
 	wxFile file(filename_);
 
@@ -328,7 +275,7 @@ bool LfdArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Dark Forces lfd archive
 // -----------------------------------------------------------------------------
-bool LfdArchive::isLfdArchive(MemChunk& mc)
+bool LfdArchive::isLfdArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -340,8 +287,7 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 
 	// Get offset of first entry
 	uint32_t dir_offset = 0;
-	mc.seek(12, SEEK_SET);
-	mc.read(&dir_offset, 4);
+	mc.read(12, &dir_offset, 4);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset) + 16;
 	if (dir_offset % 16)
 		return false;
@@ -351,11 +297,11 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 	char     name2[9];
 	uint32_t len1;
 	uint32_t len2;
-	mc.read(type1, 4);
+	mc.read(16, type1, 4);
 	type1[4] = 0;
-	mc.read(name1, 8);
+	mc.read(20, name1, 8);
 	name1[8] = 0;
-	mc.read(&len1, 4);
+	mc.read(28, &len1, 4);
 	len1 = wxINT32_SWAP_ON_BE(len1);
 
 	// Check size
@@ -363,12 +309,11 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 		return false;
 
 	// Compare
-	mc.seek(dir_offset, SEEK_SET);
-	mc.read(type2, 4);
+	mc.read(dir_offset, type2, 4);
 	type2[4] = 0;
-	mc.read(name2, 8);
+	mc.read(dir_offset + 4, name2, 8);
 	name2[8] = 0;
-	mc.read(&len2, 4);
+	mc.read(dir_offset + 12, &len2, 4);
 	len2 = wxINT32_SWAP_ON_BE(len2);
 
 	if (strcmp(type1, type2) != 0 || strcmp(name1, name2) != 0 || len1 != len2)
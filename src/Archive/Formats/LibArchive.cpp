@@ -53,7 +53,7 @@ uint32_t LibArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -65,7 +65,7 @@ void LibArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -122,7 +122,7 @@ bool LibArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(myname, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->storage().offset = offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -131,7 +131,6 @@ bool LibArchive::open(MemChunk& mc)
 	}
 
 	// Detect all entry types
-	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
@@ -145,8 +144,7 @@ bool LibArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
+			entry->importMemChunk(mc, getEntryOffset(entry), entry->size());
 		}
 
 		// Detect entry type
@@ -220,7 +218,7 @@ bool LibArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)wxINT32_SWAP_ON_BE(offset);
+			entry->storage().offset = wxINT32_SWAP_ON_BE(offset);
 		}
 	}
 
@@ -273,15 +271,14 @@ bool LibArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Shadowcaster lib archive
 // -----------------------------------------------------------------------------
-bool LibArchive::isLibArchive(MemChunk& mc)
+bool LibArchive::isLibArchive(const MemChunk& mc)
 {
 	if (mc.size() < 64)
 		return false;
 
 	// Read lib footer
-	mc.seek(2, SEEK_END);
 	uint32_t num_lumps = 0;
-	mc.read(&num_lumps, 2); // Size
+	mc.read(mc.size() - 2, &num_lumps, 2); // Size
 	num_lumps          = wxINT16_SWAP_ON_BE(num_lumps);
 	int32_t dir_offset = mc.size() - (2 + (num_lumps * 21));
 
@@ -290,15 +287,14 @@ bool LibArchive::isLibArchive(MemChunk& mc)
 		return false;
 
 	// Check directory offset is decent
-	mc.seek(dir_offset, SEEK_SET);
 	char     myname[13] = "";
 	uint32_t offset     = 0;
 	uint32_t size       = 0;
 	uint8_t  dummy      = 0;
-	mc.read(&size, 4);   // Size
-	mc.read(&offset, 4); // Offset
-	mc.read(myname, 12); // Name
-	mc.read(&dummy, 1);  // Separator
+	mc.read(dir_offset, &size, 4);       // Size
+	mc.read(dir_offset + 4, &offset, 4); // Offset
+	mc.read(dir_offset + 8, myname, 12); // Name
+	mc.read(dir_offset + 20, &dummy, 1); // Separator
 	offset     = wxINT32_SWAP_ON_BE(offset);
 	size       = wxINT32_SWAP_ON_BE(size);
 	myname[12] = '\0';
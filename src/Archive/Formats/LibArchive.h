@@ -22,7 +22,7 @@ public:
 	bool     loadEntryData(ArchiveEntry* entry) override;
 	unsigned numEntries() override { return rootDir()->numEntries(); }
 
-	static bool isLibArchive(MemChunk& mc);
+	static bool isLibArchive(const MemChunk& mc);
 	static bool isLibArchive(const string& filename);
 };
 } // namespace slade
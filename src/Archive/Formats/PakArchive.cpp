@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "PakArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -39,10 +40,14 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Directory record: name (56, with path), offset (4), size (4)
+const FixedDirLoader::RecordFormat dir_format{ 64, 0, 56, 56, 60, FixedDirLoader::DataLayout::Offset, false, true };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -83,78 +88,13 @@ bool PakArchive::open(MemChunk& mc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
 	// Read the directory
-	size_t num_entries = dir_size / 64;
-	mc.seek(dir_offset, SEEK_SET);
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading pak archive data");
-	for (uint32_t d = 0; d < num_entries; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_entries));
-
-		// Read entry info
-		char    name[56];
-		int32_t offset;
-		int32_t size;
-		mc.read(name, 56);
-		mc.read(&offset, 4);
-		mc.read(&size, 4);
-
-		// Byteswap if needed
-		offset = wxINT32_SWAP_ON_BE(offset);
-		size   = wxINT32_SWAP_ON_BE(size);
-
-		// Check offset+size
-		if ((unsigned)(offset + size) > mc.size())
-		{
-			log::error("PakArchive::open: Pak archive is invalid or corrupt (entry goes past end of file)");
-			global::error = "Archive is invalid and/or corrupt";
-			return false;
-		}
-
-		// Create directory if needed
-		auto dir = createDir(strutil::Path::pathOf(name));
-
-		// Create entry
-		auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-		entry->exProp("Offset") = (int)offset;
-		entry->setLoaded(false);
-		entry->setState(ArchiveEntry::State::Unmodified);
-
-		// Add to directory
-		dir->addEntry(entry);
-	}
+	if (!loader.readDirectory(dir_offset, dir_size / 64))
+		return false;
 
 	// Detect all entry types
-	MemChunk              edata;
-	vector<ArchiveEntry*> all_entries;
-	putEntryTreeAsList(all_entries);
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < all_entries.size(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_entries)));
-
-		// Get entry
-		auto entry = all_entries[a];
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	loader.detectEntryTypes();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -215,7 +155,7 @@ bool PakArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 
 		// Check entry name
@@ -280,6 +220,10 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, entry->storage().offset))
+		return true;
+
 	// Open archive file
 	wxFile file(filename_);
 
@@ -291,7 +235,7 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -311,7 +255,7 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Quake pak archive
 // -----------------------------------------------------------------------------
-bool PakArchive::isPakArchive(MemChunk& mc)
+bool PakArchive::isPakArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	if (mc.size() < 12)
@@ -321,10 +265,9 @@ bool PakArchive::isPakArchive(MemChunk& mc)
 	char    pack[4];
 	int32_t dir_offset;
 	int32_t dir_size;
-	mc.seek(0, SEEK_SET);
-	mc.read(pack, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
+	mc.read(0, pack, 4);
+	mc.read(4, &dir_offset, 4);
+	mc.read(8, &dir_size, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "PodArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/Console.h"
 #include "General/UI.h"
 #include "MainEditor/MainEditor.h"
@@ -42,10 +43,14 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Directory record (FileEntry): name (32, with path), size (4), offset (4)
+const FixedDirLoader::RecordFormat dir_format{ 40, 0, 32, 36, 32, FixedDirLoader::DataLayout::Offset, false, true };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -91,63 +96,17 @@ bool PodArchive::open(MemChunk& mc)
 	// Read id
 	mc.read(id_, 80);
 
-	// Read directory
-	vector<FileEntry> files(num_files);
-	mc.read(files.data(), num_files * sizeof(FileEntry));
-
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
-	// Create entries
+	// Read the directory (directly follows the header)
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading pod archive data");
-	for (unsigned a = 0; a < num_files; a++)
-	{
-		// Create entry
-		auto new_entry = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(files[a].name), files[a].size);
-		new_entry->exProp("Offset") = files[a].offset;
-		new_entry->setLoaded(false);
-
-		// Add entry and directory to directory tree
-		auto ndir = createDir(strutil::Path::pathOf(files[a].name, false));
-		ndir->addEntry(new_entry);
-
-		new_entry->setState(ArchiveEntry::State::Unmodified);
-
-		log::info(5, "File size: {}, offset: {}, name: {}", files[a].size, files[a].offset, files[a].name);
-	}
-
-	// Detect entry types
-	vector<ArchiveEntry*> all_entries;
-	putEntryTreeAsList(all_entries);
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (unsigned a = 0; a < all_entries.size(); a++)
-	{
-		// Skip dir/marker
-		if (all_entries[a]->size() == 0 || all_entries[a]->type() == EntryType::folderType())
-		{
-			all_entries[a]->setState(ArchiveEntry::State::Unmodified);
-			continue;
-		}
-
-		// Update splash window progress
-		ui::setSplashProgress((float)a / (float)all_entries.size());
-
-		// Read data
-		MemChunk edata;
-		mc.exportMemChunk(edata, all_entries[a]->exProp<int>("Offset"), all_entries[a]->size());
-		all_entries[a]->importMemChunk(edata);
-
-		// Detect entry type
-		EntryType::detectEntryType(*all_entries[a]);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			all_entries[a]->unloadData();
+	if (!loader.readDirectory(84, num_files))
+		return false;
 
-		// Set entry to unchanged
-		all_entries[a]->setState(ArchiveEntry::State::Unmodified);
-		log::info(5, "entry {} size {}", all_entries[a]->name(), all_entries[a]->size());
-	}
+	// Detect all entry types
+	loader.detectEntryTypes();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -220,7 +179,7 @@ bool PodArchive::write(MemChunk& mc, bool update)
 			5,
 			"entry {}: old={} new={} size={}",
 			fe.name,
-			entry->exProp<int>("Offset"),
+			entry->storage().offset,
 			fe.offset,
 			entry->size());
 
@@ -254,6 +213,10 @@ bool PodArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, entry->storage().offset))
+		return true;
+
 	// Open file
 	wxFile file(filename_);
 
@@ -265,7 +228,7 @@ bool PodArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to lump offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -285,23 +248,18 @@ bool PodArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid pod archive
 // -----------------------------------------------------------------------------
-bool PodArchive::isPodArchive(MemChunk& mc)
+bool PodArchive::isPodArchive(const MemChunk& mc)
 {
 	// Check size for header
 	if (mc.size() < 84)
 		return false;
 
 	// Read no. of files
-	mc.seek(0, 0);
 	uint32_t num_files;
-	mc.read(&num_files, 4);
+	mc.read(0, &num_files, 4);
 	if (num_files == 0)
 		return false; // 0 files, unlikely to be a valid archive
 
-	// Read id
-	char id[80];
-	mc.read(id, 80);
-
 	// Check size for directory
 	auto dir_end = 84 + (num_files * 40);
 	if (mc.size() < dir_end)
@@ -311,7 +269,7 @@ bool PodArchive::isPodArchive(MemChunk& mc)
 	FileEntry entry;
 	for (unsigned a = 0; a < num_files; a++)
 	{
-		mc.read(&entry, 40);
+		mc.read(84 + a * 40, &entry, 40);
 		auto end = entry.offset + entry.size;
 		if (end > mc.size() || end < dir_end)
 			return false;
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "ResArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -38,10 +39,15 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Directory record: magic (4, "ReS\0"), name (14), offset (4), size (4),
+// flag guard (2), flags (1), unused (4), unused (2, 0xFFFF), unused (4)
+const FixedDirLoader::RecordFormat dir_format{ 39, 4, 14, 18, 22 };
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -60,7 +66,7 @@ uint32_t ResArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -72,14 +78,16 @@ void ResArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
-// Reads a res directory from a MemChunk
+// Reads the res directory of [num_lumps] records at [dir_offset] into [parent]
+// via [loader], including any subdirectories (entries that are res
+// directories themselves)
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
-bool ResArchive::readDirectory(MemChunk& mc, size_t dir_offset, size_t num_lumps, shared_ptr<ArchiveDir> parent)
+bool ResArchive::readDirectory(FixedDirLoader& loader, uint32_t dir_offset, uint32_t num_lumps, ArchiveDir* parent)
 {
 	if (!parent)
 	{
@@ -87,111 +95,68 @@ bool ResArchive::readDirectory(MemChunk& mc, size_t dir_offset, size_t num_lumps
 		global::error = "Archive is invalid and/or corrupt";
 		return false;
 	}
-	mc.seek(dir_offset, SEEK_SET);
-	for (uint32_t d = 0; d < num_lumps; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
 
-		// Read lump info
-		char     magic[4] = "";
-		char     name[15] = "";
-		uint32_t dumzero1, dumzero2;
-		uint16_t dumff, dumze;
-		uint8_t  flags  = 0;
-		uint32_t offset = 0;
-		uint32_t size   = 0;
-
-		mc.read(magic, 4);   // ReS\0
-		mc.read(name, 14);   // Name
-		mc.read(&offset, 4); // Offset
-		mc.read(&size, 4);   // Size
+	auto read_entry = [&](FixedDirLoader::Record& record) {
+		const auto  data = record.data;
+		const auto& name = record.name;
 
 		// Check the identifier
-		if (magic[0] != 'R' || magic[1] != 'e' || magic[2] != 'S' || magic[3] != 0)
+		if (data[0] != 'R' || data[1] != 'e' || data[2] != 'S' || data[3] != 0)
 		{
-			log::error("ResArchive::readDir: Entry {} ({}@0x{:x}) has invalid directory entry", name, size, offset);
+			log::error(
+				"ResArchive::readDir: Entry {} ({}@0x{:x}) has invalid directory entry", name, record.size, record.offset);
 			global::error = "Archive is invalid and/or corrupt";
 			return false;
 		}
 
-		// Byteswap values for big endian if needed
-		offset   = wxINT32_SWAP_ON_BE(offset);
-		size     = wxINT32_SWAP_ON_BE(size);
-		name[14] = '\0';
-
-		mc.read(&dumze, 2);
+		// Check the unused values
+		uint32_t dumzero1, dumzero2;
+		uint16_t dumff, dumze;
+		memcpy(&dumze, data + 26, 2);
+		memcpy(&dumzero1, data + 29, 4);
+		memcpy(&dumff, data + 33, 2);
+		memcpy(&dumzero2, data + 35, 4);
 		if (dumze)
 			log::info("Flag guard not null for entry {}", name);
-		mc.read(&flags, 1);
-		if (flags != 1 && flags != 17)
+		if (data[28] != 1 && data[28] != 17)
 			log::info("Unknown flag value for entry {}", name);
-		mc.read(&dumzero1, 4);
 		if (dumzero1)
 			log::info("Near-end values not set to zero for entry {}", name);
-		mc.read(&dumff, 2);
 		if (dumff != 0xFFFF)
 			log::info("Dummy set to a non-FF value for entry {}", name);
-		mc.read(&dumzero2, 4);
 		if (dumzero2)
 			log::info("Trailing values not set to zero for entry {}", name);
 
 		// If the lump data goes past the end of the file,
 		// the resfile is invalid
-		if (offset + size > mc.size())
+		if (static_cast<uint64_t>(record.offset) + record.size > loader.data().size())
 		{
 			log::error("ResArchive::readDirectory: Res archive is invalid or corrupt, offset overflow");
 			global::error = "Archive is invalid and/or corrupt";
 			return false;
 		}
 
-		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(name, size);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-		nlump->setState(ArchiveEntry::State::Unmodified);
-
-		// Read entry data if it isn't zero-sized
-		if (nlump->size() > 0)
-		{
-			// Read the entry data
-			MemChunk edata;
-			mc.exportMemChunk(edata, offset, size);
-			nlump->importMemChunk(edata);
-		}
-
 		// What if the entry is a directory?
-		size_t d_o, n_l;
-		if (isResArchive(nlump->data(), d_o, n_l))
+		MemChunk edata;
+		size_t   d_o, n_l;
+		edata.importShared(loader.data(), record.offset, record.size);
+		if (isResArchive(edata, d_o, n_l))
 		{
-			auto ndir = createDir(name, parent);
-			if (ndir)
-			{
-				ui::setSplashProgressMessage(fmt::format("Reading res archive data: {} directory", name));
-				// Save offset to restore it once the recursion is done
-				size_t myoffset = mc.currentPos();
-				readDirectory(mc, d_o, n_l, ndir);
-				ndir->dirEntry()->setState(ArchiveEntry::State::Unmodified);
-				// Restore offset and clean out the entry
-				mc.seek(myoffset, SEEK_SET);
-			}
-			else
+			auto ndir = createDir(name, ArchiveDir::getShared(parent));
+			if (!ndir)
 				return false;
-			// Not a directory, then add to entry list
-		}
-		else
-		{
-			parent->addEntry(nlump);
-			// Detect entry type
-			EntryType::detectEntryType(*nlump);
-			// Unload entry data if needed
-			if (!archive_load_data)
-				nlump->unloadData();
-			// Set entry to unchanged
-			nlump->setState(ArchiveEntry::State::Unmodified);
+
+			ui::setSplashProgressMessage(fmt::format("Reading res archive data: {} directory", name));
+			readDirectory(loader, d_o, n_l, ndir.get());
+			ndir->dirEntry()->setState(ArchiveEntry::State::Unmodified);
+			return true;
 		}
-	}
-	return true;
+
+		// Not a directory, then add to entry list
+		return loader.addEntry(record) != nullptr;
+	};
+
+	return loader.readDirectory(dir_offset, num_lumps, read_entry, parent);
 }
 
 // -----------------------------------------------------------------------------
@@ -237,11 +202,14 @@ bool ResArchive::open(MemChunk& mc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
 	// Read the directory
-	mc.seek(dir_offset, SEEK_SET);
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading res archive data");
-	if (!readDirectory(mc, dir_offset, num_lumps, rootDir()))
+	if (!readDirectory(loader, dir_offset, num_lumps, rootDir().get()))
 		return false;
 
+	// Detect all entry types
+	loader.detectEntryTypes();
+
 	// Detect maps (will detect map entry types)
 	ui::setSplashProgressMessage("Detecting maps");
 	detectMaps();
@@ -303,7 +271,7 @@ bool ResArchive::write(MemChunk& mc, bool update)
 
 			if (update) {
 				entry->setState(ArchiveEntry::State::Unmodified);
-				entry->exProp("Offset") = (int)offset;
+				entry->storage().offset = offset;
 			}
 		}
 	*/
@@ -328,6 +296,10 @@ bool ResArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, getEntryOffset(entry)))
+		return true;
+
 	// Open resfile
 	wxFile file(filename_);
 
@@ -351,12 +323,12 @@ bool ResArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid A&A res archive
 // -----------------------------------------------------------------------------
-bool ResArchive::isResArchive(MemChunk& mc)
+bool ResArchive::isResArchive(const MemChunk& mc)
 {
 	size_t dummy1, dummy2;
 	return isResArchive(mc, dummy1, dummy2);
 }
-bool ResArchive::isResArchive(MemChunk& mc, size_t& dir_offset, size_t& num_lumps)
+bool ResArchive::isResArchive(const MemChunk& mc, size_t& dir_offset, size_t& num_lumps)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -367,9 +339,8 @@ bool ResArchive::isResArchive(MemChunk& mc, size_t& dir_offset, size_t& num_lump
 		return false;
 
 	uint32_t dir_size = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
+	mc.read(4, &dir_offset, 4);
+	mc.read(8, &dir_size, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -387,9 +358,6 @@ bool ResArchive::isResArchive(MemChunk& mc, size_t& dir_offset, size_t& num_lump
 
 	num_lumps = dir_size / RESDIRENTRYSIZE;
 
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
-
 	// If it's passed to here it's probably a res file
 	return true;
 }
@@ -4,6 +4,8 @@
 
 namespace slade
 {
+class FixedDirLoader;
+
 class ResArchive : public Archive
 {
 public:
@@ -15,7 +17,7 @@ public:
 	void     setEntryOffset(ArchiveEntry* entry, uint32_t offset);
 
 	// Opening/writing
-	bool readDirectory(MemChunk& mc, size_t dir_offset, size_t num_lumps, shared_ptr<ArchiveDir> parent);
+	bool readDirectory(FixedDirLoader& loader, uint32_t dir_offset, uint32_t num_lumps, ArchiveDir* parent);
 	bool open(MemChunk& mc) override;                      // Open from MemChunk
 	bool write(MemChunk& mc, bool update = true) override; // Write to MemChunk
 
@@ -23,8 +25,8 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isResArchive(MemChunk& mc);
-	static bool isResArchive(MemChunk& mc, size_t& d_o, size_t& n_l);
+	static bool isResArchive(const MemChunk& mc);
+	static bool isResArchive(const MemChunk& mc, size_t& d_o, size_t& n_l);
 	static bool isResArchive(const string& filename);
 
 private:
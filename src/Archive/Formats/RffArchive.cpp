@@ -132,7 +132,7 @@ uint32_t RffArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -144,7 +144,7 @@ void RffArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -222,7 +222,7 @@ bool RffArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->storage().offset = offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Is the entry encrypted?
@@ -337,7 +337,7 @@ bool RffArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Duke Nukem 3D grp archive
 // -----------------------------------------------------------------------------
-bool RffArchive::isRffArchive(MemChunk& mc)
+bool RffArchive::isRffArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -347,11 +347,10 @@ bool RffArchive::isRffArchive(MemChunk& mc)
 	uint8_t  magic[4];
 	uint32_t version, dir_offset, num_lumps;
 
-	mc.seek(0, SEEK_SET);
-	mc.read(magic, 4);       // Should be "RFF\x18"
-	mc.read(&version, 4);    // 0x01 0x03 \x00 \x00
-	mc.read(&dir_offset, 4); // Offset to directory
-	mc.read(&num_lumps, 4);  // No. of lumps in rff
+	mc.read(0, magic, 4);       // Should be "RFF\x18"
+	mc.read(4, &version, 4);    // 0x01 0x03 \x00 \x00
+	mc.read(8, &dir_offset, 4); // Offset to directory
+	mc.read(12, &num_lumps, 4); // No. of lumps in rff
 
 	// Byteswap values for big endian if needed
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
@@ -365,9 +364,8 @@ bool RffArchive::isRffArchive(MemChunk& mc)
 
 	// Compute total size
 	auto lumps = new RFFLump[num_lumps];
-	mc.seek(dir_offset, SEEK_SET);
 	ui::setSplashProgressMessage("Reading rff archive data");
-	mc.read(lumps, num_lumps * sizeof(RFFLump));
+	mc.read(dir_offset, lumps, num_lumps * sizeof(RFFLump));
 	bloodCrypt(lumps, dir_offset, num_lumps * sizeof(RFFLump));
 	uint32_t totalsize = 12 + num_lumps * sizeof(RFFLump);
 	uint32_t size      = 0;
@@ -22,7 +22,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isRffArchive(MemChunk& mc);
+	static bool isRffArchive(const MemChunk& mc);
 	static bool isRffArchive(const string& filename);
 };
 } // namespace slade
@@ -117,7 +117,7 @@ bool SiNArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-		entry->exProp("Offset") = (int)offset;
+		entry->storage().offset = offset;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -126,7 +126,6 @@ bool SiNArchive::open(MemChunk& mc)
 	}
 
 	// Detect all entry types
-	MemChunk              edata;
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
 	ui::setSplashProgressMessage("Detecting entry types");
@@ -142,8 +141,7 @@ bool SiNArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
+			entry->importMemChunk(mc, entry->storage().offset, entry->size());
 		}
 
 		// Detect entry type
@@ -216,7 +214,7 @@ bool SiNArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 
 		// Check entry name
@@ -291,7 +289,7 @@ bool SiNArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -311,7 +309,7 @@ bool SiNArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Ritual Entertainment SiN archive
 // -----------------------------------------------------------------------------
-bool SiNArchive::isSiNArchive(MemChunk& mc)
+bool SiNArchive::isSiNArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	if (mc.size() < 12)
@@ -321,10 +319,9 @@ bool SiNArchive::isSiNArchive(MemChunk& mc)
 	char    pack[4];
 	int32_t dir_offset;
 	int32_t dir_size;
-	mc.seek(0, SEEK_SET);
-	mc.read(pack, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
+	mc.read(0, pack, 4);
+	mc.read(4, &dir_offset, 4);
+	mc.read(8, &dir_size, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -32,7 +32,9 @@
 #include "Main.h"
 #include "TarArchive.h"
 #include "General/UI.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
+#include <filesystem>
 
 using namespace slade;
 
@@ -261,34 +263,27 @@ void tarDefaultHeader(TarHeader* header)
 
 
 // -----------------------------------------------------------------------------
-// Reads tar format data from a MemChunk
-// Returns true if successful, false otherwise
+// Reads all tar headers from [data], creating (unloaded) entries and
+// directories for them. Each entry's data offset is kept in its storage info
 // -----------------------------------------------------------------------------
-bool TarArchive::open(MemChunk& mc)
+void TarArchive::readHeaders(SeekableData& data)
 {
-	// Check given data is valid
-	if (mc.size() < 1024)
-		return false;
-
-	mc.seek(0, SEEK_SET);
-
-	// Stop announcements (don't want to be announcing modification due to entries being added etc)
-	ArchiveModSignalBlocker sig_blocker{ *this };
+	data.seekFromStart(0);
 	ui::setSplashProgressMessage("Reading tar archive data");
 
 	// Two consecutive empty blocks mark the end of the file
 	int blankcount = 0;
 
 	// Read all entries in the order they appear
-	while ((mc.currentPos() + 512) < mc.size() && blankcount < 2)
+	while ((data.currentPos() + 512) < data.size() && blankcount < 2)
 	{
 		// Update splash window progress
 		// Since there is no directory in Unix tape archives, use the size
-		ui::setSplashProgress(((float)mc.currentPos() / (float)mc.size()));
+		ui::setSplashProgress(((float)data.currentPos() / (float)data.size()));
 
 		// Read tar header
 		TarHeader header;
-		mc.read(&header, 512);
+		data.read(&header, 512);
 		if (!strutil::equalCI({header.magic, sizeof(header.magic)}, TMAGIC))
 		{
 			if (tarMakeChecksum(&header) == 0)
@@ -296,7 +291,7 @@ bool TarArchive::open(MemChunk& mc)
 				++blankcount;
 			}
 			// Invalid block, ignore
-			mc.seek(512, SEEK_CUR);
+			data.seek(512);
 			continue;
 		}
 		else if (blankcount)
@@ -307,7 +302,7 @@ bool TarArchive::open(MemChunk& mc)
 
 		if (!tarChecksum(&header))
 		{
-			log::warning("Invalid checksum for block at 0x{:x}", mc.currentPos() - 512);
+			log::warning("Invalid checksum for block at 0x{:x}", data.currentPos() - 512);
 			continue;
 		}
 
@@ -330,7 +325,7 @@ bool TarArchive::open(MemChunk& mc)
 
 			// Create entry
 			auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-			entry->exProp("Offset") = (int)mc.currentPos();
+			entry->storage().offset = data.currentPos();
 			entry->setLoaded(false);
 			entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -350,13 +345,18 @@ bool TarArchive::open(MemChunk& mc)
 		// Move to next header
 		size_t sum = size % 512; // Do we need padding?
 		if (sum)
-			sum = 512 - sum;    // Compute it
-		sum += size;            // then add it
-		mc.seek(sum, SEEK_CUR); // and move on
+			sum = 512 - sum; // Compute it
+		sum += size;         // then add it
+		data.seek(sum);      // and move on
 	}
+}
 
-	// Detect all entry types
-	MemChunk              edata;
+// -----------------------------------------------------------------------------
+// Detects the types of all entries, using [read_data] to read the data of each
+// (non-empty) entry
+// -----------------------------------------------------------------------------
+void TarArchive::detectEntryTypes(const std::function<void(ArchiveEntry*)>& read_data)
+{
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
 	ui::setSplashProgressMessage("Detecting entry types");
@@ -370,11 +370,7 @@ bool TarArchive::open(MemChunk& mc)
 
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
-		}
+			read_data(entry);
 
 		// Detect entry type
 		EntryType::detectEntryType(*entry);
@@ -386,6 +382,27 @@ bool TarArchive::open(MemChunk& mc)
 		// Set entry to unchanged
 		entry->setState(ArchiveEntry::State::Unmodified);
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads tar format data from a MemChunk
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool TarArchive::open(MemChunk& mc)
+{
+	// Check given data is valid
+	if (mc.size() < 1024)
+		return false;
+
+	// Stop announcements (don't want to be announcing modification due to entries being added etc)
+	ArchiveModSignalBlocker sig_blocker{ *this };
+
+	readHeaders(mc);
+
+	// Detect all entry types (entry data is shared with [mc])
+	detectEntryTypes([&mc](ArchiveEntry* entry) {
+		entry->importMemChunk(mc, entry->storage().offset, entry->size());
+	});
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -397,14 +414,60 @@ bool TarArchive::open(MemChunk& mc)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the tar archive to a MemChunk
+// Reads a tar file from disk. Only the headers are read up front, with each
+// entry's data read from the file individually (for type detection, and later
+// on demand via loadEntryData) rather than loading the whole file at once.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
-bool TarArchive::write(MemChunk& mc, bool update)
+bool TarArchive::open(string_view filename)
 {
-	// Clear current data
-	mc.clear();
+	// Entries are kept loaded anyway, so just read the whole file
+	if (archive_load_data)
+		return Archive::open(filename);
+
+	SFile file(filename);
+	if (!file.isOpen())
+	{
+		global::error = "Unable to open file. Make sure it isn't in use by another program.";
+		return false;
+	}
+
+	// Check given data is valid
+	if (file.size() < 1024)
+		return false;
+
+	// Stop announcements (don't want to be announcing modification due to entries being added etc)
+	ArchiveModSignalBlocker sig_blocker{ *this };
+
+	readHeaders(file);
+
+	// Detect all entry types, reading each entry's data from the file
+	MemChunk data;
+	detectEntryTypes([&file, &data](ArchiveEntry* entry) {
+		file.seekFromStart(entry->storage().offset);
+		if (file.read(data, entry->size()))
+			entry->importMemChunk(data);
+	});
+
+	// Setup variables
+	filename_      = filename;
+	file_modified_ = fileutil::fileModifiedTime(filename);
+	on_disk_       = true;
+	sig_blocker.unblock();
+	setModified(false);
+
+	ui::setSplashProgressMessage("");
 
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the tar archive to [out].
+// If [update] is true, entry offsets are updated to their positions in [out]
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool TarArchive::writeData(SeekableData& out, bool update)
+{
 	// We'll use that
 	uint8_t padding[512];
 	memset(padding, 0, 512);
@@ -437,7 +500,8 @@ bool TarArchive::write(MemChunk& mc, bool update)
 		{
 			header.typeflag = DIRTYPE;
 			tarWriteOctal(tarMakeChecksum(&header), header.chksum, 7);
-			mc.write(&header, 512);
+			if (!out.write(&header, 512))
+				return false;
 
 			// Else we've got a file
 		}
@@ -449,17 +513,58 @@ bool TarArchive::write(MemChunk& mc, bool update)
 			size_t padsize = entries[a]->size() % 512;
 			if (padsize)
 				padsize = 512 - padsize;
-			mc.write(&header, 512);
-			mc.write(entries[a]->rawData(), entries[a]->size());
+			if (!out.write(&header, 512))
+				return false;
+			if (update)
+				entries[a]->storage().offset = out.currentPos();
+			if (entries[a]->size() > 0 && !out.write(entries[a]->rawData(), entries[a]->size()))
+				return false;
 			if (padsize)
-				mc.write(padding, padsize);
+				out.write(padding, padsize);
 		}
 	}
 
 	// Finished, so write two pages of zeroes and return a success
-	mc.write(padding, 512);
-	mc.write(padding, 512);
-	return true;
+	out.write(padding, 512);
+	return out.write(padding, 512);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the tar archive to a MemChunk
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool TarArchive::write(MemChunk& mc, bool update)
+{
+	// Clear current data
+	mc.clear();
+
+	return writeData(mc, false);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the tar archive directly to a file
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool TarArchive::write(string_view filename, bool update)
+{
+	// Make sure all entry data is loaded before the tar file is overwritten
+	std::error_code ec;
+	if (on_disk_ && std::filesystem::equivalent(filename_, string{ filename }, ec))
+	{
+		vector<ArchiveEntry*> entries;
+		putEntryTreeAsList(entries);
+		for (auto entry : entries)
+			entry->rawData();
+	}
+
+	SFile file(filename, SFile::Mode::Write);
+	if (!file.isOpen())
+	{
+		global::error = "Unable to open file for writing";
+		return false;
+	}
+
+	return writeData(file, update);
 }
 
 // -----------------------------------------------------------------------------
@@ -491,7 +596,7 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -511,15 +616,16 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Unix tar archive
 // -----------------------------------------------------------------------------
-bool TarArchive::isTarArchive(MemChunk& mc)
+bool TarArchive::isTarArchive(const MemChunk& mc)
 {
-	mc.seek(0, SEEK_SET);
-	int blankcount = 0;
-	while ((mc.currentPos() + 512) <= mc.size() && blankcount < 3)
+	size_t pos        = 0;
+	int    blankcount = 0;
+	while ((pos + 512) <= mc.size() && blankcount < 3)
 	{
 		// Read tar header
 		TarHeader header;
-		mc.read(&header, 512);
+		mc.read(pos, &header, 512);
+		pos += 512;
 		if (!strutil::equalCI({header.magic, sizeof(header.magic)}, TMAGIC))
 		{
 			if (tarMakeChecksum(&header) == 0)
@@ -550,7 +656,7 @@ bool TarArchive::isTarArchive(MemChunk& mc)
 		if (sum)
 			sum = 512 - sum;    // Compute it
 		sum += size;            // then add it
-		mc.seek(sum, SEEK_CUR); // and move on
+		pos += sum;             // and move on
 	}
 	// We should end with a blankcount of precisely 2
 	return (blankcount == 2);
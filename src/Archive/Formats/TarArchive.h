@@ -11,14 +11,21 @@ public:
 	~TarArchive() = default;
 
 	// Opening/writing
-	bool open(MemChunk& mc) override;                      // Open from MemChunk
-	bool write(MemChunk& mc, bool update = true) override; // Write to MemChunk
+	bool open(string_view filename) override;                      // Open from File
+	bool open(MemChunk& mc) override;                              // Open from MemChunk
+	bool write(MemChunk& mc, bool update = true) override;         // Write to MemChunk
+	bool write(string_view filename, bool update = true) override; // Write to File
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isTarArchive(MemChunk& mc);
+	static bool isTarArchive(const MemChunk& mc);
 	static bool isTarArchive(const string& filename);
+
+private:
+	void readHeaders(SeekableData& data);
+	void detectEntryTypes(const std::function<void(ArchiveEntry*)>& read_data);
+	bool writeData(SeekableData& out, bool update);
 };
 } // namespace slade
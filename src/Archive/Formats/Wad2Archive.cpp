@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Wad2Archive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -40,10 +41,16 @@ using namespace slade;
 
 // -----------------------------------------------------------------------------
 //
-// External Variables
+// Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
+namespace
+{
+// Directory record, see Wad2Entry (dsize is the entry size)
+const FixedDirLoader::RecordFormat dir_format{
+	sizeof(Wad2Entry), offsetof(Wad2Entry, name), 16, offsetof(Wad2Entry, offset), offsetof(Wad2Entry, dsize)
+};
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -90,73 +97,22 @@ bool Wad2Archive::open(MemChunk& mc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
 	// Read the directory
-	mc.seek(dir_offset, SEEK_SET);
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading wad archive data");
-	for (uint32_t d = 0; d < num_lumps; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
-
-		// Read lump info
-		Wad2Entry info;
-		mc.read(&info, 32);
-
-		// Byteswap values for big endian if needed
-		info.offset = wxINT32_SWAP_ON_BE(info.offset);
-		info.size   = wxINT32_SWAP_ON_BE(info.size);
-		info.dsize  = wxINT32_SWAP_ON_BE(info.dsize);
-
-		// If the lump data goes past the end of the file,
-		// the wadfile is invalid
-		if ((unsigned)(info.offset + info.dsize) > mc.size())
-		{
-			log::error("Wad2Archive::open: Wad2 archive is invalid or corrupt");
-			global::error = "Archive is invalid and/or corrupt";
+	auto read_entry = [&loader](FixedDirLoader::Record& record) {
+		auto entry = loader.addEntry(record);
+		if (!entry)
 			return false;
-		}
-
-		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(info.name, info.dsize);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)info.offset;
-		nlump->exProp("W2Type") = info.type;
-		nlump->exProp("W2Size") = (int)info.size;
-		nlump->exProp("W2Comp") = !!(info.cmprs);
-		nlump->setState(ArchiveEntry::State::Unmodified);
-
-		// Add to entry list
-		rootDir()->addEntry(nlump);
-	}
-
-	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
-
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
-		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
+		entry->storage().type   = record.data[offsetof(Wad2Entry, type)];
+		entry->storage().method = record.data[offsetof(Wad2Entry, cmprs)];
+		return true;
+	};
+	if (!loader.readDirectory(dir_offset, num_lumps, read_entry))
+		return false;
 
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	// Detect all entry types
+	loader.detectEntryTypes();
 
 	// Detect maps (will detect map entry types)
 	ui::setSplashProgressMessage("Detecting maps");
@@ -183,7 +139,7 @@ bool Wad2Archive::write(MemChunk& mc, bool update)
 	for (uint32_t l = 0; l < numEntries(); l++)
 	{
 		entry                   = entryAt(l);
-		entry->exProp("Offset") = (int)dir_offset;
+		entry->storage().offset = dir_offset;
 		dir_offset += entry->size();
 	}
 
@@ -219,11 +175,11 @@ bool Wad2Archive::write(MemChunk& mc, bool update)
 		Wad2Entry info;
 		memset(info.name, 0, 16);
 		memcpy(info.name, entry->name().data(), entry->name().size());
-		info.cmprs  = entry->exProp<bool>("W2Comp");
+		info.cmprs  = entry->storage().method;
 		info.dsize  = entry->size();
 		info.size   = entry->size();
-		info.offset = entry->exProp<int>("Offset");
-		info.type   = entry->exProp<int>("W2Type");
+		info.offset = entry->storage().offset;
+		info.type   = entry->storage().type;
 
 		// Write it
 		mc.write(&info, 32);
@@ -253,6 +209,10 @@ bool Wad2Archive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, entry->storage().offset))
+		return true;
+
 	// Open wadfile
 	wxFile file(filename_);
 
@@ -264,7 +224,7 @@ bool Wad2Archive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to lump offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->storage().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -284,7 +244,7 @@ bool Wad2Archive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Quake wad2 archive
 // -----------------------------------------------------------------------------
-bool Wad2Archive::isWad2Archive(MemChunk& mc)
+bool Wad2Archive::isWad2Archive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -297,12 +257,8 @@ bool Wad2Archive::isWad2Archive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	int32_t num_lumps  = 0;
 	int32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	mc.read(4, &num_lumps, 4);
+	mc.read(8, &dir_offset, 4);
 
 	// Byteswap values for big endian if needed
 	num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
@@ -30,7 +30,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isWad2Archive(MemChunk& mc);
+	static bool isWad2Archive(const MemChunk& mc);
 	static bool isWad2Archive(const string& filename);
 
 private:
@@ -31,11 +31,15 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadArchive.h"
+#include "Archive/EntryType/EntryTypeCache.h"
 #include "General/Misc.h"
 #include "General/UI.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
 #include "WadJArchive.h"
+#include <filesystem>
+#include <unordered_set>
 
 using namespace slade;
 
@@ -46,6 +50,10 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, iwad_lock, true, CVar::Flag::Save)
+CVAR(Bool, wad_save_incremental, false, CVar::Flag::Save)
+CVAR(Int, wad_save_compact_percent, 25, CVar::Flag::Save)
+constexpr size_t   type_detect_batch_size = 64 * 1024 * 1024; // Max. entry data to load at once for type detection
+constexpr unsigned splash_update_interval = 500;              // No. of lumps to read between splash progress updates
 
 namespace
 {
@@ -117,7 +125,7 @@ namespace
 // -----------------------------------------------------------------------------
 bool isNamespaceEntry(ArchiveEntry* entry)
 {
-	return strutil::endsWith(entry->upperName(), "_START") || strutil::endsWith(entry->upperName(), "_END");
+	return strutil::endsWithCI(entry->name(), "_START") || strutil::endsWithCI(entry->name(), "_END");
 }
 } // namespace
 
@@ -146,7 +154,7 @@ uint32_t WadArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -158,7 +166,7 @@ void WadArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -176,7 +184,7 @@ void WadArchive::updateNamespaces()
 		auto entry = rootDir()->entryAt(a);
 
 		// Check for namespace begin
-		if (strutil::endsWith(entry->upperName(), "_START"))
+		if (strutil::endsWithCI(entry->name(), "_START"))
 		{
 			log::debug("Found namespace start marker {} at index {}", entry->name(), entryIndex(entry));
 
@@ -204,7 +212,7 @@ void WadArchive::updateNamespaces()
 		}
 		// Check for namespace end
 		// else if (strutil::matches(entry->upperName(), "?_END") || strutil::matches(entry->upperName(), "??_END"))
-		else if (strutil::endsWith(entry->upperName(), "_END"))
+		else if (strutil::endsWithCI(entry->name(), "_END"))
 		{
 			log::debug("Found namespace end marker {} at index {}", entry->name(), entryIndex(entry));
 
@@ -260,8 +268,8 @@ void WadArchive::updateNamespaces()
 	// ROTT stuff. The first lump in the archive is always WALLSTRT, the last lump is either
 	// LICENSE (darkwar.wad) or VENDOR (huntbgin.wad), with TABLES just before in both cases.
 	// The shareware version has 2091 lumps, the complete version has about 50% more.
-	if (numEntries() > 2090 && rootDir()->entryAt(0)->upperName() == "WALLSTRT"
-		&& rootDir()->entryAt(numEntries() - 2)->upperName() == "TABLES")
+	if (numEntries() > 2090 && strutil::equalCI(rootDir()->entryAt(0)->name(), "WALLSTRT")
+		&& strutil::equalCI(rootDir()->entryAt(numEntries() - 2)->name(), "TABLES"))
 	{
 		NSPair ns(rootDir()->entryAt(0), rootDir()->entryAt(numEntries() - 1));
 		ns.name        = "rott";
@@ -301,6 +309,38 @@ void WadArchive::updateNamespaces()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Updates namespace start/end indices after a single non-marker entry was
+// added at (if [count] is 1) or removed from (if [count] is -1) [index],
+// without needing to rescan all entries like updateNamespaces does
+// -----------------------------------------------------------------------------
+void WadArchive::updateNamespaceIndices(int index, int count)
+{
+	if (index < 0)
+		return;
+
+	const auto pos = static_cast<size_t>(index);
+	for (auto& ns : namespaces_)
+	{
+		if (count > 0)
+		{
+			// Entries at or after the added entry are shifted down
+			if (ns.start_index >= pos)
+				ns.start_index++;
+			if (ns.end_index >= pos)
+				ns.end_index++;
+		}
+		else
+		{
+			// Entries after the removed entry are shifted up
+			if (ns.start_index > pos)
+				ns.start_index--;
+			if (ns.end_index > pos)
+				ns.end_index--;
+		}
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Detects if the flat hack is used in this archive or not
 // -----------------------------------------------------------------------------
@@ -351,24 +391,35 @@ bool WadArchive::open(MemChunk& mc)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
-	vector<uint32_t> offsets;
+	// Check the directory is within the file
+	if (static_cast<uint64_t>(dir_offset) + static_cast<uint64_t>(num_lumps) * 16 > mc.size())
+	{
+		log::error("WadArchive::open: Wad archive is invalid or corrupt");
+		global::error = "Archive is invalid and/or corrupt (directory goes past end of file)";
+		return false;
+	}
 
-	// Read the directory
-	mc.seek(dir_offset, SEEK_SET);
+	// Read the directory (records are read directly from the data rather than
+	// via separate MemChunk::read calls, this can be slow for very large wads)
+	const auto                   dir_data = mc.data() + dir_offset;
+	std::unordered_set<uint32_t> offsets;
+	offsets.reserve(num_lumps);
 	ui::setSplashProgressMessage("Reading wad archive data");
 	for (uint32_t d = 0; d < num_lumps; d++)
 	{
 		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
+		if (d % splash_update_interval == 0)
+			ui::setSplashProgress(((float)d / (float)num_lumps));
 
 		// Read lump info
-		char     name[9] = "";
-		uint32_t offset  = 0;
-		uint32_t size    = 0;
-
-		mc.read(&offset, 4); // Offset
-		mc.read(&size, 4);   // Size
-		mc.read(name, 8);    // Name
+		const auto record  = dir_data + static_cast<size_t>(d) * 16;
+		char       name[9] = "";
+		uint32_t   offset  = 0;
+		uint32_t   size    = 0;
+
+		memcpy(&offset, record, 4);   // Offset
+		memcpy(&size, record + 4, 4); // Size
+		memcpy(name, record + 8, 8);  // Name
 		name[8] = '\0';
 
 		// Byteswap values for big endian if needed
@@ -383,12 +434,11 @@ bool WadArchive::open(MemChunk& mc)
 				log::info(2, "No.");
 				continue;
 			}
-			if (VECTOR_EXISTS(offsets, offset))
+			if (!offsets.insert(offset).second)
 			{
 				log::warning("Ignoring entry {}: {}, is a clone of a previous entry", d, name);
 				continue;
 			}
-			offsets.push_back(offset);
 		}
 
 		// Hack to open Operation: Rheingold WAD files
@@ -405,19 +455,16 @@ bool WadArchive::open(MemChunk& mc)
 		{
 			if (d < num_lumps - 1)
 			{
-				size_t   pos        = mc.currentPos();
 				uint32_t nextoffset = 0;
-				for (int i = 0; i + d < num_lumps; ++i)
+				for (uint32_t next = d + 1; next < num_lumps; ++next)
 				{
-					mc.read(&nextoffset, 4);
+					memcpy(&nextoffset, dir_data + static_cast<size_t>(next) * 16, 4);
 					if (nextoffset != 0)
 						break;
-					mc.seek(12, SEEK_CUR);
 				}
 				nextoffset = wxINT32_SWAP_ON_BE(nextoffset);
 				if (nextoffset == 0)
 					nextoffset = dir_offset;
-				mc.seek(pos, SEEK_SET);
 				actualsize = nextoffset - offset;
 			}
 			else
@@ -446,13 +493,13 @@ bool WadArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->storage().offset = offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		if (jaguarencrypt)
 		{
 			nlump->setEncryption(ArchiveEntry::Encryption::Jaguar);
-			nlump->exProp("FullSize") = (int)size;
+			nlump->storage().full_size = size;
 		}
 
 		// Add to entry list
@@ -463,47 +510,83 @@ bool WadArchive::open(MemChunk& mc)
 	// rely on being within certain namespaces)
 	updateNamespaces();
 
-	// Detect all entry types
-	MemChunk edata;
+	// Detect all entry types (in batches, to limit the amount of entry data
+	// loaded at once). Types cached from the last time this file was opened
+	// are used where possible
+	EntryTypeCache        type_cache(filename_, mc.size());
+	MemChunk              edata;
+	vector<ArchiveEntry*> batch;
+	size_t                batch_size   = 0;
+	auto                  detect_batch = [&batch, &batch_size]() {
+		EntryType::detectEntryTypes(batch);
+		for (auto entry : batch)
+		{
+			// Unload entry data if needed
+			if (!archive_load_data)
+				entry->unloadData();
+
+			// Set entry to unchanged
+			entry->setState(ArchiveEntry::State::Unmodified);
+		}
+		batch.clear();
+		batch_size = 0;
+	};
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
 		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)numEntries())));
+		if (a % splash_update_interval == 0)
+			ui::setSplashProgress((((float)a / (float)numEntries())));
 
 		// Get entry
 		auto entry = entryAt(a);
 
+		// Use cached type if available, no need to read the entry data unless
+		// all data is to be loaded
+		const bool cacheable = entry->size() > 0 && entry->encryption() == ArchiveEntry::Encryption::None;
+		if (cacheable)
+		{
+			type_cache.add(entry, getEntryOffset(entry));
+			if (!archive_load_data && type_cache.apply(*entry, getEntryOffset(entry)))
+				continue;
+		}
+
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			if (entry->encryption() != ArchiveEntry::Encryption::None)
+			if (entry->encryption() == ArchiveEntry::Encryption::None)
+				entry->importMemChunk(mc, getEntryOffset(entry), entry->size());
+			else
 			{
-				if (entry->exProps().contains("FullSize")
-					&& static_cast<unsigned>(entry->exProp<int>("FullSize")) > entry->size())
-					edata.reSize((entry->exProp<int>("FullSize")), true);
+				mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
+				if (entry->storage().hasFullSize() && entry->storage().full_size > entry->size())
+					edata.reSize(entry->storage().full_size, true);
 				if (!WadJArchive::jaguarDecode(edata))
 					log::warning(
 						"{}: {} (following {}), did not decode properly",
 						a,
 						entry->name(),
 						a > 0 ? entryAt(a - 1)->name() : "nothing");
+				entry->importMemChunk(edata);
 			}
-			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
+		// Use cached type if available (importing the data resets it)
+		if (cacheable && archive_load_data && type_cache.apply(*entry, getEntryOffset(entry)))
+		{
+			entry->setState(ArchiveEntry::State::Unmodified);
+			continue;
+		}
 
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Add to type detection batch
+		batch.push_back(entry);
+		batch_size += entry->size();
+		if (batch_size >= type_detect_batch_size)
+			detect_batch();
 	}
+	detect_batch();
+	type_cache.save();
 
 	// Identify #included lumps (DECORATE, GLDEFS, etc.)
 	detectIncludes();
@@ -515,6 +598,7 @@ bool WadArchive::open(MemChunk& mc)
 	// Setup variables
 	sig_blocker.unblock();
 	setModified(false);
+	file_offsets_valid_ = true;
 
 	ui::setSplashProgressMessage("");
 
@@ -544,6 +628,9 @@ bool WadArchive::write(MemChunk& mc, bool update)
 		dir_offset += entry->size();
 	}
 
+	// Lump offsets no longer refer to the wad file (if any)
+	file_offsets_valid_ = false;
+
 	// Clear/init MemChunk
 	mc.clear();
 	mc.seek(0, SEEK_SET);
@@ -589,7 +676,7 @@ bool WadArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
 		}
 	}
 
@@ -609,6 +696,20 @@ bool WadArchive::write(string_view filename, bool update)
 		return false;
 	}
 
+	// Check if we're writing over the wad file
+	std::error_code ec;
+	const bool      overwrite = on_disk_ && std::filesystem::equivalent(filename_, string{ filename }, ec);
+
+	// Just append modified lumps and a new directory to the existing file if
+	// possible
+	if (overwrite && update && wad_save_incremental && writeIncremental())
+		return true;
+
+	// Make sure all lump data is loaded before the wad file is overwritten
+	if (overwrite)
+		for (uint32_t l = 0; l < numEntries(); l++)
+			entryAt(l)->rawData();
+
 	// Open file for writing
 	wxFile file;
 	file.Open(wxString{ filename.data(), filename.size() }, wxFile::write);
@@ -667,12 +768,166 @@ bool WadArchive::write(string_view filename, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->storage().offset = offset;
+		}
+	}
+
+	file.Close();
+
+	// Lump offsets now refer to the written file
+	file_offsets_valid_ = update;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Saves the wad by appending only new/modified lumps to the end of the existing
+// wad file, followed by a new directory (any lump data that is no longer used,
+// and the old directory, is left in place).
+// The header is only updated to point to the new directory once everything
+// else has been written successfully, so the wad on disk stays valid (as it
+// was before saving) if writing fails part way.
+// Returns false if the wad can't be saved this way, if the amount of unused
+// space in the file would exceed the wad_save_compact_percent threshold (in
+// which case the whole wad should be rewritten instead) or if writing failed.
+// Entries are only updated if true is returned
+// -----------------------------------------------------------------------------
+bool WadArchive::writeIncremental()
+{
+	// Check lump offsets still refer to the wad file, and that it hasn't been
+	// changed since it was opened/saved
+	if (!file_offsets_valid_ || parentEntry() || !on_disk_ || !fileutil::fileExists(filename_)
+		|| fileutil::fileModifiedTime(filename_) != file_modified_ || fileutil::fileSize(filename_) != file_size_)
+		return false;
+
+	// Find the end of all lump data still in use, and how much of it is used
+	const auto num_lumps  = numEntries();
+	uint64_t   data_end   = 12;
+	uint64_t   data_used  = 0;
+	uint64_t   data_added = 0;
+	for (unsigned l = 0; l < num_lumps; l++)
+	{
+		auto entry = entryAt(l);
+
+		// Can't incrementally save encrypted lumps
+		if (entry->encryption() != ArchiveEntry::Encryption::None)
+			return false;
+
+		if (entry->size() == 0)
+			continue;
+
+		if (entry->state() == ArchiveEntry::State::Unmodified && entry->storage().hasOffset())
+		{
+			data_end = std::max<uint64_t>(data_end, getEntryOffset(entry) + entry->size());
+			data_used += entry->size();
 		}
+		else
+			data_added += entry->size();
+	}
+
+	// New data is appended after everything currently in the file (including
+	// the current directory)
+	const uint64_t file_size   = std::max(file_size_, data_end);
+	const uint64_t dir_offset  = file_size + data_added;
+	const uint64_t dir_size    = static_cast<uint64_t>(num_lumps) * 16;
+	const uint64_t new_size    = dir_offset + dir_size;
+	const uint64_t append_size = new_size - file_size;
+
+	// Check the wad won't go over the size limit
+	if (new_size > 0xFFFFFFFF)
+		return false;
+
+	// Check amount of unused space
+	const auto wasted = file_size - 12 - data_used;
+	if (wasted * 100 > new_size * static_cast<uint64_t>(std::max(0, *wad_save_compact_percent)))
+	{
+		log::info(2, "Compacting wad {} ({} bytes unused)", filename_, wasted);
+		return false;
+	}
+
+	// Open the file
+	wxFile file;
+	file.Open(filename_, wxFile::read_write);
+	if (!file.IsOpened())
+		return false;
+
+	auto write = [&file](const void* data, size_t size) { return file.Write(data, size) == size; };
+	auto fail  = [&file, file_size, this]() {
+		// Remove anything appended, the header and old directory are untouched
+		file.Close();
+		std::error_code ec;
+		std::filesystem::resize_file(filename_, file_size, ec);
+		log::warning("Unable to save wad {} incrementally", filename_);
+		return false;
+	};
+
+	// Append new/modified lumps
+	vector<uint32_t> offsets(num_lumps);
+	auto             offset = static_cast<uint32_t>(file_size);
+	if (file.Seek(offset, wxFromStart) == wxInvalidOffset)
+		return fail();
+	for (unsigned l = 0; l < num_lumps; l++)
+	{
+		auto entry = entryAt(l);
+		if (entry->size() > 0 && entry->state() == ArchiveEntry::State::Unmodified
+			&& entry->storage().hasOffset())
+		{
+			offsets[l] = getEntryOffset(entry);
+			continue;
+		}
+
+		offsets[l] = offset;
+		if (entry->size() > 0)
+		{
+			if (!write(entry->rawData(), entry->size()))
+				return fail();
+			offset += entry->size();
+		}
+	}
+
+	// Append the new directory
+	for (unsigned l = 0; l < num_lumps; l++)
+	{
+		auto     entry    = entryAt(l);
+		char     name[8]  = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		uint32_t size     = entry->size();
+		uint32_t l_offset = offsets[l];
+
+		for (size_t c = 0; c < entry->name().length() && c < 8; c++)
+			name[c] = entry->name()[c];
+
+		if (!write(&l_offset, 4) || !write(&size, 4) || !write(name, 8))
+			return fail();
 	}
 
+	// Make sure everything is on disk before pointing the header to it
+	if (!file.Flush())
+		return fail();
+
+	// Write the header
+	char wad_type[4] = { 'P', 'W', 'A', 'D' };
+	if (iwad_)
+		wad_type[0] = 'I';
+	auto dir_offset32 = static_cast<uint32_t>(dir_offset);
+	if (file.Seek(0, wxFromStart) == wxInvalidOffset || !write(wad_type, 4) || !write(&num_lumps, 4)
+		|| !write(&dir_offset32, 4) || !file.Flush())
+	{
+		// Don't truncate here, the header may already point to the new directory
+		log::warning("Unable to write header of wad {}", filename_);
+		return false;
+	}
 	file.Close();
 
+	// Update lump info
+	for (unsigned l = 0; l < num_lumps; l++)
+	{
+		auto entry = entryAt(l);
+		entry->setState(ArchiveEntry::State::Unmodified);
+		setEntryOffset(entry, offsets[l]);
+	}
+
+	log::info(2, "Saved wad {} incrementally ({} bytes written)", filename_, append_size);
+
 	return true;
 }
 
@@ -694,6 +949,10 @@ bool WadArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly from the mapped archive file if possible
+	if (loadMappedEntryData(entry, getEntryOffset(entry)))
+		return true;
+
 	// Open wadfile
 	wxFile file(filename_);
 
@@ -715,6 +974,20 @@ bool WadArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the (unloaded) data of [entry] directly from the wadfile to [file],
+// without loading it into memory.
+// Returns false if the entry data can't be exported this way
+// -----------------------------------------------------------------------------
+bool WadArchive::exportEntryData(ArchiveEntry* entry, wxFile& file)
+{
+	// Check the entry is valid, unloaded and stored as-is in the wadfile
+	if (!checkEntry(entry) || entry->isLoaded() || entry->encryption() != ArchiveEntry::Encryption::None)
+		return false;
+
+	return exportFileData(getEntryOffset(entry), entry->size(), file);
+}
+
 // -----------------------------------------------------------------------------
 // Override of Archive::addEntry to force entry addition to the root directory,
 // update namespaces if needed and rename the entry if necessary to be
@@ -731,11 +1004,14 @@ shared_ptr<ArchiveEntry> WadArchive::addEntry(shared_ptr<ArchiveEntry> entry, un
 		return nullptr;
 
 	// Do default entry addition (to root directory)
-	TreelessArchive::addEntry(entry, position);
+	if (!TreelessArchive::addEntry(entry, position))
+		return nullptr;
 
 	// Update namespaces if necessary
 	if (isNamespaceEntry(entry.get()))
 		updateNamespaces();
+	else
+		updateNamespaceIndices(entryIndex(entry.get()), 1);
 
 	return entry;
 }
@@ -753,7 +1029,7 @@ shared_ptr<ArchiveEntry> WadArchive::addEntry(shared_ptr<ArchiveEntry> entry, st
 		if (strutil::equalCI(ns.name, add_namespace))
 		{
 			// Namespace found, add entry before end marker
-			return addEntry(entry, ns.end_index++, nullptr);
+			return addEntry(entry, ns.end_index, nullptr);
 		}
 	}
 
@@ -783,6 +1059,7 @@ bool WadArchive::removeEntry(ArchiveEntry* entry)
 
 	// Check if namespace entry
 	bool ns_entry = isNamespaceEntry(entry);
+	int  index    = entryIndex(entry);
 
 	// Do default remove
 	if (Archive::removeEntry(entry))
@@ -790,6 +1067,8 @@ bool WadArchive::removeEntry(ArchiveEntry* entry)
 		// Update namespaces if necessary
 		if (ns_entry)
 			updateNamespaces();
+		else
+			updateNamespaceIndices(index, -1);
 
 		return true;
 	}
@@ -855,11 +1134,17 @@ bool WadArchive::moveEntry(ArchiveEntry* entry, unsigned position, ArchiveDir* d
 		return false;
 
 	// Do default move (force root dir)
+	int old_index = entryIndex(entry);
 	if (TreelessArchive::moveEntry(entry, position, nullptr))
 	{
 		// Update namespaces if necessary
 		if (isNamespaceEntry(entry))
 			updateNamespaces();
+		else
+		{
+			updateNamespaceIndices(old_index, -1);
+			updateNamespaceIndices(entryIndex(entry), 1);
+		}
 
 		return true;
 	}
@@ -895,7 +1180,7 @@ Archive::MapDesc WadArchive::mapDesc(ArchiveEntry* maphead)
 	int  entry_count = dir->numEntries();
 
 	// Check for UDMF format map
-	if (head_index < entry_count && dir->entryAt(head_index + 1)->upperName() == "TEXTMAP")
+	if (head_index < entry_count && strutil::equalCI(dir->entryAt(head_index + 1)->name(), "TEXTMAP"))
 	{
 		// Get map info
 		map.head   = s_maphead;
@@ -907,14 +1192,14 @@ Archive::MapDesc WadArchive::mapDesc(ArchiveEntry* maphead)
 		auto entry = dir->sharedEntryAt(index);
 		while (index < entry_count)
 		{
-			if (!entry || entry->upperName() == "ENDMAP")
+			if (!entry || strutil::equalCI(entry->name(), "ENDMAP"))
 				break;
 
 			// Check for unknown map lumps
 			bool known = false;
 			for (unsigned a = 0; a < NUMMAPLUMPS; a++)
 			{
-				if (entry->upperName() == map_lumps[a])
+				if (strutil::equalCI(entry->name(), map_lumps[a]))
 				{
 					known = true;
 					a     = NUMMAPLUMPS;
@@ -940,6 +1225,8 @@ Archive::MapDesc WadArchive::mapDesc(ArchiveEntry* maphead)
 	// Check for doom/hexen format map
 	uint8_t existing_map_lumps[NUMMAPLUMPS];
 	memset(existing_map_lumps, 0, NUMMAPLUMPS);
+	string gl_header{ maphead->upperNameNoExt() };
+	strutil::prependIP(gl_header, "GL_");
 	auto index = head_index + 1;
 	auto entry = dir->sharedEntryAt(index);
 	while (entry)
@@ -948,7 +1235,7 @@ Archive::MapDesc WadArchive::mapDesc(ArchiveEntry* maphead)
 		bool mapentry = false;
 		for (unsigned a = 0; a < NUMMAPLUMPS; a++)
 		{
-			if (entry->upperName() == map_lumps[a])
+			if (strutil::equalCI(entry->name(), map_lumps[a]))
 			{
 				mapentry              = true;
 				existing_map_lumps[a] = 1;
@@ -956,9 +1243,7 @@ Archive::MapDesc WadArchive::mapDesc(ArchiveEntry* maphead)
 			}
 			else if (a == LUMP_GL_HEADER)
 			{
-				string name{ maphead->upperNameNoExt() };
-				strutil::prependIP(name, "GL_");
-				if (entry->upperName() == name)
+				if (strutil::equalCI(entry->name(), gl_header))
 				{
 					mapentry              = true;
 					existing_map_lumps[a] = 1;
@@ -1054,7 +1339,7 @@ vector<Archive::MapDesc> WadArchive::detectMaps()
 		for (int a = 0; a < 5; a++)
 		{
 			// Compare with all base map lump names
-			if (entry->upperName() == map_lumps[a])
+			if (strutil::equalCI(entry->name(), map_lumps[a]))
 			{
 				maplump_found         = true;
 				existing_map_lumps[a] = 1;
@@ -1079,7 +1364,7 @@ vector<Archive::MapDesc> WadArchive::detectMaps()
 				for (int a = 0; a < NUMMAPLUMPS; a++)
 				{
 					// Compare with all base map lump names
-					if (entry->upperName() == map_lumps[a])
+					if (strutil::equalCI(entry->name(), map_lumps[a]))
 					{
 						existing_map_lumps[a] = 1;
 						done                  = false;
@@ -1308,7 +1593,7 @@ ArchiveEntry* WadArchive::findFirst(SearchOptions& options)
 		// Check name
 		if (!options.match_name.empty())
 		{
-			if (!strutil::matches(options.match_name, entry->upperName()))
+			if (!strutil::matchesCI(options.match_name, entry->name()))
 				continue;
 		}
 
@@ -1381,7 +1666,7 @@ ArchiveEntry* WadArchive::findLast(SearchOptions& options)
 		// Check name
 		if (!options.match_name.empty())
 		{
-			if (!strutil::matches(entry->upperName(), options.match_name))
+			if (!strutil::matchesCI(entry->name(), options.match_name))
 				continue;
 		}
 
@@ -1450,7 +1735,7 @@ vector<ArchiveEntry*> WadArchive::findAll(SearchOptions& options)
 		// Check name
 		if (!options.match_name.empty())
 		{
-			if (!strutil::matches(entry->upperName(), options.match_name))
+			if (!strutil::matchesCI(entry->name(), options.match_name))
 				continue;
 		}
 
@@ -1473,7 +1758,7 @@ vector<ArchiveEntry*> WadArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Doom wad archive
 // -----------------------------------------------------------------------------
-bool WadArchive::isWadArchive(MemChunk& mc)
+bool WadArchive::isWadArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -1486,12 +1771,8 @@ bool WadArchive::isWadArchive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	uint32_t num_lumps  = 0;
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	mc.read(4, &num_lumps, 4);
+	mc.read(8, &dir_offset, 4);
 
 	// Byteswap values for big endian if needed
 	num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
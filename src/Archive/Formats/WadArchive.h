@@ -16,6 +16,7 @@ public:
 	uint32_t getEntryOffset(ArchiveEntry* entry);
 	void     setEntryOffset(ArchiveEntry* entry, uint32_t offset);
 	void     updateNamespaces();
+	void     updateNamespaceIndices(int index, int count);
 
 	// Opening
 	bool open(MemChunk& mc) override;
@@ -26,6 +27,7 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool exportEntryData(ArchiveEntry* entry, wxFile& file) override;
 
 	// Entry addition/removal
 	shared_ptr<ArchiveEntry> addEntry(
@@ -56,7 +58,7 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isWadArchive(MemChunk& mc);
+	static bool isWadArchive(const MemChunk& mc);
 	static bool isWadArchive(const string& filename);
 
 	static bool exportEntriesAsWad(string_view filename, vector<ArchiveEntry*> entries)
@@ -88,7 +90,10 @@ private:
 		NSPair(ArchiveEntry* start, ArchiveEntry* end) : start{ start }, start_index{ 0 }, end{ end }, end_index{ 0 } {}
 	};
 
-	bool           iwad_ = false;
+	bool           iwad_               = false;
+	bool           file_offsets_valid_ = false; // True if lump offsets refer to the wad file on disk
 	vector<NSPair> namespaces_;
+
+	bool writeIncremental();
 };
 } // namespace slade
@@ -32,18 +32,30 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadJArchive.h"
+#include "Archive/FixedDirLoader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Directory record (big endian): offset (4), size (4), name (8)
+const FixedDirLoader::RecordFormat dir_format{ 16, 8, 8, 0, 4, FixedDirLoader::DataLayout::Offset, true };
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // External Variables
 //
 // -----------------------------------------------------------------------------
-EXTERN_CVAR(Bool, archive_load_data)
 EXTERN_CVAR(Bool, iwad_lock)
 
 
@@ -96,137 +108,76 @@ bool WadJArchive::open(MemChunk& mc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
 	// Read the directory
-	mc.seek(dir_offset, SEEK_SET);
+	FixedDirLoader loader(*this, mc, dir_format);
 	ui::setSplashProgressMessage("Reading wad archive data");
-	for (uint32_t d = 0; d < num_lumps; d++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress(((float)d / (float)num_lumps));
-
-		// Read lump info
-		char     name[9] = "";
-		uint32_t offset  = 0;
-		uint32_t size    = 0;
-
-		mc.read(&offset, 4); // Offset
-		mc.read(&size, 4);   // Size
-		mc.read(name, 8);    // Name
-		name[8] = '\0';
-
-		// Byteswap values for little endian
-		offset = wxINT32_SWAP_ON_LE(offset);
-		size   = wxINT32_SWAP_ON_LE(size);
-
+	auto read_entry = [&](FixedDirLoader::Record& record) {
 		// Is there a compression/encryption thing going on?
-		bool jaguarencrypt = !!(name[0] & 0x80); // look at high bit
-		name[0]            = name[0] & 0x7F;     // then strip it away
+		bool jaguarencrypt = !record.name.empty() && (record.name[0] & 0x80); // look at high bit
+		if (jaguarencrypt)
+			record.name[0] = record.name[0] & 0x7F; // then strip it away
 
 		// Look for encryption shenanigans
-		size_t actualsize = size;
+		const auto size = record.size;
 		if (jaguarencrypt)
 		{
-			if (d < num_lumps - 1)
+			if (record.index < num_lumps - 1)
 			{
-				size_t   pos        = mc.currentPos();
 				uint32_t nextoffset = 0;
-				for (int i = 0; i + d < num_lumps; ++i)
+				for (uint32_t next = record.index + 1; next < num_lumps; ++next)
 				{
-					mc.read(&nextoffset, 4);
+					nextoffset = mc.readB32(dir_offset + next * 16);
 					if (nextoffset != 0)
 						break;
-					mc.seek(12, SEEK_CUR);
 				}
-				nextoffset = wxINT32_SWAP_ON_LE(nextoffset);
 				if (nextoffset == 0)
 					nextoffset = dir_offset;
-				mc.seek(pos, SEEK_SET);
-				actualsize = nextoffset - offset;
+				record.size = nextoffset - record.offset;
 			}
 			else
 			{
-				if (offset > dir_offset)
-					actualsize = mc.size() - offset;
+				if (record.offset > dir_offset)
+					record.size = mc.size() - record.offset;
 				else
-					actualsize = dir_offset - offset;
+					record.size = dir_offset - record.offset;
 			}
 		}
 
-		// If the lump data goes past the end of the file,
-		// the wadfile is invalid
-		if (offset + actualsize > mc.size())
-		{
-			log::error("WadJArchive::open: Wad archive is invalid or corrupt");
-			global::error = fmt::format(
-				"Archive is invalid and/or corrupt (lump {}: {} data goes past end of file)", d, name);
-			return false;
-		}
-
 		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(name, actualsize);
-		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-		nlump->setState(ArchiveEntry::State::Unmodified);
+		auto entry = loader.addEntry(record);
+		if (!entry)
+			return false;
 
 		if (jaguarencrypt)
 		{
-			nlump->setEncryption(ArchiveEntry::Encryption::Jaguar);
-			nlump->exProp("FullSize") = (int)size;
+			entry->setEncryption(ArchiveEntry::Encryption::Jaguar);
+			entry->storage().full_size = size;
+
+			// Decode the data now, so it isn't referenced from the archive as-is
+			MemChunk edata;
+			mc.exportMemChunk(edata, record.offset, record.size);
+			if (size > record.size)
+				edata.reSize(size, true);
+			if (!jaguarDecode(edata))
+				log::warning("{}: {}, did not decode properly", record.index, entry->name());
+			entry->importMemChunk(edata);
 		}
 
-		// Add to entry list
-		rootDir()->addEntry(nlump);
-	}
+		return true;
+	};
+	if (!loader.readDirectory(dir_offset, num_lumps, read_entry))
+		return false;
 
 	// Detect namespaces (needs to be done before type detection as some types
 	// rely on being within certain namespaces)
 	updateNamespaces();
 
 	// Detect all entry types
-	MemChunk edata;
-	ui::setSplashProgressMessage("Detecting entry types");
-	for (size_t a = 0; a < numEntries(); a++)
-	{
-		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
+	loader.detectEntryTypes();
 
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			edata.clear();
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			if (entry->encryption() != ArchiveEntry::Encryption::None)
-			{
-				if (entry->exProps().contains("FullSize")
-					&& (unsigned)(entry->exProp<int>("FullSize")) > entry->size())
-					edata.reSize((entry->exProp<int>("FullSize")), true);
-				if (!jaguarDecode(edata))
-					log::warning(
-						"{}: {} (following {}), did not decode properly",
-						a,
-						entry->name(),
-						a > 0 ? entryAt(a - 1)->name() : "nothing");
-			}
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Lock entry if IWAD
-		if (wad_type_[0] == 'I' && iwad_lock)
-			entry->lock();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
-	}
+	// Lock entries if IWAD
+	if (wad_type_[0] == 'I' && iwad_lock)
+		for (size_t a = 0; a < numEntries(); a++)
+			entryAt(a)->lock();
 
 	// Detect maps (will detect map entry types)
 	ui::setSplashProgressMessage("Detecting maps");
@@ -299,7 +250,7 @@ bool WadJArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)wxINT32_SWAP_ON_LE(offset);
+			entry->storage().offset = wxINT32_SWAP_ON_LE(offset);
 		}
 	}
 
@@ -328,7 +279,7 @@ string WadJArchive::detectNamespace(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Jaguar Doom wad archive
 // -----------------------------------------------------------------------------
-bool WadJArchive::isWadJArchive(MemChunk& mc)
+bool WadJArchive::isWadJArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -341,12 +292,8 @@ bool WadJArchive::isWadJArchive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	uint32_t num_lumps  = 0;
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	mc.read(4, &num_lumps, 4);
+	mc.read(8, &dir_offset, 4);
 
 	// Byteswap values for little endian
 	num_lumps  = wxINT32_SWAP_ON_LE(num_lumps);
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WolfArchive.h"
+#include "Archive/EntryType/EntryTypeCache.h"
 #include "General/UI.h"
 #include "UI/WxUtils.h"
 #include "Utility/FileUtils.h"
@@ -39,6 +40,13 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Bool, archive_load_data)
+
 
 // -----------------------------------------------------------------------------
 //
@@ -192,12 +200,8 @@ string searchIMFName(MemChunk& mc)
 // Adds height and width information to a picture. Needed because Wolf3D is just
 // that much of a horrible hacky mess.
 // -----------------------------------------------------------------------------
-void addWolfPicHeader(ArchiveEntry* entry, uint16_t width, uint16_t height)
+void addWolfPicHeader(MemChunk& mc, uint16_t width, uint16_t height)
 {
-	if (!entry)
-		return;
-
-	auto& mc = entry->data();
 	if (mc.size() == 0)
 		return;
 
@@ -213,8 +217,7 @@ void addWolfPicHeader(ArchiveEntry* entry, uint16_t width, uint16_t height)
 	{
 		newdata[4 + i] = mc[i];
 	}
-	// mc.clear();
-	entry->importMem(newdata, newsize);
+	mc.importMem(newdata, newsize);
 	delete[] newdata;
 }
 
@@ -282,62 +285,67 @@ struct HuffNode
 {
 	uint16_t bit0, bit1; // 0-255 is a character, > is a pointer to a node
 };
-void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, HuffNode* hufftable)
-{
-	if (!entry || entry->size() == 0)
-		return;
-
-	size_t         expanded; // expanded size
-	const uint8_t* source = entry->rawData();
-
 
+// -----------------------------------------------------------------------------
+// Returns the size VGAGRAPH chunk [lumpnum] will be once expanded, from its
+// compressed [data] of [size] bytes, or 0 if it can't be expanded
+// -----------------------------------------------------------------------------
+size_t wolfGraphLumpExpandedSize(const uint8_t* data, size_t size, size_t lumpnum, size_t numlumps)
+{
+	size_t expanded;
 	if (lumpnum == WolfConstant(STARTTILE8, numlumps))
 		expanded = 64 * WolfConstant(NUMTILE8, numlumps);
+	else if (size >= 4)
+		expanded = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
 	else
+		expanded = 0;
+
+	return expanded > 65000 ? 0 : expanded;
+}
+
+// -----------------------------------------------------------------------------
+// Expands (Huffman-decodes) the VGAGRAPH chunk [lumpnum] in [mc] using
+// [hufftable]. The data is left as-is if it can't be expanded
+// -----------------------------------------------------------------------------
+void expandWolfGraphLump(MemChunk& mc, size_t lumpnum, size_t numlumps, const HuffNode* hufftable)
+{
+	if (mc.size() == 0)
+		return;
+
+	const uint8_t* source = std::as_const(mc).data();
+	size_t         size   = mc.size();
+
+	size_t expanded = wolfGraphLumpExpandedSize(source, size, lumpnum, numlumps); // expanded size
+	if (lumpnum != WolfConstant(STARTTILE8, numlumps))
 	{
-		expanded = *(uint32_t*)source;
 		source += 4; // skip over length
+		size -= 4;
 	}
 
-	if (expanded == 0 || expanded > 65000)
+	if (expanded == 0)
 	{
 		log::error("ExpandWolfGraphLump: invalid expanded size in entry {}", lumpnum);
 		return;
 	}
 
-	uint8_t*  dest = new uint8_t[expanded];
-	uint8_t * end, *start;
-	HuffNode *headptr, *huffptr;
-
-	headptr = hufftable + 254; // head node is always node 254
+	vector<uint8_t> dest(expanded);
+	const HuffNode* headptr = hufftable + 254; // head node is always node 254
+	const HuffNode* huffptr = headptr;
 
+	// Read bits (lowest first) until the expanded size is reached
 	size_t written = 0;
-
-	end   = dest + expanded;
-	start = dest;
-
-	uint8_t  val  = *source++;
-	uint8_t  mask = 1;
-	uint16_t nodeval;
-	huffptr = headptr;
-	while (true)
+	for (size_t bit = 0; bit < size * 8 && written < expanded; ++bit)
 	{
-		if (!(val & mask))
+		uint16_t nodeval;
+		if (!(source[bit >> 3] & (1 << (bit & 7))))
 			nodeval = huffptr->bit0;
 		else
 			nodeval = huffptr->bit1;
-		if (mask == 0x80)
-			val = *source++, mask = 1;
-		else
-			mask <<= 1;
 
 		if (nodeval < 256)
 		{
-			*dest++ = (uint8_t)nodeval;
-			written++;
-			huffptr = headptr;
-			if (dest >= end)
-				break;
+			dest[written++] = (uint8_t)nodeval;
+			huffptr         = headptr;
 		}
 		else if (nodeval < 512)
 		{
@@ -347,8 +355,10 @@ void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, H
 			log::warning("ExpandWolfGraphLump: nodeval is out of control ({}) in entry {}", nodeval, lumpnum);
 	}
 
-	entry->importMem(start, expanded);
-	delete[] start;
+	if (written < expanded)
+		log::warning("ExpandWolfGraphLump: unexpected end of data in entry {}", lumpnum);
+
+	mc.importMem(dest.data(), expanded);
 }
 } // namespace
 
@@ -366,7 +376,7 @@ void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, H
 // -----------------------------------------------------------------------------
 uint32_t WolfArchive::getEntryOffset(ArchiveEntry* entry) const
 {
-	return uint32_t(entry->exProp<int>("Offset"));
+	return entry->storage().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -374,7 +384,7 @@ uint32_t WolfArchive::getEntryOffset(ArchiveEntry* entry) const
 // -----------------------------------------------------------------------------
 void WolfArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset) const
 {
-	entry->exProp("Offset") = (int)offset;
+	entry->storage().offset = offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -402,9 +412,10 @@ bool WolfArchive::open(string_view filename)
 			fn1.setFileName("MAPHEAD");
 		}
 		MemChunk data, head;
+		auto     data_file = findFileCasing(fn2);
 		head.importFile(findFileCasing(fn1));
-		data.importFile(findFileCasing(fn2));
-		opened = openMaps(head, data);
+		data.importFile(data_file);
+		opened = openMaps(head, data, data_file);
 	}
 	else if (fn1_name == "AUDIOHED" || fn1_name == "AUDIOT")
 	{
@@ -412,9 +423,10 @@ bool WolfArchive::open(string_view filename)
 		fn1.setFileName("AUDIOHED");
 		fn2.setFileName("AUDIOT");
 		MemChunk data, head;
+		auto     data_file = findFileCasing(fn2);
 		head.importFile(findFileCasing(fn1));
-		data.importFile(findFileCasing(fn2));
-		opened = openAudio(head, data);
+		data.importFile(data_file);
+		opened = openAudio(head, data, data_file);
 	}
 	else if (fn1_name == "VGAHEAD" || fn1_name == "VGAGRAPH" || fn1_name == "VGADICT")
 	{
@@ -424,10 +436,11 @@ bool WolfArchive::open(string_view filename)
 		fn2.setFileName("VGAGRAPH");
 		fn3.setFileName("VGADICT");
 		MemChunk data, head, dict;
+		auto     data_file = findFileCasing(fn2);
 		head.importFile(findFileCasing(fn1));
-		data.importFile(findFileCasing(fn2));
+		data.importFile(data_file);
 		dict.importFile(findFileCasing(fn3));
-		opened = openGraph(head, data, dict);
+		opened = openGraph(head, data, dict, data_file);
 	}
 	else
 	{
@@ -438,8 +451,12 @@ bool WolfArchive::open(string_view filename)
 			global::error = "Unable to open file. Make sure it isn't in use by another program.";
 			return false;
 		}
-		// Load from MemChunk
-		opened = open(mc);
+		// Load from MemChunk (with the filename set first, for the entry type cache)
+		const auto backupname = filename_;
+		filename_             = filename;
+		opened                = open(mc);
+		if (!opened)
+			filename_ = backupname;
 	}
 
 	if (opened)
@@ -457,6 +474,7 @@ bool WolfArchive::open(string_view filename)
 
 // -----------------------------------------------------------------------------
 // Reads VSWAP Wolf format data from a MemChunk.
+// Entry data is only loaded from [mc] when needed.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
 bool WolfArchive::open(MemChunk& mc)
@@ -546,7 +564,7 @@ bool WolfArchive::open(MemChunk& mc)
 			// Create & setup lump
 			auto nlump = std::make_shared<ArchiveEntry>(name, size);
 			nlump->setLoaded(false);
-			nlump->exProp("Offset") = (int)pages[d].offset;
+			nlump->storage().offset = pages[d].offset;
 			nlump->setState(ArchiveEntry::State::Unmodified);
 
 			d = e;
@@ -565,31 +583,20 @@ bool WolfArchive::open(MemChunk& mc)
 		}
 	}
 
-	// Detect all entry types
-	MemChunk edata;
+	// Keep the data to load entries from
+	chunk_data_.importMem(mc);
+
+	// Setup entry types (detected when needed unless cached)
+	EntryTypeCache type_cache(filename_, mc.size());
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
 		// Update splash window progress
 		ui::setSplashProgress((((float)a / (float)num_lumps)));
 
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		setupChunkEntry(entryAt(a), type_cache);
 	}
+	type_cache.save();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -602,9 +609,11 @@ bool WolfArchive::open(MemChunk& mc)
 
 // -----------------------------------------------------------------------------
 // Reads Wolf AUDIOT/AUDIOHEAD format data from a MemChunk.
+// [data_file] is the path to the file [data] was read from, if any.
+// Entry data is only loaded from [data] when needed.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
-bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
+bool WolfArchive::openAudio(MemChunk& head, MemChunk& data, string_view data_file)
 {
 	// Check data was given
 	if (!head.hasData() || !data.hasData())
@@ -617,10 +626,14 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
+	// Keep the data to load entries from
+	chunk_data_.importMem(data);
+
 	// Read the offsets
 	ui::setSplashProgressMessage("Reading Wolf archive data");
-	auto     offsets = (const uint32_t*)head.data();
-	MemChunk edata;
+	auto           offsets = (const uint32_t*)head.data();
+	MemChunk       edata;
+	EntryTypeCache type_cache(data_file, data.size());
 
 	// First try to determine where data type changes
 	enum
@@ -643,7 +656,7 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 		// Read entry data if it isn't zero-sized
 		if (size >= 4)
 		{
-			data.exportMemChunk(edata, offset, size);
+			edata.importShared(data, offset, size);
 
 			if (strncmp((const char*)&edata[size - 4], "!ID!", 4) == 0)
 				seg_ends[current_seg++] = d;
@@ -664,7 +677,7 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 				break;
 
 			// Look to see if we have an IMF
-			data.exportMemChunk(edata, offset, size);
+			edata.importShared(data, offset, size);
 
 			auto name = searchIMFName(edata);
 			if (name.empty())
@@ -707,35 +720,27 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 			++current_seg;
 		}
 
-		//
-		// Read entry data if it isn't zero-sized
-		if (size > 0)
-		{
-			// Read the entry data
-			data.exportMemChunk(edata, offset, size);
-		}
-
 		// Wolf chunks have no names, so just give them a number
 		string name;
-		if (current_seg == SegmentMusic)
+		if (current_seg == SegmentMusic && size > 0)
+		{
+			edata.importShared(data, offset, size);
 			name = searchIMFName(edata);
+		}
 		if (name.empty())
 			name = fmt::format("{}{:05d}", SEG_PREFIX[current_seg], d - d_ofs);
 
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
-
-		// Detect entry type
-		if (size > 0)
-			nlump->importMemChunk(edata);
-		EntryType::detectEntryType(*nlump);
+		nlump->storage().offset = offset;
+		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
-		nlump->setState(ArchiveEntry::State::Unmodified);
 		rootDir()->addEntry(nlump);
+		setupChunkEntry(nlump.get(), type_cache);
 	}
+	type_cache.save();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -748,9 +753,11 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 
 // -----------------------------------------------------------------------------
 // Reads Wolf GAMEMAPS/MAPHEAD format data from a MemChunk.
+// [data_file] is the path to the file [data] was read from, if any.
+// Entry data is only loaded from [data] when needed.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
-bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
+bool WolfArchive::openMaps(MemChunk& head, MemChunk& data, string_view data_file)
 {
 	// Check data was given
 	if (!head.hasData() || !data.hasData())
@@ -797,7 +804,7 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->storage().offset = offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -817,37 +824,26 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 			name        = fmt::format("PLANE{}", i);
 			auto nlump2 = std::make_shared<ArchiveEntry>(name, planelen[i]);
 			nlump2->setLoaded(false);
-			nlump2->exProp("Offset") = (int)planeofs[i];
+			nlump2->storage().offset = planeofs[i];
 			nlump2->setState(ArchiveEntry::State::Unmodified);
 			rootDir()->addEntry(nlump2);
 		}
 	}
 
-	// Detect all entry types
-	MemChunk edata;
+	// Keep the data to load entries from
+	chunk_data_.importMem(data);
+
+	// Setup entry types (detected when needed unless cached)
+	EntryTypeCache type_cache(data_file, data.size());
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
 		// Update splash window progress
-		ui::setSplashProgress((((float)a / (float)num_lumps)));
-
-		// Get entry
-		auto entry = entryAt(a);
+		ui::setSplashProgress((((float)a / (float)numEntries())));
 
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			data.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		setupChunkEntry(entryAt(a), type_cache);
 	}
+	type_cache.save();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -860,10 +856,12 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 
 // -----------------------------------------------------------------------------
 // Reads Wolf VGAGRAPH/VGAHEAD/VGADICT format data from a MemChunk.
+// [data_file] is the path to the file [data] was read from, if any.
+// Entry data is only loaded from [data] when needed.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
 #define WC(a) WolfConstant(a, num_lumps)
-bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
+bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict, string_view data_file)
 {
 	// Check data was given
 	if (!head.hasData() || !data.hasData() || !dict.hasData())
@@ -875,12 +873,11 @@ bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
 			"WolfArchive::openGraph: VGADICT is improperly sized ({} bytes instead of 1024)", dict.size());
 		return false;
 	}
-	HuffNode nodes[256];
-	memcpy(nodes, dict.data(), 1024);
 
 	// Read Wolf header file
 	uint32_t num_lumps = (head.size() / 3) - 1;
 	spritestart_ = soundstart_ = num_lumps;
+	num_graph_chunks_          = num_lumps;
 
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
@@ -934,53 +931,52 @@ bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
 			name = "LMP";
 		name += fmt::format("{:05d}", d);
 
+		// Get the size of the chunk once expanded (with a header added if it's a picture)
+		uint32_t full_size = size;
+		if (size > 0)
+		{
+			if (auto expanded = wolfGraphLumpExpandedSize(std::as_const(data).data() + offset, size, d, num_lumps))
+				full_size = expanded;
+			if (d >= WC(STARTPICS) && d < WC(STARTPICM))
+				full_size += 4;
+		}
 
-		// Create & setup lump
-		auto nlump = std::make_shared<ArchiveEntry>(name, size);
+		// Create & setup lump (the chunk is expanded when its data is loaded)
+		auto nlump = std::make_shared<ArchiveEntry>(name, full_size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->storage().offset = offset;
+		nlump->storage().index  = d;
+		nlump->storage().method = static_cast<uint8_t>(ChunkCompression::Huffman);
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
 		rootDir()->addEntry(nlump);
 	}
 
-	// Detect all entry types
-	MemChunk        edata;
-	const uint16_t* pictable = nullptr;
+	// Keep the data to load (and expand) entries from
+	chunk_data_.importMem(data);
+	graph_head_.importMem(head);
+	graph_dict_.importMem(dict);
+
+	// Read pictable information (picture sizes) from the first chunk
+	MemChunk info;
+	if (numEntries() > 0 && readChunk(entryAt(0), info))
+	{
+		graph_pictable_.resize(info.size() / 2);
+		memcpy(graph_pictable_.data(), std::as_const(info).data(), graph_pictable_.size() * 2);
+	}
+
+	// Setup entry types (detected when needed unless cached)
+	EntryTypeCache type_cache(data_file, data.size());
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
 		// Update splash window progress
 		ui::setSplashProgress((((float)a / (float)num_lumps)));
 
-		// Get entry
-		auto entry = entryAt(a);
-
-		// Read entry data if it isn't zero-sized
-		if (entry->size() > 0)
-		{
-			// Read the entry data
-			data.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
-		}
-		expandWolfGraphLump(entry, a, num_lumps, nodes);
-
-		// Store pictable information
-		if (a == 0)
-			pictable = (uint16_t*)entry->rawData();
-		else if (a >= WC(STARTPICS) && a < WC(STARTPICM))
-		{
-			size_t i = (a - WC(STARTPICS)) << 1;
-			addWolfPicHeader(entry, pictable[i], pictable[i + 1]);
-		}
-
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		setupChunkEntry(entryAt(a), type_cache);
 	}
+	type_cache.save();
 
 	// Setup variables
 	sig_blocker.unblock();
@@ -1038,7 +1034,7 @@ bool WolfArchive::write(MemChunk& mc, bool update)
 }
 
 // -----------------------------------------------------------------------------
-// Loads an entry's data from the datafile
+// Loads an entry's data from the archive data (expanding it if needed)
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
 bool WolfArchive::loadEntryData(ArchiveEntry* entry)
@@ -1055,19 +1051,14 @@ bool WolfArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
-	// Open wadfile
-	wxFile file(filename_);
-
-	// Check if opening the file failed
-	if (!file.IsOpened())
+	// Read (and expand if needed) the chunk data
+	MemChunk mc;
+	if (!readChunk(entry, mc))
 	{
-		log::error("WolfArchive::loadEntryData: Failed to open datfile {}", filename_);
+		log::error("WolfArchive::loadEntryData: Failed to read data for entry {}", entry->name());
 		return false;
 	}
-
-	// Seek to lump offset in file and read it in
-	file.Seek(getEntryOffset(entry), wxFromStart);
-	entry->importFileStream(file, entry->size());
+	entry->importMemChunk(mc);
 
 	// Set the lump to loaded
 	entry->setLoaded();
@@ -1075,21 +1066,80 @@ bool WolfArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Sets up the type of [entry] (an unloaded chunk entry that was just added).
+// The type is taken from [type_cache] if possible, otherwise detection is
+// deferred until the type is needed (so the chunk isn't read or expanded until
+// then), unless all entry data is to be loaded when opening
+// -----------------------------------------------------------------------------
+void WolfArchive::setupChunkEntry(ArchiveEntry* entry, EntryTypeCache& type_cache)
+{
+	const auto key = entry->storage().offset;
+
+	if (entry->size() == 0)
+		EntryType::detectEntryType(*entry);
+	else if (archive_load_data)
+	{
+		entry->data();
+		EntryType::detectEntryType(*entry);
+		type_cache.add(entry, key);
+	}
+	else if (type_cache.apply(*entry, key))
+		type_cache.add(entry, key);
+	else
+		entry->setTypeDeferred();
+
+	entry->setState(ArchiveEntry::State::Unmodified);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the chunk data for [entry] from the archive data into [mc], expanding
+// it if it is a compressed VGAGRAPH chunk (otherwise [mc] references the
+// archive data rather than copying it).
+// Returns false if the chunk is outside of the archive data
+// -----------------------------------------------------------------------------
+bool WolfArchive::readChunk(const ArchiveEntry* entry, MemChunk& mc) const
+{
+	const auto& storage = entry->storage();
+	if (storage.method != static_cast<uint8_t>(ChunkCompression::Huffman))
+		return mc.importShared(chunk_data_, storage.offset, entry->size());
+
+	// Get compressed chunk size from the next chunk offset
+	const auto size = graph_head_.readL24((storage.index + 1) * 3) - storage.offset;
+	if (!mc.importShared(chunk_data_, storage.offset, size))
+		return false;
+
+	// Expand
+	HuffNode nodes[256];
+	memcpy(nodes, graph_dict_.data(), 1024);
+	expandWolfGraphLump(mc, storage.index, num_graph_chunks_, nodes);
+
+	// Add picture header
+	const auto start_pics = WolfConstant(STARTPICS, num_graph_chunks_);
+	if (storage.index >= start_pics && storage.index < WolfConstant(STARTPICM, num_graph_chunks_))
+	{
+		const size_t i = (storage.index - start_pics) << 1;
+		if (i + 1 < graph_pictable_.size())
+			addWolfPicHeader(mc, graph_pictable_[i], graph_pictable_[i + 1]);
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Wolfenstein VSWAP archive
 // -----------------------------------------------------------------------------
-bool WolfArchive::isWolfArchive(MemChunk& mc)
+bool WolfArchive::isWolfArchive(const MemChunk& mc)
 {
 	// Read Wolf header
-	mc.seek(0, SEEK_SET);
 	uint16_t num_lumps, sprites, sounds;
-	mc.read(&num_lumps, 2); // Size
+	mc.read(0, &num_lumps, 2); // Size
 	num_lumps = wxINT16_SWAP_ON_BE(num_lumps);
 	if (num_lumps == 0)
 		return false;
 
-	mc.read(&sprites, 2); // Sprites start
-	mc.read(&sounds, 2);  // Sounds start
+	mc.read(2, &sprites, 2); // Sprites start
+	mc.read(4, &sounds, 2);  // Sounds start
 	sprites = wxINT16_SWAP_ON_BE(sprites);
 	sounds  = wxINT16_SWAP_ON_BE(sounds);
 	if (sprites > sounds)
@@ -1108,7 +1158,7 @@ bool WolfArchive::isWolfArchive(MemChunk& mc)
 	uint32_t           lastoffset = 0;
 	for (size_t a = 0; a < num_lumps; ++a)
 	{
-		mc.read(&offset, 4);
+		mc.read(6 + a * 4, &offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 		if (offset < lastoffset || offset % 512)
 			return false;
@@ -1118,7 +1168,7 @@ bool WolfArchive::isWolfArchive(MemChunk& mc)
 	uint16_t lastsize = 0;
 	for (size_t b = 0; b < num_lumps; ++b)
 	{
-		mc.read(&size, 2);
+		mc.read(6 + num_lumps * 4 + b * 2, &size, 2);
 		size = wxINT16_SWAP_ON_BE(size);
 		pagesize += (size / 512) + ((size % 512) ? 1 : 0);
 		pages[b].size = size;
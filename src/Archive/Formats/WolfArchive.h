@@ -4,6 +4,8 @@
 
 namespace slade
 {
+class EntryTypeCache;
+
 class WolfArchive : public TreelessArchive
 {
 public:
@@ -18,9 +20,9 @@ public:
 	bool open(string_view filename) override; // Open from File
 	bool open(MemChunk& mc) override;         // Open from MemChunk
 
-	bool openAudio(MemChunk& head, MemChunk& data);
-	bool openGraph(MemChunk& head, MemChunk& data, MemChunk& dict);
-	bool openMaps(MemChunk& head, MemChunk& data);
+	bool openAudio(MemChunk& head, MemChunk& data, string_view data_file = {});
+	bool openGraph(MemChunk& head, MemChunk& data, MemChunk& dict, string_view data_file = {});
+	bool openMaps(MemChunk& head, MemChunk& data, string_view data_file = {});
 
 	// Writing/Saving
 	bool write(MemChunk& mc, bool update = true) override; // Write to MemChunk
@@ -39,7 +41,7 @@ public:
 	// Entry modification
 	bool renameEntry(ArchiveEntry* entry, string_view name) override;
 
-	static bool isWolfArchive(MemChunk& mc);
+	static bool isWolfArchive(const MemChunk& mc);
 	static bool isWolfArchive(const string& filename);
 
 private:
@@ -49,7 +51,25 @@ private:
 		uint16_t size;
 	};
 
+	// Compression of an entry's chunk data (stored in the entry's storage().method)
+	enum class ChunkCompression : uint8_t
+	{
+		None = 0,
+		Huffman // VGAGRAPH chunk (storage().index is the chunk number)
+	};
+
 	uint16_t spritestart_;
 	uint16_t soundstart_;
+
+	// Chunk data is kept so entries can be loaded (and decompressed) only when
+	// their data is accessed
+	MemChunk         chunk_data_;          // VSWAP, AUDIOT, GAMEMAPS or VGAGRAPH data
+	MemChunk         graph_head_;          // VGAHEAD data (chunk offsets)
+	MemChunk         graph_dict_;          // VGADICT data (Huffman tree)
+	vector<uint16_t> graph_pictable_;      // Picture sizes, from the first VGAGRAPH chunk
+	uint32_t         num_graph_chunks_ = 0;
+
+	void setupChunkEntry(ArchiveEntry* entry, EntryTypeCache& type_cache);
+	bool readChunk(const ArchiveEntry* entry, MemChunk& mc) const;
 };
 } // namespace slade
@@ -32,13 +32,17 @@
 #include "Main.h"
 #include "ZipArchive.h"
 #include "App.h"
+#include "Archive/EntryType/EntryTypeCache.h"
 #include "General/Misc.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "UI/WxUtils.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 #include "WadArchive.h"
+#include <filesystem>
 #include <fstream>
+#include <wx/mstream.h>
 
 using namespace slade;
 
@@ -51,6 +55,46 @@ using namespace slade;
 EXTERN_CVAR(Bool, archive_load_data)
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, zip_lazy_open, false, CVar::Flag::Save)
+CVAR(String, zip_store_types, "png;jpeg;jpg;snd_ogg;ogg;snd_flac;flac;snd_mp3;mp3;zip;pk3;pk7;7z;gz", CVar::Flag::Save)
+CVAR(Int, zip_store_max_size, 64, CVar::Flag::Save) // Entries this size or smaller (bytes) are stored uncompressed
+constexpr size_t type_detect_batch_size = 64 * 1024 * 1024; // Max. entry data to load at once for type detection
+constexpr size_t stream_entry_size      = 250 * 1024 * 1024; // Entries larger than this aren't loaded when opening
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [entry] should be stored in the zip without compression -
+// if it is tiny (deflate overhead would outweigh any gains) or its type or
+// extension is in zip_store_types (ie. the data is already compressed)
+// -----------------------------------------------------------------------------
+bool storeUncompressed(const ArchiveEntry* entry, const vector<string_view>& store_types)
+{
+	if (entry->size() <= static_cast<unsigned>(std::max<int>(zip_store_max_size, 0)))
+		return true;
+
+	auto type_id = entry->type()->id();
+	auto ext     = strutil::Path::extensionOf(entry->name());
+	for (const auto& type : store_types)
+		if (type == type_id || (!ext.empty() && strutil::equalCI(type, ext)))
+			return true;
+
+	return false;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ZipArchive Class Functions
@@ -63,6 +107,9 @@ EXTERN_CVAR(Bool, archive_load_data)
 // -----------------------------------------------------------------------------
 ZipArchive::~ZipArchive()
 {
+	if (types_deferred_)
+		saveTypeCache();
+
 	if (fileutil::fileExists(temp_file_))
 		fileutil::removeFile(temp_file_);
 }
@@ -80,10 +127,6 @@ bool ZipArchive::open(string_view filename)
 		return false;
 	}
 
-	// Copy the zip to a temp file (for use when saving)
-	generateTempFileName(filename);
-	fileutil::copyFile(filename, temp_file_);
-
 	// Open the file
 	wxFFileInputStream in(wxutil::strFromView(filename));
 	if (!in.IsOk())
@@ -92,6 +135,29 @@ bool ZipArchive::open(string_view filename)
 		return false;
 	}
 
+	// Read the zip
+	zip_data_.clear();
+	if (!readZip(in, filename, zip_lazy_open && !archive_load_data))
+		return false;
+
+	// Setup variables
+	filename_      = filename;
+	file_modified_ = fileutil::fileModifiedTime(filename);
+	on_disk_       = true;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads zip data from the [in] stream. [filename] is the path to the zip file
+// being read, if any (used for the entry type cache).
+// If [lazy] is true, only the zip central directory is read - entry data is
+// not decompressed and type detection is deferred until each entry's type is
+// first requested.
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool ZipArchive::readZip(wxInputStream& in, string_view filename, bool lazy)
+{
 	// Create zip stream
 	wxZipInputStream zip(in);
 	if (!zip.IsOk())
@@ -103,9 +169,28 @@ bool ZipArchive::open(string_view filename)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	const ArchiveModSignalBlocker sig_blocker{ *this };
 
+	// Entry types are detected in batches, to limit the amount of entry data
+	// loaded at once. Types cached from the last time this file was opened
+	// are used where possible
+	EntryTypeCache        type_cache(filename, static_cast<uint64_t>(in.GetLength()));
+	vector<ArchiveEntry*> batch;
+	size_t                batch_size   = 0;
+	auto                  detect_batch = [&batch, &batch_size]() {
+		EntryType::detectEntryTypes(batch);
+
+		// Unload data if needed
+		if (!archive_load_data)
+			for (auto entry : batch)
+				entry->unloadData();
+
+		batch.clear();
+		batch_size = 0;
+	};
+
 	// Go through all zip entries
 	int  entry_index = 0;
 	auto zip_entry   = zip.GetNextEntry();
+	zip_entries_.clear();
 	ui::setSplashProgressMessage("Reading zip data");
 	while (zip_entry)
 	{
@@ -121,39 +206,69 @@ bool ZipArchive::open(string_view filename)
 			// Get the entry name as a Path (so we can break it up)
 			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
 
-			// Create entry
-			auto new_entry = std::make_shared<ArchiveEntry>(
-				misc::fileNameToLumpName(fn.fileName()), zip_entry->GetSize());
+			// Create entry. Entries too large for a 32-bit size (zip64) can't be
+			// loaded, but are still copied when saving or exporting the archive
+			const auto ze_size   = static_cast<uint64_t>(zip_entry->GetSize());
+			const bool too_large = ze_size > std::numeric_limits<uint32_t>::max();
+			auto       new_entry = std::make_shared<ArchiveEntry>(
+				misc::fileNameToLumpName(fn.fileName()), too_large ? 0 : static_cast<uint32_t>(ze_size));
+			if (too_large)
+				log::warning(
+					"Zip entry {} is too large to be loaded or edited ({} mb)", fn.fullPath(), ze_size / (1 << 20));
 
 			// Setup entry info
 			new_entry->setLoaded(false);
-			new_entry->exProp("ZipIndex") = entry_index;
+			new_entry->storage().index = entry_index;
 
 			// Add entry and directory to directory tree
 			auto ndir = createDir(fn.path(true));
 			ndir->addEntry(new_entry);
 
-			if (const auto ze_size = zip_entry->GetSize(); ze_size < 250 * 1024 * 1024)
+			if (ze_size > stream_entry_size)
 			{
-				if (ze_size > 0)
+				// Very large entry, don't load it now. It is only loaded if something
+				// explicitly needs its data, otherwise it is streamed directly from the
+				// zip file when exporting or saving
+				if (too_large || !type_cache.apply(*new_entry, entry_index))
+					new_entry->setType(EntryType::unknownType());
+				if (!too_large)
+					type_cache.add(new_entry.get(), entry_index);
+			}
+			else if (lazy && ze_size > 0)
+			{
+				// Don't read the entry data, detect its type when needed (unless cached)
+				if (!type_cache.apply(*new_entry, entry_index))
 				{
-					vector<uint8_t> data(ze_size);
-					zip.Read(data.data(), ze_size); // Note: this is where exceedingly large files cause an exception.
-					new_entry->importMem(data.data(), static_cast<uint32_t>(ze_size));
+					new_entry->setTypeDeferred();
+					types_deferred_ = type_cache.isEnabled();
 				}
-				new_entry->setLoaded(true);
-
-				// Determine its type
-				EntryType::detectEntryType(*new_entry);
-
-				// Unload data if needed
-				if (!archive_load_data)
-					new_entry->unloadData();
+				type_cache.add(new_entry.get(), entry_index);
+			}
+			else if (ze_size > 0 && !archive_load_data && type_cache.apply(*new_entry, entry_index))
+			{
+				// Type is cached, no need to read the entry data now
+				type_cache.add(new_entry.get(), entry_index);
 			}
 			else
 			{
-				global::error = fmt::format("Entry too large: {} is {} mb", fn.fullPath(), ze_size / (1 << 20));
-				return false;
+				if (ze_size > 0)
+				{
+					MemChunk data(static_cast<uint32_t>(ze_size));
+					zip.Read(data.data(), ze_size);
+					new_entry->importMemChunk(data);
+					type_cache.add(new_entry.get(), entry_index);
+				}
+				new_entry->setLoaded(true);
+
+				// Use cached type if available (importing the data resets it),
+				// otherwise add to type detection batch
+				if (ze_size == 0 || !type_cache.apply(*new_entry, entry_index))
+				{
+					batch.push_back(new_entry.get());
+					batch_size += ze_size;
+					if (batch_size >= type_detect_batch_size)
+						detect_batch();
+				}
 			}
 		}
 		else
@@ -164,10 +279,12 @@ bool ZipArchive::open(string_view filename)
 		}
 
 		// Go to next entry in the zip file
-		delete zip_entry;
+		zip_entries_.emplace_back(zip_entry);
 		zip_entry = zip.GetNextEntry();
 		entry_index++;
 	}
+	detect_batch();
+	type_cache.save();
 	ui::updateSplash();
 
 	// Set all entries/directories to unmodified
@@ -179,34 +296,54 @@ bool ZipArchive::open(string_view filename)
 	// Enable announcements
 	sig_blocker.unblock();
 
-	// Setup variables
-	filename_      = filename;
-	file_modified_ = fileutil::fileModifiedTime(filename);
 	setModified(false);
-	on_disk_ = true;
-
 	ui::setSplashProgressMessage("");
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the types of all unmodified entries to the entry type cache for the
+// zip file on disk. Used when type detection was deferred on opening, since
+// the types aren't known until the entries are accessed (see readZip)
+// -----------------------------------------------------------------------------
+void ZipArchive::saveTypeCache()
+{
+	// Entry zip indices only match the file on disk if it hasn't changed since
+	// it was last opened or saved
+	if (!on_disk_ || !fileutil::fileExists(filename_) || fileutil::fileModifiedTime(filename_) != file_modified_)
+		return;
+
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
+
+	std::error_code ec;
+	EntryTypeCache  type_cache(filename_, std::filesystem::file_size(filename_, ec));
+	for (auto entry : entries)
+		if (entry->state() == ArchiveEntry::State::Unmodified && entry->storage().hasIndex() && entry->size() > 0)
+			type_cache.add(entry, entry->storage().index);
+	type_cache.save();
+}
+
 // -----------------------------------------------------------------------------
 // Reads zip format data from a MemChunk
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
 bool ZipArchive::open(MemChunk& mc)
 {
-	// Write the MemChunk to a temp file
-	const auto tempfile = app::path("slade-temp-open.zip", app::Dir::Temp);
-	mc.exportFile(tempfile);
-
-	// Load the file
-	const bool success = open(tempfile);
+	// Keep the zip data to read entries from (and copy unmodified entries from
+	// when saving). This shares the data with [mc] rather than copying it
+	zip_data_.importMem(mc);
 
-	// Clean up
-	fileutil::removeFile(tempfile);
+	// Read the zip directly from memory
+	wxMemoryInputStream in(std::as_const(zip_data_).data(), zip_data_.size());
+	if (!readZip(in, "", zip_lazy_open && !archive_load_data))
+	{
+		zip_data_.clear();
+		return false;
+	}
 
-	return success;
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -223,6 +360,11 @@ bool ZipArchive::write(MemChunk& mc, bool update)
 	{
 		// Load file into MemChunk
 		success = mc.importFile(tempfile);
+
+		// Entry zip indices now refer to the written data, so read entries from
+		// it from now on if the zip is in memory
+		if (success && zip_data_.hasData())
+			zip_data_.importMem(mc);
 	}
 
 	// Clean up
@@ -237,6 +379,27 @@ bool ZipArchive::write(MemChunk& mc, bool update)
 // -----------------------------------------------------------------------------
 bool ZipArchive::write(string_view filename, bool update)
 {
+	// Get the old zip to copy unmodified entries from (see below). This is read
+	// directly from the archive file unless it is about to be overwritten, in
+	// which case it is copied to a temp file first
+	std::error_code ec;
+	auto            old_zip = temp_file_;
+	if (!fileutil::fileExists(old_zip) && on_disk_ && fileutil::fileExists(filename_))
+	{
+		if (std::filesystem::equivalent(filename_, string{ filename }, ec))
+		{
+			generateTempFileName(filename_);
+			if (!fileutil::copyFile(filename_, temp_file_))
+			{
+				global::error = "Unable to create a temporary copy of the zip for saving";
+				return false;
+			}
+			old_zip = temp_file_;
+		}
+		else
+			old_zip = filename_;
+	}
+
 	// Open the file
 	wxFFileOutputStream out(wxutil::strFromView(filename));
 	if (!out.IsOk())
@@ -253,16 +416,18 @@ bool ZipArchive::write(string_view filename, bool update)
 		return false;
 	}
 
-	// Open old zip for copying, from the temp file that was copied on opening.
-	// This is used to copy any entries that have been previously saved/compressed
-	// and are unmodified, to greatly speed up zip file saving by not having to
-	// recompress unchanged entries
-	unique_ptr<wxZipInputStream>   inzip;
-	unique_ptr<wxFFileInputStream> in;
-	vector<wxZipEntry*>            c_entries;
-	if (fileutil::fileExists(temp_file_))
+	// Open old zip for copying. This is used to copy any entries that have been
+	// previously saved/compressed and are unmodified, to greatly speed up zip
+	// file saving by not having to recompress unchanged entries
+	unique_ptr<wxZipInputStream> inzip;
+	unique_ptr<wxInputStream>    in;
+	vector<wxZipEntry*>          c_entries;
+	if (zip_data_.hasData())
+		in = std::make_unique<wxMemoryInputStream>(std::as_const(zip_data_).data(), zip_data_.size());
+	else if (fileutil::fileExists(old_zip))
+		in = std::make_unique<wxFFileInputStream>(old_zip);
+	if (in)
 	{
-		in    = std::make_unique<wxFFileInputStream>(temp_file_);
 		inzip = std::make_unique<wxZipInputStream>(*in);
 
 		if (inzip->IsOk())
@@ -284,6 +449,46 @@ bool ZipArchive::write(string_view filename, bool update)
 	vector<ArchiveEntry*> entries;
 	putEntryTreeAsList(entries);
 
+	// Compress all new/modified entries in parallel first, each into a single
+	// entry zip in memory. These are then copied raw into the output zip below.
+	// Entries that wouldn't benefit from compression are just stored
+	auto                                     store_types = strutil::splitV(zip_store_types.value, ';');
+	vector<unique_ptr<wxMemoryOutputStream>> deflated(entries.size());
+	vector<uint8_t>                          store(entries.size(), 0);
+	vector<size_t>                           to_deflate;
+	for (size_t a = 0; a < entries.size(); a++)
+	{
+		if (entries[a]->type() == EntryType::folderType())
+			continue;
+
+		int index = -1;
+		if (entries[a]->storage().hasIndex())
+			index = entries[a]->storage().index;
+
+		if (!inzip || entries[a]->state() != ArchiveEntry::State::Unmodified || index < 0
+			|| index >= inzip->GetTotalEntries())
+		{
+			entries[a]->rawData(); // Make sure data is loaded (isn't thread-safe)
+			if (storeUncompressed(entries[a], store_types))
+				store[a] = 1;
+			else
+				to_deflate.push_back(a);
+		}
+	}
+	if (to_deflate.size() > 1)
+	{
+		threadpool::parallelFor(to_deflate.size(), [&](size_t i) {
+			const auto entry  = entries[to_deflate[i]];
+			auto       buffer = std::make_unique<wxMemoryOutputStream>();
+
+			wxZipOutputStream entry_zip(*buffer, 9);
+			entry_zip.PutNextEntry(entry->path() + misc::lumpNameToFileName(entry->name()));
+			entry_zip.Write(entry->rawData(false), entry->size());
+			if (entry_zip.Close())
+				deflated[to_deflate[i]] = std::move(buffer);
+		});
+	}
+
 	// Go through all entries
 	for (size_t a = 0; a < entries.size(); a++)
 	{
@@ -298,8 +503,8 @@ bool ZipArchive::write(string_view filename, bool update)
 
 		// Get entry zip index
 		int index = -1;
-		if (entries[a]->exProps().contains("ZipIndex"))
-			index = entries[a]->exProp<int>("ZipIndex");
+		if (entries[a]->storage().hasIndex())
+			index = entries[a]->storage().index;
 
 		auto saname = misc::lumpNameToFileName(entries[a]->name());
 		if (!inzip || entries[a]->state() != ArchiveEntry::State::Unmodified || index < 0
@@ -307,9 +512,25 @@ bool ZipArchive::write(string_view filename, bool update)
 		{
 			// If the current entry has been changed, or doesn't exist in the old zip,
 			// (re)compress its data and write it to the zip
-			const auto zipentry = new wxZipEntry(entries[a]->path() + saname);
-			zip.PutNextEntry(zipentry);
-			zip.Write(entries[a]->rawData(), entries[a]->size());
+			if (deflated[a])
+			{
+				// Already compressed, copy it over from the in-memory zip
+				wxMemoryInputStream deflated_in(*deflated[a]);
+				wxZipInputStream    deflated_zip(deflated_in);
+				zip.CopyEntry(deflated_zip.GetNextEntry(), deflated_zip);
+				deflated[a].reset();
+			}
+			else
+			{
+				const auto zipentry = new wxZipEntry(entries[a]->path() + saname);
+				if (store[a])
+				{
+					zipentry->SetMethod(wxZIP_METHOD_STORE);
+					zipentry->SetSize(entries[a]->size());
+				}
+				zip.PutNextEntry(zipentry);
+				zip.Write(entries[a]->rawData(), entries[a]->size());
+			}
 		}
 		else
 		{
@@ -323,7 +544,7 @@ bool ZipArchive::write(string_view filename, bool update)
 		if (update)
 		{
 			entries[a]->setState(ArchiveEntry::State::Unmodified);
-			entries[a]->exProp("ZipIndex") = static_cast<int>(a);
+			entries[a]->storage().index = a;
 		}
 	}
 
@@ -331,10 +552,28 @@ bool ZipArchive::write(string_view filename, bool update)
 	zip.Close();
 	out.Close();
 
-	// Update the temp file
-	if (temp_file_.empty())
-		generateTempFileName(filename);
-	fileutil::copyFile(filename, temp_file_);
+	// Entry indices have changed so the cached central directory is no longer valid
+	zip_entries_.clear();
+
+	// Entry zip indices now refer to the written file
+	if (update)
+	{
+		// Close the old zip before removing its temp copy
+		inzip = nullptr;
+		in    = nullptr;
+		if (fileutil::fileExists(temp_file_))
+			fileutil::removeFile(temp_file_);
+
+		// If the written file isn't the archive file (eg. writing to a MemChunk),
+		// keep a copy of it to copy entries from when next saving. Not needed if
+		// the zip is in memory, since the in-memory data is updated instead
+		if (!zip_data_.hasData() && !std::filesystem::equivalent(filename_, string{ filename }, ec))
+		{
+			if (temp_file_.empty())
+				generateTempFileName(filename);
+			fileutil::copyFile(filename, temp_file_);
+		}
+	}
 
 	return true;
 }
@@ -361,63 +600,147 @@ bool ZipArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
-	// Check that the entry has a zip index
-	int zip_index;
-	if (entry->exProps().contains("ZipIndex"))
-		zip_index = entry->exProp<int>("ZipIndex");
-	else
+	// Open the zip data
+	auto in = openZipData();
+	if (!in)
 	{
-		log::error("ZipArchive::loadEntryData: Entry {} has no zip entry index!", entry->name());
+		log::error("ZipArchive::loadEntryData: Unable to open zip file \"{}\"!", filename_);
 		return false;
 	}
 
-	// Open the file
-	wxFFileInputStream in(filename_);
-	if (!in.IsOk())
+	// Create zip stream and go directly to the entry data
+	wxZipInputStream zip(*in);
+	auto             zentry = openZipEntry(zip, entry);
+	if (!zentry)
+		return false;
+
+	// Lock entry state
+	entry->lockState();
+
+	// Read the data
+	MemChunk data(static_cast<uint32_t>(zentry->GetSize()));
+	if (!data.hasData())
 	{
-		log::error("ZipArchive::loadEntryData: Unable to open zip file \"{}\"!", filename_);
+		entry->unlockState();
 		return false;
 	}
+	zip.Read(data.data(), data.size());
+	entry->importMemChunk(data);
 
-	// Create zip stream
-	wxZipInputStream zip(in);
+	// Set the entry to loaded
+	entry->setLoaded();
+	entry->unlockState();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the (unloaded) data of [entry] directly from the zip file to [file],
+// inflating it incrementally in bounded chunks rather than loading it all into
+// memory.
+// Returns false if the entry data can't be exported this way
+// -----------------------------------------------------------------------------
+bool ZipArchive::exportEntryData(ArchiveEntry* entry, wxFile& file)
+{
+	// Check that the entry belongs to this archive and isn't loaded
+	if (entry->parent() != this || entry->isLoaded())
+		return false;
+
+	// Open the zip data
+	auto in = openZipData();
+	if (!in)
+		return false;
+
+	// Create zip stream and go directly to the entry data
+	wxZipInputStream zip(*in);
+	auto             zentry = openZipEntry(zip, entry);
+	if (!zentry)
+		return false;
+
+	// Copy data in chunks
+	constexpr size_t chunk_size = 1024 * 1024;
+	vector<uint8_t>  buffer(std::min<size_t>(zentry->GetSize(), chunk_size));
+	auto             remaining = static_cast<size_t>(zentry->GetSize());
+	while (remaining > 0)
+	{
+		zip.Read(buffer.data(), std::min(remaining, chunk_size));
+		const auto count = zip.LastRead();
+		if (count == 0 || file.Write(buffer.data(), count) != count)
+			return false;
+
+		remaining -= count;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a stream to read the zip data from - the in-memory zip data if the
+// zip was opened from a MemChunk, otherwise the zip file.
+// Returns nullptr if the zip file couldn't be opened
+// -----------------------------------------------------------------------------
+unique_ptr<wxInputStream> ZipArchive::openZipData() const
+{
+	if (zip_data_.hasData())
+		return std::make_unique<wxMemoryInputStream>(zip_data_.data(), zip_data_.size());
+
+	auto in = std::make_unique<wxFFileInputStream>(filename_);
+	if (!in->IsOk())
+		return nullptr;
+
+	return in;
+}
+
+// -----------------------------------------------------------------------------
+// Opens the zip entry for [entry] in [zip], reading (and caching) the zip
+// central directory if needed.
+// Returns the opened zip entry, or nullptr if it couldn't be opened
+// -----------------------------------------------------------------------------
+wxZipEntry* ZipArchive::openZipEntry(wxZipInputStream& zip, ArchiveEntry* entry)
+{
 	if (!zip.IsOk())
 	{
-		log::error("ZipArchive::loadEntryData: Invalid zip file \"{}\"!", filename_);
-		return false;
+		log::error("ZipArchive: Invalid zip file \"{}\"!", filename_);
+		return nullptr;
 	}
 
-	// Lock entry state
-	entry->lockState();
+	// Check that the entry has a zip index
+	int zip_index;
+	if (entry->storage().hasIndex())
+		zip_index = entry->storage().index;
+	else
+	{
+		log::error("ZipArchive: Entry {} has no zip entry index!", entry->name());
+		return nullptr;
+	}
 
-	// Skip to correct entry in zip
-	auto zentry = zip.GetNextEntry();
-	for (long a = 0; a < zip_index; a++)
+	// Read the zip central directory if it isn't cached
+	if (zip_entries_.empty())
 	{
-		delete zentry;
-		zentry = zip.GetNextEntry();
+		auto zentry = zip.GetNextEntry();
+		while (zentry)
+		{
+			zip_entries_.emplace_back(zentry);
+			zentry = zip.GetNextEntry();
+		}
 	}
 
 	// Abort if entry doesn't exist in zip (some kind of error)
-	if (!zentry)
+	if (zip_index < 0 || zip_index >= static_cast<int>(zip_entries_.size()))
 	{
 		log::error("Error: ZipEntry for entry \"{}\" does not exist in zip", entry->name());
-		return false;
+		return nullptr;
 	}
 
-	// Read the data
-	vector<uint8_t> data(zentry->GetSize());
-	zip.Read(data.data(), zentry->GetSize());
-	entry->importMem(data.data(), static_cast<uint32_t>(zentry->GetSize()));
-
-	// Set the entry to loaded
-	entry->setLoaded();
-	entry->unlockState();
-
-	// Clean up
-	delete zentry;
+	// Go directly to the entry data
+	auto zentry = zip_entries_[zip_index].get();
+	if (!zip.OpenEntry(*zentry))
+	{
+		log::error("ZipArchive: Unable to open zip entry for \"{}\"", entry->name());
+		return nullptr;
+	}
 
-	return true;
+	return zentry;
 }
 
 // -----------------------------------------------------------------------------
@@ -647,7 +970,7 @@ void ZipArchive::generateTempFileName(string_view filename)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid zip archive
 // -----------------------------------------------------------------------------
-bool ZipArchive::isZipArchive(MemChunk& mc)
+bool ZipArchive::isZipArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 22)
@@ -655,8 +978,7 @@ bool ZipArchive::isZipArchive(MemChunk& mc)
 
 	// Read first 4 bytes
 	uint32_t sig;
-	mc.seek(0, SEEK_SET);
-	mc.read(&sig, sizeof(uint32_t));
+	mc.read(0, &sig, sizeof(uint32_t));
 
 	// Check for signature
 	if (sig != 0x04034b50 && // File header
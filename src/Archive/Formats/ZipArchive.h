@@ -20,6 +20,7 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool exportEntryData(ArchiveEntry* entry, wxFile& file) override;
 
 	// Entry addition/removal
 	shared_ptr<ArchiveEntry> addEntry(shared_ptr<ArchiveEntry> entry, string_view add_namespace) override;
@@ -34,12 +35,24 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isZipArchive(MemChunk& mc);
+	static bool isZipArchive(const MemChunk& mc);
 	static bool isZipArchive(const string& filename);
 
 private:
-	string temp_file_;
+	string   temp_file_;
+	MemChunk zip_data_; // The zip data, if opened from a MemChunk (eg. an entry in another archive)
 
+	// Cached central directory of the zip file on disk, used to seek directly to entry data when loading
+	vector<unique_ptr<wxZipEntry>> zip_entries_;
+
+	// True if entry type detection was deferred when opening, so the entry type
+	// cache is written on close instead
+	bool types_deferred_ = false;
+
+	bool                      readZip(wxInputStream& in, string_view filename, bool lazy);
+	unique_ptr<wxInputStream> openZipData() const;
+	wxZipEntry*               openZipEntry(wxZipInputStream& zip, ArchiveEntry* entry);
 	void generateTempFileName(string_view filename);
+	void saveTypeCache();
 };
 } // namespace slade
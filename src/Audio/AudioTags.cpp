@@ -368,13 +368,13 @@ wxString buildID3v2GenreString(wxString content)
 	return genre;
 }
 
-wxString parseID3v1Tag(MemChunk& mc, size_t start)
+wxString parseID3v1Tag(const MemChunk& mc, size_t start)
 {
 	ID3v1    tag;
 	wxString version, title, artist, album, comment, genre, year;
 	int      track = 0;
 
-	mc.read(&tag, 128, start);
+	mc.read(start, &tag, 128);
 	title   = wxString::FromAscii(tag.title, 30);
 	artist  = wxString::FromAscii(tag.artist, 30);
 	album   = wxString::FromAscii(tag.album, 30);
@@ -396,7 +396,7 @@ wxString parseID3v1Tag(MemChunk& mc, size_t start)
 		ID3v1e etag;
 		version += '+';
 
-		mc.read(&etag, 227, start - 227);
+		mc.read(start - 227, &etag, 227);
 		title += wxString::FromAscii(etag.title, 60);
 		artist += wxString::FromAscii(etag.artist, 60);
 		album += wxString::FromAscii(etag.album, 60);
@@ -419,7 +419,7 @@ wxString parseID3v1Tag(MemChunk& mc, size_t start)
 	return ret;
 }
 
-wxString parseID3v2Tag(MemChunk& mc, size_t start)
+wxString parseID3v2Tag(const MemChunk& mc, size_t start)
 {
 	wxString version, title, artist, composer, copyright, album, genre, year, group, subtitle, track, comments;
 	bool     artists = false;
@@ -456,7 +456,7 @@ wxString parseID3v2Tag(MemChunk& mc, size_t start)
 
 			// First step: retrieve the text (UTF-16 massively sucks)
 			auto buffer = new char[fsize];
-			mc.read(buffer, tsize, s + step + 1);
+			mc.read(s + step + 1, buffer, tsize);
 			size_t frame = v22 ? mc.readB24(s) : mc.readB32(s);
 
 			bool   bomle = true;
@@ -614,7 +614,7 @@ wxString parseID3v2Tag(MemChunk& mc, size_t start)
 	return ret;
 }
 
-wxString parseVorbisComment(MemChunk& mc, size_t start)
+wxString parseVorbisComment(const MemChunk& mc, size_t start)
 {
 	sf::Clock timer;
 	wxString  ret;
@@ -647,7 +647,7 @@ wxString parseVorbisComment(MemChunk& mc, size_t start)
 	return ret;
 }
 
-wxString parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const WavChunk* cue, bool bigendian = false)
+wxString parseIFFChunks(const MemChunk& mc, size_t s, size_t samplerate, const WavChunk* cue, bool bigendian = false)
 {
 	const WavChunk* temp  = nullptr;
 	auto            data  = (const char*)mc.data();
@@ -922,7 +922,7 @@ wxString parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const WavChun
 //
 // -----------------------------------------------------------------------------
 
-wxString audio::getID3Tag(MemChunk& mc)
+wxString audio::getID3Tag(const MemChunk& mc)
 {
 	// We actually identify RIFF-WAVE files as MP3 if they are encoded with
 	// the MP3 codec, but that means the metadata format is different, so
@@ -988,7 +988,7 @@ wxString audio::getID3Tag(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getOggComments(MemChunk& mc)
+wxString audio::getOggComments(const MemChunk& mc)
 {
 	OggPageHeader ogg;
 	VorbisHeader  vorb;
@@ -998,7 +998,7 @@ wxString audio::getOggComments(MemChunk& mc)
 
 	while (pagestart + 28 < end)
 	{
-		mc.read(&ogg, 27, pagestart);
+		mc.read(pagestart, &ogg, 27);
 		size_t pagesize = 27;
 
 		for (int i = 0; i < ogg.segments && pagestart + 27 + i < end; ++i)
@@ -1014,7 +1014,7 @@ wxString audio::getOggComments(MemChunk& mc)
 					return ret;
 
 				// Look if we have a vorbis comment header in that segment
-				mc.read(&vorb, 7, datastart);
+				mc.read(datastart, &vorb, 7);
 				if (vorb.packettype == 3 && vorb.tag[0] == 'v' && vorb.tag[1] == 'o' && vorb.tag[2] == 'r'
 					&& vorb.tag[3] == 'b' && vorb.tag[4] == 'i' && vorb.tag[5] == 's')
 				{
@@ -1034,7 +1034,7 @@ wxString audio::getOggComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getFlacComments(MemChunk& mc)
+wxString audio::getFlacComments(const MemChunk& mc)
 {
 	wxString ret = "";
 	// FLAC files begin with identifier "fLaC"; skip them
@@ -1059,7 +1059,7 @@ wxString audio::getFlacComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getITComments(MemChunk& mc)
+wxString audio::getITComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	auto   head = (const ITHeader*)data;
@@ -1136,7 +1136,7 @@ wxString audio::getITComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getModComments(MemChunk& mc)
+wxString audio::getModComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	size_t s    = 20;
@@ -1162,7 +1162,7 @@ wxString audio::getModComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getS3MComments(MemChunk& mc)
+wxString audio::getS3MComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	auto   head = (const S3MHeader*)data;
@@ -1197,7 +1197,7 @@ wxString audio::getS3MComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getXMComments(MemChunk& mc)
+wxString audio::getXMComments(const MemChunk& mc)
 {
 	auto   data = (const char*)mc.data();
 	auto   head = (const XMHeader*)data;
@@ -1273,7 +1273,7 @@ wxString audio::getXMComments(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getSunInfo(MemChunk& mc)
+wxString audio::getSunInfo(const MemChunk& mc)
 {
 	size_t datasize   = mc.readB32(8);
 	size_t codec      = mc.readB32(12);
@@ -1310,7 +1310,7 @@ wxString audio::getSunInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getVocInfo(MemChunk& mc)
+wxString audio::getVocInfo(const MemChunk& mc)
 {
 	int         codec      = -1;
 	int         blockcount = 0;
@@ -1411,7 +1411,7 @@ wxString audio::getVocInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getWavInfo(MemChunk& mc)
+wxString audio::getWavInfo(const MemChunk& mc)
 {
 	auto               data  = (const char*)mc.data();
 	auto               udata = (const uint8_t*)data;
@@ -1528,7 +1528,7 @@ wxString audio::getWavInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getRmidInfo(MemChunk& mc)
+wxString audio::getRmidInfo(const MemChunk& mc)
 {
 	auto            data  = (const char*)mc.data();
 	auto            udata = (const uint8_t*)data;
@@ -1569,7 +1569,7 @@ wxString audio::getRmidInfo(MemChunk& mc)
 	return ret;
 }
 
-wxString audio::getAiffInfo(MemChunk& mc)
+wxString audio::getAiffInfo(const MemChunk& mc)
 {
 	auto            data  = (const char*)mc.data();
 	auto            udata = (const uint8_t*)data;
@@ -1659,7 +1659,7 @@ wxString audio::getAiffInfo(MemChunk& mc)
 // returns the index at which the true audio data begins.
 // Returns 0 if there is no tag before audio data.
 // -----------------------------------------------------------------------------
-size_t audio::checkForTags(MemChunk& mc)
+size_t audio::checkForTags(const MemChunk& mc)
 {
 	// Check for empty wasted space at the beginning, since it's apparently
 	// quite popular in MP3s to start with a useless blank frame.
@@ -33,7 +33,10 @@
 #include "Main.h"
 #include "MIDIPlayer.h"
 #include "App.h"
+#include "General/ThreadPool.h"
 #include "Utility/StringUtils.h"
+#include <condition_variable>
+#include <mutex>
 
 using namespace slade;
 using namespace audio;
@@ -53,6 +56,16 @@ namespace slade::audio
 {
 unique_ptr<MIDIPlayer> midi_player;
 }
+namespace
+{
+struct ParsedMIDI
+{
+	MemChunk data; // Shares the parsed data, to detect when different data is given
+	int      length = 0;
+	string   info;
+};
+ParsedMIDI parsed_midi;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -116,6 +129,7 @@ public:
 	// -------------------------------------------------------------------------
 	virtual ~FluidSynthMIDIPlayer()
 	{
+		waitForSoundfont();
 		FluidSynthMIDIPlayer::stop();
 		delete_fluid_audio_driver(fs_adriver_);
 		delete_fluid_player(fs_player_);
@@ -126,10 +140,17 @@ public:
 	// -------------------------------------------------------------------------
 	// Returns true if the MIDIPlayer has a soundfont loaded
 	// -------------------------------------------------------------------------
-	bool isSoundfontLoaded() override { return !fs_soundfont_ids_.empty(); }
+	bool isSoundfontLoaded() override
+	{
+		waitForSoundfont();
+		return !fs_soundfont_ids_.empty();
+	}
 
 	// -------------------------------------------------------------------------
-	// Reloads the current soundfont
+	// Reloads the current soundfont.
+	// The soundfont files are loaded on a worker thread, since large
+	// soundfonts can take a while to load - anything that needs the soundfont
+	// loaded (eg. playback) waits for it to finish
 	// -------------------------------------------------------------------------
 	bool reloadSoundfont() override
 	{
@@ -137,6 +158,8 @@ public:
 		if (!fs_initialised_)
 			return false;
 
+		waitForSoundfont();
+
 		char separator = app::platform() == app::Platform::Windows ? ';' : ':';
 
 		// Unload any current soundfont
@@ -147,22 +170,29 @@ public:
 			fs_soundfont_ids_.pop_back();
 		}
 
-		// Load soundfonts
-		auto paths  = strutil::split(fs_soundfont_path, separator);
-		bool retval = false;
-		for (int a = paths.size() - 1; a >= 0; --a)
-		{
-			auto path = paths[a];
-			if (!path.empty())
-			{
-				int fs_id = fluid_synth_sfload(fs_synth_, path.c_str(), 1);
-				fs_soundfont_ids_.push_back(fs_id);
-				if (fs_id != FLUID_FAILED)
-					retval = true;
-			}
-		}
+		// Check there are soundfonts to load
+		auto paths = strutil::split(fs_soundfont_path, separator);
+		if (std::all_of(paths.begin(), paths.end(), [](const string& path) { return path.empty(); }))
+			return false;
+
+		// Load soundfonts in the background
+		sf_loading_ = true;
+		threadpool::enqueue([this, paths]() {
+			vector<int> ids;
+			for (int a = paths.size() - 1; a >= 0; --a)
+				if (!paths[a].empty())
+					ids.push_back(fluid_synth_sfload(fs_synth_, paths[a].c_str(), 1));
+
+			if (std::all_of(ids.begin(), ids.end(), [](int id) { return id == FLUID_FAILED; }))
+				log::warning(1, "Unable to load FluidSynth soundfont, MIDI playback will not work");
+
+			std::lock_guard<std::mutex> lock(sf_mutex_);
+			fs_soundfont_ids_ = ids;
+			sf_loading_       = false;
+			sf_cv_.notify_all();
+		});
 
-		return retval;
+		return true;
 	}
 
 	// -------------------------------------------------------------------------
@@ -196,9 +226,9 @@ public:
 	// -------------------------------------------------------------------------
 	bool openData(MemChunk& mc) override
 	{
-		// Open midi
+		// Open midi (share the data rather than copying it)
 		mc.seek(0, SEEK_SET);
-		data_.importMem(mc.data(), mc.size());
+		data_.importMem(mc);
 
 		if (!fs_initialised_)
 			return false;
@@ -211,7 +241,8 @@ public:
 		if (fs_player_)
 		{
 			// fluid_player_set_loop(fs_player, -1);
-			fluid_player_add_mem(fs_player_, mc.data(), mc.size());
+			const auto& midi = data_;
+			fluid_player_add_mem(fs_player_, midi.data(), midi.size());
 			return true;
 		}
 
@@ -221,7 +252,15 @@ public:
 	// -------------------------------------------------------------------------
 	// Returns true if the MIDIPlayer is ready to play some MIDI
 	// -------------------------------------------------------------------------
-	bool isReady() override { return fs_initialised_ && !fs_soundfont_ids_.empty(); }
+	bool isReady() override
+	{
+		if (!fs_initialised_)
+			return false;
+
+		// Assume ready if the soundfont is still loading
+		std::lock_guard<std::mutex> lock(sf_mutex_);
+		return sf_loading_ || !fs_soundfont_ids_.empty();
+	}
 
 	// -------------------------------------------------------------------------
 	// Begins playback of the currently loaded MIDI stream.
@@ -230,11 +269,13 @@ public:
 	bool play() override
 	{
 		stop();
-		timer_.restart();
 
 		if (!fs_initialised_)
 			return false;
 
+		waitForSoundfont();
+		timer_.restart();
+
 		return (fluid_player_play(fs_player_) == FLUID_OK);
 	}
 
@@ -323,6 +364,19 @@ private:
 	bool        fs_initialised_ = false;
 	vector<int> fs_soundfont_ids_;
 
+	std::mutex              sf_mutex_;
+	std::condition_variable sf_cv_;
+	bool                    sf_loading_ = false; // True while the soundfont is being loaded on a worker thread
+
+	// -------------------------------------------------------------------------
+	// Waits for the soundfont to finish loading, if it is currently loading
+	// -------------------------------------------------------------------------
+	void waitForSoundfont()
+	{
+		std::unique_lock<std::mutex> lock(sf_mutex_);
+		sf_cv_.wait(lock, [this] { return !sf_loading_; });
+	}
+
 	// -------------------------------------------------------------------------
 	// Initialises fluidsynth
 	// -------------------------------------------------------------------------
@@ -401,7 +455,7 @@ public:
 	{
 		// Open midi
 		mc.seek(0, SEEK_SET);
-		data_.importMem(mc.data(), mc.size());
+		data_.importMem(mc);
 
 		file_ = app::path("slade-timidity.mid", app::Dir::Temp);
 		mc.exportFile(file_);
@@ -514,48 +568,30 @@ private:
 
 // -----------------------------------------------------------------------------
 //
-// audio Namespace Functions
+// Functions
 //
 // -----------------------------------------------------------------------------
-namespace slade::audio
+namespace
 {
 // -----------------------------------------------------------------------------
-// Returns the current MIDIPlayer instance.
-// Creates one if there is no current instance, depending on what is configured
-// (and available)
+// Reads a variable-length quantity from [data] at [pos], advancing [pos] past it
 // -----------------------------------------------------------------------------
-MIDIPlayer& midiPlayer()
+size_t readVarLen(const MemChunk& data, size_t& pos)
 {
-	if (!midi_player)
+	size_t value = 0;
+	for (int a = 0; a < 4; ++a)
 	{
-#ifndef NO_FLUIDSYNTH
-		if (strutil::equalCI(snd_midi_player, "fluidsynth"))
-			midi_player = std::make_unique<FluidSynthMIDIPlayer>();
-		else if (strutil::equalCI(snd_midi_player, "timidity"))
-			midi_player = std::make_unique<TimidityMIDIPlayer>();
-#else
-		if (strutil::equalCI(snd_midi_player, "timidity"))
-			midi_player = std::make_unique<TimidityMIDIPlayer>();
-#endif
-
-		if (!midi_player)
-			midi_player = std::make_unique<NullMIDIPlayer>();
+		value = (value << 7) + (data[pos] & 0x7F);
+		if ((data[pos++] & 0x80) != 0x80)
+			break;
 	}
-
-	return *midi_player;
+	return value;
 }
 
 // -----------------------------------------------------------------------------
-// Resets the current MIDIPlayer
-// -----------------------------------------------------------------------------
-void resetMIDIPlayer()
-{
-	if (midi_player)
-		midi_player.reset(nullptr);
-}
-
-// -----------------------------------------------------------------------------
-// Returns the length (or maximum position) of the MIDI [data], in milliseconds.
+// Parses the MIDI [data] to find its length (see below) and text events, in a
+// single pass. The result for the most recently parsed data is kept, so the
+// info display and seek bar setup don't each parse the same MIDI again.
 //
 // MIDI time division is the number of pulses per quarter note, aka PPQN, or
 // clock tick per beat; but it doesn't tell us how long a beat or a tick lasts.
@@ -570,9 +606,26 @@ void resetMIDIPlayer()
 // can squeeze or stretch notes to fit a set PPQN, so ticks per microseconds
 // will generally be more accurate.
 // 60000000 / tempo = BPM
+//
+// MIDI text events include:
+// Text event (FF 01)
+// Copyright notice (FF 02)
+// Track title (FF 03)
+// Instrument name (FF 04)
+// Lyrics (FF 05)
+// Marker (FF 06)
+// Cue point (FF 07)
 // -----------------------------------------------------------------------------
-int midiLength(const MemChunk& data)
+const ParsedMIDI& parseMidi(const MemChunk& data)
 {
+	if (parsed_midi.data.sharesData(data) && parsed_midi.data.size() == data.size())
+		return parsed_midi;
+
+	parsed_midi.data.importMem(data);
+	parsed_midi.length = 0;
+	parsed_midi.info.clear();
+
+	auto&    info          = parsed_midi.info;
 	size_t   microseconds  = 0;
 	size_t   pos           = 0;
 	size_t   end           = data.size();
@@ -582,6 +635,7 @@ int midiLength(const MemChunk& data)
 	uint16_t time_div      = 0;
 	int      tempo         = 500000; // Default value to assume if there are no tempo change event
 	bool     smpte         = false;
+	bool     timed         = true; // False if the time division is invalid (no length)
 
 	while (pos + 8 < end)
 	{
@@ -595,33 +649,37 @@ int midiLength(const MemChunk& data)
 			format     = data.readB16(pos);
 			num_tracks = data.readB16(pos + 2);
 			time_div   = data.readB16(pos + 4);
+			if (format == 0)
+				info += fmt::format("MIDI format 0 with time division {}\n", time_div);
+			else
+				info += fmt::format(
+					"MIDI format {} with {} tracks and time division {}\n", format, num_tracks, time_div);
+
 			if (data[pos + 4] & 0x80)
 			{
 				smpte    = true;
 				time_div = (256 - data[pos + 4]) * data[pos + 5];
 			}
 			if (time_div == 0) // Not a valid MIDI file
-				return 0;
+				timed = false;
 		}
 		else if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('r' << 8) | 'k')) // MTrk
 		{
+			if (format == 2)
+				info += fmt::format("\nTrack {}/{}\n", ++track_counter, num_tracks);
 			size_t tpos        = pos;
 			size_t tracklength = 0;
 			while (tpos + 4 < chunk_end)
 			{
-				// Read delta time
-				size_t dtime = 0;
-				for (int a = 0; a < 4; ++a)
+				// Read delta time, compute length in microseconds
+				size_t dtime = readVarLen(data, tpos);
+				if (timed)
 				{
-					dtime = (dtime << 7) + (data[tpos] & 0x7F);
-					if ((data[tpos++] & 0x80) != 0x80)
-						break;
+					if (smpte)
+						tracklength += dtime * time_div;
+					else
+						tracklength += dtime * tempo / time_div;
 				}
-				// Compute length in microseconds
-				if (smpte)
-					tracklength += dtime * time_div;
-				else
-					tracklength += dtime * tempo / time_div;
 
 				// Update status
 				uint8_t evtype = 0;
@@ -640,18 +698,27 @@ int midiLength(const MemChunk& data)
 				// Handle meta events
 				if (status == 0xFF)
 				{
-					evsize = 0;
-					for (int a = 0; a < 4; ++a)
-					{
-						evsize = (evsize << 7) + (data[tpos] & 0x7F);
-						if ((data[tpos++] & 0x80) != 0x80)
-							break;
-					}
+					evsize = readVarLen(data, tpos);
 
 					// Tempo event is important
 					if (evtype == 0x51)
 						tempo = data.readB24(tpos);
 
+					string tmp;
+					if (evtype > 0 && evtype < 8 && evsize)
+						tmp.append((const char*)(&data[tpos]), evsize);
+
+					switch (evtype)
+					{
+					case 1: info += fmt::format("Text: {}\n", tmp); break;
+					case 2: info += fmt::format("Copyright: {}\n", tmp); break;
+					case 3: info += fmt::format("Title: {}\n", tmp); break;
+					case 4: info += fmt::format("Instrument: {}\n", tmp); break;
+					case 5: info += fmt::format("Lyrics: {}\n", tmp); break;
+					case 6: info += fmt::format("Marker: {}\n", tmp); break;
+					case 7: info += fmt::format("Cue point: {}\n", tmp); break;
+					default: break;
+					}
 					tpos += evsize;
 				}
 				// Handle other events. Program change and channel aftertouch
@@ -664,13 +731,7 @@ int midiLength(const MemChunk& data)
 					case 0xD0: // Channel Aftertouch
 						break;
 					case 0xF0: // Sysex events
-						evsize = 0;
-						for (int a = 0; a < 4; ++a)
-						{
-							evsize = (evsize << 7) + (data[tpos] & 0x7F);
-							if ((data[tpos++] & 0x80) != 0x80)
-								break;
-						}
+						evsize = readVarLen(data, tpos);
 						tpos += evsize;
 						break;
 					default: tpos++; // Skip next parameter
@@ -683,127 +744,71 @@ int midiLength(const MemChunk& data)
 		}
 		pos = chunk_end;
 	}
+
 	// MIDI durations are in microseconds
-	return (int)(microseconds / 1000);
+	parsed_midi.length = timed ? (int)(microseconds / 1000) : 0;
+
+	return parsed_midi;
 }
+} // namespace
+
 
 // -----------------------------------------------------------------------------
-// Parses the MIDI [data] to find text events, and return a string where they
-// are each on a separate line. MIDI text events include:
-// Text event (FF 01)
-// Copyright notice (FF 02)
-// Track title (FF 03)
-// Instrument name (FF 04)
-// Lyrics (FF 05)
-// Marker (FF 06)
-// Cue point (FF 07)
+//
+// audio Namespace Functions
+//
 // -----------------------------------------------------------------------------
-string midiInfo(const MemChunk& data)
+namespace slade::audio
 {
-	string   ret;
-	size_t   pos           = 0;
-	size_t   end           = data.size();
-	size_t   track_counter = 0;
-	uint16_t num_tracks    = 0;
-	uint16_t format        = 0;
-
-	while (pos + 8 < end)
+// -----------------------------------------------------------------------------
+// Returns the current MIDIPlayer instance.
+// Creates one if there is no current instance, depending on what is configured
+// (and available)
+// -----------------------------------------------------------------------------
+MIDIPlayer& midiPlayer()
+{
+	if (!midi_player)
 	{
-		size_t chunk_name = data.readB32(pos);
-		size_t chunk_size = data.readB32(pos + 4);
-		pos += 8;
-		size_t  chunk_end      = pos + chunk_size;
-		uint8_t running_status = 0;
-		if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('h' << 8) | 'd')) // MThd
-		{
-			format            = data.readB16(pos);
-			num_tracks        = data.readB16(pos + 2);
-			uint16_t time_div = data.readB16(pos + 4);
-			if (format == 0)
-				ret += fmt::format("MIDI format 0 with time division {}\n", time_div);
-			else
-				ret += fmt::format(
-					"MIDI format {} with {} tracks and time division {}\n", format, num_tracks, time_div);
-		}
-		else if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('r' << 8) | 'k')) // MTrk
-		{
-			if (format == 2)
-				ret += fmt::format("\nTrack {}/{}\n", ++track_counter, num_tracks);
-			size_t tpos = pos;
-			while (tpos + 4 < chunk_end)
-			{
-				// Skip past delta time
-				for (int a = 0; a < 4; ++a)
-					if ((data[tpos++] & 0x80) != 0x80)
-						break;
+#ifndef NO_FLUIDSYNTH
+		if (strutil::equalCI(snd_midi_player, "fluidsynth"))
+			midi_player = std::make_unique<FluidSynthMIDIPlayer>();
+		else if (strutil::equalCI(snd_midi_player, "timidity"))
+			midi_player = std::make_unique<TimidityMIDIPlayer>();
+#else
+		if (strutil::equalCI(snd_midi_player, "timidity"))
+			midi_player = std::make_unique<TimidityMIDIPlayer>();
+#endif
 
-				// Update status
-				uint8_t evtype = 0;
-				uint8_t status = data[tpos++];
-				size_t  evsize = 0;
-				if (status < 0x80)
-				{
-					evtype = status;
-					status = running_status;
-				}
-				else
-				{
-					running_status = status;
-					evtype         = data[tpos++];
-				}
-				// Handle meta events
-				if (status == 0xFF)
-				{
-					evsize = 0;
-					for (int a = 0; a < 4; ++a)
-					{
-						evsize = (evsize << 7) + (data[tpos] & 0x7F);
-						if ((data[tpos++] & 0x80) != 0x80)
-							break;
-					}
+		if (!midi_player)
+			midi_player = std::make_unique<NullMIDIPlayer>();
+	}
 
-					string tmp;
-					if (evtype > 0 && evtype < 8 && evsize)
-						tmp.append((const char*)(&data[tpos]), evsize);
+	return *midi_player;
+}
 
-					switch (evtype)
-					{
-					case 1: ret += fmt::format("Text: {}\n", tmp); break;
-					case 2: ret += fmt::format("Copyright: {}\n", tmp); break;
-					case 3: ret += fmt::format("Title: {}\n", tmp); break;
-					case 4: ret += fmt::format("Instrument: {}\n", tmp); break;
-					case 5: ret += fmt::format("Lyrics: {}\n", tmp); break;
-					case 6: ret += fmt::format("Marker: {}\n", tmp); break;
-					case 7: ret += fmt::format("Cue point: {}\n", tmp); break;
-					default: break;
-					}
-					tpos += evsize;
-				}
-				// Handle other events. Program change and channel aftertouch
-				// have only one parameter, other non-meta events have two.
-				// Sysex events have variable length
-				else
-					switch (status & 0xF0)
-					{
-					case 0xC0: // Program Change
-					case 0xD0: // Channel Aftertouch
-						break;
-					case 0xF0: // Sysex events
-						evsize = 0;
-						for (int a = 0; a < 4; ++a)
-						{
-							evsize = (evsize << 7) + (data[tpos] & 0x7F);
-							if ((data[tpos++] & 0x80) != 0x80)
-								break;
-						}
-						tpos += evsize;
-						break;
-					default: tpos++; // Skip next parameter
-					}
-			}
-		}
-		pos = chunk_end;
-	}
-	return ret;
+// -----------------------------------------------------------------------------
+// Resets the current MIDIPlayer
+// -----------------------------------------------------------------------------
+void resetMIDIPlayer()
+{
+	if (midi_player)
+		midi_player.reset(nullptr);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the length (or maximum position) of the MIDI [data], in milliseconds
+// -----------------------------------------------------------------------------
+int midiLength(const MemChunk& data)
+{
+	return parseMidi(data).length;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a string with the text events of the MIDI [data], each on a separate
+// line (see parseMidi)
+// -----------------------------------------------------------------------------
+string midiInfo(const MemChunk& data)
+{
+	return parseMidi(data).info;
 }
 } // namespace slade::audio
@@ -10,7 +10,7 @@ namespace slade::audio
 {
 struct Mp3MemoryData
 {
-	void*  data;
+	const void* data;
 	size_t size;
 	off_t  offset;
 };
@@ -27,14 +27,14 @@ ssize_t memoryDataRead(void* raw_mp3_data, void* buffer, size_t nbyte)
 	{
 		size_t read_size    = mp3_data->size - mp3_data->offset;
 		size_t mem_set_size = mp3_data->offset + nbyte - (ssize_t)mp3_data->size;
-		memcpy(buffer, (unsigned char*)mp3_data->data + mp3_data->offset, read_size);
+		memcpy(buffer, (const unsigned char*)mp3_data->data + mp3_data->offset, read_size);
 		memset(buffer, 0, mem_set_size);
 		mp3_data->offset += read_size;
 		return (ssize_t)read_size;
 	}
 	else
 	{
-		memcpy(buffer, (unsigned char*)mp3_data->data + mp3_data->offset, nbyte);
+		memcpy(buffer, (const unsigned char*)mp3_data->data + mp3_data->offset, nbyte);
 		mp3_data->offset += nbyte;
 		return (ssize_t)nbyte;
 	}
@@ -135,7 +135,7 @@ bool Mp3Music::openFromFile(const std::string& filename)
 	return true;
 }
 
-bool Mp3Music::loadFromMemory(void* data, size_t size_in_bytes)
+bool Mp3Music::loadFromMemory(const void* data, size_t size_in_bytes)
 {
 	stop();
 
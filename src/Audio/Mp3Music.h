@@ -12,7 +12,7 @@ public:
 	~Mp3Music();
 
 	bool     openFromFile(const std::string& filename);
-	bool     loadFromMemory(void* data, size_t size_in_bytes);
+	bool     loadFromMemory(const void* data, size_t size_in_bytes);
 	sf::Time duration() const;
 
 protected:
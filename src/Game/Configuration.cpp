@@ -56,6 +56,18 @@ using namespace game;
 EXTERN_CVAR(String, game_configuration)
 EXTERN_CVAR(String, port_configuration)
 CVAR(Bool, debug_configuration, false, CVar::Flag::Save)
+CVAR(Int, game_config_cache_size, 4, CVar::Flag::Save) // Number of recently read configurations to keep in memory
+namespace
+{
+struct CachedConfig
+{
+	size_t                    hash;
+	size_t                    length;
+	MapFormat                 format;
+	unique_ptr<Configuration> config;
+};
+vector<CachedConfig> config_cache; // Most recently used first
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -163,7 +175,7 @@ void Configuration::readActionSpecials(ParseTreeNode* node, Arg::SpecialMap& sha
 		{
 			// Add current node name to group path
 			groupname = fmt::format("{}/{}", group->name(), groupname);
-			group     = dynamic_cast<ParseTreeNode*>(group->parent());
+			group     = static_cast<ParseTreeNode*>(group->parent());
 		}
 	}
 	strutil::removeSuffixIP(groupname, '/');
@@ -228,7 +240,7 @@ void Configuration::readThingTypes(ParseTreeNode* node, const ThingType& group_d
 		{
 			// Add current node name to group path
 			groupname = fmt::format("{}/{}", group->name(), groupname);
-			group     = dynamic_cast<ParseTreeNode*>(group->parent());
+			group     = static_cast<ParseTreeNode*>(group->parent());
 		}
 	}
 	strutil::removeSuffixIP(groupname, '/');
@@ -298,6 +310,10 @@ void Configuration::readUDMFProperties(ParseTreeNode* block, UDMFPropMap& plist)
 
 				if (strutil::equalCI(def->type(), "property"))
 				{
+					// Intern the property name, so map object property keys
+					// use the same spelling as the configuration
+					PropertyKey::intern(def->name());
+
 					// Parse group defaults
 					plist[def->name()].parse(group, groupname);
 
@@ -536,6 +552,7 @@ bool Configuration::readConfiguration(
 		udmf_sector_props_.clear();
 		udmf_thing_props_.clear();
 		tt_group_defaults_.clear();
+		updateLookups();
 	}
 
 	// Parse the full configuration
@@ -858,6 +875,9 @@ bool Configuration::readConfiguration(
 			log::warning("Unexpected game configuration section \"{}\", skipping", node->name());
 	}
 
+	updateLookups();
+	read_time_ = app::runTimer();
+
 	return true;
 }
 
@@ -936,15 +956,49 @@ bool Configuration::openConfig(const string& game, const string& port, MapFormat
 		test.Close();
 	}
 
+	// Check for a previously read copy of the same configuration
+	auto hash   = std::hash<string>{}(full_config);
+	auto cached = std::find_if(
+		config_cache.begin(),
+		config_cache.end(),
+		[&](const CachedConfig& c) { return c.hash == hash && c.length == full_config.size() && c.format == format; });
+
 	// Read fully built configuration
 	bool ok = true;
-	if (readConfiguration(full_config, "full.cfg", format))
+	if (cached != config_cache.end())
+	{
+		// Restore cached configuration (keeping parsed DECORATE/ZScript/MAPINFO definitions)
+		auto parsed_types = std::move(parsed_types_);
+		auto map_info     = std::move(map_info_);
+		*this             = *cached->config;
+		parsed_types_     = std::move(parsed_types);
+		map_info_         = std::move(map_info);
+		std::rotate(config_cache.begin(), cached, cached + 1);
+
+		current_game_      = game;
+		current_port_      = port;
+		game_configuration = game;
+		port_configuration = port;
+		log::info(2, R"(Restored cached game configuration "{}" + "{}")", current_game_, current_port_);
+	}
+	else if (readConfiguration(full_config, "full.cfg", format))
 	{
 		current_game_      = game;
 		current_port_      = port;
 		game_configuration = game;
 		port_configuration = port;
 		log::info(2, R"(Read game configuration "{}" + "{}")", current_game_, current_port_);
+
+		// Cache the resolved configuration, before any embedded configurations are applied
+		if (game_config_cache_size > 0)
+		{
+			auto copy = std::make_unique<Configuration>(*this);
+			copy->parsed_types_.clear();
+			copy->map_info_.clear();
+			config_cache.insert(config_cache.begin(), { hash, full_config.size(), format, std::move(copy) });
+			if (config_cache.size() > static_cast<size_t>(game_config_cache_size))
+				config_cache.resize(game_config_cache_size);
+		}
 	}
 	else
 	{
@@ -975,16 +1029,14 @@ bool Configuration::openConfig(const string& game, const string& port, MapFormat
 // -----------------------------------------------------------------------------
 // Returns the action special definition for [id]
 // -----------------------------------------------------------------------------
-const ActionSpecial& Configuration::actionSpecial(unsigned id)
+const ActionSpecial& Configuration::actionSpecial(unsigned id) const
 {
-	auto& as = action_specials_[id];
-
 	// Defined Action Special
-	if (as.defined())
-		return as;
+	if (auto as = action_special_lookup_.find(id))
+		return *as;
 
 	// Boom Generalised Special
-	if (supported_features_[Feature::Boom] && id >= 0x2f80)
+	if (featureSupported(Feature::Boom) && id >= 0x2f80)
 	{
 		if ((id & 7) >= 6)
 			return ActionSpecial::generalManual();
@@ -999,7 +1051,7 @@ const ActionSpecial& Configuration::actionSpecial(unsigned id)
 // -----------------------------------------------------------------------------
 // Returns the action special name for [special], if any
 // -----------------------------------------------------------------------------
-string Configuration::actionSpecialName(int special)
+string Configuration::actionSpecialName(int special) const
 {
 	// Check special id is valid
 	if (special < 0)
@@ -1007,9 +1059,9 @@ string Configuration::actionSpecialName(int special)
 	else if (special == 0)
 		return "None";
 
-	if (action_specials_[special].defined())
-		return action_specials_[special].name();
-	else if (special >= 0x2F80 && supported_features_[Feature::Boom])
+	if (auto as = action_special_lookup_.find(special))
+		return as->name();
+	else if (special >= 0x2F80 && featureSupported(Feature::Boom))
 		return genlinespecial::parseLineType(special);
 	else
 		return "Unknown";
@@ -1018,13 +1070,10 @@ string Configuration::actionSpecialName(int special)
 // -----------------------------------------------------------------------------
 // Returns the thing type definition for [type]
 // -----------------------------------------------------------------------------
-const ThingType& Configuration::thingType(unsigned type)
+const ThingType& Configuration::thingType(unsigned type) const
 {
-	auto& ttype = thing_types_[type];
-	if (ttype.defined())
-		return ttype;
-	else
-		return ThingType::unknown();
+	auto ttype = thing_type_lookup_.find(type);
+	return ttype ? *ttype : ThingType::unknown();
 }
 
 // -----------------------------------------------------------------------------
@@ -1119,7 +1168,7 @@ bool Configuration::thingBasicFlagSet(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			return thing->flagSet(512);
 		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 			return !thing->flagSet(64);
 		else
 			return true;
@@ -1130,7 +1179,7 @@ bool Configuration::thingBasicFlagSet(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			return thing->flagSet(1024);
 		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 			return !thing->flagSet(32);
 		else
 			return true;
@@ -1282,7 +1331,7 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			flag_val = 512;
 		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 		{
 			flag_val = 64;
 			set      = !set;
@@ -1297,7 +1346,7 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			flag_val = 1024;
 		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 		{
 			flag_val = 32;
 			set      = !set;
@@ -1346,7 +1395,9 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 // -----------------------------------------------------------------------------
 bool Configuration::parseDecorateDefs(Archive* archive)
 {
-	return readDecorateDefs(archive, thing_types_, parsed_types_);
+	bool ok = readDecorateDefs(archive, thing_types_, parsed_types_);
+	updateLookups();
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -1357,6 +1408,8 @@ void Configuration::clearDecorateDefs()
 	for (auto def : thing_types_)
 		if (def.second.decorate() && def.second.defined())
 			def.second.define(-1, "", "");
+
+	updateLookups();
 }
 
 // -----------------------------------------------------------------------------
@@ -1367,6 +1420,7 @@ void Configuration::clearDecorateDefs()
 void Configuration::importZScriptDefs(zscript::Definitions& defs)
 {
 	defs.exportThingTypes(thing_types_, parsed_types_);
+	updateLookups();
 }
 
 // -----------------------------------------------------------------------------
@@ -1396,6 +1450,8 @@ void Configuration::linkDoomEdNums()
 			log::info(2, "Linked parsed class {} to DoomEdNum %d", parsed.className(), ednum);
 		}
 	}
+
+	updateLookups();
 }
 
 // -----------------------------------------------------------------------------
@@ -1739,18 +1795,22 @@ UDMFProperty* Configuration::getUDMFProperty(const string& name, MapObject::Type
 {
 	using Type = MapObject::Type;
 
+	UDMFPropMap* props;
 	if (type == Type::Vertex)
-		return &udmf_vertex_props_[name];
+		props = &udmf_vertex_props_;
 	else if (type == Type::Line)
-		return &udmf_linedef_props_[name];
+		props = &udmf_linedef_props_;
 	else if (type == Type::Side)
-		return &udmf_sidedef_props_[name];
+		props = &udmf_sidedef_props_;
 	else if (type == Type::Sector)
-		return &udmf_sector_props_[name];
+		props = &udmf_sector_props_;
 	else if (type == Type::Thing)
-		return &udmf_thing_props_[name];
+		props = &udmf_thing_props_;
 	else
 		return nullptr;
+
+	auto prop = props->find(name);
+	return prop != props->end() ? &prop->second : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -1834,7 +1894,7 @@ void Configuration::cleanObjectUDMFProps(MapObject* object)
 // Returns the name for sector type value [type], taking generalised types into
 // account
 // -----------------------------------------------------------------------------
-string Configuration::sectorTypeName(int type)
+string Configuration::sectorTypeName(int type) const
 {
 	// Check for zero type
 	if (type == 0)
@@ -1881,7 +1941,8 @@ string Configuration::sectorTypeName(int type)
 	}
 
 	// Get base type name
-	auto name = sector_types_[type];
+	auto   base = sector_type_lookup_.find(type);
+	string name = base ? *base : "";
 	if (name.empty())
 		name = "Unknown";
 
@@ -2220,6 +2281,17 @@ int Configuration::downLightLevel(int light_level)
 	return 0;
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the number lookups for defined action specials, thing types and
+// sector types. Must be called whenever their definitions change
+// -----------------------------------------------------------------------------
+void Configuration::updateLookups()
+{
+	action_special_lookup_.build(action_specials_, [](const ActionSpecial& as) { return as.defined(); });
+	thing_type_lookup_.build(thing_types_, [](const ThingType& tt) { return tt.defined(); });
+	sector_type_lookup_.build(sector_types_, [](const string&) { return true; });
+}
+
 // -----------------------------------------------------------------------------
 // Dumps all defined action specials to the log
 // -----------------------------------------------------------------------------
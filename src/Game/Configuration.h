@@ -83,6 +83,7 @@ namespace game
 		const string& skyFlat() const { return sky_flat_; }
 		const string& scriptLanguage() const { return script_language_; }
 		int           lightLevelInterval();
+		long          readTime() const { return read_time_; }
 
 		unsigned      nMapNames() const { return maps_.size(); }
 		const string& mapName(unsigned index);
@@ -94,8 +95,16 @@ namespace game
 		const std::map<int, string>&        allSectorTypes() const { return sector_types_; }
 
 		// Feature Support
-		bool featureSupported(Feature feature) { return supported_features_[feature]; }
-		bool featureSupported(UDMFFeature feature) { return udmf_features_[feature]; }
+		bool featureSupported(Feature feature) const
+		{
+			auto i = supported_features_.find(feature);
+			return i != supported_features_.end() && i->second;
+		}
+		bool featureSupported(UDMFFeature feature) const
+		{
+			auto i = udmf_features_.find(feature);
+			return i != udmf_features_.end() && i->second;
+		}
 
 		// Configuration reading
 		void readActionSpecials(
@@ -114,11 +123,11 @@ namespace game
 		bool openConfig(const string& game, const string& port = "", MapFormat format = MapFormat::Unknown);
 
 		// Action specials
-		const ActionSpecial& actionSpecial(unsigned id);
-		string               actionSpecialName(int special);
+		const ActionSpecial& actionSpecial(unsigned id) const;
+		string               actionSpecialName(int special) const;
 
 		// Thing types
-		const ThingType& thingType(unsigned type);
+		const ThingType& thingType(unsigned type) const;
 		const ThingType& thingTypeGroupDefaults(const string& group);
 
 		// Thing flags
@@ -168,7 +177,7 @@ namespace game
 		void          cleanObjectUDMFProps(MapObject* object);
 
 		// Sector types
-		string sectorTypeName(int type);
+		string sectorTypeName(int type) const;
 		int    sectorTypeByName(string_view name);
 		int    baseSectorType(int type) const;
 		int    sectorBoomDamage(int type) const;
@@ -205,14 +214,59 @@ namespace game
 		string                    udmf_namespace_;         // Namespace to use for UDMF
 		int                       boom_sector_flag_start_; // Beginning of Boom sector flags
 		string                    sky_flat_;               // Sky flat for 3d mode
+		long                      read_time_ = 0;          // Time the configuration was last read
 		string                    script_language_;        // Scripting language (should be extended to allow multiple)
 		vector<int>               light_levels_;           // Light levels for up/down light in editor
 
+		// Read-only lookup of definitions by number, built from the definition
+		// maps below whenever they change (see updateLookups). Numbers in the
+		// common range are indexed directly, any others are hashed
+		template<typename T> class NumberLookup
+		{
+		public:
+			static constexpr int DENSE_LIMIT = 32768;
+
+			const T* find(int number) const
+			{
+				if (number >= 0 && number < static_cast<int>(dense_.size()))
+					return dense_[number];
+
+				auto i = sparse_.find(number);
+				return i != sparse_.end() ? i->second : nullptr;
+			}
+
+			template<typename F> void build(const std::map<int, T>& defs, F include)
+			{
+				dense_.clear();
+				sparse_.clear();
+				for (const auto& [number, def] : defs)
+				{
+					if (!include(def))
+						continue;
+
+					if (number >= 0 && number < DENSE_LIMIT)
+					{
+						if (number >= static_cast<int>(dense_.size()))
+							dense_.resize(number + 1, nullptr);
+						dense_[number] = &def;
+					}
+					else
+						sparse_[number] = &def;
+				}
+			}
+
+		private:
+			vector<const T*>                  dense_;
+			std::unordered_map<int, const T*> sparse_;
+		};
+
 		// Action specials
 		std::map<int, ActionSpecial> action_specials_;
+		NumberLookup<ActionSpecial>  action_special_lookup_;
 
 		// Thing types
 		std::map<int, ThingType>    thing_types_;
+		NumberLookup<ThingType>     thing_type_lookup_;
 		std::map<string, ThingType> tt_group_defaults_;
 		vector<ThingType>           parsed_types_;
 		// std::map<string, ThingType> parsed_types_;		// ThingTypes parsed from definitions
@@ -225,6 +279,7 @@ namespace game
 
 		// Sector types
 		std::map<int, string> sector_types_;
+		NumberLookup<string>  sector_type_lookup_;
 
 		// Map info
 		vector<MapConf> maps_;
@@ -253,6 +308,8 @@ namespace game
 
 		// Special Presets
 		vector<SpecialPreset> special_presets_;
+
+		void updateLookups();
 	};
 } // namespace game
 } // namespace slade
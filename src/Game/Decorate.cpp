@@ -37,6 +37,7 @@
 #include "ThingType.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <unordered_map>
 
 using namespace slade;
 using namespace game;
@@ -50,7 +51,31 @@ using namespace game;
 namespace
 {
 EntryType* etype_decorate = nullptr;
-}
+
+// A thing definition parsed from DECORATE. Definitions are added to the thing
+// types list separately from parsing, so the parsed definitions can be cached
+struct DecorateDef
+{
+	bool           actor = true; // False if an old-style (non-actor) definition
+	string         name;
+	string         class_name;
+	string         parent;
+	string         group;
+	int            ednum = -1;
+	vector<string> game_filters;
+	PropertyList   props;
+};
+
+// Parsed definitions of previously parsed DECORATE entries (including any
+// #included entries), so unchanged entries don't need to be parsed again
+struct CachedDefs
+{
+	weak_ptr<ArchiveEntry>                              entry;
+	vector<std::pair<weak_ptr<ArchiveEntry>, MemChunk>> sources; // Shares each parsed entry's data
+	vector<DecorateDef>                                 defs;
+};
+std::unordered_map<ArchiveEntry*, CachedDefs> parsed_cache;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -238,17 +263,19 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 // -----------------------------------------------------------------------------
 // Parses a DECORATE 'actor' definition
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, vector<DecorateDef>& defs)
 {
+	auto& def = defs.emplace_back();
+
 	// Get actor name
-	auto   name       = tz.next().text;
-	auto   actor_name = name;
-	string parent;
+	def.class_name = tz.next().text;
+	auto& name     = def.name;
+	name           = def.class_name;
 
 	// Check for inheritance
 	// string next = tz.peekToken();
 	if (tz.advIfNext(":"))
-		parent = tz.next().text;
+		def.parent = tz.next().text;
 
 	// Check for replaces
 	if (tz.checkNextNC("replaces"))
@@ -259,18 +286,14 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 		tz.adv();
 
 	// Check for no editor number (ie can't be placed in the map)
-	int ednum;
-	if (!tz.peek().isInteger())
-		ednum = -1;
-	else
+	auto& ednum = def.ednum;
+	if (tz.peek().isInteger())
 		tz.next().toInt(ednum);
 
-	PropertyList found_props;
-	bool         available       = false;
-	bool         filters_present = false;
-	bool         sprite_given    = false;
-	bool         title_given     = false;
-	string       group;
+	auto& found_props  = def.props;
+	auto& group        = def.group;
+	bool  sprite_given = false;
+	bool  title_given  = false;
 
 	// Skip "native" keyword if present
 	tz.advIfNextNC("native");
@@ -297,11 +320,7 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			// Game filter
 			else if (tz.checkNC("game"))
-			{
-				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
-					available = true;
-			}
+				def.game_filters.push_back(tz.next().text);
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
@@ -425,62 +444,80 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 	}
 	else
 		log::warning("Warning: Invalid actor definition for {}", name);
+}
 
-	// Ignore actors filtered for other games,
-	// and actors with a negative or null type
-	if (available || !filters_present)
+// -----------------------------------------------------------------------------
+// Adds/updates the thing type for parsed DECORATE actor [def] in [types] (or
+// [parsed] if it has no editor number)
+// -----------------------------------------------------------------------------
+void addActorDef(const DecorateDef& def, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	// Ignore actors filtered for other games
+	if (!def.game_filters.empty())
 	{
-		auto group_path = group.empty() ? "Decorate" : "Decorate/" + group;
+		auto& game_def  = gameDef(configuration().currentGame());
+		bool  available = false;
+		for (const auto& filter : def.game_filters)
+			if (game_def.supportsFilter(filter))
+			{
+				available = true;
+				break;
+			}
 
-		// Find existing definition or create it
-		ThingType* def = nullptr;
-		if (ednum <= 0)
-		{
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), actor_name))
-				{
-					def = &ptype;
-					break;
-				}
+		if (!available)
+			return;
+	}
+
+	auto group_path = def.group.empty() ? "Decorate" : "Decorate/" + def.group;
 
-			if (!def)
+	// Find existing definition or create it
+	ThingType* type = nullptr;
+	if (def.ednum <= 0)
+	{
+		for (auto& ptype : parsed)
+			if (strutil::equalCI(ptype.className(), def.class_name))
 			{
-				parsed.emplace_back(name, group_path, actor_name);
-				def = &parsed.back();
+				type = &ptype;
+				break;
 			}
-		}
-		else
-			def = &types[ednum];
 
-		// Add/update definition
-		def->define(ednum, name, group_path);
-
-		// Set group defaults (if any)
-		if (!group.empty())
+		if (!type)
 		{
-			auto& group_defaults = configuration().thingTypeGroupDefaults(group);
-			if (!group_defaults.group().empty())
-				def->copy(group_defaults);
+			parsed.emplace_back(def.name, group_path, def.class_name);
+			type = &parsed.back();
 		}
+	}
+	else
+		type = &types[def.ednum];
 
-		// Inherit from parent
-		if (!parent.empty())
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), parent))
-				{
-					def->copy(ptype);
-					break;
-				}
+	// Add/update definition
+	type->define(def.ednum, def.name, group_path);
 
-		// Set parsed properties
-		def->loadProps(found_props);
+	// Set group defaults (if any)
+	if (!def.group.empty())
+	{
+		auto& group_defaults = configuration().thingTypeGroupDefaults(def.group);
+		if (!group_defaults.group().empty())
+			type->copy(group_defaults);
 	}
+
+	// Inherit from parent
+	if (!def.parent.empty())
+		for (auto& ptype : parsed)
+			if (strutil::equalCI(ptype.className(), def.parent))
+			{
+				type->copy(ptype);
+				break;
+			}
+
+	// Set parsed properties
+	type->loadProps(def.props);
 }
 
 // -----------------------------------------------------------------------------
 // Parses an old-style (non-actor) DECORATE definition
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, vector<DecorateDef>& defs)
 {
 	string       name, sprite, group;
 	bool         spritefound = false;
@@ -556,11 +593,13 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 		if (spritefound && framefound)
 			found_props["sprite"] = sprite + frame + '?';
 
-		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
-
-		// Set parsed properties
-		types[type].loadProps(found_props);
+		// Add definition
+		auto& def = defs.emplace_back();
+		def.actor = false;
+		def.name  = name;
+		def.group = group;
+		def.ednum = type;
+		def.props = found_props;
 
 		log::info(3, "Parsed {} {}: {}", group.length() ? group : "decoration", name, type);
 	}
@@ -569,15 +608,27 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Adds/updates the thing type for parsed old-style DECORATE [def] in [types]
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void addOldDef(const DecorateDef& def, std::map<int, ThingType>& types)
+{
+	types[def.ednum].define(def.ednum, def.name, def.group.empty() ? "Decorate" : "Decorate/" + def.group);
+	types[def.ednum].loadProps(def.props);
+}
+
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions in [entry] (and any entries it
+// #includes) into [defs]. [sources] will contain all entries that were parsed,
+// or null if an #include couldn't be resolved
+// -----------------------------------------------------------------------------
+void parseDecorateEntry(ArchiveEntry* entry, vector<DecorateDef>& defs, vector<ArchiveEntry*>& sources)
 {
 	// Init tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters(":,{}");
 	tz.enableDecorate(true);
 	tz.openMem(entry->data(), entry->name());
+	sources.push_back(entry);
 
 	// --- Parse ---
 	while (!tz.atEnd())
@@ -590,6 +641,7 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 			// Check #include path could be resolved
 			if (!inc_entry)
 			{
+				sources.push_back(nullptr);
 				log::warning(
 					"Warning parsing DECORATE entry {}: "
 					"Unable to find #included entry \"{}\" at line {}, skipping",
@@ -598,16 +650,16 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 					tz.current().line_no);
 			}
 			else
-				parseDecorateEntry(inc_entry, types, parsed);
+				parseDecorateEntry(inc_entry, defs, sources);
 
 			tz.adv();
 		}
 
 		// Check for actor definition
 		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
+			parseDecorateActor(tz, defs);
 		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
+			parseDecorateOld(tz, defs); // Old DECORATE definitions might be found
 
 		tz.advIf("}");
 	}
@@ -617,6 +669,83 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 		entry->setType(etype_decorate);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the parsed definitions for DECORATE [entry], from the cache if it
+// was parsed previously and it (and any entries it #includes) hasn't changed
+// since
+// -----------------------------------------------------------------------------
+const vector<DecorateDef>& entryDefs(ArchiveEntry* entry)
+{
+	// Check for cached definitions
+	auto found = parsed_cache.find(entry);
+	if (found != parsed_cache.end())
+	{
+		auto& cached = found->second;
+		bool  valid  = cached.entry.lock().get() == entry;
+		for (auto& [source, data] : cached.sources)
+		{
+			auto source_entry = source.lock();
+			if (!valid || !source_entry || !data.sharesData(source_entry->data(false)))
+			{
+				valid = false;
+				break;
+			}
+		}
+
+		if (valid)
+			return cached.defs;
+
+		parsed_cache.erase(found);
+	}
+
+	// Remove any cached entries that no longer exist
+	for (auto i = parsed_cache.begin(); i != parsed_cache.end();)
+	{
+		if (i->second.entry.expired())
+			i = parsed_cache.erase(i);
+		else
+			++i;
+	}
+
+	// Parse
+	CachedDefs            parsed;
+	vector<ArchiveEntry*> sources;
+	parseDecorateEntry(entry, parsed.defs, sources);
+
+	// Add to cache (unless an #include couldn't be resolved, as it may resolve
+	// differently later on)
+	parsed.entry = entry->getShared();
+	for (auto source : sources)
+	{
+		auto shared = source ? source->getShared() : nullptr;
+		if (!shared)
+		{
+			parsed.entry.reset();
+			break;
+		}
+
+		parsed.sources.emplace_back(shared, MemChunk{});
+		parsed.sources.back().second.importMem(source->data());
+	}
+
+	auto& cached = parsed_cache[entry];
+	cached       = std::move(parsed);
+	return cached.defs;
+}
+
+// -----------------------------------------------------------------------------
+// Adds/updates thing types in [types] and [parsed] from parsed DECORATE [defs]
+// -----------------------------------------------------------------------------
+void addDefs(const vector<DecorateDef>& defs, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	for (const auto& def : defs)
+	{
+		if (def.actor)
+			addActorDef(def, types, parsed);
+		else
+			addOldDef(def, types);
+	}
+}
 } // namespace
 
 
@@ -652,7 +781,7 @@ bool game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 
 	// Parse DECORATE entries
 	for (auto entry : decorate_entries)
-		parseDecorateEntry(entry, types, parsed);
+		addDefs(entryDefs(entry), types, parsed);
 
 	return true;
 }
@@ -682,7 +811,7 @@ CONSOLE_COMMAND(test_decorate, 0, false)
 	{
 		auto entry = archive->entryAtPath(args[0]);
 		if (entry)
-			parseDecorateEntry(entry, types, parsed);
+			addDefs(entryDefs(entry), types, parsed);
 		else
 			log::console("Entry not found");
 	}
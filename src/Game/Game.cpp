@@ -36,11 +36,12 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "Configuration.h"
+#include "General/Jobs.h"
 #include "TextEditor/TextLanguage.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 #include "ZScript.h"
-#include <thread>
+#include <mutex>
 
 using namespace slade;
 using namespace game;
@@ -60,7 +61,7 @@ std::map<string, PortDef> port_defs;
 PortDef                   port_def_unknown;
 zscript::Definitions      zscript_base;
 zscript::Definitions      zscript_custom;
-unique_ptr<std::thread>   zscript_parse_thread;
+std::once_flag            defs_loaded;
 } // namespace slade::game
 CVAR(String, game_configuration, "", CVar::Flag::Save)
 CVAR(String, port_configuration, "", CVar::Flag::Save)
@@ -310,17 +311,13 @@ TagType game::parseTagged(ParseTreeNode* tagged)
 	return tag_type_map[strutil::lower(tagged->stringValue())];
 }
 
+namespace
+{
 // -----------------------------------------------------------------------------
-// Game related initialisation (read basic definitions, etc.)
+// Reads the basic game and port definitions from the user dir and slade.pk3
 // -----------------------------------------------------------------------------
-void game::init()
+void loadDefinitions()
 {
-	// Init static ThingTypes
-	ThingType::initGlobal();
-
-	// Init static ActionSpecials
-	ActionSpecial::initGlobal();
-
 	// Add game configurations from user dir
 	wxArrayString allfiles;
 	wxDir::GetAllFiles(app::path("games", app::Dir::User), &allfiles);
@@ -400,6 +397,30 @@ void game::init()
 			}
 		}
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the basic game and port definitions if they haven't been already.
+// They aren't read at startup unless a game configuration is to be loaded,
+// since they are otherwise only needed by the map editor (safe to call from
+// any thread)
+// -----------------------------------------------------------------------------
+void ensureDefsLoaded()
+{
+	std::call_once(defs_loaded, loadDefinitions);
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Game related initialisation (read basic definitions, etc.)
+// -----------------------------------------------------------------------------
+void game::init()
+{
+	// Init static ThingTypes
+	ThingType::initGlobal();
+
+	// Init static ActionSpecials
+	ActionSpecial::initGlobal();
 
 	// Load last configuration if any
 	if (!game_configuration.value.empty())
@@ -412,7 +433,7 @@ void game::init()
 	// Load zdoom.pk3 stuff
 	if (wxFileExists(zdoom_pk3_path))
 	{
-		zscript_parse_thread = std::make_unique<std::thread>([=]() {
+		jobs::run([](jobs::Job&) {
 			ZipArchive zdoom_pk3;
 			if (!zdoom_pk3.open(zdoom_pk3_path))
 				return;
@@ -437,7 +458,6 @@ void game::init()
 				config_current.parseMapInfo(zdoom_pk3);
 			}
 		});
-		zscript_parse_thread->detach();
 	}
 
 	// Update custom definitions when an archive is opened or closed
@@ -450,6 +470,7 @@ void game::init()
 // -----------------------------------------------------------------------------
 const std::map<string, GameDef>& game::gameDefs()
 {
+	ensureDefsLoaded();
 	return game_defs;
 }
 
@@ -458,6 +479,7 @@ const std::map<string, GameDef>& game::gameDefs()
 // -----------------------------------------------------------------------------
 const GameDef& game::gameDef(const string& id)
 {
+	ensureDefsLoaded();
 	return game_defs.empty() ? game_def_unknown : game_defs[id];
 }
 
@@ -466,6 +488,7 @@ const GameDef& game::gameDef(const string& id)
 // -----------------------------------------------------------------------------
 const std::map<string, PortDef>& game::portDefs()
 {
+	ensureDefsLoaded();
 	return port_defs;
 }
 
@@ -474,6 +497,7 @@ const std::map<string, PortDef>& game::portDefs()
 // -----------------------------------------------------------------------------
 const PortDef& game::portDef(const string& id)
 {
+	ensureDefsLoaded();
 	return port_defs.empty() ? port_def_unknown : port_defs[id];
 }
 
@@ -485,6 +509,7 @@ bool game::mapFormatSupported(MapFormat format, const string& game, const string
 	if (format == MapFormat::Unknown)
 		return false;
 
+	ensureDefsLoaded();
 	if (!port.empty())
 		return port_defs[port].supported_formats[format];
 
@@ -39,6 +39,63 @@ using namespace slade;
 using namespace game;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if map definitions [left] and [right] are identical
+// -----------------------------------------------------------------------------
+bool sameMap(const MapInfo::Map& left, const MapInfo::Map& right)
+{
+	return std::tie(
+			   left.name,
+			   left.lookup_name,
+			   left.entry_name,
+			   left.level_num,
+			   left.sky1,
+			   left.sky1_scroll_speed,
+			   left.sky2,
+			   left.sky2_scroll_speed,
+			   left.sky_double,
+			   left.sky_force_no_stretch,
+			   left.sky_stretch,
+			   left.music,
+			   left.lighting_smooth,
+			   left.lighting_wallshade_v,
+			   left.lighting_wallshade_h,
+			   left.force_fake_contrast,
+			   left.fog_density,
+			   left.fog_density_outside,
+			   left.fog_density_sky)
+			   == std::tie(
+				   right.name,
+				   right.lookup_name,
+				   right.entry_name,
+				   right.level_num,
+				   right.sky1,
+				   right.sky1_scroll_speed,
+				   right.sky2,
+				   right.sky2_scroll_speed,
+				   right.sky_double,
+				   right.sky_force_no_stretch,
+				   right.sky_stretch,
+				   right.music,
+				   right.lighting_smooth,
+				   right.lighting_wallshade_v,
+				   right.lighting_wallshade_h,
+				   right.force_fake_contrast,
+				   right.fog_density,
+				   right.fog_density_outside,
+				   right.fog_density_sky)
+		   && left.fade.equals(right.fade, true) && left.fade_outside.equals(right.fade_outside, true);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapInfo Class Functions
@@ -47,10 +104,23 @@ using namespace game;
 
 
 // -----------------------------------------------------------------------------
-// Clears all parsed MAPINFO information abour [maps] and [editor_nums] if set
+// Clears all parsed MAPINFO information abour [maps] and [editor_nums] if set.
+// Cached parsed entries are kept (see parseZMapInfo), except those that
+// weren't used since the last clear
 // -----------------------------------------------------------------------------
 void MapInfo::clear(bool maps, bool editor_nums)
 {
+	for (auto i = parsed_.begin(); i != parsed_.end();)
+	{
+		if (!i->second.used)
+			i = parsed_.erase(i);
+		else
+		{
+			i->second.used = false;
+			++i;
+		}
+	}
+
 	if (maps)
 	{
 		maps_.clear();
@@ -182,9 +252,76 @@ bool MapInfo::strToCol(const string& str, ColRGBA& col) const
 }
 
 // -----------------------------------------------------------------------------
-// Parses ZMAPINFO-format definitions in [entry]
+// Parses ZMAPINFO-format definitions in [entry].
+// The result is cached by the entry's data hash, and if the entry (and any
+// entries it includes) hasn't changed the next time it is parsed, the cached
+// definitions are applied instead of parsing it again
 // -----------------------------------------------------------------------------
 bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
+{
+	// Included entries are recorded as part of the entry including them
+	if (parsing_)
+		return parseZMapInfoEntry(entry);
+
+	// Check for a cached result
+	auto hash = entry->data().hash();
+	if (auto i = parsed_.find(hash); i != parsed_.end() && applyParsed(i->second, *entry->parent()))
+	{
+		log::info(2, "Applied cached ZMapInfo entry {}", entry->name());
+		return true;
+	}
+
+	// Parse the entry, recording the definitions it contains
+	ParsedEntry parsed;
+	parsed.default_map_in = default_map_;
+	parsing_              = &parsed;
+	bool ok               = parseZMapInfoEntry(entry);
+	parsing_              = nullptr;
+
+	if (ok)
+	{
+		parsed.default_map_out = default_map_;
+		parsed_[hash]          = std::move(parsed);
+	}
+	else
+		parsed_.erase(hash);
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Applies the cached definitions in [parsed] if they are still valid for
+// [archive] (ie. the current default map definition and all included entries
+// are the same as when it was parsed). Returns false if they weren't applied
+// -----------------------------------------------------------------------------
+bool MapInfo::applyParsed(ParsedEntry& parsed, const Archive& archive)
+{
+	// Check the definitions would be parsed the same way
+	if (!sameMap(parsed.default_map_in, default_map_))
+		return false;
+	for (const auto& [path, hash] : parsed.includes)
+	{
+		auto include_entry = archive.entryAtPath(path);
+		if ((include_entry ? include_entry->data().hash() : 0) != hash)
+			return false;
+	}
+
+	// Apply definitions
+	for (auto map : parsed.maps)
+		addOrUpdateMap(map);
+	for (const auto& [number, ednum] : parsed.editor_nums)
+		editor_nums_[number] = ednum;
+	default_map_ = parsed.default_map_out;
+
+	parsed.used = true;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Parses ZMAPINFO-format definitions in [entry] (and any entries it includes),
+// recording them in the cached result currently being parsed
+// -----------------------------------------------------------------------------
+bool MapInfo::parseZMapInfoEntry(ArchiveEntry* entry)
 {
 	Tokenizer tz;
 	tz.setReadLowerCase(true);
@@ -197,6 +334,7 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 		{
 			// Get entry at include path
 			auto* include_entry = entry->parent()->entryAtPath(tz.next().text);
+			parsing_->includes.emplace_back(tz.current().text, include_entry ? include_entry->data().hash() : 0);
 
 			if (!include_entry)
 			{
@@ -206,7 +344,7 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 					tz.current().text,
 					tz.lineNo());
 			}
-			else if (!parseZMapInfo(include_entry))
+			else if (!parseZMapInfoEntry(include_entry))
 				return false;
 		}
 
@@ -428,6 +566,9 @@ bool MapInfo::parseZMap(Tokenizer& tz, string_view type)
 		// Add if it didn't exist
 		if (!updated)
 			maps_.push_back(map);
+
+		if (parsing_)
+			parsing_->maps.push_back(map);
 	}
 	else if (type == "defaultmap")
 		default_map_ = map;
@@ -506,6 +647,9 @@ bool MapInfo::parseDoomEdNums(Tokenizer& tz)
 			}
 		}
 
+		if (parsing_)
+			parsing_->editor_nums[number] = editor_nums_[number];
+
 		tz.adv();
 	}
 
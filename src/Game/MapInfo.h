@@ -91,9 +91,28 @@ namespace game
 		void dumpDoomEdNums();
 
 	private:
+		// The result of parsing a ZMAPINFO entry (and its includes), cached so
+		// it can be applied again without re-parsing if nothing it depends on
+		// has changed
+		struct ParsedEntry
+		{
+			vector<std::pair<string, uint64_t>> includes; // Path and data hash of each include (0 if not found)
+			Map                                 default_map_in;  // Default map definition before parsing
+			Map                                 default_map_out; // Default map definition after parsing
+			vector<Map>                         maps;            // Map definitions, in the order parsed
+			DoomEdNumMap                        editor_nums;
+			bool                                used = true; // Used since the last clear
+		};
+
 		vector<Map>  maps_;
 		Map          default_map_;
 		DoomEdNumMap editor_nums_;
+
+		std::unordered_map<uint64_t, ParsedEntry> parsed_;            // Keyed by entry data hash
+		ParsedEntry*                              parsing_ = nullptr; // Currently being recorded
+
+		bool parseZMapInfoEntry(ArchiveEntry* entry);
+		bool applyParsed(ParsedEntry& parsed, const Archive& archive);
 	};
 } // namespace game
 } // namespace slade
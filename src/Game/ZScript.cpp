@@ -36,6 +36,8 @@
 #include "Archive/ArchiveManager.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <mutex>
+#include <unordered_map>
 
 using namespace slade;
 using namespace zscript;
@@ -64,6 +66,17 @@ bool dump_parsed_states    = false;
 bool dump_parsed_functions = false;
 
 string db_comment = "//$";
+
+// Parsed blocks of previously parsed ZScript entries (including any #included
+// entries), so unchanged entries don't need to be parsed again
+struct CachedBlocks
+{
+	weak_ptr<ArchiveEntry>                              entry;
+	vector<std::pair<weak_ptr<ArchiveEntry>, MemChunk>> sources; // Shares each parsed entry's data
+	vector<ParsedStatement>                             parsed;
+};
+std::unordered_map<ArchiveEntry*, CachedBlocks> parsed_cache;
+std::mutex                                      parsed_cache_mutex;
 } // namespace slade::zscript
 
 
@@ -188,7 +201,97 @@ bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, st
 // -----------------------------------------------------------------------------
 // Parses all statements/blocks in [entry], adding them to [parsed]
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<ArchiveEntry*>& entry_stack)
+// -----------------------------------------------------------------------------
+// Gets the cached parsed blocks for ZScript [entry] in [parsed].
+// Returns false if [entry] hasn't been parsed, or it (or any entry it
+// #includes) has changed since it was
+// -----------------------------------------------------------------------------
+bool getCachedBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+{
+	std::lock_guard<std::mutex> lock(parsed_cache_mutex);
+
+	auto found = parsed_cache.find(entry);
+	if (found == parsed_cache.end())
+		return false;
+
+	auto& cached = found->second;
+	bool  valid  = cached.entry.lock().get() == entry;
+	for (auto& [source, data] : cached.sources)
+	{
+		auto source_entry = source.lock();
+		if (!valid || !source_entry || !data.sharesData(source_entry->data(false)))
+		{
+			valid = false;
+			break;
+		}
+	}
+
+	if (!valid)
+	{
+		parsed_cache.erase(found);
+		return false;
+	}
+
+	// Set entry types as parseBlocks would
+	if (etype_zscript)
+		for (auto& source : cached.sources)
+		{
+			auto source_entry = source.first.lock();
+			if (source_entry->type() != etype_zscript)
+				source_entry->setType(etype_zscript);
+		}
+
+	parsed = cached.parsed;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [parsed] blocks for ZScript [entry] to the cache. [sources] is the list
+// of all entries that were parsed ([entry] and any #included entries), a null
+// entry means an #include couldn't be resolved so the result isn't cached
+// (as the #include may resolve differently later on)
+// -----------------------------------------------------------------------------
+void cacheBlocks(ArchiveEntry* entry, const vector<ArchiveEntry*>& sources, const vector<ParsedStatement>& parsed)
+{
+	CachedBlocks cached;
+	cached.entry = entry->getShared();
+	if (!cached.entry.lock())
+		return;
+
+	for (auto source : sources)
+	{
+		auto shared = source ? source->getShared() : nullptr;
+		if (!shared)
+			return;
+
+		cached.sources.emplace_back(shared, MemChunk{});
+		cached.sources.back().second.importMem(source->data());
+	}
+	cached.parsed = parsed;
+
+	std::lock_guard<std::mutex> lock(parsed_cache_mutex);
+
+	// Remove any cached entries that no longer exist
+	for (auto i = parsed_cache.begin(); i != parsed_cache.end();)
+	{
+		if (i->second.entry.expired())
+			i = parsed_cache.erase(i);
+		else
+			++i;
+	}
+
+	parsed_cache[entry] = std::move(cached);
+}
+
+// -----------------------------------------------------------------------------
+// Parses ZScript [entry] into blocks of statements in [parsed], following any
+// #include directives. [sources] will contain all entries that were parsed
+// -----------------------------------------------------------------------------
+void parseBlocks(
+	ArchiveEntry*            entry,
+	vector<ParsedStatement>& parsed,
+	vector<ArchiveEntry*>&   entry_stack,
+	vector<ArchiveEntry*>&   sources)
 {
 	Tokenizer tz;
 	tz.setSpecialCharacters(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?.");
@@ -197,6 +300,7 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 	tz.openMem(entry->data(), "ZScript");
 
 	entry_stack.push_back(entry);
+	sources.push_back(entry);
 
 	while (!tz.atEnd())
 	{
@@ -210,6 +314,7 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 				// Check #include path could be resolved
 				if (!inc_entry)
 				{
+					sources.push_back(nullptr);
 					log::warning(
 						"Warning parsing ZScript entry {}: "
 						"Unable to find #included entry \"{}\" at line {}, skipping",
@@ -227,7 +332,7 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 						tz.current().line_no);
 				}
 				else
-					parseBlocks(inc_entry, parsed, entry_stack);
+					parseBlocks(inc_entry, parsed, entry_stack, sources);
 			}
 
 			tz.advToNextLine();
@@ -955,9 +1060,16 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 	// Parse into tree of expressions and blocks
 	auto                    start = app::runTimer();
 	vector<ParsedStatement> parsed;
-	vector<ArchiveEntry*>   entry_stack;
-	parseBlocks(entry, parsed, entry_stack);
-	log::debug(2, "parseBlocks: {}ms", app::runTimer() - start);
+	if (getCachedBlocks(entry, parsed))
+		log::debug(2, "parseBlocks (cached): {}ms", app::runTimer() - start);
+	else
+	{
+		vector<ArchiveEntry*> entry_stack;
+		vector<ArchiveEntry*> sources;
+		parseBlocks(entry, parsed, entry_stack, sources);
+		cacheBlocks(entry, sources, parsed);
+		log::debug(2, "parseBlocks: {}ms", app::runTimer() - start);
+	}
 	start = app::runTimer();
 
 	for (auto& block : parsed)
@@ -1246,10 +1358,12 @@ CONSOLE_COMMAND(test_parseblocks, 1, false)
 	auto                    start = app::runTimer();
 	vector<ParsedStatement> parsed;
 	vector<ArchiveEntry*>   entry_stack;
+	vector<ArchiveEntry*>   sources;
 	for (auto a = 0; a < num; ++a)
 	{
-		parseBlocks(entry, parsed, entry_stack);
+		parseBlocks(entry, parsed, entry_stack, sources);
 		parsed.clear();
+		sources.clear();
 	}
 	log::console(fmt::format("Took {}ms", app::runTimer() - start));
 }
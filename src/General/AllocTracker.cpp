@@ -0,0 +1,228 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    AllocTracker.cpp
+// Description: Allocation tracking for core data types (MemChunk data,
+//              ParseTreeNode, Property and MapObject), counted per subsystem.
+//              Only enabled in builds with USE_ALLOC_TRACKING defined
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "AllocTracker.h"
+#include "General/Console.h"
+#include "Utility/StringUtils.h"
+#include <array>
+#include <atomic>
+
+using namespace slade;
+using namespace alloctracker;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+#ifdef USE_ALLOC_TRACKING
+namespace
+{
+constexpr unsigned n_types      = static_cast<unsigned>(Type::Count);
+constexpr unsigned n_subsystems = static_cast<unsigned>(Subsystem::Count);
+
+// Header stored before each tracked MemChunk buffer (keeps the data aligned)
+struct alignas(16) BufferHeader
+{
+	size_t    size;
+	Subsystem subsystem;
+};
+
+struct Counters
+{
+	std::atomic<int64_t>  live_count{ 0 };
+	std::atomic<int64_t>  live_bytes{ 0 };
+	std::atomic<int64_t>  peak_bytes{ 0 };
+	std::atomic<uint64_t> total_count{ 0 }; // Allocations since the last reset
+	std::atomic<uint64_t> total_bytes{ 0 };
+};
+
+std::array<std::array<Counters, n_types>, n_subsystems> counters;
+thread_local Subsystem                                  current_subsystem = Subsystem::Other;
+
+const char* type_names[]      = { "MemChunk", "ParseTreeNode", "Property", "MapObject" };
+const char* subsystem_names[] = { "Other", "Archive", "Map", "Parser", "Graphics", "Scripting" };
+} // namespace
+#endif
+
+
+// -----------------------------------------------------------------------------
+//
+// alloctracker Namespace Functions
+//
+// -----------------------------------------------------------------------------
+#ifdef USE_ALLOC_TRACKING
+
+// -----------------------------------------------------------------------------
+// Returns the subsystem allocations on the current thread are attributed to
+// -----------------------------------------------------------------------------
+Subsystem alloctracker::current()
+{
+	return current_subsystem;
+}
+
+// -----------------------------------------------------------------------------
+// Records an allocation of [bytes] of [type] in [subsystem]
+// -----------------------------------------------------------------------------
+void alloctracker::allocated(Type type, Subsystem subsystem, size_t bytes)
+{
+	auto& c = counters[static_cast<unsigned>(subsystem)][static_cast<unsigned>(type)];
+
+	++c.live_count;
+	++c.total_count;
+	c.total_bytes += bytes;
+	auto live = c.live_bytes += static_cast<int64_t>(bytes);
+
+	auto peak = c.peak_bytes.load(std::memory_order_relaxed);
+	while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+// -----------------------------------------------------------------------------
+// Records freeing [bytes] of [type] previously allocated in [subsystem]
+// -----------------------------------------------------------------------------
+void alloctracker::freed(Type type, Subsystem subsystem, size_t bytes)
+{
+	auto& c = counters[static_cast<unsigned>(subsystem)][static_cast<unsigned>(type)];
+
+	--c.live_count;
+	c.live_bytes -= static_cast<int64_t>(bytes);
+}
+
+// -----------------------------------------------------------------------------
+// Allocates a tracked MemChunk buffer of [size] bytes
+// -----------------------------------------------------------------------------
+uint8_t* alloctracker::allocBytes(size_t size)
+{
+	auto data   = new uint8_t[sizeof(BufferHeader) + size];
+	auto header = reinterpret_cast<BufferHeader*>(data);
+	*header     = { size, current_subsystem };
+	allocated(Type::MemChunk, header->subsystem, size);
+
+	return data + sizeof(BufferHeader);
+}
+
+// -----------------------------------------------------------------------------
+// Frees tracked MemChunk buffer [data] (allocated with allocBytes)
+// -----------------------------------------------------------------------------
+void alloctracker::freeBytes(uint8_t* data)
+{
+	if (!data)
+		return;
+
+	data -= sizeof(BufferHeader);
+	auto header = reinterpret_cast<BufferHeader*>(data);
+	freed(Type::MemChunk, header->subsystem, header->size);
+
+	delete[] data;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Scope Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Scope class constructor
+// -----------------------------------------------------------------------------
+Scope::Scope(Subsystem subsystem) : prev_{ current_subsystem }
+{
+	current_subsystem = subsystem;
+}
+
+// -----------------------------------------------------------------------------
+// Scope class destructor
+// -----------------------------------------------------------------------------
+Scope::~Scope()
+{
+	current_subsystem = prev_;
+}
+
+#endif
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(alloc_stats, 0, false)
+{
+#ifdef USE_ALLOC_TRACKING
+	bool reset = !args.empty() && strutil::equalCI(args[0], "reset");
+
+	log::console(fmt::format(
+		"{:<10} {:<14} {:>10} {:>12} {:>12} {:>12} {:>14}",
+		"Subsystem",
+		"Type",
+		"Live",
+		"Live (KB)",
+		"Peak (KB)",
+		"Allocs",
+		"Alloc'd (KB)"));
+	for (unsigned s = 0; s < n_subsystems; ++s)
+		for (unsigned t = 0; t < n_types; ++t)
+		{
+			auto& c = counters[s][t];
+			if (c.total_count > 0 || c.live_count > 0)
+				log::console(fmt::format(
+					"{:<10} {:<14} {:>10} {:>12.1f} {:>12.1f} {:>12} {:>14.1f}",
+					subsystem_names[s],
+					type_names[t],
+					c.live_count.load(),
+					c.live_bytes.load() / 1024.,
+					c.peak_bytes.load() / 1024.,
+					c.total_count.load(),
+					c.total_bytes.load() / 1024.));
+
+			// Reset peaks to the current live size, and totals
+			if (reset)
+			{
+				c.peak_bytes  = c.live_bytes.load();
+				c.total_count = 0;
+				c.total_bytes = 0;
+			}
+		}
+
+	if (reset)
+		log::console("Allocation peaks and totals reset");
+#else
+	log::console("Allocation tracking is not enabled in this build (see the USE_ALLOC_TRACKING CMake option)");
+#endif
+}
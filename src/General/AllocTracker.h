@@ -0,0 +1,86 @@
+#pragma once
+
+// Allocation tracking for core data types, counted per subsystem. Only enabled
+// in builds with USE_ALLOC_TRACKING defined (the USE_ALLOC_TRACKING CMake
+// option), otherwise everything here compiles to nothing (or plain new/delete).
+// Use the 'alloc_stats' console command to view the counts
+namespace slade::alloctracker
+{
+// Tracked types
+enum class Type
+{
+	MemChunk, // Data buffer bytes
+	ParseTreeNode,
+	Property, // PropertyList entries
+	MapObject, // Base object size only
+
+	Count
+};
+
+// Subsystems that allocations are attributed to (see Scope)
+enum class Subsystem : uint8_t
+{
+	Other,
+	Archive,
+	Map,
+	Parser,
+	Graphics,
+	Scripting,
+
+	Count
+};
+
+#ifdef USE_ALLOC_TRACKING
+constexpr bool enabled = true;
+
+Subsystem current();
+void      allocated(Type type, Subsystem subsystem, size_t bytes);
+void      freed(Type type, Subsystem subsystem, size_t bytes);
+uint8_t*  allocBytes(size_t size);
+void      freeBytes(uint8_t* data);
+#else
+constexpr bool enabled = false;
+
+inline uint8_t* allocBytes(size_t size)
+{
+	return new uint8_t[size];
+}
+inline void freeBytes(uint8_t* data)
+{
+	delete[] data;
+}
+#endif
+
+// Attributes tracked allocations made on the current thread to [subsystem]
+// while in scope
+class Scope
+{
+public:
+#ifdef USE_ALLOC_TRACKING
+	Scope(Subsystem subsystem);
+	~Scope();
+
+private:
+	Subsystem prev_;
+#else
+	Scope(Subsystem) {}
+#endif
+};
+
+// Base class for tracked types, counting sizeof(T) bytes per instance against
+// the subsystem it was created in. Empty unless built with USE_ALLOC_TRACKING
+template<class T, Type type> class Counted
+{
+#ifdef USE_ALLOC_TRACKING
+protected:
+	Counted() : subsystem_{ current() } { allocated(type, subsystem_, sizeof(T)); }
+	Counted(const Counted&) : Counted() {}
+	~Counted() { freed(type, subsystem_, sizeof(T)); }
+
+	Counted& operator=(const Counted&) { return *this; }
+
+private:
+	Subsystem subsystem_;
+#endif
+};
+} // namespace slade::alloctracker
@@ -0,0 +1,578 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Benchmark.cpp
+// Description: Repeatable benchmarks of archive open/write, entry type
+//              detection, map read/write, polygon triangulation, image
+//              conversion, Doom gfx read/write, palette lookups, text parsing
+//              and texture compositing, run over the contents of a fixture
+//              archive. Results can be logged or written as JSON for tracking
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Benchmark.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/Formats/WadArchive.h"
+#include "Archive/Formats/ZipArchive.h"
+#include "General/Console.h"
+#include "General/Misc.h"
+#include "General/Profiler.h"
+#include "Graphics/CTexture/PatchTable.h"
+#include "Graphics/CTexture/TextureXList.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "MainEditor/MainEditor.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/Parser.h"
+#include "Utility/Polygon2D.h"
+#include "Utility/StringUtils.h"
+#include "Utility/Tokenizer.h"
+#include <fstream>
+#include <random>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Each benchmark is run (after one untimed warm-up run) at least
+// min_iterations times and until it has taken at least min_time_us in total,
+// up to max_iterations times
+constexpr unsigned min_iterations = 5;
+constexpr unsigned max_iterations = 1000;
+constexpr int64_t  min_time_us    = 500000;
+
+// Number of colours looked up per nearestColour iteration
+constexpr unsigned n_palette_lookups = 65536;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Runs benchmark [name] ([func], processing [items] things per call) and adds
+// its timings to [report]. Does nothing if there are no [items]
+// -----------------------------------------------------------------------------
+void bench(benchmark::Report& report, const string& name, size_t items, const std::function<void()>& func)
+{
+	if (items == 0)
+		return;
+
+	// Warm up (loads any lazily loaded data, fills caches)
+	func();
+
+	vector<double> times;
+	int64_t        total = 0;
+	while (times.size() < max_iterations && (times.size() < min_iterations || total < min_time_us))
+	{
+		auto start = profiler::now();
+		func();
+		auto time = profiler::now() - start;
+
+		total += time;
+		times.push_back(static_cast<double>(time) / 1000.);
+	}
+
+	report.results.push_back(benchmark::summarise(name, items, times));
+	log::info(
+		2, "Benchmark \"{}\": {:1.3f}ms ({} iterations)", name, report.results.back().mean_ms, times.size());
+}
+
+// -----------------------------------------------------------------------------
+// Runs the archive open/write benchmarks for [archive] (if it is a wad or zip)
+// containing [n_entries] entries
+// -----------------------------------------------------------------------------
+void benchArchive(benchmark::Report& report, Archive& archive, size_t n_entries)
+{
+	auto format = archive.formatId();
+	if (format != "wad" && format != "zip")
+		return;
+
+	auto create = [&format]() -> unique_ptr<Archive> {
+		if (format == "wad")
+			return std::make_unique<WadArchive>();
+		return std::make_unique<ZipArchive>();
+	};
+
+	MemChunk data;
+	if (!archive.write(data, false))
+		return;
+
+	bench(report, fmt::format("{} open", format), n_entries, [&]() {
+		auto opened = create();
+		opened->open(data);
+	});
+
+	auto opened = create();
+	if (!opened->open(data))
+		return;
+	bench(report, fmt::format("{} write", format), n_entries, [&]() {
+		MemChunk out;
+		opened->write(out, false);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Runs the map read/write and sector triangulation benchmarks for all maps in
+// [archive]
+// -----------------------------------------------------------------------------
+void benchMaps(benchmark::Report& report, Archive& archive)
+{
+	// Group maps by format (binary formats and UDMF perform very differently)
+	std::map<string, vector<Archive::MapDesc>> maps;
+	for (const auto& map : archive.detectMaps())
+		maps[map.format == MapFormat::UDMF ? "UDMF" : "binary"].push_back(map);
+
+	for (const auto& [format, descs] : maps)
+	{
+		bench(report, fmt::format("{} map read", format), descs.size(), [&descs]() {
+			for (const auto& desc : descs)
+			{
+				SLADEMap map;
+				map.readMap(desc);
+			}
+		});
+
+		// Open all maps for the write/triangulation benchmarks
+		vector<unique_ptr<SLADEMap>> opened;
+		size_t                       n_sectors = 0;
+		for (const auto& desc : descs)
+		{
+			auto map = std::make_unique<SLADEMap>();
+			if (!map->readMap(desc))
+				continue;
+			n_sectors += map->nSectors();
+			opened.push_back(std::move(map));
+		}
+
+		bench(report, fmt::format("{} map write", format), opened.size(), [&opened]() {
+			for (const auto& map : opened)
+			{
+				vector<ArchiveEntry*> entries;
+				map->writeMap(entries);
+				for (auto entry : entries)
+					delete entry;
+			}
+		});
+
+		bench(report, fmt::format("{} sector triangulation", format), n_sectors, [&opened]() {
+			Polygon2D poly;
+			for (const auto& map : opened)
+				for (auto sector : map->sectors())
+					poly.openSector(sector, Polygon2D::SplitMethod::Triangulator);
+		});
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs the image load/conversion benchmarks for all graphics entries in
+// [entries]
+// -----------------------------------------------------------------------------
+void benchImages(benchmark::Report& report, const vector<ArchiveEntry*>& entries)
+{
+	vector<ArchiveEntry*> gfx_entries;
+	for (auto entry : entries)
+		if (entry->type()->editor() == "gfx")
+			gfx_entries.push_back(entry);
+
+	bench(report, "SImage load", gfx_entries.size(), [&gfx_entries]() {
+		SImage image;
+		for (auto entry : gfx_entries)
+			misc::loadImageFromEntry(&image, entry);
+	});
+
+	// Load all images for the conversion benchmarks
+	vector<unique_ptr<SImage>> images;
+	for (auto entry : gfx_entries)
+	{
+		auto image = std::make_unique<SImage>();
+		if (misc::loadImageFromEntry(image.get(), entry))
+			images.push_back(std::move(image));
+	}
+
+	auto palette = maineditor::currentPalette(gfx_entries.empty() ? nullptr : gfx_entries[0]);
+	bench(report, "SImage convert RGBA", images.size(), [&images, palette]() {
+		SImage image;
+		for (const auto& source : images)
+		{
+			image.copyImage(source.get());
+			image.convertRGBA(palette);
+		}
+	});
+
+	bench(report, "SImage convert paletted", images.size(), [&images, palette]() {
+		SImage image;
+		for (const auto& source : images)
+		{
+			image.copyImage(source.get());
+			image.convertRGBA(palette);
+			image.convertPaletted(palette, palette);
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Runs the Doom gfx format read/write benchmarks for all Doom gfx entries in
+// [entries]. Also checks that each image written reads back the same (by
+// writing it again and comparing the data), logging any that don't
+// -----------------------------------------------------------------------------
+void benchDoomGfx(benchmark::Report& report, const vector<ArchiveEntry*>& entries)
+{
+	auto format = SIFormat::getFormat("doom");
+
+	vector<ArchiveEntry*> gfx_entries;
+	for (auto entry : entries)
+		if (entry->type()->formatId() == "img_doom")
+			gfx_entries.push_back(entry);
+
+	bench(report, "Doom gfx read", gfx_entries.size(), [&gfx_entries, format]() {
+		SImage image;
+		for (auto entry : gfx_entries)
+			format->loadImage(image, entry->data());
+	});
+
+	// Load all images for the write benchmark
+	vector<unique_ptr<SImage>> images;
+	for (auto entry : gfx_entries)
+	{
+		auto image = std::make_unique<SImage>();
+		if (format->loadImage(*image, entry->data()))
+			images.push_back(std::move(image));
+	}
+
+	bench(report, "Doom gfx write", images.size(), [&images, format]() {
+		MemChunk mc;
+		for (const auto& image : images)
+			format->saveImage(*image, mc);
+	});
+
+	// Check written images read back the same
+	for (unsigned a = 0; a < images.size(); ++a)
+	{
+		MemChunk written, rewritten;
+		SImage   image;
+		format->saveImage(*images[a], written);
+		bool same = format->loadImage(image, written) && format->saveImage(image, rewritten)
+					&& written.size() == rewritten.size()
+					&& memcmp(written.data(), rewritten.data(), written.size()) == 0;
+		if (!same)
+			log::warning("Doom gfx image {} is different after writing and reading back", a);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs the Palette::nearestColour benchmark (with the global palette)
+// -----------------------------------------------------------------------------
+void benchPalette(benchmark::Report& report)
+{
+	// Use the same (pseudo-random) colours every run
+	std::mt19937    rng(1234);
+	vector<ColRGBA> colours(n_palette_lookups);
+	for (auto& colour : colours)
+		colour = ColRGBA(rng() & 0xFF, rng() & 0xFF, rng() & 0xFF);
+
+	Palette palette;
+	palette.copyPalette(app::paletteManager()->globalPalette());
+	bench(report, "Palette nearestColour", colours.size(), [&colours, &palette]() {
+		for (const auto& colour : colours)
+			palette.nearestColour(colour);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Runs the Tokenizer benchmark for all text entries in [entries], and the
+// Parser benchmark for all configuration files in the program resource
+// -----------------------------------------------------------------------------
+void benchText(benchmark::Report& report, const vector<ArchiveEntry*>& entries)
+{
+	vector<ArchiveEntry*> text_entries;
+	for (auto entry : entries)
+		if (entry->type()->editor() == "text")
+			text_entries.push_back(entry);
+
+	bench(report, "Tokenizer", text_entries.size(), [&text_entries]() {
+		Tokenizer tz;
+		for (auto entry : text_entries)
+		{
+			tz.openMem(entry->data(), entry->name());
+			while (!tz.atEnd())
+				tz.adv();
+		}
+	});
+
+	vector<ArchiveEntry*> config_entries;
+	auto                  res_archive = app::archiveManager().programResourceArchive();
+	if (auto dir = res_archive ? res_archive->dirAtPath("config") : nullptr)
+	{
+		vector<ArchiveEntry*> res_entries;
+		res_archive->putEntryTreeAsList(res_entries, dir);
+		for (auto entry : res_entries)
+			if (strutil::endsWithCI(entry->name(), ".cfg"))
+				config_entries.push_back(entry);
+	}
+
+	bench(report, "Parser (program resource configs)", config_entries.size(), [&config_entries]() {
+		for (auto entry : config_entries)
+		{
+			Parser parser(entry->parentDir());
+			parser.parseText(entry->data(), entry->name());
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Runs the CTexture::toImage benchmark for all TEXTUREx and TEXTURES
+// definitions in [archive]
+// -----------------------------------------------------------------------------
+void benchTextures(benchmark::Report& report, Archive& archive)
+{
+	TextureXList textures;
+
+	Archive::SearchOptions opt;
+	opt.match_type = EntryType::fromId("pnames");
+	if (auto pnames = archive.findLast(opt))
+	{
+		PatchTable ptable;
+		ptable.loadPNAMES(pnames);
+
+		opt.match_type = EntryType::fromId("texturex");
+		for (auto entry : archive.findAll(opt))
+			textures.readTEXTUREXData(entry, ptable, true);
+	}
+
+	opt.match_type = EntryType::fromId("zdtextures");
+	for (auto entry : archive.findAll(opt))
+		textures.readTEXTURESData(entry);
+
+	auto palette = maineditor::currentPalette();
+	bench(report, "CTexture toImage", textures.size(), [&textures, &archive, palette]() {
+		SImage image;
+		for (unsigned a = 0; a < textures.size(); a++)
+			textures.texture(a)->toImage(image, &archive, palette, true);
+	});
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// benchmark Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the result of benchmark [name] (processing [items] things per
+// iteration) with iteration times [times_ms]
+// -----------------------------------------------------------------------------
+benchmark::Result benchmark::summarise(string_view name, size_t items, vector<double> times_ms)
+{
+	Result result;
+	result.name       = name;
+	result.items      = items;
+	result.iterations = times_ms.size();
+	if (times_ms.empty())
+		return result;
+
+	std::sort(times_ms.begin(), times_ms.end());
+	auto percentile = [&times_ms](double p) {
+		auto index = static_cast<size_t>(std::ceil(p * times_ms.size())) - 1;
+		return times_ms[std::min(index, times_ms.size() - 1)];
+	};
+
+	double total = 0.;
+	for (auto time : times_ms)
+		total += time;
+
+	result.min_ms  = times_ms.front();
+	result.mean_ms = total / times_ms.size();
+	result.p50_ms  = percentile(0.5);
+	result.p95_ms  = percentile(0.95);
+	result.p99_ms  = percentile(0.99);
+	result.max_ms  = times_ms.back();
+
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Runs all benchmarks over the contents of [archive] and returns the results.
+// Benchmarks with nothing to process in [archive] are skipped
+// -----------------------------------------------------------------------------
+benchmark::Report benchmark::run(Archive& archive)
+{
+	Report report;
+	report.archive = archive.filename(false);
+
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+	entries.erase(
+		std::remove_if(
+			entries.begin(),
+			entries.end(),
+			[](ArchiveEntry* entry) { return entry->type() == EntryType::folderType(); }),
+		entries.end());
+
+	// Load all entry data first, so the benchmarks don't include reading it
+	// from disk
+	for (auto entry : entries)
+		entry->data();
+
+	benchArchive(report, archive, entries.size());
+	bench(report, "EntryType detection", entries.size(), [&entries]() {
+		for (auto entry : entries)
+			EntryType::detectEntryType(*entry);
+	});
+	benchMaps(report, archive);
+	benchImages(report, entries);
+	benchDoomGfx(report, entries);
+	benchPalette(report);
+	benchText(report, entries);
+	benchTextures(report, archive);
+
+	return report;
+}
+
+// -----------------------------------------------------------------------------
+// Logs the results in [report] to the console
+// -----------------------------------------------------------------------------
+void benchmark::logReport(const Report& report)
+{
+	log::console(fmt::format("Benchmarks for {}:", report.archive));
+	log::console(fmt::format(
+		"{:>8} {:>8} {:>10} {:>10} {:>10} {:>10}  Benchmark",
+		"Items",
+		"Iters",
+		"Min (ms)",
+		"Mean (ms)",
+		"P95 (ms)",
+		"Max (ms)"));
+	for (const auto& result : report.results)
+	{
+		auto line = fmt::format(
+			"{:>8} {:>8} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}  {}",
+			result.items,
+			result.iterations,
+			result.min_ms,
+			result.mean_ms,
+			result.p95_ms,
+			result.max_ms,
+			result.name);
+		if (result.draw_calls > 0. || result.texture_binds > 0.)
+			line += fmt::format(" ({:.0f} draw calls, {:.0f} texture binds)", result.draw_calls, result.texture_binds);
+		log::console(line);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes the results in [reports] to [filename] as JSON.
+// Returns false if the file couldn't be written
+// -----------------------------------------------------------------------------
+bool benchmark::writeJSON(string_view filename, const vector<Report>& reports)
+{
+	std::ofstream file{ string{ filename } };
+	if (!file.is_open())
+		return false;
+
+	auto escape = [](string text) {
+		strutil::replaceIP(text, "\\", "\\\\");
+		strutil::replaceIP(text, "\"", "\\\"");
+		return text;
+	};
+
+	file << fmt::format("{{\"version\":\"{}\",\"archives\":[\n", app::version().toString());
+	for (size_t a = 0; a < reports.size(); ++a)
+	{
+		file << fmt::format("{{\"archive\":\"{}\",\"benchmarks\":[\n", escape(reports[a].archive));
+		const auto& results = reports[a].results;
+		for (size_t r = 0; r < results.size(); ++r)
+		{
+			const auto& result = results[r];
+			file << fmt::format(
+				"{{\"name\":\"{}\",\"items\":{},\"iterations\":{},\"min_ms\":{:.4f},\"mean_ms\":{:.4f},"
+				"\"p50_ms\":{:.4f},\"p95_ms\":{:.4f},\"p99_ms\":{:.4f},\"max_ms\":{:.4f}",
+				escape(result.name),
+				result.items,
+				result.iterations,
+				result.min_ms,
+				result.mean_ms,
+				result.p50_ms,
+				result.p95_ms,
+				result.p99_ms,
+				result.max_ms);
+			if (result.draw_calls > 0. || result.texture_binds > 0.)
+				file << fmt::format(
+					",\"draw_calls\":{:.1f},\"texture_binds\":{:.1f}", result.draw_calls, result.texture_binds);
+			file << "}" << (r + 1 < results.size() ? "," : "") << "\n";
+		}
+		file << "]}" << (a + 1 < reports.size() ? "," : "") << "\n";
+	}
+	file << "]}\n";
+
+	return file.good();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(benchmark, 0, false)
+{
+	auto archive = maineditor::currentArchive();
+	if (!archive)
+	{
+		log::console("No archive is currently open");
+		return;
+	}
+
+	auto report = benchmark::run(*archive);
+	benchmark::logReport(report);
+
+	if (!args.empty())
+	{
+		if (benchmark::writeJSON(args[0], { report }))
+			log::console(fmt::format("Wrote benchmark results to \"{}\"", args[0]));
+		else
+			log::error("Unable to write benchmark results to \"{}\"", args[0]);
+	}
+}
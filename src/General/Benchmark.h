@@ -0,0 +1,42 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+
+// Repeatable benchmarks of the core archive, map, graphics and text handling
+// code, run over the contents of a fixture archive (so regressions can be
+// tracked between versions by running them over the same set of archives).
+// Run via batch mode (-op benchmark:FILE) or the 'benchmark' console command.
+// See also RenderBenchmark.h for map renderer benchmarks
+namespace benchmark
+{
+	struct Result
+	{
+		string   name;
+		unsigned iterations = 0;
+		size_t   items      = 0; // Number of things processed per iteration (entries, maps, etc.)
+		double   min_ms     = 0.;
+		double   mean_ms    = 0.;
+		double   p50_ms     = 0.;
+		double   p95_ms     = 0.;
+		double   p99_ms     = 0.;
+		double   max_ms     = 0.;
+
+		// Render benchmarks only (averages per frame)
+		double draw_calls    = 0.;
+		double texture_binds = 0.;
+	};
+
+	struct Report
+	{
+		string         archive;
+		vector<Result> results;
+	};
+
+	Result summarise(string_view name, size_t items, vector<double> times_ms);
+	Report run(Archive& archive);
+	void   logReport(const Report& report);
+	bool   writeJSON(string_view filename, const vector<Report>& reports);
+} // namespace benchmark
+} // namespace slade
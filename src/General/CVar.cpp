@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "Utility/StringUtils.h"
 #include <fmt/format.h>
+#include <unordered_map>
 
 using namespace slade;
 
@@ -56,6 +57,17 @@ uint16_t n_cvars;
 // -----------------------------------------------------------------------------
 namespace
 {
+// -----------------------------------------------------------------------------
+// Returns the CVar lookup table, keyed by name.
+// This is a function-local static since CVars are added during static
+// initialisation (in any order across translation units)
+// -----------------------------------------------------------------------------
+std::unordered_map<string_view, CVar*>& cvarIndex()
+{
+	static std::unordered_map<string_view, CVar*> index;
+	return index;
+}
+
 // -----------------------------------------------------------------------------
 // Adds a CVar to the CVar list
 // -----------------------------------------------------------------------------
@@ -64,6 +76,10 @@ void addCVarList(CVar* cvar)
 	cvars          = (CVar**)realloc(cvars, (n_cvars + 1) * sizeof(CVar*));
 	cvars[n_cvars] = cvar;
 	n_cvars++;
+
+	// The name is never changed after the cvar is added, so it can be used as
+	// the key directly
+	cvarIndex().emplace(cvar->name, cvar);
 }
 } // namespace
 
@@ -134,15 +150,11 @@ CStringCVar::CStringCVar(const string& NAME, const string& defval, uint16_t FLAG
 // -----------------------------------------------------------------------------
 // Finds a CVar by name
 // -----------------------------------------------------------------------------
-CVar* CVar::get(const string& name)
+CVar* CVar::get(string_view name)
 {
-	for (unsigned i = 0; i < n_cvars; ++i)
-	{
-		if (cvars[i]->name == name)
-			return cvars[i];
-	}
-
-	return nullptr;
+	auto& index = cvarIndex();
+	auto  i     = index.find(name);
+	return i != index.end() ? i->second : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -209,24 +221,21 @@ string CVar::writeAll()
 // Reads [value] into the CVar with matching [name],
 // or does nothing if no CVar [name] exists
 // -----------------------------------------------------------------------------
-void CVar::set(const string& name, const string& value)
+void CVar::set(string_view name, const string& value)
 {
-	for (unsigned i = 0; i < n_cvars; ++i)
-	{
-		auto cvar = cvars[i];
-		if (name == cvar->name)
-		{
-			if (cvar->type == Type::Integer)
-				*dynamic_cast<CIntCVar*>(cvar) = strutil::asInt(value);
+	auto cvar = get(name);
+	if (!cvar)
+		return;
 
-			if (cvar->type == Type::Boolean)
-				*dynamic_cast<CBoolCVar*>(cvar) = strutil::asBoolean(value);
+	if (cvar->type == Type::Integer)
+		*dynamic_cast<CIntCVar*>(cvar) = strutil::asInt(value);
 
-			if (cvar->type == Type::Float)
-				*dynamic_cast<CFloatCVar*>(cvar) = strutil::asFloat(value);
+	if (cvar->type == Type::Boolean)
+		*dynamic_cast<CBoolCVar*>(cvar) = strutil::asBoolean(value);
 
-			if (cvar->type == Type::String)
-				*dynamic_cast<CStringCVar*>(cvar) = value;
-		}
-	}
+	if (cvar->type == Type::Float)
+		*dynamic_cast<CFloatCVar*>(cvar) = strutil::asFloat(value);
+
+	if (cvar->type == Type::String)
+		*dynamic_cast<CStringCVar*>(cvar) = value;
 }
@@ -47,8 +47,8 @@ public:
 
 	// Static functions
 	static string writeAll();
-	static void   set(const string& cvar_name, const string& value);
-	static CVar*  get(const string& cvar_name);
+	static void   set(string_view cvar_name, const string& value);
+	static CVar*  get(string_view cvar_name); // The returned pointer stays valid, so it can be kept for repeated access
 	static void   putList(vector<string>& list);
 };
 
@@ -0,0 +1,257 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryJobs.cpp
+// Description: Runs per-entry operations (eg. PNG optimization or exporting)
+//              concurrently on the worker thread pool, collecting the results
+//              of each into a single report
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryJobs.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/ThreadPool.h"
+#include "General/UI.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace slade;
+using namespace entryjobs;
+
+
+// -----------------------------------------------------------------------------
+//
+// Report Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the number of jobs in the report that failed
+// -----------------------------------------------------------------------------
+unsigned Report::nFailed() const
+{
+	unsigned count = 0;
+	for (const auto& result : results)
+		if (!result.success)
+			++count;
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a list of all failed entries and their messages, one per line
+// -----------------------------------------------------------------------------
+string Report::failures() const
+{
+	string list;
+	for (const auto& result : results)
+		if (!result.success)
+			list += fmt::format("{}: {}\n", result.entry->name(), result.message);
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Writes a summary of the report for [operation] to the log, along with any
+// failures
+// -----------------------------------------------------------------------------
+void Report::logSummary(string_view operation) const
+{
+	log::info("{}: {} entries processed, {} failed", operation, results.size(), nFailed());
+	for (const auto& result : results)
+		if (!result.success)
+			log::error("{}: {}: {}", operation, result.entry->name(), result.message);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryJobs Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs [func] for each of [entries], with at most [max_jobs] running at once
+// (or as many as there are worker threads if 0). Blocks until all jobs are
+// finished, then writes any modified data back to the entries in order and
+// returns the results. If [show_progress] is true, the splash window progress
+// bar is updated while waiting.
+// [func] must be safe to call concurrently for different entries
+// -----------------------------------------------------------------------------
+Report entryjobs::run(
+	const vector<ArchiveEntry*>&     entries,
+	const std::function<void(Job&)>& func,
+	unsigned                         max_jobs,
+	bool                             show_progress)
+{
+	// Shared state, kept alive by any tasks that start after all jobs have
+	// been claimed
+	struct State
+	{
+		vector<Job>             jobs;
+		std::atomic<size_t>     next{ 0 };
+		std::atomic<size_t>     done{ 0 };
+		std::mutex              mutex;
+		std::condition_variable cv;
+	};
+	auto state = std::make_shared<State>();
+
+	// Load entry data (archives can't be read from multiple threads)
+	auto count = entries.size();
+	state->jobs.resize(count);
+	for (size_t a = 0; a < count; a++)
+	{
+		auto& job = state->jobs[a];
+		job.entry = entries[a];
+		job.index = a;
+		job.data.importMem(entries[a]->data());
+	}
+
+	auto run_job = [&func](Job& job) {
+		try
+		{
+			func(job);
+		}
+		catch (const std::exception& ex)
+		{
+			job.success = false;
+			job.message = ex.what();
+		}
+	};
+
+	// Determine number of jobs to run at once
+	unsigned n_threads = threadpool::isWorkerThread() ? 0 : threadpool::numWorkers();
+	if (max_jobs > 0)
+		n_threads = std::min(n_threads, max_jobs);
+	n_threads = static_cast<unsigned>(std::min<size_t>(n_threads, count));
+
+	if (n_threads <= 1)
+	{
+		// Just run everything on this thread
+		for (size_t a = 0; a < count; a++)
+		{
+			if (show_progress)
+				ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(count));
+			run_job(state->jobs[a]);
+		}
+	}
+	else
+	{
+		auto run_jobs = [state, count, &run_job]() {
+			while (true)
+			{
+				const auto index = state->next++;
+				if (index >= count)
+					return;
+
+				run_job(state->jobs[index]);
+
+				if (++state->done == count)
+				{
+					std::lock_guard lock(state->mutex);
+					state->cv.notify_all();
+				}
+			}
+		};
+
+		for (unsigned a = 0; a < n_threads; a++)
+			threadpool::enqueue(run_jobs);
+
+		// Wait for all jobs to finish, updating progress periodically
+		std::unique_lock lock(state->mutex);
+		while (!state->cv.wait_for(
+			lock, std::chrono::milliseconds(100), [&state, count] { return state->done == count; }))
+		{
+			if (show_progress)
+			{
+				lock.unlock();
+				ui::setSplashProgress(static_cast<float>(state->done) / static_cast<float>(count));
+				lock.lock();
+			}
+		}
+	}
+
+	if (show_progress)
+		ui::setSplashProgress(1.0f);
+
+	// Write back modified data and collect results, in order
+	Report report;
+	report.results.reserve(count);
+	for (auto& job : state->jobs)
+	{
+		if (job.success && job.modified)
+			job.entry->importMemChunk(job.data);
+
+		report.results.push_back({ job.entry, job.success, std::move(job.message) });
+	}
+
+	return report;
+}
+
+// -----------------------------------------------------------------------------
+// Runs [command] as an external process (without a console window or any
+// output) and waits for it to finish. Unlike wxExecute, this can be called
+// from worker threads. Returns true if the process exited successfully
+// -----------------------------------------------------------------------------
+bool entryjobs::runProcess(const string& command)
+{
+#ifdef _WIN32
+	auto                cmd_line = wxString::FromUTF8(command.c_str()).ToStdWstring();
+	STARTUPINFOW        startup_info{};
+	PROCESS_INFORMATION process_info{};
+	startup_info.cb = sizeof(startup_info);
+	if (!CreateProcessW(
+			nullptr,
+			cmd_line.data(),
+			nullptr,
+			nullptr,
+			FALSE,
+			CREATE_NO_WINDOW,
+			nullptr,
+			nullptr,
+			&startup_info,
+			&process_info))
+		return false;
+
+	WaitForSingleObject(process_info.hProcess, INFINITE);
+	DWORD exit_code = 1;
+	GetExitCodeProcess(process_info.hProcess, &exit_code);
+	CloseHandle(process_info.hThread);
+	CloseHandle(process_info.hProcess);
+
+	return exit_code == 0;
+#else
+	return std::system((command + " >/dev/null 2>&1").c_str()) == 0;
+#endif
+}
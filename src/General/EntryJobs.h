@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Utility/MemChunk.h"
+#include <functional>
+
+namespace slade
+{
+class ArchiveEntry;
+
+// Runs an operation over a list of entries concurrently on the worker thread
+// pool. The data of each entry is loaded on the calling thread first, and each
+// job gets its own (copy-on-write) copy of it to work with. Jobs may read but
+// must not modify their entry - any data changed by a job is written back to
+// the entries in list order on the calling thread once all jobs are finished
+namespace entryjobs
+{
+	struct Job
+	{
+		ArchiveEntry* entry = nullptr;
+		size_t        index = 0; // Index of the entry in the list given to run
+		MemChunk      data;      // The entry's data, written back to the entry if [modified] is set
+		bool          modified = false;
+		bool          success  = true;
+		string        message;
+	};
+
+	struct Result
+	{
+		ArchiveEntry* entry   = nullptr;
+		bool          success = true;
+		string        message;
+	};
+
+	struct Report
+	{
+		vector<Result> results;
+
+		unsigned nFailed() const;
+		string   failures() const;
+		void     logSummary(string_view operation) const;
+	};
+
+	Report run(
+		const vector<ArchiveEntry*>&     entries,
+		const std::function<void(Job&)>& func,
+		unsigned                         max_jobs      = 0,
+		bool                             show_progress = false);
+	bool runProcess(const string& command);
+} // namespace entryjobs
+} // namespace slade
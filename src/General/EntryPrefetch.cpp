@@ -0,0 +1,280 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryPrefetch.cpp
+// Description: Loads the data of entries that are likely to be opened soon
+//              (eg. the entries after the current selection in an archive)
+//              and decodes any images on the worker thread pool, so they can
+//              be shown without delay when opened
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryPrefetch.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/ThreadPool.h"
+#include "Graphics/SImage/SImage.h"
+#include "Utility/StringUtils.h"
+#include <atomic>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, entry_prefetch_count, 4, CVar::Flag::Save) // Number of entries after the selection to prefetch (0 = off)
+namespace slade::entryprefetch
+{
+// An image being (or that has been) decoded in the background
+struct PrefetchedImage
+{
+	weak_ptr<ArchiveEntry> entry;
+	MemChunk               data; // Shares the entry's data, so any change to the entry's data can be detected
+	string                 format_hint;
+	SImage                 image;
+	bool                   ok         = false;
+	bool                   persistent = false; // Kept until used, see entryprefetch::add
+	std::atomic<bool>      done{ false };
+};
+
+vector<shared_ptr<PrefetchedImage>> prefetched;
+} // namespace slade::entryprefetch
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the prefetched image for [entry], if any exists and the entry's data
+// hasn't changed since it was prefetched
+// -----------------------------------------------------------------------------
+shared_ptr<entryprefetch::PrefetchedImage> findPrefetched(ArchiveEntry* entry)
+{
+	for (const auto& item : entryprefetch::prefetched)
+		if (item->entry.lock().get() == entry && item->data.sharesData(entry->data(false)))
+			return item;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the data of [entry] and starts decoding it on the worker thread pool
+// if it is an image. Returns the (pending) prefetched image, or nullptr if the
+// entry isn't a prefetchable image
+// -----------------------------------------------------------------------------
+shared_ptr<entryprefetch::PrefetchedImage> startDecode(ArchiveEntry* entry)
+{
+	// Load entry data (also detects the entry type if it was deferred)
+	entry->data();
+	if (!entryprefetch::canDecode(*entry))
+		return nullptr;
+
+	auto item   = std::make_shared<entryprefetch::PrefetchedImage>();
+	item->entry = entry->getShared();
+
+	// Data mapped from the archive file is copied here (see MemChunk::importMem),
+	// so a persistent item never keeps the file mapped while it is saved
+	item->data.importMem(entry->data());
+	if (item->data.isMapped())
+		item->data.detach();
+	item->format_hint = entry->type()->extraProps().getOr<string>("image_format", {});
+
+	// Decode the image in the background (after any work that is actually
+	// needed now, since it may not be used)
+	threadpool::enqueue(
+		[item]() {
+			item->ok   = item->image.open(item->data, 0, item->format_hint);
+			item->done = true;
+		},
+		threadpool::Priority::Background);
+
+	return item;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryPrefetch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is an image that can be decoded in the background
+// (from its data alone, via SImage::open). Fonts and Jaguar Doom formats are
+// excluded since they are loaded specially (see misc::loadImageFromEntry)
+// -----------------------------------------------------------------------------
+bool entryprefetch::canDecode(ArchiveEntry& entry)
+{
+	if (entry.size() == 0 || !entry.type()->extraProps().contains("image"))
+		return false;
+
+	const auto& format = entry.type()->formatId();
+	return !strutil::startsWith(format, "font_") && !strutil::startsWith(format, "img_jaguar_");
+}
+
+// -----------------------------------------------------------------------------
+// Loads the data of all given [entries] and starts decoding any images among
+// them on the worker thread pool. Anything previously prefetched for entries
+// not in [entries] is discarded (unless it was added via entryprefetch::add).
+// Must be called from the main thread, since loading entry data from an
+// archive isn't thread-safe
+// -----------------------------------------------------------------------------
+void entryprefetch::prefetch(const vector<ArchiveEntry*>& entries)
+{
+	vector<shared_ptr<PrefetchedImage>> keep;
+	for (auto entry : entries)
+	{
+		if (!entry)
+			continue;
+
+		// Keep existing prefetched image for the entry if it's still valid,
+		// otherwise start decoding it
+		auto item = findPrefetched(entry);
+		if (!item)
+			item = startDecode(entry);
+		if (item && std::find(keep.begin(), keep.end(), item) == keep.end())
+			keep.push_back(item);
+	}
+
+	// Keep anything added to be used later
+	for (const auto& item : prefetched)
+		if (item->persistent && std::find(keep.begin(), keep.end(), item) == keep.end())
+			keep.push_back(item);
+
+	prefetched = std::move(keep);
+}
+
+// -----------------------------------------------------------------------------
+// Prefetches the entries after [entry] in its directory (as many as the
+// entry_prefetch_count cvar), and the one before it
+// -----------------------------------------------------------------------------
+void entryprefetch::prefetchAround(ArchiveEntry* entry)
+{
+	if (!entry || entry_prefetch_count <= 0)
+		return;
+
+	vector<ArchiveEntry*> entries;
+	auto                  next = entry->nextEntry();
+	for (int a = 0; next && a < entry_prefetch_count; a++)
+	{
+		entries.push_back(next);
+		next = next->nextEntry();
+	}
+	entries.push_back(entry->prevEntry());
+
+	prefetch(entries);
+}
+
+// -----------------------------------------------------------------------------
+// Starts decoding [entry] on the worker thread pool (if it is an image),
+// without discarding anything already prefetched. The decoded image is kept
+// until it is used by getImage, or removed.
+// Must be called from the main thread, see prefetch
+// -----------------------------------------------------------------------------
+void entryprefetch::add(ArchiveEntry* entry)
+{
+	if (!entry)
+		return;
+
+	auto item = findPrefetched(entry);
+	if (!item)
+	{
+		item = startDecode(entry);
+		if (!item)
+			return;
+
+		prefetched.push_back(item);
+	}
+
+	item->persistent = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is currently being decoded in the background
+// -----------------------------------------------------------------------------
+bool entryprefetch::isDecoding(ArchiveEntry* entry)
+{
+	auto item = findPrefetched(entry);
+	return item && !item->done;
+}
+
+// -----------------------------------------------------------------------------
+// Copies the image prefetched for [entry] to [image], if it has finished
+// decoding and the entry's data hasn't changed since.
+// Returns false if no such image is available
+// -----------------------------------------------------------------------------
+bool entryprefetch::getImage(ArchiveEntry* entry, SImage& image)
+{
+	for (auto i = prefetched.begin(); i != prefetched.end(); ++i)
+	{
+		auto& item = *i;
+		if (item->entry.lock().get() != entry)
+			continue;
+
+		if (!item->done || !item->ok || !item->data.sharesData(entry->data(false)))
+			return false;
+
+		image.copyImage(&item->image);
+
+		// Images added to be used later are only needed once
+		if (item->persistent)
+			prefetched.erase(i);
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Discards anything prefetched for [entry]
+// -----------------------------------------------------------------------------
+void entryprefetch::remove(ArchiveEntry* entry)
+{
+	prefetched.erase(
+		std::remove_if(
+			prefetched.begin(),
+			prefetched.end(),
+			[entry](const auto& item) { return item->entry.lock().get() == entry; }),
+		prefetched.end());
+}
+
+// -----------------------------------------------------------------------------
+// Discards all prefetched data
+// -----------------------------------------------------------------------------
+void entryprefetch::clear()
+{
+	prefetched.clear();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class SImage;
+
+namespace entryprefetch
+{
+	bool canDecode(ArchiveEntry& entry);
+	void prefetch(const vector<ArchiveEntry*>& entries);
+	void prefetchAround(ArchiveEntry* entry);
+	void add(ArchiveEntry* entry);
+	bool isDecoding(ArchiveEntry* entry);
+	bool getImage(ArchiveEntry* entry, SImage& image);
+	void remove(ArchiveEntry* entry);
+	void clear();
+} // namespace entryprefetch
+} // namespace slade
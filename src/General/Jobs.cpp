@@ -0,0 +1,172 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Jobs.cpp
+// Description: Job system for running background work on the worker thread
+//              pool, with cancellation, progress reporting and continuations
+//              run on the UI thread
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Jobs.h"
+
+using namespace slade;
+using namespace jobs;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+vector<shared_ptr<Job>> active_jobs;
+std::mutex              active_mutex;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Job Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the job's current progress message
+// -----------------------------------------------------------------------------
+string Job::message() const
+{
+	std::lock_guard lock(message_mutex_);
+	return message_;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the job's current [progress] (0-1) and progress [message]
+// -----------------------------------------------------------------------------
+void Job::setProgress(float progress, string_view message)
+{
+	progress_ = progress;
+
+	std::lock_guard lock(message_mutex_);
+	message_ = message;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Jobs Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Queues [work] to run on the worker thread pool with the given [priority],
+// and returns the job's handle. [work] should check Job::isCancelled
+// periodically if it runs for a while, and return early if it is set.
+// If given, [on_finished] is run on the UI thread after [work] returns, unless
+// the job was cancelled by then
+// -----------------------------------------------------------------------------
+shared_ptr<Job> jobs::run(std::function<void(Job&)> work, std::function<void()> on_finished, Priority priority)
+{
+	auto job = std::make_shared<Job>();
+	{
+		std::lock_guard lock(active_mutex);
+		active_jobs.push_back(job);
+	}
+
+	threadpool::enqueue(
+		[job, work = std::move(work), on_finished = std::move(on_finished)]() {
+			// Skip the work if the job was cancelled while queued
+			if (!job->isCancelled())
+			{
+				try
+				{
+					work(*job);
+				}
+				catch (const std::exception& ex)
+				{
+					log::error("Background job failed: {}", ex.what());
+				}
+			}
+
+			job->finished_ = true;
+			{
+				std::lock_guard lock(active_mutex);
+				VECTOR_REMOVE(active_jobs, job);
+			}
+
+			if (on_finished && !job->isCancelled())
+				postToUI([job, on_finished]() {
+					// Check again, the job may have been cancelled on the UI thread since
+					if (!job->isCancelled())
+						on_finished();
+				});
+		},
+		priority);
+
+	return job;
+}
+
+// -----------------------------------------------------------------------------
+// Runs [func] on the UI (main) thread, after any pending events are processed.
+// [func] is discarded if the app is shutting down
+// -----------------------------------------------------------------------------
+void jobs::postToUI(const std::function<void()>& func)
+{
+	if (wxTheApp)
+		wxTheApp->CallAfter(func);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the current thread is the UI (main) thread
+// -----------------------------------------------------------------------------
+bool jobs::isUIThread()
+{
+	return wxThread::IsMain();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of jobs that are queued or running
+// -----------------------------------------------------------------------------
+unsigned jobs::numActive()
+{
+	std::lock_guard lock(active_mutex);
+	return static_cast<unsigned>(active_jobs.size());
+}
+
+// -----------------------------------------------------------------------------
+// Cancels all queued and running jobs (eg. before shutting down the thread
+// pool, so that queued jobs are skipped)
+// -----------------------------------------------------------------------------
+void jobs::cancelAll()
+{
+	std::lock_guard lock(active_mutex);
+	for (auto& job : active_jobs)
+		job->cancel();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "General/ThreadPool.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace slade
+{
+// Runs background work on the worker thread pool, with a handle to cancel each
+// job and check its progress. A job can have a continuation that is run on the
+// UI thread when it finishes, which is skipped if the job was cancelled - so a
+// window that cancels its jobs when destroyed can safely use itself in them
+namespace jobs
+{
+	using Priority = threadpool::Priority;
+
+	class Job
+	{
+	public:
+		bool   isCancelled() const { return cancelled_; }
+		bool   isFinished() const { return finished_; }
+		float  progress() const { return progress_; }
+		string message() const;
+
+		void cancel() { cancelled_ = true; }
+		void setProgress(float progress) { progress_ = progress; }
+		void setProgress(float progress, string_view message);
+
+	private:
+		std::atomic<bool>  cancelled_{ false };
+		std::atomic<bool>  finished_{ false };
+		std::atomic<float> progress_{ 0.f };
+		mutable std::mutex message_mutex_;
+		string             message_;
+
+		friend shared_ptr<Job> run(std::function<void(Job&)>, std::function<void()>, Priority);
+	};
+
+	shared_ptr<Job> run(
+		std::function<void(Job&)> work,
+		std::function<void()>     on_finished = {},
+		Priority                  priority    = Priority::Normal);
+	void     postToUI(const std::function<void()>& func);
+	bool     isUIThread();
+	unsigned numActive();
+	void     cancelAll();
+} // namespace jobs
+} // namespace slade
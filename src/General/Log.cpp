@@ -31,9 +31,12 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "App.h"
+#include <condition_variable>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 using namespace slade;
 
@@ -46,9 +49,25 @@ using namespace slade;
 namespace slade::log
 {
 vector<Message> log;
+unsigned        log_start = 0; // Index of the first message in [log] out of all messages logged
 std::ofstream   log_file;
+std::mutex      log_mutex; // Messages can be logged from worker threads
+
+// Log file writer thread
+vector<Message>         file_queue; // Messages waiting to be written to the log file
+std::mutex              file_mutex;
+std::condition_variable file_cv;
+std::thread             file_thread;
+bool                    file_stop = false;
+
+// Makes sure the writer thread is stopped if log::close wasn't called
+struct FileThreadStopper
+{
+	~FileThreadStopper() { close(); }
+} file_thread_stopper;
 } // namespace slade::log
 CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
+CVAR(Int, log_history_size, 50000, CVar::Flag::Save) // Maximum number of log messages kept in memory
 
 
 // -----------------------------------------------------------------------------
@@ -118,6 +137,81 @@ string log::Message::formattedMessageLine() const
 // Log Namespace Functions
 //
 // -----------------------------------------------------------------------------
+namespace slade::log
+{
+// -----------------------------------------------------------------------------
+// Writes queued messages to the log file until stopped.
+// Runs on its own thread, so formatting and writing messages to the file
+// doesn't slow down the threads logging them
+// -----------------------------------------------------------------------------
+void writeLogFile()
+{
+	vector<Message> messages;
+	string          text;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(file_mutex);
+			file_cv.wait(lock, [] { return file_stop || !file_queue.empty(); });
+			if (file_queue.empty())
+				return; // Stopped and nothing left to write
+			messages.swap(file_queue);
+		}
+
+		text.clear();
+		for (const auto& msg : messages)
+		{
+			text += msg.formattedMessageLine();
+			text += '\n';
+		}
+		messages.clear();
+
+		// Flushed after each batch so the log is up to date if SLADE crashes
+		sf::err() << text;
+		sf::err().flush();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds a message [text] of [type] to the log history, and queues it to be
+// written to the log file
+// -----------------------------------------------------------------------------
+void addMessage(MessageType type, string_view text)
+{
+	auto t = std::time(nullptr);
+
+	std::lock_guard<std::mutex> lock(log_mutex);
+
+	// Add log message
+	log.emplace_back(text, type, *std::localtime(&t));
+
+	// Queue for writing to log file (or write directly if the writer thread
+	// isn't running)
+	if (type != MessageType::Console)
+	{
+		if (file_thread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> file_lock(file_mutex);
+				file_queue.push_back(log.back());
+			}
+			file_cv.notify_one();
+		}
+		else if (log_file.is_open())
+			sf::err() << log.back().formattedMessageLine() << "\n";
+	}
+
+	// Remove the oldest messages if the history is too large (a quarter of
+	// them at a time, so this doesn't happen on every message)
+	auto max_size = static_cast<unsigned>(std::max(100, static_cast<int>(log_history_size)));
+	if (log.size() > max_size)
+	{
+		auto n_remove = log.size() - max_size + max_size / 4;
+		log.erase(log.begin(), log.begin() + n_remove);
+		log_start += n_remove;
+	}
+}
+} // namespace slade::log
 
 
 // -----------------------------------------------------------------------------
@@ -129,6 +223,10 @@ void log::init()
 	log_file.open(app::path("slade3.log", app::Dir::User));
 	sf::err().rdbuf(log_file.rdbuf());
 
+	// Start log file writer thread
+	if (log_file.is_open())
+		file_thread = std::thread(&writeLogFile);
+
 	// Write logfile header
 	auto t  = std::time(nullptr);
 	auto tm = std::localtime(&t);
@@ -158,13 +256,51 @@ void log::init()
 }
 
 // -----------------------------------------------------------------------------
-// Returns the log message history
+// Stops the log file writer thread, once all queued messages are written
+// -----------------------------------------------------------------------------
+void log::close()
+{
+	// Nothing can be logged until the thread is stopped
+	std::lock_guard<std::mutex> lock(log_mutex);
+	if (!file_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> file_lock(file_mutex);
+		file_stop = true;
+	}
+	file_cv.notify_one();
+	file_thread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the log message history (only the most recent log_history_size
+// messages are kept).
+// Note that this isn't safe to use while messages could be logged from other
+// threads, use messagesSince instead
 // -----------------------------------------------------------------------------
 const vector<log::Message>& log::history()
 {
 	return log;
 }
 
+// -----------------------------------------------------------------------------
+// Returns copies of the messages logged since message [index] (out of all
+// messages that have been logged), and sets [index] to the index of the next
+// message to be logged. Messages no longer in the history are skipped
+// -----------------------------------------------------------------------------
+vector<log::Message> log::messagesSince(unsigned& index)
+{
+	std::lock_guard<std::mutex> lock(log_mutex);
+
+	auto start = std::max(index, log_start) - log_start;
+	index      = log_start + log.size();
+	if (start >= log.size())
+		return {};
+
+	return { log.begin() + start, log.end() };
+}
+
 // -----------------------------------------------------------------------------
 // Returns the current log verbosity level, log messages with a higher level
 // than the current verbosity will not be logged
@@ -187,18 +323,16 @@ void log::setVerbosity(int verbosity)
 // -----------------------------------------------------------------------------
 void log::message(MessageType type, string_view text)
 {
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	addMessage(type, text);
 }
 
 void log::message(MessageType type, int level, string_view text, fmt::format_args args)
 {
-	message(type, level, fmt::vformat(text, args));
+	// Check level before formatting the message
+	if (level > log_verbosity)
+		return;
+
+	addMessage(type, fmt::vformat(text, args));
 }
 
 void log::message(MessageType type, string_view text, fmt::format_args args)
@@ -211,6 +345,8 @@ void log::message(MessageType type, string_view text, fmt::format_args args)
 // -----------------------------------------------------------------------------
 vector<log::Message*> log::since(time_t time, MessageType type)
 {
+	std::lock_guard<std::mutex> lock(log_mutex);
+
 	vector<Message*> list;
 	for (auto& msg : log)
 		if (mktime(&msg.timestamp) >= time && (type == MessageType::Any || msg.type == type))
@@ -223,7 +359,7 @@ vector<log::Message*> log::since(time_t time, MessageType type)
 // -----------------------------------------------------------------------------
 void log::debug(int level, const wxString& text)
 {
-	if (global::debug)
+	if (global::debug && level <= log_verbosity)
 		message(MessageType::Debug, level, text.ToStdString());
 }
 
@@ -238,7 +374,7 @@ void log::debug(const wxString& text)
 
 void log::debug(int level, string_view text, fmt::format_args args)
 {
-	if (global::debug)
+	if (global::debug && level <= log_verbosity)
 		message(MessageType::Debug, level, text, args);
 }
 
@@ -256,11 +392,5 @@ void log::message(MessageType type, int level, string_view text)
 	if (level > log_verbosity)
 		return;
 
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	addMessage(type, text);
 }
@@ -30,9 +30,11 @@ namespace log
 	};
 
 	const vector<Message>& history();
+	vector<Message>        messagesSince(unsigned& index);
 	int                    verbosity();
 	void                   setVerbosity(int verbosity);
 	void                   init();
+	void                   close();
 	void                   message(MessageType type, int level, string_view text);
 	void                   message(MessageType type, string_view text);
 	void                   message(MessageType type, int level, string_view text, fmt::format_args args);
@@ -43,13 +45,26 @@ namespace log
 	// Message shortcuts by type
 	// -----------------------------------------------------------------------------
 
-	inline void info(int level, const wxString& text) { message(MessageType::Info, level, text.ToStdString()); }
+	// (with a level, the level is checked before converting the text)
+	inline void info(int level, const wxString& text)
+	{
+		if (level <= verbosity())
+			message(MessageType::Info, level, text.ToStdString());
+	}
 	inline void info(const wxString& text) { message(MessageType::Info, text.ToStdString()); }
 
-	inline void warning(int level, const wxString& text) { message(MessageType::Warning, level, text.ToStdString()); }
+	inline void warning(int level, const wxString& text)
+	{
+		if (level <= verbosity())
+			message(MessageType::Warning, level, text.ToStdString());
+	}
 	inline void warning(const wxString& text) { message(MessageType::Warning, text.ToStdString()); }
 
-	inline void error(int level, const wxString& text) { message(MessageType::Error, level, text.ToStdString()); }
+	inline void error(int level, const wxString& text)
+	{
+		if (level <= verbosity())
+			message(MessageType::Error, level, text.ToStdString());
+	}
 	inline void error(const wxString& text) { message(MessageType::Error, text.ToStdString()); }
 
 	// These can't be inline, need access to Global::debug
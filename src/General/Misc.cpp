@@ -34,8 +34,10 @@
 #include "General/Misc.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveEntry.h"
+#include "General/EntryPrefetch.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
+#include "Utility/Compression.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
 
@@ -73,6 +75,8 @@ bool misc::loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index)
 	if (!entry)
 		return false;
 
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Graphics);
+
 	// Detect entry type if it isn't already
 	if (entry->type() == EntryType::unknownType())
 		EntryType::detectEntryType(*entry);
@@ -132,6 +136,10 @@ bool misc::loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index)
 		return image->loadJaguarTexture(entry->rawData(), entry->size(), dimensions.x, dimensions.y);
 	}
 
+	// Use the image if it was already decoded in the background
+	if (index == 0 && entryprefetch::getImage(entry, *image))
+		return true;
+
 	// Firstly try SIFormat system
 	if (image->open(entry->data(), index, format_hint))
 		return true;
@@ -446,64 +454,14 @@ void misc::doMassRename(vector<string>& names, string_view name_filter)
 	}
 }
 
-
-
-// CRC-32 stuff
-
-/* Table of CRCs of all 8-bit messages. */
-uint32_t crc_table[256];
-
-/* Flag: has the table been computed? Initially false. */
-int crc_table_computed = 0;
-
-/* Make the table for a fast CRC. */
-void make_crc_table(void)
-{
-	uint32_t c;
-	int      n, k;
-
-	for (n = 0; n < 256; n++)
-	{
-		c = (uint32_t)n;
-
-		for (k = 0; k < 8; k++)
-		{
-			if (c & 1)
-				c = 0xedb88320L ^ (c >> 1);
-			else
-				c = c >> 1;
-		}
-
-		crc_table[n] = c;
-	}
-
-	crc_table_computed = 1;
-}
-
-/* Update a running CRC with the bytes buf[0..len-1]--the CRC
-should be initialized to all 1's, and the transmitted value
-is the 1's complement of the final running CRC (see the
-crc() routine below)). */
-uint32_t update_crc(uint32_t crc, const uint8_t* buf, uint32_t len)
-{
-	uint32_t c = crc;
-
-	if (!crc_table_computed)
-		make_crc_table();
-
-	for (uint32_t n = 0; n < len; n++)
-		c = crc_table[(c ^ buf[n]) & 0xff] ^ (c >> 8);
-
-	return c;
-}
-
-/* Return the CRC of the bytes buf[0..len-1]. */
+// -----------------------------------------------------------------------------
+// Returns the CRC-32 of [len] bytes of [buf]
+// -----------------------------------------------------------------------------
 uint32_t misc::crc(const uint8_t* buf, uint32_t len)
 {
-	return update_crc(0xffffffffL, buf, len) ^ 0xffffffffL;
+	return compression::crc(buf, len);
 }
 
-
 // -----------------------------------------------------------------------------
 // Find the given name in a texture lump and returns a point2_t which contains
 // the dimensions.
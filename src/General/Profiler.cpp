@@ -0,0 +1,244 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Profiler.cpp
+// Description: Simple scoped-timer profiler. Subsystems mark named zones with
+//              PROFILE_ZONE, which are recorded while a capture is running
+//              (started/stopped via console commands). Captured timings can be
+//              logged as a summary per zone, or written as a Chrome trace
+//              (chrome://tracing) JSON file
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Profiler.h"
+#include "General/Console.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace slade::profiler
+{
+std::atomic<bool> capturing{ false };
+} // namespace slade::profiler
+namespace
+{
+struct ZoneEvent
+{
+	const char* name;
+	size_t      thread;
+	int64_t     start; // us since the capture started
+	int64_t     duration;
+};
+
+std::mutex        events_mutex;
+vector<ZoneEvent> events;
+int64_t           capture_start = 0;
+int64_t           capture_end   = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// profiler Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the current time in microseconds (steady clock)
+// -----------------------------------------------------------------------------
+int64_t profiler::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+// -----------------------------------------------------------------------------
+// Records a zone called [name] on the current thread, from [start] to now
+// -----------------------------------------------------------------------------
+void profiler::record(const char* name, int64_t start)
+{
+	auto end    = now();
+	auto thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+	std::lock_guard<std::mutex> lock(events_mutex);
+	if (!capturing)
+		return;
+
+	events.push_back({ name, thread, start - capture_start, end - start });
+}
+
+// -----------------------------------------------------------------------------
+// Starts capturing zone timings, discarding any previously captured
+// -----------------------------------------------------------------------------
+void profiler::start()
+{
+	std::lock_guard<std::mutex> lock(events_mutex);
+	events.clear();
+	capture_start = now();
+	capturing     = true;
+}
+
+// -----------------------------------------------------------------------------
+// Stops capturing zone timings
+// -----------------------------------------------------------------------------
+void profiler::stop()
+{
+	std::lock_guard<std::mutex> lock(events_mutex);
+	if (capturing)
+		capture_end = now();
+	capturing = false;
+}
+
+// -----------------------------------------------------------------------------
+// Logs the number of times each zone was recorded and its total, average and
+// maximum times, sorted by total time
+// -----------------------------------------------------------------------------
+void profiler::logSummary()
+{
+	struct ZoneStats
+	{
+		const char* name;
+		unsigned    count = 0;
+		int64_t     total = 0;
+		int64_t     max   = 0;
+	};
+
+	vector<ZoneStats> stats;
+	int64_t           duration;
+	{
+		std::lock_guard<std::mutex> lock(events_mutex);
+
+		std::unordered_map<const char*, size_t> index;
+		for (const auto& event : events)
+		{
+			auto i = index.emplace(event.name, stats.size());
+			if (i.second)
+				stats.push_back({ event.name });
+
+			auto& zone = stats[i.first->second];
+			zone.count++;
+			zone.total += event.duration;
+			zone.max = std::max(zone.max, event.duration);
+		}
+
+		duration = (capturing ? now() : capture_end) - capture_start;
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const ZoneStats& left, const ZoneStats& right) {
+		return left.total > right.total;
+	});
+
+	log::console(fmt::format("Profile ({:1.2f}ms captured):", static_cast<double>(duration) / 1000.));
+	log::console(fmt::format("{:>8} {:>12} {:>10} {:>10}  Zone", "Count", "Total (ms)", "Avg (ms)", "Max (ms)"));
+	for (const auto& zone : stats)
+		log::console(fmt::format(
+			"{:>8} {:>12.2f} {:>10.3f} {:>10.3f}  {}",
+			zone.count,
+			static_cast<double>(zone.total) / 1000.,
+			static_cast<double>(zone.total) / 1000. / zone.count,
+			static_cast<double>(zone.max) / 1000.,
+			zone.name));
+}
+
+// -----------------------------------------------------------------------------
+// Writes the captured zone timings to [filename] in the Chrome trace event
+// JSON format (can be viewed in chrome://tracing or similar).
+// Returns false if the file couldn't be written
+// -----------------------------------------------------------------------------
+bool profiler::writeTrace(string_view filename)
+{
+	std::ofstream file{ string{ filename } };
+	if (!file.is_open())
+		return false;
+
+	std::lock_guard<std::mutex> lock(events_mutex);
+
+	file << "{\"traceEvents\":[\n";
+	for (size_t a = 0; a < events.size(); ++a)
+	{
+		string name = events[a].name;
+		strutil::replaceIP(name, "\\", "\\\\");
+		strutil::replaceIP(name, "\"", "\\\"");
+
+		file << fmt::format(
+			"{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{}}}{}\n",
+			name,
+			events[a].thread,
+			events[a].start,
+			events[a].duration,
+			a + 1 < events.size() ? "," : "");
+	}
+	file << "]}\n";
+
+	return file.good();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(profile_start, 0, false)
+{
+	profiler::start();
+	log::console("Profiling started");
+}
+
+CONSOLE_COMMAND(profile_stop, 0, false)
+{
+	profiler::stop();
+	log::console("Profiling stopped");
+}
+
+CONSOLE_COMMAND(profile_dump, 0, false)
+{
+	profiler::logSummary();
+}
+
+CONSOLE_COMMAND(profile_trace, 1, false)
+{
+	if (profiler::writeTrace(args[0]))
+		log::console(fmt::format("Wrote profile trace to \"{}\"", args[0]));
+	else
+		log::error("Unable to write profile trace to \"{}\"", args[0]);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+namespace slade::profiler
+{
+extern std::atomic<bool> capturing;
+
+int64_t now();
+void    record(const char* name, int64_t start);
+
+// Timing of a named scope (zone), recorded when it ends if a capture was
+// running when it started (otherwise it costs only a flag check).
+// Zone names must be string literals, since only the pointer is stored
+class Zone
+{
+public:
+	Zone(const char* name) : name_{ name }
+	{
+		if (capturing.load(std::memory_order_relaxed))
+			start_ = now();
+	}
+	~Zone()
+	{
+		if (start_ >= 0)
+			record(name_, start_);
+	}
+
+	Zone(const Zone&) = delete;
+	Zone& operator=(const Zone&) = delete;
+
+private:
+	const char* name_;
+	int64_t     start_ = -1; // Start time (us), negative if not capturing
+};
+
+void start();
+void stop();
+void logSummary();
+bool writeTrace(string_view filename);
+} // namespace slade::profiler
+
+// Times the rest of the current scope as a profiler zone called [name]
+#define PROFILE_ZONE_CONCAT2(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b)  PROFILE_ZONE_CONCAT2(a, b)
+#define PROFILE_ZONE(name)         slade::profiler::Zone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
@@ -36,6 +36,7 @@
 #include "App.h"
 #include "Archive/ArchiveManager.h"
 #include "General/Console.h"
+#include "General/Profiler.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "Utility/StringUtils.h"
@@ -80,6 +81,22 @@ void removeEntryFromMap(EntryResourceMap& map, const string& name, shared_ptr<Ar
 	else
 		map[name].remove(entry);
 }
+
+// ----------------------------------------------------------------------------
+// Returns true if the resource [name] in [map] contains [entry]
+// ----------------------------------------------------------------------------
+bool mapContains(const EntryResourceMap& map, const string& name, const ArchiveEntry* entry)
+{
+	const auto i = map.find(name);
+	return i != map.end() && i->second.contains(entry);
+}
+
+// Resource type flags (see ResourceManager::resourceFlags)
+constexpr unsigned res_palette = 1;
+constexpr unsigned res_patch   = 2;
+constexpr unsigned res_flat    = 4;
+constexpr unsigned res_satex   = 8;
+constexpr unsigned res_hires   = 16;
 } // namespace
 
 
@@ -131,6 +148,18 @@ void EntryResource::removeArchive(Archive* archive)
 	}
 }
 
+// ----------------------------------------------------------------------------
+// Returns true if [entry] is part of this resource
+// ----------------------------------------------------------------------------
+bool EntryResource::contains(const ArchiveEntry* entry) const
+{
+	for (const auto& e : entries_)
+		if (e.lock().get() == entry)
+			return true;
+
+	return false;
+}
+
 // ----------------------------------------------------------------------------
 // Gets the most relevant entry for this resource, depending on [priority] and
 // [nspace]. If [priority] is set, this will prioritize entries from the
@@ -239,6 +268,8 @@ void TextureResource::remove(Archive* parent)
 // -----------------------------------------------------------------------------
 void ResourceManager::addArchive(Archive* archive)
 {
+	PROFILE_ZONE("ResourceManager::addArchive");
+
 	// Check archive was given
 	if (!archive)
 		return;
@@ -256,14 +287,8 @@ void ResourceManager::addArchive(Archive* archive)
 	archive->signals().entry_state_changed.connect([this](Archive&, ArchiveEntry& e) { updateEntry(e, true, true); });
 
 	// Update entries from the archive when renamed
-	archive->signals().entry_renamed.connect([this](Archive&, ArchiveEntry& entry, string_view prev_name) {
-		auto prev_upper   = strutil::upper(prev_name);
-		auto entry_shared = entry.getShared();
-		removeEntry(entry_shared, prev_upper);
-		addEntry(entry_shared);
-
-		signals_.resources_updated();
-	});
+	archive->signals().entry_renamed.connect(
+		[this](Archive&, ArchiveEntry& entry, string_view prev_name) { updateEntry(entry, true, true, prev_name); });
 
 	// Announce resource update
 	signals_.resources_updated();
@@ -295,9 +320,19 @@ void ResourceManager::removeArchive(Archive* archive)
 	removeArchiveFromMap(satextures_, archive);
 	removeArchiveFromMap(satextures_fp_, archive);
 
+	// Remove from hi-res textures
+	removeArchiveFromMap(hires_, archive);
+
 	// Remove any textures in the archive
 	for (auto& i : composites_)
 		i.second.remove(archive);
+	for (auto i = composite_sources_.begin(); i != composite_sources_.end();)
+	{
+		if (i->second.archive == archive)
+			i = composite_sources_.erase(i);
+		else
+			++i;
+	}
 
 	// Announce resource update
 	signals_.resources_updated();
@@ -448,10 +483,14 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 
 		// Add all textures to resources
 		CTexture* tex;
+		auto&     source = composite_sources_[entry.get()];
+		source.archive   = entry->parent();
+		source.names.clear();
 		for (unsigned a = 0; a < tx.size(); a++)
 		{
 			tex = tx.texture(a);
 			composites_[tex->name()].add(tex, entry->parent());
+			source.names.push_back(tex->name());
 		}
 	}
 }
@@ -465,7 +504,8 @@ void ResourceManager::removeEntry(shared_ptr<ArchiveEntry>& entry, string_view e
 		return;
 
 	// Get resource name (extension cut, uppercase)
-	auto name = strutil::truncate(entry_name.empty() ? entry->upperNameNoExt() : entry_name, 8);
+	auto name = strutil::truncate(
+		entry_name.empty() ? entry->upperNameNoExt() : entry_name.substr(0, entry_name.find('.')), 8);
 	auto path = entry->path(true);
 	strutil::upperIP(path);
 	path.erase(0, 1);
@@ -489,25 +529,18 @@ void ResourceManager::removeEntry(shared_ptr<ArchiveEntry>& entry, string_view e
 	removeEntryFromMap(satextures_, name, entry, full_check);
 	removeEntryFromMap(satextures_fp_, path, entry, full_check);
 
-	// Check for TEXTUREx entry
-	int txentry = 0;
-	if (entry->type()->id() == "texturex")
-		txentry = 1;
-	else if (entry->type()->id() == "zdtextures")
-		txentry = 2;
-	if (txentry > 0)
+	// Remove from hi-res textures
+	removeEntryFromMap(hires_, name, entry, full_check);
+
+	// Remove any textures added from the entry (if it is a TEXTUREx entry).
+	// The texture names are taken from when it was added, since the entry
+	// data may have changed since then
+	if (const auto source = composite_sources_.find(entry.get()); source != composite_sources_.end())
 	{
-		// Read texture list
-		TextureXList tx;
-		PatchTable   ptable;
-		if (txentry == 1)
-			tx.readTEXTUREXData(entry.get(), ptable);
-		else
-			tx.readTEXTURESData(entry.get());
+		for (const auto& tex_name : source->second.names)
+			composites_[tex_name].remove(source->second.archive);
 
-		// Remove all texture resources
-		for (unsigned a = 0; a < tx.size(); a++)
-			composites_[tx.texture(a)->name()].remove(entry->parent());
+		composite_sources_.erase(source);
 	}
 }
 
@@ -762,15 +795,84 @@ ArchiveEntry* ResourceManager::getHiresEntry(string_view texture, Archive* prior
 	return hires_[strutil::upper(texture)].getEntry(priority, "hires", true);
 }
 
-void ResourceManager::updateEntry(ArchiveEntry& entry, bool remove, bool add)
+// -----------------------------------------------------------------------------
+// Returns flags for the resource types [entry] is currently managed as, under
+// resource [name]
+// -----------------------------------------------------------------------------
+unsigned ResourceManager::resourceFlags(const ArchiveEntry* entry, const string& name) const
+{
+	unsigned flags = 0;
+	if (mapContains(palettes_, name, entry))
+		flags |= res_palette;
+	if (mapContains(patches_, name, entry))
+		flags |= res_patch;
+	if (mapContains(flats_, name, entry))
+		flags |= res_flat;
+	if (mapContains(satextures_, name, entry))
+		flags |= res_satex;
+	if (mapContains(hires_, name, entry))
+		flags |= res_hires;
+
+	return flags;
+}
+
+// -----------------------------------------------------------------------------
+// Updates resources for [entry], removing its previous resources (under
+// [prev_name] if it was renamed) if [remove] is true and re-adding them if
+// [add] is true. Announces only the resources that changed, if any
+// -----------------------------------------------------------------------------
+void ResourceManager::updateEntry(ArchiveEntry& entry, bool remove, bool add, string_view prev_name)
 {
 	auto sptr = entry.getShared();
+
+	// Get resource names before and after
+	const auto name = strutil::truncate(entry.upperNameNoExt(), 8);
+	auto       prev = name;
+	if (!prev_name.empty())
+	{
+		const auto prev_upper = strutil::upper(prev_name);
+		prev                  = strutil::truncate(prev_upper.substr(0, prev_upper.find('.')), 8);
+	}
+
+	// Remove previous resources
+	unsigned       prev_flags = 0;
+	vector<string> prev_textures;
 	if (remove)
-		removeEntry(sptr);
+	{
+		prev_flags = resourceFlags(&entry, prev);
+		if (const auto source = composite_sources_.find(&entry); source != composite_sources_.end())
+			prev_textures = source->second.names;
+
+		removeEntry(sptr, prev);
+	}
+
+	// Add current resources
+	unsigned flags = 0;
 	if (add)
+	{
 		addEntry(sptr);
+		flags = resourceFlags(&entry, name);
+	}
+	const auto source = composite_sources_.find(&entry);
 
-	signals_.resources_updated();
+	// Nothing to announce if the entry isn't (and wasn't) a resource
+	const bool composite = !prev_textures.empty() || source != composite_sources_.end();
+	if (prev_flags == 0 && flags == 0 && !composite)
+		return;
+
+	// Build list of changed resources
+	ResourceChange change;
+	change.list_changed    = prev_flags != flags || prev != name || composite;
+	change.palette_changed = ((prev_flags | flags) & res_palette) != 0;
+	if (prev_flags != 0)
+		change.names.push_back(prev);
+	if (flags != 0 && (prev_flags == 0 || prev != name))
+		change.names.push_back(name);
+	change.names.insert(change.names.end(), prev_textures.begin(), prev_textures.end());
+	if (source != composite_sources_.end())
+		change.names.insert(change.names.end(), source->second.names.begin(), source->second.names.end());
+
+	signals_.resources_changed(change);
 }
 
 
@@ -33,6 +33,7 @@ public:
 	void add(shared_ptr<ArchiveEntry>& entry);
 	void remove(shared_ptr<ArchiveEntry>& entry);
 	void removeArchive(Archive* archive);
+	bool contains(const ArchiveEntry* entry) const;
 
 	int length() const override { return entries_.size(); }
 
@@ -73,6 +74,15 @@ typedef std::map<string, TextureResource> TextureResourceMap;
 class ResourceManager
 {
 public:
+	// Describes an incremental change to resources, from a single entry being
+	// added, removed, modified or renamed
+	struct ResourceChange
+	{
+		vector<string> names;                   // Names of affected resources (uppercase)
+		bool           list_changed    = false; // True if resources were added, removed or renamed
+		bool           palette_changed = false; // True if a palette was affected
+	};
+
 	ResourceManager()  = default;
 	~ResourceManager() = default;
 
@@ -106,7 +116,8 @@ public:
 	// Signals
 	struct Signals
 	{
-		sigslot::signal<> resources_updated;
+		sigslot::signal<>                      resources_updated; // Everything should be refreshed
+		sigslot::signal<const ResourceChange&> resources_changed; // Only [names] should be refreshed
 	};
 	Signals& signals() { return signals_; }
 
@@ -127,8 +138,17 @@ private:
 	TextureResourceMap composites_; // Composite textures (defined in a TEXTUREx/TEXTURES lump)
 	Signals            signals_;
 
+	// Names of composite textures added from each TEXTUREx/TEXTURES entry
+	struct CompositeSource
+	{
+		Archive*       archive;
+		vector<string> names;
+	};
+	std::map<ArchiveEntry*, CompositeSource> composite_sources_;
+
 	static string doom64_hash_table_[65536];
 
-	void updateEntry(ArchiveEntry& entry, bool remove, bool add);
+	unsigned resourceFlags(const ArchiveEntry* entry, const string& name) const;
+	void     updateEntry(ArchiveEntry& entry, bool remove, bool add, string_view prev_name = {});
 };
 } // namespace slade
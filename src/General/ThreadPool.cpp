@@ -0,0 +1,280 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThreadPool.cpp
+// Description: A simple shared pool of worker threads, used to split up
+//              independent chunks of work (eg. entry type detection)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, threadpool_workers, 0, CVar::Flag::Save)
+namespace slade::threadpool
+{
+constexpr unsigned                n_priorities = 3;
+vector<std::thread>               workers;
+std::deque<std::function<void()>> tasks[n_priorities]; // One queue per Priority
+std::mutex                        tasks_mutex;
+std::condition_variable           tasks_cv;
+std::atomic<unsigned>             n_busy{ 0 }; // Tasks queued or running on a worker
+bool                              started   = false;
+bool                              stopping  = false;
+thread_local bool                 is_worker = false;
+} // namespace slade::threadpool
+
+
+// -----------------------------------------------------------------------------
+//
+// ThreadPool Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace slade::threadpool
+{
+// -----------------------------------------------------------------------------
+// Returns the highest priority queue with any tasks in it, or null if there are
+// no queued tasks. Must be called with [tasks_mutex] locked
+// -----------------------------------------------------------------------------
+std::deque<std::function<void()>>* nextQueue()
+{
+	for (auto& queue : tasks)
+		if (!queue.empty())
+			return &queue;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread loop, runs queued tasks until the pool is shut down
+// -----------------------------------------------------------------------------
+void workerLoop()
+{
+	is_worker = true;
+
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock                   lock(tasks_mutex);
+			std::deque<std::function<void()>>* queue = nullptr;
+			tasks_cv.wait(lock, [&queue] { return (queue = nextQueue()) || stopping; });
+			if (!queue)
+				return;
+
+			task = std::move(queue->front());
+			queue->pop_front();
+		}
+
+		task();
+		--n_busy;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Starts the worker threads if they haven't been already.
+// Must be called with [tasks_mutex] locked
+// -----------------------------------------------------------------------------
+void startWorkers()
+{
+	if (started || stopping)
+		return;
+
+	started = true;
+
+	// Use the configured number of workers, or one less than the number of
+	// hardware threads (the calling thread also does work) by default
+	unsigned count = threadpool_workers > 0 ? static_cast<unsigned>(threadpool_workers) : 0;
+	if (count == 0)
+	{
+		auto hw = std::thread::hardware_concurrency();
+		count   = hw > 1 ? hw - 1 : 0;
+	}
+
+	for (unsigned a = 0; a < count; a++)
+		workers.emplace_back(workerLoop);
+
+	log::info(2, "Started {} worker threads", count);
+}
+} // namespace slade::threadpool
+
+// -----------------------------------------------------------------------------
+// Returns the number of worker threads in the pool
+// -----------------------------------------------------------------------------
+unsigned threadpool::numWorkers()
+{
+	std::lock_guard lock(tasks_mutex);
+	startWorkers();
+	return static_cast<unsigned>(workers.size());
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the current thread is one of the pool's worker threads
+// -----------------------------------------------------------------------------
+bool threadpool::isWorkerThread()
+{
+	return is_worker;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of tasks currently queued or running on the worker threads
+// -----------------------------------------------------------------------------
+unsigned threadpool::numBusy()
+{
+	return n_busy;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [task] to be run on a worker thread, after any queued tasks of the
+// same or higher [priority]. If there are no worker threads available, [task]
+// is run immediately on the calling thread
+// -----------------------------------------------------------------------------
+void threadpool::enqueue(const std::function<void()>& task, Priority priority)
+{
+	{
+		std::lock_guard lock(tasks_mutex);
+		startWorkers();
+		if (!workers.empty())
+		{
+			tasks[static_cast<unsigned>(priority)].push_back(task);
+			++n_busy;
+			tasks_cv.notify_one();
+			return;
+		}
+	}
+
+	task();
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each index from 0 to [count]-1, split over the worker
+// threads in chunks of [grain] indices. The calling thread also processes
+// chunks, and this function does not return until all indices are done.
+// [func] must be safe to call concurrently for different indices.
+// Any exception thrown by [func] is rethrown on the calling thread
+// -----------------------------------------------------------------------------
+void threadpool::parallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain)
+{
+	if (count == 0)
+		return;
+	if (grain == 0)
+		grain = 1;
+
+	// Run serially if there's only one chunk or no workers. This can be called
+	// from a worker thread (eg. by a background job): the calling thread only
+	// ever waits for chunks other threads are already processing, and helper
+	// tasks are queued at high priority so free workers pick them up first
+	const auto n_chunks  = (count + grain - 1) / grain;
+	const auto n_helpers = std::min<size_t>(n_chunks - 1, numWorkers());
+	if (n_helpers == 0)
+	{
+		for (size_t a = 0; a < count; a++)
+			func(a);
+		return;
+	}
+
+	// Shared state, kept alive by any helper tasks that start after all
+	// chunks have been claimed
+	struct State
+	{
+		std::atomic<size_t>     next{ 0 };
+		std::atomic<size_t>     done{ 0 };
+		std::mutex              mutex;
+		std::condition_variable cv;
+		std::exception_ptr      error;
+	};
+	auto state = std::make_shared<State>();
+
+	auto run_chunks = [state, count, grain, &func]() {
+		while (true)
+		{
+			const auto start = state->next.fetch_add(grain);
+			if (start >= count)
+				return;
+
+			const auto end = std::min(start + grain, count);
+			try
+			{
+				for (auto a = start; a < end; a++)
+					func(a);
+			}
+			catch (...)
+			{
+				std::lock_guard lock(state->mutex);
+				if (!state->error)
+					state->error = std::current_exception();
+			}
+
+			if (state->done.fetch_add(end - start) + (end - start) == count)
+			{
+				std::lock_guard lock(state->mutex);
+				state->cv.notify_all();
+			}
+		}
+	};
+
+	for (size_t a = 0; a < n_helpers; a++)
+		enqueue(run_chunks, Priority::High);
+
+	// Process chunks on this thread too, then wait for the rest to finish
+	run_chunks();
+	{
+		std::unique_lock lock(state->mutex);
+		state->cv.wait(lock, [&state, count] { return state->done == count; });
+	}
+
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+// -----------------------------------------------------------------------------
+// Stops and joins all worker threads. Any tasks still queued are run first
+// -----------------------------------------------------------------------------
+void threadpool::shutdown()
+{
+	{
+		std::lock_guard lock(tasks_mutex);
+		stopping = true;
+	}
+	tasks_cv.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+	workers.clear();
+}
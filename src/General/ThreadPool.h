@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+
+namespace slade::threadpool
+{
+// Queued tasks are run in order of priority, then in the order they were queued
+enum class Priority
+{
+	High,      // Work something is waiting on (eg. parallelFor chunks)
+	Normal,    // General background work
+	Background // Work that can wait (eg. update checks)
+};
+
+unsigned numWorkers();
+bool     isWorkerThread();
+unsigned numBusy();
+void     enqueue(const std::function<void()>& task, Priority priority = Priority::Normal);
+void     parallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain = 1);
+void     shutdown();
+} // namespace slade::threadpool
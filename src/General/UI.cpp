@@ -49,6 +49,11 @@ namespace slade::ui
 unique_ptr<SplashWindow> splash_window;
 bool                     splash_enabled = true;
 
+// Background task progress
+thread_local ProgressHandler task_progress_handler;
+thread_local float           task_progress = 0.0f;
+thread_local string          task_progress_message;
+
 // Pixel sizes/scale
 double scale = 1.;
 int    px_pad_small;
@@ -74,6 +79,16 @@ bool isMainThread()
 {
 	return app::mainThreadId() == std::this_thread::get_id();
 }
+
+// -----------------------------------------------------------------------------
+// Passes the current thread's task progress to its progress handler, throwing
+// TaskCancelled if the handler reports the task was cancelled
+// -----------------------------------------------------------------------------
+void reportTaskProgress()
+{
+	if (!task_progress_handler(task_progress, task_progress_message))
+		throw TaskCancelled{};
+}
 } // namespace slade::ui
 
 // -----------------------------------------------------------------------------
@@ -161,7 +176,12 @@ void ui::setSplashMessage(string_view message)
 // -----------------------------------------------------------------------------
 void ui::setSplashProgressMessage(string_view message)
 {
-	if (splash_window && isMainThread())
+	if (task_progress_handler)
+	{
+		task_progress_message = message;
+		reportTaskProgress();
+	}
+	else if (splash_window && isMainThread())
 		splash_window->setProgressMessage(wxString{ message.data(), message.size() });
 }
 
@@ -170,10 +190,30 @@ void ui::setSplashProgressMessage(string_view message)
 // -----------------------------------------------------------------------------
 void ui::setSplashProgress(float progress)
 {
-	if (splash_window && isMainThread())
+	if (task_progress_handler)
+	{
+		task_progress = progress;
+		reportTaskProgress();
+	}
+	else if (splash_window && isMainThread())
 		splash_window->setProgress(progress);
 }
 
+// -----------------------------------------------------------------------------
+// Sets the progress [handler] for the current thread, used to report progress
+// of (and cancel) background tasks that update the splash window progress.
+// Has no effect on the main thread
+// -----------------------------------------------------------------------------
+void ui::setThreadProgressHandler(ProgressHandler handler)
+{
+	if (isMainThread())
+		return;
+
+	task_progress_handler = std::move(handler);
+	task_progress         = 0.0f;
+	task_progress_message.clear();
+}
+
 // -----------------------------------------------------------------------------
 // Sets the mouse cursor for [window]
 // -----------------------------------------------------------------------------
@@ -15,6 +15,16 @@ void  setSplashMessage(string_view message);
 void  setSplashProgressMessage(string_view message);
 void  setSplashProgress(float progress);
 
+// Background task progress.
+// If a progress handler is set for the current (non-UI) thread, splash progress
+// updates from that thread are passed to it instead. If the handler returns
+// false the task has been cancelled, and TaskCancelled is thrown to abort it
+struct TaskCancelled
+{
+};
+typedef std::function<bool(float progress, string_view message)> ProgressHandler;
+void setThreadProgressHandler(ProgressHandler handler);
+
 // Mouse Cursor
 enum class MouseCursor
 {
@@ -31,6 +31,12 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "General/UndoRedo.h"
+#include "App.h"
+#include "General/ThreadPool.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+#include <filesystem>
+#include <wx/process.h>
 
 using namespace slade;
 
@@ -40,9 +46,15 @@ using namespace slade;
 // Variables
 //
 // -----------------------------------------------------------------------------
+CVAR(Int, undo_memory_limit, 512, CVar::Flag::Save) // Max MB used by undo levels before the oldest are removed (0 = none)
+CVAR(Bool, undo_journal, true, CVar::Flag::Save) // Write undo levels to a journal file, old levels are unloaded from memory first when over undo_memory_limit
 namespace
 {
 UndoManager* current_undo_manager = nullptr;
+unsigned     n_journals           = 0;
+
+// The undo journal is only compacted once it is at least this size (in bytes)
+constexpr unsigned journal_compact_size = 64 * 1024 * 1024;
 } // namespace
 
 
@@ -105,19 +117,149 @@ bool UndoLevel::doRedo()
 }
 
 // -----------------------------------------------------------------------------
-// Reads the undo level from a file
+// Writes the undo level (name, timestamp and the data of each step) to [mc]
 // -----------------------------------------------------------------------------
-bool UndoLevel::readFile(string_view filename) const
+bool UndoLevel::write(MemChunk& mc) const
 {
+	// Write steps first (each to its own chunk), so the level can be written
+	// to [mc] all at once
+	vector<MemChunk> steps(undo_steps_.size());
+	uint32_t         size = sizeof(uint32_t) + name_.size() + sizeof(int64_t) + sizeof(uint32_t);
+	for (unsigned a = 0; a < undo_steps_.size(); a++)
+	{
+		if (!undo_steps_[a]->writeFile(steps[a]))
+			return false;
+		size += sizeof(uint32_t) + steps[a].size();
+	}
+	if (!mc.reSize(mc.currentPos() + size))
+		return false;
+
+	// Header
+	uint32_t name_size = name_.size();
+	int64_t  time      = timestamp_.GetValue().GetValue();
+	uint32_t n_steps   = undo_steps_.size();
+	mc.write(&name_size, sizeof(uint32_t));
+	mc.write(name_.data(), name_size);
+	mc.write(&time, sizeof(int64_t));
+	mc.write(&n_steps, sizeof(uint32_t));
+
+	// Steps
+	for (auto& step : steps)
+	{
+		uint32_t step_size = step.size();
+		mc.write(&step_size, sizeof(uint32_t));
+		if (step_size > 0)
+			mc.write(step.data(), step_size);
+	}
+
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads the data of each step in the undo level from [mc], which must have
+// been written by write for this level (reloading it if it was unloaded)
+// -----------------------------------------------------------------------------
+bool UndoLevel::read(MemChunk& mc)
+{
+	// Header
+	uint32_t name_size = 0;
+	if (!mc.read(&name_size, sizeof(uint32_t)) || !mc.seek(name_size + sizeof(int64_t)))
+		return false;
+	uint32_t n_steps = 0;
+	if (!mc.read(&n_steps, sizeof(uint32_t)) || n_steps != undo_steps_.size())
+		return false;
+
+	// Steps
+	for (auto& step : undo_steps_)
+	{
+		uint32_t step_size = 0;
+		if (!mc.read(&step_size, sizeof(uint32_t)) || mc.currentPos() + step_size > mc.size())
+			return false;
+
+		MemChunk step_data;
+		if (step_size > 0)
+			step_data.importShared(mc, mc.currentPos(), step_size);
+		mc.seek(step_size);
+		if (!step->readFile(step_data))
+			return false;
+	}
+
+	unloaded_ = false;
+	updateMemoryUsage();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the undo level from a file
+// -----------------------------------------------------------------------------
+bool UndoLevel::readFile(string_view filename)
+{
+	MemChunk mc;
+	if (!mc.importFile(filename))
+		return false;
+
+	return read(mc);
+}
+
 // -----------------------------------------------------------------------------
 // Writes the undo level to a file
 // -----------------------------------------------------------------------------
 bool UndoLevel::writeFile(string_view filename) const
 {
-	return true;
+	MemChunk mc;
+	if (!write(mc))
+		return false;
+
+	return mc.exportFile(filename);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the position of the level's data in the undo journal, a [size] of 0
+// means it isn't in the journal (or was changed after it was written)
+// -----------------------------------------------------------------------------
+void UndoLevel::setJournaled(unsigned offset, unsigned size)
+{
+	journal_offset_ = offset;
+	journal_size_   = size;
+}
+
+// -----------------------------------------------------------------------------
+// Frees the data of all steps in the level, which must already have been
+// written to the undo journal
+// -----------------------------------------------------------------------------
+void UndoLevel::unload()
+{
+	if (unloaded_ || !isJournaled())
+		return;
+
+	for (auto& undo_step : undo_steps_)
+		undo_step->unload();
+
+	unloaded_ = true;
+	updateMemoryUsage();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the (approximate) memory used by all steps in this level
+// -----------------------------------------------------------------------------
+void UndoLevel::updateMemoryUsage()
+{
+	memory_usage_ = 0;
+	for (const auto& undo_step : undo_steps_)
+		memory_usage_ += undo_step->memoryUsage();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the level has finished recording, lets all steps know and
+// updates the level's memory usage
+// -----------------------------------------------------------------------------
+void UndoLevel::recorded()
+{
+	for (auto& undo_step : undo_steps_)
+		undo_step->recorded();
+
+	updateMemoryUsage();
 }
 
 // -----------------------------------------------------------------------------
@@ -137,6 +279,168 @@ void UndoLevel::createMerged(vector<unique_ptr<UndoLevel>>& levels)
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// UndoJournal Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// UndoJournal class constructor, each journal gets its own file (named by
+// process id so that multiple running instances don't conflict)
+// -----------------------------------------------------------------------------
+UndoJournal::UndoJournal()
+{
+	// Clean up after any instances that didn't exit normally first
+	if (n_journals == 0)
+		removeStale();
+
+	filename_ = app::path(fmt::format("undo_{}_{}.journal", wxGetProcessId(), n_journals++), app::Dir::Temp);
+}
+
+// -----------------------------------------------------------------------------
+// UndoJournal class destructor, waits for any pending writes and removes the
+// journal file
+// -----------------------------------------------------------------------------
+UndoJournal::~UndoJournal()
+{
+	waitForWrites();
+	if (fileutil::fileExists(filename_))
+		fileutil::removeFile(filename_);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the size of the journal file, including any queued writes
+// -----------------------------------------------------------------------------
+unsigned UndoJournal::size()
+{
+	std::lock_guard lock(mutex_);
+	return size_;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [data] to be appended to the journal file in the background, and sets
+// [offset] to the position it will be written at.
+// Returns false if writing to the journal previously failed or it is full
+// -----------------------------------------------------------------------------
+bool UndoJournal::append(MemChunk data, unsigned& offset)
+{
+	std::lock_guard lock(mutex_);
+	if (failed_ || data.size() == 0 || data.size() > std::numeric_limits<unsigned>::max() - size_)
+		return false;
+
+	offset = size_;
+	size_ += data.size();
+	pending_.emplace_back(offset, std::move(data));
+	if (!writing_)
+	{
+		writing_ = true;
+		threadpool::enqueue([this]() { writePending(); });
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads [size] bytes at [offset] in the journal file into [mc], waiting for the
+// data to be written first if needed
+// -----------------------------------------------------------------------------
+bool UndoJournal::read(unsigned offset, unsigned size, MemChunk& mc)
+{
+	{
+		std::unique_lock lock(mutex_);
+		cv_written_.wait(lock, [this, offset, size] { return failed_ || written_ >= offset + size; });
+		if (written_ < offset + size)
+			return false;
+	}
+
+	return mc.importFile(filename_, offset, size);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the [size] bytes at [offset] have been written to the
+// journal file
+// -----------------------------------------------------------------------------
+bool UndoJournal::isWritten(unsigned offset, unsigned size)
+{
+	std::lock_guard lock(mutex_);
+	return written_ >= offset + size;
+}
+
+// -----------------------------------------------------------------------------
+// Waits for any queued data to finish being written
+// -----------------------------------------------------------------------------
+void UndoJournal::waitForWrites()
+{
+	std::unique_lock lock(mutex_);
+	cv_written_.wait(lock, [this] { return !writing_; });
+}
+
+// -----------------------------------------------------------------------------
+// Appends all queued data to the journal file, called on a worker thread
+// -----------------------------------------------------------------------------
+void UndoJournal::writePending()
+{
+	while (true)
+	{
+		std::pair<unsigned, MemChunk> data;
+		{
+			std::lock_guard lock(mutex_);
+			if (pending_.empty() || failed_)
+			{
+				pending_.clear();
+				writing_ = false;
+				cv_written_.notify_all();
+				return;
+			}
+
+			data = std::move(pending_.front());
+			pending_.pop_front();
+		}
+
+		// Write (the file is closed after each write so the data can be read
+		// back as soon as written_ is updated)
+		bool ok;
+		{
+			SFile file(filename_, SFile::Mode::Append);
+			ok = file.isOpen() && file.write(data.second.data(), data.second.size());
+		}
+		if (!ok)
+			log::warning("Unable to write to undo journal \"{}\"", filename_);
+
+		std::lock_guard lock(mutex_);
+		if (ok)
+			written_ = data.first + data.second.size();
+		else
+			failed_ = true;
+		cv_written_.notify_all();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Removes any journal files left in the temp folder by instances of SLADE that
+// are no longer running (ie. that crashed or were killed)
+// -----------------------------------------------------------------------------
+void UndoJournal::removeStale()
+{
+	std::error_code ec;
+	for (const auto& item : std::filesystem::directory_iterator{ app::path("", app::Dir::Temp), ec })
+	{
+		const auto name = item.path().filename().string();
+		if (!strutil::startsWith(name, "undo_") || !strutil::endsWith(name, ".journal"))
+			continue;
+
+		const auto pid = strtoul(name.c_str() + 5, nullptr, 10);
+		if (pid == 0 || pid == wxGetProcessId() || wxProcess::Exists(static_cast<int>(pid)))
+			continue;
+
+		if (std::filesystem::remove(item.path(), ec))
+			log::info(2, "Removed stale undo journal \"{}\"", name);
+	}
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // UndoManager Class Functions
@@ -191,10 +495,14 @@ void UndoManager::endRecord(bool success)
 
 	// Add current level to levels
 	// log::info(1, "Recording undo level \"%s\" succeeded", current_level->getName());
+	current_level_->recorded();
 	undo_levels_.push_back(std::move(current_level_));
 	current_level_.reset(nullptr);
 	current_level_index_ = undo_levels_.size() - 1;
 
+	// Unload/remove old levels if over the memory limit
+	trimToMemoryLimit();
+
 	// Clear current undo manager
 	current_undo_manager = nullptr;
 
@@ -241,12 +549,21 @@ string UndoManager::undo()
 	if (current_level_index_ < 0)
 		return "";
 
+	// Reload undo level data if needed. If it can't be read the level can't be
+	// undone, and neither can any before it
+	auto& level = undo_levels_[current_level_index_];
+	if (!loadLevel(*level))
+	{
+		removeLevels(0, current_level_index_ + 1);
+		return "";
+	}
+
 	// Perform undo level
 	undo_running_        = true;
 	current_undo_manager = this;
-	auto& level          = undo_levels_[current_level_index_];
 	if (!level->doUndo())
 		log::warning("Undo operation \"{}\" failed", level->name());
+	level->setJournaled(0, 0); // Journaled data is out of date now
 	undo_running_        = false;
 	current_undo_manager = nullptr;
 	current_level_index_--;
@@ -269,12 +586,21 @@ string UndoManager::redo()
 	if (current_level_index_ == (int)undo_levels_.size() - 1 || undo_levels_.empty())
 		return "";
 
+	// Reload redo level data if needed. If it can't be read the level can't be
+	// redone, and neither can any after it
+	auto& level = undo_levels_[current_level_index_ + 1];
+	if (!loadLevel(*level))
+	{
+		removeLevels(current_level_index_ + 1, undo_levels_.size());
+		return "";
+	}
+
 	// Perform redo level
 	current_level_index_++;
 	undo_running_        = true;
 	current_undo_manager = this;
-	auto& level          = undo_levels_[current_level_index_];
 	level->doRedo();
+	level->setJournaled(0, 0); // Journaled data is out of date now
 	undo_running_        = false;
 	current_undo_manager = nullptr;
 
@@ -305,6 +631,8 @@ void UndoManager::clearToResetPoint()
 
 	current_level_ = nullptr;
 	undo_running_  = false;
+
+	compactJournal();
 }
 
 // -----------------------------------------------------------------------------
@@ -315,6 +643,7 @@ void UndoManager::clear()
 	// Reset
 	undo_levels_.clear();
 	current_level_.reset(nullptr);
+	journal_.reset();
 	current_level_index_ = -1;
 	undo_running_        = false;
 }
@@ -328,9 +657,15 @@ bool UndoManager::createMergedLevel(UndoManager* manager, string_view name)
 	if (manager->undo_levels_.empty())
 		return false;
 
+	// Reload any unloaded levels to merge
+	for (auto& level : manager->undo_levels_)
+		if (!manager->loadLevel(*level))
+			return false;
+
 	// Create merged undo level from manager
 	auto merged = std::make_unique<UndoLevel>(name);
 	merged->createMerged(manager->undo_levels_);
+	merged->updateMemoryUsage();
 	manager->clear();
 
 	// Add undo level
@@ -338,9 +673,205 @@ bool UndoManager::createMergedLevel(UndoManager* manager, string_view name)
 	current_level_.reset(nullptr);
 	current_level_index_ = undo_levels_.size() - 1;
 
+	trimToMemoryLimit();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (approximate) memory used by all undo levels
+// -----------------------------------------------------------------------------
+size_t UndoManager::memoryUsage() const
+{
+	size_t total = 0;
+	for (const auto& level : undo_levels_)
+		total += level->memoryUsage();
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [level] to be written to the undo journal (if enabled and it isn't
+// already in the journal). Returns true if the level is in the journal
+// -----------------------------------------------------------------------------
+bool UndoManager::journalLevel(UndoLevel& level)
+{
+	if (level.isJournaled())
+		return true;
+	if (!undo_journal || level.isUnloaded())
+		return false;
+
+	MemChunk data;
+	if (!level.write(data))
+		return false;
+
+	if (!journal_)
+		journal_ = std::make_unique<UndoJournal>();
+
+	unsigned offset;
+	unsigned size = data.size();
+	if (!journal_->append(std::move(data), offset))
+		return false;
+
+	level.setJournaled(offset, size);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the data of [level] back from the undo journal if it was unloaded.
+// Returns false if it couldn't be read
+// -----------------------------------------------------------------------------
+bool UndoManager::loadLevel(UndoLevel& level)
+{
+	if (!level.isUnloaded())
+		return true;
+
+	MemChunk data;
+	if (!journal_ || !journal_->read(level.journalOffset(), level.journalSize(), data) || !level.read(data))
+	{
+		log::error("Unable to read undo level \"{}\" from journal", level.name());
+		return false;
+	}
+
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Removes undo levels from [start] up to (not including) [end], updating the
+// current level index and reset point to match
+// -----------------------------------------------------------------------------
+void UndoManager::removeLevels(unsigned start, unsigned end)
+{
+	if (start >= end || end > undo_levels_.size())
+		return;
+
+	undo_levels_.erase(undo_levels_.begin() + start, undo_levels_.begin() + end);
+
+	// Indices within the removed levels move to the level before them
+	const auto n_removed = static_cast<int>(end - start);
+	const auto first     = static_cast<int>(start);
+	if (current_level_index_ >= first)
+		current_level_index_ = std::max(current_level_index_ - n_removed, first - 1);
+	if (reset_point_ >= first)
+		reset_point_ = std::max(reset_point_ - n_removed, first - 1);
+}
+
+// -----------------------------------------------------------------------------
+// Unloads (if journaled) or removes the oldest undo levels until the memory
+// used by all levels is within the undo_memory_limit cvar. Levels are only
+// removed if unloading them isn't enough (the newest level is always kept)
+// -----------------------------------------------------------------------------
+void UndoManager::trimToMemoryLimit()
+{
+	if (undo_memory_limit <= 0)
+		return;
+
+	const auto limit = static_cast<size_t>(undo_memory_limit) * 1024 * 1024;
+	auto       total = memoryUsage();
+	if (total <= limit)
+		return;
+
+	// Write levels before the current level to the journal, oldest first,
+	// until unloading them would be enough
+	vector<UndoLevel*> to_unload;
+	auto               unloaded_total = total;
+	for (int a = 0; a < current_level_index_ && unloaded_total > limit; a++)
+	{
+		auto& level = undo_levels_[a];
+		if (level->isUnloaded() || !journalLevel(*level))
+			continue;
+
+		to_unload.push_back(level.get());
+		unloaded_total -= level->memoryUsage();
+	}
+
+	// Unload them, only once their data has actually been written
+	if (!to_unload.empty())
+	{
+		journal_->waitForWrites();
+		for (auto level : to_unload)
+		{
+			if (!journal_->isWritten(level->journalOffset(), level->journalSize()))
+				continue;
+
+			auto usage = level->memoryUsage();
+			level->unload();
+			total -= usage - level->memoryUsage();
+		}
+	}
+
+	// Remove oldest levels if still over the limit
+	unsigned n_remove = 0;
+	while (total > limit && undo_levels_.size() - n_remove > 1 && static_cast<int>(n_remove) < current_level_index_)
+		total -= undo_levels_[n_remove++]->memoryUsage();
+
+	if (n_remove > 0)
+	{
+		log::info(2, "Removing {} oldest undo levels (over memory limit)", n_remove);
+		removeLevels(0, n_remove);
+	}
+
+	compactJournal();
+}
+
+// -----------------------------------------------------------------------------
+// Rewrites the undo journal with only the data of unloaded levels, once most
+// of it is out of date (levels that were undone/redone since being journaled,
+// or were removed). Any other journaled levels are written again when needed.
+// The journal is removed entirely if no levels are in it
+// -----------------------------------------------------------------------------
+void UndoManager::compactJournal()
+{
+	if (!journal_)
+		return;
+
+	uint64_t used = 0;
+	for (const auto& level : undo_levels_)
+		if (level->isJournaled())
+			used += level->journalSize();
+
+	if (used == 0)
+	{
+		journal_.reset();
+		return;
+	}
+
+	const auto size = journal_->size();
+	if (size < journal_compact_size || used * 2 > size)
+		return;
+
+	// Copy the data of unloaded levels to a new journal
+	auto             journal = std::make_unique<UndoJournal>();
+	vector<unsigned> offsets(undo_levels_.size());
+	for (unsigned a = 0; a < undo_levels_.size(); a++)
+	{
+		const auto& level = undo_levels_[a];
+		if (!level->isUnloaded())
+			continue;
+
+		MemChunk data;
+		if (!journal_->read(level->journalOffset(), level->journalSize(), data)
+			|| !journal->append(std::move(data), offsets[a]))
+		{
+			log::warning("Unable to compact undo journal");
+			return;
+		}
+		journal->waitForWrites();
+	}
+
+	for (unsigned a = 0; a < undo_levels_.size(); a++)
+	{
+		auto& level = undo_levels_[a];
+		if (level->isUnloaded())
+			level->setJournaled(offsets[a], level->journalSize());
+		else
+			level->setJournaled(0, 0);
+	}
+
+	log::info(2, "Compacted undo journal from {} to {} bytes", size, journal->size());
+	journal_ = std::move(journal);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 namespace slade
 {
 class UndoStep
@@ -8,11 +12,14 @@ public:
 	UndoStep()          = default;
 	virtual ~UndoStep() = default;
 
-	virtual bool doUndo() { return true; }
-	virtual bool doRedo() { return true; }
-	virtual bool writeFile(MemChunk& mc) { return true; }
-	virtual bool readFile(MemChunk& mc) { return true; }
-	virtual bool isOk() { return true; }
+	virtual bool   doUndo() { return true; }
+	virtual bool   doRedo() { return true; }
+	virtual bool   writeFile(MemChunk& mc) { return true; }
+	virtual bool   readFile(MemChunk& mc) { return true; }
+	virtual bool   isOk() { return true; }
+	virtual void   recorded() {} // Called when the level containing the step has finished recording
+	virtual size_t memoryUsage() const { return 0; } // Approximate memory used by the step, in bytes
+	virtual void   unload() {} // Frees the data written by writeFile (read back with readFile before use)
 };
 
 class UndoLevel
@@ -26,15 +33,65 @@ public:
 	bool   doRedo();
 	void   addStep(unique_ptr<UndoStep> step) { undo_steps_.push_back(std::move(step)); }
 	string timeStamp(bool date, bool time) const;
+	size_t memoryUsage() const { return memory_usage_; }
+	void   updateMemoryUsage();
+	void   recorded();
 
+	bool write(MemChunk& mc) const;
+	bool read(MemChunk& mc);
 	bool writeFile(string_view filename) const;
-	bool readFile(string_view filename) const;
+	bool readFile(string_view filename);
 	void createMerged(vector<unique_ptr<UndoLevel>>& levels);
 
+	// Journal
+	bool     isJournaled() const { return journal_size_ > 0; }
+	bool     isUnloaded() const { return unloaded_; }
+	unsigned journalOffset() const { return journal_offset_; }
+	unsigned journalSize() const { return journal_size_; }
+	void     setJournaled(unsigned offset, unsigned size);
+	void     unload();
+
 private:
 	string                       name_;
 	vector<unique_ptr<UndoStep>> undo_steps_;
 	wxDateTime                   timestamp_;
+	size_t                       memory_usage_   = 0;
+	unsigned                     journal_offset_ = 0;
+	unsigned                     journal_size_   = 0; // 0 if not written to the journal (or changed since)
+	bool                         unloaded_       = false;
+};
+
+// An append-only file that undo levels are written to (in the background)
+// when over the memory limit, so that the data of old levels can be dropped
+// from memory and read back when they are needed again.
+// The file is removed when the journal is destroyed
+class UndoJournal
+{
+public:
+	UndoJournal();
+	~UndoJournal();
+
+	const string& filename() const { return filename_; }
+	unsigned      size();
+
+	bool append(MemChunk data, unsigned& offset);
+	bool read(unsigned offset, unsigned size, MemChunk& mc);
+	bool isWritten(unsigned offset, unsigned size);
+	void waitForWrites();
+
+	static void removeStale();
+
+private:
+	string                                    filename_;
+	unsigned                                  size_    = 0; // Size including pending writes
+	unsigned                                  written_ = 0;
+	bool                                      failed_  = false;
+	std::deque<std::pair<unsigned, MemChunk>> pending_;
+	bool                                      writing_ = false;
+	std::mutex                                mutex_;
+	std::condition_variable                   cv_written_;
+
+	void writePending();
 };
 
 class SLADEMap;
@@ -62,6 +119,8 @@ public:
 	void clear();
 	bool createMergedLevel(UndoManager* manager, string_view name);
 
+	size_t memoryUsage() const;
+
 	// Signals
 	struct Signals
 	{
@@ -79,6 +138,13 @@ private:
 	bool                          undo_running_        = false;
 	SLADEMap*                     map_                 = nullptr;
 	Signals                       signals_;
+	unique_ptr<UndoJournal>       journal_;
+
+	bool journalLevel(UndoLevel& level);
+	bool loadLevel(UndoLevel& level);
+	void removeLevels(unsigned start, unsigned end);
+	void trimToMemoryLimit();
+	void compactJournal();
 };
 
 namespace undoredo
@@ -31,8 +31,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Web.h"
+#include "General/Jobs.h"
 #include <SFML/Network.hpp>
-#include <thread>
 
 using namespace slade;
 
@@ -57,8 +57,9 @@ string web::getHttp(const string& host, const string& uri)
 	request.setMethod(sf::Http::Request::Get);
 	request.setUri(uri);
 
-	// Send HTTP request
-	auto response = http.sendRequest(request);
+	// Send HTTP request (with a timeout, a request on a worker thread that never
+	// returns would hold up shutting down the thread pool)
+	auto response = http.sendRequest(request, sf::seconds(10));
 
 	switch (response.getStatus())
 	{
@@ -68,17 +69,18 @@ string web::getHttp(const string& host, const string& uri)
 }
 
 // -----------------------------------------------------------------------------
-// Gets a response via http from [host]/[url] (non-blocking). When the response
-// is received, an event is sent to [event_handler]
+// Gets a response via http from [host]/[url] (non-blocking, as a background
+// job). When the response is received, an event is sent to [event_handler]
 // -----------------------------------------------------------------------------
 void web::getHttpAsync(const string& host, const string& uri, wxEvtHandler* event_handler)
 {
-	std::thread thread([=]() {
-		// Queue wx event with http request response
-		auto event = new wxThreadEvent(wxEVT_THREAD_WEBGET_COMPLETED);
-		event->SetString(getHttp(host, uri));
-		wxQueueEvent(event_handler, event);
-	});
-
-	thread.detach();
+	jobs::run(
+		[=](jobs::Job&) {
+			// Queue wx event with http request response
+			auto event = new wxThreadEvent(wxEVT_THREAD_WEBGET_COMPLETED);
+			event->SetString(getHttp(host, uri));
+			wxQueueEvent(event_handler, event);
+		},
+		{},
+		jobs::Priority::Background);
 }
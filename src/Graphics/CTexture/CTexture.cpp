@@ -33,9 +33,11 @@
 #include "Main.h"
 #include "CTexture.h"
 #include "App.h"
-#include "General/Misc.h"
 #include "General/ResourceManager.h"
+#include "Graphics/Palette/Palette.h"
 #include "Graphics/SImage/SImage.h"
+#include "PatchCache.h"
+#include "TextureCache.h"
 #include "TextureXList.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
@@ -340,6 +342,7 @@ void CTexture::copyTexture(const CTexture& tex, bool keep_type)
 
 	// Copy texture info
 	name_          = tex.name_;
+	nameChanged("");
 	size_          = tex.size_;
 	def_size_      = tex.def_size_;
 	scale_         = tex.scale_;
@@ -414,11 +417,23 @@ int CTexture::index() const
 	return in_list_->textureIndex(name());
 }
 
+// -----------------------------------------------------------------------------
+// Sets the texture name to [name]
+// -----------------------------------------------------------------------------
+void CTexture::setName(string_view name)
+{
+	string old_name = name_;
+	name_           = name;
+	nameChanged(old_name);
+}
+
 // -----------------------------------------------------------------------------
 // Clears all texture data
 // -----------------------------------------------------------------------------
 void CTexture::clear()
 {
+	auto old_name = name_;
+
 	name_          = "";
 	size_          = { 0, 0 };
 	def_size_      = { 0, 0 };
@@ -430,6 +445,8 @@ void CTexture::clear()
 	null_texture_  = false;
 	offset_        = { 0, 0 };
 	patches_.clear();
+
+	nameChanged(old_name);
 }
 
 // -----------------------------------------------------------------------------
@@ -811,24 +828,117 @@ bool CTexture::convertRegular()
 // [parent] primarily, and the palette [pal]
 // -----------------------------------------------------------------------------
 bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba)
+{
+	// Use the cached image if nothing it was built from has changed
+	auto cache_key = imageCacheKey(image, parent, pal, force_rgba);
+	if (loadCachedImage(image, cache_key))
+		return true;
+
+	// Load patches
+	vector<SImage> patch_images;
+	if (!loadPatchImages(patch_images, parent, pal, force_rgba))
+		return false;
+
+	// Add patches to image
+	compositeImage(image, patch_images, pal, force_rgba);
+
+	texturecache::save(cache_key, image);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the key for the cached image of this texture (see texturecache), as
+// generated by toImage for [image]'s type and the given parameters
+// -----------------------------------------------------------------------------
+uint64_t CTexture::imageCacheKey(const SImage& image, Archive* parent, Palette* pal, bool force_rgba)
+{
+	return cacheKey(parent, pal, force_rgba) ^ (static_cast<uint64_t>(image.type()) + 1);
+}
+
+// -----------------------------------------------------------------------------
+// Loads the cached image with [cache_key] (see imageCacheKey) into [image].
+// Returns false if it isn't cached
+// -----------------------------------------------------------------------------
+bool CTexture::loadCachedImage(SImage& image, uint64_t cache_key)
+{
+	if (!texturecache::load(cache_key, image))
+		return false;
+
+	if (defined_)
+	{
+		size_.x  = image.width();
+		size_.y  = image.height();
+		scale_.x = static_cast<double>(size_.x) / static_cast<double>(def_size_.x);
+		scale_.y = static_cast<double>(size_.y) / static_cast<double>(def_size_.y);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the images of all patches in the texture into [images] (in patch
+// order), ready for compositeImage. Patches that can't be loaded are left as
+// empty images.
+// This must be done on the main thread, but the compositing can be done on
+// any thread as long as the texture isn't modified in the meantime.
+// Returns false if the texture can't be generated
+// -----------------------------------------------------------------------------
+bool CTexture::loadPatchImages(vector<SImage>& images, Archive* parent, Palette* pal, bool force_rgba)
+{
+	images.clear();
+	images.reserve(patches_.size());
+	for (unsigned a = 0; a < patches_.size(); a++)
+	{
+		auto& p_img = images.emplace_back(force_rgba ? SImage::Type::RGBA : SImage::Type::PalMask);
+
+		if (defined_)
+		{
+			// Defined texture, just the first patch (which determines the size)
+			if (!loadPatchImage(0, p_img, parent, pal, force_rgba))
+				return false;
+			size_.x  = p_img.width();
+			size_.y  = p_img.height();
+			scale_.x = static_cast<double>(size_.x) / static_cast<double>(def_size_.x);
+			scale_.y = static_cast<double>(size_.y) / static_cast<double>(def_size_.y);
+			return true;
+		}
+		else if (extended_)
+		{
+			// If the patch has a translation, ensure the image is paletted
+			auto* patch = dynamic_cast<CTPatchEx*>(patches_[a].get());
+			if (patch->blendType() == CTPatchEx::BlendType::Translation)
+				p_img.clear(SImage::Type::PalMask);
+
+			loadPatchImage(a, p_img, parent, pal, force_rgba);
+		}
+		else
+			patchcache::loadImage(patches_[a]->patchEntry(parent), p_img);
+	}
+
+	return !defined_;
+}
+
+// -----------------------------------------------------------------------------
+// Generates the texture image in [image] from the patch [patch_images] loaded
+// by loadPatchImages (which are modified in the process), using the palette
+// [pal]. Doesn't access any archives or caches, so can be used from any thread
+// -----------------------------------------------------------------------------
+void CTexture::compositeImage(SImage& image, vector<SImage>& patch_images, Palette* pal, bool force_rgba) const
 {
 	// Init image
 	image.clear();
 	image.resize(size_.x, size_.y);
 
-	// Add patches
-	SImage            p_img(force_rgba ? SImage::Type::RGBA : SImage::Type::PalMask);
 	SImage::DrawProps dp;
 	dp.src_alpha = false;
 	if (defined_)
 	{
-		if (!loadPatchImage(0, p_img, parent, pal, force_rgba))
-			return false;
-		size_.x = p_img.width();
-		size_.y = p_img.height();
-		image.resize(size_.x, size_.y);
-		scale_.x = static_cast<double>(size_.x) / static_cast<double>(def_size_.x);
-		scale_.y = static_cast<double>(size_.y) / static_cast<double>(def_size_.y);
+		if (patch_images.empty())
+			return;
+
+		auto& p_img = patch_images[0];
+		image.resize(p_img.width(), p_img.height());
 		image.drawImage(p_img, 0, 0, dp, pal, pal);
 	}
 	else if (extended_)
@@ -836,16 +946,13 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		// Extended texture
 
 		// Add each patch to image
-		for (unsigned a = 0; a < patches_.size(); a++)
+		for (unsigned a = 0; a < patches_.size() && a < patch_images.size(); a++)
 		{
 			auto* patch = dynamic_cast<CTPatchEx*>(patches_[a].get());
+			auto& p_img = patch_images[a];
 
-			// If the patch has a translation, ensure the image is paletted
-			if (patch->blendType() == CTPatchEx::BlendType::Translation && p_img.type() != SImage::Type::PalMask)
-				p_img.clear(SImage::Type::PalMask);
-
-			// Load patch entry
-			if (!loadPatchImage(a, p_img, parent, pal, force_rgba))
+			// Skip if the patch couldn't be loaded
+			if (!p_img.isValid())
 				continue;
 
 			// Handle offsets
@@ -918,14 +1025,12 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		// Normal texture
 
 		// Add each patch to image
-		for (auto& patch : patches_)
+		for (unsigned a = 0; a < patches_.size() && a < patch_images.size(); a++)
 		{
-			if (misc::loadImageFromEntry(&p_img, patch->patchEntry(parent)))
-				image.drawImage(p_img, patch->xOffset(), patch->yOffset(), dp, pal, pal);
+			if (patch_images[a].isValid())
+				image.drawImage(patch_images[a], patches_[a]->xOffset(), patches_[a]->yOffset(), dp, pal, pal);
 		}
 	}
-
-	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -938,51 +1043,109 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 	if (pindex >= patches_.size())
 		return false;
 
+	// Load texture-as-patch to image if it is one
+	if (auto* tex = patchTexture(pindex, parent))
+		return tex->toImage(image, parent, pal, force_rgba);
+
+	// Otherwise load patch entry to image (decoded patches are shared between textures)
+	return patchcache::loadImage(patchImageEntry(pindex, parent), image);
+}
+
+// -----------------------------------------------------------------------------
+// Called when the texture name has changed from [old_name], updates the name
+// lookup index of the list the texture is in (if any)
+// -----------------------------------------------------------------------------
+void CTexture::nameChanged(string_view old_name)
+{
+	if (in_list_ && old_name != name_)
+		in_list_->textureRenamed(this, old_name);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture used as the patch at [pindex], or null if the patch
+// isn't a texture. Only extended textures can use textures as patches
+// -----------------------------------------------------------------------------
+CTexture* CTexture::patchTexture(unsigned pindex, Archive* parent)
+{
 	auto* patch = patches_[pindex].get();
 
-	// If the texture is extended, search for textures-as-patches first
+	// If the texture is extended, search for textures-as-patches
 	// (as long as the patch name is different from this texture's name)
-	if (extended_ && !(strutil::equalCI(patch->name(), name_)))
+	if (!extended_ || strutil::equalCI(patch->name(), name_))
+		return nullptr;
+
+	// Search the texture list we're in first
+	if (in_list_)
 	{
-		// Search the texture list we're in first
-		if (in_list_)
+		for (unsigned a = 0; a < in_list_->size(); a++)
 		{
-			for (unsigned a = 0; a < in_list_->size(); a++)
-			{
-				auto* tex = in_list_->texture(a);
+			auto* tex = in_list_->texture(a);
 
-				// Don't look past this texture in the list
-				if (tex->name() == name_)
-					break;
+			// Don't look past this texture in the list
+			if (tex->name() == name_)
+				break;
 
-				// Check for name match
-				if (strutil::equalCI(tex->name(), patch->name()))
-				{
-					// Load texture to image
-					return tex->toImage(image, parent, pal, force_rgba);
-				}
-			}
+			// Check for name match
+			if (strutil::equalCI(tex->name(), patch->name()))
+				return tex;
 		}
-
-		// Otherwise, try the resource manager
-		// TODO: Something has to be ignored here. The entire archive or just the current list?
-		auto* tex = app::resources().getTexture(patch->name(), "", parent);
-		if (tex)
-			return tex->toImage(image, parent, pal, force_rgba);
 	}
 
-	// Get patch entry
-	auto* entry = patch->patchEntry(parent);
+	// Otherwise, try the resource manager
+	// TODO: Something has to be ignored here. The entire archive or just the current list?
+	return app::resources().getTexture(patch->name(), "", parent);
+}
 
-	// Load entry to image if valid
-	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+// -----------------------------------------------------------------------------
+// Returns the image entry for the patch at [pindex] (which may also be a
+// standalone texture entry), or null if none was found
+// -----------------------------------------------------------------------------
+ArchiveEntry* CTexture::patchImageEntry(unsigned pindex, Archive* parent) const
+{
+	auto* patch = patches_[pindex].get();
+
+	// Get patch entry
+	if (auto* entry = patch->patchEntry(parent))
+		return entry;
 
 	// Maybe it's a texture?
-	entry = app::resources().getTextureEntry(patch->name(), "", parent);
+	return app::resources().getTextureEntry(patch->name(), "", parent);
+}
 
-	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+// -----------------------------------------------------------------------------
+// Returns a key for the cached image of this texture (see texturecache),
+// generated from a hash of the texture definition, the data of all patches it
+// uses (recursively, for textures-as-patches) and [pal]
+// -----------------------------------------------------------------------------
+uint64_t CTexture::cacheKey(Archive* parent, Palette* pal, bool force_rgba)
+{
+	// Texture definition
+	string key;
+	if (extended_)
+		key = asText();
+	else
+	{
+		key = fmt::format("{} {} {}\n", name_, size_.x, size_.y);
+		for (const auto& patch : patches_)
+			key += fmt::format("{} {} {}\n", patch->name(), patch->xOffset(), patch->yOffset());
+	}
+	key += force_rgba ? "rgba\n" : "\n";
+
+	// Patch data
+	for (unsigned a = 0; a < patches_.size(); a++)
+	{
+		if (auto* tex = patchTexture(a, parent))
+			key += fmt::format("t{:016x}\n", tex->cacheKey(parent, pal, force_rgba));
+		else if (auto* entry = extended_ ? patchImageEntry(a, parent) : patches_[a]->patchEntry(parent))
+			key += fmt::format("e{:016x}\n", entry->data().hash());
+		else
+			key += "-\n";
+	}
+
+	// Palette
+	if (pal)
+		for (const auto& colour : pal->colours())
+			key += fmt::format("{:02x}{:02x}{:02x}", colour.r, colour.g, colour.b);
 
-	return false;
+	return MemChunk{ reinterpret_cast<const uint8_t*>(key.data()), static_cast<uint32_t>(key.size()) }.hash();
 }
@@ -141,7 +141,7 @@ public:
 	uint8_t        state() const { return state_; }
 	int            index() const;
 
-	void setName(string_view name) { name_ = name; }
+	void setName(string_view name);
 	void setSize(const Vec2<uint16_t>& size) { size_ = size; }
 	void setWidth(uint16_t width) { size_.x = width; }
 	void setHeight(uint16_t height) { size_.y = height; }
@@ -183,6 +183,12 @@ public:
 		bool     force_rgba = false);
 	bool toImage(SImage& image, Archive* parent = nullptr, Palette* pal = nullptr, bool force_rgba = false);
 
+	// Separate steps of toImage, so the patches can be composited on another thread
+	uint64_t imageCacheKey(const SImage& image, Archive* parent, Palette* pal, bool force_rgba);
+	bool     loadCachedImage(SImage& image, uint64_t cache_key);
+	bool     loadPatchImages(vector<SImage>& images, Archive* parent, Palette* pal, bool force_rgba);
+	void     compositeImage(SImage& image, vector<SImage>& patch_images, Palette* pal, bool force_rgba) const;
+
 	// Signals
 	struct Signals
 	{
@@ -215,5 +221,10 @@ private:
 
 	// Signals
 	Signals signals_;
+
+	void          nameChanged(string_view old_name);
+	CTexture*     patchTexture(unsigned pindex, Archive* parent);
+	ArchiveEntry* patchImageEntry(unsigned pindex, Archive* parent) const;
+	uint64_t      cacheKey(Archive* parent, Palette* pal, bool force_rgba);
 };
 } // namespace slade
@@ -0,0 +1,205 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PatchCache.cpp
+// Description: In-memory cache of decoded patch images, shared by everything
+//              that builds composite texture images (CTexture::toImage). The
+//              decoded image doesn't depend on the palette or any translation
+//              (these are applied to a copy when compositing), so images are
+//              keyed by entry only
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PatchCache.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Console.h"
+#include "General/EntryPrefetch.h"
+#include "General/Misc.h"
+#include "Graphics/SImage/SImage.h"
+#include <list>
+#include <unordered_map>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, patch_cache_max_size, 64, CVar::Flag::Save) // Maximum size of decoded patches kept in memory (MB)
+namespace
+{
+struct CachedPatch
+{
+	ArchiveEntry*          key = nullptr;
+	weak_ptr<ArchiveEntry> entry;
+	MemChunk               data; // Shares the entry's data, so any change to the entry's data can be detected
+	SImage                 image;
+	size_t                 size = 0;
+};
+
+std::list<CachedPatch>                                              patches; // Most recently used first
+std::unordered_map<ArchiveEntry*, std::list<CachedPatch>::iterator> patch_index;
+size_t                                                              cache_size = 0;
+unsigned                                                            n_hits     = 0;
+unsigned                                                            n_misses   = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the maximum cache size in bytes
+// -----------------------------------------------------------------------------
+size_t maxCacheSize()
+{
+	return static_cast<size_t>(std::max(0, static_cast<int>(patch_cache_max_size))) * 1024 * 1024;
+}
+
+// -----------------------------------------------------------------------------
+// Removes the cached patch at [i]
+// -----------------------------------------------------------------------------
+void removePatch(std::list<CachedPatch>::iterator i)
+{
+	cache_size -= i->size;
+	patch_index.erase(i->key);
+	patches.erase(i);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the least recently used patches until the cache is within its
+// maximum size (patch_cache_max_size)
+// -----------------------------------------------------------------------------
+void trimCache()
+{
+	auto max_size = maxCacheSize();
+	while (cache_size > max_size && !patches.empty())
+		removePatch(std::prev(patches.end()));
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// patchcache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Loads the image for patch [entry] into [image], from the cache if it was
+// decoded previously and the entry's data hasn't changed since.
+// Returns false if the entry couldn't be loaded as an image
+// -----------------------------------------------------------------------------
+bool patchcache::loadImage(ArchiveEntry* entry, SImage& image)
+{
+	if (!entry)
+		return false;
+
+	// Check for cached image
+	auto found = patch_index.find(entry);
+	if (found != patch_index.end())
+	{
+		auto i = found->second;
+		if (i->entry.lock().get() == entry && i->data.sharesData(entry->data(false)))
+		{
+			n_hits++;
+			patches.splice(patches.begin(), patches, i);
+			return image.copyImage(&i->image);
+		}
+
+		// Entry was changed (or deleted) since it was cached
+		removePatch(i);
+	}
+
+	// Decode the entry
+	n_misses++;
+	if (!misc::loadImageFromEntry(&image, entry))
+		return false;
+
+	// Don't cache images that also depend on other entries (eg. Jaguar Doom formats),
+	// or entries not in an archive
+	if (maxCacheSize() == 0 || !entryprefetch::canDecode(*entry))
+		return true;
+	auto shared = entry->getShared();
+	if (!shared)
+		return true;
+
+	// Add to cache (the image data is shared with [image] until either is modified)
+	patches.emplace_front();
+	auto& patch = patches.front();
+	patch.key   = entry;
+	patch.entry = shared;
+	patch.data.importMem(entry->data());
+	patch.image.copyImage(&image);
+	patch.size = static_cast<size_t>(image.width()) * image.height() * (image.type() == SImage::Type::RGBA ? 4 : 2);
+	patch_index[entry] = patches.begin();
+	cache_size += patch.size;
+	trimCache();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached images
+// -----------------------------------------------------------------------------
+void patchcache::clear()
+{
+	patches.clear();
+	patch_index.clear();
+	cache_size = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(patch_cache_stats, 0, false)
+{
+	log::console(fmt::format(
+		"Patch cache: {} images, {:1.2f}MB, {} hits, {} misses",
+		patches.size(),
+		static_cast<double>(cache_size) / (1024. * 1024.),
+		n_hits,
+		n_misses));
+}
+
+CONSOLE_COMMAND(patch_cache_clear, 0, false)
+{
+	patchcache::clear();
+	log::console("Patch cache cleared");
+}
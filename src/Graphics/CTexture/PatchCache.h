@@ -0,0 +1,18 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class SImage;
+
+// In-memory cache of decoded patch images, so patches used by many composite
+// textures are only decoded once. Cached images are discarded when their
+// entry's data changes, and the least recently used images are removed when
+// the cache grows beyond its maximum size. Must only be used from the main
+// thread
+namespace patchcache
+{
+	bool loadImage(ArchiveEntry* entry, SImage& image);
+	void clear();
+} // namespace patchcache
+} // namespace slade
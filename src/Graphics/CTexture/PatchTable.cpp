@@ -65,12 +65,11 @@ PatchTable::Patch& PatchTable::patch(size_t index)
 // -----------------------------------------------------------------------------
 PatchTable::Patch& PatchTable::patch(string_view name)
 {
-	// Go through list
-	for (auto& patch : patches_)
-	{
-		if (patch.name == name)
-			return patch;
-	}
+	// Check patches with a (case-insensitive) matching name
+	if (auto indices = indexedPatches(name))
+		for (auto index : *indices)
+			if (patches_[index].name == name)
+				return patches_[index];
 
 	return patch_invalid_;
 }
@@ -113,15 +112,8 @@ ArchiveEntry* PatchTable::patchEntry(size_t index)
 // -----------------------------------------------------------------------------
 ArchiveEntry* PatchTable::patchEntry(string_view name)
 {
-	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return patchEntry(a);
-	}
-
-	// Not found
-	return nullptr;
+	auto index = patchIndex(name);
+	return index >= 0 ? patchEntry(index) : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -129,15 +121,8 @@ ArchiveEntry* PatchTable::patchEntry(string_view name)
 // -----------------------------------------------------------------------------
 int32_t PatchTable::patchIndex(string_view name) const
 {
-	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return a;
-	}
-
-	// Not found
-	return -1;
+	auto indices = indexedPatches(name);
+	return indices ? static_cast<int32_t>(indices->front()) : -1;
 }
 
 // -----------------------------------------------------------------------------
@@ -169,6 +154,7 @@ bool PatchTable::removePatch(unsigned index)
 
 	// Remove the patch
 	patches_.erase(patches_.begin() + index);
+	name_index_valid_ = false;
 
 	// Announce
 	signals_.modified();
@@ -190,6 +176,7 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 
 	// Change the patch name
 	patches_[index].name = newname;
+	name_index_valid_    = false;
 
 	// Announce
 	signals_.modified();
@@ -203,17 +190,13 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 bool PatchTable::addPatch(string_view name, bool allow_dup)
 {
 	// Check patch doesn't already exist
-	if (!allow_dup)
-	{
-		for (auto& patch : patches_)
-		{
-			if (name == patch.name)
-				return false;
-		}
-	}
+	if (!allow_dup && &patch(name) != &patch_invalid_)
+		return false;
 
 	// Add the patch
 	patches_.emplace_back(name);
+	if (name_index_valid_)
+		name_index_[strutil::upper(name)].push_back(patches_.size() - 1);
 
 	// Announce
 	signals_.modified();
@@ -235,6 +218,8 @@ bool PatchTable::loadPNAMES(ArchiveEntry* pnames, Archive* parent)
 
 	// Clear current table
 	patches_.clear();
+	name_index_.clear();
+	name_index_valid_ = true;
 
 	// Setup parent archive
 	if (!parent)
@@ -342,3 +327,22 @@ void PatchTable::updatePatchUsage(CTexture* tex)
 	// Announce
 	signals_.modified();
 }
+
+// -----------------------------------------------------------------------------
+// Returns the indices of all patches matching [name] (case-insensitive) in
+// order, or null if no patches match. Rebuilds the name lookup index first if
+// it is out of date
+// -----------------------------------------------------------------------------
+const vector<unsigned>* PatchTable::indexedPatches(string_view name) const
+{
+	if (!name_index_valid_)
+	{
+		name_index_.clear();
+		for (unsigned a = 0; a < patches_.size(); a++)
+			name_index_[strutil::upper(patches_[a].name)].push_back(a);
+		name_index_valid_ = true;
+	}
+
+	const auto i = name_index_.find(strutil::upper(name));
+	return i != name_index_.end() ? &i->second : nullptr;
+}
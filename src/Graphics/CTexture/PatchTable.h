@@ -66,5 +66,12 @@ private:
 	vector<Patch> patches_;
 	Patch         patch_invalid_{ "INVALID_PATCH" };
 	Signals       signals_;
+
+	// Case-insensitive name lookup index, rebuilt when next needed after
+	// patches are removed or renamed
+	mutable std::unordered_map<string, vector<unsigned>> name_index_; // Uppercase name -> patch indices
+	mutable bool                                         name_index_valid_ = false;
+
+	const vector<unsigned>* indexedPatches(string_view name) const;
 };
 } // namespace slade
@@ -0,0 +1,285 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureCache.cpp
+// Description: Persistent on-disk cache of composited texture images. Each
+//              image is stored (zlib compressed) in its own file in the user
+//              dir, named by its key. The oldest files are removed when the
+//              cache grows beyond its maximum size
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureCache.h"
+#include "App.h"
+#include "General/Console.h"
+#include "Graphics/SImage/SImage.h"
+#include "Utility/Compression.h"
+#include "Utility/FileUtils.h"
+#include <filesystem>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, texture_cache, true, CVar::Flag::Save)
+CVAR(Int, texture_cache_max_size, 256, CVar::Flag::Save) // Maximum size of the cache (MB)
+namespace
+{
+constexpr uint32_t cache_magic   = 0x58544C53; // "SLTX"
+constexpr uint32_t cache_version = 1;
+bool               cache_checked = false; // Cache size was checked this session
+size_t             cache_written = 0;     // Bytes written to the cache since it was last checked
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the cache directory path
+// -----------------------------------------------------------------------------
+string cacheDir()
+{
+	return app::path("texcache", app::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the cache file for [key]
+// -----------------------------------------------------------------------------
+string cacheFile(uint64_t key)
+{
+	return app::path(fmt::format("texcache/{:016x}.dat", key), app::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the least recently used cache files until the cache is within its
+// maximum size (texture_cache_max_size)
+// -----------------------------------------------------------------------------
+void checkCacheSize()
+{
+	namespace fs = std::filesystem;
+
+	cache_checked = true;
+	cache_written = 0;
+
+	// Get all cache files
+	struct CacheFile
+	{
+		fs::path           path;
+		uintmax_t          size;
+		fs::file_time_type time;
+	};
+	vector<CacheFile> files;
+	uintmax_t         total = 0;
+	std::error_code   ec;
+	for (const auto& item : fs::directory_iterator(cacheDir(), ec))
+	{
+		if (!item.is_regular_file(ec))
+			continue;
+
+		files.push_back({ item.path(), item.file_size(ec), item.last_write_time(ec) });
+		total += files.back().size;
+	}
+
+	auto max_size = static_cast<uintmax_t>(std::max(0, static_cast<int>(texture_cache_max_size))) * 1024 * 1024;
+	if (total <= max_size)
+		return;
+
+	// Remove oldest files first
+	std::sort(files.begin(), files.end(), [](const CacheFile& left, const CacheFile& right) {
+		return left.time < right.time;
+	});
+	unsigned removed = 0;
+	for (const auto& file : files)
+	{
+		if (total <= max_size)
+			break;
+
+		if (fs::remove(file.path, ec))
+		{
+			total -= file.size;
+			removed++;
+		}
+	}
+
+	log::info(2, "Removed {} old texture cache files", removed);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// texturecache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Loads the cached image for [key] into [image].
+// Returns false if there is no (valid) cached image for [key]
+// -----------------------------------------------------------------------------
+bool texturecache::load(uint64_t key, SImage& image)
+{
+	if (!texture_cache || key == 0)
+		return false;
+
+	MemChunk mc;
+	auto     path = cacheFile(key);
+	if (!fileutil::fileExists(path) || !mc.importFile(path))
+		return false;
+
+	// Check header
+	uint32_t magic, version;
+	int32_t  width, height;
+	uint8_t  type;
+	mc.seek(0, SEEK_SET);
+	if (!mc.read(&magic, 4) || !mc.read(&version, 4) || !mc.read(&width, 4) || !mc.read(&height, 4)
+		|| !mc.read(&type, 1))
+		return false;
+	if (magic != cache_magic || version != cache_version || width <= 0 || height <= 0
+		|| (type != static_cast<uint8_t>(SImage::Type::RGBA) && type != static_cast<uint8_t>(SImage::Type::PalMask)))
+		return false;
+
+	// Read image data
+	MemChunk compressed, data;
+	auto     image_type = static_cast<SImage::Type>(type);
+	size_t   data_size  = static_cast<size_t>(width) * height * (image_type == SImage::Type::RGBA ? 4 : 2);
+	if (!mc.readMC(compressed, mc.size() - mc.currentPos()) || !compression::zlibInflate(compressed, data, data_size)
+		|| data.size() != data_size)
+		return false;
+
+	if (image_type == SImage::Type::RGBA)
+	{
+		vector<uint8_t> pixels(data.data(), data.data() + data_size);
+		image.setImageData(pixels, width, height, image_type);
+	}
+	else
+	{
+		// Paletted, indices followed by alpha
+		image.create(width, height, image_type);
+		unsigned npix = width * height;
+		for (unsigned a = 0; a < npix; a++)
+			image.setPixel(a % width, a / width, data[a], data[npix + a]);
+	}
+
+	// Mark as recently used
+	std::error_code ec;
+	std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [image] to the cache for [key]
+// -----------------------------------------------------------------------------
+void texturecache::save(uint64_t key, SImage& image)
+{
+	if (!texture_cache || key == 0 || !image.isValid())
+		return;
+
+	// Get image data
+	MemChunk data;
+	if (image.type() == SImage::Type::RGBA)
+		image.putRGBAData(data);
+	else if (image.type() == SImage::Type::PalMask)
+	{
+		// Paletted, indices followed by alpha
+		vector<uint8_t> alpha;
+		alpha.reserve(image.width() * image.height());
+		for (int y = 0; y < image.height(); y++)
+			for (int x = 0; x < image.width(); x++)
+				alpha.push_back(image.pixelAt(x, y).a);
+		image.putIndexedData(data);
+		data.write(alpha.data(), alpha.size());
+	}
+	else
+		return;
+
+	MemChunk compressed;
+	if (!compression::zlibDeflate(data, compressed, 1))
+		return;
+
+	// Write header
+	MemChunk mc;
+	int32_t  width  = image.width();
+	int32_t  height = image.height();
+	auto     type   = static_cast<uint8_t>(image.type());
+	mc.write(&cache_magic, 4);
+	mc.write(&cache_version, 4);
+	mc.write(&width, 4);
+	mc.write(&height, 4);
+	mc.write(&type, 1);
+	mc.write(compressed.data(), compressed.size());
+
+	// Write to file
+	auto dir = cacheDir();
+	if (!fileutil::dirExists(dir))
+		fileutil::createDir(dir);
+	if (!mc.exportFile(cacheFile(key)))
+	{
+		log::warning("Unable to write texture cache file {}", cacheFile(key));
+		return;
+	}
+
+	// Check the cache size at first write, and then whenever another 10% of the
+	// maximum has been written
+	cache_written += mc.size();
+	if (!cache_checked || cache_written > static_cast<size_t>(texture_cache_max_size) * 1024 * 1024 / 10)
+		checkCacheSize();
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached images
+// -----------------------------------------------------------------------------
+void texturecache::clear()
+{
+	std::error_code ec;
+	std::filesystem::remove_all(cacheDir(), ec);
+	cache_written = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(texture_cache_clear, 0, false)
+{
+	texturecache::clear();
+	log::console("Texture cache cleared");
+}
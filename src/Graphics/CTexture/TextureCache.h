@@ -0,0 +1,16 @@
+#pragma once
+
+namespace slade
+{
+class SImage;
+
+// Persistent on-disk cache of composited texture images, so composite textures
+// don't need to be rebuilt from their patches every session. Images are keyed
+// by a hash of everything that affects the result (see CTexture::cacheKey)
+namespace texturecache
+{
+	bool load(uint64_t key, SImage& image);
+	void save(uint64_t key, SImage& image);
+	void clear();
+} // namespace texturecache
+} // namespace slade
@@ -34,6 +34,7 @@
 #include "TextureXList.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "General/EntryJobs.h"
 #include "Graphics/SImage/SImage.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/StringUtils.h"
@@ -105,6 +106,51 @@ struct StrifeTexDef
 	int16_t  height;
 	int16_t  patchcount;
 };
+
+// Definition types in TEXTURES (other than the old HIRESTEX 'Define')
+const char* TEXTURES_TYPES[] = { "Texture", "Sprite", "Graphic", "WallTexture", "Flat" };
+
+// -----------------------------------------------------------------------------
+// Returns an estimate of the number of definitions in TEXTURES [data], by
+// counting the lines starting with a definition keyword. Only used to reserve
+// space before parsing, so doesn't need to be exact
+// -----------------------------------------------------------------------------
+size_t countTEXTURESDefinitions(const MemChunk& data)
+{
+	auto   text  = string_view(reinterpret_cast<const char*>(data.data()), data.size());
+	size_t count = 0;
+	size_t pos   = 0;
+	while (pos < text.size())
+	{
+		// Skip leading whitespace
+		while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'))
+			++pos;
+
+		// Check for a definition keyword
+		auto line = text.substr(pos, 12);
+		if (strutil::startsWithCI(line, "Define"))
+			++count;
+		else
+		{
+			for (const auto* type : TEXTURES_TYPES)
+			{
+				if (strutil::startsWithCI(line, type))
+				{
+					++count;
+					break;
+				}
+			}
+		}
+
+		// Next line
+		pos = text.find('\n', pos);
+		if (pos == string_view::npos)
+			break;
+		++pos;
+	}
+
+	return count;
+}
 } // namespace
 
 
@@ -136,15 +182,8 @@ CTexture* TextureXList::texture(size_t index)
 // -----------------------------------------------------------------------------
 CTexture* TextureXList::texture(string_view name)
 {
-	// Search for texture by name
-	for (auto& texture : textures_)
-	{
-		if (strutil::equalCI(texture->name(), name))
-			return texture.get();
-	}
-
-	// Not found
-	return &tex_invalid_;
+	auto tex = indexedTexture(name);
+	return tex ? tex : &tex_invalid_;
 }
 
 // -----------------------------------------------------------------------------
@@ -152,18 +191,8 @@ CTexture* TextureXList::texture(string_view name)
 // -----------------------------------------------------------------------------
 int TextureXList::textureIndex(string_view name)
 {
-	// Search for texture by name
-	for (unsigned a = 0; a < textures_.size(); a++)
-	{
-		if (strutil::equalCI(textures_[a]->name(), name))
-		{
-			textures_[a]->index_ = a;
-			return a;
-		}
-	}
-
-	// Not found
-	return -1;
+	auto tex = indexedTexture(name);
+	return tex ? tex->index_ : -1;
 }
 
 // -----------------------------------------------------------------------------
@@ -173,10 +202,11 @@ void TextureXList::addTexture(unique_ptr<CTexture> tex, int position)
 {
 	// Add it to the list at position if valid
 	tex->in_list_ = this;
+	addToNameIndex(tex.get());
 	if (position >= 0 && (unsigned)position < textures_.size())
 	{
-		tex->index_ = position;
 		textures_.insert(textures_.begin() + position, std::move(tex));
+		updateIndices(position);
 	}
 	else
 	{
@@ -197,6 +227,8 @@ unique_ptr<CTexture> TextureXList::removeTexture(unsigned index)
 	// Remove the texture from the list
 	auto removed = std::move(textures_[index]);
 	textures_.erase(textures_.begin() + index);
+	removeFromNameIndex(removed.get(), removed->name());
+	updateIndices(index);
 
 	return removed;
 }
@@ -230,7 +262,11 @@ unique_ptr<CTexture> TextureXList::replaceTexture(unsigned index, unique_ptr<CTe
 		return nullptr;
 
 	// Replace texture
-	auto replaced    = std::move(textures_[index]);
+	auto replaced = std::move(textures_[index]);
+	removeFromNameIndex(replaced.get(), replaced->name());
+	replacement->in_list_ = this;
+	replacement->index_   = index;
+	addToNameIndex(replacement.get());
 	textures_[index] = std::move(replacement);
 
 	return replaced;
@@ -242,6 +278,7 @@ unique_ptr<CTexture> TextureXList::replaceTexture(unsigned index, unique_ptr<CTe
 void TextureXList::clear(bool clear_patches)
 {
 	textures_.clear();
+	name_index_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -254,6 +291,70 @@ void TextureXList::removePatch(string_view patch)
 		texture->removePatch(patch); // Remove patch from texture
 }
 
+// -----------------------------------------------------------------------------
+// Adds [tex] to the name lookup index
+// -----------------------------------------------------------------------------
+void TextureXList::addToNameIndex(CTexture* tex)
+{
+	name_index_[strutil::upper(tex->name())].push_back(tex);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [tex] from the name lookup index, where it was added with [name]
+// -----------------------------------------------------------------------------
+void TextureXList::removeFromNameIndex(CTexture* tex, string_view name)
+{
+	const auto i = name_index_.find(strutil::upper(name));
+	if (i == name_index_.end())
+		return;
+
+	auto& list = i->second;
+	list.erase(std::remove(list.begin(), list.end(), tex), list.end());
+	if (list.empty())
+		name_index_.erase(i);
+}
+
+// -----------------------------------------------------------------------------
+// Called when [tex] has been renamed from [old_name], updates the name lookup
+// index if the texture is in this list
+// -----------------------------------------------------------------------------
+void TextureXList::textureRenamed(CTexture* tex, string_view old_name)
+{
+	if (tex->index_ < 0 || tex->index_ >= static_cast<int>(textures_.size()) || textures_[tex->index_].get() != tex)
+		return;
+
+	removeFromNameIndex(tex, old_name);
+	addToNameIndex(tex);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the stored list index of each texture from [from] onwards
+// -----------------------------------------------------------------------------
+void TextureXList::updateIndices(unsigned from)
+{
+	for (unsigned a = from; a < textures_.size(); a++)
+		textures_[a]->index_ = a;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the first texture in the list matching [name] (case-insensitive) via
+// the name lookup index, or null if no textures match
+// -----------------------------------------------------------------------------
+CTexture* TextureXList::indexedTexture(string_view name) const
+{
+	const auto i = name_index_.find(strutil::upper(name));
+	if (i == name_index_.end() || i->second.empty())
+		return nullptr;
+
+	// If there are multiple textures with the name, return the first one
+	CTexture* first = nullptr;
+	for (auto* tex : i->second)
+		if (!first || tex->index_ < first->index_)
+			first = tex;
+
+	return first;
+}
+
 // -----------------------------------------------------------------------------
 // Reads in a doom-format TEXTUREx entry.
 // Returns true on success, false otherwise
@@ -272,13 +373,22 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 	maineditor::setGlobalPaletteFromArchive(texturex->parent());
 
 	// Read TEXTUREx
-
-	// Read header
-	texturex->seek(0, SEEK_SET);
+	// (the entry data is read directly rather than via seek/read, since large
+	// TEXTUREx lumps can contain thousands of definitions)
+	const auto& data = static_cast<const MemChunk&>(texturex->data());
+	auto        size = data.size();
+
+	// Copies [count] bytes at [offset] in the entry data to [dest], returns false if out of bounds
+	auto read_at = [&](size_t offset, void* dest, size_t count) {
+		if (offset > size || count > size - offset)
+			return false;
+		memcpy(dest, data.data() + offset, count);
+		return true;
+	};
 
 	// Number of textures
 	int32_t n_tex = 0;
-	if (!texturex->read(&n_tex, 4))
+	if (!read_at(0, &n_tex, 4))
 	{
 		log::error("TEXTUREx entry is corrupt (can't read texture count)");
 		return false;
@@ -290,22 +400,20 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 		return true;
 
 	// Texture definition offsets
-	vector<int32_t> offsets(n_tex);
-	if (!texturex->read(offsets.data(), n_tex * 4))
+	if (n_tex < 0 || static_cast<size_t>(n_tex) > (size - 4) / 4)
 	{
 		log::error("TEXTUREx entry is corrupt (can't read first offset)");
 		return false;
 	}
+	vector<int32_t> offsets(n_tex);
+	read_at(4, offsets.data(), n_tex * 4);
+	for (auto& offset : offsets)
+		offset = wxINT32_SWAP_ON_BE(offset);
 
 	// Read the first texture definition to try to identify the format
-	if (!texturex->seek(wxINT32_SWAP_ON_BE(offsets[0]), SEEK_SET))
-	{
-		log::error("TEXTUREx entry is corrupt (can't read first definition)");
-		return false;
-	}
 	// Look at the name field. Is it present or not?
 	char tempname[8];
-	if (!texturex->read(&tempname, 8))
+	if (!read_at(offsets[0], &tempname, 8))
 	{
 		log::error("TEXTUREx entry is corrupt (can't read first name)");
 		return false;
@@ -339,9 +447,8 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 	if (txformat_ == Format::Normal)
 	{
 		// No need to test this again since it was already tested before.
-		texturex->seek(offsets[0], SEEK_SET);
 		FullTexDef temp;
-		if (!texturex->read(&temp, 22))
+		if (!read_at(offsets[0], &temp, 22))
 		{
 			log::error("TEXTUREx entry is corrupt (can't test definition)");
 			return false;
@@ -352,15 +459,17 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 			txformat_ = Format::Strife11;
 	}
 
+	// Size of the unused data following each definition and patch (none in Strife 1.1 format)
+	size_t skip = txformat_ == Format::Strife11 ? 0 : 4;
+
+	// Reserve space for the new textures
+	textures_.reserve(textures_.size() + n_tex);
+	name_index_.reserve(name_index_.size() + n_tex);
+
 	// Read all texture definitions
 	for (int32_t a = 0; a < n_tex; a++)
 	{
-		// Skip to texture definition
-		if (!texturex->seek(offsets[a], SEEK_SET))
-		{
-			log::error("TEXTUREx entry is corrupt (can't find definition)");
-			return false;
-		}
+		size_t pos = offsets[a];
 
 		// Read definition
 		TexDef tdef;
@@ -378,11 +487,12 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 			memcpy(tdef.name, temp, 8);
 
 			// Read texture info
-			if (!texturex->read(&nameless, 8))
+			if (!read_at(pos, &nameless, 8))
 			{
 				log::error("TEXTUREx entry is corrupt (can't read nameless definition #{})", a);
 				return false;
 			}
+			pos += 8;
 
 			// Copy data to permanent structure
 			tdef.flags    = nameless.flags;
@@ -391,22 +501,19 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 			tdef.width    = nameless.width;
 			tdef.height   = nameless.height;
 		}
-		else if (!texturex->read(&tdef, 16))
-		{
-			log::error("TEXTUREx entry is corrupt, (can't read texture definition #{})", a);
-			return false;
-		}
-
-		// Skip unused
-		if (txformat_ != Format::Strife11)
+		else
 		{
-			if (!texturex->seek(4, SEEK_CUR))
+			if (!read_at(pos, &tdef, 16))
 			{
-				log::error("TEXTUREx entry is corrupt (can't skip dummy data past #{})", a);
+				log::error("TEXTUREx entry is corrupt, (can't read texture definition #{})", a);
 				return false;
 			}
+			pos += 16;
 		}
 
+		// Skip unused
+		pos += skip;
+
 		// Create texture
 		tdef.cleanupName();
 		auto tex      = std::make_unique<CTexture>();
@@ -422,54 +529,49 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 
 		// Read patches
 		int16_t n_patches = 0;
-		if (!texturex->read(&n_patches, 2))
+		if (!read_at(pos, &n_patches, 2))
 		{
 			log::error("TEXTUREx entry is corrupt (can't read patchcount #{})", a);
 			return false;
 		}
+		pos += 2;
+		n_patches = wxINT16_SWAP_ON_BE(n_patches);
 
 		// log::info(1, "Texture #{}: {} patch%s", a, n_patches, n_patches == 1 ? "" : "es");
 
-		for (uint16_t p = 0; p < n_patches; p++)
+		// Jaguar textures always use the patch with the same name as the texture
+		string jaguar_patch;
+		if (txformat_ == Format::Jaguar)
+			jaguar_patch = strutil::upper(tex->name_);
+
+		if (n_patches > 0)
+			tex->patches_.reserve(n_patches);
+		for (int16_t p = 0; p < n_patches; p++)
 		{
 			// Read patch definition
 			Patch pdef;
-			if (!texturex->read(&pdef, 6))
+			if (!read_at(pos, &pdef, 6) || pos + 6 + skip > size)
 			{
 				log::error("TEXTUREx entry is corrupt (can't read patch definition #{}:{})", a, p);
-				log::error("Lump size {}, offset {}", texturex->size(), texturex->currentPos());
+				log::error("Lump size {}, offset {}", size, pos);
 				return false;
 			}
+			pos += 6 + skip;
+			pdef.left  = wxINT16_SWAP_ON_BE(pdef.left);
+			pdef.top   = wxINT16_SWAP_ON_BE(pdef.top);
+			pdef.patch = wxUINT16_SWAP_ON_BE(pdef.patch);
 
-			// Skip unused
-			if (txformat_ != Format::Strife11)
-			{
-				if (!texturex->seek(4, SEEK_CUR))
-				{
-					log::error("TEXTUREx entry is corrupt (can't skip dummy data past #{}:{})", a, p);
-					return false;
-				}
-			}
-
-
-			// Add it to the texture
-			string patch;
-			if (txformat_ == Format::Jaguar)
-			{
-				patch = strutil::upper(tex->name_);
-			}
-			else
-			{
-				patch = patch_table.patchName(pdef.patch);
-			}
+			// Add it to the texture (directly, the new texture has nothing to notify of changes)
+			string_view patch = txformat_ == Format::Jaguar ? jaguar_patch : patch_table.patchName(pdef.patch);
 			if (patch.empty())
 			{
 				// log::info(1, "Warning: Texture %s contains patch %d which is invalid - may be incorrect PNAMES
 				// entry", tex->getName(), pdef.patch);
-				patch = fmt::format("INVPATCH{:04d}", pdef.patch);
+				tex->patches_.push_back(
+					std::make_unique<CTPatch>(fmt::format("INVPATCH{:04d}", pdef.patch), pdef.left, pdef.top));
 			}
-
-			tex->addPatch(patch, pdef.left, pdef.top);
+			else
+				tex->patches_.push_back(std::make_unique<CTPatch>(patch, pdef.left, pdef.top));
 		}
 
 		// Add texture to list
@@ -691,59 +793,40 @@ bool TextureXList::readTEXTURESData(ArchiveEntry* textures)
 		return true;
 	}
 
+	// Reserve space for the new textures
+	const auto& data  = static_cast<const MemChunk&>(textures->data());
+	auto        n_def = countTEXTURESDefinitions(data);
+	textures_.reserve(textures_.size() + n_def);
+	name_index_.reserve(name_index_.size() + n_def);
+
 	// Get text to parse
 	Tokenizer tz;
-	tz.openMem(textures->data(), textures->name());
+	tz.openMem(data, textures->name());
 
 	// Parsing gogo
 	while (!tz.atEnd())
 	{
-		// Texture definition
-		if (tz.checkNC("Texture"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Texture"))
-				addTexture(std::move(tex));
-		}
-
-		// Sprite definition
-		else if (tz.checkNC("Sprite"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Sprite"))
-				addTexture(std::move(tex));
-		}
-
-		// Graphic definition
-		else if (tz.checkNC("Graphic"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Graphic"))
-				addTexture(std::move(tex));
-		}
-
-		// WallTexture definition
-		else if (tz.checkNC("WallTexture"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "WallTexture"))
-				addTexture(std::move(tex));
-		}
-
-		// Flat definition
-		else if (tz.checkNC("Flat"))
+		// Old HIRESTEX "Define"
+		if (tz.checkNC("Define"))
 		{
 			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Flat"))
+			if (tex->parseDefine(tz))
 				addTexture(std::move(tex));
 		}
 
-		// Old HIRESTEX "Define"
-		else if (tz.checkNC("Define"))
+		// Texture/Sprite/Graphic/WallTexture/Flat definition
+		else
 		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parseDefine(tz))
-				addTexture(std::move(tex));
+			for (const auto* type : TEXTURES_TYPES)
+			{
+				if (tz.checkNC(type))
+				{
+					auto tex = std::make_unique<CTexture>();
+					if (tex->parse(tz, type))
+						addTexture(std::move(tex));
+					break;
+				}
+			}
 		}
 
 		tz.adv();
@@ -831,6 +914,26 @@ bool TextureXList::findErrors()
 	// 2. A texture with missing patches
 	// 3. A texture with columns not covered by a patch
 
+	// Find all patch entries used, and get their widths (decoded concurrently)
+	vector<ArchiveEntry*>                     patch_entries;
+	std::unordered_map<ArchiveEntry*, size_t> patch_indices;
+	vector<ArchiveEntry*>                     texture_patches; // Patch entry for each patch of each texture, in order
+	for (const auto& texture : textures_)
+		for (size_t i = 0; i < texture->nPatches(); ++i)
+		{
+			auto patch = texture->patches_[i]->patchEntry();
+			if (patch && patch_indices.emplace(patch, patch_entries.size()).second)
+				patch_entries.push_back(patch);
+			texture_patches.push_back(patch);
+		}
+	vector<int> patch_widths(patch_entries.size());
+	entryjobs::run(patch_entries, [&patch_widths](entryjobs::Job& job) {
+		SImage img;
+		img.open(job.data);
+		patch_widths[job.index] = img.width();
+	});
+
+	size_t next_patch = 0;
 	for (unsigned a = 0; a < textures_.size(); a++)
 	{
 		if (textures_[a]->nPatches() == 0)
@@ -844,7 +947,7 @@ bool TextureXList::findErrors()
 			memset(columns.data(), 0, textures_[a]->width());
 			for (size_t i = 0; i < textures_[a]->nPatches(); ++i)
 			{
-				auto patch = textures_[a]->patches_[i]->patchEntry();
+				auto patch = texture_patches[next_patch++];
 				if (patch == nullptr)
 				{
 					ret = true;
@@ -858,10 +961,8 @@ bool TextureXList::findErrors()
 				}
 				else
 				{
-					SImage img;
-					img.open(patch->data());
 					size_t start = std::max<size_t>(0, textures_[a]->patches_[i]->xOffset());
-					size_t end   = std::min<size_t>(textures_[a]->width(), img.width() + start);
+					size_t end   = std::min<size_t>(textures_[a]->width(), patch_widths[patch_indices[patch]] + start);
 					for (size_t c = start; c < end; ++c)
 						columns[c] = 1;
 				}
@@ -8,6 +8,8 @@ namespace slade
 {
 class TextureXList
 {
+	friend class CTexture;
+
 public:
 	// TEXTUREx texture patch
 	struct Patch
@@ -68,5 +70,14 @@ private:
 	vector<unique_ptr<CTexture>> textures_;
 	Format                       txformat_ = Format::Normal;
 	CTexture tex_invalid_{ static_cast<string_view>("INVALID_TEXTURE") }; // Deliberately set the invalid name to >8 characters
+
+	// Case-insensitive name lookup index
+	std::unordered_map<string, vector<CTexture*>> name_index_; // Uppercase name -> textures
+
+	void      addToNameIndex(CTexture* tex);
+	void      removeFromNameIndex(CTexture* tex, string_view name);
+	void      textureRenamed(CTexture* tex, string_view old_name);
+	void      updateIndices(unsigned from);
+	CTexture* indexedTexture(string_view name) const;
 };
 } // namespace slade
@@ -56,6 +56,8 @@ struct Icon
 	{
 		wxImage       wx_image;
 		ArchiveEntry* resource_entry = nullptr;
+		int           scale_to       = 0; // Size to scale to if using a smaller icon's image
+		bool          loaded         = false;
 	};
 
 	string name;
@@ -67,6 +69,7 @@ struct Icon
 vector<Icon>   icons_general;
 vector<Icon>   icons_text_editor;
 vector<Icon>   icons_entry;
+bool           icons_loaded[3] = { false, false, false }; // Per type, icons are loaded on first use
 wxBitmap       icon_empty;
 vector<string> iconsets_entry;
 vector<string> iconsets_general;
@@ -80,11 +83,48 @@ vector<string> iconsets_general;
 // -----------------------------------------------------------------------------
 namespace slade::icons
 {
+bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default);
+
+// -----------------------------------------------------------------------------
+// Loads the list of icons of [type] from slade.pk3 (in the icons/ dir).
+// Icon images aren't read until they are first used
+// -----------------------------------------------------------------------------
+void loadIconList(Type type)
+{
+	auto* res_archive = app::archiveManager().programResourceArchive();
+	auto* dir_icons   = res_archive ? res_archive->dirAtPath("icons") : nullptr;
+	if (!dir_icons)
+		return;
+
+	if (type == General)
+	{
+		loadIconsDir(General, dir_icons->subdir("general").get(), false);
+
+		// Load any missing icons from the default set
+		if (iconset_general != "Default")
+			loadIconsDir(General, dir_icons->subdir("general").get(), true);
+	}
+	else if (type == Entry)
+		loadIconsDir(Entry, dir_icons->subdir("entry_list").get(), false);
+	else if (type == TextEditor)
+		loadIconsDir(TextEditor, dir_icons->subdir("text_editor").get(), false);
+}
+
 // -----------------------------------------------------------------------------
-// Returns a list of all icons of [type]
+// Returns a list of all icons of [type], loading the list if it's the first
+// time it was requested
 // -----------------------------------------------------------------------------
 vector<Icon>& iconList(Type type)
 {
+	if (type != Entry && type != TextEditor)
+		type = General;
+
+	if (!icons_loaded[type])
+	{
+		icons_loaded[type] = true;
+		loadIconList(type);
+	}
+
 	if (type == Entry)
 		return icons_entry;
 	else if (type == TextEditor)
@@ -103,21 +143,6 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 	if (!dir)
 		return false;
 
-	// Check for icon set dirs
-	if (!append_default)
-	{
-		for (const auto& subdir : dir->subdirs())
-		{
-			if (subdir->name() != "16" && subdir->name() != "24" && subdir->name() != "32")
-			{
-				if (type == General)
-					iconsets_general.push_back(subdir->name());
-				else if (type == Entry)
-					iconsets_entry.push_back(subdir->name());
-			}
-		}
-	}
-
 	// Get icon set dir
 	string icon_set_dir = "Default";
 	if (type == Entry && !append_default)
@@ -128,7 +153,7 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 		if (auto subdir = dir->subdir(icon_set_dir))
 			dir = subdir.get();
 
-	auto& icons = iconList(type);
+	auto& icons = type == Entry ? icons_entry : type == TextEditor ? icons_text_editor : icons_general;
 
 	// Load 16x16 icons (these must exist)
 	bool  found  = false;
@@ -160,16 +185,8 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 				continue;
 		}
 
-		// Load 16x16 icon image
-		Icon n_icon;
-		auto stream = wxMemoryInputStream(entry->rawData(), entry->size());
-		if (!n_icon.i16.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
-		{
-			log::warning("Unable to load 16x16 image for icon \"{}\" (is it not png format?)", entry->nameNoExt());
-			continue;
-		}
-
 		// Add the icon
+		Icon n_icon;
 		n_icon.name               = entry->nameNoExt();
 		n_icon.i16.resource_entry = entry.get();
 		icons.push_back(n_icon);
@@ -193,11 +210,6 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 			{
 				if (icon.name == name)
 				{
-					// Load 24x24 icon image
-					auto stream = wxMemoryInputStream(entry->rawData(), entry->size());
-					if (!icon.i24.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
-						log::warning(
-							"Unable to load 24x24 image for icon \"{}\" (is it not png format?)", entry->nameNoExt());
 					icon.i24.resource_entry = entry.get();
 
 					break;
@@ -224,11 +236,6 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 			{
 				if (icon.name == name)
 				{
-					// Load 32x32 icon image
-					auto stream = wxMemoryInputStream(entry->rawData(), entry->size());
-					if (!icon.i32.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
-						log::warning(
-							"Unable to load 32x32 image for icon \"{}\" (is it not png format?)", entry->nameNoExt());
 					icon.i32.resource_entry = entry.get();
 
 					break;
@@ -237,55 +244,85 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 		}
 	}
 
-	// Generate any missing large icons
+	// Any missing large icons are scaled up from the 16x16 image
 	for (auto& icon : icons)
 	{
-		if (!icon.i24.wx_image.IsOk())
+		if (!icon.i24.resource_entry)
 		{
 			icon.i24.resource_entry = icon.i16.resource_entry;
-			icon.i24.wx_image       = icon.i16.wx_image.Copy();
-			icon.i24.wx_image.Rescale(24, 24, wxIMAGE_QUALITY_BICUBIC);
+			icon.i24.scale_to       = 24;
 		}
 
-		if (!icon.i32.wx_image.IsOk())
+		if (!icon.i32.resource_entry)
 		{
 			icon.i32.resource_entry = icon.i16.resource_entry;
-			icon.i32.wx_image       = icon.i16.wx_image.Copy();
-			icon.i32.wx_image.Rescale(32, 32, wxIMAGE_QUALITY_BICUBIC);
+			icon.i32.scale_to       = 32;
 		}
 	}
 
 	return true;
 }
 
-const Icon::Image& validImageForSize(const Icon& icon_def, int size)
+// -----------------------------------------------------------------------------
+// Reads [image] from its resource entry if it hasn't been already.
+// Returns false if the image couldn't be read
+// -----------------------------------------------------------------------------
+bool loadImage(const string& name, Icon::Image& image)
+{
+	if (image.loaded)
+		return image.wx_image.IsOk();
+
+	image.loaded = true;
+	if (!image.resource_entry)
+		return false;
+
+	auto stream = wxMemoryInputStream(image.resource_entry->rawData(), image.resource_entry->size());
+	if (!image.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
+	{
+		log::warning(
+			"Unable to load image {} for icon \"{}\" (is it not png format?)", image.resource_entry->path(true), name);
+		return false;
+	}
+
+	if (image.scale_to > 0)
+		image.wx_image.Rescale(image.scale_to, image.scale_to, wxIMAGE_QUALITY_BICUBIC);
+
+	return true;
+}
+
+Icon::Image& validImageForSize(Icon& icon_def, int size)
 {
 	if (size <= 16)
 		return icon_def.i16;
 
 	if (size <= 24)
-	{
-		if (icon_def.i24.wx_image.IsOk())
-			return icon_def.i24;
-		else
-			return icon_def.i16;
-	}
+		return icon_def.i24;
 
 	// Size >= 25
-	if (icon_def.i32.wx_image.IsOk())
-		return icon_def.i32;
+	return icon_def.i32;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the image of [icon_def] for [size], reading it if needed. Returns the
+// 16x16 image if the larger image couldn't be read
+// -----------------------------------------------------------------------------
+const wxImage& iconImage(Icon& icon_def, int size)
+{
+	auto& image = validImageForSize(icon_def, size);
+	if (loadImage(icon_def.name, image))
+		return image.wx_image;
 
-	return icon_def.i16;
+	loadImage(icon_def.name, icon_def.i16);
+	return icon_def.i16.wx_image;
 }
 } // namespace slade::icons
 
 // -----------------------------------------------------------------------------
-// Loads all icons from slade.pk3 (in the icons/ dir)
+// Finds the available icon sets in slade.pk3 (in the icons/ dir). The icons
+// themselves are loaded when first used
 // -----------------------------------------------------------------------------
 bool icons::loadIcons()
 {
-	auto tempfile = app::path("sladetemp", app::Dir::Temp);
-
 	// Get slade.pk3
 	auto* res_archive = app::archiveManager().programResourceArchive();
 
@@ -295,21 +332,29 @@ bool icons::loadIcons()
 
 	// Get the icons directory of the archive
 	auto* dir_icons = res_archive->dirAtPath("icons");
+	if (!dir_icons)
+		return false;
 
-	// Load general icons
+	// Get icon sets
 	iconsets_general.emplace_back("Default");
-	loadIconsDir(General, dir_icons->subdir("general").get(), false);
-
-	// Load entry list icons
 	iconsets_entry.emplace_back("Default");
-	loadIconsDir(Entry, dir_icons->subdir("entry_list").get(), false);
-
-	// Load text editor icons
-	loadIconsDir(TextEditor, dir_icons->subdir("text_editor").get(), false);
+	for (auto type : { General, Entry })
+	{
+		auto dir = dir_icons->subdir(type == General ? "general" : "entry_list");
+		if (!dir)
+			continue;
 
-	// Load any missing icons from the default set
-	if (iconset_general != "Default")
-		loadIconsDir(General, dir_icons->subdir("general").get(), true);
+		for (const auto& subdir : dir->subdirs())
+		{
+			if (subdir->name() != "16" && subdir->name() != "24" && subdir->name() != "32")
+			{
+				if (type == General)
+					iconsets_general.push_back(subdir->name());
+				else
+					iconsets_entry.push_back(subdir->name());
+			}
+		}
+	}
 
 	return true;
 }
@@ -337,9 +382,12 @@ wxBitmap icons::getIcon(Type type, string_view name, int size, bool log_missing)
 		return icon;
 	}
 
-	for (const auto& icon : iconList(type))
+	for (auto& icon : iconList(type))
 		if (icon.name == name)
-			return wxBitmap(validImageForSize(icon, size).wx_image);
+		{
+			const auto& image = iconImage(icon, size);
+			return image.IsOk() ? wxBitmap(image) : wxNullBitmap;
+		}
 
 	if (log_missing)
 		log::warning(2, "Icon \"{}\" does not exist", name);
@@ -367,11 +415,14 @@ wxBitmap icons::getPaddedIcon(Type type, string_view name, int size, Point2i pad
 		return icon;
 	}
 
-	for (const auto& icon : iconList(type))
+	for (auto& icon : iconList(type))
 		if (icon.name == name)
 		{
-			const auto& image = validImageForSize(icon, size).wx_image;
-			wxImage     padded(image.GetWidth() + padding.x * 2, image.GetHeight() + padding.y * 2);
+			const auto& image = iconImage(icon, size);
+			if (!image.IsOk())
+				return wxNullBitmap;
+
+			wxImage padded(image.GetWidth() + padding.x * 2, image.GetHeight() + padding.y * 2);
 			padded.SetMaskColour(0, 0, 0);
 			padded.InitAlpha();
 			padded.Paste(image, padding.x, padding.y);
@@ -435,7 +486,7 @@ ArchiveEntry* icons::getIconEntry(Type type, string_view name, int size)
 	}
 
 	auto& icons = iconList(type);
-	for (const auto& icon : icons)
+	for (auto& icon : icons)
 	{
 		if (icon.name == name)
 			return validImageForSize(icon, size).resource_entry;
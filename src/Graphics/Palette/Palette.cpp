@@ -37,6 +37,9 @@
 #include "Utility/CIEDeltaEquations.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <array>
+#include <atomic>
+#include <mutex>
 
 using namespace slade;
 
@@ -56,6 +59,122 @@ CVAR(Float, col_match_l, 1.0, CVar::Flag::Save)
 EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
+namespace
+{
+// The match cache splits the RGB cube into 32x32x32 blocks of 8x8x8 colours,
+// blocks are only allocated when a colour within them is first looked up
+constexpr unsigned match_block_bits = 3;
+constexpr unsigned match_block_size = 1 << (match_block_bits * 3);
+constexpr unsigned match_n_blocks   = 1 << ((8 - match_block_bits) * 3);
+constexpr unsigned match_n_modes    = static_cast<unsigned>(Palette::ColourMatch::Stop);
+constexpr uint16_t match_unset      = 0xFFFF;
+
+std::mutex match_cache_mutex; // For allocating match cache tables/blocks
+
+// Be nice if there was an easier way to convert from int -> enum class,
+// but then that's kind of the point of them I guess
+const Palette::ColourMatch cm_convert[] = {
+	Palette::ColourMatch::Default, Palette::ColourMatch::Old, Palette::ColourMatch::RGB,
+	Palette::ColourMatch::HSL,     Palette::ColourMatch::C76, Palette::ColourMatch::C94,
+	Palette::ColourMatch::C2K,     Palette::ColourMatch::Stop,
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+// Palette::MatchCache Struct
+//
+// Caches the results of nearestColour for each colour match mode. Lookups can
+// happen from multiple threads at once (eg. images being converted in the
+// background), so entries are atomic and tables/blocks are allocated under
+// [match_cache_mutex]. The cache must only be cleared when the palette itself
+// is modified, which is never done concurrently with lookups
+// -----------------------------------------------------------------------------
+struct Palette::MatchCache
+{
+	using Block = std::atomic<uint16_t>;
+
+	struct Table
+	{
+		float                                            weights[3] = { 0.f, 0.f, 0.f };
+		std::array<std::atomic<Block*>, match_n_blocks> blocks{};
+	};
+
+	std::array<std::atomic<Table*>, match_n_modes> tables{};
+
+	~MatchCache() { clear(); }
+
+	static void deleteTable(Table* table)
+	{
+		if (!table)
+			return;
+
+		for (auto& block : table->blocks)
+			delete[] block.load();
+		delete table;
+	}
+
+	void clear()
+	{
+		for (auto& table_ptr : tables)
+			deleteTable(table_ptr.exchange(nullptr));
+	}
+
+	// Returns the cache entry for [colour] in [match] mode, allocating its
+	// table/block if needed
+	Block& entry(const ColRGBA& colour, ColourMatch match, const float weights[3])
+	{
+		auto& table_ptr = tables[static_cast<unsigned>(match)];
+		auto  table     = table_ptr.load(std::memory_order_acquire);
+
+		// Weights (col_match_* cvars) changed since the table was filled, start
+		// again. The cvars are only changed from the ui, never during a lookup
+		if (table
+			&& (table->weights[0] != weights[0] || table->weights[1] != weights[1]
+				|| table->weights[2] != weights[2]))
+		{
+			std::lock_guard<std::mutex> lock(match_cache_mutex);
+			deleteTable(table_ptr.exchange(nullptr));
+			table = nullptr;
+		}
+
+		// Create table if needed
+		if (!table)
+		{
+			std::lock_guard<std::mutex> lock(match_cache_mutex);
+			table = table_ptr.load(std::memory_order_acquire);
+			if (!table)
+			{
+				table = new Table;
+				for (unsigned a = 0; a < 3; a++)
+					table->weights[a] = weights[a];
+				table_ptr.store(table, std::memory_order_release);
+			}
+		}
+
+		// Get block, creating it if needed
+		constexpr unsigned shift = match_block_bits;
+		constexpr unsigned mask  = (1 << shift) - 1;
+		unsigned block_id = ((colour.r >> shift) << ((8 - shift) * 2)) | ((colour.g >> shift) << (8 - shift))
+							| (colour.b >> shift);
+		auto& block_ptr = table->blocks[block_id];
+		auto  block     = block_ptr.load(std::memory_order_acquire);
+		if (!block)
+		{
+			std::lock_guard<std::mutex> lock(match_cache_mutex);
+			block = block_ptr.load(std::memory_order_acquire);
+			if (!block)
+			{
+				block = new Block[match_block_size];
+				for (unsigned a = 0; a < match_block_size; a++)
+					block[a].store(match_unset, std::memory_order_relaxed);
+				block_ptr.store(block, std::memory_order_release);
+			}
+		}
+
+		return block[((colour.r & mask) << (shift * 2)) | ((colour.g & mask) << shift) | (colour.b & mask)];
+	}
+};
 
 
 // -----------------------------------------------------------------------------
@@ -68,7 +187,12 @@ EXTERN_CVAR(Float, col_greyscale_b)
 // -----------------------------------------------------------------------------
 // Palette class constructor
 // -----------------------------------------------------------------------------
-Palette::Palette(unsigned size) : colours_{ size }, colours_hsl_{ size }, colours_lab_{ size }, index_trans_{ -1 }
+Palette::Palette(unsigned size) :
+	colours_{ size },
+	colours_hsl_{ size },
+	colours_lab_{ size },
+	index_trans_{ -1 },
+	match_cache_{ new MatchCache }
 {
 	// Init palette (to greyscale)
 	for (unsigned a = 0; a < size; a++)
@@ -80,28 +204,43 @@ Palette::Palette(unsigned size) : colours_{ size }, colours_hsl_{ size }, colour
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Palette class destructor
+// -----------------------------------------------------------------------------
+Palette::~Palette() = default;
+
+// -----------------------------------------------------------------------------
+// Copies the colours of [pal] into this palette
+// -----------------------------------------------------------------------------
+Palette& Palette::operator=(const Palette& pal)
+{
+	if (&pal != this)
+	{
+		colours_     = pal.colours_;
+		colours_hsl_ = pal.colours_hsl_;
+		colours_lab_ = pal.colours_lab_;
+		index_trans_ = pal.index_trans_;
+		clearMatchCache();
+	}
+
+	return *this;
+}
+
 // -----------------------------------------------------------------------------
 // Reads colour information from raw data (MemChunk)
 // -----------------------------------------------------------------------------
-bool Palette::loadMem(MemChunk& mc)
+bool Palette::loadMem(const MemChunk& mc)
 {
 	// Check that the given data has at least 1 colour (3 bytes)
 	if (mc.size() < 3)
 		return false;
 
 	// Read in colours
-	mc.seek(0, SEEK_SET);
 	int c = 0;
-	while (mc.currentPos() < mc.size())
+	for (unsigned a = 0; a + 3 <= mc.size(); a += 3)
 	{
-		uint8_t rgb[3] = { 0, 0, 0 };
-
-		// Read RGB value
-		if (!mc.read(rgb, 3))
-			break;
-
 		// Set colour in palette
-		colours_[c].set(rgb[0], rgb[1], rgb[2], 255, -1, c);
+		colours_[c].set(mc[a], mc[a + 1], mc[a + 2], 255, -1, c);
 		colours_lab_[c] = colours_[c].asLAB();
 		colours_hsl_[c] = colours_[c].asHSL();
 
@@ -109,7 +248,7 @@ bool Palette::loadMem(MemChunk& mc)
 		if (++c == 256)
 			break;
 	}
-	mc.seek(0, SEEK_SET);
+	clearMatchCache();
 
 	return true;
 }
@@ -136,6 +275,7 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 		if (++c == 256)
 			break;
 	}
+	clearMatchCache();
 
 	return true;
 }
@@ -143,7 +283,7 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 // -----------------------------------------------------------------------------
 // Reads colour information from a palette format (MemChunk)
 // -----------------------------------------------------------------------------
-bool Palette::loadMem(MemChunk& mc, Format format)
+bool Palette::loadMem(const MemChunk& mc, Format format)
 {
 	// Raw data
 	if (format == Format::Raw)
@@ -430,6 +570,7 @@ void Palette::setColour(uint8_t index, const ColRGBA& col)
 	colours_[index].index = index;
 	colours_lab_[index]   = colours_[index].asLAB();
 	colours_hsl_[index]   = colours_[index].asHSL();
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -440,6 +581,7 @@ void Palette::setColourR(uint8_t index, uint8_t val)
 	colours_[index].r   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -450,6 +592,7 @@ void Palette::setColourG(uint8_t index, uint8_t val)
 	colours_[index].g   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -460,6 +603,7 @@ void Palette::setColourB(uint8_t index, uint8_t val)
 	colours_[index].b   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -495,6 +639,8 @@ void Palette::setGradient(uint8_t startIndex, uint8_t endIndex, const ColRGBA& s
 			a + startIndex);
 		colours_[a + startIndex].set(gradCol);
 	}
+
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -572,24 +718,56 @@ double Palette::colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB&
 }
 
 // -----------------------------------------------------------------------------
-// Returns the index of the closest colour in the palette to [colour]
+// Returns the index of the closest colour in the palette to [colour].
+// Results are cached per colour match mode, so repeated lookups of the same
+// colour (eg. when converting an image) don't need to check the whole palette
 // -----------------------------------------------------------------------------
 short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
+{
+	if (match == ColourMatch::Default)
+		match = cm_convert[col_match];
+	if (match <= ColourMatch::Default || match >= ColourMatch::Stop)
+		return findNearestColour(colour, match);
+
+	// Get the weights the result depends on (if any)
+	float weights[3] = { 0.f, 0.f, 0.f };
+	if (match == ColourMatch::RGB)
+	{
+		weights[0] = col_match_r;
+		weights[1] = col_match_g;
+		weights[2] = col_match_b;
+	}
+	else if (match == ColourMatch::HSL)
+	{
+		weights[0] = col_match_h;
+		weights[1] = col_match_s;
+		weights[2] = col_match_l;
+	}
+
+	// Check cache
+	auto& entry = match_cache_->entry(colour, match, weights);
+	auto  index = entry.load(std::memory_order_relaxed);
+	if (index != match_unset)
+		return index;
+
+	// Not cached, find nearest colour
+	auto nearest = findNearestColour(colour, match);
+	entry.store(nearest, std::memory_order_relaxed);
+
+	return nearest;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour], checking
+// every colour in the palette using the [match] method
+// -----------------------------------------------------------------------------
+short Palette::findNearestColour(const ColRGBA& colour, ColourMatch match)
 {
 	double min_d = 999999;
 	short  index = 0;
 	ColHSL chsl  = colour.asHSL();
 	ColLAB clab  = colour.asLAB();
 
-	// Be nice if there was an easier way to convert from int -> enum class,
-	// but then that's kind of the point of them I guess
-	static vector<ColourMatch> cm_convert = {
-		ColourMatch::Default, ColourMatch::Old, ColourMatch::RGB, ColourMatch::HSL,
-		ColourMatch::C76,     ColourMatch::C94, ColourMatch::C2K, ColourMatch::Stop,
-	};
-	if (match == ColourMatch::Default)
-		match = cm_convert[col_match];
-
 	double delta;
 	for (short a = 0; a < 256; a++)
 	{
@@ -776,6 +954,8 @@ void Palette::saturate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -804,6 +984,8 @@ void Palette::illuminate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -832,6 +1014,8 @@ void Palette::shift(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	clearMatchCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -854,3 +1038,12 @@ void Palette::invert(int start, int end)
 		setColour(i, colours_[i]); // Just to update the HSL values
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Clears all cached nearestColour results, must be called whenever any palette
+// colour is changed
+// -----------------------------------------------------------------------------
+void Palette::clearMatchCache()
+{
+	match_cache_->clear();
+}
@@ -30,15 +30,17 @@ public:
 
 	Palette(unsigned size = 256);
 	Palette(const Palette& pal) : Palette(pal.colours_.size()) { copyPalette(&pal); }
-	~Palette() = default;
+	~Palette();
+
+	Palette& operator=(const Palette& pal);
 
 	const vector<ColRGBA>& colours() const { return colours_; }
 	ColRGBA                colour(uint8_t index) const { return colours_[index]; }
 	short                  transIndex() const { return index_trans_; }
 
-	bool loadMem(MemChunk& mc);
+	bool loadMem(const MemChunk& mc);
 	bool loadMem(const uint8_t* data, uint32_t size);
-	bool loadMem(MemChunk& mc, Format format);
+	bool loadMem(const MemChunk& mc, Format format);
 	bool loadFile(string_view filename, Format format = Format::Raw);
 	bool saveMem(MemChunk& mc, Format format = Format::Raw, string_view name = "");
 	bool saveFile(string_view filename, Format format = Format::Raw);
@@ -69,11 +71,17 @@ public:
 	void idtint(int r, int g, int b, int shift, int steps);
 
 private:
-	vector<ColRGBA> colours_;
-	vector<ColHSL>  colours_hsl_;
-	vector<ColLAB>  colours_lab_;
-	short           index_trans_;
+	// Lazily filled RGB -> nearest index lookup tables (see Palette.cpp)
+	struct MatchCache;
+
+	vector<ColRGBA>        colours_;
+	vector<ColHSL>         colours_hsl_;
+	vector<ColLAB>         colours_lab_;
+	short                  index_trans_;
+	unique_ptr<MatchCache> match_cache_;
 
 	double colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match);
+	short  findNearestColour(const ColRGBA& colour, ColourMatch match);
+	void   clearMatchCache();
 };
 } // namespace slade
@@ -7,10 +7,11 @@ public:
 	SIFDoomGfx(string_view id = "doom", string_view name = "Doom Gfx", int reliability = 230) :
 		SIFormat(id, name, "lmp", reliability)
 	{
+		min_size_ = sizeof(gfx::PatchHeader) + 1;
 	}
 	~SIFDoomGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		if (EntryDataFormat::format("img_doom")->isThisFormat(mc))
 			return true;
@@ -18,13 +19,13 @@ public:
 			return false;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader hdr;
-		mc.read(&hdr, 8, 0);
+		mc.read(0, &hdr, 8);
 
 		// Setup info
 		info.width       = hdr.width;
@@ -81,7 +82,7 @@ public:
 	}
 
 protected:
-	bool readDoomFormat(SImage& image, MemChunk& data, int version) const
+	bool readDoomFormat(SImage& image, const MemChunk& data, int version) const
 	{
 		// Init variables
 		auto gfx_data = data.data();
@@ -110,29 +111,25 @@ protected:
 			hdr_size    = 8;
 		}
 
-		// Create image
+		// Create image (colour is set to palette index 0, mask to fully transparent)
 		image.create(width, height, SImage::Type::PalMask);
-
-		// Read column offsets
-		vector<uint32_t> col_offsets(width);
-		if (version > 0)
-		{
-			auto c_ofs = (uint16_t*)((uint8_t*)gfx_data + hdr_size);
-			for (int a = 0; a < width; a++)
-				col_offsets[a] = wxUINT16_SWAP_ON_BE(c_ofs[a]);
-		}
-		else
-		{
-			auto c_ofs = (uint32_t*)((uint8_t*)gfx_data + hdr_size);
-			for (int a = 0; a < width; a++)
-				col_offsets[a] = wxUINT32_SWAP_ON_BE(c_ofs[a]);
-		}
-
-		// Load data
 		uint8_t* img_data = imageData(image);
-		memset(img_data, 0, width * height); // Set colour to palette index 0
 		uint8_t* img_mask = imageMask(image);
-		memset(img_mask, 0, width * height); // Set mask to fully transparent
+
+		// Column offsets are read directly from the data when needed
+		auto c_ofs      = gfx_data + hdr_size;
+		auto col_offset = [c_ofs, version](int c) -> uint32_t {
+			if (version > 0)
+			{
+				uint16_t offset;
+				memcpy(&offset, c_ofs + c * 2, 2);
+				return wxUINT16_SWAP_ON_BE(offset);
+			}
+
+			uint32_t offset;
+			memcpy(&offset, c_ofs + c * 4, 4);
+			return wxUINT32_SWAP_ON_BE(offset);
+		};
 
 		// Check for the Pleiades hack:
 		// Roger Ritenour's pleiades.wad for ZDoom uses 256-tall sky textures,
@@ -141,41 +138,40 @@ protected:
 		// every column represents precisely 261 bytes, in other words just enough
 		// for a single post of 256 pixels.
 		bool pleiadeshack = false;
-		if (height == 256)
+		if (height == 256 && width > 0)
 		{
 			pleiadeshack = true;
 			for (int c = 1; c < width; ++c)
 			{
-				if (col_offsets[c] - col_offsets[c - 1] != 261)
+				if (col_offset(c) - col_offset(c - 1) != 261)
 				{
 					pleiadeshack = false;
 					break;
 				}
 			}
-			if (data.size() - col_offsets[width - 1] != 261)
+			if (data.size() - col_offset(width - 1) != 261)
 				pleiadeshack = false;
 		}
 
 		// Load data
+		const size_t data_size = data.size();
+		const size_t post_hdr  = version == 0 ? 3 : 2; // Row offset, no. of pixels (and unused byte for version 0)
+		const size_t post_end  = version == 0 ? 1 : 0; // Unused byte after the pixels (version 0)
 		for (int c = 0; c < width; c++)
 		{
-			// Get current column offset (byteswap if needed)
-			auto col_offset = col_offsets[c]; // wxUINT32_SWAP_ON_BE(col_offsets[c]);
+			// Get current column offset
+			size_t pos = col_offset(c);
 
 			// Check column offset is valid
-			if (col_offset >= data.size())
+			if (pos >= data_size)
 				return false;
 
-			// Go to start of column
-			const uint8_t* bits = gfx_data;
-			bits += col_offset;
-
 			// Read posts
 			int top = -1;
-			while (true)
+			while (pos + 1 < data_size)
 			{
 				// Get row offset
-				auto row = *bits;
+				auto row = gfx_data[pos];
 
 				if (row == 0xFF) // End of column?
 					break;
@@ -186,41 +182,26 @@ protected:
 				else
 					top = row;
 
-				// Get no. of pixels
-				bits++;
-				uint16_t n_pix = *bits;
+				// Get no. of pixels (if this is a Pleiades sky, the height is 256)
+				size_t n_pix = pleiadeshack ? 256 : gfx_data[pos + 1];
 
-				// If this is a Pleiades sky, the height is 256.
-				if (pleiadeshack)
-					n_pix = 256;
+				// Copy the post pixels down the column, stopping at the bottom of
+				// the image or the end of the gfx data
+				size_t pix_start = pos + post_hdr;
+				size_t n_copy    = std::min<size_t>(n_pix, top < height ? height - top : 0);
+				n_copy           = std::min<size_t>(n_copy, pix_start < data_size ? data_size - pix_start : 0);
 
-				if (version == 0)
-					bits++; // Skip buffer
-				for (uint16_t p = 0; p < n_pix; p++)
+				const uint8_t* pixels = gfx_data + pix_start;
+				size_t         dest   = static_cast<size_t>(top) * width + c;
+				for (size_t p = 0; p < n_copy; ++p, dest += width)
 				{
-					// Get pixel position
-					bits++;
-					int pos = ((top + p) * width + c);
-
-					// Stop if we're outside the image
-					if (pos >= width * height)
-						break;
-
-					// Stop if for some reason we're outside the gfx data
-					if (bits >= gfx_data + data.size())
-						break;
-
-					// Fail if bogus data gives a negative pos (this corrupts the heap!)
-					if (pos < 0)
-						return false;
-
-					// Write pixel data
-					img_data[pos] = *bits;
-					img_mask[pos] = 255;
+					img_data[dest] = pixels[p];
+					img_mask[dest] = 255;
 				}
-				if (version == 0)
-					bits++; // Skip buffer
-				bits++;     // Go to next row offset
+
+				// Go to next row offset. If the post was cut short, reading
+				// continues one byte after the last pixel copied
+				pos = pix_start + (n_copy < n_pix ? n_copy + 1 : n_pix) + post_end;
 			}
 		}
 
@@ -231,42 +212,60 @@ protected:
 		return true;
 	}
 
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readDoomFormat(image, data, 0); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readDoomFormat(image, data, 0); }
 
 	bool writeImage(SImage& image, MemChunk& out, Palette* pal, int index) override
 	{
-		// Convert image to column/post structure
-		vector<Column> columns;
-		auto           data = imageData(image);
-		auto           mask = imageMask(image);
+		auto       data   = imageData(std::as_const(image));
+		auto       mask   = imageMask(std::as_const(image));
+		const auto width  = image.width();
+		const auto height = image.height();
+
+		// Build the gfx data in a buffer, allocated up front for the header,
+		// column offsets and (roughly) the column data of an opaque image
+		vector<uint8_t> gfx;
+		gfx.reserve(8 + width * 4 + static_cast<size_t>(width) * (height + 4 * (height / 128 + 2) + 1));
+		gfx.resize(8 + width * 4);
+
+		// Setup header
+		gfx::PatchHeader header;
+		header.width  = wxINT16_SWAP_ON_BE(static_cast<int16_t>(width));
+		header.height = wxINT16_SWAP_ON_BE(static_cast<int16_t>(height));
+		header.left   = wxINT16_SWAP_ON_BE(static_cast<int16_t>(image.offset().x));
+		header.top    = wxINT16_SWAP_ON_BE(static_cast<int16_t>(image.offset().y));
+		memcpy(gfx.data(), &header.width, 2);
+		memcpy(gfx.data() + 2, &header.height, 2);
+		memcpy(gfx.data() + 4, &header.left, 2);
+		memcpy(gfx.data() + 6, &header.top, 2);
 
 		// Go through columns
-		uint32_t offset = 0;
-		for (int c = 0; c < image.width(); c++)
+		for (int c = 0; c < width; c++)
 		{
-			Column col;
-			Post   post;
-			post.row_off   = 0;
-			bool ispost    = false;
-			bool first_254 = true; // First 254 pixels should use absolute offsets
-
-			offset          = c;
+			// Record column offset
+			auto col_offset = wxUINT32_SWAP_ON_BE(static_cast<uint32_t>(gfx.size()));
+			memcpy(gfx.data() + 8 + c * 4, &col_offset, 4);
+
+			bool   ispost     = false;
+			bool   first_254  = true; // First 254 pixels should use absolute offsets
+			size_t post_start = 0;
+			auto   end_post   = [&gfx, &post_start, &ispost]() {
+				// Set no. of pixels and unused bytes (copies of the first and
+				// last pixels)
+				gfx[post_start + 1] = static_cast<uint8_t>(gfx.size() - post_start - 3);
+				gfx[post_start + 2] = gfx[post_start + 3];
+				gfx.push_back(gfx.back());
+				ispost = false;
+			};
+
+			size_t  offset  = c;
 			uint8_t row_off = 0;
-			for (int r = 0; r < image.height(); r++)
+			for (int r = 0; r < height; r++)
 			{
 				// For vanilla-compatible dimensions, use a split at 128 to prevent tiling.
-				if (image.height() < 256)
+				if (height < 256)
 				{
-					if (row_off == 128)
-					{
-						// Finish current post if any
-						if (ispost)
-						{
-							col.posts.push_back(post);
-							post.pixels.clear();
-							ispost = false;
-						}
-					}
+					if (row_off == 128 && ispost)
+						end_post();
 				}
 
 				// Taller images cannot be expressed without tall patch support.
@@ -275,157 +274,57 @@ protected:
 				{
 					// Finish current post if any
 					if (ispost)
-					{
-						col.posts.push_back(post);
-						post.pixels.clear();
-						ispost = false;
-					}
+						end_post();
 
 					// Begin relative offsets
 					first_254 = false;
 
 					// Create dummy post
-					post.row_off = 254;
-					col.posts.push_back(post);
-
-					// Clear post
+					gfx.insert(gfx.end(), { 254, 0, 0, 0 });
 					row_off = 0;
-					ispost  = false;
 				}
 
 				// If the current pixel is not transparent, add it to the current post
 				if (!mask || mask[offset] > 0)
 				{
-					// If we're not currently building a post, begin one and set its offset
+					// If we're not currently building a post, begin one at the current offset
 					if (!ispost)
 					{
-						// Set offset
-						post.row_off = row_off;
+						post_start = gfx.size();
+						gfx.insert(gfx.end(), { row_off, 0, 0 });
 
 						// Reset offset if we're in relative offsets mode
 						if (!first_254)
 							row_off = 0;
 
-						// Start post
 						ispost = true;
 					}
 
 					// Add the pixel to the post
-					post.pixels.push_back(data[offset]);
+					gfx.push_back(data[offset]);
 				}
 				else if (ispost)
-				{
-					// If the current pixel is transparent and we are currently building
-					// a post, add the current post to the list and clear it
-					col.posts.push_back(post);
-					post.pixels.clear();
-					ispost = false;
-				}
+					end_post();
 
 				// Go to next row
-				offset += image.width();
+				offset += width;
 				row_off++;
 			}
 
-			// If the column ended with a post, add it
+			// If the column ended with a post, finish it
 			if (ispost)
-				col.posts.push_back(post);
-
-			// Add the column data
-			columns.push_back(col);
+				end_post();
 
-			// Go to next column
-			offset++;
+			// Write '255' row to signal end of column
+			gfx.push_back(255);
 		}
 
 		// Write doom gfx data to output
 		out.clear();
-		out.seek(0, SEEK_SET);
-
-		// Setup header
-		gfx::PatchHeader header;
-		header.top    = image.offset().y;
-		header.left   = image.offset().x;
-		header.width  = image.width();
-		header.height = image.height();
-
-		// Byteswap header values if needed
-		header.top    = wxINT16_SWAP_ON_BE(header.top);
-		header.left   = wxINT16_SWAP_ON_BE(header.left);
-		header.width  = wxINT16_SWAP_ON_BE(header.width);
-		header.height = wxINT16_SWAP_ON_BE(header.height);
-
-		// Write it
-		out.write(&header.width, 2);
-		out.write(&header.height, 2);
-		out.write(&header.left, 2);
-		out.write(&header.top, 2);
-
-		// Write dummy column offsets for now
-		vector<uint32_t> col_offsets(columns.size());
-		out.write(col_offsets.data(), columns.size() * 4);
-
-		// Write columns
-		for (size_t c = 0; c < columns.size(); c++)
-		{
-			// Record column offset
-			col_offsets[c] = wxUINT32_SWAP_ON_BE(out.currentPos());
-
-			// Determine column size (in bytes)
-			uint32_t col_size = 0;
-			for (auto& post : columns[c].posts)
-				col_size += post.pixels.size() + 4;
-
-			// Allocate memory to write the column data
-			out.reSize(out.size() + col_size, true);
-
-			// Write column posts
-			for (auto& post : columns[c].posts)
-			{
-				// Write row offset
-				out.write(&post.row_off, 1);
-
-				// Write no. of pixels
-				uint8_t npix = post.pixels.size();
-				out.write(&npix, 1);
-
-				// Write unused byte
-				uint8_t temp = (npix > 0) ? post.pixels[0] : 0;
-				out.write(&temp, 1);
-
-				// Write pixels
-				for (auto& pixel : post.pixels)
-					out.write(&pixel, 1);
-
-				// Write unused byte
-				temp = (npix > 0) ? post.pixels.back() : 0;
-				out.write(&temp, 1);
-			}
-
-			// Write '255' row to signal end of column
-			uint8_t temp = 255;
-			out.write(&temp, 1);
-		}
-
-		// Now we write column offsets
-		out.seek(8, SEEK_SET);
-		out.write(col_offsets.data(), columns.size() * 4);
+		out.importMem(gfx.data(), gfx.size());
 
 		return true;
 	}
-
-private:
-	// Doom Gfx format structs
-	struct Post
-	{
-		uint8_t         row_off;
-		vector<uint8_t> pixels;
-	};
-
-	struct Column
-	{
-		vector<Post> posts;
-	};
 };
 
 class SIFDoomBetaGfx : public SIFDoomGfx
@@ -434,9 +333,9 @@ public:
 	SIFDoomBetaGfx() : SIFDoomGfx("doom_beta", "Doom Gfx (Beta)", 160) {}
 	~SIFDoomBetaGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_beta")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_beta")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		auto info   = SIFDoomGfx::info(mc, index);
 		info.format = id_;
@@ -449,18 +348,21 @@ public:
 	bool     convertWritable(SImage& image, ConvertOptions opt) override { return false; }
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readDoomFormat(image, data, 1); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readDoomFormat(image, data, 1); }
 };
 
 class SIFDoomAlphaGfx : public SIFDoomGfx
 {
 public:
-	SIFDoomAlphaGfx() : SIFDoomGfx("doom_alpha", "Doom Gfx (Alpha)", 100) {}
+	SIFDoomAlphaGfx() : SIFDoomGfx("doom_alpha", "Doom Gfx (Alpha)", 100)
+	{
+		min_size_ = sizeof(gfx::OldPatchHeader) + 1;
+	}
 	~SIFDoomAlphaGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_alpha")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_alpha")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -481,24 +383,24 @@ public:
 	bool     convertWritable(SImage& image, ConvertOptions opt) override { return false; }
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readDoomFormat(image, data, 2); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readDoomFormat(image, data, 2); }
 };
 
 class SIFDoomArah : public SIFormat
 {
 public:
-	SIFDoomArah() : SIFormat("doom_arah", "Doom Arah", "lmp", 100) {}
+	SIFDoomArah() : SIFormat("doom_arah", "Doom Arah", "lmp", 100) { min_size_ = sizeof(gfx::PatchHeader); }
 	~SIFDoomArah() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_arah")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_arah")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader header;
-		mc.read(&header, 8, 0);
+		mc.read(0, &header, 8);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_BE(header.width);
@@ -512,11 +414,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::PatchHeader header;
-		data.read(&header, 8, 0);
+		data.read(0, &header, 8);
 		int width    = wxINT16_SWAP_ON_BE(header.width);
 		int height   = wxINT16_SWAP_ON_BE(header.height);
 		int offset_x = wxINT16_SWAP_ON_BE(header.left);
@@ -528,7 +430,7 @@ protected:
 		uint8_t* img_mask = imageMask(image);
 
 		// Read raw pixel data
-		data.read(img_data, width * height, 8);
+		data.read(8, img_data, width * height);
 
 		// Create mask (all opaque)
 		memset(img_mask, 255, width * height);
@@ -549,12 +451,12 @@ protected:
 class SIFDoomSnea : public SIFormat
 {
 public:
-	SIFDoomSnea() : SIFormat("doom_snea", "Doom Snea", "lmp") {}
+	SIFDoomSnea() : SIFormat("doom_snea", "Doom Snea", "lmp") { min_size_ = 6; }
 	~SIFDoomSnea() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_snea")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_snea")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -569,7 +471,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Check/setup size
 		uint8_t qwidth = data[0];
@@ -618,18 +520,18 @@ protected:
 class SIFDoomPSX : public SIFormat
 {
 public:
-	SIFDoomPSX() : SIFormat("doom_psx", "Doom PSX", "lmp", 100) {}
+	SIFDoomPSX() : SIFormat("doom_psx", "Doom PSX", "lmp", 100) { min_size_ = sizeof(gfx::PSXPicHeader); }
 	~SIFDoomPSX() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_psx")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_psx")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::PatchHeader header;
-		mc.read(&header, 8, 0);
+		mc.read(0, &header, 8);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_BE(header.width);
@@ -678,11 +580,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::PSXPicHeader header;
-		data.read(&header, 8, 0);
+		data.read(0, &header, 8);
 		int width    = wxINT16_SWAP_ON_BE(header.width);
 		int height   = wxINT16_SWAP_ON_BE(header.height);
 		int offset_x = wxINT16_SWAP_ON_BE(header.left);
@@ -694,7 +596,7 @@ protected:
 		auto img_mask = imageMask(image);
 
 		// Read raw pixel data
-		data.read(img_data, width * height, 8);
+		data.read(8, img_data, width * height);
 
 		// Create mask (all opaque)
 		memset(img_mask, 255, width * height);
@@ -792,18 +694,18 @@ protected:
 class SIFDoomJaguar : public SIFormat
 {
 public:
-	SIFDoomJaguar() : SIFormat("doom_jaguar", "Doom Jaguar", "lmp", 85) {}
+	SIFDoomJaguar() : SIFormat("doom_jaguar", "Doom Jaguar", "lmp", 85) { min_size_ = sizeof(gfx::JagPicHeader); }
 	~SIFDoomJaguar() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_jaguar")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_jaguar")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Read header
 		gfx::JagPicHeader header;
-		mc.read(&header, 16, 0);
+		mc.read(0, &header, 16);
 
 		// Set info
 		info.width     = wxINT16_SWAP_ON_LE(header.width);
@@ -817,11 +719,11 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
 		gfx::JagPicHeader header;
-		data.read(&header, 16, 0);
+		data.read(0, &header, 16);
 		int width  = wxINT16_SWAP_ON_LE(header.width);
 		int height = wxINT16_SWAP_ON_LE(header.height);
 		int depth  = wxINT16_SWAP_ON_LE(header.depth);
@@ -838,7 +740,7 @@ protected:
 		// Read raw pixel data
 		if (depth == 3)
 		{
-			data.read(img_data, width * height);
+			data.read(16, img_data, width * height);
 		}
 		else if (depth == 2)
 		{
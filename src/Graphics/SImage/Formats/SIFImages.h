@@ -10,24 +10,33 @@ public:
 	uint32_t  crc() const { return crc_; }
 	MemChunk& data() { return data_; }
 
-	void read(MemChunk& mc)
+	// Reads the chunk at [offset] in [mc], and moves [offset] to the next chunk.
+	// Returns false if there is no complete chunk at [offset]
+	bool read(const MemChunk& mc, unsigned& offset)
 	{
 		// Read size and chunk name
-		mc.read(&size_, 4);
-		mc.read(name_, 4);
+		if (!mc.read(offset, &size_, 4) || !mc.read(offset + 4, name_, 4))
+			return false;
 
 		// Endianness correction
 		size_ = wxUINT32_SWAP_ON_LE(size_);
 
-		// Read chunk data
+		// Check chunk data and crc fit
 		data_.clear();
-		mc.readMC(data_, size_);
+		if (static_cast<size_t>(offset) + size_ + 12 > mc.size())
+			return false;
+
+		// Read chunk data
+		data_.importMem(mc.data() + offset + 8, size_);
 
 		// Read crc
-		mc.read(&crc_, 4);
+		mc.read(offset + 8 + size_, &crc_, 4);
 
 		// Endianness correction
 		crc_ = wxUINT32_SWAP_ON_LE(crc_);
+
+		offset += size_ + 12;
+		return true;
 	}
 
 	void write(MemChunk& mc) const
@@ -77,13 +86,14 @@ private:
 class SIFPng : public SIFormat
 {
 public:
-	SIFPng() : SIFormat("png", "PNG", "png") {}
-
-	bool isThisFormat(MemChunk& mc) override
+	SIFPng() : SIFormat("png", "PNG", "png")
 	{
-		// Reset MemChunk
-		mc.seek(0, SEEK_SET);
+		signature_ = "\x89PNG\r\n\x1a\n";
+		min_size_  = 9;
+	}
 
+	bool isThisFormat(const MemChunk& mc) override
+	{
 		// Check size
 		if (mc.size() > 8)
 		{
@@ -96,7 +106,7 @@ public:
 		return false;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info inf;
 		inf.format = "png";
@@ -104,9 +114,9 @@ public:
 		inf.height = 0;
 
 		// Read first chunk
-		mc.seek(8, SEEK_SET);
+		unsigned offset = 8;
 		PNGChunk chunk;
-		chunk.read(mc);
+		chunk.read(mc, offset);
 		// Should be IHDR
 		int bpp = 32;
 		if (chunk.name() == "IHDR")
@@ -132,7 +142,8 @@ public:
 		// Look for other info chunks (grAb or alPh)
 		while (true)
 		{
-			chunk.read(mc);
+			if (!chunk.read(mc, offset))
+				break;
 
 			// Set format to alpha map if alPh present (and 8bpp)
 			if (bpp == 8 && chunk.name() == "alPh")
@@ -230,7 +241,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Create FreeImage bitmap from entry data
 		auto mem = FreeImage_OpenMemory((BYTE*)data.data(), data.size());
@@ -256,12 +267,13 @@ protected:
 		int32_t yoff       = 0;
 		bool    alPh_chunk = false;
 		bool    grAb_chunk = false;
-		data.seek(8, SEEK_SET); // Start after PNG header
+		unsigned offset = 8; // Start after PNG header
 		PNGChunk chunk;
 		while (true)
 		{
 			// Read next PNG chunk
-			chunk.read(data);
+			if (!chunk.read(data, offset))
+				break;
 
 			// Check for 'grAb' chunk
 			if (!grAb_chunk && chunk.name() == "grAb")
@@ -2,12 +2,12 @@
 class SIFQuakeGfx : public SIFormat
 {
 public:
-	SIFQuakeGfx() : SIFormat("quake", "Quake Gfx", "dat") {}
+	SIFQuakeGfx() : SIFormat("quake", "Quake Gfx", "dat") { min_size_ = 9; }
 	~SIFQuakeGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quake")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quake")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -29,7 +29,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image properties
 		int     width  = wxINT16_SWAP_ON_BE(*(const uint16_t*)(data.data()));
@@ -121,12 +121,16 @@ private:
 class SIFQuakeSprite : public SIFormat
 {
 public:
-	SIFQuakeSprite() : SIFormat("qspr", "Quake Sprite", "dat") {}
+	SIFQuakeSprite() : SIFormat("qspr", "Quake Sprite", "dat")
+	{
+		signature_ = "IDSP";
+		min_size_  = 64;
+	}
 	~SIFQuakeSprite() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_qspr")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_qspr")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		// Get image info
 		SImage::Info info;
@@ -136,7 +140,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		SImage::Info info;
@@ -166,7 +170,7 @@ protected:
 	}
 
 private:
-	unsigned sprInfo(MemChunk& mc, int index, SImage::Info& info) const
+	unsigned sprInfo(const MemChunk& mc, int index, SImage::Info& info) const
 	{
 		// Setup variables
 		uint32_t maxheight = mc.readL32(16);
@@ -253,12 +257,12 @@ private:
 class SIFQuakeTex : public SIFormat
 {
 public:
-	SIFQuakeTex() : SIFormat("quaketex", "Quake Texture", "dat", 11) {}
+	SIFQuakeTex() : SIFormat("quaketex", "Quake Texture", "dat", 11) { min_size_ = 125; }
 	~SIFQuakeTex() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quaketex")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quaketex")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -285,7 +289,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -309,12 +313,12 @@ protected:
 class SIFQuake2Wal : public SIFormat
 {
 public:
-	SIFQuake2Wal() : SIFormat("quake2wal", "Quake II Wall", "dat", 21) {}
+	SIFQuake2Wal() : SIFormat("quake2wal", "Quake II Wall", "dat", 21) { min_size_ = 101; }
 	~SIFQuake2Wal() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quake2wal")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quake2wal")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -329,7 +333,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -5,15 +5,16 @@ public:
 	SIFRottGfx(string_view id = "rott", string_view name = "ROTT Gfx", int reliability = 121) :
 		SIFormat(id, name, "dat", reliability)
 	{
+		min_size_ = sizeof(gfx::ROTTPatchHeader) + 1;
 	}
 	~SIFRottGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rott")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -32,7 +33,7 @@ public:
 	}
 
 protected:
-	bool readRottGfx(SImage& image, MemChunk& data, bool mask)
+	bool readRottGfx(SImage& image, const MemChunk& data, bool mask)
 	{
 		// Get image info
 		auto info = this->info(data, 0);
@@ -119,7 +120,7 @@ protected:
 		return true;
 	}
 
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readRottGfx(image, data, false); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readRottGfx(image, data, false); }
 };
 
 class SIFRottGfxMasked : public SIFRottGfx
@@ -128,24 +129,28 @@ public:
 	SIFRottGfxMasked() : SIFRottGfx("rottmask", "ROTT Masked Gfx", 120) {}
 	~SIFRottGfxMasked() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_rottmask")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_rottmask")->isThisFormat(mc); }
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return readRottGfx(image, data, true); }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return readRottGfx(image, data, true); }
 };
 
 class SIFRottLbm : public SIFormat
 {
 public:
-	SIFRottLbm() : SIFormat("rottlbm", "ROTT Lbm", "dat", 80) {}
+	SIFRottLbm() : SIFormat("rottlbm", "ROTT Lbm", "dat", 80)
+	{
+		signature_ = { '\x40', '\x01', '\xC8', '\x00' };
+		min_size_  = 801;
+	}
 	~SIFRottLbm() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottlbm")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -160,7 +165,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -226,15 +231,15 @@ protected:
 class SIFRottRaw : public SIFormat
 {
 public:
-	SIFRottRaw() : SIFormat("rottraw", "ROTT Raw", "dat", 101) {}
+	SIFRottRaw() : SIFormat("rottraw", "ROTT Raw", "dat", 101) { min_size_ = sizeof(gfx::PatchHeader); }
 	~SIFRottRaw() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottraw")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -253,7 +258,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -263,7 +268,7 @@ protected:
 		image.fillAlpha(255);
 
 		// Read raw pixel data
-		data.read(imageData(image), info.width * info.height, 8);
+		data.read(8, imageData(image), info.width * info.height);
 
 		// Convert from column-major to row-major
 		image.rotate(90);
@@ -276,15 +281,15 @@ protected:
 class SIFRottPic : public SIFormat
 {
 public:
-	SIFRottPic() : SIFormat("rottpic", "ROTT Picture", "dat", 60) {}
+	SIFRottPic() : SIFormat("rottpic", "ROTT Picture", "dat", 60) { min_size_ = 8; }
 	~SIFRottPic() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottpic")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -300,7 +305,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -343,12 +348,12 @@ protected:
 class SIFRottWall : public SIFormat
 {
 public:
-	SIFRottWall() : SIFormat("rottwall", "ROTT Flat", "dat", 10) {}
+	SIFRottWall() : SIFormat("rottwall", "ROTT Flat", "dat", 10) { min_size_ = 4096; }
 	~SIFRottWall() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return (mc.size() == 4096 || mc.size() == 51200); }
+	bool isThisFormat(const MemChunk& mc) override { return (mc.size() == 4096 || mc.size() == 51200); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
@@ -364,7 +369,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		auto info = this->info(data, index);
@@ -374,8 +379,7 @@ protected:
 		image.fillAlpha(255);
 
 		// Read raw pixel data
-		data.seek(0, SEEK_SET);
-		data.read(imageData(image), info.height * info.width);
+		data.read(0, imageData(image), info.height * info.width);
 
 		// Convert from column-major to row-major
 		image.rotate(90);
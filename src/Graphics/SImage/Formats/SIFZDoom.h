@@ -2,17 +2,21 @@
 class SIFImgz : public SIFormat
 {
 public:
-	SIFImgz() : SIFormat("imgz", "IMGZ", "imgz") {}
+	SIFImgz() : SIFormat("imgz", "IMGZ", "imgz")
+	{
+		signature_ = "IMGZ";
+		min_size_  = sizeof(gfx::IMGZHeader);
+	}
 	~SIFImgz() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_imgz")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_imgz")->isThisFormat(mc); }
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 
 		// Get width & height
-		auto header = (gfx::IMGZHeader*)mc.data();
+		auto header = (const gfx::IMGZHeader*)mc.data();
 		info.width  = wxINT16_SWAP_ON_BE(header->width);
 		info.height = wxINT16_SWAP_ON_BE(header->height);
 
@@ -24,10 +28,10 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Setup variables
-		auto header   = (gfx::IMGZHeader*)data.data();
+		auto header   = (const gfx::IMGZHeader*)data.data();
 		int  width    = wxINT16_SWAP_ON_BE(header->width);
 		int  height   = wxINT16_SWAP_ON_BE(header->height);
 		int  offset_x = wxINT16_SWAP_ON_BE(header->left);
@@ -34,8 +34,10 @@
 #undef BOOL
 #include "Archive/Archive.h"
 #include "Archive/EntryType/EntryType.h"
+#include "General/Console.h"
 #include "General/Misc.h"
 #include "SIFormat.h"
+#include <array>
 
 using namespace slade;
 
@@ -52,6 +54,12 @@ SIFormat*         sif_raw     = nullptr;
 SIFormat*         sif_flat    = nullptr;
 SIFormat*         sif_general = nullptr;
 SIFormat*         sif_unknown = nullptr;
+
+// Detectable formats that could match data beginning with each byte value
+// (in registration order), and formats that could match empty data
+std::array<vector<SIFormat*>, 256> formats_by_byte;
+vector<SIFormat*>                  formats_empty;
+std::atomic<unsigned>              n_determine{ 0 };
 } // namespace
 
 
@@ -86,14 +94,14 @@ EXTERN_CVAR(Bool, gfx_extraconv)
 class SIFUnknown : public SIFormat
 {
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override { return false; }
+	bool readImage(SImage& image, const MemChunk& data, int index) override { return false; }
 
 public:
 	SIFUnknown() : SIFormat("unknown") { reliability_ = 0; }
 	~SIFUnknown() = default;
 
-	bool         isThisFormat(MemChunk& mc) override { return false; }
-	SImage::Info info(MemChunk& mc, int index) override { return {}; }
+	bool         isThisFormat(const MemChunk& mc) override { return false; }
+	SImage::Info info(const MemChunk& mc, int index) override { return {}; }
 };
 
 
@@ -109,7 +117,7 @@ public:
 	SIFGeneralImage() : SIFormat("image", "Image", "dat") {}
 	~SIFGeneralImage() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		auto mem = FreeImage_OpenMemory((BYTE*)mc.data(), mc.size());
 		auto fif = FreeImage_GetFileTypeFromMemory(mem, 0);
@@ -117,7 +125,7 @@ public:
 		return fif != FIF_UNKNOWN;
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 		getFIInfo(mc, info);
@@ -125,7 +133,7 @@ public:
 	}
 
 protected:
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get image info
 		SImage::Info info;
@@ -189,7 +197,7 @@ protected:
 	bool writeImage(SImage& image, MemChunk& out, Palette* pal, int index) override { return false; }
 
 private:
-	FIBITMAP* getFIInfo(MemChunk& data, SImage::Info& info) const
+	FIBITMAP* getFIInfo(const MemChunk& data, SImage::Info& info) const
 	{
 		// Get FreeImage bitmap info from entry data
 		auto mem = FreeImage_OpenMemory((BYTE*)data.data(), data.size());
@@ -254,13 +262,13 @@ public:
 	SIFRaw(string_view id = "raw") : SIFormat(id, "Raw", "dat") {}
 	~SIFRaw() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Just check the size
 		return validSize(mc.size());
 	}
 
-	SImage::Info info(MemChunk& mc, int index) override
+	SImage::Info info(const MemChunk& mc, int index) override
 	{
 		SImage::Info info;
 		unsigned     size = mc.size();
@@ -353,14 +361,14 @@ protected:
 		return false;
 	}
 
-	bool readImage(SImage& image, MemChunk& data, int index) override
+	bool readImage(SImage& image, const MemChunk& data, int index) override
 	{
 		// Get info
 		auto inf = info(data, index);
 
 		// Create image from data
 		image.create(inf.width, inf.height, SImage::Type::PalMask);
-		data.read(imageData(image), inf.width * inf.height, 0);
+		data.read(0, imageData(image), inf.width * inf.height);
 		image.fillAlpha(255);
 
 		return true;
@@ -495,6 +503,18 @@ SIFormat::SIFormat(string_view id, string_view name, string_view ext, uint8_t re
 	simage_formats.push_back(this);
 }
 
+// -----------------------------------------------------------------------------
+// Returns false if the data in [mc] can't be in this format, going only by its
+// size and signature
+// -----------------------------------------------------------------------------
+bool SIFormat::couldBeFormat(const MemChunk& mc) const
+{
+	if (mc.size() < min_size_ || mc.size() < signature_.size())
+		return false;
+
+	return signature_.empty() || memcmp(mc.data(), signature_.data(), signature_.size()) == 0;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -566,6 +586,25 @@ void SIFormat::initFormats()
 	new SIFHeretic2M32();
 	new SIFWolfPic();
 	new SIFWolfSprite();
+
+	// Index formats by the first byte of their signature, formats without a
+	// signature are candidates for any data
+	for (auto& list : formats_by_byte)
+		list.clear();
+	formats_empty.clear();
+	for (auto* simage_format : simage_formats)
+	{
+		if (simage_format->signature_.empty())
+		{
+			for (auto& list : formats_by_byte)
+				list.push_back(simage_format);
+
+			if (simage_format->min_size_ == 0)
+				formats_empty.push_back(simage_format);
+		}
+		else
+			formats_by_byte[static_cast<uint8_t>(simage_format->signature_[0])].push_back(simage_format);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -595,19 +634,30 @@ SIFormat* SIFormat::getFormat(string_view id)
 // -----------------------------------------------------------------------------
 // Determines the format of the image data in [mc]
 // -----------------------------------------------------------------------------
-SIFormat* SIFormat::determineFormat(MemChunk& mc)
+SIFormat* SIFormat::determineFormat(const MemChunk& mc)
 {
-	// Go through all registered formats
-	SIFormat* format = sif_unknown;
-	for (auto& simage_format : simage_formats)
+	++n_determine;
+
+	// Go through registered formats that could match the first byte of the data
+	const auto& candidates = mc.size() > 0 ? formats_by_byte[mc[0]] : formats_empty;
+	SIFormat*   format     = sif_unknown;
+	for (auto* simage_format : candidates)
 	{
 		// Don't bother checking if the format is less reliable
 		if (simage_format->reliability_ < format->reliability_)
 			continue;
 
+		// Skip full check if the size or signature rule out the format
+		if (!simage_format->couldBeFormat(mc))
+			continue;
+
 		// Check if data matches format
+		++simage_format->n_checked_;
 		if (simage_format->isThisFormat(mc))
+		{
 			format = simage_format;
+			++format->n_matched_;
+		}
 
 		// Stop if format detected is 100% reliable
 		if (format->reliability_ == 255)
@@ -667,3 +717,31 @@ void SIFormat::putAllFormats(vector<SIFormat*>& list)
 	list.push_back(sif_raw);
 	list.push_back(sif_flat);
 }
+
+// -----------------------------------------------------------------------------
+// Writes the number of times each format was fully checked and matched by
+// determineFormat to the console
+// -----------------------------------------------------------------------------
+void SIFormat::logDetectionStats()
+{
+	log::console(fmt::format("determineFormat calls: {}", n_determine.load()));
+	for (auto* simage_format : simage_formats)
+		log::console(fmt::format(
+			"{:<12} checked {:>8} matched {:>8}",
+			simage_format->id_,
+			simage_format->n_checked_.load(),
+			simage_format->n_matched_.load()));
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(sif_detect_stats, 0, false)
+{
+	SIFormat::logDetectionStats();
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SImage.h"
+#include <atomic>
 
 namespace slade
 {
@@ -34,12 +35,12 @@ public:
 	const string& name() const { return name_; }
 	const string& extension() const { return extension_; }
 
-	virtual bool isThisFormat(MemChunk& mc) = 0;
+	virtual bool isThisFormat(const MemChunk& mc) = 0;
 
 	// Reading
-	virtual SImage::Info info(MemChunk& mc, int index = 0) = 0;
+	virtual SImage::Info info(const MemChunk& mc, int index = 0) = 0;
 
-	bool loadImage(SImage& image, MemChunk& data, int index = 0)
+	bool loadImage(SImage& image, const MemChunk& data, int index = 0)
 	{
 		// Check format
 		if (!isThisFormat(data))
@@ -90,12 +91,13 @@ public:
 
 	static void      initFormats();
 	static SIFormat* getFormat(string_view name);
-	static SIFormat* determineFormat(MemChunk& mc);
+	static SIFormat* determineFormat(const MemChunk& mc);
 	static SIFormat* unknownFormat();
 	static SIFormat* rawFormat();
 	static SIFormat* flatFormat();
 	static SIFormat* generalFormat();
 	static void      putAllFormats(vector<SIFormat*>& list);
+	static void      logDetectionStats();
 
 protected:
 	string  id_;
@@ -103,12 +105,28 @@ protected:
 	string  extension_   = "dat";
 	uint8_t reliability_ = 255;
 
-	// Stuff to access protected image data
-	uint8_t* imageData(SImage& image) const { return image.data_.data(); }
-	uint8_t* imageMask(SImage& image) const { return image.mask_.data(); }
-	Palette& imagePalette(SImage& image) const { return image.palette_; }
+	// Cheap checks used by determineFormat to rule out this format before
+	// calling isThisFormat (which can be slow, eg. validating doom gfx columns)
+	string   signature_;    // The data must begin with these bytes (if any)
+	unsigned min_size_ = 0; // The data must be at least this many bytes
 
-	virtual bool readImage(SImage& image, MemChunk& data, int index) = 0;
+	// Stuff to access protected image data
+	// (use the const versions where the data is only read, since the non-const
+	// versions detach image data shared with any copies of the image)
+	uint8_t*       imageData(SImage& image) const { return image.data_.data(); }
+	uint8_t*       imageMask(SImage& image) const { return image.mask_.data(); }
+	const uint8_t* imageData(const SImage& image) const { return image.data_.data(); }
+	const uint8_t* imageMask(const SImage& image) const { return image.mask_.data(); }
+	Palette&       imagePalette(SImage& image) const { return image.palette_; }
+
+	virtual bool readImage(SImage& image, const MemChunk& data, int index) = 0;
 	virtual bool writeImage(SImage& image, MemChunk& data, Palette* pal, int index) { return false; }
+
+private:
+	// Detection statistics (see the sif_detect_stats console command)
+	std::atomic<unsigned> n_checked_{ 0 };
+	std::atomic<unsigned> n_matched_{ 0 };
+
+	bool couldBeFormat(const MemChunk& mc) const;
 };
 } // namespace slade
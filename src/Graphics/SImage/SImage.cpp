@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SImage.h"
+#include "General/ThreadPool.h"
 #include "Graphics/Translation.h"
 #include "SIFormat.h"
 #include "Utility/MathStuff.h"
@@ -51,6 +52,165 @@ EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr size_t pixel_grain = 16384; // Pixels per thread for per-pixel operations
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Calls [func] with ranges of pixels [first, last) covering [count] pixels.
+// Large images are split across worker threads, small ones (or any when called
+// from a worker thread) are done in one go on the calling thread
+// -----------------------------------------------------------------------------
+void forPixelRanges(size_t count, const std::function<void(size_t, size_t)>& func)
+{
+	threadpool::parallelFor(
+		(count + pixel_grain - 1) / pixel_grain,
+		[count, &func](size_t chunk) { func(chunk * pixel_grain, std::min(count, (chunk + 1) * pixel_grain)); });
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each row of an image [width] pixels wide and [height] rows
+// high, split across worker threads if the image is large enough
+// -----------------------------------------------------------------------------
+void forRows(unsigned width, unsigned height, const std::function<void(size_t)>& func)
+{
+	threadpool::parallelFor(height, func, std::max<size_t>(1, pixel_grain / std::max<unsigned>(width, 1)));
+}
+
+// -----------------------------------------------------------------------------
+// Mirrors [width] x [height] pixels of [bpp] bytes in [data], in place
+// -----------------------------------------------------------------------------
+void mirrorData(uint8_t* data, unsigned width, unsigned height, unsigned bpp, bool vertical)
+{
+	const size_t row_size = width * bpp;
+
+	// Vertical, swap rows
+	if (vertical)
+	{
+		forRows(width * 2, height / 2, [data, height, row_size](size_t y) {
+			std::swap_ranges(data + y * row_size, data + (y + 1) * row_size, data + (height - 1 - y) * row_size);
+		});
+	}
+
+	// Horizontal, reverse pixels in each row
+	else if (bpp == 4)
+	{
+		forRows(width, height, [data, width, row_size](size_t y) {
+			auto row = data + y * row_size;
+			for (unsigned x = 0; x < width / 2; x++)
+				std::swap_ranges(row + x * 4, row + x * 4 + 4, row + (width - 1 - x) * 4);
+		});
+	}
+	else
+	{
+		forRows(width, height, [data, row_size](size_t y) {
+			std::reverse(data + y * row_size, data + (y + 1) * row_size);
+		});
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes [width] x [height] pixels of [bpp] bytes in [src] to [dest], rotated
+// 90 degrees clockwise (or anticlockwise if [clockwise] is false).
+// The destination is processed in square tiles so that the source rows being
+// read stay in the cache
+// -----------------------------------------------------------------------------
+void rotateData90(const uint8_t* src, uint8_t* dest, int width, int height, int bpp, bool clockwise)
+{
+	constexpr int tile        = 32;
+	const int     dest_width  = height;
+	const int     dest_height = width;
+
+	threadpool::parallelFor(
+		(dest_height + tile - 1) / tile,
+		[=](size_t tile_row) {
+			const int y1 = tile_row * tile;
+			const int y2 = std::min(dest_height, y1 + tile);
+			for (int x1 = 0; x1 < dest_width; x1 += tile)
+			{
+				const int x2 = std::min(dest_width, x1 + tile);
+				for (int y = y1; y < y2; y++)
+				{
+					auto out = dest + (y * dest_width + x1) * bpp;
+					for (int x = x1; x < x2; x++)
+					{
+						const int src_x = clockwise ? y : width - 1 - y;
+						const int src_y = clockwise ? height - 1 - x : x;
+						memcpy(out, src + (src_y * width + src_x) * bpp, bpp);
+						out += bpp;
+					}
+				}
+			}
+		},
+		std::max<size_t>(1, pixel_grain / (tile * std::max(dest_width, 1))));
+}
+
+// -----------------------------------------------------------------------------
+// Writes the RGBA values of all colours in [palette] to [rgba]
+// -----------------------------------------------------------------------------
+void paletteRGBA(const Palette& palette, uint8_t* rgba)
+{
+	for (unsigned a = 0; a < 256; a++)
+		palette.colour(a).write(rgba + a * 4);
+}
+
+// -----------------------------------------------------------------------------
+// Writes to [index_map] the index of the nearest colour in [palette] to each
+// palette colour after [func] is applied to its RGB values. Only indices from
+// [start] to [stop] are changed if a valid range is given
+// -----------------------------------------------------------------------------
+void colourIndexMap(
+	Palette&                              palette,
+	int                                   start,
+	int                                   stop,
+	const std::function<void(uint8_t*)>& func,
+	uint8_t*                              index_map)
+{
+	const bool range = start >= 0 && stop >= start && stop < 256;
+	uint8_t    rgba[4];
+	for (int a = 0; a < 256; a++)
+	{
+		index_map[a] = a;
+
+		// Skip colors out of range if desired
+		if (range && (a < start || a > stop))
+			continue;
+
+		palette.colour(a).write(rgba);
+		func(rgba);
+		index_map[a] = palette.nearestColour(ColRGBA(rgba[0], rgba[1], rgba[2], rgba[3]));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Replaces each of the [count] [pixels] with its entry in [index_map]
+// -----------------------------------------------------------------------------
+void remapPixels(uint8_t* pixels, size_t count, const uint8_t* index_map)
+{
+	forPixelRanges(
+		count,
+		[pixels, index_map](size_t first, size_t last) {
+			for (auto a = first; a < last; a++)
+				pixels[a] = index_map[pixels[a]];
+		});
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SImage Class Functions
@@ -59,7 +219,8 @@ EXTERN_CVAR(Float, col_greyscale_b)
 
 
 // -----------------------------------------------------------------------------
-// SImage class copy constructor
+// SImage class copy constructor.
+// The pixel data and mask are shared with [img] until either image is modified
 // -----------------------------------------------------------------------------
 SImage::SImage(const SImage& img) :
 	width_{ img.width_ },
@@ -103,21 +264,28 @@ bool SImage::putRGBAData(MemChunk& mc, Palette* pal) const
 		// Get palette to use
 		const auto& palette = (has_palette_ || !pal) ? palette_ : *pal;
 
-		uint8_t rgba[4];
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get colour
-			ColRGBA col = palette.colour(data_[a]);
-
-			// Set alpha
-			if (mask_.data())
-				col.a = mask_[a];
-			else
-				col.a = 255;
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
+		// Get palette colours as RGBA (with full alpha)
+		uint8_t pal_rgba[256 * 4];
+		paletteRGBA(palette, pal_rgba);
+		for (unsigned a = 0; a < 256; a++)
+			pal_rgba[a * 4 + 3] = 255;
+
+		// Expand pixels
+		const auto src  = data_.data();
+		const auto mask = mask_.data();
+		auto       dest = mc.data();
+		forPixelRanges(
+			width_ * height_,
+			[src, mask, dest, &pal_rgba](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					memcpy(dest + a * 4, pal_rgba + src[a] * 4, 4);
+
+				// Set alpha from mask
+				if (mask)
+					for (auto a = first; a < last; a++)
+						dest[a * 4 + 3] = mask[a];
+			});
+		mc.seek(mc.size(), SEEK_SET);
 
 		return true;
 	}
@@ -125,16 +293,16 @@ bool SImage::putRGBAData(MemChunk& mc, Palette* pal) const
 	// Convert if alpha map
 	else if (type_ == Type::AlphaMap)
 	{
-		uint8_t rgba[4];
-		ColRGBA col;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get pixel as colour (greyscale)
-			col.set(data_[a], data_[a], data_[a], data_[a]);
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
+		// Get pixel as colour (greyscale)
+		const auto src  = data_.data();
+		auto       dest = mc.data();
+		forPixelRanges(
+			width_ * height_,
+			[src, dest](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					memset(dest + a * 4, src[a], 4);
+			});
+		mc.seek(mc.size(), SEEK_SET);
 	}
 
 	return false; // Invalid image type
@@ -153,11 +321,18 @@ bool SImage::putRGBData(MemChunk& mc, Palette* pal) const
 	// Init rgb data
 	mc.reSize(width_ * height_ * 3, false);
 
+	const auto src  = data_.data();
+	auto       dest = mc.data();
 	if (type_ == Type::RGBA)
 	{
 		// RGBA format, remove alpha information
-		for (int a = 0; a < width_ * height_ * 4; a += 4)
-			mc.write(&data_[a], 3);
+		forPixelRanges(
+			width_ * height_,
+			[src, dest](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					memcpy(dest + a * 3, src + a * 4, 3);
+			});
+		mc.seek(mc.size(), SEEK_SET);
 
 		return true;
 	}
@@ -169,29 +344,28 @@ bool SImage::putRGBData(MemChunk& mc, Palette* pal) const
 		const auto& palette = (has_palette_ || !pal) ? palette_ : *pal;
 
 		// Build RGB data
-		uint8_t rgba[4];
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			palette.colour(data_[a]).write(rgba);
-			mc.write(rgba, 3);
-		}
+		uint8_t pal_rgba[256 * 4];
+		paletteRGBA(palette, pal_rgba);
+		forPixelRanges(
+			width_ * height_,
+			[src, dest, &pal_rgba](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					memcpy(dest + a * 3, pal_rgba + src[a] * 4, 3);
+			});
+		mc.seek(mc.size(), SEEK_SET);
 
 		return true;
 	}
 	else if (type_ == Type::AlphaMap)
 	{
-		// Alpha map, convert to RGB
-
-		uint8_t rgba[4];
-		ColRGBA col;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get pixel as colour (greyscale)
-			col.set(data_[a], data_[a], data_[a], data_[a]);
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 3); // Write array to MemChunk
-		}
+		// Alpha map, convert to RGB (greyscale)
+		forPixelRanges(
+			width_ * height_,
+			[src, dest](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					memset(dest + a * 3, src[a], 3);
+			});
+		mc.seek(mc.size(), SEEK_SET);
 	}
 
 	return false; // Invalid image type
@@ -273,14 +447,16 @@ ColRGBA SImage::pixelAt(unsigned x, unsigned y, Palette* pal)
 	if (index >= static_cast<unsigned>(width_ * height_ * bpp()))
 		return { 0, 0, 0, 0 };
 
-	// Get colour at pixel
-	ColRGBA col;
+	// Get colour at pixel (via const references so shared data isn't detached)
+	const auto& data = static_cast<const MemChunk&>(data_);
+	const auto& mask = static_cast<const MemChunk&>(mask_);
+	ColRGBA     col;
 	if (type_ == Type::RGBA)
 	{
-		col.r = data_[index];
-		col.g = data_[index + 1];
-		col.b = data_[index + 2];
-		col.a = data_[index + 3];
+		col.r = data[index];
+		col.g = data[index + 1];
+		col.b = data[index + 2];
+		col.a = data[index + 3];
 	}
 	else if (type_ == Type::PalMask)
 	{
@@ -288,16 +464,16 @@ ColRGBA SImage::pixelAt(unsigned x, unsigned y, Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
-		col.set(pal->colour(data_[index]));
+		col.set(pal->colour(data[index]));
 		if (mask_.hasData())
-			col.a = mask_[index];
+			col.a = mask[index];
 	}
 	else if (type_ == Type::AlphaMap)
 	{
-		col.r = data_[index];
-		col.g = data_[index];
-		col.b = data_[index];
-		col.a = data_[index];
+		col.r = data[index];
+		col.g = data[index];
+		col.b = data[index];
+		col.a = data[index];
 	}
 
 	return col;
@@ -560,7 +736,8 @@ void SImage::shrinkPalette(Palette* pal)
 }
 
 // -----------------------------------------------------------------------------
-// Copies all data and properties from [image]
+// Copies all data and properties from [image].
+// The pixel data and mask are shared with [image] until either is modified
 // -----------------------------------------------------------------------------
 bool SImage::copyImage(SImage* image)
 {
@@ -598,7 +775,7 @@ bool SImage::copyImage(SImage* image)
 // Detects the format of [data] and, if it's a valid image format, loads it into
 // this image
 // -----------------------------------------------------------------------------
-bool SImage::open(MemChunk& data, int index, string_view type_hint)
+bool SImage::open(const MemChunk& data, int index, string_view type_hint)
 {
 	// Check with type hint format first
 	if (!type_hint.empty())
@@ -670,9 +847,14 @@ bool SImage::convertPaletted(Palette* pal_target, Palette* pal_current)
 		mask_.reSize(width_ * height_);
 
 		// Get values from alpha channel
-		int c = 0;
-		for (int a = 3; a < width_ * height_ * 4; a += 4)
-			mask_[c++] = rgba_data[a];
+		const auto src  = rgba_data.data();
+		auto       dest = mask_.data();
+		forPixelRanges(
+			width_ * height_,
+			[src, dest](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					dest[a] = src[a * 4 + 3];
+			});
 	}
 
 	// Load given palette
@@ -681,18 +863,22 @@ bool SImage::convertPaletted(Palette* pal_target, Palette* pal_current)
 	// Clear current image data (but not mask)
 	clearData(false);
 
-	// Do conversion
+	// Do conversion (nearestColour is safe to use from multiple threads)
 	data_.reSize(width_ * height_);
-	unsigned i = 0;
-	ColRGBA  col;
-	for (int a = 0; a < width_ * height_; a++)
-	{
-		col.r    = rgba_data[i++];
-		col.g    = rgba_data[i++];
-		col.b    = rgba_data[i++];
-		data_[a] = palette_.nearestColour(col);
-		i++; // Skip alpha
-	}
+	const auto src  = rgba_data.data();
+	auto       dest = data_.data();
+	forPixelRanges(
+		width_ * height_,
+		[this, src, dest](size_t first, size_t last) {
+			ColRGBA col;
+			for (auto a = first; a < last; a++)
+			{
+				col.r   = src[a * 4];
+				col.g   = src[a * 4 + 1];
+				col.b   = src[a * 4 + 2];
+				dest[a] = palette_.nearestColour(col);
+			}
+		});
 
 	// Update variables
 	type_        = Type::PalMask;
@@ -719,23 +905,21 @@ bool SImage::convertAlphaMap(AlphaSource alpha_source, Palette* pal)
 	create(width_, height_, Type::AlphaMap);
 
 	// Generate alpha mask
-	unsigned c = 0;
-	for (int a = 0; a < width_ * height_; a++)
-	{
-		// Determine alpha for this pixel
-		uint8_t alpha;
-		if (alpha_source == AlphaSource::Brightness) // Pixel brightness
-			alpha = static_cast<double>(rgba[c]) * 0.3 + static_cast<double>(rgba[c + 1]) * 0.59
-					+ static_cast<double>(rgba[c + 2]) * 0.11;
-		else // Existing alpha
-			alpha = rgba[c + 3];
-
-		// Set pixel
-		data_[a] = alpha;
-
-		// Next RGBA pixel
-		c += 4;
-	}
+	const auto src  = rgba.data();
+	auto       dest = data_.data();
+	forPixelRanges(
+		width_ * height_,
+		[alpha_source, src, dest](size_t first, size_t last) {
+			for (auto a = first; a < last; a++)
+			{
+				auto c = src + a * 4;
+				if (alpha_source == AlphaSource::Brightness) // Pixel brightness
+					dest[a] = static_cast<double>(c[0]) * 0.3 + static_cast<double>(c[1]) * 0.59
+							  + static_cast<double>(c[2]) * 0.11;
+				else // Existing alpha
+					dest[a] = c[3];
+			}
+		});
 
 	// Announce change
 	signals_.image_changed();
@@ -755,31 +939,34 @@ bool SImage::maskFromColour(ColRGBA colour, Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
+		// Get mask value for each palette index
+		uint8_t index_mask[256];
+		for (unsigned a = 0; a < 256; a++)
+			index_mask[a] = pal->colour(a).equals(colour) ? 0 : 255;
+
 		// Palette+Mask type, go through the mask
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			if (pal->colour(data_[a]).equals(colour))
-				mask_[a] = 0;
-			else
-				mask_[a] = 255;
-		}
+		const auto src  = static_cast<const MemChunk&>(data_).data();
+		auto       dest = mask_.data();
+		forPixelRanges(
+			width_ * height_,
+			[src, dest, &index_mask](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+					dest[a] = index_mask[src[a]];
+			});
 	}
 	else if (type_ == Type::RGBA)
 	{
 		// RGBA type, go through alpha channel
-		uint32_t c = 0;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			ColRGBA pix_col(data_[c], data_[c + 1], data_[c + 2], 255);
-
-			if (pix_col.equals(colour))
-				data_[c + 3] = 0;
-			else
-				data_[c + 3] = 255;
-
-			// Skip to next pixel
-			c += 4;
-		}
+		auto pixels = data_.data();
+		forPixelRanges(
+			width_ * height_,
+			[pixels, colour](size_t first, size_t last) {
+				for (auto a = first; a < last; a++)
+				{
+					auto pix = pixels + a * 4;
+					pix[3]   = (pix[0] == colour.r && pix[1] == colour.g && pix[2] == colour.b) ? 0 : 255;
+				}
+			});
 	}
 	else
 		return false;
@@ -1025,8 +1212,7 @@ bool SImage::rotate(int angle)
 		new_width  = width_;
 		new_height = height_;
 	}
-	const int numpixels = width_ * height_;
-	int       numbpp;
+	int numbpp;
 	if (type_ == Type::PalMask)
 		numbpp = 1;
 	else if (type_ == Type::RGBA)
@@ -1034,42 +1220,40 @@ bool SImage::rotate(int angle)
 	else
 		return false;
 
-	// Create new data and mask
-	vector<uint8_t> new_data(numpixels * numbpp);
-	vector<uint8_t> new_mask;
-	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp, 0);
-
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
+	// 180 degrees, mirror both ways in place
+	if (angle == 180)
 	{
-		switch (angle)
-		{
-			// Urgh maths...
-		case 90: j = (((new_height - 1) - (i % width_)) * new_width) + (i / width_); break;
-		case 180: j = (numpixels - 1) - i; break;
-		case 270: j = ((i % width_) * new_width) + ((new_width - 1) - (i / width_)); break;
-		default: return false;
-		}
-		if (j >= numpixels)
-		{
-			log::error("Pixel {} remapped to {}, how did this even happen?", i, j);
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
+		mirrorData(data_.data(), width_, height_, numbpp, true);
+		mirrorData(data_.data(), width_, height_, numbpp, false);
+		if (mask_.hasData())
 		{
-			new_data[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_.hasData())
-				new_mask[(j * numbpp) + k] = mask_[(i * numbpp) + k];
+			mirrorData(mask_.data(), width_, height_, 1, true);
+			mirrorData(mask_.data(), width_, height_, 1, false);
 		}
+
+		// Announce change
+		signals_.image_changed();
+		return true;
+	}
+
+	// Rotate data and mask into new buffers
+	const bool      clockwise = angle == 270;
+	const MemChunk& data      = data_;
+	const MemChunk& mask      = mask_;
+	MemChunk        new_data(width_ * height_ * numbpp);
+	rotateData90(data.data(), new_data.data(), width_, height_, numbpp, clockwise);
+	MemChunk new_mask;
+	if (mask.hasData())
+	{
+		new_mask.reSize(width_ * height_, false);
+		rotateData90(mask.data(), new_mask.data(), width_, height_, 1, clockwise);
 	}
 
 	// It worked, yay
 	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
+	data_.importMem(new_data);
+	if (new_mask.hasData())
+		mask_.importMem(new_mask);
 	width_  = new_width;
 	height_ = new_height;
 
@@ -1083,9 +1267,8 @@ bool SImage::rotate(int angle)
 // -----------------------------------------------------------------------------
 bool SImage::mirror(bool vertical)
 {
-	// Compute numbers of pixels and bytes
-	const int numpixels = width_ * height_;
-	int       numbpp;
+	// Get number of bytes per pixel
+	int numbpp;
 	if (type_ == Type::PalMask)
 		numbpp = 1;
 	else if (type_ == Type::RGBA)
@@ -1093,38 +1276,10 @@ bool SImage::mirror(bool vertical)
 	else
 		return false;
 
-	// Create new data and mask
-	vector<uint8_t> new_data(numpixels * numbpp);
-	vector<uint8_t> new_mask;
+	// Mirror data and mask in place
+	mirrorData(data_.data(), width_, height_, numbpp, vertical);
 	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp);
-
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
-	{
-		if (vertical)
-			j = (((height_ - 1) - (i / width_)) * width_) + (i % width_);
-		else // horizontal
-			j = ((i / width_) * width_) + ((width_ - 1) - (i % width_));
-		if (j >= numpixels)
-		{
-			log::error("Pixel {} remapped to {}, how did this even happen?", i, j);
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
-		{
-			new_data[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_.hasData())
-				new_mask[(j * numbpp) + k] = mask_[(i * numbpp) + k];
-		}
-	}
-
-	// It worked, yay
-	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
+		mirrorData(mask_.data(), width_, height_, 1, vertical);
 
 	// Announce change
 	signals_.image_changed();
@@ -1178,14 +1333,16 @@ bool SImage::crop(long x1, long y1, long x2, long y2)
 		new_mask.resize(numpixels * numbpp);
 
 	// Remapping loop
-	size_t i, a, b;
+	const auto src  = static_cast<const MemChunk&>(data_).data();
+	const auto mask = static_cast<const MemChunk&>(mask_).data();
+	size_t     i, a, b;
 	for (i = 0; i < new_height; ++i)
 	{
 		a = i * new_width * numbpp;
 		b = (((i + y1) * width_) + x1) * numbpp;
-		memcpy(new_data.data() + a, data_.data() + b, new_width * numbpp);
+		memcpy(new_data.data() + a, src + b, new_width * numbpp);
 		if (mask_.hasData())
-			memcpy(new_mask.data() + a, mask_.data() + b, new_width * numbpp);
+			memcpy(new_mask.data() + a, mask + b, new_width * numbpp);
 	}
 
 	// It worked, yay
@@ -1224,37 +1381,46 @@ bool SImage::resize(int nwidth, int nheight)
 		bpp = 4;
 
 	// Create new image data
-	vector<uint8_t> new_data(nwidth * nheight * bpp, 0);
+	MemChunk new_data(nwidth * nheight * bpp);
+	memset(new_data.data(), 0, new_data.size());
 
 	// Create new mask if needed
-	vector<uint8_t> new_mask;
+	MemChunk new_mask;
 	if (type_ == Type::PalMask)
-		new_mask.resize(nwidth * nheight, 0);
+	{
+		new_mask.reSize(nwidth * nheight, false);
+		memset(new_mask.data(), 0, new_mask.size());
+	}
 
 	// Write new image data
-	unsigned       offset = 0;
 	const unsigned rowlen = std::min<unsigned>(width_, nwidth) * bpp;
 	const unsigned nrows  = std::min<unsigned>(height_, nheight);
-	for (unsigned y = 0; y < nrows; y++)
-	{
-		// Copy data row
-		memcpy(new_data.data() + offset, data_.data() + (y * width_ * bpp), rowlen);
-
-		// Copy mask row
-		if (!new_mask.empty())
-			memcpy(new_mask.data() + offset, mask_.data() + (y * width_), rowlen);
-
-		// Go to next row
-		offset += nwidth * bpp;
-	}
+	const auto     src    = static_cast<const MemChunk&>(data_).data();
+	const auto     mask   = mask_.hasData() ? static_cast<const MemChunk&>(mask_).data() : nullptr;
+	const auto     dest   = new_data.data();
+	const auto     dmask  = new_mask.hasData() ? new_mask.data() : nullptr;
+	const unsigned width  = width_;
+	forRows(
+		rowlen / bpp,
+		nrows,
+		[src, mask, dest, dmask, width, nwidth, bpp, rowlen](size_t y) {
+			// Copy data row
+			memcpy(dest + y * nwidth * bpp, src + y * width * bpp, rowlen);
+
+			// Copy mask row (or make it opaque if there was no mask)
+			if (dmask && mask)
+				memcpy(dmask + y * nwidth, mask + y * width, rowlen);
+			else if (dmask)
+				memset(dmask + y * nwidth, 255, rowlen);
+		});
 
 	// Update variables
 	width_  = nwidth;
 	height_ = nheight;
 	clearData();
-	data_.importMem(new_data.data(), new_data.size());
-	if (!new_mask.empty())
-		mask_.importMem(new_mask.data(), new_mask.size());
+	data_.importMem(new_data);
+	if (new_mask.hasData())
+		mask_.importMem(new_mask);
 
 	// Announce change
 	signals_.image_changed();
@@ -1314,46 +1480,62 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	else
 		newdata = data_.data();
 
-	// Go through pixels
-	for (int p = 0; p < width_ * height_; p++)
-	{
-		// No need to process transparent pixels
-		if (mask_.hasData() && mask_[p] == 0)
-			continue;
-
-		ColRGBA col;
-		int     q = p * bpp;
-		if (type_ == Type::PalMask)
-			col.set(pal->colour(data_[p]));
-		else if (type_ == Type::RGBA)
-		{
-			col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
-
-			// skip colours that don't match exactly to the palette
-			col.index = pal->nearestColour(col);
-			if (!col.equals(pal->colour(col.index)))
-				continue;
-		}
-
-		col = tr->translate(col, pal);
+	// Get translated colour for each palette index
+	const auto table = tr->colourTable(pal);
 
-		if (truecolor)
-		{
-			q              = p * 4;
-			newdata[q + 0] = col.r;
-			newdata[q + 1] = col.g;
-			newdata[q + 2] = col.b;
-			newdata[q + 3] = mask_.hasData() ? mask_[p] : col.a;
-		}
-		else
-			data_[p] = col.index;
-	}
+	// Go through pixels
+	const auto type   = type_;
+	const auto pixels = data_.data();
+	const auto mask   = mask_.hasData() ? mask_.data() : nullptr;
+	forPixelRanges(
+		width_ * height_,
+		[type, bpp, truecolor, pixels, mask, newdata, pal, &table](size_t first, size_t last) {
+			for (auto p = first; p < last; p++)
+			{
+				// No need to process transparent pixels
+				if (mask && mask[p] == 0)
+					continue;
+
+				const ColRGBA* col;
+				uint8_t        alpha;
+				if (type == Type::PalMask)
+				{
+					col   = &table->colours[pixels[p]];
+					alpha = col->a;
+				}
+				else
+				{
+					const auto q = p * bpp;
+					ColRGBA    pix_col(pixels[q], pixels[q + 1], pixels[q + 2], pixels[q + 3]);
+
+					// skip colours that don't match exactly to the palette
+					const auto index = pal->nearestColour(pix_col);
+					if (!pix_col.equals(pal->colour(index)))
+						continue;
+
+					col   = &table->colours[index];
+					alpha = table->keep_alpha[index] ? pix_col.a : col->a;
+				}
+
+				if (truecolor)
+				{
+					const auto q   = p * 4;
+					newdata[q + 0] = col->r;
+					newdata[q + 1] = col->g;
+					newdata[q + 2] = col->b;
+					newdata[q + 3] = mask ? mask[p] : alpha;
+				}
+				else
+					pixels[p] = col->index;
+			}
+		});
 
 	if (truecolor && type_ == Type::PalMask)
 	{
 		clearData(true);
 		data_.importMem(newdata, width_ * height_ * 4);
 		type_ = Type::RGBA;
+		delete[] newdata;
 	}
 
 	return true;
@@ -1503,7 +1685,10 @@ bool SImage::drawImage(SImage& img, int x_pos, int y_pos, DrawProps& properties,
 	if (has_palette_ || !pal_dest)
 		pal_dest = &palette_;
 
-	// Go through pixels
+	// Go through pixels (the source image is only read, so its data is accessed
+	// via const references to avoid detaching data it shares with other images)
+	const auto&    s_data   = static_cast<const MemChunk&>(img.data_);
+	const auto&    s_mask   = static_cast<const MemChunk&>(img.mask_);
 	const unsigned s_stride = img.stride();
 	const uint8_t  s_bpp    = img.bpp();
 	unsigned       sp       = 0;
@@ -1526,9 +1711,9 @@ bool SImage::drawImage(SImage& img, int x_pos, int y_pos, DrawProps& properties,
 			}
 
 			// Skip if source pixel is fully transparent
-			if ((img.type_ == Type::PalMask && img.mask_[sp] == 0)
-				|| (img.type_ == Type::AlphaMap && img.data_[sp] == 0)
-				|| (img.type_ == Type::RGBA && img.data_[sp + 3] == 0))
+			if ((img.type_ == Type::PalMask && s_mask[sp] == 0)
+				|| (img.type_ == Type::AlphaMap && s_data[sp] == 0)
+				|| (img.type_ == Type::RGBA && s_data[sp + 3] == 0))
 			{
 				sp += s_bpp;
 				continue;
@@ -1537,20 +1722,20 @@ bool SImage::drawImage(SImage& img, int x_pos, int y_pos, DrawProps& properties,
 			// Draw pixel
 			if (img.type_ == Type::PalMask)
 			{
-				ColRGBA col = pal_src->colour(img.data_[sp]);
-				col.a       = img.mask_[sp];
+				ColRGBA col = pal_src->colour(s_data[sp]);
+				col.a       = s_mask[sp];
 				drawPixel(x, y, col, properties, pal_dest);
 			}
 			else if (img.type_ == Type::RGBA)
 				drawPixel(
 					x,
 					y,
-					ColRGBA(img.data_[sp], img.data_[sp + 1], img.data_[sp + 2], img.data_[sp + 3]),
+					ColRGBA(s_data[sp], s_data[sp + 1], s_data[sp + 2], s_data[sp + 3]),
 					properties,
 					pal_dest);
 			else if (img.type_ == Type::AlphaMap)
 				drawPixel(
-					x, y, ColRGBA(img.data_[sp], img.data_[sp], img.data_[sp], img.data_[sp]), properties, pal_dest);
+					x, y, ColRGBA(s_data[sp], s_data[sp], s_data[sp], s_data[sp]), properties, pal_dest);
 
 			// Go to next source pixel
 			sp += s_bpp;
@@ -1575,39 +1760,37 @@ bool SImage::colourise(ColRGBA colour, Palette* pal, int start, int stop)
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	// Go through all pixels
-	const uint8_t bpp = this->bpp();
-	ColRGBA       col;
-	for (int a = 0; a < width_ * height_ * bpp; a += bpp)
-	{
-		// Skip colors out of range if desired
-		if (type_ == Type::PalMask && start >= 0 && stop >= start && stop < 256)
-		{
-			if (data_[a] < start || data_[a] > stop)
-				continue;
-		}
-
-		// Get current pixel colour
-		if (type_ == Type::RGBA)
-			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
-		else
-			col.set(pal->colour(data_[a]));
-
-		// Colourise it
-		float grey = (col.r * col_greyscale_r + col.g * col_greyscale_g + col.b * col_greyscale_b) / 255.0f;
+	// Colourise function
+	const float grey_r = col_greyscale_r;
+	const float grey_g = col_greyscale_g;
+	const float grey_b = col_greyscale_b;
+	auto        apply  = [&colour, grey_r, grey_g, grey_b](uint8_t* rgb) {
+		float grey = (rgb[0] * grey_r + rgb[1] * grey_g + rgb[2] * grey_b) / 255.0f;
 		if (grey > 1.0)
 			grey = 1.0;
-		col.r = colour.r * grey;
-		col.g = colour.g * grey;
-		col.b = colour.b * grey;
+		rgb[0] = colour.r * grey;
+		rgb[1] = colour.g * grey;
+		rgb[2] = colour.b * grey;
+	};
 
-		// Set pixel colour
-		if (type_ == Type::RGBA)
-			col.write(data_.data() + a);
-		else
-			data_[a] = pal->nearestColour(col);
+	// Paletted, colourise each palette index once and remap pixels
+	if (type_ == Type::PalMask)
+	{
+		uint8_t index_map[256];
+		colourIndexMap(*pal, start, stop, apply, index_map);
+		remapPixels(data_.data(), width_ * height_, index_map);
+		return true;
 	}
 
+	// RGBA, go through all pixels
+	auto pixels = data_.data();
+	forPixelRanges(
+		width_ * height_,
+		[pixels, &apply](size_t first, size_t last) {
+			for (auto a = first; a < last; a++)
+				apply(pixels + a * 4);
+		});
+
 	return true;
 }
 
@@ -1626,39 +1809,32 @@ bool SImage::tint(ColRGBA colour, float amount, Palette* pal, int start, int sto
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	// Go through all pixels
-	const uint8_t bpp = this->bpp();
-	ColRGBA       col;
-	for (int a = 0; a < width_ * height_ * bpp; a += bpp)
-	{
-		// Skip colors out of range if desired
-		if (type_ == Type::PalMask && start >= 0 && stop >= start && stop < 256)
-		{
-			if (data_[a] < start || data_[a] > stop)
-				continue;
-		}
-
-		// Get current pixel colour
-		if (type_ == Type::RGBA)
-			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
-		else
-			col.set(pal->colour(data_[a]));
-
-		// Tint it
-		const float inv_amt = 1.0f - amount;
-		col.set(
-			col.r * inv_amt + colour.r * amount,
-			col.g * inv_amt + colour.g * amount,
-			col.b * inv_amt + colour.b * amount,
-			col.a);
+	// Tint function
+	const float inv_amt = 1.0f - amount;
+	auto        apply   = [&colour, amount, inv_amt](uint8_t* rgb) {
+		rgb[0] = rgb[0] * inv_amt + colour.r * amount;
+		rgb[1] = rgb[1] * inv_amt + colour.g * amount;
+		rgb[2] = rgb[2] * inv_amt + colour.b * amount;
+	};
 
-		// Set pixel colour
-		if (type_ == Type::RGBA)
-			col.write(data_.data() + a);
-		else
-			data_[a] = pal->nearestColour(col);
+	// Paletted, tint each palette index once and remap pixels
+	if (type_ == Type::PalMask)
+	{
+		uint8_t index_map[256];
+		colourIndexMap(*pal, start, stop, apply, index_map);
+		remapPixels(data_.data(), width_ * height_, index_map);
+		return true;
 	}
 
+	// RGBA, go through all pixels
+	auto pixels = data_.data();
+	forPixelRanges(
+		width_ * height_,
+		[pixels, &apply](size_t first, size_t last) {
+			for (auto a = first; a < last; a++)
+				apply(pixels + a * 4);
+		});
+
 	return true;
 }
 
@@ -1671,6 +1847,10 @@ bool SImage::adjust()
 {
 	int x1 = 0, x2 = width_, y1 = 0, y2 = height_;
 
+	// Image data is only read here (crop creates new data)
+	const auto& data = static_cast<const MemChunk&>(data_);
+	const auto& mask = static_cast<const MemChunk&>(mask_);
+
 	// Loop for empty columns on the left
 	bool opaquefound = false;
 	while (x1 < x2)
@@ -1681,15 +1861,15 @@ bool SImage::adjust()
 			switch (type_)
 			{
 			case Type::PalMask: // Transparency is mask[p] == 0
-				if (mask_[p])
+				if (mask[p])
 					opaquefound = true;
 				break;
 			case Type::RGBA: // Transparency is data[p*4 + 3] == 0
-				if (data_[p * 4 + 3])
+				if (data[p * 4 + 3])
 					opaquefound = true;
 				break;
 			case Type::AlphaMap: // Transparency is data[p] == 0
-				if (data_[p])
+				if (data[p])
 					opaquefound = true;
 				break;
 			default: break;
@@ -1715,15 +1895,15 @@ bool SImage::adjust()
 			switch (type_)
 			{
 			case Type::PalMask:
-				if (mask_[p])
+				if (mask[p])
 					opaquefound = true;
 				break;
 			case Type::RGBA:
-				if (data_[p * 4 + 3])
+				if (data[p * 4 + 3])
 					opaquefound = true;
 				break;
 			case Type::AlphaMap:
-				if (data_[p])
+				if (data[p])
 					opaquefound = true;
 				break;
 			default: break;
@@ -1746,15 +1926,15 @@ bool SImage::adjust()
 			switch (type_)
 			{
 			case Type::PalMask:
-				if (mask_[p])
+				if (mask[p])
 					opaquefound = true;
 				break;
 			case Type::RGBA:
-				if (data_[p * 4 + 3])
+				if (data[p * 4 + 3])
 					opaquefound = true;
 				break;
 			case Type::AlphaMap:
-				if (data_[p])
+				if (data[p])
 					opaquefound = true;
 				break;
 			default: break;
@@ -1778,15 +1958,15 @@ bool SImage::adjust()
 			switch (type_)
 			{
 			case Type::PalMask:
-				if (mask_[p])
+				if (mask[p])
 					opaquefound = true;
 				break;
 			case Type::RGBA:
-				if (data_[p * 4 + 3])
+				if (data[p * 4 + 3])
 					opaquefound = true;
 				break;
 			case Type::AlphaMap:
-				if (data_[p])
+				if (data[p])
 					opaquefound = true;
 				break;
 			default: break;
@@ -58,6 +58,7 @@ using namespace slade;
 EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
+EXTERN_CVAR(Int, col_match)
 
 
 // -----------------------------------------------------------------------------
@@ -636,6 +637,64 @@ ColRGBA Translation::translate(const ColRGBA& col, Palette* pal)
 	return colour;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a table of the translated colour for each index in [pal] (or the
+// current palette if none given). The table is cached and only rebuilt when the
+// translation, palette or relevant colour settings have changed since it was
+// last built
+// -----------------------------------------------------------------------------
+shared_ptr<const Translation::ColourTable> Translation::colourTable(Palette* pal)
+{
+	if (pal == nullptr)
+		pal = maineditor::currentPalette();
+
+	// Check if the cached table is still valid
+	auto key = fmt::format(
+		"{}|{}|{},{},{}",
+		asText(),
+		static_cast<int>(col_match),
+		static_cast<float>(col_greyscale_r),
+		static_cast<float>(col_greyscale_g),
+		static_cast<float>(col_greyscale_b));
+	auto table = std::atomic_load(&colour_table_);
+	if (table && table->key == key)
+	{
+		bool same_palette = true;
+		for (unsigned a = 0; a < 256; a++)
+		{
+			const auto& col = pal->colour(a);
+			if (!col.equals(table->palette[a], true, true))
+			{
+				same_palette = false;
+				break;
+			}
+		}
+
+		if (same_palette)
+			return table;
+	}
+
+	// Build table
+	auto new_table = std::make_shared<ColourTable>();
+	new_table->key = key;
+	for (unsigned a = 0; a < 256; a++)
+	{
+		auto col              = pal->colour(a);
+		new_table->palette[a] = col;
+		col.index             = a;
+		new_table->colours[a] = translate(col, pal);
+
+		// Check if the alpha of the source colour is kept by translating it
+		// again with a different alpha
+		col.a                    = 255 - col.a;
+		new_table->keep_alpha[a] = translate(col, pal).a == col.a;
+	}
+
+	std::atomic_store(&colour_table_, shared_ptr<const ColourTable>(new_table));
+
+	return new_table;
+}
+
 // -----------------------------------------------------------------------------
 // Adds a new translation range of [type] at [pos] in the list, with the range
 // spanning from [range_start] to [range_end]
@@ -259,6 +259,15 @@ class Palette;
 class Translation
 {
 public:
+	// The translated colour of every index in a palette
+	struct ColourTable
+	{
+		ColRGBA colours[256];    // Translated colour (and index) for each palette index
+		bool    keep_alpha[256]; // True if the alpha of the colour being translated is kept
+		string  key;             // Translation definition and settings the table was built with
+		ColRGBA palette[256];    // Palette colours the table was built with
+	};
+
 	Translation()  = default;
 	~Translation() = default;
 
@@ -280,7 +289,8 @@ public:
 	void setBuiltInName(string_view name) { built_in_name_ = name; }
 	void setDesaturationAmount(uint8_t amount) { desat_amount_ = amount; }
 
-	ColRGBA translate(const ColRGBA& col, Palette* pal = nullptr);
+	ColRGBA                       translate(const ColRGBA& col, Palette* pal = nullptr);
+	shared_ptr<const ColourTable> colourTable(Palette* pal = nullptr);
 
 	TransRange* addRange(TransRange::Type type, int pos = -1, int range_start = 0, int range_end = 0);
 	void        removeRange(int pos);
@@ -293,5 +303,6 @@ private:
 	vector<unique_ptr<TransRange>> translations_;
 	string                         built_in_name_;
 	uint8_t                        desat_amount_ = 0;
+	shared_ptr<const ColourTable>  colour_table_;
 };
 } // namespace slade
@@ -0,0 +1,525 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ACSCompiler.cpp
+// Description: Functions for compiling ACS script entries with ACC in the
+//              background, running multiple compiler processes at once
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ACSCompiler.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "UI/Dialogs/ExtMessageDialog.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+#include <deque>
+#include <filesystem>
+#include <set>
+#include <thread>
+
+using namespace slade;
+using namespace acscompiler;
+namespace fs = std::filesystem;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(String, path_acc)
+EXTERN_CVAR(String, path_acc_libs)
+EXTERN_CVAR(Bool, acc_always_show_output)
+EXTERN_CVAR(Int, max_external_processes)
+
+namespace
+{
+// A group of entries compiled together, reported on once all are finished
+struct Batch
+{
+	wxFrame*       parent = nullptr;
+	FinishedFunc   finished;
+	unsigned       remaining = 0;
+	vector<Result> results;
+};
+
+struct Job
+{
+	shared_ptr<Batch>      batch;
+	weak_ptr<ArchiveEntry> entry;
+	weak_ptr<ArchiveEntry> target;
+	bool                   hexen = false;
+	string                 name;
+	string                 dir;
+	string                 ofile;
+	string                 output;
+};
+
+std::deque<Job>            queue;
+unsigned                   n_running   = 0;
+unsigned                   next_job_id = 0;
+std::map<string, uint64_t> exported_libs; // Hash of the data last exported to each library file
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// CompileProcess Class
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+void finishJob(Job& job, bool started);
+
+// Runs ACC for a single job, writing its output to the console as it runs
+class CompileProcess : public wxProcess
+{
+public:
+	CompileProcess(Job job) : job_{ std::move(job) }
+	{
+		Redirect();
+
+		timer_.SetOwner(this);
+		Bind(wxEVT_TIMER, [this](wxTimerEvent&) {
+			readOutput(GetInputStream(), partial_output_[0]);
+			readOutput(GetErrorStream(), partial_output_[1]);
+		});
+	}
+
+	bool start(const string& command)
+	{
+		log::info(2, "execute \"{}\"", command);
+		if (wxExecute(command, wxEXEC_ASYNC | wxEXEC_HIDE_CONSOLE, this) <= 0)
+			return false;
+
+		timer_.Start(100);
+		return true;
+	}
+
+	void OnTerminate(int pid, int status) override
+	{
+		timer_.Stop();
+
+		// Log any remaining output
+		readOutput(GetInputStream(), partial_output_[0]);
+		readOutput(GetErrorStream(), partial_output_[1]);
+		flushOutput(partial_output_[0]);
+		flushOutput(partial_output_[1]);
+
+		// Finish from the event loop, so this can safely be deleted
+		CallAfter([this]() {
+			finishJob(job_, true);
+			delete this;
+		});
+	}
+
+private:
+	Job     job_;
+	wxTimer timer_;
+	string  partial_output_[2]; // Incomplete last line of stdout/stderr
+
+	void readOutput(wxInputStream* stream, string& partial)
+	{
+		if (!stream)
+			return;
+
+		char buffer[1024];
+		while (stream->CanRead())
+		{
+			stream->Read(buffer, sizeof(buffer));
+			auto count = stream->LastRead();
+			if (count == 0)
+				break;
+			partial.append(buffer, count);
+		}
+
+		size_t start = 0;
+		for (auto end = partial.find('\n'); end != string::npos; end = partial.find('\n', start))
+		{
+			auto line = partial.substr(start, end - start);
+			start     = end + 1;
+			flushOutput(line);
+		}
+		partial.erase(0, start);
+	}
+
+	void flushOutput(string& line)
+	{
+		strutil::trimIP(line);
+		if (!line.empty())
+		{
+			log::console(fmt::format("{}: {}", job_.name, line));
+			job_.output += line + "\n";
+		}
+		line.clear();
+	}
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the maximum number of compiler processes to run at once
+// -----------------------------------------------------------------------------
+unsigned maxProcesses()
+{
+	if (max_external_processes > 0)
+		return max_external_processes;
+
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// -----------------------------------------------------------------------------
+// Exports all ACS include libraries available to [entry] (from its own archive
+// and any resource archives) to a temp folder for its archive, and returns
+// the folder path. Library files are only written if their content has changed
+// since they were last exported
+// -----------------------------------------------------------------------------
+string exportLibraries(ArchiveEntry* entry)
+{
+	auto dir = app::path(
+		fmt::format(
+			"acc/lib_{:016x}",
+			entry->parent() ? std::hash<string>{}(entry->parent()->filename(true)) : 0),
+		app::Dir::Temp);
+	std::error_code ec;
+	fs::create_directories(dir, ec);
+
+	// Find any resource libraries
+	Archive::SearchOptions opt;
+	opt.match_type     = EntryType::fromId("acs");
+	opt.search_subdirs = true;
+	auto entries       = app::archiveManager().findAllResourceEntries(opt);
+
+	// Export them
+	std::set<string> lib_files;
+	for (auto& res_entry : entries)
+	{
+		// Ignore SCRIPTS
+		if (res_entry->upperNameNoExt() == "SCRIPTS")
+			continue;
+
+		// Ignore entries from other archives
+		if (entry->parent() && (entry->parent()->filename(true) != res_entry->parent()->filename(true)))
+			continue;
+
+		auto filename = fmt::format("{}.acs", res_entry->nameNoExt());
+		if (!lib_files.insert(filename).second)
+			continue;
+
+		// Skip if unchanged since last exported
+		auto path = fmt::format("{}/{}", dir, filename);
+		auto hash = res_entry->data().hash();
+		auto prev = exported_libs.find(path);
+		if (prev != exported_libs.end() && prev->second == hash && fileutil::fileExists(path))
+			continue;
+
+		res_entry->exportFile(path);
+		exported_libs[path] = hash;
+		log::info(2, "Exporting ACS library {}", res_entry->name());
+	}
+
+	// Remove any libraries that no longer exist
+	for (const auto& file : fileutil::allFilesInDir(dir))
+	{
+		auto filename = fs::path(file).filename().string();
+		if (lib_files.count(filename) == 0)
+		{
+			fileutil::removeFile(file);
+			exported_libs.erase(fmt::format("{}/{}", dir, filename));
+		}
+	}
+
+	return dir;
+}
+
+// -----------------------------------------------------------------------------
+// Imports the compiled script [ofile] into [target], or if no target is given,
+// into the BEHAVIOR lump (for map scripts) or library entry for [entry]
+// -----------------------------------------------------------------------------
+void importCompiled(ArchiveEntry* entry, ArchiveEntry* target, const string& ofile)
+{
+	if (target)
+	{
+		target->importFile(ofile);
+		return;
+	}
+
+	auto parent = entry->parent();
+	if (!parent)
+		return;
+
+	// Check if the script is a map script (BEHAVIOR)
+	if (entry->upperName() == "SCRIPTS")
+	{
+		// Get entry before SCRIPTS
+		auto prev = parent->entryAt(parent->entryIndex(entry) - 1);
+
+		// Create a new entry there if it isn't BEHAVIOR
+		if (!prev || prev->upperName() != "BEHAVIOR")
+			prev = parent->addNewEntry("BEHAVIOR", parent->entryIndex(entry)).get();
+
+		// Import compiled script
+		prev->importFile(ofile);
+	}
+	else
+	{
+		// Otherwise, treat it as a library
+
+		// See if the compiled library already exists as an entry
+		Archive::SearchOptions opt;
+		opt.match_namespace = "acs";
+		opt.match_name      = entry->nameNoExt();
+		if (parent->formatDesc().names_extensions)
+		{
+			opt.match_name += ".o";
+			opt.ignore_ext = false;
+		}
+		auto lib = parent->findLast(opt);
+
+		// If it doesn't exist, create it
+		if (!lib)
+			lib = parent->addEntry(std::make_shared<ArchiveEntry>(fmt::format("{}.o", entry->nameNoExt())), "acs").get();
+
+		// Import compiled script
+		lib->importFile(ofile);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Shows the results of all compiles in [batch], if there were any errors (or
+// acc_always_show_output is set)
+// -----------------------------------------------------------------------------
+void reportBatch(const Batch& batch)
+{
+	unsigned n_failed = 0;
+	string   errors;
+	for (const auto& result : batch.results)
+	{
+		if (!result.success)
+			++n_failed;
+
+		if (result.errors.empty() || (result.success && !acc_always_show_output))
+			continue;
+
+		if (batch.results.size() > 1)
+			errors += fmt::format("=== {} ===\n", result.name);
+		errors += result.errors + "\n";
+	}
+
+	if (batch.results.size() > 1)
+		log::info("ACS compile: {} entries compiled, {} failed", batch.results.size(), n_failed);
+
+	if (n_failed > 0 || (acc_always_show_output && !errors.empty()))
+	{
+		ExtMessageDialog dlg(batch.parent, n_failed > 0 ? "Error Compiling" : "ACC Output");
+		dlg.setMessage(
+			n_failed > 0 ? "The following errors were encountered while compiling, please fix them and recompile:" :
+                           "Compiler output shown below: ");
+		dlg.setExt(errors);
+		dlg.ShowModal();
+	}
+
+	if (batch.finished)
+		batch.finished(batch.results);
+}
+
+// -----------------------------------------------------------------------------
+// Starts compiling the next queued jobs, up to the maximum number of processes
+// -----------------------------------------------------------------------------
+void startJobs()
+{
+	while (n_running < maxProcesses() && !queue.empty())
+	{
+		auto job = std::move(queue.front());
+		queue.pop_front();
+
+		auto entry = job.entry.lock();
+		if (!entry)
+		{
+			finishJob(job, false);
+			continue;
+		}
+
+		// Export script and any libraries it could include
+		auto lib_dir = exportLibraries(entry.get());
+		job.dir      = app::path(fmt::format("acc/job{}", next_job_id++), app::Dir::Temp);
+		std::error_code ec;
+		fs::create_directories(job.dir, ec);
+		auto srcfile = fmt::format("{}/{}.acs", job.dir, entry->nameNoExt());
+		job.ofile    = fmt::format("{}/{}.o", job.dir, entry->nameNoExt());
+		entry->exportFile(srcfile);
+
+		// Setup command
+		auto command = fmt::format("\"{}\"", path_acc.value);
+		if (job.hexen)
+			command += " -h";
+		command += fmt::format(" -i \"{}\"", lib_dir);
+		for (const auto& include_path : strutil::splitV(path_acc_libs.value, ';'))
+			if (!include_path.empty())
+				command += fmt::format(" -i \"{}\"", include_path);
+		command += fmt::format(" \"{}\" \"{}\"", srcfile, job.ofile);
+
+		// Start compiler
+		auto process = new CompileProcess(job);
+		if (!process->start(command))
+		{
+			delete process;
+			log::error("Unable to run ACS compiler \"{}\"", path_acc.value);
+			finishJob(job, false);
+			continue;
+		}
+
+		++n_running;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Finishes [job] once its compiler process has terminated ([started] is false
+// if it couldn't be started), importing the compiled script if successful.
+// Reports on the job's batch if it was the last one in it, and starts the next
+// queued job
+// -----------------------------------------------------------------------------
+void finishJob(Job& job, bool started)
+{
+	Result result;
+	result.name = job.name;
+
+	auto entry  = job.entry.lock();
+	auto target = job.target.lock();
+	if (!started)
+		result.errors = entry ? "Unable to run the ACS compiler" : "Entry no longer exists";
+	else
+	{
+		--n_running;
+
+		// Check it compiled successfully
+		result.success = fileutil::fileExists(job.ofile);
+		if (result.success && entry)
+			importCompiled(entry.get(), target.get(), job.ofile);
+		else if (!entry)
+		{
+			result.success = false;
+			result.errors  = "Entry no longer exists";
+		}
+
+		// Get errors
+		auto err_file = job.dir + "/acs.err";
+		if (result.errors.empty() && !fileutil::readFileToString(err_file, result.errors))
+			result.errors = job.output;
+	}
+
+	// Clean up
+	if (!job.dir.empty())
+	{
+		std::error_code ec;
+		fs::remove_all(job.dir, ec);
+	}
+
+	auto& batch = *job.batch;
+	batch.results.push_back(std::move(result));
+	if (--batch.remaining == 0)
+		reportBatch(batch);
+
+	startJobs();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ACSCompiler Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Queues [entries] to be compiled (to Hexen bytecode if [hexen] is true), and
+// starts compiling as many as possible. If [target] is given the compiled
+// script is imported to it, otherwise to the map's BEHAVIOR lump or the
+// matching library entry. Once all entries are compiled, any errors are shown
+// (with [parent] as the dialog parent) and [finished] is called
+// -----------------------------------------------------------------------------
+bool acscompiler::compile(
+	const vector<ArchiveEntry*>& entries,
+	bool                         hexen,
+	ArchiveEntry*                target,
+	wxFrame*                     parent,
+	FinishedFunc                 finished)
+{
+	if (entries.empty())
+		return false;
+
+	auto batch       = std::make_shared<Batch>();
+	batch->parent    = parent;
+	batch->finished  = std::move(finished);
+	batch->remaining = entries.size();
+
+	for (auto entry : entries)
+	{
+		Job job;
+		job.batch = batch;
+		job.entry = entry->getShared();
+		if (target)
+			job.target = target->getShared();
+		job.hexen = hexen;
+		job.name  = entry->name();
+		queue.push_back(std::move(job));
+	}
+
+	startJobs();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of compiles queued or running
+// -----------------------------------------------------------------------------
+unsigned acscompiler::nQueued()
+{
+	return queue.size() + n_running;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is an ACS source that can be compiled on its own,
+// ie. a map SCRIPTS lump or a library (containing a #library directive)
+// -----------------------------------------------------------------------------
+bool acscompiler::isCompilable(ArchiveEntry* entry)
+{
+	if (entry->upperNameNoExt() == "SCRIPTS")
+		return true;
+
+	auto& data = entry->data();
+	return strutil::containsCI(string_view{ reinterpret_cast<const char*>(data.data()), data.size() }, "#library");
+}
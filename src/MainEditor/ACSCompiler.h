@@ -0,0 +1,35 @@
+#pragma once
+
+class wxFrame;
+
+namespace slade
+{
+class ArchiveEntry;
+
+// Runs the ACS compiler (ACC) on script entries asynchronously, with several
+// compiler processes running at once (up to max_external_processes). Compiler
+// output is written to the console as it runs, and compiled scripts are
+// imported into the archive once each compile finishes. Any include libraries
+// are exported to a temp folder shared between compiles, and only re-exported
+// when their content has changed
+namespace acscompiler
+{
+	struct Result
+	{
+		string name;
+		bool   success = false;
+		string errors;
+	};
+	using FinishedFunc = std::function<void(const vector<Result>&)>;
+
+	bool compile(
+		const vector<ArchiveEntry*>& entries,
+		bool                         hexen    = false,
+		ArchiveEntry*                target   = nullptr,
+		wxFrame*                     parent   = nullptr,
+		FinishedFunc                 finished = {});
+
+	unsigned nQueued();
+	bool     isCompilable(ArchiveEntry* entry);
+} // namespace acscompiler
+} // namespace slade
@@ -35,6 +35,7 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/WadArchive.h"
 #include "General/Console.h"
+#include "General/ThreadPool.h"
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "MainEditor/MainEditor.h"
@@ -42,12 +43,18 @@
 #include "SLADEMap/MapFormat/Doom64MapFormat.h"
 #include "SLADEMap/MapFormat/DoomMapFormat.h"
 #include "SLADEMap/MapFormat/HexenMapFormat.h"
+#include "SLADEMap/MapTextureUsage.h"
 #include "SLADEMap/MapObject/MapSector.h"
 #include "SLADEMap/MapObject/MapThing.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/Compression.h"
 #include "Utility/StringUtils.h"
-#include "Utility/Tokenizer.h"
+#include <chrono>
+#include <regex>
+#include <thread>
+#include <unordered_set>
+#include <wx/progdlg.h>
 
 using namespace slade;
 
@@ -59,7 +66,6 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 typedef std::map<wxString, int>                   StrIntMap;
 typedef std::map<wxString, vector<ArchiveEntry*>> PathMap;
-typedef std::map<int, vector<ArchiveEntry*>>      CRCMap;
 
 
 // -----------------------------------------------------------------------------
@@ -123,9 +129,8 @@ bool archiveoperations::removeUnusedPatches(Archive* archive)
 			if (entry && entry->parent() == archive)
 				to_remove.push_back(entry);
 
-			// Update texturex list patch indices
-			for (auto& tx_list : tx_lists)
-				tx_list->removePatch(p.name);
+			// Textures refer to patches by name and none use this one, so the
+			// texturex lists don't need updating
 
 			// Remove the patch from the patch table
 			log::info(wxString::Format("Removed patch %s", p.name));
@@ -246,6 +251,51 @@ bool archiveoperations::checkDuplicateEntryNames(Archive* archive)
 	return true;
 }
 
+namespace
+{
+// Entry in the base resource archive index
+struct BaseResourceEntry
+{
+	ArchiveEntry* entry;
+	uint32_t      crc       = 0;
+	bool          crc_valid = false; // CRC is computed when first needed
+};
+
+// Index of the base resource archive's root entries by namespace and name, for
+// removeEntriesUnchangedFromIWAD. The base resource archive isn't edited, so
+// this is kept until a different base resource archive is loaded
+std::unordered_map<string, BaseResourceEntry> base_resource_index;
+weak_ptr<ArchiveDir>                          base_resource_index_root;
+
+// -----------------------------------------------------------------------------
+// Returns the base resource index key for an entry named [name] (upper case)
+// in namespace [ns]
+// -----------------------------------------------------------------------------
+string baseResourceKey(string_view ns, string_view name)
+{
+	return fmt::format("{}/{}", strutil::lower(ns), name);
+}
+
+// -----------------------------------------------------------------------------
+// Builds the index of base resource archive [bra], if it isn't already
+// -----------------------------------------------------------------------------
+void updateBaseResourceIndex(Archive& bra)
+{
+	auto root = bra.rootDir();
+	if (base_resource_index_root.lock() == root)
+		return;
+
+	// Later entries take precedence (as with Archive::findLast)
+	base_resource_index.clear();
+	for (unsigned a = 0; a < root->numEntries(); a++)
+	{
+		auto entry = root->entryAt(a);
+		base_resource_index[baseResourceKey(bra.detectNamespace(a, root.get()), entry->upperNameNoExt())] = { entry };
+	}
+	base_resource_index_root = root;
+}
+} // namespace
+
 // -----------------------------------------------------------------------------
 // Compare the archive's entries with those sharing the same name and namespace
 // in the base resource archive, deleting duplicates
@@ -258,39 +308,74 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 	if (bra == nullptr || bra == archive || archive == nullptr)
 		return;
 
-	// Get list of all entries in archive
-	vector<ArchiveEntry*> entries;
-	archive->putEntryTreeAsList(entries);
-
-	// Init search options
-	Archive::SearchOptions search;
-	ArchiveEntry*          other = nullptr;
-	wxString               dups  = "";
-	size_t                 count = 0;
+	updateBaseResourceIndex(*bra);
 
-	// Go through list
-	for (auto& entry : entries)
+	// Find all entries with a counterpart of the same size in the base resource
+	// archive
+	struct Candidate
 	{
-		// Skip directory entries
-		if (entry->type() == EntryType::folderType())
-			continue;
+		ArchiveEntry*      entry;
+		BaseResourceEntry* other;
+		uint32_t           crc;
+	};
+	vector<Candidate> candidates;
+	std::function<void(ArchiveDir*)> find_candidates = [&](ArchiveDir* dir) {
+		for (unsigned a = 0; a < dir->numEntries(); a++)
+		{
+			auto entry = dir->entryAt(a);
 
-		// Skip markers
-		if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
-			continue;
+			// Skip markers
+			if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
+				continue;
 
-		// Now, let's look for a counterpart in the IWAD
-		search.match_namespace = archive->detectNamespace(entry);
-		search.match_name      = entry->name();
-		other                  = bra->findLast(search);
+			auto other = base_resource_index.find(baseResourceKey(archive->detectNamespace(a, dir), entry->upperName()));
+			if (other != base_resource_index.end() && other->second.entry->size() == entry->size())
+				candidates.push_back({ entry, &other->second, 0 });
+		}
+
+		for (unsigned a = 0; a < dir->numSubdirs(); a++)
+			find_candidates(dir->subdirAt(a).get());
+	};
+	find_candidates(archive->rootDir().get());
+
+	// Load the data of all entries to compare (loading from the archive isn't
+	// thread-safe)
+	vector<ArchiveEntry*> to_unload;
+	auto load = [&to_unload](ArchiveEntry* entry) {
+		if (!entry->isLoaded())
+			to_unload.push_back(entry);
+		entry->data();
+	};
+	std::unordered_set<BaseResourceEntry*> other_crcs;
+	for (auto& candidate : candidates)
+	{
+		load(candidate.entry);
+		if (!candidate.other->crc_valid && other_crcs.insert(candidate.other).second)
+			load(candidate.other->entry);
+	}
 
-		// If there is one, and it is identical, remove it
-		if (other != nullptr && (other->data().crc() == entry->data().crc()))
+	// Compute CRCs (on the worker threads)
+	threadpool::parallelFor(candidates.size(), [&candidates](size_t index) {
+		candidates[index].crc = std::as_const(candidates[index].entry->data(false)).crc();
+	});
+	vector<BaseResourceEntry*> others(other_crcs.begin(), other_crcs.end());
+	threadpool::parallelFor(others.size(), [&others](size_t index) {
+		others[index]->crc       = std::as_const(others[index]->entry->data(false)).crc();
+		others[index]->crc_valid = true;
+	});
+	for (auto entry : to_unload)
+		entry->unloadData();
+
+	// Remove any that are identical
+	wxString dups  = "";
+	size_t   count = 0;
+	for (auto& candidate : candidates)
+	{
+		if (candidate.crc == candidate.other->crc)
 		{
 			++count;
-			dups += wxString::Format("%s\n", search.match_name);
-			archive->removeEntry(entry);
-			entry = nullptr;
+			dups += wxString::Format("%s\n", candidate.entry->name());
+			archive->removeEntry(candidate.entry);
 		}
 	}
 
@@ -320,47 +405,114 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 // -----------------------------------------------------------------------------
 bool archiveoperations::checkDuplicateEntryContent(Archive* archive)
 {
-	CRCMap map_entries;
+	// Load and hash entry data in batches of around this many bytes
+	constexpr size_t hash_batch_size = 256 * 1024 * 1024;
 
 	// Get list of all entries in archive
 	vector<ArchiveEntry*> entries;
 	archive->putEntryTreeAsList(entries);
-	wxString dups = "";
 
-	// Go through list
-	for (auto& entry : entries)
+	// Get candidate entries, only entries with the same size as at least one
+	// other entry can be duplicates
+	std::unordered_map<uint32_t, unsigned> size_counts;
+	vector<ArchiveEntry*>                  candidates;
+	for (int pass = 0; pass < 2; pass++)
+		for (auto& entry : entries)
+		{
+			// Skip directory entries
+			if (entry->type() == EntryType::folderType())
+				continue;
+
+			// Skip markers
+			if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
+				continue;
+
+			if (pass == 0)
+				size_counts[entry->size()]++;
+			else if (size_counts[entry->size()] > 1)
+				candidates.push_back(entry);
+		}
+
+	// Hash candidate entries' data on the worker threads.
+	// Entry data is loaded (in batches to limit memory usage) on this thread
+	// beforehand since loading from the archive isn't thread-safe, and
+	// unloaded again afterwards if it wasn't already loaded
+	vector<uint64_t> hashes(candidates.size());
+	for (size_t batch_start = 0; batch_start < candidates.size();)
 	{
-		// Skip directory entries
-		if (entry->type() == EntryType::folderType())
-			continue;
+		size_t       batch_end  = batch_start;
+		size_t       batch_size = 0;
+		vector<bool> was_loaded;
+		while (batch_end < candidates.size() && (batch_end == batch_start || batch_size < hash_batch_size))
+		{
+			auto entry = candidates[batch_end++];
+			was_loaded.push_back(entry->isLoaded());
+			batch_size += entry->data().size();
+		}
 
-		// Skip markers
-		if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
+		threadpool::parallelFor(
+			batch_end - batch_start,
+			[&](size_t index) {
+				hashes[batch_start + index] = std::as_const(candidates[batch_start + index]->data(false)).hash();
+			},
+			4);
+
+		for (size_t a = batch_start; a < batch_end; a++)
+			if (!was_loaded[a - batch_start])
+				candidates[a]->unloadData();
+
+		batch_start = batch_end;
+	}
+
+	// Group candidates with the same size and hash
+	std::map<std::pair<uint32_t, uint64_t>, vector<ArchiveEntry*>> hash_groups;
+	for (size_t a = 0; a < candidates.size(); a++)
+		hash_groups[{ candidates[a]->size(), hashes[a] }].push_back(candidates[a]);
+
+	// Confirm duplicates within each group by comparing the actual data
+	vector<vector<ArchiveEntry*>> duplicates;
+	for (auto& [key, group] : hash_groups)
+	{
+		if (group.size() < 2)
 			continue;
 
-		// Enqueue entries
-		map_entries[entry->data().crc()].push_back(entry);
+		vector<vector<ArchiveEntry*>> matches;
+		for (auto entry : group)
+		{
+			const auto& data  = std::as_const(entry->data());
+			bool        found = false;
+			for (auto& match : matches)
+			{
+				const auto& other = std::as_const(match[0]->data());
+				if (other.size() == data.size() && memcmp(other.data(), data.data(), data.size()) == 0)
+				{
+					match.push_back(entry);
+					found = true;
+					break;
+				}
+			}
+			if (!found)
+				matches.push_back({ entry });
+		}
+
+		for (auto& match : matches)
+			if (match.size() > 1)
+				duplicates.push_back(match);
 	}
 
 	// Now iterate through the dupes to list the name of the duplicated entries
-	auto i = map_entries.begin();
-	while (i != map_entries.end())
+	wxString dups = "";
+	for (auto& match : duplicates)
 	{
-		if (i->second.size() > 1)
+		wxString name = match[0]->path(true);
+		name.Remove(0, 1);
+		dups += wxString::Format("\n%s\t(%8x) duplicated by", name, match[0]->data().crc());
+		for (unsigned a = 1; a < match.size(); a++)
 		{
-			wxString name = i->second[0]->path(true);
+			name = match[a]->path(true);
 			name.Remove(0, 1);
-			dups += wxString::Format("\n%s\t(%8x) duplicated by", name, i->first);
-			auto j = i->second.begin() + 1;
-			while (j != i->second.end())
-			{
-				name = (*j)->path(true);
-				name.Remove(0, 1);
-				dups += wxString::Format("\t%s", name);
-				++j;
-			}
+			dups += wxString::Format("\t%s", name);
 		}
-		++i;
 	}
 
 	// If no duplicates exist, do nothing
@@ -400,100 +552,19 @@ wxString flat_anim_end[] = {
 	"NUKAGE3", "FWATER4", "SWATER4", "LAVA4", "BLOOD3", "RROCK08", "SLIME04", "SLIME08", "SLIME12",
 };
 
-struct texused_t
-{
-	bool used;
-	texused_t() { used = false; }
-};
-WX_DECLARE_STRING_HASH_MAP(texused_t, TexUsedMap);
 void archiveoperations::removeUnusedTextures(Archive* archive)
 {
 	// Check archive was given
 	if (!archive)
 		return;
 
-	// --- Build list of used textures ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SIDEDEFS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sidedefs");
-	auto sidedefs  = archive->findAll(opt);
-	total_maps += sidedefs.size();
-
-	// Go through and add used textures to list
-	DoomMapFormat::SideDef sdef;
-	wxString               tex_lower, tex_middle, tex_upper;
-	for (auto& sidedef : sidedefs)
-	{
-		int nsides = sidedef->size() / 30;
-		sidedef->seek(0, SEEK_SET);
-		for (int s = 0; s < nsides; s++)
-		{
-			// Read side data
-			sidedef->read(&sdef, 30);
-
-			// Get textures
-			tex_lower  = wxString::FromAscii(sdef.tex_lower, 8);
-			tex_middle = wxString::FromAscii(sdef.tex_middle, 8);
-			tex_upper  = wxString::FromAscii(sdef.tex_upper, 8);
-
-			// Add to used textures list
-			used_textures[tex_lower].used  = true;
-			used_textures[tex_middle].used = true;
-			used_textures[tex_upper].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used textures to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sidedef definition
-			if (token == "sidedef")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturetop" || token == "texturemiddle" || token == "texturebottom")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
-
-	// Check if any maps were found
-	if (total_maps == 0)
+	// Get textures used in all maps
+	auto usage = maptextureusage::archiveUsage(*archive);
+	if (usage.n_map_entries == 0)
 		return;
 
 	// Find all TEXTUREx entries
-	opt.match_name  = "";
+	Archive::SearchOptions opt;
 	opt.match_type  = EntryType::fromId("texturex");
 	auto tx_entries = archive->findAll(opt);
 
@@ -534,7 +605,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			}
 
 			// Mark if unused and not part of an animation
-			if (!used_textures[texname].used && !anim && !thisend)
+			if (!usage.usesTexture(wxutil::strToView(texname)) && !anim && !thisend)
 				unused_tex.Add(txlist.texture(t)->name());
 		}
 	}
@@ -573,7 +644,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW1", "SW2", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (usage.usesTexture(wxutil::strToView(swname)))
 				swtex = true;
 		}
 		else if (unused_tex[a].StartsWith("SW2"))
@@ -583,7 +654,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW2", "SW1", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (usage.usesTexture(wxutil::strToView(swname)))
 				swtex = true;
 		}
 
@@ -644,88 +715,14 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 	if (!archive)
 		return;
 
-	// --- Build list of used flats ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SECTORS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sectors");
-	auto sectors   = archive->findAll(opt);
-	total_maps += sectors.size();
-
-	// Go through and add used flats to list
-	DoomMapFormat::Sector sec;
-	wxString              tex_floor, tex_ceil;
-	for (auto& sector : sectors)
-	{
-		int nsec = sector->size() / 26;
-		sector->seek(0, SEEK_SET);
-		for (int s = 0; s < nsec; s++)
-		{
-			// Read sector data
-			sector->read(&sec, 26);
-
-			// Get textures
-			tex_floor = wxString::FromAscii(sec.f_tex, 8);
-			tex_ceil  = wxString::FromAscii(sec.c_tex, 8);
-
-			// Add to used textures list
-			used_textures[tex_floor].used = true;
-			used_textures[tex_ceil].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used flats to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sector definition
-			if (token == "sector")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturefloor" || token == "textureceiling")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
-
-	// Check if any maps were found
-	if (total_maps == 0)
+	// Get flats used in all maps
+	auto usage = maptextureusage::archiveUsage(*archive);
+	if (usage.n_map_entries == 0)
 		return;
 
 	// Find all flats
-	opt.match_name      = "";
+	Archive::SearchOptions opt;
 	opt.match_namespace = "flats";
-	opt.match_type      = nullptr;
 	auto flats          = archive->findAll(opt);
 
 	// Create list of all unused flats
@@ -763,7 +760,7 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 		}
 
 		// Add if not animated
-		if (!used_textures[flatname].used && !anim && !thisend)
+		if (!usage.usesFlat(flatname) && !anim && !thisend)
 			unused_tex.Add(flatname);
 	}
 
@@ -819,7 +816,175 @@ void importEntryDataKeepType(ArchiveEntry* entry, const void* data, unsigned siz
 	entry->importMem(data, size);
 	entry->setType(type, type->reliability());
 }
-size_t replaceThingsDoom(ArchiveEntry* entry, int oldtype, int newtype)
+
+namespace
+{
+// Entry data changed by a map replace operation
+struct EntryChange
+{
+	ArchiveEntry* entry;
+	MemChunk      data;
+};
+typedef vector<EntryChange> EntryChanges;
+
+// Replace operation on a single map, run on a worker thread. Returns the
+// number of map objects changed, and adds the new data of any changed entries
+// to [changes] (the entries themselves must not be modified)
+typedef std::function<size_t(EntryChanges& changes)> MapReplaceTask;
+typedef std::function<MapReplaceTask(const Archive::MapDesc& map, const vector<ArchiveEntry*>& entries)>
+	MapReplaceTaskFunc;
+
+// -----------------------------------------------------------------------------
+// Adds [size] bytes of [data] as the new data for [entry] to [changes]
+// -----------------------------------------------------------------------------
+void addEntryChange(EntryChanges& changes, ArchiveEntry* entry, const void* data, unsigned size)
+{
+	changes.push_back({ entry, MemChunk{ static_cast<const uint8_t*>(data), size } });
+}
+
+// -----------------------------------------------------------------------------
+// Imports the new data for each entry in [changes], keeping their types
+// -----------------------------------------------------------------------------
+void applyEntryChanges(const EntryChanges& changes)
+{
+	for (const auto& change : changes)
+	{
+		auto type = change.entry->type();
+		change.entry->importMemChunk(change.data);
+		change.entry->setType(type, type->reliability());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs a replace operation on all maps in [archive], including maps in any
+// embedded wads. [get_task] is called for each map (on this thread, with the
+// data of the map's entries loaded) to get the replace task for it, if any.
+// The tasks for all maps are run in parallel on the worker threads, with a
+// progress dialog shown if they take a while. Once all are done the changes
+// are applied to the map entries (and embedded wads), or discarded if the
+// operation was cancelled.
+// Returns the total number of map objects ([what]) changed
+// -----------------------------------------------------------------------------
+size_t replaceInMaps(Archive& archive, string_view what, const MapReplaceTaskFunc& get_task)
+{
+	struct MapJob
+	{
+		string         name;
+		MapReplaceTask task;
+		size_t         changed = 0;
+		EntryChanges   changes;
+	};
+	struct EmbeddedWad
+	{
+		shared_ptr<ArchiveEntry> entry;
+		shared_ptr<WadArchive>   archive;
+		size_t                   first_job;
+		size_t                   end_job;
+	};
+
+	// Get replace tasks for all maps, opening any embedded wads (nested wads
+	// always come after the wad containing them)
+	vector<MapJob>      jobs;
+	vector<EmbeddedWad> wads;
+	std::function<void(Archive&, string_view)> add_jobs = [&](Archive& parent, string_view path) {
+		for (auto& map : parent.detectMaps())
+		{
+			auto m_head = map.head.lock();
+			if (!m_head)
+				continue;
+
+			auto name = fmt::format("{}{}", path, m_head->name());
+			if (map.archive)
+			{
+				// Attempt to open entry as wad archive
+				auto temp_archive = std::make_shared<WadArchive>();
+				if (temp_archive->open(m_head->data()))
+				{
+					auto index = wads.size();
+					wads.push_back({ m_head, temp_archive, jobs.size(), 0 });
+					add_jobs(*temp_archive, name + "/");
+					wads[index].end_job = jobs.size();
+				}
+				continue;
+			}
+
+			// Loading from the archive isn't thread-safe, so load the map data here
+			auto entries = map.entries(parent);
+			for (auto entry : entries)
+				entry->data();
+
+			jobs.push_back({ name, get_task(map, entries) });
+		}
+	};
+	add_jobs(archive, "");
+
+	// Run all tasks on the worker threads
+	std::atomic<size_t> n_done{ 0 };
+	std::atomic<bool>   cancelled{ false };
+	for (auto& job : jobs)
+		threadpool::enqueue([&job, &n_done, &cancelled]() {
+			if (job.task && !cancelled)
+				job.changed = job.task(job.changes);
+			++n_done;
+		});
+
+	// Wait for them to finish, showing progress if it takes a while (and the
+	// editor UI is open, not in batch mode)
+	unique_ptr<wxProgressDialog> progress;
+	auto                         start = std::chrono::steady_clock::now();
+	while (n_done < jobs.size())
+	{
+		if (!progress && theMainWindow
+			&& std::chrono::steady_clock::now() - start > std::chrono::milliseconds(250))
+			progress = std::make_unique<wxProgressDialog>(
+				"Replacing in Maps",
+				fmt::format("Replacing {} in {} maps...", what, jobs.size()),
+				jobs.size(),
+				theMainWindow,
+				wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+		if (progress && !cancelled && !progress->Update(n_done))
+			cancelled = true;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	progress.reset();
+
+	if (cancelled)
+	{
+		log::info("Replacing {} in maps cancelled, no changes made", what);
+		return 0;
+	}
+
+	// Apply changes to all map entries
+	size_t   changed = 0;
+	wxString report  = "";
+	for (auto& job : jobs)
+	{
+		applyEntryChanges(job.changes);
+		report += fmt::format("{}:\t{} {} changed\n", job.name, job.changed, what);
+		changed += job.changed;
+	}
+
+	// Write back any modified embedded wads (nested wads first)
+	for (auto wad = wads.rbegin(); wad != wads.rend(); ++wad)
+	{
+		size_t wad_changed = 0;
+		for (auto a = wad->first_job; a < wad->end_job; a++)
+			wad_changed += jobs[a].changed;
+		if (wad_changed == 0)
+			continue;
+
+		MemChunk mc;
+		if (!wad->archive->write(mc, true) || !wad->entry->importMemChunk(mc))
+			log::warning("Unable to write changes to embedded wad {}", wad->entry->name());
+	}
+
+	log::info(1, report);
+	return changed;
+}
+} // namespace
+
+size_t replaceThingsDoom(ArchiveEntry* entry, EntryChanges& changes, int oldtype, int newtype)
 {
 	if (entry == nullptr)
 		return 0;
@@ -829,7 +994,7 @@ size_t replaceThingsDoom(ArchiveEntry* entry, int oldtype, int newtype)
 	size_t changed   = 0;
 
 	auto things = new DoomMapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	memcpy(things, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t t = 0; t < numthings; ++t)
@@ -842,12 +1007,12 @@ size_t replaceThingsDoom(ArchiveEntry* entry, int oldtype, int newtype)
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
+		addEntryChange(changes, entry, things, size);
 	delete[] things;
 
 	return changed;
 }
-size_t replaceThingsDoom64(ArchiveEntry* entry, int oldtype, int newtype)
+size_t replaceThingsDoom64(ArchiveEntry* entry, EntryChanges& changes, int oldtype, int newtype)
 {
 	if (entry == nullptr)
 		return 0;
@@ -857,7 +1022,7 @@ size_t replaceThingsDoom64(ArchiveEntry* entry, int oldtype, int newtype)
 	size_t changed   = 0;
 
 	auto things = new Doom64MapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	memcpy(things, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t t = 0; t < numthings; ++t)
@@ -870,12 +1035,12 @@ size_t replaceThingsDoom64(ArchiveEntry* entry, int oldtype, int newtype)
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
+		addEntryChange(changes, entry, things, size);
 	delete[] things;
 
 	return changed;
 }
-size_t replaceThingsHexen(ArchiveEntry* entry, int oldtype, int newtype)
+size_t replaceThingsHexen(ArchiveEntry* entry, EntryChanges& changes, int oldtype, int newtype)
 {
 	if (entry == nullptr)
 		return 0;
@@ -885,7 +1050,7 @@ size_t replaceThingsHexen(ArchiveEntry* entry, int oldtype, int newtype)
 	size_t changed   = 0;
 
 	auto things = new HexenMapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	memcpy(things, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t t = 0; t < numthings; ++t)
@@ -898,12 +1063,12 @@ size_t replaceThingsHexen(ArchiveEntry* entry, int oldtype, int newtype)
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
+		addEntryChange(changes, entry, things, size);
 	delete[] things;
 
 	return changed;
 }
-size_t replaceThingsUDMF(ArchiveEntry* entry, int oldtype, int newtype)
+size_t replaceThingsUDMF(ArchiveEntry* entry, EntryChanges& changes, int oldtype, int newtype)
 {
 	if (entry == nullptr)
 		return 0;
@@ -919,91 +1084,55 @@ size_t replaceThingsUDMF(ArchiveEntry* entry, int oldtype, int newtype)
 }
 size_t archiveoperations::replaceThings(Archive* archive, int oldtype, int newtype)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
-
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
-		if (!m_head)
-			continue;
+		return 0;
 
-		size_t achanged = 0;
-		// Is it an embedded wad?
-		if (map.archive)
+	auto get_task = [=](const Archive::MapDesc& map, const vector<ArchiveEntry*>& entries) -> MapReplaceTask {
+		// Find the map entry to modify
+		ArchiveEntry* things = nullptr;
+		if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
 		{
-			// Attempt to open entry as wad archive
-			auto temp_archive = std::make_shared<WadArchive>();
-			if (temp_archive->open(m_head->data()))
+			for (auto mapentry : entries)
 			{
-				achanged = archiveoperations::replaceThings(temp_archive.get(), oldtype, newtype);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
+				if (mapentry->type() == EntryType::fromId("map_things"))
 				{
-					achanged = 0;
-				}
-				else
-				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
+					things = mapentry;
+					break;
 				}
 			}
 		}
-		else
+		else if (map.format == MapFormat::UDMF)
 		{
-			// Find the map entry to modify
-			auto          entries = map.entries(*archive);
-			ArchiveEntry* things  = nullptr;
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("map_things"))
-					{
-						things = mapentry;
-						break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
+			for (auto mapentry : entries)
 			{
-				for (auto mapentry : entries)
+				if (mapentry->type() == EntryType::fromId("udmf_textmap"))
 				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						things = mapentry;
-						break;
-					}
+					things = mapentry;
+					break;
 				}
 			}
+		}
 
-			// Did we get a map entry?
-			if (things)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom: achanged = replaceThingsDoom(things, oldtype, newtype); break;
-				case MapFormat::Hexen: achanged = replaceThingsHexen(things, oldtype, newtype); break;
-				case MapFormat::Doom64: achanged = replaceThingsDoom64(things, oldtype, newtype); break;
-				case MapFormat::UDMF: achanged = replaceThingsUDMF(things, oldtype, newtype); break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
+		// Did we get a map entry?
+		if (!things)
+			return nullptr;
+
+		switch (map.format)
+		{
+		case MapFormat::Doom:
+			return [=](EntryChanges& changes) { return replaceThingsDoom(things, changes, oldtype, newtype); };
+		case MapFormat::Hexen:
+			return [=](EntryChanges& changes) { return replaceThingsHexen(things, changes, oldtype, newtype); };
+		case MapFormat::Doom64:
+			return [=](EntryChanges& changes) { return replaceThingsDoom64(things, changes, oldtype, newtype); };
+		case MapFormat::UDMF:
+			return [=](EntryChanges& changes) { return replaceThingsUDMF(things, changes, oldtype, newtype); };
+		default: log::warning("Unknown map format for " + map.name); return nullptr;
 		}
-		report += wxString::Format("%s:\t%i things changed\n", m_head->name(), achanged);
-		changed += achanged;
-	}
-	log::info(1, report);
-	return changed;
+	};
+
+	return replaceInMaps(*archive, "things", get_task);
 }
 
 CONSOLE_COMMAND(replacethings, 2, true)
@@ -1086,7 +1215,14 @@ CONSOLE_COMMAND(convertmapchex2to3, 0, false)
 	}
 }
 
-size_t replaceSpecialsDoom(ArchiveEntry* entry, int oldtype, int newtype, bool tag, int oldtag, int newtag)
+size_t replaceSpecialsDoom(
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	int           oldtype,
+	int           newtype,
+	bool          tag,
+	int           oldtag,
+	int           newtag)
 {
 	if (entry == nullptr)
 		return 0;
@@ -1096,7 +1232,7 @@ size_t replaceSpecialsDoom(ArchiveEntry* entry, int oldtype, int newtype, bool t
 	size_t changed  = 0;
 
 	auto lines = new DoomMapFormat::LineDef[numlines];
-	memcpy(lines, entry->rawData(), size);
+	memcpy(lines, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t l = 0; l < numlines; ++l)
@@ -1114,18 +1250,26 @@ size_t replaceSpecialsDoom(ArchiveEntry* entry, int oldtype, int newtype, bool t
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, lines, size);
+		addEntryChange(changes, entry, lines, size);
 	delete[] lines;
 
 	return changed;
 }
-size_t replaceSpecialsDoom64(ArchiveEntry* entry, int oldtype, int newtype, bool tag, int oldtag, int newtag)
+size_t replaceSpecialsDoom64(
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	int           oldtype,
+	int           newtype,
+	bool          tag,
+	int           oldtag,
+	int           newtag)
 {
 	return 0;
 }
 size_t replaceSpecialsHexen(
 	ArchiveEntry* l_entry,
 	ArchiveEntry* t_entry,
+	EntryChanges& changes,
 	int           oldtype,
 	int           newtype,
 	bool          arg0,
@@ -1156,7 +1300,7 @@ size_t replaceSpecialsHexen(
 		size_t numlines = size / sizeof(HexenMapFormat::LineDef);
 
 		auto lines = new HexenMapFormat::LineDef[numlines];
-		memcpy(lines, l_entry->rawData(), size);
+		memcpy(lines, l_entry->rawData(false), size);
 		size_t lchanged = 0;
 
 		// Perform replacement
@@ -1186,7 +1330,7 @@ size_t replaceSpecialsHexen(
 		// Import the changes if needed
 		if (lchanged > 0)
 		{
-			importEntryDataKeepType(l_entry, lines, size);
+			addEntryChange(changes, l_entry, lines, size);
 			changed += lchanged;
 		}
 		delete[] lines;
@@ -1198,7 +1342,7 @@ size_t replaceSpecialsHexen(
 		size_t numthings = size / sizeof(HexenMapFormat::Thing);
 
 		auto things = new HexenMapFormat::Thing[numthings];
-		memcpy(things, t_entry->rawData(), size);
+		memcpy(things, t_entry->rawData(false), size);
 		size_t tchanged = 0;
 
 		// Perform replacement
@@ -1228,7 +1372,7 @@ size_t replaceSpecialsHexen(
 		// Import the changes if needed
 		if (tchanged > 0)
 		{
-			importEntryDataKeepType(t_entry, things, size);
+			addEntryChange(changes, t_entry, things, size);
 			changed += tchanged;
 		}
 		delete[] things;
@@ -1238,6 +1382,7 @@ size_t replaceSpecialsHexen(
 }
 size_t replaceSpecialsUDMF(
 	ArchiveEntry* entry,
+	EntryChanges& changes,
 	int           oldtype,
 	int           newtype,
 	bool          arg0,
@@ -1290,173 +1435,116 @@ size_t archiveoperations::replaceSpecials(
 	int      oldarg4,
 	int      newarg4)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
-
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
-		if (!m_head)
-			continue;
+		return 0;
 
-		size_t achanged = 0;
-		// Is it an embedded wad?
-		if (map.archive)
+	auto get_task = [=](const Archive::MapDesc& map, const vector<ArchiveEntry*>& entries) -> MapReplaceTask {
+		// Find the map entry to modify
+		ArchiveEntry* t_entry = nullptr;
+		ArchiveEntry* l_entry = nullptr;
+		if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
 		{
-			// Attempt to open entry as wad archive
-			Archive* temp_archive = new WadArchive();
-			if (temp_archive->open(m_head.get()))
+			for (auto mapentry : entries)
 			{
-				achanged = archiveoperations::replaceSpecials(
-					temp_archive,
-					oldtype,
-					newtype,
-					lines,
-					things,
-					arg0,
-					oldarg0,
-					newarg0,
-					arg1,
-					oldarg1,
-					newarg1,
-					arg2,
-					oldarg2,
-					newarg2,
-					arg3,
-					oldarg3,
-					newarg3,
-					arg4,
-					oldarg4,
-					newarg4);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
+				if (things && mapentry->type() == EntryType::fromId("map_things"))
 				{
-					achanged = 0;
+					t_entry = mapentry;
+					if (l_entry || !lines)
+						break;
 				}
-				else
+				if (lines && mapentry->type() == EntryType::fromId("map_linedefs"))
 				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
+					l_entry = mapentry;
+					if (t_entry || !things)
+						break;
 				}
 			}
-
-			// Cleanup
-			delete temp_archive;
 		}
-		else
+		else if (map.format == MapFormat::UDMF)
 		{
-			// Find the map entry to modify
-			ArchiveEntry* t_entry = nullptr;
-			ArchiveEntry* l_entry = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
+			for (auto mapentry : entries)
 			{
-				for (auto mapentry : entries)
+				if (mapentry->type() == EntryType::fromId("udmf_textmap"))
 				{
-					if (things && mapentry->type() == EntryType::fromId("map_things"))
-					{
-						t_entry = mapentry;
-						if (l_entry || !lines)
-							break;
-					}
-					if (lines && mapentry->type() == EntryType::fromId("map_linedefs"))
-					{
-						l_entry = mapentry;
-						if (t_entry || !things)
-							break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						l_entry = t_entry = mapentry;
-						break;
-					}
+					l_entry = t_entry = mapentry;
+					break;
 				}
 			}
+		}
 
-			// Did we get a map entry?
-			if (l_entry || t_entry)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom:
-					if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
-						break;
-					achanged = replaceSpecialsDoom(l_entry, oldtype, newtype, arg0, oldarg0, newarg0);
-					break;
-				case MapFormat::Hexen:
-					if (oldtype > 255 || newtype > 255) // Do nothing if Doom specials are being modified
-						break;
-					achanged = replaceSpecialsHexen(
-						l_entry,
-						t_entry,
-						oldtype,
-						newtype,
-						arg0,
-						arg1,
-						arg2,
-						arg3,
-						arg4,
-						oldarg0,
-						oldarg1,
-						oldarg2,
-						oldarg3,
-						oldarg4,
-						newarg0,
-						newarg1,
-						newarg2,
-						newarg3,
-						newarg4);
-					break;
-				case MapFormat::Doom64:
-					if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
-						break;
-					achanged = replaceSpecialsDoom64(l_entry, oldtype, newtype, arg0, oldarg0, newarg0);
-					break;
-				case MapFormat::UDMF:
-					achanged = replaceSpecialsUDMF(
-						l_entry,
-						oldtype,
-						newtype,
-						arg0,
-						arg1,
-						arg2,
-						arg3,
-						arg4,
-						oldarg0,
-						oldarg1,
-						oldarg2,
-						oldarg3,
-						oldarg4,
-						newarg0,
-						newarg1,
-						newarg2,
-						newarg3,
-						newarg4);
-					break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
+		// Did we get a map entry?
+		if (!l_entry && !t_entry)
+			return nullptr;
+
+		switch (map.format)
+		{
+		case MapFormat::Doom:
+			if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
+				return nullptr;
+			return [=](EntryChanges& changes) {
+				return replaceSpecialsDoom(l_entry, changes, oldtype, newtype, arg0, oldarg0, newarg0);
+			};
+		case MapFormat::Hexen:
+			if (oldtype > 255 || newtype > 255) // Do nothing if Doom specials are being modified
+				return nullptr;
+			return [=](EntryChanges& changes) {
+				return replaceSpecialsHexen(
+					l_entry,
+					t_entry,
+					changes,
+					oldtype,
+					newtype,
+					arg0,
+					arg1,
+					arg2,
+					arg3,
+					arg4,
+					oldarg0,
+					oldarg1,
+					oldarg2,
+					oldarg3,
+					oldarg4,
+					newarg0,
+					newarg1,
+					newarg2,
+					newarg3,
+					newarg4);
+			};
+		case MapFormat::Doom64:
+			if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
+				return nullptr;
+			return [=](EntryChanges& changes) {
+				return replaceSpecialsDoom64(l_entry, changes, oldtype, newtype, arg0, oldarg0, newarg0);
+			};
+		case MapFormat::UDMF:
+			return [=](EntryChanges& changes) {
+				return replaceSpecialsUDMF(
+					l_entry,
+					changes,
+					oldtype,
+					newtype,
+					arg0,
+					arg1,
+					arg2,
+					arg3,
+					arg4,
+					oldarg0,
+					oldarg1,
+					oldarg2,
+					oldarg3,
+					oldarg4,
+					newarg0,
+					newarg1,
+					newarg2,
+					newarg3,
+					newarg4);
+			};
+		default: log::warning("Unknown map format for " + map.name); return nullptr;
 		}
-		report += wxString::Format("%s:\t%i specials changed\n", m_head->name(), achanged);
-		changed += achanged;
-	}
-	log::info(1, report);
-	return changed;
+	};
+
+	return replaceInMaps(*archive, "specials", get_task);
 }
 
 CONSOLE_COMMAND(replacespecials, 2, true)
@@ -1511,10 +1599,10 @@ CONSOLE_COMMAND(replacespecials, 2, true)
 	}
 }
 
-bool replaceTextureString(char* str, wxString oldtex, wxString newtex)
+bool replaceTextureString(char* str, string_view oldtex, string_view newtex)
 {
 	bool go = true;
-	for (unsigned c = 0; c < oldtex.Length(); ++c)
+	for (unsigned c = 0; c < oldtex.size(); ++c)
 	{
 		if (str[c] != oldtex[c] && oldtex[c] != '?' && oldtex[c] != '*')
 			go = false;
@@ -1525,7 +1613,7 @@ bool replaceTextureString(char* str, wxString oldtex, wxString newtex)
 	{
 		for (unsigned i = 0; i < 8; ++i)
 		{
-			if (i < newtex.Len())
+			if (i < newtex.size())
 			{
 				// Keep the rest of the name as-is?
 				if (newtex[i] == '*')
@@ -1543,11 +1631,12 @@ bool replaceTextureString(char* str, wxString oldtex, wxString newtex)
 	return go;
 }
 size_t replaceFlatsDoomHexen(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            floor,
-	bool            ceiling)
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	string_view   oldtex,
+	string_view   newtex,
+	bool          floor,
+	bool          ceiling)
 {
 	if (entry == nullptr)
 		return 0;
@@ -1558,7 +1647,7 @@ size_t replaceFlatsDoomHexen(
 	size_t changed = 0;
 
 	auto sectors = new DoomMapFormat::Sector[numsectors];
-	memcpy(sectors, entry->rawData(), size);
+	memcpy(sectors, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t s = 0; s < numsectors; ++s)
@@ -1573,18 +1662,19 @@ size_t replaceFlatsDoomHexen(
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, sectors, size);
+		addEntryChange(changes, entry, sectors, size);
 	delete[] sectors;
 
 	return changed;
 }
 size_t replaceWallsDoomHexen(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            lower,
-	bool            middle,
-	bool            upper)
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	string_view   oldtex,
+	string_view   newtex,
+	bool          lower,
+	bool          middle,
+	bool          upper)
 {
 	if (entry == nullptr)
 		return 0;
@@ -1595,7 +1685,7 @@ size_t replaceWallsDoomHexen(
 	size_t changed = 0;
 
 	DoomMapFormat::SideDef* sides = new DoomMapFormat::SideDef[numsides];
-	memcpy(sides, entry->rawData(), size);
+	memcpy(sides, entry->rawData(false), size);
 	char compare[9];
 	compare[8] = 0;
 
@@ -1614,12 +1704,18 @@ size_t replaceWallsDoomHexen(
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, sides, size);
+		addEntryChange(changes, entry, sides, size);
 	delete[] sides;
 
 	return changed;
 }
-size_t replaceFlatsDoom64(ArchiveEntry* entry, const wxString& oldtex, const wxString& newtex, bool floor, bool ceiling)
+size_t replaceFlatsDoom64(
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	uint16_t      oldhash,
+	uint16_t      newhash,
+	bool          floor,
+	bool          ceiling)
 {
 	if (entry == nullptr)
 		return 0;
@@ -1629,11 +1725,8 @@ size_t replaceFlatsDoom64(ArchiveEntry* entry, const wxString& oldtex, const wxS
 	bool   fchanged, cchanged;
 	size_t changed = 0;
 
-	uint16_t oldhash = app::resources().getTextureHash(oldtex.ToStdString());
-	uint16_t newhash = app::resources().getTextureHash(newtex.ToStdString());
-
 	auto sectors = new Doom64MapFormat::Sector[numsectors];
-	memcpy(sectors, entry->rawData(), size);
+	memcpy(sectors, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t s = 0; s < numsectors; ++s)
@@ -1654,18 +1747,19 @@ size_t replaceFlatsDoom64(ArchiveEntry* entry, const wxString& oldtex, const wxS
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, sectors, size);
+		addEntryChange(changes, entry, sectors, size);
 	delete[] sectors;
 
 	return changed;
 }
 size_t replaceWallsDoom64(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            lower,
-	bool            middle,
-	bool            upper)
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	uint16_t      oldhash,
+	uint16_t      newhash,
+	bool          lower,
+	bool          middle,
+	bool          upper)
 {
 	if (entry == nullptr)
 		return 0;
@@ -1675,11 +1769,8 @@ size_t replaceWallsDoom64(
 	bool   lchanged, mchanged, uchanged;
 	size_t changed = 0;
 
-	uint16_t oldhash = app::resources().getTextureHash(oldtex.ToStdString());
-	uint16_t newhash = app::resources().getTextureHash(newtex.ToStdString());
-
 	auto sides = new Doom64MapFormat::SideDef[numsides];
-	memcpy(sides, entry->rawData(), size);
+	memcpy(sides, entry->rawData(false), size);
 
 	// Perform replacement
 	for (size_t s = 0; s < numsides; ++s)
@@ -1705,20 +1796,21 @@ size_t replaceWallsDoom64(
 	}
 	// Import the changes if needed
 	if (changed > 0)
-		importEntryDataKeepType(entry, sides, size);
+		addEntryChange(changes, entry, sides, size);
 	delete[] sides;
 
 	return changed;
 }
 size_t replaceTexturesUDMF(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            floor,
-	bool            ceiling,
-	bool            lower,
-	bool            middle,
-	bool            upper)
+	ArchiveEntry* entry,
+	EntryChanges& changes,
+	string_view   oldtex,
+	string_view   newtex,
+	bool          floor,
+	bool          ceiling,
+	bool          lower,
+	bool          middle,
+	bool          upper)
 {
 	if (entry == nullptr)
 		return 0;
@@ -1742,125 +1834,662 @@ size_t archiveoperations::replaceTextures(
 	bool            middle,
 	bool            upper)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
-
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
-		if (!m_head)
-			continue;
+		return 0;
 
-		size_t achanged = 0;
-		// Is it an embedded wad?
-		if (map.archive)
+	// Doom64 maps reference textures by hash
+	auto old_name = oldtex.ToStdString();
+	auto new_name = newtex.ToStdString();
+	auto oldhash  = app::resources().getTextureHash(old_name);
+	auto newhash  = app::resources().getTextureHash(new_name);
+
+	auto get_task = [=](const Archive::MapDesc& map, const vector<ArchiveEntry*>& entries) -> MapReplaceTask {
+		// Find the map entry to modify
+		ArchiveEntry* sectors = nullptr;
+		ArchiveEntry* sides   = nullptr;
+		if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
 		{
-			// Attempt to open entry as wad archive
-			Archive* temp_archive = new WadArchive();
-			if (temp_archive->open(m_head.get()))
+			for (auto mapentry : entries)
 			{
-				achanged = archiveoperations::replaceTextures(
-					temp_archive, oldtex, newtex, floor, ceiling, lower, middle, upper);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
+				if ((floor || ceiling) && (mapentry->type() == EntryType::fromId("map_sectors")))
 				{
-					achanged = 0;
+					sectors = mapentry;
+					if (sides || !(lower || middle || upper))
+						break;
 				}
-				else
+				if ((lower || middle || upper) && (mapentry->type() == EntryType::fromId("map_sidedefs")))
 				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
+					sides = mapentry;
+					if (sectors || !(floor || ceiling))
+						break;
 				}
 			}
-
-			// Cleanup
-			delete temp_archive;
 		}
-		else
+		else if (map.format == MapFormat::UDMF)
 		{
-			// Find the map entry to modify
-			ArchiveEntry* sectors = nullptr;
-			ArchiveEntry* sides   = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
+			for (auto mapentry : entries)
 			{
-				for (auto mapentry : entries)
+				if (mapentry->type() == EntryType::fromId("udmf_textmap"))
 				{
-					if ((floor || ceiling) && (mapentry->type() == EntryType::fromId("map_sectors")))
-					{
-						sectors = mapentry;
-						if (sides || !(lower || middle || upper))
-							break;
-					}
-					if ((lower || middle || upper) && (mapentry->type() == EntryType::fromId("map_sidedefs")))
-					{
-						sides = mapentry;
-						if (sectors || !(floor || ceiling))
-							break;
-					}
+					sectors = sides = mapentry;
+					break;
 				}
 			}
-			else if (map.format == MapFormat::UDMF)
+		}
+
+		// Did we get a map entry?
+		if (!sectors && !sides)
+			return nullptr;
+
+		switch (map.format)
+		{
+		case MapFormat::Doom:
+		case MapFormat::Hexen:
+			return [=](EntryChanges& changes) {
+				size_t changed = 0;
+				if (sectors)
+					changed += replaceFlatsDoomHexen(sectors, changes, old_name, new_name, floor, ceiling);
+				if (sides)
+					changed += replaceWallsDoomHexen(sides, changes, old_name, new_name, lower, middle, upper);
+				return changed;
+			};
+		case MapFormat::Doom64:
+			return [=](EntryChanges& changes) {
+				size_t changed = 0;
+				if (sectors)
+					changed += replaceFlatsDoom64(sectors, changes, oldhash, newhash, floor, ceiling);
+				if (sides)
+					changed += replaceWallsDoom64(sides, changes, oldhash, newhash, lower, middle, upper);
+				return changed;
+			};
+		case MapFormat::UDMF:
+			return [=](EntryChanges& changes) {
+				return replaceTexturesUDMF(
+					sectors, changes, old_name, new_name, floor, ceiling, lower, middle, upper);
+			};
+		default: log::warning("Unknown map format for " + map.name); return nullptr;
+		}
+	};
+
+	return replaceInMaps(*archive, "elements", get_task);
+}
+
+CONSOLE_COMMAND(replacetextures, 2, true)
+{
+	auto current = maineditor::currentArchive();
+
+	if (current)
+	{
+		archiveoperations::replaceTextures(current, args[0], args[1], true, true, true, true, true);
+	}
+}
+
+CONSOLE_COMMAND(bench_compression, 0, false)
+{
+	auto current = maineditor::currentArchive();
+	if (!current)
+	{
+		log::console("No archive open");
+		return;
+	}
+
+	// Data is only read (so mapped entry data isn't copied)
+	vector<ArchiveEntry*>   entries;
+	vector<const MemChunk*> data;
+	current->putEntryTreeAsList(entries);
+	for (auto entry : entries)
+		if (entry->type() != EntryType::folderType() && entry->size() > 0)
+			data.push_back(&std::as_const(entry->data()));
+
+	compression::benchmark(data);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Text Search & Replace
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+struct TextSearch
+{
+	string     find; // Lowercase if not case sensitive
+	bool       match_case = false;
+	bool       use_regex  = false;
+	std::regex regex;
+};
+
+// -----------------------------------------------------------------------------
+// Initialises [search] to find [find]. Returns false if [find] is empty or an
+// invalid regular expression
+// -----------------------------------------------------------------------------
+bool initTextSearch(TextSearch& search, string_view find, bool match_case, bool regex)
+{
+	if (find.empty())
+		return false;
+
+	search.match_case = match_case;
+	search.use_regex  = regex;
+	search.find       = match_case ? string{ find } : strutil::lower(find);
+
+	if (regex)
+	{
+		try
+		{
+			auto flags = std::regex::ECMAScript;
+			if (!match_case)
+				flags |= std::regex::icase;
+			search.regex = std::regex(string{ find }, flags);
+		}
+		catch (const std::regex_error& ex)
+		{
+			log::error("Invalid regular expression \"{}\": {}", find, ex.what());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [found] with the start and end offsets of each match of [search] in
+// [text]. Safe to call from a worker thread
+// -----------------------------------------------------------------------------
+void findTextMatches(const TextSearch& search, string_view text, const std::function<void(size_t, size_t)>& found)
+{
+	if (search.use_regex)
+	{
+		std::cregex_iterator end;
+		for (std::cregex_iterator i(text.data(), text.data() + text.size(), search.regex); i != end; ++i)
+			if (i->length() > 0)
+				found(i->position(), i->position() + i->length());
+
+		return;
+	}
+
+	string lower;
+	if (!search.match_case)
+	{
+		lower = strutil::lower(text);
+		text  = lower;
+	}
+
+	auto pos = text.find(search.find);
+	while (pos != string_view::npos)
+	{
+		found(pos, pos + search.find.size());
+		pos = text.find(search.find, pos + search.find.size());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] with batches of [entries] (only text entries if [text_only] is
+// true). Entry data is loaded (in batches to limit memory usage) on this
+// thread beforehand, since loading from the archive isn't thread-safe, so
+// [func] can process the entries in each batch on the worker threads. Data is
+// unloaded again afterwards if it wasn't already loaded (and wasn't modified)
+// -----------------------------------------------------------------------------
+void forEachEntryBatch(
+	const vector<ArchiveEntry*>&                              entries,
+	bool                                                      text_only,
+	const std::function<void(const vector<ArchiveEntry*>&)>& func)
+{
+	constexpr size_t batch_size_max = 256 * 1024 * 1024;
+
+	size_t index = 0;
+	while (index < entries.size())
+	{
+		vector<ArchiveEntry*> batch;
+		vector<ArchiveEntry*> to_unload;
+		size_t                batch_size = 0;
+		while (index < entries.size() && batch_size < batch_size_max)
+		{
+			auto entry = entries[index++];
+			if (entry->type() == EntryType::folderType() || entry->size() == 0)
+				continue;
+
+			// Loading the data also detects the entry type if it was deferred
+			bool was_loaded = entry->isLoaded();
+			entry->data();
+			if (!text_only || entry->type()->editor() == "text")
 			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
+				batch.push_back(entry);
+				batch_size += entry->size();
+			}
+			if (!was_loaded)
+				to_unload.push_back(entry);
+		}
+
+		if (!batch.empty())
+			func(batch);
+
+		for (auto entry : to_unload)
+			entry->unloadData();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] with batches of all text entries in [archive], see
+// forEachEntryBatch
+// -----------------------------------------------------------------------------
+void forEachTextEntryBatch(Archive* archive, const std::function<void(const vector<ArchiveEntry*>&)>& func)
+{
+	vector<ArchiveEntry*> entries;
+	archive->putEntryTreeAsList(entries);
+	forEachEntryBatch(entries, true, func);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the text data of [entry]
+// -----------------------------------------------------------------------------
+string_view entryText(ArchiveEntry* entry)
+{
+	const auto& data = std::as_const(entry->data(false));
+	return { reinterpret_cast<const char*>(data.data()), data.size() };
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Data Search
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+char foldCase(char c)
+{
+	return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+struct FoldCaseHash
+{
+	size_t operator()(char c) const { return std::hash<char>{}(foldCase(c)); }
+};
+
+struct FoldCaseEqual
+{
+	bool operator()(char a, char b) const { return foldCase(a) == foldCase(b); }
+};
+
+using FoldCaseSearcher = std::boyer_moore_horspool_searcher<const char*, FoldCaseHash, FoldCaseEqual>;
+
+// -----------------------------------------------------------------------------
+// Calls [found] with the offset of each (non-overlapping) occurrence of [find]
+// in [data]. Case sensitive searches look for the first byte of [find] with
+// memchr and compare the rest with memcmp (both are vectorised by the C
+// library), otherwise the [fold_case] searcher is used.
+// Safe to call from a worker thread
+// -----------------------------------------------------------------------------
+void findDataMatches(
+	string_view                        data,
+	string_view                        find,
+	const FoldCaseSearcher*            fold_case,
+	const std::function<void(size_t)>& found)
+{
+	if (data.size() < find.size())
+		return;
+
+	const auto begin = data.data();
+	const auto end   = begin + data.size();
+
+	if (fold_case)
+	{
+		auto pos = begin;
+		while (pos < end)
+		{
+			auto match = (*fold_case)(pos, end).first;
+			if (match == end)
+				break;
+
+			found(match - begin);
+			pos = match + find.size();
+		}
+
+		return;
+	}
+
+	const auto last = end - find.size(); // Last position a match can start at
+	auto       pos  = begin;
+	while (pos <= last)
+	{
+		pos = static_cast<const char*>(memchr(pos, find[0], last - pos + 1));
+		if (!pos)
+			break;
+
+		if (memcmp(pos + 1, find.data() + 1, find.size() - 1) == 0)
+		{
+			found(pos - begin);
+			pos += find.size();
+		}
+		else
+			++pos;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Converts the hex byte string [hex] (eg. "FF 00 1a") to bytes in [bytes].
+// Returns false if [hex] isn't valid
+// -----------------------------------------------------------------------------
+bool hexToBytes(string_view hex, string& bytes)
+{
+	string digits;
+	for (auto c : hex)
+	{
+		if (c == ' ')
+			continue;
+		if (!isxdigit(static_cast<unsigned char>(c)))
+			return false;
+		digits += c;
+	}
+
+	if (digits.empty() || digits.size() % 2 != 0)
+		return false;
+
+	bytes.clear();
+	for (size_t a = 0; a < digits.size(); a += 2)
+		bytes += static_cast<char>(std::stoi(digits.substr(a, 2), nullptr, 16));
+
+	return true;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Finds all lines containing [find] in all text entries in [archive] (on the
+// worker threads). If [regex] is true, [find] is a regular expression
+// -----------------------------------------------------------------------------
+vector<archiveoperations::TextMatch> archiveoperations::findText(
+	Archive*    archive,
+	string_view find,
+	bool        match_case,
+	bool        regex)
+{
+	vector<TextMatch> matches;
+	TextSearch        search;
+	if (!archive || !initTextSearch(search, find, match_case, regex))
+		return matches;
+
+	forEachTextEntryBatch(archive, [&](const vector<ArchiveEntry*>& batch) {
+		vector<vector<TextMatch>> batch_matches(batch.size());
+		threadpool::parallelFor(batch.size(), [&](size_t index) {
+			auto     entry      = batch[index];
+			auto     text       = entryText(entry);
+			unsigned line       = 1;
+			size_t   line_start = 0;
+			size_t   scanned    = 0;
+			findTextMatches(search, text, [&](size_t start, size_t end) {
+				// Count lines up to the match
+				for (; scanned < start; ++scanned)
+					if (text[scanned] == '\n')
 					{
-						sectors = sides = mapentry;
-						break;
+						line++;
+						line_start = scanned + 1;
 					}
-				}
-			}
 
-			// Did we get a map entry?
-			if (sectors || sides)
+				// Only list each line once
+				auto& entry_matches = batch_matches[index];
+				if (!entry_matches.empty() && entry_matches.back().line == line)
+					return;
+
+				auto line_text = text.substr(line_start, text.find('\n', start) - line_start);
+				if (strutil::endsWith(line_text, '\r'))
+					line_text.remove_suffix(1);
+				entry_matches.push_back({ entry, line, strutil::trim(line_text) });
+			});
+		});
+
+		for (auto& entry_matches : batch_matches)
+			for (auto& match : entry_matches)
+				matches.push_back(std::move(match));
+	});
+
+	return matches;
+}
+
+// -----------------------------------------------------------------------------
+// Replaces all occurrences of [find] with [replace] in all text entries in
+// [archive] (on the worker threads). If [regex] is true, [find] is a regular
+// expression and [replace] can contain $n references to its groups.
+// Only entries containing [find] are modified. Returns the number of
+// occurrences replaced
+// -----------------------------------------------------------------------------
+size_t archiveoperations::replaceText(
+	Archive*    archive,
+	string_view find,
+	string_view replace,
+	bool        match_case,
+	bool        regex)
+{
+	TextSearch search;
+	if (!archive || !initTextSearch(search, find, match_case, regex))
+		return 0;
+
+	size_t n_replaced = 0;
+	forEachTextEntryBatch(archive, [&](const vector<ArchiveEntry*>& batch) {
+		vector<string> new_text(batch.size());
+		vector<size_t> counts(batch.size(), 0);
+		threadpool::parallelFor(batch.size(), [&](size_t index) {
+			if (batch[index]->isLocked())
+				return;
+
+			auto   text = entryText(batch[index]);
+			auto&  out  = new_text[index];
+			size_t last = 0;
+			findTextMatches(search, text, [&](size_t start, size_t end) {
+				out.append(text.substr(last, start - last));
+				out.append(replace);
+				last = end;
+				counts[index]++;
+			});
+			if (counts[index] == 0)
+				return;
+
+			if (regex)
+				out = std::regex_replace(string{ text }, search.regex, string{ replace });
+			else
+				out.append(text.substr(last));
+		});
+
+		// Write modified entries
+		for (size_t a = 0; a < batch.size(); a++)
+			if (counts[a] > 0)
 			{
-				switch (map.format)
-				{
-				case MapFormat::Doom:
-				case MapFormat::Hexen:
-					achanged = 0;
-					if (sectors)
-						achanged += replaceFlatsDoomHexen(sectors, oldtex, newtex, floor, ceiling);
-					if (sides)
-						achanged += replaceWallsDoomHexen(sides, oldtex, newtex, lower, middle, upper);
-					break;
-				case MapFormat::Doom64:
-					achanged = 0;
-					if (sectors)
-						achanged += replaceFlatsDoom64(sectors, oldtex, newtex, floor, ceiling);
-					if (sides)
-						achanged += replaceWallsDoom64(sides, oldtex, newtex, lower, middle, upper);
-					break;
-				case MapFormat::UDMF:
-					achanged = replaceTexturesUDMF(sectors, oldtex, newtex, floor, ceiling, lower, middle, upper);
-					break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
+				importEntryDataKeepType(batch[a], new_text[a].data(), new_text[a].size());
+				n_replaced += counts[a];
 			}
-		}
-		report += wxString::Format("%s:\t%i elements changed\n", m_head->name(), achanged);
-		changed += achanged;
+	});
+
+	return n_replaced;
+}
+
+// -----------------------------------------------------------------------------
+// Prompts for text to find in all text entries in [archive], and displays a
+// list of all matching lines
+// -----------------------------------------------------------------------------
+bool archiveoperations::findTextInEntries(Archive* archive)
+{
+	auto find = wxGetTextFromUser("Enter text to find (case-insensitive):", "Find Text in Entries").ToStdString();
+	if (find.empty())
+		return false;
+
+	auto start   = app::runTimer();
+	auto matches = findText(archive, find);
+	log::info(2, "Found {} matching lines in {}ms", matches.size(), app::runTimer() - start);
+	if (matches.empty())
+	{
+		wxMessageBox(wxString::Format("\"%s\" not found in any text entries", find));
+		return false;
 	}
-	log::info(1, report);
-	return changed;
+
+	string list;
+	for (const auto& match : matches)
+		list += fmt::format("{}:{}\t{}\n", match.entry->path(true).substr(1), match.line, match.line_text);
+
+	ExtMessageDialog msg(theMainWindow, "Find Text in Entries");
+	msg.setExt(wxString::FromUTF8(list));
+	msg.setMessage(fmt::format("Found \"{}\" on {} lines:", find, matches.size()));
+	msg.ShowModal();
+
+	return true;
 }
 
-CONSOLE_COMMAND(replacetextures, 2, true)
+// -----------------------------------------------------------------------------
+// Prompts for text to find and replace in all text entries in [archive]
+// -----------------------------------------------------------------------------
+bool archiveoperations::replaceTextInEntries(Archive* archive)
+{
+	auto find = wxGetTextFromUser("Enter text to find (case-insensitive):", "Replace Text in Entries").ToStdString();
+	if (find.empty())
+		return false;
+
+	auto replace = wxGetTextFromUser(
+					   wxString::Format("Enter text to replace \"%s\" with:", find), "Replace Text in Entries")
+					   .ToStdString();
+
+	auto count = replaceText(archive, find, replace);
+	wxMessageBox(fmt::format("Replaced {} occurrences", count));
+
+	return count > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Finds [find] in the data of all entries in [archives] (on the worker
+// threads), returning the offset of the first occurrence and the number of
+// occurrences for each entry containing it. Entry data that references its
+// archive's data is searched in place, without being copied
+// -----------------------------------------------------------------------------
+vector<archiveoperations::DataMatch> archiveoperations::findData(
+	const vector<Archive*>& archives,
+	string_view             find,
+	bool                    match_case)
+{
+	vector<DataMatch> matches;
+	if (find.empty())
+		return matches;
+
+	std::optional<FoldCaseSearcher> fold_case;
+	if (!match_case)
+		fold_case.emplace(find.data(), find.data() + find.size());
+
+	vector<ArchiveEntry*> entries;
+	for (auto archive : archives)
+		archive->putEntryTreeAsList(entries);
+
+	forEachEntryBatch(entries, false, [&](const vector<ArchiveEntry*>& batch) {
+		vector<DataMatch> batch_matches(batch.size());
+		threadpool::parallelFor(batch.size(), [&](size_t index) {
+			auto& match = batch_matches[index];
+			match.entry = batch[index];
+			findDataMatches(entryText(batch[index]), find, fold_case ? &*fold_case : nullptr, [&](size_t offset) {
+				if (match.count++ == 0)
+					match.offset = offset;
+			});
+		});
+
+		for (const auto& match : batch_matches)
+			if (match.count > 0)
+				matches.push_back(match);
+	});
+
+	return matches;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a list of all open archives (including the base resource archive)
+// -----------------------------------------------------------------------------
+vector<Archive*> archiveoperations::allOpenArchives()
+{
+	vector<Archive*> archives;
+	if (auto base = app::archiveManager().baseResourceArchive())
+		archives.push_back(base);
+	for (const auto& archive : app::archiveManager().allArchives())
+		archives.push_back(archive.get());
+
+	return archives;
+}
+
+// -----------------------------------------------------------------------------
+// Prompts for text to find in the data of all entries in all open archives
+// -----------------------------------------------------------------------------
+bool archiveoperations::findDataInArchives()
+{
+	auto find = wxGetTextFromUser("Enter text to find (case-insensitive):", "Find in All Archive Data").ToStdString();
+	if (find.empty())
+		return false;
+
+	auto start   = app::runTimer();
+	auto matches = findData(allOpenArchives(), find);
+	log::info(2, "Found {} matching entries in {}ms", matches.size(), app::runTimer() - start);
+	if (matches.empty())
+	{
+		wxMessageBox(wxString::Format("\"%s\" not found in any entries", find));
+		return false;
+	}
+
+	string list;
+	for (const auto& match : matches)
+		list += fmt::format(
+			"{}: {}\t@ {} ({}x)\n",
+			match.entry->parent()->filename(false),
+			match.entry->path(true).substr(1),
+			match.offset,
+			match.count);
+
+	ExtMessageDialog msg(theMainWindow, "Find in All Archive Data");
+	msg.setExt(wxString::FromUTF8(list));
+	msg.setMessage(fmt::format("Found \"{}\" in {} entries:", find, matches.size()));
+	msg.ShowModal();
+
+	return true;
+}
+
+CONSOLE_COMMAND(findtext, 1, true)
 {
 	auto current = maineditor::currentArchive();
+	if (!current)
+		return;
 
-	if (current)
+	bool match_case = VECTOR_EXISTS(args, "case");
+	bool regex      = VECTOR_EXISTS(args, "regex");
+	for (const auto& match : archiveoperations::findText(current, args[0], match_case, regex))
+		log::console(fmt::format("{}:{}: {}", match.entry->path(true).substr(1), match.line, match.line_text));
+}
+
+CONSOLE_COMMAND(replacetext, 2, true)
+{
+	auto current = maineditor::currentArchive();
+	if (!current)
+		return;
+
+	bool match_case = VECTOR_EXISTS(args, "case");
+	bool regex      = VECTOR_EXISTS(args, "regex");
+	auto count      = archiveoperations::replaceText(current, args[0], args[1], match_case, regex);
+	log::console(fmt::format("Replaced {} occurrences", count));
+}
+
+CONSOLE_COMMAND(finddata, 1, true)
+{
+	bool match_case = VECTOR_EXISTS(args, "case");
+	auto find       = args[0];
+	if (VECTOR_EXISTS(args, "hex"))
 	{
-		archiveoperations::replaceTextures(current, args[0], args[1], true, true, true, true, true);
+		if (!hexToBytes(args[0], find))
+		{
+			log::console(fmt::format("Invalid hex bytes \"{}\"", args[0]));
+			return;
+		}
+		match_case = true;
 	}
+
+	auto matches = archiveoperations::findData(archiveoperations::allOpenArchives(), find, match_case);
+	for (const auto& match : matches)
+		log::console(fmt::format(
+			"{}: {} @ {} ({}x)",
+			match.entry->parent()->filename(false),
+			match.entry->path(true).substr(1),
+			match.offset,
+			match.count));
+	log::console(fmt::format("Found in {} entries", matches.size()));
 }
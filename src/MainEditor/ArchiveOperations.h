@@ -43,4 +43,32 @@ size_t replaceSpecials(
 	bool     arg4    = false,
 	int      oldarg4 = 0,
 	int      newarg4 = 0);
+
+// Search and replace in text entries
+struct TextMatch
+{
+	ArchiveEntry* entry;
+	unsigned      line;
+	string        line_text;
+};
+vector<TextMatch> findText(Archive* archive, string_view find, bool match_case = false, bool regex = false);
+size_t replaceText(
+	Archive*    archive,
+	string_view find,
+	string_view replace,
+	bool        match_case = false,
+	bool        regex      = false);
+bool findTextInEntries(Archive* archive);
+bool replaceTextInEntries(Archive* archive);
+
+// Search in entry data in all open archives
+struct DataMatch
+{
+	ArchiveEntry* entry  = nullptr;
+	size_t        offset = 0; // Offset of the first occurrence
+	unsigned      count  = 0; // No. of occurrences
+};
+vector<DataMatch> findData(const vector<Archive*>& archives, string_view find, bool match_case = false);
+vector<Archive*>  allOpenArchives();
+bool              findDataInArchives();
 }; // namespace slade::archiveoperations
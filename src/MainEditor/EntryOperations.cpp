@@ -37,9 +37,12 @@
 #include "Archive/Formats/WadArchive.h"
 #include "BinaryControlLump.h"
 #include "General/Console.h"
+#include "General/EntryJobs.h"
+#include "General/EntryPrefetch.h"
 #include "General/Misc.h"
 #include "Graphics/GameFormats.h"
 #include "Graphics/Graphics.h"
+#include "MainEditor/ACSCompiler.h"
 #include "MainEditor/MainEditor.h"
 #include "SLADEWxApp.h"
 #include "UI/Controls/PaletteChooser.h"
@@ -48,9 +51,11 @@
 #include "UI/Dialogs/Preferences/PreferencesDialog.h"
 #include "UI/TextureXEditor/TextureXEditor.h"
 #include "Utility/FileMonitor.h"
+#include "Utility/FileUtils.h"
 #include "Utility/Memory.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/Tokenizer.h"
+#include <atomic>
 
 using namespace slade;
 
@@ -67,6 +72,7 @@ CVAR(String, path_pngcrush, "", CVar::Flag::Save);
 CVAR(String, path_deflopt, "", CVar::Flag::Save);
 CVAR(String, path_db2, "", CVar::Flag::Save)
 CVAR(Bool, acc_always_show_output, false, CVar::Flag::Save);
+CVAR(Int, max_external_processes, 0, CVar::Flag::Save) // Max external tools run at once (0 = number of cores)
 
 
 // -----------------------------------------------------------------------------
@@ -115,6 +121,136 @@ struct ChunkSize
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::atomic<unsigned> next_png_temp_id{ 0 };
+
+// -----------------------------------------------------------------------------
+// Returns true if at least one of the external PNG tools is configured
+// -----------------------------------------------------------------------------
+bool pngToolsAvailable()
+{
+	return (!path_pngcrush.empty() && wxFileExists(path_pngcrush))
+		   || (!path_pngout.empty() && wxFileExists(path_pngout))
+		   || (!path_deflopt.empty() && wxFileExists(path_deflopt));
+}
+
+// -----------------------------------------------------------------------------
+// Optimizes PNG [data] (from an entry named [name]) using the configured
+// external PNG tools. Each call uses its own temp files, so this can be run
+// for multiple entries at once. Any issues encountered are added to [errors].
+// Returns false if neither PNGCrush or PNGout could optimize the data
+// -----------------------------------------------------------------------------
+bool optimizePNGData(MemChunk& data, string_view name, string& errors)
+{
+	// Save special chunks
+	bool   alphchunk = gfx::pngGetalPh(data);
+	auto   grabchunk = gfx::getImageOffsets(data);
+	size_t oldsize   = data.size();
+	size_t crushsize = 0, outsize = 0, deflsize = 0;
+	bool   crushed = false, outed = false;
+
+	// Temp files
+	auto id      = next_png_temp_id++;
+	auto pngfile = app::path(fmt::format("optpng{}.png", id), app::Dir::Temp);
+	auto optfile = app::path(fmt::format("optpng{}.opt.png", id), app::Dir::Temp);
+
+	// Runs a PNG tool via [command], replacing [data] with the optimized
+	// file if it was created and is smaller. Returns true if the file was
+	// created
+	auto run_tool = [&](const string& command, const char* tool) {
+		data.exportFile(pngfile);
+		entryjobs::runProcess(command);
+
+		MemChunk optimized;
+		if (!fileutil::fileExists(optfile) || !optimized.importFile(optfile))
+			return false;
+
+		if (optimized.size() < data.size())
+			data.importMem(optimized);
+		else
+			errors += fmt::format("{} failed to reduce file size further.\n", tool);
+
+		fileutil::removeFile(optfile);
+		fileutil::removeFile(pngfile);
+		return true;
+	};
+
+	// Run PNGCrush
+	if (!path_pngcrush.empty() && wxFileExists(path_pngcrush))
+	{
+		crushed = run_tool(
+			fmt::format("\"{}\" -brute \"{}\" \"{}\"", path_pngcrush.value, pngfile, optfile), "PNGCrush");
+		if (!crushed)
+			errors += "PNGCrush failed to create optimized file.\n";
+		crushsize = data.size();
+	}
+
+	// Run PNGOut
+	if (!path_pngout.empty() && wxFileExists(path_pngout))
+	{
+		outed = run_tool(fmt::format("\"{}\" /y \"{}\" \"{}\"", path_pngout.value, pngfile, optfile), "PNGout");
+		if (!outed && !crushed)
+			// Don't treat it as an error if PNGout couldn't create a smaller file than PNGCrush
+			errors += "PNGout failed to create optimized file.\n";
+		outsize = data.size();
+	}
+
+	// Run deflopt
+	if (!path_deflopt.empty() && wxFileExists(path_deflopt))
+	{
+		data.exportFile(pngfile);
+		entryjobs::runProcess(fmt::format("\"{}\" /sf \"{}\"", path_deflopt.value, pngfile));
+		data.importFile(pngfile);
+		fileutil::removeFile(pngfile);
+		deflsize = data.size();
+	}
+
+	// Rewrite special chunks
+	if (alphchunk)
+		gfx::pngSetalPh(data, true);
+	if (grabchunk)
+		gfx::setImageOffsets(data, grabchunk->x, grabchunk->y);
+
+	log::info(
+		"PNG {} size {} =PNGCrush=> {} =PNGout=> {} =DeflOpt=> {} =+grAb/alPh=> {}",
+		name,
+		oldsize,
+		crushsize,
+		outsize,
+		deflsize,
+		data.size());
+
+	return crushed || outed || errors.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the ACC path is set up, otherwise shows an error and opens
+// the ACS preferences
+// -----------------------------------------------------------------------------
+bool accPathValid(wxFrame* parent)
+{
+	wxString accpath = path_acc;
+	if (accpath.IsEmpty() || !wxFileExists(accpath))
+	{
+		wxMessageBox(
+			"Error: ACC path not defined, please configure in SLADE preferences",
+			"Error",
+			wxOK | wxCENTRE | wxICON_ERROR);
+		PreferencesDialog::openPreferences(parent, "ACS");
+		return false;
+	}
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // EntryOperations Namespace Functions
@@ -562,7 +698,9 @@ bool entryoperations::findTextureErrors(const vector<ArchiveEntry*>& entries)
 // Attempts to compile [entry] as an ACS script.
 // If the entry is named SCRIPTS, the compiled data is imported to the BEHAVIOR
 // entry previous to it, otherwise it is imported to a same-name compiled
-// library entry in the acs namespace
+// library entry in the acs namespace.
+// The compiler is run in the background (see acscompiler::compile), returns
+// false if it couldn't be started
 // -----------------------------------------------------------------------------
 bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry* target, wxFrame* parent)
 {
@@ -581,180 +719,75 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 		return false;
 	}
 
-	// Check if the ACC path is set up
-	wxString accpath = path_acc;
-	if (accpath.IsEmpty() || !wxFileExists(accpath))
-	{
-		wxMessageBox(
-			"Error: ACC path not defined, please configure in SLADE preferences",
-			"Error",
-			wxOK | wxCENTRE | wxICON_ERROR);
-		PreferencesDialog::openPreferences(parent, "ACS");
+	if (!accPathValid(parent))
 		return false;
-	}
 
-	// Setup some path strings
-	auto srcfile       = app::path(fmt::format("{}.acs", entry->nameNoExt()), app::Dir::Temp);
-	auto ofile         = app::path(fmt::format("{}.o", entry->nameNoExt()), app::Dir::Temp);
-	auto include_paths = wxSplit(path_acc_libs, ';');
-
-	// Setup command options
-	wxString opt;
-	if (hexen)
-		opt += " -h";
-	if (!include_paths.IsEmpty())
-	{
-		for (const auto& include_path : include_paths)
-			opt += wxString::Format(" -i \"%s\"", include_path);
-	}
+	return acscompiler::compile({ entry }, hexen, target, parent);
+}
 
-	// Find/export any resource libraries
-	Archive::SearchOptions sopt;
-	sopt.match_type       = EntryType::fromId("acs");
-	sopt.search_subdirs   = true;
-	auto          entries = app::archiveManager().findAllResourceEntries(sopt);
-	wxArrayString lib_paths;
-	for (auto& res_entry : entries)
+// -----------------------------------------------------------------------------
+// Compiles all text [entries] as ACS scripts (see compileACS above), running
+// multiple compiles in parallel. Any errors are shown together once all are
+// finished
+// -----------------------------------------------------------------------------
+bool entryoperations::compileACS(const vector<ArchiveEntry*>& entries, bool hexen, wxFrame* parent)
+{
+	// Get valid script entries
+	vector<ArchiveEntry*> scripts;
+	auto                  fmt_text = EntryDataFormat::format("text");
+	for (auto entry : entries)
 	{
-		// Ignore SCRIPTS
-		if (res_entry->upperNameNoExt() == "SCRIPTS")
+		if (!entry->parent())
 			continue;
 
-		// Ignore entries from other archives
-		if (entry->parent() && (entry->parent()->filename(true) != res_entry->parent()->filename(true)))
+		if (!fmt_text->isThisFormat(entry->data()))
+		{
+			log::warning("Not compiling {}: entry does not appear to be text", entry->name());
 			continue;
+		}
 
-		auto path = app::path(fmt::format("{}.acs", res_entry->nameNoExt()), app::Dir::Temp);
-		res_entry->exportFile(path);
-		lib_paths.Add(path);
-		log::info(2, "Exporting ACS library {}", res_entry->name());
+		scripts.push_back(entry);
 	}
 
-	// Export script to file
-	entry->exportFile(srcfile);
-
-	// Execute acc
-	wxString      command = "\"" + path_acc + "\"" + " " + opt + " \"" + srcfile + "\" \"" + ofile + "\"";
-	wxArrayString output;
-	wxArrayString errout;
-	wxGetApp().SetTopWindow(parent);
-	wxExecute(command, output, errout, wxEXEC_SYNC);
-	wxGetApp().SetTopWindow(maineditor::windowWx());
-
-	// Log output
-	log::console("ACS compiler output:");
-	wxString output_log;
-	if (!output.IsEmpty())
+	if (scripts.empty())
 	{
-		const char* title1 = "=== Log: ===\n";
-		log::console(title1);
-		output_log += title1;
-		for (const auto& line : output)
-		{
-			log::console(line);
-			output_log += line;
-		}
+		wxMessageBox("Error: No text entries selected", "Error", wxOK | wxCENTRE | wxICON_ERROR);
+		return false;
 	}
 
-	if (!errout.IsEmpty())
-	{
-		const char* title2 = "\n=== Error log: ===\n";
-		log::console(title2);
-		output_log += title2;
-		for (const auto& line : errout)
-		{
-			log::console(line);
-			output_log += line + "\n";
-		}
-	}
+	if (!accPathValid(parent))
+		return false;
 
-	// Delete source file
-	wxRemoveFile(srcfile);
+	return acscompiler::compile(scripts, hexen, nullptr, parent);
+}
 
-	// Delete library files
-	for (const auto& lib_path : lib_paths)
-		wxRemoveFile(lib_path);
+// -----------------------------------------------------------------------------
+// Compiles all ACS sources in [archive] - any map SCRIPTS lumps and library
+// sources (see acscompiler::isCompilable)
+// -----------------------------------------------------------------------------
+bool entryoperations::compileAllACS(Archive* archive, bool hexen, wxFrame* parent)
+{
+	if (!archive)
+		return false;
 
-	// Check it compiled successfully
-	bool success = wxFileExists(ofile);
-	if (success)
+	// Find all ACS sources
+	Archive::SearchOptions opt;
+	opt.match_type     = EntryType::fromId("acs");
+	opt.search_subdirs = true;
+	vector<ArchiveEntry*> sources;
+	for (auto entry : archive->findAll(opt))
+		if (acscompiler::isCompilable(entry))
+			sources.push_back(entry);
+
+	if (sources.empty())
 	{
-		// If no target entry was given, find one
-		if (!target)
-		{
-			// Check if the script is a map script (BEHAVIOR)
-			if (entry->upperName() == "SCRIPTS")
-			{
-				// Get entry before SCRIPTS
-				auto prev = entry->parent()->entryAt(entry->parent()->entryIndex(entry) - 1);
-
-				// Create a new entry there if it isn't BEHAVIOR
-				if (!prev || prev->upperName() != "BEHAVIOR")
-					prev = entry->parent()->addNewEntry("BEHAVIOR", entry->parent()->entryIndex(entry)).get();
-
-				// Import compiled script
-				prev->importFile(ofile);
-			}
-			else
-			{
-				// Otherwise, treat it as a library
-
-				// See if the compiled library already exists as an entry
-				Archive::SearchOptions opt;
-				opt.match_namespace = "acs";
-				opt.match_name      = entry->nameNoExt();
-				if (entry->parent()->formatDesc().names_extensions)
-				{
-					opt.match_name += ".o";
-					opt.ignore_ext = false;
-				}
-				auto lib = entry->parent()->findLast(opt);
-
-				// If it doesn't exist, create it
-				if (!lib)
-					lib = entry->parent()
-							  ->addEntry(std::make_shared<ArchiveEntry>(fmt::format("{}.o", entry->nameNoExt())), "acs")
-							  .get();
-
-				// Import compiled script
-				lib->importFile(ofile);
-			}
-		}
-		else
-			target->importFile(ofile);
-
-		// Delete compiled script file
-		wxRemoveFile(ofile);
+		wxMessageBox("No ACS sources found in the archive", "Compile All ACS", wxOK | wxCENTRE | wxICON_INFORMATION);
+		return false;
 	}
 
-	if (!success || acc_always_show_output)
-	{
-		wxString errors;
-		if (wxFileExists(app::path("acs.err", app::Dir::Temp)))
-		{
-			// Read acs.err to string
-			wxFile       file(app::path("acs.err", app::Dir::Temp));
-			vector<char> buf(file.Length());
-			file.Read(buf.data(), file.Length());
-			errors = wxString::From8BitData(buf.data(), file.Length());
-		}
-		else
-			errors = output_log;
-
-		if (!errors.empty() || !success)
-		{
-			ExtMessageDialog dlg(nullptr, success ? "ACC Output" : "Error Compiling");
-			dlg.setMessage(
-				success ? "The following errors were encountered while compiling, please fix them and recompile:" :
-                          "Compiler output shown below: ");
-			dlg.setExt(errors);
-			dlg.ShowModal();
-		}
-
-		return success;
-	}
+	log::info("Compiling {} ACS sources", sources.size());
 
-	return true;
+	return compileACS(sources, hexen, parent);
 }
 
 // -----------------------------------------------------------------------------
@@ -788,6 +821,80 @@ bool entryoperations::exportAsPNG(ArchiveEntry* entry, const wxString& filename)
 	return png.exportFile(filename.ToStdString());
 }
 
+// -----------------------------------------------------------------------------
+// Converts each of [entries] to a PNG image and saves it to the file at the
+// same index in [filenames]. Images that can be decoded from their data alone
+// are converted concurrently, see entryjobs::run
+// -----------------------------------------------------------------------------
+entryjobs::Report entryoperations::exportAsPNG(
+	const vector<ArchiveEntry*>& entries,
+	const vector<string>&        filenames)
+{
+	// Get the palette and format hint for each entry here, since looking up
+	// the current palette isn't thread-safe. Anything that can't be decoded
+	// on a worker thread (eg. fonts) is exported the usual way afterwards
+	vector<ArchiveEntry*> decodable;
+	vector<size_t>        indices;
+	vector<Palette*>      palettes;
+	vector<string>        format_hints;
+	for (size_t a = 0; a < entries.size(); a++)
+	{
+		entries[a]->data();
+		if (!entryprefetch::canDecode(*entries[a]))
+			continue;
+
+		decodable.push_back(entries[a]);
+		indices.push_back(a);
+		palettes.push_back(maineditor::currentPalette(entries[a]));
+		format_hints.push_back(entries[a]->type()->extraProps().getOr<string>("image_format", {}));
+	}
+
+	// Export decodable images
+	auto fmt_png = SIFormat::getFormat("png");
+	auto decoded = entryjobs::run(decodable, [&](entryjobs::Job& job) {
+		SImage image;
+		if (!image.open(job.data, 0, format_hints[job.index]))
+		{
+			job.success = false;
+			job.message = "Unable to read image";
+			return;
+		}
+
+		MemChunk png;
+		if (!fmt_png->saveImage(image, png, palettes[job.index]))
+		{
+			job.success = false;
+			job.message = "Unable to convert to PNG";
+			return;
+		}
+
+		if (!png.exportFile(filenames[indices[job.index]]))
+		{
+			job.success = false;
+			job.message = fmt::format("Unable to write file \"{}\"", filenames[indices[job.index]]);
+		}
+	});
+
+	// Collect results in order, exporting anything else
+	entryjobs::Report report;
+	report.results.resize(entries.size());
+	for (size_t a = 0; a < decoded.results.size(); a++)
+		report.results[indices[a]] = std::move(decoded.results[a]);
+	for (size_t a = 0; a < entries.size(); a++)
+	{
+		auto& result = report.results[a];
+		if (result.entry)
+			continue;
+
+		result.entry   = entries[a];
+		result.success = exportAsPNG(entries[a], filenames[a]);
+		if (!result.success)
+			result.message = "Unable to convert to PNG";
+	}
+
+	return report;
+}
+
 // -----------------------------------------------------------------------------
 // Attempts to optimize [entry] using external PNG optimizers.
 // -----------------------------------------------------------------------------
@@ -809,188 +916,20 @@ bool entryoperations::optimizePNG(ArchiveEntry* entry)
 	}
 
 	// Check if the PNG tools path are set up, at least one of them should be
-	wxString pngpathc = path_pngcrush;
-	wxString pngpatho = path_pngout;
-	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
+	if (!pngToolsAvailable())
 	{
 		log::error(1, "PNG tool paths not defined or invalid, no optimization done.");
 		return false;
 	}
 
-	// Save special chunks
-	bool          alphchunk     = gfx::pngGetalPh(entry->data());
-	auto          grabchunk     = gfx::getImageOffsets(entry->data());
-	wxString      errormessages = "";
-	wxArrayString output;
-	wxArrayString errors;
-	size_t        oldsize   = entry->size();
-	size_t        crushsize = 0, outsize = 0, deflsize = 0;
-	bool          crushed = false, outed = false;
-
-	// Run PNGCrush
-	if (!pngpathc.IsEmpty() && wxFileExists(pngpathc))
-	{
-		wxFileName fn(pngpathc);
-		fn.SetExt("opt");
-		wxString pngfile = fn.GetFullPath();
-		fn.SetExt("png");
-		wxString optfile = fn.GetFullPath();
-		entry->exportFile(pngfile.ToStdString());
-
-		wxString command = path_pngcrush + " -brute \"" + pngfile + "\" \"" + optfile + "\"";
-		output.Empty();
-		errors.Empty();
-		wxExecute(command, output, errors, wxEXEC_SYNC);
-
-		if (wxFileExists(optfile))
-		{
-			if (optfile.size() < oldsize)
-			{
-				entry->importFile(optfile.ToStdString());
-				wxRemoveFile(optfile);
-				wxRemoveFile(pngfile);
-			}
-			else
-				errormessages += "PNGCrush failed to reduce file size further.\n";
-			crushed = true;
-		}
-		else
-			errormessages += "PNGCrush failed to create optimized file.\n";
-		crushsize = entry->size();
-
-		// send app output to console if wanted
-		if (false)
-		{
-			wxString crushlog = "";
-			if (errors.GetCount())
-			{
-				crushlog += "PNGCrush error messages:\n";
-				for (size_t i = 0; i < errors.GetCount(); ++i)
-					crushlog += errors[i] + "\n";
-				errormessages += crushlog;
-			}
-			if (output.GetCount())
-			{
-				crushlog += "PNGCrush output messages:\n";
-				for (size_t i = 0; i < output.GetCount(); ++i)
-					crushlog += output[i] + "\n";
-			}
-			log::info(1, crushlog);
-		}
-	}
-
-	// Run PNGOut
-	if (!pngpatho.IsEmpty() && wxFileExists(pngpatho))
-	{
-		wxFileName fn(pngpatho);
-		fn.SetExt("opt");
-		wxString pngfile = fn.GetFullPath();
-		fn.SetExt("png");
-		wxString optfile = fn.GetFullPath();
-		entry->exportFile(pngfile.ToStdString());
-
-		wxString command = path_pngout + " /y \"" + pngfile + "\" \"" + optfile + "\"";
-		output.Empty();
-		errors.Empty();
-		wxExecute(command, output, errors, wxEXEC_SYNC);
-
-		if (wxFileExists(optfile))
-		{
-			if (optfile.size() < oldsize)
-			{
-				entry->importFile(optfile.ToStdString());
-				wxRemoveFile(optfile);
-				wxRemoveFile(pngfile);
-			}
-			else
-				errormessages += "PNGout failed to reduce file size further.\n";
-			outed = true;
-		}
-		else if (!crushed)
-			// Don't treat it as an error if PNGout couldn't create a smaller file than PNGCrush
-			errormessages += "PNGout failed to create optimized file.\n";
-		outsize = entry->size();
-
-		// send app output to console if wanted
-		if (false)
-		{
-			wxString pngoutlog = "";
-			if (errors.GetCount())
-			{
-				pngoutlog += "PNGOut error messages:\n";
-				for (size_t i = 0; i < errors.GetCount(); ++i)
-					pngoutlog += errors[i] + "\n";
-				errormessages += pngoutlog;
-			}
-			if (output.GetCount())
-			{
-				pngoutlog += "PNGOut output messages:\n";
-				for (size_t i = 0; i < output.GetCount(); ++i)
-					pngoutlog += output[i] + "\n";
-			}
-			log::info(1, pngoutlog);
-		}
-	}
+	// Optimize
+	MemChunk data;
+	data.importMem(entry->data());
+	string errormessages;
+	bool   ok = optimizePNGData(data, entry->name(), errormessages);
+	entry->importMemChunk(data);
 
-	// Run deflopt
-	if (!pngpathd.IsEmpty() && wxFileExists(pngpathd))
-	{
-		wxFileName fn(pngpathd);
-		fn.SetExt("png");
-		wxString pngfile = fn.GetFullPath();
-		entry->exportFile(pngfile.ToStdString());
-
-		wxString command = path_deflopt + " /sf \"" + pngfile + "\"";
-		output.Empty();
-		errors.Empty();
-		wxExecute(command, output, errors, wxEXEC_SYNC);
-
-		entry->importFile(pngfile.ToStdString());
-		wxRemoveFile(pngfile);
-		deflsize = entry->size();
-
-		// send app output to console if wanted
-		if (false)
-		{
-			wxString defloptlog = "";
-			if (errors.GetCount())
-			{
-				defloptlog += "DeflOpt error messages:\n";
-				for (size_t i = 0; i < errors.GetCount(); ++i)
-					defloptlog += errors[i] + "\n";
-				errormessages += defloptlog;
-			}
-			if (output.GetCount())
-			{
-				defloptlog += "DeflOpt output messages:\n";
-				for (size_t i = 0; i < output.GetCount(); ++i)
-					defloptlog += output[i] + "\n";
-			}
-			log::info(1, defloptlog);
-		}
-	}
-	output.Clear();
-	errors.Clear();
-
-	// Rewrite special chunks
-	if (alphchunk)
-		gfx::pngSetalPh(entry->data(), true);
-	if (grabchunk)
-		gfx::setImageOffsets(entry->data(), grabchunk->x, grabchunk->y);
-
-	log::info(
-		"PNG {} size {} =PNGCrush=> {} =PNGout=> {} =DeflOpt=> {} =+grAb/alPh=> {}",
-		entry->name(),
-		oldsize,
-		crushsize,
-		outsize,
-		deflsize,
-		entry->size());
-
-
-	if (!crushed && !outed && !errormessages.IsEmpty())
+	if (!ok)
 	{
 		ExtMessageDialog dlg(nullptr, "Optimizing Report");
 		dlg.setMessage("The following issues were encountered while optimizing:");
@@ -1003,6 +942,42 @@ bool entryoperations::optimizePNG(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Attempts to optimize all PNG [entries] using external PNG optimizers.
+// Entries are optimized concurrently, with at most max_external_processes
+// running at once
+// -----------------------------------------------------------------------------
+entryjobs::Report entryoperations::optimizePNG(const vector<ArchiveEntry*>& entries)
+{
+	// Check if the PNG tools path are set up, at least one of them should be
+	if (!pngToolsAvailable())
+	{
+		entryjobs::Report report;
+		for (auto entry : entries)
+			report.results.push_back({ entry, false, "PNG tool paths not defined or invalid" });
+		return report;
+	}
+
+	auto fmt_png = EntryDataFormat::format("img_png");
+	return entryjobs::run(
+		entries,
+		[fmt_png](entryjobs::Job& job) {
+			if (!fmt_png->isThisFormat(job.data))
+			{
+				job.success = false;
+				job.message = "Entry does not appear to be PNG";
+				return;
+			}
+
+			MemChunk original;
+			original.importMem(job.data);
+			job.success  = optimizePNGData(job.data, job.entry->name(), job.message);
+			job.modified = !job.data.sharesData(original);
+		},
+		max_external_processes > 0 ? static_cast<unsigned>(max_external_processes) : 0,
+		true);
+}
+
 // -----------------------------------------------------------------------------
 // Converts ANIMATED data in [entry] to ANIMDEFS format, written to [animdata]
 // -----------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/ArchiveEntry.h"
+#include "General/EntryJobs.h"
 #include "Graphics/SImage/SIFormat.h"
 
 class wxFrame;
@@ -18,9 +19,15 @@ namespace entryoperations
 	bool convertTextures(const vector<ArchiveEntry*>& entries);
 	bool findTextureErrors(const vector<ArchiveEntry*>& entries);
 	bool compileACS(ArchiveEntry* entry, bool hexen = false, ArchiveEntry* target = nullptr, wxFrame* parent = nullptr);
+	bool compileACS(const vector<ArchiveEntry*>& entries, bool hexen = false, wxFrame* parent = nullptr);
+	bool compileAllACS(Archive* archive, bool hexen = false, wxFrame* parent = nullptr);
 	bool exportAsPNG(ArchiveEntry* entry, const wxString& filename);
 	bool optimizePNG(ArchiveEntry* entry);
 
+	// Batch operations (run concurrently, see entryjobs::run)
+	entryjobs::Report exportAsPNG(const vector<ArchiveEntry*>& entries, const vector<string>& filenames);
+	entryjobs::Report optimizePNG(const vector<ArchiveEntry*>& entries);
+
 	// ANIMATED/SWITCHES
 	bool convertAnimated(ArchiveEntry* entry, MemChunk* animdata, bool animdefs);
 	bool convertSwitches(ArchiveEntry* entry, MemChunk* animdata, bool animdefs);
@@ -39,6 +39,7 @@
 #include "Conversions.h"
 #include "General/Executables.h"
 #include "General/Misc.h"
+#include "General/ThreadPool.h"
 #include "Graphics/Graphics.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
@@ -73,9 +74,36 @@ public:
 	virtual ~ExternalEditFileMonitor() { manager_->monitorStopped(this); }
 
 	ArchiveEntry* getEntry() const { return entry_; }
-	void          fileModified() override { updateEntry(); }
 
-	virtual void updateEntry() { entry_->importFile(filename_); }
+	// Reads the modified file and converts it back to the entry's format on a
+	// worker thread, then imports the result to the entry on the main thread
+	void fileModified() override
+	{
+		auto entry   = weak_ptr<ArchiveEntry>(entry_->getShared());
+		auto convert = importConverter();
+		auto id      = ++*last_update_;
+		threadpool::enqueue([entry, filename = filename_, convert, id, last_update = last_update_]() {
+			auto data = std::make_shared<MemChunk>();
+			if (!data->importFile(filename))
+				return;
+			if (convert && !convert(*data))
+				return;
+
+			wxTheApp->CallAfter([entry, data, id, last_update]() {
+				// Ignore if the file was modified again since
+				if (*last_update != id)
+					return;
+
+				if (auto e = entry.lock())
+					e->importMemChunk(*data);
+			});
+		});
+	}
+
+	// Returns a function to convert the exported file's data back to the entry's
+	// format, or an empty function if it can be imported as-is. The function is
+	// run on a worker thread, so it must not reference the monitor
+	virtual std::function<bool(MemChunk&)> importConverter() const { return {}; }
 
 	virtual bool exportEntry()
 	{
@@ -87,9 +115,8 @@ public:
 		bool ok = entry_->exportFile(fn.fullPath());
 		if (ok)
 		{
-			filename_      = fn.fullPath();
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			filename_ = fn.fullPath();
+			startMonitoring();
 		}
 		else
 			global::error = "Failed to export entry";
@@ -103,6 +130,7 @@ protected:
 	ExternalEditManager*       manager_ = nullptr;
 	string                     gfx_format_;
 	sigslot::scoped_connection sc_entry_removed_;
+	shared_ptr<unsigned>       last_update_ = std::make_shared<unsigned>(0); // Id of the most recent update
 };
 
 
@@ -119,33 +147,30 @@ public:
 	}
 	virtual ~GfxExternalFileMonitor() = default;
 
-	void updateEntry() override
+	std::function<bool(MemChunk&)> importConverter() const override
 	{
-		// Read file
-		MemChunk data;
-		data.importFile(filename_);
+		return [gfx_format = gfx_format_, offsets = offsets_, palette = palette_](MemChunk& data) mutable {
+			// Read image
+			SImage image;
+			image.open(data, 0, "png");
+			image.convertPaletted(&palette);
 
-		// Read image
-		SImage image;
-		image.open(data, 0, "png");
-		image.convertPaletted(&palette_);
+			// Convert image to entry gfx format
+			auto format = SIFormat::getFormat(gfx_format);
+			if (!format)
+				return false;
 
-		// Convert image to entry gfx format
-		auto format = SIFormat::getFormat(gfx_format_);
-		if (format)
-		{
 			MemChunk conv_data;
-			if (format->saveImage(image, conv_data, &palette_))
-			{
-				// Update entry data
-				entry_->importMemChunk(conv_data);
-				gfx::setImageOffsets(entry_->data(), offsets_.x, offsets_.y);
-			}
-			else
+			if (!format->saveImage(image, conv_data, &palette))
 			{
 				log::error("Unable to convert external png to {}", format->name());
+				return false;
 			}
-		}
+
+			gfx::setImageOffsets(conv_data, offsets.x, offsets.y);
+			data.importMem(conv_data);
+			return true;
+		};
 	}
 
 	bool exportEntry() override
@@ -180,8 +205,7 @@ public:
 		filename_ = fn.fullPath();
 		if (png.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -208,12 +232,6 @@ public:
 	}
 	virtual ~MIDIExternalFileMonitor() = default;
 
-	void updateEntry() override
-	{
-		// Can't convert back, just import the MIDI
-		entry_->importFile(filename_);
-	}
-
 	bool exportEntry() override
 	{
 		strutil::Path fn(app::path(entry_->name(), app::Dir::Temp));
@@ -246,8 +264,7 @@ public:
 		filename_ = fn.fullPath();
 		if (convdata.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -277,24 +294,19 @@ public:
 	}
 	virtual ~SfxExternalFileMonitor() = default;
 
-	void updateEntry() override
+	std::function<bool(MemChunk&)> importConverter() const override
 	{
-		// Convert back to doom sound if it was originally
-		if (doom_sound_)
-		{
-			MemChunk in, out;
-			in.importFile(filename_);
-			if (conversion::wavToDoomSnd(in, out))
-			{
-				// Import converted data to entry if successful
-				entry_->importMemChunk(out);
-				return;
-			}
-		}
-
-		// Just import wav to entry if conversion to doom sound
-		// failed or the entry was not a convertable type
-		entry_->importFile(filename_);
+		if (!doom_sound_)
+			return {};
+
+		return [](MemChunk& data) {
+			// Convert back to doom sound if it was originally, otherwise (or if
+			// conversion fails) just import the wav
+			MemChunk out;
+			if (conversion::wavToDoomSnd(data, out))
+				data.importMem(out);
+			return true;
+		};
 	}
 
 	bool exportEntry() override
@@ -343,8 +355,7 @@ public:
 		filename_ = fn.fullPath();
 		if (convdata.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -33,6 +33,9 @@
 #include "MainEditor.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "General/Misc.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/Palette/PaletteManager.h"
 #include "MapEditor/MapEditor.h"
 #include "MapEditor/UI/MapEditorWindow.h"
 #include "UI/ArchiveManagerPanel.h"
@@ -53,6 +56,10 @@ namespace slade::maineditor
 {
 MainWindow* main_window = nullptr;
 }
+namespace
+{
+Palette headless_palette; // Archive palette when there is no main window (batch mode)
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -153,10 +160,19 @@ void maineditor::setGlobalPaletteFromArchive(Archive* archive)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the currently selected palette
+// Returns the currently selected palette, or the palette from [entry]'s archive
+// if the main window isn't open
 // -----------------------------------------------------------------------------
 Palette* maineditor::currentPalette(ArchiveEntry* entry)
 {
+	if (!main_window)
+	{
+		headless_palette.copyPalette(app::paletteManager()->globalPalette());
+		if (entry)
+			misc::loadPaletteFromArchive(&headless_palette, entry->parent(), misc::detectPaletteHack(entry));
+		return &headless_palette;
+	}
+
 	return main_window->paletteChooser()->selectedPalette(entry);
 }
 
@@ -38,6 +38,7 @@
 #include "Archive/Formats/DirArchive.h"
 #include "ArchivePanel.h"
 #include "EntryPanel/EntryPanel.h"
+#include "General/Jobs.h"
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "MainEditor/MainEditor.h"
@@ -64,6 +65,11 @@ CVAR(Bool, close_archive_with_tab, true, CVar::Flag::Save)
 CVAR(Int, am_current_tab, 0, CVar::Flag::Save)
 CVAR(Bool, am_file_browser_tab, false, CVar::Flag::Save)
 CVAR(Int, dir_archive_change_action, 2, CVar::Flag::Save) // 0=always ignore, 1=always apply, 2+=ask
+namespace
+{
+constexpr int dir_changes_delay     = 500;  // Wait this long (ms) after the last file system change before processing
+constexpr int data_budget_interval = 5000; // Check loaded entry data against the memory budget this often (ms)
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -116,9 +122,9 @@ void DirArchiveCheck::addChange(DirEntryChange change)
 }
 
 // -----------------------------------------------------------------------------
-// DirArchiveCheck thread entry function
+// Checks the directory for changes, and sends them to the handler when done
 // -----------------------------------------------------------------------------
-wxThread::ExitCode DirArchiveCheck::Entry()
+void DirArchiveCheck::run()
 {
 	// Get current directory structure
 	vector<string>      files, dirs;
@@ -205,8 +211,6 @@ wxThread::ExitCode DirArchiveCheck::Entry()
 	auto event = new wxThreadEvent(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED);
 	event->SetPayload<DirArchiveChangeList>(change_list_);
 	wxQueueEvent(handler_, event);
-
-	return nullptr;
 }
 
 
@@ -328,6 +332,23 @@ ArchiveManagerPanel::ArchiveManagerPanel(wxWindow* parent, STabCtrl* nb_archives
 	stc_tabs_->Bind(
 		wxEVT_AUINOTEBOOK_PAGE_CHANGED, [&](wxAuiNotebookEvent&) { am_current_tab = stc_tabs_->GetSelection(); });
 	Bind(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED, &ArchiveManagerPanel::onDirArchiveCheckCompleted, this);
+	Bind(wxEVT_FSWATCHER, &ArchiveManagerPanel::onFileSystemChanged, this);
+	timer_dir_changes_.SetOwner(this);
+	Bind(
+		wxEVT_TIMER,
+		[&](wxTimerEvent&) { applyWatchedDirChanges(maineditor::windowWx()->IsActive()); },
+		timer_dir_changes_.GetId());
+	timer_data_budget_.SetOwner(this);
+	Bind(
+		wxEVT_TIMER,
+		[&](wxTimerEvent&) {
+			// Entry data may be in use by whatever is yielding, so wait until it's done
+			auto loop = wxEventLoopBase::GetActive();
+			if (!loop || !loop->IsYielding())
+				app::archiveManager().enforceDataBudget();
+		},
+		timer_data_budget_.GetId());
+	timer_data_budget_.Start(data_budget_interval);
 
 	connectSignals();
 
@@ -1106,16 +1127,66 @@ void ArchiveManagerPanel::openFile(const wxString& filename) const
 }
 
 // -----------------------------------------------------------------------------
-// Opens each file in a supplied array of filenames
+// Opens each file in a supplied array of filenames.
+// Multiple files are opened at the same time in the background
 // -----------------------------------------------------------------------------
-void ArchiveManagerPanel::openFiles(wxArrayString& files) const
+void ArchiveManagerPanel::openFiles(wxArrayString& files)
 {
+	if (files.size() == 1)
+	{
+		openFile(files[0]);
+		return;
+	}
+
 	// Go through each filename in the array
 	for (const auto& file : files)
 	{
-		// Open the archive
-		openFile(file);
+		// Start opening the archive
+		auto task = app::archiveManager().openArchiveAsync(file.ToStdString());
+		if (!VECTOR_EXISTS(opening_files_, task))
+			opening_files_.push_back(task);
 	}
+
+	ui::showSplash(fmt::format("Opening {} Archives...", opening_files_.size()), true);
+	updateOpeningFilesProgress();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the splash window with the overall progress of files being opened in
+// the background, and shows any errors once they have all finished
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::updateOpeningFilesProgress()
+{
+	if (opening_files_.empty())
+		return;
+
+	float    progress = 0.0f;
+	unsigned finished = 0;
+	for (const auto& task : opening_files_)
+	{
+		if (task->isFinished())
+			finished++;
+		progress += task->isFinished() ? 1.0f : task->progress();
+	}
+
+	// Still opening, update progress
+	if (finished < opening_files_.size())
+	{
+		ui::setSplashProgressMessage(fmt::format("{} of {} opened", finished, opening_files_.size()));
+		ui::setSplashProgress(progress / opening_files_.size());
+		return;
+	}
+
+	// All finished, show any errors
+	ui::hideSplash();
+	wxString errors;
+	for (const auto& task : opening_files_)
+		if (task->status() == ArchiveOpenTask::Status::Failed)
+			errors += wxString::Format("%s:\n%s\n\n", task->filename(), task->error());
+	opening_files_.clear();
+
+	if (!errors.empty())
+		wxMessageBox(wxString::Format("Error opening:\n\n%s", errors.Trim()), "Error", wxICON_ERROR);
 }
 
 // -----------------------------------------------------------------------------
@@ -1282,8 +1353,10 @@ void ArchiveManagerPanel::saveAll() const
 }
 
 // -----------------------------------------------------------------------------
-// Checks all open directory archives for changes on the file system in
-// background threads
+// Checks all open directory archives for changes on the file system.
+// Archives watched for file system notifications only process the changes
+// reported since the last check, others are fully rescanned in background
+// threads
 // -----------------------------------------------------------------------------
 void ArchiveManagerPanel::checkDirArchives()
 {
@@ -1299,12 +1372,142 @@ void ArchiveManagerPanel::checkDirArchives()
 		if (VECTOR_EXISTS(checking_archives_, archive.get()))
 			continue;
 
+		// Already watched, changes are applied below
+		if (watched_dir_changes_.find(archive.get()) != watched_dir_changes_.end())
+			continue;
+
+		// If the archive wasn't able to be watched when it was opened (eg. it
+		// was opened before the event loop started), try again now but still
+		// do a full check in case anything was missed
+		watchDirArchive(archive.get());
+
 		log::info(2, "Checking {} for external changes...", archive->filename());
 		checking_archives_.push_back(archive.get());
-		auto check = new DirArchiveCheck(this, dynamic_cast<DirArchive*>(archive.get()));
-		check->Create();
-		check->Run();
+		auto check = std::make_shared<DirArchiveCheck>(this, dynamic_cast<DirArchive*>(archive.get()));
+		jobs::run([check](jobs::Job&) { check->run(); }, {}, jobs::Priority::Background);
+	}
+
+	applyWatchedDirChanges(true);
+}
+
+// -----------------------------------------------------------------------------
+// Starts watching the directory of (folder) [archive] for file system
+// notifications. Returns false if watching isn't possible, in which case
+// changes need to be checked for by a full rescan (DirArchiveCheck)
+// -----------------------------------------------------------------------------
+bool ArchiveManagerPanel::watchDirArchive(Archive* archive)
+{
+	if (!archive || archive->formatId() != "folder")
+		return false;
+	if (watched_dir_changes_.find(archive) != watched_dir_changes_.end())
+		return true;
+
+	// The watcher can only be created once the event loop is running
+	if (!wxEventLoopBase::GetActive())
+		return false;
+
+	if (!fs_watcher_)
+	{
+		fs_watcher_ = std::make_unique<wxFileSystemWatcher>();
+		fs_watcher_->SetOwner(this);
+	}
+
+	if (!fs_watcher_->AddTree(
+			wxFileName::DirName(archive->filename()),
+			wxFSW_EVENT_CREATE | wxFSW_EVENT_DELETE | wxFSW_EVENT_RENAME | wxFSW_EVENT_MODIFY))
+	{
+		log::warning("Unable to watch {} for changes, it will be rescanned instead", archive->filename());
+		return false;
 	}
+
+	watched_dir_changes_[archive];
+	log::info(2, "Watching {} for external changes", archive->filename());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Stops watching the directory of [archive] for file system notifications
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::unwatchDirArchive(Archive* archive)
+{
+	if (watched_dir_changes_.erase(archive) > 0 && fs_watcher_)
+		fs_watcher_->RemoveTree(wxFileName::DirName(archive->filename()));
+}
+
+// -----------------------------------------------------------------------------
+// Processes the paths reported as changed in watched directory archives since
+// they were last processed.
+// If [allow_prompt] is false and changes need to be confirmed by the user,
+// they are kept until the next call (eg. the app regaining focus)
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::applyWatchedDirChanges(bool allow_prompt)
+{
+	if (checked_dir_archive_changes_)
+		return;
+
+	// Don't process anything while yielding (eg. in the middle of saving)
+	auto loop = wxEventLoopBase::GetActive();
+	if (loop && loop->IsYielding())
+	{
+		timer_dir_changes_.StartOnce(dir_changes_delay);
+		return;
+	}
+
+	// Get changed paths, leaving them pending if they can't be applied yet
+	vector<std::pair<Archive*, vector<string>>> changed;
+	for (auto& [archive, paths] : watched_dir_changes_)
+	{
+		if (paths.empty() || VECTOR_EXISTS(checking_archives_, archive))
+			continue;
+		if (dir_archive_change_action == 0)
+			paths.clear();
+		else if (dir_archive_change_action == 1 || allow_prompt)
+		{
+			changed.emplace_back(archive, std::move(paths));
+			paths.clear();
+		}
+	}
+
+	// Apply changes (the list of watched archives can change while a dialog is
+	// open, so check each archive is still open first)
+	for (auto& [archive, paths] : changed)
+	{
+		if (app::archiveManager().archiveIndex(archive) < 0)
+			continue;
+
+		auto dir_archive = dynamic_cast<DirArchive*>(archive);
+		auto changes     = dir_archive->changedEntries(paths);
+		handleDirArchiveChanges(dir_archive, changes);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Applies [changes] to [archive], or shows a dialog to select the changes to
+// apply, depending on the dir_archive_change_action cvar
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::handleDirArchiveChanges(DirArchive* archive, vector<DirEntryChange>& changes)
+{
+	if (changes.empty())
+	{
+		log::info(2, "No changes");
+		return;
+	}
+
+	checked_dir_archive_changes_ = true;
+
+	// Auto apply if option set
+	if (dir_archive_change_action == 1)
+		archive->updateChangedEntries(changes);
+
+	// Otherwise show change/update dialog
+	else
+	{
+		DirArchiveUpdateDialog dlg(maineditor::windowWx(), archive, changes);
+		dlg.ShowModal();
+	}
+
+	checked_dir_archive_changes_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -2245,6 +2448,34 @@ void ArchiveManagerPanel::onArchiveTabClosed(wxAuiNotebookEvent& e)
 	e.Skip();
 }
 
+// -----------------------------------------------------------------------------
+// Called when a file or directory in a watched directory archive is changed.
+// Records the changed path(s), which are processed after no more changes have
+// been reported for a short time
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::onFileSystemChanged(wxFileSystemWatcherEvent& e)
+{
+	if (e.IsError())
+	{
+		log::warning("File system watcher error: {}", e.GetErrorDescription().ToStdString());
+		return;
+	}
+
+	vector<string> paths{ e.GetPath().GetFullPath().ToStdString() };
+	if (e.GetChangeType() == wxFSW_EVENT_RENAME)
+		paths.push_back(e.GetNewPath().GetFullPath().ToStdString());
+
+	for (auto& path : paths)
+	{
+		strutil::removeSuffixIP(path, wxFileName::GetPathSeparator());
+		for (auto& [archive, changed_paths] : watched_dir_changes_)
+			if (strutil::startsWith(path, archive->filename()))
+				changed_paths.push_back(path);
+	}
+
+	timer_dir_changes_.StartOnce(dir_changes_delay);
+}
+
 // -----------------------------------------------------------------------------
 // Called when a directory archive check thread finishes work.
 // Pops up a dialog to apply any changes found (if any)
@@ -2257,28 +2488,7 @@ void ArchiveManagerPanel::onDirArchiveCheckCompleted(wxThreadEvent& e)
 	if (app::archiveManager().archiveIndex(change_list.archive) >= 0)
 	{
 		log::info(2, wxString::Format("Finished checking %s for external changes", change_list.archive->filename()));
-
-		if (!change_list.changes.empty())
-		{
-			checked_dir_archive_changes_ = true;
-
-			auto archive = dynamic_cast<DirArchive*>(change_list.archive);
-
-			// Auto apply if option set
-			if (dir_archive_change_action == 1)
-				archive->updateChangedEntries(change_list.changes);
-
-			// Otherwise show change/update dialog
-			else
-			{
-				DirArchiveUpdateDialog dlg(maineditor::windowWx(), archive, change_list.changes);
-				dlg.ShowModal();
-			}
-
-			checked_dir_archive_changes_ = false;
-		}
-		else
-			log::info(2, "No changes");
+		handleDirArchiveChanges(dynamic_cast<DirArchive*>(change_list.archive), change_list.changes);
 	}
 
 	VECTOR_REMOVE(checking_archives_, change_list.archive);
@@ -2292,6 +2502,7 @@ void ArchiveManagerPanel::connectSignals()
 	signal_connections += signals.archive_added.connect([this](unsigned index) {
 		list_archives_->addItem(index, wxEmptyString);
 		updateOpenListItem(index);
+		watchDirArchive(app::archiveManager().getArchive(index).get());
 	});
 	signal_connections += signals.archive_closed.connect([this](unsigned index) { list_archives_->DeleteItem(index); });
 	signal_connections += signals.archive_saved.connect([this](unsigned index) {
@@ -2305,6 +2516,7 @@ void ArchiveManagerPanel::connectSignals()
 
 	// When an archive is being closed, close any related tabs
 	signal_connections += signals.archive_closing.connect([this](unsigned index) {
+		unwatchDirArchive(app::archiveManager().getArchive(index).get());
 		closeTextureTab(index);
 		closeEntryTabs(app::archiveManager().getArchive(index).get());
 		closeTab(index);
@@ -2313,6 +2525,12 @@ void ArchiveManagerPanel::connectSignals()
 	// When an archive is opened, open its tab
 	signal_connections += signals.archive_opened.connect([this](int index) { openTab(index); });
 
+	// Update progress of files being opened in the background
+	signal_connections += signals.archive_open_progress.connect(
+		[this](const ArchiveOpenTask&) { updateOpeningFilesProgress(); });
+	signal_connections += signals.archive_open_finished.connect(
+		[this](const ArchiveOpenTask&) { updateOpeningFilesProgress(); });
+
 	// Refresh recent files list when changed
 	signal_connections += signals.recent_files_changed.connect([this]() { refreshRecentFileList(); });
 
@@ -5,6 +5,7 @@
 #include "General/Sigslot.h"
 #include "UI/Controls/DockPanel.h"
 #include "UI/Lists/ListView.h"
+#include <wx/fswatcher.h>
 
 wxDECLARE_EVENT(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED, wxThreadEvent);
 
@@ -13,6 +14,7 @@ namespace slade
 class ArchiveManagerPanel;
 class ArchivePanel;
 class Archive;
+class ArchiveOpenTask;
 class STabCtrl;
 class TextureXEditor;
 class EntryPanel;
@@ -23,13 +25,16 @@ struct DirArchiveChangeList
 	vector<DirEntryChange> changes;
 };
 
-class DirArchiveCheck : public wxThread
+// Checks a directory archive for external changes to its files. Set up on the
+// UI thread and run as a background job, sending the changes found to
+// [handler] in a wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED event
+class DirArchiveCheck
 {
 public:
 	DirArchiveCheck(wxEvtHandler* handler, DirArchive* archive);
-	virtual ~DirArchiveCheck() = default;
+	~DirArchiveCheck() = default;
 
-	ExitCode Entry() override;
+	void run();
 
 private:
 	struct EntryInfo
@@ -116,7 +121,7 @@ public:
 	void            closeEntryTab(ArchiveEntry* entry) const;
 	void            closeEntryTabs(Archive* parent) const;
 	void            openFile(const wxString& filename) const;
-	void            openFiles(wxArrayString& files) const;
+	void            openFiles(wxArrayString& files);
 	void            openDirAsArchive(const wxString& dir) const;
 	bool            redirectToTab(ArchiveEntry* entry) const;
 	bool            entryIsOpenInTab(ArchiveEntry* entry) const;
@@ -166,6 +171,7 @@ public:
 	void onArchiveTabClose(wxAuiNotebookEvent& e);
 	void onArchiveTabClosed(wxAuiNotebookEvent& e);
 	void onDirArchiveCheckCompleted(wxThreadEvent& e);
+	void onFileSystemChanged(wxFileSystemWatcherEvent& e);
 
 private:
 	STabCtrl*        stc_tabs_                    = nullptr;
@@ -185,9 +191,25 @@ private:
 	bool             checked_dir_archive_changes_ = false;
 	vector<Archive*> checking_archives_;
 
+	// Directory archive file system watching
+	unique_ptr<wxFileSystemWatcher>    fs_watcher_;
+	std::map<Archive*, vector<string>> watched_dir_changes_;
+	wxTimer                            timer_dir_changes_;
+
+	// Files being opened in the background
+	vector<shared_ptr<ArchiveOpenTask>> opening_files_;
+
+	// Periodically unloads entry data to stay within the memory budget
+	wxTimer timer_data_budget_;
+
 	// Signal connections
 	ScopedConnectionList signal_connections;
 
 	void connectSignals();
+	bool watchDirArchive(Archive* archive);
+	void unwatchDirArchive(Archive* archive);
+	void applyWatchedDirChanges(bool allow_prompt);
+	void handleDirArchiveChanges(DirArchive* archive, vector<DirEntryChange>& changes);
+	void updateOpeningFilesProgress();
 };
 } // namespace slade
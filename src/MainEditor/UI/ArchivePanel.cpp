@@ -48,9 +48,11 @@
 #include "EntryPanel/TextEntryPanel.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
+#include "General/EntryPrefetch.h"
 #include "General/Executables.h"
 #include "General/KeyBind.h"
 #include "General/Misc.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
@@ -64,6 +66,7 @@
 #include "Scripting/ScriptManager.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "UI/Controls/SIconButton.h"
+#include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/Dialogs/GfxColouriseDialog.h"
 #include "UI/Dialogs/GfxConvDialog.h"
 #include "UI/Dialogs/GfxTintDialog.h"
@@ -160,17 +163,18 @@ public:
 
 		// Import all dragged files, inserting after the item they were dragged onto
 		list_->Freeze();
-		for (int a = filenames.size() - 1; a >= 0; a--)
+		vector<string> new_files;
+		for (const auto& filename : filenames)
 		{
 			// Is this a directory?
-			if (wxDirExists(filenames[a]))
+			if (wxDirExists(filename))
 			{
 				// TODO: Handle folders with recursively importing all content
 				// and converting to namespaces if dropping in a treeless archive.
 			}
 			else
 			{
-				strutil::Path fn(filenames[a].ToStdString());
+				strutil::Path fn(filename.ToStdString());
 				ArchiveEntry* entry = nullptr;
 
 				// Find entry to replace if needed
@@ -197,15 +201,20 @@ public:
 					}
 				}
 
-				// Create new entry if needed
-				if (entry == nullptr)
-					entry = archive->addNewEntry(fn.fileName(), index, dir).get();
-
-				// Import the file to it
-				entry->importFile(filenames[a].ToStdString());
-				EntryType::detectEntryType(*entry);
+				// Import the file to the existing entry, or queue it to be
+				// imported as a new entry
+				if (entry)
+				{
+					entry->importFile(filename.ToStdString());
+					EntryType::detectEntryType(*entry);
+				}
+				else
+					new_files.push_back(filename.ToStdString());
 			}
 		}
+
+		// Import new entries (read in parallel and added in a single pass)
+		archive->importFiles(new_files, index < 0 ? 0xFFFFFFFF : index, dir);
 		list_->Thaw();
 
 		return true;
@@ -275,7 +284,8 @@ public:
 	EntryTreeClipboardItem(vector<ArchiveEntry*>& entries, vector<ArchiveDir*>& dirs) :
 		ClipboardItem(Type::EntryTree), tree_{ new ArchiveDir("") }
 	{
-		// Copy entries
+		// Copy entries (data mapped from the source archive file is copied,
+		// so the clipboard never keeps the file mapped)
 		for (auto& entry : entries)
 			tree_->addEntry(std::make_shared<ArchiveEntry>(*entry));
 
@@ -924,33 +934,11 @@ bool ArchivePanel::importFiles()
 		// Begin recording undo level
 		undo_manager_->beginRecord("Import Files");
 
-		// Go through the list of files
-		bool ok = false;
+		// Import all files (read in parallel and added in a single pass)
 		entry_tree_->Freeze();
-		ui::showSplash("Importing Files...", true);
-		for (size_t a = 0; a < info.filenames.size(); a++)
-		{
-			// Get filename
-			wxString name = wxFileName(info.filenames[a]).GetFullName();
-
-			// Update splash window
-			ui::setSplashProgress(float(a) / float(info.filenames.size()));
-			ui::setSplashProgressMessage(name.ToStdString());
-
-			// Add the entry to the archive
-			auto new_entry = archive->addNewEntry(name.ToStdString(), index, dir);
-
-			// If the entry was created ok, load the file into it
-			if (new_entry)
-			{
-				new_entry->importFile(info.filenames[a]); // Import file to entry
-				EntryType::detectEntryType(*new_entry);   // Detect entry type
-				ok = true;
-			}
-
-			if (index > 0)
-				index++;
-		}
+		ui::showSplash(fmt::format("Importing {} Files...", info.filenames.size()));
+		const auto new_entries = archive->importFiles(info.filenames, index < 0 ? 0xFFFFFFFF : index, dir);
+		const bool ok          = !new_entries.empty();
 		ui::hideSplash();
 		entry_tree_->Thaw();
 
@@ -2069,28 +2057,31 @@ bool ArchivePanel::gfxConvert() const
 	// Show splash window
 	ui::showSplash("Writing converted image data...", true);
 
+	// Encode converted images on the thread pool (each item has its own image
+	// and palette, so they can be written independently)
+	vector<MemChunk> converted(selection.size());
+	vector<uint8_t>  saved(selection.size(), 0);
+	threadpool::parallelFor(selection.size(), [&](size_t a) {
+		if (gcd.itemModified(a))
+			saved[a] = gcd.itemFormat(a)->saveImage(*gcd.itemImage(a), converted[a], gcd.itemPalette(a));
+	});
+
 	// Begin recording undo level
 	undo_manager_->beginRecord("Gfx Format Conversion");
 
-	// Write any changes
+	// Write any changes (in order, on the main thread)
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
 		// Update splash window
 		ui::setSplashProgressMessage(selection[a]->name());
 		ui::setSplashProgress((float)a / (float)selection.size());
 
-		// Skip if the image wasn't converted
-		if (!gcd.itemModified(a))
+		// Skip if the image wasn't converted or couldn't be written
+		if (!saved[a])
 			continue;
 
-		// Get image and conversion info
-		auto image  = gcd.itemImage(a);
-		auto format = gcd.itemFormat(a);
-
 		// Write converted image back to entry
-		MemChunk mc;
-		format->saveImage(*image, mc, gcd.itemPalette(a));
-		selection[a]->importMemChunk(mc);
+		selection[a]->importMemChunk(converted[a]);
 		EntryType::detectEntryType(*selection[a]);
 		selection[a]->setExtensionByType();
 	}
@@ -2336,17 +2327,20 @@ bool ArchivePanel::gfxExportPNG()
 		if (filedialog::saveFiles(
 				info, "Export Entries as PNG (Filename will be ignored)", "PNG Files (*.png)|*.png", this))
 		{
-			// Go through the selection
+			// Setup entry filenames
+			vector<string> filenames;
 			for (auto& entry : selection)
 			{
-				// Setup entry filename
 				wxFileName fn(entry->name());
 				fn.SetPath(info.path);
 				fn.SetExt("png");
-
-				// Do export
-				entryoperations::exportAsPNG(entry, fn.GetFullPath());
+				filenames.push_back(fn.GetFullPath().ToStdString());
 			}
+
+			// Do export
+			ui::showSplash("Exporting entries as PNG...", true);
+			entryoperations::exportAsPNG(selection, filenames).logSummary("Export as PNG");
+			ui::hideSplash();
 		}
 	}
 
@@ -2749,17 +2743,8 @@ bool ArchivePanel::musMidiConvert() const
 // -----------------------------------------------------------------------------
 bool ArchivePanel::compileACS(bool hexen) const
 {
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
-
-	// Go through selection
-	for (unsigned a = 0; a < selection.size(); a++)
-	{
-		// Compile ACS script
-		entryoperations::compileACS(selection[a], hexen, nullptr, theMainWindow);
-	}
-
-	return true;
+	// Compile selected entries (in parallel)
+	return entryoperations::compileACS(entry_tree_->selectedEntries(), hexen, theMainWindow);
 }
 
 // -----------------------------------------------------------------------------
@@ -2781,30 +2766,36 @@ bool ArchivePanel::optimizePNG() const
 		return false;
 	}
 
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
+	// Get selected PNG entries
+	vector<ArchiveEntry*> entries;
+	for (auto entry : entry_tree_->selectedEntries())
+		if (entry->type()->formatId() == "img_png")
+			entries.push_back(entry);
 
 	ui::showSplash("Running external programs, please wait...", true);
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Optimize PNG");
+	for (auto entry : entries)
+		undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(entry));
 
-	// Go through selection
-	for (unsigned a = 0; a < selection.size(); a++)
-	{
-		ui::setSplashProgressMessage(selection[a]->nameNoExt());
-		ui::setSplashProgress(float(a) / float(selection.size()));
-		if (selection[a]->type()->formatId() == "img_png")
-		{
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a]));
-			entryoperations::optimizePNG(selection[a]);
-		}
-	}
+	// Optimize entries
+	auto report = entryoperations::optimizePNG(entries);
 	ui::hideSplash();
 
 	// Finish recording undo level
 	undo_manager_->endRecord(true);
 
+	// Show any issues encountered
+	report.logSummary("Optimize PNG");
+	if (report.nFailed() > 0)
+	{
+		ExtMessageDialog dlg(nullptr, "Optimizing Report");
+		dlg.setMessage(fmt::format("{} of {} entries could not be optimized:", report.nFailed(), entries.size()));
+		dlg.setExt(report.failures());
+		dlg.ShowModal();
+	}
+
 	return true;
 }
 
@@ -3030,6 +3021,9 @@ void ArchivePanel::focusOnEntry(ArchiveEntry* entry) const
 	if (!entry)
 		return;
 
+	// Make sure the tree knows about the entry if it was just added
+	entry_tree_->flushNotifications();
+
 	wxDataViewItem item{ entry };
 	entry_tree_->EnsureVisible(item);
 	entry_tree_->SetSelections(wxDataViewItemArray(1, item));
@@ -3257,6 +3251,22 @@ bool ArchivePanel::handleAction(string_view id)
 	else if (id == "arch_clean_iwaddupes")
 		archiveoperations::removeEntriesUnchangedFromIWAD(archive.get());
 
+	// Archive->Maintenance->Find Text in Entries
+	else if (id == "arch_find_text")
+		archiveoperations::findTextInEntries(archive.get());
+
+	// Archive->Maintenance->Find in All Archive Data
+	else if (id == "arch_find_data")
+		archiveoperations::findDataInArchives();
+
+	// Archive->Maintenance->Replace Text in Entries
+	else if (id == "arch_replace_text")
+		archiveoperations::replaceTextInEntries(archive.get());
+
+	// Archive->Maintenance->Compile All ACS Sources
+	else if (id == "arch_compile_all_acs")
+		entryoperations::compileAllACS(archive.get(), false, theMainWindow);
+
 	// Archive->Maintenance->Replace in Maps
 	else if (id == "arch_replace_maps")
 	{
@@ -3494,7 +3504,11 @@ wxMenu* ArchivePanel::createMaintenanceMenu()
 	SAction::fromId("arch_clean_iwaddupes")->addToMenu(menu_clean);
 	SAction::fromId("arch_check_duplicates")->addToMenu(menu_clean);
 	SAction::fromId("arch_check_duplicates2")->addToMenu(menu_clean);
+	SAction::fromId("arch_find_text")->addToMenu(menu_clean);
+	SAction::fromId("arch_find_data")->addToMenu(menu_clean);
+	SAction::fromId("arch_replace_text")->addToMenu(menu_clean);
 	SAction::fromId("arch_replace_maps")->addToMenu(menu_clean);
+	SAction::fromId("arch_compile_all_acs")->addToMenu(menu_clean);
 	return menu_clean;
 }
 
@@ -3536,6 +3550,12 @@ void ArchivePanel::selectionChanged()
 		toolbar_elist_->findActionButton("arch_entry_bookmark")->Enable(true);
 		toolbar_elist_->enableGroup("_Moving", canMoveEntries());
 		openEntry(selection[0]);
+
+		// Prefetch the following entries once the selected one is shown
+		CallAfter([entry = weak_ptr<ArchiveEntry>(selection[0]->getShared())]() {
+			if (auto e = entry.lock())
+				entryprefetch::prefetchAround(e.get());
+		});
 	}
 	else
 	{
@@ -4155,50 +4175,253 @@ void ArchivePanel::onBtnClearFilter(wxCommandEvent& e)
 
 
 // -----------------------------------------------------------------------------
-// Swaps data between the entry and the undo step
+// Returns the entry the undo step applies to, or null if it no longer exists
 // -----------------------------------------------------------------------------
-bool EntryDataUS::swapData()
+ArchiveEntry* EntryDataUS::entry() const
 {
-	// log::info(1, "Entry data swap...");
-
-	// Get parent dir
 	auto dir = archive_->dirAtPath(path_.ToStdString());
-	if (dir)
-	{
-		// Get entry
-		auto entry = dir->entryAt(index_);
-		if (!entry)
-			return false;
+	return dir ? dir->entryAt(index_) : nullptr;
+}
 
-		// Backup data
-		MemChunk temp_data;
-		temp_data.importMem(entry->rawData(), entry->size());
-		// log::info(1, "Backup current data, size %d", entry->getSize());
+// -----------------------------------------------------------------------------
+// Stores [other] as the version of the entry's data to swap to, as the ranges
+// that differ from the entry's [current] data if that is small enough.
+// Otherwise [other] is kept in full (shared rather than copied)
+// -----------------------------------------------------------------------------
+void EntryDataUS::store(const MemChunk& current, const MemChunk& other)
+{
+	// Ranges of differing bytes closer than this are merged
+	static constexpr uint32_t MIN_GAP = 16;
 
-		// Restore entry data
-		if (data_.size() == 0)
+	diff_.clear();
+	is_diff_ = false;
+
+	if (current.hasData() && other.hasData())
+	{
+		const auto* cur       = current.data();
+		const auto* oth       = other.data();
+		size_t      diff_size = 0;
+		if (current.size() == other.size())
 		{
-			entry->clearData();
-			// log::info(1, "Clear entry data");
+			// Same size, find runs of differing bytes
+			uint32_t size = current.size();
+			uint32_t pos  = 0;
+			while (pos < size && diff_size < size / 2)
+			{
+				if (cur[pos] == oth[pos])
+				{
+					++pos;
+					continue;
+				}
+
+				uint32_t start = pos;
+				uint32_t end   = pos + 1;
+				for (pos = end; pos < size && pos - end < MIN_GAP; ++pos)
+					if (cur[pos] != oth[pos])
+						end = pos + 1;
+
+				diff_.push_back({ start, end - start, MemChunk{ oth + start, end - start } });
+				diff_size += end - start;
+			}
 		}
 		else
 		{
-			entry->importMemChunk(data_);
-			// log::info(1, "Restored entry data, size %d", data.getSize());
+			// Different size, find the common start and end
+			uint32_t min_size = std::min(current.size(), other.size());
+			uint32_t prefix   = 0;
+			while (prefix < min_size && cur[prefix] == oth[prefix])
+				++prefix;
+			uint32_t suffix = 0;
+			while (suffix < min_size - prefix
+				   && cur[current.size() - suffix - 1] == oth[other.size() - suffix - 1])
+				++suffix;
+
+			uint32_t size = other.size() - prefix - suffix;
+			diff_.push_back({ prefix, current.size() - prefix - suffix, MemChunk{ oth + prefix, size } });
+			diff_size = size;
 		}
 
-		// Store previous entry data
-		if (temp_data.size() > 0)
-			data_.importMem(temp_data.data(), temp_data.size());
-		else
+		// Only keep the diff if it's significantly smaller than the data
+		if (diff_size < other.size() / 2)
+		{
+			is_diff_   = true;
+			diff_size_ = other.size();
+			diff_hash_ = current.hash();
 			data_.clear();
+			return;
+		}
 
-		return true;
+		diff_.clear();
 	}
 
-	return false;
+	data_ = other;
+}
+
+// -----------------------------------------------------------------------------
+// Called when the undo level has finished recording (the entry has its new
+// data), reduces the previous data to a diff if possible
+// -----------------------------------------------------------------------------
+void EntryDataUS::recorded()
+{
+	auto entry = this->entry();
+	if (!entry || !data_.hasData())
+		return;
+
+	MemChunk previous{ data_ };
+	store(entry->data(), previous);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (approximate) memory used by the undo step
+// -----------------------------------------------------------------------------
+size_t EntryDataUS::memoryUsage() const
+{
+	if (!is_diff_)
+		return data_.size();
+
+	size_t total = 0;
+	for (const auto& range : diff_)
+		total += sizeof(DiffRange) + range.data.size();
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the other version of the entry's data (or the diff) to [mc]
+// -----------------------------------------------------------------------------
+bool EntryDataUS::writeFile(MemChunk& mc)
+{
+	// Size the chunk first so it isn't resized for each write
+	uint32_t size = sizeof(uint8_t) + 3 * sizeof(uint32_t) + sizeof(uint64_t) + data_.size();
+	for (const auto& range : diff_)
+		size += 3 * sizeof(uint32_t) + range.data.size();
+	if (!mc.reSize(mc.currentPos() + size))
+		return false;
+
+	uint8_t  is_diff   = is_diff_ ? 1 : 0;
+	uint32_t data_size = data_.size();
+	uint32_t n_ranges  = diff_.size();
+	mc.write(&is_diff, sizeof(uint8_t));
+	mc.write(&diff_size_, sizeof(uint32_t));
+	mc.write(&diff_hash_, sizeof(uint64_t));
+	mc.write(&data_size, sizeof(uint32_t));
+	if (data_size > 0)
+		mc.write(data_.data(), data_size);
+	mc.write(&n_ranges, sizeof(uint32_t));
+	for (auto& range : diff_)
+	{
+		uint32_t range_size = range.data.size();
+		mc.write(&range.offset, sizeof(uint32_t));
+		mc.write(&range.size, sizeof(uint32_t));
+		mc.write(&range_size, sizeof(uint32_t));
+		if (range_size > 0)
+			mc.write(range.data.data(), range_size);
+	}
+
+	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads the other version of the entry's data (or the diff) from [mc], as
+// written by writeFile. The data is shared with [mc] rather than copied
+// -----------------------------------------------------------------------------
+bool EntryDataUS::readFile(MemChunk& mc)
+{
+	uint8_t  is_diff   = 0;
+	uint32_t data_size = 0;
+	if (!mc.read(&is_diff, sizeof(uint8_t)) || !mc.read(&diff_size_, sizeof(uint32_t))
+		|| !mc.read(&diff_hash_, sizeof(uint64_t)) || !mc.read(&data_size, sizeof(uint32_t)))
+		return false;
+
+	is_diff_ = is_diff != 0;
+	if (!data_.importShared(mc, mc.currentPos(), data_size))
+		return false;
+	mc.seek(data_size);
+
+	uint32_t n_ranges = 0;
+	if (!mc.read(&n_ranges, sizeof(uint32_t)))
+		return false;
+	diff_.resize(n_ranges);
+	for (auto& range : diff_)
+	{
+		uint32_t range_size = 0;
+		if (!mc.read(&range.offset, sizeof(uint32_t)) || !mc.read(&range.size, sizeof(uint32_t))
+			|| !mc.read(&range_size, sizeof(uint32_t)) || !range.data.importShared(mc, mc.currentPos(), range_size))
+			return false;
+		mc.seek(range_size);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Frees the other version of the entry's data (after it was written to the
+// undo journal)
+// -----------------------------------------------------------------------------
+void EntryDataUS::unload()
+{
+	data_.clear();
+	diff_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Swaps data between the entry and the undo step
+// -----------------------------------------------------------------------------
+bool EntryDataUS::swapData()
+{
+	auto entry = this->entry();
+	if (!entry)
+		return false;
+
+	// Get the other version of the data (rebuilt from the diff if needed)
+	const MemChunk current{ entry->data() };
+	MemChunk other;
+	if (is_diff_)
+	{
+		// The entry must be unchanged since the diff was made
+		if (current.hash() != diff_hash_)
+		{
+			log::warning("Unable to undo/redo changes to entry {}: data was modified", entry->name());
+			return false;
+		}
+
+		if (!other.reSize(diff_size_, false))
+			return false;
+
+		const auto* cur = current.data();
+		auto*       out = other.data();
+		uint32_t    pos = 0;
+		for (const auto& range : diff_)
+		{
+			memcpy(out, cur + pos, range.offset - pos);
+			out += range.offset - pos;
+			memcpy(out, range.data.data(), range.data.size());
+			out += range.data.size();
+			pos = range.offset + range.size;
+		}
+		memcpy(out, cur + pos, current.size() - pos);
+	}
+	else
+		other = data_;
+
+	// Restore entry data
+	if (other.size() == 0)
+		entry->clearData();
+	else
+		entry->importMemChunk(other);
+
+	// Store previous entry data
+	if (current.hasData())
+		store(other, current);
+	else
+	{
+		diff_.clear();
+		is_diff_ = false;
+		data_.clear();
+	}
+
+	return true;
+}
 
 // -----------------------------------------------------------------------------
 // Console Commands
@@ -170,22 +170,48 @@ private:
 	wxPanel* createEntryListPanel(wxWindow* parent);
 };
 
+// Undo step for changes to an entry's data. The previous data is shared with
+// the entry until it is modified, and once the undo level is recorded it is
+// reduced to the ranges that differ from the entry's (new) data where possible
 class EntryDataUS : public UndoStep
 {
 public:
 	EntryDataUS(ArchiveEntry* entry) : path_{ entry->path() }, index_{ entry->index() }, archive_{ entry->parent() }
 	{
-		data_.importMem(entry->rawData(), entry->size());
+		data_.importMem(entry->data());
+		if (data_.isMapped())
+			data_.detach();
 	}
 
-	bool swapData();
-	bool doUndo() override { return swapData(); }
-	bool doRedo() override { return swapData(); }
+	bool   swapData();
+	bool   doUndo() override { return swapData(); }
+	bool   doRedo() override { return swapData(); }
+	void   recorded() override;
+	size_t memoryUsage() const override;
+	bool   writeFile(MemChunk& mc) override;
+	bool   readFile(MemChunk& mc) override;
+	void   unload() override;
 
 private:
-	MemChunk data_;
-	wxString path_;
-	int      index_   = -1;
-	Archive* archive_ = nullptr;
+	// A range of [size] bytes at [offset] in the entry's data, replaced by
+	// [data] in the other version
+	struct DiffRange
+	{
+		uint32_t offset;
+		uint32_t size;
+		MemChunk data;
+	};
+
+	MemChunk          data_; // The other version of the entry's data, if not stored as a diff
+	vector<DiffRange> diff_;
+	bool              is_diff_   = false;
+	uint32_t          diff_size_ = 0; // Size of the other version
+	uint64_t          diff_hash_ = 0; // Hash of the entry data [diff_] applies to
+	wxString          path_;
+	int               index_   = -1;
+	Archive*          archive_ = nullptr;
+
+	ArchiveEntry* entry() const;
+	void          store(const MemChunk& current, const MemChunk& other);
 };
 } // namespace slade
@@ -36,10 +36,13 @@
 #include "Audio/MIDIPlayer.h"
 #include "Audio/ModMusic.h"
 #include "Audio/Mp3Music.h"
+#include "General/ThreadPool.h"
 #include "MainEditor/Conversions.h"
 #include "UI/Controls/SIconButton.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
+#include <list>
 
 using namespace slade;
 
@@ -53,6 +56,232 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Int, snd_volume, 100, CVar::Flag::Save)
 CVAR(Bool, snd_autoplay, false, CVar::Flag::Save)
+CVAR(Int, snd_conversion_cache_size, 64, CVar::Flag::Save) // Maximum size of converted audio kept in memory (MB)
+namespace slade
+{
+// Conversion of an audio entry to a playable format, done on a worker thread
+struct AudioConversion
+{
+	typedef bool (*ConvertFunc)(MemChunk& in, MemChunk& out, int* num_tracks);
+
+	ArchiveEntry*          key = nullptr;
+	weak_ptr<ArchiveEntry> entry;
+	MemChunk               source; // Shares the entry's data, so any change to the entry's data can be detected
+	MemChunk               converted;
+	int                    num_tracks = 1;
+	size_t                 size       = 0;
+	std::atomic<bool>      done{ false };
+};
+
+// Request to read the info (tags/comments) of an audio entry on a worker
+// thread, for display in [panel] (cleared if the panel no longer wants it)
+struct AudioInfoRequest
+{
+	AudioEntryPanel*       panel = nullptr;
+	ArchiveEntry*          key   = nullptr;
+	weak_ptr<ArchiveEntry> entry;
+	MemChunk               data; // Shares the entry's data
+	string                 type_id;
+};
+} // namespace slade
+namespace
+{
+std::list<shared_ptr<AudioConversion>> conversions; // Most recently used first
+size_t                                 conversions_size = 0;
+
+struct CachedInfo
+{
+	ArchiveEntry*          key = nullptr;
+	weak_ptr<ArchiveEntry> entry;
+	MemChunk               data; // Shares the entry's data, so any change to the entry's data can be detected
+	wxString               info;
+};
+std::list<CachedInfo> cached_info; // Most recently used first
+constexpr size_t      max_cached_info = 256;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the function to convert audio of [format] to a playable format, or
+// nullptr if no conversion is needed (or it can't be done on a worker thread)
+// -----------------------------------------------------------------------------
+AudioConversion::ConvertFunc converter(string_view format)
+{
+	if (format == "snd_doom" || format == "snd_doom_mac") // Doom Sound -> WAV
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::doomSndToWav(in, out); };
+	if (format == "snd_speaker") // Doom PC Speaker Sound -> WAV
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::spkSndToWav(in, out); };
+	if (format == "snd_audiot") // AudioT PC Speaker Sound -> WAV
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::spkSndToWav(in, out, true); };
+	if (format == "snd_wolf") // Wolfenstein 3D Sound -> WAV
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::wolfSndToWav(in, out); };
+	if (format == "snd_voc") // Creative Voice File -> WAV
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::vocToWav(in, out); };
+	if (format == "snd_jaguar") // Jaguar Doom Sound -> WAV
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::jagSndToWav(in, out); };
+	if (format == "midi_mus") // MUS -> MIDI
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::musToMidi(in, out); };
+	if (format == "midi_xmi" || format == "midi_hmi" || format == "midi_hmp") // HMI/HMP/XMI -> MIDI
+		return [](MemChunk& in, MemChunk& out, int* num_tracks) {
+			return conversion::zmusToMidi(in, out, 0, num_tracks);
+		};
+	if (format == "midi_gmid") // GMID -> MIDI
+		return [](MemChunk& in, MemChunk& out, int*) { return conversion::gmidToMidi(in, out); };
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Removes the least recently used conversions until the cache is within its
+// maximum size (snd_conversion_cache_size). Conversions still in progress
+// aren't counted until they are done
+// -----------------------------------------------------------------------------
+void trimConversions()
+{
+	auto max_size = static_cast<size_t>(std::max(0, static_cast<int>(snd_conversion_cache_size))) * 1024 * 1024;
+	while (conversions_size > max_size && !conversions.empty())
+	{
+		conversions_size -= conversions.back()->size;
+		conversions.pop_back();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the conversion of [entry] using [convert], from the cache if it was
+// converted (or started converting) previously and the entry's data hasn't
+// changed since. Otherwise the conversion is started on a worker thread
+// -----------------------------------------------------------------------------
+shared_ptr<AudioConversion> entryConversion(ArchiveEntry* entry, AudioConversion::ConvertFunc convert)
+{
+	for (auto i = conversions.begin(); i != conversions.end(); ++i)
+	{
+		auto& conv = *i;
+		if (conv->key != entry)
+			continue;
+
+		if (conv->entry.lock().get() == entry && conv->source.sharesData(entry->data(false)))
+		{
+			// Count the size once done, and move to front
+			if (conv->done && conv->size == 0)
+			{
+				conv->size = std::max<size_t>(conv->converted.size(), 1);
+				conversions_size += conv->size;
+			}
+			conversions.splice(conversions.begin(), conversions, i);
+			auto found = conversions.front();
+			trimConversions();
+			return found;
+		}
+
+		// Entry was changed (or deleted) since it was converted
+		conversions_size -= conv->size;
+		conversions.erase(i);
+		break;
+	}
+
+	auto conv   = std::make_shared<AudioConversion>();
+	conv->key   = entry;
+	conv->entry = entry->getShared();
+	conv->source.importMem(entry->data());
+	conversions.push_front(conv);
+
+	threadpool::enqueue([conv, convert]() {
+		// Convert a separate copy, so [source] keeps sharing the entry's data
+		MemChunk in;
+		in.importMem(conv->source);
+		if (!convert(in, conv->converted, &conv->num_tracks))
+			conv->converted.clear();
+		conv->done = true;
+	});
+
+	return conv;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the info (tags, comments, sample counts etc.) read from audio [mc]
+// of entry type [type_id]. Safe to call from a worker thread
+// -----------------------------------------------------------------------------
+wxString readAudioInfo(const MemChunk& mc, const string& type_id)
+{
+	if (type_id == "snd_doom")
+	{
+		size_t samplerate = mc.readL16(2);
+		size_t samples    = mc.readL16(4);
+		return wxString::Format("%lu samples at %lu Hz", (unsigned long)samples, (unsigned long)samplerate);
+	}
+	if (type_id == "snd_speaker")
+		return wxString::Format("%lu samples", (unsigned long)mc.readL16(2));
+	if (type_id == "snd_audiot")
+		return wxString::Format("%lu samples", (unsigned long)mc.readL16(0));
+	if (type_id == "snd_sun")
+		return audio::getSunInfo(mc);
+	if (type_id == "snd_voc")
+		return audio::getVocInfo(mc);
+	if (type_id == "snd_wav")
+		return audio::getWavInfo(mc);
+	if (type_id == "snd_mp3")
+		return audio::getID3Tag(mc);
+	if (type_id == "snd_ogg")
+		return audio::getOggComments(mc);
+	if (type_id == "snd_flac")
+		return audio::getFlacComments(mc);
+	if (type_id == "snd_aiff")
+		return audio::getAiffInfo(mc);
+	if (type_id == "mod_it")
+		return audio::getITComments(mc);
+	if (type_id == "mod_mod")
+		return audio::getModComments(mc);
+	if (type_id == "mod_s3m")
+		return audio::getS3MComments(mc);
+	if (type_id == "mod_xm")
+		return audio::getXMComments(mc);
+
+	return {};
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached info for [entry], or nullptr if it isn't cached or the
+// entry's data has changed since it was cached
+// -----------------------------------------------------------------------------
+const wxString* cachedInfo(ArchiveEntry& entry)
+{
+	for (auto i = cached_info.begin(); i != cached_info.end(); ++i)
+	{
+		if (i->key != &entry)
+			continue;
+
+		if (i->entry.lock().get() == &entry && i->data.sharesData(entry.data(false)))
+		{
+			// Move to front
+			cached_info.splice(cached_info.begin(), cached_info, i);
+			return &cached_info.front().info;
+		}
+
+		// Entry was changed (or deleted) since it was cached
+		cached_info.erase(i);
+		break;
+	}
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the [info] read for [request] to the cache
+// -----------------------------------------------------------------------------
+void cacheInfo(const AudioInfoRequest& request, const wxString& info)
+{
+	cached_info.push_front({ request.key, request.entry, request.data, info });
+	while (cached_info.size() > max_cached_info)
+		cached_info.pop_back();
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -162,6 +391,10 @@ AudioEntryPanel::~AudioEntryPanel()
 	// Stop the timer to avoid crashes
 	timer_seek_->Stop();
 	resetStream();
+
+	// Don't update the info area once any pending info has been read
+	if (info_request_)
+		info_request_->panel = nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -180,6 +413,8 @@ bool AudioEntryPanel::loadEntry(ArchiveEntry* entry)
 	stopStream();
 	resetStream();
 	opened_ = false;
+	pending_conversion_.reset();
+	play_when_converted_ = false;
 
 	// Enable all playback controls initially
 	slider_seek_->Enable();
@@ -277,40 +512,29 @@ bool AudioEntryPanel::open(ArchiveEntry* entry)
 
 	// Convert if necessary, then write to file
 	data_.clear();
-	if (entry->type()->formatId() == "snd_doom" || // Doom Sound -> WAV
-		entry->type()->formatId() == "snd_doom_mac")
-		conversion::doomSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_speaker") // Doom PC Speaker Sound -> WAV
-		conversion::spkSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_audiot") // AudioT PC Speaker Sound -> WAV
-		conversion::spkSndToWav(mcdata, data_, true);
-	else if (entry->type()->formatId() == "snd_wolf") // Wolfenstein 3D Sound -> WAV
-		conversion::wolfSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_voc") // Creative Voice File -> WAV
-		conversion::vocToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_jaguar") // Jaguar Doom Sound -> WAV
-		conversion::jagSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_bloodsfx") // Blood Sound -> WAV
-		conversion::bloodToWav(entry, data_);
-	else if (entry->type()->formatId() == "midi_mus") // MUS -> MIDI
-	{
-		conversion::musToMidi(mcdata, data_);
-		path.SetExt("mid");
-	}
-	else if (
-		entry->type()->formatId() == "midi_xmi" || // HMI/HMP/XMI -> MIDI
-		entry->type()->formatId() == "midi_hmi" || entry->type()->formatId() == "midi_hmp")
-	{
-		conversion::zmusToMidi(mcdata, data_, 0, &num_tracks_);
-		path.SetExt("mid");
-	}
-	else if (entry->type()->formatId() == "midi_gmid") // GMID -> MIDI
+	if (auto convert = converter(entry->type()->formatId()))
 	{
-		conversion::gmidToMidi(mcdata, data_);
-		path.SetExt("mid");
+		// Conversion is done on a worker thread (and cached), if it isn't done
+		// yet the entry will be opened when it is (see onTimer)
+		auto conv = entryConversion(entry, convert);
+		if (!conv->done)
+		{
+			pending_conversion_ = conv;
+			txt_title_->SetLabel(entry->path(true) + " (converting...)");
+			timer_seek_->Start(10);
+			return true;
+		}
+
+		pending_conversion_.reset();
+		data_.importMem(conv->converted);
+		num_tracks_ = conv->num_tracks;
+		if (strutil::startsWith(entry->type()->formatId(), "midi_"))
+			path.SetExt("mid");
 	}
+	else if (entry->type()->formatId() == "snd_bloodsfx") // Blood Sound -> WAV
+		conversion::bloodToWav(entry, data_);
 	else
-		data_.importMem(mcdata.data(), mcdata.size());
+		data_.importMem(mcdata); // Shares the entry data, the decoders only read from it
 
 	// MIDI format
 	if (strutil::startsWith(entry->type()->formatId(), "midi_"))
@@ -349,7 +573,7 @@ bool AudioEntryPanel::open(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Opens an audio file for playback (SFML 2.x+)
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::openAudio(MemChunk& audio, const wxString& filename)
+bool AudioEntryPanel::openAudio(const MemChunk& audio, const wxString& filename)
 {
 	// Stop if sound currently playing
 	resetStream();
@@ -437,7 +661,7 @@ bool AudioEntryPanel::openMidi(MemChunk& data, const wxString& filename)
 // -----------------------------------------------------------------------------
 // Opens a Module file for playback
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::openMod(MemChunk& data)
+bool AudioEntryPanel::openMod(const MemChunk& data)
 {
 	// Attempt to load the mod
 	if (mod_->loadFromMemory(data.data(), data.size()))
@@ -469,7 +693,7 @@ bool AudioEntryPanel::openMod(MemChunk& data)
 // -----------------------------------------------------------------------------
 // Opens an mp3 file for playback
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::openMp3(MemChunk& data)
+bool AudioEntryPanel::openMp3(const MemChunk& data)
 {
 	// Attempt to load the mp3
 	if (mp3_->loadFromMemory(data.data(), data.size()))
@@ -506,6 +730,13 @@ void AudioEntryPanel::startStream()
 	if (!opened_ && entry_.lock())
 		open(entry_.lock().get());
 
+	// Start playing once converted if the conversion isn't done yet
+	if (pending_conversion_)
+	{
+		play_when_converted_ = true;
+		return;
+	}
+
 	switch (audio_type_)
 	{
 	case Sound: sound_->play(); break;
@@ -550,60 +781,59 @@ void AudioEntryPanel::resetStream() const
 }
 
 // -----------------------------------------------------------------------------
-// Used to update the info area, returns true if info is non-empty
+// Used to update the info area, returns true if info is non-empty.
+// Tags/comments are read on a worker thread (and cached), the info area is
+// updated again when they have been read
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::updateInfo(ArchiveEntry& entry) const
+bool AudioEntryPanel::updateInfo(ArchiveEntry& entry)
 {
 	txt_info_->Clear();
 
-	wxString info = entry.typeString() + "\n";
-	auto&    mc   = entry.data();
+	// Cancel any previous request
+	if (info_request_)
+		info_request_->panel = nullptr;
+	info_request_.reset();
+
+	wxString    info = entry.typeString() + "\n";
+	const auto& mc   = entry.data();
 	switch (audio_type_)
 	{
 	case Sound:
 	case Music:
 	case Mp3:
-		if (entry.type() == EntryType::fromId("snd_doom"))
-		{
-			size_t samplerate = mc.readL16(2);
-			size_t samples    = mc.readL16(4);
-			info += wxString::Format("%lu samples at %lu Hz", (unsigned long)samples, (unsigned long)samplerate);
-		}
-		else if (entry.type() == EntryType::fromId("snd_speaker"))
-		{
-			size_t samples = mc.readL16(2);
-			info += wxString::Format("%lu samples", (unsigned long)samples);
-		}
-		else if (entry.type() == EntryType::fromId("snd_audiot"))
+	case Mod:
+	{
+		// Check for cached info
+		if (auto cached = cachedInfo(entry))
 		{
-			size_t samples = mc.readL16(0);
-			info += wxString::Format("%lu samples", (unsigned long)samples);
+			info += *cached;
+			break;
 		}
-		else if (entry.type() == EntryType::fromId("snd_sun"))
-			info += audio::getSunInfo(mc);
-		else if (entry.type() == EntryType::fromId("snd_voc"))
-			info += audio::getVocInfo(mc);
-		else if (entry.type() == EntryType::fromId("snd_wav"))
-			info += audio::getWavInfo(mc);
-		else if (entry.type() == EntryType::fromId("snd_mp3"))
-			info += audio::getID3Tag(mc);
-		else if (entry.type() == EntryType::fromId("snd_ogg"))
-			info += audio::getOggComments(mc);
-		else if (entry.type() == EntryType::fromId("snd_flac"))
-			info += audio::getFlacComments(mc);
-		else if (entry.type() == EntryType::fromId("snd_aiff"))
-			info += audio::getAiffInfo(mc);
-		break;
-	case Mod:
-		if (entry.type() == EntryType::fromId("mod_it"))
-			info += audio::getITComments(mc);
-		else if (entry.type() == EntryType::fromId("mod_mod"))
-			info += audio::getModComments(mc);
-		else if (entry.type() == EntryType::fromId("mod_s3m"))
-			info += audio::getS3MComments(mc);
-		else if (entry.type() == EntryType::fromId("mod_xm"))
-			info += audio::getXMComments(mc);
+
+		// Read on a worker thread
+		auto request     = std::make_shared<AudioInfoRequest>();
+		request->panel   = this;
+		request->key     = &entry;
+		request->entry   = entry.getShared();
+		request->type_id = entry.type()->id();
+		request->data.importMem(mc);
+		info_request_ = request;
+
+		threadpool::enqueue([request, header = info]() {
+			auto text = readAudioInfo(request->data, request->type_id);
+
+			wxTheApp->CallAfter([request, header, text]() {
+				cacheInfo(*request, text);
+				if (request->panel)
+				{
+					request->panel->txt_info_->SetValue(header + text);
+					request->panel->info_request_.reset();
+					request->panel = nullptr;
+				}
+			});
+		});
 		break;
+	}
 	case MIDI:
 		info += audio::midiInfo(mc);
 		if (entry.type() == EntryType::fromId("midi_rmid"))
@@ -652,7 +882,9 @@ void AudioEntryPanel::onBtnPause(wxCommandEvent& e)
 {
 	// Stop playing (no reset)
 	stopStream();
-	timer_seek_->Stop();
+	play_when_converted_ = false;
+	if (!pending_conversion_)
+		timer_seek_->Stop();
 }
 
 // -----------------------------------------------------------------------------
@@ -662,7 +894,9 @@ void AudioEntryPanel::onBtnStop(wxCommandEvent& e)
 {
 	// Stop playing
 	stopStream();
-	timer_seek_->Stop();
+	play_when_converted_ = false;
+	if (!pending_conversion_)
+		timer_seek_->Stop();
 
 	// Reset
 	resetStream();
@@ -720,6 +954,25 @@ void AudioEntryPanel::onBtnNext(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void AudioEntryPanel::onTimer(wxTimerEvent& e)
 {
+	// Open the entry once its conversion is done
+	if (pending_conversion_)
+	{
+		auto entry = entry_.lock();
+		if (!pending_conversion_->done || !entry)
+			return;
+
+		pending_conversion_.reset();
+		open(entry.get());
+		if (play_when_converted_)
+		{
+			play_when_converted_ = false;
+			startStream();
+		}
+		else
+			timer_seek_->Stop();
+		return;
+	}
+
 	// Get current playback position
 	int pos = 0;
 
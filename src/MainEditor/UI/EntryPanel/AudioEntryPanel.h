@@ -17,6 +17,9 @@ class Music;
 
 namespace slade
 {
+struct AudioConversion;
+struct AudioInfoRequest;
+
 class AudioEntryPanel : public EntryPanel
 {
 public:
@@ -50,6 +53,10 @@ private:
 	bool      opened_      = false;
 	MemChunk  data_;
 
+	shared_ptr<AudioConversion>  pending_conversion_; // Conversion of the entry in progress, if any
+	bool                         play_when_converted_ = false;
+	shared_ptr<AudioInfoRequest> info_request_; // Info (tags etc.) being read for the entry, if any
+
 	wxBitmapButton* btn_play_      = nullptr;
 	wxBitmapButton* btn_pause_     = nullptr;
 	wxBitmapButton* btn_stop_      = nullptr;
@@ -69,11 +76,11 @@ private:
 	unique_ptr<audio::Mp3Music> mp3_;
 
 	bool open(ArchiveEntry* entry);
-	bool openAudio(MemChunk& audio, const wxString& filename);
+	bool openAudio(const MemChunk& audio, const wxString& filename);
 	bool openMidi(MemChunk& data, const wxString& filename);
-	bool openMod(MemChunk& data);
-	bool openMp3(MemChunk& data);
-	bool updateInfo(ArchiveEntry& entry) const;
+	bool openMod(const MemChunk& data);
+	bool openMp3(const MemChunk& data);
+	bool updateInfo(ArchiveEntry& entry);
 	void startStream();
 	void stopStream() const;
 	void resetStream() const;
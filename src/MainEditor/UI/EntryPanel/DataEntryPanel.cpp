@@ -47,6 +47,40 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Returns the data being viewed. This is the entry's data until it is first
+// modified, so only the cells currently visible in the grid are read from it
+// -----------------------------------------------------------------------------
+const MemChunk& DataEntryTable::data() const
+{
+	static const MemChunk no_data;
+
+	if (data_modified_)
+		return data_;
+	if (auto entry = entry_.lock())
+		return entry->data();
+
+	return no_data;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the data to be modified, copying the entry's data on first use
+// -----------------------------------------------------------------------------
+MemChunk& DataEntryTable::editableData()
+{
+	if (!data_modified_)
+	{
+		if (auto entry = entry_.lock())
+		{
+			data_.importMem(entry->data());
+			data_.detach();
+		}
+		data_modified_ = true;
+	}
+
+	return data_;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the number of rows contained in the data
 // -----------------------------------------------------------------------------
@@ -55,7 +89,7 @@ int DataEntryTable::GetNumberRows()
 	if (row_stride_ == 0)
 		return 0;
 	else
-		return ((data_stop_ ? data_stop_ : data_.size()) - data_start_) / row_stride_;
+		return ((data_stop_ ? data_stop_ : data().size()) - data_start_) / row_stride_;
 }
 
 // -----------------------------------------------------------------------------
@@ -71,7 +105,9 @@ int DataEntryTable::GetNumberCols()
 // -----------------------------------------------------------------------------
 wxString DataEntryTable::GetValue(int row, int col)
 {
-	if (!data_.seek(data_start_ + ((row * row_stride_) + columns_[col].row_offset), 0))
+	auto&    data   = this->data();
+	uint32_t offset = data_start_ + ((row * row_stride_) + columns_[col].row_offset);
+	if (offset > data.size())
 		return "INVALID";
 
 	// Signed integer column
@@ -80,25 +116,25 @@ wxString DataEntryTable::GetValue(int row, int col)
 		if (columns_[col].size == 1)
 		{
 			int8_t val;
-			data_.read(&val, 1);
+			data.read(offset, &val, 1);
 			return wxString::Format("%hhd", val);
 		}
 		else if (columns_[col].size == 2)
 		{
 			int16_t val;
-			data_.read(&val, 2);
+			data.read(offset, &val, 2);
 			return wxString::Format("%hd", val);
 		}
 		else if (columns_[col].size == 4)
 		{
 			int32_t val;
-			data_.read(&val, 4);
+			data.read(offset, &val, 4);
 			return wxString::Format("%d", val);
 		}
 		else if (columns_[col].size == 8)
 		{
 			int64_t val;
-			data_.read(&val, 8);
+			data.read(offset, &val, 8);
 			return wxString::Format("%lld", val);
 		}
 		return "INVALID SIZE";
@@ -110,25 +146,25 @@ wxString DataEntryTable::GetValue(int row, int col)
 		if (columns_[col].size == 1)
 		{
 			uint8_t val;
-			data_.read(&val, 1);
+			data.read(offset, &val, 1);
 			return wxString::Format("%hhd", val);
 		}
 		else if (columns_[col].size == 2)
 		{
 			uint16_t val;
-			data_.read(&val, 2);
+			data.read(offset, &val, 2);
 			return wxString::Format("%hd", val);
 		}
 		else if (columns_[col].size == 4)
 		{
 			uint32_t val;
-			data_.read(&val, 4);
+			data.read(offset, &val, 4);
 			return wxString::Format("%d", val);
 		}
 		else if (columns_[col].size == 8)
 		{
 			uint64_t val;
-			data_.read(&val, 8);
+			data.read(offset, &val, 8);
 			return wxString::Format("%lld", (long long)val);
 		}
 		return "INVALID SIZE";
@@ -140,7 +176,7 @@ wxString DataEntryTable::GetValue(int row, int col)
 		if (columns_[col].size == 4)
 		{
 			int32_t val;
-			data_.read(&val, 4);
+			data.read(offset, &val, 4);
 			return wxString::Format("%1.3f", (double)val / 65536.0);
 		}
 		return "INVALID SIZE";
@@ -149,7 +185,7 @@ wxString DataEntryTable::GetValue(int row, int col)
 	// String column
 	else if (columns_[col].type == ColType::String)
 	{
-		return wxString::FromAscii(data_.data() + data_.currentPos(), columns_[col].size);
+		return wxString::FromAscii(data.data() + offset, columns_[col].size);
 	}
 
 	// Custom value column
@@ -159,25 +195,25 @@ wxString DataEntryTable::GetValue(int row, int col)
 		if (columns_[col].size == 1)
 		{
 			int8_t val;
-			data_.read(&val, 1);
+			data.read(offset, &val, 1);
 			value = val;
 		}
 		else if (columns_[col].size == 2)
 		{
 			int16_t val;
-			data_.read(&val, 2);
+			data.read(offset, &val, 2);
 			value = val;
 		}
 		else if (columns_[col].size == 4)
 		{
 			int32_t val;
-			data_.read(&val, 4);
+			data.read(offset, &val, 4);
 			value = val;
 		}
 		else if (columns_[col].size == 8)
 		{
 			int64_t val;
-			data_.read(&val, 8);
+			data.read(offset, &val, 8);
 			value = val;
 		}
 		return wxString::Format("%d: %s", value, columns_[col].customValue(value));
@@ -192,7 +228,8 @@ wxString DataEntryTable::GetValue(int row, int col)
 void DataEntryTable::SetValue(int row, int col, const wxString& value)
 {
 	// Seek to data position
-	if (!data_.seek(data_start_ + (row * row_stride_) + columns_[col].row_offset, 0))
+	auto& data = editableData();
+	if (!data.seek(data_start_ + (row * row_stride_) + columns_[col].row_offset, 0))
 		return;
 
 	// Signed integer or custom value column
@@ -204,22 +241,22 @@ void DataEntryTable::SetValue(int row, int col, const wxString& value)
 		if (columns_[col].size == 1)
 		{
 			int8_t val = longval;
-			data_.write(&val, 1);
+			data.write(&val, 1);
 		}
 		else if (columns_[col].size == 2)
 		{
 			int16_t val = longval;
-			data_.write(&val, 2);
+			data.write(&val, 2);
 		}
 		else if (columns_[col].size == 4)
 		{
 			int32_t val = longval;
-			data_.write(&val, 4);
+			data.write(&val, 4);
 		}
 		else if (columns_[col].size == 8)
 		{
 			int64_t val = longval;
-			data_.write(&val, 8);
+			data.write(&val, 8);
 		}
 	}
 
@@ -234,22 +271,22 @@ void DataEntryTable::SetValue(int row, int col, const wxString& value)
 		if (columns_[col].size == 1)
 		{
 			uint8_t val = longval;
-			data_.write(&val, 1);
+			data.write(&val, 1);
 		}
 		else if (columns_[col].size == 2)
 		{
 			uint16_t val = longval;
-			data_.write(&val, 2);
+			data.write(&val, 2);
 		}
 		else if (columns_[col].size == 4)
 		{
 			uint32_t val = longval;
-			data_.write(&val, 4);
+			data.write(&val, 4);
 		}
 		else if (columns_[col].size == 8)
 		{
 			uint64_t val = longval;
-			data_.write(&val, 8);
+			data.write(&val, 8);
 		}
 	}
 
@@ -260,7 +297,7 @@ void DataEntryTable::SetValue(int row, int col, const wxString& value)
 		unsigned     minsize = std::min<unsigned>(columns_[col].size, value.size());
 		for (unsigned a = 0; a < minsize; a++)
 			str[a] = value[a];
-		data_.write(str.data(), columns_[col].size);
+		data.write(str.data(), columns_[col].size);
 	}
 
 	// Set cell to modified colour
@@ -304,9 +341,9 @@ wxString DataEntryTable::GetRowLabelValue(int row)
 // -----------------------------------------------------------------------------
 bool DataEntryTable::DeleteRows(size_t pos, size_t num)
 {
-	// Copy existing data
-	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	// Get existing data (shared, not copied)
+	const MemChunk copy{ data() };
+	data_modified_ = true;
 
 	// Write new data (excluding deleted rows)
 	unsigned start = data_start_ + (row_stride_ * pos);
@@ -349,9 +386,9 @@ bool DataEntryTable::DeleteRows(size_t pos, size_t num)
 // -----------------------------------------------------------------------------
 bool DataEntryTable::InsertRows(size_t pos, size_t num)
 {
-	// Copy existing data
-	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	// Get existing data (shared, not copied)
+	const MemChunk copy{ data() };
+	data_modified_ = true;
 
 	// Write leading rows
 	unsigned start = data_start_ + (row_stride_ * pos);
@@ -389,34 +426,30 @@ bool DataEntryTable::InsertRows(size_t pos, size_t num)
 // -----------------------------------------------------------------------------
 wxGridCellAttr* DataEntryTable::GetAttr(int row, int col, wxGridCellAttr::wxAttrKind kind)
 {
-	auto attr = new wxGridCellAttr();
-
 	// Check if cell is part of a new row
-	bool new_row = false;
 	for (int i : rows_new_)
 	{
 		if (i == row)
 		{
+			auto attr = new wxGridCellAttr();
 			attr->SetTextColour(colourconfig::colour("new").toWx());
-			new_row = true;
-			break;
+			return attr;
 		}
 	}
 
 	// Check if cell is modified
-	if (!new_row)
+	for (auto& cell : cells_modified_)
 	{
-		for (auto& cell : cells_modified_)
+		if (cell.x == row && cell.y == col)
 		{
-			if (cell.x == row && cell.y == col)
-			{
-				attr->SetTextColour(colourconfig::colour("modified").toWx());
-				break;
-			}
+			auto attr = new wxGridCellAttr();
+			attr->SetTextColour(colourconfig::colour("modified").toWx());
+			return attr;
 		}
 	}
 
-	return attr;
+	// Unmodified cells use the default attributes
+	return nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -425,7 +458,9 @@ wxGridCellAttr* DataEntryTable::GetAttr(int row, int col, wxGridCellAttr::wxAttr
 bool DataEntryTable::setupDataStructure(ArchiveEntry* entry)
 {
 	// Clear existing
+	entry_.reset();
 	data_.clear();
+	data_modified_ = false;
 	data_clipboard_.clear();
 	cells_modified_.clear();
 	rows_new_.clear();
@@ -439,8 +474,8 @@ bool DataEntryTable::setupDataStructure(ArchiveEntry* entry)
 	if (!entry)
 		return true;
 
-	// Load entry data
-	data_.write(entry->rawData(), entry->size());
+	// View entry data (only copied when modified)
+	entry_ = entry->getShared();
 
 	// Setup columns
 	auto type = entry->type()->id();
@@ -812,7 +847,7 @@ void DataEntryTable::copyRows(int row, int num, bool add)
 	if (!add)
 		data_clipboard_.clear();
 
-	data_clipboard_.write(data_.data() + data_start_ + (row * row_stride_), num * row_stride_);
+	data_clipboard_.write(data().data() + data_start_ + (row * row_stride_), num * row_stride_);
 }
 
 // -----------------------------------------------------------------------------
@@ -824,9 +859,9 @@ void DataEntryTable::pasteRows(int row)
 	if (data_clipboard_.size() == 0)
 		return;
 
-	// Copy existing data
-	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	// Get existing data (shared, not copied)
+	const MemChunk copy{ data() };
+	data_modified_ = true;
 
 	// Write leading rows
 	unsigned start = data_start_ + (row_stride_ * row);
@@ -937,7 +972,7 @@ bool DataEntryPanel::writeEntry(ArchiveEntry& entry)
 		{
 			// Write number of entries
 			uint32_t n_pnames = table_data_->GetNumberRows();
-			auto&    data     = table_data_->data();
+			auto&    data     = table_data_->editableData();
 			data.seek(0, SEEK_SET);
 			data.write(&n_pnames, 4);
 		}
@@ -945,7 +980,7 @@ bool DataEntryPanel::writeEntry(ArchiveEntry& entry)
 			return false;
 	}
 
-	entry.importMemChunk(table_data_->data());
+	entry.importMemChunk(table_data_->editableData());
 
 	return true;
 }
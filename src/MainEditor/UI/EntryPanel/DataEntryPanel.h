@@ -65,24 +65,27 @@ public:
 	bool            InsertRows(size_t pos, size_t num) override;
 	wxGridCellAttr* GetAttr(int row, int col, wxGridCellAttr::wxAttrKind kind) override;
 
-	MemChunk& data() { return data_; }
-	Column    columnInfo(int col) { return columns_[col]; }
-	bool      setupDataStructure(ArchiveEntry* entry);
-	void      copyRows(int row, int num, bool add = false);
-	void      pasteRows(int row);
+	const MemChunk& data() const;
+	MemChunk&       editableData();
+	Column          columnInfo(int col) { return columns_[col]; }
+	bool            setupDataStructure(ArchiveEntry* entry);
+	void            copyRows(int row, int num, bool add = false);
+	void            pasteRows(int row);
 
 private:
-	MemChunk        data_;
-	vector<Column>  columns_;
-	unsigned        row_stride_ = 0;
-	unsigned        data_start_ = 0;
-	unsigned        data_stop_  = 0;
-	int             row_first_  = 0;
-	wxString        row_prefix_;
-	DataEntryPanel* parent_ = nullptr;
-	MemChunk        data_clipboard_;
-	vector<Vec2i>   cells_modified_;
-	vector<int>     rows_new_;
+	weak_ptr<ArchiveEntry> entry_; // Entry being viewed, its data is read directly until first modified
+	MemChunk               data_;  // Modified data
+	bool                   data_modified_ = false;
+	vector<Column>         columns_;
+	unsigned               row_stride_ = 0;
+	unsigned               data_start_ = 0;
+	unsigned               data_stop_  = 0;
+	int                    row_first_  = 0;
+	wxString               row_prefix_;
+	DataEntryPanel*        parent_ = nullptr;
+	MemChunk               data_clipboard_;
+	vector<Vec2i>          cells_modified_;
+	vector<int>            rows_new_;
 };
 
 class DataEntryPanel : public EntryPanel
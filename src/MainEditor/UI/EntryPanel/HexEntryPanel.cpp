@@ -69,5 +69,5 @@ bool HexEntryPanel::loadEntry(ArchiveEntry* entry)
 		return false;
 
 	// Load entry data to hex editor
-	return hex_editor_->loadData(entry->data());
+	return hex_editor_->loadEntry(entry);
 }
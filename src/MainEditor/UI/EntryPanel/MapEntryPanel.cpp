@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "MapEntryPanel.h"
 #include "Archive/Archive.h"
+#include "SLADEMap/MapPreview.h"
 #include "UI/Canvas/MapPreviewCanvas.h"
 #include "UI/WxUtils.h"
 
@@ -133,7 +134,13 @@ bool MapEntryPanel::loadEntry(ArchiveEntry* entry)
 	}
 
 	// Load map into preview canvas
-	if (map_canvas_->openMap(thismap))
+	bool opened = map_canvas_->openMap(thismap);
+
+	// Decode the other maps in the archive in the background, so they are
+	// ready if they are selected next
+	mappreview::prefetch(maps);
+
+	if (opened)
 	{
 		label_stats_->SetLabel(wxString::Format(
 			"Vertices: %d, Sides: %d, Lines: %d, Sectors: %d, Things: %d, Total Size: %dx%d",
@@ -162,14 +169,7 @@ bool MapEntryPanel::createImage()
 
 	ArchiveEntry temp;
 
-	// Stupid OpenGL grumble grumble grumble
-	if (GLEW_ARB_framebuffer_object)
-		map_canvas_->createImage(temp, map_image_width, map_image_height);
-	else
-		map_canvas_->createImage(
-			temp,
-			min<int>(map_image_width, map_canvas_->GetSize().x),
-			min<int>(map_image_height, map_canvas_->GetSize().y));
+	map_canvas_->createImage(temp, map_image_width, map_image_height);
 
 	wxString   name = wxString::Format("%s_%s", entry->parent()->filename(false), entry->name());
 	wxFileName fn(name);
@@ -35,6 +35,7 @@
 #include "App.h"
 #include "Archive/Archive.h"
 #include "General/Misc.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
@@ -1056,16 +1057,20 @@ bool PaletteEntryPanel::generateColormaps()
 	uint8_t rgba[4];
 	rgba[3] = 255;
 
-	ColRGBA rgb;
-	float   grey;
 	// Generate 34 maps: the first 32 for diminishing light levels,
 	// the 33th for the inverted grey map used by invulnerability.
 	// The 34th colormap remains empty and black.
-	for (size_t l = 0; l < 34; ++l)
-	{
+	// Each map is generated on a separate thread, since finding the nearest
+	// palette colours can be slow (eg. with CIEDE2000 matching)
+	auto            palette = palettes_[0].get();
+	vector<ColRGBA> colours(34 * 256);
+	vector<short>   indices(34 * 256);
+	threadpool::parallelFor(34, [&](size_t l) {
+		ColRGBA rgb;
+		float   grey;
 		for (size_t c = 0; c < 256; ++c)
 		{
-			rgb = palettes_[0]->colour(c);
+			rgb = palette->colour(c);
 			if (l < 32)
 			{
 				// Generate light maps
@@ -1096,14 +1101,20 @@ bool PaletteEntryPanel::generateColormaps()
 			else
 			{
 				// Fill with 0
-				rgb = palettes_[0]->colour(0);
+				rgb = palette->colour(0);
 			}
-			rgba[0] = rgb.r;
-			rgba[1] = rgb.g;
-			rgba[2] = rgb.b;
-			imc.write(&rgba, 4);
-			mc[(256 * l) + c] = palettes_[0]->nearestColour(rgb);
+			colours[(256 * l) + c] = rgb;
+			indices[(256 * l) + c] = palette->nearestColour(rgb);
 		}
+	});
+
+	for (size_t a = 0; a < colours.size(); ++a)
+	{
+		rgba[0] = colours[a].r;
+		rgba[1] = colours[a].g;
+		rgba[2] = colours[a].b;
+		imc.write(&rgba, 4);
+		mc[a] = indices[a];
 	}
 #if 0
 	// Create truecolor image
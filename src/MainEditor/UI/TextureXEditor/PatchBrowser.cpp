@@ -36,6 +36,7 @@
 #include "Main.h"
 #include "PatchBrowser.h"
 #include "App.h"
+#include "Archive/ArchiveEntry.h"
 #include "Archive/ArchiveManager.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
@@ -47,6 +48,7 @@
 #include "OpenGL/GLTexture.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -67,22 +69,37 @@ PatchBrowserItem::~PatchBrowserItem()
 }
 
 // -----------------------------------------------------------------------------
-// Loads the item's image from its associated entry (if any)
+// Loads the item's image from its associated entry (if any). The thumbnail
+// shown in the browser is generated in the background
 // -----------------------------------------------------------------------------
 bool PatchBrowserItem::loadImage()
 {
-	SImage img;
+	auto img = std::make_shared<SImage>();
 
 	// Load patch image
 	if (type_ == Type::Patch)
 	{
 		// Find patch entry
 		auto entry = app::resources().getPatchEntry(name_.ToStdString(), nspace_.ToStdString(), archive_);
+		if (!entry)
+			return false;
 
-		// Load entry to image, if it exists
-		if (entry)
-			misc::loadImageFromEntry(&img, entry);
-		else
+		// Decode the entry in the background if it's a standalone image (fonts
+		// and Jaguar Doom formats need other entries, so are loaded here)
+		entry->data();
+		const auto& format = entry->type()->formatId();
+		if (entry->type()->extraProps().contains("image") && !strutil::startsWith(format, "font_")
+			&& !strutil::startsWith(format, "img_jaguar_"))
+		{
+			MemChunk data;
+			data.importMem(entry->data());
+			auto format_hint = entry->type()->extraProps().getOr<string>("image_format", {});
+			generateThumbnail([data, format_hint](SImage& image) { return image.open(data, 0, format_hint); });
+			return true;
+		}
+
+		// Load entry to image
+		if (!misc::loadImageFromEntry(img.get(), entry))
 			return false;
 	}
 
@@ -91,18 +108,35 @@ bool PatchBrowserItem::loadImage()
 	{
 		// Find texture
 		auto tex = app::resources().getTexture(name_.ToStdString(), "", archive_);
-
-		// Load texture to image, if it exists
-		if (tex)
-			tex->toImage(img, archive_, parent_->palette());
-		else
+		if (!tex)
 			return false;
+
+		// Use the cached image if there is one
+		auto pal       = parent_->palette();
+		auto cache_key = tex->imageCacheKey(*img, archive_, pal, false);
+		if (!tex->loadCachedImage(*img, cache_key))
+		{
+			// Load patch images (the patch cache isn't thread-safe, so this is
+			// done here) and composite them in the background, using copies of
+			// the texture and palette since they may be modified in the meantime
+			auto patch_images = std::make_shared<vector<SImage>>();
+			if (!tex->loadPatchImages(*patch_images, archive_, pal, false))
+				return false;
+
+			auto texture = std::make_shared<CTexture>();
+			auto palette = std::make_shared<Palette>(*pal);
+			texture->copyTexture(*tex);
+			generateThumbnail([texture, palette, patch_images](SImage& image) {
+				texture->compositeImage(image, *patch_images, palette.get(), false);
+				return true;
+			});
+			return true;
+		}
 	}
 
-	// Create gl texture from image
-	gl::Texture::clear(image_tex_);
-	image_tex_ = gl::Texture::createFromImage(img, parent_->palette());
-	return image_tex_ > 0;
+	// Generate thumbnail from image
+	generateThumbnail([img](SImage& image) { return image.copyImage(img.get()); });
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -115,8 +149,8 @@ wxString PatchBrowserItem::itemInfo()
 	// Add dimensions if known
 	if (image_tex_)
 	{
-		auto& tex_info = gl::Texture::info(image_tex_);
-		info += wxString::Format("%dx%d", tex_info.size.x, tex_info.size.y);
+		auto size = imageSize();
+		info += wxString::Format("%dx%d", size.x, size.y);
 	}
 	else
 		info += "Unknown size";
@@ -145,6 +179,7 @@ void PatchBrowserItem::clearImage()
 {
 	gl::Texture::clear(image_tex_);
 	image_tex_ = 0;
+	clearThumbnail();
 }
 
 
@@ -195,6 +230,7 @@ bool PatchBrowser::openPatchTable(PatchTable* table)
 	theMainWindow->paletteChooser()->setGlobalFromArchive(table->parent());
 
 	// Go through patch table
+	std::unordered_map<Archive*, wxString> archive_names;
 	for (unsigned a = 0; a < table->nPatches(); a++)
 	{
 		// Get patch
@@ -213,7 +249,12 @@ bool PatchBrowser::openPatchTable(PatchTable* table)
 			parent_archive = entry->parent();
 
 			if (parent_archive)
-				whereis = parent_archive->filename(false);
+			{
+				auto& name = archive_names[parent_archive];
+				if (name.empty())
+					name = parent_archive->filename(false);
+				whereis = name;
+			}
 		}
 
 		// Add it
@@ -272,16 +313,23 @@ bool PatchBrowser::openArchive(Archive* archive)
 		flats.clear();
 	}
 
+	// Get the namespace of each entry (only once, it's needed for both the
+	// full path category check and adding the items)
+	vector<string> namespaces(patches.size());
+	for (unsigned a = 0; a < patches.size(); a++)
+		if (patches[a]->parent())
+			namespaces[a] = patches[a]->parent()->detectNamespace(patches[a]);
+
 	// Determine whether one or more patches exists in a treeful archive
 	if (full_path_)
 	{
 		bool bPatches = false, bGraphics = false, bTextures = false, bFlats = false, bSprites = false;
-		for (auto entry : patches)
+		for (unsigned a = 0; a < patches.size(); a++)
 		{
-			if (entry->parent()->isTreeless())
+			if (!patches[a]->parent() || patches[a]->parent()->isTreeless())
 				continue;
 
-			wxString ns = entry->parent()->detectNamespace(entry);
+			const auto& ns = namespaces[a];
 			if (ns == "patches")
 			{
 				if (bPatches)
@@ -323,18 +371,21 @@ bool PatchBrowser::openArchive(Archive* archive)
 		}
 	}
 
-	vector<wxString> usednames;
+	std::unordered_set<string>           usednames;
+	std::unordered_map<Archive*, string> archive_names;
 
 	// Go through the list
-	for (auto entry : patches)
+	for (unsigned a = 0; a < patches.size(); a++)
 	{
 		// Skip any without parent archives (shouldn't happen)
-		if (!entry->parent())
+		auto entry  = patches[a];
+		auto parent = entry->parent();
+		if (!parent)
 			continue;
 
 		// Check entry namespace
-		wxString ns = entry->parent()->detectNamespace(entry);
-		wxString nspace;
+		const auto& ns = namespaces[a];
+		wxString    nspace;
 		if (ns == "patches")
 			nspace = "Patches";
 		else if (ns == "flats")
@@ -347,38 +398,27 @@ bool PatchBrowser::openArchive(Archive* archive)
 			nspace = "Graphics";
 
 		// Check entry parent archive
-		wxString arch = "Unknown";
-		if (entry->parent())
-			arch = entry->parent()->filename(false);
+		auto& arch = archive_names[parent];
+		if (arch.empty())
+			arch = parent->filename(false);
 
 		PatchBrowserItem* item;
 
 		// Add it
-		if (full_path_ && !entry->parent()->isTreeless())
+		if (full_path_ && !parent->isTreeless())
 		{
 			item = new PatchBrowserItem(entry->path(true).substr(1), archive, PatchBrowserItem::Type::Patch, ns);
 			wxString fnspace = nspace + " (Full Path)";
 			addItem(item, fnspace + "/" + arch);
 		}
 
-		wxString name = strutil::truncate(entry->upperNameNoExt(), 8);
-
-		bool duplicate = false;
-		for (auto& usedname : usednames)
-		{
-			if (usedname.Cmp(name) == 0)
-			{
-				duplicate = true;
-				break;
-			}
-		}
-
-		if (duplicate)
+		// Skip if an entry with the same name was already added
+		auto name = strutil::truncate(entry->upperNameNoExt(), 8);
+		if (!usednames.insert(name).second)
 			continue;
 
 		item = new PatchBrowserItem(name, archive, PatchBrowserItem::Type::Patch, ns);
 		addItem(item, nspace + "/" + arch);
-		usednames.push_back(name);
 	}
 
 	// Get list of all available textures (that aren't in the given archive)
@@ -398,7 +438,10 @@ bool PatchBrowser::openArchive(Archive* archive)
 			auto item = new PatchBrowserItem(res->tex.name(), parent, PatchBrowserItem::Type::CTexture);
 
 			// Add to textures node (under parent archive name)
-			addItem(item, "Textures/" + parent->filename(false));
+			auto& arch = archive_names[parent];
+			if (arch.empty())
+				arch = parent->filename(false);
+			addItem(item, "Textures/" + arch);
 		}
 	}
 
@@ -422,17 +465,17 @@ bool PatchBrowser::openTextureXList(TextureXList* texturex, Archive* parent)
 	if (!texturex)
 		return false;
 
+	// Get archive name
+	wxString arch = "Unknown";
+	if (parent)
+		arch = parent->filename(false);
+
 	// Go through all textures in the list
 	for (unsigned a = 0; a < texturex->size(); a++)
 	{
 		// Create browser item
 		auto item = new PatchBrowserItem(texturex->texture(a)->name(), parent, PatchBrowserItem::Type::CTexture);
 
-		// Set archive name
-		wxString arch = "Unknown";
-		if (parent)
-			arch = parent->filename(false);
-
 		// Add to textures node (under parent archive name)
 		addItem(item, "Textures/" + arch);
 	}
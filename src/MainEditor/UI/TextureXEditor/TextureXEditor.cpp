@@ -212,6 +212,12 @@ TextureXEditor::TextureXEditor(wxWindow* parent) : wxPanel(parent, -1)
 		pb_update_ = true;
 		updateTexturePalette();
 	});
+	sc_resources_changed_ = app::resources().signals().resources_changed.connect(
+		[this](const ResourceManager::ResourceChange& change) {
+			pb_update_ = true;
+			if (change.palette_changed)
+				updateTexturePalette();
+		});
 	sc_ptable_modified_   = patch_table_.signals().modified.connect([this]() {
         pb_update_ = true;
         updateTexturePalette();
@@ -62,6 +62,7 @@ private:
 
 	// Signal connections
 	sigslot::scoped_connection sc_resources_updated_;
+	sigslot::scoped_connection sc_resources_changed_;
 	sigslot::scoped_connection sc_palette_changed_;
 	sigslot::scoped_connection sc_ptable_modified_;
 
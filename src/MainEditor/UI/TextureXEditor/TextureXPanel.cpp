@@ -77,6 +77,46 @@ bool TxListIsTextures(TextureXList& tx)
 {
 	return tx.format() == TextureXList::Format::Textures;
 }
+
+// -----------------------------------------------------------------------------
+// Returns the (lowercase) name filter terms in [filter] for TextureXListView
+// -----------------------------------------------------------------------------
+vector<string> filterTerms(const wxString& filter)
+{
+	if (filter.IsEmpty())
+		return {};
+
+	// Split filter by ,
+	auto terms = strutil::split(filter.ToStdString(), ',');
+
+	// Process filter strings
+	for (auto& term : terms)
+	{
+		// Remove spaces
+		strutil::replaceIP(term, " ", "");
+
+		// Set to lowercase and add * to the end
+		if (!term.empty())
+		{
+			strutil::lowerIP(term);
+			term += "*";
+		}
+	}
+
+	return terms;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [name_lower] matches any of the filter [terms]
+// -----------------------------------------------------------------------------
+bool matchesFilter(const string& name_lower, const vector<string>& terms)
+{
+	for (const auto& term : terms)
+		if (strutil::matches(name_lower, term))
+			return true;
+
+	return false;
+}
 } // namespace
 
 
@@ -319,7 +359,7 @@ wxString TextureXListView::itemText(long item, long column, long index) const
 		return "INVALID INDEX";
 
 	// Check index is ok
-	if (index < 0 || (unsigned)index > texturex_->size())
+	if (index < 0 || (unsigned)index >= texturex_->size())
 		return "INVALID INDEX";
 
 	// Get associated texture
@@ -328,7 +368,7 @@ wxString TextureXListView::itemText(long item, long column, long index) const
 	if (column == 0) // Name column
 		return tex->name();
 	else if (column == 1) // Size column
-		return wxString::Format("%dx%d", tex->width(), tex->height());
+		return rowData(index).size_text;
 	else if (column == 2) // Type column
 		return tex->type();
 	else
@@ -346,7 +386,7 @@ void TextureXListView::updateItemAttr(long item, long column, long index) const
 		return;
 
 	// Check index is ok
-	if (index < 0 || (unsigned)index > texturex_->size())
+	if (index < 0 || (unsigned)index >= texturex_->size())
 		return;
 
 	// Get associated texture
@@ -369,45 +409,16 @@ void TextureXListView::updateItemAttr(long item, long column, long index) const
 }
 
 // -----------------------------------------------------------------------------
-// Clears the list if [clear] is true, and refreshes it
+// Clears the list if [clear] is true, and refreshes it (any cached item text is
+// cleared, since the textures may have changed)
 // -----------------------------------------------------------------------------
 void TextureXListView::updateList(bool clear)
 {
 	if (clear)
 		ClearAll();
 
-	// Set list size
-	items_.clear();
-	if (texturex_)
-	{
-		unsigned count = texturex_->size();
-		for (unsigned a = 0; a < count; a++)
-			items_.push_back(a);
-		applyFilter();
-		SetItemCount(items_.size());
-	}
-	else
-		SetItemCount(0);
-
-	sortItems();
-	updateWidth();
-	Refresh();
-}
-
-// -----------------------------------------------------------------------------
-// Returns true if texture at index [left] is smaller than [right]
-// -----------------------------------------------------------------------------
-bool TextureXListView::sizeSort(long left, long right)
-{
-	auto tl = dynamic_cast<TextureXListView*>(lv_current_)->txList()->texture(left);
-	auto tr = dynamic_cast<TextureXListView*>(lv_current_)->txList()->texture(right);
-	int  s1 = tl->width() * tl->height();
-	int  s2 = tr->width() * tr->height();
-
-	if (s1 == s2)
-		return left < right;
-	else
-		return lv_current_->sortDescend() ? s1 > s2 : s2 > s1;
+	rows_.clear();
+	refreshItems();
 }
 
 // -----------------------------------------------------------------------------
@@ -416,180 +427,154 @@ bool TextureXListView::sizeSort(long left, long right)
 void TextureXListView::sortItems()
 {
 	lv_current_ = this;
-	if (sort_column_ == 1)
-		std::sort(items_.begin(), items_.end(), &TextureXListView::sizeSort);
-	else
-		std::sort(items_.begin(), items_.end(), &VirtualListView::defaultSort);
-}
-
-// -----------------------------------------------------------------------------
-// Filters items by the current filter text string
-// -----------------------------------------------------------------------------
-void TextureXListView::applyFilter()
-{
-	// Show all if no filter
-	if (filter_text_.IsEmpty())
+	if (!texturex_ || sort_column_ < 0)
+	{
+		std::sort(items_.begin(), items_.end(), &VirtualListView::indexSort);
 		return;
+	}
 
-	// Split filter by ,
-	auto terms = wxSplit(filter_text_, ',');
-
-	// Process filter strings
-	for (auto& term : terms)
+	// Get the sort key for each item first, so comparisons don't need to look
+	// up textures or generate column text each time
+	struct SortItem
 	{
-		// Remove spaces
-		term.Replace(" ", "");
-
-		// Set to lowercase and add * to the end
-		if (!term.IsEmpty())
-			term = term.Lower() + "*";
+		long          index;
+		int           size;
+		const string* text;
+	};
+	vector<string> type_text;
+	if (sort_column_ == 2)
+	{
+		type_text.reserve(items_.size());
+		for (auto index : items_)
+			type_text.push_back(strutil::lower(texturex_->texture(index)->type()));
 	}
-
-	// Go through filtered list
+	vector<SortItem> sort_items;
+	sort_items.reserve(items_.size());
 	for (unsigned a = 0; a < items_.size(); a++)
 	{
-		auto tex = texturex_->texture(items_[a]);
-
-		// Check for name match with filter
-		bool match = false;
-		for (auto& term : terms)
-		{
-			if (strutil::matchesCI(tex->name(), wxutil::strToView(term)))
-			{
-				match = true;
-				break;
-			}
-		}
-		if (match)
-			continue;
-
-		// No match, remove from filtered list
-		items_.erase(items_.begin() + a);
-		a--;
+		const auto& row = rowData(items_[a]);
+		sort_items.push_back({ items_[a], row.size, sort_column_ == 2 ? &type_text[a] : &row.name_lower });
 	}
-}
 
+	const bool by_size = sort_column_ == 1;
+	const bool descend = sort_descend_;
+	std::sort(sort_items.begin(), sort_items.end(), [by_size, descend](const SortItem& left, const SortItem& right) {
+		int result = by_size ? left.size - right.size : left.text->compare(*right.text);
+		if (result == 0)
+			return left.index < right.index;
+		return descend ? result > 0 : result < 0;
+	});
+
+	for (unsigned a = 0; a < sort_items.size(); a++)
+		items_[a] = sort_items[a].index;
+}
 
 // -----------------------------------------------------------------------------
-//
-// Undo Steps
-//
+// Filters the list to only textures with names matching [filter].
+// If the new filter can only match a subset of what the current filter does
+// (eg. a character was added to the end), the current filtered list is
+// narrowed down rather than filtering all textures again
 // -----------------------------------------------------------------------------
-
-class TextureSwapUS : public UndoStep
+void TextureXListView::setFilter(const wxString& filter)
 {
-public:
-	TextureSwapUS(TextureXList& texturex, int index1, int index2) :
-		texturex_(texturex), index1_(index1), index2_(index2)
+	// Check if the current filtered list can be narrowed down
+	auto terms  = filterTerms(filter);
+	bool narrow = terms.size() == 1 && terms[0].size() > 1 && filter_terms_.size() == 1;
+	if (narrow)
 	{
+		const auto& prev = filter_terms_[0];
+		narrow = !prev.empty() && strutil::startsWith(terms[0], string_view{ prev }.substr(0, prev.size() - 1));
 	}
-	~TextureSwapUS() = default;
 
-	bool doSwap() const
+	filter_text_ = filter;
+
+	if (narrow)
 	{
-		// Get parent dir
-		texturex_.swapTextures(index1_, index2_);
-		return true;
+		filter_terms_ = terms;
+		items_.erase(
+			std::remove_if(
+				items_.begin(),
+				items_.end(),
+				[this](long index) { return !matchesFilter(rowData(index).name_lower, filter_terms_); }),
+			items_.end());
+		SetItemCount(items_.size());
+		Refresh();
 	}
+	else
+		refreshItems();
+}
 
-	bool doUndo() override { return doSwap(); }
-	bool doRedo() override { return doSwap(); }
-
-private:
-	TextureXList& texturex_;
-	int           index1_ = -1;
-	int           index2_ = -1;
-};
-
-class TextureCreateDeleteUS : public UndoStep
+// -----------------------------------------------------------------------------
+// Filters items by the current filter text string
+// -----------------------------------------------------------------------------
+void TextureXListView::applyFilter()
 {
-public:
-	// Texture Created
-	TextureCreateDeleteUS(TextureXPanel* tx_panel, int created_index) : tx_panel_{ tx_panel }, index_{ created_index }
-	{
-	}
+	filter_terms_ = filterTerms(filter_text_);
 
-	// Texture Deleted
-	TextureCreateDeleteUS(TextureXPanel* tx_panel, unique_ptr<CTexture> tex_removed, int removed_index) :
-		tx_panel_{ tx_panel }, tex_removed_{ std::move(tex_removed) }, index_{ removed_index }, created_{ false }
-	{
-	}
+	// Show all if no filter
+	if (filter_text_.IsEmpty())
+		return;
 
-	~TextureCreateDeleteUS() = default;
+	// Remove items not matching the filter
+	items_.erase(
+		std::remove_if(
+			items_.begin(),
+			items_.end(),
+			[this](long index) { return !matchesFilter(rowData(index).name_lower, filter_terms_); }),
+		items_.end());
+}
 
-	bool deleteTexture()
-	{
-		tex_removed_ = tx_panel_->txList().removeTexture(index_);
-		if (tx_panel_->currentTexture() == tex_removed_.get())
-			tx_panel_->textureEditor()->clearTexture();
-		return true;
-	}
+// -----------------------------------------------------------------------------
+// Returns the cached column text and sort/filter keys for the texture at
+// [index], generating them first if needed.
+// The cache is cleared whenever the list is updated (see updateList)
+// -----------------------------------------------------------------------------
+const TextureXListView::RowData& TextureXListView::rowData(long index) const
+{
+	static RowData invalid;
 
-	bool createTexture()
-	{
-		tx_panel_->txList().addTexture(std::move(tex_removed_), index_);
-		return true;
-	}
+	if (!texturex_ || index < 0 || (unsigned)index >= texturex_->size())
+		return invalid;
 
-	bool doUndo() override
-	{
-		if (created_)
-			return deleteTexture();
-		else
-			return createTexture();
-	}
+	if (rows_.size() < texturex_->size())
+		rows_.resize(texturex_->size());
 
-	bool doRedo() override
+	auto& row = rows_[index];
+	if (!row.cached)
 	{
-		if (!created_)
-			return deleteTexture();
-		else
-			return createTexture();
+		auto tex       = texturex_->texture(index);
+		row.size       = tex->width() * tex->height();
+		row.name_lower = strutil::lower(tex->name());
+		row.size_text  = wxString::Format("%dx%d", tex->width(), tex->height());
+		row.cached     = true;
 	}
 
-private:
-	TextureXPanel*       tx_panel_ = nullptr;
-	unique_ptr<CTexture> tex_removed_;
-	int                  index_   = -1;
-	bool                 created_ = true;
-};
+	return row;
+}
 
-class TextureModificationUS : public UndoStep
+// -----------------------------------------------------------------------------
+// Rebuilds the (filtered and sorted) list items from the texture list
+// -----------------------------------------------------------------------------
+void TextureXListView::refreshItems()
 {
-public:
-	TextureModificationUS(TextureXPanel* tx_panel, const CTexture& texture) : tx_panel_(tx_panel)
-	{
-		tex_copy_ = std::make_unique<CTexture>();
-		tex_copy_->copyTexture(texture);
-		tex_copy_->setState(texture.state());
-		index_ = tx_panel->txList().textureIndex(tex_copy_->name());
-	}
-
-	~TextureModificationUS() = default;
-
-	bool swapData()
+	// Set list size
+	items_.clear();
+	if (texturex_)
 	{
-		auto replaced = tx_panel_->txList().replaceTexture(index_, std::move(tex_copy_));
-		if (replaced)
-		{
-			if (tx_panel_->currentTexture() == replaced.get() || tx_panel_->currentTexture() == tex_copy_.get())
-				tx_panel_->textureEditor()->openTexture(tex_copy_.get(), &(tx_panel_->txList()));
-			tex_copy_ = std::move(replaced);
-		}
-		else
-			return false;
-
-		return true;
+		unsigned count = texturex_->size();
+		items_.reserve(count);
+		for (unsigned a = 0; a < count; a++)
+			items_.push_back(a);
+		applyFilter();
+		SetItemCount(items_.size());
 	}
+	else
+		SetItemCount(0);
 
-	bool doUndo() override { return swapData(); }
-	bool doRedo() override { return swapData(); }
-
-private:
-	TextureXPanel*       tx_panel_ = nullptr;
-	unique_ptr<CTexture> tex_copy_;
-	int                  index_ = -1;
-};
+	sortItems();
+	updateWidth();
+	Refresh();
+}
 
 
 // -----------------------------------------------------------------------------
@@ -19,14 +19,9 @@ public:
 
 	TextureXList* txList() const { return texturex_; }
 
-	void        updateList(bool clear = false) override;
-	static bool sizeSort(long left, long right);
-	void        sortItems() override;
-	void        setFilter(const wxString& filter)
-	{
-		filter_text_ = filter;
-		updateList();
-	}
+	void updateList(bool clear = false) override;
+	void sortItems() override;
+	void setFilter(const wxString& filter);
 	void applyFilter() override;
 
 protected:
@@ -34,7 +29,21 @@ protected:
 	void     updateItemAttr(long item, long column, long index) const override;
 
 private:
-	TextureXList* texturex_;
+	// Cached column text and sort/filter keys for a list item
+	struct RowData
+	{
+		bool     cached = false;
+		int      size   = 0; // Width * height
+		string   name_lower;
+		wxString size_text;
+	};
+
+	TextureXList*           texturex_;
+	mutable vector<RowData> rows_;         // Indexed by texture index
+	vector<string>          filter_terms_; // Name filter terms currently applied to [items_]
+
+	const RowData& rowData(long index) const;
+	void           refreshItems();
 };
 
 class TextureXPanel : public wxPanel, SActionHandler
@@ -53,6 +53,58 @@ using namespace mapeditor;
 EXTERN_CVAR(Bool, map_merge_undo_step)
 
 
+// -----------------------------------------------------------------------------
+//
+// ObjectEditGroup::Transform Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the transform that applies this transform followed by [next]
+// -----------------------------------------------------------------------------
+ObjectEditGroup::Transform ObjectEditGroup::Transform::then(const Transform& next) const
+{
+	return { next.a * a + next.c * b,
+			 next.b * a + next.d * b,
+			 next.a * c + next.c * d,
+			 next.b * c + next.d * d,
+			 next.a * e + next.c * f + next.e,
+			 next.b * e + next.d * f + next.f };
+}
+
+// -----------------------------------------------------------------------------
+// Returns a transform that moves by [offset]
+// -----------------------------------------------------------------------------
+ObjectEditGroup::Transform ObjectEditGroup::Transform::translation(Vec2d offset)
+{
+	return { 1., 0., 0., 1., offset.x, offset.y };
+}
+
+// -----------------------------------------------------------------------------
+// Returns a transform that scales by [xscale,yscale] from [origin]
+// -----------------------------------------------------------------------------
+ObjectEditGroup::Transform ObjectEditGroup::Transform::scale(Vec2d origin, double xscale, double yscale)
+{
+	return { xscale, 0., 0., yscale, origin.x - origin.x * xscale, origin.y - origin.y * yscale };
+}
+
+// -----------------------------------------------------------------------------
+// Returns a transform that rotates by [degrees] around [origin]
+// -----------------------------------------------------------------------------
+ObjectEditGroup::Transform ObjectEditGroup::Transform::rotation(Vec2d origin, double degrees)
+{
+	auto srot = sin(math::degToRad(degrees));
+	auto crot = cos(math::degToRad(degrees));
+	return { crot,
+			 srot,
+			 -srot,
+			 crot,
+			 origin.x - (crot * origin.x - srot * origin.y),
+			 origin.y - (srot * origin.x + crot * origin.y) };
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // ObjectEditGroup Class Functions
@@ -61,21 +113,25 @@ EXTERN_CVAR(Bool, map_merge_undo_step)
 
 
 // -----------------------------------------------------------------------------
-// Adds [vertex] to the group.
+// Adds [vertex] to the group (if it isn't already in it).
 // If [ignored] is set, the vertex won't be modified by the object edit
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::addVertex(MapVertex* vertex, bool ignored)
 {
-	auto v = new Vertex{ { vertex->xPos(), vertex->yPos() }, { vertex->xPos(), vertex->yPos() }, vertex, ignored };
+	if (!vertex_indices_.emplace(vertex, map_vertices_.size()).second)
+		return;
+
+	vertex_positions_.push_back(vertex->position());
+	map_vertices_.push_back(vertex);
+	vertex_ignored_.push_back(ignored);
+	++version_;
 
 	if (!ignored)
 	{
-		bbox_.extend(v->position.x, v->position.y);
-		old_bbox_.extend(v->position.x, v->position.y);
-		original_bbox_.extend(v->position.x, v->position.y);
+		bbox_.extend(vertex->xPos(), vertex->yPos());
+		old_bbox_.extend(vertex->xPos(), vertex->yPos());
+		original_bbox_.extend(vertex->xPos(), vertex->yPos());
 	}
-
-	vertices_.emplace_back(v);
 }
 
 // -----------------------------------------------------------------------------
@@ -83,35 +139,26 @@ void ObjectEditGroup::addVertex(MapVertex* vertex, bool ignored)
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::addConnectedLines()
 {
-	const auto n_v = vertices_.size();
+	const auto n_v = map_vertices_.size();
 	for (unsigned v = 0; v < n_v; ++v) // Can't use a range-for loop here due to addVertex usage
 	{
-		auto map_vertex = vertices_[v]->map_vertex;
+		auto map_vertex = map_vertices_[v];
 		for (unsigned l = 0; l < map_vertex->nConnectedLines(); l++)
 		{
 			const auto map_line = map_vertex->connectedLine(l);
-			if (!hasLine(map_line))
-			{
-				// Create line
-				Line line{ findVertex(map_line->v1()), findVertex(map_line->v2()), map_line };
+			if (!line_set_.insert(map_line).second)
+				continue;
 
-				// Add extra vertex if needed (will be ignored for editing)
-				if (!line.v1)
-				{
-					addVertex(map_line->v1(), true);
-					line.v1 = vertices_.back().get();
-				}
-				if (!line.v2)
-				{
-					addVertex(map_line->v2(), true);
-					line.v2 = vertices_.back().get();
-				}
+			// Add extra vertices if needed (will be ignored for editing)
+			addVertex(map_line->v1(), true);
+			addVertex(map_line->v2(), true);
 
-				// Add line
-				lines_.push_back(line);
-			}
+			// Add line
+			lines_.push_back({ vertex_indices_[map_line->v1()], vertex_indices_[map_line->v2()], map_line });
 		}
 	}
+
+	++version_;
 }
 
 // -----------------------------------------------------------------------------
@@ -121,12 +168,11 @@ void ObjectEditGroup::addThing(MapThing* thing)
 {
 	// Add thing
 	Thing t;
-	t.map_thing    = thing;
-	t.position.x   = thing->xPos();
-	t.position.y   = thing->yPos();
-	t.old_position = t.position;
-	t.angle        = thing->angle();
+	t.map_thing = thing;
+	t.position  = thing->position();
+	t.angle     = thing->angle();
 	things_.push_back(t);
+	++version_;
 
 	// Update bbox
 	bbox_.extend(t.position.x, t.position.y);
@@ -134,43 +180,26 @@ void ObjectEditGroup::addThing(MapThing* thing)
 	original_bbox_.extend(t.position.x, t.position.y);
 }
 
-// -----------------------------------------------------------------------------
-// Returns true if [line] is connected to the group vertices
-// -----------------------------------------------------------------------------
-bool ObjectEditGroup::hasLine(MapLine* line)
-{
-	for (auto& l : lines_)
-		if (l.map_line == line)
-			return true;
-
-	return false;
-}
-
-// -----------------------------------------------------------------------------
-// Returns the group info about [vertex]
-// -----------------------------------------------------------------------------
-ObjectEditGroup::Vertex* ObjectEditGroup::findVertex(MapVertex* vertex)
-{
-	for (auto& v : vertices_)
-		if (v->map_vertex == vertex)
-			return v.get();
-
-	return nullptr;
-}
-
 // -----------------------------------------------------------------------------
 // Clears all group items
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::clear()
 {
-	vertices_.clear();
+	vertex_positions_.clear();
+	map_vertices_.clear();
+	vertex_ignored_.clear();
+	vertex_indices_.clear();
 	lines_.clear();
+	line_set_.clear();
 	things_.clear();
 	bbox_.reset();
 	old_bbox_.reset();
 	original_bbox_.reset();
-	offset_prev_ = { 0, 0 };
-	rotation_    = 0;
+	transform_     = {};
+	old_transform_ = {};
+	offset_prev_   = { 0, 0 };
+	rotation_      = 0;
+	++version_;
 }
 
 // -----------------------------------------------------------------------------
@@ -179,9 +208,9 @@ void ObjectEditGroup::clear()
 void ObjectEditGroup::filterObjects(bool filter)
 {
 	// Vertices
-	for (auto& vertex : vertices_)
-		if (!vertex->ignored)
-			vertex->map_vertex->filter(filter);
+	for (unsigned a = 0; a < map_vertices_.size(); ++a)
+		if (!vertex_ignored_[a])
+			map_vertices_[a]->filter(filter);
 
 	// Lines
 	for (auto& line : lines_)
@@ -193,29 +222,12 @@ void ObjectEditGroup::filterObjects(bool filter)
 }
 
 // -----------------------------------------------------------------------------
-// Resets the position of all group objects to their original positions
-// (ie. current position on the actual map)
+// Starts a new drag operation from the current position of all group objects
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::resetPositions()
 {
-	bbox_.reset();
-
-	// Vertices
-	for (auto& vertex : vertices_)
-	{
-		vertex->old_position = vertex->position;
-
-		if (!vertex->ignored)
-			bbox_.extend(vertex->position.x, vertex->position.y);
-	}
-
-	// Things
-	for (auto& thing : things_)
-	{
-		thing.old_position = thing.position;
-		bbox_.extend(thing.position.x, thing.position.y);
-	}
-
+	old_transform_ = transform_;
+	updateBBox();
 	old_bbox_ = bbox_;
 	rotation_ = 0;
 }
@@ -225,18 +237,20 @@ void ObjectEditGroup::resetPositions()
 // and sets [v1]/[v2] to the line vertices.
 // Returns true if a line was found within the distance specified
 // -----------------------------------------------------------------------------
-bool ObjectEditGroup::nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec2d& v2)
+bool ObjectEditGroup::nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec2d& v2) const
 {
 	double min_dist = min;
 	for (auto& line : lines_)
 	{
-		double d = math::distanceToLineFast(pos, { line.v1->position, line.v2->position });
+		auto   p1 = vertexPosition(line.v1);
+		auto   p2 = vertexPosition(line.v2);
+		double d  = math::distanceToLineFast(pos, { p1, p2 });
 
 		if (d < min_dist)
 		{
 			min_dist = d;
-			v1.set(line.v1->position);
-			v2.set(line.v2->position);
+			v1.set(p1);
+			v2.set(p2);
 		}
 	}
 
@@ -244,31 +258,43 @@ bool ObjectEditGroup::nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec
 }
 
 // -----------------------------------------------------------------------------
-// Fills [list] with the positions of all group vertices
+// Returns the current position of the group vertex at [index]
 // -----------------------------------------------------------------------------
-void ObjectEditGroup::putVerticesToDraw(vector<Vec2d>& list)
+Vec2d ObjectEditGroup::vertexPosition(unsigned index) const
 {
-	for (auto& vertex : vertices_)
-		if (!vertex->ignored)
-			list.push_back(vertex->position);
+	return vertex_ignored_[index] ? vertex_positions_[index] : transform_.apply(vertex_positions_[index]);
 }
 
 // -----------------------------------------------------------------------------
-// Fills [list] with all lines in the group
+// Fills [list] with the original positions of all edited group vertices
 // -----------------------------------------------------------------------------
-void ObjectEditGroup::putLinesToDraw(vector<Line>& list)
+void ObjectEditGroup::putVerticesToDraw(vector<Vec2d>& list) const
 {
-	for (auto line : lines_)
-		list.push_back(line);
+	for (unsigned a = 0; a < vertex_positions_.size(); ++a)
+		if (!vertex_ignored_[a])
+			list.push_back(vertex_positions_[a]);
 }
 
 // -----------------------------------------------------------------------------
-// Fills [list] with all things in the group
+// Fills [list] with all lines in the group, in their original positions
 // -----------------------------------------------------------------------------
-void ObjectEditGroup::putThingsToDraw(vector<Thing>& list)
+void ObjectEditGroup::putLinesToDraw(vector<LineToDraw>& list) const
+{
+	for (const auto& line : lines_)
+		list.push_back({ vertex_positions_[line.v1],
+						 vertex_positions_[line.v2],
+						 line.map_line,
+						 !vertex_ignored_[line.v1],
+						 !vertex_ignored_[line.v2] });
+}
+
+// -----------------------------------------------------------------------------
+// Fills [list] with all things in the group (at their current positions)
+// -----------------------------------------------------------------------------
+void ObjectEditGroup::putThingsToDraw(vector<Thing>& list) const
 {
 	for (const auto& thing : things_)
-		list.push_back(thing);
+		list.push_back({ transform_.apply(thing.position), thing.map_thing, thing.angle });
 }
 
 // -----------------------------------------------------------------------------
@@ -279,23 +305,7 @@ void ObjectEditGroup::doMove(double xoff, double yoff)
 	if (xoff == offset_prev_.x && yoff == offset_prev_.y)
 		return;
 
-	// Update vertices
-	for (auto& vertex : vertices_)
-	{
-		// Skip ignored
-		if (vertex->ignored)
-			continue;
-
-		vertex->position.x = vertex->old_position.x + xoff;
-		vertex->position.y = vertex->old_position.y + yoff;
-	}
-
-	// Update things
-	for (auto& thing : things_)
-	{
-		thing.position.x = thing.old_position.x + xoff;
-		thing.position.y = thing.old_position.y + yoff;
-	}
+	transform_ = old_transform_.then(Transform::translation({ xoff, yoff }));
 
 	// Update bbox
 	bbox_.max.x = old_bbox_.max.x + xoff;
@@ -361,33 +371,9 @@ void ObjectEditGroup::doScale(double xoff, double yoff, bool left, bool top, boo
 	if (old_bbox_.height() > 0)
 		yscale = bbox_.height() / old_bbox_.height();
 
-	// Update vertices
-	for (auto& vertex : vertices_)
-	{
-		// Skip ignored
-		if (vertex->ignored)
-			continue;
-
-		// Scale
-		vertex->position.x = old_bbox_.min.x + ((vertex->old_position.x - old_bbox_.min.x) * xscale);
-		vertex->position.y = old_bbox_.min.y + ((vertex->old_position.y - old_bbox_.min.y) * yscale);
-
-		// Move
-		vertex->position.x += xofs;
-		vertex->position.y += yofs;
-	}
-
-	// Update things
-	for (auto& thing : things_)
-	{
-		// Scale
-		thing.position.x = old_bbox_.min.x + ((thing.old_position.x - old_bbox_.min.x) * xscale);
-		thing.position.y = old_bbox_.min.y + ((thing.old_position.y - old_bbox_.min.y) * yscale);
-
-		// Move
-		thing.position.x += xofs;
-		thing.position.y += yofs;
-	}
+	// Scale from the bbox origin, then move
+	transform_ = old_transform_.then(Transform::scale(old_bbox_.min, xscale, yscale))
+					 .then(Transform::translation({ xofs, yofs }));
 
 	offset_prev_.x = xoff;
 	offset_prev_.y = yoff;
@@ -416,16 +402,7 @@ void ObjectEditGroup::doRotate(Vec2d p1, Vec2d p2, bool lock45)
 			rotation_ = 0;
 	}
 
-	// Rotate vertices
-	for (auto& vertex : vertices_)
-	{
-		if (!vertex->ignored)
-			vertex->position = math::rotatePoint(mid, vertex->old_position, rotation_);
-	}
-
-	// Rotate things
-	for (auto& thing : things_)
-		thing.position = math::rotatePoint(mid, thing.old_position, rotation_);
+	transform_ = old_transform_.then(Transform::rotation(mid, rotation_));
 }
 
 // -----------------------------------------------------------------------------
@@ -459,52 +436,21 @@ void ObjectEditGroup::doAll(
 	bbox_.max.y += (ygrow * 0.5);
 	old_bbox_ = bbox_;
 
+	// Mirror and scale (from the original center), then move and rotate
+	transform_ = Transform::scale(original_bbox_.mid(), mirror_x ? -xscale : xscale, mirror_y ? -yscale : yscale)
+					 .then(Transform::translation({ xoff, yoff }));
+	if (rotation != 0)
+		transform_ = transform_.then(Transform::rotation(bbox_.mid(), rotation));
+	old_transform_ = transform_;
 
-	// Update vertices
-	for (auto& vertex : vertices_)
-	{
-		// Skip ignored
-		if (vertex->ignored)
-			continue;
-
-		// Reset first
-		vertex->position.x = vertex->map_vertex->xPos();
-		vertex->position.y = vertex->map_vertex->yPos();
-
-		// Mirror
-		if (mirror_x)
-			vertex->position.x = original_bbox_.midX() - (vertex->position.x - original_bbox_.midX());
-		if (mirror_y)
-			vertex->position.y = original_bbox_.midY() - (vertex->position.y - original_bbox_.midY());
-
-		// Scale
-		vertex->position.x = original_bbox_.midX() + (vertex->position.x - original_bbox_.midX()) * xscale;
-		vertex->position.y = original_bbox_.midY() + (vertex->position.y - original_bbox_.midY()) * yscale;
-
-		// Move
-		vertex->position.x += xoff;
-		vertex->position.y += yoff;
-
-		// Rotate
-		if (rotation != 0)
-			vertex->position = math::rotatePoint(bbox_.mid(), vertex->position, rotation);
-
-		vertex->old_position = vertex->position;
-	}
-
-
-	// Update things
+	// Update thing angles
 	for (auto& thing : things_)
 	{
-		// Reset first
-		thing.position.x = thing.map_thing->xPos();
-		thing.position.y = thing.map_thing->yPos();
-		thing.angle      = thing.map_thing->angle();
+		thing.angle = thing.map_thing->angle();
 
 		// Mirror
 		if (mirror_x)
 		{
-			thing.position.x = original_bbox_.midX() - (thing.position.x - original_bbox_.midX());
 			thing.angle += 90;
 			thing.angle = 360 - thing.angle;
 			thing.angle -= 90;
@@ -513,36 +459,16 @@ void ObjectEditGroup::doAll(
 		}
 		if (mirror_y)
 		{
-			thing.position.y = original_bbox_.midY() - (thing.position.y - original_bbox_.midY());
-			thing.angle      = 360 - thing.angle;
+			thing.angle = 360 - thing.angle;
 			while (thing.angle < 0)
 				thing.angle += 360;
 		}
-
-		// Scale
-		thing.position.x = original_bbox_.min.x + ((thing.position.x - original_bbox_.min.x) * xscale);
-		thing.position.y = original_bbox_.min.y + ((thing.position.y - original_bbox_.min.y) * yscale);
-
-		// Move
-		thing.position.x += xoff;
-		thing.position.y += yoff;
-
-		// Rotate
-		if (rotation != 0)
-			thing.position = math::rotatePoint(bbox_.mid(), thing.position, rotation);
-
-		thing.old_position = thing.position;
 	}
 
 	// Update bbox again for rotation if needed
 	if (rotation != 0)
 	{
-		bbox_.reset();
-		for (auto& vertex : vertices_)
-			if (!vertex->ignored)
-				bbox_.extend(vertex->position.x, vertex->position.y);
-		for (auto& thing : things_)
-			bbox_.extend(thing.position.x, thing.position.y);
+		updateBBox();
 		old_bbox_ = bbox_;
 	}
 
@@ -558,23 +484,18 @@ void ObjectEditGroup::doAll(
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::applyEdit()
 {
-	// Get map
-	SLADEMap* map;
-	if (!vertices_.empty())
-		map = vertices_[0]->map_vertex->parentMap();
-	else if (!things_.empty())
-		map = things_[0].map_thing->parentMap();
-	else
-		return;
-
 	// Move vertices
-	for (auto& vertex : vertices_)
-		vertex->map_vertex->move(vertex->position.x, vertex->position.y);
+	for (unsigned a = 0; a < map_vertices_.size(); ++a)
+		if (!vertex_ignored_[a])
+		{
+			auto pos = transform_.apply(vertex_positions_[a]);
+			map_vertices_[a]->move(pos.x, pos.y);
+		}
 
 	// Move things
 	for (auto& thing : things_)
 	{
-		thing.map_thing->move(thing.position);
+		thing.map_thing->move(transform_.apply(thing.position));
 		thing.map_thing->setAngle(thing.angle);
 	}
 
@@ -583,7 +504,7 @@ void ObjectEditGroup::applyEdit()
 	{
 		for (auto& line : lines_)
 		{
-			if (!line.isExtra())
+			if (!vertex_ignored_[line.v1] && !vertex_ignored_[line.v2])
 				line.map_line->flip(false);
 		}
 	}
@@ -592,12 +513,29 @@ void ObjectEditGroup::applyEdit()
 // -----------------------------------------------------------------------------
 // Adds all group vertices to [list]
 // -----------------------------------------------------------------------------
-void ObjectEditGroup::putMapVertices(vector<MapVertex*>& list)
+void ObjectEditGroup::putMapVertices(vector<MapVertex*>& list) const
 {
-	for (auto& vertex : vertices_)
+	for (unsigned a = 0; a < map_vertices_.size(); ++a)
+		if (!vertex_ignored_[a])
+			list.push_back(map_vertices_[a]);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the bbox to fit the current positions of all edited group objects
+// -----------------------------------------------------------------------------
+void ObjectEditGroup::updateBBox()
+{
+	bbox_.reset();
+	for (unsigned a = 0; a < vertex_positions_.size(); ++a)
+		if (!vertex_ignored_[a])
+		{
+			auto pos = transform_.apply(vertex_positions_[a]);
+			bbox_.extend(pos.x, pos.y);
+		}
+	for (const auto& thing : things_)
 	{
-		if (!vertex->ignored)
-			list.push_back(vertex->map_vertex);
+		auto pos = transform_.apply(thing.position);
+		bbox_.extend(pos.x, pos.y);
 	}
 }
 
@@ -630,40 +568,40 @@ bool ObjectEdit::begin()
 	}
 	else
 	{
-		vector<MapObject*> edit_objects;
+		// Setup object group (vertices already in the group are ignored)
+		group_.clear();
 
 		// Vertices mode
 		if (context_.editMode() == Mode::Vertices)
 		{
-			// Get selected vertices
-			edit_objects = context_.selection().selectedObjects();
+			// Add selected vertices
+			for (auto& object : context_.selection().selectedObjects())
+				group_.addVertex((MapVertex*)object);
 		}
 
 		// Lines mode
 		else if (context_.editMode() == Mode::Lines)
 		{
-			// Get vertices of selected lines
-			auto lines = context_.selection().selectedLines();
-			for (auto& line : lines)
+			// Add vertices of selected lines
+			for (auto& line : context_.selection().selectedLines())
 			{
-				VECTOR_ADD_UNIQUE(edit_objects, line->v1());
-				VECTOR_ADD_UNIQUE(edit_objects, line->v2());
+				group_.addVertex(line->v1());
+				group_.addVertex(line->v2());
 			}
 		}
 
 		// Sectors mode
 		else if (context_.editMode() == Mode::Sectors)
 		{
-			// Get vertices of selected sectors
-			auto sectors = context_.selection().selectedSectors();
-			for (auto& sector : sectors)
-				sector->putVertices(edit_objects);
+			// Add vertices of selected sectors
+			for (auto& sector : context_.selection().selectedSectors())
+				for (auto& side : sector->connectedSides())
+				{
+					group_.addVertex(side->parentLine()->v1());
+					group_.addVertex(side->parentLine()->v2());
+				}
 		}
 
-		// Setup object group
-		group_.clear();
-		for (auto& object : edit_objects)
-			group_.addVertex((MapVertex*)object);
 		group_.addConnectedLines();
 
 		// Filter objects
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utility/Structs.h"
+#include <unordered_set>
 
 namespace slade
 {
@@ -12,50 +13,73 @@ class MapThing;
 class ObjectEditGroup
 {
 public:
-	struct Vertex
+	// 2d affine transform applied to the group objects:
+	// x' = a * x + c * y + e
+	// y' = b * x + d * y + f
+	struct Transform
 	{
-		Vec2d      position;
-		Vec2d      old_position;
-		MapVertex* map_vertex;
-		bool       ignored;
+		double a = 1.;
+		double b = 0.;
+		double c = 0.;
+		double d = 1.;
+		double e = 0.;
+		double f = 0.;
+
+		Vec2d     apply(Vec2d p) const { return { a * p.x + c * p.y + e, b * p.x + d * p.y + f }; }
+		Transform then(const Transform& next) const;
+
+		static Transform translation(Vec2d offset);
+		static Transform scale(Vec2d origin, double xscale, double yscale);
+		static Transform rotation(Vec2d origin, double degrees);
 	};
 
 	struct Line
 	{
-		Vertex*  v1;
-		Vertex*  v2;
+		unsigned v1; // Index of the line's first vertex in the group
+		unsigned v2; // Index of the line's second vertex in the group
 		MapLine* map_line;
-
-		bool isExtra() const { return v1->ignored || v2->ignored; }
 	};
 
 	struct Thing
 	{
-		Vec2d     position;
-		Vec2d     old_position;
+		Vec2d     position; // Position before the edit
 		MapThing* map_thing;
 		int       angle;
 	};
 
-	BBox   bbox() const { return bbox_; }
-	double rotation() const { return rotation_; }
-
-	void    addVertex(MapVertex* vertex, bool ignored = false);
-	void    addConnectedLines();
-	void    addThing(MapThing* thing);
-	bool    hasLine(MapLine* line);
-	Vertex* findVertex(MapVertex* vertex);
-	void    clear();
-	void    filterObjects(bool filter);
-	void    resetPositions();
-	bool    empty() const { return vertices_.empty() && things_.empty(); }
-	bool    nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec2d& v2);
-	void    putMapVertices(vector<MapVertex*>& list);
-
-	// Drawing
-	void putVerticesToDraw(vector<Vec2d>& list);
-	void putLinesToDraw(vector<Line>& list);
-	void putThingsToDraw(vector<Thing>& list);
+	// A line to draw, in its original position. Edited ends of the line are
+	// to be drawn with transform() applied
+	struct LineToDraw
+	{
+		Vec2d    v1;
+		Vec2d    v2;
+		MapLine* map_line;
+		bool     v1_edited;
+		bool     v2_edited;
+	};
+
+	BBox             bbox() const { return bbox_; }
+	double           rotation() const { return rotation_; }
+	const Transform& transform() const { return transform_; }
+	unsigned         version() const { return version_; }
+
+	void  addVertex(MapVertex* vertex, bool ignored = false);
+	void  addConnectedLines();
+	void  addThing(MapThing* thing);
+	bool  hasLine(MapLine* line) const { return line_set_.count(line) > 0; }
+	void  clear();
+	void  filterObjects(bool filter);
+	void  resetPositions();
+	bool  empty() const { return vertex_positions_.empty() && things_.empty(); }
+	bool  nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec2d& v2) const;
+	void  putMapVertices(vector<MapVertex*>& list) const;
+	Vec2d vertexPosition(unsigned index) const;
+
+	// Drawing. Vertices and lines are given in their original positions, to be
+	// drawn with transform() applied
+	void putVerticesToDraw(vector<Vec2d>& list) const;
+	void putLinesToDraw(vector<LineToDraw>& list) const;
+	void putThingsToDraw(vector<Thing>& list) const;
 
 	// Modification
 	void doMove(double xoff, double yoff);
@@ -65,15 +89,29 @@ public:
 	void applyEdit();
 
 private:
-	vector<unique_ptr<Vertex>> vertices_;
-	vector<Line>               lines_;
-	vector<Thing>              things_;
-	BBox                       bbox_;          // Current
-	BBox                       old_bbox_;      // Before drag operation
-	BBox                       original_bbox_; // From first init
-	Vec2d                      offset_prev_ = { 0, 0 };
-	double                     rotation_    = 0;
-	bool                       mirrored_    = false;
+	// Vertices (as separate arrays, each indexed by the vertex's group index).
+	// Positions are only transformed when needed, the renderer applies
+	// transform_ when drawing and the final positions are calculated when the
+	// edit is applied
+	vector<Vec2d>                            vertex_positions_; // Positions before the edit
+	vector<MapVertex*>                       map_vertices_;
+	vector<uint8_t>                          vertex_ignored_; // Not modified by the edit (connected lines only)
+	std::unordered_map<MapVertex*, unsigned> vertex_indices_;
+
+	vector<Line>                 lines_;
+	std::unordered_set<MapLine*> line_set_;
+	vector<Thing>                things_;
+	BBox                         bbox_;          // Current
+	BBox                         old_bbox_;      // Before drag operation
+	BBox                         original_bbox_; // From first init
+	Transform                    transform_;     // Current
+	Transform                    old_transform_; // Before drag operation
+	Vec2d                        offset_prev_ = { 0, 0 };
+	double                       rotation_    = 0;
+	bool                         mirrored_    = false;
+	unsigned                     version_     = 0; // Incremented whenever objects are added or removed
+
+	void updateBBox();
 };
 
 #undef None
@@ -0,0 +1,347 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    HiresProxyCache.cpp
+// Description: Cache of downscaled 'proxy' images for hi-res textures. The map
+//              editor shows these until a texture is seen up close enough to
+//              need its full resolution (see MapTextureManager)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "HiresProxyCache.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Console.h"
+#include "General/EntryPrefetch.h"
+#include "General/ThreadPool.h"
+#include "Graphics/SImage/SImage.h"
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, map_tex_proxy_size, 128, CVar::Flag::Save)      // Maximum width/height of hi-res texture proxies
+CVAR(Int, map_tex_proxy_cache_size, 64, CVar::Flag::Save) // Maximum size of cached hi-res texture proxies (MB)
+namespace
+{
+struct Proxy
+{
+	ArchiveEntry*          key = nullptr;
+	weak_ptr<ArchiveEntry> entry;
+	MemChunk               data; // Shares the entry's data, so any change to the entry's data can be detected
+	string                 format_hint;
+	int                    max_size = 0;
+	SImage                 image;
+	Vec2i                  full_size;
+	size_t                 size = 0;
+	bool                   ok   = false;
+	std::atomic<bool>      done{ false };
+};
+
+std::list<shared_ptr<Proxy>>                                              proxies; // Most recently used first
+std::unordered_map<ArchiveEntry*, std::list<shared_ptr<Proxy>>::iterator> proxy_index;
+size_t                                                                    cache_size  = 0;
+unsigned                                                                  n_generated = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the maximum cache size in bytes
+// -----------------------------------------------------------------------------
+size_t maxCacheSize()
+{
+	return static_cast<size_t>(std::max(0, static_cast<int>(map_tex_proxy_cache_size))) * 1024 * 1024;
+}
+
+// -----------------------------------------------------------------------------
+// Decodes the image data of [proxy] and downscales it to fit within its
+// maximum size (by a power of two, so the result matches what
+// gl::Texture::reduce would give). Images already small enough are kept as-is.
+// Safe to call from a worker thread
+// -----------------------------------------------------------------------------
+void generate(Proxy& proxy)
+{
+	SImage full;
+	if (!full.open(proxy.data, 0, proxy.format_hint))
+		return;
+
+	int width       = full.width();
+	int height      = full.height();
+	proxy.full_size = { width, height };
+	int reduction   = 1;
+	while (std::max(width, height) / reduction > proxy.max_size)
+		reduction *= 2;
+
+	if (reduction == 1)
+	{
+		proxy.image.copyImage(&full);
+		proxy.ok = true;
+		return;
+	}
+
+	// Paletted images without their own palette depend on the current resource
+	// palette, leave these to be loaded in full
+	if (full.type() != SImage::Type::RGBA && !full.hasPalette())
+		return;
+
+	MemChunk rgba;
+	if (!full.putRGBAData(rgba))
+		return;
+
+	// Downscale (average each block of pixels)
+	int             p_width  = std::max(1, width / reduction);
+	int             p_height = std::max(1, height / reduction);
+	vector<uint8_t> pixels(p_width * p_height * 4);
+	const auto      src = rgba.data();
+	for (int y = 0; y < p_height; y++)
+	{
+		int y1 = y * height / p_height;
+		int y2 = std::max(y1 + 1, (y + 1) * height / p_height);
+		for (int x = 0; x < p_width; x++)
+		{
+			int      x1       = x * width / p_width;
+			int      x2       = std::max(x1 + 1, (x + 1) * width / p_width);
+			unsigned total[4] = { 0, 0, 0, 0 };
+			for (int sy = y1; sy < y2; sy++)
+				for (int sx = x1; sx < x2; sx++)
+					for (int c = 0; c < 4; c++)
+						total[c] += src[(sy * width + sx) * 4 + c];
+
+			unsigned npix = (x2 - x1) * (y2 - y1);
+			for (int c = 0; c < 4; c++)
+				pixels[(y * p_width + x) * 4 + c] = total[c] / npix;
+		}
+	}
+
+	proxy.ok = proxy.image.setImageData(pixels, p_width, p_height, SImage::Type::RGBA);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a new (not yet generated) proxy for [entry], or nullptr if the entry
+// isn't an image that can be decoded in the background
+// -----------------------------------------------------------------------------
+shared_ptr<Proxy> newProxy(ArchiveEntry* entry)
+{
+	// Load entry data (also detects the entry type if it was deferred)
+	entry->data();
+	if (!entryprefetch::canDecode(*entry))
+		return nullptr;
+
+	auto proxy   = std::make_shared<Proxy>();
+	proxy->key   = entry;
+	proxy->entry = entry->getShared();
+	proxy->data.importMem(entry->data());
+	proxy->format_hint = entry->type()->extraProps().getOr<string>("image_format", {});
+	proxy->max_size    = std::max(1, static_cast<int>(map_tex_proxy_size));
+
+	return proxy;
+}
+
+// -----------------------------------------------------------------------------
+// Removes the cached proxy at [i]
+// -----------------------------------------------------------------------------
+void removeProxy(std::list<shared_ptr<Proxy>>::iterator i)
+{
+	cache_size -= (*i)->size;
+	proxy_index.erase((*i)->key);
+	proxies.erase(i);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the least recently used proxies until the cache is within its
+// maximum size (map_tex_proxy_cache_size). Proxies still being generated
+// aren't counted until they are done
+// -----------------------------------------------------------------------------
+void trimCache()
+{
+	auto max_size = maxCacheSize();
+	while (cache_size > max_size && !proxies.empty())
+		removeProxy(std::prev(proxies.end()));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached proxy for [entry], if any exists and the entry's data
+// hasn't changed since it was cached
+// -----------------------------------------------------------------------------
+shared_ptr<Proxy> findProxy(ArchiveEntry* entry)
+{
+	auto found = proxy_index.find(entry);
+	if (found == proxy_index.end())
+		return nullptr;
+
+	auto i = found->second;
+	if ((*i)->entry.lock().get() == entry && (*i)->data.sharesData(entry->data(false))
+		&& (*i)->max_size == std::max(1, static_cast<int>(map_tex_proxy_size)))
+		return *i;
+
+	// Entry was changed (or deleted) since it was cached
+	removeProxy(i);
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [proxy] to the cache as the most recently used
+// -----------------------------------------------------------------------------
+void addProxy(const shared_ptr<Proxy>& proxy)
+{
+	proxies.push_front(proxy);
+	proxy_index[proxy->key] = proxies.begin();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// hiresproxy Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts generating the proxy for hi-res [entry] on the worker thread pool, if
+// it isn't already cached or being generated
+// -----------------------------------------------------------------------------
+void hiresproxy::request(ArchiveEntry* entry)
+{
+	if (!entry || findProxy(entry))
+		return;
+
+	auto proxy = newProxy(entry);
+	if (!proxy)
+		return;
+
+	addProxy(proxy);
+	threadpool::enqueue(
+		[proxy]() {
+			generate(*proxy);
+			proxy->done = true;
+		},
+		threadpool::Priority::Background);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the proxy for [entry] is currently being generated
+// -----------------------------------------------------------------------------
+bool hiresproxy::isPending(ArchiveEntry* entry)
+{
+	auto proxy = findProxy(entry);
+	return proxy && !proxy->done;
+}
+
+// -----------------------------------------------------------------------------
+// Copies the proxy image for hi-res [entry] to [image], and the size of the
+// full image to [full_size]. The proxy is generated immediately if it wasn't
+// requested previously (or is still being generated).
+// [image] is the full image if it was already small enough to not need a
+// proxy. Returns false if no proxy could be generated, in which case the image
+// should be loaded in full as normal
+// -----------------------------------------------------------------------------
+bool hiresproxy::get(ArchiveEntry* entry, SImage& image, Vec2i& full_size)
+{
+	if (!entry)
+		return false;
+
+	auto proxy = findProxy(entry);
+	if (!proxy || !proxy->done)
+	{
+		// Generate now (only cache if it wasn't already being generated)
+		bool pending = proxy != nullptr;
+		proxy        = newProxy(entry);
+		if (!proxy)
+			return false;
+
+		generate(*proxy);
+		proxy->done = true;
+		if (!pending)
+			addProxy(proxy);
+	}
+	else
+	{
+		// Move to front
+		proxies.splice(proxies.begin(), proxies, proxy_index[entry]);
+	}
+
+	if (!proxy->ok)
+		return false;
+
+	// Now that it's done, update the cache size
+	auto cached = proxy_index.find(entry);
+	if (proxy->size == 0 && cached != proxy_index.end() && *cached->second == proxy)
+	{
+		proxy->size = static_cast<size_t>(proxy->image.width()) * proxy->image.height()
+					  * (proxy->image.type() == SImage::Type::RGBA ? 4 : 2);
+		n_generated++;
+		cache_size += proxy->size;
+	}
+
+	image.copyImage(&proxy->image);
+	full_size = proxy->full_size;
+	trimCache();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached proxies
+// -----------------------------------------------------------------------------
+void hiresproxy::clear()
+{
+	proxies.clear();
+	proxy_index.clear();
+	cache_size = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(map_tex_proxy_stats, 0, false)
+{
+	log::console(fmt::format(
+		"Hi-res texture proxies: {} cached, {:1.2f}MB, {} generated",
+		proxies.size(),
+		static_cast<double>(cache_size) / (1024. * 1024.),
+		n_generated));
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class SImage;
+
+// Cache of small downscaled 'proxy' images for hi-res textures, so large
+// hi-res replacements can be shown in the map editor without uploading them at
+// full size (see MapTextureManager). Proxies are generated on worker threads,
+// and discarded when their entry's data changes or the least recently used
+// proxies are removed when the cache grows beyond its maximum size.
+// Must only be used from the main thread
+namespace hiresproxy
+{
+	void request(ArchiveEntry* entry);
+	bool isPending(ArchiveEntry* entry);
+	bool get(ArchiveEntry* entry, SImage& image, Vec2i& full_size);
+	void clear();
+} // namespace hiresproxy
+} // namespace slade
@@ -80,6 +80,22 @@ mapeditor::Item ItemSelection::firstSelectedOrHilight()
 	return {};
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if [item] is selected (a selected item of type Any matches any
+// item with the same index)
+// -----------------------------------------------------------------------------
+bool ItemSelection::isSelected(const mapeditor::Item& item) const
+{
+	// Negative indices aren't tracked per type, check the list
+	if (item.index < 0)
+		return VECTOR_EXISTS(selection_, item);
+
+	auto  index    = static_cast<unsigned>(item.index);
+	auto& bits     = selected_[static_cast<int>(item.type)];
+	auto& any_bits = selected_[static_cast<int>(ItemType::Any)];
+	return (index < bits.size() && bits[index]) || (index < any_bits.size() && any_bits[index]);
+}
+
 // -----------------------------------------------------------------------------
 // Sets the current hilight to [item]. Returns true if the hilight was changed
 // -----------------------------------------------------------------------------
@@ -201,6 +217,7 @@ void ItemSelection::clear()
 
 	// Clear selection
 	selection_.clear();
+	resetSelected();
 
 	if (context_)
 		context_->selectionUpdated();
@@ -229,8 +246,11 @@ void ItemSelection::select(const vector<mapeditor::Item>& items, bool select, bo
 	if (new_change)
 		last_change_.clear();
 
+	// Deselected items are removed from the list all at once afterwards
 	for (auto& item : items)
-		selectItem(item, select);
+		selectItem(item, select, false);
+	if (!select)
+		removeDeselected();
 }
 
 // -----------------------------------------------------------------------------
@@ -730,26 +750,81 @@ void ItemSelection::migrate(Mode from_edit_mode, Mode to_edit_mode)
 
 	// Apply new selection
 	selection_.assign(new_selection.begin(), new_selection.end());
+	resetSelected();
+	for (auto& item : selection_)
+		setSelected(item, true);
 }
 
 // -----------------------------------------------------------------------------
 // Selects or deselects [item] depending on the value of [select] and updates
 // the current ChangeSet
 // -----------------------------------------------------------------------------
-void ItemSelection::selectItem(const mapeditor::Item& item, bool select)
+void ItemSelection::selectItem(const mapeditor::Item& item, bool select, bool remove_now)
 {
 	// Check if already selected
-	bool selected = VECTOR_EXISTS(selection_, item);
+	bool selected = isSelected(item);
 
 	// (De)Select and update change set
 	if (select && !selected)
 	{
 		selection_.push_back(item);
+		setSelected(item, true);
 		last_change_[item] = true;
 	}
 	if (!select && selected)
 	{
-		VECTOR_REMOVE(selection_, item);
+		setSelected(item, false);
+		if (remove_now || item.index < 0)
+			VECTOR_REMOVE(selection_, item);
 		last_change_[item] = false;
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Sets the selection state of [item] to [selected]. When deselecting, any
+// selected item of type Any with the same index is also deselected (as it
+// matches [item])
+// -----------------------------------------------------------------------------
+void ItemSelection::setSelected(const mapeditor::Item& item, bool selected)
+{
+	if (item.index < 0)
+		return;
+
+	auto  index = static_cast<unsigned>(item.index);
+	auto& bits  = selected_[static_cast<int>(item.type)];
+	if (selected)
+	{
+		if (bits.size() <= index)
+			bits.resize(index + 1, false);
+		bits[index] = true;
+		return;
+	}
+
+	if (index < bits.size())
+		bits[index] = false;
+	auto& any_bits = selected_[static_cast<int>(ItemType::Any)];
+	if (index < any_bits.size())
+		any_bits[index] = false;
+}
+
+// -----------------------------------------------------------------------------
+// Removes any items that are no longer selected from the selection list
+// -----------------------------------------------------------------------------
+void ItemSelection::removeDeselected()
+{
+	selection_.erase(
+		std::remove_if(
+			selection_.begin(),
+			selection_.end(),
+			[this](const mapeditor::Item& item) { return !isSelected(item); }),
+		selection_.end());
+}
+
+// -----------------------------------------------------------------------------
+// Clears the selection state of all items
+// -----------------------------------------------------------------------------
+void ItemSelection::resetSelected()
+{
+	for (auto& bits : selected_)
+		bits.clear();
+}
@@ -54,7 +54,7 @@ public:
 
 	bool hasHilight() const { return hilight_.index >= 0; }
 	bool hasHilightOrSelection() const { return !selection_.empty() || hilight_.index >= 0; }
-	bool isSelected(const mapeditor::Item& item) const { return VECTOR_EXISTS(selection_, item); }
+	bool isSelected(const mapeditor::Item& item) const;
 	bool isHilighted(const mapeditor::Item& item) const { return item == hilight_; }
 
 	bool updateHilight(Vec2d mouse_pos, double dist_scale);
@@ -89,12 +89,18 @@ public:
 	// void	selectItem3d(MapEditor::Item item, int sel);
 
 private:
+	static constexpr int n_item_types = static_cast<int>(mapeditor::ItemType::Any) + 1;
+
 	mapeditor::Item         hilight_ = { -1, mapeditor::ItemType::Any };
 	vector<mapeditor::Item> selection_;
+	vector<bool>            selected_[n_item_types]; // Selection state of each index, per item type
 	bool                    hilight_lock_ = false;
 	ChangeSet               last_change_;
 	MapEditContext*         context_ = nullptr;
 
-	void selectItem(const mapeditor::Item& item, bool select = true);
+	void selectItem(const mapeditor::Item& item, bool select = true, bool remove_now = true);
+	void setSelected(const mapeditor::Item& item, bool selected);
+	void removeDeselected();
+	void resetSelected();
 };
 } // namespace slade
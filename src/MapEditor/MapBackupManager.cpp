@@ -34,11 +34,15 @@
 #include "App.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "General/Misc.h"
+#include "General/ThreadPool.h"
 #include "MapEditor.h"
 #include "UI/MapBackupPanel.h"
 #include "UI/SDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/Compression.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
+#include <filesystem>
 
 using namespace slade;
 
@@ -57,6 +61,130 @@ string mb_ignore_entries[] = { "NODES",    "SSECTORS", "ZNODES",  "SEGS",     "R
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A lump listed in a backup manifest
+struct BackupLump
+{
+	string   name;
+	unsigned size = 0;
+	uint32_t crc  = 0;
+
+	bool operator==(const BackupLump& other) const
+	{
+		return name == other.name && size == other.size && crc == other.crc;
+	}
+
+	// Filename of the lump's (compressed) data within the backup data dir.
+	// Lumps are stored by content, so identical lumps are only stored once
+	string dataFile() const { return fmt::format("{:08x}_{}.lmp", crc, size); }
+};
+
+// -----------------------------------------------------------------------------
+// Returns the directory that map backups for [archive_name] are stored in
+// -----------------------------------------------------------------------------
+string backupDir(string_view archive_name)
+{
+	string fname{ archive_name };
+	std::replace(fname.begin(), fname.end(), '.', '_');
+	return fmt::format("{}/{}_backup", app::path("backups", app::Dir::User), fname);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a list of the backup timestamps in the map backup dir [map_dir],
+// from oldest to newest
+// -----------------------------------------------------------------------------
+vector<string> backupTimestamps(const string& map_dir)
+{
+	vector<string>  timestamps;
+	std::error_code ec;
+	for (const auto& item : std::filesystem::directory_iterator{ map_dir, ec })
+		if (item.is_regular_file() && item.path().extension() == ".txt")
+			timestamps.push_back(item.path().stem().string());
+
+	// Timestamps are ISO format, so sort chronologically
+	std::sort(timestamps.begin(), timestamps.end());
+
+	return timestamps;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the lumps listed in the backup manifest file at [path]
+// -----------------------------------------------------------------------------
+vector<BackupLump> readManifest(const string& path)
+{
+	vector<BackupLump> lumps;
+	string             text;
+	if (!fileutil::readFileToString(path, text))
+		return lumps;
+
+	for (const auto& line : strutil::splitV(text, '\n'))
+	{
+		auto parts = strutil::splitV(line, ' ');
+		if (parts.size() < 3)
+			continue;
+
+		BackupLump lump;
+		lump.name = parts[0];
+		lump.size = strutil::asUInt(parts[1]);
+		lump.crc  = strutil::asUInt(parts[2], 16);
+		lumps.push_back(lump);
+	}
+
+	return lumps;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [lumps] to a backup manifest file at [path]
+// -----------------------------------------------------------------------------
+bool writeManifest(const string& path, const vector<BackupLump>& lumps)
+{
+	string text;
+	for (const auto& lump : lumps)
+		text += fmt::format("{} {} {:08x}\n", lump.name, lump.size, lump.crc);
+
+	return fileutil::writeStringToFile(text, path);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the oldest backups in [map_dir] so there are no more than
+// max_map_backups, then removes any lump data no longer used by a backup
+// -----------------------------------------------------------------------------
+void rotateBackups(const string& map_dir)
+{
+	auto timestamps = backupTimestamps(map_dir);
+	if (static_cast<int>(timestamps.size()) <= max_map_backups)
+		return;
+
+	auto n_remove = timestamps.size() - std::max<int>(max_map_backups, 1);
+	for (size_t a = 0; a < n_remove; a++)
+		fileutil::removeFile(fmt::format("{}/{}.txt", map_dir, timestamps[a]));
+
+	// Collect data files still in use
+	std::set<string> used;
+	for (auto a = n_remove; a < timestamps.size(); a++)
+		for (const auto& lump : readManifest(fmt::format("{}/{}.txt", map_dir, timestamps[a])))
+			used.insert(lump.dataFile());
+
+	// Remove unused data files
+	std::error_code ec;
+	vector<string>  unused;
+	for (const auto& item : std::filesystem::directory_iterator{ map_dir + "/data", ec })
+		if (item.is_regular_file() && used.count(item.path().filename().string()) == 0)
+			unused.push_back(item.path().string());
+	for (const auto& path : unused)
+		fileutil::removeFile(path);
+
+	log::info(2, "Removed {} old map backups, {} unused lumps", n_remove, unused.size());
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapBackupManager Class Functions
@@ -66,28 +194,21 @@ string mb_ignore_entries[] = { "NODES",    "SSECTORS", "ZNODES",  "SEGS",     "R
 
 // -----------------------------------------------------------------------------
 // Writes a backup for [map_name] in [archive_name], with the map data entries
-// in [map_data]
+// in [map_data].
+// The backup is written in the background, so this only fails if there is no
+// map data to back up
 // -----------------------------------------------------------------------------
 bool MapBackupManager::writeBackup(
 	vector<unique_ptr<ArchiveEntry>>& map_data,
 	std::string_view                  archive_name,
-	std::string_view                  map_name) const
+	std::string_view                  map_name)
 {
-	// Create backup directory if needed
-	auto backup_dir = app::path("backups", app::Dir::User);
-	if (!wxDirExists(backup_dir))
-		wxMkdir(backup_dir);
-
-	// Open or create backup zip
-	shared_ptr<Archive> backup = std::make_shared<ZipArchive>();
-	string              fname{ archive_name };
-	std::replace(fname.begin(), fname.end(), '.', '_');
-	auto backup_file = fmt::format("{}/{}_backup.zip", backup_dir, fname);
-	if (!backup->open(backup_file))
-		backup->setFilename(backup_file);
+	BackupJob job;
+	job.dir       = fmt::format("{}/{}", backupDir(archive_name), map_name);
+	job.timestamp = wxDateTime::Now().FormatISOCombined('_').ToStdString();
+	strutil::replaceIP(job.timestamp, ":", "");
 
 	// Filter ignored entries
-	vector<ArchiveEntry*> backup_entries;
 	for (auto& entry : map_data)
 	{
 		// Check for ignored entry
@@ -101,72 +222,169 @@ bool MapBackupManager::writeBackup(
 			}
 		}
 
+		// Entry data is shared rather than copied here, the background write
+		// only reads it
 		if (!ignored)
-			backup_entries.push_back(entry.get());
+			job.lumps.emplace_back(entry->name(), entry->data());
 	}
 
-	// Compare with last backup (if any)
-	auto map_dir = backup->dirAtPath(map_name);
-	if (map_dir && map_dir->numSubdirs() > 0)
+	if (job.lumps.empty())
+		return false;
+
+	// Queue backup to be written
+	std::lock_guard lock(mutex_);
+	pending_.push_back(std::move(job));
+	if (!writing_)
+	{
+		writing_ = true;
+		threadpool::enqueue([this]() { writePending(); });
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Waits for any queued backups to finish being written
+// -----------------------------------------------------------------------------
+void MapBackupManager::waitForWrites()
+{
+	std::unique_lock lock(mutex_);
+	cv_writes_done_.wait(lock, [this] { return !writing_; });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the timestamps of all backups for [map_name] in [archive_name], from
+// oldest to newest
+// -----------------------------------------------------------------------------
+vector<string> MapBackupManager::backups(string_view archive_name, string_view map_name)
+{
+	waitForWrites();
+	return backupTimestamps(fmt::format("{}/{}", backupDir(archive_name), map_name));
+}
+
+// -----------------------------------------------------------------------------
+// Adds the map data entries of the backup at [timestamp] for [map_name] in
+// [archive_name] to [target]
+// -----------------------------------------------------------------------------
+bool MapBackupManager::loadBackup(
+	string_view archive_name,
+	string_view map_name,
+	string_view timestamp,
+	Archive&    target) const
+{
+	auto map_dir = fmt::format("{}/{}", backupDir(archive_name), map_name);
+	auto lumps   = readManifest(fmt::format("{}/{}.txt", map_dir, timestamp));
+	if (lumps.empty())
+		return false;
+
+	for (const auto& lump : lumps)
 	{
-		auto last_backup = map_dir->subdirAt(map_dir->numSubdirs() - 1);
-		bool same        = true;
-		if (last_backup->numEntries() != backup_entries.size())
-			same = false;
-		else
+		MemChunk compressed, data;
+		if (!compressed.importFile(fmt::format("{}/data/{}", map_dir, lump.dataFile()))
+			|| !compression::zlibInflate(compressed, data, lump.size))
 		{
-			for (unsigned a = 0; a < last_backup->numEntries(); a++)
+			log::error("Unable to read lump {} of map backup {}", lump.name, timestamp);
+			return false;
+		}
+
+		auto entry = std::make_shared<ArchiveEntry>(lump.name);
+		entry->importMemChunk(data);
+		target.addEntry(entry, "");
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the single zip file that map backups for [archive_name]
+// were stored in by older versions
+// -----------------------------------------------------------------------------
+string MapBackupManager::legacyBackupFile(string_view archive_name)
+{
+	return backupDir(archive_name) + ".zip";
+}
+
+// -----------------------------------------------------------------------------
+// Writes all queued backups, called on a worker thread.
+// Each backup is a manifest listing its lumps, with the lump data stored
+// (compressed) by content in a shared data dir. This means a backup only needs
+// to write the lumps that changed since any previous backup, regardless of how
+// many backups there are
+// -----------------------------------------------------------------------------
+void MapBackupManager::writePending()
+{
+	while (true)
+	{
+		BackupJob job;
+		{
+			std::lock_guard lock(mutex_);
+			if (pending_.empty())
 			{
-				auto e1 = backup_entries[a];
-				auto e2 = last_backup->entryAt(a);
-				if (e1->size() != e2->size())
-				{
-					same = false;
-					break;
-				}
-
-				uint32_t crc1 = misc::crc(e1->rawData(), e1->size());
-				uint32_t crc2 = misc::crc(e2->rawData(), e2->size());
-				if (crc1 != crc2)
-				{
-					same = false;
-					break;
-				}
+				writing_ = false;
+				cv_writes_done_.notify_all();
+				return;
 			}
+
+			job = std::move(pending_.front());
+			pending_.pop_front();
 		}
 
-		if (same)
+		// Create backup directories if needed
+		std::error_code ec;
+		std::filesystem::create_directories(job.dir + "/data", ec);
+		if (ec)
+		{
+			log::warning("Warning: Unable to create map backup directory \"{}\"", job.dir);
+			continue;
+		}
+
+		// Build manifest
+		vector<BackupLump> lumps;
+		for (auto& [name, data] : job.lumps)
+			lumps.push_back({ name, data.size(), misc::crc(data.data(), data.size()) });
+
+		// Compare with last backup (if any)
+		auto timestamps = backupTimestamps(job.dir);
+		if (!timestamps.empty() && readManifest(fmt::format("{}/{}.txt", job.dir, timestamps.back())) == lumps)
 		{
 			log::info(2, "Same data as previous backup - ignoring");
-			return true;
+			continue;
 		}
-	}
 
-	// Add map data to backup
-	auto timestamp = wxDateTime::Now().FormatISOCombined('_').ToStdString();
-	strutil::replaceIP(timestamp, ":", "");
-	auto dir = fmt::format("{}/{}", map_name, timestamp);
-	for (auto& entry : backup_entries)
-		backup->addEntry(std::make_shared<ArchiveEntry>(*entry), dir);
+		// Write any lump data not already stored
+		bool ok = true;
+		for (unsigned a = 0; a < lumps.size(); a++)
+		{
+			auto path = fmt::format("{}/data/{}", job.dir, lumps[a].dataFile());
+			if (fileutil::fileExists(path))
+				continue;
 
-	// Check for max backups & remove old ones if over
-	map_dir = backup->dirAtPath(map_name);
-	while ((int)map_dir->numSubdirs() > max_map_backups)
-		backup->removeDir(map_dir->subdirAt(0)->name(), map_dir);
+			MemChunk compressed;
+			if (!compression::zlibDeflate(job.lumps[a].second, compressed) || !compressed.exportFile(path))
+			{
+				fileutil::removeFile(path);
+				ok = false;
+				break;
+			}
+		}
 
-	// Save backup file
-	Archive::save_backup = false;
-	bool ok              = backup->save();
-	Archive::save_backup = true;
+		// Write manifest (last, so the backup only exists once complete)
+		if (!ok || !writeManifest(fmt::format("{}/{}.txt", job.dir, job.timestamp), lumps))
+		{
+			log::warning("Warning: Failed to backup map data");
+			continue;
+		}
 
-	return ok;
+		// Check for max backups & remove old ones if over
+		rotateBackups(job.dir);
+	}
 }
 
 // -----------------------------------------------------------------------------
 // Shows the map backups for [map_name] in [archive_name], returns the selected
 // map backup data in a WadArchive
 // -----------------------------------------------------------------------------
-Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_name) const
+Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_name)
 {
 	SDialog dlg(mapeditor::windowWx(), fmt::format("Restore {} backup", map_name), "map_backup", 500, 400);
 	auto    sizer = new wxBoxSizer(wxVERTICAL);
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 namespace slade
 {
 class ArchiveEntry;
@@ -10,7 +14,30 @@ public:
 	MapBackupManager()  = default;
 	~MapBackupManager() = default;
 
-	bool writeBackup(vector<unique_ptr<ArchiveEntry>>& map_data, string_view archive_name, string_view map_name) const;
-	Archive* openBackup(string_view archive_name, string_view map_name) const;
+	bool writeBackup(vector<unique_ptr<ArchiveEntry>>& map_data, string_view archive_name, string_view map_name);
+	void waitForWrites();
+
+	vector<string> backups(string_view archive_name, string_view map_name);
+	bool           loadBackup(string_view archive_name, string_view map_name, string_view timestamp, Archive& target)
+		const;
+	Archive* openBackup(string_view archive_name, string_view map_name);
+
+	static string legacyBackupFile(string_view archive_name);
+
+private:
+	// A map backup waiting to be written
+	struct BackupJob
+	{
+		string                              dir;
+		string                              timestamp;
+		vector<std::pair<string, MemChunk>> lumps;
+	};
+
+	std::deque<BackupJob>   pending_;
+	bool                    writing_ = false;
+	std::mutex              mutex_;
+	std::condition_variable cv_writes_done_;
+
+	void writePending();
 };
 } // namespace slade
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapChecks.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "Game/ThingType.h"
 #include "General/SAction.h"
@@ -42,6 +43,7 @@
 #include "UI/Dialogs/ThingTypeBrowser.h"
 #include "Utility/MathStuff.h"
 #include "Utility/StringUtils.h"
+#include <numeric>
 
 using namespace slade;
 
@@ -78,6 +80,107 @@ std::map<MapCheck::StandardCheck, StandardCheckInfo> std_checks = {
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns all pairs of indices into [boxes] where the boxes overlap (or touch),
+// with the lower index first in each pair, sorted by first then second index.
+// The boxes are swept along the x axis so that only boxes near each other are
+// compared
+// -----------------------------------------------------------------------------
+vector<std::pair<unsigned, unsigned>> overlappingBoxPairs(const vector<BBox>& boxes)
+{
+	vector<unsigned> order(boxes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(
+		order.begin(), order.end(), [&boxes](unsigned a, unsigned b) { return boxes[a].min.x < boxes[b].min.x; });
+
+	vector<std::pair<unsigned, unsigned>> pairs;
+	for (unsigned a = 0; a < order.size(); a++)
+	{
+		const auto& box1 = boxes[order[a]];
+		for (unsigned b = a + 1; b < order.size(); b++)
+		{
+			// Boxes further along can't overlap once one starts after [box1]
+			const auto& box2 = boxes[order[b]];
+			if (box2.min.x > box1.max.x)
+				break;
+
+			if (box2.min.y <= box1.max.y && box2.max.y >= box1.min.y)
+				pairs.emplace_back(std::min(order[a], order[b]), std::max(order[a], order[b]));
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	return pairs;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a list of flags for each object in [problems], true if the object is
+// in [objects]
+// -----------------------------------------------------------------------------
+template<typename T>
+vector<bool> problemsWith(const vector<T*>& problems, const std::unordered_set<MapObject*>& objects)
+{
+	vector<bool> flagged(problems.size());
+	for (unsigned a = 0; a < problems.size(); a++)
+		flagged[a] = objects.count(problems[a]) > 0;
+	return flagged;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all items in [list] with a matching true value in [flagged]
+// -----------------------------------------------------------------------------
+template<typename T> void eraseFlagged(vector<T>& list, const vector<bool>& flagged)
+{
+	unsigned count = 0;
+	for (unsigned a = 0; a < list.size(); a++)
+		if (!flagged[a])
+			list[count++] = list[a];
+	list.resize(count);
+}
+
+// -----------------------------------------------------------------------------
+// Caches the result of looking up each distinct texture name (by its
+// case-insensitive id), so that names shared by many objects are only looked
+// up once per check
+// -----------------------------------------------------------------------------
+class MissingTextureCache
+{
+public:
+	void clear() { state_.clear(); }
+
+	// Returns true if [name] is missing, calling [is_missing] to look it up
+	// if it hasn't been already
+	template<typename F> bool missing(const TextureName& name, F is_missing)
+	{
+		auto id = name.idCI();
+		if (id >= state_.size())
+			state_.resize(id + 1, Unchecked);
+		if (state_[id] == Unchecked)
+			state_[id] = is_missing(name) ? Missing : Found;
+
+		return state_[id] == Missing;
+	}
+
+private:
+	enum State : uint8_t
+	{
+		Unchecked,
+		Found,
+		Missing
+	};
+
+	vector<uint8_t> state_;
+};
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 // MissingTextureCheck Class
 //
@@ -88,77 +191,105 @@ class MissingTextureCheck : public MapCheck
 public:
 	MissingTextureCheck(SLADEMap* map) : MapCheck(map) {}
 
-	void doCheck() override
+	void checkLine(MapLine* line, const TextureName& sky_flat)
 	{
-		string sky_flat = game::configuration().skyFlat();
-		for (unsigned a = 0; a < map_->nLines(); a++)
+		auto side1 = line->s1();
+		auto side2 = line->s2();
+
+		// Nothing to check if no textures are blank (so the line's heights
+		// don't need to be compared)
+		auto blank = [this](MapSide* side) {
+			return side
+				   && (side->texUpper() == tex_none_ || side->texMiddle() == tex_none_
+					   || side->texLower() == tex_none_);
+		};
+		if (!blank(side1) && !blank(side2))
+			return;
+
+		// Check what textures the line needs
+		int needs = line->needsTexture();
+
+		// Detect if sky hack might apply
+		bool sky_hack = false;
+		if (side1 && side1->sector()->ceiling().texture.equalCI(sky_flat) && side2
+			&& side2->sector()->ceiling().texture.equalCI(sky_flat))
+			sky_hack = true;
+
+		// Check for missing textures (front side)
+		if (side1)
 		{
-			// Check what textures the line needs
-			auto line  = map_->line(a);
-			auto side1 = line->s1();
-			auto side2 = line->s2();
-			int  needs = line->needsTexture();
-
-			// Detect if sky hack might apply
-			bool sky_hack = false;
-			if (side1 && strutil::equalCI(sky_flat, side1->sector()->ceiling().texture) && side2
-				&& strutil::equalCI(sky_flat, side2->sector()->ceiling().texture))
-				sky_hack = true;
-
-			// Check for missing textures (front side)
-			if (side1)
+			// Upper
+			if ((needs & MapLine::Part::FrontUpper) > 0 && side1->texUpper() == tex_none_ && !sky_hack)
 			{
-				// Upper
-				if ((needs & MapLine::Part::FrontUpper) > 0 && side1->texUpper() == MapSide::TEX_NONE && !sky_hack)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontUpper);
-				}
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontUpper);
+			}
 
-				// Middle
-				if ((needs & MapLine::Part::FrontMiddle) > 0 && side1->texMiddle() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontMiddle);
-				}
+			// Middle
+			if ((needs & MapLine::Part::FrontMiddle) > 0 && side1->texMiddle() == tex_none_)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontMiddle);
+			}
 
-				// Lower
-				if ((needs & MapLine::Part::FrontLower) > 0 && side1->texLower() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontLower);
-				}
+			// Lower
+			if ((needs & MapLine::Part::FrontLower) > 0 && side1->texLower() == tex_none_)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontLower);
 			}
+		}
 
-			// Check for missing textures (back side)
-			if (side2)
+		// Check for missing textures (back side)
+		if (side2)
+		{
+			// Upper
+			if ((needs & MapLine::Part::BackUpper) > 0 && side2->texUpper() == tex_none_ && !sky_hack)
 			{
-				// Upper
-				if ((needs & MapLine::Part::BackUpper) > 0 && side2->texUpper() == MapSide::TEX_NONE && !sky_hack)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackUpper);
-				}
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackUpper);
+			}
 
-				// Middle
-				if ((needs & MapLine::Part::BackMiddle) > 0 && side2->texMiddle() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackMiddle);
-				}
+			// Middle
+			if ((needs & MapLine::Part::BackMiddle) > 0 && side2->texMiddle() == tex_none_)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackMiddle);
+			}
 
-				// Lower
-				if ((needs & MapLine::Part::BackLower) > 0 && side2->texLower() == MapSide::TEX_NONE)
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackLower);
-				}
+			// Lower
+			if ((needs & MapLine::Part::BackLower) > 0 && side2->texLower() == tex_none_)
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackLower);
 			}
 		}
+	}
+
+	void doCheck() override
+	{
+		lines_.clear();
+		parts_.clear();
+
+		TextureName sky_flat{ game::configuration().skyFlat() };
+		for (unsigned a = 0; a < map_->nLines(); a++)
+			checkLine(map_->line(a), sky_flat);
 
 		log::info(3, "Missing Texture Check: {} missing textures", parts_.size());
 	}
 
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		auto flagged = problemsWith(lines_, objects);
+		eraseFlagged(lines_, flagged);
+		eraseFlagged(parts_, flagged);
+
+		TextureName sky_flat{ game::configuration().skyFlat() };
+		for (unsigned a = 0; a < map_->nLines(); a++)
+			if (objects.count(map_->line(a)))
+				checkLine(map_->line(a), sky_flat);
+	}
+
 	unsigned nProblems() override { return lines_.size(); }
 
 	string texName(int part) const
@@ -247,6 +378,7 @@ public:
 private:
 	vector<MapLine*> lines_;
 	vector<int>      parts_;
+	TextureName      tex_none_{ MapSide::TEX_NONE };
 };
 
 
@@ -261,48 +393,76 @@ class SpecialTagsCheck : public MapCheck
 public:
 	SpecialTagsCheck(SLADEMap* map) : MapCheck(map) {}
 
-	void doCheck() override
+	void checkLine(MapLine* line)
 	{
 		using game::TagType;
 
-		for (auto& line : map_->lines())
-		{
-			if (line->special() == 0)
-				continue;
+		if (line->special() == 0)
+			return;
 
-			// Get action special
-			auto tagged = game::configuration().actionSpecial(line->special()).needsTag();
+		// Get action special
+		auto tagged = game::configuration().actionSpecial(line->special()).needsTag();
 
-			// Check for back sector that removes need for tagged sector
-			if ((tagged == TagType::Back || tagged == TagType::SectorOrBack) && line->backSector())
-				continue;
+		// Check for back sector that removes need for tagged sector
+		if ((tagged == TagType::Back || tagged == TagType::SectorOrBack) && line->backSector())
+			return;
 
-			// Check if tag is required but not set
-			if (tagged != TagType::None && line->arg(0) == 0)
-				objects_.push_back(line);
-		}
-		// Hexen and UDMF allow specials on things
-		if (map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF)
-		{
+		// Check if tag is required but not set
+		if (tagged != TagType::None && line->arg(0) == 0)
+			objects_.push_back(line);
+	}
+
+	void checkThing(MapThing* thing)
+	{
+		using game::TagType;
+
+		// Ignore the Heresiarch which does not have a real special
+		auto& tt = game::configuration().thingType(thing->type());
+		if (tt.flags() & game::ThingType::Flags::Script)
+			return;
+
+		// Get special and tag
+		int special = thing->special();
+		int tag     = thing->arg(0);
+
+		// Get action special
+		auto tagged = game::configuration().actionSpecial(special).needsTag();
+
+		// Check if tag is required but not set
+		if (tagged != TagType::None && tagged != TagType::Back && tag == 0)
+			objects_.push_back(thing);
+	}
+
+	// Hexen and UDMF allow specials on things
+	bool thingSpecials() const
+	{
+		return map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF;
+	}
+
+	void doCheck() override
+	{
+		objects_.clear();
+
+		for (auto& line : map_->lines())
+			checkLine(line);
+
+		if (thingSpecials())
 			for (unsigned a = 0; a < map_->nThings(); ++a)
-			{
-				// Ignore the Heresiarch which does not have a real special
-				auto& tt = game::configuration().thingType(map_->thing(a)->type());
-				if (tt.flags() & game::ThingType::Flags::Script)
-					continue;
+				checkThing(map_->thing(a));
+	}
 
-				// Get special and tag
-				int special = map_->thing(a)->special();
-				int tag     = map_->thing(a)->arg(0);
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		eraseFlagged(objects_, problemsWith(objects_, objects));
 
-				// Get action special
-				auto tagged = game::configuration().actionSpecial(special).needsTag();
+		for (auto& line : map_->lines())
+			if (objects.count(line))
+				checkLine(line);
 
-				// Check if tag is required but not set
-				if (tagged != TagType::None && tagged != TagType::Back && tag == 0)
-					objects_.push_back(map_->thing(a));
-			}
-		}
+		if (thingSpecials())
+			for (unsigned a = 0; a < map_->nThings(); ++a)
+				if (objects.count(map_->thing(a)))
+					checkThing(map_->thing(a));
 	}
 
 	unsigned nProblems() override { return objects_.size(); }
@@ -368,6 +528,8 @@ public:
 	{
 		using game::TagType;
 
+		objects_.clear();
+
 		unsigned nlines  = map_->nLines();
 		unsigned nthings = 0;
 		if (map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF)
@@ -495,28 +657,25 @@ public:
 
 	void checkIntersections(vector<MapLine*> lines)
 	{
-		Vec2d    pos;
-		MapLine* line1;
-		MapLine* line2;
+		Vec2d pos;
 
 		// Clear existing intersections
 		intersections_.clear();
 
-		// Go through lines
+		// Get line bounding boxes
+		vector<BBox> boxes(lines.size());
 		for (unsigned a = 0; a < lines.size(); a++)
 		{
-			line1 = lines[a];
-
-			// Go through uncompared lines
-			for (unsigned b = a + 1; b < lines.size(); b++)
-			{
-				line2 = lines[b];
-
-				// Check intersection
-				if (line1->intersects(line2, pos))
-					intersections_.emplace_back(line1, line2, pos.x, pos.y);
-			}
+			auto seg     = lines[a]->seg();
+			boxes[a].min = { std::min(seg.x1(), seg.x2()), std::min(seg.y1(), seg.y2()) };
+			boxes[a].max = { std::max(seg.x1(), seg.x2()), std::max(seg.y1(), seg.y2()) };
 		}
+
+		// Check intersection of each pair of lines with overlapping bounding
+		// boxes (lines can't intersect otherwise)
+		for (auto [a, b] : overlappingBoxPairs(boxes))
+			if (lines[a]->intersects(lines[b], pos))
+				intersections_.emplace_back(lines[a], lines[b], pos.x, pos.y);
 	}
 
 	void doCheck() override
@@ -530,6 +689,39 @@ public:
 		checkIntersections(all_lines);
 	}
 
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		// Remove intersections involving re-checked lines
+		auto removed = std::remove_if(
+			intersections_.begin(), intersections_.end(), [&objects](const Intersection& intersection) {
+				return objects.count(intersection.line1) || objects.count(intersection.line2);
+			});
+		intersections_.erase(removed, intersections_.end());
+
+		// Check re-checked lines against any lines near them
+		Vec2d pos;
+		for (unsigned a = 0; a < map_->nLines(); a++)
+		{
+			auto line1 = map_->line(a);
+			if (!objects.count(line1))
+				continue;
+
+			auto seg = line1->seg();
+			for (auto line2 : map_->lines().allInBox({ seg.left(), seg.top() }, { seg.right(), seg.bottom() }))
+			{
+				// Pairs of re-checked lines only need checking once
+				if (line2 == line1 || (objects.count(line2) && line2->index() < line1->index()))
+					continue;
+
+				// Check intersection (in line index order, as in a full check)
+				auto first  = line1->index() < line2->index() ? line1 : line2;
+				auto second = first == line1 ? line2 : line1;
+				if (first->intersects(second, pos))
+					intersections_.emplace_back(first, second, pos.x, pos.y);
+			}
+		}
+	}
+
 	unsigned nProblems() override { return intersections_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -642,20 +834,60 @@ public:
 
 	void doCheck() override
 	{
+		overlaps_.clear();
+
+		auto vertices_key = [](MapLine* line) {
+			return std::make_pair(std::min(line->v1(), line->v2()), std::max(line->v1(), line->v2()));
+		};
+
+		// Group lines by their (unordered) vertices, in index order
+		std::map<std::pair<MapVertex*, MapVertex*>, vector<MapLine*>> vertex_lines;
+		for (unsigned a = 0; a < map_->nLines(); a++)
+			vertex_lines[vertices_key(map_->line(a))].push_back(map_->line(a));
+
 		// Go through lines
 		for (unsigned a = 0; a < map_->nLines(); a++)
 		{
 			auto line1 = map_->line(a);
 
-			// Go through uncompared lines
-			for (unsigned b = a + 1; b < map_->nLines(); b++)
+			// Any later lines with the same vertices overlap (both vertices shared)
+			auto& group = vertex_lines[vertices_key(line1)];
+			auto  line2 = std::find(group.begin(), group.end(), line1);
+			for (++line2; line2 != group.end(); ++line2)
+				overlaps_.emplace_back(line1, *line2);
+		}
+	}
+
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		// Remove overlaps involving re-checked lines
+		auto removed = std::remove_if(overlaps_.begin(), overlaps_.end(), [&objects](const Overlap& overlap) {
+			return objects.count(overlap.line1) || objects.count(overlap.line2);
+		});
+		overlaps_.erase(removed, overlaps_.end());
+
+		// Check re-checked lines against other lines sharing their first vertex
+		for (unsigned a = 0; a < map_->nLines(); a++)
+		{
+			auto line1 = map_->line(a);
+			if (!objects.count(line1) || !line1->v1())
+				continue;
+
+			for (auto line2 : line1->v1()->connectedLines())
 			{
-				auto line2 = map_->line(b);
+				// Pairs of re-checked lines only need checking once
+				if (line2 == line1 || (objects.count(line2) && line2->index() < line1->index()))
+					continue;
 
 				// Check for overlap (both vertices shared)
 				if ((line1->v1() == line2->v1() && line1->v2() == line2->v2())
 					|| (line1->v2() == line2->v1() && line1->v1() == line2->v2()))
-					overlaps_.emplace_back(line1, line2);
+				{
+					if (line1->index() < line2->index())
+						overlaps_.emplace_back(line1, line2);
+					else
+						overlaps_.emplace_back(line2, line1);
+				}
 			}
 		}
 	}
@@ -745,152 +977,215 @@ class ThingsOverlapCheck : public MapCheck
 public:
 	ThingsOverlapCheck(SLADEMap* map) : MapCheck(map) {}
 
+	// Returns true if the flags of [thing1] and [thing2] mean that an overlap
+	// between them should be reported
+	bool isConflict(MapThing* thing1, MapThing* thing2, const game::ThingType& tt1, const game::ThingType& tt2) const
+	{
+		// Check flags
+		// Case #1: different skill levels
+		bool shareflag = false;
+		for (int s = min_skill_; s < max_skill_; ++s)
+		{
+			auto skill = fmt::format("skill{}", s);
+			if (game::configuration().thingBasicFlagSet(skill, thing1, map_format_)
+				&& game::configuration().thingBasicFlagSet(skill, thing2, map_format_))
+			{
+				shareflag = true;
+				s         = max_skill_;
+			}
+		}
+		if (!shareflag)
+			return false;
+
+		// Booleans for single, coop, deathmatch, and teamgame status for each thing
+		bool s1, s2, c1, c2, d1, d2, t1, t2;
+		s1 = game::configuration().thingBasicFlagSet("single", thing1, map_format_);
+		s2 = game::configuration().thingBasicFlagSet("single", thing2, map_format_);
+		c1 = game::configuration().thingBasicFlagSet("coop", thing1, map_format_);
+		c2 = game::configuration().thingBasicFlagSet("coop", thing2, map_format_);
+		d1 = game::configuration().thingBasicFlagSet("dm", thing1, map_format_);
+		d2 = game::configuration().thingBasicFlagSet("dm", thing2, map_format_);
+		t1 = t2 = false;
+
+		// Player starts
+		// P1 are automatically S and C; P2+ are automatically C;
+		// Deathmatch starts are automatically D, and team start are T.
+		if (tt1.flags() & game::ThingType::Flags::CoOpStart)
+		{
+			c1 = true;
+			d1 = t1 = false;
+			if (thing1->type() == 1)
+				s1 = true;
+			else
+				s1 = false;
+		}
+		else if (tt1.flags() & game::ThingType::Flags::DMStart)
+		{
+			s1 = c1 = t1 = false;
+			d1           = true;
+		}
+		else if (tt1.flags() & game::ThingType::Flags::TeamStart)
+		{
+			s1 = c1 = d1 = false;
+			t1           = true;
+		}
+		if (tt2.flags() & game::ThingType::Flags::CoOpStart)
+		{
+			c2 = true;
+			d2 = t2 = false;
+			if (thing2->type() == 1)
+				s2 = true;
+			else
+				s2 = false;
+		}
+		else if (tt2.flags() & game::ThingType::Flags::DMStart)
+		{
+			s2 = c2 = t2 = false;
+			d2           = true;
+		}
+		else if (tt2.flags() & game::ThingType::Flags::TeamStart)
+		{
+			s2 = c2 = d2 = false;
+			t2           = true;
+		}
+
+		// Case #2: different game modes (single, coop, dm)
+		shareflag = false;
+		if ((c1 && c2) || (d1 && d2) || (t1 && t2))
+		{
+			shareflag = true;
+		}
+		if (!shareflag && s1 && s2)
+		{
+			// Case #3: things flagged for single player with different class filters
+			for (int c = 1; c < max_class_; ++c)
+			{
+				auto pclass = fmt::format("class{}", c);
+				if (game::configuration().thingBasicFlagSet(pclass, thing1, map_format_)
+					&& game::configuration().thingBasicFlagSet(pclass, thing2, map_format_))
+				{
+					shareflag = true;
+					c         = max_class_;
+				}
+			}
+		}
+		if (!shareflag)
+			return false;
+
+		// Also check player start spots in Hexen-style hubs
+		shareflag = false;
+		if (tt1.flags() & game::ThingType::Flags::CoOpStart && tt2.flags() & game::ThingType::Flags::CoOpStart)
+		{
+			if (thing1->arg(0) == thing2->arg(0))
+				shareflag = true;
+		}
+
+		return shareflag;
+	}
+
+	// Sets up the flag checks for the current map format
+	void initFlagChecks()
+	{
+		map_format_ = map_->currentFormat();
+		bool udmf_zdoom =
+			(map_format_ == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "zdoom"));
+		bool udmf_eternity =
+			(map_format_ == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "eternity"));
+		min_skill_ = udmf_zdoom || udmf_eternity ? 1 : 2;
+		max_skill_ = udmf_zdoom ? 17 : 5;
+		max_class_ = udmf_zdoom ? 17 : 4;
+	}
+
 	void doCheck() override
 	{
-		double r1, r2;
+		overlaps_.clear();
+		initFlagChecks();
 
-		// Go through things
+		// Get solid things and their bounding boxes
+		vector<MapThing*> things;
+		vector<BBox>      boxes;
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
-			auto  thing1 = map_->thing(a);
-			auto& tt1    = game::configuration().thingType(thing1->type());
-			r1           = tt1.radius() - 1;
+			auto   thing = map_->thing(a);
+			auto&  tt    = game::configuration().thingType(thing->type());
+			double r     = tt.radius() - 1;
 
 			// Ignore if no radius
-			if (r1 < 0 || !tt1.solid())
+			if (r < 0 || !tt.solid())
 				continue;
 
-			// Go through uncompared things
-			auto map_format = map_->currentFormat();
-			bool udmf_zdoom =
-				(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "zdoom"));
-			bool udmf_eternity =
-				(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "eternity"));
-			int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
-			int max_skill = udmf_zdoom ? 17 : 5;
-			int max_class = udmf_zdoom ? 17 : 4;
-
-			for (unsigned b = a + 1; b < map_->nThings(); b++)
-			{
-				auto  thing2 = map_->thing(b);
-				auto& tt2    = game::configuration().thingType(thing2->type());
-				r2           = tt2.radius() - 1;
+			BBox box;
+			box.min = { thing->xPos() - r, thing->yPos() - r };
+			box.max = { thing->xPos() + r, thing->yPos() + r };
+			things.push_back(thing);
+			boxes.push_back(box);
+		}
 
-				// Ignore if no radius
-				if (r2 < 0 || !tt2.solid())
-					continue;
+		// Go through pairs of things that overlap
+		for (auto [a, b] : overlappingBoxPairs(boxes))
+		{
+			auto& tt1 = game::configuration().thingType(things[a]->type());
+			auto& tt2 = game::configuration().thingType(things[b]->type());
+			if (isConflict(things[a], things[b], tt1, tt2))
+				overlaps_.emplace_back(things[a], things[b]);
+		}
+	}
 
-				// Check flags
-				// Case #1: different skill levels
-				bool shareflag = false;
-				for (int s = min_skill; s < max_skill; ++s)
-				{
-					auto skill = fmt::format("skill{}", s);
-					if (game::configuration().thingBasicFlagSet(skill, thing1, map_format)
-						&& game::configuration().thingBasicFlagSet(skill, thing2, map_format))
-					{
-						shareflag = true;
-						s         = max_skill;
-					}
-				}
-				if (!shareflag)
-					continue;
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		// Remove overlaps involving re-checked things
+		auto removed = std::remove_if(overlaps_.begin(), overlaps_.end(), [&objects](const Overlap& overlap) {
+			return objects.count(overlap.thing1) || objects.count(overlap.thing2);
+		});
+		overlaps_.erase(removed, overlaps_.end());
 
-				// Booleans for single, coop, deathmatch, and teamgame status for each thing
-				bool s1, s2, c1, c2, d1, d2, t1, t2;
-				s1 = game::configuration().thingBasicFlagSet("single", thing1, map_format);
-				s2 = game::configuration().thingBasicFlagSet("single", thing2, map_format);
-				c1 = game::configuration().thingBasicFlagSet("coop", thing1, map_format);
-				c2 = game::configuration().thingBasicFlagSet("coop", thing2, map_format);
-				d1 = game::configuration().thingBasicFlagSet("dm", thing1, map_format);
-				d2 = game::configuration().thingBasicFlagSet("dm", thing2, map_format);
-				t1 = t2 = false;
-
-				// Player starts
-				// P1 are automatically S and C; P2+ are automatically C;
-				// Deathmatch starts are automatically D, and team start are T.
-				if (tt1.flags() & game::ThingType::Flags::CoOpStart)
-				{
-					c1 = true;
-					d1 = t1 = false;
-					if (thing1->type() == 1)
-						s1 = true;
-					else
-						s1 = false;
-				}
-				else if (tt1.flags() & game::ThingType::Flags::DMStart)
-				{
-					s1 = c1 = t1 = false;
-					d1           = true;
-				}
-				else if (tt1.flags() & game::ThingType::Flags::TeamStart)
-				{
-					s1 = c1 = d1 = false;
-					t1           = true;
-				}
-				if (tt2.flags() & game::ThingType::Flags::CoOpStart)
-				{
-					c2 = true;
-					d2 = t2 = false;
-					if (thing2->type() == 1)
-						s2 = true;
-					else
-						s2 = false;
-				}
-				else if (tt2.flags() & game::ThingType::Flags::DMStart)
-				{
-					s2 = c2 = t2 = false;
-					d2           = true;
-				}
-				else if (tt2.flags() & game::ThingType::Flags::TeamStart)
-				{
-					s2 = c2 = d2 = false;
-					t2           = true;
-				}
+		initFlagChecks();
 
-				// Case #2: different game modes (single, coop, dm)
-				shareflag = false;
-				if ((c1 && c2) || (d1 && d2) || (t1 && t2))
-				{
-					shareflag = true;
-				}
-				if (!shareflag && s1 && s2)
-				{
-					// Case #3: things flagged for single player with different class filters
-					for (int c = 1; c < max_class; ++c)
-					{
-						auto pclass = fmt::format("class{}", c);
-						if (game::configuration().thingBasicFlagSet(pclass, thing1, map_format)
-							&& game::configuration().thingBasicFlagSet(pclass, thing2, map_format))
-						{
-							shareflag = true;
-							c         = max_class;
-						}
-					}
-				}
-				if (!shareflag)
-					continue;
+		// Get the largest solid thing radius, to find things that could overlap
+		double max_radius = 0;
+		for (unsigned a = 0; a < map_->nThings(); a++)
+		{
+			auto& tt = game::configuration().thingType(map_->thing(a)->type());
+			if (tt.solid())
+				max_radius = std::max<double>(max_radius, tt.radius() - 1);
+		}
 
-				// Also check player start spots in Hexen-style hubs
-				shareflag = false;
-				if (tt1.flags() & game::ThingType::Flags::CoOpStart && tt2.flags() & game::ThingType::Flags::CoOpStart)
-				{
-					if (thing1->arg(0) == thing2->arg(0))
-						shareflag = true;
-				}
-				if (!shareflag)
+		// Check re-checked things against any things near them
+		for (unsigned a = 0; a < map_->nThings(); a++)
+		{
+			auto thing1 = map_->thing(a);
+			if (!objects.count(thing1))
+				continue;
+
+			auto&  tt1 = game::configuration().thingType(thing1->type());
+			double r1  = tt1.radius() - 1;
+			if (r1 < 0 || !tt1.solid())
+				continue;
+
+			auto range = r1 + max_radius;
+			auto pos   = thing1->position();
+			auto near  = map_->things().allInBox({ pos.x - range, pos.y - range }, { pos.x + range, pos.y + range });
+			for (auto thing2 : near)
+			{
+				// Pairs of re-checked things only need checking once
+				if (thing2 == thing1 || (objects.count(thing2) && thing2->index() < thing1->index()))
 					continue;
 
-				// Check x non-overlap
-				if (thing2->xPos() + r2 < thing1->xPos() - r1 || thing2->xPos() - r2 > thing1->xPos() + r1)
+				auto&  tt2 = game::configuration().thingType(thing2->type());
+				double r2  = tt2.radius() - 1;
+				if (r2 < 0 || !tt2.solid())
 					continue;
 
-				// Check y non-overlap
-				if (thing2->yPos() + r2 < thing1->yPos() - r1 || thing2->yPos() - r2 > thing1->yPos() + r1)
+				// Check x/y non-overlap
+				if (thing2->xPos() + r2 < thing1->xPos() - r1 || thing2->xPos() - r2 > thing1->xPos() + r1
+					|| thing2->yPos() + r2 < thing1->yPos() - r1 || thing2->yPos() - r2 > thing1->yPos() + r1)
 					continue;
 
-				// Overlap detected
-				overlaps_.emplace_back(thing1, thing2);
+				// Check flags (in thing index order, as in a full check)
+				if (thing1->index() < thing2->index() && isConflict(thing1, thing2, tt1, tt2))
+					overlaps_.emplace_back(thing1, thing2);
+				else if (thing2->index() < thing1->index() && isConflict(thing2, thing1, tt2, tt1))
+					overlaps_.emplace_back(thing2, thing1);
 			}
 		}
 	}
@@ -972,6 +1267,11 @@ private:
 		Overlap(MapThing* thing1, MapThing* thing2) : thing1{ thing1 }, thing2{ thing2 } {}
 	};
 	vector<Overlap> overlaps_;
+
+	MapFormat map_format_ = MapFormat::Unknown;
+	int       min_skill_  = 2;
+	int       max_skill_  = 5;
+	int       max_class_  = 4;
 };
 
 
@@ -985,77 +1285,109 @@ class UnknownTexturesCheck : public MapCheck
 public:
 	UnknownTexturesCheck(SLADEMap* map, MapTextureManager* texman) : MapCheck(map), texman_{ texman } {}
 
-	void doCheck() override
+	// Looking up textures can load them (requires the OpenGL context)
+	bool threadSafe() const override { return false; }
+
+	// Returns true if [texture] is set but doesn't exist
+	bool unknown(const TextureName& texture, bool mixed)
 	{
-		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
+		if (texture == MapSide::TEX_NONE)
+			return false;
 
-		// Go through lines
-		for (unsigned a = 0; a < map_->nLines(); a++)
+		return cache_.missing(texture, [this, mixed](const TextureName& name) {
+			return texman_->texture(name, mixed).gl_id == gl::Texture::missingTexture();
+		});
+	}
+
+	void checkLine(MapLine* line, bool mixed)
+	{
+		// Check front side textures
+		if (line->s1())
 		{
-			auto line = map_->line(a);
+			// Get textures
+			auto upper  = line->s1()->texUpper();
+			auto middle = line->s1()->texMiddle();
+			auto lower  = line->s1()->texLower();
 
-			// Check front side textures
-			if (line->s1())
+			// Upper
+			if (unknown(upper, mixed))
 			{
-				// Get textures
-				auto upper  = line->s1()->texUpper();
-				auto middle = line->s1()->texMiddle();
-				auto lower  = line->s1()->texLower();
-
-				// Upper
-				if (upper != "-" && texman_->texture(upper, mixed).gl_id == gl::Texture::missingTexture())
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontUpper);
-				}
-
-				// Middle
-				if (middle != "-" && texman_->texture(middle, mixed).gl_id == gl::Texture::missingTexture())
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontMiddle);
-				}
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontUpper);
+			}
 
-				// Lower
-				if (lower != "-" && texman_->texture(lower, mixed).gl_id == gl::Texture::missingTexture())
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::FrontLower);
-				}
+			// Middle
+			if (unknown(middle, mixed))
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontMiddle);
 			}
 
-			// Check back side textures
-			if (line->s2())
+			// Lower
+			if (unknown(lower, mixed))
 			{
-				// Get textures
-				auto upper  = line->s2()->texUpper();
-				auto middle = line->s2()->texMiddle();
-				auto lower  = line->s2()->texLower();
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::FrontLower);
+			}
+		}
 
-				// Upper
-				if (upper != "-" && texman_->texture(upper, mixed).gl_id == gl::Texture::missingTexture())
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackUpper);
-				}
+		// Check back side textures
+		if (line->s2())
+		{
+			// Get textures
+			auto upper  = line->s2()->texUpper();
+			auto middle = line->s2()->texMiddle();
+			auto lower  = line->s2()->texLower();
 
-				// Middle
-				if (middle != "-" && texman_->texture(middle, mixed).gl_id == gl::Texture::missingTexture())
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackMiddle);
-				}
+			// Upper
+			if (unknown(upper, mixed))
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackUpper);
+			}
 
-				// Lower
-				if (lower != "-" && texman_->texture(lower, mixed).gl_id == gl::Texture::missingTexture())
-				{
-					lines_.push_back(line);
-					parts_.push_back(MapLine::Part::BackLower);
-				}
+			// Middle
+			if (unknown(middle, mixed))
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackMiddle);
+			}
+
+			// Lower
+			if (unknown(lower, mixed))
+			{
+				lines_.push_back(line);
+				parts_.push_back(MapLine::Part::BackLower);
 			}
 		}
 	}
 
+	void doCheck() override
+	{
+		lines_.clear();
+		parts_.clear();
+		cache_.clear();
+
+		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
+
+		// Go through lines
+		for (unsigned a = 0; a < map_->nLines(); a++)
+			checkLine(map_->line(a), mixed);
+	}
+
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		auto flagged = problemsWith(lines_, objects);
+		eraseFlagged(lines_, flagged);
+		eraseFlagged(parts_, flagged);
+		cache_.clear();
+
+		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
+		for (unsigned a = 0; a < map_->nLines(); a++)
+			if (objects.count(map_->line(a)))
+				checkLine(map_->line(a), mixed);
+	}
+
 	unsigned nProblems() override { return lines_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1150,9 +1482,10 @@ public:
 	}
 
 private:
-	MapTextureManager* texman_ = nullptr;
-	vector<MapLine*>   lines_;
-	vector<int>        parts_;
+	MapTextureManager*  texman_ = nullptr;
+	vector<MapLine*>    lines_;
+	vector<int>         parts_;
+	MissingTextureCache cache_;
 };
 
 
@@ -1166,27 +1499,58 @@ class UnknownFlatsCheck : public MapCheck
 public:
 	UnknownFlatsCheck(SLADEMap* map, MapTextureManager* texman) : MapCheck(map), texman_{ texman } {}
 
+	// Looking up textures can load them (requires the OpenGL context)
+	bool threadSafe() const override { return false; }
+
+	// Returns true if [flat] doesn't exist
+	bool unknown(const TextureName& flat, bool mixed)
+	{
+		return cache_.missing(flat, [this, mixed](const TextureName& name) {
+			return texman_->flat(name, mixed).gl_id == gl::Texture::missingTexture();
+		});
+	}
+
+	void checkSector(MapSector* sector, bool mixed)
+	{
+		// Check floor texture
+		if (unknown(sector->floor().texture, mixed))
+		{
+			sectors_.push_back(sector);
+			floor_.push_back(true);
+		}
+
+		// Check ceiling texture
+		if (unknown(sector->ceiling().texture, mixed))
+		{
+			sectors_.push_back(sector);
+			floor_.push_back(false);
+		}
+	}
+
 	void doCheck() override
 	{
+		sectors_.clear();
+		floor_.clear();
+		cache_.clear();
+
 		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
 
 		// Go through sectors
 		for (unsigned a = 0; a < map_->nSectors(); a++)
-		{
-			// Check floor texture
-			if (texman_->flat(map_->sector(a)->floor().texture, mixed).gl_id == gl::Texture::missingTexture())
-			{
-				sectors_.push_back(map_->sector(a));
-				floor_.push_back(true);
-			}
+			checkSector(map_->sector(a), mixed);
+	}
 
-			// Check ceiling texture
-			if (texman_->flat(map_->sector(a)->ceiling().texture, mixed).gl_id == gl::Texture::missingTexture())
-			{
-				sectors_.push_back(map_->sector(a));
-				floor_.push_back(false);
-			}
-		}
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		auto flagged = problemsWith(sectors_, objects);
+		eraseFlagged(sectors_, flagged);
+		eraseFlagged(floor_, flagged);
+		cache_.clear();
+
+		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
+		for (unsigned a = 0; a < map_->nSectors(); a++)
+			if (objects.count(map_->sector(a)))
+				checkSector(map_->sector(a), mixed);
 	}
 
 	unsigned nProblems() override { return sectors_.size(); }
@@ -1256,9 +1620,10 @@ public:
 	}
 
 private:
-	MapTextureManager* texman_ = nullptr;
-	vector<MapSector*> sectors_;
-	vector<bool>       floor_;
+	MapTextureManager*  texman_ = nullptr;
+	vector<MapSector*>  sectors_;
+	vector<bool>        floor_;
+	MissingTextureCache cache_;
 };
 
 
@@ -1274,6 +1639,7 @@ public:
 
 	void doCheck() override
 	{
+		things_.clear();
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
 			auto& tt = game::configuration().thingType(map_->thing(a)->type());
@@ -1282,6 +1648,14 @@ public:
 		}
 	}
 
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		eraseFlagged(things_, problemsWith(things_, objects));
+		for (auto& thing : map_->things())
+			if (objects.count(thing) && !game::configuration().thingType(thing->type()).defined())
+				things_.push_back(thing);
+	}
+
 	unsigned nProblems() override { return things_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1347,51 +1721,89 @@ class StuckThingsCheck : public MapCheck
 public:
 	StuckThingsCheck(SLADEMap* map) : MapCheck(map) {}
 
-	void doCheck() override
+	// Returns true if [line] blocks things (only if flagged as blocking if it's
+	// 2-sided)
+	bool isBlocking(MapLine* line) const
 	{
-		double radius;
+		return !line->s2() || game::configuration().lineBasicFlagSet("blocking", line, map_->currentFormat());
+	}
 
-		// Get list of lines to check
-		vector<MapLine*> check_lines;
-		MapLine*         line;
-		for (unsigned a = 0; a < map_->nLines(); a++)
-		{
-			line = map_->line(a);
+	void checkThing(MapThing* thing)
+	{
+		auto& tt = game::configuration().thingType(thing->type());
 
-			// Skip if line is 2-sided and not blocking
-			if (line->s2() && !game::configuration().lineBasicFlagSet("blocking", line, map_->currentFormat()))
-				continue;
+		// Skip if not a solid thing
+		if (!tt.solid())
+			return;
 
-			check_lines.push_back(line);
+		double radius = tt.radius() - 1;
+		Rectf  bbox(thing->xPos(), thing->yPos(), radius * 2, radius * 2, 1);
+
+		// Go through lines the thing could be touching (in index order)
+		auto r     = std::abs(radius);
+		auto lines = map_->lines().allInBox(
+			{ thing->xPos() - r, thing->yPos() - r }, { thing->xPos() + r, thing->yPos() + r });
+		for (auto line : lines)
+		{
+			// Check intersection
+			if (isBlocking(line) && math::boxLineIntersect(bbox, line->seg()))
+			{
+				things_.push_back(thing);
+				lines_.push_back(line);
+				return;
+			}
 		}
+	}
+
+	void doCheck() override
+	{
+		things_.clear();
+		lines_.clear();
 
 		// Go through things
 		for (unsigned a = 0; a < map_->nThings(); a++)
-		{
-			auto  thing = map_->thing(a);
-			auto& tt    = game::configuration().thingType(thing->type());
+			checkThing(map_->thing(a));
+	}
+
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		// Get things to re-check, starting with any stuck in re-checked lines
+		std::unordered_set<MapObject*> things;
+		for (unsigned a = 0; a < things_.size(); a++)
+			if (objects.count(things_[a]) || objects.count(lines_[a]))
+				things.insert(things_[a]);
 
-			// Skip if not a solid thing
-			if (!tt.solid())
+		// Add things that could be touching re-checked lines
+		double max_radius = 0;
+		for (auto& thing : map_->things())
+		{
+			auto& tt   = game::configuration().thingType(thing->type());
+			max_radius = std::max<double>(max_radius, std::abs(tt.radius() - 1));
+		}
+		for (auto& line : map_->lines())
+		{
+			if (!objects.count(line))
 				continue;
 
-			radius = tt.radius() - 1;
-			Rectf bbox(thing->xPos(), thing->yPos(), radius * 2, radius * 2, 1);
+			auto seg  = line->seg();
+			auto near = map_->things().allInBox(
+				{ seg.left() - max_radius, seg.top() - max_radius },
+				{ seg.right() + max_radius, seg.bottom() + max_radius });
+			things.insert(near.begin(), near.end());
+		}
 
-			// Go through lines
-			for (auto& check_line : check_lines)
-			{
-				line = check_line;
+		// Add re-checked things
+		for (auto& thing : map_->things())
+			if (objects.count(thing))
+				things.insert(thing);
 
-				// Check intersection
-				if (math::boxLineIntersect(bbox, line->seg()))
-				{
-					things_.push_back(thing);
-					lines_.push_back(line);
-					break;
-				}
-			}
-		}
+		auto flagged = problemsWith(things_, things);
+		eraseFlagged(things_, flagged);
+		eraseFlagged(lines_, flagged);
+
+		for (auto& thing : map_->things())
+			if (things.count(thing))
+				checkThing(thing);
 	}
 
 	unsigned nProblems() override { return things_.size(); }
@@ -1486,6 +1898,7 @@ public:
 	void doCheck() override
 	{
 		// Go through map lines
+		invalid_refs_.clear();
 		for (unsigned a = 0; a < map_->nLines(); a++)
 			checkLine(map_->line(a));
 	}
@@ -1802,31 +2215,55 @@ class UnknownSpecialCheck : public MapCheck
 public:
 	UnknownSpecialCheck(SLADEMap* map) : MapCheck(map) {}
 
+	void checkLine(MapLine* line)
+	{
+		if (game::configuration().actionSpecialName(line->special()) == "Unknown")
+			objects_.push_back(line);
+	}
+
+	void checkThing(MapThing* thing)
+	{
+		// Ignore the Heresiarch which does not have a real special
+		auto& tt = game::configuration().thingType(thing->type());
+		if (tt.flags() & game::ThingType::Flags::Script)
+			return;
+
+		// Otherwise, check special
+		if (game::configuration().actionSpecialName(thing->special()) == "Unknown")
+			objects_.push_back(thing);
+	}
+
+	// In Hexen or UDMF, things can have specials too
+	bool thingSpecials() const
+	{
+		return map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF;
+	}
+
 	void doCheck() override
 	{
 		// Go through map lines
 		objects_.clear();
 		for (unsigned a = 0; a < map_->nLines(); ++a)
-		{
-			int special = map_->line(a)->special();
-			if (game::configuration().actionSpecialName(special) == "Unknown")
-				objects_.push_back(map_->line(a));
-		}
-		// In Hexen or UDMF, go through map things too since they too can have specials
-		if (map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF)
-		{
+			checkLine(map_->line(a));
+
+		// Go through map things
+		if (thingSpecials())
 			for (unsigned a = 0; a < map_->nThings(); ++a)
-			{
-				// Ignore the Heresiarch which does not have a real special
-				auto& tt = game::configuration().thingType(map_->thing(a)->type());
-				if (tt.flags() & game::ThingType::Flags::Script)
-					continue;
+				checkThing(map_->thing(a));
+	}
 
-				// Otherwise, check special
-				if (game::configuration().actionSpecialName(map_->thing(a)->special()) == "Unknown")
-					objects_.push_back(map_->thing(a));
-			}
-		}
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		eraseFlagged(objects_, problemsWith(objects_, objects));
+
+		for (unsigned a = 0; a < map_->nLines(); ++a)
+			if (objects.count(map_->line(a)))
+				checkLine(map_->line(a));
+
+		if (thingSpecials())
+			for (unsigned a = 0; a < map_->nThings(); ++a)
+				if (objects.count(map_->thing(a)))
+					checkThing(map_->thing(a));
 	}
 
 	unsigned nProblems() override { return objects_.size(); }
@@ -1892,17 +2329,27 @@ class ObsoleteThingCheck : public MapCheck
 public:
 	ObsoleteThingCheck(SLADEMap* map) : MapCheck(map) {}
 
+	void checkThing(MapThing* thing)
+	{
+		auto& tt = game::configuration().thingType(thing->type());
+		if (tt.flags() & game::ThingType::Flags::Obsolete)
+			things_.push_back(thing);
+	}
+
 	void doCheck() override
 	{
-		// Go through map lines
+		// Go through map things
 		things_.clear();
 		for (unsigned a = 0; a < map_->nThings(); ++a)
-		{
-			auto  thing = map_->thing(a);
-			auto& tt    = game::configuration().thingType(thing->type());
-			if (tt.flags() & game::ThingType::Flags::Obsolete)
-				things_.push_back(thing);
-		}
+			checkThing(map_->thing(a));
+	}
+
+	void recheckObjects(const std::unordered_set<MapObject*>& objects) override
+	{
+		eraseFlagged(things_, problemsWith(things_, objects));
+		for (unsigned a = 0; a < map_->nThings(); ++a)
+			if (objects.count(map_->thing(a)))
+				checkThing(map_->thing(a));
 	}
 
 	unsigned nProblems() override { return things_.size(); }
@@ -1956,6 +2403,71 @@ private:
 };
 
 
+// -----------------------------------------------------------------------------
+//
+// MapCheck Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the check on only the objects modified since it was last run this way
+// (plus their neighbours), keeping the existing results for everything else.
+// Checks the whole map if the check hasn't been run this way yet, or if any
+// objects were removed (or restored via undo/redo) since then
+// -----------------------------------------------------------------------------
+void MapCheck::doCheckIncremental()
+{
+	const auto& data = map_->mapData();
+	if (checked_time_ == 0 || data.lastRemovedTime() >= checked_time_)
+	{
+		checked_time_ = app::runTimer();
+		doCheck();
+		return;
+	}
+
+	auto modified = data.modifiedObjects(checked_time_, MapObject::Type::Object);
+	checked_time_ = app::runTimer();
+	if (modified.empty())
+		return;
+
+	// Add any objects whose problems could be affected by the modified objects
+	std::unordered_set<MapObject*> objects(modified.begin(), modified.end());
+	for (auto object : modified)
+	{
+		if (object->objType() == MapObject::Type::Vertex)
+		{
+			for (auto line : dynamic_cast<MapVertex*>(object)->connectedLines())
+				objects.insert(line);
+		}
+		else if (object->objType() == MapObject::Type::Side)
+		{
+			auto side = dynamic_cast<MapSide*>(object);
+			if (side->parentLine())
+				objects.insert(side->parentLine());
+			if (side->sector())
+				objects.insert(side->sector());
+		}
+		else if (object->objType() == MapObject::Type::Line)
+		{
+			auto line = dynamic_cast<MapLine*>(object);
+			for (auto side : { line->s1(), line->s2() })
+				if (side && side->sector())
+					objects.insert(side->sector());
+		}
+		else if (object->objType() == MapObject::Type::Sector)
+		{
+			// Lines need re-checking if their sectors' heights or textures change
+			for (auto side : dynamic_cast<MapSector*>(object)->connectedSides())
+				if (side->parentLine())
+					objects.insert(side->parentLine());
+		}
+	}
+
+	recheckObjects(objects);
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // MapCheck Class Static Functions
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_set>
+
 namespace slade
 {
 class SLADEMap;
@@ -42,6 +44,12 @@ public:
 	virtual string     progressText() { return "Checking..."; }
 	virtual string     fixText(unsigned fix_type, unsigned index) { return ""; }
 
+	// Returns true if doCheck can be run on a worker thread, ie. it only reads
+	// the map and game configuration (see SLADEMap::updateCaches)
+	virtual bool threadSafe() const { return true; }
+
+	void doCheckIncremental();
+
 	static unique_ptr<MapCheck> standardCheck(StandardCheck type, SLADEMap* map, MapTextureManager* texman = nullptr);
 	static unique_ptr<MapCheck> standardCheck(string_view type_id, SLADEMap* map, MapTextureManager* texman = nullptr);
 	static string               standardCheckDesc(StandardCheck type);
@@ -49,5 +57,11 @@ public:
 
 protected:
 	SLADEMap* map_;
+	long      checked_time_ = 0; // When the check was last run via doCheckIncremental
+
+	// Re-checks only [objects] (modified since the last check, and their
+	// neighbours), replacing any existing problems involving them. Checks that
+	// can't be done per-object re-check the whole map instead
+	virtual void recheckObjects(const std::unordered_set<MapObject*>& objects) { doCheck(); }
 };
 } // namespace slade
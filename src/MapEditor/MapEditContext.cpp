@@ -34,11 +34,15 @@
 #include "Main.h"
 #include "MapEditContext.h"
 #include "App.h"
+#include "Archive/ArchiveManager.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/Console.h"
+#include "General/Misc.h"
+#include "General/Profiler.h"
 #include "General/UndoRedo.h"
 #include "MapChecks.h"
+#include "MapEditor/Renderer/FrameProfiler.h"
 #include "MapEditor/Renderer/Overlays/InfoOverlay3d.h"
 #include "MapEditor/Renderer/Overlays/LineTextureOverlay.h"
 #include "MapEditor/Renderer/Overlays/QuickTextureOverlay3d.h"
@@ -50,7 +54,9 @@
 #include "UI/MapCanvas.h"
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
+#include "Utility/Polygon2D.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -82,44 +88,6 @@ EXTERN_CVAR(Int, flat_drawtype)
 EXTERN_CVAR(Bool, thing_preview_lights)
 
 
-// -----------------------------------------------------------------------------
-//
-// Functions
-//
-// -----------------------------------------------------------------------------
-
-
-// -----------------------------------------------------------------------------
-// Template function to find something in an associative map.
-// M::mapped_type should be default constructible, or just provide
-// a value for the third argument (the default value if not found).
-// This really only works for value types right now, like maps to pointers.
-// -----------------------------------------------------------------------------
-template<typename M>
-#if defined(_MSC_VER) && (_MSC_VER < 1500)
-// MSVC++ 2005 will give error C2899 if attempting to compile "typename M::mapped_type()".
-typename M::mapped_type findInMap(M& m, const typename M::key_type& k, typename M::mapped_type def = M::mapped_type())
-{
-#else
-// On the other hand, other compilers will fail if this typename isn't there.
-typename M::mapped_type findInMap(
-	M&                          m,
-	const typename M::key_type& k,
-	typename M::mapped_type     def = typename M::mapped_type())
-{
-#endif
-	typename M::iterator i = m.find(k);
-	if (i == m.end())
-	{
-		return const_cast<typename M::mapped_type&>(def);
-	}
-	else
-	{
-		return i->second;
-	}
-}
-
-
 // -----------------------------------------------------------------------------
 //
 // MapEditContext Class Functions
@@ -295,8 +263,10 @@ void MapEditContext::lockMouse(bool lock)
 // -----------------------------------------------------------------------------
 bool MapEditContext::update(long frametime)
 {
-	// Force an update if animations are active
-	if (renderer_.animationsActive() || selection_.hasHilight())
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Update);
+
+	// Force an update if animations are active or textures are waiting to load
+	if (renderer_.animationsActive() || selection_.hasHilight() || mapeditor::textureManager().loadsQueued())
 		next_frame_length_ = 2;
 
 	// Ignore if we aren't ready to update
@@ -344,25 +314,11 @@ bool MapEditContext::update(long frametime)
 	else
 	{
 		// Update hilight if needed
-		auto prev_hl = selection_.hilight();
-		if (input_.mouseState() == mapeditor::Input::MouseState::Normal /* && !mouse_movebegin*/)
-		{
-			auto old_hl = selection_.hilightedObject();
-			if (selection_.updateHilight(input_.mousePosMap(), renderer_.view().scale()) && hilight_smooth)
-				renderer_.animateHilightChange({}, old_hl);
-		}
+		updateHilight();
 
 		// Do item moving if needed
 		if (input_.mouseState() == mapeditor::Input::MouseState::Move)
 			move_objects_.update(input_.mousePosMap());
-
-		// Check if we have to update the info overlay
-		if (selection_.hilight() != prev_hl)
-		{
-			// Update info overlay depending on edit mode
-			updateInfoOverlay();
-			info_showing_ = selection_.hasHilight();
-		}
 	}
 
 	// Update overlay animation (if active)
@@ -375,15 +331,42 @@ bool MapEditContext::update(long frametime)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the hilighted item (2d mode) from the current mouse position, and the
+// info overlay if it changed
+// -----------------------------------------------------------------------------
+void MapEditContext::updateHilight()
+{
+	if (edit_mode_ == Mode::Visual || input_.mouseState() != mapeditor::Input::MouseState::Normal)
+		return;
+
+	auto prev_hl = selection_.hilight();
+	auto old_hl  = selection_.hilightedObject();
+	if (selection_.updateHilight(input_.mousePosMap(), renderer_.view().scale()) && hilight_smooth)
+		renderer_.animateHilightChange({}, old_hl);
+
+	// Update info overlay depending on edit mode
+	if (selection_.hilight() != prev_hl)
+	{
+		updateInfoOverlay();
+		info_showing_ = selection_.hasHilight();
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Opens [map]
 // -----------------------------------------------------------------------------
 bool MapEditContext::openMap(Archive::MapDesc map)
 {
+	PROFILE_ZONE("MapEditContext::openMap");
+
 	log::info("Opening map {}", map.name);
 	if (!map_.readMap(map))
 		return false;
 
+	auto& timings = map_.openTimings();
+	timings.begin("Renderer setup");
+
 	// Find camera thing
 	if (canvas_)
 	{
@@ -409,15 +392,32 @@ bool MapEditContext::openMap(Archive::MapDesc map)
 
 		// Reset rendering data
 		forceRefreshRenderer();
+
+		// Start loading the sprites of all thing types in the map
+		timings.begin("Queue sprites");
+		std::unordered_set<const game::ThingType*> used_types;
+		vector<const game::ThingType*>             types;
+		for (unsigned a = 0; a < map_.nThings(); a++)
+		{
+			auto type = &game::configuration().thingType(map_.thing(a)->type());
+			if (used_types.insert(type).second)
+				types.push_back(type);
+		}
+		mapeditor::textureManager().preloadSprites(types);
 	}
 
 	edit_3d_.setLinked(true, true);
 
+	timings.begin("Thing lists");
 	updateStatusText();
 	updateThingLists();
 
 	// Process specials
+	timings.begin("Process specials");
 	map_.mapSpecials()->processMapSpecials(&(map_));
+	timings.end();
+
+	log::info("Opened map {} in {:1.0f}ms ({})", map.name, timings.totalMs(), timings.summary());
 
 	return true;
 }
@@ -2045,32 +2045,52 @@ bool MapEditContext::handleAction(string_view id)
 // -----------------------------------------------------------------------------
 void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 {
-	// Get sectors and sides to copy
-	vector<MapSector*> copy_sectors;
-	vector<MapSide*>   copy_sides;
+	// Get sectors, sides and vertices to copy, recording the index of each
+	// within the copied lists (so relations can be looked up directly rather
+	// than searched for, both here and when pasting)
+	std::unordered_map<MapSector*, unsigned> sector_indices;
+	std::unordered_map<MapSide*, unsigned>   side_indices;
+	std::unordered_map<MapVertex*, unsigned> vertex_indices;
+	vector<MapSector*>                       copy_sectors;
+	vector<MapSide*>                         copy_sides;
+	vector<MapVertex*>                       copy_verts;
+	double                                   min_x = 9999999;
+	double                                   max_x = -9999999;
+	double                                   min_y = 9999999;
+	double                                   max_y = -9999999;
 	for (auto line : lines)
 	{
-		auto s1 = line->s1();
-		auto s2 = line->s2();
-
-		// Front side
-		if (s1)
+		for (auto side : { line->s1(), line->s2() })
 		{
-			copy_sides.push_back(s1);
-			if (std::find(copy_sectors.begin(), copy_sectors.end(), s1->sector()) == copy_sectors.end())
-				copy_sectors.push_back(s1->sector());
+			if (!side)
+				continue;
+
+			side_indices[side] = copy_sides.size();
+			copy_sides.push_back(side);
+			if (sector_indices.emplace(side->sector(), copy_sectors.size()).second)
+				copy_sectors.push_back(side->sector());
 		}
 
-		// Back side
-		if (s2)
+		for (auto vertex : { line->v1(), line->v2() })
 		{
-			copy_sides.push_back(s2);
-			if (std::find(copy_sectors.begin(), copy_sectors.end(), s2->sector()) == copy_sectors.end())
-				copy_sectors.push_back(s2->sector());
+			if (vertex_indices.emplace(vertex, copy_verts.size()).second)
+				copy_verts.push_back(vertex);
+
+			// Update min/max
+			min_x = std::min(min_x, vertex->xPos());
+			max_x = std::max(max_x, vertex->xPos());
+			min_y = std::min(min_y, vertex->yPos());
+			max_y = std::max(max_y, vertex->yPos());
 		}
 	}
 
+	// Determine midpoint
+	double mid_x = min_x + ((max_x - min_x) * 0.5);
+	double mid_y = min_y + ((max_y - min_y) * 0.5);
+	midpoint_.set(mid_x, mid_y);
+
 	// Copy sectors
+	sectors_.reserve(copy_sectors.size());
 	for (auto& sector : copy_sectors)
 	{
 		auto copy = std::make_unique<MapSector>();
@@ -2079,66 +2099,20 @@ void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 	}
 
 	// Copy sides
+	sides_.reserve(copy_sides.size());
+	side_sectors_.reserve(copy_sides.size());
 	for (auto& side : copy_sides)
 	{
-		auto copy = std::make_unique<MapSide>();
+		auto sector_index = sector_indices[side->sector()];
+		auto copy         = std::make_unique<MapSide>();
 		copy->copy(side);
-
-		// Set relative sector
-		for (unsigned b = 0; b < copy_sectors.size(); b++)
-		{
-			if (side->sector() == copy_sectors[b])
-			{
-				copy->setSector(sectors_[b].get());
-				break;
-			}
-		}
-
+		copy->setSector(sectors_[sector_index].get());
 		sides_.push_back(std::move(copy));
+		side_sectors_.push_back(sector_index);
 	}
 
-	// Get vertices to copy (and determine midpoint)
-	double             min_x = 9999999;
-	double             max_x = -9999999;
-	double             min_y = 9999999;
-	double             max_y = -9999999;
-	vector<MapVertex*> copy_verts;
-	for (auto line : lines)
-	{
-		auto v1 = line->v1();
-		auto v2 = line->v2();
-
-		// Add vertices to copy list
-		if (std::find(copy_verts.begin(), copy_verts.end(), v1) == copy_verts.end())
-			copy_verts.push_back(v1);
-		if (std::find(copy_verts.begin(), copy_verts.end(), v2) == copy_verts.end())
-			copy_verts.push_back(v2);
-
-		// Update min/max
-		if (v1->xPos() < min_x)
-			min_x = v1->xPos();
-		if (v1->xPos() > max_x)
-			max_x = v1->xPos();
-		if (v1->yPos() < min_y)
-			min_y = v1->yPos();
-		if (v1->yPos() > max_y)
-			max_y = v1->yPos();
-		if (v2->xPos() < min_x)
-			min_x = v2->xPos();
-		if (v2->xPos() > max_x)
-			max_x = v2->xPos();
-		if (v2->yPos() < min_y)
-			min_y = v2->yPos();
-		if (v2->yPos() > max_y)
-			max_y = v2->yPos();
-	}
-
-	// Determine midpoint
-	double mid_x = min_x + ((max_x - min_x) * 0.5);
-	double mid_y = min_y + ((max_y - min_y) * 0.5);
-	midpoint_.set(mid_x, mid_y);
-
 	// Copy vertices
+	vertices_.reserve(copy_verts.size());
 	for (auto& vertex : copy_verts)
 	{
 		auto copy = std::make_unique<MapVertex>(vertex->position() - midpoint_);
@@ -2147,48 +2121,24 @@ void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 	}
 
 	// Copy lines
+	lines_.reserve(lines.size());
+	line_refs_.reserve(lines.size());
 	for (auto line : lines)
 	{
-		// Get relative sides
-		MapSide* s1       = nullptr;
-		MapSide* s2       = nullptr;
-		bool     s1_found = false;
-		bool     s2_found = !(line->s2());
-		for (unsigned i = 0; i < copy_sides.size(); i++)
-		{
-			if (line->s1() == copy_sides[i])
-			{
-				s1       = sides_[i].get();
-				s1_found = true;
-			}
-			if (line->s2() == copy_sides[i])
-			{
-				s2       = sides_[i].get();
-				s2_found = true;
-			}
-
-			if (s1_found && s2_found)
-				break;
-		}
-
-		// Get relative vertices
-		MapVertex* v1 = nullptr;
-		MapVertex* v2 = nullptr;
-		for (unsigned i = 0; i < copy_verts.size(); i++)
-		{
-			if (line->v1() == copy_verts[i])
-				v1 = vertices_[i].get();
-			if (line->v2() == copy_verts[i])
-				v2 = vertices_[i].get();
-
-			if (v1 && v2)
-				break;
-		}
-
-		// Copy line
-		auto copy = std::make_unique<MapLine>(v1, v2, s1, s2);
+		LineRefs refs;
+		refs.v1 = vertex_indices[line->v1()];
+		refs.v2 = vertex_indices[line->v2()];
+		refs.s1 = line->s1() ? static_cast<int>(side_indices[line->s1()]) : -1;
+		refs.s2 = line->s2() ? static_cast<int>(side_indices[line->s2()]) : -1;
+
+		auto copy = std::make_unique<MapLine>(
+			vertices_[refs.v1].get(),
+			vertices_[refs.v2].get(),
+			refs.s1 >= 0 ? sides_[refs.s1].get() : nullptr,
+			refs.s2 >= 0 ? sides_[refs.s2].get() : nullptr);
 		copy->copy(line);
 		lines_.push_back(std::move(copy));
+		line_refs_.push_back(refs);
 	}
 }
 
@@ -2210,94 +2160,62 @@ string MapArchClipboardItem::info() const
 // -----------------------------------------------------------------------------
 vector<MapVertex*> MapArchClipboardItem::pasteToMap(SLADEMap* map, Vec2d position)
 {
-	std::map<MapVertex*, MapVertex*> vertMap;
-	std::map<MapSector*, MapSector*> sectMap;
-	std::map<MapSide*, MapSide*>     sideMap;
-	// Not used yet...
-	// std::map<MapLine*, MapLine*> lineMap;
-
 	// Add vertices
 	vector<MapVertex*> new_verts;
+	new_verts.reserve(vertices_.size());
 	for (auto& vertex : vertices_)
 	{
 		new_verts.push_back(map->createVertex(position + vertex->position()));
 		new_verts.back()->copy(vertex.get());
-		vertMap[vertex.get()] = new_verts.back();
 	}
 
 	// Add sectors
+	vector<MapSector*> new_sectors;
+	new_sectors.reserve(sectors_.size());
 	for (auto& sector : sectors_)
 	{
-		auto new_sector = map->createSector();
-		new_sector->copy(sector.get());
-		sectMap[sector.get()] = new_sector;
+		new_sectors.push_back(map->createSector());
+		new_sectors.back()->copy(sector.get());
 	}
 
 	// Add sides
-	// int first_new_side = map->nSides();
-	for (auto& side : sides_)
+	vector<MapSide*> new_sides;
+	new_sides.reserve(sides_.size());
+	for (unsigned a = 0; a < sides_.size(); a++)
 	{
-		// Get relative sector
-		auto sector = findInMap(sectMap, side->sector());
-
-		auto new_side = map->createSide(sector);
-		new_side->copy(side.get());
-		sideMap[side.get()] = new_side;
+		new_sides.push_back(map->createSide(new_sectors[side_sectors_[a]]));
+		new_sides.back()->copy(sides_[a].get());
 	}
 
 	// Add lines
-	// int first_new_line = map->nLines();
-	for (auto& line : lines_)
+	for (unsigned a = 0; a < lines_.size(); a++)
 	{
-		// Get relative vertices
-		auto v1 = findInMap(vertMap, line->v1());
-		auto v2 = findInMap(vertMap, line->v2());
+		auto& refs = line_refs_[a];
 
-		if (!v1)
-		{
-			log::info(1, "no v1");
+		// Lines between new vertices can't already exist, unless the vertices
+		// were merged into existing ones (createVertex returns any existing
+		// vertex at the position)
+		auto newline = map->createLine(new_verts[refs.v1], new_verts[refs.v2], true);
+		if (!newline)
 			continue;
-		}
-		if (!v2)
-		{
-			log::info(1, "no v2");
-		}
-
-		auto newline = map->createLine(v1, v2, true);
-		newline->copy(line.get());
+		newline->copy(lines_[a].get());
 
 		// Set relative sides
-		auto newS1 = findInMap(sideMap, line->s1());
-		auto newS2 = findInMap(sideMap, line->s2());
-		if (newS1)
-			newline->setS1(newS1);
-		if (newS2)
-			newline->setS2(newS2);
+		auto new_s1 = refs.s1 >= 0 ? new_sides[refs.s1] : nullptr;
+		auto new_s2 = refs.s2 >= 0 ? new_sides[refs.s2] : nullptr;
+		if (new_s1)
+			newline->setS1(new_s1);
+		if (new_s2)
+			newline->setS2(new_s2);
 
 		// Set important flags (needed when copying from Doom/Hexen format to UDMF)
 		// Won't be needed when proper map format conversion stuff is implemented
-		game::configuration().setLineBasicFlag("twosided", newline, map->currentFormat(), (newS1 && newS2));
-		game::configuration().setLineBasicFlag("blocking", newline, map->currentFormat(), !newS2);
-	}
-
-	// TODO:
-	// - Split lines
-	// - Merge lines
-
-	//// Fix sector references
-	//// TODO: figure out what lines are 'outside' on copy, only fix said lines
-	// for (unsigned a = first_new_line; a < map->nLines(); a++)
-	//{
-	//	MapLine* line = map->getLine(a);
-	//	MapSector* sec1 = map->getLineSideSector(line, true);
-	//	MapSector* sec2 = map->getLineSideSector(line, false);
-	//	int i1 = -1;
-	//	int i2 = -2;
-	//	if (sec1) i1 = sec1->getIndex();
-	//	if (sec2) i2 = sec2->getIndex();
-	//	map->setLineSector(a, i1, true);
-	//	map->setLineSector(a, i2, false);
-	//}
+		game::configuration().setLineBasicFlag("twosided", newline, map->currentFormat(), (new_s1 && new_s2));
+		game::configuration().setLineBasicFlag("blocking", newline, map->currentFormat(), !new_s2);
+	}
+
+	// Splitting and merging with existing architecture is done afterwards
+	// by SLADEMap::mergeArch
 
 	return new_verts;
 }
@@ -2466,6 +2384,95 @@ CONSOLE_COMMAND(m_check, 0, true)
 }
 
 
+CONSOLE_COMMAND(m_memory, 0, false)
+{
+	auto& context = mapeditor::editContext();
+	auto& map     = context.map();
+
+	auto print = [](string_view category, size_t bytes, string_view info = {}) {
+		log::console(fmt::format(
+			"  {:<22} {:>10}{}",
+			category,
+			misc::sizeAsString(static_cast<uint32_t>(std::min<size_t>(bytes, 0xFFFFFFFF))),
+			info.empty() ? string{} : fmt::format(" ({})", info)));
+	};
+
+	// Map objects (the objects themselves, and their property lists)
+	size_t props = 0;
+
+	auto objects_size = [&props](const auto& list, size_t object_size) {
+		for (const auto& object : list)
+			props += object->props().memoryUsage();
+		return list.size() * object_size;
+	};
+	const auto vertices = objects_size(map.vertices(), sizeof(MapVertex));
+	const auto lines    = objects_size(map.lines(), sizeof(MapLine));
+	const auto sides    = objects_size(map.sides(), sizeof(MapSide));
+	const auto sectors  = objects_size(map.sectors(), sizeof(MapSector));
+	const auto things   = objects_size(map.things(), sizeof(MapThing));
+
+	// Sector polygons
+	size_t polygons = 0;
+	for (const auto& sector : map.sectors())
+		polygons += sector->polygonMemoryUsage();
+
+	// GPU buffers and textures
+	const auto vbo_2d    = context.renderer().renderer2D().vboMemoryUsage();
+	const auto vbo_3d    = context.renderer().renderer3D().vboMemoryUsage();
+	const auto tex_stats = mapeditor::textureManager().memoryStats();
+	const auto textures  = tex_stats.used;
+
+	// Undo history
+	const auto undo_2d = context.undoManager()->memoryUsage();
+	const auto undo_3d = context.edit3D().undoManager()->memoryUsage();
+
+	log::console(fmt::format("Memory usage for map {}:", map.mapName()));
+	print("Vertices", vertices, fmt::format("{}", map.nVertices()));
+	print("Lines", lines, fmt::format("{}", map.nLines()));
+	print("Sides", sides, fmt::format("{}", map.nSides()));
+	print("Sectors", sectors, fmt::format("{}", map.nSectors()));
+	print("Things", things, fmt::format("{}", map.nThings()));
+	print("Object properties", props);
+	print("Sector polygons", polygons);
+	print("VBOs (2d)", vbo_2d);
+	print("VBOs (3d)", vbo_3d);
+	print("Undo history", undo_2d, fmt::format("{} levels", context.undoManager()->nUndoLevels()));
+	print("Undo history (3d)", undo_3d, fmt::format("{} levels", context.edit3D().undoManager()->nUndoLevels()));
+	print(
+		"Textures (GPU)",
+		textures,
+		fmt::format(
+			"{} loaded, {} reduced, {} proxies, {} unloaded, budget {}",
+			tex_stats.loaded,
+			tex_stats.reduced,
+			tex_stats.proxies,
+			tex_stats.evicted,
+			tex_stats.budget > 0 ? fmt::format("{}MB", tex_stats.budget / (1024 * 1024)) : "unlimited"));
+	print(
+		"Total",
+		vertices + lines + sides + sectors + things + props + polygons + vbo_2d + vbo_3d + undo_2d + undo_3d + textures);
+}
+
+CONSOLE_COMMAND(m_timings, 0, false)
+{
+	auto& map = mapeditor::editContext().map();
+
+	auto print = [](string_view title, const PhaseTimer& timings) {
+		if (timings.empty())
+		{
+			log::console(fmt::format("{}: No timings recorded", title));
+			return;
+		}
+
+		log::console(fmt::format("{} ({:1.0f}ms total):", title, timings.totalMs()));
+		for (const auto& phase : timings.phases())
+			log::console(fmt::format("  {:<20} {:8.1f}ms", phase.name, phase.ms));
+	};
+
+	print("Last map open", map.openTimings());
+	print("Last map save", map.saveTimings());
+}
+
 
 
 // testing stuff
@@ -2540,6 +2547,89 @@ CONSOLE_COMMAND(m_n_polys, 0, false)
 	log::console(fmt::format("{} polygons total", npoly));
 }
 
+// Triangulates every sector of every map in all open archives with each
+// polygon split method, and reports the time taken and resulting polygon and
+// triangle counts
+CONSOLE_COMMAND(m_polygon_benchmark, 0, false)
+{
+	struct Result
+	{
+		int64_t  us          = 0;
+		int64_t  max_us      = 0;
+		unsigned n_polys     = 0;
+		unsigned n_triangles = 0;
+		unsigned n_failed    = 0;
+		int      slowest     = -1;
+	};
+
+	auto run = [](SLADEMap& map, Polygon2D::SplitMethod method, Result& total) {
+		Result    result;
+		Polygon2D poly;
+		sf::Clock clock;
+		for (unsigned a = 0; a < map.nSectors(); a++)
+		{
+			clock.restart();
+			const bool ok = poly.openSector(map.sector(a), method);
+			const auto us = clock.getElapsedTime().asMicroseconds();
+
+			result.us += us;
+			if (us > result.max_us)
+			{
+				result.max_us  = us;
+				result.slowest = a;
+			}
+			if (!ok)
+				result.n_failed++;
+			result.n_polys += poly.nSubPolys();
+			for (unsigned p = 0; p < poly.nSubPolys(); p++)
+				result.n_triangles += poly.subPoly(p)->vertices.size() - 2;
+		}
+
+		total.us += result.us;
+		total.n_polys += result.n_polys;
+		total.n_triangles += result.n_triangles;
+		total.n_failed += result.n_failed;
+		return result;
+	};
+	auto report = [](string_view name, const Result& result) {
+		auto info = fmt::format(
+			"  {}: {:1.2f}ms, {} polygons, {} triangles",
+			name,
+			result.us / 1000.,
+			result.n_polys,
+			result.n_triangles);
+		if (result.slowest >= 0)
+			info += fmt::format(" (slowest: sector {}, {:1.2f}ms)", result.slowest, result.max_us / 1000.);
+		if (result.n_failed > 0)
+			info += fmt::format(" ({} failed)", result.n_failed);
+		log::console(info);
+	};
+
+	Result total_splitter, total_triangulator;
+	auto&  manager = app::archiveManager();
+	for (int a = 0; a < manager.numArchives(); a++)
+	{
+		auto archive = manager.getArchive(a);
+		for (const auto& map_desc : archive->detectMaps())
+		{
+			SLADEMap map;
+			if (!map.readMap(map_desc))
+			{
+				log::console(fmt::format("{}: Unable to read map {}", archive->filename(false), map_desc.name));
+				continue;
+			}
+
+			log::console(fmt::format("{}: {} ({} sectors)", archive->filename(false), map_desc.name, map.nSectors()));
+			report("PolygonSplitter", run(map, Polygon2D::SplitMethod::Splitter, total_splitter));
+			report("PolygonTriangulator", run(map, Polygon2D::SplitMethod::Triangulator, total_triangulator));
+		}
+	}
+
+	log::console("Total:");
+	report("PolygonSplitter", total_splitter);
+	report("PolygonTriangulator", total_triangulator);
+}
+
 CONSOLE_COMMAND(mobj_info, 1, false)
 {
 	int id = strutil::asInt(args[0]);
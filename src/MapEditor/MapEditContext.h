@@ -81,6 +81,7 @@ public:
 
 	// Selection/hilight
 	void showItem(int index);
+	void updateHilight();
 	void updateTagged();
 	void selectionUpdated();
 
@@ -243,10 +244,21 @@ public:
 	Vec2d              midpoint() const { return midpoint_; }
 
 private:
+	// Indices of a copied line's vertices and sides within vertices_ and sides_
+	struct LineRefs
+	{
+		unsigned v1 = 0;
+		unsigned v2 = 0;
+		int      s1 = -1;
+		int      s2 = -1;
+	};
+
 	vector<unique_ptr<MapVertex>> vertices_;
 	vector<unique_ptr<MapSide>>   sides_;
 	vector<unique_ptr<MapLine>>   lines_;
 	vector<unique_ptr<MapSector>> sectors_;
+	vector<LineRefs>              line_refs_;    // Parallel to lines_
+	vector<unsigned>              side_sectors_; // Index in sectors_ for each side, parallel to sides_
 	Vec2d                         midpoint_;
 };
 
@@ -36,15 +36,20 @@
 #include "Archive/ArchiveEntry.h"
 #include "Archive/ArchiveManager.h"
 #include "Game/Configuration.h"
+#include "Game/ThingType.h"
+#include "General/EntryPrefetch.h"
 #include "General/Misc.h"
+#include "General/Profiler.h"
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/SImage/SImage.h"
+#include "HiresProxyCache.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "MapEditContext.h"
 #include "MapEditor.h"
 #include "OpenGL/OpenGL.h"
+#include "SLADEMap/MapObject/TextureName.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/StringUtils.h"
 
@@ -61,6 +66,42 @@ namespace
 MapTextureManager::Texture tex_invalid;
 }
 CVAR(Int, map_tex_filter, 0, CVar::Flag::Save)
+CVAR(Bool, map_tex_atlas, false, CVar::Flag::Save)
+CVAR(Int, map_tex_atlas_max, 256, CVar::Flag::Save) // Largest texture width/height to add to an atlas
+CVAR(Bool, map_tex_async, true, CVar::Flag::Save)
+CVAR(Int, map_tex_load_budget, 8, CVar::Flag::Save) // Time (ms) to spend loading queued textures per frame
+CVAR(Int, map_tex_budget, 1024, CVar::Flag::Save)    // GPU memory budget (MB) for textures, 0 for no limit
+CVAR(Int, map_tex_evict_frames, 300, CVar::Flag::Save) // Frames a texture must be unused for before it can be unloaded
+CVAR(Int, map_tex_reduce_dist, 0, CVar::Flag::Save)    // Distance beyond which 3d view textures are reduced, 0 to disable
+CVAR(Bool, map_tex_hires_stream, true, CVar::Flag::Save) // Show large hi-res textures as proxies until needed
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the texture for [name] in [map], using [by_id] (pointers to textures
+// in [map] by TextureName::idCI) so that [map] is only searched the first time
+// -----------------------------------------------------------------------------
+MapTextureManager::Texture& cachedTexture(
+	MapTextureManager::MapTexHashMap&     map,
+	vector<MapTextureManager::Texture*>& by_id,
+	const TextureName&                    name)
+{
+	auto id = name.idCI();
+	if (id >= by_id.size())
+		by_id.resize(id + 1, nullptr);
+
+	if (!by_id[id])
+		by_id[id] = &map[strutil::upper(name)];
+
+	return *by_id[id];
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -85,6 +126,15 @@ void MapTextureManager::init()
 	sc_palette_changed_   = theMainWindow->paletteChooser()->signals().palette_changed.connect(
         [this]() { refreshResources(); });
 
+	// Only refresh what changed when individual resource entries are updated
+	sc_resources_changed_ = app::resources().signals().resources_changed.connect(
+		[this](const ResourceManager::ResourceChange& change) {
+			if (change.palette_changed)
+				refreshResources();
+			else
+				refreshResources(change.names, change.list_changed);
+		});
+
 	// Load palette
 	if (auto pal = resourcePalette(); pal != palette_.get())
 		palette_->copyPalette(pal);
@@ -116,9 +166,23 @@ Palette* MapTextureManager::resourcePalette() const
 // -----------------------------------------------------------------------------
 const MapTextureManager::Texture& MapTextureManager::texture(string_view name, bool mixed)
 {
-	// Get texture matching name
-	auto& mtex = textures_[strutil::upper(name)];
+	return loadTexture(textures_[strutil::upper(name)], name, mixed);
+}
+
+// -----------------------------------------------------------------------------
+// Same as above, but the texture is looked up by [name]'s id rather than by
+// string, which is much quicker (eg. for map textures)
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::texture(const TextureName& name, bool mixed)
+{
+	return loadTexture(cachedTexture(textures_, textures_by_id_, name), name, mixed);
+}
 
+// -----------------------------------------------------------------------------
+// Returns texture [mtex] (for [name]), loading it from resources if necessary
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::loadTexture(Texture& mtex, string_view name, bool mixed)
+{
 	// Get desired filter type
 	auto filter = gl::TexFilter::Linear;
 	if (map_tex_filter == 0)
@@ -142,6 +206,10 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 		mtex.gl_id = 0;
 	}
 
+	// Return placeholder if the texture is waiting to be loaded
+	if (mtex.loading)
+		return placeholder();
+
 	// Texture not found or unloaded, look for it
 
 	// Look for composite textures first
@@ -149,12 +217,26 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 	auto* ctex    = app::resources().getTexture(name, "WallTexture", archive);
 	if (!ctex)
 		ctex = app::resources().getTexture(name, "", archive);
+
+	// Queue to load later if possible
+	vector<ArchiveEntry*> entries;
+	ArchiveEntry*         hires = nullptr;
+	if (!ctex)
+	{
+		hires = app::resources().getHiresEntry(name, archive);
+		if (!hires)
+			entries.push_back(app::resources().getTextureEntry(name, "textures", archive));
+	}
+	if (queueLoad(mtex, { QueuedLoad::Type::Texture, string{ name }, mixed }, entries, hires))
+		return placeholder();
+
 	if (ctex)
 	{
 		SImage image;
 		if (ctex->toImage(image, archive, palette_.get(), true))
 		{
 			mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+			addToAtlas(mtex, image, palette_.get());
 
 			double sx = ctex->scaleX();
 			if (sx == 0.0)
@@ -174,19 +256,17 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 		// HIRES
 		if (auto* etex = app::resources().getHiresEntry(name, archive))
 		{
-			SImage image;
-			if (misc::loadImageFromEntry(&image, etex))
+			Vec2i size;
+			if (loadHires(mtex, etex, filter, size))
 			{
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
-
 				if (auto* ref = app::resources().getTextureEntry(name, "textures", archive))
 				{
 					SImage imgref;
 					if (misc::loadImageFromEntry(&imgref, ref))
 					{
 						int w, h, sw, sh;
-						w                  = image.width();
-						h                  = image.height();
+						w                  = size.x;
+						h                  = size.y;
 						sw                 = imgref.width();
 						sh                 = imgref.height();
 						mtex.world_panning = true;
@@ -202,7 +282,10 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 			SImage image;
 			etex = app::resources().getTextureEntry(name, "textures", archive);
 			if (misc::loadImageFromEntry(&image, etex))
+			{
 				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				addToAtlas(mtex, image, palette_.get());
+			}
 		}
 	}
 
@@ -226,9 +309,23 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 // -----------------------------------------------------------------------------
 const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool mixed)
 {
-	// Get flat matching name
-	auto& mtex = flats_[strutil::upper(name)];
+	return loadFlat(flats_[strutil::upper(name)], name, mixed);
+}
 
+// -----------------------------------------------------------------------------
+// Same as above, but the flat is looked up by [name]'s id rather than by
+// string, which is much quicker (eg. for map flats)
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::flat(const TextureName& name, bool mixed)
+{
+	return loadFlat(cachedTexture(flats_, flats_by_id_, name), name, mixed);
+}
+
+// -----------------------------------------------------------------------------
+// Returns flat [mtex] (for [name]), loading it from resources if necessary
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::loadFlat(Texture& mtex, string_view name, bool mixed)
+{
 	// Get desired filter type
 	auto filter = gl::TexFilter::Linear;
 	if (map_tex_filter == 0)
@@ -252,8 +349,23 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 		mtex.gl_id = 0;
 	}
 
+	// Return placeholder if the flat is waiting to be loaded
+	if (mtex.loading)
+		return placeholder();
+
+	// Queue to load later if possible
+	auto                  archive = archive_.lock().get();
+	vector<ArchiveEntry*> entries = { app::resources().getFlatEntry(name, archive) };
+	if (mixed)
+		entries.push_back(app::resources().getTextureEntry(name, "textures", archive));
+	if (queueLoad(
+			mtex,
+			{ QueuedLoad::Type::Flat, string{ name }, mixed },
+			entries,
+			app::resources().getHiresEntry(name, archive)))
+		return placeholder();
+
 	// Prioritize standalone textures
-	auto archive = archive_.lock().get();
 	if (mixed && app::resources().getTextureEntry(name, "textures", archive))
 	{
 		return texture(name, false);
@@ -268,6 +380,7 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 			if (ctex->toImage(image, archive, palette_.get(), true))
 			{
 				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				addToAtlas(mtex, image, palette_.get());
 
 				double sx = ctex->scaleX();
 				if (sx == 0.0)
@@ -289,29 +402,33 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 	{
 		auto* entry = app::resources().getFlatEntry(name, archive);
 		auto* hires_entry = app::resources().getHiresEntry(name, archive);
-		auto* image_entry = hires_entry;
 		auto* scale_entry = entry;
 		
-		// No high-res texture found
-		if (!image_entry)
+		// Load the image
+		Vec2i size;
+		if (hires_entry)
+			loadHires(mtex, hires_entry, filter, size);
+		else
 		{
-			image_entry = entry;
+			// No high-res texture found
 			scale_entry = nullptr;
+
+			SImage image;
+			if (misc::loadImageFromEntry(&image, entry))
+			{
+				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				addToAtlas(mtex, image, palette_.get());
+			}
 		}
 		
-		// Load the image
-		SImage image;
-		if (misc::loadImageFromEntry(&image, image_entry))
-			mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
-		
 		// Get high-res texture scale
-		if (scale_entry)
+		if (scale_entry && mtex.gl_id)
 		{
 			SImage lores_image;
 			if (misc::loadImageFromEntry(&lores_image, scale_entry))
 			{
-				double scale_x = static_cast<double>(lores_image.width()) / static_cast<double>(image.width());
-				double scale_y = static_cast<double>(lores_image.height()) / static_cast<double>(image.height());
+				double scale_x = static_cast<double>(lores_image.width()) / static_cast<double>(size.x);
+				double scale_y = static_cast<double>(lores_image.height()) / static_cast<double>(size.y);
 				mtex.world_panning = true;
 				mtex.scale = { scale_x, scale_y };
 			}
@@ -395,6 +512,14 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 		if (entry)
 			mirror = true;
 	}
+
+	// Return placeholder if the sprite is waiting to be loaded, or queue to
+	// load later if possible
+	if (mtex.loading
+		|| queueLoad(
+			mtex, { QueuedLoad::Type::Sprite, string{ name }, false, string{ translation }, string{ palette } }, { entry }))
+		return placeholder();
+
 	if (entry)
 	{
 		found = true;
@@ -433,6 +558,7 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 
 		// Turn into GL texture
 		mtex.gl_id = gl::Texture::createFromImage(image, pal, filter, false);
+		addToAtlas(mtex, image, pal);
 		return mtex;
 	}
 	else if (name.back() == '?')
@@ -460,6 +586,100 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 	return tex_invalid;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the sprite for thing [type], from the per-type cache if it was
+// already resolved
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::sprite(const game::ThingType& type)
+{
+	// Check cache
+	auto& cached = sprites_by_type_[&type];
+	if (cached.texture && cached.sprite == type.sprite() && cached.translation == type.translation()
+		&& cached.palette == type.palette())
+	{
+		// Not found
+		if (cached.texture == &tex_invalid)
+			return tex_invalid;
+
+		// Still loaded with the current filter
+		if (cached.texture->gl_id && cached.filter == map_tex_filter)
+			return *cached.texture;
+	}
+
+	// Resolve sprite, and cache it unless it is still waiting to be loaded
+	auto& tex = sprite(type.sprite(), type.translation(), type.palette());
+	if (&tex == &tex_placeholder_ || (&tex != &tex_invalid && !tex.gl_id))
+	{
+		cached.texture = nullptr;
+		return tex;
+	}
+
+	cached.texture     = &tex;
+	cached.filter      = map_tex_filter;
+	cached.sprite      = type.sprite();
+	cached.translation = type.translation();
+	cached.palette     = type.palette();
+
+	return tex;
+}
+
+// -----------------------------------------------------------------------------
+// Starts loading the sprites for all thing [types] (eg. when a map is opened),
+// so they are decoded in the background and loaded over the following frames
+// rather than all at once when the things are first drawn
+// -----------------------------------------------------------------------------
+void MapTextureManager::preloadSprites(const vector<const game::ThingType*>& types)
+{
+	auto queue_enabled  = load_queue_enabled_;
+	load_queue_enabled_ = true;
+	for (auto type : types)
+		sprite(*type);
+	load_queue_enabled_ = queue_enabled;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (approximate) GPU memory used by all currently loaded textures,
+// flats, sprites and editor images, assuming 32bpp RGBA
+// -----------------------------------------------------------------------------
+size_t MapTextureManager::textureMemoryUsage() const
+{
+	size_t total = 0;
+	for (const auto* map : { &textures_, &flats_, &sprites_, &editor_images_ })
+		for (const auto& [name, tex] : *map)
+			if (tex.gl_id > 0)
+				total += gl::Texture::memoryUsage(tex.gl_id);
+
+	for (const auto& page : atlas_pages_)
+		total += static_cast<size_t>(page.size) * page.size * 4;
+
+	return total;
+}
+
+// -----------------------------------------------------------------------------
+// Returns current texture memory usage and budget stats
+// -----------------------------------------------------------------------------
+MapTextureManager::MemoryStats MapTextureManager::memoryStats() const
+{
+	MemoryStats stats;
+	stats.used    = textureMemoryUsage();
+	stats.budget  = map_tex_budget > 0 ? static_cast<size_t>(map_tex_budget) * 1024 * 1024 : 0;
+	stats.evicted = n_evicted_;
+	for (const auto* map : { &textures_, &flats_, &sprites_ })
+		for (const auto& [name, tex] : *map)
+		{
+			if (tex.gl_id == 0)
+				continue;
+
+			stats.loaded++;
+			if (tex.proxy)
+				stats.proxies++;
+			else if (gl::Texture::info(tex.gl_id).reduction > 1)
+				stats.reduced++;
+		}
+
+	return stats;
+}
+
 // -----------------------------------------------------------------------------
 // Detects offset hacks such as that used by the wall torch thing in Heretic.
 // If the Y offset is noticeably larger than the sprite height, that means the
@@ -491,6 +711,482 @@ int MapTextureManager::verticalOffset(string_view name) const
 	return 0;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the placeholder texture, used in place of textures that are queued
+// to be loaded
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapTextureManager::placeholder()
+{
+	if (!tex_placeholder_.gl_id)
+	{
+		// Plain grey
+		vector<uint8_t> data(8 * 8 * 4, 128);
+		for (unsigned a = 3; a < data.size(); a += 4)
+			data[a] = 255;
+		tex_placeholder_.gl_id = gl::Texture::createFromData(data.data(), 8, 8);
+	}
+
+	return tex_placeholder_;
+}
+
+// -----------------------------------------------------------------------------
+// Updates textures for a new frame - loads queued textures, reduces or restores
+// 3d view textures based on distance, and unloads unused textures if over the
+// memory budget.
+// Must be called on the GL thread, before anything is drawn
+// -----------------------------------------------------------------------------
+void MapTextureManager::update()
+{
+	// Anything drawn with the placeholder needs refreshing if textures loaded
+	if (processLoadQueue())
+		stale_textures_.insert(tex_placeholder_.gl_id);
+
+	processStreamQueue();
+	gl::Texture::processUploads();
+	updateResidency();
+
+	// Check memory budget (no need to do this every frame)
+	if (app::runTimer() - budget_checked_ > 500)
+	{
+		evictUnused();
+		budget_checked_ = app::runTimer();
+	}
+
+	gl::Texture::nextFrame();
+}
+
+// -----------------------------------------------------------------------------
+// Loads textures queued by queueLoad, until the time budget for this frame
+// (map_tex_load_budget) is used up. Textures with images still being decoded
+// in the background are skipped until they are ready.
+// Must be called on the GL thread. Returns true if any textures were loaded
+// -----------------------------------------------------------------------------
+bool MapTextureManager::processLoadQueue()
+{
+	PROFILE_ZONE("MapTextureManager::processLoadQueue");
+
+	if (load_queue_.empty())
+		return false;
+
+	auto start      = app::runTimer();
+	bool loaded     = false;
+	loading_queued_ = true;
+	for (auto i = load_queue_.begin(); i != load_queue_.end();)
+	{
+		if (loaded && app::runTimer() - start >= map_tex_load_budget)
+			break;
+
+		// Skip if any images (or hi-res proxies) are still being decoded
+		bool decoding = false;
+		for (const auto& entry : i->entries)
+			if (auto e = entry.lock(); e && entryprefetch::isDecoding(e.get()))
+			{
+				decoding = true;
+				break;
+			}
+		for (const auto& entry : i->proxies)
+			if (auto e = entry.lock(); e && hiresproxy::isPending(e.get()))
+			{
+				decoding = true;
+				break;
+			}
+		if (decoding)
+		{
+			++i;
+			continue;
+		}
+
+		// Load it
+		switch (i->type)
+		{
+		case QueuedLoad::Type::Texture:
+			textures_[strutil::upper(i->name)].loading = false;
+			texture(i->name, i->mixed);
+			break;
+		case QueuedLoad::Type::Flat:
+			flats_[strutil::upper(i->name)].loading = false;
+			flat(i->name, i->mixed);
+			break;
+		case QueuedLoad::Type::Sprite:
+			sprites_[strutil::upper(i->name + i->translation + i->palette)].loading = false;
+			sprite(i->name, i->translation, i->palette);
+			break;
+		}
+
+		// Discard any decoded images that weren't used
+		for (const auto& entry : i->entries)
+			if (auto e = entry.lock())
+				entryprefetch::remove(e.get());
+
+		i      = load_queue_.erase(i);
+		loaded = true;
+	}
+	loading_queued_ = false;
+
+	return loaded;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [mtex] to be loaded by processLoadQueue if async loading is enabled
+// (and the queue is enabled, see enableLoadQueue), and starts decoding any of
+// the image [entries] it will use in the background. If [hires] is given and
+// hi-res streaming is enabled, only its proxy is generated in the background.
+// Returns false if the texture should be loaded immediately instead
+// -----------------------------------------------------------------------------
+bool MapTextureManager::queueLoad(
+	Texture&                     mtex,
+	QueuedLoad                   load,
+	const vector<ArchiveEntry*>& entries,
+	ArchiveEntry*                hires)
+{
+	if (!map_tex_async || !load_queue_enabled_ || loading_queued_ || mtex.deferred)
+		return false;
+
+	for (auto entry : entries)
+	{
+		if (!entry)
+			continue;
+
+		entryprefetch::add(entry);
+		load.entries.push_back(entry->getShared());
+	}
+
+	if (hires && map_tex_hires_stream)
+	{
+		hiresproxy::request(hires);
+		load.proxies.push_back(hires->getShared());
+	}
+	else if (hires)
+	{
+		entryprefetch::add(hires);
+		load.entries.push_back(hires->getShared());
+	}
+
+	mtex.loading  = true;
+	mtex.deferred = true;
+	load_queue_.push_back(std::move(load));
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads hi-res image [entry] to [mtex]. If hi-res streaming is enabled
+// (map_tex_hires_stream) and the image is large, a downscaled proxy of it is
+// loaded instead, to be replaced by the full size image when it is seen up
+// close in the 3d view (see updateResidency). [full_size] is set to the size
+// of the full image. Returns true if the image was loaded
+// -----------------------------------------------------------------------------
+bool MapTextureManager::loadHires(Texture& mtex, ArchiveEntry* entry, gl::TexFilter filter, Vec2i& full_size)
+{
+	PROFILE_ZONE("MapTextureManager::loadHires");
+
+	mtex.proxy     = false;
+	mtex.streaming = false;
+
+	SImage image;
+	bool   proxy = false;
+	if (map_tex_hires_stream && hiresproxy::get(entry, image, full_size))
+		proxy = image.width() < full_size.x || image.height() < full_size.y;
+	else if (misc::loadImageFromEntry(&image, entry))
+		full_size = { image.width(), image.height() };
+	else
+		return false;
+
+	// Full size (or small enough to not need a proxy)
+	if (!proxy)
+	{
+		mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+		addToAtlas(mtex, image, palette_.get());
+		return mtex.gl_id > 0;
+	}
+
+	// Proxy (never added to an atlas, since it will be replaced later)
+	mtex.atlas_id   = 0;
+	mtex.atlas_rect = {};
+	mtex.gl_id      = gl::Texture::create(filter);
+	if (!gl::Texture::loadReduced(mtex.gl_id, image, full_size, palette_.get()))
+	{
+		gl::Texture::clear(mtex.gl_id);
+		mtex.gl_id = 0;
+		return false;
+	}
+	mtex.proxy = true;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Starts loading the full size hi-res image for proxy texture [mtex] (named
+// [name] in [map]), decoding it in the background to be uploaded by
+// processStreamQueue
+// -----------------------------------------------------------------------------
+void MapTextureManager::streamHires(MapTexHashMap& map, const string& name, Texture& mtex)
+{
+	auto* entry = app::resources().getHiresEntry(name, archive_.lock().get());
+	if (!entry)
+		return;
+
+	entryprefetch::add(entry);
+	stream_queue_.push_back({ &map, name, entry->getShared() });
+	mtex.streaming = true;
+}
+
+// -----------------------------------------------------------------------------
+// Replaces hi-res proxies with their full size images once they have been
+// decoded in the background (see streamHires), until the time budget for this
+// frame (map_tex_load_budget) is used up. The full size image is queued for
+// upload to the proxy's existing GL texture (see gl::Texture::loadImageAsync),
+// so nothing using it needs refreshing and the proxy is shown until then.
+// Must be called on the GL thread
+// -----------------------------------------------------------------------------
+void MapTextureManager::processStreamQueue()
+{
+	auto start  = app::runTimer();
+	bool loaded = false;
+	for (auto i = stream_queue_.begin(); i != stream_queue_.end();)
+	{
+		if (loaded && app::runTimer() - start >= map_tex_load_budget)
+			break;
+
+		// Skip if the image is still being decoded
+		auto entry = i->entry.lock();
+		if (entry && entryprefetch::isDecoding(entry.get()))
+		{
+			++i;
+			continue;
+		}
+
+		// Load it (if the texture is still showing the proxy)
+		auto mtex = i->map->find(i->name);
+		if (entry && mtex != i->map->end() && mtex->second.gl_id && mtex->second.proxy && mtex->second.streaming)
+		{
+			SImage image;
+			if (misc::loadImageFromEntry(&image, entry.get()))
+				gl::Texture::loadImageAsync(mtex->second.gl_id, image, palette_.get());
+
+			// Don't try again if it failed to load
+			mtex->second.proxy     = false;
+			mtex->second.streaming = false;
+			loaded                 = true;
+		}
+
+		if (entry)
+			entryprefetch::remove(entry.get());
+		i = stream_queue_.erase(i);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Unloads the least recently used textures, flats and sprites until texture
+// memory usage is within the budget (map_tex_budget). Only textures that
+// haven't been used for at least map_tex_evict_frames frames are unloaded, and
+// are loaded again as normal when next needed
+// -----------------------------------------------------------------------------
+void MapTextureManager::evictUnused()
+{
+	if (map_tex_budget <= 0)
+		return;
+
+	auto budget = static_cast<size_t>(map_tex_budget) * 1024 * 1024;
+	auto used   = textureMemoryUsage();
+	if (used <= budget)
+		return;
+
+	// Get textures that can be unloaded
+	auto             frame = gl::Texture::currentFrame();
+	vector<Texture*> unused;
+	for (auto* map : { &textures_, &flats_, &sprites_ })
+		for (auto& [name, mtex] : *map)
+		{
+			if (mtex.gl_id == 0 || mtex.gl_id == gl::Texture::missingTexture() || mtex.atlas_id > 0)
+				continue;
+
+			if (gl::Texture::info(mtex.gl_id).last_used + map_tex_evict_frames < frame)
+				unused.push_back(&mtex);
+		}
+
+	// Unload least recently used first
+	std::sort(unused.begin(), unused.end(), [](const Texture* left, const Texture* right) {
+		return gl::Texture::info(left->gl_id).last_used < gl::Texture::info(right->gl_id).last_used;
+	});
+	unsigned evicted = 0;
+	for (auto* mtex : unused)
+	{
+		if (used <= budget)
+			break;
+
+		used -= std::min(used, gl::Texture::memoryUsage(mtex->gl_id));
+		stale_textures_.insert(mtex->gl_id);
+		gl::Texture::clear(mtex->gl_id);
+		mtex->gl_id    = 0;
+		mtex->deferred = false;
+		evicted++;
+	}
+
+	if (evicted > 0)
+	{
+		n_evicted_ += evicted;
+		log::info(2, "Unloaded {} unused textures, texture memory usage now {}MB", evicted, used / (1024 * 1024));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reduces or restores the resolution of textures and flats in the 3d view
+// based on the nearest distance they were visible at (see setTextureDistances).
+// Textures beyond map_tex_reduce_dist are reduced to half size, and beyond
+// twice that to quarter size. Reduced textures are unloaded to be reloaded at
+// full size when they come closer again, and hi-res proxies are streamed in at
+// full size when they are visible close enough to need it (see streamHires)
+// -----------------------------------------------------------------------------
+void MapTextureManager::updateResidency()
+{
+	if (tex_distances_.empty())
+		return;
+
+	// Get the reduction for a texture at [dist] with [range] as the reduce distance
+	auto reduction_at = [](double dist, double range) {
+		if (range <= 0.)
+			return 1;
+		return dist > range * 2. ? 4 : dist > range ? 2 : 1;
+	};
+
+	auto     start    = app::runTimer();
+	unsigned restored = 0;
+	for (auto* map : { &textures_, &flats_ })
+		for (auto& [name, mtex] : *map)
+		{
+			if (mtex.gl_id == 0 || mtex.atlas_id > 0)
+				continue;
+			auto dist = tex_distances_.find(mtex.gl_id);
+			if (dist == tex_distances_.end())
+				continue;
+
+			// Hi-res proxies are replaced by the full size image (loaded in the
+			// background) when seen closer than the proxy is sufficient for
+			const auto& info = gl::Texture::info(mtex.gl_id);
+			if (mtex.proxy)
+			{
+				if (!mtex.streaming && stream_queue_.size() < 8
+					&& reduction_at(dist->second, map_tex_reduce_dist) < info.reduction)
+					streamHires(*map, name, mtex);
+				continue;
+			}
+
+			if (reduction_at(dist->second, map_tex_reduce_dist * 0.8) < info.reduction && restored < 8)
+			{
+				// Unload to be reloaded at full size when next requested (it
+				// will be reloaded immediately rather than queued)
+				stale_textures_.insert(mtex.gl_id);
+				gl::Texture::clear(mtex.gl_id);
+				mtex.gl_id    = 0;
+				mtex.deferred = true;
+				restored++;
+			}
+			else if (auto reduction = reduction_at(dist->second, map_tex_reduce_dist); reduction > info.reduction)
+			{
+				// Don't bother with small textures
+				if (info.size.x < 128 || info.size.y < 128)
+					continue;
+
+				if (app::runTimer() - start < map_tex_load_budget)
+					gl::Texture::reduce(mtex.gl_id, reduction);
+			}
+		}
+
+	tex_distances_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [image] to a texture atlas page if atlasing is enabled and it is small
+// enough, and sets the atlas info of [mtex] to match.
+// Each texture in an atlas is surrounded by a 1 pixel border wrapped from its
+// opposite edge, so that it filters the same as when tiled
+// -----------------------------------------------------------------------------
+void MapTextureManager::addToAtlas(Texture& mtex, const SImage& image, Palette* pal)
+{
+	mtex.atlas_id   = 0;
+	mtex.atlas_rect = {};
+
+	int iw = image.width();
+	int ih = image.height();
+	if (!map_tex_atlas || iw <= 0 || ih <= 0 || iw > map_tex_atlas_max || ih > map_tex_atlas_max)
+		return;
+
+	// Get image data with border
+	MemChunk rgba;
+	if (!image.putRGBAData(rgba, pal))
+		return;
+	int             w = iw + 2;
+	int             h = ih + 2;
+	vector<uint8_t> data(w * h * 4);
+	for (int y = 0; y < h; y++)
+	{
+		int sy = (y + ih - 1) % ih;
+		for (int x = 0; x < w; x++)
+		{
+			int sx = (x + iw - 1) % iw;
+			memcpy(&data[(y * w + x) * 4], rgba.data() + (sy * iw + sx) * 4, 4);
+		}
+	}
+
+	// Find space on the current (last) page, starting a new shelf if needed
+	auto find_space = [w, h](AtlasPage& page, int& x, int& y) {
+		if (page.shelf_x + w > page.size)
+		{
+			page.shelf_x = 0;
+			page.shelf_y += page.shelf_h;
+			page.shelf_h = 0;
+		}
+		if (w > page.size || page.shelf_y + h > page.size)
+			return false;
+
+		x = page.shelf_x;
+		y = page.shelf_y;
+		page.shelf_x += w;
+		page.shelf_h = std::max(page.shelf_h, h);
+		return true;
+	};
+	int x, y;
+	if (atlas_pages_.empty() || !find_space(atlas_pages_.back(), x, y))
+	{
+		// No space, add a new page (atlases aren't mipmapped)
+		AtlasPage page;
+		page.size  = std::min<int>(2048, gl::maxTextureSize());
+		page.gl_id = gl::Texture::create(
+			map_tex_filter == 0 || map_tex_filter == 3 ? gl::TexFilter::Nearest : gl::TexFilter::Linear, false);
+		vector<uint8_t> blank(page.size * page.size * 4, 0);
+		if (!gl::Texture::loadData(page.gl_id, blank.data(), page.size, page.size))
+		{
+			gl::Texture::clear(page.gl_id);
+			return;
+		}
+		atlas_pages_.push_back(page);
+
+		if (!find_space(atlas_pages_.back(), x, y))
+			return;
+	}
+
+	// Upload to the page
+	auto& page = atlas_pages_.back();
+	gl::Texture::bind(page.gl_id);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+
+	float scale     = 1.0f / page.size;
+	mtex.atlas_id   = page.gl_id;
+	mtex.atlas_rect = { (x + 1) * scale, (y + 1) * scale, (x + 1 + iw) * scale, (y + 1 + ih) * scale };
+}
+
+// -----------------------------------------------------------------------------
+// Unloads all texture atlas pages
+// -----------------------------------------------------------------------------
+void MapTextureManager::clearAtlas()
+{
+	for (const auto& page : atlas_pages_)
+		gl::Texture::clear(page.gl_id);
+
+	atlas_pages_.clear();
+}
+
 // -----------------------------------------------------------------------------
 // Loads all editor images (thing icons, etc) from the program resource archive
 // -----------------------------------------------------------------------------
@@ -552,19 +1248,99 @@ void MapTextureManager::refreshResources()
 	// Just clear all cached textures
 	textures_.clear();
 	flats_.clear();
+	textures_by_id_.clear();
+	flats_by_id_.clear();
 	sprites_.clear();
+	sprites_by_type_.clear();
+	load_queue_.clear();
+	stream_queue_.clear();
+	clearAtlas();
 	theMainWindow->paletteChooser()->setGlobalFromArchive(archive_.lock().get());
 	mapeditor::forceRefresh(true);
 	palette_->copyPalette(resourcePalette());
 	buildTexInfoList();
 }
 
+// -----------------------------------------------------------------------------
+// Unloads cached textures, flats and sprites matching any of [names], along
+// with any cached composite textures using them as patches. Their GL ids are
+// added to the stale textures, so the renderers only refresh what used them.
+// If [rebuild_info] is true, the texture info lists are also rebuilt
+// -----------------------------------------------------------------------------
+void MapTextureManager::refreshResources(const vector<string>& names, bool rebuild_info)
+{
+	std::set<string> changed;
+	for (const auto& name : names)
+		changed.insert(strutil::upper(name));
+
+	// Check if the texture/flat [name] is one of the changed resources, or is
+	// a composite texture that uses one as a patch
+	auto archive     = archive_.lock().get();
+	auto is_affected = [&](const string& name) {
+		if (changed.count(name) > 0)
+			return true;
+
+		auto* ctex = app::resources().getTexture(name, "WallTexture", archive);
+		if (!ctex)
+			ctex = app::resources().getTexture(name, "", archive);
+		if (ctex)
+			for (size_t a = 0; a < ctex->nPatches(); a++)
+				if (changed.count(strutil::upper(ctex->patch(a)->name())) > 0)
+					return true;
+
+		return false;
+	};
+
+	// Unloads [i] in [map], marking anything drawn with it as stale
+	auto unload = [this](MapTexHashMap& map, MapTexHashMap::iterator i) {
+		if (i->second.gl_id)
+			stale_textures_.insert(i->second.gl_id);
+		if (i->second.atlas_id)
+			stale_textures_.insert(i->second.atlas_id);
+		return map.erase(i);
+	};
+
+	// Anything drawn as missing may exist now if resources were added or renamed
+	if (rebuild_info)
+		stale_textures_.insert(gl::Texture::missingTexture());
+
+	// Unload affected textures and flats
+	textures_by_id_.clear();
+	flats_by_id_.clear();
+	for (auto i = textures_.begin(); i != textures_.end();)
+		i = is_affected(i->first) ? unload(textures_, i) : std::next(i);
+	for (auto i = flats_.begin(); i != flats_.end();)
+		i = is_affected(i->first) ? unload(flats_, i) : std::next(i);
+
+	// Unload affected sprites (sprites are keyed by name + translation + palette)
+	for (auto i = sprites_.begin(); i != sprites_.end();)
+	{
+		bool affected = false;
+		for (const auto& name : changed)
+			if (strutil::startsWith(i->first, name))
+			{
+				affected = true;
+				break;
+			}
+
+		i = affected ? unload(sprites_, i) : std::next(i);
+	}
+	sprites_by_type_.clear();
+
+	mapeditor::forceRefresh(true);
+
+	if (rebuild_info)
+		buildTexInfoList();
+}
+
 // -----------------------------------------------------------------------------
 // (Re)builds lists with information about all currently available resource
 // textures and flats
 // -----------------------------------------------------------------------------
 void MapTextureManager::buildTexInfoList()
 {
+	PROFILE_ZONE("MapTextureManager::buildTexInfoList");
+
 	// Clear
 	tex_info_.clear();
 	flat_info_.clear();
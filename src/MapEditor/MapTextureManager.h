@@ -1,12 +1,20 @@
 #pragma once
 
 #include "OpenGL/GLTexture.h"
+#include <deque>
 
 namespace slade
 {
 class ArchiveDir;
+class ArchiveEntry;
 class Archive;
 class Palette;
+class SImage;
+class TextureName;
+namespace game
+{
+	class ThingType;
+}
 
 class MapTextureManager
 {
@@ -26,6 +34,12 @@ public:
 		unsigned gl_id         = 0;
 		bool     world_panning = false;
 		Vec2d    scale         = { 1., 1. };
+		unsigned atlas_id      = 0;     // GL id of the atlas page containing the texture (0 if not in an atlas)
+		Rectf    atlas_rect;            // Texture coordinates of the texture within its atlas page
+		bool     loading       = false; // Queued to be loaded, see MapTextureManager::processLoadQueue
+		bool     deferred      = false; // Was queued to be loaded (any further loads are immediate)
+		bool     proxy         = false; // Showing a downscaled proxy of a hi-res image, see hiresproxy
+		bool     streaming     = false; // Full size hi-res image is being loaded, see processStreamQueue
 		~Texture() { gl::Texture::clear(gl_id); }
 	};
 	typedef std::map<string, Texture> MapTexHashMap;
@@ -56,20 +70,44 @@ public:
 		}
 	};
 
+	struct MemoryStats
+	{
+		size_t   used    = 0; // Approximate GPU memory used by all textures
+		size_t   budget  = 0; // GPU memory budget (0 if unlimited)
+		unsigned loaded  = 0; // Number of textures loaded
+		unsigned reduced = 0; // Number of textures currently reduced in size
+		unsigned evicted = 0; // Number of textures unloaded to stay within the budget
+		unsigned proxies = 0; // Number of hi-res textures currently showing a downscaled proxy
+	};
+
 	MapTextureManager(shared_ptr<Archive> archive = nullptr);
-	~MapTextureManager() = default;
+	~MapTextureManager() { clearAtlas(); }
 
 	void init();
 	void setArchive(shared_ptr<Archive> archive);
 	void refreshResources();
+	void refreshResources(const vector<string>& names, bool rebuild_info);
 	void buildTexInfoList();
 
 	Palette*       resourcePalette() const;
 	const Texture& texture(string_view name, bool mixed);
+	const Texture& texture(const TextureName& name, bool mixed);
 	const Texture& flat(string_view name, bool mixed);
+	const Texture& flat(const TextureName& name, bool mixed);
 	const Texture& sprite(string_view name, string_view translation = "", string_view palette = "");
+	const Texture& sprite(const game::ThingType& type);
+	void           preloadSprites(const vector<const game::ThingType*>& types);
 	const Texture& editorImage(string_view name);
 	int            verticalOffset(string_view name) const;
+	size_t         textureMemoryUsage() const;
+	MemoryStats    memoryStats() const;
+	const Texture& placeholder();
+	bool           loadsQueued() const { return !load_queue_.empty(); }
+	void           enableLoadQueue(bool enable) { load_queue_enabled_ = enable; }
+	void           setTextureDistances(std::map<unsigned, double> distances) { tex_distances_ = std::move(distances); }
+	void           update();
+
+	std::set<unsigned> takeStaleTextures() { return std::move(stale_textures_); }
 
 	vector<TexInfo>& allTexturesInfo() { return tex_info_; }
 	vector<TexInfo>& allFlatsInfo() { return flat_info_; }
@@ -81,14 +119,102 @@ private:
 	MapTexHashMap       sprites_;
 	MapTexHashMap       editor_images_;
 	bool                editor_images_loaded_ = false;
+
+	// Textures and flats above by TextureName::idCI, so that map textures can
+	// be looked up without searching the maps
+	vector<Texture*> textures_by_id_;
+	vector<Texture*> flats_by_id_;
+
+	// Resolved sprites by thing type (including any rotation fallbacks, or
+	// not found), so that a type's sprite can be returned without building
+	// its name key or searching for it again. The type's sprite, translation
+	// and palette are kept to check the cached sprite still applies
+	struct TypeSprite
+	{
+		const Texture* texture = nullptr;
+		int            filter  = 0; // map_tex_filter when the sprite was resolved
+		string         sprite;
+		string         translation;
+		string         palette;
+	};
+	std::unordered_map<const game::ThingType*, TypeSprite> sprites_by_type_;
+
 	unique_ptr<Palette> palette_;
 	vector<TexInfo>     tex_info_;
 	vector<TexInfo>     flat_info_;
 
+	// Texture atlas pages, textures are packed into rows ('shelves') of
+	// increasing y position
+	struct AtlasPage
+	{
+		unsigned gl_id   = 0;
+		int      size    = 0;
+		int      shelf_x = 0; // Start of free space on the current shelf
+		int      shelf_y = 0; // Top of the current shelf
+		int      shelf_h = 0; // Height of the current shelf
+	};
+	vector<AtlasPage> atlas_pages_;
+
+	// Textures queued to be loaded over the following frames rather than when
+	// first requested. Any standalone image entries they use are decoded on the
+	// worker threads in the meantime
+	struct QueuedLoad
+	{
+		enum class Type
+		{
+			Texture,
+			Flat,
+			Sprite
+		};
+		Type                           type = Type::Texture;
+		string                         name;
+		bool                           mixed = false;
+		string                         translation;
+		string                         palette;
+		vector<weak_ptr<ArchiveEntry>> entries;
+		vector<weak_ptr<ArchiveEntry>> proxies; // Hi-res entries that will be loaded as proxies
+	};
+	std::deque<QueuedLoad> load_queue_;
+	bool                   load_queue_enabled_ = false; // Queue textures rather than load immediately
+	bool                   loading_queued_     = false; // Currently loading queued textures
+	Texture                tex_placeholder_;
+
+	// Texture memory management. Textures that haven't been used recently are
+	// unloaded when over the memory budget, and textures only visible far away
+	// in the 3d view can be reduced in size. The GL ids of any textures that
+	// were unloaded or replaced are kept until taken by the renderer
+	std::set<unsigned>         stale_textures_;
+	std::map<unsigned, double> tex_distances_; // Nearest distance each texture is visible at (by GL id)
+
+	// Hi-res textures shown as proxies that are being loaded at full size
+	// (decoded in the background, then uploaded in place of the proxy)
+	struct StreamedLoad
+	{
+		MapTexHashMap*         map = nullptr;
+		string                 name;
+		weak_ptr<ArchiveEntry> entry;
+	};
+	vector<StreamedLoad> stream_queue_;
+	long                       budget_checked_ = 0;
+	unsigned                   n_evicted_      = 0;
+
 	// Signal connections
 	sigslot::scoped_connection sc_resources_updated_;
+	sigslot::scoped_connection sc_resources_changed_;
 	sigslot::scoped_connection sc_palette_changed_;
 
+	const Texture& loadTexture(Texture& mtex, string_view name, bool mixed);
+	const Texture& loadFlat(Texture& mtex, string_view name, bool mixed);
+
 	void importEditorImages(MapTexHashMap& map, ArchiveDir* dir, string_view path) const;
+	bool queueLoad(Texture& mtex, QueuedLoad load, const vector<ArchiveEntry*>& entries, ArchiveEntry* hires = nullptr);
+	bool processLoadQueue();
+	bool loadHires(Texture& mtex, ArchiveEntry* entry, gl::TexFilter filter, Vec2i& full_size);
+	void streamHires(MapTexHashMap& map, const string& name, Texture& mtex);
+	void processStreamQueue();
+	void evictUnused();
+	void updateResidency();
+	void addToAtlas(Texture& mtex, const SImage& image, Palette* pal);
+	void clearAtlas();
 };
 } // namespace slade
@@ -34,10 +34,12 @@
 #include "NodeBuilders.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "UI/WxUtils.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
+using namespace nodebuilders;
 
 
 // -----------------------------------------------------------------------------
@@ -55,6 +57,167 @@ vector<string>  builder_paths;
 } // namespace slade::nodebuilders
 
 
+// -----------------------------------------------------------------------------
+//
+// BuildProcess Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// BuildProcess class constructor
+// -----------------------------------------------------------------------------
+BuildProcess::BuildProcess(const Builder& builder, string_view filename, string_view options, FinishedFunc finished) :
+	path_{ builder.path },
+	command_{ commandLine(builder, filename, options) },
+	filename_{ filename },
+	finished_{ std::move(finished) }
+{
+	// Capture output so it can be logged while the builder is running
+	Redirect();
+
+	timer_.SetOwner(this);
+	Bind(wxEVT_TIMER, [this](wxTimerEvent&) {
+		readOutput(GetInputStream(), partial_output_[0]);
+		readOutput(GetErrorStream(), partial_output_[1]);
+		if (progress_)
+			progress_();
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Starts the node builder process, returns false if it couldn't be started
+// -----------------------------------------------------------------------------
+bool BuildProcess::start()
+{
+	log::info("execute \"{}\"", command_);
+	stopwatch_.Start();
+	pid_ = wxExecute(command_, wxEXEC_ASYNC | wxEXEC_HIDE_CONSOLE, this);
+	if (pid_ <= 0)
+	{
+		pid_ = 0;
+		log::error("Unable to run node builder \"{}\"", path_);
+		return false;
+	}
+
+	// Poll for output
+	timer_.Start(100);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Kills the node builder process if it is running. The finished callback is
+// still called once it has terminated
+// -----------------------------------------------------------------------------
+void BuildProcess::cancel()
+{
+	if (pid_ <= 0)
+		return;
+
+	cancelled_ = true;
+	wxProcess::Kill(pid_, wxSIGKILL, wxKILL_CHILDREN);
+}
+
+// -----------------------------------------------------------------------------
+// Cancels the build if it is running, without calling the finished callback.
+// The BuildProcess deletes itself once the process has terminated, so it must
+// not be used (or deleted) by the caller after this
+// -----------------------------------------------------------------------------
+void BuildProcess::abandon()
+{
+	finished_ = nullptr;
+	if (pid_ <= 0)
+	{
+		delete this;
+		return;
+	}
+
+	abandoned_ = true;
+	cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the node builder process has terminated
+// -----------------------------------------------------------------------------
+void BuildProcess::OnTerminate(int pid, int status)
+{
+	timer_.Stop();
+	stopwatch_.Pause();
+	pid_ = 0;
+
+	// Log any remaining output
+	readOutput(GetInputStream(), partial_output_[0]);
+	readOutput(GetErrorStream(), partial_output_[1]);
+	flushOutput(partial_output_[0]);
+	flushOutput(partial_output_[1]);
+
+	if (cancelled_)
+		log::info("Node build cancelled");
+	else if (status != 0)
+		log::warning("Node builder exited with status {} after {}ms", status, stopwatch_.Time());
+	else
+		log::info("Node build finished in {}ms", stopwatch_.Time());
+
+	if (abandoned_)
+	{
+		delete this;
+		return;
+	}
+
+	// Call the finished callback from the event loop, so it can safely delete
+	// this process
+	auto success = !cancelled_;
+	CallAfter([this, success]() {
+		if (finished_)
+			finished_(success);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Reads any available output from [stream], logging each complete line.
+// [partial] holds the incomplete last line from previous reads
+// -----------------------------------------------------------------------------
+void BuildProcess::readOutput(wxInputStream* stream, string& partial)
+{
+	if (!stream)
+		return;
+
+	char buffer[1024];
+	while (stream->CanRead())
+	{
+		stream->Read(buffer, sizeof(buffer));
+		auto count = stream->LastRead();
+		if (count == 0)
+			break;
+		partial.append(buffer, count);
+	}
+
+	size_t start = 0;
+	for (auto end = partial.find('\n'); end != string::npos; end = partial.find('\n', start))
+	{
+		auto line = partial.substr(start, end - start);
+		start     = end + 1;
+		flushOutput(line);
+	}
+	partial.erase(0, start);
+}
+
+// -----------------------------------------------------------------------------
+// Logs [line] of output (if it isn't blank) and clears it
+// -----------------------------------------------------------------------------
+void BuildProcess::flushOutput(string& line)
+{
+	strutil::trimIP(line);
+	if (!line.empty())
+	{
+		log::info(line);
+		last_output_ = line;
+	}
+	line.clear();
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // NodeBuilders Namespace Functions
@@ -184,3 +347,16 @@ nodebuilders::Builder& nodebuilders::builder(unsigned index)
 
 	return builders[index];
 }
+
+// -----------------------------------------------------------------------------
+// Returns the full command line to run [builder] on the wad [filename], with
+// the given extra [options]
+// -----------------------------------------------------------------------------
+string nodebuilders::commandLine(const Builder& builder, string_view filename, string_view options)
+{
+	wxString command = builder.command;
+	command.Replace("$f", wxString::Format("\"%s\"", wxutil::strFromView(filename)));
+	command.Replace("$o", wxutil::strFromView(options));
+
+	return fmt::format("\"{}\" {}", builder.path, command.ToStdString());
+}
@@ -13,10 +13,53 @@ struct Builder
 	vector<string> option_desc;
 };
 
+// Runs a node builder on a wad file in the background. Output from the builder
+// is written to the log as it runs, and [finished] is called (on the main
+// thread) once the process has terminated, with false if it was cancelled
+class BuildProcess : public wxProcess
+{
+public:
+	using FinishedFunc = std::function<void(bool)>;
+
+	BuildProcess(const Builder& builder, string_view filename, string_view options, FinishedFunc finished);
+	~BuildProcess() override = default;
+
+	const string& filename() const { return filename_; }
+	const string& lastOutput() const { return last_output_; }
+	bool          running() const { return pid_ > 0; }
+	long          elapsedMs() const { return stopwatch_.Time(); }
+
+	void setProgressCallback(std::function<void()> progress) { progress_ = std::move(progress); }
+
+	bool start();
+	void cancel();
+	void abandon();
+
+	void OnTerminate(int pid, int status) override;
+
+private:
+	string                path_;
+	string                command_;
+	string                filename_;
+	long                  pid_       = 0;
+	bool                  cancelled_ = false;
+	bool                  abandoned_ = false;
+	FinishedFunc          finished_;
+	std::function<void()> progress_;
+	wxTimer               timer_;
+	wxStopWatch           stopwatch_;
+	string                partial_output_[2]; // Incomplete last line of stdout/stderr
+	string                last_output_;
+
+	void readOutput(wxInputStream* stream, string& partial);
+	void flushOutput(string& line);
+};
+
 void     init();
 void     addBuilderPath(string_view builder, string_view path);
 void     saveBuilderPaths(wxFile& file);
 unsigned nNodeBuilders();
 Builder& builder(string_view id);
 Builder& builder(unsigned index);
+string   commandLine(const Builder& builder, string_view filename, string_view options);
 } // namespace slade::nodebuilders
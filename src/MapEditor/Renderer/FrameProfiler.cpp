@@ -0,0 +1,207 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    FrameProfiler.cpp
+// Description: Records per-frame timings of the map editor renderer, split into
+//              sections (visibility, VBO updates, flats, walls etc.), along
+//              with draw call and texture bind counts. Timings are averaged
+//              over recent frames for display in an on-screen overlay
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "FrameProfiler.h"
+#include "General/Console.h"
+#include "OpenGL/GLTexture.h"
+#include <array>
+#include <deque>
+
+using namespace slade;
+using namespace frameprofiler;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, map_show_profiler, false, 0)
+namespace
+{
+constexpr unsigned n_sections     = static_cast<unsigned>(Section::Count);
+constexpr unsigned history_frames = 60; // Number of frames to average timings over
+
+struct FrameTimes
+{
+	std::array<double, n_sections> sections{};
+	double                         total      = 0.;
+	unsigned                       draw_calls = 0;
+	unsigned                       binds      = 0;
+};
+
+FrameTimes                            current;
+std::deque<FrameTimes>                history;
+std::chrono::steady_clock::time_point frame_start;
+unsigned                              frame_binds = 0;     // Texture bind count at the start of the frame
+bool                                  recording   = false; // Recording without the overlay (eg. for benchmarks)
+
+const char* section_names[] = { "Update", "Textures", "Visibility", "VBOs",  "Flats",
+								"Walls",  "Things",   "Overlays",   "Text" };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// frameprofiler Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if the profiler is enabled
+// -----------------------------------------------------------------------------
+bool frameprofiler::enabled()
+{
+	return map_show_profiler || recording;
+}
+
+// -----------------------------------------------------------------------------
+// Enables or disables recording frame timings and counts even if the profiler
+// overlay isn't shown
+// -----------------------------------------------------------------------------
+void frameprofiler::setRecording(bool record)
+{
+	recording = record;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [ms] milliseconds to [section] for the current frame
+// -----------------------------------------------------------------------------
+void frameprofiler::addTime(Section section, double ms)
+{
+	current.sections[static_cast<unsigned>(section)] += ms;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [count] draw calls to the current frame
+// -----------------------------------------------------------------------------
+void frameprofiler::addDrawCalls(unsigned count)
+{
+	if (enabled())
+		current.draw_calls += count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of draw calls made so far in the current frame
+// -----------------------------------------------------------------------------
+unsigned frameprofiler::drawCalls()
+{
+	return current.draw_calls;
+}
+
+// -----------------------------------------------------------------------------
+// Begins drawing a frame. Anything recorded since the last frame ended (eg.
+// MapEditContext::update) is included in this frame
+// -----------------------------------------------------------------------------
+void frameprofiler::beginFrame()
+{
+	frame_start = std::chrono::steady_clock::now();
+	frame_binds = gl::Texture::bindCount();
+}
+
+// -----------------------------------------------------------------------------
+// Ends drawing the current frame and adds it to the history
+// -----------------------------------------------------------------------------
+void frameprofiler::endFrame()
+{
+	if (!enabled())
+	{
+		history.clear();
+		current = {};
+		return;
+	}
+
+	current.total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count()
+					+ current.sections[static_cast<unsigned>(Section::Update)];
+	current.binds = gl::Texture::bindCount() - frame_binds;
+
+	history.push_back(current);
+	while (history.size() > history_frames)
+		history.pop_front();
+
+	current = {};
+}
+
+// -----------------------------------------------------------------------------
+// Returns lines of text describing the average timings over recent frames
+// -----------------------------------------------------------------------------
+vector<string> frameprofiler::report()
+{
+	vector<string> lines;
+	if (history.empty())
+		return lines;
+
+	// Get averages
+	FrameTimes avg;
+	double     max_total = 0.;
+	for (const auto& frame : history)
+	{
+		for (unsigned a = 0; a < n_sections; a++)
+			avg.sections[a] += frame.sections[a];
+		avg.total += frame.total;
+		avg.draw_calls += frame.draw_calls;
+		avg.binds += frame.binds;
+		max_total = std::max(max_total, frame.total);
+	}
+	double n = history.size();
+
+	lines.push_back(fmt::format("Frame      {:6.2f}ms (max {:1.2f}ms)", avg.total / n, max_total));
+	double other = avg.total;
+	for (unsigned a = 0; a < n_sections; a++)
+	{
+		lines.push_back(fmt::format("{:<10} {:6.2f}ms", section_names[a], avg.sections[a] / n));
+		other -= avg.sections[a];
+	}
+	lines.push_back(fmt::format("{:<10} {:6.2f}ms", "Other", std::max(0., other) / n));
+	lines.push_back(fmt::format("Draw calls {:6.0f}", avg.draw_calls / n));
+	lines.push_back(fmt::format("Tex binds  {:6.0f}", avg.binds / n));
+
+	return lines;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(m_profiler, 0, true)
+{
+	map_show_profiler = !map_show_profiler;
+	log::console(fmt::format("Map frame profiler {}", map_show_profiler ? "enabled" : "disabled"));
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+
+namespace slade
+{
+// Records per-frame timings of the map editor renderer (and related work), for
+// display in an on-screen overlay (see map_show_profiler)
+namespace frameprofiler
+{
+	// Timed parts of a map editor frame
+	enum class Section
+	{
+		Update,     // MapEditContext::update
+		Textures,   // Texture loading, unloading and residency
+		Visibility, // Determining what is visible
+		VBOs,       // Updating vertex buffers
+		Flats,      // Flats/sectors
+		Walls,      // Walls (3d) or lines and vertices (2d)
+		Things,     // Things
+		Overlays,   // Info and fullscreen overlays
+		Text,       // Editor messages, help text and stats
+
+		Count
+	};
+
+	bool           enabled();
+	void           setRecording(bool record);
+	void           addTime(Section section, double ms);
+	void           addDrawCalls(unsigned count = 1);
+	unsigned       drawCalls();
+	void           beginFrame();
+	void           endFrame();
+	vector<string> report();
+
+	// Adds the time elapsed between construction and destruction to [section],
+	// if the profiler is enabled. Time spent in any timers nested within this
+	// one is only added to the nested timers' sections
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(Section section) : section_{ section }, active_{ enabled() }
+		{
+			if (!active_)
+				return;
+
+			parent_  = current_;
+			current_ = this;
+			start_   = Clock::now();
+		}
+		~ScopedTimer()
+		{
+			if (!active_)
+				return;
+
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+			addTime(section_, ms - nested_ms_);
+			if (parent_)
+				parent_->nested_ms_ += ms;
+			current_ = parent_;
+		}
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		Section           section_;
+		bool              active_;
+		Clock::time_point start_;
+		double            nested_ms_ = 0.;
+		ScopedTimer*      parent_    = nullptr;
+
+		static inline ScopedTimer* current_ = nullptr;
+	};
+} // namespace frameprofiler
+} // namespace slade
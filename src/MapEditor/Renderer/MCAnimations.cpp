@@ -57,6 +57,30 @@ EXTERN_CVAR(Int, halo_width)
 EXTERN_CVAR(Bool, sector_selected_fill)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Draws [vertices] (x, y pairs) as [mode] primitives in a single call, rather
+// than one immediate mode call per vertex
+// -----------------------------------------------------------------------------
+void drawVertexArray(GLenum mode, const vector<float>& vertices)
+{
+	if (vertices.empty())
+		return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, vertices.data());
+	glDrawArrays(mode, 0, vertices.size() / 2);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MCASelboxFader Class Functions
@@ -208,19 +232,21 @@ MCALineSelection::MCALineSelection(long start, const vector<MapLine*>& lines, bo
 	select_{ select }
 {
 	// Go through list of lines
+	vertices_.reserve(lines.size() * 8);
 	for (auto& line : lines)
 	{
 		if (!line)
 			continue;
 
 		// Add line
-		lines_.emplace_back(line->x1(), line->y1(), line->x2(), line->y2());
+		vertices_.insert(
+			vertices_.end(), { (float)line->x1(), (float)line->y1(), (float)line->x2(), (float)line->y2() });
 
 		// Calculate line direction tab
 		auto mid = line->getPoint(MapObject::Point::Mid);
 		auto tab = line->dirTabPoint();
 
-		tabs_.emplace_back(mid.x, mid.y, tab.x, tab.y);
+		vertices_.insert(vertices_.end(), { (float)mid.x, (float)mid.y, (float)tab.x, (float)tab.y });
 	}
 }
 
@@ -249,15 +275,7 @@ void MCALineSelection::draw()
 
 	// Draw lines
 	glLineWidth(line_width * colourconfig::lineSelectionWidth());
-	glBegin(GL_LINES);
-	for (unsigned a = 0; a < lines_.size(); a++)
-	{
-		glVertex2d(lines_[a].tl.x, lines_[a].tl.y);
-		glVertex2d(lines_[a].br.x, lines_[a].br.y);
-		glVertex2d(tabs_[a].tl.x, tabs_[a].tl.y);
-		glVertex2d(tabs_[a].br.x, tabs_[a].br.y);
-	}
-	glEnd();
+	drawVertexArray(GL_LINES, vertices_);
 }
 
 
@@ -277,11 +295,13 @@ MCAVertexSelection::MCAVertexSelection(long start, const vector<MapVertex*>& ver
 	select_{ select }
 {
 	// Setup vertices list
+	vertices_.reserve(verts.size() * 2);
 	for (auto& vertex : verts)
 	{
 		if (!vertex)
 			continue;
-		vertices_.emplace_back(vertex->xPos(), vertex->yPos());
+		vertices_.push_back(vertex->xPos());
+		vertices_.push_back(vertex->yPos());
 	}
 
 	if (!select)
@@ -360,10 +380,7 @@ void MCAVertexSelection::draw()
 		glPointSize(size_ + (size_ * fade_));
 	else
 		glPointSize(size_);
-	glBegin(GL_POINTS);
-	for (auto& v : vertices_)
-		glVertex2d(v.x, v.y);
-	glEnd();
+	drawVertexArray(GL_POINTS, vertices_);
 
 	if (point)
 	{
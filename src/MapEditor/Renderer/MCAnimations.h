@@ -74,8 +74,7 @@ public:
 	void draw() override;
 
 private:
-	vector<Rectf> lines_;
-	vector<Rectf> tabs_;
+	vector<float> vertices_; // Line and direction tab vertices (x, y), drawn as a vertex array
 	bool          select_ = true;
 	float         fade_   = 1.f;
 };
@@ -91,7 +90,7 @@ public:
 	void draw() override;
 
 private:
-	vector<Vec2d> vertices_;
+	vector<float> vertices_; // Vertex positions (x, y), drawn as a vertex array
 	double        size_   = 0.;
 	bool          select_ = true;
 	float         fade_   = 1.f;
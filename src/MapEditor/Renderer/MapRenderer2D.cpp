@@ -33,8 +33,10 @@
 #include "Main.h"
 #include "MapRenderer2D.h"
 #include "App.h"
+#include "FrameProfiler.h"
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
+#include "General/Profiler.h"
 #include "MapEditor/Edit/ObjectEdit.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
@@ -42,7 +44,9 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
 #include "Utility/Polygon2D.h"
 
 using namespace slade;
@@ -80,10 +84,175 @@ CVAR(Bool, action_lines, true, CVar::Flag::Save)
 CVAR(String, arrow_pathed_color, "#22FFFF", CVar::Flag::Save)
 CVAR(String, arrow_dragon_color, "#FF2222", CVar::Flag::Save)
 CVAR(Bool, test_ssplit, false, CVar::Flag::Save)
+CVAR(Bool, map_lod, true, CVar::Flag::Save)
+CVAR(Float, map_lod_scale, 0.25f, CVar::Flag::Save) // Use simplified geometry when zoomed out below this scale
 namespace
 {
 // Texture coordinates for rendering square things (since we can't just rotate these)
 float sq_thing_tc[] = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+
+// Map lines shader, applies the overall lines alpha to the per-line colours in
+// the lines VBO, so the VBO doesn't need rebuilding when the alpha changes
+// (eg. when fading lines in/out)
+const char* shader_lines_vert = R"(#version 120
+uniform float alpha;
+void main()
+{
+	gl_Position   = ftransform();
+	gl_FrontColor = vec4(gl_Color.rgb, gl_Color.a * alpha);
+}
+)";
+const char* shader_lines_frag = R"(#version 120
+void main()
+{
+	gl_FragColor = gl_Color;
+}
+)";
+
+// Point light previews shader, draws each light quad with a smooth radial
+// falloff from the light colour at its centre, so all lights can be drawn
+// (additively) in a single batch without a light texture
+const char* shader_lights_vert = R"(#version 120
+varying vec2 light_pos;
+void main()
+{
+	gl_Position   = ftransform();
+	gl_FrontColor = gl_Color;
+	light_pos     = gl_MultiTexCoord0.xy * 2.0 - 1.0;
+}
+)";
+const char* shader_lights_frag = R"(#version 120
+uniform float alpha;
+varying vec2  light_pos;
+void main()
+{
+	float falloff = 1.0 - smoothstep(0.0, 1.0, length(light_pos));
+	gl_FragColor  = vec4(gl_Color.rgb, gl_Color.a * alpha * falloff);
+}
+)";
+
+// Map flats shader, calculates flat texture coordinates from the vertex
+// position and the flat's texture transform (scale, offset and rotation), so
+// they don't need to be stored in the flats VBO
+const char* shader_flats_vert = R"(#version 120
+uniform vec4 tex_transform; // Scale x/y, offset x/y
+uniform vec2 tex_rotation;  // Cos, sin
+void main()
+{
+	gl_Position    = ftransform();
+	gl_FrontColor  = gl_Color;
+	vec2 pos       = vec2(
+		tex_rotation.x * gl_Vertex.x - tex_rotation.y * gl_Vertex.y,
+		tex_rotation.y * gl_Vertex.x + tex_rotation.x * gl_Vertex.y);
+	gl_TexCoord[0] = vec4(
+		pos.x * tex_transform.x + tex_transform.z, tex_transform.w - pos.y * tex_transform.y, 0.0, 1.0);
+}
+)";
+const char* shader_flats_frag = R"(#version 120
+uniform sampler2D texture;
+void main()
+{
+	gl_FragColor = texture2D(texture, gl_TexCoord[0].xy) * gl_Color;
+}
+)";
+
+// -----------------------------------------------------------------------------
+// Applies the flat texture scale, offset and rotation UDMF properties of
+// [sector]'s floor (if [type] <= 1) or ceiling to [sx], [sy], [ox], [oy] and
+// [rot], if the current map format and game configuration support them
+// -----------------------------------------------------------------------------
+void applyFlatTexProperties(MapSector* sector, int type, double& sx, double& sy, double& ox, double& oy, double& rot)
+{
+	using game::UDMFFeature;
+
+	if (mapeditor::editContext().mapDesc().format != MapFormat::UDMF)
+		return;
+
+	// Floor
+	if (type <= 1)
+	{
+		if (game::configuration().featureSupported(UDMFFeature::FlatPanning))
+		{
+			ox = sector->floatProperty("xpanningfloor");
+			oy = sector->floatProperty("ypanningfloor");
+		}
+		if (game::configuration().featureSupported(UDMFFeature::FlatScaling))
+		{
+			sx *= (1.0 / sector->floatProperty("xscalefloor"));
+			sy *= (1.0 / sector->floatProperty("yscalefloor"));
+		}
+		if (game::configuration().featureSupported(UDMFFeature::FlatRotation))
+			rot = sector->floatProperty("rotationfloor");
+	}
+	// Ceiling
+	else
+	{
+		if (game::configuration().featureSupported(UDMFFeature::FlatPanning))
+		{
+			ox = sector->floatProperty("xpanningceiling");
+			oy = sector->floatProperty("ypanningceiling");
+		}
+		if (game::configuration().featureSupported(UDMFFeature::FlatScaling))
+		{
+			sx *= (1.0 / sector->floatProperty("xscaleceiling"));
+			sy *= (1.0 / sector->floatProperty("yscaleceiling"));
+		}
+		if (game::configuration().featureSupported(UDMFFeature::FlatRotation))
+			rot = sector->floatProperty("rotationceiling");
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] with the first index and count of each run of consecutive
+// indices in [indices] (which is sorted and made unique first)
+// -----------------------------------------------------------------------------
+template<typename F> void forEachIndexRange(vector<unsigned>& indices, F func)
+{
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+	size_t start = 0;
+	for (size_t a = 1; a <= indices.size(); a++)
+	{
+		if (a == indices.size() || indices[a] != indices[a - 1] + 1)
+		{
+			func(indices[start], a - start);
+			start = a;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the colour to draw a thing of [type] in, taking point light [args]
+// into account
+// -----------------------------------------------------------------------------
+ColRGBA thingColour(const game::ThingType& type, const MapObject::ArgSet& args, float alpha)
+{
+	auto a = static_cast<uint8_t>(alpha * 255.f);
+
+	if (type.pointLight().empty())
+		return { type.colour().r, type.colour().g, type.colour().b, a };
+	if (type.pointLight() == "zdoom")
+		return { static_cast<uint8_t>(args[0]), static_cast<uint8_t>(args[1]), static_cast<uint8_t>(args[2]), a };
+	if (type.pointLight() == "vavoom")
+		return { static_cast<uint8_t>(args[1]), static_cast<uint8_t>(args[2]), static_cast<uint8_t>(args[3]), a };
+
+	return { 255, 255, 255, a };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the preview radius of a point light thing of [type] with [args]
+// -----------------------------------------------------------------------------
+double pointLightRadius(const game::ThingType& type, const MapObject::ArgSet& args)
+{
+	double radius = 0.;
+	if (type.pointLight() == "zdoom")
+		radius = args[3];
+	else if (type.pointLight() == "vavoom" || type.pointLight() == "vavoom_white")
+		radius = args[0];
+
+	return radius * 2; // Doubling the radius value matches better with in-game results
+}
 } // namespace
 
 
@@ -113,6 +282,14 @@ MapRenderer2D::~MapRenderer2D()
 		glDeleteBuffers(1, &vbo_lines_);
 	if (vbo_flats_ > 0)
 		glDeleteBuffers(1, &vbo_flats_);
+	if (vbo_lod_lines_ > 0)
+		glDeleteBuffers(1, &vbo_lod_lines_);
+	if (vbo_lod_vertices_ > 0)
+		glDeleteBuffers(1, &vbo_lod_vertices_);
+	if (vbo_moving_ > 0)
+		glDeleteBuffers(1, &vbo_moving_);
+	if (vbo_object_edit_ > 0)
+		glDeleteBuffers(1, &vbo_object_edit_);
 	if (list_vertices_ > 0)
 		glDeleteLists(list_vertices_, 1);
 	if (list_lines_ > 0)
@@ -182,6 +359,8 @@ bool MapRenderer2D::setupVertexRendering(float size_scale, bool overlay) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderVertices(float alpha)
 {
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Walls);
+
 	// Check there are any vertices to render
 	if (map_->nVertices() == 0)
 		return;
@@ -199,10 +378,12 @@ void MapRenderer2D::renderVertices(float alpha)
 	glColor4f(col.fr(), col.fg(), col.fb(), col.fa() * alpha);
 
 	// Render the vertices depending on what features are supported
-	if (gl::vboSupport())
-		renderVerticesVBO();
-	else
+	if (!gl::vboSupport())
 		renderVerticesImmediate();
+	else if (auto band = lodBand(); band > 0)
+		renderVerticesLOD(band);
+	else
+		renderVerticesVBO();
 
 	if (point)
 	{
@@ -218,7 +399,10 @@ void MapRenderer2D::renderVerticesImmediate()
 {
 	if (list_vertices_ > 0 && map_->nVertices() == n_vertices_ && map_->geometryUpdated() <= vertices_updated_
 		&& !map_->mapData().modifiedSince(vertices_updated_, MapObject::Type::Vertex))
+	{
 		glCallList(list_vertices_);
+		frameprofiler::addDrawCalls();
+	}
 	else
 	{
 		// Rebuild display list
@@ -249,9 +433,13 @@ void MapRenderer2D::renderVerticesVBO()
 	if (map_->nVertices() == 0)
 		return;
 
-	// Update vertices VBO if required
-	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_ || map_->geometryUpdated() > vertices_updated_)
+	// Update vertices VBO if required (only modified vertices unless any were
+	// added or removed)
+	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_
+		|| map_->mapData().lastRemovedTime() > vertices_updated_)
 		updateVerticesVBO();
+	else if (map_->geometryUpdated() > vertices_updated_)
+		updateModifiedVerticesVBO();
 
 	// Set VBO arrays to use
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -264,6 +452,7 @@ void MapRenderer2D::renderVerticesVBO()
 
 	// Render the VBO
 	glDrawArrays(GL_POINTS, 0, map_->nVertices());
+	frameprofiler::addDrawCalls();
 
 	// Cleanup state
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -371,6 +560,10 @@ ColRGBA MapRenderer2D::lineColour(MapLine* line, bool ignore_filter) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderLines(bool show_direction, float alpha)
 {
+	PROFILE_ZONE("MapRenderer2D::renderLines");
+
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Walls);
+
 	// Check there are any lines to render
 	if (map_->nLines() == 0)
 		return;
@@ -388,10 +581,12 @@ void MapRenderer2D::renderLines(bool show_direction, float alpha)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Render the lines depending on what features are supported
-	if (gl::vboSupport())
-		renderLinesVBO(show_direction, alpha);
-	else
+	if (!gl::vboSupport())
 		renderLinesImmediate(show_direction, alpha);
+	else if (auto band = lodBand(); band > 0)
+		renderLinesLOD(band, alpha);
+	else
+		renderLinesVBO(show_direction, alpha);
 }
 
 // -----------------------------------------------------------------------------
@@ -405,6 +600,7 @@ void MapRenderer2D::renderLinesImmediate(bool show_direction, float alpha)
 		&& !map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
 	{
 		glCallList(list_lines_);
+		frameprofiler::addDrawCalls();
 		return;
 	}
 
@@ -465,11 +661,17 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 	if (map_->nLines() == 0)
 		return;
 
-	// Update lines VBO if required
+	// Update lines VBO if required. Without the shader, the overall alpha is
+	// part of the VBO colours, so it needs updating if the alpha changes too.
+	// Only modified lines are rewritten unless any lines were added or removed
+	auto& shader = linesShader();
 	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || map_->nLines() != n_lines_
-		|| map_->geometryUpdated() > lines_updated_
-		|| map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
+		|| map_->mapData().lastRemovedTime() > lines_updated_ || (!shader.isValid() && alpha != lines_vbo_alpha_))
 		updateLinesVBO(show_direction, alpha);
+	else if (
+		map_->geometryUpdated() > lines_updated_
+		|| map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
+		updateModifiedLinesVBO();
 
 	// Disable any blending
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -485,13 +687,23 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 
 	glColorPointer(4, GL_FLOAT, 24, ((char*)nullptr + 8));
 
+	// Setup shader
+	if (shader.isValid())
+	{
+		shader.bind();
+		shader.setUniform("alpha", alpha);
+	}
+
 	// Render the VBO
 	if (show_direction)
 		glDrawArrays(GL_LINES, 0, map_->nLines() * 4);
 	else
 		glDrawArrays(GL_LINES, 0, map_->nLines() * 2);
+	frameprofiler::addDrawCalls();
 
 	// Clean state
+	if (shader.isValid())
+		gl::Shader::unbind();
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -499,6 +711,203 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 	lines_dirs_ = show_direction;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the zoom band to use simplified (level of detail) geometry for at the
+// current view scale, or 0 if the full geometry should be used
+// -----------------------------------------------------------------------------
+int MapRenderer2D::lodBand() const
+{
+	if (!map_lod || view_scale_ <= 0. || view_scale_ >= map_lod_scale)
+		return 0;
+
+	// Use the smallest cell size that is at least one pixel
+	return std::max(1, static_cast<int>(std::ceil(std::log2(view_scale_inv_))));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the simplified map geometry for zoom [band], building it if needed.
+// Line and vertex positions are snapped to a grid of 2^[band] sized cells,
+// lines that end up within a single cell are dropped and duplicates merged,
+// so runs of tiny lines become simplified polylines
+// -----------------------------------------------------------------------------
+const MapRenderer2D::LODGeometry& MapRenderer2D::lodGeometry(int band)
+{
+	// Clear cached geometry if the map has changed since it was built
+	auto& map_data = map_->mapData();
+	if (map_->nLines() != lod_n_lines_ || map_->nVertices() != lod_n_vertices_
+		|| map_->geometryUpdated() > lod_updated_ || map_data.lastRemovedTime() > lod_updated_
+		|| map_data.modifiedSince(lod_updated_, MapObject::Type::Line))
+	{
+		lod_cache_.clear();
+		lod_lines_band_    = 0;
+		lod_vertices_band_ = 0;
+		lod_n_lines_       = map_->nLines();
+		lod_n_vertices_    = map_->nVertices();
+		lod_updated_       = app::runTimer();
+	}
+
+	// Check cache
+	auto cached = lod_cache_.find(band);
+	if (cached != lod_cache_.end())
+		return cached->second;
+
+	auto&      lod        = lod_cache_[band];
+	const auto cell_size  = std::ldexp(1.0, band);
+	auto       cell_coord = [cell_size](double pos) { return static_cast<int64_t>(std::floor(pos / cell_size)); };
+
+	// Lines
+	std::set<std::array<int64_t, 4>> lines_added;
+	for (unsigned a = 0; a < map_->nLines(); a++)
+	{
+		auto    line = map_->line(a);
+		int64_t x1   = cell_coord(line->x1());
+		int64_t y1   = cell_coord(line->y1());
+		int64_t x2   = cell_coord(line->x2());
+		int64_t y2   = cell_coord(line->y2());
+
+		// Ignore if it's within a single cell
+		if (x1 == x2 && y1 == y2)
+			continue;
+
+		// Ignore if there's already a line between the same cells
+		if (std::make_pair(x1, y1) > std::make_pair(x2, y2))
+		{
+			std::swap(x1, x2);
+			std::swap(y1, y2);
+		}
+		if (!lines_added.insert({ x1, y1, x2, y2 }).second)
+			continue;
+
+		// Add line between cell centers
+		auto col = lineColour(line);
+		lod.lines.push_back({ static_cast<float>((x1 + 0.5) * cell_size),
+							  static_cast<float>((y1 + 0.5) * cell_size),
+							  col.fr(),
+							  col.fg(),
+							  col.fb(),
+							  col.fa() });
+		lod.lines.push_back({ static_cast<float>((x2 + 0.5) * cell_size),
+							  static_cast<float>((y2 + 0.5) * cell_size),
+							  col.fr(),
+							  col.fg(),
+							  col.fb(),
+							  col.fa() });
+	}
+
+	// Vertices (one per occupied cell)
+	std::set<std::pair<int64_t, int64_t>> vertices_added;
+	for (unsigned a = 0; a < map_->nVertices(); a++)
+	{
+		auto vertex = map_->vertex(a);
+		auto x      = cell_coord(vertex->xPos());
+		auto y      = cell_coord(vertex->yPos());
+		if (vertices_added.insert({ x, y }).second)
+		{
+			lod.vertices.push_back(static_cast<float>((x + 0.5) * cell_size));
+			lod.vertices.push_back(static_cast<float>((y + 0.5) * cell_size));
+		}
+	}
+
+	log::info(
+		3,
+		"Built LOD geometry for zoom band {}: {} lines, {} vertices",
+		band,
+		lod.lines.size() / 2,
+		lod.vertices.size() / 2);
+
+	return lod;
+}
+
+// -----------------------------------------------------------------------------
+// Renders simplified map lines for zoom [band]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderLinesLOD(int band, float alpha)
+{
+	auto& lod = lodGeometry(band);
+	if (lod.lines.empty())
+		return;
+
+	// Update VBO if needed. As with the full lines VBO, the overall alpha is
+	// part of the VBO colours if the lines shader isn't available
+	auto& shader     = linesShader();
+	float base_alpha = shader.isValid() ? 1.0f : alpha;
+	if (vbo_lod_lines_ == 0)
+		glGenBuffers(1, &vbo_lod_lines_);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lod_lines_);
+	if (lod_lines_band_ != band || lod_lines_alpha_ != base_alpha)
+	{
+		if (base_alpha == 1.0f)
+			glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * lod.lines.size(), lod.lines.data(), GL_STATIC_DRAW);
+		else
+		{
+			auto lines = lod.lines;
+			for (auto& vert : lines)
+				vert.a *= base_alpha;
+			glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * lines.size(), lines.data(), GL_STATIC_DRAW);
+		}
+
+		lod_lines_band_  = band;
+		lod_lines_alpha_ = base_alpha;
+	}
+
+	// Set VBO arrays to use
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 24, nullptr);
+	glColorPointer(4, GL_FLOAT, 24, ((char*)nullptr + 8));
+
+	// Setup shader
+	if (shader.isValid())
+	{
+		shader.bind();
+		shader.setUniform("alpha", alpha);
+	}
+
+	// Render the VBO
+	glDrawArrays(GL_LINES, 0, lod.lines.size());
+	frameprofiler::addDrawCalls();
+
+	// Clean state
+	if (shader.isValid())
+		gl::Shader::unbind();
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Renders simplified map vertices for zoom [band]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderVerticesLOD(int band)
+{
+	auto& lod = lodGeometry(band);
+	if (lod.vertices.empty())
+		return;
+
+	// Update VBO if needed
+	if (vbo_lod_vertices_ == 0)
+		glGenBuffers(1, &vbo_lod_vertices_);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lod_vertices_);
+	if (lod_vertices_band_ != band)
+	{
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * lod.vertices.size(), lod.vertices.data(), GL_STATIC_DRAW);
+		lod_vertices_band_ = band;
+	}
+
+	// Render the VBO
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, nullptr);
+	glDrawArrays(GL_POINTS, 0, lod.vertices.size() / 2);
+	frameprofiler::addDrawCalls();
+
+	// Cleanup state
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 // -----------------------------------------------------------------------------
 // Renders the line hilight overlay for line [index]
 // -----------------------------------------------------------------------------
@@ -795,24 +1204,7 @@ void MapRenderer2D::renderRoundThing(
 	// --- Determine texture to use ---
 	unsigned tex    = 0;
 	bool     rotate = false;
-
-	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	auto     colour = thingColour(type, args, alpha);
 
 	// Check for custom thing icon
 	if (!type.icon().empty() && !thing_force_dir && !things_angles_)
@@ -845,36 +1237,11 @@ void MapRenderer2D::renderRoundThing(
 		return;
 	}
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
-	// Rotate if needed
-	if (rotate)
-	{
-		glPushMatrix();
-		glTranslated(x, y, 0);
-		glRotated(angle, 0, 0, 1);
-		x = y = 0;
-	}
-
-	// Draw thing
+	// Draw thing (rotated to angle if needed)
 	double radius = type.radius() * radius_mult;
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
-
-	// Restore previous matrix if rotated
-	if (rotate)
-		glPopMatrix();
+	drawThingQuad(tex, x, y, radius, radius, colour, rotate ? angle : 0.);
 }
 
 // -----------------------------------------------------------------------------
@@ -906,7 +1273,7 @@ bool MapRenderer2D::renderSpriteThing(
 	// Attempt to get sprite texture
 	if (!tex)
 	{
-		tex = mapeditor::textureManager().sprite(type.sprite(), type.translation(), type.palette()).gl_id;
+		tex = mapeditor::textureManager().sprite(type).gl_id;
 
 		if (index < thing_sprites_.size())
 		{
@@ -929,9 +1296,6 @@ bool MapRenderer2D::renderSpriteThing(
 	if (type.angled() || thing_force_dir || things_angles_)
 		show_angle = true;
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
 	// Draw thing
 	auto&  tex_info = gl::Texture::info(tex);
 	double hw       = tex_info.size.x * 0.5;
@@ -951,41 +1315,13 @@ bool MapRenderer2D::renderSpriteThing(
 		double sz = (min(hw, hh)) * 0.1;
 		if (sz < 1)
 			sz = 1;
-		glColor4f(0.0f, 0.0f, 0.0f, alpha * (thing_shadow * 0.7));
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - hw - sz, y - hh - sz);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - hw - sz, y + hh + sz);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + hw + sz, y + hh + sz);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + hw + sz, y - hh - sz);
-		glEnd();
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - hw - sz, y - hh - sz - sz);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - hw - sz, y + hh + sz);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + hw + sz + sz, y + hh + sz);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + hw + sz + sz, y - hh - sz - sz);
-		glEnd();
+		ColRGBA shadow_col{ 0, 0, 0, static_cast<uint8_t>(alpha * thing_shadow * 0.7f * 255.f) };
+		drawThingQuad(tex, x, y, hw + sz, hh + sz, shadow_col);
+		drawThingQuad(tex, x + sz * 0.5, y - sz * 0.5, hw + sz * 1.5, hh + sz * 1.5, shadow_col);
 	}
-	// Draw thing
-	glColor4f(1.0f, 1.0f, 1.0f, alpha);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - hw, y - hh);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - hw, y + hh);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + hw, y + hh);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + hw, y - hh);
-	glEnd();
 
+	// Draw thing
+	drawThingQuad(tex, x, y, hw, hh, { 255, 255, 255, static_cast<uint8_t>(alpha * 255.f) });
 
 	return show_angle;
 }
@@ -1004,25 +1340,8 @@ bool MapRenderer2D::renderSquareThing(
 	bool                     framed) const
 {
 	// --- Determine texture to use ---
-	unsigned tex = 0;
-
-	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	unsigned tex    = 0;
+	auto     colour = thingColour(type, args, alpha);
 
 	// Show icon anyway if no sprite set
 	if (type.sprite().empty())
@@ -1092,33 +1411,11 @@ bool MapRenderer2D::renderSquareThing(
 		return false;
 	}
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
 	// Draw thing
 	double radius = type.radius();
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
-	glBegin(GL_QUADS);
-	int tc = tc_start;
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
+	drawThingQuad(tex, x, y, radius, radius, colour, 0., tc_start);
 
 	return ((type.angled() || thing_force_dir || things_angles_) && !showicon);
 }
@@ -1154,22 +1451,8 @@ void MapRenderer2D::renderSimpleSquareThing(
 	glEnd();
 
 	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	auto colour = thingColour(type, args, alpha);
+	glColor4ub(colour.r, colour.g, colour.b, colour.a);
 
 	// Draw base
 	glBegin(GL_QUADS);
@@ -1195,62 +1478,151 @@ void MapRenderer2D::renderSimpleSquareThing(
 }
 
 // -----------------------------------------------------------------------------
-// Renders map things
-// -----------------------------------------------------------------------------
-void MapRenderer2D::renderThings(float alpha, bool force_dir)
+// Draws a textured quad for a thing using texture [tex], centered at [x,y] with
+// half-size [hw,hh], rotated by [angle] degrees. [tc_start] is the index into
+// sq_thing_tc to start texture coordinates at.
+// If a thing batch is currently active the quad is added to it rather than
+// being drawn immediately
+// -----------------------------------------------------------------------------
+void MapRenderer2D::drawThingQuad(
+	unsigned       tex,
+	double         x,
+	double         y,
+	double         hw,
+	double         hh,
+	const ColRGBA& colour,
+	double         angle,
+	int            tc_start) const
 {
-	// Don't bother if (practically) invisible
-	if (alpha <= 0.01f)
+	// Determine corners
+	double cx[] = { -hw, -hw, hw, hw };
+	double cy[] = { -hh, hh, hh, -hh };
+	if (angle != 0.)
+	{
+		double rad = math::degToRad(angle);
+		double c   = cos(rad);
+		double s   = sin(rad);
+		for (unsigned a = 0; a < 4; a++)
+		{
+			double rx = cx[a] * c - cy[a] * s;
+			double ry = cx[a] * s + cy[a] * c;
+			cx[a]     = rx;
+			cy[a]     = ry;
+		}
+	}
+
+	// Add to batch if active
+	int tc = tc_start;
+	if (thing_batch_)
+	{
+		auto& verts = (*thing_batch_)[tex];
+		for (unsigned a = 0; a < 4; a++)
+		{
+			verts.push_back({ static_cast<float>(x + cx[a]),
+							  static_cast<float>(y + cy[a]),
+							  sq_thing_tc[tc],
+							  sq_thing_tc[tc + 1],
+							  colour.r,
+							  colour.g,
+							  colour.b,
+							  colour.a });
+			tc = (tc + 2) % 8;
+		}
 		return;
+	}
 
-	things_angles_ = force_dir;
-	renderThingsImmediate(alpha);
+	// Otherwise draw now
+	gl::Texture::bind(tex, false);
+	glColor4ub(colour.r, colour.g, colour.b, colour.a);
+	glBegin(GL_QUADS);
+	for (unsigned a = 0; a < 4; a++)
+	{
+		glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
+		glVertex2d(x + cx[a], y + cy[a]);
+		tc = (tc + 2) % 8;
+	}
+	glEnd();
+	frameprofiler::addDrawCalls();
 }
 
 // -----------------------------------------------------------------------------
-// Renders map things in immediate mode
+// Draws all quads in thing [batch], with one draw call per texture
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderThingsImmediate(float alpha)
+void MapRenderer2D::renderThingQuadBatch(const ThingQuadBatch& batch)
 {
-	// Display lists aren't really good for this, better to check for
-	// visibility and just render things in immediate mode
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
 
-	// Enable textures
-	glEnable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, alpha);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	for (auto& [tex, verts] : batch)
+	{
+		if (verts.empty())
+			continue;
 
-	// Go through things
-	MapThing*   thing;
-	double      x, y, angle;
-	vector<int> things_arrows;
-	long        last_update = thing_sprites_updated_;
+		gl::Texture::bind(tex, false);
+		glVertexPointer(2, GL_FLOAT, sizeof(ThingQuadVert), &verts[0].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(ThingQuadVert), &verts[0].u);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ThingQuadVert), &verts[0].r);
+		glDrawArrays(GL_QUADS, 0, verts.size());
+		frameprofiler::addDrawCalls();
+	}
 
-	// Draw thing shadows if needed
-	if (thing_shadow > 0.01f && thing_drawtype != ThingDrawType::Sprite)
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// -----------------------------------------------------------------------------
+// Renders map things
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderThings(float alpha, bool force_dir)
+{
+	PROFILE_ZONE("MapRenderer2D::renderThings");
+
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Things);
+
+	// Don't bother if (practically) invisible
+	if (alpha <= 0.01f)
+		return;
+
+	things_angles_ = force_dir;
+	renderThingsImmediate(alpha);
+}
+
+// -----------------------------------------------------------------------------
+// Renders map things.
+// Thing quads are collected into batches grouped by texture as each thing is
+// processed, and each batch is drawn with a single call per texture
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderThingsImmediate(float alpha)
+{
+	// Enable textures
+	glEnable(GL_TEXTURE_2D);
+	glColor4f(1.0f, 1.0f, 1.0f, alpha);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Go through things
+	MapThing*      thing;
+	double         x, y, angle;
+	vector<int>    things_arrows;
+	long           last_update = thing_sprites_updated_;
+	ThingQuadBatch batch;
+
+	// Draw thing shadows if needed
+	if (thing_shadow > 0.01f && thing_drawtype != ThingDrawType::Sprite)
 	{
-		glEnable(GL_TEXTURE_2D);
 		auto tex_shadow = mapeditor::textureManager().editorImage("thing/shadow").gl_id;
 		if (thing_drawtype == ThingDrawType::Square || thing_drawtype == ThingDrawType::SquareSprite
 			|| thing_drawtype == ThingDrawType::FramedSprite)
 			tex_shadow = mapeditor::textureManager().editorImage("thing/square/shadow").gl_id;
 		if (tex_shadow)
 		{
-			gl::Texture::bind(tex_shadow);
-			glColor4f(0.0f, 0.0f, 0.0f, alpha * thing_shadow);
-
-			// Setup point sprites if supported
-			bool point = false;
-			if (gl::pointSpriteSupport())
-			{
-				glEnable(GL_POINT_SPRITE);
-				glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
-				point = true;
-			}
+			ColRGBA shadow_col{ 0, 0, 0, static_cast<uint8_t>(alpha * thing_shadow * 255.f) };
+			thing_batch_ = &batch;
 
-			for (unsigned a = 0; a < map_->nThings(); a++)
+			for (auto a : vis_list_t_)
 			{
-				if (vis_t_[a] > 0)
+				if (a >= map_->nThings() || vis_t_[a] > 0)
 					continue;
 
 				// No shadow if filtered
@@ -1264,48 +1636,23 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				if (tt.shrinkOnZoom())
 					radius = scaledRadius(radius);
 				radius *= 1.3;
-				x = thing->xPos();
-				y = thing->yPos();
 
-				// Draw shadow
-				if (point && radius * 2 * view_scale_ <= gl::maxPointSize())
-				{
-					// Point sprite
-					glPointSize(radius * 2 * view_scale_);
-					glBegin(GL_POINTS);
-					glVertex2d(x, y);
-					glEnd();
-				}
-				else
-				{
-					// Textured quad
-					if (point)
-						glDisable(GL_POINT_SPRITE);
-					glBegin(GL_QUADS);
-					glTexCoord2f(0.0f, 1.0f);
-					glVertex2d(x - radius, y - radius);
-					glTexCoord2f(0.0f, 0.0f);
-					glVertex2d(x - radius, y + radius);
-					glTexCoord2f(1.0f, 0.0f);
-					glVertex2d(x + radius, y + radius);
-					glTexCoord2f(1.0f, 1.0f);
-					glVertex2d(x + radius, y - radius);
-					glEnd();
-					if (point)
-						glEnable(GL_POINT_SPRITE);
-				}
+				// Add shadow
+				drawThingQuad(tex_shadow, thing->xPos(), thing->yPos(), radius, radius, shadow_col);
 			}
 
-			if (point)
-				glDisable(GL_POINT_SPRITE);
+			thing_batch_ = nullptr;
+			renderThingQuadBatch(batch);
+			batch.clear();
 		}
 	}
 
 	// Draw things
 	double talpha;
-	for (unsigned a = 0; a < map_->nThings(); a++)
+	thing_batch_ = &batch;
+	for (auto a : vis_list_t_)
 	{
-		if (vis_t_[a] > 0)
+		if (a >= map_->nThings() || vis_t_[a] > 0)
 			continue;
 
 		// Get thing info
@@ -1350,15 +1697,17 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				things_arrows.push_back(a);
 		}
 	}
+	thing_batch_ = nullptr;
+	renderThingQuadBatch(batch);
+	batch.clear();
 
 	// Draw thing sprites within squares if that drawtype is set
 	if (thing_drawtype > ThingDrawType::Sprite)
 	{
-		glEnable(GL_TEXTURE_2D);
-
-		for (unsigned a = 0; a < map_->nThings(); a++)
+		thing_batch_ = &batch;
+		for (auto a : vis_list_t_)
 		{
-			if (vis_t_[a] > 0)
+			if (a >= map_->nThings() || vis_t_[a] > 0)
 				continue;
 
 			// Get thing info
@@ -1378,54 +1727,38 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 
 			renderSpriteThing(x, y, thing->angle(), tt, thing->args(), a, talpha, true);
 		}
+		thing_batch_ = nullptr;
+		renderThingQuadBatch(batch);
+		batch.clear();
 	}
 
 	// Draw any thing direction arrows needed
 	if (!things_arrows.empty())
 	{
-		auto acol = ColRGBA::WHITE;
-		acol.a    = 255 * alpha * arrow_alpha;
-		gl::setColour(acol);
-		// glColor4f(1.0f, 1.0f, 1.0f, alpha * arrow_alpha);
+		auto acol      = ColRGBA::WHITE;
+		acol.a         = 255 * alpha * arrow_alpha;
 		auto tex_arrow = mapeditor::textureManager().editorImage("arrow").gl_id;
 		if (tex_arrow)
 		{
-			glEnable(GL_TEXTURE_2D);
-			gl::Texture::bind(tex_arrow);
-
+			thing_batch_ = &batch;
 			for (int things_arrow : things_arrows)
 			{
 				thing = map_->thing(things_arrow);
+				auto col = acol;
 				if (arrow_colour)
 				{
 					auto& tt = game::configuration().thingType(thing->type());
 					if (tt.defined())
 					{
-						acol.set(tt.colour());
-						acol.a = 255 * alpha * arrow_alpha;
-						gl::setColour(acol);
+						col.set(tt.colour());
+						col.a = acol.a;
 					}
 				}
-				x = thing->xPos();
-				y = thing->yPos();
-
-				glPushMatrix();
-				glTranslated(x, y, 0);
-				glRotated(thing->angle(), 0, 0, 1);
-
-				glBegin(GL_QUADS);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex2d(-32, -32);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex2d(-32, 32);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex2d(32, 32);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex2d(32, -32);
-				glEnd();
 
-				glPopMatrix();
+				drawThingQuad(tex_arrow, thing->xPos(), thing->yPos(), 32., 32., col, thing->angle());
 			}
+			thing_batch_ = nullptr;
+			renderThingQuadBatch(batch);
 		}
 	}
 
@@ -1861,88 +2194,126 @@ void MapRenderer2D::renderPathedThings(vector<MapThing*>& things)
 }
 
 // -----------------------------------------------------------------------------
-// Renders point light previews
+// Renders point light previews. All lights are drawn additively in a single
+// batch, which is only rebuilt when things are modified
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index) const
+void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index)
 {
 	if (!thing_preview_lights)
 		return;
-	
-	ColRGBA light_col{ 0, 0, 0, static_cast<uint8_t>(alpha * (thing_light_intensity * 255.f)) };
-	double  light_radius = 0.;
-\
-	glEnable(GL_TEXTURE_2D);
-	const auto light_tex = mapeditor::textureManager().editorImage("thing/light_preview").gl_id;
-	gl::Texture::bind(light_tex);
 
-	for (const auto& thing : map_->things())
-	{
-		const auto& ttype = game::configuration().thingType(thing->type());
+	// Check if the light quads need updating
+	if (map_->nThings() != lights_n_things_ || map_->thingsUpdated() > lights_updated_
+		|| map_->mapData().lastRemovedTime() > lights_updated_ || lights_intensity_ != thing_light_intensity)
+		updatePointLights();
 
-		// Not a point light
-		if (ttype.pointLight().empty())
-			continue;
-
-		// ZDoom point light
-		if (ttype.pointLight() == "zdoom")
+	if (!light_verts_.empty())
+	{
+		auto& shader = lightsShader();
+		if (shader.isValid())
 		{
-			light_col.r  = thing->arg(0);
-			light_col.g  = thing->arg(1);
-			light_col.b  = thing->arg(2);
-			light_radius = thing->arg(3);
+			glDisable(GL_TEXTURE_2D);
+			shader.bind();
+			shader.setUniform("alpha", alpha);
 		}
-
-		// Vavoom point light
-		else if (ttype.pointLight() == "vavoom")
+		else
 		{
-			light_col.r  = thing->arg(1);
-			light_col.g  = thing->arg(2);
-			light_col.b  = thing->arg(3);
-			light_radius = thing->arg(0);
+			glEnable(GL_TEXTURE_2D);
+			gl::Texture::bind(mapeditor::textureManager().editorImage("thing/light_preview").gl_id);
 		}
 
-		// Vavoom white light
-		else if (ttype.pointLight() == "vavoom_white")
+		// Without shaders the overall alpha has to be applied to the vertex colours
+		auto* verts = &light_verts_;
+		if (!shader.isValid() && alpha < 1.0f)
 		{
-			light_col.r  = 255;
-			light_col.g  = 255;
-			light_col.b  = 255;
-			light_radius = thing->arg(0);
+			light_verts_faded_ = light_verts_;
+			for (auto& vert : light_verts_faded_)
+				vert.a = static_cast<uint8_t>(vert.a * alpha);
+			verts = &light_verts_faded_;
 		}
 
-		light_radius *= 2; // Doubling the radius value matches better with in-game results
-		gl::setColour(light_col, gl::Blend::Additive);
+		// Draw all lights
+		gl::setBlend(gl::Blend::Additive);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(ThingQuadVert), &(*verts)[0].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(ThingQuadVert), &(*verts)[0].u);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ThingQuadVert), &(*verts)[0].r);
+		glDrawArrays(GL_QUADS, 0, verts->size());
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		frameprofiler::addDrawCalls();
 
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(thing->xPos() - light_radius, thing->yPos() - light_radius);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(thing->xPos() + light_radius, thing->yPos() - light_radius);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(thing->xPos() + light_radius, thing->yPos() + light_radius);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(thing->xPos() - light_radius, thing->yPos() + light_radius);
-		glEnd();
+		if (shader.isValid())
+			gl::Shader::unbind();
+	}
 
-		// Draw radius circle if the thing is the current hilight
-		if (hilight_index >= 0 && thing->index() == hilight_index)
+	// Draw radius circle if the hilighted thing is a light
+	if (hilight_index >= 0)
+	{
+		if (auto* thing = map_->thing(hilight_index))
 		{
-			auto col = light_col;
-			col.a = 180;
-			glDisable(GL_TEXTURE_2D);
-			glLineWidth(2.f);
-			drawing::drawEllipse(thing->position(), light_radius, light_radius, 64, col);
-			glEnable(GL_TEXTURE_2D);
+			const auto& ttype = game::configuration().thingType(thing->type());
+			if (!ttype.pointLight().empty())
+			{
+				auto radius = pointLightRadius(ttype, thing->args());
+				auto col    = thingColour(ttype, thing->args(), 180.f / 255.f);
+				glDisable(GL_TEXTURE_2D);
+				glLineWidth(2.f);
+				drawing::drawEllipse(thing->position(), radius, radius, 64, col);
+			}
 		}
 	}
+
+	gl::setBlend(gl::Blend::Normal);
+	glEnable(GL_TEXTURE_2D);
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the point light preview quads for all point light things
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updatePointLights()
+{
+	light_verts_.clear();
+	for (const auto& thing : map_->things())
+	{
+		const auto& ttype = game::configuration().thingType(thing->type());
+
+		// Not a point light
+		if (ttype.pointLight().empty())
+			continue;
+
+		auto radius = pointLightRadius(ttype, thing->args());
+		if (radius <= 0.)
+			continue;
+
+		auto  col = thingColour(ttype, thing->args(), thing_light_intensity);
+		float x1  = thing->xPos() - radius;
+		float y1  = thing->yPos() - radius;
+		float x2  = thing->xPos() + radius;
+		float y2  = thing->yPos() + radius;
+		light_verts_.push_back({ x1, y1, 0.0f, 0.0f, col.r, col.g, col.b, col.a });
+		light_verts_.push_back({ x2, y1, 1.0f, 0.0f, col.r, col.g, col.b, col.a });
+		light_verts_.push_back({ x2, y2, 1.0f, 1.0f, col.r, col.g, col.b, col.a });
+		light_verts_.push_back({ x1, y2, 0.0f, 1.0f, col.r, col.g, col.b, col.a });
+	}
+
+	lights_n_things_  = map_->nThings();
+	lights_intensity_ = thing_light_intensity;
+	lights_updated_   = app::runTimer();
+}
 
 // -----------------------------------------------------------------------------
 // Renders map flats (sectors)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderFlats(int type, bool texture, float alpha)
 {
+	PROFILE_ZONE("MapRenderer2D::renderFlats");
+
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Flats);
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
@@ -1969,7 +2340,6 @@ bool sortPolyByTex(Polygon2D* left, Polygon2D* right)
 void MapRenderer2D::renderFlatsImmediate(int type, bool texture, float alpha)
 {
 	using game::Feature;
-	using game::UDMFFeature;
 
 	if (texture)
 	{
@@ -1995,14 +2365,14 @@ void MapRenderer2D::renderFlatsImmediate(int type, bool texture, float alpha)
 	// Go through sectors
 	unsigned tex_last = 0;
 	unsigned tex      = 0;
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	for (auto a : vis_list_s_)
 	{
-		auto sector = map_->sector(a);
-
 		// Skip if sector is out of view
-		if (vis_s_[a] > 0)
+		if (a >= map_->nSectors() || vis_s_[a] > 0)
 			continue;
 
+		auto sector = map_->sector(a);
+
 		const MapTextureManager::Texture* map_tex_props = nullptr;
 		if (texture)
 		{
@@ -2047,42 +2417,7 @@ void MapRenderer2D::renderFlatsImmediate(int type, bool texture, float alpha)
 			double sx  = map_tex_props ? map_tex_props->scale.x : 1.;
 			double sy  = map_tex_props ? map_tex_props->scale.y : 1.;
 			double rot = 0.;
-			// Check for various UDMF extensions
-			if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF)
-			{
-				// Floor
-				if (type <= 1)
-				{
-					if (game::configuration().featureSupported(UDMFFeature::FlatPanning))
-					{
-						ox = sector->floatProperty("xpanningfloor");
-						oy = sector->floatProperty("ypanningfloor");
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatScaling))
-					{
-						sx *= (1.0 / sector->floatProperty("xscalefloor"));
-						sy *= (1.0 / sector->floatProperty("yscalefloor"));
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatRotation))
-						rot = sector->floatProperty("rotationfloor");
-				}
-				// Ceiling
-				else
-				{
-					if (game::configuration().featureSupported(UDMFFeature::FlatPanning))
-					{
-						ox = sector->floatProperty("xpanningceiling");
-						oy = sector->floatProperty("ypanningceiling");
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatScaling))
-					{
-						sx *= (1.0 / sector->floatProperty("xscaleceiling"));
-						sy *= (1.0 / sector->floatProperty("yscaleceiling"));
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatRotation))
-						rot = sector->floatProperty("rotationceiling");
-				}
-			}
+			applyFlatTexProperties(sector, type, sx, sy, ox, oy, rot);
 
 			poly->updateTextureCoords(sx, sy, ox, oy, rot);
 		}
@@ -2095,6 +2430,7 @@ void MapRenderer2D::renderFlatsImmediate(int type, bool texture, float alpha)
 			glColor4f(col.fr(), col.fg(), col.fb(), alpha);
 		}
 		poly->render();
+		frameprofiler::addDrawCalls();
 	}
 
 	if (texture)
@@ -2107,13 +2443,9 @@ void MapRenderer2D::renderFlatsImmediate(int type, bool texture, float alpha)
 void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 {
 	using game::Feature;
-	using game::UDMFFeature;
 
 	bool vbo_updated = false;
 
-	if (flat_ignore_light)
-		glColor4f(flat_brightness, flat_brightness, flat_brightness, alpha);
-
 	if (!glGenBuffers)
 		return;
 
@@ -2131,46 +2463,71 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		last_flat_type_ = type;
 	}
 
-	// First, check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	// Texture coordinates are calculated in the shader if supported (all flat
+	// textures need to be looked up again if the transforms list is re-init,
+	// since transforms are only updated along with the texture)
+	auto& shader = flatsShader();
+	if (texture && shader.isValid() && flat_tex_transforms_.size() != tex_flats_.size())
 	{
-		auto poly = map_->sector(a)->polygon();
-		if (poly && poly->vboUpdate() > 1)
+		flat_tex_transforms_.clear();
+		flat_tex_transforms_.resize(tex_flats_.size());
+		std::fill(tex_flats_.begin(), tex_flats_.end(), 0);
+	}
+
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
+		// Rebuild any outdated sector polygons
+		map_->sectors().updatePolygons();
+
+		// Refresh the entire vbo if sectors were added or removed (indices may
+		// have been compacted)
+		if (vbo_flats_ == 0 || map_->nSectors() != n_sectors_ || map_->mapData().lastRemovedTime() > flats_updated_)
 		{
 			updateFlatsVBO();
 			vbo_updated = true;
 		}
-	}
 
-	// Create VBO if necessary
-	if (!vbo_updated && vbo_flats_ == 0)
-	{
-		updateFlatsVBO();
-		vbo_updated = true;
-	}
+		// Setup opengl state
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 
-	// Setup opengl state
-	if (texture)
-		glEnable(GL_TEXTURE_2D);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+		// Check if any polygon vertex data has changed, and rewrite it in place
+		// if possible (otherwise we need to refresh the entire vbo)
+		for (unsigned a = 0; a < map_->nSectors() && !vbo_updated; a++)
+		{
+			auto poly = map_->sector(a)->polygon();
+			if (poly && poly->vboUpdate() > 1 && !poly->rewriteVBO())
+			{
+				updateFlatsVBO();
+				glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+				vbo_updated = true;
+			}
+		}
+	}
 
 	// Setup VBO pointers
 	Polygon2D::setupVBOPointers();
 
-	// Go through sectors
-	unsigned tex_last = 0;
-	unsigned tex      = 0;
-	bool     first    = true;
-	unsigned update   = 0;
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	// Go through sectors, getting the texture and colour (material) of each
+	// visible flat so they can be drawn in batches
+	struct FlatBatchItem
+	{
+		unsigned                tex;
+		ColRGBA                 colour;
+		Polygon2D*              poly;
+		const FlatTexTransform* transform; // Only if using the shader
+	};
+	vector<FlatBatchItem> batch;
+	unsigned              tex    = 0;
+	unsigned              update = 0;
+	for (auto a : vis_list_s_)
 	{
-		auto sector = map_->sector(a);
-
 		// Skip if sector is out of view
-		if (vis_s_[a] > 0)
+		if (a >= map_->nSectors() || vis_s_[a] > 0)
 			continue;
 
-		first                                           = false;
+		auto sector = map_->sector(a);
+
 		const MapTextureManager::Texture* map_tex_props = nullptr;
 		if (texture)
 		{
@@ -2192,7 +2549,39 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 
 		// Setup polygon texture info if needed
 		auto poly = sector->polygon();
-		if (texture && poly->texture() != tex)
+		if (texture && shader.isValid())
+		{
+			// Only the texture transform needs updating, and only if the
+			// texture was looked up again (ie. it or the sector changed)
+			if (map_tex_props)
+			{
+				double ox  = 0.;
+				double oy  = 0.;
+				double sx  = map_tex_props->scale.x;
+				double sy  = map_tex_props->scale.y;
+				double rot = 0.;
+				applyFlatTexProperties(sector, type, sx, sy, ox, oy, rot);
+
+				// Equivalent to Polygon2D::updateTextureCoords, with the
+				// offsets scaled by the texture scale as below
+				auto&  tex_info = gl::Texture::info(tex);
+				double width    = tex_info.size.x > 0 ? tex_info.size.x : 1;
+				double height   = tex_info.size.y > 0 ? tex_info.size.y : 1;
+				if (sx == 0)
+					sx = 1;
+				if (sy == 0)
+					sy = 1;
+
+				auto& transform    = flat_tex_transforms_[a];
+				transform.scale_x  = 1.0 / (sx * width);
+				transform.scale_y  = 1.0 / (sy * height);
+				transform.offset_x = ox / (sx * width);
+				transform.offset_y = oy / (sy * height);
+				transform.rot_cos  = cos(math::degToRad(rot));
+				transform.rot_sin  = sin(math::degToRad(rot));
+			}
+		}
+		else if (texture && poly->texture() != tex)
 		{
 			poly->setTexture(tex); // Set polygon texture
 
@@ -2202,42 +2591,8 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 			double sx  = map_tex_props ? map_tex_props->scale.x : 1.;
 			double sy  = map_tex_props ? map_tex_props->scale.y : 1.;
 			double rot = 0.;
-			// Check for various UDMF extensions
-			if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF)
-			{
-				// Floor
-				if (type <= 1)
-				{
-					if (game::configuration().featureSupported(UDMFFeature::FlatPanning))
-					{
-						ox = sector->floatProperty("xpanningfloor");
-						oy = sector->floatProperty("ypanningfloor");
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatScaling))
-					{
-						sx *= (1.0 / sector->floatProperty("xscalefloor"));
-						sy *= (1.0 / sector->floatProperty("yscalefloor"));
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatRotation))
-						rot = sector->floatProperty("rotationfloor");
-				}
-				// Ceiling
-				else
-				{
-					if (game::configuration().featureSupported(UDMFFeature::FlatPanning))
-					{
-						ox = sector->floatProperty("xpanningceiling");
-						oy = sector->floatProperty("ypanningceiling");
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatScaling))
-					{
-						sx *= (1.0 / sector->floatProperty("xscaleceiling"));
-						sy *= (1.0 / sector->floatProperty("yscaleceiling"));
-					}
-					if (game::configuration().featureSupported(UDMFFeature::FlatRotation))
-						rot = sector->floatProperty("rotationceiling");
-				}
-			}
+			applyFlatTexProperties(sector, type, sx, sy, ox, oy, rot);
+
 			// Scaling applies to offsets as well.
 			// Note for posterity: worldpanning only applies to textures, not flats
 			ox /= sx;
@@ -2255,33 +2610,99 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 				break;
 		}
 
-		// Bind the texture if needed
-		if (tex)
+		// Add to batch
+		ColRGBA col{ 255, 255, 255 };
+		if (flat_ignore_light)
+			col = col.ampf(flat_brightness, flat_brightness, flat_brightness, 1.0f);
+		else
+			col = sector->colourAt(type).ampf(flat_brightness, flat_brightness, flat_brightness, 1.0f);
+		batch.push_back({ texture ? tex : 0,
+						  col,
+						  poly,
+						  texture && tex && shader.isValid() ? &flat_tex_transforms_[a] : nullptr });
+	}
+
+	// Sort by material (and texture transform, if using the shader)
+	auto colKey       = [](const ColRGBA& col) { return (col.r << 16) | (col.g << 8) | col.b; };
+	auto transformKey = [](const FlatTexTransform* t) {
+		return t ? std::make_tuple(t->scale_x, t->scale_y, t->offset_x, t->offset_y, t->rot_cos, t->rot_sin) :
+				   std::make_tuple(0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+	};
+	auto sameMaterial = [&](const FlatBatchItem& left, const FlatBatchItem& right) {
+		return left.tex == right.tex && colKey(left.colour) == colKey(right.colour)
+			   && transformKey(left.transform) == transformKey(right.transform);
+	};
+	std::sort(batch.begin(), batch.end(), [&](const FlatBatchItem& left, const FlatBatchItem& right) {
+		if (left.tex != right.tex)
+			return left.tex < right.tex;
+		if (colKey(left.colour) != colKey(right.colour))
+			return colKey(left.colour) < colKey(right.colour);
+		return transformKey(left.transform) < transformKey(right.transform);
+	});
+
+	// Draw each run of flats with the same material in a single call
+	vector<GLint>   firsts;
+	vector<GLsizei> counts;
+	bool            shader_bound = false;
+	for (size_t start = 0; start < batch.size();)
+	{
+		const auto& item = batch[start];
+
+		// Collect sub-polygons of all flats in the run
+		firsts.clear();
+		counts.clear();
+		auto end = start;
+		for (; end < batch.size() && sameMaterial(batch[end], item); ++end)
 		{
-			if (!tex_last || first)
-				glEnable(GL_TEXTURE_2D);
-			if (tex != tex_last)
-				gl::Texture::bind(tex);
+			auto poly = batch[end].poly;
+			for (unsigned a = 0; a < poly->nSubPolys(); a++)
+			{
+				auto subpoly = poly->subPoly(a);
+				firsts.push_back(subpoly->vbo_index);
+				counts.push_back(subpoly->vertices.size());
+			}
 		}
-		else if (!tex_last || first)
-			glDisable(GL_TEXTURE_2D);
-		tex_last = tex;
 
-		// Render the polygon
-		if (!flat_ignore_light)
+		// Setup material
+		if (item.tex)
 		{
-			auto col = sector->colourAt(type);
-			col.ampf(flat_brightness, flat_brightness, flat_brightness, 1.0f);
-			glColor4f(col.fr(), col.fg(), col.fb(), alpha);
+			glEnable(GL_TEXTURE_2D);
+			gl::Texture::bind(item.tex);
+		}
+		else
+			glDisable(GL_TEXTURE_2D);
+		glColor4f(item.colour.fr(), item.colour.fg(), item.colour.fb(), alpha);
+		if (item.transform)
+		{
+			if (!shader_bound)
+				shader.bind();
+			shader_bound = true;
+			shader.setUniform(
+				"tex_transform",
+				item.transform->scale_x,
+				item.transform->scale_y,
+				item.transform->offset_x,
+				item.transform->offset_y);
+			shader.setUniform("tex_rotation", item.transform->rot_cos, item.transform->rot_sin);
+		}
+		else if (shader_bound)
+		{
+			gl::Shader::unbind();
+			shader_bound = false;
 		}
-		poly->renderVBO(false);
+
+		glMultiDrawArrays(GL_TRIANGLE_FAN, firsts.data(), counts.data(), firsts.size());
+		frameprofiler::addDrawCalls();
+
+		start = end;
 	}
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
 	// Clean up opengl state
-	if (texture)
-		glDisable(GL_TEXTURE_2D);
+	if (shader_bound)
+		gl::Shader::unbind();
+	glDisable(GL_TEXTURE_2D);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -2487,194 +2908,240 @@ void MapRenderer2D::renderTaggedFlats(vector<MapSector*>& sectors, float fade) c
 }
 
 // -----------------------------------------------------------------------------
-// Renders the moving overlay for vertex indices in [vertices], to show movement
-// by [move_vec]
+// Returns the cached geometry for moving [items] (vertices, lines or sectors),
+// rebuilding it if the items or the map have changed since it was built.
+// Lines attached to the moving vertices are split into those moving entirely
+// and those with only one moving vertex, which need to be stretched each frame
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec) const
+const MapRenderer2D::MovingGeometry& MapRenderer2D::movingGeometry(const vector<mapeditor::Item>& items)
 {
-	vector<uint8_t> lines_drawn(map_->nLines(), 0);
-
-	// Determine what lines need drawing (and which of their vertices are being moved)
-	for (const auto& item : vertices)
-	{
-		if (auto v = item.asVertex(*map_))
+	// Check if the cached geometry is still valid
+	auto same_item = [](const mapeditor::Item& left, const mapeditor::Item& right) {
+		return left.index == right.index && left.type == right.type;
+	};
+	if (moving_.updated >= 0 && map_->geometryUpdated() <= moving_.updated
+		&& map_->mapData().lastModifiedTime() <= moving_.updated
+		&& std::equal(items.begin(), items.end(), moving_.items.begin(), moving_.items.end(), same_item))
+		return moving_;
+
+	moving_.items   = items;
+	moving_.updated = app::runTimer();
+	moving_.verts.clear();
+	moving_.partial.clear();
+	moving_.points = false;
+
+	// Get moving vertices and lines (for the overlay)
+	vector<MapVertex*> vertices;
+	vector<MapLine*>   overlay_lines;
+	vector<uint8_t>    line_added(map_->nLines(), 0);
+	for (const auto& item : items)
+	{
+		if (auto vertex = item.asVertex(*map_))
 		{
-			for (const auto& line : v->connectedLines())
+			vertices.push_back(vertex);
+			moving_.points = true;
+		}
+		else if (auto line = item.asLine(*map_))
+		{
+			if (!line_added[line->index()])
+			{
+				line_added[line->index()] = 1;
+				overlay_lines.push_back(line);
+			}
+		}
+		else if (auto sector = item.asSector(*map_))
+		{
+			for (auto& side : sector->connectedSides())
 			{
-				if (line->v1() == v)
-					lines_drawn[line->index()] |= 1;
-				if (line->v2() == v)
-					lines_drawn[line->index()] |= 2;
+				auto parent = side->parentLine();
+				if (!line_added[parent->index()])
+				{
+					line_added[parent->index()] = 1;
+					overlay_lines.push_back(parent);
+				}
 			}
 		}
 	}
+	for (auto line : overlay_lines)
+	{
+		vertices.push_back(line->v1());
+		vertices.push_back(line->v2());
+	}
 
-	// Draw any lines attached to the moving vertices
-	glLineWidth(line_width);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_LINES);
-	for (unsigned a = 0; a < map_->nLines(); a++)
+	// Determine what lines need drawing (and which of their vertices are being moved)
+	vector<uint8_t>  lines_drawn(map_->nLines(), 0);
+	vector<MapLine*> lines;
+	for (auto vertex : vertices)
 	{
-		auto line  = map_->line(a);
-		auto drawn = lines_drawn[line->index()];
+		for (auto line : vertex->connectedLines())
+		{
+			auto& drawn = lines_drawn[line->index()];
+			if (drawn == 0)
+				lines.push_back(line);
+			if (line->v1() == vertex)
+				drawn |= 1;
+			if (line->v2() == vertex)
+				drawn |= 2;
+		}
+	}
 
-		// Skip if not attached to any moving vertices
-		if (drawn == 0)
+	auto add_vert = [](vector<GLVert>& verts, Vec2d pos, const ColRGBA& col) {
+		verts.push_back({ (float)pos.x, (float)pos.y, col.fr(), col.fg(), col.fb(), col.fa() });
+	};
+
+	// Lines moving entirely
+	for (auto line : lines)
+	{
+		if (lines_drawn[line->index()] != 3)
 			continue;
 
-		// Set line colour
-		gl::setColour(lineColour(line, true));
+		auto col = lineColour(line, true);
+		add_vert(moving_.verts, line->start(), col);
+		add_vert(moving_.verts, line->end(), col);
+	}
+	moving_.n_lines = moving_.verts.size();
 
-		// First vertex
-		if (drawn & 1)
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-		else
-			glVertex2d(line->x1(), line->y1());
+	// Lines with one moving vertex
+	for (auto line : lines)
+	{
+		auto drawn = lines_drawn[line->index()];
+		if (drawn == 3)
+			continue;
 
-		// Second vertex
-		if (drawn & 2)
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
-		else
-			glVertex2d(line->x2(), line->y2());
+		auto col = lineColour(line, true);
+		add_vert(moving_.partial, drawn & 1 ? line->start() : line->end(), col);
+		add_vert(moving_.partial, drawn & 1 ? line->end() : line->start(), col);
 	}
-	glEnd();
-
-	// Set 'moving' colour
-	colourconfig::setGLColour("map_moving");
 
-	// Draw moving vertex overlays
-	bool point = setupVertexRendering(1.5f);
-	glBegin(GL_POINTS);
-	for (const auto& item : vertices)
+	// Overlay (colour is set when rendering)
+	if (moving_.points)
 	{
-		if (auto v = item.asVertex(*map_))
-			glVertex2d(v->xPos() + move_vec.x, v->yPos() + move_vec.y);
+		for (const auto& item : items)
+			if (auto vertex = item.asVertex(*map_))
+				add_vert(moving_.verts, vertex->position(), ColRGBA::WHITE);
+	}
+	else
+	{
+		for (auto line : overlay_lines)
+		{
+			add_vert(moving_.verts, line->start(), ColRGBA::WHITE);
+			add_vert(moving_.verts, line->end(), ColRGBA::WHITE);
+		}
 	}
-	glEnd();
 
-	// Clean up
-	if (point)
+	// Upload to VBO if supported
+	if (gl::vboSupport())
 	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
+		if (vbo_moving_ == 0)
+			glGenBuffers(1, &vbo_moving_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_moving_);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * moving_.verts.size(), moving_.verts.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
+
+	return moving_;
 }
 
 // -----------------------------------------------------------------------------
-// Renders the moving overlay for line indices in [lines], to show movement by
-// [move_vec]
+// Renders the cached [moving] geometry, to show movement by [move_vec]
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec) const
+void MapRenderer2D::renderMoving(const MovingGeometry& moving, Vec2d move_vec) const
 {
-	vector<uint8_t> lines_drawn(map_->nLines(), 0);
-
-	// Determine what lines need drawing (and which of their vertices are being moved)
-	for (const auto& item : lines)
-	{
-		if (auto line = item.asLine(*map_))
-		{
-			// Check first vertex
-			auto v = line->v1();
-			for (unsigned l = 0; l < v->nConnectedLines(); l++)
-			{
-				auto cline = v->connectedLine(l);
-
-				if (cline->v1() == v)
-					lines_drawn[cline->index()] |= 1;
-				if (cline->v2() == v)
-					lines_drawn[cline->index()] |= 2;
-			}
-
-			// Check second vertex
-			v = line->v2();
-			for (unsigned l = 0; l < v->nConnectedLines(); l++)
-			{
-				auto cline = v->connectedLine(l);
-
-				if (cline->v1() == v)
-					lines_drawn[cline->index()] |= 1;
-				if (cline->v2() == v)
-					lines_drawn[cline->index()] |= 2;
-			}
-		}
-	}
-
-	// Draw any lines attached to the moving vertices
 	glLineWidth(line_width);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Draw lines with one moving vertex
 	glBegin(GL_LINES);
-	for (unsigned a = 0; a < map_->nLines(); a++)
+	for (unsigned a = 0; a < moving.partial.size(); a += 2)
 	{
-		auto line  = map_->line(a);
-		auto drawn = lines_drawn[line->index()];
+		auto& moved = moving.partial[a];
+		auto& fixed = moving.partial[a + 1];
+		glColor4f(moved.r, moved.g, moved.b, moved.a);
+		glVertex2d(moved.x + move_vec.x, moved.y + move_vec.y);
+		glVertex2d(fixed.x, fixed.y);
+	}
+	glEnd();
 
-		// Skip if not attached to any moving vertices
-		if (drawn == 0)
-			continue;
+	if (moving.verts.empty())
+		return;
 
-		// Set line colour
-		gl::setColour(lineColour(line, true));
+	// Everything else moves entirely, so is drawn translated by the move vector
+	glPushMatrix();
+	glTranslated(move_vec.x, move_vec.y, 0.);
 
-		// First vertex
-		if (drawn & 1)
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-		else
-			glVertex2d(line->x1(), line->y1());
+	// Set arrays to use (from the VBO if supported)
+	const char* base = nullptr;
+	if (vbo_moving_ > 0)
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_moving_);
+	else
+		base = reinterpret_cast<const char*>(moving.verts.data());
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 24, base);
+	glColorPointer(4, GL_FLOAT, 24, base + 8);
 
-		// Second vertex
-		if (drawn & 2)
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
-		else
-			glVertex2d(line->x2(), line->y2());
+	// Draw lines moving entirely
+	if (moving.n_lines > 0)
+	{
+		glDrawArrays(GL_LINES, 0, moving.n_lines);
+		frameprofiler::addDrawCalls();
 	}
-	glEnd();
 
 	// Set 'moving' colour
+	glDisableClientState(GL_COLOR_ARRAY);
 	colourconfig::setGLColour("map_moving");
 
-	// Draw moving line overlays
-	glLineWidth(line_width * 3);
-	glBegin(GL_LINES);
-	for (const auto& item : lines)
+	// Draw moving vertex or line overlays
+	unsigned n_overlay = moving.verts.size() - moving.n_lines;
+	if (moving.points)
 	{
-		if (auto line = item.asLine(*map_))
+		bool point = setupVertexRendering(1.5f);
+		glDrawArrays(GL_POINTS, moving.n_lines, n_overlay);
+		if (point)
 		{
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
+			glDisable(GL_POINT_SPRITE);
+			glDisable(GL_TEXTURE_2D);
 		}
 	}
-	glEnd();
+	else
+	{
+		glLineWidth(line_width * 3);
+		glDrawArrays(GL_LINES, moving.n_lines, n_overlay);
+	}
+	frameprofiler::addDrawCalls();
+
+	// Clean state
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glPopMatrix();
 }
 
 // -----------------------------------------------------------------------------
-// Renders the moving overlay for sector indices in [sectors], to show movement
+// Renders the moving overlay for vertex indices in [vertices], to show movement
 // by [move_vec]
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec) const
+void MapRenderer2D::renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec)
 {
-	// Determine what lines are being moved
-	vector<uint8_t> lines_moved(map_->nLines(), 0);
-	for (auto item : sectors)
-	{
-		if (auto sector = item.asSector(*map_))
-		{
-			// Go through connected sides
-			auto& sides = sector->connectedSides();
-			for (auto& side : sides)
-				lines_moved[side->parentLine()->index()] = 1; // Mark parent line as moved
-		}
-	}
+	renderMoving(movingGeometry(vertices), move_vec);
+}
 
-	// Build list of moving lines
-	vector<mapeditor::Item> lines;
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		if (lines_moved[a] > 0)
-			lines.emplace_back((int)a, mapeditor::ItemType::Line);
-	}
+// -----------------------------------------------------------------------------
+// Renders the moving overlay for line indices in [lines], to show movement by
+// [move_vec]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec)
+{
+	renderMoving(movingGeometry(lines), move_vec);
+}
 
-	// Draw moving lines
-	renderMovingLines(lines, move_vec);
+// -----------------------------------------------------------------------------
+// Renders the moving overlay for sector indices in [sectors], to show movement
+// by [move_vec]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec)
+{
+	renderMoving(movingGeometry(sectors), move_vec);
 }
 
 // -----------------------------------------------------------------------------
@@ -2856,58 +3323,134 @@ void MapRenderer2D::renderPasteThings(vector<MapThing*>& things, Vec2d pos)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns the cached geometry for the lines and vertices in object edit
+// [group], rebuilding it if the group has changed since it was built
+// -----------------------------------------------------------------------------
+const MapRenderer2D::ObjectEditGeometry& MapRenderer2D::objectEditGeometry(const ObjectEditGroup& group)
+{
+	if (object_edit_.group == &group && object_edit_.version == group.version())
+		return object_edit_;
+
+	object_edit_.group   = &group;
+	object_edit_.version = group.version();
+	object_edit_.verts.clear();
+	object_edit_.partial.clear();
+
+	auto add_vert = [](vector<GLVert>& verts, Vec2d pos, const ColRGBA& col) {
+		verts.push_back({ (float)pos.x, (float)pos.y, col.fr(), col.fg(), col.fb(), col.fa() });
+	};
+
+	// Lines
+	vector<ObjectEditGroup::LineToDraw> lines;
+	group.putLinesToDraw(lines);
+	for (const auto& line : lines)
+	{
+		auto col = lineColour(line.map_line, true);
+		if (line.v1_edited && line.v2_edited)
+		{
+			add_vert(object_edit_.verts, line.v1, col);
+			add_vert(object_edit_.verts, line.v2, col);
+		}
+		else
+		{
+			add_vert(object_edit_.partial, line.v1_edited ? line.v1 : line.v2, col);
+			add_vert(object_edit_.partial, line.v1_edited ? line.v2 : line.v1, col);
+		}
+	}
+	object_edit_.n_lines = object_edit_.verts.size();
+
+	// Vertices (colour is set when rendering)
+	vector<Vec2d> vertices;
+	group.putVerticesToDraw(vertices);
+	for (const auto& vertex : vertices)
+		add_vert(object_edit_.verts, vertex, ColRGBA::WHITE);
+
+	// Upload to VBO if supported
+	if (gl::vboSupport())
+	{
+		if (vbo_object_edit_ == 0)
+			glGenBuffers(1, &vbo_object_edit_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_object_edit_);
+		glBufferData(
+			GL_ARRAY_BUFFER, sizeof(GLVert) * object_edit_.verts.size(), object_edit_.verts.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	return object_edit_;
+}
+
 // -----------------------------------------------------------------------------
 // Renders object edit group overlay for [group]
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 {
-	// Simple test
-	vector<Vec2d> vertex_points;
-	group->putVerticesToDraw(vertex_points);
-	vector<ObjectEditGroup::Line> lines;
-	group->putLinesToDraw(lines);
-
-	// Set 'drawing' colour
-	colourconfig::setGLColour("map_linedraw");
+	const auto& geometry  = objectEditGeometry(*group);
+	const auto& transform = group->transform();
 
 	// --- Lines ---
 
-	// Lines
-	glBegin(GL_LINES);
+	// Lines with one edited vertex (only the edited end is transformed)
 	glLineWidth(line_width);
-	for (auto& line : lines)
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glBegin(GL_LINES);
+	for (unsigned a = 0; a < geometry.partial.size(); a += 2)
 	{
-		gl::setColour(lineColour(line.map_line, true));
-		glVertex2d(line.v1->position.x, line.v1->position.y);
-		glVertex2d(line.v2->position.x, line.v2->position.y);
+		auto& edited = geometry.partial[a];
+		auto& fixed  = geometry.partial[a + 1];
+		auto  pos    = transform.apply({ edited.x, edited.y });
+		glColor4f(edited.r, edited.g, edited.b, edited.a);
+		glVertex2d(pos.x, pos.y);
+		glVertex2d(fixed.x, fixed.y);
 	}
 	glEnd();
 
-	// Edit overlay
-	colourconfig::setGLColour("map_object_edit");
-	glLineWidth(line_width * 3);
-	glBegin(GL_LINES);
-	for (auto& line : lines)
+	// Everything else is drawn with the group transform applied
+	// (column-major 4x4 matrix for the 2d affine transform)
+	GLdouble matrix[16] = { transform.a, transform.b, 0., 0., transform.c, transform.d, 0., 0.,
+							0.,          0.,          1., 0., transform.e, transform.f, 0., 1. };
+	glPushMatrix();
+	glMultMatrixd(matrix);
+
+	// Set arrays to use (from the VBO if supported)
+	const char* base = nullptr;
+	if (vbo_object_edit_ > 0)
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_object_edit_);
+	else
+		base = reinterpret_cast<const char*>(geometry.verts.data());
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 24, base);
+	glColorPointer(4, GL_FLOAT, 24, base + 8);
+
+	if (geometry.n_lines > 0)
 	{
-		if (line.isExtra())
-			continue;
+		// Lines
+		glDrawArrays(GL_LINES, 0, geometry.n_lines);
 
-		glVertex2d(line.v1->position.x, line.v1->position.y);
-		glVertex2d(line.v2->position.x, line.v2->position.y);
+		// Edit overlay
+		glDisableClientState(GL_COLOR_ARRAY);
+		colourconfig::setGLColour("map_object_edit");
+		glLineWidth(line_width * 3);
+		glDrawArrays(GL_LINES, 0, geometry.n_lines);
+		frameprofiler::addDrawCalls(2);
 	}
-	glEnd();
 
 	// --- Vertices ---
 
 	// Setup rendering properties
+	glDisableClientState(GL_COLOR_ARRAY);
 	bool point = setupVertexRendering(1.0f);
 	gl::setColour(colourconfig::colour("map_object_edit"));
 
 	// Render vertices
-	glBegin(GL_POINTS);
-	for (auto& vertex_point : vertex_points)
-		glVertex2d(vertex_point.x, vertex_point.y);
-	glEnd();
+	unsigned n_vertices = geometry.verts.size() - geometry.n_lines;
+	if (n_vertices > 0)
+	{
+		glDrawArrays(GL_POINTS, geometry.n_lines, n_vertices);
+		frameprofiler::addDrawCalls();
+	}
 
 	// Clean up
 	if (point)
@@ -2915,6 +3458,9 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 		glDisable(GL_POINT_SPRITE);
 		glDisable(GL_TEXTURE_2D);
 	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glPopMatrix();
 
 	// --- Things ---
 
@@ -3012,21 +3558,26 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVerticesVBO()
 {
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
 	// Create VBO if needed
 	if (vbo_vertices_ == 0)
 		glGenBuffers(1, &vbo_vertices_);
 
 	// Fill vertices VBO
-	int             nfloats = map_->nVertices() * 2;
+	const auto&     geometry = map_->geometry();
+	const auto&     x        = geometry.vertexX();
+	const auto&     y        = geometry.vertexY();
+	int             nfloats  = geometry.nVertices() * 2;
 	vector<GLfloat> verts(nfloats);
-	unsigned        i = 0;
-	for (unsigned a = 0; a < map_->nVertices(); a++)
+	for (unsigned a = 0; a < geometry.nVertices(); a++)
 	{
-		verts[i++] = map_->vertex(a)->xPos();
-		verts[i++] = map_->vertex(a)->yPos();
+		verts[a * 2]     = x[a];
+		verts[a * 2 + 1] = y[a];
 	}
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * nfloats, verts.data(), GL_STATIC_DRAW);
+	vbo_vertices_size_ = sizeof(GLfloat) * nfloats;
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -3035,13 +3586,53 @@ void MapRenderer2D::updateVerticesVBO()
 	vertices_updated_ = app::runTimer();
 }
 
+// -----------------------------------------------------------------------------
+// Updates the map vertices VBO data for any vertices modified since it was
+// last updated
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateModifiedVerticesVBO()
+{
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
+	// Get modified vertex indices
+	vector<unsigned> indices;
+	for (auto object : map_->mapData().modifiedObjects(vertices_updated_, MapObject::Type::Vertex))
+		if (object->index() < map_->nVertices())
+			indices.push_back(object->index());
+
+	// Write each modified range
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
+	vector<GLfloat> verts;
+	forEachIndexRange(indices, [&](unsigned first, unsigned count) {
+		verts.resize(count * 2);
+		for (unsigned a = 0; a < count; a++)
+		{
+			auto vertex      = map_->vertex(first + a);
+			verts[a * 2]     = vertex->xPos();
+			verts[a * 2 + 1] = vertex->yPos();
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * first * 2, sizeof(GLfloat) * count * 2, verts.data());
+	});
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vertices_updated_ = app::runTimer();
+}
+
 // -----------------------------------------------------------------------------
 // (Re)builds the map lines VBO
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 {
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
 	log::info(3, "Updating lines VBO");
 
+	// The overall alpha is applied by the lines shader if it's available
+	if (linesShader().isValid())
+		base_alpha = 1.0f;
+
 	// Create VBO if needed
 	if (vbo_lines_ == 0)
 		glGenBuffers(1, &vbo_lines_);
@@ -3054,64 +3645,102 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 	// Fill lines VBO
 	int            nverts = map_->nLines() * vpl;
 	vector<GLVert> lines(nverts);
-	unsigned       v = 0;
-	ColRGBA        col;
-	float          alpha;
 	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		auto line = map_->line(a);
+		setLineVBOVerts(map_->line(a), &lines[a * vpl], show_direction, base_alpha);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
+	vbo_lines_size_ = sizeof(GLVert) * nverts;
 
-		// Get line colour
-		col   = lineColour(line);
-		alpha = base_alpha * col.fa();
-
-		// Set line vertices
-		lines[v].x     = line->v1()->xPos();
-		lines[v].y     = line->v1()->yPos();
-		lines[v + 1].x = line->v2()->xPos();
-		lines[v + 1].y = line->v2()->yPos();
-
-		// Set line colour(s)
-		lines[v].r = lines[v + 1].r = col.fr();
-		lines[v].g = lines[v + 1].g = col.fg();
-		lines[v].b = lines[v + 1].b = col.fb();
-		lines[v].a = lines[v + 1].a = alpha;
-
-		// Direction tab if needed
-		if (show_direction)
-		{
-			auto mid       = line->getPoint(MapObject::Point::Mid);
-			auto tab       = line->dirTabPoint();
-			lines[v + 2].x = mid.x;
-			lines[v + 2].y = mid.y;
-			lines[v + 3].x = tab.x;
-			lines[v + 3].y = tab.y;
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-			// Colours
-			lines[v + 2].r = lines[v + 3].r = col.fr();
-			lines[v + 2].g = lines[v + 3].g = col.fg();
-			lines[v + 2].b = lines[v + 3].b = col.fb();
-			lines[v + 2].a = lines[v + 3].a = alpha * 0.6f;
-		}
+	n_lines_         = map_->nLines();
+	lines_updated_   = app::runTimer();
+	lines_vbo_alpha_ = base_alpha;
+}
 
-		// Next line
-		v += vpl;
-	}
+// -----------------------------------------------------------------------------
+// Updates the map lines VBO data for any lines modified (or with modified
+// vertices) since it was last updated
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateModifiedLinesVBO()
+{
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
+	// Get modified line indices
+	auto&            map_data = map_->mapData();
+	vector<unsigned> indices;
+	for (auto object : map_data.modifiedObjects(lines_updated_, MapObject::Type::Line))
+		if (object->index() < map_->nLines())
+			indices.push_back(object->index());
+	for (auto object : map_data.modifiedObjects(lines_updated_, MapObject::Type::Vertex))
+		for (auto line : dynamic_cast<MapVertex*>(object)->connectedLines())
+			indices.push_back(line->index());
+
+	// Write each modified range
+	unsigned vpl = lines_dirs_ ? 4 : 2;
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
+	vector<GLVert> lines;
+	forEachIndexRange(indices, [&](unsigned first, unsigned count) {
+		lines.resize(count * vpl);
+		for (unsigned a = 0; a < count; a++)
+			setLineVBOVerts(map_->line(first + a), &lines[a * vpl], lines_dirs_, lines_vbo_alpha_);
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLVert) * first * vpl, sizeof(GLVert) * count * vpl, lines.data());
+	});
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	n_lines_       = map_->nLines();
 	lines_updated_ = app::runTimer();
 }
 
+// -----------------------------------------------------------------------------
+// Sets the lines VBO vertices [verts] for [line] (2, or 4 if [show_direction]
+// is true)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::setLineVBOVerts(MapLine* line, GLVert* verts, bool show_direction, float base_alpha) const
+{
+	// Get line colour
+	auto  col   = lineColour(line);
+	float alpha = base_alpha * col.fa();
+
+	// Set line vertices
+	verts[0].x = line->v1()->xPos();
+	verts[0].y = line->v1()->yPos();
+	verts[1].x = line->v2()->xPos();
+	verts[1].y = line->v2()->yPos();
+
+	// Set line colour(s)
+	verts[0].r = verts[1].r = col.fr();
+	verts[0].g = verts[1].g = col.fg();
+	verts[0].b = verts[1].b = col.fb();
+	verts[0].a = verts[1].a = alpha;
+
+	// Direction tab if needed
+	if (show_direction)
+	{
+		auto mid   = line->getPoint(MapObject::Point::Mid);
+		auto tab   = line->dirTabPoint();
+		verts[2].x = mid.x;
+		verts[2].y = mid.y;
+		verts[3].x = tab.x;
+		verts[3].y = tab.y;
+
+		// Colours
+		verts[2].r = verts[3].r = col.fr();
+		verts[2].g = verts[3].g = col.fg();
+		verts[2].b = verts[3].b = col.fb();
+		verts[2].a = verts[3].a = alpha * 0.6f;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // (Re)builds the map flats VBO
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateFlatsVBO()
 {
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
 	if (!flats_use_vbo)
 		return;
 
@@ -3130,6 +3759,7 @@ void MapRenderer2D::updateFlatsVBO()
 	// Allocate buffer data
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 	glBufferData(GL_ARRAY_BUFFER, totalsize, nullptr, GL_STATIC_DRAW);
+	vbo_flats_size_ = totalsize;
 
 	// Write polygon data to VBO
 	unsigned offset = 0;
@@ -3144,6 +3774,7 @@ void MapRenderer2D::updateFlatsVBO()
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+	n_sectors_     = map_->nSectors();
 	flats_updated_ = app::runTimer();
 }
 
@@ -3152,15 +3783,34 @@ void MapRenderer2D::updateFlatsVBO()
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 {
-	// Sector visibility
+	frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Visibility);
+
+	// Update chunks
+	updateVisChunks();
+
+	// Reset visibility of objects that were in the view previously (or all
+	// objects if the number of them changed)
 	if (map_->nSectors() != vis_s_.size())
-	{
-		// Number of sectors changed, reset array
-		vis_s_.clear();
-		for (unsigned a = 0; a < map_->nSectors(); a++)
-			vis_s_.push_back(0);
-	}
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+		vis_s_.assign(map_->nSectors(), VIS_OUTSIDE);
+	else
+		for (auto index : vis_list_s_)
+			if (index < vis_s_.size())
+				vis_s_[index] = VIS_OUTSIDE;
+	if (map_->nThings() != vis_t_.size())
+		vis_t_.assign(map_->nThings(), VIS_OUTSIDE);
+	else
+		for (auto index : vis_list_t_)
+			if (index < vis_t_.size())
+				vis_t_[index] = VIS_OUTSIDE;
+
+	// Get sectors in chunks overlapping the view
+	vis_list_s_.clear();
+	vis_chunks_s_.forEachInBox(view_tl, view_br, [&](MapSector* sector) { vis_list_s_.push_back(sector->index()); });
+	std::sort(vis_list_s_.begin(), vis_list_s_.end());
+	vis_list_s_.erase(std::unique(vis_list_s_.begin(), vis_list_s_.end()), vis_list_s_.end());
+
+	// Sector visibility
+	for (auto a : vis_list_s_)
 	{
 		// Check against sector bounding box
 		auto bbox = map_->sector(a)->boundingBox();
@@ -3179,17 +3829,19 @@ void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 			vis_s_[a] = VIS_SMALL;
 	}
 
+	// Get things in chunks overlapping the view (extended by the largest thing
+	// radius, since things may extend into the view from outside it)
+	vis_list_t_.clear();
+	vis_chunks_t_.forEachInBox(
+		{ view_tl.x - vis_max_radius_, view_tl.y - vis_max_radius_ },
+		{ view_br.x + vis_max_radius_, view_br.y + vis_max_radius_ },
+		[&](MapThing* thing) { vis_list_t_.push_back(thing->index()); });
+	std::sort(vis_list_t_.begin(), vis_list_t_.end());
+
 	// Thing visibility
-	if (map_->nThings() != vis_t_.size())
-	{
-		// Number of things changed, reset array
-		vis_t_.clear();
-		for (unsigned a = 0; a < map_->nThings(); a++)
-			vis_t_.push_back(0);
-	}
 	double x, y;
 	double radius;
-	for (unsigned a = 0; a < vis_t_.size(); a++)
+	for (auto a : vis_list_t_)
 	{
 		vis_t_[a] = 0;
 		x         = map_->thing(a)->xPos();
@@ -3209,6 +3861,65 @@ void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Updates the visibility chunks for any things or sectors modified since they
+// were last updated, or rebuilds them if any were added or removed
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateVisChunks()
+{
+	auto& map_data     = map_->mapData();
+	bool  removed      = map_data.lastRemovedTime() > vis_chunks_updated_;
+	auto  thing_radius = [](MapThing* thing) { return game::configuration().thingType(thing->type()).radius() * 1.3; };
+
+	// Things
+	if (removed || map_->nThings() != vis_chunks_n_t_)
+	{
+		vis_chunks_t_.clear();
+		vis_max_radius_ = 0.;
+		for (unsigned a = 0; a < map_->nThings(); a++)
+		{
+			auto thing = map_->thing(a);
+			vis_chunks_t_.addPoint(thing, thing->position());
+			vis_max_radius_ = std::max(vis_max_radius_, thing_radius(thing));
+		}
+		vis_chunks_n_t_ = map_->nThings();
+	}
+	else
+	{
+		for (auto object : map_data.modifiedObjects(vis_chunks_updated_, MapObject::Type::Thing))
+		{
+			auto thing = dynamic_cast<MapThing*>(object);
+			if (vis_chunks_t_.contains(thing))
+			{
+				vis_chunks_t_.addPoint(thing, thing->position());
+				vis_max_radius_ = std::max(vis_max_radius_, thing_radius(thing));
+			}
+		}
+	}
+
+	// Sectors (bounding boxes can change with any geometry or side changes,
+	// so just re-add them all if anything relevant was modified)
+	if (removed || map_->nSectors() != vis_chunks_n_s_ || map_->geometryUpdated() > vis_chunks_updated_
+		|| map_data.modifiedSince(vis_chunks_updated_, MapObject::Type::Sector)
+		|| map_data.modifiedSince(vis_chunks_updated_, MapObject::Type::Side)
+		|| map_data.modifiedSince(vis_chunks_updated_, MapObject::Type::Line))
+	{
+		vis_chunks_s_.clear();
+		for (unsigned a = 0; a < map_->nSectors(); a++)
+		{
+			auto sector = map_->sector(a);
+			auto bbox   = sector->boundingBox();
+			if (bbox.isValid())
+				vis_chunks_s_.addBox(sector, bbox);
+			else
+				vis_chunks_s_.addPoint(sector, bbox.min);
+		}
+		vis_chunks_n_s_ = map_->nSectors();
+	}
+
+	vis_chunks_updated_ = app::runTimer();
+}
+
 // -----------------------------------------------------------------------------
 // Updates all VBOs and other cached data
 // -----------------------------------------------------------------------------
@@ -3219,6 +3930,10 @@ void MapRenderer2D::forceUpdate(float line_alpha)
 	tex_flats_.clear();
 	thing_sprites_.clear();
 	thing_paths_.clear();
+	lod_cache_.clear();
+	lod_lines_band_    = 0;
+	lod_vertices_band_ = 0;
+	moving_.updated    = -1;
 
 	if (gl::vboSupport())
 	{
@@ -3257,6 +3972,51 @@ double MapRenderer2D::scaledRadius(int radius) const
 		return (double)radius;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the shader used to render map lines, loading it if needed. The
+// shader will be invalid if shaders aren't supported
+// -----------------------------------------------------------------------------
+gl::Shader& MapRenderer2D::linesShader()
+{
+	if (!shader_lines_)
+	{
+		shader_lines_ = std::make_unique<gl::Shader>("map2d_lines");
+		shader_lines_->load(shader_lines_vert, shader_lines_frag);
+	}
+
+	return *shader_lines_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the shader used to render point light previews, loading it if needed.
+// The shader will be invalid if shaders aren't supported
+// -----------------------------------------------------------------------------
+gl::Shader& MapRenderer2D::lightsShader()
+{
+	if (!shader_lights_)
+	{
+		shader_lights_ = std::make_unique<gl::Shader>("map2d_lights");
+		shader_lights_->load(shader_lights_vert, shader_lights_frag);
+	}
+
+	return *shader_lights_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the shader used to render textured flats, loading it if needed. The
+// shader will be invalid if shaders aren't supported
+// -----------------------------------------------------------------------------
+gl::Shader& MapRenderer2D::flatsShader()
+{
+	if (!shader_flats_)
+	{
+		shader_flats_ = std::make_unique<gl::Shader>("map2d_flats");
+		shader_flats_->load(shader_flats_vert, shader_flats_frag);
+	}
+
+	return *shader_flats_;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the current visibility info is valid
 // -----------------------------------------------------------------------------
@@ -3264,3 +4024,19 @@ bool MapRenderer2D::visOK() const
 {
 	return !(map_->nSectors() != vis_s_.size() || map_->nThings() != vis_t_.size());
 }
+
+// -----------------------------------------------------------------------------
+// Clears any cached flat textures and thing sprites that are any of the
+// textures in [gl_ids] (eg. the placeholder for textures queued to load, or
+// textures that were unloaded), so they are looked up again
+// -----------------------------------------------------------------------------
+void MapRenderer2D::refreshTextures(const std::set<unsigned>& gl_ids)
+{
+	for (auto& tex : tex_flats_)
+		if (gl_ids.count(tex) > 0)
+			tex = 0;
+
+	for (auto& tex : thing_sprites_)
+		if (gl_ids.count(tex) > 0)
+			tex = 0;
+}
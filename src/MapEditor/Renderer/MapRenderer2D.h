@@ -2,6 +2,7 @@
 
 #include "MapEditor/MapEditor.h"
 #include "SLADEMap/MapObject/MapObject.h"
+#include "SLADEMap/MapObjectList/MapObjectGrid.h"
 #include "Utility/Colour.h"
 
 namespace slade
@@ -17,6 +18,10 @@ namespace game
 {
 	class ThingType;
 }
+namespace gl
+{
+	class Shader;
+}
 
 class MapRenderer2D
 {
@@ -25,6 +30,7 @@ public:
 	~MapRenderer2D();
 
 	double viewScaleInv() const { return view_scale_inv_; }
+	size_t vboMemoryUsage() const { return vbo_vertices_size_ + vbo_lines_size_ + vbo_flats_size_; }
 
 	// Vertices
 	bool setupVertexRendering(float size_scale, bool overlay = false) const;
@@ -95,7 +101,7 @@ public:
 	void renderTaggedThings(vector<MapThing*>& things, float fade) const;
 	void renderTaggingThings(vector<MapThing*>& things, float fade) const;
 	void renderPathedThings(vector<MapThing*>& things);
-	void renderPointLightPreviews(float alpha, int hilight_index) const;
+	void renderPointLightPreviews(float alpha, int hilight_index);
 
 	// Flats (sectors)
 	void renderFlats(int type = 0, bool texture = true, float alpha = 1.0f);
@@ -106,9 +112,9 @@ public:
 	void renderTaggedFlats(vector<MapSector*>& sectors, float fade) const;
 
 	// Moving
-	void renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec) const;
-	void renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec) const;
-	void renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec) const;
+	void renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec);
+	void renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec);
+	void renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec);
 	void renderMovingThings(const vector<mapeditor::Item>& things, Vec2d move_vec);
 
 	// Paste
@@ -133,6 +139,7 @@ public:
 	double scaledRadius(int radius) const;
 	bool   visOK() const;
 	void   clearTextureCache() { tex_flats_.clear(); }
+	void   refreshTextures(const std::set<unsigned>& gl_ids);
 
 private:
 	SLADEMap* map_ = nullptr;
@@ -142,9 +149,18 @@ private:
 	long flats_updated_    = 0;
 
 	// VBOs etc
-	unsigned vbo_vertices_ = 0;
-	unsigned vbo_lines_    = 0;
-	unsigned vbo_flats_    = 0;
+	unsigned vbo_vertices_      = 0;
+	unsigned vbo_lines_         = 0;
+	unsigned vbo_flats_         = 0;
+	size_t   vbo_vertices_size_ = 0;
+	size_t   vbo_lines_size_    = 0;
+	size_t   vbo_flats_size_    = 0;
+	float    lines_vbo_alpha_   = 1.0f; // The overall alpha the lines VBO was built with (if not using shaders)
+
+	// Shaders
+	unique_ptr<gl::Shader> shader_lines_;
+	unique_ptr<gl::Shader> shader_lights_;
+	unique_ptr<gl::Shader> shader_flats_;
 
 	// Display lists
 	unsigned list_vertices_ = 0;
@@ -153,17 +169,29 @@ private:
 	// Visibility
 	enum
 	{
-		VIS_LEFT  = 1,
-		VIS_RIGHT = 2,
-		VIS_ABOVE = 4,
-		VIS_BELOW = 8,
-		VIS_SMALL = 16,
+		VIS_LEFT    = 1,
+		VIS_RIGHT   = 2,
+		VIS_ABOVE   = 4,
+		VIS_BELOW   = 8,
+		VIS_SMALL   = 16,
+		VIS_OUTSIDE = 32, // Not in any chunk overlapping the view
 	};
 	vector<uint8_t> vis_v_;
 	vector<uint8_t> vis_l_;
 	vector<uint8_t> vis_t_;
 	vector<uint8_t> vis_s_;
 
+	// Visibility chunks. Things and sectors are placed in a coarse grid, so that
+	// only objects in chunks overlapping the view need to be checked or drawn
+	MapObjectGrid<MapThing>  vis_chunks_t_{ 1024. };
+	MapObjectGrid<MapSector> vis_chunks_s_{ 1024. };
+	unsigned                 vis_chunks_n_t_     = 0;
+	unsigned                 vis_chunks_n_s_     = 0;
+	long                     vis_chunks_updated_ = 0;
+	double                   vis_max_radius_     = 0.; // Largest thing visibility radius in the chunks
+	vector<unsigned>         vis_list_t_;              // Things in chunks overlapping the view (sorted)
+	vector<unsigned>         vis_list_s_;              // Sectors in chunks overlapping the view (sorted)
+
 	// Structs
 	struct GLVert
 	{
@@ -176,20 +204,94 @@ private:
 		GLVert dv1, dv2; // Direction tab
 	};
 
+	// Level of detail. When zoomed far out, lines and vertices are drawn from
+	// simplified geometry, with endpoints snapped to a grid of roughly pixel
+	// sized cells. Simplified geometry is cached per zoom band (where the cell
+	// size is 2^band map units)
+	struct LODGeometry
+	{
+		vector<GLVert> lines;
+		vector<float>  vertices;
+	};
+	std::map<int, LODGeometry> lod_cache_;
+	long                       lod_updated_       = 0;
+	unsigned                   lod_n_lines_       = 0;
+	unsigned                   lod_n_vertices_    = 0;
+	unsigned                   vbo_lod_lines_     = 0;
+	unsigned                   vbo_lod_vertices_  = 0;
+	int                        lod_lines_band_    = 0; // Zoom band currently in the LOD lines VBO (0 = none)
+	int                        lod_vertices_band_ = 0; // Zoom band currently in the LOD vertices VBO (0 = none)
+	float                      lod_lines_alpha_   = 1.0f;
+
+	// Moving objects. The lines affected by a move are cached when it begins,
+	// so each frame only needs to draw the cached geometry offset by the move
+	// vector (as a translation for anything that moves entirely)
+	struct MovingGeometry
+	{
+		vector<mapeditor::Item> items;
+		long                    updated = -1;
+		vector<GLVert>          verts;           // Lines moving entirely, followed by the overlay
+		unsigned                n_lines = 0;     // Number of [verts] that are lines moving entirely
+		bool                    points  = false; // Overlay is vertex points rather than lines
+		vector<GLVert>          partial;         // Lines with one moving vertex (moving vertex first)
+	};
+	MovingGeometry moving_;
+	unsigned       vbo_moving_ = 0;
+
+	// Object edit group. The group lines and vertices are cached in their
+	// original positions when the group changes, so each frame only needs to
+	// draw them with the group transform applied
+	struct ObjectEditGeometry
+	{
+		const ObjectEditGroup* group   = nullptr;
+		unsigned               version = 0;
+		vector<GLVert>         verts;       // Lines between edited vertices, followed by edited vertices
+		unsigned               n_lines = 0; // Number of [verts] that are lines
+		vector<GLVert>         partial;     // Lines with one edited vertex (edited vertex first)
+	};
+	ObjectEditGeometry object_edit_;
+	unsigned           vbo_object_edit_ = 0;
+
 	// Other
 	bool     lines_dirs_     = false;
 	unsigned n_vertices_     = 0;
 	unsigned n_lines_        = 0;
 	unsigned n_things_       = 0;
+	unsigned n_sectors_      = 0;
 	double   view_scale_     = 0.;
 	double   view_scale_inv_ = 0.;
 	bool     things_angles_  = false;
 
 	vector<unsigned> tex_flats_;
 	int              last_flat_type_ = -1;
+
+	// Flat texture coordinate transform for each sector, used when flat texture
+	// coordinates are calculated in the flats shader rather than stored in the
+	// flats VBO (so changing them doesn't require updating the VBO)
+	struct FlatTexTransform
+	{
+		float scale_x  = 1.f; // 1 / (texture width * x scale)
+		float scale_y  = 1.f; // 1 / (texture height * y scale)
+		float offset_x = 0.f; // In texture widths
+		float offset_y = 0.f; // In texture heights
+		float rot_cos  = 1.f;
+		float rot_sin  = 0.f;
+	};
+	vector<FlatTexTransform> flat_tex_transforms_;
 	vector<unsigned> thing_sprites_;
 	long             thing_sprites_updated_ = 0;
 
+	// Thing quads, batched by texture so all things can be drawn with a single
+	// draw call per texture rather than one per thing
+	struct ThingQuadVert
+	{
+		float   x, y;
+		float   u, v;
+		uint8_t r, g, b, a;
+	};
+	typedef std::map<unsigned, vector<ThingQuadVert>> ThingQuadBatch;
+	ThingQuadBatch* thing_batch_ = nullptr; // If set, thing quads are added here instead of drawn immediately
+
 	// Thing paths
 	enum class PathType
 	{
@@ -206,5 +308,44 @@ private:
 	};
 	vector<ThingPath> thing_paths_;
 	long              thing_paths_updated_ = 0;
+
+	// Point light previews
+	vector<ThingQuadVert> light_verts_;
+	vector<ThingQuadVert> light_verts_faded_; // Light quads with the overall alpha applied (if not using shaders)
+	long                  lights_updated_   = 0;
+	unsigned              lights_n_things_  = 0;
+	float                 lights_intensity_ = 0.f;
+
+	gl::Shader& linesShader();
+	gl::Shader& lightsShader();
+	gl::Shader& flatsShader();
+	void        updatePointLights();
+	void        updateModifiedVerticesVBO();
+	void        updateModifiedLinesVBO();
+	void        setLineVBOVerts(MapLine* line, GLVert* verts, bool show_direction, float base_alpha) const;
+	void        updateVisChunks();
+	void        drawThingQuad(
+		unsigned       tex,
+		double         x,
+		double         y,
+		double         hw,
+		double         hh,
+		const ColRGBA& colour,
+		double         angle    = 0.,
+		int            tc_start = 0) const;
+	static void renderThingQuadBatch(const ThingQuadBatch& batch);
+
+	// Level of detail
+	int                lodBand() const;
+	const LODGeometry& lodGeometry(int band);
+	void               renderLinesLOD(int band, float alpha);
+	void               renderVerticesLOD(int band);
+
+	// Moving
+	const MovingGeometry& movingGeometry(const vector<mapeditor::Item>& items);
+	void                  renderMoving(const MovingGeometry& moving, Vec2d move_vec) const;
+
+	// Object edit
+	const ObjectEditGeometry& objectEditGeometry(const ObjectEditGroup& group);
 };
 } // namespace slade
@@ -33,14 +33,18 @@
 #include "Main.h"
 #include "MapRenderer3D.h"
 #include "App.h"
+#include "FrameProfiler.h"
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
+#include "General/Profiler.h"
 #include "General/ResourceManager.h"
+#include "General/ThreadPool.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapTextureManager.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/MathStuff.h"
@@ -72,6 +76,10 @@ CVAR(Bool, mlook_invert_y, false, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_x, 1.0f, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_y, 1.0f, CVar::Flag::Save)
 CVAR(Int, render_fov, 90, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_vis, true, CVar::Flag::Save)
+CVAR(Bool, render_3d_occlusion, false, CVar::Flag::Save)
+CVAR(Bool, render_3d_stats, false, CVar::Flag::Save)
+CVAR(Bool, render_3d_gpu_picking, false, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -83,6 +91,113 @@ EXTERN_CVAR(Bool, flats_use_vbo)
 EXTERN_CVAR(Bool, use_zeth_icons)
 
 
+// -----------------------------------------------------------------------------
+//
+// Shaders
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Sky shader, drawn as a single fullscreen quad. The view ray for each pixel is
+// intersected with a cylinder around the camera to get the sky texture
+// coordinates, fading into the average top/bottom sky colours above and below
+// (the same as the sky geometry drawn without shaders)
+const char* shader_sky_vert = R"(#version 120
+varying vec2 screen_pos;
+void main()
+{
+	screen_pos  = gl_Vertex.xy;
+	gl_Position = vec4(gl_Vertex.xy, 0.0, 1.0);
+}
+)";
+const char* shader_sky_frag = R"(#version 120
+uniform sampler2D sky_texture;
+uniform vec4      colour_top;
+uniform vec4      colour_bottom;
+uniform vec2      tex_scale;
+uniform float     offset;
+varying vec2      screen_pos;
+void main()
+{
+	// Get view direction
+	vec4 near = gl_ModelViewProjectionMatrixInverse * vec4(screen_pos, -1.0, 1.0);
+	vec4 far  = gl_ModelViewProjectionMatrixInverse * vec4(screen_pos, 1.0, 1.0);
+	vec3 dir  = far.xyz / far.w - near.xyz / near.w;
+
+	// Height the view ray hits the sky cylinder at (-1 = bottom, 1 = top)
+	float height = dir.z / max(length(dir.xy), 0.00001) + offset;
+
+	// Sky texture, fading into the top/bottom colour towards the top/bottom
+	float u     = -atan(dir.x, dir.y) * tex_scale.x;
+	float v     = (1.0 - height) * tex_scale.y * 0.5;
+	vec3  sky   = texture2D(sky_texture, vec2(u, v)).rgb;
+	vec3  cap   = height > 0.0 ? colour_top.rgb : colour_bottom.rgb;
+	float alpha = clamp(2.0 - 2.0 * abs(height), 0.0, 1.0);
+
+	gl_FragColor = vec4(mix(cap, sky, alpha), 1.0);
+}
+)";
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Picking
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Object ids rendered to the picking buffer are the object index + 1 in RGB
+// (0 = nothing) and the object kind (plus wall part for walls) in A
+enum PickKind : uint8_t
+{
+	PICK_WALL    = 1,
+	PICK_FLOOR   = 2,
+	PICK_CEILING = 3,
+	PICK_THING   = 4,
+	PICK_KIND    = 7, // Mask
+
+	// Wall part flags
+	PICK_BACK  = 8,
+	PICK_UPPER = 16,
+	PICK_LOWER = 32,
+};
+
+uint32_t pickId(uint8_t kind, unsigned index)
+{
+	return ((index + 1) & 0xFFFFFF) | (static_cast<uint32_t>(kind) << 24);
+}
+
+uint32_t wallPickId(const MapRenderer3D::Quad& quad)
+{
+	uint8_t kind = PICK_WALL;
+	if (quad.flags & MapRenderer3D::BACK)
+		kind |= PICK_BACK;
+	if (quad.flags & MapRenderer3D::UPPER)
+		kind |= PICK_UPPER;
+	else if (quad.flags & MapRenderer3D::LOWER)
+		kind |= PICK_LOWER;
+
+	return pickId(kind, quad.line);
+}
+
+void pickColour(uint32_t id, uint8_t* rgba)
+{
+	rgba[0] = id & 0xFF;
+	rgba[1] = (id >> 8) & 0xFF;
+	rgba[2] = (id >> 16) & 0xFF;
+	rgba[3] = id >> 24;
+}
+
+void setPickColour(uint32_t id)
+{
+	uint8_t rgba[4];
+	pickColour(id, rgba);
+	glColor4ubv(rgba);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapRenderer3D Class Functions
@@ -101,8 +216,15 @@ MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }
 	// Init other
 	init();
 
-	// Refresh textures when resources are updated or the main palette is changed
+	// Refresh textures when resources are updated or the main palette is changed.
+	// When individual resources change, only what was drawn with them is
+	// refreshed (via the texture manager's stale textures, see Renderer::draw)
 	sc_resources_updated_ = app::resources().signals().resources_updated.connect([this]() { refreshTextures(); });
+	sc_resources_changed_ = app::resources().signals().resources_changed.connect(
+		[this](const ResourceManager::ResourceChange& change) {
+			if (change.palette_changed)
+				refreshTextures();
+		});
 	sc_palette_changed_   = theMainWindow->paletteChooser()->signals().palette_changed.connect(
         [this]() { refreshTextures(); });
 }
@@ -121,6 +243,15 @@ MapRenderer3D::~MapRenderer3D()
 		glDeleteBuffers(1, &vbo_floors_);
 	if (vbo_walls_ > 0)
 		glDeleteBuffers(1, &vbo_walls_);
+	if (!occ_queries_.empty())
+		glDeleteQueries(occ_queries_.size(), occ_queries_.data());
+	if (pick_fbo_ > 0)
+	{
+		glDeleteFramebuffersEXT(1, &pick_fbo_);
+		glDeleteRenderbuffersEXT(1, &pick_rb_colour_);
+		glDeleteRenderbuffersEXT(1, &pick_rb_depth_);
+		glDeleteBuffers(2, pick_pbos_);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -163,7 +294,17 @@ void MapRenderer3D::refresh()
 	{
 		glDeleteBuffers(1, &vbo_floors_);
 		glDeleteBuffers(1, &vbo_ceilings_);
-		vbo_floors_ = vbo_ceilings_ = 0;
+		vbo_floors_     = 0;
+		vbo_ceilings_   = 0;
+		vbo_flats_size_ = 0;
+	}
+
+	// Clear occlusion queries
+	if (!occ_queries_.empty())
+	{
+		glDeleteQueries(occ_queries_.size(), occ_queries_.data());
+		occ_queries_.clear();
+		occ_state_.clear();
 	}
 
 	floors_.clear();
@@ -210,6 +351,33 @@ void MapRenderer3D::refreshTextures()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Marks anything drawn with any of the textures in [gl_ids] as needing an
+// update (eg. the placeholder for textures queued to load, or textures that
+// were unloaded)
+// -----------------------------------------------------------------------------
+void MapRenderer3D::refreshTextures(const std::set<unsigned>& gl_ids)
+{
+	// Refresh lines
+	for (auto& line : lines_)
+		for (auto& quad : line.quads)
+			if (gl_ids.count(quad.texture) > 0)
+			{
+				line.updated_time = 0;
+				break;
+			}
+
+	// Refresh flats (sectors are updated based on their floor)
+	for (unsigned a = 0; a < floors_.size() && a < ceilings_.size(); a++)
+		if (gl_ids.count(floors_[a].texture) > 0 || gl_ids.count(ceilings_[a].texture) > 0)
+			floors_[a].updated_time = 0;
+
+	// Refresh things
+	for (auto& thing : things_)
+		if (gl_ids.count(thing.sprite) > 0)
+			thing.updated_time = 0;
+}
+
 // -----------------------------------------------------------------------------
 // Clears all cached rendering data
 // -----------------------------------------------------------------------------
@@ -220,6 +388,8 @@ void MapRenderer3D::clearData()
 	things_.clear();
 	floors_.clear();
 	ceilings_.clear();
+	pick_result_valid_ = false;
+	pick_frame_        = 0;
 
 	// Clear everything else
 	refresh();
@@ -508,6 +678,17 @@ void MapRenderer3D::setupView(int width, int height)
 // level
 // -----------------------------------------------------------------------------
 void MapRenderer3D::setLight(ColRGBA& colour, uint8_t light, float alpha) const
+{
+	float rgba[4];
+	lightColour(colour, light, alpha, rgba);
+	glColor4fv(rgba);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the colour for rendering an object using [colour] and [light] level
+// to [rgba]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::lightColour(const ColRGBA& colour, uint8_t light, float alpha, float* rgba) const
 {
 	// Force 255 light in fullbright mode
 	if (fullbright_)
@@ -521,7 +702,10 @@ void MapRenderer3D::setLight(ColRGBA& colour, uint8_t light, float alpha) const
 	// closer resemble the software renderer light level
 	float mult = (float)light / 255.0f;
 	mult *= (mult * 1.3f);
-	glColor4f(colour.fr() * mult, colour.fg() * mult, colour.fb() * mult, colour.fa() * alpha);
+	rgba[0] = colour.fr() * mult;
+	rgba[1] = colour.fg() * mult;
+	rgba[2] = colour.fb() * mult;
+	rgba[3] = colour.fa() * alpha;
 }
 
 // -----------------------------------------------------------------------------
@@ -565,6 +749,8 @@ void MapRenderer3D::setFog(ColRGBA& fogcol, uint8_t light)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderMap()
 {
+	PROFILE_ZONE("MapRenderer3D::renderMap");
+
 	// Setup GL stuff
 	glEnable(GL_DEPTH_TEST);
 	glCullFace(GL_BACK);
@@ -576,23 +762,34 @@ void MapRenderer3D::renderMap()
 	// Init VBO stuff
 	if (gl::vboSupport())
 	{
-		// Check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::VBOs);
+
+		// Rebuild any outdated sector polygons
+		map_->sectors().updatePolygons();
+
+		// Refresh the entire vbo if sectors were added or removed (indices may
+		// have been compacted)
 		bool vbo_updated = false;
-		for (unsigned a = 0; a < map_->nSectors(); a++)
+		if (vbo_floors_ == 0 || map_->nSectors() != vbo_flats_n_
+			|| map_->mapData().lastRemovedTime() > vbo_flats_time_)
+		{
+			updateFlatsVBO();
+			vbo_updated = true;
+		}
+
+		// Check if any polygon vertex data has changed, and rewrite it in place
+		// if possible (otherwise we need to refresh the entire vbo)
+		for (unsigned a = 0; a < map_->nSectors() && !vbo_updated; a++)
 		{
-			auto poly = map_->sector(a)->polygon();
-			if (poly && poly->vboUpdate() > 1)
+			auto sector = map_->sector(a);
+			auto poly   = sector->polygon();
+			if (poly && poly->vboUpdate() > 1 && !updateFlatVBO(sector))
 			{
 				updateFlatsVBO();
 				vbo_updated = true;
-				break;
 			}
 		}
 
-		// Create VBO if necessary
-		if (!vbo_updated && vbo_floors_ == 0)
-			updateFlatsVBO();
-
 		glEnableClientState(GL_VERTEX_ARRAY);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	}
@@ -614,11 +811,18 @@ void MapRenderer3D::renderMap()
 
 	// Quick distance vis check
 	sf::Clock clock;
-	quickVisDiscard();
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Visibility);
+		quickVisDiscard();
 
-	// Build lists of quads and flats to render
-	checkVisibleFlats();
-	checkVisibleQuads();
+		// Build lists of quads and flats to render
+		checkVisibleFlats();
+		checkVisibleQuads();
+	}
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Textures);
+		updateTextureResidency();
+	}
 
 	// Render sky
 	if (render_3d_sky)
@@ -640,17 +844,41 @@ void MapRenderer3D::renderMap()
 	}
 
 	// Render walls
-	renderWalls();
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Walls);
+		renderWalls();
+	}
 
 	// Render flats
-	renderFlats();
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Flats);
+		renderFlats();
+	}
 
 	// Render things
 	if (render_3d_things > 0)
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Things);
 		renderThings();
+	}
 
 	// Render transparent stuff
-	renderTransparentWalls();
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Walls);
+		renderTransparentWalls();
+	}
+
+	// Check sector visibility for the next frame
+	renderOcclusionQueries();
+
+	// Render object ids under the crosshair for the next frame's hilight
+	if (render_3d_gpu_picking)
+		renderPickBuffer();
+	else
+	{
+		pick_result_valid_ = false;
+		pick_frame_        = 0;
+	}
 
 	// Check elapsed time
 	if (render_max_dist_adaptive)
@@ -764,10 +992,6 @@ void MapRenderer3D::renderSky()
 	glDepthMask(GL_FALSE);
 	glEnable(GL_TEXTURE_2D);
 
-	// Center skybox a bit below the camera view
-	glPushMatrix();
-	glTranslatef(0.0f, 0.0f, -10.0f);
-
 	// Get sky texture
 	unsigned sky;
 	if (!skytex2_.empty())
@@ -789,30 +1013,6 @@ void MapRenderer3D::renderSky()
 				sky, { 0, tex_info.size.y - theight, tex_info.size.x, tex_info.size.y });
 		}
 
-		// Render top cap
-		float size = 64.0f;
-		glDisable(GL_TEXTURE_2D);
-		gl::setColour(skycol_top_);
-		glBegin(GL_QUADS);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
-		glEnd();
-
-		// Render bottom cap
-		gl::setColour(skycol_bottom_);
-		glBegin(GL_QUADS);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
-		glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
-		glVertex3f(cam_position_.x + (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
-		glEnd();
-
-		// Render skybox sides
-		glDisable(GL_ALPHA_TEST);
-		glEnable(GL_TEXTURE_2D);
-
 		// Check for odd sky sizes
 		float tx = 0.125f;
 		float ty = 2.0f;
@@ -821,12 +1021,66 @@ void MapRenderer3D::renderSky()
 		if (tex_info.size.y > 128)
 			ty = 1.0f;
 
-		renderSkySlice(1.0f, 0.5f, 0.0f, 1.0f, size, tx, ty);   // Top
-		renderSkySlice(0.5f, -0.5f, 1.0f, 1.0f, size, tx, ty);  // Middle
-		renderSkySlice(-0.5f, -1.0f, 1.0f, 0.0f, size, tx, ty); // Bottom
+		float size = 64.0f;
+		glDisable(GL_ALPHA_TEST);
+
+		// Render with the sky shader if possible (a single fullscreen quad)
+		auto& shader = skyShader();
+		if (shader.isValid())
+		{
+			shader.bind();
+			shader.setUniform("sky_texture", 0);
+			shader.setUniform("colour_top", skycol_top_.fr(), skycol_top_.fg(), skycol_top_.fb(), 1.0f);
+			shader.setUniform("colour_bottom", skycol_bottom_.fr(), skycol_bottom_.fg(), skycol_bottom_.fb(), 1.0f);
+			shader.setUniform("tex_scale", tx * 32.0f / (2.0f * math::PI), ty);
+			shader.setUniform("offset", 10.0f / size); // Center a bit below the camera view
+
+			glBegin(GL_QUADS);
+			glVertex2f(-1.0f, -1.0f);
+			glVertex2f(1.0f, -1.0f);
+			glVertex2f(1.0f, 1.0f);
+			glVertex2f(-1.0f, 1.0f);
+			glEnd();
+			frameprofiler::addDrawCalls();
+
+			gl::Shader::unbind();
+		}
+		else
+		{
+			// Center skybox a bit below the camera view
+			glPushMatrix();
+			glTranslatef(0.0f, 0.0f, -10.0f);
+
+			// Render top cap
+			glDisable(GL_TEXTURE_2D);
+			gl::setColour(skycol_top_);
+			glBegin(GL_QUADS);
+			glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
+			glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
+			glVertex3f(cam_position_.x + (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
+			glVertex3f(cam_position_.x + (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
+			glEnd();
+
+			// Render bottom cap
+			gl::setColour(skycol_bottom_);
+			glBegin(GL_QUADS);
+			glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
+			glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
+			glVertex3f(cam_position_.x + (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
+			glVertex3f(cam_position_.x + (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
+			glEnd();
+
+			// Render skybox sides
+			glEnable(GL_TEXTURE_2D);
+			renderSkySlice(1.0f, 0.5f, 0.0f, 1.0f, size, tx, ty);   // Top
+			renderSkySlice(0.5f, -0.5f, 1.0f, 1.0f, size, tx, ty);  // Middle
+			renderSkySlice(-0.5f, -1.0f, 1.0f, 0.0f, size, tx, ty); // Bottom
+			frameprofiler::addDrawCalls(5);
+
+			glPopMatrix();
+		}
 	}
 
-	glPopMatrix();
 	glDepthMask(GL_TRUE);
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_DEPTH_TEST);
@@ -864,6 +1118,21 @@ void MapRenderer3D::renderSky()
 	glEnable(GL_TEXTURE_2D);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the shader used to render the sky, loading it if needed. The shader
+// will be invalid if shaders aren't supported
+// -----------------------------------------------------------------------------
+gl::Shader& MapRenderer3D::skyShader()
+{
+	if (!shader_sky_)
+	{
+		shader_sky_ = std::make_unique<gl::Shader>("map3d_sky");
+		shader_sky_->load(shader_sky_vert, shader_sky_frag);
+	}
+
+	return *shader_sky_;
+}
+
 // -----------------------------------------------------------------------------
 // Updates the vertex texture coordinates of all polygons for sector [index]
 // -----------------------------------------------------------------------------
@@ -1050,6 +1319,7 @@ void MapRenderer3D::renderFlat(Flat* flat)
 
 		// Render
 		flat->sector->polygon()->renderVBO(false);
+		frameprofiler::addDrawCalls();
 	}
 	else
 	{
@@ -1069,6 +1339,7 @@ void MapRenderer3D::renderFlat(Flat* flat)
 
 		// Render
 		flat->sector->polygon()->render();
+		frameprofiler::addDrawCalls();
 
 		glPopMatrix();
 	}
@@ -1293,10 +1564,91 @@ void MapRenderer3D::setupQuadTexCoords(
 	quad->points[3].ty = (y1 * y_mult) + ((h_top - quad->points[3].z) * y_mult);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the wall texture [name], preloaded by updateLines if possible
+// -----------------------------------------------------------------------------
+const MapTextureManager::Texture& MapRenderer3D::lineTexture(const TextureName& name, bool mixed) const
+{
+	auto i = line_textures_.find(name.id());
+	if (i != line_textures_.end())
+		return *i->second;
+
+	// Not preloaded, textures can only be loaded on the main thread
+	if (std::this_thread::get_id() == app::mainThreadId())
+		return mapeditor::textureManager().texture(name, mixed);
+
+	return tex_none_;
+}
+
 // -----------------------------------------------------------------------------
 // Updates cached rendering data for line [index]
 // -----------------------------------------------------------------------------
 void MapRenderer3D::updateLine(unsigned index)
+{
+	updateLines({ index });
+}
+
+// -----------------------------------------------------------------------------
+// Updates cached rendering data for all lines in [indices].
+// Line specials are processed and wall textures loaded first on the calling
+// (GL) thread, since these can modify map data or create GL textures. The
+// quads for each line only read map data and the loaded textures, so are then
+// built in parallel on the worker threads
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updateLines(const vector<unsigned>& indices)
+{
+	bool mixed    = game::configuration().featureSupported(game::Feature::MixTexFlats);
+	auto load_tex = [&](const TextureName& name) {
+		if (line_textures_.find(name.id()) == line_textures_.end())
+			line_textures_[name.id()] = &mapeditor::textureManager().texture(name, mixed);
+	};
+	for (auto index : indices)
+	{
+		if (index >= lines_.size())
+			continue;
+
+		auto line = map_->line(index);
+		if (!line->s1())
+			continue;
+
+		// Process line special
+		map_->mapSpecials()->processLineSpecial(line);
+
+		// Load textures
+		for (auto side : { line->s1(), line->s2() })
+		{
+			if (!side)
+				continue;
+
+			load_tex(side->texUpper());
+			load_tex(side->texMiddle());
+			load_tex(side->texLower());
+		}
+		if (line->s2())
+			load_tex(TextureName{ line->stringProperty("side2.texturemiddle") });
+
+		// Calculate (and cache) length
+		line->length();
+
+		// Update cached sector lighting, since the sectors may be shared by
+		// lines being built on different threads
+		if (line->frontSector())
+			line->frontSector()->updateLightCache();
+		if (line->backSector())
+			line->backSector()->updateLightCache();
+	}
+
+	// Build quads
+	threadpool::parallelFor(indices.size(), [&](size_t a) { buildLineQuads(indices[a]); }, 32);
+
+	line_textures_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Builds the quads for line [index].
+// Can be called from a worker thread, see updateLines
+// -----------------------------------------------------------------------------
+void MapRenderer3D::buildLineQuads(unsigned index)
 {
 	using game::Feature;
 	using game::UDMFFeature;
@@ -1313,9 +1665,6 @@ void MapRenderer3D::updateLine(unsigned index)
 	if (!line->s1())
 		return;
 
-	// Process line special
-	map_->mapSpecials()->processLineSpecial(line);
-
 	// Get relevant line info
 	auto   map_format = mapeditor::editContext().mapDesc().format;
 	bool   upeg       = game::configuration().lineBasicFlagSet("dontpegtop", line, map_format);
@@ -1380,7 +1729,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed);
+		auto& tex    = lineTexture(line->s1()->texMiddle(), mixed);
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1483,7 +1832,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texLower(), mixed);
+		auto& tex    = lineTexture(line->s1()->texLower(), mixed);
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1531,7 +1880,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		Quad quad;
 
 		// Get texture
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed);
+		auto& tex    = lineTexture(line->s1()->texMiddle(), mixed);
 		quad.texture = tex.gl_id;
 
 		// Determine offsets
@@ -1639,7 +1988,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texUpper(), mixed);
+		auto& tex    = lineTexture(line->s1()->texUpper(), mixed);
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1698,7 +2047,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s2()->texLower(), mixed);
+		auto& tex    = lineTexture(line->s2()->texLower(), mixed);
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1747,7 +2096,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		Quad quad;
 
 		// Get texture
-		auto& tex    = mapeditor::textureManager().texture(midtex2, mixed);
+		auto& tex    = lineTexture(TextureName{ midtex2 }, mixed);
 		quad.texture = tex.gl_id;
 
 		// Determine offsets
@@ -1856,7 +2205,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s2()->texUpper(), mixed);
+		auto& tex    = lineTexture(line->s2()->texUpper(), mixed);
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1937,6 +2286,7 @@ void MapRenderer3D::renderQuad(MapRenderer3D::Quad* quad, float alpha)
 	glTexCoord2f(quad->points[3].tx, quad->points[3].ty);
 	glVertex3f(quad->points[3].x, quad->points[3].y, quad->points[3].z);
 	glEnd();
+	frameprofiler::addDrawCalls();
 
 	// Reset settings
 	if (quad->colour.a == 255)
@@ -1949,7 +2299,10 @@ void MapRenderer3D::renderQuad(MapRenderer3D::Quad* quad, float alpha)
 }
 
 // -----------------------------------------------------------------------------
-// Renders all currently visible wall quads
+// Renders all currently visible wall quads.
+// Opaque quads are sorted by texture and render state into batches, and each
+// batch is drawn from the walls VBO with a single draw call. Light levels are
+// applied via vertex colours so they don't split batches
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderWalls()
 {
@@ -1958,40 +2311,120 @@ void MapRenderer3D::renderWalls()
 	glEnable(GL_TEXTURE_2D);
 	glCullFace(GL_BACK);
 
-	// Render all visible quads, ordered by texture
-	unsigned a        = 0;
-	unsigned tex_last = 0;
-	while (n_quads_ > 0)
+	// Separate out transparent quads
+	unsigned n_opaque = 0;
+	for (unsigned a = 0; a < n_quads_; a++)
 	{
-		tex_last = 0;
-		a        = 0;
-		while (a < n_quads_)
+		if (quads_[a]->colour.a < 255)
+			quads_transparent_.push_back(quads_[a]);
+		else
+			quads_[n_opaque++] = quads_[a];
+	}
+	n_quads_ = 0;
+
+	// Sort quads by texture and render state
+	bool sky       = render_3d_sky;
+	bool fog       = fog_;
+	auto batch_key = [sky, fog](const Quad* quad) {
+		bool is_sky = (quad->flags & SKY) && sky;
+		return std::make_tuple(
+			quad->texture,
+			is_sky,
+			(quad->flags & MIDTEX) && !is_sky ? quad->alpha : -1.f,
+			(quad->flags & TRANSADD) != 0,
+			fog ? quad->fogcolour.r : 0,
+			fog ? quad->fogcolour.g : 0,
+			fog ? quad->fogcolour.b : 0,
+			fog ? quad->light : 0);
+	};
+	std::sort(quads_, quads_ + n_opaque, [&batch_key](const Quad* left, const Quad* right) {
+		return batch_key(left) < batch_key(right);
+	});
+
+	// Build batches
+	wall_vertices_.clear();
+	wall_batches_.clear();
+	wall_pick_colours_.clear();
+	float   rgba[4];
+	uint8_t pick_rgba[4];
+	for (unsigned a = 0; a < n_opaque; a++)
+	{
+		auto quad = quads_[a];
+		if (wall_batches_.empty() || batch_key(wall_batches_.back().quad) != batch_key(quad))
+			wall_batches_.push_back({ quad, static_cast<unsigned>(wall_vertices_.size()), 0 });
+
+		lightColour(quad->colour, quad->light, (quad->flags & SKY) && sky ? 0.f : quad->alpha, rgba);
+		for (auto& p : quad->points)
+			wall_vertices_.push_back({ p.x, p.y, p.z, p.tx, p.ty, rgba[0], rgba[1], rgba[2], rgba[3] });
+		wall_batches_.back().count += 4;
+
+		// Pick id colours
+		if (render_3d_gpu_picking)
 		{
-			// Check alpha
-			if (quads_[a]->colour.a < 255)
-			{
-				quads_transparent_.push_back(quads_[a]);
-				quads_[a] = quads_[n_quads_ - 1];
-				n_quads_--;
-				continue;
-			}
+			pickColour(wallPickId(*quad), pick_rgba);
+			for (int v = 0; v < 4; v++)
+				wall_pick_colours_.insert(wall_pick_colours_.end(), pick_rgba, pick_rgba + 4);
+		}
+	}
 
-			// Check texture
-			if (!tex_last && quads_[a]->texture)
-			{
-				tex_last = quads_[a]->texture;
-				gl::Texture::bind(quads_[a]->texture);
-			}
-			if (quads_[a]->texture != tex_last)
-			{
-				a++;
-				continue;
-			}
+	if (!wall_batches_.empty())
+	{
+		// Setup arrays (from the VBO if supported)
+		const char* data = nullptr;
+		if (gl::vboSupport())
+			updateWallsVBO();
+		else
+		{
+			data = reinterpret_cast<const char*>(wall_vertices_.data());
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		}
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, sizeof(WallVertex), data);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(WallVertex), data + 12);
+		glColorPointer(4, GL_FLOAT, sizeof(WallVertex), data + 20);
+
+		// Render batches
+		for (auto& batch : wall_batches_)
+		{
+			auto quad   = batch.quad;
+			bool is_sky = (quad->flags & SKY) && sky;
+
+			// Setup special rendering options
+			if (is_sky)
+				glDisable(GL_ALPHA_TEST);
+			else if (quad->flags & MIDTEX)
+				glAlphaFunc(GL_GREATER, 0.9f * quad->alpha);
+
+			// Checking for additive renderstyle
+			if (quad->flags & TRANSADD)
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+			else
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			// Setup texture and fog
+			gl::Texture::bind(quad->texture);
+			setFog(quad->fogcolour, quad->light);
 
-			// Render quad
-			renderQuad(quads_[a], quads_[a]->alpha);
-			quads_[a] = quads_[n_quads_ - 1];
-			n_quads_--;
+			// Draw batch
+			glDrawArrays(GL_QUADS, batch.first, batch.count);
+			frameprofiler::addDrawCalls();
+
+			// Reset settings
+			if (is_sky)
+				glEnable(GL_ALPHA_TEST);
+			else if (quad->flags & MIDTEX)
+				glAlphaFunc(GL_GREATER, 0.0f);
+		}
+
+		// Clean up
+		glDisableClientState(GL_COLOR_ARRAY);
+		if (gl::vboSupport())
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		else
+		{
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 		}
 	}
 
@@ -2133,12 +2566,7 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 
 	// Get sprite texture
 	uint32_t theight      = render_thing_icon_size;
-	things_[index].sprite = mapeditor::textureManager()
-								.sprite(
-									things_[index].type->sprite(),
-									things_[index].type->translation(),
-									things_[index].type->palette())
-								.gl_id;
+	things_[index].sprite = mapeditor::textureManager().sprite(*things_[index].type).gl_id;
 	if (!things_[index].sprite)
 	{
 		// Sprite not found, try an icon
@@ -2315,6 +2743,7 @@ void MapRenderer3D::renderThings()
 		glTexCoord2f(1.0f, 0.0f);
 		glVertex3f(x2, y2, things_[a].z + theight);
 		glEnd();
+		frameprofiler::addDrawCalls();
 
 		things_[a].flags |= DRAWN;
 	}
@@ -2542,6 +2971,7 @@ void MapRenderer3D::updateFlatsVBO()
 		auto poly = map_->sector(a)->polygon();
 		totalsize += poly->vboDataSize();
 	}
+	vbo_flats_size_ = totalsize * 2;
 
 	// --- Floors ---
 
@@ -2590,13 +3020,233 @@ void MapRenderer3D::updateFlatsVBO()
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vbo_flats_n_    = map_->nSectors();
+	vbo_flats_time_ = app::runTimer();
+}
+
+// -----------------------------------------------------------------------------
+// Rewrites the floor and ceiling VBO data for [sector] in place (eg. after its
+// polygon was rebuilt).
+// Returns false if the polygon no longer fits, in which case the flat VBOs
+// need to be fully rebuilt
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::updateFlatVBO(MapSector* sector) const
+{
+	auto poly = sector->polygon();
+
+	// Floor
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_floors_);
+	poly->setZ(sector->floor().height);
+	bool ok = poly->rewriteVBO();
+
+	// Ceiling
+	if (ok)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_ceilings_);
+		poly->setZ(sector->ceiling().height);
+		poly->rewriteVBO();
+	}
+
+	// Clean up
+	poly->setZ(0.0f);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Uploads the current wall batch vertices to the walls Vertex Buffer Object,
+// leaving it bound
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updateWallsVBO()
+{
+	// Create VBO if needed
+	if (vbo_walls_ == 0)
+		glGenBuffers(1, &vbo_walls_);
+
+	// Upload vertices (contents change every frame)
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_walls_);
+	glBufferData(
+		GL_ARRAY_BUFFER, sizeof(WallVertex) * wall_vertices_.size(), wall_vertices_.data(), GL_STREAM_DRAW);
+}
+
+namespace
+{
+constexpr double TWO_PI = math::PI * 2.;
+
+// An arc of view directions from the camera, beginning at angle [start] and
+// extending anticlockwise by [width] (in radians)
+struct ViewArc
+{
+	double start = 0.;
+	double width = TWO_PI;
+
+	bool full() const { return width >= TWO_PI; }
+};
+
+// Wraps [angle] to the range [0, 2pi)
+double wrapAngle(double angle)
+{
+	angle = std::fmod(angle, TWO_PI);
+	return angle < 0. ? angle + TWO_PI : angle;
+}
+
+// Returns the arc covered by [seg] as seen from [cam]
+ViewArc segArc(Vec2d cam, const Seg2d& seg)
+{
+	auto a1 = std::atan2(seg.start().y - cam.y, seg.start().x - cam.x);
+	auto a2 = std::atan2(seg.end().y - cam.y, seg.end().x - cam.x);
+	auto d  = wrapAngle(a2 - a1);
+	if (d <= math::PI)
+		return { wrapAngle(a1), d };
+	else
+		return { wrapAngle(a2), TWO_PI - d };
+}
+
+// Clips [arc] to [clip], returning false if they don't overlap.
+// If the overlap is in two pieces, [arc] is set to cover both
+bool clipArc(ViewArc& arc, const ViewArc& clip)
+{
+	if (clip.full())
+		return true;
+	if (arc.full())
+	{
+		arc = clip;
+		return true;
+	}
+
+	// Check overlap relative to the start of [clip], with [arc] both as-is and
+	// wrapped back a full turn
+	auto   offset = wrapAngle(arc.start - clip.start);
+	double lo     = TWO_PI;
+	double hi     = -TWO_PI;
+	for (auto o : { offset, offset - TWO_PI })
+	{
+		auto s = std::max(o, 0.);
+		auto e = std::min(o + arc.width, clip.width);
+		if (s <= e)
+		{
+			lo = std::min(lo, s);
+			hi = std::max(hi, e);
+		}
+	}
+	if (hi < lo)
+		return false;
+
+	arc.start = wrapAngle(clip.start + lo);
+	arc.width = hi - lo;
+	return true;
+}
+
+// Expands [arc] to also cover [add], returning false if it already did
+bool mergeArc(ViewArc& arc, const ViewArc& add)
+{
+	if (arc.full())
+		return false;
+	if (add.full())
+	{
+		arc = add;
+		return true;
+	}
+
+	// Already covered
+	auto offset = wrapAngle(add.start - arc.start);
+	if (offset + add.width <= arc.width + 0.00001)
+		return false;
+
+	// Expand in whichever direction gives the smaller arc
+	auto w_fwd  = offset + add.width;
+	auto w_back = std::max(add.width, wrapAngle(arc.start - add.start) + arc.width);
+	if (w_fwd <= w_back)
+		arc.width = w_fwd;
+	else
+	{
+		arc.start = add.start;
+		arc.width = w_back;
+	}
+	arc.width = std::min(arc.width, TWO_PI);
+
+	return true;
 }
+} // namespace
 
 // -----------------------------------------------------------------------------
-// (Re)builds the walls Vertex Buffer Object
-// (or would, if it were used for wall rendering)
+// Determines which sectors are potentially visible from the camera, by flood
+// filling from the camera's sector through open two-sided lines (portals).
+// The arc of view directions is narrowed through each portal, so sectors that
+// are only reachable through portals out of view aren't visited.
+// Results are written to vis_sectors_, returns false if the camera is not
+// within a sector
 // -----------------------------------------------------------------------------
-void MapRenderer3D::updateWallsVBO() const {}
+bool MapRenderer3D::checkPortalVisibility()
+{
+	auto cam        = cam_position_.get2d();
+	auto cam_sector = map_->sectors().atPos(cam);
+	if (!cam_sector)
+		return false;
+
+	vis_sectors_.assign(map_->nSectors(), 0);
+	vector<ViewArc>  arcs(map_->nSectors());
+	vector<unsigned> to_check;
+	vis_sectors_[cam_sector->index()] = 1;
+	to_check.push_back(cam_sector->index());
+	while (!to_check.empty())
+	{
+		auto sector = map_->sector(to_check.back());
+		auto arc    = arcs[to_check.back()];
+		to_check.pop_back();
+
+		for (auto side : sector->connectedSides())
+		{
+			// Get sector on the other side (if any)
+			auto line  = side->parentLine();
+			auto other = line->s1() == side ? line->s2() : line->s1();
+			if (!other || other->sector() == sector)
+				continue;
+			auto next = other->sector();
+
+			// Check distance
+			Seg2d seg{ line->start(), line->end() };
+			auto  dist = math::distanceToLine(cam, seg);
+			if (render_max_dist > 0 && dist > render_max_dist)
+				continue;
+
+			// Check the portal is open (ie. floor is below ceiling at either end)
+			bool open = false;
+			for (auto pos : { seg.start(), seg.end() })
+			{
+				auto floor   = std::max(sector->floor().plane.heightAt(pos), next->floor().plane.heightAt(pos));
+				auto ceiling = std::min(sector->ceiling().plane.heightAt(pos), next->ceiling().plane.heightAt(pos));
+				if (ceiling > floor)
+					open = true;
+			}
+			if (!open)
+				continue;
+
+			// Narrow the view arc to the portal
+			// (if the camera is practically on the line, the portal covers everything)
+			ViewArc portal_arc;
+			if (dist > 1.)
+				portal_arc = segArc(cam, seg);
+			if (!clipArc(portal_arc, arc))
+				continue;
+
+			// Add to the sector on the other side, (re)checking it if its arc grew
+			auto index = next->index();
+			if (!vis_sectors_[index])
+			{
+				vis_sectors_[index] = 1;
+				arcs[index]         = portal_arc;
+				to_check.push_back(index);
+			}
+			else if (mergeArc(arcs[index], portal_arc))
+				to_check.push_back(index);
+		}
+	}
+
+	return true;
+}
 
 // -----------------------------------------------------------------------------
 // Runs a quick check of all sector bounding boxes against the current view to
@@ -2657,15 +3307,166 @@ void MapRenderer3D::quickVisDiscard()
 		}
 	}
 
-	// Set all lines that are part of invisible sectors to invisible
+	// Hide sectors that can't be seen through any portal from the camera's sector
+	if (render_3d_portal_vis && checkPortalVisibility())
+	{
+		for (unsigned a = 0; a < map_->nSectors(); a++)
+			if (!vis_sectors_[a])
+				dist_sectors_[a] = -1.0f;
+	}
+
+	// Hide sectors that were occluded last frame
+	n_sectors_occluded_ = 0;
+	if (render_3d_occlusion && GLEW_VERSION_1_5)
+		checkOcclusion();
+
+	// Set all lines that are only part of invisible sectors to invisible
+	for (auto& line : lines_)
+		line.visible = false;
 	for (unsigned a = 0; a < map_->nSides(); a++)
 	{
 		dist = dist_sectors_[map_->side(a)->sector()->index()];
-		if (dist < 0 || (render_max_dist > 0 && dist > render_max_dist))
-			lines_[map_->side(a)->parentLine()->index()].visible = false;
-		else
+		if (dist >= 0 && (render_max_dist <= 0 || dist <= render_max_dist))
 			lines_[map_->side(a)->parentLine()->index()].visible = true;
 	}
+
+	// Count quads hidden by occlusion
+	n_quads_occluded_ = 0;
+	if (n_sectors_occluded_ > 0)
+	{
+		for (auto& line : lines_)
+		{
+			if (line.visible || !line.line)
+				continue;
+
+			for (auto side : { line.line->s1(), line.line->s2() })
+				if (side && occ_state_[side->sector()->index()] & OCC_HIDDEN)
+				{
+					n_quads_occluded_ += line.quads.size();
+					break;
+				}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the results of the previous frame's occlusion queries and hides any
+// sectors that weren't visible. All sectors still visible after the other
+// checks (including those just hidden) are flagged to be queried again this
+// frame, see renderOcclusionQueries
+// -----------------------------------------------------------------------------
+void MapRenderer3D::checkOcclusion()
+{
+	// (Re)create queries if needed
+	if (occ_queries_.size() != map_->nSectors())
+	{
+		if (!occ_queries_.empty())
+			glDeleteQueries(occ_queries_.size(), occ_queries_.data());
+
+		occ_queries_.resize(map_->nSectors());
+		occ_state_.assign(map_->nSectors(), 0);
+		if (!occ_queries_.empty())
+			glGenQueries(occ_queries_.size(), occ_queries_.data());
+	}
+
+	auto cam = cam_position_.get2d();
+	for (unsigned a = 0; a < map_->nSectors(); a++)
+	{
+		// Get last frame's result, if it's ready (otherwise assume visible)
+		bool occluded = false;
+		if (occ_state_[a] & OCC_QUERIED)
+		{
+			GLuint available = 0;
+			glGetQueryObjectuiv(occ_queries_[a], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint samples = 0;
+				glGetQueryObjectuiv(occ_queries_[a], GL_QUERY_RESULT, &samples);
+				occluded = samples == 0;
+			}
+		}
+
+		// Skip if already hidden
+		occ_state_[a] = 0;
+		if (dist_sectors_[a] < 0 || (render_max_dist > 0 && dist_sectors_[a] > render_max_dist))
+			continue;
+
+		occ_state_[a] = OCC_QUERY;
+		if (!occluded)
+			continue;
+
+		// Never hide sectors the camera is in or very close to, since their
+		// bounding box may be clipped by the near plane
+		auto bbox = map_->sector(a)->boundingBox();
+		if (cam.x > bbox.min.x - 16 && cam.x < bbox.max.x + 16 && cam.y > bbox.min.y - 16 && cam.y < bbox.max.y + 16)
+			continue;
+
+		dist_sectors_[a] = -1.0f;
+		occ_state_[a] |= OCC_HIDDEN;
+		n_sectors_occluded_++;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Issues an occlusion query for each sector flagged by checkOcclusion, by
+// drawing its bounding box (invisibly) against the depth buffer of the
+// rendered frame
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderOcclusionQueries()
+{
+	if (!render_3d_occlusion || !GLEW_VERSION_1_5 || occ_state_.size() != map_->nSectors())
+		return;
+
+	// Setup GL state (depth test only)
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_FOG);
+
+	// Bounding box corner indices for each face
+	const int box_faces[] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 5, 4, 3, 2, 6, 7, 0, 3, 7, 4, 1, 2, 6, 5 };
+
+	for (unsigned a = 0; a < map_->nSectors(); a++)
+	{
+		if (!(occ_state_[a] & OCC_QUERY))
+			continue;
+
+		// Determine bounding box, expanded slightly so it is never behind the
+		// sector's own walls and flats
+		auto   sector = map_->sector(a);
+		auto   bbox   = sector->boundingBox();
+		double bottom = 999999.;
+		double top    = -999999.;
+		for (auto corner : { bbox.min, bbox.max, Vec2d(bbox.min.x, bbox.max.y), Vec2d(bbox.max.x, bbox.min.y) })
+		{
+			bottom = std::min(bottom, sector->floor().plane.heightAt(corner));
+			top    = std::max(top, sector->ceiling().plane.heightAt(corner));
+		}
+		double corners[8][3] = {
+			{ bbox.min.x - 1, bbox.min.y - 1, bottom - 1 }, { bbox.max.x + 1, bbox.min.y - 1, bottom - 1 },
+			{ bbox.max.x + 1, bbox.max.y + 1, bottom - 1 }, { bbox.min.x - 1, bbox.max.y + 1, bottom - 1 },
+			{ bbox.min.x - 1, bbox.min.y - 1, top + 1 },    { bbox.max.x + 1, bbox.min.y - 1, top + 1 },
+			{ bbox.max.x + 1, bbox.max.y + 1, top + 1 },    { bbox.min.x - 1, bbox.max.y + 1, top + 1 }
+		};
+
+		// Draw it
+		glBeginQuery(GL_SAMPLES_PASSED, occ_queries_[a]);
+		glBegin(GL_QUADS);
+		for (auto corner : box_faces)
+			glVertex3dv(corners[corner]);
+		glEnd();
+		glEndQuery(GL_SAMPLES_PASSED);
+
+		occ_state_[a] |= OCC_QUERIED;
+	}
+
+	// Restore GL state
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_ALPHA_TEST);
 }
 
 // -----------------------------------------------------------------------------
@@ -2695,10 +3496,11 @@ void MapRenderer3D::checkVisibleQuads()
 	// Go through lines
 	MapLine* line;
 	float    distfade;
-	n_quads_         = 0;
-	unsigned updates = 0;
-	bool     update  = false;
-	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	n_quads_    = 0;
+	bool update = false;
+	Seg2d strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	vis_lines_.clear();
+	update_lines_.clear();
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
 		line = map_->line(a);
@@ -2743,15 +3545,19 @@ void MapRenderer3D::checkVisibleQuads()
 				update = true;
 		}
 		if (update)
-		{
-			updateLine(a);
-			// updates++;
-			// if (updates > 500)
-			//	break;
-		}
+			update_lines_.push_back(a);
 
-		// Determine quads to be drawn
-		for (auto& quad : lines_[a].quads)
+		vis_lines_.emplace_back(a, distfade);
+	}
+
+	// Update lines (all at once so they can be built in parallel)
+	if (!update_lines_.empty())
+		updateLines(update_lines_);
+
+	// Determine quads to be drawn
+	for (auto [index, fade] : vis_lines_)
+	{
+		for (auto& quad : lines_[index].quads)
 		{
 			// Check we're on the right side of the quad
 			if (math::lineSide(
@@ -2761,7 +3567,8 @@ void MapRenderer3D::checkVisibleQuads()
 				continue;
 
 			quads_[n_quads_] = &quad;
-			quad.alpha       = distfade;
+			quad.alpha       = fade;
+			quad.line        = index;
 			n_quads_++;
 		}
 	}
@@ -2829,11 +3636,64 @@ void MapRenderer3D::checkVisibleFlats()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Sends the nearest distance each visible wall and flat texture is visible at
+// to the texture manager, so that distant textures can be reduced in size.
+// This is only done a few times per second
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updateTextureResidency()
+{
+	if (app::runTimer() - residency_updated_ < 250)
+		return;
+	residency_updated_ = app::runTimer();
+
+	// Keep the nearest distance for each texture
+	std::map<unsigned, double> tex_dist;
+
+	auto set_dist = [&tex_dist](unsigned texture, double dist) {
+		auto [i, added] = tex_dist.emplace(texture, dist);
+		if (!added && dist < i->second)
+			i->second = dist;
+	};
+
+	// Walls
+	auto cam = cam_position_.get2d();
+	for (auto& line : lines_)
+	{
+		if (!line.visible || !line.line)
+			continue;
+
+		double dist = math::distanceToLine(cam, line.line->seg());
+		for (auto& quad : line.quads)
+			set_dist(quad.texture, dist);
+	}
+
+	// Flats
+	for (unsigned a = 0; a < map_->nSectors() && a < floors_.size(); a++)
+	{
+		if (dist_sectors_[a] < 0)
+			continue;
+
+		auto   sector = map_->sector(a);
+		double dist   = sector->boundingBox().contains(cam) ? 0. : sector->distanceTo(cam);
+		if (dist < 0)
+			continue;
+		set_dist(floors_[a].texture, dist);
+		set_dist(ceilings_[a].texture, dist);
+	}
+
+	mapeditor::textureManager().setTextureDistances(std::move(tex_dist));
+}
+
 // -----------------------------------------------------------------------------
 // Finds the closest wall/flat/thing to the camera along the view vector
 // -----------------------------------------------------------------------------
 mapeditor::Item MapRenderer3D::determineHilight()
 {
+	// Use the picking buffer result if enabled
+	if (render_3d_gpu_picking && pick_result_valid_ && map_)
+		return pickedItem();
+
 	// Init
 	double          min_dist = 9999999;
 	mapeditor::Item current;
@@ -3009,6 +3869,317 @@ mapeditor::Item MapRenderer3D::determineHilight()
 	return current;
 }
 
+// -----------------------------------------------------------------------------
+// Creates the 1x1 offscreen framebuffer and pixel buffers used for GPU picking.
+// Returns false if they are not supported
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::initPicking()
+{
+	if (pick_fbo_ > 0)
+		return true;
+	if (pick_unsupported_)
+		return false;
+
+	if (!GLEW_EXT_framebuffer_object || !GLEW_ARB_pixel_buffer_object)
+	{
+		log::warning("GPU picking is not supported (requires framebuffer and pixel buffer objects), using CPU picking");
+		pick_unsupported_ = true;
+		return false;
+	}
+
+	GLint prev_fbo = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prev_fbo);
+
+	// Create renderbuffers
+	glGenRenderbuffersEXT(1, &pick_rb_colour_);
+	glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, pick_rb_colour_);
+	glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, 1, 1);
+	glGenRenderbuffersEXT(1, &pick_rb_depth_);
+	glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, pick_rb_depth_);
+	glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, 1, 1);
+	glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+	// Create framebuffer
+	glGenFramebuffersEXT(1, &pick_fbo_);
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, pick_fbo_);
+	glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, pick_rb_colour_);
+	glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, pick_rb_depth_);
+	auto status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prev_fbo);
+	if (status != GL_FRAMEBUFFER_COMPLETE_EXT)
+	{
+		log::warning("GPU picking framebuffer is incomplete (status {:x}), using CPU picking", status);
+		glDeleteFramebuffersEXT(1, &pick_fbo_);
+		glDeleteRenderbuffersEXT(1, &pick_rb_colour_);
+		glDeleteRenderbuffersEXT(1, &pick_rb_depth_);
+		pick_fbo_         = 0;
+		pick_unsupported_ = true;
+		return false;
+	}
+
+	// Create pixel buffers to read the result back into
+	glGenBuffers(2, pick_pbos_);
+	for (auto pbo : pick_pbos_)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 4, nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Renders the ids of all visible walls, flats and things at the centre of the
+// view (the crosshair) into the picking buffer, and reads the result back.
+// The read back is asynchronous: the pixel rendered in a frame is picked up
+// at the start of the next, so determineHilight lags a frame behind
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderPickBuffer()
+{
+	if (!map_ || !initPicking())
+		return;
+
+	// Get the result from the last frame
+	if (pick_frame_ > 0)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pick_pbos_[(pick_frame_ + 1) % 2]);
+		if (auto pixel = static_cast<const uint8_t*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY)))
+		{
+			pick_result_ = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16) | (static_cast<uint32_t>(pixel[3]) << 24);
+			pick_result_valid_ = true;
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	// Save state
+	GLint prev_fbo = 0;
+	GLint viewport[4];
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prev_fbo);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glPushAttrib(
+		GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_VIEWPORT_BIT | GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT
+		| GL_CURRENT_BIT);
+
+	// Setup the projection to cover only the pixel at the centre of the view
+	GLdouble projection[16];
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glGetDoublev(GL_PROJECTION_MATRIX, projection);
+	glLoadIdentity();
+	gluPickMatrix(viewport[0] + viewport[2] * 0.5, viewport[1] + viewport[3] * 0.5, 1, 1, viewport);
+	glMultMatrixd(projection);
+	glMatrixMode(GL_MODELVIEW);
+
+	// Setup GL state (flat colour ids with depth test)
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, pick_fbo_);
+	glViewport(0, 0, 1, 1);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_FOG);
+	glDisable(GL_BLEND);
+	glDisable(GL_DITHER);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glDepthMask(GL_TRUE);
+	glCullFace(GL_BACK);
+
+	// Opaque walls (from the batched wall vertices)
+	if (!wall_vertices_.empty() && wall_pick_colours_.size() == wall_vertices_.size() * 4)
+	{
+		const char* data = nullptr;
+		if (gl::vboSupport())
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_walls_);
+		else
+			data = reinterpret_cast<const char*>(wall_vertices_.data());
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, sizeof(WallVertex), data);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, wall_pick_colours_.data());
+
+		glDrawArrays(GL_QUADS, 0, wall_vertices_.size());
+		frameprofiler::addDrawCalls();
+
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
+
+	// Transparent walls
+	for (auto quad : quads_transparent_)
+	{
+		setPickColour(wallPickId(*quad));
+		glBegin(GL_QUADS);
+		for (auto& point : quad->points)
+			glVertex3f(point.x, point.y, point.z);
+		glEnd();
+		frameprofiler::addDrawCalls();
+	}
+
+	// Flats
+	bool vbo = gl::vboSupport() && flats_use_vbo;
+	for (int ceil = 0; ceil < 2; ceil++)
+	{
+		auto& flats = ceil ? ceilings_ : floors_;
+		glCullFace(ceil ? GL_BACK : GL_FRONT);
+		if (vbo)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, ceil ? vbo_ceilings_ : vbo_floors_);
+			Polygon2D::setupVBOPointers();
+		}
+
+		for (unsigned a = 0; a < flats.size() && a < dist_sectors_.size(); a++)
+		{
+			if (dist_sectors_[a] < 0 || !flats[a].sector)
+				continue;
+
+			setPickColour(pickId(ceil ? PICK_CEILING : PICK_FLOOR, a));
+			if (vbo)
+				flats[a].sector->polygon()->renderVBO(false);
+			else
+			{
+				glPushMatrix();
+				glTranslated(0, 0, ceil ? flats[a].sector->ceiling().height : flats[a].sector->floor().height);
+				flats[a].sector->polygon()->render();
+				glPopMatrix();
+			}
+			frameprofiler::addDrawCalls();
+		}
+	}
+	if (vbo)
+	{
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Things (those drawn this frame, as their billboard rectangles)
+	glCullFace(GL_BACK);
+	if (render_3d_things > 0 && things_.size() == map_->nThings())
+	{
+		double halfwidth, theight;
+		for (unsigned a = 0; a < things_.size(); a++)
+		{
+			if (!(things_[a].flags & DRAWN))
+				continue;
+
+			auto  thing    = map_->thing(a);
+			auto& tex_info = gl::Texture::info(things_[a].sprite);
+			halfwidth      = things_[a].type->scaleX() * tex_info.size.x * 0.5;
+			theight        = things_[a].height;
+			if (things_[a].flags & ICON)
+				halfwidth = render_thing_icon_size * 0.5;
+			float x1 = thing->xPos() - cam_strafe_.x * halfwidth;
+			float y1 = thing->yPos() - cam_strafe_.y * halfwidth;
+			float x2 = thing->xPos() + cam_strafe_.x * halfwidth;
+			float y2 = thing->yPos() + cam_strafe_.y * halfwidth;
+
+			setPickColour(pickId(PICK_THING, a));
+			glBegin(GL_QUADS);
+			glVertex3f(x1, y1, things_[a].z + theight);
+			glVertex3f(x1, y1, things_[a].z);
+			glVertex3f(x2, y2, things_[a].z);
+			glVertex3f(x2, y2, things_[a].z + theight);
+			glEnd();
+			frameprofiler::addDrawCalls();
+		}
+	}
+
+	// Read the result into this frame's pixel buffer (asynchronously)
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pick_pbos_[pick_frame_ % 2]);
+	glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	++pick_frame_;
+
+	// Restore state
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prev_fbo);
+	glPopAttrib();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the item decoded from the last picking buffer result, and updates the
+// distance to it
+// -----------------------------------------------------------------------------
+mapeditor::Item MapRenderer3D::pickedItem()
+{
+	mapeditor::Item current;
+	item_dist_ = -1;
+
+	// Check for required map structures
+	if (lines_.size() != map_->nLines() || floors_.size() != map_->nSectors() || things_.size() != map_->nThings())
+		return current;
+
+	// Decode id
+	uint8_t kind  = pick_result_ >> 24;
+	int     index = static_cast<int>(pick_result_ & 0xFFFFFF) - 1;
+	if (index < 0)
+		return current;
+
+	double dist = -1;
+	switch (kind & PICK_KIND)
+	{
+	case PICK_WALL:
+	{
+		if (static_cast<unsigned>(index) >= map_->nLines())
+			return current;
+
+		// Side index
+		auto line     = map_->line(index);
+		current.index = (kind & PICK_BACK) ? line->s2Index() : line->s1Index();
+
+		// Side part
+		if (kind & PICK_UPPER)
+			current.type = mapeditor::ItemType::WallTop;
+		else if (kind & PICK_LOWER)
+			current.type = mapeditor::ItemType::WallBottom;
+		else
+			current.type = mapeditor::ItemType::WallMiddle;
+
+		dist = math::distanceRayLine(
+			cam_position_.get2d(), (cam_position_ + cam_dir3d_).get2d(), line->start(), line->end());
+		break;
+	}
+
+	case PICK_FLOOR:
+	case PICK_CEILING:
+	{
+		if (static_cast<unsigned>(index) >= map_->nSectors())
+			return current;
+
+		bool floor    = (kind & PICK_KIND) == PICK_FLOOR;
+		current.index = index;
+		current.type  = floor ? mapeditor::ItemType::Floor : mapeditor::ItemType::Ceiling;
+		dist = math::distanceRayPlane(cam_position_, cam_dir3d_, floor ? floors_[index].plane : ceilings_[index].plane);
+		break;
+	}
+
+	case PICK_THING:
+	{
+		if (static_cast<unsigned>(index) >= map_->nThings())
+			return current;
+
+		current.index = index;
+		current.type  = mapeditor::ItemType::Thing;
+		dist          = math::distance(cam_position_.get2d(), map_->thing(index)->position());
+		break;
+	}
+
+	default: return current;
+	}
+
+	// Update item distance
+	if (dist >= 0)
+		item_dist_ = math::round(dist);
+
+	return current;
+}
+
 // -----------------------------------------------------------------------------
 // Renders the hilight overlay for the currently hilighted object
 // -----------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapEditor/Edit/Edit3D.h"
+#include "MapEditor/MapTextureManager.h"
 #include "SLADEMap/SLADEMap.h"
 
 namespace slade
@@ -12,6 +13,10 @@ namespace game
 {
 	class ThingType;
 }
+namespace gl
+{
+	class Shader;
+}
 
 class MapRenderer3D
 {
@@ -53,6 +58,7 @@ public:
 		unsigned texture = 0;
 		uint8_t  flags   = 0;
 		float    alpha   = 1.f;
+		unsigned line    = 0; // Index of the line the quad is part of
 
 		Quad() : colour{ 255, 255, 255, 255, 0 } {}
 	};
@@ -98,9 +104,16 @@ public:
 	void enableHilight(bool render) { render_hilight_ = render; }
 	void enableSelection(bool render) { render_selection_ = render; }
 
-	bool init();
-	void refresh();
+	// Stats
+	unsigned nQuads() const { return n_quads_; }
+	unsigned nQuadsOccluded() const { return n_quads_occluded_; }
+	unsigned nSectorsOccluded() const { return n_sectors_occluded_; }
+
+	bool   init();
+	void   refresh();
+	size_t vboMemoryUsage() const { return vbo_flats_size_; }
 	void refreshTextures();
+	void refreshTextures(const std::set<unsigned>& gl_ids);
 	void clearData();
 	void buildSkyCircle();
 
@@ -126,6 +139,7 @@ public:
 	// -- Rendering --
 	void setupView(int width, int height);
 	void setLight(ColRGBA& colour, uint8_t light, float alpha = 1.0f) const;
+	void lightColour(const ColRGBA& colour, uint8_t light, float alpha, float* rgba) const;
 	void setFog(ColRGBA& fogcol, uint8_t light);
 	void renderMap();
 	void renderSkySlice(
@@ -159,6 +173,7 @@ public:
 		double sx        = 1,
 		double sy        = 1) const;
 	void updateLine(unsigned index);
+	void updateLines(const vector<unsigned>& indices);
 	void renderQuad(Quad* quad, float alpha = 1.0f);
 	void renderWalls();
 	void renderTransparentWalls();
@@ -171,17 +186,23 @@ public:
 
 	// VBO stuff
 	void updateFlatsVBO();
-	void updateWallsVBO() const;
+	bool updateFlatVBO(MapSector* sector) const;
+	void updateWallsVBO();
 
 	// Visibility checking
+	bool  checkPortalVisibility();
+	void  checkOcclusion();
+	void  renderOcclusionQueries();
 	void  quickVisDiscard();
 	float calcDistFade(double distance, double max = -1) const;
 	void  checkVisibleQuads();
 	void  checkVisibleFlats();
+	void  updateTextureResidency();
 
 	// Hilight
 	mapeditor::Item determineHilight();
 	void            renderHilight(mapeditor::Item hilight, float alpha = 1.0f);
+	void            renderPickBuffer();
 
 private:
 	SLADEMap* map_;
@@ -196,7 +217,23 @@ private:
 	float     fog_depth_last_ = 0.f;
 
 	// Visibility
-	vector<float> dist_sectors_;
+	vector<float>   dist_sectors_;
+	vector<uint8_t> vis_sectors_;           // Sectors reachable from the camera through portals
+	long            residency_updated_ = 0; // Time texture distances were last sent to the texture manager
+
+	// Occlusion culling. Each sector's bounding box is drawn with an occlusion
+	// query after the frame is rendered, sectors with no visible samples are
+	// hidden the following frame
+	enum
+	{
+		OCC_QUERY   = 1, // Query this frame
+		OCC_QUERIED = 2, // Query was issued
+		OCC_HIDDEN  = 4, // Hidden by occlusion this frame
+	};
+	vector<unsigned> occ_queries_;
+	vector<uint8_t>  occ_state_;
+	unsigned         n_sectors_occluded_ = 0;
+	unsigned         n_quads_occluded_   = 0;
 
 	// Camera
 	Vec3d  cam_position_;
@@ -217,10 +254,51 @@ private:
 	vector<Flat>  ceilings_;
 	Flat**        flats_ = nullptr;
 
+	// Line updates. Wall textures are loaded up front so that line quads can be
+	// built in parallel, see updateLines
+	std::unordered_map<unsigned, const MapTextureManager::Texture*> line_textures_; // By TextureName::id
+	MapTextureManager::Texture                                      tex_none_;
+	vector<unsigned>                                                update_lines_;
+	vector<std::pair<unsigned, float>>                              vis_lines_; // Visible lines and their distance fade
+
 	// VBOs
-	unsigned vbo_floors_   = 0;
-	unsigned vbo_ceilings_ = 0;
-	unsigned vbo_walls_    = 0;
+	unsigned vbo_floors_     = 0;
+	unsigned vbo_ceilings_   = 0;
+	unsigned vbo_walls_      = 0;
+	size_t   vbo_flats_size_ = 0; // Total size of floor + ceiling VBOs
+	unsigned vbo_flats_n_    = 0; // Number of sectors when the flat VBOs were last rebuilt
+	long     vbo_flats_time_ = 0; // Time the flat VBOs were last rebuilt
+
+	// Wall batches (visible opaque wall quads, grouped by texture and render
+	// state), rebuilt each frame and drawn from the walls VBO
+	struct WallVertex
+	{
+		float x, y, z;
+		float tx, ty;
+		float r, g, b, a;
+	};
+	struct WallBatch
+	{
+		Quad*    quad;  // First quad in the batch (for texture and render state)
+		unsigned first; // First vertex
+		unsigned count; // Number of vertices
+	};
+	vector<WallVertex> wall_vertices_;
+	vector<WallBatch>  wall_batches_;
+	vector<uint8_t>    wall_pick_colours_; // Pick id colour (RGBA) for each wall vertex, see renderPickBuffer
+
+	// GPU picking. The ids of all visible objects are rendered into a 1x1
+	// offscreen buffer covering the pixel under the crosshair, which is read
+	// back asynchronously (via alternating pixel buffers) and used by
+	// determineHilight the following frame
+	unsigned pick_fbo_          = 0;
+	unsigned pick_rb_colour_    = 0;
+	unsigned pick_rb_depth_     = 0;
+	unsigned pick_pbos_[2]      = { 0, 0 };
+	unsigned pick_frame_        = 0; // Number of frames the pick buffer has been rendered
+	uint32_t pick_result_       = 0;
+	bool     pick_result_valid_ = false;
+	bool     pick_unsupported_  = false;
 
 	// Sky
 	struct GLVertexEx
@@ -235,8 +313,17 @@ private:
 	ColRGBA skycol_bottom_;
 	Vec2d   sky_circle_[32];
 
+	unique_ptr<gl::Shader> shader_sky_;
+	gl::Shader&            skyShader();
+
 	// Signal connections
 	sigslot::scoped_connection sc_resources_updated_;
+	sigslot::scoped_connection sc_resources_changed_;
 	sigslot::scoped_connection sc_palette_changed_;
+
+	const MapTextureManager::Texture& lineTexture(const TextureName& name, bool mixed) const;
+	void                              buildLineQuads(unsigned index);
+	bool                              initPicking();
+	mapeditor::Item                   pickedItem();
 };
 } // namespace slade
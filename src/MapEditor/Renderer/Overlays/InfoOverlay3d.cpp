@@ -471,7 +471,7 @@ void InfoOverlay3D::update(int item_index, mapeditor::ItemType item_type, SLADEM
 
 
 		// Texture
-		texture_ = mapeditor::textureManager().sprite(tt.sprite(), tt.translation(), tt.palette()).gl_id;
+		texture_ = mapeditor::textureManager().sprite(tt).gl_id;
 		if (!texture_)
 		{
 			if (use_zeth_icons && tt.zethIcon() >= 0)
@@ -0,0 +1,342 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    RenderBenchmark.cpp
+// Description: Benchmark of the map editor's 2d and 3d renderers, rendering
+//              the open map along a scripted camera path into an offscreen
+//              framebuffer
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "RenderBenchmark.h"
+#include "FrameProfiler.h"
+#include "General/ColourConfiguration.h"
+#include "General/Console.h"
+#include "MapEditor/MapEditContext.h"
+#include "MapEditor/MapEditor.h"
+#include "MapEditor/MapTextureManager.h"
+#include "MapEditor/UI/MapCanvas.h"
+#include "OpenGL/GLTexture.h"
+#include "OpenGL/OpenGL.h"
+#include "Renderer.h"
+#include "SLADEMap/MapObject/MapSector.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+
+using namespace slade;
+using namespace mapeditor;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, flat_drawtype)
+EXTERN_CVAR(Bool, line_tabs_always)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Offscreen framebuffer to render to
+struct FrameBuffer
+{
+	GLuint fbo       = 0;
+	GLuint rb_colour = 0;
+	GLuint rb_depth  = 0;
+	bool   complete  = false;
+
+	FrameBuffer(int width, int height)
+	{
+		glGenRenderbuffersEXT(1, &rb_colour);
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, rb_colour);
+		glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, width, height);
+		glGenRenderbuffersEXT(1, &rb_depth);
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, rb_depth);
+		glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+		glGenFramebuffersEXT(1, &fbo);
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+		glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, rb_colour);
+		glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, rb_depth);
+		complete = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT;
+	}
+
+	~FrameBuffer()
+	{
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+		glDeleteFramebuffersEXT(1, &fbo);
+		glDeleteRenderbuffersEXT(1, &rb_colour);
+		glDeleteRenderbuffersEXT(1, &rb_depth);
+	}
+};
+
+// Timings and counts for each frame rendered
+struct FrameRecord
+{
+	vector<double> times_ms;
+	double         draw_calls = 0.;
+	double         binds      = 0.;
+};
+
+// -----------------------------------------------------------------------------
+// Renders one frame of size [width,height] with [draw] and adds its timings
+// and counts to [record] (if given), in the same way as Renderer::draw
+// -----------------------------------------------------------------------------
+void renderFrame(
+	MapEditContext&              context,
+	int                          width,
+	int                          height,
+	const std::function<void()>& draw,
+	FrameRecord*                 record)
+{
+	auto& renderer = context.renderer();
+
+	frameprofiler::beginFrame();
+	auto binds = gl::Texture::bindCount();
+	auto start = std::chrono::steady_clock::now();
+
+	// Update textures
+	textureManager().update();
+	if (auto stale = textureManager().takeStaleTextures(); !stale.empty())
+	{
+		renderer.renderer2D().refreshTextures(stale);
+		renderer.renderer3D().refreshTextures(stale);
+	}
+
+	// Setup GL state
+	glViewport(0, 0, width, height);
+	auto col_bg = colourconfig::colour("map_background");
+	glClearColor(col_bg.fr(), col_bg.fg(), col_bg.fb(), 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+
+	draw();
+
+	// Wait for the frame to actually be rendered
+	glFinish();
+
+	if (record)
+	{
+		record->times_ms.push_back(
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		record->draw_calls += frameprofiler::drawCalls();
+		record->binds += gl::Texture::bindCount() - binds;
+	}
+
+	frameprofiler::endFrame();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the benchmark result for [record] called [name]
+// -----------------------------------------------------------------------------
+benchmark::Result frameResult(string_view name, size_t items, const FrameRecord& record)
+{
+	auto result = benchmark::summarise(name, items, record.times_ms);
+	if (!record.times_ms.empty())
+	{
+		result.draw_calls    = record.draw_calls / record.times_ms.size();
+		result.texture_binds = record.binds / record.times_ms.size();
+	}
+	return result;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// renderbenchmark Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Renders [frames] frames each of the map open in [context] in 2d and 3d, at
+// [width]x[height]. Each camera path is rendered once untimed first, so
+// texture loading and geometry building aren't included in the frame times.
+// The map editor's GL context (from its canvas) is used, but nothing is
+// rendered to the canvas itself, and the view/camera is restored afterwards
+// -----------------------------------------------------------------------------
+benchmark::Report renderbenchmark::run(MapEditContext& context, unsigned frames, int width, int height)
+{
+	benchmark::Report report;
+	report.archive = context.mapDesc().name;
+
+	auto canvas = context.canvas();
+	if (!canvas || !canvas->setContext() || frames == 0)
+		return report;
+
+	FrameBuffer framebuffer(width, height);
+	if (!framebuffer.complete)
+	{
+		log::error("Unable to create {}x{} framebuffer for render benchmark", width, height);
+		return report;
+	}
+
+	auto& map         = context.map();
+	auto& renderer    = context.renderer();
+	auto& renderer_2d = renderer.renderer2D();
+	auto& renderer_3d = renderer.renderer3D();
+	auto& view        = renderer.view();
+	auto  bbox        = map.bounds();
+	auto  centre      = bbox.mid();
+	auto  n_objects   = map.nLines() + map.nSectors() + map.nThings();
+
+	frameprofiler::setRecording(true);
+
+	// --- 2d ---
+
+	// Save view
+	auto prev_size   = view.size();
+	auto prev_offset = view.offset();
+	auto prev_scale  = view.scale();
+
+	// Camera path: circle around the middle of the map while zooming from
+	// showing the whole map to 8x and back
+	view.setSize(width, height);
+	view.fitTo(bbox);
+	auto fit_scale = view.scale();
+	auto set_view  = [&](unsigned frame) {
+		auto angle = math::PI * 2. * frame / frames;
+		view.setOffset(centre.x + bbox.width() * 0.3 * cos(angle), centre.y + bbox.height() * 0.3 * sin(angle));
+		view.zoom(fit_scale * (4.5 - 3.5 * cos(angle)) / view.scale());
+		view.resetInter(true, true, true);
+		renderer_2d.setScale(view.scale(true));
+		renderer_2d.updateVisibility(view.mapBounds().tl, view.mapBounds().br);
+	};
+	auto draw_2d = [&]() {
+		view.apply();
+		if (flat_drawtype > 0)
+			renderer_2d.renderFlats(0, flat_drawtype > 1);
+		renderer_2d.renderLines(line_tabs_always);
+		renderer_2d.renderThings();
+		renderer_2d.renderVertices();
+	};
+
+	FrameRecord record_2d;
+	for (auto* record : { (FrameRecord*)nullptr, &record_2d })
+		for (unsigned frame = 0; frame < frames; ++frame)
+		{
+			set_view(frame);
+			renderFrame(context, width, height, draw_2d, record);
+		}
+	report.results.push_back(frameResult(fmt::format("2d render {}x{}", width, height), n_objects, record_2d));
+
+	// Restore view
+	view.setSize(prev_size.x, prev_size.y);
+	view.setOffset(prev_offset.x, prev_offset.y);
+	view.zoom(prev_scale / view.scale());
+	view.resetInter(true, true, true);
+	renderer_2d.setScale(view.scale(true));
+	renderer_2d.updateVisibility(view.mapBounds().tl, view.mapBounds().br);
+
+	// --- 3d ---
+
+	// Save camera
+	auto prev_position  = renderer_3d.camPosition();
+	auto prev_direction = renderer_3d.camDirection();
+	auto prev_pitch     = renderer_3d.camPitch();
+
+	// Camera path: walk around the middle of the map at eye height above the
+	// floor, facing along the path
+	auto set_camera = [&](unsigned frame) {
+		auto  angle  = math::PI * 2. * frame / frames;
+		Vec2d pos    = { centre.x + bbox.width() * 0.35 * cos(angle), centre.y + bbox.height() * 0.35 * sin(angle) };
+		auto  sector = map.sectors().atPos(pos);
+		auto  z      = sector ? sector->floor().height + 41. : 41.;
+		renderer_3d.cameraSet({ pos.x, pos.y, z }, Vec2d{ -sin(angle), cos(angle) }.normalized());
+	};
+	auto draw_3d = [&]() {
+		renderer_3d.setupView(width, height);
+		renderer_3d.renderMap();
+	};
+
+	FrameRecord record_3d;
+	for (auto* record : { (FrameRecord*)nullptr, &record_3d })
+		for (unsigned frame = 0; frame < frames; ++frame)
+		{
+			set_camera(frame);
+			renderFrame(context, width, height, draw_3d, record);
+		}
+	report.results.push_back(frameResult(fmt::format("3d render {}x{}", width, height), n_objects, record_3d));
+
+	// Restore camera
+	renderer_3d.cameraSet(prev_position, prev_direction);
+	renderer_3d.cameraPitch(prev_pitch);
+
+	frameprofiler::setRecording(false);
+
+	return report;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(m_benchmark, 0, true)
+{
+	if (!mapeditor::windowCreated() || !mapeditor::windowWx()->IsShown())
+	{
+		log::console("The map editor must be open to run the render benchmark");
+		return;
+	}
+
+	unsigned frames = args.size() > 0 ? strutil::asInt(args[0]) : 300;
+	auto     report = renderbenchmark::run(mapeditor::editContext(), frames, 1280, 720);
+	if (report.results.empty())
+	{
+		log::console("Unable to run the render benchmark, see the log for details");
+		return;
+	}
+
+	benchmark::logReport(report);
+
+	if (args.size() > 1)
+	{
+		if (benchmark::writeJSON(args[1], { report }))
+			log::console(fmt::format("Wrote benchmark results to \"{}\"", args[1]));
+		else
+			log::error("Unable to write benchmark results to \"{}\"", args[1]);
+	}
+
+	mapeditor::forceRefresh(true);
+}
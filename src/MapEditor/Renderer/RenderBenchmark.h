@@ -0,0 +1,17 @@
+#pragma once
+
+#include "General/Benchmark.h"
+
+namespace slade
+{
+class MapEditContext;
+
+// Benchmark of the map editor's 2d and 3d renderers. Renders the open map
+// along a scripted camera path (the same for every run of the same map) into
+// an offscreen framebuffer, recording frame time percentiles, draw calls and
+// texture binds. Run via the 'm_benchmark' console command
+namespace renderbenchmark
+{
+	benchmark::Report run(MapEditContext& context, unsigned frames, int width, int height);
+} // namespace renderbenchmark
+} // namespace slade
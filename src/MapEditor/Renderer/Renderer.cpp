@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "Renderer.h"
 #include "App.h"
+#include "FrameProfiler.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/ColourConfiguration.h"
@@ -40,6 +41,7 @@
 #include "MapEditor/MapEditContext.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "Overlays/MCOverlay.h"
 #include "Utility/MathStuff.h"
 
@@ -70,6 +72,90 @@ CVAR(Int, map_crosshair, 0, CVar::Flag::Save)
 CVAR(Bool, map_show_selection_numbers, true, CVar::Flag::Save)
 CVAR(Int, map_max_selection_numbers, 1000, CVar::Flag::Save)
 CVAR(Int, flat_drawtype, 2, CVar::Flag::Save)
+namespace
+{
+// Map grid shader, draws all grid lines for the visible area with a single
+// quad covering the view, by checking each pixel's distance (in screen pixels)
+// from the nearest grid line
+const char* shader_grid_vert = R"(#version 120
+varying vec2 map_pos;
+void main()
+{
+	gl_Position = ftransform();
+	map_pos     = gl_Vertex.xy;
+}
+)";
+const char* shader_grid_frag = R"(#version 120
+uniform float pixel_size;   // Size of a screen pixel in map units
+uniform float grid_size;    // Regular grid size (0 if it isn't drawn)
+uniform vec4  grid_colour;
+uniform vec4  grid64_colour;
+uniform int   grid64_style; // 0 = none, 1 = full lines, 2 = crosses
+uniform float cross_size;   // Half size of 64 grid crosses in map units
+uniform int   dashed;
+uniform int   show_origin;
+varying vec2  map_pos;
+
+// Returns the distance in pixels to the nearest vertical (x) and horizontal
+// (y) line of a grid with the given size
+vec2 lineDist(float size)
+{
+	return abs(map_pos - size * floor(map_pos / size + 0.5)) / pixel_size;
+}
+
+void main()
+{
+	// Dashed lines alternate every 2 pixels along the line
+	vec2  dash = mod(floor(gl_FragCoord.yx * 0.5), 2.0);
+	bvec2 on   = dashed > 0 ? equal(dash, vec2(0.0)) : bvec2(true);
+
+	// 64 grid
+	if (grid64_style == 1)
+	{
+		vec2 dist = lineDist(64.0);
+		if ((dist.x < 0.5 && on.x) || (dist.y < 0.5 && on.y))
+		{
+			gl_FragColor = grid64_colour;
+			return;
+		}
+	}
+	else if (grid64_style == 2)
+	{
+		vec2 dist = lineDist(64.0);
+		vec2 from = dist * pixel_size;
+		if ((dist.x < 0.5 && from.y <= cross_size) || (dist.y < 0.5 && from.x <= cross_size))
+		{
+			gl_FragColor = grid64_colour;
+			return;
+		}
+	}
+
+	// Origin lines
+	if (show_origin > 0)
+	{
+		vec2 dist = abs(map_pos) / pixel_size;
+		if ((dist.x < 1.5 && on.x) || (dist.y < 1.5 && on.y))
+		{
+			gl_FragColor = grid_colour;
+			return;
+		}
+	}
+
+	// Regular grid
+	if (grid_size > 0.0)
+	{
+		vec2 dist = lineDist(grid_size);
+		if ((dist.x < 0.5 && on.x) || (dist.y < 0.5 && on.y))
+		{
+			gl_FragColor = grid_colour;
+			return;
+		}
+	}
+
+	discard;
+}
+)";
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -79,6 +165,7 @@ CVAR(Int, flat_drawtype, 2, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, vertex_round)
 EXTERN_CVAR(Int, vertex_size)
+EXTERN_CVAR(Bool, render_3d_stats)
 
 
 // -----------------------------------------------------------------------------
@@ -96,6 +183,11 @@ Renderer::Renderer(MapEditContext& context) :
 {
 }
 
+// -----------------------------------------------------------------------------
+// Renderer class destructor
+// -----------------------------------------------------------------------------
+Renderer::~Renderer() = default;
+
 // -----------------------------------------------------------------------------
 // Updates/refreshes the 2d and 3d renderers
 // -----------------------------------------------------------------------------
@@ -322,6 +414,21 @@ Vec2d Renderer::cameraDir2D() const
 	return renderer_3d_.camDirection();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the shader used to draw the grid, loading it if needed. The shader
+// will be invalid if shaders aren't supported
+// -----------------------------------------------------------------------------
+gl::Shader& Renderer::gridShader() const
+{
+	if (!shader_grid_)
+	{
+		shader_grid_ = std::make_unique<gl::Shader>("map2d_grid");
+		shader_grid_->load(shader_grid_vert, shader_grid_frag);
+	}
+
+	return *shader_grid_;
+}
+
 // -----------------------------------------------------------------------------
 // Draws the grid
 // -----------------------------------------------------------------------------
@@ -330,20 +437,6 @@ void Renderer::drawGrid() const
 	// Get grid size
 	int gridsize = context_.gridSize();
 
-	// Disable line smoothing (not needed for straight, 1.0-sized lines)
-	glDisable(GL_LINE_SMOOTH);
-	glLineWidth(1.0f);
-
-	// Enable dashed lines if needed
-	if (grid_dashed)
-	{
-		glLineStipple(2, 0xAAAA);
-		glEnable(GL_LINE_STIPPLE);
-	}
-
-	gl::setColour(colourconfig::colour("map_grid"));
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
 	// Determine smallest grid size to bother drawing
 	int grid_hidelevel = 2.0 / view_.scale();
 
@@ -353,116 +446,163 @@ void Renderer::drawGrid() const
 	int start_y = view_.mapY(view_.size().y, true);
 	int end_y   = view_.mapY(0, true);
 
-	// Draw regular grid if it's not too small
-	if (gridsize > grid_hidelevel)
-	{
-		// Vertical
-		int ofs = start_x % gridsize;
-		for (int x = start_x - ofs; x <= end_x; x += gridsize)
-		{
-			glBegin(GL_LINES);
-			glVertex2d(x, start_y);
-			glVertex2d(x, end_y);
-			glEnd();
-		}
-
-		// Horizontal
-		ofs = start_y % gridsize;
-		for (int y = start_y - ofs; y <= end_y; y += gridsize)
-		{
-			glBegin(GL_LINES);
-			glVertex2d(start_x, y);
-			glVertex2d(end_x, y);
-			glEnd();
-		}
-	}
+	// Size of 64 grid crosses
+	int cross_size = 8;
+	if (gridsize < cross_size)
+		cross_size = gridsize;
 
-	// Draw origin grid lines
-	if (grid_show_origin)
+	// Draw the grid with the shader if supported
+	auto& shader = gridShader();
+	if (shader.isValid())
 	{
-		glEnable(GL_LINE_SMOOTH);
-		glLineWidth(3.0f);
-
-		glBegin(GL_LINES);
-		glVertex2d(0, start_y);
-		glVertex2d(0, end_y);
-		glVertex2d(start_x, 0);
-		glVertex2d(end_x, 0);
+		auto col_grid   = colourconfig::colour("map_grid");
+		auto col_grid64 = colourconfig::colDef("map_64grid").colour;
+		int  style_64   = 64 > grid_hidelevel && gridsize < 64 ? static_cast<int>(grid_64_style) : 0;
+
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		shader.bind();
+		shader.setUniform("pixel_size", static_cast<float>(1.0 / view_.scale(true)));
+		shader.setUniform("grid_size", gridsize > grid_hidelevel ? static_cast<float>(gridsize) : 0.f);
+		shader.setUniform("grid_colour", col_grid.fr(), col_grid.fg(), col_grid.fb(), col_grid.fa());
+		shader.setUniform("grid64_colour", col_grid64.fr(), col_grid64.fg(), col_grid64.fb(), col_grid64.fa());
+		shader.setUniform("grid64_style", style_64);
+		shader.setUniform("cross_size", static_cast<float>(cross_size));
+		shader.setUniform("dashed", grid_dashed ? 1 : 0);
+		shader.setUniform("show_origin", grid_show_origin ? 1 : 0);
+
+		// Draw a quad covering the view
+		double x1 = view_.mapX(0, true);
+		double x2 = view_.mapX(view_.size().x, true);
+		double y1 = view_.mapY(view_.size().y, true);
+		double y2 = view_.mapY(0, true);
+		glBegin(GL_QUADS);
+		glVertex2d(x1, y1);
+		glVertex2d(x1, y2);
+		glVertex2d(x2, y2);
+		glVertex2d(x2, y1);
 		glEnd();
 
+		gl::Shader::unbind();
+	}
+	else
+	{
+		// Disable line smoothing (not needed for straight, 1.0-sized lines)
 		glDisable(GL_LINE_SMOOTH);
 		glLineWidth(1.0f);
-	}
 
-	// Disable dashed lines if 64 grid is set to crosses
-	if (grid_64_style > 1)
-		glDisable(GL_LINE_STIPPLE);
-
-	// Draw 64 grid if it's not too small and we're not on a larger grid size
-	if (64 > grid_hidelevel && gridsize < 64 && grid_64_style > 0)
-	{
-		int cross_size = 8;
-		if (gridsize < cross_size)
-			cross_size = gridsize;
+		// Enable dashed lines if needed
+		if (grid_dashed)
+		{
+			glLineStipple(2, 0xAAAA);
+			glEnable(GL_LINE_STIPPLE);
+		}
 
-		colourconfig::setGLColour("map_64grid");
+		gl::setColour(colourconfig::colour("map_grid"));
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		// Vertical
-		int ofs = start_x % 64;
-		for (int x = start_x - ofs; x <= end_x; x += 64)
+		// Draw regular grid if it's not too small
+		if (gridsize > grid_hidelevel)
 		{
 			glBegin(GL_LINES);
 
-			if (grid_64_style > 1)
-			{
-				// Cross style
-				int y = start_y - (start_y % 64);
-				while (y < end_y)
-				{
-					glVertex2d(x, y - cross_size);
-					glVertex2d(x, y + cross_size);
-					y += 64;
-				}
-			}
-			else
+			// Vertical
+			int ofs = start_x % gridsize;
+			for (int x = start_x - ofs; x <= end_x; x += gridsize)
 			{
-				// Full style
 				glVertex2d(x, start_y);
 				glVertex2d(x, end_y);
 			}
 
+			// Horizontal
+			ofs = start_y % gridsize;
+			for (int y = start_y - ofs; y <= end_y; y += gridsize)
+			{
+				glVertex2d(start_x, y);
+				glVertex2d(end_x, y);
+			}
+
 			glEnd();
 		}
 
-		// Horizontal
-		ofs = start_y % 64;
-		for (int y = start_y - ofs; y <= end_y; y += 64)
+		// Draw origin grid lines
+		if (grid_show_origin)
 		{
+			glEnable(GL_LINE_SMOOTH);
+			glLineWidth(3.0f);
+
 			glBegin(GL_LINES);
+			glVertex2d(0, start_y);
+			glVertex2d(0, end_y);
+			glVertex2d(start_x, 0);
+			glVertex2d(end_x, 0);
+			glEnd();
+
+			glDisable(GL_LINE_SMOOTH);
+			glLineWidth(1.0f);
+		}
 
-			if (grid_64_style > 1)
+		// Disable dashed lines if 64 grid is set to crosses
+		if (grid_64_style > 1)
+			glDisable(GL_LINE_STIPPLE);
+
+		// Draw 64 grid if it's not too small and we're not on a larger grid size
+		if (64 > grid_hidelevel && gridsize < 64 && grid_64_style > 0)
+		{
+			colourconfig::setGLColour("map_64grid");
+
+			glBegin(GL_LINES);
+
+			// Vertical
+			int ofs = start_x % 64;
+			for (int x = start_x - ofs; x <= end_x; x += 64)
 			{
-				// Cross style
-				int x = start_x - (start_x % 64);
-				while (x < end_x)
+				if (grid_64_style > 1)
 				{
-					glVertex2d(x - cross_size, y);
-					glVertex2d(x + cross_size, y);
-					x += 64;
+					// Cross style
+					int y = start_y - (start_y % 64);
+					while (y < end_y)
+					{
+						glVertex2d(x, y - cross_size);
+						glVertex2d(x, y + cross_size);
+						y += 64;
+					}
+				}
+				else
+				{
+					// Full style
+					glVertex2d(x, start_y);
+					glVertex2d(x, end_y);
 				}
 			}
-			else
+
+			// Horizontal
+			ofs = start_y % 64;
+			for (int y = start_y - ofs; y <= end_y; y += 64)
 			{
-				// Full style
-				glVertex2d(start_x, y);
-				glVertex2d(end_x, y);
+				if (grid_64_style > 1)
+				{
+					// Cross style
+					int x = start_x - (start_x % 64);
+					while (x < end_x)
+					{
+						glVertex2d(x - cross_size, y);
+						glVertex2d(x + cross_size, y);
+						x += 64;
+					}
+				}
+				else
+				{
+					// Full style
+					glVertex2d(start_x, y);
+					glVertex2d(end_x, y);
+				}
 			}
 
 			glEnd();
 		}
-	}
 
-	glDisable(GL_LINE_STIPPLE);
+		glDisable(GL_LINE_STIPPLE);
+	}
 
 	// Draw crosshair if needed
 	if (map_crosshair > 0)
@@ -536,6 +676,7 @@ void Renderer::drawEditorMessages() const
 	drawing::enableTextStateReset(false);
 
 	// Go through editor messages
+	drawing::beginTextBatch();
 	for (unsigned a = 0; a < context_.numEditorMessages(); a++)
 	{
 		// Check message time
@@ -567,11 +708,44 @@ void Renderer::drawEditorMessages() const
 
 		yoff += 16;
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::setTextState(false);
 	drawing::enableTextStateReset(true);
 }
 
+// -----------------------------------------------------------------------------
+// Draws the frame profiler overlay (average timings of recent frames) in the
+// top-right corner of the view
+// -----------------------------------------------------------------------------
+void Renderer::drawFrameProfiler() const
+{
+	auto lines = frameprofiler::report();
+	if (lines.empty())
+		return;
+
+	// Determine box size
+	double width = 0.;
+	for (const auto& line : lines)
+		width = std::max(width, drawing::textExtents(line, drawing::Font::Monospace).x);
+	double line_height = 16.;
+	double x           = view_.size().x - width - 16.;
+	double y           = 8.;
+
+	// Draw background
+	glDisable(GL_TEXTURE_2D);
+	gl::setColour(ColRGBA(0, 0, 0, 160));
+	drawing::drawFilledRect(x - 4., y - 4., x + width + 4., y + lines.size() * line_height + 4.);
+
+	// Draw timings
+	glEnable(GL_TEXTURE_2D);
+	for (const auto& line : lines)
+	{
+		drawing::drawText(line, x, y, ColRGBA(255, 255, 255, 220), drawing::Font::Monospace);
+		y += line_height;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Draws any feature help text currently showing
 // -----------------------------------------------------------------------------
@@ -612,6 +786,7 @@ void Renderer::drawFeatureHelpText() const
 		drawing::drawText(help_lines[a], view_.size().x - 2, yoff, col, drawing::Font::Bold, drawing::Align::Right);
 		yoff += 16;
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::setTextState(false);
 	drawing::enableTextStateReset(true);
@@ -641,6 +816,7 @@ void Renderer::drawSelectionNumbers() const
 	if (context_.selection().size() <= map_max_selection_numbers * 0.5)
 		drawing::setTextOutline(1.0f, ColRGBA::BLACK);
 #endif
+	drawing::beginTextBatch();
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
 		if ((int)a > map_max_selection_numbers)
@@ -664,8 +840,9 @@ void Renderer::drawSelectionNumbers() const
 		}
 
 		// Draw text
-		drawing::drawText(fmt::format("{}", a + 1), tp.x, tp.y, col, drawing::Font::Bold);
+		drawing::drawText(text, tp.x, tp.y, col, drawing::Font::Bold);
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::enableTextStateReset();
 	drawing::setTextState(false);
@@ -1222,6 +1399,20 @@ void Renderer::drawMap3d()
 // -----------------------------------------------------------------------------
 void Renderer::draw()
 {
+	frameprofiler::beginFrame();
+
+	// Update textures (load queued textures, unload unused ones etc.), and
+	// refresh anything drawn with a texture that was replaced or unloaded
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Textures);
+		mapeditor::textureManager().update();
+		if (auto stale = mapeditor::textureManager().takeStaleTextures(); !stale.empty())
+		{
+			renderer_2d_.refreshTextures(stale);
+			renderer_3d_.refreshTextures(stale);
+		}
+	}
+
 	// Setup the viewport
 	glViewport(0, 0, view_.size().x, view_.size().y);
 
@@ -1234,11 +1425,14 @@ void Renderer::draw()
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisable(GL_TEXTURE_2D);
 
-	// Draw 2d or 3d map depending on mode
+	// Draw 2d or 3d map depending on mode (any textures not loaded yet are
+	// queued to load over the following frames rather than immediately)
+	mapeditor::textureManager().enableLoadQueue(true);
 	if (context_.editMode() == Mode::Visual)
 		drawMap3d();
 	else
 		drawMap2d();
+	mapeditor::textureManager().enableLoadQueue(false);
 
 	// Draw info overlay
 	glDisable(GL_CULL_FACE);
@@ -1255,12 +1449,15 @@ void Renderer::draw()
 		glTranslatef(0.375f, 0.375f, 0);
 
 	// Draw current info overlay
-	glDisable(GL_TEXTURE_2D);
-	context_.drawInfoOverlay(view_.size(), anim_info_fade_);
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Overlays);
+		glDisable(GL_TEXTURE_2D);
+		context_.drawInfoOverlay(view_.size(), anim_info_fade_);
 
-	// Draw current fullscreen overlay
-	if (context_.currentOverlay())
-		context_.currentOverlay()->draw(view_.size().x, view_.size().y, anim_overlay_fade_);
+		// Draw current fullscreen overlay
+		if (context_.currentOverlay())
+			context_.currentOverlay()->draw(view_.size().x, view_.size().y, anim_overlay_fade_);
+	}
 
 	// Draw crosshair if 3d mode
 	if (context_.editMode() == Mode::Visual)
@@ -1316,6 +1513,38 @@ void Renderer::draw()
 				ColRGBA(255, 255, 255, 200),
 				drawing::Font::Small);
 		}
+
+		// Draw render stats
+		if (render_3d_stats)
+		{
+			frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Text);
+			glEnable(GL_TEXTURE_2D);
+			drawing::drawText(
+				fmt::format(
+					"Quads: {} submitted, {} occluded ({} sectors)",
+					renderer_3d_.nQuads(),
+					renderer_3d_.nQuadsOccluded(),
+					renderer_3d_.nSectorsOccluded()),
+				2,
+				view_.size().y - 18,
+				ColRGBA(255, 255, 255, 200),
+				drawing::Font::Bold);
+
+			auto tex_stats = mapeditor::textureManager().memoryStats();
+			drawing::drawText(
+				fmt::format(
+					"Textures: {} loaded, {}MB / {}, {} reduced, {} proxies, {} unloaded",
+					tex_stats.loaded,
+					tex_stats.used / (1024 * 1024),
+					tex_stats.budget > 0 ? fmt::format("{}MB", tex_stats.budget / (1024 * 1024)) : "unlimited",
+					tex_stats.reduced,
+					tex_stats.proxies,
+					tex_stats.evicted),
+				2,
+				view_.size().y - 34,
+				ColRGBA(255, 255, 255, 200),
+				drawing::Font::Bold);
+		}
 	}
 
 	// FPS counter
@@ -1339,10 +1568,18 @@ void Renderer::draw()
 	// Drawing::drawText(fmt::format("Render distance: {:1.2f}", (double)render_max_dist), 0, 100);
 
 	// Editor messages
-	drawEditorMessages();
+	{
+		frameprofiler::ScopedTimer profile_timer(frameprofiler::Section::Text);
+		drawEditorMessages();
+
+		// Help text
+		drawFeatureHelpText();
+	}
 
-	// Help text
-	drawFeatureHelpText();
+	// Frame profiler
+	frameprofiler::endFrame();
+	if (frameprofiler::enabled())
+		drawFrameProfiler();
 }
 
 namespace
@@ -16,6 +16,7 @@ namespace mapeditor
 	{
 	public:
 		Renderer(MapEditContext& context);
+		~Renderer();
 
 		MapRenderer2D& renderer2D() { return renderer_2d_; }
 		MapRenderer3D& renderer3D() { return renderer_3d_; }
@@ -73,11 +74,16 @@ namespace mapeditor
 		float  anim_help_fade_       = 0.f;
 		bool   cursor_zoom_disabled_ = false;
 
+		// Shaders
+		mutable unique_ptr<gl::Shader> shader_grid_;
+
 
 		// Drawing
-		void drawGrid() const;
+		gl::Shader& gridShader() const;
+		void        drawGrid() const;
 		void drawEditorMessages() const;
 		void drawFeatureHelpText() const;
+		void drawFrameProfiler() const;
 		void drawSelectionNumbers() const;
 		void drawThingQuickAngleLines() const;
 		void drawLineLength(Vec2d p1, Vec2d p2, ColRGBA col) const;
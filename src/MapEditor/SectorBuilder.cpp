@@ -48,7 +48,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-typedef std::map<MapLine*, int> MapLineSet;
+typedef std::unordered_map<MapLine*, int> MapLineSet;
 
 // -----------------------------------------------------------------------------
 // Finds the next adjacent edge to [edge], ie the adjacent edge that creates the
@@ -170,6 +170,27 @@ bool SectorBuilder::traceOutline(MapLine* line, bool front)
 	if (!line)
 		return false;
 
+	// Use the previously traced outline from this edge if there is one
+	auto cached = outline_cache_.find({ line, front });
+	if (cached != outline_cache_.end())
+	{
+		const auto& outline = cached->second;
+		o_edges_            = outline.edges;
+		o_clockwise_        = outline.clockwise;
+		o_bbox_             = outline.bbox;
+		vertex_right_       = outline.vertex_right;
+
+		// Discard edge vertices and add outline edges to sector edge list
+		for (auto o_edge : o_edges_)
+		{
+			vertex_valid_[o_edge.line->v1Index()] = false;
+			vertex_valid_[o_edge.line->v2Index()] = false;
+			sector_edges_.push_back(o_edge);
+		}
+
+		return true;
+	}
+
 	// Init outline
 	o_edges_.clear();
 	o_bbox_.reset();
@@ -236,6 +257,9 @@ bool SectorBuilder::traceOutline(MapLine* line, bool front)
 	for (auto o_edge : o_edges_)
 		sector_edges_.push_back(o_edge);
 
+	// Cache the outline in case it needs to be traced again
+	outline_cache_[{ line, front }] = { o_edges_, o_clockwise_, o_bbox_, vertex_right_ };
+
 	// Trace complete
 	return true;
 }
@@ -346,11 +370,9 @@ SectorBuilder::Edge SectorBuilder::findOuterEdge() const
 	// LOG_DEBUG("Finding outer edge from vertex", vertex_right, "at", vertex_right->point());
 
 	// Fire a ray east from the vertex and find the first line it crosses
-	MapLine* line = nullptr;
-	for (unsigned a = 0; a < map_->nLines(); a++)
+	// (only lines overlapping the ray's bbox need checking)
+	for (auto* line : map_->lines().allInBox({ vr_x, vr_y }, { std::max(vr_x, map_right_), vr_y }))
 	{
-		line = map_->line(a);
-
 		// Ignore if the line is completely left of the vertex
 		if (line->x1() <= vr_x && line->x2() <= vr_x)
 			continue;
@@ -523,7 +545,7 @@ MapSector* SectorBuilder::findCopySector()
 // -----------------------------------------------------------------------------
 // Finds any existing sector that is already part of the traced new sector
 // -----------------------------------------------------------------------------
-MapSector* SectorBuilder::findExistingSector(vector<MapSide*>& sides_ignore)
+MapSector* SectorBuilder::findExistingSector(const std::unordered_set<MapSide*>& sides_ignore)
 {
 	// Go through new sector edges
 	MapSector* sector          = nullptr;
@@ -534,7 +556,7 @@ MapSector* SectorBuilder::findExistingSector(vector<MapSide*>& sides_ignore)
 		if (edge.front && edge.line->frontSector())
 		{
 			// return sector_edges[a].line->frontSector();
-			if (VECTOR_EXISTS(sides_ignore, edge.line->s1()))
+			if (sides_ignore.count(edge.line->s1()))
 				sector = edge.line->frontSector();
 			else
 				sector_priority = edge.line->frontSector();
@@ -544,7 +566,7 @@ MapSector* SectorBuilder::findExistingSector(vector<MapSide*>& sides_ignore)
 		if (!edge.front && edge.line->backSector())
 		{
 			// return sector_edges[a].line->backSector();
-			if (VECTOR_EXISTS(sides_ignore, edge.line->s2()))
+			if (sides_ignore.count(edge.line->s2()))
 				sector = edge.line->backSector();
 			else
 				sector_priority = edge.line->backSector();
@@ -607,10 +629,20 @@ bool SectorBuilder::traceSector(SLADEMap* map, MapLine* line, bool front)
 	sector_edges_.clear();
 	error_ = "Unknown error";
 
+	// Discard any cached outlines if they may be out of date
+	if (map != cache_map_ || map->nLines() != cache_lines_ || map->nVertices() != cache_vertices_)
+	{
+		clearCache();
+		cache_map_      = map;
+		cache_lines_    = map->nLines();
+		cache_vertices_ = map->nVertices();
+	}
+
 	// Create valid vertices list
-	vertex_valid_.clear();
+	vertex_valid_.assign(map->nVertices(), true);
+	map_right_ = 0.;
 	for (unsigned a = 0; a < map->nVertices(); a++)
-		vertex_valid_.push_back(true);
+		map_right_ = a == 0 ? map->vertex(a)->xPos() : std::max(map_right_, map->vertex(a)->xPos());
 
 	// Find outmost outline
 	for (unsigned a = 0; a < 10000; a++)
@@ -699,6 +731,18 @@ void SectorBuilder::createSector(MapSector* sector, MapSector* sector_copy)
 		edge.side_created = map_->setLineSector(edge.line->index(), sector->index(), edge.front);
 }
 
+// -----------------------------------------------------------------------------
+// Clears all cached outlines. This must be called if the map geometry has
+// changed since the last trace with this builder
+// -----------------------------------------------------------------------------
+void SectorBuilder::clearCache()
+{
+	outline_cache_.clear();
+	cache_map_      = nullptr;
+	cache_lines_    = 0;
+	cache_vertices_ = 0;
+}
+
 // -----------------------------------------------------------------------------
 // Draws lines showing the currently traced edges
 // -----------------------------------------------------------------------------
@@ -729,3 +773,4 @@ void SectorBuilder::drawResult()
 		glEnd();
 	}
 }
+
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_set>
+
 namespace slade
 {
 // Forward declarations
@@ -37,20 +39,39 @@ public:
 	Edge       findOuterEdge() const;
 	Edge       findInnerEdge();
 	MapSector* findCopySector();
-	MapSector* findExistingSector(vector<MapSide*>& sides_ignore);
+	MapSector* findExistingSector(const std::unordered_set<MapSide*>& sides_ignore);
 	bool       isValidSector();
 
 	bool traceSector(SLADEMap* map, MapLine* line, bool front = true);
 	void createSector(MapSector* sector = nullptr, MapSector* sector_copy = nullptr);
+	void clearCache();
 
 	// Testing
 	void drawResult();
 
 private:
+	// A previously traced outline
+	struct Outline
+	{
+		vector<Edge> edges;
+		bool         clockwise;
+		BBox         bbox;
+		MapVertex*   vertex_right;
+	};
+
 	vector<bool> vertex_valid_;
 	SLADEMap*    map_ = nullptr;
 	vector<Edge> sector_edges_;
 	string       error_;
+	double       map_right_ = 0.; // Rightmost vertex x position
+
+	// Outlines traced so far, by starting edge. These are reused by later
+	// traces with the same builder, so the map geometry must not be changed
+	// between traces unless the cache is cleared
+	std::map<std::pair<MapLine*, bool>, Outline> outline_cache_;
+	SLADEMap*                                    cache_map_      = nullptr;
+	unsigned                                     cache_lines_    = 0;
+	unsigned                                     cache_vertices_ = 0;
 
 	// Current outline
 	vector<Edge> o_edges_;
@@ -351,10 +351,11 @@ void MapTextureBrowser::updateUsage() const
 	auto& items = canvas_->itemList();
 	for (auto& i : items)
 	{
-		auto item = dynamic_cast<MapTexBrowserItem*>(i);
+		auto        item = dynamic_cast<MapTexBrowserItem*>(i);
+		TextureName name{ item->name().ToStdString() };
 		if (type_ == TextureType::Texture)
-			item->setUsage(map_->sides().texUsageCount(item->name().ToStdString()));
+			item->setUsage(map_->sides().texUsageCount(name));
 		else
-			item->setUsage(map_->sectors().texUsageCount(item->name().ToStdString()));
+			item->setUsage(map_->sectors().texUsageCount(name));
 	}
 }
@@ -34,6 +34,8 @@
 #include "App.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Archive/Formats/ZipArchive.h"
+#include "MapEditor/MapBackupManager.h"
+#include "MapEditor/MapEditor.h"
 #include "UI/Canvas/MapPreviewCanvas.h"
 #include "UI/Lists/ListView.h"
 #include "UI/WxUtils.h"
@@ -70,31 +72,44 @@ MapBackupPanel::MapBackupPanel(wxWindow* parent) : wxPanel{ parent, -1 }, archiv
 }
 
 // -----------------------------------------------------------------------------
-// Opens the map backup file for [map_name] in [archive_name] and populates the
-// list
+// Finds all backups for [map_name] in [archive_name] and populates the list.
+// This includes backups in the single backup zip used by older versions
 // -----------------------------------------------------------------------------
 bool MapBackupPanel::loadBackups(wxString archive_name, const wxString& map_name)
 {
-	// Open backup file
-	archive_name.Replace(".", "_");
-	auto backup_file = app::path("backups", app::Dir::User) + "/" + archive_name.ToStdString() + "_backup.zip";
-	if (!archive_backups_->open(backup_file))
-		return false;
+	archive_name_ = archive_name.ToStdString();
+	map_name_     = map_name.ToStdString();
+	backups_.clear();
+
+	// Backups written by the backup manager
+	for (const auto& timestamp : mapeditor::backupManager().backups(archive_name_, map_name_))
+		backups_.push_back({ timestamp, nullptr });
+
+	// Legacy backup zip
+	if (archive_backups_->open(MapBackupManager::legacyBackupFile(archive_name_)))
+	{
+		auto dir = archive_backups_->dirAtPath(map_name_);
+		if (dir && dir != archive_backups_->rootDir().get())
+			for (unsigned a = 0; a < dir->numSubdirs(); a++)
+				backups_.push_back({ dir->subdirAt(a)->name(), dir->subdirAt(a) });
+	}
 
-	// Get backup dir for map
-	dir_current_ = archive_backups_->dirAtPath(map_name.ToStdString());
-	if (dir_current_ == archive_backups_->rootDir().get() || !dir_current_)
+	if (backups_.empty())
 		return false;
 
+	// Timestamps are ISO format, so sort chronologically
+	std::stable_sort(
+		backups_.begin(), backups_.end(), [](const Backup& l, const Backup& r) { return l.timestamp < r.timestamp; });
+
 	// Populate backups list
 	list_backups_->ClearAll();
 	list_backups_->AppendColumn("Backup Date");
 	list_backups_->AppendColumn("Time");
 
 	int index = 0;
-	for (int a = dir_current_->numSubdirs() - 1; a >= 0; a--)
+	for (int a = static_cast<int>(backups_.size()) - 1; a >= 0; a--)
 	{
-		wxString      timestamp = dir_current_->subdirAt(a)->name();
+		wxString      timestamp = backups_[a].timestamp;
 		wxArrayString cols;
 
 		// Date
@@ -125,13 +140,17 @@ void MapBackupPanel::updateMapPreview()
 	// Check for selection
 	if (list_backups_->selectedItems().IsEmpty())
 		return;
-	int selection = (list_backups_->GetItemCount() - 1) - list_backups_->selectedItems()[0];
+	auto& backup = backups_[(list_backups_->GetItemCount() - 1) - list_backups_->selectedItems()[0]];
 
 	// Load map data to temporary wad
 	archive_mapdata_ = std::make_unique<WadArchive>();
-	auto dir         = dir_current_->subdirAt(selection);
-	for (unsigned a = 0; a < dir->numEntries(); a++)
-		archive_mapdata_->addEntry(std::make_shared<ArchiveEntry>(*dir->entryAt(a)), "");
+	if (backup.legacy_dir)
+	{
+		for (unsigned a = 0; a < backup.legacy_dir->numEntries(); a++)
+			archive_mapdata_->addEntry(std::make_shared<ArchiveEntry>(*backup.legacy_dir->entryAt(a)), "");
+	}
+	else if (!mapeditor::backupManager().loadBackup(archive_name_, map_name_, backup.timestamp, *archive_mapdata_))
+		return;
 
 	// Open map preview
 	auto maps = archive_mapdata_->detectMaps();
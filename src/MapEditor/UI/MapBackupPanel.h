@@ -20,10 +20,20 @@ public:
 	void updateMapPreview();
 
 private:
+	// A backup in the list, either from the backup manager or a legacy backup
+	// zip (if [legacy_dir] is set)
+	struct Backup
+	{
+		string      timestamp;
+		ArchiveDir* legacy_dir = nullptr;
+	};
+
 	MapPreviewCanvas*      canvas_map_   = nullptr;
 	ListView*              list_backups_ = nullptr;
 	unique_ptr<ZipArchive> archive_backups_;
 	unique_ptr<Archive>    archive_mapdata_;
-	ArchiveDir*            dir_current_ = nullptr;
+	string                 archive_name_;
+	string                 map_name_;
+	vector<Backup>         backups_;
 };
 } // namespace slade
@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "MapCanvas.h"
 #include "App.h"
+#include "General/Profiler.h"
 #include "MapEditor/Renderer/Overlays/MCOverlay.h"
 #include "MapEditor/SectorBuilder.h"
 #include "OpenGL/Drawing.h"
@@ -50,6 +51,12 @@ using mapeditor::Mode;
 //
 // -----------------------------------------------------------------------------
 CVAR(Int, map_bg_ms, 15, CVar::Flag::Save)
+CVAR(Int, map_max_fps, 0, CVar::Flag::Save) // Maximum frames per second to draw (0 = unlimited)
+CVAR(Bool, map_vsync, false, CVar::Flag::Save) // Takes effect when the map editor is next opened
+namespace
+{
+constexpr long frame_pending_timeout = 250; // Time (ms) after which a redraw that never happened is requested again
+}
 
 
 // -----------------------------------------------------------------------------
@@ -71,7 +78,7 @@ MapCanvas::MapCanvas(wxWindow* parent, int id, MapEditContext* context) :
 	last_time_ = 0;
 
 #ifdef USE_SFML_RENDERWINDOW
-	setVerticalSyncEnabled(false);
+	setVerticalSyncEnabled(map_vsync);
 #endif
 
 	// Bind Events
@@ -108,6 +115,11 @@ MapCanvas::MapCanvas(wxWindow* parent, int id, MapEditContext* context) :
 // -----------------------------------------------------------------------------
 void MapCanvas::draw()
 {
+	PROFILE_ZONE("MapCanvas::draw");
+
+	frame_pending_ = false;
+	frame_last_    = sf_clock_.getElapsedTime().asMilliseconds();
+
 	if (!IsEnabled())
 		return;
 
@@ -118,6 +130,50 @@ void MapCanvas::draw()
 	glFinish();
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the next frame can be drawn now: the previous redraw has
+// happened and the frame rate cap (map_max_fps) allows it
+// -----------------------------------------------------------------------------
+bool MapCanvas::frameDue() const
+{
+	long now = sf_clock_.getElapsedTime().asMilliseconds();
+
+	// Wait for the previous redraw (unless it seems it isn't going to happen,
+	// eg. if the canvas isn't shown)
+	if (frame_pending_ && now - frame_requested_ < frame_pending_timeout)
+		return false;
+
+	return map_max_fps <= 0 || now - frame_last_ >= 1000 / map_max_fps;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the editor state and requests a redraw if anything changed.
+// This only happens when the next frame is due, so hilight updates and other
+// per-frame work are coalesced to once per drawn frame rather than being done
+// for every input event, while input itself is handled as it arrives
+// -----------------------------------------------------------------------------
+void MapCanvas::updateFrame()
+{
+	// Handle 3d mode mouselook
+	mouseLook3d();
+
+	if (!frameDue())
+		return;
+
+	// Get time since last redraw
+	long now       = sf_clock_.getElapsedTime().asMilliseconds();
+	long frametime = now - last_time_;
+
+	if (context_->update(frametime))
+	{
+		hilight_outdated_ = false;
+		last_time_        = now;
+		frame_pending_    = true;
+		frame_requested_  = now;
+		Refresh();
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Moves the mouse cursor to the center of the canvas
 // -----------------------------------------------------------------------------
@@ -364,6 +420,14 @@ void MapCanvas::onMouseDown(wxMouseEvent& e)
 {
 	using namespace mapeditor;
 
+	// Make sure the hilight is up to date with the mouse position, since it
+	// may not have been updated since the last frame
+	if (hilight_outdated_)
+	{
+		context_->updateHilight();
+		hilight_outdated_ = false;
+	}
+
 	// Send to editor context
 	bool skip = true;
 	context_->input().updateKeyModifiersWx(e.GetModifiers());
@@ -435,7 +499,11 @@ void MapCanvas::onMouseMotion(wxMouseEvent& e)
 		return;
 	}
 
+	// Handle 3d mode mouselook now rather than waiting for the next frame
+	mouseLook3d();
+
 	// Update mouse variables
+	hilight_outdated_ = true;
 	if (!context_->input().mouseMove(e.GetX(), e.GetY()))
 		return;
 
@@ -487,17 +555,7 @@ void MapCanvas::onMouseEnter(wxMouseEvent& e)
 // -----------------------------------------------------------------------------
 void MapCanvas::onIdle(wxIdleEvent& e)
 {
-	// Handle 3d mode mouselook
-	mouseLook3d();
-
-	// Get time since last redraw
-	long frametime = (sf_clock_.getElapsedTime().asMilliseconds()) - last_time_;
-
-	if (context_->update(frametime))
-	{
-		last_time_ = (sf_clock_.getElapsedTime().asMilliseconds());
-		Refresh();
-	}
+	updateFrame();
 }
 
 // -----------------------------------------------------------------------------
@@ -505,17 +563,7 @@ void MapCanvas::onIdle(wxIdleEvent& e)
 // -----------------------------------------------------------------------------
 void MapCanvas::onRTimer(wxTimerEvent& e)
 {
-	// Handle 3d mode mouselook
-	mouseLook3d();
-
-	// Get time since last redraw
-	long frametime = (sf_clock_.getElapsedTime().asMilliseconds()) - last_time_;
-
-	if (context_->update(frametime))
-	{
-		last_time_ = (sf_clock_.getElapsedTime().asMilliseconds());
-		Refresh();
-	}
+	updateFrame();
 
 	timer_.Start(map_bg_ms, true);
 }
@@ -29,6 +29,15 @@ private:
 	vector<int>     fps_avg_;
 	sf::Clock       sf_clock_;
 
+	// Frame scheduling
+	bool frame_pending_    = false; // A redraw was requested but hasn't happened yet
+	long frame_requested_  = 0;     // Time the pending redraw was requested
+	long frame_last_       = 0;     // Time the last frame was drawn
+	bool hilight_outdated_ = false; // The mouse moved since the hilight was last updated
+
+	bool frameDue() const;
+	void updateFrame();
+
 	// Events
 	void onSize(wxSizeEvent& e);
 	void onKeyDown(wxKeyEvent& e);
@@ -33,12 +33,17 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapChecksPanel.h"
+#include "General/ThreadPool.h"
+#include "General/UI.h"
 #include "MapEditor/MapChecks.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/WxUtils.h"
 #include "Utility/SFileDialog.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 using namespace slade;
 
@@ -234,11 +239,118 @@ void MapChecksPanel::reset()
 
 	// Clear previous checks
 	active_checks_.clear();
+	active_check_types_.clear();
 
 	refreshList();
 	lb_errors_->Show(true);
 }
 
+// -----------------------------------------------------------------------------
+// Runs all active checks (incrementally, see MapCheck::doCheckIncremental),
+// each on a worker thread where possible. Results are added to the list as
+// each check finishes, and any checks not yet started are skipped if Esc is
+// pressed.
+// The map is read by multiple threads at once while the checks run, so this
+// doesn't return until all running checks are finished (nothing else can
+// modify the map in the meantime)
+// -----------------------------------------------------------------------------
+void MapChecksPanel::runChecks()
+{
+	struct RunState
+	{
+		std::mutex              mutex;
+		std::condition_variable cv;
+		vector<MapCheck*>       finished;
+		std::atomic<bool>       cancelled{ false };
+	};
+	auto state = std::make_shared<RunState>();
+
+	// Make sure nothing in the map will be updated by reading it
+	map_->updateCaches();
+
+	ui::showSplash("Running map checks... (Esc to cancel)", true, mapeditor::windowWx());
+	ui::setSplashProgress(0.0f);
+
+	// Start checks that can run on worker threads
+	vector<MapCheck*> main_thread_checks;
+	for (auto& check : active_checks_)
+	{
+		if (!check->threadSafe())
+		{
+			main_thread_checks.push_back(check.get());
+			continue;
+		}
+
+		threadpool::enqueue([state, check = check.get()] {
+			if (!state->cancelled)
+				check->doCheckIncremental();
+
+			{
+				std::lock_guard lock(state->mutex);
+				state->finished.push_back(check);
+			}
+			state->cv.notify_one();
+		});
+	}
+
+	// Run the remaining checks here, and add results as checks finish
+	unsigned n_finished = 0;
+	while (n_finished < active_checks_.size())
+	{
+		if (!state->cancelled && wxGetKeyState(WXK_ESCAPE))
+		{
+			state->cancelled = true;
+			ui::setSplashMessage("Cancelling map checks...");
+		}
+
+		if (!main_thread_checks.empty())
+		{
+			auto check = main_thread_checks.front();
+			main_thread_checks.erase(main_thread_checks.begin());
+
+			ui::setSplashProgressMessage(check->progressText());
+			if (!state->cancelled)
+				check->doCheckIncremental();
+
+			std::lock_guard lock(state->mutex);
+			state->finished.push_back(check);
+		}
+		else
+		{
+			// Keep the UI responsive while waiting for worker checks to finish
+			// (all windows are disabled while yielding, so the map can't be
+			// modified in the meantime)
+			wxSafeYield(nullptr, true);
+			std::unique_lock lock(state->mutex);
+			state->cv.wait_for(lock, std::chrono::milliseconds(10), [&state] { return !state->finished.empty(); });
+		}
+
+		vector<MapCheck*> finished;
+		{
+			std::lock_guard lock(state->mutex);
+			finished.swap(state->finished);
+		}
+		if (finished.empty())
+			continue;
+
+		for (auto check : finished)
+			for (unsigned b = 0; b < check->nProblems(); b++)
+			{
+				lb_errors_->Append(check->problemDesc(b));
+				check_items_.emplace_back(check, b);
+			}
+
+		n_finished += finished.size();
+		ui::setSplashProgress(static_cast<float>(n_finished) / static_cast<float>(active_checks_.size()));
+		updateStatusText(wxString::Format("%d problems found so far", lb_errors_->GetCount()));
+	}
+
+	ui::hideSplash();
+
+	if (state->cancelled)
+		log::info("Map checks cancelled");
+}
+
 // -----------------------------------------------------------------------------
 // Lays out panel controls vertically
 // (for when the panel is docked vertically)
@@ -311,7 +423,6 @@ void MapChecksPanel::layoutHorizontal()
 void MapChecksPanel::onBtnCheck(wxCommandEvent& e)
 {
 	// Clear interface
-	lb_errors_->Show(false);
 	lb_errors_->Clear();
 	btn_fix1_->Show(false);
 	btn_fix2_->Show(false);
@@ -319,27 +430,32 @@ void MapChecksPanel::onBtnCheck(wxCommandEvent& e)
 	btn_export_->Enable(false);
 	check_items_.clear();
 
-	// Clear previous checks
-	active_checks_.clear();
-
-	// Setup checks
+	// Get selected checks
+	vector<unsigned> selected;
 	for (auto a = 0u; a < std_checks.size(); ++a)
-	{
 		if (clb_active_checks_->IsChecked(a))
-		{
-			active_checks_.emplace_back(
-				MapCheck::standardCheck(static_cast<MapCheck::StandardCheck>(a), map_, &mapeditor::textureManager()));
-		}
+			selected.push_back(a);
+
+	// Setup checks, unless the same checks were run last time (then only
+	// objects modified since need to be checked again)
+	if (selected != active_check_types_)
+	{
+		active_checks_.clear();
+		for (auto type : selected)
+			active_checks_.emplace_back(MapCheck::standardCheck(
+				static_cast<MapCheck::StandardCheck>(type), map_, &mapeditor::textureManager()));
+
+		active_check_types_ = selected;
 	}
 
 	// Run checks
+	runChecks();
+
+	// Re-list results in check order (they were added as each check finished)
+	lb_errors_->Clear();
+	check_items_.clear();
 	for (auto& check : active_checks_)
 	{
-		// Check
-		updateStatusText(check->progressText());
-		check->doCheck();
-
-		// Add results to list
 		for (unsigned b = 0; b < check->nProblems(); b++)
 		{
 			lb_errors_->Append(check->problemDesc(b));
@@ -347,8 +463,6 @@ void MapChecksPanel::onBtnCheck(wxCommandEvent& e)
 		}
 	}
 
-	lb_errors_->Show(true);
-
 	if (lb_errors_->GetCount() > 0)
 	{
 		updateStatusText(wxString::Format("%d problems found", lb_errors_->GetCount()));
@@ -28,6 +28,7 @@ public:
 private:
 	SLADEMap*                    map_ = nullptr;
 	vector<unique_ptr<MapCheck>> active_checks_;
+	vector<unsigned>             active_check_types_;
 
 	wxCheckListBox* clb_active_checks_ = nullptr;
 	wxListBox*      lb_errors_         = nullptr;
@@ -46,6 +47,8 @@ private:
 	};
 	vector<CheckItem> check_items_;
 
+	void runChecks();
+
 	// Events
 	void onBtnCheck(wxCommandEvent& e);
 	void onListBoxItem(wxCommandEvent& e);
@@ -89,6 +89,40 @@ CVAR(Bool, save_archive_with_map, true, CVar::Flag::Save);
 EXTERN_CVAR(Int, flat_drawtype);
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Adds copies of all unsaved (modified or new) entries in [archive] to [wad],
+// so that changes to resources in the map's archive are included when testing
+// the map without saving the archive.
+// Only entries in the global namespace of a wad are copied - map entries are
+// written separately, and entries within markers (or directories) can't be
+// overridden individually by a single lump in another wad
+// -----------------------------------------------------------------------------
+void addUnsavedEntries(WadArchive& wad, Archive& archive, const Archive::MapDesc& map)
+{
+	if (!archive.isModified() || archive.formatId() != "wad")
+		return;
+
+	auto map_entries = map.entries(archive, true);
+	for (unsigned a = 0; a < archive.numEntries(); a++)
+	{
+		auto entry = archive.entryAt(a);
+		if (entry->state() == ArchiveEntry::State::Unmodified || entry->type()->category() == "Maps"
+			|| VECTOR_EXISTS(map_entries, entry) || archive.detectNamespace(entry) != "global")
+			continue;
+
+		wad.addEntry(std::make_shared<ArchiveEntry>(*entry), "");
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapEditorWindow Class Functions
@@ -123,6 +157,9 @@ MapEditorWindow::MapEditorWindow() : STopWindow{ "SLADE", "map" }
 // -----------------------------------------------------------------------------
 MapEditorWindow::~MapEditorWindow()
 {
+	if (node_build_)
+		node_build_.release()->abandon();
+
 	wxAuiManager::GetManager(this)->UnInit();
 }
 
@@ -221,6 +258,8 @@ void MapEditorWindow::setupMenu()
 	//SAction::fromId("mapw_rename")->addToMenu(menu_map);
 	SAction::fromId("mapw_backup")->addToMenu(menu_map);
 	menu_map->AppendSeparator();
+	SAction::fromId("mapw_cancel_nodebuild")->addToMenu(menu_map);
+	menu_map->AppendSeparator();
 	SAction::fromId("mapw_run_map")->addToMenu(menu_map);
 	menu->Append(menu_map, "&Map");
 
@@ -585,6 +624,9 @@ bool MapEditorWindow::openMap(Archive::MapDesc map)
 			return true;
 	}
 
+	// Finish building nodes for the current map before it is closed
+	finishNodeBuild();
+
 	// Show blank map
 	Show(true);
 	map_canvas_->Refresh();
@@ -727,43 +769,36 @@ void MapEditorWindow::loadMapScripts(Archive::MapDesc map)
 }
 
 // -----------------------------------------------------------------------------
-// Builds nodes for the maps in [wad]
+// Returns the node builder to use for the current map, or nullptr if nodes
+// shouldn't (or can't) be built
 // -----------------------------------------------------------------------------
-void MapEditorWindow::buildNodes(Archive* wad)
+const nodebuilders::Builder* MapEditorWindow::nodeBuilder()
 {
-	// Save wad to disk
-	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
-	wad->save(filename);
-
 	// Get current nodebuilder
-	auto     builder = nodebuilders::builder(nodebuilder_id);
-	wxString command = builder.command;
-	wxString options = nodebuilder_options;
+	auto builder = &nodebuilders::builder(nodebuilder_id);
 
 	// Don't build if none selected
-	if (builder.id == "none")
-		return;
+	if (builder->id == "none")
+		return nullptr;
 
 	// Switch to ZDBSP if UDMF
 	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF && nodebuilder_id != "zdbsp")
 	{
 		wxMessageBox("Nodebuilder switched to ZDBSP for UDMF format", "Save Map", wxICON_INFORMATION);
-		builder = nodebuilders::builder("zdbsp");
-		command = builder.command;
+		builder = &nodebuilders::builder("zdbsp");
 	}
 
 	// Check for undefined path
-	if (!wxFileExists(builder.path) && !nb_warned)
+	if (!wxFileExists(builder->path) && !nb_warned)
 	{
 		// Open nodebuilder preferences
 		PreferencesDialog::openPreferences(this, "Node Builders");
 
 		// Get new builder if one was selected
-		builder = nodebuilders::builder(nodebuilder_id);
-		command = builder.command;
+		builder = &nodebuilders::builder(nodebuilder_id);
 
 		// Check again
-		if (!wxFileExists(builder.path))
+		if (!wxFileExists(builder->path))
 		{
 			wxMessageBox(
 				"No valid Node Builder is currently configured, nodes will not be built!", "Warning", wxICON_WARNING);
@@ -771,37 +806,167 @@ void MapEditorWindow::buildNodes(Archive* wad)
 		}
 	}
 
-	// Build command line
-	command.Replace("$f", wxString::Format("\"%s\"", filename));
-	command.Replace("$o", wxString(options));
+	if (!wxFileExists(builder->path))
+	{
+		if (nb_warned)
+			log::info(1, "Nodebuilder path not set up, no nodes were built");
+		return nullptr;
+	}
+
+	return builder;
+}
+
+// -----------------------------------------------------------------------------
+// Builds nodes for the maps in [wad], waiting for the node builder to finish
+// -----------------------------------------------------------------------------
+void MapEditorWindow::buildNodes(Archive* wad)
+{
+	auto builder = nodeBuilder();
+	if (!builder)
+		return;
+
+	// Save wad to disk
+	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
+	wad->save(filename);
+
+	// Run nodebuilder
+	wxArrayString out;
+	auto          command = nodebuilders::commandLine(*builder, filename, nodebuilder_options);
+	log::info("execute \"{}\"", command);
+	wxGetApp().SetTopWindow(this);
+	auto focus = wxWindow::FindFocus();
+	wxExecute(command, out, wxEXEC_HIDE_CONSOLE);
+	wxGetApp().SetTopWindow(maineditor::windowWx());
+	if (focus)
+		focus->SetFocusFromKbd();
+	log::info(1, "Nodebuilder output:");
+	for (const auto& line : out)
+		log::info(line);
+
+	// Re-load wad
+	wad->close();
+	wad->open(filename);
+}
+
+// -----------------------------------------------------------------------------
+// Starts building nodes for the map in [wad] in the background. The built node
+// lumps are merged into the current map's archive once the node builder has
+// finished (see nodeBuildFinished)
+// -----------------------------------------------------------------------------
+void MapEditorWindow::startNodeBuild(Archive& wad)
+{
+	// Results of any build already running would be out of date
+	if (node_build_)
+		node_build_.release()->abandon();
+
+	auto builder = nodeBuilder();
+	if (!builder)
+		return;
+
+	// Save wad to disk
+	auto filename = app::path("sladetemp_nodes.wad", app::Dir::Temp);
+	wad.save(filename);
 
 	// Run nodebuilder
-	if (wxFileExists(builder.path))
+	node_build_ = std::make_unique<nodebuilders::BuildProcess>(
+		*builder, filename, nodebuilder_options, [this](bool success) { nodeBuildFinished(success); });
+	node_build_->setProgressCallback([this]() {
+		SetStatusText(wxString::Format(
+			"Building nodes (%lds)... %s", node_build_->elapsedMs() / 1000, node_build_->lastOutput()));
+	});
+	if (!node_build_->start())
 	{
-		wxArrayString out;
-		log::info(wxString::Format("execute \"%s %s\"", builder.path, command));
-		wxGetApp().SetTopWindow(this);
-		auto focus = wxWindow::FindFocus();
-		wxExecute(wxString::Format("\"%s\" %s", builder.path, command), out, wxEXEC_HIDE_CONSOLE);
-		wxGetApp().SetTopWindow(maineditor::windowWx());
-		if (focus)
-			focus->SetFocusFromKbd();
-		log::info(1, "Nodebuilder output:");
-		for (const auto& line : out)
-			log::info(line);
-
-		// Re-load wad
-		wad->close();
-		wad->open(filename);
+		node_build_.reset();
+		return;
 	}
-	else if (nb_warned)
-		log::info(1, "Nodebuilder path not set up, no nodes were built");
+
+	SetStatusText("Building nodes...");
 }
 
 // -----------------------------------------------------------------------------
-// Writes the current map as [name] to a wad archive and returns it
+// Called when the background node build has finished. If it was successful,
+// the built map (including nodes) replaces the current map's entries in its
+// archive
 // -----------------------------------------------------------------------------
-bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes)
+void MapEditorWindow::nodeBuildFinished(bool success)
+{
+	auto build = std::move(node_build_);
+	if (!success)
+	{
+		SetStatusText("Node build cancelled, map was saved without nodes");
+		return;
+	}
+
+	// Don't bother if the map (or its archive) has been closed
+	auto head = mapeditor::editContext().mapDesc().head.lock();
+	if (!head)
+		return;
+
+	// Load built map
+	WadArchive wad;
+	if (!wad.open(build->filename()))
+	{
+		log::error("Unable to open node builder output \"{}\"", build->filename());
+		SetStatusText("Node build failed");
+		return;
+	}
+
+	// If the archive was saved along with the map, save it again with the nodes
+	auto archive = head->parent();
+	bool save    = archive && !archive->isModified() && archive->canSave();
+
+	// Update map entries
+	PhaseTimer timings;
+	if (!replaceMapEntries(wad, timings, false))
+	{
+		SetStatusText("Node build failed");
+		return;
+	}
+	map_data_.clear();
+	for (unsigned a = 0; a < wad.numEntries(); a++)
+		map_data_.emplace_back(new ArchiveEntry(*(wad.entryAt(a))));
+	if (save)
+		archive->save();
+
+	log::info("Merged nodes into map {} in {:1.0f}ms", mapeditor::editContext().mapDesc().name, timings.totalMs());
+	SetStatusText(wxString::Format("Nodes built in %1.1fs", build->elapsedMs() / 1000.));
+}
+
+// -----------------------------------------------------------------------------
+// If nodes are being built in the background, waits for the build to finish
+// (or be cancelled with Esc), so the nodes are not lost when the map is closed
+// -----------------------------------------------------------------------------
+void MapEditorWindow::finishNodeBuild()
+{
+	if (!node_build_)
+		return;
+
+	ui::showSplash("Building Nodes (Esc to cancel)", true, this);
+	string output;
+	while (node_build_)
+	{
+		ui::setSplashProgress(-1.0f);
+		if (node_build_->lastOutput() != output)
+		{
+			output = node_build_->lastOutput();
+			ui::setSplashProgressMessage(output);
+		}
+		if (node_build_->running() && wxGetKeyState(WXK_ESCAPE))
+			node_build_->cancel();
+
+		// Process events so the end of the process is picked up
+		wxMilliSleep(10);
+		wxSafeYield(nullptr, true);
+	}
+	ui::hideSplash();
+}
+
+// -----------------------------------------------------------------------------
+// Writes the current map as [name] to a wad archive and returns it.
+// If [update_data] is true, the written map is kept as the current map data
+// (for backups), so it should only be false when the map isn't being saved
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes, bool update_data)
 {
 	auto& mdesc_current = mapeditor::editContext().mapDesc();
 	auto& map           = mapeditor::editContext().map();
@@ -811,6 +976,9 @@ bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes
 	if (!map.writeMap(new_map_data))
 		return false;
 
+	auto& timings = map.saveTimings();
+	timings.begin("Add map entries");
+
 	// Check script language
 	bool acs = false;
 	if (game::configuration().scriptLanguage() == "acs_hexen" || game::configuration().scriptLanguage() == "acs_zdoom")
@@ -847,36 +1015,42 @@ bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes
 
 	// Build nodes
 	if (nodes)
+	{
+		timings.begin("Build nodes");
 		buildNodes(&wad);
+	}
+
+	if (!update_data)
+	{
+		timings.end();
+		return true;
+	}
 
 	// Clear current map data
+	timings.begin("Copy map data");
 	map_data_.clear();
 
 	// Update map data
 	for (unsigned a = 0; a < wad.numEntries(); a++)
 		map_data_.emplace_back(new ArchiveEntry(*(wad.entryAt(a))));
+	timings.end();
 
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Saves the current map to its archive, or opens the 'save as' dialog if it
-// doesn't currently belong to one
+// Replaces the current map's entries in its archive with the map in [wad],
+// writing a backup of the current map data first if [backup] is true
 // -----------------------------------------------------------------------------
-bool MapEditorWindow::saveMap()
+bool MapEditorWindow::replaceMapEntries(WadArchive& wad, PhaseTimer& timings, bool backup)
 {
 	auto& mdesc_current = mapeditor::editContext().mapDesc();
-
-	// Check for newly created map
-	auto current_head = mdesc_current.head.lock();
+	auto  current_head  = mdesc_current.head.lock();
 	if (!current_head)
-		return saveMapAs();
-
-	// Write map to temp wad
-	WadArchive wad;
-	if (!writeMap(wad))
 		return false;
 
+	timings.begin("Remove old entries");
+
 	// Check for map archive
 	unique_ptr<Archive> tempwad;
 	auto                map = mdesc_current;
@@ -902,10 +1076,16 @@ bool MapEditorWindow::saveMap()
 		archive->removeEntry(entry);
 
 	// Create backup
-	if (!mapeditor::backupManager().writeBackup(map_data_, m_head->topParent()->filename(false), m_head->nameNoExt()))
-		log::warning(1, "Warning: Failed to backup map data");
+	if (backup)
+	{
+		timings.begin("Write backup");
+		if (!mapeditor::backupManager().writeBackup(
+				map_data_, m_head->topParent()->filename(false), m_head->nameNoExt()))
+			log::warning(1, "Warning: Failed to backup map data");
+	}
 
 	// Add new map entries
+	timings.begin("Update archive");
 	auto entry_end = map.head;
 	for (unsigned a = 1; a < wad.numEntries(); a++)
 	{
@@ -923,8 +1103,41 @@ bool MapEditorWindow::saveMap()
 	// Finish
 	mdesc_current.updateMapFormatHints();
 	lockMapEntries();
+	timings.end();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Saves the current map to its archive, or opens the 'save as' dialog if it
+// doesn't currently belong to one.
+// The map is saved without nodes, which are then built in the background
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::saveMap()
+{
+	auto& mdesc_current = mapeditor::editContext().mapDesc();
+
+	// Check for newly created map
+	auto current_head = mdesc_current.head.lock();
+	if (!current_head)
+		return saveMapAs();
+
+	// Write map to temp wad
+	WadArchive wad;
+	if (!writeMap(wad, "MAP01", false))
+		return false;
+
+	auto& timings = mapeditor::editContext().map().saveTimings();
+	if (!replaceMapEntries(wad, timings, true))
+		return false;
+
 	mapeditor::editContext().map().setOpenedTime();
 
+	log::info("Saved map {} in {:1.0f}ms ({})", mdesc_current.name, timings.totalMs(), timings.summary());
+
+	// Build nodes
+	startNodeBuild(wad);
+
 	return true;
 }
 
@@ -987,8 +1200,12 @@ bool MapEditorWindow::saveMapAs()
 // -----------------------------------------------------------------------------
 // Closes/clears the current map
 // -----------------------------------------------------------------------------
-void MapEditorWindow::closeMap() const
+void MapEditorWindow::closeMap()
 {
+	// Cancel any node build for the map
+	if (node_build_)
+		node_build_.release()->abandon();
+
 	// Close map in editor
 	mapeditor::editContext().clearMap();
 
@@ -1166,6 +1383,14 @@ bool MapEditorWindow::handleAction(string_view id)
 		return true;
 	}
 
+	// Map->Cancel Node Build
+	if (id == "mapw_cancel_nodebuild")
+	{
+		if (node_build_)
+			node_build_->cancel();
+		return true;
+	}
+
 	// Map->Restore Backup
 	if (id == "mapw_backup")
 	{
@@ -1332,10 +1557,16 @@ bool MapEditorWindow::handleAction(string_view id)
 			else if (dlg.start3dModeChecked())
 				edit_context.swapPlayerStart3d();
 
-			// Write temp wad
+			// Write temp wad containing only the map (with nodes) and any
+			// unsaved resources from its archive, so the archive itself
+			// doesn't need to be saved to test the map
 			WadArchive wad;
-			if (writeMap(wad, mdesc_current.name))
+			if (writeMap(wad, mdesc_current.name, true, false))
+			{
+				if (archive)
+					addUnsavedEntries(wad, *archive, mdesc_current);
 				wad.save(app::path("sladetemp_run.wad", app::Dir::Temp));
+			}
 
 			// Reset player 1 start if moved
 			if (dlg.start3dModeChecked() || id == "mapw_run_map_here")
@@ -1363,7 +1594,11 @@ bool MapEditorWindow::handleAction(string_view id)
 	// Tools->Run Script
 	else if (id == "mapw_script")
 	{
-		scriptmanager::runMapScript(&mapeditor::editContext().map(), wx_id_offset_, this);
+		// Record all changes made by the script as a single undo level
+		auto& context = mapeditor::editContext();
+		context.beginUndoRecord("Run Script", true, false, false);
+		scriptmanager::runMapScript(&context.map(), wx_id_offset_, this);
+		context.endUndoRecord(true);
 		return true;
 	}
 
@@ -1409,6 +1644,9 @@ void MapEditorWindow::onClose(wxCloseEvent& e)
 	if (!IsMaximized())
 		misc::setWindowInfo(id_, GetSize().x, GetSize().y, GetPosition().x, GetPosition().y);
 
+	// Don't lose nodes still being built for the saved map
+	finishNodeBuild();
+
 	Show(false);
 	closeMap();
 }
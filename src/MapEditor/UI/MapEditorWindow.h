@@ -6,6 +6,11 @@
 
 namespace slade
 {
+namespace nodebuilders
+{
+	struct Builder;
+	class BuildProcess;
+} // namespace nodebuilders
 class MapObject;
 class MapObjectPropsPanel;
 class ScriptEditorPanel;
@@ -17,6 +22,7 @@ class MapChecksPanel;
 class UndoManagerHistoryPanel;
 class UndoManager;
 class ArchiveEntry;
+class PhaseTimer;
 
 class MapEditorWindow : public STopWindow, public SActionHandler
 {
@@ -33,10 +39,10 @@ public:
 	bool chooseMap(Archive* archive = nullptr);
 	bool openMap(Archive::MapDesc map);
 	void loadMapScripts(Archive::MapDesc map);
-	bool writeMap(WadArchive& wad, const wxString& name = "MAP01", bool nodes = true);
+	bool writeMap(WadArchive& wad, const wxString& name = "MAP01", bool nodes = true, bool update_data = true);
 	bool saveMap();
 	bool saveMapAs();
-	void closeMap() const;
+	void closeMap();
 	void forceRefresh(bool renderer = false) const;
 	void refreshToolBar() const;
 	void setUndoManager(UndoManager* manager) const;
@@ -63,7 +69,14 @@ private:
 	UndoManagerHistoryPanel*         panel_undo_history_ = nullptr;
 	wxMenu*                          menu_scripts_       = nullptr;
 
-	void buildNodes(Archive* wad);
+	unique_ptr<nodebuilders::BuildProcess> node_build_;
+
+	const nodebuilders::Builder* nodeBuilder();
+	void                         buildNodes(Archive* wad);
+	void                         startNodeBuild(Archive& wad);
+	void                         nodeBuildFinished(bool success);
+	void                         finishNodeBuild();
+	bool                         replaceMapEntries(WadArchive& wad, PhaseTimer& timings, bool backup);
 	void lockMapEntries(bool lock = true) const;
 
 	// Events
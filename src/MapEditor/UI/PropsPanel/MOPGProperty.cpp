@@ -70,6 +70,29 @@ void MOPGProperty::resetValue()
 	openObjects(parent_->objects());
 }
 
+// -----------------------------------------------------------------------------
+// Checks whether all [objects] have the same value for this property (read
+// with [get]), setting [value] to it if so. Objects before index [start] are
+// assumed to have already been checked
+// -----------------------------------------------------------------------------
+template<typename T>
+bool MOPGProperty::commonValue(
+	const vector<MapObject*>& objects,
+	unsigned                  start,
+	T (MapObject::*get)(string_view),
+	T& value) const
+{
+	// Only convert the property name once rather than per object
+	const auto name = propname_.ToStdString();
+
+	value = (objects[0]->*get)(name);
+	for (auto a = std::max(start, 1u); a < objects.size(); a++)
+		if ((objects[a]->*get)(name) != value)
+			return false;
+
+	return true;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -90,7 +113,7 @@ MOPGBoolProperty::MOPGBoolProperty(const wxString& label, const wxString& name)
 // Reads the value of this boolean property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGBoolProperty::openObjects(vector<MapObject*>& objects)
+void MOPGBoolProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -99,18 +122,17 @@ void MOPGBoolProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	bool first = objects[0]->boolProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	bool first;
+	if (!commonValue(objects, start, &MapObject::boolProperty, first))
 	{
-		if (objects[a]->boolProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -172,8 +194,12 @@ MOPGIntProperty::MOPGIntProperty(const wxString& label, const wxString& name) :
 // Reads the value of this integer property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGIntProperty::openObjects(vector<MapObject*>& objects)
+void MOPGIntProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
+
 	// Assume unspecified until we see otherwise
 	SetValueToUnspecified();
 
@@ -181,18 +207,13 @@ void MOPGIntProperty::openObjects(vector<MapObject*>& objects)
 	if (objects.empty())
 		return;
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	int first;
+	if (!commonValue(objects, start, &MapObject::intProperty, first))
 	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -254,7 +275,7 @@ MOPGFloatProperty::MOPGFloatProperty(const wxString& label, const wxString& name
 // Reads the value of this float property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGFloatProperty::openObjects(vector<MapObject*>& objects)
+void MOPGFloatProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -263,18 +284,17 @@ void MOPGFloatProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	double first = objects[0]->floatProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	double first;
+	if (!commonValue(objects, start, &MapObject::floatProperty, first))
 	{
-		if (objects[a]->floatProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -358,7 +378,7 @@ void MOPGStringProperty::setUDMFProp(game::UDMFProperty* prop)
 // Reads the value of this string property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGStringProperty::openObjects(vector<MapObject*>& objects)
+void MOPGStringProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -367,23 +387,22 @@ void MOPGStringProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	wxString first = objects[0]->stringProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	string first;
+	if (!commonValue(objects, start, &MapObject::stringProperty, first))
 	{
-		if (objects[a]->stringProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(wxString(first));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -665,7 +684,7 @@ MOPGLineFlagProperty::MOPGLineFlagProperty(const wxString& label, const wxString
 // Reads the value of this line flag property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGLineFlagProperty::openObjects(vector<MapObject*>& objects)
+void MOPGLineFlagProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -674,11 +693,15 @@ void MOPGLineFlagProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
+
 	// Check flag against first object
 	bool first = game::configuration().lineFlagSet(index_, (MapLine*)objects[0]);
 
 	// Check whether all objects share the same flag setting
-	for (unsigned a = 1; a < objects.size(); a++)
+	for (auto a = std::max(start, 1u); a < objects.size(); a++)
 	{
 		if (game::configuration().lineFlagSet(index_, (MapLine*)objects[a]) != first)
 		{
@@ -735,7 +758,7 @@ MOPGThingFlagProperty::MOPGThingFlagProperty(const wxString& label, const wxStri
 // Reads the value of this thing flag property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGThingFlagProperty::openObjects(vector<MapObject*>& objects)
+void MOPGThingFlagProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -744,11 +767,15 @@ void MOPGThingFlagProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
+
 	// Check flag against first object
 	bool first = game::configuration().thingFlagSet(index_, (MapThing*)objects[0]);
 
 	// Check whether all objects share the same flag setting
-	for (unsigned a = 1; a < objects.size(); a++)
+	for (auto a = std::max(start, 1u); a < objects.size(); a++)
 	{
 		if (game::configuration().thingFlagSet(index_, (MapThing*)objects[a]) != first)
 		{
@@ -826,7 +853,7 @@ MOPGAngleProperty::MOPGAngleProperty(const wxString& label, const wxString& name
 // Reads the value of this angle property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGAngleProperty::openObjects(vector<MapObject*>& objects)
+void MOPGAngleProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -835,18 +862,17 @@ void MOPGAngleProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	int first;
+	if (!commonValue(objects, start, &MapObject::intProperty, first))
 	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -929,7 +955,7 @@ MOPGColourProperty::MOPGColourProperty(const wxString& label, const wxString& na
 // Reads the value of this colour property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGColourProperty::openObjects(vector<MapObject*>& objects)
+void MOPGColourProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -938,18 +964,17 @@ void MOPGColourProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	int first;
+	if (!commonValue(objects, start, &MapObject::intProperty, first))
 	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -1016,7 +1041,7 @@ MOPGTextureProperty::MOPGTextureProperty(TextureType textype, const wxString& la
 // Reads the value of this texture property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGTextureProperty::openObjects(vector<MapObject*>& objects)
+void MOPGTextureProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -1025,23 +1050,22 @@ void MOPGTextureProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	wxString first = objects[0]->stringProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	string first;
+	if (!commonValue(objects, start, &MapObject::stringProperty, first))
 	{
-		if (objects[a]->stringProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
 	noupdate_ = true;
-	SetValue(first);
+	SetValue(wxString(first));
 	updateVisibility();
 	noupdate_ = false;
 }
@@ -1097,7 +1121,7 @@ MOPGSPACTriggerProperty::MOPGSPACTriggerProperty(const wxString& label, const wx
 // Reads the value of this SPAC trigger property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGSPACTriggerProperty::openObjects(vector<MapObject*>& objects)
+void MOPGSPACTriggerProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -1106,12 +1130,16 @@ void MOPGSPACTriggerProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
+
 	// Get property of first object
 	auto     map_format = mapeditor::editContext().mapDesc().format;
 	wxString first      = game::configuration().spacTriggerString(dynamic_cast<MapLine*>(objects[0]), map_format);
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	for (auto a = std::max(start, 1u); a < objects.size(); a++)
 	{
 		if (game::configuration().spacTriggerString(dynamic_cast<MapLine*>(objects[a]), map_format) != first)
 		{
@@ -1183,7 +1211,7 @@ MOPGTagProperty::MOPGTagProperty(IdType id_type, const wxString& label, const wx
 // Reads the value of this tag/id property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGTagProperty::openObjects(vector<MapObject*>& objects)
+void MOPGTagProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -1192,18 +1220,17 @@ void MOPGTagProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	int first;
+	if (!commonValue(objects, start, &MapObject::intProperty, first))
 	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -1264,7 +1291,7 @@ MOPGSectorSpecialProperty::MOPGSectorSpecialProperty(const wxString& label, cons
 // Reads the value of this sector special property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGSectorSpecialProperty::openObjects(vector<MapObject*>& objects)
+void MOPGSectorSpecialProperty::openObjects(vector<MapObject*>& objects, unsigned start)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
@@ -1273,18 +1300,17 @@ void MOPGSectorSpecialProperty::openObjects(vector<MapObject*>& objects)
 		return;
 	}
 
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	// Nothing more to check if the objects already read have differing values
+	if (start > 0 && IsValueUnspecified())
+		return;
 
 	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
+	int first;
+	if (!commonValue(objects, start, &MapObject::intProperty, first))
 	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
+		// Different value found, set unspecified
+		SetValueToUnspecified();
+		return;
 	}
 
 	// Set to common value
@@ -40,9 +40,12 @@ public:
 	void         setParent(MapObjectPropsPanel* parent) { parent_ = parent; }
 	virtual void setUDMFProp(game::UDMFProperty* prop) { udmf_prop_ = prop; }
 
-	virtual Type type()                                   = 0;
-	virtual void openObjects(vector<MapObject*>& objects) = 0;
-	virtual void updateVisibility()                       = 0;
+	// openObjects reads the value from [objects]. If [start] is > 0, the objects
+	// before it are the same as those last opened, so only need checking if
+	// they all had the same value
+	virtual Type type()                                                       = 0;
+	virtual void openObjects(vector<MapObject*>& objects, unsigned start = 0) = 0;
+	virtual void updateVisibility()                                           = 0;
 	virtual void applyValue() {}
 	virtual void resetValue();
 
@@ -51,6 +54,13 @@ protected:
 	bool                 noupdate_  = false;
 	game::UDMFProperty*  udmf_prop_ = nullptr;
 	wxString             propname_;
+
+	template<typename T>
+	bool commonValue(
+		const vector<MapObject*>& objects,
+		unsigned                  start,
+		T (MapObject::*get)(string_view),
+		T& value) const;
 };
 
 class MOPGBoolProperty : public MOPGProperty, public wxBoolProperty
@@ -59,7 +69,7 @@ public:
 	MOPGBoolProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Boolean; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 };
@@ -70,7 +80,7 @@ public:
 	MOPGIntProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Integer; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 };
@@ -81,7 +91,7 @@ public:
 	MOPGFloatProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Float; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 };
@@ -94,7 +104,7 @@ public:
 	void setUDMFProp(game::UDMFProperty* prop) override;
 
 	Type type() override { return Type::String; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 };
@@ -157,7 +167,7 @@ public:
 	MOPGLineFlagProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL, int index = -1);
 
 	Type type() override { return Type::LineFlag; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void applyValue() override;
 
 private:
@@ -170,7 +180,7 @@ public:
 	MOPGThingFlagProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL, int index = -1);
 
 	Type type() override { return Type::ThingFlag; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void applyValue() override;
 
 private:
@@ -183,7 +193,7 @@ public:
 	MOPGAngleProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Angle; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 
@@ -197,7 +207,7 @@ public:
 	MOPGColourProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Colour; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 };
@@ -211,7 +221,7 @@ public:
 		const wxString&        name    = wxPG_LABEL);
 
 	Type type() override { return Type::Texture; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 
 	// wxPGProperty overrides
 	bool OnEvent(wxPropertyGrid* propgrid, wxWindow* window, wxEvent& e) override;
@@ -226,7 +236,7 @@ public:
 	MOPGSPACTriggerProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::SPACTrigger; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 	void updateVisibility() override;
 	void applyValue() override;
 };
@@ -244,7 +254,7 @@ public:
 	MOPGTagProperty(IdType id_type, const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Id; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 
 	// wxPGProperty overrides
 	bool OnEvent(wxPropertyGrid* propgrid, wxWindow* window, wxEvent& e) override;
@@ -259,7 +269,7 @@ public:
 	MOPGSectorSpecialProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::SectorSpecial; }
-	void openObjects(vector<MapObject*>& objects) override;
+	void openObjects(vector<MapObject*>& objects, unsigned start) override;
 
 	// wxPGProperty overrides
 	wxString ValueToString(wxVariant& value, int argFlags = 0) const override;
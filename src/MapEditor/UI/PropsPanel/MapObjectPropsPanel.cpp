@@ -32,14 +32,17 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapObjectPropsPanel.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "Graphics/Icons.h"
 #include "MOPGProperty.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/UI/MapEditorWindow.h"
+#include "SLADEMap/SLADEMap.h"
 #include "UI/Controls/SIconButton.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -926,6 +929,36 @@ void MapObjectPropsPanel::openObject(MapObject* object)
 	openObjects(list);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the number of objects at the start of [objects] that are the objects
+// currently open, if [objects] only adds more objects to them (eg. when the
+// selection grows) and nothing has changed since they were opened.
+// Returns 0 if [objects] needs to be read in full
+// -----------------------------------------------------------------------------
+unsigned MapObjectPropsPanel::addedObjectsStart(const vector<MapObject*>& objects) const
+{
+	if (&objects == &objects_ || objects_.empty() || objects.size() <= objects_.size())
+		return 0;
+
+	// Check for any unapplied changes, or if the side properties were reset
+	if (sides_reset_ || pg_properties_->IsAnyModified() || pg_props_side1_->IsAnyModified()
+		|| pg_props_side2_->IsAnyModified())
+		return 0;
+
+	// Check the map wasn't modified since the objects were opened (including
+	// any objects being removed)
+	auto map = objects[0]->parentMap();
+	if (!map || map->mapData().lastModifiedTime() >= opened_time_ || map->geometryUpdated() >= opened_time_
+		|| map->thingsUpdated() >= opened_time_)
+		return 0;
+
+	// Check the open objects are the first of [objects]
+	if (!std::equal(objects_.begin(), objects_.end(), objects.begin()))
+		return 0;
+
+	return objects_.size();
+}
+
 // -----------------------------------------------------------------------------
 // Populates the grid with properties for all MapObjects in [objects]
 // -----------------------------------------------------------------------------
@@ -961,35 +994,32 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 	else
 		setupType(objects[0]->objType());
 
+	// If [objects] only adds to the objects already open, only the added
+	// objects need to be read
+	auto start   = addedObjectsStart(objects);
+	auto n_props = properties_.size();
+
 	// Find any custom properties (UDMF only)
 	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF)
 	{
-		for (auto& object : objects)
+		// Names of properties already on the list (or hidden)
+		std::unordered_set<string> known;
+		for (auto& property : properties_)
+			known.insert(property->propName().ToStdString());
+		for (auto& name : hide_props_)
+			known.insert(name.ToStdString());
+
+		for (auto a = start; a < objects.size(); a++)
 		{
 			// Go through object properties
-			auto objprops = object->props().properties();
-			for (auto& prop : objprops)
+			for (auto& prop : objects[a]->props().properties())
 			{
 				// Ignore side property
-				if (strutil::startsWith(prop.name, "side1.") || strutil::startsWith(prop.name, "side2."))
+				if (strutil::startsWith(prop.name(), "side1.") || strutil::startsWith(prop.name(), "side2."))
 					continue;
 
-				// Check if hidden
-				if (VECTOR_EXISTS(hide_props_, prop.name))
-					continue;
-
-				// Check if property is already on the list
-				bool exists = false;
-				for (auto& property : properties_)
-				{
-					if (property->propName() == prop.name)
-					{
-						exists = true;
-						break;
-					}
-				}
-
-				if (!exists)
+				// Check if property is already on the list (or hidden)
+				if (known.insert(prop.name()).second)
 				{
 					// Create custom group if needed
 					if (!group_custom_)
@@ -998,21 +1028,23 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 					// Add property
 					switch (property::valueType(prop.value))
 					{
-					case property::ValueType::Bool: addBoolProperty(group_custom_, prop.name, prop.name); break;
-					case property::ValueType::Int: addIntProperty(group_custom_, prop.name, prop.name); break;
-					case property::ValueType::Float: addFloatProperty(group_custom_, prop.name, prop.name); break;
-					default: addStringProperty(group_custom_, prop.name, prop.name); break;
+					case property::ValueType::Bool: addBoolProperty(group_custom_, prop.name(), prop.name()); break;
+					case property::ValueType::Int: addIntProperty(group_custom_, prop.name(), prop.name()); break;
+					case property::ValueType::Float: addFloatProperty(group_custom_, prop.name(), prop.name()); break;
+					default: addStringProperty(group_custom_, prop.name(), prop.name()); break;
 					}
 				}
 			}
 		}
 	}
 
-	// Generic properties
-	for (auto& property : properties_)
-		property->openObjects(objects);
+	// Generic properties (any custom properties just added weren't read from
+	// the objects already open)
+	for (unsigned a = 0; a < properties_.size(); a++)
+		properties_[a]->openObjects(objects, a < n_props ? start : 0);
 
 	// Handle line sides
+	sides_reset_ = false;
 	if (objects[0]->objType() == MapObject::Type::Line)
 	{
 		// Enable/disable side properties
@@ -1023,6 +1055,7 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 		{
 			pg_props_side1_->DisableProperty(pg_props_side1_->GetGrid()->GetRoot());
 			pg_props_side1_->SetPropertyValueUnspecified(pg_props_side1_->GetGrid()->GetRoot());
+			sides_reset_ = true;
 		}
 		prop = pg_properties_->GetProperty("sideback");
 		if (prop && (prop->IsValueUnspecified() || prop->GetValue().GetInteger() >= 0))
@@ -1031,6 +1064,7 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 		{
 			pg_props_side2_->DisableProperty(pg_props_side2_->GetGrid()->GetRoot());
 			pg_props_side2_->SetPropertyValueUnspecified(pg_props_side2_->GetGrid()->GetRoot());
+			sides_reset_ = true;
 		}
 	}
 
@@ -1041,6 +1075,7 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 		for (auto object : objects)
 			objects_.push_back(object);
 	}
+	opened_time_ = app::runTimer();
 
 	// Possibly update the argument names and visibility
 	updateArgs(nullptr);
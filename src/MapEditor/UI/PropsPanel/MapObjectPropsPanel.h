@@ -53,12 +53,16 @@ private:
 	wxPGProperty*         group_custom_ = nullptr;
 	bool                  no_apply_     = false;
 	bool                  udmf_         = false;
+	long                  opened_time_  = 0;     // Time objects_ were last opened
+	bool                  sides_reset_  = false; // Side properties were reset when objects_ were opened
 
 	// Hide properties
 	bool             hide_flags_    = false;
 	bool             hide_triggers_ = false;
 	vector<wxString> hide_props_;
 
+	unsigned addedObjectsStart(const vector<MapObject*>& objects) const;
+
 	MOPGProperty* addBoolProperty(
 		wxPGProperty*       group,
 		const wxString&     label,
@@ -298,10 +298,10 @@ void SidePropsPanel::openSides(vector<MapSide*>& sides) const
 	// --- Textures ---
 
 	// Upper
-	wxString tex_upper = sides[0]->texUpper();
+	wxString tex_upper = sides[0]->texUpper().name();
 	for (unsigned a = 1; a < sides.size(); a++)
 	{
-		if (sides[a]->texUpper() != tex_upper)
+		if (sides[a]->texUpper() != sides[0]->texUpper())
 		{
 			tex_upper = "";
 			break;
@@ -311,10 +311,10 @@ void SidePropsPanel::openSides(vector<MapSide*>& sides) const
 	tcb_upper_->SetValue(tex_upper);
 
 	// Middle
-	wxString tex_middle = sides[0]->texMiddle();
+	wxString tex_middle = sides[0]->texMiddle().name();
 	for (unsigned a = 1; a < sides.size(); a++)
 	{
-		if (sides[a]->texMiddle() != tex_middle)
+		if (sides[a]->texMiddle() != sides[0]->texMiddle())
 		{
 			tex_middle = "";
 			break;
@@ -324,10 +324,10 @@ void SidePropsPanel::openSides(vector<MapSide*>& sides) const
 	tcb_middle_->SetValue(tex_middle);
 
 	// Lower
-	wxString tex_lower = sides[0]->texLower();
+	wxString tex_lower = sides[0]->texLower().name();
 	for (unsigned a = 1; a < sides.size(); a++)
 	{
-		if (sides[a]->texLower() != tex_lower)
+		if (sides[a]->texLower() != sides[0]->texLower())
 		{
 			tex_lower = "";
 			break;
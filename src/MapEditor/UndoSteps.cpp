@@ -6,6 +6,18 @@
 using namespace slade;
 using namespace mapeditor;
 
+namespace
+{
+// Returns the (approximate) memory used by [value]
+size_t propertySize(const Property& value)
+{
+	if (auto str = std::get_if<string>(&value))
+		return sizeof(Property) + str->capacity();
+
+	return sizeof(Property);
+}
+} // namespace
+
 PropertyChangeUS::PropertyChangeUS(MapObject* object) : backup_{ new MapObject::Backup() }
 {
 	object->backupTo(backup_.get());
@@ -37,6 +49,12 @@ bool PropertyChangeUS::doRedo()
 	return true;
 }
 
+size_t PropertyChangeUS::memoryUsage() const
+{
+	return sizeof(*this) + sizeof(MapObject::Backup) + backup_->properties.memoryUsage()
+		   + backup_->props_internal.memoryUsage();
+}
+
 
 MapObjectCreateDeleteUS::MapObjectCreateDeleteUS()
 {
@@ -210,6 +228,13 @@ void MapObjectCreateDeleteUS::checkChanges()
 	}
 }
 
+size_t MapObjectCreateDeleteUS::memoryUsage() const
+{
+	return sizeof(*this)
+		   + (vertices_.capacity() + lines_.capacity() + sides_.capacity() + sectors_.capacity() + things_.capacity())
+				 * sizeof(unsigned);
+}
+
 bool MapObjectCreateDeleteUS::isOk()
 {
 	// Check for any changes at all
@@ -226,36 +251,76 @@ MultiMapObjectPropertyChangeUS::MultiMapObjectPropertyChangeUS()
 	auto objects = undoredo::currentMap()->mapData().allModifiedObjects(MapObject::propBackupTime());
 	for (auto& object : objects)
 	{
-		auto bak = object->backup(true);
-		if (bak)
-		{
-			backups_.emplace_back(bak);
-			// log::info(1, "%s #%d modified", objects[a]->getTypeName(), objects[a]->getIndex());
-		}
+		unique_ptr<MapObject::Backup> bak{ object->backup(true) };
+		if (!bak)
+			continue;
+
+		// Compare with the current properties, keeping only the previous
+		// values of properties that were changed
+		MapObject::Backup current;
+		object->backupTo(&current);
+		ObjectDelta delta{ bak->id, {} };
+
+		auto diff = [&delta](const PropertyList& old_props, const PropertyList& new_props, bool internal) {
+			// Changed or removed properties
+			for (const auto& prop : old_props.properties())
+			{
+				auto new_value = new_props.getIf(prop.key);
+				if (!new_value || *new_value != prop.value)
+					delta.changes.push_back({ prop.key, internal, prop.value });
+			}
+
+			// Added properties
+			for (const auto& prop : new_props.properties())
+				if (!old_props.contains(prop.key))
+					delta.changes.push_back({ prop.key, internal, std::nullopt });
+		};
+		diff(bak->properties, current.properties, false);
+		diff(bak->props_internal, current.props_internal, true);
+
+		// Ignore if nothing was actually changed
+		if (delta.changes.empty())
+			continue;
+
+		delta.changes.shrink_to_fit();
+		deltas_.push_back(std::move(delta));
 	}
+	deltas_.shrink_to_fit();
 
 	if (log::verbosity() >= 2)
 	{
 		string msg = "Modified ids: ";
-		for (auto& backup : backups_)
-			msg += fmt::format("{}, ", backup->id);
+		for (auto& delta : deltas_)
+			msg += fmt::format("{}, ", delta.id);
 		log::info(msg);
 	}
 }
 
 void MultiMapObjectPropertyChangeUS::doSwap(MapObject* obj, unsigned index)
 {
-	auto temp = std::make_unique<MapObject::Backup>();
-	obj->backupTo(temp.get());
-	obj->loadFromBackup(backups_[index].get());
-	backups_[index].swap(temp);
+	// Apply changed properties to the object's current properties, keeping
+	// the current values to swap back in
+	MapObject::Backup current;
+	obj->backupTo(&current);
+	for (auto& change : deltas_[index].changes)
+	{
+		auto& props     = change.internal ? current.props_internal : current.properties;
+		auto  old_value = props.getIf(change.key);
+		if (change.value)
+			props[change.key] = *change.value;
+		else
+			props.remove(change.key);
+		change.value = std::move(old_value);
+	}
+
+	obj->loadFromBackup(&current);
 }
 
 bool MultiMapObjectPropertyChangeUS::doUndo()
 {
-	for (unsigned a = 0; a < backups_.size(); a++)
+	for (unsigned a = 0; a < deltas_.size(); a++)
 	{
-		auto obj = undoredo::currentMap()->mapData().getObjectById(backups_[a]->id);
+		auto obj = undoredo::currentMap()->mapData().getObjectById(deltas_[a].id);
 		if (obj)
 			doSwap(obj, a);
 	}
@@ -265,13 +330,26 @@ bool MultiMapObjectPropertyChangeUS::doUndo()
 
 bool MultiMapObjectPropertyChangeUS::doRedo()
 {
-	// log::info(2, "Restore %lu objects", backups.size());
-	for (unsigned a = 0; a < backups_.size(); a++)
+	for (unsigned a = 0; a < deltas_.size(); a++)
 	{
-		auto obj = undoredo::currentMap()->mapData().getObjectById(backups_[a]->id);
+		auto obj = undoredo::currentMap()->mapData().getObjectById(deltas_[a].id);
 		if (obj)
 			doSwap(obj, a);
 	}
 
 	return true;
 }
+
+size_t MultiMapObjectPropertyChangeUS::memoryUsage() const
+{
+	auto size = sizeof(*this) + deltas_.capacity() * sizeof(ObjectDelta);
+	for (const auto& delta : deltas_)
+	{
+		size += delta.changes.capacity() * sizeof(PropertyChange);
+		for (const auto& change : delta.changes)
+			if (change.value)
+				size += propertySize(*change.value) - sizeof(Property);
+	}
+
+	return size;
+}
@@ -12,9 +12,10 @@ public:
 	PropertyChangeUS(MapObject* object);
 	~PropertyChangeUS() = default;
 
-	void doSwap(MapObject* obj);
-	bool doUndo() override;
-	bool doRedo() override;
+	void   doSwap(MapObject* obj);
+	bool   doUndo() override;
+	bool   doRedo() override;
+	size_t memoryUsage() const override;
 
 private:
 	unique_ptr<MapObject::Backup> backup_;
@@ -27,12 +28,13 @@ public:
 	MapObjectCreateDeleteUS();
 	~MapObjectCreateDeleteUS() = default;
 
-	bool isValid(vector<unsigned>& list) const { return !(list.size() == 1 && list[0] == 0); }
-	void swapLists();
-	bool doUndo() override;
-	bool doRedo() override;
-	void checkChanges();
-	bool isOk() override;
+	bool   isValid(vector<unsigned>& list) const { return !(list.size() == 1 && list[0] == 0); }
+	void   swapLists();
+	bool   doUndo() override;
+	bool   doRedo() override;
+	void   checkChanges();
+	bool   isOk() override;
+	size_t memoryUsage() const override;
 
 private:
 	vector<unsigned> vertices_;
@@ -42,19 +44,39 @@ private:
 	vector<unsigned> things_;
 };
 
-// UndoStep for when multiple MapObjects have properties changed
+// UndoStep for when multiple MapObjects have properties changed.
+// Only the properties that were actually changed are kept for each object
+// (rather than a full backup), since often only one or two properties are
+// changed on a large number of objects
 class MultiMapObjectPropertyChangeUS : public UndoStep
 {
 public:
 	MultiMapObjectPropertyChangeUS();
 	~MultiMapObjectPropertyChangeUS() = default;
 
-	void doSwap(MapObject* obj, unsigned index);
-	bool doUndo() override;
-	bool doRedo() override;
-	bool isOk() override { return !backups_.empty(); }
+	void   doSwap(MapObject* obj, unsigned index);
+	bool   doUndo() override;
+	bool   doRedo() override;
+	bool   isOk() override { return !deltas_.empty(); }
+	size_t memoryUsage() const override;
 
 private:
-	vector<unique_ptr<MapObject::Backup>> backups_;
+	// A single changed property, and its value to swap in on undo/redo
+	// (no value if the property should be removed)
+	struct PropertyChange
+	{
+		PropertyKey             key;
+		bool                    internal;
+		std::optional<Property> value;
+	};
+
+	// All changed properties of an object
+	struct ObjectDelta
+	{
+		unsigned               id;
+		vector<PropertyChange> changes;
+	};
+
+	vector<ObjectDelta> deltas_;
 };
 } // namespace slade::mapeditor
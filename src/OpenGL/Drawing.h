@@ -96,6 +96,8 @@ namespace drawing
 	void  enableTextStateReset(bool enable = true);
 	void  setTextState(bool set = true);
 	void  setTextOutline(double thickness, const ColRGBA& colour = ColRGBA::BLACK);
+	void  beginTextBatch();
+	void  endTextBatch();
 
 	// Specific
 	void drawHud();
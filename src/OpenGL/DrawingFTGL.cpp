@@ -340,4 +340,10 @@ void drawing::setTextState(bool set) {}
 // -----------------------------------------------------------------------------
 void drawing::enableTextStateReset(bool enable) {}
 
+// -----------------------------------------------------------------------------
+// Begins/ends a text batch (SFML only, FTGL text is always drawn immediately)
+// -----------------------------------------------------------------------------
+void drawing::beginTextBatch() {}
+void drawing::endTextBatch() {}
+
 #endif
@@ -35,6 +35,7 @@
 #include "Archive/ArchiveEntry.h"
 #include "Archive/ArchiveManager.h"
 #include "Drawing.h"
+#include "GLTexture.h"
 #include "MapEditor/UI/MapCanvas.h"
 #include "Utility/MathStuff.h"
 
@@ -58,6 +59,33 @@ FontPtr font_mono;
 
 sf::RenderWindow* render_target    = nullptr;
 bool              text_state_reset = true;
+
+// Laid out text, as quads for each glyph relative to the text position (and
+// texture coordinates within the font's glyph atlas texture for the size)
+struct TextLayout
+{
+	struct Quad
+	{
+		float x1, y1, x2, y2;
+		float u1, v1, u2, v2; // In pixels
+	};
+	vector<Quad>  outline;
+	vector<Quad>  fill;
+	sf::FloatRect bounds;
+	unsigned      last_used = 0;
+};
+std::unordered_map<string, TextLayout> text_layouts;
+constexpr unsigned                     text_layouts_max = 8192; // Max cached layouts before old ones are removed
+
+// Text batching
+struct TextVertex
+{
+	float   x, y;
+	float   u, v;
+	uint8_t r, g, b, a;
+};
+bool                                             text_batch_active = false;
+std::map<const sf::Texture*, vector<TextVertex>> text_batch;
 } // namespace slade::drawing
 
 
@@ -114,6 +142,191 @@ sf::Font* getFont(Font font)
 	default: return font_normal.get();
 	};
 }
+
+// -----------------------------------------------------------------------------
+// Returns the character size to use for [font]
+// -----------------------------------------------------------------------------
+unsigned characterSize(Font font)
+{
+	if (font == Font::Small)
+		return (ui::scalePx(gl_font_size) * 0.6) + 1;
+
+	return ui::scalePx(gl_font_size);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a quad for [glyph] at [x,y] to [quads]
+// -----------------------------------------------------------------------------
+void addGlyphQuad(vector<TextLayout::Quad>& quads, float x, float y, const sf::Glyph& glyph)
+{
+	constexpr float padding = 1.f;
+
+	float left   = glyph.bounds.left - padding;
+	float top    = glyph.bounds.top - padding;
+	float right  = glyph.bounds.left + glyph.bounds.width + padding;
+	float bottom = glyph.bounds.top + glyph.bounds.height + padding;
+
+	float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+	float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+	float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+	float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+	quads.push_back({ x + left, y + top, x + right, y + bottom, u1, v1, u2, v2 });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the layout of [text] drawn with [font] (and an outline of
+// [outline] thickness). Layouts are cached, so text drawn every frame only
+// needs to be laid out once
+// -----------------------------------------------------------------------------
+const TextLayout& layoutText(const string& text, Font font, float outline)
+{
+	auto size = characterSize(font);
+	auto key  = fmt::format("{}:{}:{}:{}", static_cast<int>(font), size, outline, text);
+
+	// Check for cached layout
+	auto frame = gl::Texture::currentFrame();
+	if (auto i = text_layouts.find(key); i != text_layouts.end())
+	{
+		i->second.last_used = frame;
+		return i->second;
+	}
+
+	// Remove layouts not used recently if there are too many cached
+	if (text_layouts.size() >= text_layouts_max)
+	{
+		for (auto i = text_layouts.begin(); i != text_layouts.end();)
+		{
+			if (frame - i->second.last_used > 60)
+				i = text_layouts.erase(i);
+			else
+				++i;
+		}
+		if (text_layouts.size() >= text_layouts_max)
+			text_layouts.clear();
+	}
+
+	auto& layout     = text_layouts[key];
+	layout.last_used = frame;
+
+	// Lay out glyphs (the same way sf::Text does)
+	auto       f                = getFont(font);
+	sf::String str              = text;
+	float      whitespace_width = f->getGlyph(L' ', size, false).advance;
+	float      line_spacing     = f->getLineSpacing(size);
+	float      x                = 0.f;
+	auto       y                = static_cast<float>(size);
+	float      min_x            = size;
+	float      min_y            = size;
+	float      max_x            = 0.f;
+	float      max_y            = 0.f;
+	sf::Uint32 prev_char        = 0;
+	for (auto cur_char : str)
+	{
+		x += f->getKerning(prev_char, cur_char, size);
+		prev_char = cur_char;
+
+		// Whitespace
+		if (cur_char == L' ' || cur_char == L'\n' || cur_char == L'\t')
+		{
+			min_x = std::min(min_x, x);
+			min_y = std::min(min_y, y);
+
+			if (cur_char == L' ')
+				x += whitespace_width;
+			else if (cur_char == L'\t')
+				x += whitespace_width * 4;
+			else
+			{
+				y += line_spacing;
+				x = 0;
+			}
+
+			max_x = std::max(max_x, x);
+			max_y = std::max(max_y, y);
+			continue;
+		}
+
+		// Glyph
+		if (outline > 0)
+			addGlyphQuad(layout.outline, x, y, f->getGlyph(cur_char, size, false, outline));
+		auto& glyph = f->getGlyph(cur_char, size, false);
+		addGlyphQuad(layout.fill, x, y, glyph);
+
+		min_x = std::min(min_x, x + glyph.bounds.left);
+		max_x = std::max(max_x, x + glyph.bounds.left + glyph.bounds.width);
+		min_y = std::min(min_y, y + glyph.bounds.top);
+		max_y = std::max(max_y, y + glyph.bounds.top + glyph.bounds.height);
+
+		x += glyph.advance;
+	}
+	if (!str.isEmpty())
+		layout.bounds = { min_x, min_y, max_x - min_x, max_y - min_y };
+
+	return layout;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [quads] at [x,y] to the text batch for [texture]
+// -----------------------------------------------------------------------------
+void addTextQuads(
+	const sf::Texture*              texture,
+	const vector<TextLayout::Quad>& quads,
+	float                           x,
+	float                           y,
+	const ColRGBA&                  colour)
+{
+	auto& verts = text_batch[texture];
+	for (const auto& quad : quads)
+	{
+		verts.push_back({ x + quad.x1, y + quad.y1, quad.u1, quad.v1, colour.r, colour.g, colour.b, colour.a });
+		verts.push_back({ x + quad.x2, y + quad.y1, quad.u2, quad.v1, colour.r, colour.g, colour.b, colour.a });
+		verts.push_back({ x + quad.x2, y + quad.y2, quad.u2, quad.v2, colour.r, colour.g, colour.b, colour.a });
+		verts.push_back({ x + quad.x1, y + quad.y2, quad.u1, quad.v2, colour.r, colour.g, colour.b, colour.a });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Draws all text in the text batch, with a single draw call per glyph atlas
+// texture. The OpenGL state must already be set for text (see setTextState)
+// -----------------------------------------------------------------------------
+void flushTextBatch()
+{
+	if (!render_target)
+	{
+		text_batch.clear();
+		return;
+	}
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	for (auto& [texture, verts] : text_batch)
+	{
+		if (verts.empty())
+			continue;
+
+		// Texture coordinates are in pixels, since the atlas texture may have
+		// grown since the text was laid out
+		sf::Texture::bind(texture, sf::Texture::Pixels);
+		glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), &verts[0].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), &verts[0].u);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), &verts[0].r);
+		glDrawArrays(GL_QUADS, 0, verts.size());
+		verts.clear();
+	}
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	// The glyph textures were bound outside of gl::Texture
+	gl::Texture::bind(0);
+}
 } // namespace slade::drawing
 
 // -----------------------------------------------------------------------------
@@ -143,60 +356,56 @@ void drawing::cleanupFonts()
 	font_bold.reset(nullptr);
 	font_boldcondensed.reset(nullptr);
 	font_mono.reset(nullptr);
+	text_layouts.clear();
+	text_batch.clear();
 }
 
 // -----------------------------------------------------------------------------
 // Draws [text] at [x,y]. If [bounds] is not null, the bounding coordinates of
 // the rendered text string are written to it.
+// If a text batch is active (see beginTextBatch), the text is added to the
+// batch and drawn when the batch ends
 // -----------------------------------------------------------------------------
 void drawing::drawText(const string& text, int x, int y, ColRGBA colour, Font font, Align alignment, Rectd* bounds)
 {
-	// Setup SFML string
-	sf::Text sf_str;
-	sf_str.setString(text);
-	sf_str.setFillColor(sf::Color(colour.r, colour.g, colour.b, colour.a));
-
-	// Set font
-	auto f = getFont(font);
-	sf_str.setFont(*f);
-	if (font == Font::Small)
-		sf_str.setCharacterSize((ui::scalePx(gl_font_size) * 0.6) + 1);
-	else
-		sf_str.setCharacterSize(ui::scalePx(gl_font_size));
+	// Get text layout
+	float outline = render_target ? text_outline_width : 0.;
+	auto& layout  = layoutText(text, font, outline);
 
 	// Setup alignment
 	if (alignment != Align::Left)
 	{
-		float width = sf_str.getLocalBounds().width;
+		float width = layout.bounds.width;
 
 		if (alignment == Align::Center)
 			x -= math::round(width * 0.5);
 		else
 			x -= width;
 	}
-	sf_str.setPosition(x, y);
 
 	// Set bounds rect
 	if (bounds)
-	{
-		auto rect = sf_str.getGlobalBounds();
-		bounds->set(rect.left, rect.top, rect.left + rect.width, rect.top + rect.height);
-	}
-
-	// Draw the string
-	if (render_target)
+		bounds->set(
+			x + layout.bounds.left,
+			y + layout.bounds.top,
+			x + layout.bounds.left + layout.bounds.width,
+			y + layout.bounds.top + layout.bounds.height);
+
+	// Add the string to the batch
+	if (!render_target)
+		return;
+	auto& texture = getFont(font)->getTexture(characterSize(font));
+	if (!layout.outline.empty())
+		addTextQuads(&texture, layout.outline, x, y, outline_colour);
+	addTextQuads(&texture, layout.fill, x, y, colour);
+
+	// Draw now if not batching
+	if (!text_batch_active)
 	{
 		if (text_state_reset)
 			setTextState(true);
 
-		if (text_outline_width > 0)
-		{
-			sf_str.setOutlineThickness(text_outline_width);
-			sf_str.setOutlineColor(sf::Color(outline_colour.r, outline_colour.g, outline_colour.b, outline_colour.a));
-		}
-
-		// Draw
-		render_target->draw(sf_str);
+		flushTextBatch();
 
 		if (text_state_reset)
 			setTextState(false);
@@ -208,21 +417,33 @@ void drawing::drawText(const string& text, int x, int y, ColRGBA colour, Font fo
 // -----------------------------------------------------------------------------
 Vec2d drawing::textExtents(const string& text, Font font)
 {
-	// Setup SFML string
-	sf::Text sf_str;
-	sf_str.setString(text);
+	auto& layout = layoutText(text, font, 0.f);
+	return { layout.bounds.width, layout.bounds.height };
+}
 
-	// Set font
-	auto f = getFont(font);
-	sf_str.setFont(*f);
-	if (font == Font::Small)
-		sf_str.setCharacterSize((ui::scalePx(gl_font_size) * 0.6) + 1);
-	else
-		sf_str.setCharacterSize(ui::scalePx(gl_font_size));
+// -----------------------------------------------------------------------------
+// Begins a text batch: text drawn with drawText is collected and drawn all at
+// once when endTextBatch is called
+// -----------------------------------------------------------------------------
+void drawing::beginTextBatch()
+{
+	text_batch_active = true;
+}
+
+// -----------------------------------------------------------------------------
+// Ends the current text batch, drawing all text added since beginTextBatch
+// -----------------------------------------------------------------------------
+void drawing::endTextBatch()
+{
+	text_batch_active = false;
+
+	if (text_state_reset)
+		setTextState(true);
+
+	flushTextBatch();
 
-	// Return width and height of text
-	auto rect = sf_str.getGlobalBounds();
-	return { rect.width, rect.height };
+	if (text_state_reset)
+		setTextState(false);
 }
 
 // -----------------------------------------------------------------------------
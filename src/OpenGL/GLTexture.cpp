@@ -33,6 +33,7 @@
 #include "GLTexture.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL.h"
+#include <deque>
 
 using namespace slade;
 
@@ -44,12 +45,92 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(String, bgtx_colour1, "#404050", CVar::Flag::Save)
 CVAR(String, bgtx_colour2, "#505060", CVar::Flag::Save)
+CVAR(Bool, gl_tex_upload_pbo, true, CVar::Flag::Save)
+CVAR(Int, gl_tex_upload_budget, 8192, CVar::Flag::Save) // KB of texture data to upload per frame (see processUploads)
 namespace
 {
+// Texture data waiting to be uploaded by processUploads
+struct PendingUpload
+{
+	unsigned id = 0;
+	MemChunk data;
+	unsigned width  = 0;
+	unsigned height = 0;
+};
+
 std::map<unsigned, gl::Texture> textures;
 gl::Texture                     tex_missing;
 gl::Texture                     tex_background;
 unsigned                        last_bound_tex = 0;
+unsigned                        current_frame  = 1;
+unsigned                        n_binds        = 0;
+std::deque<PendingUpload>       pending_uploads;
+unsigned                        upload_pbo = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if textures with [filter] have mipmaps
+// -----------------------------------------------------------------------------
+bool isMipmapped(gl::TexFilter filter)
+{
+	return filter == gl::TexFilter::Mipmap || filter == gl::TexFilter::LinearMipmap
+		   || filter == gl::TexFilter::NearestMipmap;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the wrap and filter parameters of the currently bound texture from
+// [tex_info]
+// -----------------------------------------------------------------------------
+void setTexParams(const gl::Texture& tex_info)
+{
+	using gl::TexFilter;
+
+	if (tex_info.tiling)
+	{
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	}
+	else
+	{
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	}
+
+	if (tex_info.filter == TexFilter::Linear)
+	{
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+	else if (tex_info.filter == TexFilter::Mipmap || tex_info.filter == TexFilter::LinearMipmap)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	}
+	else if (tex_info.filter == TexFilter::NearestMipmap)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	}
+	else if (tex_info.filter == TexFilter::NearestLinearMin)
+	{
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+	else
+	{
+		// Default to NEAREST
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	}
+}
 } // namespace
 
 
@@ -224,51 +305,16 @@ bool gl::Texture::loadData(unsigned id, const uint8_t* data, unsigned width, uns
 
 	// Set texture params
 	auto& tex_info = textures[id];
-	if (tex_info.tiling)
-	{
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	}
-	else
-	{
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-	}
+	setTexParams(tex_info);
 
 	// Generate the texture
-	if (tex_info.filter == TexFilter::Linear)
-	{
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	}
-	else if (tex_info.filter == TexFilter::Mipmap || tex_info.filter == TexFilter::LinearMipmap)
-	{
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	if (isMipmapped(tex_info.filter))
 		gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	}
-	else if (tex_info.filter == TexFilter::NearestMipmap)
-	{
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	}
-	else if (tex_info.filter == TexFilter::NearestLinearMin)
-	{
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	}
 	else
-	{
-		// Default to NEAREST
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	}
 
-	tex_info.size = { (int)width, (int)height };
+	tex_info.size      = { (int)width, (int)height };
+	tex_info.reduction = 1;
 
 	return true;
 }
@@ -293,6 +339,157 @@ bool gl::Texture::loadImage(unsigned id, const SImage& image, Palette* pal)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Queues RGBA [data] of [width]x[height] to be uploaded to the OpenGL texture
+// [id] by processUploads, via a pixel buffer object so rendering isn't blocked
+// by the transfer. The texture (and its info) is unchanged until then, so will
+// continue to show any previous image (see isUploadPending).
+// If pixel buffer objects aren't supported or are disabled (gl_tex_upload_pbo)
+// the data is loaded immediately as with loadData
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadDataAsync(unsigned id, const MemChunk& data, unsigned width, unsigned height)
+{
+	// Check OpenGL is initialised
+	if (!gl::isInitialised())
+		return false;
+
+	// Check given id
+	auto tex = textures.find(id);
+	if (id == 0 || id == tex_missing.id || id == tex_background.id || tex == textures.end() || tex->second.id != id)
+	{
+		log::warning("Unable to load OpenGL texture with id {} - invalid or built-in texture", id);
+		return false;
+	}
+
+	// Check image dimensions and data
+	if (!validTexDimension(width) || !validTexDimension(height))
+	{
+		log::warning("Attempt to create OpenGL texture of invalid size {}x{}", width, height);
+		return false;
+	}
+	if (data.size() < width * height * 4)
+		return false;
+
+	// Load immediately if pixel buffers can't be used (mipmaps are generated by
+	// the driver when uploading from a pixel buffer, which requires GL 1.4)
+	if (!gl_tex_upload_pbo || !GLEW_ARB_pixel_buffer_object || (isMipmapped(tex->second.filter) && !GLEW_VERSION_1_4))
+		return loadData(id, data.data(), width, height);
+
+	// Replace any upload already pending for the texture
+	for (auto& upload : pending_uploads)
+		if (upload.id == id)
+		{
+			upload.data.importMem(data);
+			upload.width  = width;
+			upload.height = height;
+			return true;
+		}
+
+	pending_uploads.emplace_back();
+	auto& upload = pending_uploads.back();
+	upload.id    = id;
+	upload.data.importMem(data);
+	upload.width  = width;
+	upload.height = height;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [image] to be uploaded to the OpenGL texture [id] by processUploads,
+// using [pal] if necessary. See loadDataAsync
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadImageAsync(unsigned id, const SImage& image, Palette* pal)
+{
+	// Check image dimensions
+	if (validTexDimension(image.width()) && validTexDimension(image.height()))
+	{
+		// Get RGBA image data
+		MemChunk rgba;
+		image.putRGBAData(rgba, pal);
+
+		// Queue it
+		return loadDataAsync(id, rgba, image.width(), image.height());
+	}
+
+	log::warning("Attempt to create OpenGL texture of invalid size {}x{}", image.width(), image.height());
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the OpenGL texture [id] has data waiting to be uploaded by
+// processUploads
+// -----------------------------------------------------------------------------
+bool gl::Texture::isUploadPending(unsigned id)
+{
+	if (id == 0)
+		return false;
+
+	for (const auto& upload : pending_uploads)
+		if (upload.id == id)
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Uploads texture data queued by loadDataAsync, in order, until the upload
+// budget for this frame (gl_tex_upload_budget) is used up. The data is copied
+// to a pixel buffer object that the texture is then filled from, so the
+// transfer to the GPU happens asynchronously.
+// Must be called on the GL thread, once per frame
+// -----------------------------------------------------------------------------
+void gl::Texture::processUploads()
+{
+	if (pending_uploads.empty() || !gl::isInitialised())
+		return;
+
+	if (upload_pbo == 0)
+		glGenBuffers(1, &upload_pbo);
+
+	auto   budget   = static_cast<size_t>(std::max(0, static_cast<int>(gl_tex_upload_budget))) * 1024;
+	size_t uploaded = 0;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo);
+	while (!pending_uploads.empty())
+	{
+		auto&  upload = pending_uploads.front();
+		size_t size   = static_cast<size_t>(upload.width) * upload.height * 4;
+		if (uploaded > 0 && uploaded + size > budget)
+			break;
+
+		// Copy data to the pixel buffer (orphaning its previous storage, so
+		// this doesn't wait for the previous upload to finish)
+		auto& tex_info = textures[upload.id];
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		if (auto buffer = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY))
+		{
+			memcpy(buffer, upload.data.data(), size);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+			// Fill the texture from the pixel buffer
+			bind(upload.id);
+			setTexParams(tex_info);
+			if (isMipmapped(tex_info.filter))
+				glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+			glTexImage2D(GL_TEXTURE_2D, 0, 4, upload.width, upload.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+			tex_info.size      = { static_cast<int>(upload.width), static_cast<int>(upload.height) };
+			tex_info.reduction = 1;
+		}
+		else
+		{
+			// Couldn't map the buffer, load directly instead
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			loadData(upload.id, upload.data.data(), upload.width, upload.height);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo);
+		}
+
+		uploaded += size;
+		pending_uploads.pop_front();
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
 // -----------------------------------------------------------------------------
 // Generates a 'chequerboard' texture using colours [col1] and [col2] and loads
 // it to OpenGL texture [id]
@@ -352,6 +549,81 @@ bool gl::Texture::genChequeredTexture(unsigned id, uint8_t block_size, ColRGBA c
 	return loadData(id, data.data(), block_size * 2, block_size * 2);
 }
 
+// -----------------------------------------------------------------------------
+// Reloads the OpenGL texture [id] with its image data downscaled to
+// 1/[reduction] of its full size. The texture info (size etc.) is unchanged,
+// so anything using the texture can continue to do so as normal.
+// Note that a texture can't be restored to a lower reduction, it must be
+// reloaded from its original image
+// -----------------------------------------------------------------------------
+bool gl::Texture::reduce(unsigned id, int reduction)
+{
+	if (!isLoaded(id) || id == tex_missing.id || id == tex_background.id || isUploadPending(id))
+		return false;
+
+	// Check reduction
+	auto& tex_info = textures[id];
+	if (reduction <= tex_info.reduction)
+		return false;
+
+	// Get current texture pixels
+	auto            size = dataSize(id);
+	vector<uint8_t> pixels(size.x * size.y * 4);
+	bind(id);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	// Downscale (average each block of pixels)
+	int             width  = std::max(1, tex_info.size.x / reduction);
+	int             height = std::max(1, tex_info.size.y / reduction);
+	vector<uint8_t> data(width * height * 4);
+	for (int y = 0; y < height; y++)
+	{
+		int y1 = y * size.y / height;
+		int y2 = std::max(y1 + 1, (y + 1) * size.y / height);
+		for (int x = 0; x < width; x++)
+		{
+			int      x1       = x * size.x / width;
+			int      x2       = std::max(x1 + 1, (x + 1) * size.x / width);
+			unsigned total[4] = { 0, 0, 0, 0 };
+			for (int sy = y1; sy < y2; sy++)
+				for (int sx = x1; sx < x2; sx++)
+					for (int c = 0; c < 4; c++)
+						total[c] += pixels[(sy * size.x + sx) * 4 + c];
+
+			unsigned npix = (x2 - x1) * (y2 - y1);
+			for (int c = 0; c < 4; c++)
+				data[(y * width + x) * 4 + c] = total[c] / npix;
+		}
+	}
+
+	// Load downscaled data, keeping the full size info
+	auto full_size = tex_info.size;
+	if (!loadData(id, data.data(), width, height))
+		return false;
+	tex_info.size      = full_size;
+	tex_info.reduction = reduction;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads [image] to the OpenGL texture [id], where [image] is a version of an
+// image of [full_size] already downscaled by a power of two. As with reduce,
+// the texture info has the full size and the matching reduction, so the
+// texture can be used as normal and later reloaded at full size via loadImage
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadReduced(unsigned id, const SImage& image, Vec2i full_size, Palette* pal)
+{
+	if (!loadImage(id, image, pal))
+		return false;
+
+	auto& tex_info     = textures[id];
+	tex_info.size      = full_size;
+	tex_info.reduction = std::max(1, std::max(full_size.x / image.width(), full_size.y / image.height()));
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the average colour of the OpenGL texture [id] within [area]
 // -----------------------------------------------------------------------------
@@ -376,10 +648,18 @@ ColRGBA gl::Texture::averageColour(unsigned id, Recti area)
 	if (area.br.y > tex_info.size.y)
 		area.br.y = tex_info.size.y;
 
-	// Get texture pixels
-	uint8_t* pixels = new uint8_t[tex_info.size.x * tex_info.size.y * 8];
+	// Get texture pixels (area is scaled to match if the texture is reduced)
+	auto     size   = dataSize(id);
+	uint8_t* pixels = new uint8_t[size.x * size.y * 8];
 	bind(tex_info.id);
 	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	if (tex_info.reduction > 1)
+	{
+		area.tl.x /= tex_info.reduction;
+		area.tl.y /= tex_info.reduction;
+		area.br.x = std::max(area.tl.x + 1, area.br.x / tex_info.reduction);
+		area.br.y = std::max(area.tl.y + 1, area.br.y / tex_info.reduction);
+	}
 
 	// Add colour values
 	unsigned red   = 0;
@@ -392,7 +672,7 @@ ColRGBA gl::Texture::averageColour(unsigned id, Recti area)
 		for (int x = area.tl.x; x < area.br.x; x++)
 		{
 			// Add pixel
-			unsigned c = (y * tex_info.size.x * 4) + (x * 4);
+			unsigned c = (y * size.x * 4) + (x * 4);
 			red += pixels[c++];
 			green += pixels[c++];
 			blue += pixels[c++];
@@ -413,18 +693,73 @@ ColRGBA gl::Texture::averageColour(unsigned id, Recti area)
 // -----------------------------------------------------------------------------
 void gl::Texture::bind(unsigned id, bool force)
 {
-	if (force)
-	{
-		glBindTexture(GL_TEXTURE_2D, id);
-		last_bound_tex = id;
-	}
-	else if (id != last_bound_tex)
+	if (force || id != last_bound_tex)
 	{
 		glBindTexture(GL_TEXTURE_2D, id);
 		last_bound_tex = id;
+		n_binds++;
+
+		// Record the frame the texture was used in
+		if (auto i = textures.find(id); i != textures.end())
+			i->second.last_used = current_frame;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns the size of the image data actually stored for the OpenGL texture
+// [id], which is smaller than its size if it has been reduced
+// -----------------------------------------------------------------------------
+Vec2i gl::Texture::dataSize(unsigned id)
+{
+	auto& tex_info = info(id);
+	if (tex_info.reduction <= 1)
+		return tex_info.size;
+
+	return { std::max(1, tex_info.size.x / tex_info.reduction), std::max(1, tex_info.size.y / tex_info.reduction) };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (approximate) GPU memory used by the OpenGL texture [id],
+// assuming 32bpp RGBA
+// -----------------------------------------------------------------------------
+size_t gl::Texture::memoryUsage(unsigned id)
+{
+	auto   size  = dataSize(id);
+	size_t bytes = static_cast<size_t>(size.x) * size.y * 4;
+
+	// Mipmaps add roughly another third
+	auto filter = info(id).filter;
+	if (filter == TexFilter::Mipmap || filter == TexFilter::LinearMipmap || filter == TexFilter::NearestMipmap)
+		bytes += bytes / 3;
+
+	return bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Starts a new frame, for tracking when textures were last used
+// -----------------------------------------------------------------------------
+void gl::Texture::nextFrame()
+{
+	current_frame++;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current frame number (see nextFrame)
+// -----------------------------------------------------------------------------
+unsigned gl::Texture::currentFrame()
+{
+	return current_frame;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total number of times a texture has been bound (ie. glBindTexture
+// was actually called)
+// -----------------------------------------------------------------------------
+unsigned gl::Texture::bindCount()
+{
+	return n_binds;
+}
+
 // -----------------------------------------------------------------------------
 // Deletes the OpenGL texture [id]
 // -----------------------------------------------------------------------------
@@ -433,6 +768,14 @@ void gl::Texture::clear(unsigned id)
 	if (id == 0 || id == tex_missing.id || id == tex_background.id || textures.empty())
 		return;
 
+	// Discard any pending upload (the id may be reused for a new texture)
+	for (auto i = pending_uploads.begin(); i != pending_uploads.end(); ++i)
+		if (i->id == id)
+		{
+			pending_uploads.erase(i);
+			break;
+		}
+
 	textures[id] = {};
 	glDeleteTextures(1, &id);
 }
@@ -448,4 +791,11 @@ void gl::Texture::clearAll()
 	textures.clear();
 	tex_missing    = {};
 	tex_background = {};
+
+	pending_uploads.clear();
+	if (upload_pbo > 0)
+	{
+		glDeleteBuffers(1, &upload_pbo);
+		upload_pbo = 0;
+	}
 }
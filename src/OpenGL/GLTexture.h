@@ -6,6 +6,7 @@ namespace slade
 {
 class SImage;
 class Palette;
+class MemChunk;
 
 namespace gl
 {
@@ -22,10 +23,12 @@ namespace gl
 
 	struct Texture
 	{
-		unsigned  id     = 0;
-		Vec2i     size   = { 0, 0 };
-		TexFilter filter = TexFilter::Nearest;
-		bool      tiling = true;
+		unsigned  id        = 0;
+		Vec2i     size      = { 0, 0 };
+		TexFilter filter    = TexFilter::Nearest;
+		bool      tiling    = true;
+		int       reduction = 1; // Image data is stored at 1/reduction of [size] (see reduce)
+		unsigned  last_used = 0; // Frame the texture was last bound in (see nextFrame)
 
 		static bool isCreated(unsigned id); // const { return id > 0; }
 		static bool isLoaded(unsigned id);  // const { return id > 0 && size.x > 0 && size.y > 0; }
@@ -33,6 +36,11 @@ namespace gl
 		static const Texture& info(unsigned id);
 		static ColRGBA        averageColour(unsigned id, Recti area);
 		static void           bind(unsigned id, bool force = true);
+		static Vec2i          dataSize(unsigned id);
+		static size_t         memoryUsage(unsigned id);
+		static void           nextFrame();
+		static unsigned       currentFrame();
+		static unsigned       bindCount();
 
 		static unsigned missingTexture();
 		static unsigned backgroundTexture();
@@ -52,7 +60,13 @@ namespace gl
 			bool          tiling = true);
 		static bool loadData(unsigned id, const uint8_t* data, unsigned width, unsigned height);
 		static bool loadImage(unsigned id, const SImage& image, Palette* pal = nullptr);
+		static bool loadDataAsync(unsigned id, const MemChunk& data, unsigned width, unsigned height);
+		static bool loadImageAsync(unsigned id, const SImage& image, Palette* pal = nullptr);
+		static bool isUploadPending(unsigned id);
+		static void processUploads();
 		static bool genChequeredTexture(unsigned id, uint8_t block_size, ColRGBA col1, ColRGBA col2);
+		static bool reduce(unsigned id, int reduction);
+		static bool loadReduced(unsigned id, const SImage& image, Vec2i full_size, Palette* pal = nullptr);
 		static void clear(unsigned id);
 		static void clearAll();
 	};
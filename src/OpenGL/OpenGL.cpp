@@ -47,6 +47,7 @@ CVAR(Bool, gl_tex_enable_np2, true, CVar::Flag::Save)
 CVAR(Bool, gl_point_sprite, true, CVar::Flag::Save)
 CVAR(Bool, gl_tweak_accuracy, true, CVar::Flag::Save)
 CVAR(Bool, gl_vbo, true, CVar::Flag::Save)
+CVAR(Bool, gl_shaders, true, CVar::Flag::Save)
 CVAR(Int, gl_depth_buffer_size, 24, CVar::Flag::Save)
 
 namespace slade::gl
@@ -139,6 +140,10 @@ bool gl::init()
 		log::info("Framebuffer Objects supported");
 	else
 		log::info("Framebuffer Objects not supported");
+	if (GLEW_VERSION_2_0)
+		log::info("GLSL Shaders supported");
+	else
+		log::info("GLSL Shaders not supported");
 
 	initialised = true;
 	return true;
@@ -171,6 +176,16 @@ bool gl::vboSupport()
 	return GLEW_ARB_vertex_buffer_object && gl_vbo;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the installed OpenGL version supports GLSL shader programs
+// (and vertex buffer objects, which shader rendering relies on), false
+// otherwise
+// -----------------------------------------------------------------------------
+bool gl::shaderSupport()
+{
+	return GLEW_VERSION_2_0 && gl_shaders && vboSupport();
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if [dim] is a valid texture dimension on the system OpenGL
 // version
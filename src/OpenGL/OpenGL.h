@@ -51,6 +51,7 @@ namespace gl
 	bool     np2TexSupport();
 	bool     pointSpriteSupport();
 	bool     vboSupport();
+	bool     shaderSupport();
 	bool     validTexDimension(unsigned dim);
 	float    maxPointSize();
 	unsigned maxTextureSize();
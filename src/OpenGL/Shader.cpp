@@ -0,0 +1,207 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Shader.cpp
+// Description: Shader class - a compiled GLSL shader program
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Shader.h"
+#include "OpenGL.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Compiles a shader of [type] from [source], returns the shader id or 0 if it
+// failed to compile (errors are logged with [name])
+// -----------------------------------------------------------------------------
+unsigned compileShader(GLenum type, string_view source, const string& name)
+{
+	auto        shader = glCreateShader(type);
+	const char* src    = source.data();
+	GLint       len    = static_cast<GLint>(source.size());
+	glShaderSource(shader, 1, &src, &len);
+	glCompileShader(shader);
+
+	GLint status = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (!status)
+	{
+		char log_text[1024];
+		glGetShaderInfoLog(shader, 1024, nullptr, log_text);
+		log::error(
+			"Unable to compile {} shader \"{}\": {}",
+			type == GL_VERTEX_SHADER ? "vertex" : "fragment",
+			name,
+			log_text);
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Shader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Shader class destructor
+// -----------------------------------------------------------------------------
+Shader::~Shader()
+{
+	clear();
+}
+
+// -----------------------------------------------------------------------------
+// Compiles and links the shader program from the given [vertex_source] and
+// [fragment_source]. Returns false if shaders aren't supported or the program
+// couldn't be built
+// -----------------------------------------------------------------------------
+bool Shader::load(string_view vertex_source, string_view fragment_source)
+{
+	clear();
+
+	if (!shaderSupport())
+		return false;
+
+	auto vertex   = compileShader(GL_VERTEX_SHADER, vertex_source, name_);
+	auto fragment = compileShader(GL_FRAGMENT_SHADER, fragment_source, name_);
+	if (!vertex || !fragment)
+	{
+		if (vertex)
+			glDeleteShader(vertex);
+		if (fragment)
+			glDeleteShader(fragment);
+		return false;
+	}
+
+	// Link program
+	id_ = glCreateProgram();
+	glAttachShader(id_, vertex);
+	glAttachShader(id_, fragment);
+	glLinkProgram(id_);
+
+	// Shaders are no longer needed once linked
+	glDetachShader(id_, vertex);
+	glDetachShader(id_, fragment);
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	GLint status = 0;
+	glGetProgramiv(id_, GL_LINK_STATUS, &status);
+	if (!status)
+	{
+		char log_text[1024];
+		glGetProgramInfoLog(id_, 1024, nullptr, log_text);
+		log::error("Unable to link shader \"{}\": {}", name_, log_text);
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Deletes the shader program
+// -----------------------------------------------------------------------------
+void Shader::clear()
+{
+	if (id_ > 0)
+		glDeleteProgram(id_);
+	id_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Uses the shader program for subsequent rendering
+// -----------------------------------------------------------------------------
+void Shader::bind() const
+{
+	glUseProgram(id_);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the float uniform [name] to [value]. The shader must be bound
+// -----------------------------------------------------------------------------
+void Shader::setUniform(const char* name, float value) const
+{
+	glUniform1f(uniformLocation(name), value);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the vec2 uniform [name] to [x,y]. The shader must be bound
+// -----------------------------------------------------------------------------
+void Shader::setUniform(const char* name, float x, float y) const
+{
+	glUniform2f(uniformLocation(name), x, y);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the vec4 uniform [name] to [x,y,z,w]. The shader must be bound
+// -----------------------------------------------------------------------------
+void Shader::setUniform(const char* name, float x, float y, float z, float w) const
+{
+	glUniform4f(uniformLocation(name), x, y, z, w);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the int (or sampler) uniform [name] to [value]. The shader must be bound
+// -----------------------------------------------------------------------------
+void Shader::setUniform(const char* name, int value) const
+{
+	glUniform1i(uniformLocation(name), value);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the location of uniform [name] in the program (-1 if not found)
+// -----------------------------------------------------------------------------
+int Shader::uniformLocation(const char* name) const
+{
+	return glGetUniformLocation(id_, name);
+}
+
+// -----------------------------------------------------------------------------
+// Goes back to the fixed-function pipeline for subsequent rendering
+// -----------------------------------------------------------------------------
+void Shader::unbind()
+{
+	glUseProgram(0);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace slade::gl
+{
+// A GLSL shader program, made up of a vertex and fragment shader
+class Shader
+{
+public:
+	Shader(string_view name) : name_{ name } {}
+	~Shader();
+
+	// No copying, the program is owned by this object
+	Shader(const Shader&)            = delete;
+	Shader& operator=(const Shader&) = delete;
+
+	unsigned      id() const { return id_; }
+	const string& name() const { return name_; }
+	bool          isValid() const { return id_ > 0; }
+
+	bool load(string_view vertex_source, string_view fragment_source);
+	void clear();
+
+	void bind() const;
+	void setUniform(const char* name, float value) const;
+	void setUniform(const char* name, float x, float y) const;
+	void setUniform(const char* name, float x, float y, float z, float w) const;
+	void setUniform(const char* name, int value) const;
+
+	static void unbind();
+
+private:
+	string   name_;
+	unsigned id_ = 0;
+
+	int uniformLocation(const char* name) const;
+};
+} // namespace slade::gl
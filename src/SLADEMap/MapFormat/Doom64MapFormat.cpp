@@ -142,9 +142,10 @@ bool Doom64MapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map
 	const auto     vert_data = reinterpret_cast<const Vertex*>(entry->rawData(true));
 	const unsigned nv        = entry->size() / sizeof(Vertex);
 	const float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nv; a++)
+	map_data.reserve(MapObject::Type::Vertex, nv);
+	for (unsigned a = 0; a < nv; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nv) * 0.2f);
+		updateReadProgress(p, a, nv);
 		map_data.addVertex(std::make_unique<MapVertex>(
 			Vec2d{ static_cast<double>(vert_data[a].x) / 65536, static_cast<double>(vert_data[a].y) / 65536 }));
 	}
@@ -176,9 +177,10 @@ bool Doom64MapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 	const auto     side_data = reinterpret_cast<const SideDef*>(entry->rawData(true));
 	const unsigned ns        = entry->size() / sizeof(SideDef);
 	const float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < ns; a++)
+	map_data.reserve(MapObject::Type::Side, ns);
+	for (unsigned a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(ns) * 0.2f);
+		updateReadProgress(p, a, ns);
 
 		// Add side
 		map_data.addSide(std::make_unique<MapSide>(
@@ -216,9 +218,10 @@ bool Doom64MapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 	const auto     line_data = reinterpret_cast<const LineDef*>(entry->rawData(true));
 	const unsigned nl        = entry->size() / sizeof(LineDef);
 	const float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nl; a++)
+	map_data.reserve(MapObject::Type::Line, nl);
+	for (unsigned a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nl) * 0.2f);
+		updateReadProgress(p, a, nl);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -242,18 +245,20 @@ bool Doom64MapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 				s2_index = static_cast<unsigned short>(data.side2);
 		}
 
-		// Create line
-		auto line = map_data.addLine(
-			std::make_unique<MapLine>(v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index)));
-
-		// Set properties
-		line->setArg(0, data.sector_tag);
+		// Create line (properties are set before it's added to the map, so no
+		// map updates are triggered for the changes)
+		auto line = std::make_unique<MapLine>(
+			v1,
+			v2,
+			map_data.sides().at(s1_index),
+			map_data.sides().at(s2_index),
+			data.type & 0x100 ? 0 : data.type & 0xFF,
+			data.flags,
+			MapObject::ArgSet{ data.sector_tag });
 		if (data.type & 0x100)
 			line->setIntProperty("macro", data.type & 0xFF);
-		else
-			line->setSpecial(data.type & 0xFF);
-		line->setFlags(data.flags);
 		line->setIntProperty("extraflags", data.type >> 9);
+		map_data.addLine(std::move(line));
 	}
 
 	log::info(3, "Read {} lines", map_data.lines().size());
@@ -283,28 +288,29 @@ bool Doom64MapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_
 	const auto     sect_data = reinterpret_cast<const Sector*>(entry->rawData(true));
 	const unsigned ns        = entry->size() / sizeof(Sector);
 	const float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < ns; a++)
+	map_data.reserve(MapObject::Type::Sector, ns);
+	for (unsigned a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(ns) * 0.2f);
+		updateReadProgress(p, a, ns);
 		const auto& data = sect_data[a];
 
-		// Add sector
-		auto sector = map_data.addSector(std::make_unique<MapSector>(
+		// Create sector (properties are set before it's added to the map, so no
+		// map updates are triggered for the changes)
+		auto sector = std::make_unique<MapSector>(
 			data.f_height,
 			ResourceManager::doom64TextureName(data.f_tex),
 			data.c_height,
 			ResourceManager::doom64TextureName(data.c_tex),
 			255,
 			data.special,
-			data.tag));
-
-		// Set properties
+			data.tag);
 		sector->setIntProperty("flags", data.flags);
 		sector->setIntProperty("color_floor", data.color[0]);
 		sector->setIntProperty("color_ceiling", data.color[1]);
 		sector->setIntProperty("color_things", data.color[2]);
 		sector->setIntProperty("color_upper", data.color[3]);
 		sector->setIntProperty("color_lower", data.color[4]);
+		map_data.addSector(std::move(sector));
 	}
 
 	log::info(3, "Read {} sectors", map_data.sectors().size());
@@ -335,9 +341,10 @@ bool Doom64MapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_d
 	const unsigned    nt        = entry->size() / sizeof(Thing);
 	const float       p         = ui::getSplashProgress();
 	MapObject::ArgSet args;
-	for (size_t a = 0; a < nt; a++)
+	map_data.reserve(MapObject::Type::Thing, nt);
+	for (unsigned a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nt) * 0.2f);
+		updateReadProgress(p, a, nt);
 		const auto& data = thng_data[a];
 
 		// Create thing
@@ -152,12 +152,13 @@ bool DoomMapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map_d
 		return true;
 	}
 
-	auto     vert_data = (Vertex*)entry->rawData(true);
-	unsigned nv        = entry->size() / sizeof(Vertex);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nv; a++)
+	const auto     vert_data = reinterpret_cast<const Vertex*>(entry->rawData(true));
+	const unsigned nv        = entry->size() / sizeof(Vertex);
+	const float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Vertex, nv);
+	for (unsigned a = 0; a < nv; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
+		updateReadProgress(p, a, nv);
 		map_data.addVertex(std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y }));
 	}
 
@@ -185,12 +186,13 @@ bool DoomMapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		return true;
 	}
 
-	auto     side_data = (SideDef*)entry->rawData(true);
-	unsigned ns        = entry->size() / sizeof(SideDef);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < ns; a++)
+	const auto     side_data = reinterpret_cast<const SideDef*>(entry->rawData(true));
+	const unsigned ns        = entry->size() / sizeof(SideDef);
+	const float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Side, ns);
+	for (unsigned a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		updateReadProgress(p, a, ns);
 
 		// Add side
 		map_data.addSide(std::make_unique<MapSide>(
@@ -225,12 +227,13 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		return true;
 	}
 
-	auto     line_data = (LineDef*)entry->rawData(true);
-	unsigned nl        = entry->size() / sizeof(LineDef);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nl; a++)
+	const auto     line_data = reinterpret_cast<const LineDef*>(entry->rawData(true));
+	const unsigned nl        = entry->size() / sizeof(LineDef);
+	const float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Line, nl);
+	for (unsigned a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		updateReadProgress(p, a, nl);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -254,13 +257,13 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 				s2_index = static_cast<unsigned short>(data.side2);
 		}
 
-		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(
-			v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index), data.type, data.flags));
-
-		// Set properties
+		// Create line (properties are set before it's added to the map, so no
+		// map updates are triggered for the changes)
+		auto line = std::make_unique<MapLine>(
+			v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index), data.type, data.flags);
 		line->setArg(0, data.sector_tag);
 		line->setId(data.sector_tag);
+		map_data.addLine(std::move(line));
 	}
 
 	log::info(3, "Read {} lines", map_data.lines().size());
@@ -287,12 +290,13 @@ bool DoomMapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_da
 		return true;
 	}
 
-	auto     sect_data = (Sector*)entry->rawData(true);
-	unsigned ns        = entry->size() / sizeof(Sector);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < ns; a++)
+	const auto     sect_data = reinterpret_cast<const Sector*>(entry->rawData(true));
+	const unsigned ns        = entry->size() / sizeof(Sector);
+	const float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Sector, ns);
+	for (unsigned a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		updateReadProgress(p, a, ns);
 		const auto& data = sect_data[a];
 
 		// Add sector
@@ -330,12 +334,13 @@ bool DoomMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_dat
 		return true;
 	}
 
-	auto     thng_data = (Thing*)entry->rawData(true);
-	unsigned nt        = entry->size() / sizeof(Thing);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nt; a++)
+	const auto     thng_data = reinterpret_cast<const Thing*>(entry->rawData(true));
+	const unsigned nt        = entry->size() / sizeof(Thing);
+	const float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Thing, nt);
+	for (unsigned a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		updateReadProgress(p, a, nt);
 		map_data.addThing(std::make_unique<MapThing>(
 			Vec3d{ (double)thng_data[a].x, (double)thng_data[a].y, 0. },
 			thng_data[a].type,
@@ -401,9 +406,9 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeSIDEDEFS(const SideList& sides) con
 			data.sector = side->sector()->index();
 
 		// Textures
-		memcpy(data.tex_middle, side->texMiddle().data(), side->texMiddle().size());
-		memcpy(data.tex_upper, side->texUpper().data(), side->texUpper().size());
-		memcpy(data.tex_lower, side->texLower().data(), side->texLower().size());
+		memcpy(data.tex_middle, side->texMiddle().name().data(), side->texMiddle().name().size());
+		memcpy(data.tex_upper, side->texUpper().name().data(), side->texUpper().name().size());
+		memcpy(data.tex_lower, side->texLower().name().data(), side->texLower().name().size());
 
 		entry->write(&data, 30);
 	}
@@ -468,8 +473,8 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeSECTORS(const SectorList& sectors)
 		data.c_height = sector->ceiling().height;
 
 		// Textures
-		memcpy(data.f_tex, sector->floor().texture.data(), sector->floor().texture.size());
-		memcpy(data.c_tex, sector->ceiling().texture.data(), sector->ceiling().texture.size());
+		memcpy(data.f_tex, sector->floor().texture.name().data(), sector->floor().texture.name().size());
+		memcpy(data.c_tex, sector->ceiling().texture.name().data(), sector->ceiling().texture.name().size());
 
 		// Properties
 		data.light   = sector->lightLevel();
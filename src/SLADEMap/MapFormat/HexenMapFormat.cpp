@@ -67,12 +67,13 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 		return true;
 	}
 
-	auto     line_data = (LineDef*)entry->rawData(true);
-	unsigned nl        = entry->size() / sizeof(LineDef);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nl; a++)
+	const auto     line_data = reinterpret_cast<const LineDef*>(entry->rawData(true));
+	const unsigned nl        = entry->size() / sizeof(LineDef);
+	const float    p         = ui::getSplashProgress();
+	map_data.reserve(MapObject::Type::Line, nl);
+	for (unsigned a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		updateReadProgress(p, a, nl);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -104,12 +105,12 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 		if (s2 && s2->parentLine())
 			s2 = map_data.duplicateSide(s2);
 
-		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags));
-
-		// Set properties
+		// Create line (properties are set before it's added to the map, so no
+		// map updates are triggered for the changes)
+		MapObject::ArgSet args;
 		for (unsigned i = 0; i < 5; ++i)
-			line->setArg(i, data.args[i]);
+			args[i] = data.args[i];
+		auto line = std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags, args);
 
 		// Handle some special cases
 		if (data.type)
@@ -122,6 +123,8 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 			default: break;
 			}
 		}
+
+		map_data.addLine(std::move(line));
 	}
 
 	log::info(3, "Read {} lines", map_data.lines().size());
@@ -148,13 +151,14 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 		return true;
 	}
 
-	auto              thng_data = (Thing*)entry->rawData(true);
-	unsigned          nt        = entry->size() / sizeof(Thing);
-	float             p         = ui::getSplashProgress();
+	const auto        thng_data = reinterpret_cast<const Thing*>(entry->rawData(true));
+	const unsigned    nt        = entry->size() / sizeof(Thing);
+	const float       p         = ui::getSplashProgress();
 	MapObject::ArgSet args;
-	for (size_t a = 0; a < nt; a++)
+	map_data.reserve(MapObject::Type::Thing, nt);
+	for (unsigned a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		updateReadProgress(p, a, nt);
 		const auto& data = thng_data[a];
 
 		// Set args
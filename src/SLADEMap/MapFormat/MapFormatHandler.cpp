@@ -34,6 +34,7 @@
 #include "Main.h"
 #include "Doom64MapFormat.h"
 #include "DoomMapFormat.h"
+#include "General/UI.h"
 #include "HexenMapFormat.h"
 #include "UniversalDoomMapFormat.h"
 
@@ -82,3 +83,16 @@ unique_ptr<MapFormatHandler> MapFormatHandler::get(MapFormat format)
 	default: return std::make_unique<NoMapFormat>();
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Updates the splash window progress while reading object [index] of [count]
+// from a map entry, where the entry's progress starts at [start] and takes up
+// 0.2 of the total.
+// Only updates every 1024 objects, since updating the splash window for every
+// object can take much longer than reading the objects themselves
+// -----------------------------------------------------------------------------
+void MapFormatHandler::updateReadProgress(float start, unsigned index, unsigned count)
+{
+	if (index % 1024 == 0)
+		ui::setSplashProgress(start + static_cast<float>(index) / static_cast<float>(count) * 0.2f);
+}
@@ -20,5 +20,8 @@ public:
 	virtual void   setUDMFNamespace(string_view ns) {}
 
 	static unique_ptr<MapFormatHandler> get(MapFormat format);
+
+protected:
+	static void updateReadProgress(float start, unsigned index, unsigned count);
 };
 } // namespace slade
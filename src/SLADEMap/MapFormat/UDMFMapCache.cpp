@@ -0,0 +1,456 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    UDMFMapCache.cpp
+// Description: Persistent on-disk cache of the object definitions read from
+//              large UDMF TEXTMAP entries, so unchanged maps can be reopened
+//              without parsing the text again
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "UDMFMapCache.h"
+#include "App.h"
+#include "Utility/FileUtils.h"
+#include "Utility/Parser.h"
+#include <filesystem>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, map_udmf_cache, true, CVar::Flag::Save)
+CVAR(Int, map_udmf_cache_min_size, 1024, CVar::Flag::Save) // Minimum TEXTMAP size (KB) to cache
+CVAR(Int, map_udmf_cache_max_size, 512, CVar::Flag::Save)  // Maximum total size of cache files (MB)
+namespace
+{
+constexpr uint32_t cache_magic   = 0x434D4C53; // "SLMC"
+constexpr uint32_t cache_version = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Helper functions for writing cache data to [buf]
+// -----------------------------------------------------------------------------
+template<typename T> void writeValue(vector<uint8_t>& buf, T value)
+{
+	auto bytes = reinterpret_cast<const uint8_t*>(&value);
+	buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+void writeString(vector<uint8_t>& buf, string_view str)
+{
+	writeValue(buf, static_cast<uint32_t>(str.size()));
+	buf.insert(buf.end(), str.begin(), str.end());
+}
+void writeProperty(vector<uint8_t>& buf, const Property& value)
+{
+	writeValue(buf, static_cast<uint8_t>(value.index()));
+	switch (property::valueType(value))
+	{
+	case property::ValueType::Bool: writeValue(buf, static_cast<uint8_t>(std::get<bool>(value))); break;
+	case property::ValueType::Int: writeValue(buf, static_cast<int32_t>(std::get<int>(value))); break;
+	case property::ValueType::UInt: writeValue(buf, static_cast<uint32_t>(std::get<unsigned>(value))); break;
+	case property::ValueType::Float: writeValue(buf, std::get<double>(value)); break;
+	case property::ValueType::String: writeString(buf, std::get<string>(value)); break;
+	}
+}
+
+// Reads cache data from a block of memory, with bounds checking
+class CacheReader
+{
+public:
+	CacheReader(const uint8_t* data, size_t size) : data_{ data }, size_{ size } {}
+
+	size_t position() const { return position_; }
+	void   seek(size_t position) { position_ = position; }
+
+	template<typename T> bool read(T& value)
+	{
+		if (position_ + sizeof(T) > size_)
+			return false;
+
+		memcpy(&value, data_ + position_, sizeof(T));
+		position_ += sizeof(T);
+		return true;
+	}
+
+	bool readString(string& str)
+	{
+		uint32_t length;
+		if (!read(length) || position_ + length > size_)
+			return false;
+
+		str.assign(reinterpret_cast<const char*>(data_ + position_), length);
+		position_ += length;
+		return true;
+	}
+
+	bool readProperty(Property& value)
+	{
+		uint8_t type;
+		if (!read(type))
+			return false;
+
+		switch (static_cast<property::ValueType>(type))
+		{
+		case property::ValueType::Bool:
+		{
+			uint8_t b;
+			if (!read(b))
+				return false;
+			value = b > 0;
+			return true;
+		}
+		case property::ValueType::Int:
+		{
+			int32_t i;
+			if (!read(i))
+				return false;
+			value = static_cast<int>(i);
+			return true;
+		}
+		case property::ValueType::UInt:
+		{
+			uint32_t u;
+			if (!read(u))
+				return false;
+			value = static_cast<unsigned>(u);
+			return true;
+		}
+		case property::ValueType::Float:
+		{
+			double d;
+			if (!read(d))
+				return false;
+			value = d;
+			return true;
+		}
+		case property::ValueType::String:
+		{
+			string s;
+			if (!readString(s))
+				return false;
+			value = std::move(s);
+			return true;
+		}
+		default: return false;
+		}
+	}
+
+private:
+	const uint8_t* data_;
+	size_t         size_;
+	size_t         position_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Reads an object definition using [reader], adding its properties to [def]
+// (if given). Returns false if the data is invalid
+// -----------------------------------------------------------------------------
+bool readObject(CacheReader& reader, const vector<string>& keys, ParseTreeNode* def)
+{
+	uint16_t n_props;
+	if (!reader.read(n_props))
+		return false;
+
+	Property value;
+	for (unsigned a = 0; a < n_props; a++)
+	{
+		uint16_t key;
+		if (!reader.read(key) || key >= keys.size() || !reader.readProperty(value))
+			return false;
+
+		if (def)
+			def->addChildPTN(keys[key])->addValue(value);
+	}
+
+	return true;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// UDMFMapCache Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// UDMFMapCache class constructor.
+// The cache is only used for [textmap] data of at least map_udmf_cache_min_size
+// -----------------------------------------------------------------------------
+UDMFMapCache::UDMFMapCache(const MemChunk& textmap)
+{
+	auto min_size = static_cast<uint32_t>(std::max(0, static_cast<int>(map_udmf_cache_min_size))) * 1024;
+	if (!map_udmf_cache || textmap.size() < min_size)
+		return;
+
+	// Get cache file path (named by the TEXTMAP hash)
+	textmap_hash_ = textmap.hash();
+	textmap_size_ = textmap.size();
+	cache_file_   = app::path(fmt::format("mapcache/{:016x}.dat", textmap_hash_), app::Dir::User);
+	enabled_      = true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the cached map from the cache file, calling [create] for each object
+// definition in order (with its type and index) and setting [udmf_namespace]
+// and [extra_props] to the cached map-scope values.
+// Returns false if there is no (valid) cache for the TEXTMAP data, in which
+// case [create] is never called
+// -----------------------------------------------------------------------------
+bool UDMFMapCache::read(const CreateFunc& create, string& udmf_namespace, PropertyList& extra_props) const
+{
+	if (!enabled_ || !fileutil::fileExists(cache_file_))
+		return false;
+
+	MappedFile file(cache_file_);
+	if (!file.isOpen())
+		return false;
+	CacheReader reader(file.data(), file.size());
+
+	// Check header
+	uint32_t magic, version, textmap_size;
+	uint64_t textmap_hash;
+	string   slade_version;
+	if (!reader.read(magic) || !reader.read(version) || !reader.read(textmap_hash) || !reader.read(textmap_size)
+		|| !reader.readString(slade_version))
+		return false;
+	if (magic != cache_magic || version != cache_version || textmap_hash != textmap_hash_
+		|| textmap_size != textmap_size_ || slade_version != app::version().toString())
+		return false;
+
+	// Read map-scope values
+	string                              ns;
+	uint32_t                            n_extra;
+	vector<std::pair<string, Property>> extra;
+	if (!reader.readString(ns) || !reader.read(n_extra))
+		return false;
+	for (unsigned a = 0; a < n_extra; a++)
+	{
+		string   key;
+		Property value;
+		if (!reader.readString(key) || !reader.readProperty(value))
+			return false;
+		extra.emplace_back(std::move(key), std::move(value));
+	}
+
+	// Read property key table
+	uint16_t       n_keys;
+	vector<string> keys;
+	if (!reader.read(n_keys))
+		return false;
+	keys.resize(n_keys);
+	for (auto& key : keys)
+		if (!reader.readString(key))
+			return false;
+
+	// Check all object definitions are valid before creating anything
+	auto objects_start = reader.position();
+	for (unsigned type = 0; type < N_TYPES; type++)
+	{
+		uint32_t count;
+		if (!reader.read(count))
+			return false;
+		for (unsigned a = 0; a < count; a++)
+			if (!readObject(reader, keys, nullptr))
+				return false;
+	}
+
+	// Create objects
+	reader.seek(objects_start);
+	for (unsigned type = 0; type < N_TYPES; type++)
+	{
+		uint32_t count;
+		reader.read(count);
+		for (unsigned a = 0; a < count; a++)
+		{
+			ParseTreeNode def;
+			readObject(reader, keys, &def);
+			create(static_cast<ObjectType>(type), a, &def);
+		}
+	}
+
+	if (!ns.empty())
+		udmf_namespace = ns;
+	for (auto& [key, value] : extra)
+		extra_props[key] = value;
+
+	// Mark the cache file as recently used (see prune)
+	std::error_code ec;
+	std::filesystem::last_write_time(cache_file_, std::filesystem::file_time_type::clock::now(), ec);
+
+	log::info(2, "Read map from UDMF cache file {}", cache_file_);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the object definition [def] of [type] to be written to the cache on
+// save. Objects must be added in the order they are created
+// -----------------------------------------------------------------------------
+void UDMFMapCache::addObject(ObjectType type, ParseTreeNode& def)
+{
+	if (!enabled_)
+		return;
+
+	auto& buf = objects_[static_cast<unsigned>(type)];
+	writeValue(buf, static_cast<uint16_t>(def.nChildren()));
+	for (unsigned a = 0; a < def.nChildren(); a++)
+	{
+		auto child = def.childPTN(a);
+
+		// Get key index
+		auto key = key_index_.find(child->name());
+		if (key == key_index_.end())
+		{
+			key = key_index_.emplace(child->name(), static_cast<uint16_t>(keys_.size())).first;
+			keys_.push_back(child->name());
+		}
+
+		writeValue(buf, key->second);
+		writeProperty(buf, child->nValues() > 0 ? child->values()[0] : Property{});
+	}
+
+	++n_objects_[static_cast<unsigned>(type)];
+}
+
+// -----------------------------------------------------------------------------
+// Writes all added objects and the map-scope [udmf_namespace] and
+// [extra_props] values to the cache file
+// -----------------------------------------------------------------------------
+void UDMFMapCache::save(string_view udmf_namespace, const PropertyList& extra_props)
+{
+	if (!enabled_)
+		return;
+
+	// Can't cache if there are too many distinct property names
+	if (keys_.size() > 65535)
+		return;
+
+	// Write header
+	vector<uint8_t> buf;
+	size_t          size = 256;
+	for (const auto& objects : objects_)
+		size += objects.size() + 4;
+	buf.reserve(size);
+	writeValue(buf, cache_magic);
+	writeValue(buf, cache_version);
+	writeValue(buf, textmap_hash_);
+	writeValue(buf, textmap_size_);
+	writeString(buf, app::version().toString());
+
+	// Write map-scope values
+	writeString(buf, udmf_namespace);
+	writeValue(buf, static_cast<uint32_t>(extra_props.properties().size()));
+	for (const auto& prop : extra_props.properties())
+	{
+		writeString(buf, prop.name());
+		writeProperty(buf, prop.value);
+	}
+
+	// Write property key table
+	writeValue(buf, static_cast<uint16_t>(keys_.size()));
+	for (const auto& key : keys_)
+		writeString(buf, key);
+
+	// Write objects
+	for (unsigned type = 0; type < N_TYPES; type++)
+	{
+		writeValue(buf, n_objects_[type]);
+		buf.insert(buf.end(), objects_[type].begin(), objects_[type].end());
+		objects_[type].clear();
+		objects_[type].shrink_to_fit();
+	}
+
+	// Write to file
+	const auto cache_dir = app::path("mapcache", app::Dir::User);
+	if (!fileutil::dirExists(cache_dir))
+		fileutil::createDir(cache_dir);
+	{
+		SFile file(cache_file_, SFile::Mode::Write);
+		if (!file.isOpen() || !file.write(buf.data(), buf.size()))
+		{
+			log::warning("Unable to write UDMF map cache file {}", cache_file_);
+			file.close();
+			fileutil::removeFile(cache_file_);
+			return;
+		}
+	}
+
+	prune();
+}
+
+// -----------------------------------------------------------------------------
+// Removes the least recently used cache files until the total size of all
+// cache files is within map_udmf_cache_max_size
+// -----------------------------------------------------------------------------
+void UDMFMapCache::prune() const
+{
+	namespace fs = std::filesystem;
+
+	struct CacheFile
+	{
+		fs::path           path;
+		uintmax_t          size;
+		fs::file_time_type time;
+	};
+	vector<CacheFile> files;
+	uintmax_t         total = 0;
+	std::error_code   ec;
+	for (const auto& file : fs::directory_iterator(app::path("mapcache", app::Dir::User), ec))
+	{
+		if (!file.is_regular_file(ec))
+			continue;
+
+		files.push_back({ file.path(), file.file_size(ec), file.last_write_time(ec) });
+		total += files.back().size;
+	}
+
+	// Remove oldest first
+	auto max_size = static_cast<uintmax_t>(std::max(0, static_cast<int>(map_udmf_cache_max_size))) * 1024 * 1024;
+	std::sort(files.begin(), files.end(), [](const CacheFile& l, const CacheFile& r) { return l.time < r.time; });
+	for (const auto& file : files)
+	{
+		if (total <= max_size)
+			break;
+
+		fs::remove(file.path, ec);
+		total -= file.size;
+	}
+}
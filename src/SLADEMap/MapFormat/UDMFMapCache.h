@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+
+namespace slade
+{
+class MemChunk;
+class ParseTreeNode;
+class PropertyList;
+
+// Persistent on-disk cache of the object definitions read from a (large) UDMF
+// TEXTMAP, in a compact binary form keyed by a hash of the TEXTMAP data and the
+// SLADE version. When the same unchanged TEXTMAP is read again, its objects can
+// be created from the (memory-mapped) cache without parsing any text
+class UDMFMapCache
+{
+public:
+	// Object types, in the order they are created
+	enum class ObjectType : uint8_t
+	{
+		Vertex,
+		Sector,
+		Side,
+		Line,
+		Thing,
+
+		Count
+	};
+	typedef std::function<bool(ObjectType, unsigned, ParseTreeNode*)> CreateFunc;
+
+	UDMFMapCache(const MemChunk& textmap);
+	~UDMFMapCache() = default;
+
+	bool enabled() const { return enabled_; }
+
+	bool read(const CreateFunc& create, string& udmf_namespace, PropertyList& extra_props) const;
+	void addObject(ObjectType type, ParseTreeNode& def);
+	void save(string_view udmf_namespace, const PropertyList& extra_props);
+
+private:
+	static constexpr unsigned N_TYPES = static_cast<unsigned>(ObjectType::Count);
+
+	bool     enabled_ = false;
+	string   cache_file_;
+	uint64_t textmap_hash_ = 0;
+	uint32_t textmap_size_ = 0;
+
+	// Object definitions added for saving, written per type (see addObject)
+	vector<uint8_t>                      objects_[N_TYPES];
+	uint32_t                             n_objects_[N_TYPES] = {};
+	vector<string>                       keys_;
+	std::unordered_map<string, uint16_t> key_index_;
+
+	void prune() const;
+};
+} // namespace slade
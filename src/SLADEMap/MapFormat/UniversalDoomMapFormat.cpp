@@ -33,6 +33,7 @@
 #include "UniversalDoomMapFormat.h"
 #include "App.h"
 #include "Game/Configuration.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "SLADEMap/MapObject/MapLine.h"
 #include "SLADEMap/MapObject/MapSector.h"
@@ -45,6 +46,276 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, map_udmf_direct_read, true, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [c] is a special character, which is always read as a
+// separate token
+// -----------------------------------------------------------------------------
+bool isSpecialChar(char c)
+{
+	return c == ';' || c == ',' || c == ':' || c == '|' || c == '=' || c == '{' || c == '}' || c == '/';
+}
+
+// A token read by TextmapReader. The text points directly into the data being
+// read, so quoted strings are not yet unescaped
+struct TextmapToken
+{
+	string_view text;
+	bool        quoted = false;
+
+	bool is(char c) const { return !quoted && text.size() == 1 && text[0] == c; }
+	bool isSpecial() const { return !quoted && text.size() == 1 && isSpecialChar(text[0]); }
+};
+
+// Reads tokens directly from UDMF TEXTMAP data, in the same way as a Tokenizer
+// with default settings (as used by Parser) would, but without copying
+// anything
+class TextmapReader
+{
+public:
+	TextmapReader(const char* data, size_t size) : data_{ data }, size_{ size } {}
+
+	size_t position() const { return position_; }
+	size_t size() const { return size_; }
+	void   seek(size_t position) { position_ = position; }
+
+	// Reads the next token into [token], returns false if at the end of the
+	// data
+	bool next(TextmapToken& token)
+	{
+		skipWhitespace();
+		if (position_ >= size_)
+			return false;
+
+		// Special character
+		if (isSpecialChar(data_[position_]))
+		{
+			token.text   = { data_ + position_++, 1 };
+			token.quoted = false;
+			return true;
+		}
+
+		// Quoted string
+		if (data_[position_] == '"')
+		{
+			const auto start = ++position_;
+			while (position_ < size_ && data_[position_] != '"')
+				position_ += data_[position_] == '\\' ? 2 : 1;
+			position_    = std::min(position_, size_);
+			token.text   = { data_ + start, position_ - start };
+			token.quoted = true;
+			++position_; // Skip closing "
+			return true;
+		}
+
+		// Token
+		const auto start = position_;
+		while (position_ < size_ && !isWhitespace(data_[position_]) && !isSpecialChar(data_[position_])
+			   && !commentBegins())
+			++position_;
+		token.text   = { data_ + start, position_ - start };
+		token.quoted = false;
+		return true;
+	}
+
+private:
+	const char* data_;
+	size_t      size_;
+	size_t      position_ = 0;
+
+	static bool isWhitespace(char c) { return c == '\n' || c == '\r' || c == ' ' || c == '\t'; }
+
+	bool commentBegins() const
+	{
+		if (position_ + 1 >= size_)
+			return false;
+
+		const auto c1 = data_[position_];
+		const auto c2 = data_[position_ + 1];
+		return c1 == '/' && (c2 == '*' || c2 == '/') || c1 == '#' && c2 == '#';
+	}
+
+	// Skips any whitespace and comments at the current position
+	void skipWhitespace()
+	{
+		while (position_ < size_)
+		{
+			if (isWhitespace(data_[position_]))
+				++position_;
+			else if (commentBegins())
+			{
+				// C-style comment, skip to */
+				if (data_[position_ + 1] == '*')
+				{
+					position_ += 2;
+					while (position_ + 1 < size_ && !(data_[position_] == '*' && data_[position_ + 1] == '/'))
+						++position_;
+					position_ += 2;
+				}
+
+				// Line comment, skip to end of line
+				else
+				{
+					while (position_ < size_ && data_[position_] != '\n')
+						++position_;
+				}
+			}
+			else
+				break;
+		}
+	}
+};
+
+// A block definition (eg. vertex { ... }) in TEXTMAP data
+struct TextmapBlock
+{
+	size_t start; // Position just after the opening {
+	size_t end;   // Position just after the closing }
+};
+
+// -----------------------------------------------------------------------------
+// Returns true if [text] would be matched by the regex used by strutil::isFloat
+// (^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$, note the unescaped . matches any
+// character)
+// -----------------------------------------------------------------------------
+bool isFloat(string_view text)
+{
+	if (text.empty() || text[0] == '$')
+		return false;
+
+	const auto n_digits = [&text](size_t from) {
+		auto to = from;
+		while (to < text.size() && text[to] >= '0' && text[to] <= '9')
+			++to;
+		return to - from;
+	};
+	const auto is_exponent = [&text, &n_digits](size_t from) {
+		if (from == text.size())
+			return true;
+		if (text[from] != 'e' && text[from] != 'E')
+			return false;
+		if (++from < text.size() && (text[from] == '+' || text[from] == '-'))
+			++from;
+		const auto digits = n_digits(from);
+		return digits > 0 && from + digits == text.size();
+	};
+
+	for (size_t sign = 0; sign <= (text[0] == '+' || text[0] == '-' ? 1u : 0u); ++sign)
+	{
+		const auto int_digits = n_digits(sign);
+		for (auto i = sign; i <= sign + int_digits; ++i)
+			for (size_t any = 0; any <= 1; ++any)
+			{
+				const auto frac_start = i + any;
+				if (frac_start > text.size())
+					continue;
+
+				const auto frac_digits = n_digits(frac_start);
+				if (frac_digits > 0 && is_exponent(frac_start + frac_digits))
+					return true;
+			}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value of [token], converted to a property value in the same way
+// as Parser does
+// -----------------------------------------------------------------------------
+Property tokenValue(const TextmapToken& token)
+{
+	// Quoted string
+	if (token.quoted)
+	{
+		string value;
+		value.reserve(token.text.size());
+		for (unsigned a = 0; a < token.text.size(); ++a)
+		{
+			if (token.text[a] == '\\' && a + 1 < token.text.size())
+				++a;
+			value += token.text[a];
+		}
+		return value;
+	}
+
+	auto text = strutil::lower(token.text);
+	if (text == "true")
+		return true;
+	if (text == "false")
+		return false;
+
+	// Integer
+	auto i = text[0] == '+' || text[0] == '-' ? 1u : 0u;
+	if (i < text.size() && std::all_of(text.begin() + i, text.end(), [](char c) { return c >= '0' && c <= '9'; }))
+		return strutil::asInt(text);
+
+	// Hex (0xXXXXXX)
+	if (text.size() > 2 && text[0] == '0' && text[1] == 'x'
+		&& std::all_of(text.begin() + 2, text.end(), [](char c) { return isxdigit(static_cast<unsigned char>(c)); }))
+		return strutil::asInt({ text.data() + 2, text.size() - 2 }, 16);
+
+	// Floating point
+	if (isFloat(text))
+		return strutil::asDouble(text);
+
+	// Unknown, just treat as string
+	return text;
+}
+
+// -----------------------------------------------------------------------------
+// Reads a 'name = value;' assignment using [reader], where [name] has already
+// been read. Returns false if the assignment is invalid or not a single value
+// -----------------------------------------------------------------------------
+bool readAssignment(TextmapReader& reader, const TextmapToken& name, TextmapToken& value)
+{
+	TextmapToken token;
+	return !name.quoted && !name.text.empty() && !name.isSpecial() && name.text[0] != '#' && reader.next(token)
+		   && token.is('=') && reader.next(value) && !value.isSpecial() && reader.next(token) && token.is(';');
+}
+
+// -----------------------------------------------------------------------------
+// Writes UDMF definitions of all [objects] to [file], in order. The objects are
+// written to separate text buffers in parallel (in chunks of [chunk_size]
+// objects), which are then written to the file in order
+// -----------------------------------------------------------------------------
+template<typename T> void writeObjects(const MapObjectList<T>& objects, wxFile& file, size_t chunk_size = 1024)
+{
+	vector<string> buffers((objects.size() + chunk_size - 1) / chunk_size);
+	threadpool::parallelFor(buffers.size(), [&](size_t index) {
+		auto&      buffer = buffers[index];
+		const auto start  = index * chunk_size;
+		const auto end    = std::min<size_t>(start + chunk_size, objects.size());
+		buffer.reserve(chunk_size * 192);
+
+		string object_def;
+		for (auto a = start; a < end; ++a)
+		{
+			objects[a]->writeUDMF(object_def);
+			buffer += object_def;
+		}
+	});
+
+	for (const auto& buffer : buffers)
+		file.Write(buffer);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // UniversalDoomMapFormat Class Functions
@@ -66,6 +337,32 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	if (!textmap)
 		return false;
 
+	// Read from the cache if the TEXTMAP is unchanged since it was last read
+	UDMFMapCache cache(textmap->data());
+	if (cache.enabled())
+	{
+		ui::setSplashProgressMessage("Reading cached TEXTMAP");
+		ui::setSplashProgress(-100.0f);
+		auto create = [&](UDMFMapCache::ObjectType type, unsigned index, ParseTreeNode* def) {
+			if (createObject(type, def, map_data))
+				return true;
+
+			log::warning("Invalid cached UDMF definition {} (type {}), not added", index, static_cast<int>(type));
+			return false;
+		};
+		if (cache.read(create, udmf_namespace_, map_extra_props))
+		{
+			ui::setSplashProgressMessage("Init map data");
+			return true;
+		}
+	}
+
+	// Read TEXTMAP directly if possible (writing it to the cache if enabled),
+	// otherwise fall back to the generic parser below
+	if (map_udmf_direct_read
+		&& readTextmap(textmap->data(), map_data, map_extra_props, cache.enabled() ? &cache : nullptr))
+		return true;
+
 	// --- Parse UDMF text ---
 	ui::setSplashProgressMessage("Parsing TEXTMAP");
 	ui::setSplashProgress(-100.0f);
@@ -218,6 +515,192 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads UDMF TEXTMAP [data] directly (without building a full parse tree of
+// it first), populating [map_data]. If [cache] is given, all object
+// definitions read are added to it.
+// Returns false if the data contains anything other than simple 'name = value;'
+// assignments and blocks of them, in which case nothing is added to [map_data]
+// and the generic parser should be used instead
+// -----------------------------------------------------------------------------
+bool UniversalDoomMapFormat::readTextmap(
+	const MemChunk&      data,
+	MapObjectCollection& map_data,
+	PropertyList&        map_extra_props,
+	UDMFMapCache*        cache)
+{
+	TextmapReader reader(reinterpret_cast<const char*>(data.data()), data.size());
+
+	// First go through the data, checking it's valid and making a list of all
+	// definition blocks for each object type so they can be created in the
+	// correct order (verts->sectors->sides->lines->things), even if they aren't
+	// defined in that order
+	ui::setSplashProgressMessage("Reading TEXTMAP");
+	ui::setSplashProgress(0.0f);
+	vector<TextmapBlock> blocks_vertices;
+	vector<TextmapBlock> blocks_lines;
+	vector<TextmapBlock> blocks_sides;
+	vector<TextmapBlock> blocks_sectors;
+	vector<TextmapBlock> blocks_things;
+	string               ns;
+	PropertyList         extra_props;
+	TextmapToken         name, token, value;
+	while (reader.next(name))
+	{
+		if (name.quoted || name.isSpecial() || name.text[0] == '#')
+			return false;
+
+		// Block
+		auto block_start = reader.position();
+		if (reader.next(token) && token.is('{'))
+		{
+			block_start = reader.position();
+			while (true)
+			{
+				if (!reader.next(token))
+					return false;
+				if (token.is('}'))
+					break;
+				if (!readAssignment(reader, token, value))
+					return false;
+			}
+
+			const TextmapBlock block{ block_start, reader.position() };
+			if (strutil::equalCI(name.text, "vertex"))
+				blocks_vertices.push_back(block);
+			else if (strutil::equalCI(name.text, "linedef"))
+				blocks_lines.push_back(block);
+			else if (strutil::equalCI(name.text, "sidedef"))
+				blocks_sides.push_back(block);
+			else if (strutil::equalCI(name.text, "sector"))
+				blocks_sectors.push_back(block);
+			else if (strutil::equalCI(name.text, "thing"))
+				blocks_things.push_back(block);
+
+			// TODO: Unknown blocks
+
+			ui::setSplashProgress(static_cast<float>(reader.position()) / reader.size());
+			continue;
+		}
+
+		// Map-scope value
+		reader.seek(block_start);
+		if (!readAssignment(reader, name, value))
+			return false;
+		if (strutil::equalCI(name.text, "namespace"))
+			ns = property::asString(tokenValue(value));
+		else
+			extra_props[strutil::lower(name.text)] = tokenValue(value);
+	}
+
+	if (!ns.empty())
+		udmf_namespace_ = ns;
+	for (const auto& prop : extra_props.properties())
+		map_extra_props[prop.key] = prop.value;
+
+	// Now create map objects, in the right order. Each object is created from a
+	// temporary parse tree node of its block's properties
+	using ObjectType  = UDMFMapCache::ObjectType;
+	auto read_objects = [&](const vector<TextmapBlock>& blocks, ObjectType type, string_view type_name, float progress) {
+		for (unsigned a = 0; a < blocks.size(); a++)
+		{
+			ui::setSplashProgress(progress + ((float)a / blocks.size()) * 0.2f);
+
+			ParseTreeNode def;
+			TextmapToken  name, value;
+			reader.seek(blocks[a].start);
+			while (reader.position() < blocks[a].end && reader.next(name) && !name.is('}'))
+			{
+				readAssignment(reader, name, value);
+				def.addChildPTN(strutil::lower(name.text))->addValue(tokenValue(value));
+			}
+
+			if (cache)
+				cache->addObject(type, def);
+
+			if (!createObject(type, &def, map_data))
+				log::warning("Invalid UDMF {} definition {}, not added", type_name, a);
+		}
+	};
+
+	// Create vertices
+	ui::setSplashProgressMessage("Reading Vertices");
+	read_objects(blocks_vertices, ObjectType::Vertex, "vertex", 0.0f);
+
+	// Create sectors
+	ui::setSplashProgressMessage("Reading Sectors");
+	read_objects(blocks_sectors, ObjectType::Sector, "sector", 0.2f);
+
+	// Create sides
+	ui::setSplashProgressMessage("Reading Sides");
+	read_objects(blocks_sides, ObjectType::Side, "side", 0.4f);
+
+	// Create lines
+	ui::setSplashProgressMessage("Reading Lines");
+	read_objects(blocks_lines, ObjectType::Line, "line", 0.6f);
+
+	// Create things
+	ui::setSplashProgressMessage("Reading Things");
+	read_objects(blocks_things, ObjectType::Thing, "thing", 0.8f);
+
+	// Write cache file for next time
+	if (cache)
+		cache->save(udmf_namespace_, extra_props);
+
+	ui::setSplashProgressMessage("Init map data");
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each texture name in UDMF TEXTMAP [data]. [flat] is true for
+// sector floor/ceiling textures and false for sidedef textures.
+// Reads the data directly (tokens only, no parse tree), skipping anything that
+// isn't a valid assignment
+// -----------------------------------------------------------------------------
+void UniversalDoomMapFormat::readTextureNames(
+	const MemChunk&                                data,
+	const std::function<void(string_view, bool)>& func)
+{
+	TextmapReader reader(reinterpret_cast<const char*>(data.data()), data.size());
+	TextmapToken  name, token, prop, value;
+	while (reader.next(name))
+	{
+		// Skip anything outside of blocks
+		auto position = reader.position();
+		if (!reader.next(token) || !token.is('{'))
+		{
+			reader.seek(position);
+			continue;
+		}
+
+		bool side   = strutil::equalCI(name.text, "sidedef");
+		bool sector = strutil::equalCI(name.text, "sector");
+		while (reader.next(token) && !token.is('}'))
+		{
+			if (!token.is('='))
+			{
+				prop = token;
+				continue;
+			}
+
+			// Read value
+			if (!reader.next(value) || value.is('}'))
+				break;
+			if (prop.quoted || value.isSpecial())
+				continue;
+
+			if (side
+				&& (strutil::equalCI(prop.text, "texturetop") || strutil::equalCI(prop.text, "texturemiddle")
+					|| strutil::equalCI(prop.text, "texturebottom")))
+				func(value.quoted ? property::asString(tokenValue(value)) : string{ value.text }, false);
+			else if (
+				sector && (strutil::equalCI(prop.text, "texturefloor") || strutil::equalCI(prop.text, "textureceiling")))
+				func(value.quoted ? property::asString(tokenValue(value)) : string{ value.text }, true);
+		}
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Writes the given [map_data] to UDMF format, returning the list of entries
 // making up the map
@@ -240,81 +723,39 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 	tempfile.Write(map_extra_props.toString(true));
 	tempfile.Write("\n");
 
-	// sf::Clock clock;
-
 	// Locale for float number format
 	setlocale(LC_NUMERIC, "C");
 
-	// Write things
-	string object_def;
+	// Cleanup object properties (this is done first since it isn't safe to do
+	// from multiple threads)
 	for (const auto& thing : map_data.things())
-	{
-		// Cleanup properties
 		if (!thing->props().empty())
 		{
 			thing->props().remove("flags");
 			game::configuration().cleanObjectUDMFProps(thing);
 		}
-
-		thing->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing things took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write lines
-	// clock.restart();
 	for (const auto& line : map_data.lines())
-	{
-		// Cleanup properties
 		if (!line->props().empty())
 		{
 			line->props().remove("flags");
 			game::configuration().cleanObjectUDMFProps(line);
 		}
-
-		line->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing lines took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sides
-	// clock.restart();
 	for (const auto& side : map_data.sides())
-	{
-		// Cleanup properties
 		if (!side->props().empty())
 			game::configuration().cleanObjectUDMFProps(side);
-
-		side->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sides took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write vertices
-	// clock.restart();
 	for (const auto& vertex : map_data.vertices())
-	{
-		// Cleanup properties
 		if (!vertex->props().empty())
 			game::configuration().cleanObjectUDMFProps(vertex);
-
-		vertex->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing vertices took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sectors
-	// clock.restart();
 	for (const auto& sector : map_data.sectors())
-	{
-		// Cleanup properties
 		if (!sector->props().empty())
 			game::configuration().cleanObjectUDMFProps(sector);
 
-		sector->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sectors took %dms", clock.getElapsedTime().asMilliseconds());
+	// Write objects
+	writeObjects(map_data.things(), tempfile);
+	writeObjects(map_data.lines(), tempfile);
+	writeObjects(map_data.sides(), tempfile);
+	writeObjects(map_data.vertices(), tempfile);
+	writeObjects(map_data.sectors(), tempfile);
 
 	// Close file
 	tempfile.Close();
@@ -325,6 +766,58 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 	return entries;
 }
 
+// -----------------------------------------------------------------------------
+// Creates an object of [type] from parsed UDMF definition [def] and adds it to
+// [map_data]. Returns false if the definition is invalid
+// -----------------------------------------------------------------------------
+bool UniversalDoomMapFormat::createObject(
+	UDMFMapCache::ObjectType type,
+	ParseTreeNode*           def,
+	MapObjectCollection&     map_data) const
+{
+	switch (type)
+	{
+	case UDMFMapCache::ObjectType::Vertex:
+		if (auto vertex = createVertex(def))
+		{
+			map_data.addVertex(std::move(vertex));
+			return true;
+		}
+		break;
+	case UDMFMapCache::ObjectType::Sector:
+		if (auto sector = createSector(def))
+		{
+			map_data.addSector(std::move(sector));
+			return true;
+		}
+		break;
+	case UDMFMapCache::ObjectType::Side:
+		if (auto side = createSide(def, map_data))
+		{
+			map_data.addSide(std::move(side));
+			return true;
+		}
+		break;
+	case UDMFMapCache::ObjectType::Line:
+		if (auto line = createLine(def, map_data))
+		{
+			map_data.addLine(std::move(line));
+			return true;
+		}
+		break;
+	case UDMFMapCache::ObjectType::Thing:
+		if (auto thing = createThing(def))
+		{
+			map_data.addThing(std::move(thing));
+			return true;
+		}
+		break;
+	default: break;
+	}
+
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Creates and returns a vertex from parsed UDMF definition [def]
 // -----------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapFormatHandler.h"
+#include "UDMFMapCache.h"
 
 namespace slade
 {
@@ -22,9 +23,18 @@ public:
 	string udmfNamespace() const override { return udmf_namespace_; }
 	void   setUDMFNamespace(string_view ns) override { udmf_namespace_ = ns; }
 
+	static void readTextureNames(const MemChunk& data, const std::function<void(string_view, bool)>& func);
+
 private:
 	string udmf_namespace_;
 
+	bool readTextmap(
+		const MemChunk&      data,
+		MapObjectCollection& map_data,
+		PropertyList&        map_extra_props,
+		UDMFMapCache*        cache = nullptr);
+	bool createObject(UDMFMapCache::ObjectType type, ParseTreeNode* def, MapObjectCollection& map_data) const;
+
 	unique_ptr<MapVertex> createVertex(ParseTreeNode* def) const;
 	unique_ptr<MapSector> createSector(ParseTreeNode* def) const;
 	unique_ptr<MapSide>   createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const;
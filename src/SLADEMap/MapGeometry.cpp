@@ -0,0 +1,135 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapGeometry.cpp
+// Description: MapGeometry class. A contiguous (struct-of-arrays) copy of the
+//              vertex positions and line vertices/bounding boxes of a map,
+//              kept in sync with the map's objects
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapGeometry.h"
+#include "MapObjectList/LineList.h"
+#include "MapObjectList/VertexList.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// MapGeometry Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Marks [vertex] as (about to be) modified, so its position is updated on the
+// next update()
+// -----------------------------------------------------------------------------
+void MapGeometry::vertexModified(MapVertex* vertex)
+{
+	if (!rebuild_)
+		dirty_vertices_.push_back(vertex);
+}
+
+// -----------------------------------------------------------------------------
+// Marks [line] as (about to be) modified, so its vertices and bounding box are
+// updated on the next update()
+// -----------------------------------------------------------------------------
+void MapGeometry::lineModified(MapLine* line)
+{
+	if (!rebuild_)
+		dirty_lines_.push_back(line);
+}
+
+// -----------------------------------------------------------------------------
+// Brings the geometry up to date with [vertices] and [lines], rebuilding it
+// fully if needed or otherwise updating any modified vertices and lines
+// -----------------------------------------------------------------------------
+void MapGeometry::update(const VertexList& vertices, const LineList& lines)
+{
+	if (rebuild_)
+	{
+		const auto n_vertices = vertices.size();
+		vertex_x_.resize(n_vertices);
+		vertex_y_.resize(n_vertices);
+		for (unsigned a = 0; a < n_vertices; ++a)
+		{
+			vertex_x_[a] = vertices[a]->xPos();
+			vertex_y_[a] = vertices[a]->yPos();
+		}
+
+		const auto n_lines = lines.size();
+		line_v1_.resize(n_lines);
+		line_v2_.resize(n_lines);
+		line_bbox_.resize(n_lines);
+		for (unsigned a = 0; a < n_lines; ++a)
+			updateLine(a, lines[a]);
+
+		rebuild_ = false;
+		dirty_vertices_.clear();
+		dirty_lines_.clear();
+		return;
+	}
+
+	// Update modified vertices (that are still in the map)
+	for (auto vertex : dirty_vertices_)
+	{
+		const auto index = vertex->index();
+		if (index < vertices.size() && vertices[index] == vertex)
+		{
+			vertex_x_[index] = vertex->xPos();
+			vertex_y_[index] = vertex->yPos();
+		}
+	}
+	dirty_vertices_.clear();
+
+	// Update modified lines (that are still in the map)
+	for (auto line : dirty_lines_)
+	{
+		const auto index = line->index();
+		if (index < lines.size() && lines[index] == line)
+			updateLine(index, line);
+	}
+	dirty_lines_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the vertex indices and bounding box of [line] at [index]
+// -----------------------------------------------------------------------------
+void MapGeometry::updateLine(unsigned index, const MapLine* line)
+{
+	line_v1_[index] = line->v1Index();
+	line_v2_[index] = line->v2Index();
+
+	auto& bbox = line_bbox_[index];
+	bbox.reset();
+	if (line->v1())
+		bbox.extend(line->v1()->xPos(), line->v1()->yPos());
+	if (line->v2())
+		bbox.extend(line->v2()->xPos(), line->v2()->yPos());
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace slade
+{
+class MapVertex;
+class MapLine;
+class VertexList;
+class LineList;
+
+// A contiguous (struct-of-arrays) copy of the basic geometry of a map's
+// vertices and lines, indexed the same as the vertex and line lists, for tight
+// loops over all vertices/lines (eg. rendering, checks) that would otherwise
+// have to go through scattered MapVertex/MapLine objects.
+//
+// Modified vertices/lines are updated individually, anything that changes the
+// lists or object indices causes a full rebuild, when the geometry is next
+// requested via update()
+class MapGeometry
+{
+public:
+	MapGeometry()  = default;
+	~MapGeometry() = default;
+
+	unsigned nVertices() const { return vertex_x_.size(); }
+	unsigned nLines() const { return line_v1_.size(); }
+
+	const vector<double>& vertexX() const { return vertex_x_; }
+	const vector<double>& vertexY() const { return vertex_y_; }
+	const vector<int>&    lineV1() const { return line_v1_; }
+	const vector<int>&    lineV2() const { return line_v2_; }
+	const vector<BBox>&   lineBBox() const { return line_bbox_; }
+
+	void invalidate() { rebuild_ = true; }
+	void vertexModified(MapVertex* vertex);
+	void lineModified(MapLine* line);
+
+	void update(const VertexList& vertices, const LineList& lines);
+
+private:
+	vector<double> vertex_x_;
+	vector<double> vertex_y_;
+	vector<int>    line_v1_; // Vertex index, -1 if none
+	vector<int>    line_v2_;
+	vector<BBox>   line_bbox_;
+
+	bool               rebuild_ = true;
+	vector<MapVertex*> dirty_vertices_;
+	vector<MapLine*>   dirty_lines_;
+
+	void updateLine(unsigned index, const MapLine* line);
+};
+} // namespace slade
@@ -44,6 +44,10 @@ public:
 	MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTreeNode* udmf_def);
 	~MapLine() = default;
 
+	// Allocated from a pool, see MapObjectPool
+	static void* operator new(size_t size) { return MapObjectPool<MapLine>::allocate(size); }
+	static void  operator delete(void* ptr, size_t size) { MapObjectPool<MapLine>::deallocate(ptr, size); }
+
 	bool isOk() const { return vertex1_ && vertex2_; }
 
 	MapVertex*    v1() const { return vertex1_; }
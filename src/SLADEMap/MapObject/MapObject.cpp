@@ -104,6 +104,10 @@ void MapObject::setModified()
 	}
 
 	modified_time_ = app::runTimer();
+
+	// Let the map know, so it can update any lookups using the object's position
+	if (parent_map_)
+		parent_map_->objectModified(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -125,8 +129,12 @@ void MapObject::copy(MapObject* c)
 	if (!c->properties_.empty())
 	{
 		properties_ = c->properties_;
-		parent_map_ = c->parent_map_;
 		filtered_   = c->filtered_;
+
+		// Keep the current parent map if there is one, so modifications are
+		// still reported to it
+		if (!parent_map_)
+			parent_map_ = c->parent_map_;
 	}
 }
 
@@ -4,6 +4,8 @@
 #pragma clang diagnostic ignored "-Wundefined-bool-conversion"
 #endif
 
+#include "General/AllocTracker.h"
+#include "MapObjectPool.h"
 #include "Utility/Property.h"
 #include <array>
 
@@ -19,7 +21,7 @@ class MapLine;
 class MapSector;
 class MapThing;
 
-class MapObject
+class MapObject : alloctracker::Counted<MapObject, alloctracker::Type::MapObject>
 {
 	friend class SLADEMap;
 	friend class MapObjectCollection;
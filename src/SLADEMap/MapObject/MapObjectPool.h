@@ -0,0 +1,116 @@
+#pragma once
+
+#include <mutex>
+
+namespace slade
+{
+// A pool allocator for map objects of type T. Objects are allocated from
+// large contiguous slabs rather than individually, which is much quicker when
+// loading (and closing) large maps, and avoids fragmenting the heap. Freed
+// objects are reused for later allocations, and slabs are only released once
+// every object in the pool has been freed (see releaseUnused).
+//
+// Map object classes use this via class-specific operator new/delete, so it
+// works with the usual std::make_unique/unique_ptr ownership
+template<class T> class MapObjectPool
+{
+public:
+	// Allocates memory for a single T (or anything else of [size] normally)
+	static void* allocate(size_t size)
+	{
+		if (size != sizeof(T))
+			return ::operator new(size);
+
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+		if (!pool.free_)
+			pool.addSlab(SLAB_SIZE);
+
+		auto block = pool.free_;
+		pool.free_ = block->next;
+		--pool.n_free_;
+		++pool.n_allocated_;
+
+		return block;
+	}
+
+	// Frees memory at [ptr] previously allocated with allocate([size])
+	static void deallocate(void* ptr, size_t size)
+	{
+		if (!ptr)
+			return;
+
+		if (size != sizeof(T))
+		{
+			::operator delete(ptr);
+			return;
+		}
+
+		auto&           pool  = instance();
+		std::lock_guard lock(pool.mutex_);
+		auto            block = static_cast<Block*>(ptr);
+		block->next           = pool.free_;
+		pool.free_            = block;
+		++pool.n_free_;
+		--pool.n_allocated_;
+	}
+
+	// Ensures at least [count] objects can be allocated without needing to
+	// add more slabs (eg. before loading a map with a known number of objects)
+	static void reserve(size_t count)
+	{
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+		if (count > pool.n_free_)
+			pool.addSlab(std::max<size_t>(count - pool.n_free_, SLAB_SIZE));
+	}
+
+	// Releases all slabs if no objects are currently allocated from the pool
+	static void releaseUnused()
+	{
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+		if (pool.n_allocated_ > 0)
+			return;
+
+		pool.slabs_.clear();
+		pool.free_   = nullptr;
+		pool.n_free_ = 0;
+	}
+
+private:
+	static constexpr size_t SLAB_SIZE = 1024; // Default number of objects per slab
+
+	union Block
+	{
+		Block* next;
+		alignas(T) unsigned char data[sizeof(T)];
+	};
+
+	std::mutex                  mutex_;
+	vector<unique_ptr<Block[]>> slabs_;
+	Block*                      free_        = nullptr;
+	size_t                      n_free_      = 0;
+	size_t                      n_allocated_ = 0;
+
+	// The pool is intentionally never destroyed, since map objects may still
+	// be freed during static destruction
+	static MapObjectPool& instance()
+	{
+		static auto* pool = new MapObjectPool();
+		return *pool;
+	}
+
+	void addSlab(size_t count)
+	{
+		slabs_.push_back(std::make_unique<Block[]>(count));
+		auto slab = slabs_.back().get();
+		for (size_t i = count; i > 0; --i)
+		{
+			slab[i - 1].next = free_;
+			free_            = &slab[i - 1];
+		}
+		n_free_ += count;
+	}
+};
+} // namespace slade
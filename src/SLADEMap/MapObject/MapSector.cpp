@@ -33,6 +33,7 @@
 #include "MapSector.h"
 #include "App.h"
 #include "Game/Configuration.h"
+#include "General/ThreadPool.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/Parser.h"
@@ -360,6 +361,10 @@ Vec2d MapSector::getPoint(Point point)
 // -----------------------------------------------------------------------------
 void MapSector::updateBBox()
 {
+	// Let the map know, so it can update the overall map bounds
+	if (parent_map_)
+		parent_map_->sectors().bboxChanging(this, bbox_);
+
 	// Reset bounding box
 	bbox_.reset();
 
@@ -376,6 +381,22 @@ void MapSector::updateBBox()
 	setGeometryUpdated();
 }
 
+// -----------------------------------------------------------------------------
+// Resets the sector bounding box, to be recalculated when next needed
+// -----------------------------------------------------------------------------
+void MapSector::resetBBox()
+{
+	// Let the map know the sector needs updating in its position lookup grid
+	// and the overall map bounds
+	if (parent_map_)
+	{
+		parent_map_->sectors().bboxChanging(this, bbox_);
+		parent_map_->sectors().bboxReset(this);
+	}
+
+	bbox_.reset();
+}
+
 // -----------------------------------------------------------------------------
 // Returns the sector bounding box
 // -----------------------------------------------------------------------------
@@ -546,6 +567,18 @@ bool MapSector::putVertices(vector<MapObject*>& list)
 // Returns the light level of the sector at [where] - 1 = floor, 2 = ceiling
 // -----------------------------------------------------------------------------
 uint8_t MapSector::lightAt(int where)
+{
+	if (!updateLightCache())
+		return calcLightAt(where);
+
+	return light_cache_.light[where == 1 || where == 2 ? where : 0];
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the light level of the sector at [where] - 1 = floor,
+// 2 = ceiling (uncached)
+// -----------------------------------------------------------------------------
+uint8_t MapSector::calcLightAt(int where)
 {
 	// Check for UDMF + flat lighting
 	if (parent_map_->currentFormat() == MapFormat::UDMF
@@ -636,6 +669,19 @@ void MapSector::changeLight(int amount, int where)
 // If [fullbright] is true, light level is ignored
 // -----------------------------------------------------------------------------
 ColRGBA MapSector::colourAt(int where, bool fullbright)
+{
+	if (!updateLightCache())
+		return calcColourAt(where, fullbright);
+
+	int index = where == 1 || where == 2 ? where : 0;
+	return fullbright ? light_cache_.colour_fullbright[index] : light_cache_.colour[index];
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the colour of the sector at [where] - 1 = floor, 2 = ceiling
+// (uncached). If [fullbright] is true, light level is ignored
+// -----------------------------------------------------------------------------
+ColRGBA MapSector::calcColourAt(int where, bool fullbright)
 {
 	using game::UDMFFeature;
 
@@ -742,6 +788,17 @@ ColRGBA MapSector::colourAt(int where, bool fullbright)
 // Returns the fog colour of the sector
 // -----------------------------------------------------------------------------
 ColRGBA MapSector::fogColour()
+{
+	if (!updateLightCache())
+		return calcFogColour();
+
+	return light_cache_.fog;
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the fog colour of the sector (uncached)
+// -----------------------------------------------------------------------------
+ColRGBA MapSector::calcFogColour()
 {
 	ColRGBA color(0, 0, 0, 0);
 
@@ -764,6 +821,36 @@ ColRGBA MapSector::fogColour()
 	return color;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the cached light levels and colours of the sector if the sector, map
+// specials (tag colours) or game configuration have changed since they were
+// last cached. The cache can't be updated from a worker thread, so returns
+// false if it is out of date there (the values should be calculated directly)
+// -----------------------------------------------------------------------------
+bool MapSector::updateLightCache()
+{
+	// Check if up to date (the cache is only trusted if updated after any change,
+	// not within the same timer tick)
+	auto time = light_cache_.updated_time;
+	if (time > modified_time_ && time > parent_map_->mapSpecials()->coloursUpdatedTime()
+		&& time > game::configuration().readTime())
+		return true;
+
+	if (threadpool::isWorkerThread())
+		return false;
+
+	for (int where = 0; where < 3; ++where)
+	{
+		light_cache_.light[where]             = calcLightAt(where);
+		light_cache_.colour[where]            = calcColourAt(where, false);
+		light_cache_.colour_fullbright[where] = calcColourAt(where, true);
+	}
+	light_cache_.fog          = calcFogColour();
+	light_cache_.updated_time = app::runTimer();
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Finds the 'text point' for the sector. This is a point within the sector that
 // is reasonably close to the middle of the sector bbox while still being within
@@ -829,7 +916,7 @@ void MapSector::connectSide(MapSide* side)
 	setModified();
 	connected_sides_.push_back(side);
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -849,7 +936,7 @@ void MapSector::disconnectSide(MapSide* side)
 	}
 
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -858,8 +945,8 @@ void MapSector::disconnectSide(MapSide* side)
 // -----------------------------------------------------------------------------
 void MapSector::writeBackup(Backup* backup)
 {
-	backup->props_internal[PROP_TEXFLOOR]      = floor_.texture;
-	backup->props_internal[PROP_TEXCEILING]    = ceiling_.texture;
+	backup->props_internal[PROP_TEXFLOOR]      = floor_.texture.name();
+	backup->props_internal[PROP_TEXCEILING]    = ceiling_.texture.name();
 	backup->props_internal[PROP_HEIGHTFLOOR]   = floor_.height;
 	backup->props_internal[PROP_HEIGHTCEILING] = ceiling_.height;
 	backup->props_internal[PROP_LIGHTLEVEL]    = light_;
@@ -892,7 +979,7 @@ void MapSector::readBackup(Backup* backup)
 
 	// Update geometry info
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapObject.h"
+#include "TextureName.h"
 #include "Utility/Colour.h"
 #include "Utility/Polygon2D.h"
 
@@ -10,6 +11,7 @@ class MapSector : public MapObject
 {
 	friend class SLADEMap;
 	friend class MapSide;
+	friend class SectorList;
 
 public:
 	enum SurfaceType
@@ -20,9 +22,9 @@ public:
 
 	struct Surface
 	{
-		string texture;
-		int    height = 0;
-		Plane  plane  = { 0., 0., 1., 0. };
+		TextureName texture;
+		int         height = 0;
+		Plane       plane  = { 0., 0., 1., 0. };
 
 		Surface(string_view texture = "", int height = 0, const Plane& plane = { 0., 0., 1., 0. }) :
 			texture{ texture },
@@ -52,6 +54,10 @@ public:
 	MapSector(string_view f_tex, string_view c_tex, ParseTreeNode* udmf_def);
 	~MapSector() = default;
 
+	// Allocated from a pool, see MapObjectPool
+	static void* operator new(size_t size) { return MapObjectPool<MapSector>::allocate(size); }
+	static void  operator delete(void* ptr, size_t size) { MapObjectPool<MapSector>::deallocate(ptr, size); }
+
 	void copy(MapObject* obj) override;
 
 	const Surface& floor() const { return floor_; }
@@ -83,11 +89,13 @@ public:
 	template<SurfaceType p> void  setPlane(const Plane& plane);
 
 	Vec2d             getPoint(Point point) override;
-	void              resetBBox() { bbox_.reset(); }
+	void              resetBBox();
 	BBox              boundingBox();
 	vector<MapSide*>& connectedSides() { return connected_sides_; }
 	void              resetPolygon() { poly_needsupdate_ = true; }
+	bool              polygonNeedsUpdate() const { return poly_needsupdate_; }
 	Polygon2D*        polygon();
+	size_t            polygonMemoryUsage() const { return polygon_.memoryUsage(); }
 	bool              containsPoint(Vec2d point);
 	double            distanceTo(Vec2d point, double maxdist = -1);
 	bool              putLines(vector<MapLine*>& list);
@@ -97,6 +105,7 @@ public:
 	void              changeLight(int amount, int where = 0);
 	ColRGBA           colourAt(int where = 0, bool fullbright = false);
 	ColRGBA           fogColour();
+	bool              updateLightCache();
 	long              geometryUpdatedTime() const { return geometry_updated_; }
 	void              findTextPoint();
 
@@ -135,7 +144,22 @@ private:
 	long             geometry_updated_ = 0;
 	Vec2d            text_point_;
 
-	void setGeometryUpdated();
+	// Cached results of lightAt, colourAt and fogColour for each of
+	// 0 (general), 1 (floor) and 2 (ceiling)
+	struct LightCache
+	{
+		long    updated_time = -1; // -1 if never updated
+		uint8_t light[3]     = { 0, 0, 0 };
+		ColRGBA colour[3];
+		ColRGBA colour_fullbright[3];
+		ColRGBA fog;
+	};
+	LightCache light_cache_;
+
+	void    setGeometryUpdated();
+	uint8_t calcLightAt(int where);
+	ColRGBA calcColourAt(int where, bool fullbright);
+	ColRGBA calcFogColour();
 };
 
 // Note: these MUST be inline, or the linker will complain
@@ -336,9 +336,9 @@ void MapSide::writeBackup(Backup* backup)
 		backup->props_internal[PROP_SECTOR] = 0;
 
 	// Textures
-	backup->props_internal[PROP_TEXUPPER]  = tex_upper_;
-	backup->props_internal[PROP_TEXMIDDLE] = tex_middle_;
-	backup->props_internal[PROP_TEXLOWER]  = tex_lower_;
+	backup->props_internal[PROP_TEXUPPER]  = tex_upper_.name();
+	backup->props_internal[PROP_TEXMIDDLE] = tex_middle_.name();
+	backup->props_internal[PROP_TEXLOWER]  = tex_lower_.name();
 
 	// Offsets
 	backup->props_internal[PROP_OFFSETX] = tex_offset_.x;
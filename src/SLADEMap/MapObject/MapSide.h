@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapObject.h"
+#include "TextureName.h"
 
 namespace slade
 {
@@ -30,19 +31,23 @@ public:
 	MapSide(MapSector* sector, ParseTreeNode* udmf_def);
 	~MapSide() = default;
 
+	// Allocated from a pool, see MapObjectPool
+	static void* operator new(size_t size) { return MapObjectPool<MapSide>::allocate(size); }
+	static void  operator delete(void* ptr, size_t size) { MapObjectPool<MapSide>::deallocate(ptr, size); }
+
 	void copy(MapObject* c) override;
 
 	bool isOk() const { return !!sector_; }
 
-	MapSector*    sector() const { return sector_; }
-	MapLine*      parentLine() const { return parent_; }
-	const string& texUpper() const { return tex_upper_; }
-	const string& texMiddle() const { return tex_middle_; }
-	const string& texLower() const { return tex_lower_; }
-	short         texOffsetX() const { return tex_offset_.x; }
-	short         texOffsetY() const { return tex_offset_.y; }
-	Vec2i         texOffset() const { return tex_offset_; }
-	uint8_t       light();
+	MapSector*         sector() const { return sector_; }
+	MapLine*           parentLine() const { return parent_; }
+	const TextureName& texUpper() const { return tex_upper_; }
+	const TextureName& texMiddle() const { return tex_middle_; }
+	const TextureName& texLower() const { return tex_lower_; }
+	short              texOffsetX() const { return tex_offset_.x; }
+	short              texOffsetY() const { return tex_offset_.y; }
+	Vec2i              texOffset() const { return tex_offset_; }
+	uint8_t            light();
 
 	void setSector(MapSector* sector);
 	void changeLight(int amount);
@@ -65,11 +70,11 @@ public:
 
 private:
 	// Basic data
-	MapSector* sector_     = nullptr;
-	MapLine*   parent_     = nullptr;
-	string     tex_upper_  = "-";
-	string     tex_middle_ = "-";
-	string     tex_lower_  = "-";
-	Vec2i      tex_offset_ = { 0, 0 };
+	MapSector*  sector_     = nullptr;
+	MapLine*    parent_     = nullptr;
+	TextureName tex_upper_{ TEX_NONE };
+	TextureName tex_middle_{ TEX_NONE };
+	TextureName tex_lower_{ TEX_NONE };
+	Vec2i       tex_offset_ = { 0, 0 };
 };
 } // namespace slade
@@ -35,6 +35,10 @@ public:
 	MapThing(const Vec3d& pos, short type, ParseTreeNode* def);
 	~MapThing() = default;
 
+	// Allocated from a pool, see MapObjectPool
+	static void* operator new(size_t size) { return MapObjectPool<MapThing>::allocate(size); }
+	static void  operator delete(void* ptr, size_t size) { MapObjectPool<MapThing>::deallocate(ptr, size); }
+
 	double        xPos() const { return position_.x; }
 	double        yPos() const { return position_.y; }
 	double        zPos() const { return z_; }
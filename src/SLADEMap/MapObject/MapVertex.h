@@ -19,6 +19,10 @@ public:
 	MapVertex(const Vec2d& pos, ParseTreeNode* udmf_def);
 	~MapVertex() = default;
 
+	// Allocated from a pool, see MapObjectPool
+	static void* operator new(size_t size) { return MapObjectPool<MapVertex>::allocate(size); }
+	static void  operator delete(void* ptr, size_t size) { MapObjectPool<MapVertex>::deallocate(ptr, size); }
+
 	double xPos() const { return position_.x; }
 	double yPos() const { return position_.y; }
 	Vec2d  position() const { return position_; }
@@ -0,0 +1,84 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureName.cpp
+// Description: TextureName class - an interned texture/flat name, so map
+//              objects share a single copy of each name and can compare names
+//              by pointer/id rather than by string
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureName.h"
+#include "Utility/StringUtils.h"
+#include <deque>
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureName Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the interned atom for [name], adding it if it doesn't exist yet
+// -----------------------------------------------------------------------------
+const TextureName::Atom* TextureName::intern(string_view name)
+{
+	// Atoms are never removed, and are stored in a deque so that pointers to
+	// them (and their names, used as the index keys) stay valid as it grows
+	static std::deque<Atom>                             atoms;
+	static std::unordered_map<string_view, const Atom*> index;
+	static std::mutex                                   mutex;
+
+	std::lock_guard lock(mutex);
+
+	if (auto i = index.find(name); i != index.end())
+		return i->second;
+
+	// Get the id of the upper case version of the name first (adding it if needed)
+	auto     upper = strutil::upper(name);
+	unsigned id_ci = static_cast<unsigned>(atoms.size());
+	if (upper != name)
+	{
+		auto i = index.find(upper);
+		if (i == index.end())
+		{
+			auto& atom_upper = atoms.emplace_back(Atom{ upper, id_ci, id_ci });
+			index[atom_upper.name] = &atom_upper;
+		}
+		else
+			id_ci = i->second->id;
+	}
+
+	auto& atom = atoms.emplace_back(Atom{ string{ name }, static_cast<unsigned>(atoms.size()), id_ci });
+	index[atom.name] = &atom;
+	return &atom;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+namespace slade
+{
+// An interned texture/flat name, as used by map sides and sectors.
+// Each distinct name is stored only once (in a global table, so that names are
+// shared between all maps and with objects not yet added to a map) and a
+// TextureName is just a pointer to it, so copying and comparing names doesn't
+// involve any string operations. Each name also has a numeric id, and an id
+// that is the same for all names that only differ by case, which can be used
+// as lookup keys (eg. by MapTextureManager).
+// Interning a name is thread-safe
+class TextureName
+{
+public:
+	TextureName(string_view name = {}) : atom_{ intern(name) } {}
+
+	TextureName& operator=(string_view name)
+	{
+		atom_ = intern(name);
+		return *this;
+	}
+
+	const string& name() const { return atom_->name; }
+	unsigned      id() const { return atom_->id; }
+	unsigned      idCI() const { return atom_->id_ci; }
+	bool          empty() const { return atom_->name.empty(); }
+	bool          equalCI(const TextureName& other) const { return atom_->id_ci == other.atom_->id_ci; }
+
+	operator const string&() const { return atom_->name; }
+	operator string_view() const { return atom_->name; }
+
+	bool operator==(const TextureName& other) const { return atom_ == other.atom_; }
+	bool operator!=(const TextureName& other) const { return atom_ != other.atom_; }
+
+private:
+	struct Atom
+	{
+		string   name;
+		unsigned id    = 0;
+		unsigned id_ci = 0; // Id of the upper case version of the name
+	};
+
+	const Atom* atom_;
+
+	static const Atom* intern(string_view name);
+};
+
+inline bool operator==(const TextureName& left, string_view right)
+{
+	return left.name() == right;
+}
+inline bool operator!=(const TextureName& left, string_view right)
+{
+	return left.name() != right;
+}
+inline bool operator==(string_view left, const TextureName& right)
+{
+	return left == right.name();
+}
+inline bool operator!=(string_view left, const TextureName& right)
+{
+	return left != right.name();
+}
+} // namespace slade
+
+// Formatter for fmt so that a TextureName can be written to a string
+namespace fmt
+{
+template<> struct formatter<slade::TextureName>
+{
+	template<typename ParseContext> constexpr auto parse(ParseContext& ctx) { return ctx.begin(); }
+	template<typename FormatContext> auto          format(const slade::TextureName& name, FormatContext& ctx)
+	{
+		return format_to(ctx.out(), "{}", name.name());
+	}
+};
+} // namespace fmt
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapObjectCollection.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "MapObject/MapLine.h"
 #include "MapObject/MapSector.h"
@@ -57,6 +58,7 @@ void MapObjectCollection::addMapObject(unique_ptr<MapObject> object)
 	object->obj_id_     = objects_.size();
 	object->parent_map_ = parent_map_;
 	objects_.emplace_back(std::move(object), true);
+	addJournalEntry(objects_.back().object.get());
 }
 
 // -----------------------------------------------------------------------------
@@ -66,6 +68,7 @@ void MapObjectCollection::addMapObject(unique_ptr<MapObject> object)
 void MapObjectCollection::removeMapObject(MapObject* object)
 {
 	objects_[object->obj_id_].in_map = false;
+	removed_time_                    = app::runTimer();
 }
 
 // -----------------------------------------------------------------------------
@@ -106,6 +109,10 @@ void MapObjectCollection::putObjectIdList(MapObject::Type type, vector<unsigned>
 // -----------------------------------------------------------------------------
 void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsigned>& list)
 {
+	removed_time_ = app::runTimer();
+	if (type == MapObject::Type::Vertex || type == MapObject::Type::Line)
+		geometry_.invalidate();
+
 	if (type == MapObject::Type::Vertex)
 	{
 		// Clear
@@ -188,6 +195,8 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 // -----------------------------------------------------------------------------
 void MapObjectCollection::refreshIndices()
 {
+	geometry_.invalidate();
+
 	// Vertex indices
 	for (unsigned a = 0; a < vertices_.size(); a++)
 		vertices_[a]->index_ = a;
@@ -215,6 +224,7 @@ void MapObjectCollection::refreshIndices()
 void MapObjectCollection::clear()
 {
 	// Clear lists
+	geometry_.invalidate();
 	sides_.clear();
 	lines_.clear();
 	vertices_.clear();
@@ -223,6 +233,17 @@ void MapObjectCollection::clear()
 
 	// Clear map objects
 	objects_.clear();
+	journal_.clear();
+	last_modified_time_ = 0;
+	snapshot_objects_.clear();
+	last_snapshot_.reset();
+
+	// Release pooled object memory (if no other maps are using it)
+	MapObjectPool<MapVertex>::releaseUnused();
+	MapObjectPool<MapSide>::releaseUnused();
+	MapObjectPool<MapLine>::releaseUnused();
+	MapObjectPool<MapSector>::releaseUnused();
+	MapObjectPool<MapThing>::releaseUnused();
 
 	// Object id 0 is always null
 	objects_.emplace_back(nullptr, false);
@@ -299,6 +320,7 @@ bool MapObjectCollection::removeVertex(unsigned index, bool merge_lines)
 	// Remove the vertex
 	removeMapObject(vertex);
 	vertices_.remove(index);
+	geometry_.invalidate();
 
 	if (parent_map_)
 		parent_map_->setGeometryUpdated();
@@ -346,6 +368,7 @@ bool MapObjectCollection::removeLine(unsigned index)
 	// Remove the line
 	removeMapObject(line);
 	lines_.remove(index);
+	geometry_.invalidate();
 
 	if (parent_map_)
 		parent_map_->setGeometryUpdated();
@@ -478,6 +501,96 @@ bool MapObjectCollection::removeThing(unsigned index)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the contiguous vertex/line geometry of the map, updating it first if
+// anything has changed
+// -----------------------------------------------------------------------------
+const MapGeometry& MapObjectCollection::geometry() const
+{
+	geometry_.update(vertices_, lines_);
+	return geometry_;
+}
+
+// -----------------------------------------------------------------------------
+// Called when [object] is (about to be) modified, so its position and ids can
+// be updated in the relevant lookup grids/indexes when next needed
+// -----------------------------------------------------------------------------
+void MapObjectCollection::objectModified(MapObject* object)
+{
+	addJournalEntry(object);
+
+	switch (object->objType())
+	{
+	case MapObject::Type::Vertex:
+	{
+		auto vertex = dynamic_cast<MapVertex*>(object);
+		vertices_.vertexModified(vertex);
+		geometry_.vertexModified(vertex);
+
+		// Moving a vertex also moves any lines connected to it
+		for (auto line : vertex->connectedLines())
+		{
+			lines_.lineModified(line);
+			geometry_.lineModified(line);
+		}
+		break;
+	}
+	case MapObject::Type::Line:
+	{
+		auto line = dynamic_cast<MapLine*>(object);
+		lines_.lineModified(line);
+		lines_.lineIdsModified(line);
+		geometry_.lineModified(line);
+		break;
+	}
+	case MapObject::Type::Sector: sectors_.sectorIdsModified(dynamic_cast<MapSector*>(object)); break;
+	case MapObject::Type::Thing:
+	{
+		auto thing = dynamic_cast<MapThing*>(object);
+		things_.thingModified(thing);
+		things_.thingIdsModified(thing);
+		break;
+	}
+	default: break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reserves space for [count] more objects of [type] to be added (eg. when
+// reading a map where the number of objects is known up-front), so the object
+// lists don't need to be reallocated and the objects can be allocated from a
+// single pool slab while adding them
+// -----------------------------------------------------------------------------
+void MapObjectCollection::reserve(MapObject::Type type, unsigned count)
+{
+	objects_.reserve(objects_.size() + count);
+
+	switch (type)
+	{
+	case MapObject::Type::Vertex:
+		vertices_.reserve(vertices_.size() + count);
+		MapObjectPool<MapVertex>::reserve(count);
+		break;
+	case MapObject::Type::Side:
+		sides_.reserve(sides_.size() + count);
+		MapObjectPool<MapSide>::reserve(count);
+		break;
+	case MapObject::Type::Line:
+		lines_.reserve(lines_.size() + count);
+		MapObjectPool<MapLine>::reserve(count);
+		break;
+	case MapObject::Type::Sector:
+		sectors_.reserve(sectors_.size() + count);
+		MapObjectPool<MapSector>::reserve(count);
+		break;
+	case MapObject::Type::Thing:
+		things_.reserve(things_.size() + count);
+		MapObjectPool<MapThing>::reserve(count);
+		break;
+	default: break;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Adds [vertex] to the map
 // -----------------------------------------------------------------------------
@@ -485,6 +598,7 @@ MapVertex* MapObjectCollection::addVertex(unique_ptr<MapVertex> vertex)
 {
 	vertex->index_ = vertices_.size();
 	vertices_.add(vertex.get());
+	geometry_.invalidate();
 	addMapObject(std::move(vertex));
 	return vertices_.back();
 }
@@ -507,6 +621,7 @@ MapLine* MapObjectCollection::addLine(unique_ptr<MapLine> line)
 {
 	line->index_ = lines_.size();
 	lines_.add(line.get());
+	geometry_.invalidate();
 	addMapObject(std::move(line));
 	return lines_.back();
 }
@@ -555,6 +670,33 @@ vector<MapObject*> MapObjectCollection::modifiedObjects(long since, MapObject::T
 {
 	vector<MapObject*> modified_objects;
 
+	// Get modified objects from the change journal if possible
+	if (parent_map_)
+	{
+		for (auto* object : journalObjects(since, true))
+			if (objects_[object->obj_id_].in_map && (type == MapObject::Type::Object || object->type_ == type))
+				modified_objects.push_back(object);
+
+		// Sort by type (in the same order as below), then index
+		auto type_order = [](MapObject::Type object_type) {
+			switch (object_type)
+			{
+			case MapObject::Type::Vertex: return 0;
+			case MapObject::Type::Side: return 1;
+			case MapObject::Type::Line: return 2;
+			case MapObject::Type::Sector: return 3;
+			default: return 4;
+			}
+		};
+		std::sort(modified_objects.begin(), modified_objects.end(), [&](MapObject* left, MapObject* right) {
+			const auto order_left  = type_order(left->type_);
+			const auto order_right = type_order(right->type_);
+			return order_left != order_right ? order_left < order_right : left->index_ < right->index_;
+		});
+
+		return modified_objects;
+	}
+
 	if (type == MapObject::Type::Object || type == MapObject::Type::Vertex)
 		vertices_.putModifiedObjects(since, modified_objects);
 	if (type == MapObject::Type::Object || type == MapObject::Type::Side)
@@ -574,6 +716,9 @@ vector<MapObject*> MapObjectCollection::modifiedObjects(long since, MapObject::T
 // -----------------------------------------------------------------------------
 vector<MapObject*> MapObjectCollection::allModifiedObjects(long since) const
 {
+	if (parent_map_)
+		return journalObjects(since, true);
+
 	vector<MapObject*> modified_objects;
 
 	for (auto& holder : objects_)
@@ -590,6 +735,9 @@ vector<MapObject*> MapObjectCollection::allModifiedObjects(long since) const
 // -----------------------------------------------------------------------------
 long MapObjectCollection::lastModifiedTime() const
 {
+	if (parent_map_)
+		return last_modified_time_;
+
 	long mod_time = 0;
 
 	for (auto& holder : objects_)
@@ -606,6 +754,19 @@ long MapObjectCollection::lastModifiedTime() const
 // -----------------------------------------------------------------------------
 bool MapObjectCollection::modifiedSince(long since, MapObject::Type type) const
 {
+	// Check the change journal if possible
+	if (parent_map_)
+	{
+		if (type == MapObject::Type::Object)
+			return last_modified_time_ > since;
+
+		for (auto* object : journalObjects(since, false))
+			if (object->type_ == type && objects_[object->obj_id_].in_map)
+				return true;
+
+		return false;
+	}
+
 	switch (type)
 	{
 	case MapObject::Type::Object: return lastModifiedTime() > since;
@@ -618,6 +779,238 @@ bool MapObjectCollection::modifiedSince(long since, MapObject::Type type) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns an immutable snapshot of all objects currently in the map, that can
+// be read from other threads while the map continues to be edited.
+// Only objects modified since the last snapshot are copied, the rest are
+// shared with it (and if nothing has changed at all the last snapshot is
+// returned again). Must be called from the main thread
+// -----------------------------------------------------------------------------
+shared_ptr<const MapSnapshot> MapObjectCollection::snapshot()
+{
+	// Nothing modified, added or removed since the last snapshot
+	if (last_snapshot_ && parent_map_ && last_modified_time_ < last_snapshot_->time_
+		&& removed_time_ < last_snapshot_->time_)
+		return last_snapshot_;
+
+	auto snapshot   = std::make_shared<MapSnapshot>();
+	snapshot->time_ = app::runTimer();
+
+	auto update_object = [this](MapObject* object) {
+		auto backup = std::make_shared<MapObject::Backup>();
+		object->backupTo(backup.get());
+		snapshot_objects_[object->obj_id_] = std::move(backup);
+	};
+
+	// Update the backups of objects modified since the last snapshot (from the
+	// change journal), or all objects if there is no journal to go by
+	snapshot_objects_.resize(objects_.size());
+	if (last_snapshot_ && parent_map_)
+	{
+		for (auto* object : journalObjects(last_snapshot_->time_, true))
+			update_object(object);
+	}
+	else
+	{
+		for (auto& holder : objects_)
+			if (holder.object)
+				update_object(holder.object.get());
+	}
+
+	// Build the snapshot's object lists
+	snapshot->by_id_.resize(objects_.size());
+	auto add_objects = [&](const auto& map_objects, vector<MapSnapshot::Object>& list) {
+		list.reserve(map_objects.size());
+		for (auto* object : map_objects)
+		{
+			// An object added to the map after it was last modified won't be
+			// in the journal since the last snapshot
+			if (!snapshot_objects_[object->obj_id_])
+				update_object(object);
+
+			snapshot->by_id_[object->obj_id_] = { snapshot_objects_[object->obj_id_].get(), object->index_ };
+			list.push_back(snapshot_objects_[object->obj_id_]);
+		}
+	};
+	add_objects(vertices_, snapshot->vertices_);
+	add_objects(sides_, snapshot->sides_);
+	add_objects(lines_, snapshot->lines_);
+	add_objects(sectors_, snapshot->sectors_);
+	add_objects(things_, snapshot->things_);
+
+	last_snapshot_ = snapshot;
+	return snapshot;
+}
+
+// -----------------------------------------------------------------------------
+// Adds an entry for [object] (which has just been modified or added) to the
+// change journal
+// -----------------------------------------------------------------------------
+void MapObjectCollection::addJournalEntry(const MapObject* object)
+{
+	// Ignore objects not (yet) added
+	if (object->obj_id_ == 0)
+		return;
+
+	// Keep the journal in time order. An object being added may have been
+	// modified before the latest entry, but its entry can't be earlier than
+	// its modified time
+	auto time = object->modified_time_;
+	if (!journal_.empty() && journal_.back().time > time)
+		time = journal_.back().time;
+
+	// Consecutive modifications of the same object (eg. setting several of its
+	// properties) only need a single entry, at the latest time
+	if (!journal_.empty() && journal_.back().obj_id == object->obj_id_)
+		journal_.back().time = time;
+	else
+		journal_.push_back({ object->obj_id_, time });
+	last_modified_time_ = std::max(last_modified_time_, object->modified_time_);
+
+	// Don't let the journal grow too large compared to the number of objects
+	if (journal_.size() > objects_.size() * 4 + 1024)
+		compactJournal();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the change journal with only a single entry (at its last modified
+// time) for each object
+// -----------------------------------------------------------------------------
+void MapObjectCollection::compactJournal()
+{
+	journal_.clear();
+	for (auto& holder : objects_)
+		if (holder.object)
+			journal_.push_back({ holder.object->obj_id_, holder.object->modified_time_ });
+
+	std::stable_sort(journal_.begin(), journal_.end(), [](const JournalEntry& left, const JournalEntry& right) {
+		return left.time < right.time;
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Returns all objects with a modified time later than [since] (or the same as
+// it, if [inclusive] is true) from the change journal, in object id order
+// -----------------------------------------------------------------------------
+vector<MapObject*> MapObjectCollection::journalObjects(long since, bool inclusive) const
+{
+	// Find the first journal entry at or after [since]
+	auto entry = std::lower_bound(journal_.begin(), journal_.end(), since, [&](const JournalEntry& journal_entry, long time) {
+		return inclusive ? journal_entry.time < time : journal_entry.time <= time;
+	});
+
+	// Get ids of all objects with entries from there on
+	vector<unsigned> ids;
+	for (; entry != journal_.end(); ++entry)
+		ids.push_back(entry->obj_id);
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+	// Check the objects' actual modified times
+	vector<MapObject*> list;
+	for (auto id : ids)
+	{
+		auto* object = objects_[id].object.get();
+		if (object && (inclusive ? object->modified_time_ >= since : object->modified_time_ > since))
+			list.push_back(object);
+	}
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all detached vertices, sides and sectors and invalid sides (see the
+// individual remove functions below) in a single pass, refreshing object
+// indices only once at the end. Unlike the individual functions, this keeps
+// the remaining objects in their original order.
+// Returns the number of each type of object removed
+// -----------------------------------------------------------------------------
+MapObjectCollection::CleanupCounts MapObjectCollection::removeDetachedObjects()
+{
+	CleanupCounts counts;
+	refreshIndices();
+
+	// Determine sides to remove - any without a parent line (detached) or
+	// sector (invalid)
+	vector<uint8_t> remove_side(sides_.size(), 0);
+	for (auto side : sides_)
+	{
+		if (!side->parentLine())
+		{
+			remove_side[side->index_] = 1;
+			counts.detached_sides++;
+		}
+		else if (!side->sector())
+		{
+			remove_side[side->index_] = 1;
+			counts.invalid_sides++;
+		}
+	}
+
+	// Disconnect sides to be removed from their sectors and lines
+	for (auto side : sides_)
+	{
+		if (!remove_side[side->index_])
+			continue;
+
+		if (auto sector = side->sector())
+		{
+			auto& connected_sides = sector->connectedSides();
+			connected_sides.erase(
+				std::remove_if(
+					connected_sides.begin(),
+					connected_sides.end(),
+					[&remove_side](MapSide* cside) { return remove_side[cside->index_] != 0; }),
+				connected_sides.end());
+		}
+		else if (auto line = side->parentLine())
+		{
+			line->setModified();
+			if (line->s1() == side)
+				line->setS1(nullptr);
+			if (line->s2() == side)
+				line->setS2(nullptr);
+
+			// Set appropriate line flags
+			if (parent_map_)
+			{
+				game::configuration().setLineBasicFlag("blocking", line, parent_map_->currentFormat(), true);
+				game::configuration().setLineBasicFlag("twosided", line, parent_map_->currentFormat(), false);
+			}
+		}
+	}
+
+	// Remove everything in one go
+	counts.detached_vertices = vertices_.removeIf([this](MapVertex* vertex) {
+		if (vertex->nConnectedLines() > 0)
+			return false;
+
+		removeMapObject(vertex);
+		return true;
+	});
+	sides_.removeIf([this, &remove_side](MapSide* side) {
+		if (!remove_side[side->index_])
+			return false;
+
+		removeMapObject(side);
+		return true;
+	});
+	counts.detached_sectors = sectors_.removeIf([this](MapSector* sector) {
+		if (!sector->connectedSides().empty())
+			return false;
+
+		removeMapObject(sector);
+		return true;
+	});
+
+	if (counts.detached_vertices > 0 && parent_map_)
+		parent_map_->setGeometryUpdated();
+
+	refreshIndices();
+
+	return counts;
+}
+
 // -----------------------------------------------------------------------------
 // Removes any vertices not attached to any lines. Returns the number of
 // vertices removed
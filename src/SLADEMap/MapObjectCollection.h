@@ -1,11 +1,13 @@
 #pragma once
 
 #include "General/Defs.h"
+#include "MapGeometry.h"
 #include "MapObjectList/LineList.h"
 #include "MapObjectList/SectorList.h"
 #include "MapObjectList/SideList.h"
 #include "MapObjectList/ThingList.h"
 #include "MapObjectList/VertexList.h"
+#include "MapSnapshot.h"
 
 namespace slade
 {
@@ -26,6 +28,8 @@ public:
 	const SectorList& sectors() const { return sectors_; }
 	const ThingList&  things() const { return things_; }
 
+	const MapGeometry& geometry() const;
+
 	void setParentMap(SLADEMap* map) { parent_map_ = map; }
 
 	// MapObject id stuff (used for undo/redo)
@@ -37,8 +41,10 @@ public:
 
 	void refreshIndices();
 	void clear();
+	void objectModified(MapObject* object);
 
 	// Object add
+	void       reserve(MapObject::Type type, unsigned count);
 	MapVertex* addVertex(unique_ptr<MapVertex> vertex);
 	MapSide*   addSide(unique_ptr<MapSide> side);
 	MapLine*   addLine(unique_ptr<MapLine> line);
@@ -65,13 +71,25 @@ public:
 	vector<MapObject*> allModifiedObjects(long since) const;
 	long               lastModifiedTime() const;
 	bool               modifiedSince(long since, MapObject::Type type) const;
+	long               lastRemovedTime() const { return removed_time_; }
+
+	// Snapshots
+	shared_ptr<const MapSnapshot> snapshot();
 
 	// Checks
-	int removeDetachedVertices();
-	int removeDetachedSides();
-	int removeDetachedSectors();
-	int removeZeroLengthLines();
-	int removeInvalidSides();
+	struct CleanupCounts
+	{
+		int detached_vertices = 0;
+		int detached_sides    = 0;
+		int detached_sectors  = 0;
+		int invalid_sides     = 0;
+	};
+	CleanupCounts removeDetachedObjects();
+	int           removeDetachedVertices();
+	int           removeDetachedSides();
+	int           removeDetachedSectors();
+	int           removeZeroLengthLines();
+	int           removeInvalidSides();
 
 	// Cleanup/Extra
 	void rebuildConnectedLines();
@@ -86,12 +104,38 @@ private:
 		MapObjectHolder(unique_ptr<MapObject> object, bool in_map) : object{ std::move(object) }, in_map{ in_map } {}
 	};
 
+	// An entry in the change journal, recording that an object was modified
+	// (or added) at [time]
+	struct JournalEntry
+	{
+		unsigned obj_id;
+		long     time;
+	};
+
 	SLADEMap*               parent_map_ = nullptr;
 	vector<MapObjectHolder> objects_;
+	long                    removed_time_ = 0; // The last time any object was removed from (or restored to) the map
+
+	// Change journal, in time order. Every object modified at or after a time
+	// has an entry at or after that time, so modified objects can be found
+	// without checking every object. Only kept up to date if there is a parent
+	// map, since objects report modifications via their parent map
+	vector<JournalEntry> journal_;
+	long                 last_modified_time_ = 0;
 	VertexList              vertices_;
 	SideList                sides_;
 	LineList                lines_;
 	SectorList              sectors_;
 	ThingList               things_;
+	mutable MapGeometry     geometry_;
+
+	// Object backups (by id) as of the last snapshot, reused in the next
+	// snapshot for objects that weren't modified in the meantime
+	vector<MapSnapshot::Object>   snapshot_objects_;
+	shared_ptr<const MapSnapshot> last_snapshot_;
+
+	void               addJournalEntry(const MapObject* object);
+	void               compactJournal();
+	vector<MapObject*> journalObjects(long since, bool inclusive) const;
 };
 } // namespace slade
@@ -40,6 +40,126 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [line] has a special affecting objects of [type] with [id]
+// -----------------------------------------------------------------------------
+#define IDEQ(x) (((x) != 0) && ((x) == id))
+bool lineTagsId(const MapLine* line, int id, int type)
+{
+	using game::TagType;
+
+	int special = line->special();
+	if (!special)
+		return false;
+
+	int  tag  = line->arg(0);
+	int  arg2, arg3, arg4, arg5;
+	bool fits = false;
+	switch (game::configuration().actionSpecial(special).needsTag())
+	{
+	case TagType::Sector:
+	case TagType::SectorOrBack:
+	case TagType::SectorAndBack: fits = (IDEQ(tag) && type == SLADEMap::SECTORS); break;
+	case TagType::LineNegative: tag = abs(tag);
+	case TagType::Line: fits = (IDEQ(tag) && type == SLADEMap::LINEDEFS); break;
+	case TagType::Thing: fits = (IDEQ(tag) && type == SLADEMap::THINGS); break;
+	case TagType::Thing1Sector2:
+		arg2 = line->arg(1);
+		fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
+		break;
+	case TagType::Thing1Sector3:
+		arg3 = line->arg(2);
+		fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg3) && type == SLADEMap::SECTORS));
+		break;
+	case TagType::Thing1Thing2:
+		arg2 = line->arg(1);
+		fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2)));
+		break;
+	case TagType::Thing1Thing4:
+		arg4 = line->arg(3);
+		fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg4)));
+		break;
+	case TagType::Thing1Thing2Thing3:
+		arg2 = line->arg(1);
+		arg3 = line->arg(2);
+		fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3)));
+		break;
+	case TagType::Sector1Thing2Thing3Thing5:
+		arg2 = line->arg(1);
+		arg3 = line->arg(2);
+		arg5 = line->arg(4);
+		fits =
+			(type == SLADEMap::SECTORS ?
+				 (IDEQ(tag)) :
+				 (type == SLADEMap::THINGS && (IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg5))));
+		break;
+	case TagType::LineId1Line2:
+		arg2 = line->arg(1);
+		fits = (type == SLADEMap::LINEDEFS && IDEQ(arg2));
+		break;
+	case TagType::Thing4:
+		arg4 = line->arg(3);
+		fits = (type == SLADEMap::THINGS && IDEQ(arg4));
+		break;
+	case TagType::Thing5:
+		arg5 = line->arg(4);
+		fits = (type == SLADEMap::THINGS && IDEQ(arg5));
+		break;
+	case TagType::Line1Sector2:
+		arg2 = line->arg(1);
+		fits = (type == SLADEMap::LINEDEFS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
+		break;
+	case TagType::Sector1Sector2:
+		arg2 = line->arg(1);
+		fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2)));
+		break;
+	case TagType::Sector1Sector2Sector3Sector4:
+		arg2 = line->arg(1);
+		arg3 = line->arg(2);
+		arg4 = line->arg(3);
+		fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg4)));
+		break;
+	case TagType::Sector2Is3Line:
+		arg2 = line->arg(1);
+		fits = (IDEQ(tag) && (arg2 == 3 ? type == SLADEMap::LINEDEFS : type == SLADEMap::SECTORS));
+		break;
+	case TagType::Sector1Thing2:
+		arg2 = line->arg(1);
+		fits = (type == SLADEMap::SECTORS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::THINGS));
+		break;
+	default: break;
+	}
+	return fits;
+}
+#undef IDEQ
+
+// -----------------------------------------------------------------------------
+// Returns the keys to index [line] by in the arg index: its nonzero args, and
+// the absolute values of any negative args
+// -----------------------------------------------------------------------------
+vector<int> argKeys(const MapLine* line)
+{
+	vector<int> keys;
+	for (unsigned a = 0; a < 5; a++)
+	{
+		int arg = line->arg(a);
+		if (arg != 0)
+			keys.push_back(arg);
+		if (arg < 0)
+			keys.push_back(-arg);
+	}
+	return keys;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // LineList Class Functions
@@ -53,28 +173,29 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 MapLine* LineList::nearest(Vec2d point, double min) const
 {
-	// Go through lines
+	updateGrid();
+
+	// Go through lines near the point
 	double   dist;
 	double   min_dist = min;
 	MapLine* nearest  = nullptr;
-	for (const auto& line : objects_)
-	{
+	grid_.forEachNear(point, min, [&](MapLine* line) {
 		// Check with line bounding box first (since we have a minimum distance)
 		auto bbox = line->seg();
 		bbox.expand(min, min);
 		if (!bbox.contains(point))
-			continue;
+			return;
 
 		// Calculate distance to line
 		dist = line->distanceTo(point);
 
 		// Check if it's nearer than the previous nearest
-		if (dist < min_dist && dist < min)
+		if (dist < min_dist && dist < min || nearest && dist == min_dist && line->index() < nearest->index())
 		{
 			nearest  = line;
 			min_dist = dist;
 		}
-	}
+	});
 
 	return nearest;
 }
@@ -104,8 +225,8 @@ vector<Vec2d> LineList::cutPoints(const Seg2d& cutter) const
 	vector<Vec2d> intersect_points;
 	Vec2d         intersection;
 
-	// Go through map lines
-	for (const auto& line : objects_)
+	// Go through map lines that could cross the cutting line
+	for (const auto& line : allInBox({ cutter.left(), cutter.top() }, { cutter.right(), cutter.bottom() }))
 	{
 		// Check for intersection
 		intersection = cutter.start();
@@ -156,16 +277,41 @@ vector<Vec2d> LineList::cutPoints(const Seg2d& cutter) const
 	return intersect_points;
 }
 
+// -----------------------------------------------------------------------------
+// Returns all lines with a bounding box overlapping the box from [min] to
+// [max], in list order
+// -----------------------------------------------------------------------------
+vector<MapLine*> LineList::allInBox(Vec2d min, Vec2d max) const
+{
+	updateGrid();
+
+	vector<MapLine*> list;
+	grid_.forEachInBox(min, max, [&](MapLine* line) {
+		const auto seg = line->seg();
+		if (seg.right() >= min.x && seg.left() <= max.x && seg.bottom() >= min.y && seg.top() <= max.y)
+			list.push_back(line);
+	});
+
+	// Lines covering multiple grid cells may have been found more than once
+	std::sort(list.begin(), list.end(), [](MapLine* left, MapLine* right) { return left->index() < right->index(); });
+	list.erase(std::unique(list.begin(), list.end()), list.end());
+
+	return list;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the first line found with [id], or null if none found
 // -----------------------------------------------------------------------------
 MapLine* LineList::firstWithId(int id) const
 {
-	for (auto& line : objects_)
-		if (line->id() == id)
-			return line;
+	updateIdIndexes();
 
-	return nullptr;
+	MapLine* first = nullptr;
+	for (auto line : id_index_.objects(id))
+		if (!first || line->index() < first->index())
+			first = line;
+
+	return first;
 }
 
 // -----------------------------------------------------------------------------
@@ -173,9 +319,10 @@ MapLine* LineList::firstWithId(int id) const
 // -----------------------------------------------------------------------------
 void LineList::putAllWithId(int id, vector<MapLine*>& list) const
 {
-	for (auto& line : objects_)
-		if (line->id() == id)
-			list.push_back(line);
+	updateIdIndexes();
+
+	auto lines = id_index_.sortedObjects(id);
+	list.insert(list.end(), lines.begin(), lines.end());
 }
 
 // -----------------------------------------------------------------------------
@@ -191,100 +338,15 @@ vector<MapLine*> LineList::allWithId(int id) const
 // -----------------------------------------------------------------------------
 // Adds all lines with special affecting matching [id] to [list]
 // -----------------------------------------------------------------------------
-#define IDEQ(x) (((x) != 0) && ((x) == id))
 void LineList::putAllTaggingWithId(int id, int type, vector<MapLine*>& list) const
 {
-	using game::TagType;
+	updateIdIndexes();
 
-	// Find lines with special affecting matching id
-	int tag, arg2, arg3, arg4, arg5;
-	for (auto& line : objects_)
-	{
-		int special = line->special();
-		if (special)
-		{
-			tag       = line->arg(0);
-			bool fits = false;
-			switch (game::configuration().actionSpecial(special).needsTag())
-			{
-			case TagType::Sector:
-			case TagType::SectorOrBack:
-			case TagType::SectorAndBack: fits = (IDEQ(tag) && type == SLADEMap::SECTORS); break;
-			case TagType::LineNegative: tag = abs(tag);
-			case TagType::Line: fits = (IDEQ(tag) && type == SLADEMap::LINEDEFS); break;
-			case TagType::Thing: fits = (IDEQ(tag) && type == SLADEMap::THINGS); break;
-			case TagType::Thing1Sector2:
-				arg2 = line->arg(1);
-				fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
-				break;
-			case TagType::Thing1Sector3:
-				arg3 = line->arg(2);
-				fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg3) && type == SLADEMap::SECTORS));
-				break;
-			case TagType::Thing1Thing2:
-				arg2 = line->arg(1);
-				fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2)));
-				break;
-			case TagType::Thing1Thing4:
-				arg4 = line->arg(3);
-				fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg4)));
-				break;
-			case TagType::Thing1Thing2Thing3:
-				arg2 = line->arg(1);
-				arg3 = line->arg(2);
-				fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3)));
-				break;
-			case TagType::Sector1Thing2Thing3Thing5:
-				arg2 = line->arg(1);
-				arg3 = line->arg(2);
-				arg5 = line->arg(4);
-				fits =
-					(type == SLADEMap::SECTORS ?
-						 (IDEQ(tag)) :
-						 (type == SLADEMap::THINGS && (IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg5))));
-				break;
-			case TagType::LineId1Line2:
-				arg2 = line->arg(1);
-				fits = (type == SLADEMap::LINEDEFS && IDEQ(arg2));
-				break;
-			case TagType::Thing4:
-				arg4 = line->arg(3);
-				fits = (type == SLADEMap::THINGS && IDEQ(arg4));
-				break;
-			case TagType::Thing5:
-				arg5 = line->arg(4);
-				fits = (type == SLADEMap::THINGS && IDEQ(arg5));
-				break;
-			case TagType::Line1Sector2:
-				arg2 = line->arg(1);
-				fits = (type == SLADEMap::LINEDEFS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
-				break;
-			case TagType::Sector1Sector2:
-				arg2 = line->arg(1);
-				fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2)));
-				break;
-			case TagType::Sector1Sector2Sector3Sector4:
-				arg2 = line->arg(1);
-				arg3 = line->arg(2);
-				arg4 = line->arg(3);
-				fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg4)));
-				break;
-			case TagType::Sector2Is3Line:
-				arg2 = line->arg(1);
-				fits = (IDEQ(tag) && (arg2 == 3 ? type == SLADEMap::LINEDEFS : type == SLADEMap::SECTORS));
-				break;
-			case TagType::Sector1Thing2:
-				arg2 = line->arg(1);
-				fits = (type == SLADEMap::SECTORS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::THINGS));
-				break;
-			default: break;
-			}
-			if (fits)
-				list.push_back(line);
-		}
-	}
+	// Only lines with an arg matching id can have a special affecting it
+	for (auto line : arg_index_.sortedObjects(id))
+		if (lineTagsId(line, id, type))
+			list.push_back(line);
 }
-#undef IDEQ
 
 // -----------------------------------------------------------------------------
 // Returns the lowest unused id.
@@ -293,46 +355,124 @@ void LineList::putAllTaggingWithId(int id, int type, vector<MapLine*>& list) con
 // -----------------------------------------------------------------------------
 int LineList::firstFreeId(MapFormat format) const
 {
-	int id = 1;
+	updateIdIndexes();
 
 	// UDMF (id property)
 	if (format == MapFormat::UDMF)
-	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->id() == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
-	}
+		return id_index_.firstFreeKey();
+
+	// Hexen (special 121 arg0) or Boom (sector tag (arg0))
+	auto arg0_used = [this, format](int id) {
+		for (auto line : arg_index_.objects(id))
+			if (line->arg(0) == id && (format != MapFormat::Hexen || line->special() == 121))
+				return true;
+
+		return false;
+	};
 
-	// Hexen (special 121 arg0)
-	else if (format == MapFormat::Hexen)
+	int id = 1;
+	if (format == MapFormat::Hexen
+		|| format == MapFormat::Doom && game::configuration().featureSupported(game::Feature::Boom))
 	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->special() == 121 && objects_[a]->arg(0) == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+		while (arg0_used(id))
+			id++;
 	}
 
-	// Boom (sector tag (arg0))
-	else if (format == MapFormat::Doom && game::configuration().featureSupported(game::Feature::Boom))
+	return id;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all lines from the list
+// -----------------------------------------------------------------------------
+void LineList::clear()
+{
+	MapObjectList::clear();
+	grid_.clear();
+	id_index_.clear();
+	arg_index_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [line] to the list
+// -----------------------------------------------------------------------------
+void LineList::add(MapLine* line)
+{
+	MapObjectList::add(line);
+	addToGrid(line);
+	addToIdIndexes(line);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the line at [index] from the list
+// -----------------------------------------------------------------------------
+void LineList::remove(unsigned index)
+{
+	if (index < count_)
 	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->arg(0) == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+		grid_.remove(objects_[index]);
+		id_index_.remove(objects_[index]);
+		arg_index_.remove(objects_[index]);
 	}
 
-	return id;
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last line in the list
+// -----------------------------------------------------------------------------
+void LineList::removeLast()
+{
+	grid_.remove(objects_.back());
+	id_index_.remove(objects_.back());
+	arg_index_.remove(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the grid and id indexes for all lines modified since they were last
+// updated
+// -----------------------------------------------------------------------------
+void LineList::updateIndexes() const
+{
+	updateGrid();
+	updateIdIndexes();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the positions of any lines in the grid that have been modified (or
+// had a vertex moved) since it was last updated
+// -----------------------------------------------------------------------------
+void LineList::updateGrid() const
+{
+	grid_.updateDirty([this](MapLine* line) { addToGrid(line); });
+}
+
+// -----------------------------------------------------------------------------
+// Adds (or updates) [line] in the grid at its current position
+// -----------------------------------------------------------------------------
+void LineList::addToGrid(MapLine* line) const
+{
+	if (line->v1() && line->v2())
+		grid_.addSegment(line, line->v1()->position(), line->v2()->position());
+	else
+		grid_.addUnplaced(line);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the ids and args of any lines in the id indexes that have been
+// modified since they were last updated
+// -----------------------------------------------------------------------------
+void LineList::updateIdIndexes() const
+{
+	id_index_.updateDirty([this](MapLine* line) { id_index_.add(line, { line->id() }); });
+	arg_index_.updateDirty([this](MapLine* line) { arg_index_.add(line, argKeys(line)); });
+}
+
+// -----------------------------------------------------------------------------
+// Adds (or updates) [line] in the id indexes with its current id and args
+// -----------------------------------------------------------------------------
+void LineList::addToIdIndexes(MapLine* line) const
+{
+	id_index_.add(line, { line->id() });
+	arg_index_.add(line, argKeys(line));
 }
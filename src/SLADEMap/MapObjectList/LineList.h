@@ -1,6 +1,8 @@
 #pragma once
 
 #include "General/Defs.h"
+#include "MapObjectGrid.h"
+#include "MapObjectIdIndex.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapLine.h"
 
@@ -12,10 +14,35 @@ public:
 	MapLine*         nearest(Vec2d point, double min = 64) const;
 	MapLine*         withVertices(MapVertex* v1, MapVertex* v2, bool reverse = true) const;
 	vector<Vec2d>    cutPoints(const Seg2d& cutter) const;
+	vector<MapLine*> allInBox(Vec2d min, Vec2d max) const;
 	MapLine*         firstWithId(int id) const;
 	void             putAllWithId(int id, vector<MapLine*>& list) const;
 	vector<MapLine*> allWithId(int id) const;
 	void             putAllTaggingWithId(int id, int type, vector<MapLine*>& list) const;
 	int              firstFreeId(MapFormat format) const;
+
+	void clear() override;
+	void add(MapLine* line) override;
+	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateIndexes() const;
+
+	void lineModified(MapLine* line) { grid_.markDirty(line); }
+	void lineIdsModified(MapLine* line)
+	{
+		id_index_.markDirty(line);
+		arg_index_.markDirty(line);
+	}
+
+private:
+	mutable MapObjectGrid<MapLine>    grid_;
+	mutable MapObjectIdIndex<MapLine> id_index_;  // By line id
+	mutable MapObjectIdIndex<MapLine> arg_index_; // By nonzero args (and their absolute values)
+
+	void updateGrid() const;
+	void addToGrid(MapLine* line) const;
+	void updateIdIndexes() const;
+	void addToIdIndexes(MapLine* line) const;
 };
 } // namespace slade
@@ -0,0 +1,193 @@
+#pragma once
+
+namespace slade
+{
+// A uniform grid spatial index for map objects, used to speed up position-based
+// lookups (eg. finding the nearest vertex to a point). Each object is added to
+// every grid cell it touches, and must be updated (re-added) whenever it moves.
+//
+// Objects can be marked 'dirty' when they (may) have moved, to be updated in
+// one go the next time the grid is queried
+template<class T> class MapObjectGrid
+{
+public:
+	MapObjectGrid(double cell_size = 128.) : cell_size_{ cell_size } {}
+	~MapObjectGrid() = default;
+
+	bool contains(T* object) const { return object_cells_.find(object) != object_cells_.end(); }
+	bool hasDirty() const { return !dirty_.empty(); }
+
+	void clear()
+	{
+		cells_.clear();
+		object_cells_.clear();
+		dirty_.clear();
+	}
+
+	// Adds [object] without placing it in any cell (eg. if it doesn't have a
+	// position yet), so it can still be marked dirty
+	void addUnplaced(T* object) { add(object, {}); }
+
+	// Adds [object] at [point]
+	void addPoint(T* object, Vec2d point) { add(object, { cellKey(cellCoord(point.x), cellCoord(point.y)) }); }
+
+	// Adds [object] to all cells the line from [p1] to [p2] passes through
+	void addSegment(T* object, Vec2d p1, Vec2d p2)
+	{
+		if (p1.x > p2.x)
+			std::swap(p1, p2);
+
+		// Go through each column of cells the line crosses, adding the cells
+		// covered by the part of the line within the column
+		vector<uint64_t> keys;
+		const auto       cx1   = cellCoord(p1.x);
+		const auto       cx2   = cellCoord(p2.x);
+		const auto       slope = p1.x == p2.x ? 0. : (p2.y - p1.y) / (p2.x - p1.x);
+		for (auto cx = cx1; cx <= cx2; ++cx)
+		{
+			auto ya = p1.y;
+			auto yb = p2.y;
+			if (p1.x != p2.x)
+			{
+				ya = p1.y + (std::max(p1.x, cx * cell_size_) - p1.x) * slope;
+				yb = p1.y + (std::min(p2.x, (cx + 1) * cell_size_) - p1.x) * slope;
+			}
+
+			const auto cy2 = cellCoord(std::max(ya, yb));
+			for (auto cy = cellCoord(std::min(ya, yb)); cy <= cy2; ++cy)
+				keys.push_back(cellKey(cx, cy));
+		}
+
+		add(object, std::move(keys));
+	}
+
+	// Adds [object] to all cells overlapping [bbox]
+	void addBox(T* object, const BBox& bbox)
+	{
+		vector<uint64_t> keys;
+		const auto       cx2 = cellCoord(bbox.max.x);
+		const auto       cy2 = cellCoord(bbox.max.y);
+		for (auto cx = cellCoord(bbox.min.x); cx <= cx2; ++cx)
+			for (auto cy = cellCoord(bbox.min.y); cy <= cy2; ++cy)
+				keys.push_back(cellKey(cx, cy));
+
+		add(object, std::move(keys));
+	}
+
+	// Removes [object] from the grid
+	void remove(T* object)
+	{
+		auto i = object_cells_.find(object);
+		if (i == object_cells_.end())
+			return;
+
+		for (auto key : i->second)
+		{
+			auto cell = cells_.find(key);
+			if (cell == cells_.end())
+				continue;
+
+			auto& objects = cell->second;
+			auto  pos     = std::find(objects.begin(), objects.end(), object);
+			if (pos != objects.end())
+			{
+				*pos = objects.back();
+				objects.pop_back();
+			}
+			if (objects.empty())
+				cells_.erase(cell);
+		}
+
+		object_cells_.erase(i);
+	}
+
+	// Marks [object] as needing to be updated, if it is in the grid
+	void markDirty(T* object)
+	{
+		if (contains(object))
+			dirty_.push_back(object);
+	}
+
+	// Calls [update] for each dirty object still in the grid, which should
+	// re-add it at its current position
+	template<typename F> void updateDirty(F update)
+	{
+		// Nothing is changed if there are no dirty objects, so a clean index
+		// can safely be queried from multiple threads at once
+		if (dirty_.empty())
+			return;
+
+		auto dirty = std::move(dirty_);
+		dirty_.clear();
+		std::sort(dirty.begin(), dirty.end());
+		dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+		for (auto object : dirty)
+			if (contains(object))
+				update(object);
+	}
+
+	// Calls [func] for each object in any cell overlapping the box from [min]
+	// to [max]. Objects covering multiple cells may be passed more than once
+	template<typename F> void forEachInBox(Vec2d min, Vec2d max, F func) const
+	{
+		const auto cx1 = cellCoord(min.x);
+		const auto cy1 = cellCoord(min.y);
+		const auto cx2 = cellCoord(max.x);
+		const auto cy2 = cellCoord(max.y);
+
+		// If the box covers more cells than are in use, it's quicker to go
+		// through the used cells instead
+		if (static_cast<double>(cx2 - cx1 + 1) * static_cast<double>(cy2 - cy1 + 1) > cells_.size())
+		{
+			for (const auto& [key, objects] : cells_)
+			{
+				const auto cx = static_cast<int32_t>(key >> 32);
+				const auto cy = static_cast<int32_t>(key & 0xFFFFFFFF);
+				if (cx >= cx1 && cx <= cx2 && cy >= cy1 && cy <= cy2)
+					for (auto object : objects)
+						func(object);
+			}
+			return;
+		}
+
+		for (auto cx = cx1; cx <= cx2; ++cx)
+			for (auto cy = cy1; cy <= cy2; ++cy)
+			{
+				auto cell = cells_.find(cellKey(cx, cy));
+				if (cell != cells_.end())
+					for (auto object : cell->second)
+						func(object);
+			}
+	}
+
+	// Calls [func] for each object in any cell within [radius] (on either
+	// axis) of [point]
+	template<typename F> void forEachNear(Vec2d point, double radius, F func) const
+	{
+		forEachInBox({ point.x - radius, point.y - radius }, { point.x + radius, point.y + radius }, func);
+	}
+
+private:
+	double                                   cell_size_;
+	std::unordered_map<uint64_t, vector<T*>> cells_;
+	std::unordered_map<T*, vector<uint64_t>> object_cells_;
+	vector<T*>                               dirty_;
+
+	int64_t cellCoord(double pos) const
+	{
+		return static_cast<int64_t>(std::floor(std::clamp(pos / cell_size_, -2147483648., 2147483647.)));
+	}
+	static uint64_t cellKey(int64_t cx, int64_t cy)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+	}
+
+	void add(T* object, vector<uint64_t> keys)
+	{
+		remove(object);
+		for (auto key : keys)
+			cells_[key].push_back(object);
+		object_cells_[object] = std::move(keys);
+	}
+};
+} // namespace slade
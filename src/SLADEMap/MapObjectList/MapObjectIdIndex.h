@@ -0,0 +1,121 @@
+#pragma once
+
+namespace slade
+{
+// A hash index of map objects by integer keys (eg. ids/tags, or special
+// args), used to speed up id-based lookups. Each object can have any number of
+// keys, and must be updated (re-added) whenever its keys change.
+//
+// As with MapObjectGrid, objects can be marked 'dirty' when their keys (may)
+// have changed, to be updated in one go the next time the index is queried
+template<class T> class MapObjectIdIndex
+{
+public:
+	MapObjectIdIndex()  = default;
+	~MapObjectIdIndex() = default;
+
+	bool contains(T* object) const { return object_keys_.find(object) != object_keys_.end(); }
+	bool hasDirty() const { return !dirty_.empty(); }
+	bool hasKey(int key) const { return objects_.find(key) != objects_.end(); }
+
+	void clear()
+	{
+		objects_.clear();
+		object_keys_.clear();
+		dirty_.clear();
+	}
+
+	// Adds [object] with [keys], replacing any keys it already had
+	void add(T* object, vector<int> keys)
+	{
+		remove(object);
+
+		std::sort(keys.begin(), keys.end());
+		keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+		for (auto key : keys)
+			objects_[key].push_back(object);
+		object_keys_[object] = std::move(keys);
+	}
+
+	// Removes [object] from the index
+	void remove(T* object)
+	{
+		auto i = object_keys_.find(object);
+		if (i == object_keys_.end())
+			return;
+
+		for (auto key : i->second)
+		{
+			auto list = objects_.find(key);
+			if (list == objects_.end())
+				continue;
+
+			auto& objects = list->second;
+			auto  pos     = std::find(objects.begin(), objects.end(), object);
+			if (pos != objects.end())
+			{
+				*pos = objects.back();
+				objects.pop_back();
+			}
+			if (objects.empty())
+				objects_.erase(list);
+		}
+
+		object_keys_.erase(i);
+	}
+
+	// Marks [object] as needing to be updated, if it is in the index
+	void markDirty(T* object)
+	{
+		if (contains(object))
+			dirty_.push_back(object);
+	}
+
+	// Calls [update] for each dirty object still in the index, which should
+	// re-add it with its current keys
+	template<typename F> void updateDirty(F update)
+	{
+		// Don't touch a clean index (see MapObjectGrid::updateDirty)
+		if (dirty_.empty())
+			return;
+
+		auto dirty = std::move(dirty_);
+		dirty_.clear();
+		std::sort(dirty.begin(), dirty.end());
+		dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+		for (auto object : dirty)
+			if (contains(object))
+				update(object);
+	}
+
+	// Returns all objects with [key], in no particular order
+	const vector<T*>& objects(int key) const
+	{
+		static const vector<T*> none;
+		auto                    i = objects_.find(key);
+		return i != objects_.end() ? i->second : none;
+	}
+
+	// Returns all objects with [key], sorted by map index
+	vector<T*> sortedObjects(int key) const
+	{
+		auto list = objects(key);
+		std::sort(list.begin(), list.end(), [](T* left, T* right) { return left->index() < right->index(); });
+		return list;
+	}
+
+	// Returns the lowest positive key that no object has
+	int firstFreeKey() const
+	{
+		int key = 1;
+		while (hasKey(key))
+			key++;
+		return key;
+	}
+
+private:
+	std::unordered_map<int, vector<T*>> objects_;
+	std::unordered_map<T*, vector<int>> object_keys_;
+	vector<T*>                          dirty_;
+};
+} // namespace slade
@@ -29,6 +29,7 @@ public:
 	}
 	T*   back() { return objects_.back(); }
 	bool empty() const { return count_ == 0; }
+	void reserve(unsigned count) { objects_.reserve(count); }
 
 	// Access
 	const vector<T*>& all() const { return objects_; }
@@ -57,6 +58,26 @@ public:
 		--count_;
 	}
 
+	// Removes all objects for which [pred] returns true in a single pass,
+	// keeping the remaining objects in order. Object indices are not updated.
+	// Returns the number of objects removed
+	template<typename P> unsigned removeIf(P pred)
+	{
+		unsigned kept = 0;
+		for (auto object : objects_)
+		{
+			if (pred(object))
+				removed(object);
+			else
+				objects_[kept++] = object;
+		}
+
+		auto n_removed = count_ - kept;
+		objects_.resize(kept);
+		count_ = kept;
+		return n_removed;
+	}
+
 	// Misc
 	void putModifiedObjects(long since, vector<MapObject*>& modified_objects) const
 	{
@@ -76,5 +97,8 @@ public:
 protected:
 	vector<T*> objects_;
 	unsigned   count_ = 0;
+
+	// Called when [object] is removed from the list
+	virtual void removed(T* object) {}
 };
 } // namespace slade
@@ -33,8 +33,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SectorList.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
-#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -52,6 +52,10 @@ using namespace slade;
 void SectorList::clear()
 {
 	usage_tex_.clear();
+	grid_.clear();
+	tag_index_.clear();
+	bounds_valid_ = false;
+	bounds_dirty_.clear();
 	MapObjectList::clear();
 }
 
@@ -61,10 +65,17 @@ void SectorList::clear()
 void SectorList::add(MapSector* sector)
 {
 	// Update texture counts
-	usage_tex_[strutil::upper(sector->floor().texture)] += 1;
-	usage_tex_[strutil::upper(sector->ceiling().texture)] += 1;
+	usage_tex_[sector->floor().texture.idCI()] += 1;
+	usage_tex_[sector->ceiling().texture.idCI()] += 1;
+
+	// New sectors usually have no lines yet, so are added to the bounds when
+	// their bbox is first updated
+	if (bounds_valid_)
+		bounds_dirty_.push_back(sector);
 
 	MapObjectList::add(sector);
+	addToGrid(sector);
+	tag_index_.add(sector, { sector->tag() });
 }
 
 // -----------------------------------------------------------------------------
@@ -75,11 +86,32 @@ void SectorList::remove(unsigned index)
 	if (index >= objects_.size())
 		return;
 
+	removed(objects_[index]);
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last sector in the list
+// -----------------------------------------------------------------------------
+void SectorList::removeLast()
+{
+	removed(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Called when [sector] is removed from the list, updates texture usage and
+// removes it from the bounds, grid and tag index
+// -----------------------------------------------------------------------------
+void SectorList::removed(MapSector* sector)
+{
 	// Update texture counts
-	usage_tex_[strutil::upper(objects_[index]->floor().texture)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->ceiling().texture)] -= 1;
+	usage_tex_[sector->floor().texture.idCI()] -= 1;
+	usage_tex_[sector->ceiling().texture.idCI()] -= 1;
 
-	MapObjectList::remove(index);
+	boundsRemoved(sector);
+	grid_.remove(sector);
+	tag_index_.remove(sector);
 }
 
 // -----------------------------------------------------------------------------
@@ -87,20 +119,95 @@ void SectorList::remove(unsigned index)
 // -----------------------------------------------------------------------------
 MapSector* SectorList::atPos(Vec2d point) const
 {
+	updateGrid();
+
+	// Go through sectors with a bounding box overlapping the grid cell at the
+	// point (the first in the list containing the point is returned)
+	MapSector* found = nullptr;
+	grid_.forEachNear(point, 0, [&](MapSector* sector) {
+		// Check if point is within sector
+		if ((!found || sector->index() < found->index()) && sector->containsPoint(point))
+			found = sector;
+	});
+
+	// Null if not within a sector
+	return found;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a bounding box containing all sectors in the list.
+// The bounds are kept up to date as sectors are added or change shape, and
+// only need to be fully recalculated if a sector on the edge of the bounds
+// changes or is removed
+// -----------------------------------------------------------------------------
+BBox SectorList::allSectorBounds() const
+{
+	if (count_ == 0)
+		return {};
+
 	// Go through sectors
-	for (const auto& sector : objects_)
+	// This is quicker than generating it from vertices,
+	// but relies on sector bboxes being up-to-date (which they should be)
+	// (sectors without any lines yet are ignored)
+	if (!bounds_valid_)
 	{
-		// Check if point is within sector
-		if (sector->containsPoint(point))
-			return sector;
+		bool first = true;
+		for (unsigned i = 0; i < count_; ++i)
+		{
+			auto sbb = objects_[i]->boundingBox();
+			if (!sbb.isValid())
+				continue;
+
+			if (first)
+				bounds_ = sbb;
+			else
+				bounds_.extend(sbb);
+			first = false;
+		}
+
+		// Can't extend empty bounds, so leave them to be recalculated
+		bounds_valid_ = !first;
 	}
+	else
+	{
+		// Getting the bbox of a dirty sector can update it, which marks it
+		// dirty again, so go through a copy of the list
+		auto dirty = std::move(bounds_dirty_);
+		for (auto sector : dirty)
+		{
+			auto sbb = sector->boundingBox();
+			if (sbb.isValid())
+				bounds_.extend(sbb);
+		}
+	}
+	bounds_dirty_.clear();
 
-	// Not within a sector
-	return nullptr;
+	return bounds_;
 }
 
 // -----------------------------------------------------------------------------
-// Returns a bounding box containing all sectors in the list
+// Called when the bbox of [sector] is about to change (or be reset) from
+// [old_bbox]. The bounds need to be recalculated if the sector is currently on
+// their edge, otherwise they can just be extended to its new bbox
+// -----------------------------------------------------------------------------
+void SectorList::bboxChanging(MapSector* sector, const BBox& old_bbox) const
+{
+	if (!bounds_valid_)
+		return;
+
+	// An invalid (eg. reset) bbox was either already checked when it was reset,
+	// or wasn't included in the bounds
+	if (old_bbox.isValid()
+		&& (old_bbox.min.x <= bounds_.min.x || old_bbox.min.y <= bounds_.min.y || old_bbox.max.x >= bounds_.max.x
+			|| old_bbox.max.y >= bounds_.max.y))
+	{
+		bounds_valid_ = false;
+		bounds_dirty_.clear();
+	}
+	else
+		bounds_dirty_.push_back(sector);
+}
+
 // -----------------------------------------------------------------------------
 BBox SectorList::allSectorBounds() const
 {
@@ -132,18 +239,31 @@ BBox SectorList::allSectorBounds() const
 // -----------------------------------------------------------------------------
 // Forces building of polygons for all sectors in the list
 // -----------------------------------------------------------------------------
-void SectorList::initPolygons()
+void SectorList::initPolygons() const
 {
 	ui::setSplashProgressMessage("Building sector polygons");
 	ui::setSplashProgress(0.0f);
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		ui::setSplashProgress((float)i / (float)count_);
-		objects_[i]->polygon();
-	}
+	updatePolygons();
 	ui::setSplashProgress(1.0f);
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the polygons of all sectors in the list that need updating (eg.
+// after their geometry was changed).
+// The sectors are triangulated in parallel on the worker threads, each into
+// its own polygon, and this doesn't return until all are done, so renderers
+// never see a partially built polygon. The map must not be modified meanwhile
+// -----------------------------------------------------------------------------
+void SectorList::updatePolygons() const
+{
+	vector<MapSector*> outdated;
+	for (auto sector : objects_)
+		if (sector->polygonNeedsUpdate())
+			outdated.push_back(sector);
+
+	threadpool::parallelFor(outdated.size(), [&outdated](size_t index) { outdated[index]->polygon(); }, 8);
+}
+
 // -----------------------------------------------------------------------------
 // Forces update of bounding boxes for all sectors in the list
 // -----------------------------------------------------------------------------
@@ -158,9 +278,10 @@ void SectorList::initBBoxes()
 // -----------------------------------------------------------------------------
 void SectorList::putAllWithId(int id, vector<MapSector*>& list) const
 {
-	for (auto& sector : objects_)
-		if (sector->tag() == id)
-			list.push_back(sector);
+	updateTagIndex();
+
+	auto sectors = tag_index_.sortedObjects(id);
+	list.insert(list.end(), sectors.begin(), sectors.end());
 }
 
 // -----------------------------------------------------------------------------
@@ -178,11 +299,14 @@ vector<MapSector*> SectorList::allWithId(int id) const
 // -----------------------------------------------------------------------------
 MapSector* SectorList::firstWithId(int id) const
 {
-	for (auto& sector : objects_)
-		if (sector->tag() == id)
-			return sector;
+	updateTagIndex();
 
-	return nullptr;
+	MapSector* first = nullptr;
+	for (auto sector : tag_index_.objects(id))
+		if (!first || sector->index() < first->index())
+			first = sector;
+
+	return first;
 }
 
 // -----------------------------------------------------------------------------
@@ -190,31 +314,73 @@ MapSector* SectorList::firstWithId(int id) const
 // -----------------------------------------------------------------------------
 int SectorList::firstFreeId() const
 {
-	int id = 1;
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		if (objects_[i]->tag() == id)
-		{
-			id++;
-			i = 0;
-		}
-	}
-
-	return id;
+	updateTagIndex();
+	return tag_index_.firstFreeKey();
 }
 
 // -----------------------------------------------------------------------------
 // Adjusts the usage count of [tex] by [adjust]
 // -----------------------------------------------------------------------------
-void SectorList::updateTexUsage(string_view tex, int adjust) const
+void SectorList::updateTexUsage(const TextureName& tex, int adjust) const
 {
-	usage_tex_[strutil::upper(tex)] += adjust;
+	usage_tex_[tex.idCI()] += adjust;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the usage count of [tex]
 // -----------------------------------------------------------------------------
-int SectorList::texUsageCount(string_view tex) const
+int SectorList::texUsageCount(const TextureName& tex) const
+{
+	auto i = usage_tex_.find(tex.idCI());
+	return i != usage_tex_.end() ? i->second : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the grid and tag index for all sectors modified since they were last
+// updated
+// -----------------------------------------------------------------------------
+void SectorList::updateIndexes() const
+{
+	updateGrid();
+	updateTagIndex();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the bounding boxes of any sectors in the grid that have changed
+// since it was last updated
+// -----------------------------------------------------------------------------
+void SectorList::updateGrid() const
+{
+	grid_.updateDirty([this](MapSector* sector) { addToGrid(sector); });
+}
+
+// -----------------------------------------------------------------------------
+// Adds (or updates) [sector] in the grid at its current bounding box
+// -----------------------------------------------------------------------------
+void SectorList::addToGrid(MapSector* sector) const
+{
+	auto bbox = sector->boundingBox();
+	if (bbox.isValid())
+		grid_.addBox(sector, bbox);
+	else
+		grid_.addUnplaced(sector);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the tags of any sectors in the tag index that have been modified
+// since it was last updated
+// -----------------------------------------------------------------------------
+void SectorList::updateTagIndex() const
+{
+	tag_index_.updateDirty([this](MapSector* sector) { tag_index_.add(sector, { sector->tag() }); });
+}
+
+// -----------------------------------------------------------------------------
+// Called when [sector] is about to be removed from the list
+// -----------------------------------------------------------------------------
+void SectorList::boundsRemoved(MapSector* sector) const
 {
-	return usage_tex_[strutil::upper(tex)];
+	// Removing a sector on the edge of the bounds can shrink them
+	bboxChanging(sector, sector->bbox_);
+	bounds_dirty_.erase(std::remove(bounds_dirty_.begin(), bounds_dirty_.end(), sector), bounds_dirty_.end());
 }
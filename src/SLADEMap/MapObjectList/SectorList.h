@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MapObjectGrid.h"
+#include "MapObjectIdIndex.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapSector.h"
 
@@ -12,21 +14,41 @@ public:
 	void clear() override;
 	void add(MapSector* sector) override;
 	void remove(unsigned index) override;
+	void removeLast() override;
 
 	MapSector*         atPos(Vec2d point) const;
 	BBox               allSectorBounds() const;
-	void               initPolygons();
+	void               initPolygons() const;
+	void               updatePolygons() const;
 	void               initBBoxes();
 	void               putAllWithId(int id, vector<MapSector*>& list) const;
 	vector<MapSector*> allWithId(int id) const;
 	MapSector*         firstWithId(int id) const;
 	int                firstFreeId() const;
+	void               updateIndexes() const;
 
 	void clearTexUsage() const { usage_tex_.clear(); }
-	void updateTexUsage(string_view tex, int adjust) const;
-	int  texUsageCount(string_view tex) const;
+	void updateTexUsage(const TextureName& tex, int adjust) const;
+	int  texUsageCount(const TextureName& tex) const;
+
+	void bboxReset(MapSector* sector) const { grid_.markDirty(sector); }
+	void bboxChanging(MapSector* sector, const BBox& old_bbox) const;
+	void sectorIdsModified(MapSector* sector) { tag_index_.markDirty(sector); }
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable std::unordered_map<unsigned, int> usage_tex_; // By TextureName::idCI
+	mutable MapObjectGrid<MapSector>          grid_{ 256. };
+	mutable MapObjectIdIndex<MapSector>       tag_index_;
+
+	// Bounds of all sectors, kept up to date incrementally
+	mutable BBox               bounds_;
+	mutable bool               bounds_valid_ = false;
+	mutable vector<MapSector*> bounds_dirty_; // Sectors with bboxes changed since the bounds were updated
+
+	void removed(MapSector* sector) override;
+	void updateGrid() const;
+	void addToGrid(MapSector* sector) const;
+	void updateTagIndex() const;
+	void boundsRemoved(MapSector* sector) const;
 };
 } // namespace slade
@@ -33,7 +33,6 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SideList.h"
-#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -60,9 +59,9 @@ void SideList::clear()
 void SideList::add(MapSide* side)
 {
 	// Update texture counts
-	usage_tex_[strutil::upper(side->tex_upper_)] += 1;
-	usage_tex_[strutil::upper(side->tex_middle_)] += 1;
-	usage_tex_[strutil::upper(side->tex_lower_)] += 1;
+	usage_tex_[side->tex_upper_.idCI()] += 1;
+	usage_tex_[side->tex_middle_.idCI()] += 1;
+	usage_tex_[side->tex_lower_.idCI()] += 1;
 
 	MapObjectList::add(side);
 }
@@ -75,26 +74,33 @@ void SideList::remove(unsigned index)
 	if (index >= objects_.size())
 		return;
 
-	// Update texture counts
-	usage_tex_[strutil::upper(objects_[index]->tex_upper_)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->tex_middle_)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->tex_lower_)] -= 1;
-
+	removed(objects_[index]);
 	MapObjectList::remove(index);
 }
 
+// -----------------------------------------------------------------------------
+// Called when [side] is removed from the list, updates texture usage
+// -----------------------------------------------------------------------------
+void SideList::removed(MapSide* side)
+{
+	usage_tex_[side->tex_upper_.idCI()] -= 1;
+	usage_tex_[side->tex_middle_.idCI()] -= 1;
+	usage_tex_[side->tex_lower_.idCI()] -= 1;
+}
+
 // -----------------------------------------------------------------------------
 // Adjusts the usage count of [tex] by [adjust]
 // -----------------------------------------------------------------------------
-void SideList::updateTexUsage(string_view tex, int adjust) const
+void SideList::updateTexUsage(const TextureName& tex, int adjust) const
 {
-	usage_tex_[strutil::upper(tex)] += adjust;
+	usage_tex_[tex.idCI()] += adjust;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the usage count of [tex]
 // -----------------------------------------------------------------------------
-int SideList::texUsageCount(string_view tex) const
+int SideList::texUsageCount(const TextureName& tex) const
 {
-	return usage_tex_[strutil::upper(tex)];
+	auto i = usage_tex_.find(tex.idCI());
+	return i != usage_tex_.end() ? i->second : 0;
 }
@@ -14,10 +14,12 @@ public:
 	void remove(unsigned index) override;
 
 	void clearTexUsage() const { usage_tex_.clear(); }
-	void updateTexUsage(string_view tex, int adjust) const;
-	int  texUsageCount(string_view tex) const;
+	void updateTexUsage(const TextureName& tex, int adjust) const;
+	int  texUsageCount(const TextureName& tex) const;
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable std::unordered_map<unsigned, int> usage_tex_; // By TextureName::idCI
+
+	void removed(MapSide* side) override;
 };
 } // namespace slade
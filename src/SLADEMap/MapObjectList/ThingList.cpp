@@ -40,6 +40,143 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [thing] has a special affecting objects of [type] with [id].
+// [ttype] is the type of the thing being affected, if [type] is things
+// -----------------------------------------------------------------------------
+#define IDEQ(x) (((x) != 0) && ((x) == id))
+bool thingTagsId(const MapThing* thing, int id, int type, int ttype)
+{
+	using game::TagType;
+
+	auto& tt        = game::configuration().thingType(thing->type());
+	auto  needs_tag = tt.needsTag();
+	if (needs_tag == TagType::None && (!thing->special() || tt.flags() & game::ThingType::Flags::Script))
+		return false;
+
+	if (needs_tag == TagType::None)
+		needs_tag = game::configuration().actionSpecial(thing->special()).needsTag();
+
+	int  tag  = thing->arg(0);
+	int  arg2, arg3, arg4, arg5, tid;
+	bool fits = false;
+	int  path_type;
+	switch (needs_tag)
+	{
+	case TagType::Sector:
+	case TagType::SectorOrBack:
+	case TagType::SectorAndBack: fits = (IDEQ(tag) && type == SLADEMap::SECTORS); break;
+	case TagType::LineNegative: tag = abs(tag);
+	case TagType::Line: fits = (IDEQ(tag) && type == SLADEMap::LINEDEFS); break;
+	case TagType::Thing: fits = (IDEQ(tag) && type == SLADEMap::THINGS); break;
+	case TagType::Thing1Sector2:
+		arg2 = thing->arg(1);
+		fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
+		break;
+	case TagType::Thing1Sector3:
+		arg3 = thing->arg(2);
+		fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg3) && type == SLADEMap::SECTORS));
+		break;
+	case TagType::Thing1Thing2:
+		arg2 = thing->arg(1);
+		fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2)));
+		break;
+	case TagType::Thing1Thing4:
+		arg4 = thing->arg(3);
+		fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg4)));
+		break;
+	case TagType::Thing1Thing2Thing3:
+		arg2 = thing->arg(1);
+		arg3 = thing->arg(2);
+		fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3)));
+		break;
+	case TagType::Sector1Thing2Thing3Thing5:
+		arg2 = thing->arg(1);
+		arg3 = thing->arg(2);
+		arg5 = thing->arg(4);
+		fits =
+			(type == SLADEMap::SECTORS ?
+				 (IDEQ(tag)) :
+				 (type == SLADEMap::THINGS && (IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg5))));
+		break;
+	case TagType::LineId1Line2:
+		arg2 = thing->arg(1);
+		fits = (type == SLADEMap::LINEDEFS && IDEQ(arg2));
+		break;
+	case TagType::Thing4:
+		arg4 = thing->arg(3);
+		fits = (type == SLADEMap::THINGS && IDEQ(arg4));
+		break;
+	case TagType::Thing5:
+		arg5 = thing->arg(4);
+		fits = (type == SLADEMap::THINGS && IDEQ(arg5));
+		break;
+	case TagType::Line1Sector2:
+		arg2 = thing->arg(1);
+		fits = (type == SLADEMap::LINEDEFS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
+		break;
+	case TagType::Sector1Sector2:
+		arg2 = thing->arg(1);
+		fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2)));
+		break;
+	case TagType::Sector1Sector2Sector3Sector4:
+		arg2 = thing->arg(1);
+		arg3 = thing->arg(2);
+		arg4 = thing->arg(3);
+		fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg4)));
+		break;
+	case TagType::Sector2Is3Line:
+		arg2 = thing->arg(1);
+		fits = (IDEQ(tag) && (arg2 == 3 ? type == SLADEMap::LINEDEFS : type == SLADEMap::SECTORS));
+		break;
+	case TagType::Sector1Thing2:
+		arg2 = thing->arg(1);
+		fits = (type == SLADEMap::SECTORS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::THINGS));
+		break;
+	case TagType::Patrol: path_type = 9047;
+	case TagType::Interpolation:
+	{
+		path_type = 9075;
+
+		tid  = thing->id();
+		fits = ((path_type == ttype) && (IDEQ(tid)) && (tt.needsTag() == needs_tag));
+	}
+	break;
+	default: break;
+	}
+	return fits;
+}
+#undef IDEQ
+
+// -----------------------------------------------------------------------------
+// Returns the keys to index [thing] by in the tagging index: its nonzero args
+// (and the absolute values of any negative args) and id
+// -----------------------------------------------------------------------------
+vector<int> taggingKeys(const MapThing* thing)
+{
+	vector<int> keys;
+	for (unsigned a = 0; a < 5; a++)
+	{
+		int arg = thing->arg(a);
+		if (arg != 0)
+			keys.push_back(arg);
+		if (arg < 0)
+			keys.push_back(-arg);
+	}
+	if (thing->id() != 0)
+		keys.push_back(thing->id());
+	return keys;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ThingList Class Functions
@@ -53,22 +190,25 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 MapThing* ThingList::nearest(Vec2d point, double min) const
 {
-	// Go through things
+	updateGrid();
+
+	// Go through things near the point. The nearest thing by 'quick' distance
+	// can only be within [min] if it's within min * sqrt(2) on both axes, so
+	// there's no need to check any further out than min * 2
 	double    dist;
 	double    min_dist = 999999999;
 	MapThing* nearest  = nullptr;
-	for (const auto& thing : objects_)
-	{
+	grid_.forEachNear(point, min * 2, [&](MapThing* thing) {
 		// Get 'quick' distance (no need to get real distance)
 		dist = point.taxicabDistanceTo(thing->position());
 
 		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
+		if (dist < min_dist || nearest && dist == min_dist && thing->index() < nearest->index())
 		{
 			nearest  = thing;
 			min_dist = dist;
 		}
-	}
+	});
 
 	// Now determine the real distance to the closest thing,
 	// to check for minimum hilight distance
@@ -82,6 +222,26 @@ MapThing* ThingList::nearest(Vec2d point, double min) const
 	return nearest;
 }
 
+// -----------------------------------------------------------------------------
+// Returns all things within the box from [min] to [max], in list order
+// -----------------------------------------------------------------------------
+vector<MapThing*> ThingList::allInBox(Vec2d min, Vec2d max) const
+{
+	updateGrid();
+
+	vector<MapThing*> list;
+	grid_.forEachInBox(min, max, [&](MapThing* thing) {
+		const auto pos = thing->position();
+		if (pos.x >= min.x && pos.x <= max.x && pos.y >= min.y && pos.y <= max.y)
+			list.push_back(thing);
+	});
+
+	std::sort(
+		list.begin(), list.end(), [](MapThing* left, MapThing* right) { return left->index() < right->index(); });
+
+	return list;
+}
+
 // -----------------------------------------------------------------------------
 // Same as 'nearest', but returns a list of things for the case where there are
 // multiple things at the same point
@@ -89,42 +249,75 @@ MapThing* ThingList::nearest(Vec2d point, double min) const
 vector<MapThing*> ThingList::multiNearest(Vec2d point) const
 {
 	vector<MapThing*> ret;
+	if (count_ == 0)
+		return ret;
 
-	// Go through things
+	updateGrid();
+
+	// Search outwards from the point until any things are found. Things even
+	// nearer could be outside the searched area if the nearest found is further
+	// than the search radius, so in that case search again out to that distance
 	double min_dist = 999999999;
-	double dist     = 0;
-	for (const auto& thing : objects_)
+	double radius   = 128;
+	while (true)
 	{
-		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicabDistanceTo(thing->position());
+		ret.clear();
+		min_dist = 999999999;
+		grid_.forEachNear(point, radius, [&](MapThing* thing) {
+			// Get 'quick' distance (no need to get real distance)
+			double dist = point.taxicabDistanceTo(thing->position());
 
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
-		{
-			ret.clear();
-			ret.push_back(thing);
-			min_dist = dist;
-		}
-		else if (dist == min_dist)
-			ret.push_back(thing);
+			// Check if it's nearer than the previous nearest
+			if (dist < min_dist)
+			{
+				ret.clear();
+				ret.push_back(thing);
+				min_dist = dist;
+			}
+			else if (dist == min_dist)
+				ret.push_back(thing);
+		});
+
+		if (ret.empty())
+			radius *= 4;
+		else if (min_dist > radius)
+			radius = min_dist;
+		else
+			break;
 	}
 
+	// Return in list order
+	std::sort(ret.begin(), ret.end(), [](MapThing* left, MapThing* right) { return left->index() < right->index(); });
+
 	return ret;
 }
 
 // -----------------------------------------------------------------------------
-// Returns a bounding box for all things's positions
+// Returns a bounding box for all things's positions.
+// The bounds are kept up to date as things are added or moved, and only need to
+// be fully recalculated if a thing on the edge of the bounds moves or is
+// removed
 // -----------------------------------------------------------------------------
 BBox ThingList::allThingBounds() const
 {
 	if (count_ == 0)
 		return {};
 
-	BBox bbox;
-	for (const auto& thing : objects_)
-		bbox.extend(thing->position());
+	if (!bounds_valid_)
+	{
+		bounds_.reset();
+		for (const auto& thing : objects_)
+			bounds_.extend(thing->position());
+		bounds_valid_ = true;
+	}
+	else
+	{
+		for (auto thing : bounds_dirty_)
+			bounds_.extend(thing->position());
+	}
+	bounds_dirty_.clear();
 
-	return bbox;
+	return bounds_;
 }
 
 // -----------------------------------------------------------------------------
@@ -133,9 +326,11 @@ BBox ThingList::allThingBounds() const
 // -----------------------------------------------------------------------------
 void ThingList::putAllWithId(int id, vector<MapThing*>& list, unsigned start, int type) const
 {
-	for (unsigned i = start; i < count_; ++i)
-		if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
-			list.push_back(objects_[i]);
+	updateIdIndexes();
+
+	for (auto thing : id_index_.sortedObjects(id))
+		if (thing->index() >= start && (type == 0 || thing->type() == type))
+			list.push_back(thing);
 }
 
 // -----------------------------------------------------------------------------
@@ -155,17 +350,19 @@ vector<MapThing*> ThingList::allWithId(int id, unsigned start, int type) const
 // -----------------------------------------------------------------------------
 MapThing* ThingList::firstWithId(int id, unsigned start, int type, bool ignore_dragon) const
 {
-	for (unsigned i = start; i < count_; ++i)
-		if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
+	updateIdIndexes();
+
+	for (auto thing : id_index_.sortedObjects(id))
+		if (thing->index() >= start && (type == 0 || thing->type() == type))
 		{
 			if (ignore_dragon)
 			{
-				auto& tt = game::configuration().thingType(objects_[i]->type());
+				auto& tt = game::configuration().thingType(thing->type());
 				if (tt.flags() & game::ThingType::Flags::Dragon)
 					continue;
 			}
 
-			return objects_[i];
+			return thing;
 		}
 
 	return nullptr;
@@ -188,128 +385,149 @@ void ThingList::putAllPathed(vector<MapThing*>& list) const
 // -----------------------------------------------------------------------------
 // Adds all things with special affecting matching id to [list]
 // -----------------------------------------------------------------------------
-#define IDEQ(x) (((x) != 0) && ((x) == id))
 void ThingList::putAllTaggingWithId(int id, int type, vector<MapThing*>& list, int ttype) const
 {
-	using game::TagType;
+	updateIdIndexes();
 
-	// Find things with special affecting matching id
-	int tag, arg2, arg3, arg4, arg5, tid;
-	for (auto& thing : objects_)
+	// Only things with an arg (or id) matching id can have a special affecting it
+	for (auto thing : tagging_index_.sortedObjects(id))
+		if (thingTagsId(thing, id, type, ttype))
+			list.push_back(thing);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the lowest unused thing id
+// -----------------------------------------------------------------------------
+int ThingList::firstFreeId() const
+{
+	updateIdIndexes();
+	return id_index_.firstFreeKey();
+}
+
+// -----------------------------------------------------------------------------
+// Clears all things from the list
+// -----------------------------------------------------------------------------
+void ThingList::clear()
+{
+	MapObjectList::clear();
+	grid_.clear();
+	id_index_.clear();
+	tagging_index_.clear();
+	bounds_valid_ = false;
+	bounds_dirty_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [thing] to the list
+// -----------------------------------------------------------------------------
+void ThingList::add(MapThing* thing)
+{
+	// Bounds are recalculated when the first thing is added, since they can't
+	// be extended from empty
+	if (bounds_valid_ && count_ > 0)
+		bounds_.extend(thing->position());
+	else
+		bounds_valid_ = false;
+
+	MapObjectList::add(thing);
+	grid_.addPoint(thing, thing->position());
+	id_index_.add(thing, { thing->id() });
+	tagging_index_.add(thing, taggingKeys(thing));
+}
+
+// -----------------------------------------------------------------------------
+// Removes the thing at [index] from the list
+// -----------------------------------------------------------------------------
+void ThingList::remove(unsigned index)
+{
+	if (index < count_)
 	{
-		auto& tt        = game::configuration().thingType(thing->type());
-		auto  needs_tag = tt.needsTag();
-		if (needs_tag != TagType::None || (thing->special() && !(tt.flags() & game::ThingType::Flags::Script)))
-		{
-			if (needs_tag == TagType::None)
-				needs_tag = game::configuration().actionSpecial(thing->special()).needsTag();
-			tag       = thing->arg(0);
-			bool fits = false;
-			int  path_type;
-			switch (needs_tag)
-			{
-			case TagType::Sector:
-			case TagType::SectorOrBack:
-			case TagType::SectorAndBack: fits = (IDEQ(tag) && type == SLADEMap::SECTORS); break;
-			case TagType::LineNegative: tag = abs(tag);
-			case TagType::Line: fits = (IDEQ(tag) && type == SLADEMap::LINEDEFS); break;
-			case TagType::Thing: fits = (IDEQ(tag) && type == SLADEMap::THINGS); break;
-			case TagType::Thing1Sector2:
-				arg2 = thing->arg(1);
-				fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
-				break;
-			case TagType::Thing1Sector3:
-				arg3 = thing->arg(2);
-				fits = (type == SLADEMap::THINGS ? IDEQ(tag) : (IDEQ(arg3) && type == SLADEMap::SECTORS));
-				break;
-			case TagType::Thing1Thing2:
-				arg2 = thing->arg(1);
-				fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2)));
-				break;
-			case TagType::Thing1Thing4:
-				arg4 = thing->arg(3);
-				fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg4)));
-				break;
-			case TagType::Thing1Thing2Thing3:
-				arg2 = thing->arg(1);
-				arg3 = thing->arg(2);
-				fits = (type == SLADEMap::THINGS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3)));
-				break;
-			case TagType::Sector1Thing2Thing3Thing5:
-				arg2 = thing->arg(1);
-				arg3 = thing->arg(2);
-				arg5 = thing->arg(4);
-				fits =
-					(type == SLADEMap::SECTORS ?
-						 (IDEQ(tag)) :
-						 (type == SLADEMap::THINGS && (IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg5))));
-				break;
-			case TagType::LineId1Line2:
-				arg2 = thing->arg(1);
-				fits = (type == SLADEMap::LINEDEFS && IDEQ(arg2));
-				break;
-			case TagType::Thing4:
-				arg4 = thing->arg(3);
-				fits = (type == SLADEMap::THINGS && IDEQ(arg4));
-				break;
-			case TagType::Thing5:
-				arg5 = thing->arg(4);
-				fits = (type == SLADEMap::THINGS && IDEQ(arg5));
-				break;
-			case TagType::Line1Sector2:
-				arg2 = thing->arg(1);
-				fits = (type == SLADEMap::LINEDEFS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::SECTORS));
-				break;
-			case TagType::Sector1Sector2:
-				arg2 = thing->arg(1);
-				fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2)));
-				break;
-			case TagType::Sector1Sector2Sector3Sector4:
-				arg2 = thing->arg(1);
-				arg3 = thing->arg(2);
-				arg4 = thing->arg(3);
-				fits = (type == SLADEMap::SECTORS && (IDEQ(tag) || IDEQ(arg2) || IDEQ(arg3) || IDEQ(arg4)));
-				break;
-			case TagType::Sector2Is3Line:
-				arg2 = thing->arg(1);
-				fits = (IDEQ(tag) && (arg2 == 3 ? type == SLADEMap::LINEDEFS : type == SLADEMap::SECTORS));
-				break;
-			case TagType::Sector1Thing2:
-				arg2 = thing->arg(1);
-				fits = (type == SLADEMap::SECTORS ? (IDEQ(tag)) : (IDEQ(arg2) && type == SLADEMap::THINGS));
-				break;
-			case TagType::Patrol: path_type = 9047;
-			case TagType::Interpolation:
-			{
-				path_type = 9075;
+		boundsRemoved(objects_[index]);
+		grid_.remove(objects_[index]);
+		id_index_.remove(objects_[index]);
+		tagging_index_.remove(objects_[index]);
+	}
 
-				tid  = thing->id();
-				fits = ((path_type == ttype) && (IDEQ(tid)) && (tt.needsTag() == needs_tag));
-			}
-			break;
-			default: break;
-			}
-			if (fits)
-				list.push_back(thing);
-		}
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last thing in the list
+// -----------------------------------------------------------------------------
+void ThingList::removeLast()
+{
+	boundsRemoved(objects_.back());
+	grid_.remove(objects_.back());
+	id_index_.remove(objects_.back());
+	tagging_index_.remove(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the grid and id indexes for all things modified since they were last
+// updated
+// -----------------------------------------------------------------------------
+void ThingList::updateIndexes() const
+{
+	updateGrid();
+	updateIdIndexes();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the positions of any things in the grid that have been modified
+// since it was last updated
+// -----------------------------------------------------------------------------
+void ThingList::updateGrid() const
+{
+	grid_.updateDirty([this](MapThing* thing) { grid_.addPoint(thing, thing->position()); });
+}
+
+// -----------------------------------------------------------------------------
+// Updates the ids and args of any things in the id indexes that have been
+// modified since they were last updated
+// -----------------------------------------------------------------------------
+void ThingList::updateIdIndexes() const
+{
+	id_index_.updateDirty([this](MapThing* thing) { id_index_.add(thing, { thing->id() }); });
+	tagging_index_.updateDirty([this](MapThing* thing) { tagging_index_.add(thing, taggingKeys(thing)); });
+}
+
+// -----------------------------------------------------------------------------
+// Called when [thing] is about to be moved, the bounds need to be recalculated
+// if it is currently on their edge, otherwise they can just be extended to its
+// new position
+// -----------------------------------------------------------------------------
+void ThingList::boundsModified(MapThing* thing) const
+{
+	if (!bounds_valid_)
+		return;
+
+	const auto pos = thing->position();
+	if (pos.x <= bounds_.min.x || pos.x >= bounds_.max.x || pos.y <= bounds_.min.y || pos.y >= bounds_.max.y)
+	{
+		bounds_valid_ = false;
+		bounds_dirty_.clear();
 	}
+	else
+		bounds_dirty_.push_back(thing);
 }
-#undef IDEQ
 
 // -----------------------------------------------------------------------------
-// Returns the lowest unused thing id
+// Called when [thing] is about to be removed from the list
 // -----------------------------------------------------------------------------
-int ThingList::firstFreeId() const
+void ThingList::boundsRemoved(MapThing* thing) const
 {
-	int id = 1;
-	for (unsigned i = 0; i < count_; ++i)
+	if (!bounds_valid_)
+		return;
+
+	// Removing a thing on the edge of the bounds can shrink them
+	const auto pos = thing->position();
+	if (pos.x <= bounds_.min.x || pos.x >= bounds_.max.x || pos.y <= bounds_.min.y || pos.y >= bounds_.max.y)
 	{
-		if (objects_[i]->id() == id)
-		{
-			id++;
-			i = 0;
-		}
+		bounds_valid_ = false;
+		bounds_dirty_.clear();
+		return;
 	}
 
-	return id;
+	bounds_dirty_.erase(std::remove(bounds_dirty_.begin(), bounds_dirty_.end(), thing), bounds_dirty_.end());
 }
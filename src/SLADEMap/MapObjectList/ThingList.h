@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MapObjectGrid.h"
+#include "MapObjectIdIndex.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapThing.h"
 
@@ -10,6 +12,7 @@ class ThingList : public MapObjectList<MapThing>
 public:
 	MapThing*         nearest(Vec2d point, double min = 64) const;
 	vector<MapThing*> multiNearest(Vec2d point) const;
+	vector<MapThing*> allInBox(Vec2d min, Vec2d max) const;
 	BBox              allThingBounds() const;
 	void              putAllWithId(int id, vector<MapThing*>& list, unsigned start = 0, int type = 0) const;
 	vector<MapThing*> allWithId(int id, unsigned start = 0, int type = 0) const;
@@ -17,5 +20,38 @@ public:
 	void              putAllPathed(vector<MapThing*>& list) const;
 	void              putAllTaggingWithId(int id, int type, vector<MapThing*>& list, int ttype) const;
 	int               firstFreeId() const;
+
+	void clear() override;
+	void add(MapThing* thing) override;
+	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateIndexes() const;
+
+	void thingModified(MapThing* thing)
+	{
+		grid_.markDirty(thing);
+		boundsModified(thing);
+	}
+	void thingIdsModified(MapThing* thing)
+	{
+		id_index_.markDirty(thing);
+		tagging_index_.markDirty(thing);
+	}
+
+private:
+	mutable MapObjectGrid<MapThing>    grid_;
+	mutable MapObjectIdIndex<MapThing> id_index_;      // By thing id
+	mutable MapObjectIdIndex<MapThing> tagging_index_; // By nonzero args (and their absolute values) and id
+
+	// Bounds of all thing positions, kept up to date incrementally
+	mutable BBox              bounds_;
+	mutable bool              bounds_valid_ = false;
+	mutable vector<MapThing*> bounds_dirty_; // Things (possibly) moved since the bounds were updated
+
+	void updateGrid() const;
+	void updateIdIndexes() const;
+	void boundsModified(MapThing* thing) const;
+	void boundsRemoved(MapThing* thing) const;
 };
 } // namespace slade
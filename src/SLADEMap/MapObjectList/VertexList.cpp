@@ -51,22 +51,25 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::nearest(Vec2d point, double min) const
 {
-	// Go through vertices
+	updateGrid();
+
+	// Go through vertices near the point. The nearest vertex by 'quick'
+	// distance can only be within [min] if it's within min * sqrt(2) on both
+	// axes, so there's no need to check any further out than min * 2
 	double     dist;
 	double     min_dist = 999999999;
 	MapVertex* nearest  = nullptr;
-	for (const auto& vertex : objects_)
-	{
+	grid_.forEachNear(point, min * 2, [&](MapVertex* vertex) {
 		// Get 'quick' distance (no need to get real distance)
 		dist = point.taxicabDistanceTo(vertex->position());
 
 		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
+		if (dist < min_dist || nearest && dist == min_dist && vertex->index() < nearest->index())
 		{
 			nearest  = vertex;
 			min_dist = dist;
 		}
-	}
+	});
 
 	// Now determine the real distance to the closest vertex,
 	// to check for minimum hilight distance
@@ -85,15 +88,16 @@ MapVertex* VertexList::nearest(Vec2d point, double min) const
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::vertexAt(double x, double y) const
 {
-	// Go through all vertices
-	for (auto& vertex : objects_)
-	{
-		if (vertex->position_.x == x && vertex->position_.y == y)
-			return vertex;
-	}
+	updateGrid();
+
+	// Go through vertices in the grid cell at [x,y]
+	MapVertex* found = nullptr;
+	grid_.forEachNear({ x, y }, 0, [&](MapVertex* vertex) {
+		if (vertex->position_.x == x && vertex->position_.y == y && (!found || vertex->index() < found->index()))
+			found = vertex;
+	});
 
-	// No vertex at [x,y]
-	return nullptr;
+	return found;
 }
 
 // -----------------------------------------------------------------------------
@@ -101,10 +105,10 @@ MapVertex* VertexList::vertexAt(double x, double y) const
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::firstCrossed(const Seg2d& line) const
 {
-	// Go through vertices
+	// Go through vertices within the line bbox
 	MapVertex* cv       = nullptr;
 	double     min_dist = 999999;
-	for (const auto& vertex : objects_)
+	for (const auto& vertex : allInBox({ line.left(), line.top() }, { line.right(), line.bottom() }))
 	{
 		auto point = vertex->position();
 
@@ -132,3 +136,87 @@ MapVertex* VertexList::firstCrossed(const Seg2d& line) const
 	// Return closest overlapping vertex to line start
 	return cv;
 }
+
+// -----------------------------------------------------------------------------
+// Returns all vertices within the box from [min] to [max], in list order
+// -----------------------------------------------------------------------------
+vector<MapVertex*> VertexList::allInBox(Vec2d min, Vec2d max) const
+{
+	updateGrid();
+
+	vector<MapVertex*> list;
+	grid_.forEachInBox(min, max, [&](MapVertex* vertex) {
+		const auto pos = vertex->position();
+		if (pos.x >= min.x && pos.x <= max.x && pos.y >= min.y && pos.y <= max.y)
+			list.push_back(vertex);
+	});
+
+	std::sort(list.begin(), list.end(), [](MapVertex* left, MapVertex* right) {
+		return left->index() < right->index();
+	});
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all vertices from the list
+// -----------------------------------------------------------------------------
+void VertexList::clear()
+{
+	MapObjectList::clear();
+	grid_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [vertex] to the list
+// -----------------------------------------------------------------------------
+void VertexList::add(MapVertex* vertex)
+{
+	MapObjectList::add(vertex);
+	grid_.addPoint(vertex, vertex->position());
+}
+
+// -----------------------------------------------------------------------------
+// Removes the vertex at [index] from the list
+// -----------------------------------------------------------------------------
+void VertexList::remove(unsigned index)
+{
+	if (index < count_)
+		removed(objects_[index]);
+
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the last vertex in the list
+// -----------------------------------------------------------------------------
+void VertexList::removeLast()
+{
+	removed(objects_.back());
+	MapObjectList::removeLast();
+}
+
+// -----------------------------------------------------------------------------
+// Called when [vertex] is removed from the list
+// -----------------------------------------------------------------------------
+void VertexList::removed(MapVertex* vertex)
+{
+	grid_.remove(vertex);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the grid for all vertices moved since it was last updated
+// -----------------------------------------------------------------------------
+void VertexList::updateIndexes() const
+{
+	updateGrid();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the positions of any vertices in the grid that have been modified
+// since it was last updated
+// -----------------------------------------------------------------------------
+void VertexList::updateGrid() const
+{
+	grid_.updateDirty([this](MapVertex* vertex) { grid_.addPoint(vertex, vertex->position()); });
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MapObjectGrid.h"
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapVertex.h"
 
@@ -11,5 +12,22 @@ public:
 	MapVertex* nearest(Vec2d point, double min = 64) const;
 	MapVertex* vertexAt(double x, double y) const;
 	MapVertex* firstCrossed(const Seg2d& line) const;
+
+	vector<MapVertex*> allInBox(Vec2d min, Vec2d max) const;
+
+	void clear() override;
+	void add(MapVertex* vertex) override;
+	void remove(unsigned index) override;
+	void removeLast() override;
+
+	void updateIndexes() const;
+
+	void vertexModified(MapVertex* vertex) { grid_.markDirty(vertex); }
+
+private:
+	mutable MapObjectGrid<MapVertex> grid_;
+
+	void removed(MapVertex* vertex) override;
+	void updateGrid() const;
 };
 } // namespace slade
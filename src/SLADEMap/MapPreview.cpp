@@ -0,0 +1,803 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapPreview.cpp
+// Description: Reads basic map data (vertices, lines and things) for map
+//              previews, and renders map preview images. Map lumps are decoded
+//              on worker threads and cached by a hash of their data, and
+//              preview images are rasterised on the CPU in parallel bands
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapPreview.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/ColourConfiguration.h"
+#include "General/Console.h"
+#include "General/ThreadPool.h"
+#include "Graphics/SImage/SImage.h"
+#include "SLADEMap/MapFormat/Doom64MapFormat.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "SLADEMap/MapFormat/HexenMapFormat.h"
+#include "Utility/StringUtils.h"
+#include "Utility/Tokenizer.h"
+#include <future>
+#include <list>
+
+using namespace slade;
+using namespace mappreview;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, map_preview_cache_size, 64, CVar::Flag::Save) // Max number of maps to keep parsed preview data for
+namespace
+{
+using MapFuture = std::shared_future<shared_ptr<const MapData>>;
+
+// Map lump data to be decoded on a worker thread
+struct MapLumps
+{
+	MapFormat format = MapFormat::Unknown;
+	MemChunk  wad; // The whole map wad, for maps in zip archives
+	MemChunk  vertexes;
+	MemChunk  linedefs;
+	MemChunk  things;
+	MemChunk  textmap;
+	size_t    sidedefs_size = 0;
+	size_t    sectors_size  = 0;
+};
+
+// Map lump entries within an archive
+struct MapEntries
+{
+	ArchiveEntry* wad      = nullptr;
+	ArchiveEntry* vertexes = nullptr;
+	ArchiveEntry* linedefs = nullptr;
+	ArchiveEntry* things   = nullptr;
+	ArchiveEntry* textmap  = nullptr;
+	ArchiveEntry* sidedefs = nullptr;
+	ArchiveEntry* sectors  = nullptr;
+};
+
+struct CacheItem
+{
+	uint64_t  key;
+	MapFuture data;
+};
+
+std::list<CacheItem> cache; // Most recently used first
+
+constexpr int render_band_height = 16; // Rows per parallel rendering task
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads a little-endian value of type T at [offset] in [data]
+// -----------------------------------------------------------------------------
+template<typename T> T readValue(const uint8_t* data, size_t offset)
+{
+	T value;
+	memcpy(&value, data + offset, sizeof(T));
+	return value;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the lump entries for [map]
+// -----------------------------------------------------------------------------
+MapEntries findEntries(const Archive::MapDesc& map)
+{
+	MapEntries entries;
+	auto       head = map.head.lock().get();
+	auto       end  = map.end.lock().get();
+
+	// Map in a zip archive, use the whole wad
+	if (map.archive)
+	{
+		entries.wad = head;
+		return entries;
+	}
+
+	while (head)
+	{
+		// Check entry type
+		auto& type = head->type()->id();
+		if (type == "map_vertexes")
+			entries.vertexes = head;
+		else if (type == "map_linedefs")
+			entries.linedefs = head;
+		else if (type == "map_things")
+			entries.things = head;
+		else if (type == "map_sidedefs")
+			entries.sidedefs = head;
+		else if (type == "map_sectors")
+			entries.sectors = head;
+		else if (type == "udmf_textmap" && !entries.textmap)
+			entries.textmap = head;
+
+		// Exit loop if we've reached the end of the map entries
+		if (head == end)
+			break;
+		head = head->nextEntry();
+	}
+
+	return entries;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the data of [entry] (if any) to [hash]
+// -----------------------------------------------------------------------------
+void hashEntry(uint64_t& hash, ArchiveEntry* entry, bool size_only = false)
+{
+	uint64_t crc  = entry && !size_only ? entry->data().crc() : 0;
+	uint64_t size = entry ? entry->size() : 0;
+	hash ^= ((crc << 32) | (size & 0xFFFFFFFF)) + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cache key for a map in [format] with lumps [entries]
+// -----------------------------------------------------------------------------
+uint64_t cacheKey(MapFormat format, const MapEntries& entries)
+{
+	uint64_t hash = static_cast<uint64_t>(format) + 1;
+	hashEntry(hash, entries.wad);
+	hashEntry(hash, entries.vertexes);
+	hashEntry(hash, entries.linedefs);
+	hashEntry(hash, entries.things);
+	hashEntry(hash, entries.textmap);
+	hashEntry(hash, entries.sidedefs, true);
+	hashEntry(hash, entries.sectors, true);
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [name] is the name of a binary format map lump
+// -----------------------------------------------------------------------------
+bool isMapLump(string_view name)
+{
+	static const vector<string_view> map_lumps = { "THINGS",   "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS",
+												   "SSECTORS", "NODES",    "SECTORS",  "REJECT",   "BLOCKMAP",
+												   "BEHAVIOR", "SCRIPTS",  "LEAFS",    "LIGHTS",   "MACROS" };
+	return std::find(map_lumps.begin(), map_lumps.end(), name) != map_lumps.end();
+}
+
+// -----------------------------------------------------------------------------
+// Reads the lumps of the first map in the wad data in [lumps], and determines
+// its format from the lumps present. Lumps are identified by name only, since
+// entry type detection isn't available off the main thread
+// -----------------------------------------------------------------------------
+bool readWadLumps(MapLumps& lumps)
+{
+	const auto& wad  = lumps.wad;
+	auto        data = wad.data();
+	if (wad.size() < 12 || (data[0] != 'P' && data[0] != 'I') || data[1] != 'W' || data[2] != 'A' || data[3] != 'D')
+		return false;
+
+	// Read directory
+	auto n_lumps    = wxINT32_SWAP_ON_BE(readValue<int32_t>(data, 4));
+	auto dir_offset = wxINT32_SWAP_ON_BE(readValue<int32_t>(data, 8));
+	if (n_lumps < 0 || dir_offset < 0 || static_cast<size_t>(dir_offset) + n_lumps * 16ull > wad.size())
+		return false;
+
+	struct Lump
+	{
+		string   name;
+		uint32_t offset;
+		uint32_t size;
+	};
+	vector<Lump> dir(n_lumps);
+	for (int a = 0; a < n_lumps; a++)
+	{
+		auto entry    = dir_offset + a * 16;
+		dir[a].offset = wxUINT32_SWAP_ON_BE(readValue<uint32_t>(data, entry));
+		dir[a].size   = wxUINT32_SWAP_ON_BE(readValue<uint32_t>(data, entry + 4));
+		auto name     = reinterpret_cast<const char*>(data) + entry + 8;
+		dir[a].name   = strutil::upper(string_view(name, strnlen(name, 8)));
+		if (static_cast<uint64_t>(dir[a].offset) + dir[a].size > wad.size())
+			dir[a].size = 0;
+	}
+
+	auto export_lump = [&wad](const Lump& lump, MemChunk& mc) {
+		if (lump.size > 0)
+			mc.importShared(wad, lump.offset, lump.size);
+	};
+
+	// Find the first map (a marker followed by TEXTMAP or map lumps)
+	for (int a = 1; a < n_lumps; a++)
+	{
+		// UDMF
+		if (dir[a].name == "TEXTMAP")
+		{
+			lumps.format = MapFormat::UDMF;
+			export_lump(dir[a], lumps.textmap);
+			return lumps.textmap.hasData();
+		}
+
+		// Binary format
+		if (dir[a].name == "THINGS" || dir[a].name == "LINEDEFS")
+		{
+			lumps.format = MapFormat::Doom;
+			for (int b = a; b < n_lumps && isMapLump(dir[b].name); b++)
+			{
+				auto& name = dir[b].name;
+				if (name == "VERTEXES")
+					export_lump(dir[b], lumps.vertexes);
+				else if (name == "LINEDEFS")
+					export_lump(dir[b], lumps.linedefs);
+				else if (name == "THINGS")
+					export_lump(dir[b], lumps.things);
+				else if (name == "SIDEDEFS")
+					lumps.sidedefs_size = dir[b].size;
+				else if (name == "SECTORS")
+					lumps.sectors_size = dir[b].size;
+				else if (name == "BEHAVIOR")
+					lumps.format = MapFormat::Hexen;
+				else if (name == "LEAFS" || name == "LIGHTS" || name == "MACROS")
+					lumps.format = MapFormat::Doom64;
+			}
+
+			return lumps.vertexes.hasData() && lumps.linedefs.hasData();
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Parses UDMF [textmap] data into [map]
+// -----------------------------------------------------------------------------
+bool parseUDMF(const MemChunk& textmap, MapData& map)
+{
+	Tokenizer tz;
+	tz.openMem(textmap, "TEXTMAP");
+
+	// Skips to the end of the current statement or block
+	auto skip_to = [&tz](string& token, const char* end) {
+		do
+		{
+			token = tz.getToken();
+		} while (token != end && !token.empty());
+	};
+
+	// Reads the x and y properties of a vertex or thing block
+	auto read_xy = [&tz, &skip_to](string& token, Vec2d& pos) {
+		bool got_x = false;
+		bool got_y = false;
+		do
+		{
+			token = tz.getToken();
+			if (strutil::equalCI(token, "x") || strutil::equalCI(token, "y"))
+			{
+				bool is_x = strutil::equalCI(token, "x");
+				if (tz.getToken() != "=")
+					return false;
+				if (is_x)
+					pos.x = tz.getDouble(), got_x = true;
+				else
+					pos.y = tz.getDouble(), got_y = true;
+				skip_to(token, ";");
+			}
+		} while (token != "}" && !token.empty());
+
+		return got_x && got_y;
+	};
+
+	auto token = tz.getToken();
+	while (!token.empty())
+	{
+		if (strutil::equalCI(token, "namespace"))
+			skip_to(token, ";");
+		else if (strutil::equalCI(token, "vertex"))
+		{
+			Vec2d pos;
+			if (!read_xy(token, pos))
+			{
+				log::error("Bad vertex {} in UDMF map data", map.vertices.size());
+				return false;
+			}
+			map.vertices.push_back(pos);
+		}
+		else if (strutil::equalCI(token, "linedef"))
+		{
+			Line line;
+			bool got_v1 = false;
+			bool got_v2 = false;
+			do
+			{
+				token = tz.getToken();
+				if (strutil::equalCI(token, "v1") || strutil::equalCI(token, "v2"))
+				{
+					bool is_v1 = strutil::equalCI(token, "v1");
+					if (tz.getToken() != "=")
+					{
+						log::error("Bad syntax for linedef {} in UDMF map data", map.lines.size());
+						return false;
+					}
+					if (is_v1)
+						line.v1 = tz.getInteger(), got_v1 = true;
+					else
+						line.v2 = tz.getInteger(), got_v2 = true;
+					skip_to(token, ";");
+				}
+				else if (strutil::equalCI(token, "special"))
+				{
+					line.special = true;
+					skip_to(token, ";");
+				}
+				else if (strutil::equalCI(token, "sideback"))
+				{
+					line.twosided = true;
+					skip_to(token, ";");
+				}
+			} while (token != "}" && !token.empty());
+
+			if (!got_v1 || !got_v2)
+			{
+				log::error("Bad line {} in UDMF map data", map.lines.size());
+				return false;
+			}
+			map.lines.push_back(line);
+		}
+		else if (strutil::equalCI(token, "thing"))
+		{
+			Vec2d pos;
+			if (!read_xy(token, pos))
+			{
+				log::error("Bad thing {} in UDMF map data", map.things.size());
+				return false;
+			}
+			map.things.push_back(pos);
+		}
+		else
+		{
+			// Check for side or sector definition (increase counts)
+			if (strutil::equalCI(token, "sidedef"))
+				map.n_sides++;
+			else if (strutil::equalCI(token, "sector"))
+				map.n_sectors++;
+
+			// Map preview ignores sidedefs, sectors, comments,
+			// unknown fields, etc. so skip to end of block
+			skip_to(token, "}");
+		}
+
+		// Iterate to next token
+		token = tz.getToken();
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads binary format lines of type L from [data] into [map]
+// -----------------------------------------------------------------------------
+template<typename L> void readLines(const MemChunk& data, MapData& map, bool macros)
+{
+	auto n_lines = data.size() / sizeof(L);
+	map.lines.reserve(n_lines);
+	for (size_t a = 0; a < n_lines; a++)
+	{
+		auto l = readValue<L>(data.data(), a * sizeof(L));
+
+		Line line;
+		line.v1       = l.vertex1;
+		line.v2       = l.vertex2;
+		line.twosided = l.side2 != 0xFFFF;
+		if (macros && (l.type & 0x100))
+			line.macro = true;
+		else
+			line.special = l.type > 0;
+		map.lines.push_back(line);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads binary format things of type T from [data] into [map]
+// -----------------------------------------------------------------------------
+template<typename T> void readThings(const MemChunk& data, MapData& map)
+{
+	auto n_things = data.size() / sizeof(T);
+	map.things.reserve(n_things);
+	for (size_t a = 0; a < n_things; a++)
+	{
+		auto t = readValue<T>(data.data(), a * sizeof(T));
+		map.things.emplace_back(t.x, t.y);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Parses binary format map [lumps] into [map]
+// -----------------------------------------------------------------------------
+bool parseBinary(const MapLumps& lumps, MapData& map)
+{
+	// Vertices
+	if (lumps.format == MapFormat::Doom64)
+	{
+		auto n_verts = lumps.vertexes.size() / sizeof(Doom64MapFormat::Vertex);
+		map.vertices.reserve(n_verts);
+		for (size_t a = 0; a < n_verts; a++)
+		{
+			auto v = readValue<Doom64MapFormat::Vertex>(lumps.vertexes.data(), a * sizeof(Doom64MapFormat::Vertex));
+			map.vertices.emplace_back(static_cast<double>(v.x) / 65536, static_cast<double>(v.y) / 65536);
+		}
+	}
+	else
+	{
+		auto n_verts = lumps.vertexes.size() / sizeof(DoomMapFormat::Vertex);
+		map.vertices.reserve(n_verts);
+		for (size_t a = 0; a < n_verts; a++)
+		{
+			auto v = readValue<DoomMapFormat::Vertex>(lumps.vertexes.data(), a * sizeof(DoomMapFormat::Vertex));
+			map.vertices.emplace_back(v.x, v.y);
+		}
+	}
+
+	// Lines, things, sides & sectors (count only)
+	switch (lumps.format)
+	{
+	case MapFormat::Doom:
+		readLines<DoomMapFormat::LineDef>(lumps.linedefs, map, false);
+		readThings<DoomMapFormat::Thing>(lumps.things, map);
+		map.n_sides   = lumps.sidedefs_size / sizeof(DoomMapFormat::SideDef);
+		map.n_sectors = lumps.sectors_size / sizeof(DoomMapFormat::Sector);
+		break;
+	case MapFormat::Hexen:
+		readLines<HexenMapFormat::LineDef>(lumps.linedefs, map, false);
+		readThings<HexenMapFormat::Thing>(lumps.things, map);
+		map.n_sides   = lumps.sidedefs_size / sizeof(DoomMapFormat::SideDef);
+		map.n_sectors = lumps.sectors_size / sizeof(DoomMapFormat::Sector);
+		break;
+	case MapFormat::Doom64:
+		readLines<Doom64MapFormat::LineDef>(lumps.linedefs, map, true);
+		readThings<Doom64MapFormat::Thing>(lumps.things, map);
+		map.n_sides   = lumps.sidedefs_size / sizeof(Doom64MapFormat::SideDef);
+		map.n_sectors = lumps.sectors_size / sizeof(Doom64MapFormat::Sector);
+		break;
+	default: return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Parses the map in [lumps]. Returns nullptr if the map is invalid.
+// This is called on worker threads
+// -----------------------------------------------------------------------------
+shared_ptr<const MapData> parse(MapLumps& lumps)
+{
+	if (lumps.wad.hasData() && !readWadLumps(lumps))
+		return nullptr;
+
+	auto map = std::make_shared<MapData>();
+	if (lumps.format == MapFormat::UDMF ? !parseUDMF(lumps.textmap, *map) : !parseBinary(lumps, *map))
+		return nullptr;
+
+	// Remove lines with invalid vertices
+	auto n_verts = map->vertices.size();
+	map->lines.erase(
+		std::remove_if(
+			map->lines.begin(),
+			map->lines.end(),
+			[n_verts](const Line& line) { return line.v1 >= n_verts || line.v2 >= n_verts; }),
+		map->lines.end());
+
+	// Get extents
+	if (!map->vertices.empty())
+	{
+		map->min = map->max = map->vertices[0];
+		for (const auto& vertex : map->vertices)
+		{
+			map->min.x = std::min(map->min.x, vertex.x);
+			map->min.y = std::min(map->min.y, vertex.y);
+			map->max.x = std::max(map->max.x, vertex.x);
+			map->max.y = std::max(map->max.y, vertex.y);
+		}
+	}
+
+	return map;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (possibly still loading) preview data for [map] from the cache.
+// If it isn't cached, the map's lumps are queued to be decoded on a worker
+// thread. Returns an invalid future if [map] has no map data
+// -----------------------------------------------------------------------------
+MapFuture request(const Archive::MapDesc& map)
+{
+	if (map.head.expired())
+		return {};
+
+	auto entries = findEntries(map);
+	if (!entries.wad && !entries.textmap && (!entries.vertexes || !entries.linedefs))
+		return {};
+
+	// Check cache
+	auto key = cacheKey(map.format, entries);
+	for (auto i = cache.begin(); i != cache.end(); ++i)
+	{
+		if (i->key == key)
+		{
+			cache.splice(cache.begin(), cache, i);
+			return i->data;
+		}
+	}
+
+	// Get lump data for the worker (shared, not copied, until modified)
+	auto lumps    = std::make_shared<MapLumps>();
+	lumps->format = map.format;
+	if (entries.wad)
+		lumps->wad = entries.wad->data();
+	else if (map.format == MapFormat::UDMF)
+	{
+		if (!entries.textmap)
+			return {};
+		lumps->textmap = entries.textmap->data();
+	}
+	else
+	{
+		if (!entries.vertexes || !entries.linedefs)
+			return {};
+		lumps->vertexes = entries.vertexes->data();
+		lumps->linedefs = entries.linedefs->data();
+		if (entries.things)
+			lumps->things = entries.things->data();
+		if (entries.sidedefs && entries.sectors)
+		{
+			lumps->sidedefs_size = entries.sidedefs->size();
+			lumps->sectors_size  = entries.sectors->size();
+		}
+	}
+
+	auto      promise = std::make_shared<std::promise<shared_ptr<const MapData>>>();
+	MapFuture future  = promise->get_future().share();
+	threadpool::enqueue([lumps, promise]() {
+		try
+		{
+			promise->set_value(parse(*lumps));
+		}
+		catch (...)
+		{
+			promise->set_value(nullptr);
+		}
+	});
+
+	// Add to cache
+	cache.push_front({ key, future });
+	while (cache.size() > static_cast<size_t>(std::max(1, static_cast<int>(map_preview_cache_size))))
+		cache.pop_back();
+
+	return future;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// mappreview Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the preview data for [map], waiting for it to be decoded if needed.
+// Returns nullptr if [map] is invalid
+// -----------------------------------------------------------------------------
+shared_ptr<const MapData> mappreview::mapData(const Archive::MapDesc& map)
+{
+	auto future = request(map);
+	return future.valid() ? future.get() : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Queues all [maps] (up to the cache size) to be decoded in the background,
+// so they are ready when later requested via mapData
+// -----------------------------------------------------------------------------
+void mappreview::prefetch(const vector<Archive::MapDesc>& maps)
+{
+	auto count = std::min<size_t>(maps.size(), std::max(0, static_cast<int>(map_preview_cache_size)));
+	for (size_t a = 0; a < count; a++)
+		request(maps[a]);
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached map preview data
+// -----------------------------------------------------------------------------
+void mappreview::clearCache()
+{
+	cache.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current map image colours from the colour configuration
+// -----------------------------------------------------------------------------
+Colours mappreview::imageColours()
+{
+	Colours colours;
+	colours.background   = colourconfig::colour("map_image_background");
+	colours.line_1s      = colourconfig::colour("map_image_line_1s");
+	colours.line_2s      = colourconfig::colour("map_image_line_2s");
+	colours.line_special = colourconfig::colour("map_image_line_special");
+	colours.line_macro   = colourconfig::colour("map_image_line_macro");
+	return colours;
+}
+
+// -----------------------------------------------------------------------------
+// Renders [map] into [image] at [width]x[height], with anti-aliased lines of
+// [thickness] pixels. 2-sided lines are drawn first, so 1-sided lines are
+// always visible over them. The image is split into horizontal bands which
+// are rasterised in parallel
+// -----------------------------------------------------------------------------
+bool mappreview::render(const MapData& map, SImage& image, int width, int height, float thickness, const Colours& colours)
+{
+	if (width <= 0 || height <= 0)
+		return false;
+
+	// Zoom/offset to fit whole map
+	double map_width  = std::max(1., map.max.x - map.min.x);
+	double map_height = std::max(1., map.max.y - map.min.y);
+	double zoom       = std::min(width / map_width, height / map_height) * 0.95;
+	Vec2d  centre     = { map.min.x + (map.max.x - map.min.x) * 0.5, map.min.y + (map.max.y - map.min.y) * 0.5 };
+
+	// Get line segments in image space, 2-sided first
+	struct Segment
+	{
+		float   x1, y1, x2, y2;
+		float   min_y, max_y;
+		ColRGBA colour;
+	};
+	vector<Segment> segments;
+	segments.reserve(map.lines.size());
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (const auto& line : map.lines)
+		{
+			if (line.twosided != (pass == 0))
+				continue;
+
+			auto& v1 = map.vertices[line.v1];
+			auto& v2 = map.vertices[line.v2];
+
+			Segment seg;
+			seg.x1     = width * 0.5 + (v1.x - centre.x) * zoom;
+			seg.y1     = height * 0.5 - (v1.y - centre.y) * zoom;
+			seg.x2     = width * 0.5 + (v2.x - centre.x) * zoom;
+			seg.y2     = height * 0.5 - (v2.y - centre.y) * zoom;
+			seg.min_y  = std::min(seg.y1, seg.y2);
+			seg.max_y  = std::max(seg.y1, seg.y2);
+			if (line.special)
+				seg.colour = colours.line_special;
+			else if (line.macro)
+				seg.colour = colours.line_macro;
+			else if (line.twosided)
+				seg.colour = colours.line_2s;
+			else
+				seg.colour = colours.line_1s;
+			segments.push_back(seg);
+		}
+	}
+
+	// Clear to background
+	vector<uint8_t> buffer(static_cast<size_t>(width) * height * 4);
+	for (size_t a = 0; a < buffer.size(); a += 4)
+	{
+		buffer[a]     = colours.background.r;
+		buffer[a + 1] = colours.background.g;
+		buffer[a + 2] = colours.background.b;
+		buffer[a + 3] = colours.background.a;
+	}
+
+	// Draw lines in bands
+	float half_width = std::max(thickness, 0.5f) * 0.5f;
+	float reach      = half_width + 1.f;
+	auto  n_bands    = (height + render_band_height - 1) / render_band_height;
+	threadpool::parallelFor(n_bands, [&](size_t band) {
+		int band_start = band * render_band_height;
+		int band_end   = std::min<int>(band_start + render_band_height, height);
+
+		for (const auto& seg : segments)
+		{
+			if (seg.max_y + reach < band_start || seg.min_y - reach > band_end)
+				continue;
+
+			float dx        = seg.x2 - seg.x1;
+			float dy        = seg.y2 - seg.y1;
+			float len_sq    = dx * dx + dy * dy;
+			int   row_start = std::max(band_start, static_cast<int>(std::floor(seg.min_y - reach)));
+			int   row_end   = std::min(band_end - 1, static_cast<int>(std::ceil(seg.max_y + reach)));
+			for (int y = row_start; y <= row_end; y++)
+			{
+				// Get the horizontal extent of the line within reach of this row
+				float py = y + 0.5f;
+				float x_min, x_max;
+				if (std::abs(dy) < 0.0001f)
+				{
+					x_min = std::min(seg.x1, seg.x2);
+					x_max = std::max(seg.x1, seg.x2);
+				}
+				else
+				{
+					float ta = std::clamp((py - reach - seg.y1) / dy, 0.f, 1.f);
+					float tb = std::clamp((py + reach - seg.y1) / dy, 0.f, 1.f);
+					x_min    = seg.x1 + dx * std::min(ta, tb);
+					x_max    = seg.x1 + dx * std::max(ta, tb);
+					if (x_min > x_max)
+						std::swap(x_min, x_max);
+				}
+				int col_start = std::max(0, static_cast<int>(std::floor(x_min - reach)));
+				int col_end   = std::min(width - 1, static_cast<int>(std::ceil(x_max + reach)));
+
+				auto row = buffer.data() + static_cast<size_t>(y) * width * 4;
+				for (int x = col_start; x <= col_end; x++)
+				{
+					// Get distance from pixel centre to segment
+					float px = x + 0.5f;
+					float t  = 0.f;
+					if (len_sq > 0.f)
+						t = std::clamp(((px - seg.x1) * dx + (py - seg.y1) * dy) / len_sq, 0.f, 1.f);
+					float ox       = px - (seg.x1 + dx * t);
+					float oy       = py - (seg.y1 + dy * t);
+					float coverage = half_width + 0.5f - std::sqrt(ox * ox + oy * oy);
+					if (coverage <= 0.f)
+						continue;
+
+					// Blend
+					float alpha = std::min(coverage, 1.f) * seg.colour.a / 255.f;
+					auto  pixel = row + x * 4;
+					pixel[0]    = pixel[0] + (seg.colour.r - pixel[0]) * alpha;
+					pixel[1]    = pixel[1] + (seg.colour.g - pixel[1]) * alpha;
+					pixel[2]    = pixel[2] + (seg.colour.b - pixel[2]) * alpha;
+					pixel[3]    = pixel[3] + (255 - pixel[3]) * alpha;
+				}
+			}
+		}
+	});
+
+	return image.setImageData(buffer, width, height, SImage::Type::RGBA);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+CONSOLE_COMMAND(map_preview_cache_clear, 0, false)
+{
+	mappreview::clearCache();
+	log::console("Map preview cache cleared");
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Archive/Archive.h"
+
+namespace slade
+{
+class SImage;
+
+// Basic map data (vertices, lines and things) for map previews and thumbnails.
+// Map lumps are decoded on worker threads and the results are cached by a hash
+// of the lump data, so browsing the maps in an archive doesn't reparse them.
+// The cache and all functions here must only be used from the main thread
+namespace mappreview
+{
+	struct Line
+	{
+		unsigned v1       = 0;
+		unsigned v2       = 0;
+		bool     twosided = false;
+		bool     special  = false;
+		bool     macro    = false;
+	};
+
+	struct MapData
+	{
+		vector<Vec2d> vertices;
+		vector<Line>  lines;
+		vector<Vec2d> things;
+		unsigned      n_sides   = 0;
+		unsigned      n_sectors = 0;
+		Vec2d         min;
+		Vec2d         max;
+	};
+
+	struct Colours
+	{
+		ColRGBA background;
+		ColRGBA line_1s;
+		ColRGBA line_2s;
+		ColRGBA line_special;
+		ColRGBA line_macro;
+	};
+
+	shared_ptr<const MapData> mapData(const Archive::MapDesc& map);
+	void                      prefetch(const vector<Archive::MapDesc>& maps);
+	void                      clearCache();
+
+	Colours imageColours();
+	bool    render(const MapData& map, SImage& image, int width, int height, float thickness, const Colours& colours);
+} // namespace mappreview
+} // namespace slade
@@ -0,0 +1,85 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapSnapshot.cpp
+// Description: MapSnapshot class - an immutable, thread-safe copy of the state
+//              of all objects in a map, sharing unmodified objects with
+//              previous snapshots of the same map
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapSnapshot.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// MapSnapshot Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the list of all objects of [type] in the snapshot, in index order
+// -----------------------------------------------------------------------------
+const vector<MapSnapshot::Object>& MapSnapshot::objects(MapObject::Type type) const
+{
+	static const vector<Object> no_objects;
+
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return vertices_;
+	case MapObject::Type::Side: return sides_;
+	case MapObject::Type::Line: return lines_;
+	case MapObject::Type::Sector: return sectors_;
+	case MapObject::Type::Thing: return things_;
+	default: return no_objects;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the object with the given [id], or null if it wasn't in the map when
+// the snapshot was taken
+// -----------------------------------------------------------------------------
+const MapObject::Backup* MapSnapshot::objectById(unsigned id) const
+{
+	return id < by_id_.size() ? by_id_[id].object : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the object with the given [id] (within the list of
+// objects of its type), or -1 if it wasn't in the map when the snapshot was
+// taken
+// -----------------------------------------------------------------------------
+int MapSnapshot::objectIndex(unsigned id) const
+{
+	if (id >= by_id_.size() || !by_id_[id].object)
+		return -1;
+
+	return static_cast<int>(by_id_[id].index);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "MapObject/MapObject.h"
+
+namespace slade
+{
+// An immutable copy of the state of all objects in a map at a point in time,
+// that can be read from any thread while the map itself continues to be edited
+// on the main thread (eg. by map checks, backups or node builds running as
+// background jobs).
+//
+// Each object is stored as a MapObject::Backup, with references to other
+// objects (eg. line vertices) stored as object ids. Object backups are shared
+// between snapshots of the same map, so taking a new snapshot only copies the
+// objects that were modified since the previous one.
+// Snapshots are taken with MapObjectCollection::snapshot (main thread only)
+class MapSnapshot
+{
+	friend class MapObjectCollection;
+
+public:
+	using Object = shared_ptr<const MapObject::Backup>;
+
+	MapSnapshot()  = default;
+	~MapSnapshot() = default;
+
+	long time() const { return time_; }
+
+	const vector<Object>& objects(MapObject::Type type) const;
+	const vector<Object>& vertices() const { return vertices_; }
+	const vector<Object>& sides() const { return sides_; }
+	const vector<Object>& lines() const { return lines_; }
+	const vector<Object>& sectors() const { return sectors_; }
+	const vector<Object>& things() const { return things_; }
+
+	const MapObject::Backup* objectById(unsigned id) const;
+	int                      objectIndex(unsigned id) const;
+
+private:
+	// Location of an object (by id) within the snapshot
+	struct ObjectRef
+	{
+		const MapObject::Backup* object = nullptr; // Null if not in the map
+		unsigned                 index  = 0;
+	};
+
+	long              time_ = 0;
+	vector<Object>    vertices_;
+	vector<Object>    sides_;
+	vector<Object>    lines_;
+	vector<Object>    sectors_;
+	vector<Object>    things_;
+	vector<ObjectRef> by_id_;
+};
+} // namespace slade
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSpecials.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "SLADEMap.h"
 #include "Utility/MathStuff.h"
@@ -66,13 +67,19 @@ void MapSpecials::reset()
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+	special_inputs_.clear();
+	processed_time_  = 0;
+	colours_updated_ = app::runTimer();
 }
 
 // -----------------------------------------------------------------------------
 // Process map specials, depending on the current game/port
 // -----------------------------------------------------------------------------
-void MapSpecials::processMapSpecials(SLADEMap* map) const
+void MapSpecials::processMapSpecials(SLADEMap* map)
 {
+	processed_time_ = app::runTimer();
+	special_inputs_.clear();
+
 	// ZDoom
 	if (game::configuration().currentPort() == "zdoom")
 		processZDoomMapSpecials(map);
@@ -81,6 +88,65 @@ void MapSpecials::processMapSpecials(SLADEMap* map) const
 		processEternitySlopes(map);
 }
 
+// -----------------------------------------------------------------------------
+// Re-processes map specials for only the objects in [map] that were modified
+// since specials were last processed, and any sectors whose planes depend on
+// them. Falls back to processing everything if specials haven't been processed
+// yet, or any objects were removed (or restored via undo/redo) since then
+// -----------------------------------------------------------------------------
+void MapSpecials::updateMapSpecials(SLADEMap* map)
+{
+	const auto& data = map->mapData();
+	if (processed_time_ == 0 || data.lastRemovedTime() >= processed_time_)
+	{
+		processMapSpecials(map);
+		return;
+	}
+
+	auto modified   = data.modifiedObjects(processed_time_, MapObject::Type::Object);
+	processed_time_ = app::runTimer();
+	if (modified.empty())
+		return;
+
+	const auto& port = game::configuration().currentPort();
+	if (port != "zdoom" && port != "eternity")
+		return;
+
+	// Line specials on modified lines, or tagging them
+	if (port == "zdoom")
+	{
+		std::unordered_set<MapObject*> modified_lines;
+		std::unordered_set<int>        modified_ids;
+		for (auto object : modified)
+			if (object->objType() == MapObject::Type::Line)
+			{
+				modified_lines.insert(object);
+				modified_ids.insert(dynamic_cast<MapLine*>(object)->id());
+			}
+
+		if (!modified_lines.empty())
+			for (unsigned a = 0; a < map->nLines(); a++)
+			{
+				auto line = map->line(a);
+				if (line->special() == 208 && (modified_lines.count(line) || modified_ids.count(line->arg(0))))
+					processZDoomLineSpecial(line);
+			}
+	}
+
+	// Slopes, for affected sectors only
+	findUpdateSectors(map, modified);
+	if (update_sectors_.empty())
+		return;
+
+	for (auto sector : update_sectors_)
+		special_inputs_.erase(sector);
+
+	update_all_ = false;
+	processSlopes(map);
+	update_all_ = true;
+	update_sectors_.clear();
+}
+
 // -----------------------------------------------------------------------------
 // Process a line's special, depending on the current game/port
 // -----------------------------------------------------------------------------
@@ -180,7 +246,7 @@ void MapSpecials::updateTaggedSectors(SLADEMap* map)
 // Process ZDoom map specials, mostly to convert hexen specials to UDMF
 // counterparts
 // -----------------------------------------------------------------------------
-void MapSpecials::processZDoomMapSpecials(SLADEMap* map) const
+void MapSpecials::processZDoomMapSpecials(SLADEMap* map)
 {
 	// Line specials
 	for (unsigned a = 0; a < map->nLines(); a++)
@@ -240,6 +306,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+	colours_updated_ = app::runTimer();
 
 	if (!entry || entry->size() == 0)
 		return;
@@ -356,10 +423,301 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Records that the planes of [target] are calculated from [inputs], so they
+// will be recalculated if any of them are modified
+// -----------------------------------------------------------------------------
+void MapSpecials::addInputs(MapSector* target, std::initializer_list<MapObject*> inputs)
+{
+	auto& objects = special_inputs_[target].objects;
+	for (auto input : inputs)
+		if (input && input != target)
+			objects.push_back(input);
+}
+
+// -----------------------------------------------------------------------------
+// Records that the planes of [target] are calculated from whichever object(s)
+// of [type] have [id], so they will be recalculated if an object with [id] is
+// modified
+// -----------------------------------------------------------------------------
+void MapSpecials::addIdInput(MapSector* target, MapObject::Type type, int id)
+{
+	special_inputs_[target].ids.emplace_back(type, id);
+}
+
+// -----------------------------------------------------------------------------
+// Finds all sectors in [map] that need their slopes recalculated, given the
+// [modified] objects, and adds them to [update_sectors_].
+// This includes sectors touching the modified objects, sectors whose slopes
+// were calculated from them, and (so that everything involved is recalculated
+// in the same order as a full pass) any special sectors those depend on
+// -----------------------------------------------------------------------------
+void MapSpecials::findUpdateSectors(SLADEMap* map, const vector<MapObject*>& modified)
+{
+	// Build lookups for the sectors calculated from each input
+	std::unordered_map<MapObject*, vector<MapSector*>>            dependents;
+	std::map<std::pair<MapObject::Type, int>, vector<MapSector*>> id_dependents;
+	for (const auto& [target, inputs] : special_inputs_)
+	{
+		for (auto object : inputs.objects)
+			dependents[object].push_back(target);
+		for (const auto& id : inputs.ids)
+			id_dependents[id].push_back(target);
+	}
+
+	vector<MapSector*> pending;
+
+	auto addDependents = [&](MapObject* object) {
+		if (auto i = dependents.find(object); i != dependents.end())
+			pending.insert(pending.end(), i->second.begin(), i->second.end());
+	};
+	auto addIdDependents = [&](MapObject::Type type, int id) {
+		if (auto i = id_dependents.find({ type, id }); i != id_dependents.end())
+			pending.insert(pending.end(), i->second.begin(), i->second.end());
+	};
+	auto addLineSectors = [&](MapLine* line) {
+		if (line->frontSector())
+			pending.push_back(line->frontSector());
+		if (line->backSector())
+			pending.push_back(line->backSector());
+	};
+
+	// Get sectors affected by modified objects
+	for (auto object : modified)
+	{
+		addDependents(object);
+
+		switch (object->objType())
+		{
+		case MapObject::Type::Sector:
+		{
+			auto sector = dynamic_cast<MapSector*>(object);
+			pending.push_back(sector);
+			addIdDependents(MapObject::Type::Sector, sector->id());
+			break;
+		}
+		case MapObject::Type::Side:
+		{
+			auto side = dynamic_cast<MapSide*>(object);
+			if (side->sector())
+				pending.push_back(side->sector());
+			if (side->parentLine())
+				addLineSectors(side->parentLine());
+			break;
+		}
+		case MapObject::Type::Line:
+		{
+			auto line = dynamic_cast<MapLine*>(object);
+			addLineSectors(line);
+			addIdDependents(MapObject::Type::Line, line->id());
+			break;
+		}
+		case MapObject::Type::Vertex:
+			for (auto line : dynamic_cast<MapVertex*>(object)->connectedLines())
+				addLineSectors(line);
+			break;
+		case MapObject::Type::Thing:
+		{
+			// Slope things can affect sectors other than the one they are in
+			auto thing = dynamic_cast<MapThing*>(object);
+			auto type  = thing->type();
+			if (type == 9500 || type == 9501)
+			{
+				if (thing->arg(0))
+					for (auto line : map->lines().allWithId(thing->arg(0)))
+						addLineSectors(line);
+			}
+			else if (type == 1504 || type == 1505)
+			{
+				if (auto vertex = map->vertices().vertexAt(thing->xPos(), thing->yPos()))
+					for (auto line : vertex->connectedLines())
+						addLineSectors(line);
+			}
+			else if (type == 9502 || type == 9503 || type == 1500 || type == 1501 || type == 9510 || type == 9511)
+			{
+				if (auto sector = map->sectors().atPos(thing->position()))
+					pending.push_back(sector);
+			}
+			break;
+		}
+		default: break;
+		}
+	}
+
+	// Add them and all sectors calculated from them
+	update_sectors_.clear();
+	while (!pending.empty())
+	{
+		auto sector = pending.back();
+		pending.pop_back();
+		if (update_sectors_.insert(sector).second)
+			addDependents(sector);
+	}
+
+	// Add any special sectors they are calculated from
+	pending.assign(update_sectors_.begin(), update_sectors_.end());
+	while (!pending.empty())
+	{
+		auto i = special_inputs_.find(pending.back());
+		pending.pop_back();
+		if (i == special_inputs_.end())
+			continue;
+
+		for (auto object : i->second.objects)
+		{
+			if (object->objType() != MapObject::Type::Sector)
+				continue;
+
+			auto source = dynamic_cast<MapSector*>(object);
+			if (special_inputs_.count(source) && update_sectors_.insert(source).second)
+				pending.push_back(source);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Process slope specials, depending on the current game/port
+// -----------------------------------------------------------------------------
+void MapSpecials::processSlopes(SLADEMap* map)
+{
+	if (game::configuration().currentPort() == "zdoom")
+		processZDoomSlopes(map);
+	else if (game::configuration().currentPort() == "eternity")
+		processEternitySlopes(map);
+}
+
+// -----------------------------------------------------------------------------
+// Resets all sectors being updated in [map] to flat planes
+// -----------------------------------------------------------------------------
+void MapSpecials::resetPlanes(SLADEMap* map) const
+{
+	for (unsigned a = 0; a < map->nSectors(); a++)
+	{
+		auto target = map->sector(a);
+		if (!updateSector(target))
+			continue;
+
+		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
+		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Applies all Plane_Align (line special 181) specials in [map]
+// -----------------------------------------------------------------------------
+void MapSpecials::processPlaneAlignLines(SLADEMap* map)
+{
+	for (unsigned a = 0; a < map->nLines(); a++)
+	{
+		auto line = map->line(a);
+		if (line->special() != 181)
+			continue;
+
+		auto sector1 = line->frontSector();
+		auto sector2 = line->backSector();
+		if (!sector1 || !sector2)
+		{
+			if (update_all_)
+				log::warning("Ignoring Plane_Align on one-sided line {}", line->index());
+			continue;
+		}
+		if (sector1 == sector2)
+		{
+			if (update_all_)
+				log::warning("Ignoring Plane_Align on line {}, which has the same sector on both sides", line->index());
+			continue;
+		}
+
+		int floor_arg = line->arg(0);
+		if (floor_arg == 1 && updateSector(sector1))
+			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
+		else if (floor_arg == 2 && updateSector(sector2))
+			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
+
+		int ceiling_arg = line->arg(1);
+		if (ceiling_arg == 1 && updateSector(sector1))
+			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
+		else if (ceiling_arg == 2 && updateSector(sector2))
+			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Applies all Plane_Copy (line special 118) specials in [map]
+// -----------------------------------------------------------------------------
+void MapSpecials::processPlaneCopyLines(SLADEMap* map)
+{
+	for (unsigned a = 0; a < map->nLines(); a++)
+	{
+		auto line = map->line(a);
+		if (line->special() != 118)
+			continue;
+
+		auto front = line->frontSector();
+		auto back  = line->backSector();
+
+		// Copies from the first sector with a tag
+		auto copyPlane = [&](int tag, bool floor) {
+			if (!front || !updateSector(front))
+				return;
+
+			auto sector = map->sectors().firstWithId(tag);
+			addInputs(front, { line, sector });
+			addIdInput(front, MapObject::Type::Sector, tag);
+			if (!sector)
+				return;
+
+			if (floor)
+				front->setFloorPlane(sector->floor().plane);
+			else
+				front->setCeilingPlane(sector->ceiling().plane);
+		};
+
+		int tag;
+		if ((tag = line->arg(0)) && front)
+			copyPlane(tag, true);
+		if ((tag = line->arg(1)) && front)
+			copyPlane(tag, false);
+		if ((tag = line->arg(2)) && back)
+			copyPlane(tag, true);
+		if ((tag = line->arg(3)) && back)
+			copyPlane(tag, false);
+
+		// The fifth "share" argument copies from one side of the line to the
+		// other
+		if (front && back)
+		{
+			int share = line->arg(4);
+
+			if ((share & 3) == 1 && updateSector(back))
+			{
+				addInputs(back, { line, front });
+				back->setFloorPlane(front->floor().plane);
+			}
+			else if ((share & 3) == 2 && updateSector(front))
+			{
+				addInputs(front, { line, back });
+				front->setFloorPlane(back->floor().plane);
+			}
+
+			if ((share & 12) == 4 && updateSector(back))
+			{
+				addInputs(back, { line, front });
+				back->setCeilingPlane(front->ceiling().plane);
+			}
+			else if ((share & 12) == 8 && updateSector(front))
+			{
+				addInputs(front, { line, back });
+				front->setCeilingPlane(back->ceiling().plane);
+			}
+		}
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Process ZDoom slope specials
 // -----------------------------------------------------------------------------
-void MapSpecials::processZDoomSlopes(SLADEMap* map) const
+void MapSpecials::processZDoomSlopes(SLADEMap* map)
 {
 	// ZDoom has a variety of slope mechanisms, which must be evaluated in a
 	// specific order.
@@ -372,17 +730,15 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	//  - Plane_Copy, in line order
 
 	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
-	}
+	resetPlanes(map);
 
 	// Floor/ceiling plane properties
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
-		auto target        = map->sector(a);
+		auto target = map->sector(a);
+		if (!updateSector(target))
+			continue;
+
 		auto floorplane    = Plane::flat(target->floor().height);
 		bool hasFloorplane = false;
 		// Check for floor plane.
@@ -411,6 +767,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 		}
 		if (hasFloorplane && !(floorplane.a == 0 && floorplane.b == 0 && floorplane.c == -1 && floorplane.d == 0))
 		{
+			addInputs(target, {});
 			target->setFloorPlane(floorplane);
 		}
 
@@ -440,42 +797,13 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 		if (hasCeilingplane
 			&& !(ceilingplane.a == 0 && ceilingplane.b == 0 && ceilingplane.c == -1 && ceilingplane.d == 0))
 		{
+			addInputs(target, {});
 			target->setCeilingPlane(ceilingplane);
 		}
 	}
 
 	// Plane_Align (line special 181)
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 181)
-			continue;
-
-		auto sector1 = line->frontSector();
-		auto sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			log::warning("Ignoring Plane_Align on one-sided line {}", line->index());
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			log::warning("Ignoring Plane_Align on line {}, which has the same sector on both sides", line->index());
-			continue;
-		}
-
-		int floor_arg = line->arg(0);
-		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
-
-		int ceiling_arg = line->arg(1);
-		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
-	}
+	processPlaneAlignLines(map);
 
 	// Line slope things (9500/9501), sector tilt things (9502/9503), and
 	// vavoom things (1500/1501), all in the same pass
@@ -508,10 +836,11 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 		if (thing->type() == 9510 || thing->type() == 9511)
 		{
 			auto target = map->sectors().atPos(thing->position());
-			if (!target)
+			if (!target || !updateSector(target))
 				continue;
 
 			// First argument is the tag of a sector whose slope should be copied
+			addInputs(target, { thing });
 			int tag = thing->arg(0);
 			if (!tag)
 			{
@@ -520,6 +849,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 			}
 
 			auto tagged_sector = map->sectors().firstWithId(tag);
+			addIdInput(target, MapObject::Type::Sector, tag);
 			if (!tagged_sector)
 			{
 				log::warning(
@@ -527,6 +857,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 				continue;
 			}
 
+			addInputs(target, { tagged_sector });
 			if (thing->type() == 9510)
 				target->setFloorPlane(tagged_sector->floor().plane);
 			else
@@ -538,8 +869,9 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	// These only affect the calculation of slopes and shouldn't be stored in
 	// the map data proper, so instead of actually changing vertex properties,
 	// we store them in a hashmap.
-	VertexHeightMap vertex_floor_heights;
-	VertexHeightMap vertex_ceiling_heights;
+	VertexHeightMap                                    vertex_floor_heights;
+	VertexHeightMap                                    vertex_ceiling_heights;
+	std::unordered_map<MapVertex*, vector<MapObject*>> vertex_height_things;
 	for (unsigned a = 0; a < map->nThings(); a++)
 	{
 		auto thing = map->thing(a);
@@ -553,6 +885,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 					vertex_floor_heights[vertex] = thing->zPos();
 				else if (thing->type() == 1505)
 					vertex_ceiling_heights[vertex] = thing->zPos();
+				vertex_height_things[vertex].push_back(thing);
 			}
 		}
 	}
@@ -564,69 +897,32 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
 		auto target = map->sector(a);
+		if (!updateSector(target))
+			continue;
+
 		vertices.clear();
 		target->putVertices(vertices);
 		if (vertices.size() != 3)
 			continue;
 
+		// Calculated from any vertex height things on its vertices
+		auto& inputs = special_inputs_[target].objects;
+		for (auto vertex : vertices)
+			if (auto i = vertex_height_things.find(vertex); i != vertex_height_things.end())
+				inputs.insert(inputs.end(), i->second.begin(), i->second.end());
+
 		applyVertexHeightSlope<SurfaceType::Floor>(target, vertices, vertex_floor_heights);
 		applyVertexHeightSlope<SurfaceType::Ceiling>(target, vertices, vertex_ceiling_heights);
 	}
 
 	// Plane_Copy
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 118)
-			continue;
-
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
-
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
-
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
-	}
+	processPlaneCopyLines(map);
 }
 
 // -----------------------------------------------------------------------------
 // Process Eternity slope specials
 // -----------------------------------------------------------------------------
-void MapSpecials::processEternitySlopes(SLADEMap* map) const
+void MapSpecials::processEternitySlopes(SLADEMap* map)
 {
 	// Eternity plans on having a few slope mechanisms,
 	// which must be evaluated in a specific order.
@@ -635,103 +931,23 @@ void MapSpecials::processEternitySlopes(SLADEMap* map) const
 	//  - Plane_Copy, in line order
 
 	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
-	}
+	resetPlanes(map);
 
 	// Plane_Align (line special 181)
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 181)
-			continue;
-
-		auto sector1 = line->frontSector();
-		auto sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			log::warning("Ignoring Plane_Align on one-sided line {}", line->index());
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			log::warning("Ignoring Plane_Align on line {}, which has the same sector on both sides", line->index());
-			continue;
-		}
-
-		int floor_arg = line->arg(0);
-		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
-
-		int ceiling_arg = line->arg(1);
-		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
-	}
+	processPlaneAlignLines(map);
 
 	// Plane_Copy
-	vector<MapSector*> sectors;
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 118)
-			continue;
-
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
-
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
-
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
-	}
+	processPlaneCopyLines(map);
 }
 
 
 // -----------------------------------------------------------------------------
 // Applies a Plane_Align special on [line], to [target] from [model]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model) const
+template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model)
 {
+	addInputs(target, { line, model });
+
 	vector<MapVertex*> vertices;
 	target->putVertices(vertices);
 
@@ -774,7 +990,7 @@ template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSect
 // -----------------------------------------------------------------------------
 // Applies a line slope special on [thing], to its containing sector in [map]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing) const
+template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing)
 {
 	int lineid = thing->arg(0);
 	if (!lineid)
@@ -797,7 +1013,7 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 			target = line->backSector();
 		else if (side > 0)
 			target = line->frontSector();
-		if (!target)
+		if (!target || !updateSector(target))
 			continue;
 
 		// Need to know the containing sector's height to find the thing's true height
@@ -809,6 +1025,9 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 			thingz = containing_sector->plane<T>().heightAt(thing->position()) + thing->zPos();
 		}
 
+		addInputs(target, { thing, line, containing_sector });
+		addIdInput(target, MapObject::Type::Line, lineid);
+
 		// Three points: endpoints of the line, and the thing itself
 		auto  target_plane = target->plane<T>();
 		Vec3d p1(line->x1(), line->y1(), target_plane.heightAt(line->start()));
@@ -821,14 +1040,16 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 // -----------------------------------------------------------------------------
 // Applies a tilt slope special on [thing], to its containing sector in [map]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, MapThing* thing) const
+template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, MapThing* thing)
 {
 	// TODO should this apply to /all/ sectors at this point, in the case of an
 	// intersection?
 	auto target = map->sectors().atPos(thing->position());
-	if (!target)
+	if (!target || !updateSector(target))
 		return;
 
+	addInputs(target, { thing });
+
 	// First argument is the tilt angle, but starting with 0 as straight down;
 	// subtracting 90 fixes that.
 	int raw_angle = thing->arg(0);
@@ -866,12 +1087,14 @@ template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, Ma
 // -----------------------------------------------------------------------------
 // Applies a vavoom slope special on [thing], to its containing sector in [map]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing) const
+template<SurfaceType T> void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing)
 {
 	auto target = map->sectors().atPos(thing->position());
-	if (!target)
+	if (!target || !updateSector(target))
 		return;
 
+	addInputs(target, { thing });
+
 	int              tid = thing->id();
 	vector<MapLine*> lines;
 	target->putLines(lines);
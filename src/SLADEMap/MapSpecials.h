@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SLADEMap/MapObject/MapSector.h"
+#include <unordered_set>
 
 namespace slade
 {
@@ -15,17 +16,19 @@ class MapSpecials
 public:
 	void reset();
 
-	void processMapSpecials(SLADEMap* map) const;
+	void processMapSpecials(SLADEMap* map);
+	void updateMapSpecials(SLADEMap* map);
 	void processLineSpecial(MapLine* line) const;
 
 	bool tagColour(int tag, ColRGBA* colour);
 	bool tagFadeColour(int tag, ColRGBA* colour);
 	bool tagColoursSet() const;
 	bool tagFadeColoursSet() const;
+	long coloursUpdatedTime() const { return colours_updated_; }
 	void updateTaggedSectors(SLADEMap* map);
 
 	// ZDoom
-	void processZDoomMapSpecials(SLADEMap* map) const;
+	void processZDoomMapSpecials(SLADEMap* map);
 	void processZDoomLineSpecial(MapLine* line) const;
 	void updateZDoomSector(MapSector* line);
 	void processACSScripts(ArchiveEntry* entry);
@@ -38,19 +41,42 @@ private:
 		ColRGBA colour;
 	};
 
+	// The objects (and line/sector ids) a special sector's planes were
+	// calculated from
+	struct SpecialInputs
+	{
+		vector<MapObject*>                      objects;
+		vector<std::pair<MapObject::Type, int>> ids;
+	};
+
 	typedef std::map<MapVertex*, double> VertexHeightMap;
 
 	vector<SectorColour> sector_colours_;
 	vector<SectorColour> sector_fadecolours_;
+	long                 colours_updated_ = 0; // Time the tag colours were last changed
 
-	void processZDoomSlopes(SLADEMap* map) const;
-	void processEternitySlopes(SLADEMap* map) const;
+	// Incremental updating
+	long                                          processed_time_ = 0; // 0 if a full pass is needed
+	std::unordered_map<MapSector*, SpecialInputs> special_inputs_;
+	std::unordered_set<MapSector*>                update_sectors_;
+	bool                                          update_all_ = true;
 
-	template<MapSector::SurfaceType>
-	void applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model_sector) const;
-	template<MapSector::SurfaceType> void   applyLineSlopeThing(SLADEMap* map, MapThing* thing) const;
-	template<MapSector::SurfaceType> void   applySectorTiltThing(SLADEMap* map, MapThing* thing) const;
-	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(SLADEMap* map, MapThing* thing) const;
+	bool updateSector(MapSector* sector) const { return update_all_ || update_sectors_.count(sector) > 0; }
+	void addInputs(MapSector* target, std::initializer_list<MapObject*> inputs);
+	void addIdInput(MapSector* target, MapObject::Type type, int id);
+	void findUpdateSectors(SLADEMap* map, const vector<MapObject*>& modified);
+	void processSlopes(SLADEMap* map);
+
+	void resetPlanes(SLADEMap* map) const;
+	void processPlaneAlignLines(SLADEMap* map);
+	void processPlaneCopyLines(SLADEMap* map);
+	void processZDoomSlopes(SLADEMap* map);
+	void processEternitySlopes(SLADEMap* map);
+
+	template<MapSector::SurfaceType> void   applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model_sector);
+	template<MapSector::SurfaceType> void   applyLineSlopeThing(SLADEMap* map, MapThing* thing);
+	template<MapSector::SurfaceType> void   applySectorTiltThing(SLADEMap* map, MapThing* thing);
+	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(SLADEMap* map, MapThing* thing);
 	template<MapSector::SurfaceType> double vertexHeight(MapVertex* vertex, MapSector* sector) const;
 	template<MapSector::SurfaceType>
 	void applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights) const;
@@ -0,0 +1,279 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapTextureUsage.cpp
+// Description: Index of the texture and flat names used by all maps in an
+//              archive (eg. for removing unused textures/flats), read directly
+//              from the map entries in parallel and cached per entry
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapTextureUsage.h"
+#include "Archive/Archive.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/ThreadPool.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "SLADEMap/MapFormat/UniversalDoomMapFormat.h"
+#include "Utility/StringUtils.h"
+#include <atomic>
+#include <unordered_map>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+enum class LumpType
+{
+	Sidedefs,
+	Sectors,
+	Textmap
+};
+
+// Names used in a single map entry
+struct LumpUsage
+{
+	weak_ptr<ArchiveEntry> entry;
+	bool                   valid = false;
+	size_t                 size  = 0;
+	uint64_t               hash  = 0; // Hash of the entry data the names were read from
+	vector<string>         textures;
+	vector<string>         flats;
+};
+
+std::unordered_map<ArchiveEntry*, LumpUsage> lump_cache;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the upper case texture name from 8-character (not necessarily null
+// terminated) [name]
+// -----------------------------------------------------------------------------
+string textureName(const char* name)
+{
+	return strutil::upper({ name, strnlen(name, 8) });
+}
+
+// -----------------------------------------------------------------------------
+// Removes any duplicates from [names]
+// -----------------------------------------------------------------------------
+void removeDuplicates(vector<string>& names)
+{
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+}
+
+// -----------------------------------------------------------------------------
+// Reads the texture and flat names used in map entry [data] of [type] into
+// [usage]. Safe to call from a worker thread
+// -----------------------------------------------------------------------------
+void readLump(const MemChunk& data, LumpType type, LumpUsage& usage)
+{
+	usage.textures.clear();
+	usage.flats.clear();
+
+	switch (type)
+	{
+	case LumpType::Sidedefs:
+	{
+		DoomMapFormat::SideDef side;
+		for (unsigned offset = 0; offset + sizeof(side) <= data.size(); offset += sizeof(side))
+		{
+			data.read(offset, &side, sizeof(side));
+			usage.textures.push_back(textureName(side.tex_upper));
+			usage.textures.push_back(textureName(side.tex_middle));
+			usage.textures.push_back(textureName(side.tex_lower));
+		}
+		break;
+	}
+	case LumpType::Sectors:
+	{
+		DoomMapFormat::Sector sector;
+		for (unsigned offset = 0; offset + sizeof(sector) <= data.size(); offset += sizeof(sector))
+		{
+			data.read(offset, &sector, sizeof(sector));
+			usage.flats.push_back(textureName(sector.f_tex));
+			usage.flats.push_back(textureName(sector.c_tex));
+		}
+		break;
+	}
+	case LumpType::Textmap:
+		UniversalDoomMapFormat::readTextureNames(data, [&usage](string_view name, bool flat) {
+			(flat ? usage.flats : usage.textures).push_back(strutil::upper(name));
+		});
+		break;
+	}
+
+	removeDuplicates(usage.textures);
+	removeDuplicates(usage.flats);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// maptextureusage::Usage Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if texture [name] is used in any map (case-insensitive)
+// -----------------------------------------------------------------------------
+bool maptextureusage::Usage::usesTexture(string_view name) const
+{
+	return textures.count(strutil::upper(name)) > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if flat [name] is used in any map (case-insensitive)
+// -----------------------------------------------------------------------------
+bool maptextureusage::Usage::usesFlat(string_view name) const
+{
+	return flats.count(strutil::upper(name)) > 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// maptextureusage Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the texture and flat names used by all maps in [archive].
+// Entries that haven't changed since they were last read are taken from the
+// cache, the rest are read on the worker threads
+// -----------------------------------------------------------------------------
+maptextureusage::Usage maptextureusage::archiveUsage(Archive& archive)
+{
+	struct Lump
+	{
+		ArchiveEntry* entry;
+		LumpType      type;
+		LumpUsage*    usage;
+		bool          unload;
+	};
+
+	// Find all map entries that can contain texture names (Doom64 format maps
+	// reference textures by index, so are skipped)
+	vector<Lump> lumps;
+	auto find_lumps = [&](string_view type_id, string_view name, LumpType type, unsigned record_size) {
+		Archive::SearchOptions opt;
+		opt.match_type = EntryType::fromId(type_id);
+		opt.match_name = name;
+		for (auto entry : archive.findAll(opt))
+			if (record_size == 0 || entry->size() % record_size == 0)
+				lumps.push_back({ entry, type, nullptr, false });
+	};
+	find_lumps("map_sidedefs", "", LumpType::Sidedefs, sizeof(DoomMapFormat::SideDef));
+	find_lumps("map_sectors", "", LumpType::Sectors, sizeof(DoomMapFormat::Sector));
+	find_lumps("udmf_textmap", "TEXTMAP", LumpType::Textmap, 0);
+
+	// Load entry data (loading from the archive isn't thread-safe) and get
+	// cached names for each entry
+	for (auto& lump : lumps)
+	{
+		lump.unload = !lump.entry->isLoaded();
+		lump.entry->data();
+
+		auto& usage = lump_cache[lump.entry];
+		if (usage.entry.lock().get() != lump.entry)
+		{
+			usage       = {};
+			usage.entry = lump.entry->getShared();
+		}
+		lump.usage = &usage;
+	}
+
+	// Read names from any entries changed since they were cached
+	std::atomic<unsigned> n_read{ 0 };
+	threadpool::parallelFor(lumps.size(), [&lumps, &n_read](size_t index) {
+		auto&       lump = lumps[index];
+		const auto& data = std::as_const(lump.entry->data(false));
+		auto        hash = data.hash();
+		if (lump.usage->valid && lump.usage->size == data.size() && lump.usage->hash == hash)
+			return;
+
+		readLump(data, lump.type, *lump.usage);
+		lump.usage->valid = true;
+		lump.usage->size  = data.size();
+		lump.usage->hash  = hash;
+		++n_read;
+	});
+
+	// Build usage index
+	Usage usage;
+	usage.n_map_entries = lumps.size();
+	for (auto& lump : lumps)
+	{
+		usage.textures.insert(lump.usage->textures.begin(), lump.usage->textures.end());
+		usage.flats.insert(lump.usage->flats.begin(), lump.usage->flats.end());
+
+		if (lump.unload)
+			lump.entry->unloadData();
+	}
+
+	// Remove cached names for entries that no longer exist
+	for (auto i = lump_cache.begin(); i != lump_cache.end();)
+	{
+		if (i->second.entry.expired())
+			i = lump_cache.erase(i);
+		else
+			++i;
+	}
+
+	log::info(
+		2,
+		"Indexed textures used in {} map entries ({} read, {} cached)",
+		lumps.size(),
+		n_read.load(),
+		lumps.size() - n_read.load());
+
+	return usage;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached map entry texture names
+// -----------------------------------------------------------------------------
+void maptextureusage::clear()
+{
+	lump_cache.clear();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <unordered_set>
+
+namespace slade
+{
+class Archive;
+
+// Index of the texture and flat names used by all maps in an archive, read
+// directly from the SIDEDEFS/SECTORS (Doom/Hexen format) and TEXTMAP (UDMF)
+// entries without opening the maps. Map entries are read in parallel, and the
+// names used in each entry are cached until the entry's data changes, so
+// indexing the same archive again only re-reads modified maps.
+// Must only be used from the main thread
+namespace maptextureusage
+{
+	struct Usage
+	{
+		std::unordered_set<string> textures; // Upper case
+		std::unordered_set<string> flats;    // Upper case
+		unsigned                   n_map_entries = 0;
+
+		bool usesTexture(string_view name) const;
+		bool usesFlat(string_view name) const;
+	};
+
+	Usage archiveUsage(Archive& archive);
+	void  clear();
+} // namespace maptextureusage
+} // namespace slade
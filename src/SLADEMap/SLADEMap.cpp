@@ -34,9 +34,11 @@
 #include "App.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
+#include "General/Profiler.h"
 #include "MapEditor/SectorBuilder.h"
 #include "MapFormat/MapFormatHandler.h"
 #include "Utility/MathStuff.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -110,6 +112,12 @@ void SLADEMap::setThingsUpdated()
 // -----------------------------------------------------------------------------
 bool SLADEMap::readMap(const Archive::MapDesc& map)
 {
+	PROFILE_ZONE("SLADEMap::readMap");
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Map);
+
+	open_timings_.clear();
+	open_timings_.begin("Read map data");
+
 	auto omap = map;
 
 	// Check for map archive
@@ -154,11 +162,16 @@ bool SLADEMap::readMap(const Archive::MapDesc& map)
 			udmf_namespace_ = game::configuration().udmfNamespace();
 	}
 
+	open_timings_.begin("Map open checks");
 	mapOpenChecks();
 
+	open_timings_.begin("Sector bboxes");
 	data_.sectors().initBBoxes();
+	open_timings_.begin("Sector polygons");
 	data_.sectors().initPolygons();
+	open_timings_.begin("Map specials");
 	recomputeSpecials();
+	open_timings_.end();
 
 	opened_time_ = app::runTimer() + 10;
 
@@ -205,28 +218,27 @@ BBox SLADEMap::bounds(bool include_things)
 // -----------------------------------------------------------------------------
 void SLADEMap::updateGeometryInfo(long modified_time)
 {
-	for (auto& vertex : data_.vertices())
+	// Only go through vertices modified since [modified_time] (found via the
+	// change journal) rather than checking every vertex
+	for (auto* object : data_.modifiedObjects(modified_time + 1, MapObject::Type::Vertex))
 	{
-		if (vertex->modifiedTime() > modified_time)
+		for (auto* line : dynamic_cast<MapVertex*>(object)->connected_lines_)
 		{
-			for (auto* line : vertex->connected_lines_)
-			{
-				// Update line geometry
-				line->resetInternals();
+			// Update line geometry
+			line->resetInternals();
 
-				// Update front sector
-				if (line->frontSector())
-				{
-					line->frontSector()->resetPolygon();
-					line->frontSector()->updateBBox();
-				}
+			// Update front sector
+			if (line->frontSector())
+			{
+				line->frontSector()->resetPolygon();
+				line->frontSector()->updateBBox();
+			}
 
-				// Update back sector
-				if (line->backSector())
-				{
-					line->backSector()->resetPolygon();
-					line->backSector()->updateBBox();
-				}
+			// Update back sector
+			if (line->backSector())
+			{
+				line->backSector()->resetPolygon();
+				line->backSector()->updateBBox();
 			}
 		}
 	}
@@ -292,14 +304,11 @@ void SLADEMap::putThingsWithIdInSectorTag(int id, int tag, vector<MapThing*>& li
 		return;
 
 	// Find things with matching id contained in sector with matching tag
-	for (auto& thing : data_.things())
+	for (auto& thing : data_.things().allWithId(id))
 	{
-		if (thing->id() == id)
-		{
-			auto* sector = data_.sectors().atPos(thing->position());
-			if (sector && sector->id_ == tag)
-				list.push_back(thing);
-		}
+		auto* sector = data_.sectors().atPos(thing->position());
+		if (sector && sector->id_ == tag)
+			list.push_back(thing);
 	}
 }
 
@@ -491,11 +500,12 @@ void SLADEMap::setOpenedTime()
 // Re-applies all the currently calculated special map properties (currently
 // this just means ZDoom slopes).
 // Since this needs to be done anytime the map changes, it's called whenever a
-// map is read, an undo record ends, or an undo/redo is performed.
+// map is read, an undo record ends, or an undo/redo is performed. Only the
+// specials affected by objects modified since the last time are recalculated
 // -----------------------------------------------------------------------------
 void SLADEMap::recomputeSpecials()
 {
-	map_specials_.processMapSpecials(this);
+	map_specials_.updateMapSpecials(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -503,12 +513,18 @@ void SLADEMap::recomputeSpecials()
 // -----------------------------------------------------------------------------
 bool SLADEMap::writeMap(vector<ArchiveEntry*>& map_entries) const
 {
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Map);
+
+	save_timings_.clear();
+	save_timings_.begin("Write map data");
+
 	// Get format handler
 	auto handler = MapFormatHandler::get(current_format_);
 	handler->setUDMFNamespace(udmf_namespace_);
 
 	// Get map data
 	auto out = handler->writeMap(data_, udmf_props_);
+	save_timings_.end();
 	if (out.empty())
 		return false;
 
@@ -546,7 +562,9 @@ MapVertex* SLADEMap::createVertex(Vec2d pos, double split_dist)
 	// Check if this vertex splits any lines (if needed)
 	if (split_dist >= 0)
 	{
-		auto lines = data_.lines();
+		// Only lines with a bbox within [split_dist] of the position can be split
+		auto lines = data_.lines().allInBox(
+			{ pos.x - split_dist, pos.y - split_dist }, { pos.x + split_dist, pos.y + split_dist });
 		for (auto* line : lines)
 		{
 			// Skip line if it shares the vertex
@@ -716,30 +734,26 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
 // -----------------------------------------------------------------------------
 MapVertex* SLADEMap::mergeVerticesPoint(const Vec2d& pos)
 {
-	// Go through all vertices
-	int merge = -1;
-	for (unsigned a = 0; a < vertices().size(); a++)
+	// Go through all vertices on the point
+	MapVertex* merge = nullptr;
+	for (auto* vertex : data_.vertices().allInBox(pos, pos))
 	{
-		// Skip if vertex isn't on the point
-		if (vertex(a)->position_.x != pos.x || vertex(a)->position_.y != pos.y)
-			continue;
-
 		// Set as the merge target vertex if we don't have one already
-		if (merge < 0)
+		if (!merge)
 		{
-			merge = a;
+			merge = vertex;
 			continue;
 		}
 
-		// Otherwise, merge this vertex with the merge target
-		mergeVertices(merge, a);
-		a--;
+		// Otherwise, merge this vertex with the merge target (indices are
+		// looked up each time since removing a vertex can change them)
+		mergeVertices(merge->index(), vertex->index());
 	}
 
 	geometry_updated_ = app::runTimer();
 
 	// Return the final merged vertex
-	return vertex(merge);
+	return merge;
 }
 
 // -----------------------------------------------------------------------------
@@ -804,12 +818,12 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 // -----------------------------------------------------------------------------
 void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 {
-	// Check if this vertex splits any lines (if needed)
-	const auto nlines = data_.lines().size();
-	for (unsigned i = 0; i < nlines; ++i)
+	// Check if this vertex splits any lines (if needed), only lines with a
+	// bbox within [split_dist] of the vertex can be split
+	const auto pos = vertex->position();
+	for (auto* line : data_.lines().allInBox(
+			 { pos.x - split_dist, pos.y - split_dist }, { pos.x + split_dist, pos.y + split_dist }))
 	{
-		auto* line = this->line(i);
-
 		// Skip line if it shares the vertex
 		if (line->v1() == vertex || line->v2() == vertex)
 			continue;
@@ -822,7 +836,7 @@ void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 				vertex->index_,
 				vertex->position_.x,
 				vertex->position_.y,
-				i);
+				line->index());
 			splitLine(line, vertex);
 		}
 	}
@@ -999,17 +1013,32 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	auto*          last_vertex = this->vertices().last();
 	auto*          last_line   = lines().last();
 
+	// Lists of merged vertices and connected lines, with sets to check for
+	// duplicates quickly (pasting can merge thousands of them)
+	vector<MapVertex*>             merged_vertices;
+	vector<MapLine*>               connected_lines;
+	std::unordered_set<MapVertex*> merged_vertices_set;
+	std::unordered_set<MapLine*>   connected_lines_set;
+	auto                           add_merged_vertex = [&](MapVertex* vertex) {
+		if (merged_vertices_set.insert(vertex).second)
+			merged_vertices.push_back(vertex);
+	};
+	auto get_connected_lines = [&]() {
+		connected_lines.clear();
+		connected_lines_set.clear();
+		for (const auto* vertex : merged_vertices)
+			for (auto* connected_line : vertex->connected_lines_)
+				if (connected_lines_set.insert(connected_line).second)
+					connected_lines.push_back(connected_line);
+	};
+
 	// Merge vertices
-	vector<MapVertex*> merged_vertices;
 	for (const auto* vertex : vertices)
 		if (auto* v = mergeVerticesPoint(vertex->position_))
-			VECTOR_ADD_UNIQUE(merged_vertices, v);
+			add_merged_vertex(v);
 
 	// Get all connected lines
-	vector<MapLine*> connected_lines;
-	for (const auto* vertex : merged_vertices)
-		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+	get_connected_lines();
 
 	// Split lines (by vertices)
 	const double split_dist = 0.1;
@@ -1020,11 +1049,12 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	// Split lines that moved onto existing vertices
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		const unsigned nvertices = nVertices();
-		for (unsigned b = 0; b < nvertices; b++)
+		// Only vertices within [split_dist] of the line bbox can split it
+		const auto bbox1 = connected_lines[a]->seg();
+		for (auto* vertex : data_.vertices().allInBox(
+				 { bbox1.left() - split_dist, bbox1.top() - split_dist },
+				 { bbox1.right() + split_dist, bbox1.bottom() + split_dist }))
 		{
-			auto* vertex = this->vertex(b);
-
 			// Skip line if it shares the vertex
 			if (connected_lines[a]->v1() == vertex || connected_lines[a]->v2() == vertex)
 				continue;
@@ -1032,7 +1062,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			if (connected_lines[a]->distanceTo(vertex->position()) < split_dist)
 			{
 				connected_lines.push_back(splitLine(connected_lines[a], vertex));
-				VECTOR_ADD_UNIQUE(merged_vertices, vertex);
+				add_merged_vertex(vertex);
 			}
 		}
 	}
@@ -1044,11 +1074,9 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 		auto* line1 = connected_lines[a];
 		seg1        = line1->seg();
 
-		const unsigned count = nLines();
-		for (unsigned b = 0; b < count; b++)
+		// Only lines overlapping the line bbox can intersect it
+		for (auto* line2 : data_.lines().allInBox({ seg1.left(), seg1.top() }, { seg1.right(), seg1.bottom() }))
 		{
-			auto* line2 = line(b);
-
 			// Can't intersect if they share a vertex
 			if (line1->vertex1_ == line2->vertex1_ || line1->vertex1_ == line2->vertex2_
 				|| line2->vertex1_ == line1->vertex2_ || line2->vertex2_ == line1->vertex2_)
@@ -1060,7 +1088,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			{
 				// Create split vertex
 				auto* nv = createVertex(intersection);
-				merged_vertices.push_back(nv);
+				add_merged_vertex(nv);
 
 				// Split lines
 				splitLine(line1, nv);
@@ -1077,39 +1105,54 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	}
 
 	// Refresh connected lines
-	connected_lines.clear();
-	for (const auto* vertex : merged_vertices)
-		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+	get_connected_lines();
 
-	// Find overlapping lines
-	vector<MapLine*> remove_lines;
+	// Find overlapping lines. Any line overlapping another must share its
+	// first vertex, so only lines connected to that need to be checked
+	std::unordered_map<MapLine*, unsigned> connected_line_indices;
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+		connected_line_indices[connected_lines[a]] = a;
+	vector<MapLine*>             remove_lines;
+	std::unordered_set<MapLine*> remove_lines_set;
+	vector<unsigned>             overlapping;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
 		auto* line1 = connected_lines[a];
 
 		// Skip if removing already
-		if (VECTOR_EXISTS(remove_lines, line1))
+		if (remove_lines_set.count(line1))
 			continue;
 
-		for (unsigned l = a + 1; l < connected_lines.size(); l++)
+		// Get (the indices of) any later connected lines overlapping this one
+		overlapping.clear();
+		for (auto* line2 : line1->vertex1_->connected_lines_)
+		{
+			if (line2 == line1
+				|| !(line1->vertex2_ == line2->vertex2_ && line1->vertex1_ == line2->vertex1_
+					 || line1->vertex2_ == line2->vertex1_ && line1->vertex1_ == line2->vertex2_))
+				continue;
+
+			auto index = connected_line_indices.find(line2);
+			if (index != connected_line_indices.end() && index->second > a)
+				overlapping.push_back(index->second);
+		}
+		std::sort(overlapping.begin(), overlapping.end());
+
+		for (auto l : overlapping)
 		{
 			auto* line2 = connected_lines[l];
 
 			// Skip if removing already
-			if (VECTOR_EXISTS(remove_lines, line2))
+			if (remove_lines_set.count(line2))
 				continue;
 
-			if (line1->vertex1_ == line2->vertex1_ && line1->vertex2_ == line2->vertex2_
-				|| line1->vertex1_ == line2->vertex2_ && line1->vertex2_ == line2->vertex1_)
-			{
-				auto* remove_line = mergeOverlappingLines(line2, line1);
-				VECTOR_ADD_UNIQUE(remove_lines, remove_line);
+			auto* remove_line = mergeOverlappingLines(line2, line1);
+			if (remove_lines_set.insert(remove_line).second)
+				remove_lines.push_back(remove_line);
 
-				// Don't check against any more lines if we just decided to remove this one
-				if (remove_line == line1)
-					break;
-			}
+			// Don't check against any more lines if we just decided to remove this one
+			if (remove_line == line1)
+				break;
 		}
 	}
 
@@ -1119,15 +1162,12 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 		log::info(4, "Removing overlapping line {} (#{})", remove_line->objId(), remove_line->index());
 		data_.removeLine(remove_line);
 	}
-	for (unsigned a = 0; a < connected_lines.size(); a++)
-	{
-		if (VECTOR_EXISTS(remove_lines, connected_lines[a]))
-		{
-			connected_lines[a] = connected_lines.back();
-			connected_lines.pop_back();
-			a--;
-		}
-	}
+	connected_lines.erase(
+		std::remove_if(
+			connected_lines.begin(),
+			connected_lines.end(),
+			[&](MapLine* line) { return remove_lines_set.count(line) > 0; }),
+		connected_lines.end());
 
 	// Check if anything was actually merged
 	bool merged = false;
@@ -1258,13 +1298,17 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 		}
 	}
 
-	vector<MapSide*> sides_correct;
-	for (auto& edge : edges)
+	std::unordered_set<MapSide*>                   sides_correct;
+	std::unordered_map<MapLine*, vector<unsigned>> line_edges;
+	for (unsigned e = 0; e < edges.size(); e++)
 	{
+		auto& edge = edges[e];
 		if (edge.front && edge.line->side1_)
-			sides_correct.push_back(edge.line->side1_);
+			sides_correct.insert(edge.line->side1_);
 		else if (!edge.front && edge.line->side2_)
-			sides_correct.push_back(edge.line->side2_);
+			sides_correct.insert(edge.line->side2_);
+
+		line_edges[edge.line].push_back(e);
 	}
 
 	// Build sectors
@@ -1298,11 +1342,12 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 			bool  is_front = builder.edgeIsFront(b);
 
 			bool line_is_ours = false;
-			for (unsigned e = 0; e < edges.size(); e++)
+			auto line_edge    = line_edges.find(line);
+			if (line_edge != line_edges.end())
 			{
-				if (edges[e].line == line)
+				line_is_ours = true;
+				for (auto e : line_edge->second)
 				{
-					line_is_ours = true;
 					if (edges[e].front == is_front)
 					{
 						edges_in_sector.push_back(e);
@@ -1462,17 +1507,34 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 // -----------------------------------------------------------------------------
 void SLADEMap::mapOpenChecks()
 {
-	const int rverts  = data_.removeDetachedVertices();
-	const int rsides  = data_.removeDetachedSides();
-	const int rsec    = data_.removeDetachedSectors();
-	const int risides = data_.removeInvalidSides();
+	const auto removed = data_.removeDetachedObjects();
 
 	log::info(
 		"Removed {} detached vertices, {} detached sides, {} invalid sides and {} detached sectors",
-		rverts,
-		rsides,
-		risides,
-		rsec);
+		removed.detached_vertices,
+		removed.detached_sides,
+		removed.invalid_sides,
+		removed.detached_sectors);
+}
+
+// -----------------------------------------------------------------------------
+// Updates all lazily calculated map data (object indexes and line geometry) so
+// that the map can be read from multiple threads at once. Nothing may modify
+// the map while it is being read this way, since that would invalidate it
+// again
+// -----------------------------------------------------------------------------
+void SLADEMap::updateCaches() const
+{
+	data_.vertices().updateIndexes();
+	data_.lines().updateIndexes();
+	data_.sectors().updateIndexes();
+	data_.things().updateIndexes();
+
+	for (auto line : data_.lines())
+	{
+		line->length();
+		line->frontVector();
+	}
 }
 
 // -----------------------------------------------------------------------------
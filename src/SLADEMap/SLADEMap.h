@@ -3,6 +3,7 @@
 #include "Archive/Archive.h"
 #include "MapObjectCollection.h"
 #include "MapSpecials.h"
+#include "Utility/PhaseTimer.h"
 
 namespace slade
 {
@@ -35,6 +36,7 @@ public:
 	long                       geometryUpdated() const { return geometry_updated_; }
 	long                       thingsUpdated() const { return things_updated_; }
 	const MapObjectCollection& mapData() const { return data_; }
+	const MapGeometry&         geometry() const { return data_.geometry(); }
 
 	void setGeometryUpdated();
 	void setThingsUpdated();
@@ -68,6 +70,10 @@ public:
 	// Map saving
 	bool writeMap(vector<ArchiveEntry*>& map_entries) const;
 
+	// Timing breakdowns of the last map open/save
+	PhaseTimer& openTimings() { return open_timings_; }
+	PhaseTimer& saveTimings() const { return save_timings_; }
+
 	// Creation
 	MapVertex* createVertex(Vec2d pos, double split_dist = -1.);
 	MapLine*   createLine(Vec2d p1, Vec2d p2, double split_dist = -1.);
@@ -126,6 +132,10 @@ public:
 	void rebuildConnectedLines() { data_.rebuildConnectedLines(); }
 	void rebuildConnectedSides() { data_.rebuildConnectedSides(); }
 	void restoreObjectIdList(MapObject::Type type, vector<unsigned>& list) { data_.restoreObjectIdList(type, list); }
+	void objectModified(MapObject* object) { data_.objectModified(object); }
+	void updateCaches() const;
+
+	shared_ptr<const MapSnapshot> snapshot() { return data_.snapshot(); }
 
 	// Convert
 	bool convertToHexen() const;
@@ -144,6 +154,8 @@ private:
 	MapFormat           current_format_ = MapFormat::Unknown;
 	long                opened_time_    = 0;
 	MapSpecials         map_specials_;
+	PhaseTimer          open_timings_;
+	mutable PhaseTimer  save_timings_;
 
 	vector<ArchiveEntry*> udmf_extra_entries_; // UDMF Extras
 
@@ -35,6 +35,7 @@
 #include "App.h"
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/All.h"
+#include "DataView.h"
 #include "General/Misc.h"
 #include "Utility/StringUtils.h"
 #include "thirdparty/sol/sol.hpp"
@@ -303,6 +304,7 @@ void registerArchiveEntry(sol::state& lua)
 	lua_entry["index"] = sol::property(&ArchiveEntry::index);
 	lua_entry["crc32"] = sol::property([](ArchiveEntry& self) { return misc::crc(self.rawData(), self.size()); });
 	lua_entry["data"]  = sol::property([](ArchiveEntry& self) { return &self.data(); });
+	lua_entry["view"]  = sol::property([](ArchiveEntry& self) { return lua::DataView(self); });
 	lua_entry["parentArchive"] = sol::property(&entryParent);
 	lua_entry["parentDir"]     = sol::property(&entryDir);
 
@@ -0,0 +1,279 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    DataView.cpp
+// Description: DataView struct and its export to lua using sol3. A DataView
+//              gives scripts direct, bounds-checked access to binary data
+//              (eg. entry data) with typed read/write functions, without the
+//              data being copied to and from lua strings
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "DataView.h"
+#include "Archive/ArchiveEntry.h"
+#include "thirdparty/sol/sol.hpp"
+
+using namespace slade;
+using namespace lua;
+
+
+// -----------------------------------------------------------------------------
+//
+// DataView Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// DataView constructor, creates a view of all of [entry]'s data (loading it if
+// needed)
+// -----------------------------------------------------------------------------
+DataView::DataView(ArchiveEntry& entry) : data{ &entry.data() }, entry{ &entry } {}
+
+// -----------------------------------------------------------------------------
+// Returns the size of the view, clamped to the current size of the data
+// -----------------------------------------------------------------------------
+unsigned DataView::size() const
+{
+	if (offset >= data->size())
+		return 0;
+
+	return std::min(length, data->size() - offset);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a pointer to [count] bytes at [pos] in the view for reading, or null
+// if they are out of bounds
+// -----------------------------------------------------------------------------
+const uint8_t* DataView::readPtr(unsigned pos, unsigned count) const
+{
+	auto view_size = size();
+	if (pos > view_size || count > view_size - pos)
+		return nullptr;
+
+	return static_cast<const MemChunk*>(data)->data() + offset + pos;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a pointer to [count] bytes at [pos] in the view for writing, or null
+// if they are out of bounds (or the view's entry is locked).
+// If the view is of an entry's data, the entry is marked as modified
+// -----------------------------------------------------------------------------
+uint8_t* DataView::writePtr(unsigned pos, unsigned count)
+{
+	auto view_size = size();
+	if (pos > view_size || count > view_size - pos)
+		return nullptr;
+
+	if (entry)
+	{
+		if (entry->isLocked())
+			return nullptr;
+
+		if (entry->state() == ArchiveEntry::State::Unmodified)
+			entry->setState(ArchiveEntry::State::Modified);
+	}
+
+	// Data is copied here if it is shared with anything else (eg. a mapped file)
+	return data->data() + offset + pos;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a view of [count] bytes at [pos] within this view
+// -----------------------------------------------------------------------------
+DataView DataView::slice(unsigned pos, unsigned count) const
+{
+	auto view_size = size();
+	pos            = std::min(pos, view_size);
+
+	auto view   = *this;
+	view.offset = offset + pos;
+	view.length = std::min(count, view_size - pos);
+	return view;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Lua Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace slade::lua
+{
+// -----------------------------------------------------------------------------
+// Reads a value of type T at [pos] in [self], with the given endianness.
+// Returns nil if the value is out of bounds
+// -----------------------------------------------------------------------------
+template<typename T, bool big_endian = false> sol::optional<T> dataViewRead(const DataView& self, unsigned pos)
+{
+	auto ptr = self.readPtr(pos, sizeof(T));
+	if (!ptr)
+		return sol::nullopt;
+
+	std::make_unsigned_t<T> value = 0;
+	for (unsigned a = 0; a < sizeof(T); ++a)
+	{
+		auto byte = big_endian ? ptr[a] : ptr[sizeof(T) - 1 - a];
+		value     = (value << 8) | byte;
+	}
+
+	return static_cast<T>(value);
+}
+
+// -----------------------------------------------------------------------------
+// Writes [value] as type T at [pos] in [self], with the given endianness.
+// Returns false if the value is out of bounds
+// -----------------------------------------------------------------------------
+template<typename T, bool big_endian = false> bool dataViewWrite(DataView& self, unsigned pos, int64_t value)
+{
+	auto ptr = self.writePtr(pos, sizeof(T));
+	if (!ptr)
+		return false;
+
+	auto uvalue = static_cast<std::make_unsigned_t<T>>(value);
+	for (unsigned a = 0; a < sizeof(T); ++a)
+	{
+		ptr[big_endian ? sizeof(T) - 1 - a : a] = uvalue & 0xFF;
+		uvalue >>= 8;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [length] bytes at [pos] in [self] as a string (the whole view if no
+// position is given). Returns nil if out of bounds
+// -----------------------------------------------------------------------------
+sol::optional<string_view> dataViewString(
+	const DataView&         self,
+	sol::optional<unsigned> pos,
+	sol::optional<unsigned> length)
+{
+	auto start = pos.value_or(0);
+	auto count = length.value_or(start < self.size() ? self.size() - start : 0);
+	auto ptr   = self.readPtr(start, count);
+	if (!ptr)
+		return sol::nullopt;
+
+	return string_view{ reinterpret_cast<const char*>(ptr), count };
+}
+
+// -----------------------------------------------------------------------------
+// Writes the bytes of [value] at [pos] in [self].
+// Returns false if out of bounds
+// -----------------------------------------------------------------------------
+bool dataViewWriteString(DataView& self, unsigned pos, string_view value)
+{
+	auto ptr = self.writePtr(pos, value.size());
+	if (!ptr)
+		return false;
+
+	memcpy(ptr, value.data(), value.size());
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Copies the contents of [source] to [pos] in [self] (the two views can
+// overlap). Returns false if out of bounds
+// -----------------------------------------------------------------------------
+bool dataViewCopyFrom(DataView& self, unsigned pos, const DataView& source)
+{
+	auto count = source.size();
+	if (!source.readPtr(0, count) || !self.writePtr(pos, count))
+		return false;
+
+	// Get both pointers after the destination data is unshared, [source] may view the same data
+	memmove(self.writePtr(pos, count), source.readPtr(0, count), count);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Sets all bytes in [self] to [value]
+// -----------------------------------------------------------------------------
+bool dataViewFill(DataView& self, uint8_t value)
+{
+	auto ptr = self.writePtr(0, self.size());
+	if (!ptr)
+		return false;
+
+	memset(ptr, value, self.size());
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Registers the DataView type with lua
+// -----------------------------------------------------------------------------
+void registerDataViewType(sol::state& lua)
+{
+	auto lua_view = lua.new_usertype<DataView>(
+		"DataView", sol::constructors<DataView(MemChunk&), DataView(ArchiveEntry&)>());
+
+	// Properties
+	// -------------------------------------------------------------------------
+	lua_view["size"]   = sol::property(&DataView::size);
+	lua_view["offset"] = sol::property([](const DataView& self) { return self.offset; });
+
+	// Metamethods
+	// -------------------------------------------------------------------------
+	lua_view[sol::meta_function::length] = &DataView::size;
+
+	// Functions
+	// -------------------------------------------------------------------------
+	lua_view["Slice"]    = &DataView::slice;
+	lua_view["AsString"] = sol::overload(
+		[](const DataView& self) { return dataViewString(self, sol::nullopt, sol::nullopt); },
+		[](const DataView& self, unsigned pos) { return dataViewString(self, pos, sol::nullopt); },
+		[](const DataView& self, unsigned pos, unsigned length) { return dataViewString(self, pos, length); });
+	lua_view["WriteString"] = &dataViewWriteString;
+	lua_view["CopyFrom"]    = &dataViewCopyFrom;
+	lua_view["Fill"]        = &dataViewFill;
+
+	// Reading
+	lua_view["ReadInt8"]     = &dataViewRead<int8_t>;
+	lua_view["ReadUInt8"]    = &dataViewRead<uint8_t>;
+	lua_view["ReadInt16"]    = &dataViewRead<int16_t>;
+	lua_view["ReadUInt16"]   = &dataViewRead<uint16_t>;
+	lua_view["ReadInt32"]    = &dataViewRead<int32_t>;
+	lua_view["ReadUInt32"]   = &dataViewRead<uint32_t>;
+	lua_view["ReadInt16BE"]  = &dataViewRead<int16_t, true>;
+	lua_view["ReadUInt16BE"] = &dataViewRead<uint16_t, true>;
+	lua_view["ReadInt32BE"]  = &dataViewRead<int32_t, true>;
+	lua_view["ReadUInt32BE"] = &dataViewRead<uint32_t, true>;
+
+	// Writing
+	lua_view["WriteInt8"]     = &dataViewWrite<int8_t>;
+	lua_view["WriteUInt8"]    = &dataViewWrite<uint8_t>;
+	lua_view["WriteInt16"]    = &dataViewWrite<int16_t>;
+	lua_view["WriteUInt16"]   = &dataViewWrite<uint16_t>;
+	lua_view["WriteInt32"]    = &dataViewWrite<int32_t>;
+	lua_view["WriteUInt32"]   = &dataViewWrite<uint32_t>;
+	lua_view["WriteInt16BE"]  = &dataViewWrite<int16_t, true>;
+	lua_view["WriteUInt16BE"] = &dataViewWrite<uint16_t, true>;
+	lua_view["WriteInt32BE"]  = &dataViewWrite<int32_t, true>;
+	lua_view["WriteUInt32BE"] = &dataViewWrite<uint32_t, true>;
+}
+} // namespace slade::lua
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+
+namespace lua
+{
+	// A bounds-checked view of (part of) a MemChunk, or of an ArchiveEntry's
+	// data, that scripts can read and write directly without copying the data
+	// into lua strings. Bounds are checked against the current size of the
+	// underlying data on each access, so a view stays safe to use if the data
+	// is resized
+	struct DataView
+	{
+		MemChunk*     data   = nullptr;
+		ArchiveEntry* entry  = nullptr; // If set, writes mark the entry as modified
+		unsigned      offset = 0;
+		unsigned      length = 0xFFFFFFFF; // Clamped to the end of [data]
+
+		DataView(MemChunk& data) : data{ &data } {}
+		DataView(ArchiveEntry& entry);
+
+		unsigned       size() const;
+		const uint8_t* readPtr(unsigned pos, unsigned count) const;
+		uint8_t*       writePtr(unsigned pos, unsigned count);
+		DataView       slice(unsigned pos, unsigned count) const;
+	};
+} // namespace lua
+} // namespace slade
@@ -12,6 +12,7 @@ void registerUINamespace(sol::state& lua);
 
 // Types
 void registerMiscTypes(sol::state& lua);
+void registerDataViewType(sol::state& lua);
 void registerArchiveTypes(sol::state& lua);
 void registerMapEditorTypes(sol::state& lua);
 void registerGameTypes(sol::state& lua);
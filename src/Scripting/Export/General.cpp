@@ -35,6 +35,7 @@
 #include "Graphics/Palette/Palette.h"
 #include "MainEditor/MainEditor.h"
 #include "MapEditor/MapEditContext.h"
+#include "Scripting/Export/Export.h"
 #include "Scripting/Lua.h"
 #include "thirdparty/sol/sol.hpp"
 
@@ -261,6 +262,7 @@ void registerMiscTypes(sol::state& lua)
 
 	// MemChunk type
 	registerMemChunkType(lua);
+	registerDataViewType(lua);
 }
 
 // -----------------------------------------------------------------------------
@@ -95,6 +95,107 @@ void objectSetStringProperty(MapObject& self, string_view key, string_view value
 		log::warning("{} string property \"{}\" can not be modified via script", self.typeName(), key);
 }
 
+// -----------------------------------------------------------------------------
+// Sets a property [key] on the MapObject [self] to [value], using the setter
+// matching the type of [value] (numbers without a fractional part are set as
+// integers). Returns false if [value] isn't a valid property type or the
+// property [key] can't be modified by scripts (without logging a warning, so
+// bulk edits can warn only once)
+// -----------------------------------------------------------------------------
+bool objectSetProperty(MapObject& self, string_view key, const sol::object& value)
+{
+	if (!self.scriptCanModifyProp(key))
+		return false;
+
+	switch (value.get_type())
+	{
+	case sol::type::boolean: self.setBoolProperty(key, value.as<bool>()); return true;
+	case sol::type::string: self.setStringProperty(key, value.as<string_view>()); return true;
+	case sol::type::number:
+	{
+		auto number = value.as<double>();
+		if (number == std::floor(number) && std::abs(number) <= std::numeric_limits<int>::max())
+			self.setIntProperty(key, static_cast<int>(number));
+		else
+			self.setFloatProperty(key, number);
+		return true;
+	}
+	default: return false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the MapObjects in [objects], which can be either a lua table of map
+// objects or a list returned from another function (eg. Map.linedefs or
+// MapEditor:SelectedLines)
+// -----------------------------------------------------------------------------
+vector<MapObject*> mapObjectList(const sol::object& objects)
+{
+	vector<MapObject*> list;
+	auto               add = [&](const auto& objects) { list.insert(list.end(), objects.begin(), objects.end()); };
+
+	if (objects.get_type() == sol::type::table)
+	{
+		for (auto& item : objects.as<sol::table>())
+			if (item.second.is<MapObject*>())
+				list.push_back(item.second.as<MapObject*>());
+	}
+	else if (objects.is<vector<MapVertex*>>())
+		add(objects.as<vector<MapVertex*>&>());
+	else if (objects.is<vector<MapLine*>>())
+		add(objects.as<vector<MapLine*>&>());
+	else if (objects.is<vector<MapSide*>>())
+		add(objects.as<vector<MapSide*>&>());
+	else if (objects.is<vector<MapSector*>>())
+		add(objects.as<vector<MapSector*>&>());
+	else if (objects.is<vector<MapThing*>>())
+		add(objects.as<vector<MapThing*>&>());
+	else if (objects.is<vector<MapObject*>>())
+		add(objects.as<vector<MapObject*>&>());
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Sets each property in [changes] (a table of key = value) on [objects].
+// A warning is logged once for each property that couldn't be set on some of
+// the objects, rather than once per object
+// -----------------------------------------------------------------------------
+void setObjectsProperties(const vector<MapObject*>& objects, const sol::table& changes)
+{
+	// Get changes up-front rather than iterating the table for each object
+	vector<std::pair<string, sol::object>> props;
+	for (auto& change : changes)
+		if (change.first.get_type() == sol::type::string)
+			props.emplace_back(change.first.as<string>(), change.second);
+
+	vector<bool> failed(props.size(), false);
+	for (auto object : objects)
+		for (unsigned a = 0; object && a < props.size(); ++a)
+			if (!objectSetProperty(*object, props[a].first, props[a].second))
+				failed[a] = true;
+
+	for (unsigned a = 0; a < props.size(); ++a)
+		if (failed[a])
+			log::warning("Property \"{}\" can not be modified via script on some objects", props[a].first);
+}
+
+// -----------------------------------------------------------------------------
+// Sets property [key] to [value] on [objects].
+// A warning is logged once if the property couldn't be set on some of the
+// objects, rather than once per object
+// -----------------------------------------------------------------------------
+void setObjectsProperty(const vector<MapObject*>& objects, string_view key, const sol::object& value)
+{
+	bool failed = false;
+	for (auto object : objects)
+		if (object && !objectSetProperty(*object, key, value))
+			failed = true;
+
+	if (failed)
+		log::warning("Property \"{}\" can not be modified via script on some objects", key);
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Map type with lua
 // -----------------------------------------------------------------------------
@@ -107,11 +208,32 @@ void registerSLADEMap(sol::state& lua)
 	// -------------------------------------------------------------------------
 	lua_map["name"]          = sol::property(&SLADEMap::mapName);
 	lua_map["udmfNamespace"] = sol::property(&SLADEMap::udmfNamespace);
-	lua_map["vertices"]      = sol::property([](SLADEMap& self) { return self.vertices().all(); });
-	lua_map["linedefs"]      = sol::property([](SLADEMap& self) { return self.lines().all(); });
-	lua_map["sidedefs"]      = sol::property([](SLADEMap& self) { return self.sides().all(); });
-	lua_map["sectors"]       = sol::property([](SLADEMap& self) { return self.sectors().all(); });
-	lua_map["things"]        = sol::property([](SLADEMap& self) { return self.things().all(); });
+	// Object lists are returned by reference, so accessing them by index in a
+	// loop doesn't copy the whole list each time
+	lua_map["vertices"] = sol::property([](SLADEMap& self) -> const vector<MapVertex*>& {
+		return self.vertices().all();
+	});
+	lua_map["linedefs"] = sol::property([](SLADEMap& self) -> const vector<MapLine*>& {
+		return self.lines().all();
+	});
+	lua_map["sidedefs"] = sol::property([](SLADEMap& self) -> const vector<MapSide*>& {
+		return self.sides().all();
+	});
+	lua_map["sectors"] = sol::property([](SLADEMap& self) -> const vector<MapSector*>& {
+		return self.sectors().all();
+	});
+	lua_map["things"] = sol::property([](SLADEMap& self) -> const vector<MapThing*>& {
+		return self.things().all();
+	});
+
+	// Functions
+	// -------------------------------------------------------------------------
+	lua_map["SetProperty"] = [](SLADEMap&, const sol::object& objects, string_view key, const sol::object& value) {
+		setObjectsProperty(mapObjectList(objects), key, value);
+	};
+	lua_map["SetProperties"] = [](SLADEMap&, const sol::object& objects, const sol::table& changes) {
+		setObjectsProperties(mapObjectList(objects), changes);
+	};
 }
 
 // -----------------------------------------------------------------------------
@@ -177,6 +299,12 @@ void registerMapEditor(sol::state& lua)
 		[](MapEditContext& self, bool try_hilight) { return self.selection().selectedThings(try_hilight); },
 		[](MapEditContext& self) { return self.selection().selectedThings(false); });
 	lua_mapeditor["ClearSelection"] = [](MapEditContext& self) { self.selection().clear(); };
+	lua_mapeditor["SetSelectionProperty"] = [](MapEditContext& self, string_view key, const sol::object& value) {
+		setObjectsProperty(self.selection().selectedObjects(false), key, value);
+	};
+	lua_mapeditor["SetSelectionProperties"] = [](MapEditContext& self, const sol::table& changes) {
+		setObjectsProperties(self.selection().selectedObjects(false), changes);
+	};
 	lua_mapeditor["Select"]         = sol::overload(
         &selectMapObject, [](MapEditContext& self, MapObject* object) { selectMapObject(self, object, true); });
 	lua_mapeditor["SetEditMode"] = sol::overload(
@@ -276,9 +404,9 @@ void registerMapSide(sol::state& lua)
 	// -------------------------------------------------------------------------
 	lua_side["sector"]        = sol::property(&MapSide::sector);
 	lua_side["line"]          = sol::property(&MapSide::parentLine);
-	lua_side["textureBottom"] = sol::property(&MapSide::texLower);
-	lua_side["textureMiddle"] = sol::property(&MapSide::texMiddle);
-	lua_side["textureTop"]    = sol::property(&MapSide::texUpper);
+	lua_side["textureBottom"] = sol::property([](MapSide& self) { return self.texLower().name(); });
+	lua_side["textureMiddle"] = sol::property([](MapSide& self) { return self.texMiddle().name(); });
+	lua_side["textureTop"]    = sol::property([](MapSide& self) { return self.texUpper().name(); });
 	lua_side["offsetX"]       = sol::property(&MapSide::texOffsetX);
 	lua_side["offsetY"]       = sol::property(&MapSide::texOffsetY);
 }
@@ -294,8 +422,8 @@ void registerMapSector(sol::state& lua)
 
 	// Properties
 	// -------------------------------------------------------------------------
-	lua_sector["textureFloor"]   = sol::property([](MapSector& self) { return self.floor().texture; });
-	lua_sector["textureCeiling"] = sol::property([](MapSector& self) { return self.ceiling().texture; });
+	lua_sector["textureFloor"]   = sol::property([](MapSector& self) { return self.floor().texture.name(); });
+	lua_sector["textureCeiling"] = sol::property([](MapSector& self) { return self.ceiling().texture.name(); });
 	lua_sector["heightFloor"]    = sol::property([](MapSector& self) { return self.floor().height; });
 	lua_sector["heightCeiling"]  = sol::property([](MapSector& self) { return self.ceiling().height; });
 	lua_sector["lightLevel"]     = sol::property(&MapSector::lightLevel);
@@ -381,6 +509,9 @@ void registerMapObject(sol::state& lua)
 	lua_mapobject["SetIntProperty"]    = &objectSetIntProperty;
 	lua_mapobject["SetFloatProperty"]  = &objectSetFloatProperty;
 	lua_mapobject["SetStringProperty"] = &objectSetStringProperty;
+	lua_mapobject["SetProperties"]     = [](MapObject& self, const sol::table& changes) {
+		setObjectsProperties({ &self }, changes);
+	};
 }
 
 // -----------------------------------------------------------------------------
@@ -164,6 +164,10 @@ void registerUINamespace(sol::state& lua)
 	ui["SetSplashMessage"]         = &ui::setSplashMessage;
 	ui["SetSplashProgressMessage"] = &ui::setSplashProgressMessage;
 	ui["SetSplashProgress"]        = &ui::setSplashProgress;
+	ui["SetScriptProgress"]        = sol::overload(
+        [](float progress) { setScriptProgress(progress); },
+        [](float progress, string_view message) { setScriptProgress(progress, message); });
+	ui["ScriptCancelled"] = &scriptCancelled;
 
 	// Constants
 	// -------------------------------------------------------------------------
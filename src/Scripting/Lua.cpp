@@ -31,15 +31,19 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #define SOL_CHECK_ARGUMENTS 1
+#include "App.h"
 #include "Export/Export.h"
 #include "General/Console.h"
 #include "General/Misc.h"
+#include "General/UI.h"
 #include "Lua.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
 #include "thirdparty/sol/sol.hpp"
+#include <chrono>
+#include <unordered_map>
 
 using namespace slade;
 
@@ -49,12 +53,49 @@ using namespace slade;
 // Variables
 //
 // -----------------------------------------------------------------------------
+CVAR(Int, script_progress_delay, 1000, CVar::Flag::Save) // Time (ms) a script runs before its progress is shown
+CVAR(Bool, script_profile, false, CVar::Flag::Save)      // Log a per-function timing report after each script
 namespace slade::lua
 {
 sol::state lua;
 wxWindow*  current_window = nullptr;
 Error      script_error;
 time_t     script_start_time;
+
+// Progress of the currently running script
+struct ScriptProgress
+{
+	bool   running     = false;
+	bool   profiling   = false;
+	bool   shown       = false;
+	bool   cancelled   = false;
+	long   start_time  = 0;
+	long   update_time = 0;
+	float  progress    = -1.0f;
+	string message;
+};
+ScriptProgress script_progress;
+
+constexpr int HOOK_INSTRUCTIONS = 100000; // Number of instructions run between progress checks
+constexpr int PROGRESS_INTERVAL = 50;     // Minimum time (ms) between progress updates
+
+// Profiling of the currently running script (if script_profile is enabled)
+using ProfileClock = std::chrono::steady_clock;
+struct ProfileFunction
+{
+	string   name;
+	unsigned calls      = 0;
+	double   total_time = 0.; // Including time in called functions
+	double   self_time  = 0.;
+};
+struct ProfileFrame
+{
+	ProfileFunction*         function;
+	ProfileClock::time_point start;
+	double                   child_time;
+};
+std::unordered_map<const void*, ProfileFunction> profile_functions;
+vector<ProfileFrame>                             profile_stack;
 } // namespace slade::lua
 
 
@@ -105,6 +146,179 @@ sol::protected_function_result handleError(lua_State* L, sol::protected_function
 	return pfr;
 }
 
+// -----------------------------------------------------------------------------
+// Checks if the running script should be cancelled (Esc pressed), and shows or
+// updates its progress in the splash window if it has been running for longer
+// than script_progress_delay.
+// Since scripts run on the main thread, this is what lets long-running
+// scripts show progress and be cancelled. Returns true if cancelled
+// -----------------------------------------------------------------------------
+bool updateScriptProgress(bool force = false)
+{
+	if (!script_progress.running || script_progress.cancelled)
+		return script_progress.cancelled;
+
+	auto time = app::runTimer();
+	if (!force && time - script_progress.update_time < PROGRESS_INTERVAL)
+		return false;
+	script_progress.update_time = time;
+
+	if (wxGetKeyState(WXK_ESCAPE))
+	{
+		script_progress.cancelled = true;
+		return true;
+	}
+
+	if (!script_progress.shown)
+	{
+		if (time - script_progress.start_time < script_progress_delay)
+			return false;
+
+		ui::showSplash("Running Script (Esc to cancel)", true, current_window);
+		script_progress.shown = true;
+	}
+
+	ui::setSplashProgress(script_progress.progress);
+	ui::setSplashProgressMessage(script_progress.message);
+	ui::updateSplash();
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Records a call of the function described by [debug] in the profile
+// -----------------------------------------------------------------------------
+void profileCall(lua_State* state, lua_Debug* debug)
+{
+	lua_getinfo(state, "nSf", debug);
+	auto key = lua_topointer(state, -1);
+	lua_pop(state, 1);
+
+	auto& function = profile_functions[key];
+	if (function.name.empty())
+	{
+		string name = debug->name ? debug->name : "?";
+		if (debug->what == string_view{ "C" })
+			function.name = fmt::format("{} [C]", name);
+		else if (debug->what == string_view{ "main" })
+			function.name = fmt::format("(main chunk) [{}]", debug->short_src);
+		else
+			function.name = fmt::format("{} [{}:{}]", name, debug->short_src, debug->linedefined);
+	}
+
+	function.calls++;
+	profile_stack.push_back({ &function, ProfileClock::now(), 0. });
+}
+
+// -----------------------------------------------------------------------------
+// Records a return from the function at the top of the profile stack
+// -----------------------------------------------------------------------------
+void profileReturn()
+{
+	if (profile_stack.empty())
+		return;
+
+	auto frame = profile_stack.back();
+	profile_stack.pop_back();
+
+	auto time = std::chrono::duration<double>(ProfileClock::now() - frame.start).count();
+	frame.function->total_time += time;
+	frame.function->self_time += time - frame.child_time;
+	if (!profile_stack.empty())
+		profile_stack.back().child_time += time;
+}
+
+// -----------------------------------------------------------------------------
+// Logs the profile of the script that was run, sorted by time spent in each
+// function (excluding functions it called)
+// -----------------------------------------------------------------------------
+void logProfile()
+{
+	// Finish any frames left over (eg. if the script ended with an error)
+	while (!profile_stack.empty())
+		profileReturn();
+
+	vector<ProfileFunction*> functions;
+	for (auto& function : profile_functions)
+		functions.push_back(&function.second);
+	std::sort(functions.begin(), functions.end(), [](const ProfileFunction* left, const ProfileFunction* right) {
+		return left->self_time > right->self_time;
+	});
+
+	log::info("Script profile:");
+	log::info("{:>10} {:>12} {:>12}  Function", "Calls", "Total (ms)", "Self (ms)");
+	for (auto function : functions)
+		log::info(
+			"{:>10} {:>12.2f} {:>12.2f}  {}",
+			function->calls,
+			function->total_time * 1000.,
+			function->self_time * 1000.,
+			function->name);
+
+	profile_functions.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Lua hook called while a script is running. Every HOOK_INSTRUCTIONS
+// instructions the script is aborted with an error if it was cancelled, and
+// function calls and returns are recorded if the script is being profiled
+// -----------------------------------------------------------------------------
+void scriptHook(lua_State* state, lua_Debug* debug)
+{
+	switch (debug->event)
+	{
+	case LUA_HOOKCALL: profileCall(state, debug); break;
+	case LUA_HOOKTAILCALL:
+		// The tail-called function replaces the current one
+		profileReturn();
+		profileCall(state, debug);
+		break;
+	case LUA_HOOKRET: profileReturn(); break;
+	case LUA_HOOKCOUNT:
+		if (updateScriptProgress())
+			luaL_error(state, "Script cancelled");
+		break;
+	default: break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Begins tracking the progress of a script about to be run
+// -----------------------------------------------------------------------------
+void beginScript()
+{
+	script_progress            = {};
+	script_progress.running    = true;
+	script_progress.start_time = app::runTimer();
+
+	auto mask = LUA_MASKCOUNT;
+	if (script_profile)
+	{
+		script_progress.profiling = true;
+		mask |= LUA_MASKCALL | LUA_MASKRET;
+		profile_functions.clear();
+		profile_stack.clear();
+	}
+	lua_sethook(lua.lua_state(), &scriptHook, mask, HOOK_INSTRUCTIONS);
+}
+
+// -----------------------------------------------------------------------------
+// Ends tracking the progress of the script that was running
+// -----------------------------------------------------------------------------
+void endScript()
+{
+	lua_sethook(lua.lua_state(), nullptr, 0, 0);
+	if (script_progress.profiling)
+		logProfile();
+
+	if (script_progress.shown)
+		ui::hideSplash();
+	if (script_progress.cancelled)
+		log::warning("Script cancelled");
+
+	script_progress = {};
+}
+
 // -----------------------------------------------------------------------------
 // Template function for Lua::run*Script functions.
 // Loads [script] and runs the 'Execute' function in the script, passing
@@ -112,14 +326,18 @@ sol::protected_function_result handleError(lua_State* L, sol::protected_function
 // -----------------------------------------------------------------------------
 template<class T> bool runEditorScript(const string& script, T param)
 {
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Scripting);
+
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
 
 	// Load script
+	beginScript();
 	sol::environment sandbox(lua, sol::create, lua.globals());
 	auto             load_result = lua.script(script, sandbox, handleError);
 	if (!load_result.valid())
 	{
+		endScript();
 		processError(load_result);
 		log::error(
 			"{} Error running Lua script: {}: {}", script_error.type, script_error.line_no, script_error.message);
@@ -131,6 +349,7 @@ template<class T> bool runEditorScript(const string& script, T param)
 	// auto                    exec_result = func(param);
 	sol::protected_function        func(sandbox["Execute"]);
 	sol::protected_function_result exec_result = func(param);
+	endScript();
 	if (!exec_result.valid())
 	{
 		sol::error error = exec_result;
@@ -228,11 +447,15 @@ void lua::showErrorDialog(wxWindow* parent, string_view title, string_view messa
 // -----------------------------------------------------------------------------
 bool lua::run(const string& program)
 {
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Scripting);
+
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
 
+	beginScript();
 	sol::environment sandbox(lua, sol::create, lua.globals());
 	auto             result = lua.script(program, sandbox, handleError);
+	endScript();
 	lua.collect_garbage();
 
 	if (!result.valid())
@@ -251,11 +474,15 @@ bool lua::run(const string& program)
 // -----------------------------------------------------------------------------
 bool lua::runFile(const string& filename)
 {
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Scripting);
+
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
 
+	beginScript();
 	sol::environment sandbox(lua, sol::create, lua.globals());
 	auto             result = lua.script_file(filename, sandbox, handleError);
+	endScript();
 	lua.collect_garbage();
 
 	if (!result.valid())
@@ -296,6 +523,27 @@ bool lua::runMapScript(const string& script, SLADEMap* map)
 	return runEditorScript<SLADEMap*>(script, map);
 }
 
+// -----------------------------------------------------------------------------
+// Sets the [progress] (0-1, or negative if unknown) and progress [message] of
+// the currently running script, shown once it has been running for a while
+// -----------------------------------------------------------------------------
+void lua::setScriptProgress(float progress, string_view message)
+{
+	script_progress.progress = progress;
+	script_progress.message  = message;
+	updateScriptProgress();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the currently running script has been cancelled, so scripts
+// can check this and finish early (scripts are otherwise aborted when next
+// checked while running)
+// -----------------------------------------------------------------------------
+bool lua::scriptCancelled()
+{
+	return updateScriptProgress(true);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the active lua state
 // -----------------------------------------------------------------------------
@@ -33,6 +33,10 @@ namespace lua
 	bool runEntryScript(const string& script, vector<ArchiveEntry*>& entries);
 	bool runMapScript(const string& script, SLADEMap* map);
 
+	// Progress of the currently running script
+	void setScriptProgress(float progress, string_view message = {});
+	bool scriptCancelled();
+
 	sol::state& state();
 
 	wxWindow* currentWindow();
@@ -229,6 +229,12 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 
 		++pos;
 	}
+
+	// Keep comment blocks sorted for isWithinComment
+	std::sort(
+		comment_blocks_.begin(),
+		comment_blocks_.end(),
+		[](const CommentBlock& left, const CommentBlock& right) { return left.start_pos < right.start_pos; });
 }
 
 // -----------------------------------------------------------------------------
@@ -245,12 +251,11 @@ void Lexer::addWord(string_view word, int style)
 // -----------------------------------------------------------------------------
 void Lexer::styleWord(LexerState& state, string_view word)
 {
-	string word_str{ word };
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word_str);
+	auto& word_str = lookupWord(word);
+	auto  found    = word_list_.find(word_str);
 
-	if (word_list_[word_str].style > 0)
-		state.editor->SetStyling(word.length(), word_list_[word_str].style);
+	if (found != word_list_.end() && found->second.style > 0)
+		state.editor->SetStyling(word.length(), found->second.style);
 	else if (strutil::startsWith(word_str, language_->preprocessor()))
 		state.editor->SetStyling(word.length(), Style::Preprocessor);
 	else
@@ -263,6 +268,20 @@ void Lexer::styleWord(LexerState& state, string_view word)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns [word] as it would be found in the word list (ie. lowercase if the
+// language isn't case sensitive). The returned string is only valid until the
+// next call
+// -----------------------------------------------------------------------------
+const string& Lexer::lookupWord(string_view word)
+{
+	word_lower_.assign(word);
+	if (!language_->caseSensitive())
+		strutil::lowerIP(word_lower_);
+
+	return word_lower_;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the valid word characters to [chars]
 // -----------------------------------------------------------------------------
@@ -289,11 +308,11 @@ void Lexer::setOperatorChars(string_view chars)
 // -----------------------------------------------------------------------------
 bool Lexer::processUnknown(LexerState& state)
 {
-	int    u_length = 0;
-	bool   end      = false;
-	bool   pp       = false;
-	string block_begin;
-	string block_end;
+	int         u_length = 0;
+	bool        end      = false;
+	bool        pp       = false;
+	string_view block_begin;
+	string_view block_end;
 
 	if (language_)
 	{
@@ -412,11 +431,11 @@ bool Lexer::processUnknown(LexerState& state)
 // -----------------------------------------------------------------------------
 bool Lexer::processWord(LexerState& state)
 {
-	vector<char> word;
-	bool         end = false;
+	string word;
+	bool   end = false;
 
 	// Add first letter
-	word.push_back((char)state.editor->GetCharAt(state.position++));
+	word += (char)state.editor->GetCharAt(state.position++);
 
 	while (true)
 	{
@@ -430,7 +449,7 @@ bool Lexer::processWord(LexerState& state)
 		char c = (char)state.editor->GetCharAt(state.position);
 		if (VECTOR_EXISTS(word_chars_, c))
 		{
-			word.push_back(c);
+			word += c;
 			state.position++;
 		}
 		else
@@ -440,9 +459,7 @@ bool Lexer::processWord(LexerState& state)
 		}
 	}
 
-	// Get word as string
-	string word_string{ &word[0], word.size() };
-	auto   word_lower = strutil::lower(word_string);
+	auto word_lower = strutil::lower(word);
 
 	// Check for preprocessor folding word
 	if (fold_preprocessor_ && word[0] == preprocessor_char_)
@@ -461,9 +478,9 @@ bool Lexer::processWord(LexerState& state)
 	}
 
 	if (debug_lexer)
-		log::debug("word: {}", word_string);
+		log::debug("word: {}", word);
 
-	styleWord(state, word_string);
+	styleWord(state, word);
 
 	return end;
 }
@@ -673,17 +690,28 @@ bool Lexer::checkToken(TextEditorCtrl* editor, int pos, const vector<string>& to
 // ----------------------------------------------------------------------------
 int Lexer::isWithinComment(int pos)
 {
-	for (unsigned i = 0; i < comment_blocks_.size(); ++i)
-		if (pos >= comment_blocks_[i].start_pos && pos < comment_blocks_[i].end_pos)
-			return i;
+	// Find the last block starting at or before [pos]
+	auto i = std::upper_bound(
+		comment_blocks_.begin(),
+		comment_blocks_.end(),
+		pos,
+		[](int value, const CommentBlock& block) { return value < block.start_pos; });
+	if (i == comment_blocks_.begin())
+		return -1;
+
+	--i;
+	if (pos < i->end_pos)
+		return i - comment_blocks_.begin();
 
 	return -1;
 }
 
 // ---------------------------------------------------------------------------
-// Updates code folding levels in [editor], starting from line [line_start]
+// Updates code folding levels in [editor], starting from line [line_start].
+// Lines after [line_end] (the last line that was styled) haven't changed, so
+// updating stops at the first of these that already has the correct level
 // -----------------------------------------------------------------------------
-void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
+void Lexer::updateFolding(TextEditorCtrl* editor, int line_start, int line_end)
 {
 	int fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
 
@@ -693,11 +721,23 @@ void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
 		int next_level = fold_level + lines_[l].fold_increment;
 		if (next_level < wxSTC_FOLDLEVELBASE)
 			next_level = wxSTC_FOLDLEVELBASE;
+		bool header_up = next_level > fold_level && !lines_[l].has_word;
+
+		// Stop if this (unchanged) line's level is already correct, the rest
+		// will be too. Its fold header may need to be moved up again though,
+		// as the previous line's level may have just been set
+		if (l > line_end
+			&& (editor->GetFoldLevel(l) & wxSTC_FOLDLEVELNUMBERMASK) == (header_up ? next_level : fold_level))
+		{
+			if (header_up)
+				editor->SetFoldLevel(l - 1, fold_level | wxSTC_FOLDLEVELHEADERFLAG);
+			break;
+		}
 
 		// Check if we are going up a fold level
 		if (next_level > fold_level)
 		{
-			if (!lines_[l].has_word)
+			if (header_up)
 			{
 				// Line doesn't have any words (eg. only has an opening brace),
 				// move the fold header up a line
@@ -720,10 +760,8 @@ void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
 // -----------------------------------------------------------------------------
 bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 {
-	auto word = editor->GetTextRange(start_pos, end_pos).ToStdString();
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word);
-	return word_list_[word].style == (int)Style::Function;
+	auto found = word_list_.find(lookupWord(editor->GetTextRange(start_pos, end_pos).ToStdString()));
+	return found != word_list_.end() && found->second.style == (int)Style::Function;
 }
 
 
@@ -763,11 +801,7 @@ void ZScriptLexer::styleWord(LexerState& state, string_view word)
 	// Check for '(' (possible function)
 	if (state.editor->GetCharAt(index) == '(')
 	{
-		string word_str{ word };
-		if (!language_->caseSensitive())
-			strutil::lowerIP(word_str);
-
-		if (VECTOR_EXISTS(functions_, word_str))
+		if (VECTOR_EXISTS(functions_, lookupWord(word)))
 		{
 			state.editor->SetStyling(word.length(), Style::Function);
 			return;
@@ -807,8 +841,5 @@ bool ZScriptLexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos
 		return false;
 
 	// Check if word is a function name
-	auto word = editor->GetTextRange(start_pos, end_pos).ToStdString();
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word);
-	return VECTOR_EXISTS(functions_, word);
+	return VECTOR_EXISTS(functions_, lookupWord(editor->GetTextRange(start_pos, end_pos).ToStdString()));
 }
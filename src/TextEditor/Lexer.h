@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+
 namespace slade
 {
 class TextEditorCtrl;
@@ -42,7 +44,7 @@ public:
 	void setWordChars(string_view chars);
 	void setOperatorChars(string_view chars);
 
-	void updateFolding(TextEditorCtrl* editor, int line_start);
+	void updateFolding(TextEditorCtrl* editor, int line_start, int line_end);
 	void foldComments(bool fold) { fold_comments_ = fold; }
 	void foldPreprocessor(bool fold) { fold_preprocessor_ = fold; }
 
@@ -77,7 +79,8 @@ protected:
 		char style;
 		WLIndex() : style(0) {}
 	};
-	std::map<string, WLIndex> word_list_;
+	std::unordered_map<string, WLIndex> word_list_; // Keys are lowercase if the language isn't case sensitive
+	string                              word_lower_; // Reused buffer for case-insensitive word lookups
 
 	struct LineInfo
 	{
@@ -92,7 +95,7 @@ protected:
 		int start_pos = -1;
 		int end_pos   = -1;
 	};
-	vector<CommentBlock> comment_blocks_;
+	vector<CommentBlock> comment_blocks_; // Sorted by start position
 
 	struct LexerState
 	{
@@ -112,8 +115,9 @@ protected:
 	bool processOperator(LexerState& state);
 	bool processWhitespace(LexerState& state);
 
-	virtual void styleWord(LexerState& state, string_view word);
-	bool         checkToken(TextEditorCtrl* editor, int pos, string_view token) const;
+	virtual void  styleWord(LexerState& state, string_view word);
+	const string& lookupWord(string_view word);
+	bool          checkToken(TextEditorCtrl* editor, int pos, string_view token) const;
 	bool checkToken(TextEditorCtrl* editor, int pos, const vector<string>& tokens, int* found_idx = nullptr) const;
 	int  isWithinComment(int pos);
 };
@@ -40,6 +40,7 @@
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <mutex>
 
 using namespace slade;
 
@@ -50,6 +51,42 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 vector<TextLanguage*> text_languages;
+namespace
+{
+std::once_flag languages_loaded;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the (already loaded) language definition matching [id], or nullptr
+// if no match found
+// -----------------------------------------------------------------------------
+TextLanguage* findLanguage(string_view id)
+{
+	for (auto& text_language : text_languages)
+		if (text_language->id() == id)
+			return text_language;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the text language definitions from slade.pk3 if they haven't been
+// already. They aren't loaded at startup since they're only needed once a
+// text editor is opened (safe to call from any thread)
+// -----------------------------------------------------------------------------
+void ensureLanguagesLoaded()
+{
+	std::call_once(languages_loaded, [] { TextLanguage::loadLanguages(); });
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -275,7 +312,10 @@ void TextLanguage::copyTo(TextLanguage* copy)
 		copy->word_lists_[a] = word_lists_[a];
 
 	// Copy functions
-	copy->functions_ = functions_;
+	copy->functions_          = functions_;
+	copy->functions_index_    = functions_index_;
+	copy->functions_index_ci_ = functions_index_ci_;
+	copy->autocomp_valid_     = false;
 
 	// Copy preprocessor/word block begin/end
 	copy->pp_block_begin_   = pp_block_begin_;
@@ -290,9 +330,12 @@ void TextLanguage::copyTo(TextLanguage* copy)
 void TextLanguage::addWord(WordType type, string_view keyword, bool custom)
 {
 	// Add only if it doesn't already exist
-	auto& list = custom ? word_lists_custom_[type].list : word_lists_[type].list;
-	if (std::find(list.begin(), list.end(), keyword) == list.end())
-		list.emplace_back(keyword);
+	auto& words = custom ? word_lists_custom_[type] : word_lists_[type];
+	if (words.index.emplace(keyword).second)
+	{
+		words.list.emplace_back(keyword);
+		autocomp_valid_ = false;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -322,15 +365,15 @@ void TextLanguage::addFunction(
 
 	// If it doesn't, create it
 	if (!func)
-	{
-		functions_.emplace_back(func_name);
-		func = &functions_.back();
-	}
+		func = addNewFunction(func_name);
 	// Clear the function if we're replacing it
 	else if (replace)
 	{
 		if (!context.empty())
+		{
 			func->clear();
+			func->setName(func_name);
+		}
 		else
 			func->clearContexts();
 	}
@@ -362,10 +405,7 @@ void TextLanguage::loadZScript(zscript::Definitions& defs, bool custom)
 
 			// If it doesn't, create it
 			if (!func)
-			{
-				functions_.emplace_back(f.name());
-				func = &functions_.back();
-			}
+				func = addNewFunction(f.name());
 
 			// Add the context
 			if (!func->hasContext(f.baseClass()))
@@ -422,28 +462,20 @@ string TextLanguage::functionsList()
 // -----------------------------------------------------------------------------
 string TextLanguage::autocompletionList(string_view start, bool include_custom)
 {
-	// Firstly, add all functions and word lists to a vector
+	if (!autocomp_valid_)
+		buildAutocompIndex();
+
+	// Get all items starting with [start] from the index
+	auto prefix = strutil::lower(start);
+	auto i      = std::lower_bound(
+		autocomp_items_.begin(),
+		autocomp_items_.end(),
+		prefix,
+		[](const AutocompItem& item, const string& key) { return item.key < key; });
 	vector<string> list;
-
-	// Add word lists
-	for (unsigned type = 0; type < 4; type++)
-	{
-		for (auto& word : word_lists_[type].list)
-			if (strutil::startsWithCI(word, start))
-				list.push_back(fmt::format("{}?{}", word, type + 1));
-
-		if (!include_custom)
-			continue;
-
-		for (auto& word : word_lists_custom_[type].list)
-			if (strutil::startsWithCI(word, start))
-				list.push_back(fmt::format("{}?{}", word, type + 1));
-	}
-
-	// Add functions
-	for (auto& func : functions_)
-		if (strutil::startsWithCI(func.name(), start))
-			list.push_back(fmt::format("{}{}", func.name(), "?5"));
+	for (; i != autocomp_items_.end() && strutil::startsWith(i->key, prefix); ++i)
+		if (include_custom || !i->custom)
+			list.push_back(i->item);
 
 	// Sort the list
 	std::sort(list.begin(), list.end());
@@ -497,11 +529,7 @@ vector<string> TextLanguage::functionsSorted()
 // -----------------------------------------------------------------------------
 bool TextLanguage::isWord(WordType type, string_view word)
 {
-	for (auto& w : word_lists_[type].list)
-		if (w == word)
-			return true;
-
-	return false;
+	return word_lists_[type].index.count(string{ word }) > 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -509,11 +537,7 @@ bool TextLanguage::isWord(WordType type, string_view word)
 // -----------------------------------------------------------------------------
 bool TextLanguage::isFunction(string_view word)
 {
-	for (auto& func : functions_)
-		if (func.name() == word)
-			return true;
-
-	return false;
+	return functions_index_.count(string{ word }) > 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -523,23 +547,35 @@ bool TextLanguage::isFunction(string_view word)
 TLFunction* TextLanguage::function(string_view name)
 {
 	// Find function matching [name]
-	if (case_sensitive_)
-	{
-		for (auto& func : functions_)
-			if (func.name() == name)
-				return &func;
-	}
-	else
-	{
-		for (auto& func : functions_)
-			if (strutil::equalCI(func.name(), name))
-				return &func;
-	}
+	const auto& index = case_sensitive_ ? functions_index_ : functions_index_ci_;
+	auto        i     = index.find(case_sensitive_ ? string{ name } : strutil::lower(name));
+	if (i != index.end())
+		return &functions_[i->second];
 
 	// Not found
 	return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Clears all (non-custom) words of [type] in the language
+// -----------------------------------------------------------------------------
+void TextLanguage::clearWordList(WordType type)
+{
+	word_lists_[type].clear();
+	autocomp_valid_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all functions in the language
+// -----------------------------------------------------------------------------
+void TextLanguage::clearFunctions()
+{
+	functions_.clear();
+	functions_index_.clear();
+	functions_index_ci_.clear();
+	autocomp_valid_ = false;
+}
+
 // -----------------------------------------------------------------------------
 // Clears all custom definitions in the language
 // -----------------------------------------------------------------------------
@@ -553,9 +589,69 @@ void TextLanguage::clearCustomDefs()
 		if (functions_[i].contexts().empty())
 			functions_.erase(functions_.begin() + i);
 	}
+	indexFunctions();
 
 	for (auto& a : word_lists_custom_)
-		a.list.clear();
+		a.clear();
+
+	autocomp_valid_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a new function [name] to the language (which must not exist already)
+// and returns it
+// -----------------------------------------------------------------------------
+TLFunction* TextLanguage::addNewFunction(string_view name)
+{
+	auto& func = functions_.emplace_back(name);
+	functions_index_.emplace(func.name(), functions_.size() - 1);
+	functions_index_ci_.emplace(strutil::lower(func.name()), functions_.size() - 1);
+	autocomp_valid_ = false;
+
+	return &func;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the function name lookup indices
+// -----------------------------------------------------------------------------
+void TextLanguage::indexFunctions()
+{
+	functions_index_.clear();
+	functions_index_ci_.clear();
+	for (size_t a = 0; a < functions_.size(); ++a)
+	{
+		functions_index_.emplace(functions_[a].name(), a);
+		functions_index_ci_.emplace(strutil::lower(functions_[a].name()), a);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the (sorted) autocompletion index from all words and functions in
+// the language
+// -----------------------------------------------------------------------------
+void TextLanguage::buildAutocompIndex()
+{
+	autocomp_items_.clear();
+
+	// Add word lists
+	for (unsigned type = 0; type < 4; type++)
+	{
+		for (auto& word : word_lists_[type].list)
+			autocomp_items_.push_back({ strutil::lower(word), fmt::format("{}?{}", word, type + 1), false });
+		for (auto& word : word_lists_custom_[type].list)
+			autocomp_items_.push_back({ strutil::lower(word), fmt::format("{}?{}", word, type + 1), true });
+	}
+
+	// Add functions
+	for (auto& func : functions_)
+		autocomp_items_.push_back({ strutil::lower(func.name()), fmt::format("{}{}", func.name(), "?5"), false });
+
+	std::sort(
+		autocomp_items_.begin(),
+		autocomp_items_.end(),
+		[](const AutocompItem& left, const AutocompItem& right) { return left.key < right.key; });
+
+	autocomp_valid_ = true;
 }
 
 
@@ -597,7 +693,7 @@ bool TextLanguage::readLanguageDefinition(MemChunk& mc, string_view source)
 		// Check for inheritance
 		if (!node->inherit().empty())
 		{
-			auto* inherit = fromId(node->inherit());
+			auto* inherit = findLanguage(node->inherit());
 			if (inherit)
 				inherit->copyTo(lang);
 			else
@@ -884,7 +980,8 @@ bool TextLanguage::readLanguageDefinition(MemChunk& mc, string_view source)
 }
 
 // -----------------------------------------------------------------------------
-// Loads all text language definitions from slade.pk3
+// Loads all text language definitions from slade.pk3.
+// Called on first use of any language (see ensureLanguagesLoaded)
 // -----------------------------------------------------------------------------
 bool TextLanguage::loadLanguages()
 {
@@ -926,15 +1023,8 @@ bool TextLanguage::loadLanguages()
 // -----------------------------------------------------------------------------
 TextLanguage* TextLanguage::fromId(string_view id)
 {
-	// Find text language matching [id]
-	for (auto& text_language : text_languages)
-	{
-		if (text_language->id_ == id)
-			return text_language;
-	}
-
-	// Not found
-	return nullptr;
+	ensureLanguagesLoaded();
+	return findLanguage(id);
 }
 
 // -----------------------------------------------------------------------------
@@ -943,6 +1033,8 @@ TextLanguage* TextLanguage::fromId(string_view id)
 // -----------------------------------------------------------------------------
 TextLanguage* TextLanguage::fromIndex(unsigned index)
 {
+	ensureLanguagesLoaded();
+
 	// Check index
 	if (index >= text_languages.size())
 		return nullptr;
@@ -955,6 +1047,8 @@ TextLanguage* TextLanguage::fromIndex(unsigned index)
 // -----------------------------------------------------------------------------
 TextLanguage* TextLanguage::fromName(string_view name)
 {
+	ensureLanguagesLoaded();
+
 	// Find text language matching [name]
 	for (auto& text_language : text_languages)
 	{
@@ -971,6 +1065,8 @@ TextLanguage* TextLanguage::fromName(string_view name)
 // -----------------------------------------------------------------------------
 vector<string> TextLanguage::languageNames()
 {
+	ensureLanguagesLoaded();
+
 	vector<string> ret;
 
 	for (auto& text_language : text_languages)
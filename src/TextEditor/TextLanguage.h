@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_set>
+
 namespace slade
 {
 namespace zscript
@@ -165,8 +167,8 @@ public:
 
 	TLFunction* function(string_view name);
 
-	void clearWordList(WordType type) { word_lists_[type].list.clear(); }
-	void clearFunctions() { functions_.clear(); }
+	void clearWordList(WordType type);
+	void clearFunctions();
 	void clearCustomDefs();
 
 	// Static functions
@@ -199,18 +201,39 @@ private:
 	// Word lists
 	struct WordList
 	{
-		vector<string> list;
-		bool           upper;
-		bool           lower;
-		bool           caps;
-		string         lookup_url;
+		vector<string>             list;
+		std::unordered_set<string> index; // All words in list, for lookups
+		bool                       upper;
+		bool                       lower;
+		bool                       caps;
+		string                     lookup_url;
+
+		void clear()
+		{
+			list.clear();
+			index.clear();
+		}
 	};
 	WordList word_lists_[4];
 	WordList word_lists_custom_[4];
 
 	// Functions
-	vector<TLFunction> functions_;
-	string             f_lookup_url_;
+	vector<TLFunction>                 functions_;
+	std::unordered_map<string, size_t> functions_index_;    // Function name -> index in functions_
+	std::unordered_map<string, size_t> functions_index_ci_; // Lowercase function name -> index of first match
+	string                             f_lookup_url_;
+
+	// Autocompletion list items (all words and functions) sorted by lowercase
+	// name, so the items starting with a given prefix are together.
+	// Rebuilt when needed after words or functions are added or removed
+	struct AutocompItem
+	{
+		string key;  // Lowercase word/function name
+		string item; // Autocompletion list item (name?type)
+		bool   custom = false;
+	};
+	vector<AutocompItem> autocomp_items_;
+	bool                 autocomp_valid_ = false;
 
 	// Zscript function properties which cannot be parsed from (g)zdoom.pk3
 	struct ZFuncExProp
@@ -219,5 +242,9 @@ private:
 		string deprecated_f;
 	};
 	std::map<string, ZFuncExProp> zfuncs_ex_props_;
+
+	TLFunction* addNewFunction(string_view name);
+	void        indexFunctions();
+	void        buildAutocompIndex();
 };
 } // namespace slade
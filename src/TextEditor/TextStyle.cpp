@@ -59,7 +59,32 @@ vector<TextEditorCtrl*> StyleSet::editors_;
 namespace
 {
 vector<unique_ptr<StyleSet>> style_sets;
-StyleSet*                    ss_current = nullptr;
+StyleSet*                    ss_current  = nullptr;
+bool                         sets_loaded = false;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Loads the built-in and custom style sets if they haven't been already.
+// They aren't loaded at startup since they're only needed once a text editor
+// is opened
+// -----------------------------------------------------------------------------
+void ensureSetsLoaded()
+{
+	if (sets_loaded)
+		return;
+
+	sets_loaded = true;
+	StyleSet::loadResourceStyles();
+	StyleSet::loadCustomStyles();
+}
 } // namespace
 
 
@@ -581,6 +606,8 @@ int StyleSet::defaultFontSize()
 // -----------------------------------------------------------------------------
 void StyleSet::initCurrent()
 {
+	ensureSetsLoaded();
+
 	// Create 'current' styleset
 	ss_current        = new StyleSet();
 	ss_current->name_ = "<current styleset>";
@@ -641,6 +668,8 @@ StyleSet* StyleSet::currentSet()
 // -----------------------------------------------------------------------------
 bool StyleSet::loadSet(string_view name)
 {
+	ensureSetsLoaded();
+
 	// Search for set matching name
 	for (auto& style_set : style_sets)
 	{
@@ -660,6 +689,8 @@ bool StyleSet::loadSet(string_view name)
 // -----------------------------------------------------------------------------
 bool StyleSet::loadSet(unsigned index)
 {
+	ensureSetsLoaded();
+
 	// Check index
 	if (index >= style_sets.size())
 		return false;
@@ -683,6 +714,8 @@ void StyleSet::applyCurrent(TextEditorCtrl* stc)
 // -----------------------------------------------------------------------------
 string StyleSet::styleName(unsigned index)
 {
+	ensureSetsLoaded();
+
 	// Check index
 	if (index >= style_sets.size())
 		return "";
@@ -695,6 +728,7 @@ string StyleSet::styleName(unsigned index)
 // -----------------------------------------------------------------------------
 unsigned StyleSet::numSets()
 {
+	ensureSetsLoaded();
 	return style_sets.size();
 }
 
@@ -703,6 +737,8 @@ unsigned StyleSet::numSets()
 // -----------------------------------------------------------------------------
 StyleSet* StyleSet::set(unsigned index)
 {
+	ensureSetsLoaded();
+
 	// Check index
 	if (index >= style_sets.size())
 		return nullptr;
@@ -741,6 +777,8 @@ void StyleSet::applyCurrentToAll()
 // -----------------------------------------------------------------------------
 void StyleSet::addSet(StyleSet* set)
 {
+	ensureSetsLoaded();
+
 	// Find existing custom set with same name
 	for (const auto& s : style_sets)
 		if (s->name_ == set->name_)
@@ -76,7 +76,6 @@ CVAR(Bool, txed_tab_spaces, false, CVar::Flag::Save)
 CVAR(Int, txed_show_whitespace, 0, CVar::Flag::Save)
 CVAR(Bool, txed_calltips_argset_kb, true, CVar::Flag::Save)
 
-wxDEFINE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDEFINE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 
@@ -88,17 +87,36 @@ wxDEFINE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 
 // -----------------------------------------------------------------------------
-// JumpToCalculator thread entry function
+// JumpToCalculator class constructor
 // -----------------------------------------------------------------------------
-wxThread::ExitCode JumpToCalculator::Entry()
+JumpToCalculator::JumpToCalculator(string_view text, const vector<string>& block_names, vector<string> ignore) :
+	text_{ text },
+	ignore_{ std::move(ignore) }
 {
-	wxString jump_points;
+	// Get jump block keywords (and number of tokens to skip if given, eg. 'script:1')
+	for (const auto& block : block_names)
+	{
+		auto colon = block.find(':');
+		if (colon == string::npos)
+			blocks_.push_back({ block, 0 });
+		else
+			blocks_.push_back({ block.substr(0, colon), strutil::asInt(string_view{ block }.substr(colon + 1)) });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the jump points in the text, returned as a comma-separated list
+// of line/name pairs
+// -----------------------------------------------------------------------------
+string JumpToCalculator::calculate() const
+{
+	string jump_points;
 
 	Tokenizer tz;
 	tz.setSpecialCharacters(";,:|={}/()");
 	tz.openString(text_);
 
-	wxString token = tz.getToken();
+	string token = tz.getToken();
 	while (!tz.atEnd())
 	{
 		if (token == "{")
@@ -108,36 +126,27 @@ wxThread::ExitCode JumpToCalculator::Entry()
 				token = tz.getToken();
 		}
 
-		for (auto block : block_names_)
+		for (const auto& block : blocks_)
 		{
-			// Get jump block keyword
-			long skip = 0;
-			if (strutil::contains(block, ':'))
-			{
-				auto sp = wxSplit(block, ':');
-				sp.back().ToLong(&skip);
-				block = sp[0];
-			}
-
-			if (S_CMPNOCASE(token, block))
+			if (strutil::equalCI(token, block.keyword))
 			{
-				wxString name = tz.getToken();
-				for (int s = 0; s < skip; s++)
+				auto name = tz.getToken();
+				for (int s = 0; s < block.skip; s++)
 					name = tz.getToken();
 
 				for (const auto& i : ignore_)
-					if (S_CMPNOCASE(name, i))
+					if (strutil::equalCI(name, i))
 						name = tz.getToken();
 
 				// Numbered block, add block name
-				if (name.IsNumber())
-					name = wxString::Format("%s %s", block, name);
+				if (strutil::isInteger(name, false))
+					name = fmt::format("{} {}", block.keyword, name);
 				// Unnamed block, use block name
 				if (name == "{" || name == ";")
-					name = block;
+					name = block.keyword;
 
 				// Add jump point
-				jump_points += wxString::Format("%d,%s,", tz.lineNo() - 1, name);
+				jump_points += fmt::format("{},{},", tz.lineNo() - 1, name);
 			}
 		}
 
@@ -146,14 +155,9 @@ wxThread::ExitCode JumpToCalculator::Entry()
 
 	// Remove ending comma
 	if (!jump_points.empty())
-		jump_points.RemoveLast(1);
-
-	// Send event
-	auto event = new wxThreadEvent(wxEVT_COMMAND_JTCALCULATOR_COMPLETED);
-	event->SetString(jump_points);
-	wxQueueEvent(handler_, event);
+		jump_points.pop_back();
 
-	return nullptr;
+	return jump_points;
 }
 
 
@@ -212,7 +216,6 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	Bind(wxEVT_KILL_FOCUS, &TextEditorCtrl::onFocusLoss, this);
 	Bind(wxEVT_ACTIVATE, &TextEditorCtrl::onActivate, this);
 	Bind(wxEVT_STC_MARGINCLICK, &TextEditorCtrl::onMarginClick, this);
-	Bind(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, &TextEditorCtrl::onJumpToCalculateComplete, this);
 	Bind(wxEVT_STC_CHANGE, &TextEditorCtrl::onModified, this);
 	Bind(wxEVT_TIMER, &TextEditorCtrl::onUpdateTimer, this);
 	Bind(wxEVT_STC_STYLENEEDED, &TextEditorCtrl::onStyleNeeded, this);
@@ -223,6 +226,10 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 // -----------------------------------------------------------------------------
 TextEditorCtrl::~TextEditorCtrl()
 {
+	// Discard any in-progress jump to calculation
+	if (jump_to_job_)
+		jump_to_job_->cancel();
+
 	StyleSet::removeEditor(this);
 }
 
@@ -997,17 +1004,29 @@ void TextEditorCtrl::updateJumpToList()
 	if (!choice_jump_to_)
 		return;
 
-	if (!language_ || jump_to_calculator_ || GetText().length() == 0)
+	// If the list is currently being calculated, update again once it's done
+	if (jump_to_job_)
+	{
+		jump_to_outdated_ = true;
+		return;
+	}
+
+	if (!language_ || GetTextLength() == 0)
 	{
 		choice_jump_to_->Clear();
+		jump_to_lines_.clear();
 		return;
 	}
 
-	// Begin jump to calculation thread
-	choice_jump_to_->Enable(false);
-	jump_to_calculator_ = new JumpToCalculator(
-		this, wxutil::strToView(GetText()), language_->jumpBlocks(), language_->jumpBlocksIgnored());
-	jump_to_calculator_->Run();
+	// Begin jump to calculation job (the result is only used if the job isn't
+	// cancelled, so this editor will still exist when it completes)
+	jump_to_outdated_ = false;
+	auto calculator   = std::make_shared<JumpToCalculator>(
+		wxutil::strToView(GetText()), language_->jumpBlocks(), language_->jumpBlocksIgnored());
+	auto result  = std::make_shared<string>();
+	jump_to_job_ = jobs::run(
+		[calculator, result](jobs::Job&) { *result = calculator->calculate(); },
+		[this, result]() { onJumpToCalculateComplete(*result); });
 }
 
 // -----------------------------------------------------------------------------
@@ -1718,22 +1737,25 @@ void TextEditorCtrl::onMarginClick(wxStyledTextEvent& e)
 }
 
 // -----------------------------------------------------------------------------
-// Called when the 'Jump To' calculation thread completes
+// Called when the 'Jump To' calculation job completes with [jump_points]
 // -----------------------------------------------------------------------------
-void TextEditorCtrl::onJumpToCalculateComplete(wxThreadEvent& e)
+void TextEditorCtrl::onJumpToCalculateComplete(const string& jump_points)
 {
+	jump_to_job_.reset();
 	if (!choice_jump_to_)
+		return;
+
+	// Text was changed while calculating, the results are already out of date
+	if (jump_to_outdated_)
 	{
-		jump_to_calculator_ = nullptr;
+		updateJumpToList();
 		return;
 	}
 
-	choice_jump_to_->Clear();
-	jump_to_lines_.clear();
-
-	auto split = wxSplit(e.GetString(), ',');
+	auto split = wxSplit(wxString::FromUTF8(jump_points), ',');
 
 	wxArrayString items;
+	vector<int>   lines;
 	for (unsigned a = 0; a < split.size(); a += 2)
 	{
 		if (a == split.size() - 1)
@@ -1742,16 +1764,18 @@ void TextEditorCtrl::onJumpToCalculateComplete(wxThreadEvent& e)
 		long line;
 		if (!split[a].ToLong(&line))
 			line = 0;
-		wxString name = split[a + 1];
 
-		items.push_back(name);
-		jump_to_lines_.push_back(line);
+		items.push_back(split[a + 1]);
+		lines.push_back(line);
 	}
 
-	choice_jump_to_->Append(items);
-	choice_jump_to_->Enable(true);
+	// Only rebuild the list if something changed
+	if (lines == jump_to_lines_ && items == choice_jump_to_->GetStrings())
+		return;
 
-	jump_to_calculator_ = nullptr;
+	choice_jump_to_->Clear();
+	choice_jump_to_->Append(items);
+	jump_to_lines_ = std::move(lines);
 }
 
 // -----------------------------------------------------------------------------
@@ -1841,7 +1865,7 @@ void TextEditorCtrl::onStyleNeeded(wxStyledTextEvent& e)
 	if (txed_fold_enable)
 	{
 		auto modified = last_modified_;
-		lexer_->updateFolding(this, line_start);
+		lexer_->updateFolding(this, line_start, line_end);
 		last_modified_ = modified;
 	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/ArchiveEntry.h"
+#include "General/Jobs.h"
 #include "TextEditor/Lexer.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
@@ -11,7 +12,6 @@ class wxCheckBox;
 class wxTextCtrl;
 class wxChoice;
 
-wxDECLARE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDECLARE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 namespace slade
@@ -19,25 +19,24 @@ namespace slade
 class FindReplacePanel;
 class SCallTip;
 
-class JumpToCalculator : public wxThread
+class JumpToCalculator
 {
 public:
-	JumpToCalculator(wxEvtHandler* handler, string_view text, vector<string> block_names, vector<string> ignore) :
-		handler_(handler),
-		text_(text),
-		block_names_(std::move(block_names)),
-		ignore_(std::move(ignore))
-	{
-	}
-	virtual ~JumpToCalculator() = default;
+	JumpToCalculator(string_view text, const vector<string>& block_names, vector<string> ignore);
+	~JumpToCalculator() = default;
 
-	ExitCode Entry() override;
+	string calculate() const;
 
 private:
-	wxEvtHandler*  handler_;
-	string         text_;
-	vector<string> block_names_;
-	vector<string> ignore_;
+	struct JumpBlock
+	{
+		string keyword;
+		int    skip = 0; // Number of tokens to skip after the keyword to get the name
+	};
+
+	string            text_;
+	vector<JumpBlock> blocks_;
+	vector<string>    ignore_;
 };
 
 class TextEditorCtrl : public wxStyledTextCtrl
@@ -94,16 +93,16 @@ public:
 	void cycleComments() const;
 
 private:
-	TextLanguage*     language_           = nullptr;
-	FindReplacePanel* panel_fr_           = nullptr;
-	SCallTip*         call_tip_           = nullptr;
-	wxChoice*         choice_jump_to_     = nullptr;
-	JumpToCalculator* jump_to_calculator_ = nullptr;
-	unique_ptr<Lexer> lexer_;
-	wxString          prev_word_match_;
-	wxString          autocomp_list_;
-	vector<int>       jump_to_lines_;
-	long              last_modified_ = 0;
+	TextLanguage*         language_       = nullptr;
+	FindReplacePanel*     panel_fr_       = nullptr;
+	SCallTip*             call_tip_       = nullptr;
+	wxChoice*             choice_jump_to_ = nullptr;
+	shared_ptr<jobs::Job> jump_to_job_;
+	unique_ptr<Lexer>     lexer_;
+	wxString              prev_word_match_;
+	wxString              autocomp_list_;
+	vector<int>           jump_to_lines_;
+	long                  last_modified_ = 0;
 
 	// State tracking for updates
 	int  prev_cursor_pos_      = -1;
@@ -115,6 +114,7 @@ private:
 	wxTimer timer_update_;
 	bool    update_jump_to_    = false;
 	bool    update_word_match_ = false;
+	bool    jump_to_outdated_  = false; // Text changed while the jump to list was being calculated
 
 	// Calltip stuff
 	TLFunction* ct_function_ = nullptr;
@@ -139,7 +139,7 @@ private:
 	void onFocusLoss(wxFocusEvent& e);
 	void onActivate(wxActivateEvent& e);
 	void onMarginClick(wxStyledTextEvent& e);
-	void onJumpToCalculateComplete(wxThreadEvent& e);
+	void onJumpToCalculateComplete(const string& jump_points);
 	void onJumpToChoiceSelected(wxCommandEvent& e);
 	void onModified(wxStyledTextEvent& e);
 	void onUpdateTimer(wxTimerEvent& e);
@@ -34,8 +34,11 @@
 #include "Main.h"
 #include "BrowserCanvas.h"
 #include "BrowserItem.h"
+#include "App.h"
 #include "General/UI.h"
 #include "OpenGL/Drawing.h"
+#include "OpenGL/GLTexture.h"
+#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -47,6 +50,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Int, browser_bg_type, false, CVar::Flag::Save)
 CVAR(Int, browser_item_size, 96, CVar::Flag::Save)
+CVAR(Int, browser_load_budget, 10, CVar::Flag::Save) // Time (ms) to spend loading item images per frame
 DEFINE_EVENT_TYPE(wxEVT_BROWSERCANVAS_SELECTION_CHANGED)
 
 
@@ -61,7 +65,7 @@ DEFINE_EVENT_TYPE(wxEVT_BROWSERCANVAS_SELECTION_CHANGED)
 // BrowserCanvas class constructor
 // -----------------------------------------------------------------------------
 BrowserCanvas::BrowserCanvas(wxWindow* parent) :
-	OGLCanvas{ parent, -1 },
+	OGLCanvas{ parent, -1, true, 30 },
 	item_border_{ ui::scalePx(8) },
 	font_{ drawing::Font::Bold }
 {
@@ -107,6 +111,11 @@ void BrowserCanvas::addItem(BrowserItem* item)
 // -----------------------------------------------------------------------------
 void BrowserCanvas::clearItems()
 {
+	// Clear any images loaded for the items
+	for (auto* item : items_loaded_)
+		item->clearImage();
+	items_loaded_.clear();
+
 	items_.clear();
 }
 
@@ -147,6 +156,9 @@ int BrowserCanvas::fullItemSizeY() const
 // -----------------------------------------------------------------------------
 void BrowserCanvas::draw()
 {
+	// Upload any finished thumbnails
+	gl::Texture::processUploads();
+
 	// Setup the viewport
 	glViewport(0, 0, GetSize().x, GetSize().y);
 
@@ -203,29 +215,26 @@ void BrowserCanvas::draw()
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 	glLineWidth(2.0f);
 
-	// Draw items
-	int x         = item_border_;
-	int y         = item_border_;
-	int col_width = GetSize().x / num_cols_;
-	int col       = 0;
+	// Determine visible items
+	int num_cols   = std::max(num_cols_, 1);
+	int row_height = fullItemSizeY();
+	int skip       = yoff_ - row_height - item_border_;
+	int first_row  = skip > 0 ? (skip + row_height - 1) / row_height : 0;
+	int last_row   = (yoff_ + GetSize().y - item_border_) / row_height;
+	int first      = first_row * num_cols;
+	int last       = std::min<int>(items_filter_.size(), (last_row + 1) * num_cols) - 1;
+
+	// Load images for visible items (and unload any no longer near the view)
+	updateItemImages(first, last);
+
+	// Draw items (item names are batched and drawn after all items)
+	drawing::beginTextBatch();
+	int col_width = GetSize().x / num_cols;
 	top_index_    = -1;
-	for (unsigned a = 0; a < items_filter_.size(); a++)
+	for (int a = first; a <= last; a++)
 	{
-		// If we're not yet into the viewable area, skip
-		if (y < yoff_ - fullItemSizeY())
-		{
-			col++;
-			if (col >= num_cols_)
-			{
-				col = 0;
-				y += fullItemSizeY();
-
-				// Canvas is filled, stop drawing
-				if (y > yoff_ + GetSize().y)
-					break;
-			}
-			continue;
-		}
+		int col = a % num_cols;
+		int y   = item_border_ + (a / num_cols) * row_height;
 
 		// If we're drawing the first non-hidden item, save it
 		if (top_index_ < 0)
@@ -236,7 +245,7 @@ void BrowserCanvas::draw()
 
 		// Determine current x position
 		int xgap = (col_width - fullItemSizeX()) * 0.5;
-		x        = item_border_ + xgap + (col * col_width);
+		int x    = item_border_ + xgap + (col * col_width);
 
 		// Draw selection box if selected
 		if (item_selected_ == items_[items_filter_[a]])
@@ -278,24 +287,81 @@ void BrowserCanvas::draw()
 		else
 			items_[items_filter_[a]]->draw(
 				item_size_, x, y - yoff_, font_, show_names_, item_type_, col_text, text_shadow);
-
-		// Move over for next item
-		col++;
-		if (col >= num_cols_)
-		{
-			col = 0;
-			y += fullItemSizeY();
-
-			// Canvas is filled, stop drawing
-			if (y > yoff_ + GetSize().y)
-				break;
-		}
 	}
+	drawing::endTextBatch();
 
 	// Swap Buffers
 	SwapBuffers();
 }
 
+// -----------------------------------------------------------------------------
+// Called when the update timer ticks, keeps redrawing while visible items are
+// waiting for their images
+// -----------------------------------------------------------------------------
+void BrowserCanvas::update(long frametime)
+{
+	if (images_pending_)
+		Refresh();
+}
+
+// -----------------------------------------------------------------------------
+// Loads images for the visible (filtered) items [first] to [last], and then
+// for the items within a page before and after them, until the time budget
+// (browser_load_budget) for this frame is used up. Images of any other items
+// are unloaded
+// -----------------------------------------------------------------------------
+void BrowserCanvas::updateItemImages(int first, int last)
+{
+	images_pending_ = false;
+	if (first > last)
+		return;
+
+	int  size       = item_size_ > 0 ? item_size_ : static_cast<int>(browser_item_size);
+	int  margin     = last - first + 1;
+	int  keep_first = std::max(0, first - margin);
+	int  keep_last  = std::min<int>(items_filter_.size() - 1, last + margin);
+	auto start      = app::runTimer();
+
+	auto load = [&](int index) {
+		auto item = items_[items_filter_[index]];
+		if (item->imageFailed())
+			return;
+
+		if (app::runTimer() - start < browser_load_budget || item->imagePending())
+			item->updateImage(size);
+		if (item->imageLoaded() || item->imagePending())
+			items_loaded_.insert(item);
+
+		// Keep going while visible items are waiting for images
+		if (index >= first && index <= last && (!item->imageLoaded() || item->imagePending()) && !item->imageFailed())
+			images_pending_ = true;
+	};
+
+	// Visible items first, then the margin after and before them
+	for (int a = first; a <= last; a++)
+		load(a);
+	for (int a = last + 1; a <= keep_last; a++)
+		load(a);
+	for (int a = first - 1; a >= keep_first; a--)
+		load(a);
+
+	// Unload images of items outside the margin
+	std::set<BrowserItem*> keep;
+	for (int a = keep_first; a <= keep_last; a++)
+		keep.insert(items_[items_filter_[a]]);
+	for (auto i = items_loaded_.begin(); i != items_loaded_.end();)
+	{
+		if (keep.count(*i))
+		{
+			++i;
+			continue;
+		}
+
+		(*i)->clearImage();
+		i = items_loaded_.erase(i);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Sets this canvas' associated vertical scrollbar
 // -----------------------------------------------------------------------------
@@ -443,34 +509,78 @@ void BrowserCanvas::filterItems(wxString filter)
 	// Find the currently-viewed item before we change the item list
 	int viewed_index = getViewedIndex();
 
-	// Clear current filter list
-	items_filter_.clear();
+	// Rebuild the filter index if the items have changed
+	bool index_updated = index_items_ != items_;
+	if (index_updated)
+		updateFilterIndex();
 
-	// If the filter is empty, just add all items to the filter
-	if (filter.IsEmpty())
+	auto new_filter = strutil::lower(filter.ToStdString());
+	if (new_filter.empty())
 	{
+		// If the filter is empty, just add all items to the filter
+		items_filter_.resize(items_.size());
 		for (unsigned a = 0; a < items_.size(); a++)
-			items_filter_.push_back(a);
+			items_filter_[a] = a;
+	}
+	else if (new_filter.find_first_of("*?") == string::npos)
+	{
+		// No wildcards, find all names starting with the filter in the sorted
+		// index
+		auto i = std::lower_bound(
+			index_sorted_.begin(), index_sorted_.end(), new_filter, [this](int index, const string& value) {
+				return index_names_[index] < value;
+			});
+		items_filter_.clear();
+		for (; i != index_sorted_.end() && strutil::startsWith(index_names_[*i], new_filter); ++i)
+			items_filter_.push_back(*i);
+		std::sort(items_filter_.begin(), items_filter_.end());
 	}
 	else
 	{
-		// Setup filter string
-		filter.MakeLower();
-		filter += "*";
-
-		// Go through items
-		for (unsigned a = 0; a < items_.size(); a++)
+		// If the filter only adds to the previous one, only the items that
+		// matched it need checking
+		vector<int> candidates;
+		if (!index_updated && !filter_.empty() && strutil::startsWith(new_filter, filter_))
+			candidates.swap(items_filter_);
+		else
 		{
-			// Add to filter list if name matches
-			if (items_[a]->name().Lower().Matches(filter))
-				items_filter_.push_back(a);
+			candidates.resize(items_.size());
+			for (unsigned a = 0; a < items_.size(); a++)
+				candidates[a] = a;
 		}
+
+		// Add to filter list if name matches
+		auto match = new_filter + "*";
+		items_filter_.clear();
+		for (auto index : candidates)
+			if (strutil::matches(index_names_[index], match))
+				items_filter_.push_back(index);
 	}
+	filter_ = new_filter;
 
 	// Update scrollbar and refresh
 	updateLayout(viewed_index);
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the filter index (lowercase names and name-sorted item indices) for
+// the current items
+// -----------------------------------------------------------------------------
+void BrowserCanvas::updateFilterIndex()
+{
+	index_items_ = items_;
+	index_names_.resize(items_.size());
+	index_sorted_.resize(items_.size());
+	for (unsigned a = 0; a < items_.size(); a++)
+	{
+		index_names_[a]  = strutil::lower(items_[a]->name().ToStdString());
+		index_sorted_[a] = a;
+	}
+	std::sort(index_sorted_.begin(), index_sorted_.end(), [this](int left, int right) {
+		return index_names_[left] < index_names_[right];
+	});
+}
+
 // -----------------------------------------------------------------------------
 // Scrolls the view to show [item] if it is currently off-screen.
 // If [where] is positive, the item will be shown on the top row;
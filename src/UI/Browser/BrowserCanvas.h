@@ -51,6 +51,7 @@ public:
 	void                  setItemSize(int size) { this->item_size_ = size; }
 	void                  setItemViewType(ItemView type) { this->item_type_ = type; }
 	int                   longestItemTextWidth() const;
+	void                  update(long frametime) override;
 
 	// Events
 	void onSize(wxSizeEvent& e);
@@ -70,6 +71,18 @@ private:
 	wxString             search_;
 	BrowserItem*         item_selected_ = nullptr;
 
+	// Filter index, lowercase item names and item indices sorted by name. Only
+	// rebuilt when the item list (or its order) changes
+	vector<BrowserItem*> index_items_;
+	vector<string>       index_names_;
+	vector<int>          index_sorted_;
+	string               filter_;
+
+	// Item images. Images are only kept for items within a page of the visible
+	// area, and are loaded within a time budget each frame
+	std::set<BrowserItem*> items_loaded_;
+	bool                   images_pending_ = false; // Visible items are still waiting for images
+
 	// Display
 	int           yoff_        = 0;
 	int           item_border_ = 0;
@@ -80,6 +93,9 @@ private:
 	int           top_y_       = 0;
 	ItemView      item_type_   = ItemView::Normal;
 	int           num_cols_    = -1;
+
+	void updateFilterIndex();
+	void updateItemImages(int first, int last);
 };
 } // namespace slade
 
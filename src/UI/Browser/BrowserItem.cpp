@@ -34,17 +34,104 @@
 #include "Main.h"
 #include "BrowserItem.h"
 #include "BrowserWindow.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
+#include "Graphics/SImage/SImage.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
 
 using namespace slade;
 using NameType = BrowserCanvas::NameType;
 using ItemView = BrowserCanvas::ItemView;
 
 
+// -----------------------------------------------------------------------------
+//
+// BrowserItem::Thumbnail Struct
+//
+// -----------------------------------------------------------------------------
+struct BrowserItem::Thumbnail
+{
+	std::function<bool(SImage&)> load;
+	Palette                      palette;
+	int                          size = 0;
+	SImage                       image;
+	Vec2i                        full_size;
+	bool                         ok = false;
+	std::atomic<bool>            done{ false };
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Scales [image] down to fit within [size]x[size] (if it is larger), averaging
+// the pixels covered by each scaled pixel. The image is converted to RGBA
+// (using [pal] if it is paletted)
+// -----------------------------------------------------------------------------
+void scaleToFit(SImage& image, Palette* pal, int size)
+{
+	int width  = image.width();
+	int height = image.height();
+	if (size <= 0 || (width <= size && height <= size))
+		return;
+
+	double scale      = static_cast<double>(size) / std::max(width, height);
+	int    new_width  = std::max(1, static_cast<int>(width * scale));
+	int    new_height = std::max(1, static_cast<int>(height * scale));
+
+	MemChunk rgba;
+	if (!image.putRGBAData(rgba, pal))
+		return;
+
+	vector<uint8_t> scaled(new_width * new_height * 4);
+	for (int y = 0; y < new_height; y++)
+	{
+		int y1 = y * height / new_height;
+		int y2 = std::max(y1 + 1, (y + 1) * height / new_height);
+		for (int x = 0; x < new_width; x++)
+		{
+			int x1 = x * width / new_width;
+			int x2 = std::max(x1 + 1, (x + 1) * width / new_width);
+
+			// Average colour weighted by alpha, so transparent pixels don't
+			// darken the edges
+			unsigned r = 0, g = 0, b = 0, a = 0, n = 0;
+			for (int sy = y1; sy < y2; sy++)
+				for (int sx = x1; sx < x2; sx++)
+				{
+					auto* pixel = rgba.data() + (sy * width + sx) * 4;
+					r += pixel[0] * pixel[3];
+					g += pixel[1] * pixel[3];
+					b += pixel[2] * pixel[3];
+					a += pixel[3];
+					n++;
+				}
+
+			auto* out = scaled.data() + (y * new_width + x) * 4;
+			if (a > 0)
+			{
+				out[0] = r / a;
+				out[1] = g / a;
+				out[2] = b / a;
+			}
+			out[3] = a / n;
+		}
+	}
+
+	image.setImageData(scaled, new_width, new_height, SImage::Type::RGBA);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // BrowserItem Class Functions
@@ -71,6 +158,125 @@ bool BrowserItem::loadImage()
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the item image is loaded (or a thumbnail of it)
+// -----------------------------------------------------------------------------
+bool BrowserItem::imageLoaded() const
+{
+	return image_tex_ && gl::Texture::isLoaded(image_tex_);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the item image (thumbnail) is still being generated or is
+// waiting to be uploaded
+// -----------------------------------------------------------------------------
+bool BrowserItem::imagePending() const
+{
+	return thumbnail_ != nullptr || gl::Texture::isUploadPending(image_tex_);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the full size of the item image (even if it was scaled down to a
+// thumbnail)
+// -----------------------------------------------------------------------------
+Vec2i BrowserItem::imageSize() const
+{
+	if (thumb_size_ > 0)
+		return image_size_;
+
+	return gl::Texture::info(image_tex_).size;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the item image for display at [size] if it isn't loaded already (or
+// was scaled down to a smaller thumbnail than [size]), or uploads its
+// thumbnail if it has finished generating in the background.
+// Returns true if anything was loaded
+// -----------------------------------------------------------------------------
+bool BrowserItem::updateImage(int size)
+{
+	display_size_ = size;
+
+	// Check for a finished thumbnail
+	if (thumbnail_)
+	{
+		if (!thumbnail_->done)
+			return false;
+
+		auto thumb = std::move(thumbnail_);
+		if (!thumb->ok)
+		{
+			image_failed_ = !imageLoaded();
+			return true;
+		}
+
+		// Queue upload (any previous image is shown until it is done)
+		if (!image_tex_)
+			image_tex_ = gl::Texture::create();
+		if (!gl::Texture::loadImageAsync(image_tex_, thumb->image, &thumb->palette))
+		{
+			gl::Texture::clear(image_tex_);
+			image_tex_ = 0;
+		}
+		image_size_ = thumb->full_size;
+		thumb_size_ = thumb->image.width() < thumb->full_size.x || thumb->image.height() < thumb->full_size.y
+						  ? thumb->size
+						  : 0;
+		return true;
+	}
+
+	if (gl::Texture::isUploadPending(image_tex_))
+		return false;
+
+	if (image_failed_ || (imageLoaded() && (thumb_size_ == 0 || thumb_size_ >= size)))
+		return false;
+
+	if (!loadImage() && !thumbnail_)
+		image_failed_ = !imageLoaded();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Starts generating a thumbnail of the item image on the worker thread pool.
+// [load] is called (on a worker thread) to load the full image, which is then
+// scaled down to the size the item is displayed at. The thumbnail is uploaded
+// when finished, by updateImage
+// -----------------------------------------------------------------------------
+void BrowserItem::generateThumbnail(std::function<bool(SImage&)> load)
+{
+	auto thumb  = std::make_shared<Thumbnail>();
+	thumb->load = std::move(load);
+	thumb->size = display_size_;
+	if (parent_)
+		thumb->palette.copyPalette(parent_->palette());
+
+	threadpool::enqueue([thumb]() {
+		thumb->ok = thumb->load(thumb->image) && thumb->image.isValid();
+		if (thumb->ok)
+		{
+			thumb->full_size = { thumb->image.width(), thumb->image.height() };
+			scaleToFit(thumb->image, &thumb->palette, thumb->size);
+		}
+		thumb->load = nullptr;
+		thumb->done = true;
+	});
+
+	thumbnail_ = thumb;
+}
+
+// -----------------------------------------------------------------------------
+// Discards any thumbnail being generated and clears the image size and failed
+// state (for use when the item image is cleared)
+// -----------------------------------------------------------------------------
+void BrowserItem::clearThumbnail()
+{
+	thumbnail_.reset();
+	thumb_size_   = 0;
+	image_size_   = {};
+	image_failed_ = false;
+}
+
 // -----------------------------------------------------------------------------
 // Draws the item in a [size]x[size] box, keeping the correct aspect ratio of
 // it's image
@@ -140,16 +346,16 @@ void BrowserItem::draw(
 	if (blank_)
 		return;
 
-	// Try to load image if it isn't already
-	if (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_)))
-		loadImage();
-
-	// If it still isn't just draw a red box with an X
-	if (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_)))
+	// If the image isn't loaded (yet) just draw a box, with an X in it if it
+	// failed to load
+	if (!imageLoaded())
 	{
 		glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
 
-		glColor3f(1, 0, 0);
+		if (image_failed_)
+			glColor3f(1, 0, 0);
+		else
+			glColor4f(0.5f, 0.5f, 0.5f, 0.5f);
 		glDisable(GL_TEXTURE_2D);
 
 		// Outline
@@ -161,22 +367,25 @@ void BrowserItem::draw(
 		glEnd();
 
 		// X
-		glBegin(GL_LINES);
-		glVertex2i(x, y);
-		glVertex2i(x + size, y + size);
-		glVertex2i(x, y + size);
-		glVertex2i(x + size, y);
-		glEnd();
+		if (image_failed_)
+		{
+			glBegin(GL_LINES);
+			glVertex2i(x, y);
+			glVertex2i(x + size, y + size);
+			glVertex2i(x, y + size);
+			glVertex2i(x + size, y);
+			glEnd();
+		}
 
 		glPopAttrib();
 
 		return;
 	}
 
-	// Determine texture dimensions
-	auto&  tex_info = gl::Texture::info(image_tex_);
-	double width    = tex_info.size.x;
-	double height   = tex_info.size.y;
+	// Determine image dimensions
+	auto   image_size = imageSize();
+	double width      = image_size.x;
+	double height     = image_size.y;
 
 	// Scale up if size > 128
 	if (size > 128)
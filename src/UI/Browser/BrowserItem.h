@@ -2,14 +2,17 @@
 
 #include "BrowserCanvas.h"
 #include "OpenGL/Drawing.h"
+#include <functional>
 
 namespace slade
 {
 class BrowserWindow;
+class SImage;
 
 class BrowserItem
 {
 	friend class BrowserWindow;
+class SImage;
 
 public:
 	BrowserItem(const wxString& name, unsigned index = 0, const wxString& type = "item");
@@ -17,8 +20,13 @@ public:
 
 	wxString name() const { return name_; }
 	unsigned index() const { return index_; }
+	bool     imageFailed() const { return image_failed_; }
+	bool     imagePending() const;
+	bool     imageLoaded() const;
+	Vec2i    imageSize() const;
 
 	virtual bool loadImage();
+	bool         updateImage(int size);
 	void         draw(
 				int                     size,
 				int                     x,
@@ -39,5 +47,17 @@ protected:
 	BrowserWindow*      parent_    = nullptr;
 	bool                blank_     = false;
 	unique_ptr<TextBox> text_box_;
+
+	// Thumbnails, generated in the background at the size the item is
+	// displayed at (see generateThumbnail)
+	struct Thumbnail;
+	shared_ptr<Thumbnail> thumbnail_;
+	int                   display_size_ = 0;     // Size the item was last displayed at
+	int                   thumb_size_   = 0;     // Size the image was scaled down to fit (0 if not scaled)
+	Vec2i                 image_size_;           // Full size of the image, if scaled down
+	bool                  image_failed_ = false; // Image failed to load, don't try again until cleared
+
+	void generateThumbnail(std::function<bool(SImage&)> load);
+	void clearThumbnail();
 };
 } // namespace slade
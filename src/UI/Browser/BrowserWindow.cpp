@@ -314,6 +314,9 @@ void BrowserWindow::clearItems(BrowserTreeNode* node) const
 	if (!node)
 		node = items_root_;
 
+	// Remove items from the canvas before they are deleted
+	canvas_->clearItems();
+
 	// Clear all items from node
 	node->clearItems();
 
@@ -7,7 +7,9 @@
 // Web:         http://slade.mancubus.net
 // Filename:    CTextureCanvas.cpp
 // Description: An OpenGL canvas that displays a composite texture
-//              (ie from doom's TEXTUREx)
+//              (ie from doom's TEXTUREx). Patches are composited on the GPU
+//              where possible, so the texture can be edited interactively
+//              without regenerating the full texture image
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -32,10 +34,13 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "CTextureCanvas.h"
+#include "General/Jobs.h"
 #include "Graphics/CTexture/CTexture.h"
+#include "Graphics/CTexture/TextureCache.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/Shader.h"
 
 using namespace slade;
 
@@ -48,6 +53,95 @@ using namespace slade;
 wxDEFINE_EVENT(EVT_DRAG_END, wxCommandEvent);
 CVAR(Bool, tx_arc, false, CVar::Flag::Save)
 EXTERN_CVAR(Bool, gfx_show_border)
+EXTERN_CVAR(Float, col_greyscale_r)
+EXTERN_CVAR(Float, col_greyscale_g)
+EXTERN_CVAR(Float, col_greyscale_b)
+namespace
+{
+// Composite patch shader, applies an extended patch's colour blend (colourise
+// or tint) and alpha. The patch's blend style is applied via the GL blend
+// function (see PatchBlend), and translations are applied to the patch image
+// when it is loaded
+const char* shader_patch_vert = R"(#version 120
+varying vec2 tex_coord;
+void main()
+{
+	gl_Position = ftransform();
+	tex_coord   = gl_MultiTexCoord0.xy;
+}
+)";
+const char* shader_patch_frag = R"(#version 120
+uniform sampler2D patch_texture;
+uniform int       colour_mode; // 0 = none, 1 = colourise, 2 = tint
+uniform vec4      colour;
+uniform vec4      greyscale;
+uniform float     alpha;
+uniform int       src_alpha;
+varying vec2      tex_coord;
+void main()
+{
+	vec4 texel = texture2D(patch_texture, tex_coord);
+	if (texel.a <= 0.0)
+		discard;
+
+	vec3 rgb = texel.rgb;
+	if (colour_mode == 1)
+		rgb = colour.rgb * min(dot(rgb, greyscale.rgb), 1.0);
+	else if (colour_mode == 2)
+		rgb = mix(rgb, colour.rgb, colour.a);
+
+	gl_FragColor = vec4(rgb, src_alpha == 1 ? texel.a * alpha : alpha);
+}
+)";
+
+// GL blending setup to draw a patch with, matching the blending done for the
+// patch's style by CTexture::toImage
+struct PatchBlend
+{
+	GLenum equation  = GL_FUNC_ADD;
+	GLenum src       = GL_SRC_ALPHA;
+	GLenum dest      = GL_ONE_MINUS_SRC_ALPHA;
+	float  alpha     = 1.0f;
+	bool   src_alpha = true;
+
+	PatchBlend(const CTPatchEx* patch)
+	{
+		if (!patch)
+			return;
+
+		src_alpha = false;
+
+		const auto style = patch->style();
+		if (style == "CopyAlpha" || style == "Overlay")
+			src_alpha = true;
+		else if (style == "Translucent" || style == "CopyNewAlpha")
+			alpha = patch->alpha();
+		else if (style == "Add")
+		{
+			dest  = GL_ONE;
+			alpha = patch->alpha();
+		}
+		else if (style == "Subtract")
+		{
+			equation = GL_FUNC_REVERSE_SUBTRACT;
+			dest     = GL_ONE;
+			alpha    = patch->alpha();
+		}
+		else if (style == "ReverseSubtract")
+		{
+			equation = GL_FUNC_SUBTRACT;
+			dest     = GL_ONE;
+			alpha    = patch->alpha();
+		}
+		else if (style == "Modulate")
+		{
+			src   = GL_DST_COLOR;
+			dest  = GL_ZERO;
+			alpha = patch->alpha();
+		}
+	}
+};
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -68,6 +162,15 @@ CTextureCanvas::CTextureCanvas(wxWindow* parent, int id) : OGLCanvas(parent, id)
 	Bind(wxEVT_LEAVE_WINDOW, &CTextureCanvas::onMouseEvent, this);
 }
 
+// -----------------------------------------------------------------------------
+// CTextureCanvas class destructor
+// -----------------------------------------------------------------------------
+CTextureCanvas::~CTextureCanvas()
+{
+	cancelPreview();
+	clearComposite();
+}
+
 // -----------------------------------------------------------------------------
 // Selects the patch at [index]
 // -----------------------------------------------------------------------------
@@ -129,6 +232,8 @@ void CTextureCanvas::clearTexture()
 	// Clear full preview
 	gl::Texture::clear(tex_preview_);
 	tex_preview_ = 0;
+	cancelPreview();
+	clearComposite();
 
 	// Refresh canvas
 	Refresh();
@@ -139,6 +244,8 @@ void CTextureCanvas::clearTexture()
 // -----------------------------------------------------------------------------
 void CTextureCanvas::clearPatchTextures()
 {
+	for (const auto& patch_texture : patch_textures_)
+		gl::Texture::clear(patch_texture.id);
 	patch_textures_.clear();
 
 	// Refresh canvas
@@ -153,13 +260,14 @@ void CTextureCanvas::updatePatchTextures()
 	// Unload single patch textures
 	for (auto& patch_texture : patch_textures_)
 	{
-		gl::Texture::clear(patch_texture);
-		patch_texture = 0;
+		gl::Texture::clear(patch_texture.id);
+		patch_texture = {};
 	}
 
 	// Unload full preview
 	gl::Texture::clear(tex_preview_);
 	tex_preview_ = 0;
+	cancelPreview();
 }
 
 // -----------------------------------------------------------------------------
@@ -170,6 +278,7 @@ void CTextureCanvas::updateTexturePreview()
 	// Unload full preview
 	gl::Texture::clear(tex_preview_);
 	tex_preview_ = 0;
+	cancelPreview();
 }
 
 // -----------------------------------------------------------------------------
@@ -189,7 +298,7 @@ bool CTextureCanvas::openTexture(CTexture* tex, Archive* parent)
 	for (uint32_t a = 0; a < tex->nPatches(); a++)
 	{
 		// Create GL texture
-		patch_textures_.push_back(gl::Texture::create());
+		patch_textures_.push_back({ gl::Texture::create() });
 
 		// Set selection
 		selected_patches_.push_back(false);
@@ -204,7 +313,7 @@ bool CTextureCanvas::openTexture(CTexture* tex, Archive* parent)
 		for (uint32_t a = 0; a < texture_->nPatches(); a++)
 		{
 			// Create GL texture
-			patch_textures_.push_back(gl::Texture::create());
+			patch_textures_.push_back({ gl::Texture::create() });
 
 			// Set selection
 			selected_patches_.push_back(false);
@@ -319,8 +428,13 @@ void CTextureCanvas::drawTexture()
 	// Reset colouring
 	gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
 
-	// If we're currently dragging, draw a 'basic' preview of the texture using opengl
-	if (dragging_)
+	// If we're currently dragging (or previewing in truecolour), composite the
+	// patches on the GPU rather than regenerating the full texture image
+	const bool composited = (dragging_ || blend_rgba_) && drawComposite();
+
+	// If compositing isn't supported, draw a 'basic' preview of the texture
+	// using opengl while dragging
+	if (!composited && dragging_)
 	{
 		glEnable(GL_SCISSOR_TEST);
 		glScissor(
@@ -334,24 +448,16 @@ void CTextureCanvas::drawTexture()
 	}
 
 	// Otherwise, draw the fully generated texture
-	else
+	else if (!composited)
 	{
-		// Generate if needed
+		// Generate if needed (this may be done in the background, in which
+		// case nothing is drawn until it's ready)
 		if (!tex_preview_)
-		{
-			// Determine image type
-			auto type = SImage::Type::PalMask;
-			if (blend_rgba_)
-				type = SImage::Type::RGBA;
-
-			// CTexture -> temp Image -> GLTexture
-			SImage temp(type);
-			texture_->toImage(temp, parent_, &palette_, blend_rgba_);
-			tex_preview_ = gl::Texture::createFromImage(temp, &palette_);
-		}
+			generatePreview();
 
 		// Draw it
-		drawing::drawTexture(tex_preview_);
+		if (tex_preview_)
+			drawing::drawTexture(tex_preview_);
 	}
 
 	// Disable textures
@@ -372,7 +478,7 @@ void CTextureCanvas::drawTexture()
 		const auto epatch = dynamic_cast<CTPatchEx*>(patch);
 
 		// Check for rotation
-		auto& tex_info = gl::Texture::info(patch_textures_[a]);
+		auto& tex_info = gl::Texture::info(patch_textures_[a].id);
 		if (texture_->isExtended() && (epatch->rotation() == 90 || epatch->rotation() == -90))
 		{
 			// Draw outline, width/height swapped
@@ -404,7 +510,7 @@ void CTextureCanvas::drawTexture()
 		// Get patch
 		const auto patch         = texture_->patch(hilight_patch_);
 		const auto epatch        = dynamic_cast<CTPatchEx*>(patch);
-		const auto patch_texture = patch_textures_[hilight_patch_];
+		const auto patch_texture = patch_textures_[hilight_patch_].id;
 
 		// Check for rotation
 		auto& tex_info = gl::Texture::info(patch_texture);
@@ -437,7 +543,9 @@ void CTextureCanvas::drawTexture()
 }
 
 // -----------------------------------------------------------------------------
-// Draws the patch at index [num] in the composite texture
+// Draws the patch at index [num] in the composite texture. If [outside] is
+// true the patch is drawn semitransparently, otherwise if compositing the
+// patch is drawn with its extended blending options applied
 // -----------------------------------------------------------------------------
 void CTextureCanvas::drawPatch(int num, bool outside)
 {
@@ -449,17 +557,8 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 		return;
 
 	// Load the patch as an opengl texture if it isn't already
-	if (!gl::Texture::isLoaded(patch_textures_[num]))
-	{
-		SImage temp(SImage::Type::PalMask);
-		if (texture_->loadPatchImage(num, temp, parent_, &palette_, blend_rgba_))
-		{
-			// Load the image as a texture
-			gl::Texture::loadImage(patch_textures_[num], temp, &palette_);
-		}
-		else
-			patch_textures_[num] = gl::Texture::missingTexture();
-	}
+	loadPatchTexture(num);
+	const auto& patch_texture = patch_textures_[num];
 
 	// Translate to position
 	glPushMatrix();
@@ -469,14 +568,14 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Setup extended features
-	bool         flipx = false;
-	bool         flipy = false;
-	const double alpha = 1.0;
-	const auto   col   = ColRGBA::WHITE;
-	if (texture_->isExtended())
+	bool       flipx  = false;
+	bool       flipy  = false;
+	const auto epatch = texture_->isExtended() ? dynamic_cast<CTPatchEx*>(patch) : nullptr;
+	if (epatch)
 	{
-		// Get extended patch
-		const auto epatch = dynamic_cast<CTPatchEx*>(patch);
+		// Image offsets
+		if (epatch->useOffsets())
+			glTranslated(-patch_texture.offset.x, -patch_texture.offset.y, 0);
 
 		// Flips
 		if (epatch->flipX())
@@ -485,7 +584,7 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 			flipy = true;
 
 		// Rotation
-		auto& tex_info = gl::Texture::info(patch_textures_[num]);
+		auto& tex_info = gl::Texture::info(patch_texture.id);
 		if (epatch->rotation() == 90)
 		{
 			glTranslated(tex_info.size.y, 0, 0);
@@ -506,15 +605,258 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	// Set colour
 	if (outside)
 		glColor4f(0.8f, 0.2f, 0.2f, 0.3f);
+	else if (compositing_)
+	{
+		// Setup blending
+		const PatchBlend blend(epatch);
+		glBlendEquationSeparate(blend.equation, GL_FUNC_ADD);
+		glBlendFuncSeparate(blend.src, blend.dest, GL_ONE, GL_ONE);
+
+		// Setup colour
+		auto& shader      = patchShader();
+		int   colour_mode = 0;
+		if (epatch && epatch->blendType() == CTPatchEx::BlendType::Blend)
+			colour_mode = 1;
+		else if (epatch && epatch->blendType() == CTPatchEx::BlendType::Tint)
+			colour_mode = 2;
+		const auto col = epatch ? epatch->colour() : ColRGBA::WHITE;
+		shader.setUniform("colour_mode", colour_mode);
+		shader.setUniform("colour", col.fr(), col.fg(), col.fb(), col.fa());
+		shader.setUniform("alpha", blend.alpha);
+		shader.setUniform("src_alpha", blend.src_alpha ? 1 : 0);
+	}
 	else
-		glColor4f(col.fr(), col.fg(), col.fb(), alpha);
+		glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
 	// Draw the patch
-	drawing::drawTexture(patch_textures_[num], 0, 0, flipx, flipy);
+	drawing::drawTexture(patch_texture.id, 0, 0, flipx, flipy);
 
 	glPopMatrix();
 }
 
+// -----------------------------------------------------------------------------
+// Composites all patches into the composite texture on the GPU and draws it.
+// Patch textures are only reloaded if they change (see loadPatchTexture), so
+// this is fast enough to do every frame while patches are being dragged.
+// Returns false if GPU compositing isn't supported
+// -----------------------------------------------------------------------------
+bool CTextureCanvas::drawComposite()
+{
+	const int width  = texture_->width();
+	const int height = texture_->height();
+	if (!GLEW_EXT_framebuffer_object || width <= 0 || height <= 0 || !patchShader().isValid())
+		return false;
+
+	// Load patch textures first, so nothing is loaded while the framebuffer is bound
+	for (unsigned a = 0; a < texture_->nPatches(); a++)
+		loadPatchTexture(a);
+
+	// (Re)create composite texture and framebuffer if needed
+	auto& tex_info = gl::Texture::info(tex_composite_);
+	if (!tex_composite_ || tex_info.size.x != width || tex_info.size.y != height)
+	{
+		clearComposite();
+		tex_composite_ = gl::Texture::createFromData(nullptr, width, height, gl::TexFilter::Nearest, false);
+		if (!tex_composite_)
+			return false;
+
+		glGenFramebuffersEXT(1, &fbo_composite_);
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo_composite_);
+		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, tex_composite_, 0);
+		const bool complete = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT;
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+		if (!complete)
+		{
+			log::warning("Unable to create framebuffer for composite texture preview");
+			clearComposite();
+			return false;
+		}
+	}
+
+	// Setup rendering to the composite texture (y-up, so the first row of the
+	// framebuffer is the top of the texture)
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo_composite_);
+	glPushAttrib(GL_VIEWPORT_BIT | GL_SCISSOR_BIT);
+	glDisable(GL_SCISSOR_TEST);
+	glViewport(0, 0, width, height);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, width, 0, height, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// Draw patches
+	auto& shader = patchShader();
+	shader.bind();
+	shader.setUniform("patch_texture", 0);
+	shader.setUniform("greyscale", col_greyscale_r, col_greyscale_g, col_greyscale_b, 0.0f);
+	compositing_ = true;
+	for (unsigned a = 0; a < texture_->nPatches(); a++)
+		drawPatch(a);
+	compositing_ = false;
+	gl::Shader::unbind();
+
+	// Restore rendering to the canvas
+	glBlendEquation(GL_FUNC_ADD);
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopAttrib();
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+	// Draw the composited texture
+	gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
+	drawing::drawTexture(tex_composite_);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the image for the patch at [num] to its opengl texture, if it isn't
+// loaded already or its translation has changed
+// -----------------------------------------------------------------------------
+void CTextureCanvas::loadPatchTexture(int num)
+{
+	auto& patch_texture = patch_textures_[num];
+
+	// Get translation to apply (if any)
+	string translation;
+	auto   epatch = texture_->isExtended() ? dynamic_cast<CTPatchEx*>(texture_->patch(num)) : nullptr;
+	if (epatch && epatch->blendType() == CTPatchEx::BlendType::Translation)
+		translation = epatch->translation().asText();
+
+	// Check if already loaded
+	if (gl::Texture::isLoaded(patch_texture.id) && patch_texture.translation == translation)
+		return;
+
+	if (patch_texture.id == 0 || patch_texture.id == gl::Texture::missingTexture())
+		patch_texture.id = gl::Texture::create();
+
+	SImage temp(SImage::Type::PalMask);
+	if (texture_->loadPatchImage(num, temp, parent_, &palette_, blend_rgba_))
+	{
+		// Apply translation
+		if (!translation.empty())
+			temp.applyTranslation(&epatch->translation(), &palette_, blend_rgba_);
+
+		// Load the image as a texture
+		gl::Texture::loadImage(patch_texture.id, temp, &palette_);
+		patch_texture.offset = temp.offset();
+	}
+	else
+	{
+		gl::Texture::clear(patch_texture.id);
+		patch_texture.id     = gl::Texture::missingTexture();
+		patch_texture.offset = { 0, 0 };
+	}
+	patch_texture.translation = translation;
+}
+
+// -----------------------------------------------------------------------------
+// Deletes the composite texture and its framebuffer
+// -----------------------------------------------------------------------------
+void CTextureCanvas::clearComposite()
+{
+	gl::Texture::clear(tex_composite_);
+	tex_composite_ = 0;
+
+	if (fbo_composite_)
+	{
+		glDeleteFramebuffersEXT(1, &fbo_composite_);
+		fbo_composite_ = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Generates the full preview texture. The patch images are loaded here (from
+// the shared patch image cache), then composited into the texture image on a
+// worker thread. The preview texture is created on the next draw after that
+// is finished.
+// The image is used straight away if it was cached (see texturecache)
+// -----------------------------------------------------------------------------
+void CTextureCanvas::generatePreview()
+{
+	// Check if the image has been generated in the background
+	if (preview_image_)
+	{
+		tex_preview_ = gl::Texture::createFromImage(*preview_image_, &palette_);
+		preview_image_.reset();
+		return;
+	}
+
+	// Check if it's already being generated
+	if (preview_job_ || !texture_)
+		return;
+
+	// Use the cached image if nothing it was built from has changed
+	auto image     = std::make_shared<SImage>(blend_rgba_ ? SImage::Type::RGBA : SImage::Type::PalMask);
+	auto cache_key = texture_->imageCacheKey(*image, parent_, &palette_, blend_rgba_);
+	if (texture_->loadCachedImage(*image, cache_key))
+	{
+		tex_preview_ = gl::Texture::createFromImage(*image, &palette_);
+		return;
+	}
+
+	// Load patch images (if the texture can't be generated, show it blank)
+	auto patch_images = std::make_shared<vector<SImage>>();
+	if (!texture_->loadPatchImages(*patch_images, parent_, &palette_, blend_rgba_))
+	{
+		image->resize(texture_->width(), texture_->height());
+		tex_preview_ = gl::Texture::createFromImage(*image, &palette_);
+		return;
+	}
+
+	// Composite patches in the background (using copies of the texture and
+	// palette, since they may be modified in the meantime)
+	auto texture = std::make_shared<CTexture>();
+	auto palette = std::make_shared<Palette>(palette_);
+	auto rgba    = blend_rgba_;
+	texture->copyTexture(*texture_);
+	preview_job_ = jobs::run(
+		[image, patch_images, texture, palette, rgba](jobs::Job&) {
+			texture->compositeImage(*image, *patch_images, palette.get(), rgba);
+		},
+		[this, image, cache_key]() {
+			texturecache::save(cache_key, *image);
+			preview_image_ = image;
+			preview_job_.reset();
+			Refresh();
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Cancels generating the full preview texture in the background, if it is
+// currently being generated
+// -----------------------------------------------------------------------------
+void CTextureCanvas::cancelPreview()
+{
+	if (preview_job_)
+	{
+		preview_job_->cancel();
+		preview_job_.reset();
+	}
+	preview_image_.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the composite patch shader, loading it if needed
+// -----------------------------------------------------------------------------
+gl::Shader& CTextureCanvas::patchShader()
+{
+	if (!shader_patch_)
+	{
+		shader_patch_ = std::make_unique<gl::Shader>("ctexture_patch");
+		shader_patch_->load(shader_patch_vert, shader_patch_frag);
+	}
+
+	return *shader_patch_;
+}
+
 // -----------------------------------------------------------------------------
 // Draws a black border around the texture
 // -----------------------------------------------------------------------------
@@ -772,7 +1114,7 @@ int CTextureCanvas::patchAt(int x, int y)
 	{
 		// Check if x,y is within patch bounds
 		const auto patch    = texture_->patch(a);
-		auto&      tex_info = gl::Texture::info(patch_textures_[a]);
+		auto&      tex_info = gl::Texture::info(patch_textures_[a].id);
 		if (x >= patch->xOffset() && x < patch->xOffset() + tex_info.size.x && y >= patch->yOffset()
 			&& y < patch->yOffset() + tex_info.size.y)
 		{
@@ -799,9 +1141,7 @@ bool CTextureCanvas::swapPatches(size_t p1, size_t p2)
 		return false;
 
 	// Swap patch gl textures
-	const unsigned tmp  = patch_textures_[p1];
-	patch_textures_[p1] = patch_textures_[p2];
-	patch_textures_[p2] = tmp;
+	std::swap(patch_textures_[p1], patch_textures_[p2]);
 
 	// Swap patches in the texture itself
 	return texture_->swapPatches(p1, p2);
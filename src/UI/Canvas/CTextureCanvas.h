@@ -8,6 +8,15 @@ namespace slade
 {
 class CTexture;
 class Archive;
+class SImage;
+namespace gl
+{
+	class Shader;
+}
+namespace jobs
+{
+	class Job;
+}
 
 class CTextureCanvas : public OGLCanvas
 {
@@ -20,7 +29,7 @@ public:
 	};
 
 	CTextureCanvas(wxWindow* parent, int id);
-	~CTextureCanvas() = default;
+	~CTextureCanvas();
 
 	CTexture* texture() const { return texture_; }
 	View      viewType() const { return view_type_; }
@@ -48,6 +57,7 @@ public:
 	void draw() override;
 	void drawTexture();
 	void drawPatch(int num, bool outside = false);
+	bool drawComposite();
 	void drawTextureBorder() const;
 	void drawOffsetLines() const;
 	void resetOffsets() { offset_.x = offset_.y = 0; }
@@ -60,21 +70,44 @@ public:
 	bool swapPatches(size_t p1, size_t p2);
 
 private:
-	CTexture*        texture_ = nullptr;
-	Archive*         parent_  = nullptr;
-	vector<unsigned> patch_textures_;
-	unsigned         tex_preview_ = 0;
-	vector<bool>     selected_patches_;
-	int              hilight_patch_ = -1;
-	Vec2d            offset_;
-	Vec2i            mouse_prev_;
-	double           scale_        = 1.;
-	bool             draw_outside_ = true;
-	bool             dragging_     = false;
-	bool             show_grid_    = false;
-	bool             blend_rgba_   = false;
-	bool             tex_scale_    = false;
-	View             view_type_    = View::Normal;
+	struct PatchTexture
+	{
+		unsigned id = 0;
+		string   translation; // The translation applied to the loaded image
+		Vec2i    offset;      // The offsets of the loaded image
+	};
+
+	CTexture*            texture_ = nullptr;
+	Archive*             parent_  = nullptr;
+	vector<PatchTexture> patch_textures_;
+	unsigned             tex_preview_ = 0;
+	vector<bool>         selected_patches_;
+	int                  hilight_patch_ = -1;
+	Vec2d                offset_;
+	Vec2i                mouse_prev_;
+	double               scale_        = 1.;
+	bool                 draw_outside_ = true;
+	bool                 dragging_     = false;
+	bool                 show_grid_    = false;
+	bool                 blend_rgba_   = false;
+	bool                 tex_scale_    = false;
+	View                 view_type_    = View::Normal;
+
+	// GPU compositing
+	unique_ptr<gl::Shader> shader_patch_;
+	unsigned               tex_composite_ = 0;
+	unsigned               fbo_composite_ = 0;
+	bool                   compositing_   = false;
+
+	// Full preview generation (in the background)
+	shared_ptr<jobs::Job> preview_job_;
+	shared_ptr<SImage>    preview_image_; // Generated image, to be uploaded on the next draw
+
+	gl::Shader& patchShader();
+	void        loadPatchTexture(int num);
+	void        clearComposite();
+	void        generatePreview();
+	void        cancelPreview();
 
 	// Signal connections
 	sigslot::scoped_connection sc_patches_modified_;
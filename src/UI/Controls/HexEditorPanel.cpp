@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "HexEditorPanel.h"
+#include "Archive/ArchiveEntry.h"
 #include "UI/WxUtils.h"
 #include "Utility/CodePages.h"
 
@@ -59,7 +60,7 @@ CVAR(Int, hex_grid_width, 16, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 int HexTable::GetNumberRows()
 {
-	return (data_.size() / hex_grid_width) + 1;
+	return (data().size() / hex_grid_width) + 1;
 }
 
 // -----------------------------------------------------------------------------
@@ -75,11 +76,12 @@ int HexTable::GetNumberCols()
 // -----------------------------------------------------------------------------
 wxString HexTable::GetValue(int row, int col)
 {
-	if (unsigned(row * hex_grid_width + col) >= data_.size())
+	auto& data = this->data();
+	if (unsigned(row * hex_grid_width + col) >= data.size())
 		return "";
 	else
 	{
-		uint8_t val = data_[row * hex_grid_width + col];
+		uint8_t val = data[row * hex_grid_width + col];
 
 		// Hex
 		if (view_type_ == 0)
@@ -107,11 +109,27 @@ void HexTable::SetValue(int row, int col, const wxString& value)
 }
 
 // -----------------------------------------------------------------------------
-// Loads in data from [mc]. Returns true on success, false otherwise
+// Returns the data being viewed (the entry's data, or empty if there is no
+// entry)
 // -----------------------------------------------------------------------------
-bool HexTable::loadData(MemChunk& mc)
+const MemChunk& HexTable::data() const
 {
-	data_.importMem(mc.data(), mc.size());
+	static const MemChunk no_data;
+
+	if (auto entry = entry_.lock())
+		return entry->data();
+
+	return no_data;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the table to view [entry]'s data. The data isn't copied, only the cells
+// currently visible in the grid are read from the entry.
+// Returns true on success, false otherwise
+// -----------------------------------------------------------------------------
+bool HexTable::loadEntry(ArchiveEntry* entry)
+{
+	entry_ = entry ? entry->getShared() : nullptr;
 	return true;
 }
 
@@ -128,8 +146,9 @@ uint32_t HexTable::offset(int row, int col) const
 // -----------------------------------------------------------------------------
 uint8_t HexTable::uByteValue(uint32_t offset) const
 {
-	if (offset < data_.size())
-		return data_[offset];
+	auto& data = this->data();
+	if (offset < data.size())
+		return data[offset];
 	else
 		return 0;
 }
@@ -137,99 +156,108 @@ uint8_t HexTable::uByteValue(uint32_t offset) const
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned short
 // -----------------------------------------------------------------------------
-uint16_t HexTable::uShortValue(uint32_t offset)
+uint16_t HexTable::uShortValue(uint32_t offset) const
 {
-	uint16_t val = 0;
-	if (offset < data_.size() - 1)
-		memcpy(&val, data_.data() + offset, 2);
+	auto&    data = this->data();
+	uint16_t val  = 0;
+	if (offset < data.size() - 1)
+		memcpy(&val, data.data() + offset, 2);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned 32-bit integer
 // -----------------------------------------------------------------------------
-uint32_t HexTable::uInt32Value(uint32_t offset)
+uint32_t HexTable::uInt32Value(uint32_t offset) const
 {
-	uint32_t val = 0;
-	if (offset < data_.size() - 3)
-		memcpy(&val, data_.data() + offset, 4);
+	auto&    data = this->data();
+	uint32_t val  = 0;
+	if (offset < data.size() - 3)
+		memcpy(&val, data.data() + offset, 4);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned 64-bit integer
 // -----------------------------------------------------------------------------
-uint64_t HexTable::uInt64Value(uint32_t offset)
+uint64_t HexTable::uInt64Value(uint32_t offset) const
 {
-	uint64_t val = 0;
-	if (offset < data_.size() - 7)
-		memcpy(&val, data_.data() + offset, 8);
+	auto&    data = this->data();
+	uint64_t val  = 0;
+	if (offset < data.size() - 7)
+		memcpy(&val, data.data() + offset, 8);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed byte
 // -----------------------------------------------------------------------------
-int8_t HexTable::byteValue(uint32_t offset)
+int8_t HexTable::byteValue(uint32_t offset) const
 {
-	int8_t val = 0;
-	if (offset < data_.size())
-		val = *(data_.data() + offset);
+	auto&  data = this->data();
+	int8_t val  = 0;
+	if (offset < data.size())
+		val = *(data.data() + offset);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed short
 // -----------------------------------------------------------------------------
-int16_t HexTable::shortValue(uint32_t offset)
+int16_t HexTable::shortValue(uint32_t offset) const
 {
-	int16_t val = 0;
-	if (offset < data_.size() - 1)
-		memcpy(&val, data_.data() + offset, 2);
+	auto&   data = this->data();
+	int16_t val  = 0;
+	if (offset < data.size() - 1)
+		memcpy(&val, data.data() + offset, 2);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed 32-bit integer
 // -----------------------------------------------------------------------------
-int32_t HexTable::int32Value(uint32_t offset)
+int32_t HexTable::int32Value(uint32_t offset) const
 {
-	int32_t val = 0;
-	if (offset < data_.size() - 3)
-		memcpy(&val, data_.data() + offset, 4);
+	auto&   data = this->data();
+	int32_t val  = 0;
+	if (offset < data.size() - 3)
+		memcpy(&val, data.data() + offset, 4);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a signed 64-bit integer
 // -----------------------------------------------------------------------------
-int64_t HexTable::int64Value(uint32_t offset)
+int64_t HexTable::int64Value(uint32_t offset) const
 {
-	int64_t val = 0;
-	if (offset < data_.size() - 7)
-		memcpy(&val, data_.data() + offset, 8);
+	auto&   data = this->data();
+	int64_t val  = 0;
+	if (offset < data.size() - 7)
+		memcpy(&val, data.data() + offset, 8);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a float
 // -----------------------------------------------------------------------------
-float HexTable::floatValue(uint32_t offset)
+float HexTable::floatValue(uint32_t offset) const
 {
-	float val = 0;
-	if (offset < data_.size() - 3)
-		val = *(data_.data() + offset);
+	auto& data = this->data();
+	float val  = 0;
+	if (offset < data.size() - 3)
+		val = *(data.data() + offset);
 	return val;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as a double
 // -----------------------------------------------------------------------------
-double HexTable::doubleValue(uint32_t offset)
+double HexTable::doubleValue(uint32_t offset) const
 {
-	double val = 0;
-	if (offset < data_.size() - 7)
-		val = *(data_.data() + offset);
+	auto&  data = this->data();
+	double val  = 0;
+	if (offset < data.size() - 7)
+		val = *(data.data() + offset);
 	return val;
 }
 
@@ -293,11 +321,11 @@ HexEditorPanel::HexEditorPanel(wxWindow* parent) : wxPanel(parent, -1)
 }
 
 // -----------------------------------------------------------------------------
-// Loads data from [mc] into the hex grid
+// Loads [entry]'s data into the hex grid
 // -----------------------------------------------------------------------------
-bool HexEditorPanel::loadData(MemChunk& mc)
+bool HexEditorPanel::loadEntry(ArchiveEntry* entry)
 {
-	if (table_hex_->loadData(mc))
+	if (table_hex_->loadEntry(entry))
 	{
 		grid_hex_->SetTable(table_hex_);
 		Layout();
@@ -383,7 +411,7 @@ void HexEditorPanel::onCellSelected(wxGridEvent& e)
 	uint32_t offset = table_hex_->offset(e.GetRow(), e.GetCol());
 
 	// Check offset
-	if (offset > table_hex_->getData().size())
+	if (offset > table_hex_->data().size())
 		return;
 
 	// Reset labels
@@ -409,7 +437,7 @@ void HexEditorPanel::onCellSelected(wxGridEvent& e)
 	// label_double_be->SetLabel("Double:");
 
 	// Get values
-	uint32_t size    = table_hex_->getData().size() - offset;
+	uint32_t size    = table_hex_->data().size() - offset;
 	int8_t   vbyte   = 0;
 	uint8_t  vubyte  = 0;
 	int16_t  vshort  = 0;
@@ -480,11 +508,11 @@ void HexEditorPanel::onCellSelected(wxGridEvent& e)
 void HexEditorPanel::onBtnGoToOffset(wxCommandEvent& e)
 {
 	// Do nothing if no data
-	if (table_hex_->getData().size() == 0)
+	if (table_hex_->data().size() == 0)
 		return;
 
 	// Pop up dialog to prompt user for an offset
-	int ofs = wxGetNumberFromUser("Enter Offset", "Offset", "Go to Offset", 0, 0, table_hex_->getData().size() - 1);
+	int ofs = wxGetNumberFromUser("Enter Offset", "Offset", "Go to Offset", 0, 0, table_hex_->data().size() - 1);
 	if (ofs >= 0)
 	{
 		// Determine row/col of offset
@@ -2,13 +2,15 @@
 
 namespace slade
 {
+class ArchiveEntry;
+
 class HexTable : public wxGridTableBase
 {
 public:
 	HexTable()  = default;
 	~HexTable() = default;
 
-	MemChunk& getData() { return data_; }
+	const MemChunk& data() const;
 
 	// Overrides
 	int      GetNumberRows() override;
@@ -16,25 +18,25 @@ public:
 	wxString GetValue(int row, int col) override;
 	void     SetValue(int row, int col, const wxString& value) override;
 
-	bool     loadData(MemChunk& mc);
+	bool     loadEntry(ArchiveEntry* entry);
 	uint32_t offset(int row, int col) const;
 	void     setViewType(int type) { view_type_ = type; }
 
 	// Get values
 	uint8_t  uByteValue(uint32_t offset) const;
-	uint16_t uShortValue(uint32_t offset);
-	uint32_t uInt32Value(uint32_t offset);
-	uint64_t uInt64Value(uint32_t offset);
-	int8_t   byteValue(uint32_t offset);
-	int16_t  shortValue(uint32_t offset);
-	int32_t  int32Value(uint32_t offset);
-	int64_t  int64Value(uint32_t offset);
-	float    floatValue(uint32_t offset);
-	double   doubleValue(uint32_t offset);
+	uint16_t uShortValue(uint32_t offset) const;
+	uint32_t uInt32Value(uint32_t offset) const;
+	uint64_t uInt64Value(uint32_t offset) const;
+	int8_t   byteValue(uint32_t offset) const;
+	int16_t  shortValue(uint32_t offset) const;
+	int32_t  int32Value(uint32_t offset) const;
+	int64_t  int64Value(uint32_t offset) const;
+	float    floatValue(uint32_t offset) const;
+	double   doubleValue(uint32_t offset) const;
 
 private:
-	MemChunk data_;
-	int      view_type_ = 0;
+	weak_ptr<ArchiveEntry> entry_; // The data is read from the entry as needed rather than copied
+	int                    view_type_ = 0;
 };
 
 class HexEditorPanel : public wxPanel
@@ -43,7 +45,7 @@ public:
 	HexEditorPanel(wxWindow* parent);
 	~HexEditorPanel() = default;
 
-	bool loadData(MemChunk& mc);
+	bool loadEntry(ArchiveEntry* entry);
 
 private:
 	wxGrid*        grid_hex_         = nullptr;
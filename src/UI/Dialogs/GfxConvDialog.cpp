@@ -33,7 +33,9 @@
 #include "Main.h"
 #include "GfxConvDialog.h"
 #include "Archive/ArchiveManager.h"
+#include "General/EntryPrefetch.h"
 #include "General/Misc.h"
+#include "General/ThreadPool.h"
 #include "General/UI.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/Icons.h"
@@ -102,29 +104,8 @@ bool GfxConvDialog::nextItem()
 	}
 
 	// Load image if needed
-	if (!items_[current_item_].image.isValid())
-	{
-		// If loading images from entries
-		if (items_[current_item_].entry != nullptr)
-		{
-			if (!misc::loadImageFromEntry(&(items_[current_item_].image), items_[current_item_].entry))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		// If loading images from textures
-		else if (items_[current_item_].texture != nullptr)
-		{
-			if (items_[current_item_].force_rgba)
-				items_[current_item_].image.convertRGBA(items_[current_item_].palette);
-			if (!items_[current_item_].texture->toImage(
-					items_[current_item_].image,
-					items_[current_item_].archive,
-					items_[current_item_].palette,
-					items_[current_item_].force_rgba))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		else
-			return nextItem(); // Skip if not a valid image entry
-	}
+	if (!loadItem(items_[current_item_]))
+		return nextItem(); // Skip if not a valid image entry
 
 	// Update valid formats
 	combo_target_format_->Clear();
@@ -224,6 +205,65 @@ bool GfxConvDialog::nextItem()
 	return ok;
 }
 
+// -----------------------------------------------------------------------------
+// Loads the image for [item] from its entry or texture, if it isn't already
+// loaded. Returns false if no valid image could be loaded
+// -----------------------------------------------------------------------------
+bool GfxConvDialog::loadItem(ConvItem& item) const
+{
+	if (item.image.isValid())
+		return true;
+
+	// If loading images from entries
+	if (item.entry != nullptr)
+		return misc::loadImageFromEntry(&item.image, item.entry);
+
+	// If loading images from textures
+	if (item.texture != nullptr)
+	{
+		if (item.force_rgba)
+			item.image.convertRGBA(item.palette);
+		return item.texture->toImage(item.image, item.archive, item.palette, item.force_rgba);
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [image] can be converted to the currently selected format
+// -----------------------------------------------------------------------------
+bool GfxConvDialog::canConvert(SImage& image) const
+{
+	return current_format_.format && current_format_.format->canWrite(image) != SIFormat::Writable::No
+		   && current_format_.format->canWriteType(current_format_.coltype);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a copy of [pal] owned by the dialog, reusing an existing copy if one
+// has the same colours. Palettes from the palette choosers can't be used
+// directly since the 'Archive/Global' palette is reloaded for each entry
+// -----------------------------------------------------------------------------
+Palette* GfxConvDialog::sharedPalette(const Palette* pal)
+{
+	if (!pal)
+		return nullptr;
+
+	for (const auto& copy : palettes_)
+	{
+		if (copy->transIndex() != pal->transIndex())
+			continue;
+
+		bool same = true;
+		for (unsigned a = 0; a < 256 && same; a++)
+			same = copy->colour(a).equals(pal->colour(a), true);
+		if (same)
+			return copy.get();
+	}
+
+	palettes_.push_back(std::make_unique<Palette>(*pal));
+	return palettes_.back().get();
+}
+
 // -----------------------------------------------------------------------------
 // Sets up the dialog UI layout
 // -----------------------------------------------------------------------------
@@ -586,7 +626,156 @@ void GfxConvDialog::applyConversion()
 	// Update item info
 	item.modified   = true;
 	item.new_format = current_format_.format;
-	item.palette    = pal_chooser_target_->selectedPalette(item.entry);
+	item.palette    = sharedPalette(pal_chooser_target_->selectedPalette(item.entry));
+}
+
+// -----------------------------------------------------------------------------
+// Converts the current item and all items after it to the current format.
+// Images are decoded (where possible) and converted on the worker thread pool,
+// and the results applied to the items in order as they finish. Stops at the
+// first item that can't be converted to the current format (or if cancelled
+// with Esc), which is then opened so the user can choose what to do with it
+// -----------------------------------------------------------------------------
+void GfxConvDialog::convertAll()
+{
+	// An item being loaded and converted in the background
+	struct Job
+	{
+		MemChunk                 data; // Entry data to decode, if the image wasn't already loaded
+		string                   format_hint;
+		SImage                   image;
+		SImage                   converted;
+		SIFormat::ConvertOptions opt;
+		bool                     loaded       = false;
+		bool                     converted_ok = false;
+		std::atomic<bool>        done{ false };
+	};
+
+	// The current item was already converted for the preview
+	applyConversion();
+
+	// Get conversion options (palettes are set for each item)
+	SIFormat::ConvertOptions opt;
+	convertOptions(opt);
+
+	// Setup and start jobs for the remaining items
+	const auto              first     = current_item_ + 1;
+	const auto              format    = current_format_.format;
+	auto                    cancelled = std::make_shared<std::atomic<bool>>(false);
+	vector<shared_ptr<Job>> jobs;
+	for (auto a = first; a < items_.size(); a++)
+	{
+		auto& item           = items_[a];
+		auto  job            = std::make_shared<Job>();
+		job->opt             = opt;
+		job->opt.pal_current = sharedPalette(pal_chooser_current_->selectedPalette(item.entry));
+		job->opt.pal_target  = sharedPalette(pal_chooser_target_->selectedPalette(item.entry));
+
+		// Load entry data to be decoded in the background if possible,
+		// otherwise load the image here
+		if (!item.image.isValid() && item.entry && item.entry->data().hasData()
+			&& entryprefetch::canDecode(*item.entry))
+		{
+			job->data.importMem(item.entry->data());
+			job->format_hint = item.entry->type()->extraProps().getOr<string>("image_format", {});
+		}
+		else if (loadItem(item))
+		{
+			job->image.copyImage(&item.image);
+			job->loaded = true;
+		}
+
+		jobs.push_back(job);
+		threadpool::enqueue([job, format, cancelled]() {
+			if (!*cancelled)
+			{
+				if (job->data.hasData())
+					job->loaded = job->image.open(job->data, 0, job->format_hint);
+				if (job->loaded)
+				{
+					job->converted.copyImage(&job->image);
+					format->convertWritable(job->converted, job->opt);
+					job->converted_ok = true;
+				}
+			}
+			job->done = true;
+		});
+	}
+
+	// Apply finished conversions in order
+	ui::showSplash("Converting Gfx... (Esc to cancel)", true);
+	size_t next = 0;
+	bool   stop = false;
+	while (next < jobs.size())
+	{
+		// Cancel event
+		if (wxGetKeyState(WXK_ESCAPE))
+			*cancelled = true;
+
+		if (!jobs[next]->done)
+		{
+			wxMilliSleep(10);
+			continue;
+		}
+
+		auto& job  = *jobs[next];
+		auto& item = items_[first + next];
+
+		if (!stop && !job.converted_ok)
+		{
+			// Stop if cancelled before this item was converted
+			if (*cancelled)
+				stop = true;
+
+			// Otherwise it couldn't be decoded in the background, so load and
+			// convert it here
+			else if (loadItem(item))
+			{
+				job.image.copyImage(&item.image);
+				job.converted.copyImage(&item.image);
+				format->convertWritable(job.converted, job.opt);
+				job.loaded       = true;
+				job.converted_ok = true;
+			}
+		}
+
+		// Stop if the image can't be converted to the current format
+		if (!stop && job.converted_ok && !canConvert(job.image))
+		{
+			stop       = true;
+			*cancelled = true;
+		}
+
+		if (stop)
+		{
+			// Keep the loaded image for the item, it will be opened when
+			// converting continues
+			if (job.loaded && !item.image.isValid())
+				item.image.copyImage(&job.image);
+		}
+		else
+		{
+			// Apply conversion (invalid images are skipped)
+			if (job.converted_ok)
+			{
+				item.image.copyImage(&job.converted);
+				item.modified   = true;
+				item.new_format = format;
+				item.palette    = job.opt.pal_target;
+			}
+
+			current_item_ = first + next;
+		}
+
+		next++;
+		ui::setSplashProgressMessage(fmt::format("{} of {}", first + next, items_.size()));
+		ui::setSplashProgress(static_cast<float>(first + next) / static_cast<float>(items_.size()));
+	}
+
+	ui::hideSplash();
+
+	// Open the next item (closes the dialog if all items were converted)
+	nextItem();
 }
 
 
@@ -624,19 +813,7 @@ void GfxConvDialog::onBtnConvert(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void GfxConvDialog::onBtnConvertAll(wxCommandEvent& e)
 {
-	// Show splash window
-	ui::showSplash("Converting Gfx...", true);
-
-	// Convert all images
-	for (size_t a = current_item_; a < items_.size(); a++)
-	{
-		applyConversion();
-		if (!nextItem())
-			break;
-	}
-
-	// Hide splash window
-	ui::hideSplash();
+	convertAll();
 }
 
 // -----------------------------------------------------------------------------
@@ -59,6 +59,7 @@ public:
 	Palette*  itemPalette(int index);
 
 	void applyConversion();
+	void convertAll();
 
 private:
 	struct ConvFormat
@@ -95,10 +96,11 @@ private:
 		}
 	};
 
-	vector<ConvItem>   items_;
-	size_t             current_item_ = 0;
-	vector<ConvFormat> conv_formats_;
-	ConvFormat         current_format_;
+	vector<ConvItem>            items_;
+	size_t                      current_item_ = 0;
+	vector<ConvFormat>          conv_formats_;
+	ConvFormat                  current_format_;
+	vector<unique_ptr<Palette>> palettes_; // Copies of palettes used for conversion, see sharedPalette
 
 	wxStaticText*   label_current_format_     = nullptr;
 	GfxCanvas*      gfx_current_              = nullptr;
@@ -123,7 +125,10 @@ private:
 	Palette target_pal_;
 	ColRGBA colour_trans_;
 
-	bool nextItem();
+	bool     nextItem();
+	bool     loadItem(ConvItem& item) const;
+	bool     canConvert(SImage& image) const;
+	Palette* sharedPalette(const Palette* pal);
 
 	// Static
 	static wxString current_palette_name_;
@@ -37,6 +37,7 @@
 #include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
 #include "Graphics/Icons.h"
+#include "SLADEMap/MapPreview.h"
 #include "UI/Canvas/MapPreviewCanvas.h"
 #include "UI/Controls/BaseResourceChooser.h"
 #include "UI/Controls/ResourceArchiveChooser.h"
@@ -392,8 +393,10 @@ void MapEditorConfigDialog::populateMapList()
 	if (!archive_)
 		return;
 
-	// Get all archive maps
+	// Get all archive maps, and decode them for previews in the background
 	maps_ = archive_->detectMaps();
+	if (canvas_preview_)
+		mappreview::prefetch(maps_);
 
 	// Get currently selected game/port
 	string game = games_list_[choice_game_config_->GetSelection()].ToStdString();
@@ -43,11 +43,16 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, close_archive_with_tab)
 EXTERN_CVAR(Bool, archive_load_data)
+EXTERN_CVAR(Bool, archive_mmap_open)
+EXTERN_CVAR(Bool, zip_lazy_open)
+EXTERN_CVAR(Bool, dir_archive_lazy_open)
+EXTERN_CVAR(Bool, etype_detect_cache)
 EXTERN_CVAR(Bool, auto_open_wads_root)
 EXTERN_CVAR(Bool, update_check)
 EXTERN_CVAR(Bool, update_check_beta)
 EXTERN_CVAR(Bool, confirm_exit)
 EXTERN_CVAR(Bool, backup_archives)
+EXTERN_CVAR(Bool, wad_save_incremental)
 
 
 // -----------------------------------------------------------------------------
@@ -65,15 +70,35 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 	// Create + Layout controls
 	SetSizer(wxutil::layoutVertically(
 		{ cb_archive_load_      = new wxCheckBox(this, -1, "Load all archive entry data to memory when opened"),
+		  cb_archive_mmap_      = new wxCheckBox(this, -1, "Memory-map archive files when opening"),
+		  cb_zip_lazy_          = new wxCheckBox(this, -1, "Only read the zip directory when opening zip archives"),
+		  cb_dir_lazy_          = new wxCheckBox(this, -1, "Only list files when opening folder archives"),
+		  cb_type_cache_        = new wxCheckBox(this, -1, "Cache detected entry types of opened archives"),
 		  cb_archive_close_tab_ = new wxCheckBox(this, -1, "Close archive when its tab is closed"),
 		  cb_wads_root_         = new wxCheckBox(this, -1, "Auto open nested wad archives"),
 #ifdef __WXMSW__
 		  cb_update_check_      = new wxCheckBox(this, -1, "Check for updates on startup"),
 		  cb_update_check_beta_ = new wxCheckBox(this, -1, "Include beta versions when checking for updates"),
 #endif
-		  cb_confirm_exit_    = new wxCheckBox(this, -1, "Show confirmation dialog on exit"),
-		  cb_backup_archives_ = new wxCheckBox(this, -1, "Back up archives") }));
+		  cb_confirm_exit_      = new wxCheckBox(this, -1, "Show confirmation dialog on exit"),
+		  cb_backup_archives_   = new wxCheckBox(this, -1, "Back up archives"),
+		  cb_wad_incremental_   = new wxCheckBox(this, -1, "Only write changed lumps when saving wad archives") }));
 
+	cb_archive_mmap_->SetToolTip(
+		"Read archive directories directly from a memory-mapped view of the file rather than loading the whole "
+		"file into memory first. Can greatly speed up opening large wad, grp, pak etc. archives");
+	cb_zip_lazy_->SetToolTip(
+		"Don't decompress zip entries when opening, entry data is only read and its type detected when first "
+		"needed. Has no effect if all entry data is loaded to memory when opened");
+	cb_dir_lazy_->SetToolTip(
+		"Don't read files when opening a folder as an archive, file data is only read and its type detected when "
+		"first needed. Has no effect if all entry data is loaded to memory when opened");
+	cb_type_cache_->SetToolTip(
+		"Remember the detected types of entries in wad and zip archives opened from disk, so type detection can be "
+		"skipped when the same (unchanged) file is opened again");
+	cb_wad_incremental_->SetToolTip(
+		"Append new and modified lumps to the end of the existing wad file instead of rewriting the whole file. "
+		"The wad is fully rewritten (compacted) once too much of the file is unused");
 	cb_wads_root_->SetToolTip(
 		"When opening a zip or folder archive, automatically open all wad entries in the root directory");
 }
@@ -84,6 +109,10 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 void GeneralPrefsPanel::init()
 {
 	cb_archive_load_->SetValue(archive_load_data);
+	cb_archive_mmap_->SetValue(archive_mmap_open);
+	cb_zip_lazy_->SetValue(zip_lazy_open);
+	cb_dir_lazy_->SetValue(dir_archive_lazy_open);
+	cb_type_cache_->SetValue(etype_detect_cache);
 	cb_archive_close_tab_->SetValue(close_archive_with_tab);
 	cb_wads_root_->SetValue(auto_open_wads_root);
 #ifdef __WXMSW__
@@ -92,6 +121,7 @@ void GeneralPrefsPanel::init()
 #endif
 	cb_confirm_exit_->SetValue(confirm_exit);
 	cb_backup_archives_->SetValue(backup_archives);
+	cb_wad_incremental_->SetValue(wad_save_incremental);
 }
 
 // -----------------------------------------------------------------------------
@@ -100,12 +130,17 @@ void GeneralPrefsPanel::init()
 void GeneralPrefsPanel::applyPreferences()
 {
 	archive_load_data      = cb_archive_load_->GetValue();
+	archive_mmap_open      = cb_archive_mmap_->GetValue();
+	zip_lazy_open          = cb_zip_lazy_->GetValue();
+	dir_archive_lazy_open  = cb_dir_lazy_->GetValue();
+	etype_detect_cache     = cb_type_cache_->GetValue();
 	close_archive_with_tab = cb_archive_close_tab_->GetValue();
 	auto_open_wads_root    = cb_wads_root_->GetValue();
 #ifdef __WXMSW__
 	update_check      = cb_update_check_->GetValue();
 	update_check_beta = cb_update_check_beta_->GetValue();
 #endif
-	confirm_exit    = cb_confirm_exit_->GetValue();
-	backup_archives = cb_backup_archives_->GetValue();
+	confirm_exit         = cb_confirm_exit_->GetValue();
+	backup_archives      = cb_backup_archives_->GetValue();
+	wad_save_incremental = cb_wad_incremental_->GetValue();
 }
@@ -16,11 +16,16 @@ public:
 private:
 	wxCheckBox* cb_gl_np2_            = nullptr;
 	wxCheckBox* cb_archive_load_      = nullptr;
+	wxCheckBox* cb_archive_mmap_      = nullptr;
+	wxCheckBox* cb_zip_lazy_          = nullptr;
+	wxCheckBox* cb_dir_lazy_          = nullptr;
+	wxCheckBox* cb_type_cache_        = nullptr;
 	wxCheckBox* cb_archive_close_tab_ = nullptr;
 	wxCheckBox* cb_wads_root_         = nullptr;
 	wxCheckBox* cb_update_check_      = nullptr;
 	wxCheckBox* cb_update_check_beta_ = nullptr;
 	wxCheckBox* cb_confirm_exit_      = nullptr;
 	wxCheckBox* cb_backup_archives_   = nullptr;
+	wxCheckBox* cb_wad_incremental_   = nullptr;
 };
 } // namespace slade
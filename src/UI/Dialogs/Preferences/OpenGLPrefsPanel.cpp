@@ -46,6 +46,7 @@ using namespace slade;
 EXTERN_CVAR(Bool, gl_tex_enable_np2)
 EXTERN_CVAR(Bool, gl_point_sprite)
 EXTERN_CVAR(Bool, gl_vbo)
+EXTERN_CVAR(Bool, gl_shaders)
 EXTERN_CVAR(Int, gl_font_size)
 
 
@@ -70,6 +71,7 @@ OpenGLPrefsPanel::OpenGLPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent), l
 		vector<wxObject*>{ cb_gl_np2_ = new wxCheckBox(this, -1, "Enable Non-power-of-two textures if supported"),
 						   cb_gl_point_sprite_ = new wxCheckBox(this, -1, "Enable point sprites if supported"),
 						   cb_gl_use_vbo_      = new wxCheckBox(this, -1, "Use Vertex Buffer Objects if supported"),
+						   cb_gl_shaders_      = new wxCheckBox(this, -1, "Use GLSL shaders if supported"),
 						   wxutil::createLabelHBox(this, "Font Size:", ntc_font_size_ = new NumberTextCtrl(this)) },
 		wxSizerFlags(0).Expand());
 
@@ -86,6 +88,7 @@ void OpenGLPrefsPanel::init()
 	cb_gl_np2_->SetValue(gl_tex_enable_np2);
 	cb_gl_point_sprite_->SetValue(gl_point_sprite);
 	cb_gl_use_vbo_->SetValue(gl_vbo);
+	cb_gl_shaders_->SetValue(gl_shaders);
 	ntc_font_size_->setNumber(gl_font_size);
 }
 
@@ -97,6 +100,7 @@ void OpenGLPrefsPanel::applyPreferences()
 	gl_tex_enable_np2 = cb_gl_np2_->GetValue();
 	gl_point_sprite   = cb_gl_point_sprite_->GetValue();
 	gl_vbo            = cb_gl_use_vbo_->GetValue();
+	gl_shaders        = cb_gl_shaders_->GetValue();
 	gl_font_size      = ntc_font_size_->number();
 
 	if (gl_font_size != last_font_size_)
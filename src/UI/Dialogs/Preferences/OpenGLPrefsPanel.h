@@ -19,6 +19,7 @@ private:
 	wxCheckBox*     cb_gl_np2_          = nullptr;
 	wxCheckBox*     cb_gl_point_sprite_ = nullptr;
 	wxCheckBox*     cb_gl_use_vbo_      = nullptr;
+	wxCheckBox*     cb_gl_shaders_      = nullptr;
 	NumberTextCtrl* ntc_font_size_      = nullptr;
 	int             last_font_size_     = 0;
 };
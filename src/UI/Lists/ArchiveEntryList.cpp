@@ -39,6 +39,7 @@
 #include "Graphics/Icons.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -137,39 +138,11 @@ wxString ArchiveEntryList::itemText(long item, long column, long index) const
 	if (col == 0)
 		return entry->name(); // Name column
 	else if (col == 1)
-	{
-		// Size column
-		if (entry->type() == EntryType::folderType())
-		{
-			// Entry is a folder, return the number of entries+subdirectories in it
-			ArchiveDir* dir = nullptr;
-
-			// Get selected directory
-			if (entry == entry_dir_back_.get())
-				dir = current_dir_.lock()->parent().get(); // If it's the 'back directory', get the current dir's parent
-			else if (auto archive = archive_.lock())
-				dir = archive->dirAtPath(entry->name(), current_dir_.lock().get());
-
-			// If it's null, return error
-			if (!dir)
-				return "INVALID DIRECTORY";
-
-			// Return the number of items in the directory
-			return wxString::Format("%d entries", dir->numEntries() + dir->numSubdirs());
-		}
-		else
-			return entry->sizeString(); // Not a folder, just return the normal size string
-	}
+		return rowData(index).size_text; // Size column
 	else if (col == 2)
-		return entry->typeString(); // Type column
+		return rowData(index).type_text; // Type column
 	else if (col == 3)
-	{
-		// Index column
-		if (entry->type() == EntryType::folderType())
-			return "";
-		else
-			return wxString::Format("%d", entry->index());
-	}
+		return rowData(index).index_text; // Index column
 	else
 		return "INVALID COLUMN"; // Invalid column
 }
@@ -264,7 +237,14 @@ void ArchiveEntryList::setArchive(const shared_ptr<Archive>& archive)
 	if (archive)
 	{
 		// Update list when archive is modified
-		sc_archive_modified_ = archive->signals().modified.connect([this](Archive&) { updateEntries(); });
+		sc_archive_modified_ = archive->signals().modified.connect([this](Archive&) {
+			filter_current_ = false;
+			updateEntries();
+		});
+
+		// Clear cached item text when an entry's state changes
+		sc_entry_state_changed_ = archive->signals().entry_state_changed.connect(
+			[this](Archive&, ArchiveEntry&) { rows_.clear(); });
 
 		// Open root directory
 		current_dir_ = archive->rootDir();
@@ -366,32 +346,52 @@ void ArchiveEntryList::updateList(bool clear)
 // -----------------------------------------------------------------------------
 // Filters the list to only entries and directories with names matching
 // [filter], and with type categories matching [category].
+// If the new filter can only match a subset of what the current filter does
+// (eg. a character was added to the end), the current filtered list is
+// narrowed down rather than filtering all items again
 // -----------------------------------------------------------------------------
 void ArchiveEntryList::filterList(const wxString& filter, const wxString& category)
 {
+	// Check if the current filtered list can be narrowed down
+	auto terms  = filterTerms(filter);
+	bool narrow = filter_current_ && category == filter_category_ && terms.size() == 1 && terms[0].size() > 1;
+	if (narrow && !filter_terms_.empty())
+	{
+		const auto& prev = filter_terms_[0];
+		narrow = filter_terms_.size() == 1 && !prev.empty()
+				 && strutil::startsWith(terms[0], string_view{ prev }.substr(0, prev.size() - 1));
+	}
+
 	// Update variables
 	filter_text_     = filter;
 	filter_category_ = category;
 
 	// Save current selection
-	auto selection = selectedEntries();
-	auto focus     = focusedEntry();
+	auto                              selected = selectedEntries();
+	std::unordered_set<ArchiveEntry*> selection(selected.begin(), selected.end());
+	auto                              focus = focusedEntry();
 
 	// Apply the filter
 	clearSelection();
-	applyFilter();
+	if (narrow)
+	{
+		filter_terms_ = terms;
+		items_.erase(
+			std::remove_if(
+				items_.begin(),
+				items_.end(),
+				[&](long index) { return !matchesFilter(entryAt(index, false), filter_terms_); }),
+			items_.end());
+		updateList();
+	}
+	else
+		applyFilter();
 
 	for (int a = 0; a < GetItemCount(); a++)
 	{
 		auto entry = entryAt(a, false);
-		for (auto& selected_entry : selection)
-		{
-			if (entry == selected_entry)
-			{
-				selectItem(a);
-				break;
-			}
-		}
+		if (selection.count(entry) > 0)
+			selectItem(a);
 
 		if (entry == focus)
 		{
@@ -410,8 +410,12 @@ void ArchiveEntryList::applyFilter()
 	if (!dir)
 		return;
 
-	// Clear current filter list
+	// Clear current filter list (and cached item text, since the items may
+	// have changed)
 	items_.clear();
+	rows_.clear();
+	filter_terms_   = filterTerms(filter_text_);
+	filter_current_ = true;
 
 	// Check if any filters were given
 	if (filter_text_.IsEmpty() && filter_category_.IsEmpty())
@@ -425,69 +429,20 @@ void ArchiveEntryList::applyFilter()
 		return;
 	}
 
-	// Filter by category
-	unsigned index = 0;
-	auto     entry = entryAt(index, false);
+	// Filter by category and name
+	auto     category = filter_category_.ToStdString();
+	unsigned index    = 0;
+	auto     entry    = entryAt(index, false);
 	while (entry)
 	{
-		if (filter_category_.IsEmpty() || entry->type() == EntryType::folderType())
-			items_.push_back(index); // If no category specified, just add all entries to the filter
-		else
-		{
-			// Check for category match
-			if (strutil::equalCI(entry->type()->category(), filter_category_.ToStdString()))
-				items_.push_back(index);
-		}
-
-		entry = entryAt(++index, false);
-	}
-
-	// Now filter by name if needed
-	if (!filter_text_.IsEmpty())
-	{
-		// Split filter by ,
-		auto terms = strutil::split(filter_text_.ToStdString(), ',');
+		// If no category specified, just add all entries to the filter
+		bool category_match = category.empty() || entry->type() == EntryType::folderType()
+							  || strutil::equalCI(entry->type()->category(), category);
 
-		// Process filter strings
-		for (auto& term : terms)
-		{
-			// Remove spaces
-			strutil::replaceIP(term, " ", "");
-
-			// Set to uppercase and add * to the end
-			if (!term.empty())
-			{
-				strutil::upperIP(term);
-				term += "*";
-			}
-		}
+		if (category_match && matchesFilter(entry, filter_terms_))
+			items_.push_back(index);
 
-		// Go through filtered list
-		for (unsigned a = 0; a < items_.size(); a++)
-		{
-			entry = entryAt(items_[a], false);
-
-			// Don't filter folders if !elist_filter_dirs
-			if (!elist_filter_dirs && entry->type() == EntryType::folderType())
-				continue;
-
-			// Check for name match with filter
-			bool match = false;
-			for (const auto& term : terms)
-			{
-				if (entry == entry_dir_back_.get() || strutil::matches(entry->upperName(), term))
-				{
-					match = true;
-					continue;
-				}
-			}
-			if (match)
-				continue;
-
-			// No match, remove from filtered list
-			items_.erase(items_.begin() + a);
-			a--;
-		}
+		entry = entryAt(++index, false);
 	}
 
 	// Update the list
@@ -540,52 +495,203 @@ bool ArchiveEntryList::goUpDir()
 }
 
 // -----------------------------------------------------------------------------
-// Returns either the size of the entry at [index], or if it is a folder, the
-// number of entries+subfolders within it
+// Returns the directory for the folder item at [index] (unfiltered), or
+// nullptr if the item isn't a folder
+// -----------------------------------------------------------------------------
+ArchiveDir* ArchiveEntryList::entryDir(long index) const
+{
+	auto dir = current_dir_.lock();
+	if (!dir)
+		return nullptr;
+
+	// 'Up folder' item
+	if (show_dir_back_ && dir->parent())
+	{
+		if (index == 0)
+			return dir->parent().get();
+		else
+			index--;
+	}
+
+	if (index >= 0 && index < static_cast<long>(dir->numSubdirs()))
+		return dir->subdirAt(index).get();
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached column text and sort keys for the item at [index]
+// (unfiltered), generating them first if needed.
+// The cache is cleared whenever the items change (see applyFilter) or an
+// entry's state changes
 // -----------------------------------------------------------------------------
-int ArchiveEntryList::entrySize(long index) const
+const ArchiveEntryList::RowData& ArchiveEntryList::rowData(long index) const
 {
+	static RowData invalid;
+
 	auto entry = entryAt(index, false);
-	if (entry->type() == EntryType::folderType())
+	if (!entry)
+		return invalid;
+
+	if (index >= static_cast<long>(rows_.size()))
+		rows_.resize(index + 1);
+
+	auto& row = rows_[index];
+	if (row.cached)
+		return row;
+
+	row.cached    = true;
+	row.folder    = entry->type() == EntryType::folderType();
+	row.type_text = entry->typeString();
+	if (row.folder)
 	{
-		auto dir = archive_.lock()->dirAtPath(entry->name(), current_dir_.lock().get());
-		return dir ? dir->numEntries() + dir->numSubdirs() : 0;
+		// Folder, size is the number of entries+subdirectories in it
+		if (auto dir = entryDir(index))
+		{
+			row.size      = dir->numEntries() + dir->numSubdirs();
+			row.size_text = wxString::Format("%d entries", row.size);
+		}
+		else
+			row.size_text = "INVALID DIRECTORY";
 	}
 	else
-		return entry->size();
+	{
+		row.size       = entry->size();
+		row.size_text  = entry->sizeString();
+		row.index_text = wxString::Format("%d", entry->index());
+	}
+
+	return row;
 }
 
 // -----------------------------------------------------------------------------
-// Sorts the list items depending on the current sorting column
+// Returns true if [entry]'s name matches any of the name filter [terms]
+// (see filterTerms), or if it isn't affected by the name filter
 // -----------------------------------------------------------------------------
-void ArchiveEntryList::sortItems()
+bool ArchiveEntryList::matchesFilter(ArchiveEntry* entry, const vector<string>& terms) const
 {
-	lv_current_ = this;
-	std::sort(items_.begin(), items_.end(), [&](long left, long right) {
-		auto le = entryAt(left, false);
-		auto re = entryAt(right, false);
+	if (!entry)
+		return false;
 
-		// Sort folder->entry first
-		if (le->type() == EntryType::folderType() && re->type() != EntryType::folderType())
+	// No name filter, or the 'up folder' item
+	if (terms.empty() || entry == entry_dir_back_.get())
+		return true;
+
+	// Don't filter folders if !elist_filter_dirs
+	if (!elist_filter_dirs && entry->type() == EntryType::folderType())
+		return true;
+
+	// Check for name match with filter
+	for (const auto& term : terms)
+		if (strutil::matches(entry->upperName(), term))
 			return true;
-		if (re->type() == EntryType::folderType() && le->type() != EntryType::folderType())
-			return false;
 
-		// Name sort
-		if (col_name_ >= 0 && col_name_ == sortColumn())
-			return sort_descend_ ? le->upperName() > re->upperName() : le->upperName() < re->upperName();
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name filter terms to match entry names against for [filter]
+// (split by commas, spaces removed, uppercase and with * added to the end).
+// Returns an empty list if [filter] is empty
+// -----------------------------------------------------------------------------
+vector<string> ArchiveEntryList::filterTerms(const wxString& filter)
+{
+	if (filter.IsEmpty())
+		return {};
 
-		// Size sort
-		if (col_size_ >= 0 && col_size_ == sortColumn())
-			return sort_descend_ ? entrySize(left) > entrySize(right) : entrySize(left) < entrySize(right);
+	// Split filter by ,
+	auto terms = strutil::split(filter.ToStdString(), ',');
 
-		// Index sort
-		if (col_index_ >= 0 && col_index_ == sortColumn())
-			return sort_descend_ ? left > right : left < right;
+	// Process filter strings
+	for (auto& term : terms)
+	{
+		// Remove spaces
+		strutil::replaceIP(term, " ", "");
 
-		// Other (default) sort
-		return VirtualListView::defaultSort(left, right);
+		// Set to uppercase and add * to the end
+		if (!term.empty())
+		{
+			strutil::upperIP(term);
+			term += "*";
+		}
+	}
+
+	return terms;
+}
+
+// -----------------------------------------------------------------------------
+// Sorts the list items depending on the current sorting column
+// -----------------------------------------------------------------------------
+void ArchiveEntryList::sortItems()
+{
+	lv_current_ = this;
+
+	// Determine what to sort by
+	enum class SortBy
+	{
+		Index,
+		Name,
+		Size,
+		Text
+	};
+	auto sort_by = SortBy::Text;
+	if (sort_column_ < 0 || (col_index_ >= 0 && col_index_ == sort_column_))
+		sort_by = SortBy::Index;
+	else if (col_name_ >= 0 && col_name_ == sort_column_)
+		sort_by = SortBy::Name;
+	else if (col_size_ >= 0 && col_size_ == sort_column_)
+		sort_by = SortBy::Size;
+
+	// Get the sort key for each item first, so comparisons don't need to look
+	// up entries or generate column text each time
+	struct SortItem
+	{
+		long          index;
+		bool          folder;
+		int           size;
+		const string* name;
+		wxString      text;
+	};
+	vector<SortItem> sort_items;
+	sort_items.reserve(items_.size());
+	for (auto index : items_)
+	{
+		auto        entry = entryAt(index, false);
+		const auto& row   = rowData(index);
+		sort_items.push_back({ index, row.folder, row.size, entry ? &entry->name() : nullptr, {} });
+		if (sort_by == SortBy::Text)
+			sort_items.back().text = itemText(index, sort_column_, index).Lower();
+	}
+
+	std::sort(sort_items.begin(), sort_items.end(), [&](const SortItem& left, const SortItem& right) {
+		// Sort folder->entry first
+		if (left.folder != right.folder)
+			return left.folder;
+
+		switch (sort_by)
+		{
+		case SortBy::Name:
+		{
+			if (!left.name || !right.name)
+				return left.name != nullptr;
+			const int result = strutil::compareCI(*left.name, *right.name);
+			return sort_descend_ ? result > 0 : result < 0;
+		}
+		case SortBy::Size: return sort_descend_ ? left.size > right.size : left.size < right.size;
+		case SortBy::Text:
+		{
+			// Sort by column text > index
+			int result = left.text.compare(right.text);
+			if (result == 0)
+				return left.index < right.index;
+			return sort_descend_ ? result > 0 : result < 0;
+		}
+		default: return sort_descend_ ? left.index > right.index : left.index < right.index;
+		}
 	});
+
+	for (size_t a = 0; a < sort_items.size(); ++a)
+		items_[a] = sort_items[a].index;
 }
 
 // -----------------------------------------------------------------------------
@@ -19,7 +19,11 @@ public:
 	const weak_ptr<ArchiveDir>& currentDir() const { return current_dir_; }
 
 	bool showDirBack() const { return show_dir_back_; }
-	void showDirBack(bool db) { show_dir_back_ = db; }
+	void showDirBack(bool db)
+	{
+		show_dir_back_  = db;
+		filter_current_ = false;
+	}
 
 	void setArchive(const shared_ptr<Archive>& archive);
 	void setUndoManager(UndoManager* manager) { undo_manager_ = manager; }
@@ -65,6 +69,17 @@ protected:
 	void     updateItemAttr(long item, long column, long index) const override;
 
 private:
+	// Cached column text and sort keys for a list item
+	struct RowData
+	{
+		bool     cached = false;
+		bool     folder = false;
+		int      size   = 0; // Entry size, or number of entries+subdirectories for folders
+		wxString size_text;
+		wxString type_text;
+		wxString index_text;
+	};
+
 	weak_ptr<Archive>        archive_;
 	wxString                 filter_category_;
 	weak_ptr<ArchiveDir>     current_dir_;
@@ -76,10 +91,18 @@ private:
 	int                      col_size_       = 0;
 	int                      col_type_       = 0;
 	bool                     entries_update_ = true;
+	mutable vector<RowData>  rows_;                   // Indexed by unfiltered item index
+	vector<string>           filter_terms_;           // Name filter terms currently applied to [items_]
+	bool                     filter_current_ = false; // False if [items_] may be out of date with the dir contents
 
 	// Signal connections
 	sigslot::scoped_connection sc_archive_modified_;
+	sigslot::scoped_connection sc_entry_state_changed_;
+
+	ArchiveDir*    entryDir(long index) const;
+	const RowData& rowData(long index) const;
+	bool           matchesFilter(ArchiveEntry* entry, const vector<string>& terms) const;
 
-	int entrySize(long index) const;
+	static vector<string> filterTerms(const wxString& filter);
 };
 } // namespace slade
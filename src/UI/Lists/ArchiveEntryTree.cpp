@@ -126,37 +126,57 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 
 	// --- Connect to Archive/ArchiveManager signals ---
 
+	// Additions and changes are queued and sent together on the next event loop
+	// iteration (see flushNotifications), so operations on many entries don't
+	// send thousands of separate notifications. Removals can't be deferred
+	// since the entry is about to be deleted, so any queued notifications are
+	// sent first to keep the order consistent
+
 	// Entry added
 	connections_ += archive->signals().entry_added.connect([this](Archive& archive, ArchiveEntry& entry) {
-		ItemAdded(createItemForDirectory(*entry.parentDir()), wxDataViewItem(&entry));
+		queueAdded(createItemForDirectory(*entry.parentDir()), wxDataViewItem(&entry));
 	});
 
 	// Entry removed
 	connections_ += archive->signals().entry_removed.connect(
 		[this](Archive& archive, ArchiveDir& dir, ArchiveEntry& entry) {
+			pending_changed_.erase(&entry);
+
+			// Nothing to remove if it was added since the last flush
+			auto added = std::find_if(pending_added_.begin(), pending_added_.end(), [&entry](const auto& item) {
+				return item.second.GetID() == &entry;
+			});
+			if (added != pending_added_.end())
+			{
+				pending_added_.erase(added);
+				return;
+			}
+
+			flushNotifications();
 			ItemDeleted(createItemForDirectory(dir), wxDataViewItem(&entry));
 		});
 
 	// Entry modified
 	connections_ += archive->signals().entry_state_changed.connect(
-		[this](Archive& archive, ArchiveEntry& entry) { ItemChanged(wxDataViewItem(&entry)); });
+		[this](Archive& archive, ArchiveEntry& entry) { queueChanged(&entry); });
 
 	// Dir added
 	connections_ += archive->signals().dir_added.connect([this](Archive& archive, ArchiveDir& dir) {
-		ItemAdded(createItemForDirectory(*dir.parent()), wxDataViewItem(dir.dirEntry()));
+		queueAdded(createItemForDirectory(*dir.parent()), wxDataViewItem(dir.dirEntry()));
 	});
 
 	// Dir removed
 	connections_ += archive->signals().dir_removed.connect(
 		[this](Archive& archive, ArchiveDir& parent, ArchiveDir& dir) {
+			flushNotifications();
 			ItemDeleted(createItemForDirectory(parent), wxDataViewItem(dir.dirEntry()));
 		});
 
 	// Entries reordered within dir
 	connections_ += archive->signals().entries_swapped.connect(
 		[this](Archive& archive, ArchiveDir& dir, unsigned index1, unsigned index2) {
-			ItemChanged(wxDataViewItem(dir.entryAt(index1)));
-			ItemChanged(wxDataViewItem(dir.entryAt(index2)));
+			queueChanged(dir.entryAt(index1));
+			queueChanged(dir.entryAt(index2));
 		});
 
 	// Bookmark added
@@ -183,6 +203,8 @@ void ArchiveViewModel::setFilter(string_view name, string_view category)
 	if (name.empty() && filter_name_.empty() && filter_category_ == category)
 		return;
 
+	flushNotifications();
+
 	// Get current root items (to remove)
 	wxDataViewItemArray prev_items;
 	if (auto* archive = archive_.lock().get())
@@ -224,6 +246,86 @@ void ArchiveViewModel::setFilter(string_view name, string_view category)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Sends any queued item added/changed notifications
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::flushNotifications()
+{
+	// Nothing to notify if the archive was closed
+	if (archive_.expired())
+	{
+		pending_added_.clear();
+		pending_changed_.clear();
+		return;
+	}
+
+	// Added items (grouped by parent)
+	if (!pending_added_.empty())
+	{
+		auto   added = std::move(pending_added_);
+		size_t a     = 0;
+		pending_added_.clear();
+		while (a < added.size())
+		{
+			auto                parent = added[a].first;
+			wxDataViewItemArray items;
+			for (; a < added.size() && added[a].first == parent; ++a)
+				items.push_back(added[a].second);
+			ItemsAdded(parent, items);
+		}
+	}
+
+	// Changed items
+	if (!pending_changed_.empty())
+	{
+		wxDataViewItemArray items;
+		for (auto* entry : pending_changed_)
+			items.push_back(wxDataViewItem{ entry });
+		pending_changed_.clear();
+		ItemsChanged(items);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Queues a notification that [item] was added to [parent]
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::queueAdded(const wxDataViewItem& parent, const wxDataViewItem& item)
+{
+	pending_added_.emplace_back(parent, item);
+	queueFlush();
+}
+
+// -----------------------------------------------------------------------------
+// Queues a notification that [entry] was changed
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::queueChanged(ArchiveEntry* entry)
+{
+	if (!entry)
+		return;
+
+	pending_changed_.insert(entry);
+	queueFlush();
+}
+
+// -----------------------------------------------------------------------------
+// Sends queued notifications on the next event loop iteration, if not already
+// scheduled
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::queueFlush()
+{
+	if (flush_queued_)
+		return;
+
+	// Keep the model alive until then
+	flush_queued_ = true;
+	IncRef();
+	wxTheApp->CallAfter([this]() {
+		flush_queued_ = false;
+		flushNotifications();
+		DecRef();
+	});
+}
+
 // -----------------------------------------------------------------------------
 // Returns the wxVariant type for the column [col]
 // -----------------------------------------------------------------------------
@@ -252,15 +354,18 @@ void ArchiveViewModel::GetValue(wxVariant& variant, const wxDataViewItem& item,
 	// Name column
 	if (col == 0)
 	{
-		const auto pad  = Point2i{ 1, elist_icon_padding };
-		const auto size = scalePx(elist_icon_size);
-		const auto bmp  = elist_icon_padding > 0 ?
-                              icons::getPaddedIcon(icons::Type::Entry, entry->type()->icon(), size, pad) :
-                              icons::getIcon(icons::Type::Entry, entry->type()->icon(), size);
-
-		wxIcon icon;
-		icon.CopyFromBitmap(bmp);
-		wxString name = entry->name();
+		// Get icon for the entry type (cached)
+		auto& icon = type_icons_[entry->type()];
+		if (!icon.IsOk())
+		{
+			const auto pad  = Point2i{ 1, elist_icon_padding };
+			const auto size = scalePx(elist_icon_size);
+			const auto bmp  = elist_icon_padding > 0 ?
+								  icons::getPaddedIcon(icons::Type::Entry, entry->type()->icon(), size, pad) :
+								  icons::getIcon(icons::Type::Entry, entry->type()->icon(), size);
+			icon.CopyFromBitmap(bmp);
+		}
+
 		if (modified_indicator_ && entry->state() != ArchiveEntry::State::Unmodified)
 			variant << wxDataViewIconText(entry->name() + " *", icon);
 		else
@@ -520,9 +625,9 @@ int ArchiveViewModel::Compare(
 	else if (e1_type == t_folder && e2_type == t_folder)
 	{
 		if (column == 0 && !ascending)
-			return e2->upperName().compare(e1->upperName());
+			return strutil::compareCI(e2->name(), e1->name());
 		else
-			return e1->upperName().compare(e2->upperName());
+			return strutil::compareCI(e1->name(), e2->name());
 	}
 
 	// Entry <-> Entry
@@ -532,7 +637,7 @@ int ArchiveViewModel::Compare(
 
 		// Name column (order by name only)
 		if (column == 0)
-			cmpval = e1->upperName().compare(e2->upperName());
+			cmpval = strutil::compareCI(e1->name(), e2->name());
 
 		// Size column (order by size -> name)
 		else if (column == 1)
@@ -542,7 +647,7 @@ int ArchiveViewModel::Compare(
 			else if (e1->size() < e2->size())
 				cmpval = -1;
 			else
-				cmpval = e1->upperName().compare(e2->upperName());
+				cmpval = strutil::compareCI(e1->name(), e2->name());
 		}
 
 		// Type column (order by type name -> name)
@@ -550,7 +655,7 @@ int ArchiveViewModel::Compare(
 		{
 			cmpval = e1_type->name().compare(e2_type->name());
 			if (cmpval == 0)
-				cmpval = e1->upperName().compare(e2->upperName());
+				cmpval = strutil::compareCI(e1->name(), e2->name());
 		}
 
 		// Default
@@ -558,7 +663,7 @@ int ArchiveViewModel::Compare(
 		{
 			// Directory archives default to alphabetical order
 			if (const auto archive = archive_.lock(); archive->formatId() == "folder")
-				cmpval = e1->upperName().compare(e2->upperName());
+				cmpval = strutil::compareCI(e1->name(), e2->name());
 
 			// Everything else defaults to index order
 			else
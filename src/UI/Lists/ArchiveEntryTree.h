@@ -1,6 +1,8 @@
 #pragma once
 
 #include "General/Sigslot.h"
+#include <unordered_map>
+#include <unordered_set>
 #include <wx/dataview.h>
 
 namespace slade
@@ -8,6 +10,7 @@ namespace slade
 class Archive;
 class ArchiveEntry;
 class ArchiveDir;
+class EntryType;
 class UndoManager;
 
 namespace ui
@@ -20,6 +23,7 @@ namespace ui
 		void openArchive(shared_ptr<Archive> archive, UndoManager* undo_manager);
 		void setFilter(string_view name, string_view category);
 		void showModifiedIndicators(bool show) { modified_indicator_ = show; }
+		void flushNotifications();
 
 	private:
 		weak_ptr<Archive>    archive_;
@@ -30,6 +34,17 @@ namespace ui
 		bool                 sort_enabled_ = true;
 		bool                 modified_indicator_ = true;
 
+		// Queued notifications
+		vector<std::pair<wxDataViewItem, wxDataViewItem>> pending_added_; // Parent, item
+		std::unordered_set<ArchiveEntry*>                 pending_changed_;
+		bool                                              flush_queued_ = false;
+
+		mutable std::unordered_map<const EntryType*, wxIcon> type_icons_;
+
+		void queueAdded(const wxDataViewItem& parent, const wxDataViewItem& item);
+		void queueChanged(ArchiveEntry* entry);
+		void queueFlush();
+
 		// wxDataViewModel
 		unsigned int   GetColumnCount() const override { return 4; }
 		wxString       GetColumnType(unsigned int col) const override;
@@ -79,6 +94,7 @@ namespace ui
 
 		void setFilter(string_view name, string_view category);
 		void collapseAll(const ArchiveDir& dir_start);
+		void flushNotifications() const { model_->flushNotifications(); }
 
 	private:
 		weak_ptr<Archive> archive_;
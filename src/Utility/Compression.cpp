@@ -32,37 +32,208 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Compression.h"
+#include "FileUtils.h"
 #include "thirdparty/zreaders/files.h"
+#include <chrono>
+#ifdef USE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
 
 using namespace slade;
 
 
 // -----------------------------------------------------------------------------
 //
-// Compression Namespace Functions
+// Variables
 //
 // -----------------------------------------------------------------------------
+namespace
+{
+constexpr size_t   max_inflate_size   = 0xFFFFFFFF; // MemChunk sizes are 32bit
+constexpr size_t   stream_chunk_size  = 256 * 1024; // Output buffer size when streaming to a file
+constexpr unsigned deflate_chunk_size = 4096;       // Input/output buffer size for genericDeflate
+} // namespace
 
 
 // -----------------------------------------------------------------------------
-// Inflates the content of [in] to [out]
+//
+// Functions
+//
 // -----------------------------------------------------------------------------
-#define CHUNK 4096
-bool compression::genericInflate(MemChunk& in, MemChunk& out, int windowbits, const char* function)
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the initial output buffer size to use when inflating [in_size]
+// bytes, or [size_hint] if the inflated size is known
+// -----------------------------------------------------------------------------
+size_t inflateBufferSize(size_t in_size, size_t size_hint)
+{
+	if (size_hint > 0)
+		return std::min(size_hint, max_inflate_size);
+
+	return std::min(std::max<size_t>(in_size * 4, 4096), max_inflate_size);
+}
+
+// -----------------------------------------------------------------------------
+// Inflates [in_size] bytes of compressed data from [source] to [out] with
+// zlib's streaming inflate.
+// Output is written to a single growing buffer rather than appended to [out]
+// in small chunks, which would reallocate [out] for every chunk. If [size_hint]
+// is correct the buffer is never grown, and is handed over to [out] as-is
+// -----------------------------------------------------------------------------
+bool zlibStreamInflate(FileReader& source, size_t in_size, MemChunk& out, int windowbits, size_t size_hint)
+{
+	// The buffer is one byte larger than the expected size, so the end of the
+	// stream is reached without filling (and then growing) it
+	FileReaderZ stream(source, windowbits);
+	MemChunk    buffer(inflateBufferSize(in_size, size_hint > 0 ? size_hint + 1 : 0));
+	size_t      total = 0;
+	long        requested, gotten;
+	do
+	{
+		// Grow buffer if full
+		if (total == buffer.size())
+		{
+			if (buffer.size() >= max_inflate_size
+				|| !buffer.reSize(std::min<size_t>(buffer.size() + buffer.size() / 2 + 4096, max_inflate_size)))
+				break;
+		}
+
+		requested = static_cast<long>(std::min<size_t>(buffer.size() - total, 0x40000000));
+		gotten    = stream.Read(buffer.data() + total, requested);
+		if (gotten > 0)
+			total += gotten;
+	} while (gotten == requested && stream.Status == Z_OK);
+
+	if (total > 0)
+	{
+		// Share the buffer if it's (nearly) the right size, otherwise copy the
+		// data so any unused space isn't kept
+		if (total + 1 >= buffer.size())
+			out.importShared(buffer, 0, total);
+		else
+			out.importMem(std::as_const(buffer).data(), total);
+		out.seek(0, SEEK_END);
+	}
+
+	return (stream.Status == Z_OK || stream.Status == Z_STREAM_END);
+}
+
+// -----------------------------------------------------------------------------
+// Inflates [in] to [out] with zlib's streaming inflate
+// -----------------------------------------------------------------------------
+bool zlibStreamInflate(const MemChunk& in, MemChunk& out, int windowbits, size_t size_hint)
 {
-	in.seek(0, SEEK_SET);
-	out.clear();
 	MemoryReader source(in);
-	FileReaderZ  stream(source, windowbits);
-	uint8_t      buffer[CHUNK];
-	size_t       gotten;
+	return zlibStreamInflate(source, in.size(), out, windowbits, size_hint);
+}
+
+// -----------------------------------------------------------------------------
+// Decompresses bzip2 data from [source] to [out]
+// -----------------------------------------------------------------------------
+bool bzip2StreamDecompress(FileReader& source, MemChunk& out)
+{
+	FileReaderBZ2 stream(source);
+	uint8_t       buffer[4096];
+	size_t        gotten;
 	do
 	{
-		gotten = stream.Read(buffer, CHUNK);
+		gotten = stream.Read(buffer, 4096);
 		if (gotten > 0)
 			out.write(buffer, gotten);
-	} while (gotten == CHUNK && stream.Status == Z_OK);
-	return (stream.Status == Z_OK || stream.Status == Z_STREAM_END);
+	} while (gotten == 4096 && stream.Status == BZ_OK);
+
+	return (stream.Status == BZ_OK || stream.Status == BZ_STREAM_END);
+}
+
+#ifdef USE_LIBDEFLATE
+// -----------------------------------------------------------------------------
+// Returns the libdeflate decompressor for the current thread
+// -----------------------------------------------------------------------------
+libdeflate_decompressor* libdeflateDecompressor()
+{
+	struct Deleter
+	{
+		void operator()(libdeflate_decompressor* d) const { libdeflate_free_decompressor(d); }
+	};
+	thread_local std::unique_ptr<libdeflate_decompressor, Deleter> decompressor{ libdeflate_alloc_decompressor() };
+	return decompressor.get();
+}
+
+// -----------------------------------------------------------------------------
+// Inflates [in] to [out] in a single call with libdeflate, which is much
+// faster than zlib's streaming inflate but needs the whole output buffer up
+// front. The buffer starts at [size_hint] (or an estimate) and is grown until
+// the data fits.
+// The stream format is selected by [windowbits] as for zlib
+// -----------------------------------------------------------------------------
+bool libdeflateInflate(const MemChunk& in, MemChunk& out, int windowbits, size_t size_hint)
+{
+	auto decompressor = libdeflateDecompressor();
+	if (!decompressor || in.size() == 0)
+		return false;
+
+	vector<uint8_t>   buffer(inflateBufferSize(in.size(), size_hint));
+	size_t            out_size = 0;
+	libdeflate_result result;
+	while (true)
+	{
+		if (windowbits < 0)
+			result = libdeflate_deflate_decompress(
+				decompressor, in.data(), in.size(), buffer.data(), buffer.size(), &out_size);
+		else if (windowbits > MAX_WBITS)
+			result = libdeflate_gzip_decompress(
+				decompressor, in.data(), in.size(), buffer.data(), buffer.size(), &out_size);
+		else
+			result = libdeflate_zlib_decompress(
+				decompressor, in.data(), in.size(), buffer.data(), buffer.size(), &out_size);
+
+		if (result != LIBDEFLATE_INSUFFICIENT_SPACE || buffer.size() >= max_inflate_size)
+			break;
+
+		buffer.resize(std::min(buffer.size() * 2, max_inflate_size));
+	}
+
+	if (result != LIBDEFLATE_SUCCESS)
+		return false;
+
+	if (out_size > 0)
+	{
+		out.importMem(buffer.data(), out_size);
+		out.seek(0, SEEK_END);
+	}
+
+	return true;
+}
+#endif
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Compression Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] to [out].
+// [size_hint] is the expected inflated size, if known.
+// Uses libdeflate if enabled at build time (USE_LIBDEFLATE), falling back to
+// zlib if that fails (eg. for truncated streams, which zlib will still inflate
+// as much of as possible)
+// -----------------------------------------------------------------------------
+bool compression::genericInflate(const MemChunk& in, MemChunk& out, int windowbits, const char* function, size_t size_hint)
+{
+	out.clear();
+
+#ifdef USE_LIBDEFLATE
+	if (libdeflateInflate(in, out, windowbits, size_hint))
+		return true;
+	out.clear();
+#endif
+
+	return zlibStreamInflate(in, out, windowbits, size_hint);
 }
 
 // -----------------------------------------------------------------------------
@@ -77,8 +248,8 @@ bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int win
 	int           ret, flush;
 	unsigned      have;
 	z_stream      strm;
-	unsigned char bin[CHUNK];
-	unsigned char bout[CHUNK];
+	unsigned char bin[deflate_chunk_size];
+	unsigned char bout[deflate_chunk_size];
 
 	/* allocate deflate state */
 	strm.zalloc = nullptr;
@@ -100,9 +271,9 @@ bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int win
 		// Find out how much stream remains
 		have = in.size() - in.currentPos();
 		// keep it in bite-sized chunks
-		if (have > CHUNK)
+		if (have > deflate_chunk_size)
 		{
-			have  = CHUNK;
+			have  = deflate_chunk_size;
 			flush = Z_NO_FLUSH;
 		}
 		else
@@ -116,11 +287,11 @@ bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int win
 			compression if all of source has been read in */
 		do
 		{
-			strm.avail_out = CHUNK;
+			strm.avail_out = deflate_chunk_size;
 			strm.next_out  = bout;
 			ret            = deflate(&strm, flush); /* no bad return value */
 			assert(ret != Z_STREAM_ERROR);          /* state not clobbered */
-			have = CHUNK - strm.avail_out;
+			have = deflate_chunk_size - strm.avail_out;
 			out.write(bout, have);
 		} while (strm.avail_out == 0);
 		assert(strm.avail_in == 0); /* all input will be used */
@@ -137,9 +308,9 @@ bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int win
 // ZIP streams use a windowbits size of MAX_WBITS (15).
 // The value is inverted to signify wrapping should be used.
 // -----------------------------------------------------------------------------
-bool compression::zipInflate(MemChunk& in, MemChunk& out, size_t maxsize)
+bool compression::zipInflate(const MemChunk& in, MemChunk& out, size_t maxsize)
 {
-	bool ret = compression::genericInflate(in, out, -MAX_WBITS, "ZipInflate");
+	bool ret = compression::genericInflate(in, out, -MAX_WBITS, "ZipInflate", maxsize);
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("Zip stream inflated to {}, expected {}", out.size(), maxsize);
@@ -162,9 +333,9 @@ bool compression::zipDeflate(MemChunk& in, MemChunk& out, int level)
 // GZip streams use a windowbits size of MAX_WBITS (15).
 // The +16 tells zlib to look out for a gzip header
 // -----------------------------------------------------------------------------
-bool compression::gzipInflate(MemChunk& in, MemChunk& out, size_t maxsize)
+bool compression::gzipInflate(const MemChunk& in, MemChunk& out, size_t maxsize)
 {
-	bool ret = compression::genericInflate(in, out, 16 + MAX_WBITS, "GZipInflate");
+	bool ret = compression::genericInflate(in, out, 16 + MAX_WBITS, "GZipInflate", maxsize);
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("Zip stream inflated to {}, expected {}", out.size(), maxsize);
@@ -188,9 +359,9 @@ bool compression::gzipDeflate(MemChunk& in, MemChunk& out, int level)
 // as well, but the function used for initialization is different so we use 0
 // here instead.
 // -----------------------------------------------------------------------------
-bool compression::zlibInflate(MemChunk& in, MemChunk& out, size_t maxsize)
+bool compression::zlibInflate(const MemChunk& in, MemChunk& out, size_t maxsize)
 {
-	bool ret = compression::genericInflate(in, out, 0, "ZlibInflate");
+	bool ret = compression::genericInflate(in, out, 0, "ZlibInflate", maxsize);
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("Zlib stream inflated to {}, expected {}", out.size(), maxsize);
@@ -214,21 +385,13 @@ bool compression::bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize)
 	in.seek(0, SEEK_SET);
 	out.clear();
 
-	MemoryReader  source(in);
-	FileReaderBZ2 stream(source);
-	uint8_t       buffer[4096];
-	size_t        gotten;
-	do
-	{
-		gotten = stream.Read(buffer, 4096);
-		if (gotten > 0)
-			out.write(buffer, gotten);
-	} while (gotten == 4096 && stream.Status == BZ_OK);
+	MemoryReader source(in);
+	bool         ok = bzip2StreamDecompress(source, out);
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("bzip2 stream inflated to {}, expected {}", out.size(), maxsize);
 
-	return (stream.Status == BZ_OK || stream.Status == BZ_STREAM_END);
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -280,3 +443,235 @@ bool compression::lzmaDecompress(MemChunk& in, MemChunk& out, size_t size)
 	delete[] cache;
 	return false;
 }
+
+// -----------------------------------------------------------------------------
+// Inflates the gzip file at [filename] to [out], reading the file in chunks
+// rather than loading it all first.
+// [size_hint] is the expected inflated size, if known
+// -----------------------------------------------------------------------------
+bool compression::gzipInflateFile(const string& filename, MemChunk& out, size_t size_hint)
+{
+	out.clear();
+
+	FileReader source;
+	if (!source.Open(filename.c_str()))
+		return false;
+
+	return zlibStreamInflate(source, source.GetLength(), out, 16 + MAX_WBITS, size_hint);
+}
+
+// -----------------------------------------------------------------------------
+// Decompresses the bzip2 file at [filename] to [out], reading the file in
+// chunks rather than loading it all first
+// -----------------------------------------------------------------------------
+bool compression::bzip2DecompressFile(const string& filename, MemChunk& out)
+{
+	out.clear();
+
+	FileReader source;
+	if (!source.Open(filename.c_str()))
+		return false;
+
+	return bzip2StreamDecompress(source, out);
+}
+
+// -----------------------------------------------------------------------------
+// Deflates [size] bytes of [data] and writes the compressed stream to [out] as
+// it is produced. [windowbits] selects the stream format as for genericDeflate
+// -----------------------------------------------------------------------------
+bool compression::deflateToFile(const uint8_t* data, size_t size, SFile& out, int level, int windowbits)
+{
+	z_stream strm{};
+	int      ret = deflateInit2(&strm, level, Z_DEFLATED, windowbits, 9, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK)
+	{
+		log::error("deflateToFile init error {}: {}", ret, strm.msg ? strm.msg : "");
+		return false;
+	}
+
+	vector<uint8_t> buffer(stream_chunk_size);
+	bool            ok = true;
+	do
+	{
+		// Feed input in chunks that fit zlib's 32bit length
+		if (strm.avail_in == 0 && size > 0)
+		{
+			strm.next_in  = const_cast<uint8_t*>(data);
+			strm.avail_in = static_cast<uInt>(std::min<size_t>(size, 0x40000000));
+			data += strm.avail_in;
+			size -= strm.avail_in;
+		}
+
+		strm.next_out  = buffer.data();
+		strm.avail_out = buffer.size();
+		ret            = deflate(&strm, size == 0 ? Z_FINISH : Z_NO_FLUSH);
+		auto have = buffer.size() - strm.avail_out;
+		if (ret == Z_STREAM_ERROR || (have > 0 && !out.write(buffer.data(), have)))
+		{
+			ok = false;
+			break;
+		}
+	} while (ret != Z_STREAM_END);
+
+	deflateEnd(&strm);
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Compresses [size] bytes of [data] as a bzip2 stream and writes it to [out]
+// as it is produced
+// -----------------------------------------------------------------------------
+bool compression::bzip2CompressToFile(const uint8_t* data, size_t size, SFile& out)
+{
+	bz_stream strm{};
+	if (BZ2_bzCompressInit(&strm, 9, 0, 0) != BZ_OK)
+		return false;
+
+	vector<char> buffer(stream_chunk_size);
+	bool         ok = true;
+	int          ret;
+	do
+	{
+		if (strm.avail_in == 0 && size > 0)
+		{
+			strm.next_in  = reinterpret_cast<char*>(const_cast<uint8_t*>(data));
+			strm.avail_in = static_cast<unsigned>(std::min<size_t>(size, 0x40000000));
+			data += strm.avail_in;
+			size -= strm.avail_in;
+		}
+
+		strm.next_out  = buffer.data();
+		strm.avail_out = buffer.size();
+		ret            = BZ2_bzCompress(&strm, size == 0 ? BZ_FINISH : BZ_RUN);
+		auto have = buffer.size() - strm.avail_out;
+		if (ret < 0 || (have > 0 && !out.write(buffer.data(), have)))
+		{
+			ok = false;
+			break;
+		}
+	} while (ret != BZ_STREAM_END);
+
+	BZ2_bzCompressEnd(&strm);
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the CRC-32 of [size] bytes of [data].
+// Uses libdeflate's implementation if enabled at build time (USE_LIBDEFLATE),
+// which is hardware accelerated (PCLMUL/ARMv8 CRC) where available, otherwise
+// zlib's
+// -----------------------------------------------------------------------------
+uint32_t compression::crc(const uint8_t* data, size_t size)
+{
+#ifdef USE_LIBDEFLATE
+	return libdeflate_crc32(0, data, size);
+#else
+	// zlib's crc32 takes a 32bit length
+	uLong crc = ::crc32(0L, Z_NULL, 0);
+	while (size > 0)
+	{
+		const auto len = static_cast<uInt>(std::min<size_t>(size, 0x40000000));
+		crc            = ::crc32(crc, data, len);
+		data += len;
+		size -= len;
+	}
+	return static_cast<uint32_t>(crc);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Measures and logs the throughput of each available inflate and CRC-32
+// implementation on [data] (eg. all entries in an archive).
+// Each chunk of data is deflated as a zlib stream first, to get realistic
+// input for inflating
+// -----------------------------------------------------------------------------
+void compression::benchmark(const vector<const MemChunk*>& data)
+{
+	using Clock = std::chrono::steady_clock;
+
+	size_t           total = 0;
+	vector<MemChunk> deflated(data.size());
+	vector<uint32_t> crcs(data.size());
+	for (unsigned a = 0; a < data.size(); a++)
+	{
+		// Deflate from a view, the data itself is never modified (or copied)
+		MemChunk in;
+		in.importShared(*data[a], 0, data[a]->size());
+		total += data[a]->size();
+		zlibDeflate(in, deflated[a]);
+		crcs[a] = crc(data[a]->data(), data[a]->size());
+	}
+	if (total == 0)
+	{
+		log::console("No data to benchmark");
+		return;
+	}
+
+	log::console(fmt::format("Benchmarking {} chunks of data ({:.1f}MB)", data.size(), total / 1048576.0));
+
+	auto report = [total](string_view method, Clock::duration time, bool ok) {
+		const auto seconds = std::max(std::chrono::duration<double>(time).count(), 1e-9);
+		log::console(fmt::format(
+			"{:<20} {:>10.1f}MB/s{}", method, total / 1048576.0 / seconds, ok ? "" : " (output mismatch!)"));
+	};
+
+	// Runs [func] for each chunk of data, returning the total time taken.
+	// [func] returns true if its output was correct, which is checked after
+	// timing each call
+	auto run = [&data](const std::function<bool(unsigned, Clock::duration&)>& func, bool& ok) {
+		Clock::duration time{};
+		ok = true;
+		for (unsigned a = 0; a < data.size(); a++)
+			if (!func(a, time))
+				ok = false;
+		return time;
+	};
+
+	bool ok;
+	auto time = run(
+		[&](unsigned a, Clock::duration& elapsed) {
+			const auto start = Clock::now();
+			const auto value = ::crc32(0L, data[a]->data(), data[a]->size());
+			elapsed += Clock::now() - start;
+			return value == crcs[a];
+		},
+		ok);
+	report("CRC-32 (zlib)", time, ok);
+
+#ifdef USE_LIBDEFLATE
+	time = run(
+		[&](unsigned a, Clock::duration& elapsed) {
+			const auto start = Clock::now();
+			const auto value = libdeflate_crc32(0, data[a]->data(), data[a]->size());
+			elapsed += Clock::now() - start;
+			return value == crcs[a];
+		},
+		ok);
+	report("CRC-32 (libdeflate)", time, ok);
+#endif
+
+	MemChunk out;
+	time = run(
+		[&](unsigned a, Clock::duration& elapsed) {
+			const auto start = Clock::now();
+			out.clear();
+			zlibStreamInflate(deflated[a], out, 0, data[a]->size());
+			elapsed += Clock::now() - start;
+			return out.size() == data[a]->size() && crc(std::as_const(out).data(), out.size()) == crcs[a];
+		},
+		ok);
+	report("Inflate (zlib)", time, ok);
+
+#ifdef USE_LIBDEFLATE
+	time = run(
+		[&](unsigned a, Clock::duration& elapsed) {
+			const auto start = Clock::now();
+			out.clear();
+			libdeflateInflate(deflated[a], out, 0, data[a]->size());
+			elapsed += Clock::now() - start;
+			return out.size() == data[a]->size() && crc(std::as_const(out).data(), out.size()) == crcs[a];
+		},
+		ok);
+	report("Inflate (libdeflate)", time, ok);
+#endif
+}
@@ -1,18 +1,32 @@
 #pragma once
 
+namespace slade
+{
+class SFile;
+}
+
 namespace slade::compression
 {
-bool genericInflate(MemChunk& in, MemChunk& out, int windowbits, const char* function);
+bool genericInflate(const MemChunk& in, MemChunk& out, int windowbits, const char* function, size_t size_hint = 0);
 bool genericDeflate(MemChunk& in, MemChunk& out, int level, int windowbits, const char* function);
-bool gzipInflate(MemChunk& in, MemChunk& out, size_t maxsize = 0);
+bool gzipInflate(const MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool gzipDeflate(MemChunk& in, MemChunk& out, int level = -1);
-bool zipInflate(MemChunk& in, MemChunk& out, size_t maxsize = 0);
+bool zipInflate(const MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool zipDeflate(MemChunk& in, MemChunk& out, int level = -1);
-bool zlibInflate(MemChunk& in, MemChunk& out, size_t maxsize = 0);
+bool zlibInflate(const MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool zlibDeflate(MemChunk& in, MemChunk& out, int level = -1);
 bool zipExplode(MemChunk& in, MemChunk& out, size_t size, int flags);
 bool zipUnshrink(MemChunk& in, MemChunk& out, size_t maxsize);
 bool bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool bzip2Compress(MemChunk& in, MemChunk& out);
 bool lzmaDecompress(MemChunk& in, MemChunk& out, size_t size);
+
+// Streaming to/from files (the compressed data is never fully in memory)
+bool gzipInflateFile(const string& filename, MemChunk& out, size_t size_hint = 0);
+bool bzip2DecompressFile(const string& filename, MemChunk& out);
+bool deflateToFile(const uint8_t* data, size_t size, SFile& out, int level, int windowbits);
+bool bzip2CompressToFile(const uint8_t* data, size_t size, SFile& out);
+
+uint32_t crc(const uint8_t* data, size_t size);
+void     benchmark(const vector<const MemChunk*>& data);
 } // namespace slade::compression
@@ -7,8 +7,10 @@
 // Web:         http://slade.mancubus.net
 // Filename:    FileMonitor.cpp
 // Description: FileMonitor class, keeps track of a file and checks it for any
-//              modifications every second, also tracks an external process, and
-//              deletes itself when this process is terminated.
+//              modifications when the OS reports a change in its directory
+//              (or every second if that isn't possible), also tracks an
+//              external process, and deletes itself when this process is
+//              terminated.
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -38,10 +40,26 @@
 #include "FileUtils.h"
 #include "StringUtils.h"
 #include <filesystem>
+#include <wx/fswatcher.h>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr int file_change_delay = 250; // Time (ms) to wait after a change is reported before checking the file
+
+unique_ptr<wxFileSystemWatcher> fs_watcher;
+std::map<string, unsigned>      watched_dirs; // Number of monitors watching each directory
+vector<FileMonitor*>            watching_monitors;
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // FileMonitor Class Fucntions
@@ -57,19 +75,109 @@ FileMonitor::FileMonitor(string_view filename, bool start) : filename_{ filename
 	// Create process
 	process_ = std::make_unique<wxProcess>(this);
 
-	// Start timer (updates every 1 sec)
+	// Start monitoring the file
 	if (start)
+		startMonitoring();
+
+	// Bind events
+	Bind(wxEVT_END_PROCESS, &FileMonitor::onEndProcess, this);
+}
+
+// -----------------------------------------------------------------------------
+// FileMonitor class destructor
+// -----------------------------------------------------------------------------
+FileMonitor::~FileMonitor()
+{
+	if (watched_dir_.empty())
+		return;
+
+	VECTOR_REMOVE(watching_monitors, this);
+	if (--watched_dirs[watched_dir_] == 0)
 	{
-		file_modified_ = fileutil::fileModifiedTime(filename);
+		watched_dirs.erase(watched_dir_);
+		if (fs_watcher)
+			fs_watcher->Remove(wxFileName::DirName(watched_dir_));
+	}
+
+	// Don't keep the watcher around if nothing is being watched
+	if (watching_monitors.empty())
+		fs_watcher.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Starts monitoring the file for modifications, via file system notifications
+// for its directory if possible, otherwise by checking it every second
+// -----------------------------------------------------------------------------
+void FileMonitor::startMonitoring()
+{
+	file_modified_ = fileutil::fileModifiedTime(filename_);
+
+	if (!watch())
 		wxTimer::Start(1000);
+}
+
+// -----------------------------------------------------------------------------
+// Starts watching the file's directory for file system notifications.
+// The directory is watched rather than the file itself since many editors save
+// by writing a new file and renaming it over the original.
+// Returns false if watching isn't possible
+// -----------------------------------------------------------------------------
+bool FileMonitor::watch()
+{
+	if (!watched_dir_.empty())
+		return true;
+
+	// The watcher can only be created once the event loop is running
+	if (!wxEventLoopBase::GetActive())
+		return false;
+
+	if (!fs_watcher)
+	{
+		fs_watcher = std::make_unique<wxFileSystemWatcher>();
+		fs_watcher->Bind(wxEVT_FSWATCHER, &FileMonitor::onFileSystemChanged);
 	}
 
-	// Bind events
-	Bind(wxEVT_END_PROCESS, &FileMonitor::onEndProcess, this);
+	auto dir = wxFileName(filename_).GetPath().ToStdString();
+	if (watched_dirs[dir]++ == 0
+		&& !fs_watcher->Add(wxFileName::DirName(dir), wxFSW_EVENT_CREATE | wxFSW_EVENT_RENAME | wxFSW_EVENT_MODIFY))
+	{
+		log::warning("Unable to watch {} for changes, it will be checked periodically instead", dir);
+		watched_dirs.erase(dir);
+		return false;
+	}
+
+	watched_dir_ = dir;
+	watching_monitors.push_back(this);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Called when a file in a watched directory is changed. Any monitor for the
+// file checks it after no more changes have been reported for a short time,
+// so it isn't read while the editor is still writing it
+// -----------------------------------------------------------------------------
+void FileMonitor::onFileSystemChanged(wxFileSystemWatcherEvent& e)
+{
+	if (e.IsError())
+	{
+		log::warning("File system watcher error: {}", e.GetErrorDescription().ToStdString());
+		return;
+	}
+
+	vector<string> paths{ e.GetPath().GetFullPath().ToStdString() };
+	if (e.GetChangeType() == wxFSW_EVENT_RENAME)
+		paths.push_back(e.GetNewPath().GetFullPath().ToStdString());
+
+	for (const auto& path : paths)
+		for (auto monitor : watching_monitors)
+			if (strutil::Path::filePathsMatch(path, monitor->filename_))
+				monitor->StartOnce(file_change_delay);
 }
 
 // -----------------------------------------------------------------------------
-// Override of wxTimer::Notify, called each time the timer updates
+// Override of wxTimer::Notify, called each time the timer updates (or once
+// after a change to the file was reported, if watching)
 // -----------------------------------------------------------------------------
 void FileMonitor::Notify()
 {
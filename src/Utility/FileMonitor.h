@@ -1,5 +1,7 @@
 #pragma once
 
+class wxFileSystemWatcherEvent;
+
 namespace slade
 {
 class Archive;
@@ -8,7 +10,7 @@ class FileMonitor : public wxTimer
 {
 public:
 	FileMonitor(string_view filename, bool start = true);
-	virtual ~FileMonitor() = default;
+	virtual ~FileMonitor();
 
 	wxProcess*    process() const { return process_.get(); }
 	const string& filename() const { return filename_; }
@@ -21,10 +23,16 @@ public:
 
 protected:
 	string filename_;
-	time_t file_modified_;
+	time_t file_modified_ = 0;
+
+	void startMonitoring();
 
 private:
 	unique_ptr<wxProcess> process_;
+	string                watched_dir_; // Directory watched for changes to the file (empty if polling)
+
+	bool        watch();
+	static void onFileSystemChanged(wxFileSystemWatcherEvent& e);
 };
 
 class DB2MapFileMonitor : public FileMonitor
@@ -35,6 +35,13 @@
 #include "FileUtils.h"
 #include <filesystem>
 #include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace slade;
 namespace fs = std::filesystem;
@@ -182,6 +189,17 @@ time_t fileutil::fileModifiedTime(string_view path)
 	return static_cast<time_t>(fs::last_write_time(path).time_since_epoch().count());
 }
 
+// -----------------------------------------------------------------------------
+// Returns the size of the file at [path] in bytes, or 0 if the file doesn't
+// exist or can't be accessed
+// -----------------------------------------------------------------------------
+uint64_t fileutil::fileSize(string_view path)
+{
+	std::error_code ec;
+	auto            size = fs::file_size(path, ec);
+	return ec ? 0 : static_cast<uint64_t>(size);
+}
+
 
 
 // -----------------------------------------------------------------------------
@@ -324,3 +342,76 @@ bool SFile::writeStr(string_view str) const
 
 	return false;
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// MappedFile Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MappedFile class constructor, maps the file at [path] into memory.
+// The mapping is private (copy-on-write), so writes to the mapped data are
+// never written back to the file
+// -----------------------------------------------------------------------------
+MappedFile::MappedFile(string_view path)
+{
+#ifdef _WIN32
+	auto wpath  = wxString::FromUTF8(path.data(), path.size());
+	auto handle = CreateFileW(
+		wpath.wc_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return;
+	file_handle_ = handle;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart == 0 || file_size.HighPart != 0)
+		return;
+
+	map_handle_ = CreateFileMappingW(handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (!map_handle_)
+		return;
+
+	data_ = static_cast<uint8_t*>(MapViewOfFile(map_handle_, FILE_MAP_COPY, 0, 0, 0));
+	if (data_)
+		size_ = file_size.LowPart;
+#else
+	auto fd = ::open(string{ path }.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0 && file_stat.st_size <= 0xFFFFFFFF)
+	{
+		auto mapped = mmap(nullptr, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED)
+		{
+			data_ = static_cast<uint8_t*>(mapped);
+			size_ = static_cast<unsigned>(file_stat.st_size);
+		}
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	::close(fd);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// MappedFile class destructor, unmaps the file
+// -----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+	if (data_)
+		UnmapViewOfFile(data_);
+	if (map_handle_)
+		CloseHandle(map_handle_);
+	if (file_handle_)
+		CloseHandle(file_handle_);
+#else
+	if (data_)
+		munmap(data_, size_);
+#endif
+}
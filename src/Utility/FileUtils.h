@@ -15,6 +15,7 @@ namespace fileutil
 	bool           createDir(string_view path);
 	vector<string> allFilesInDir(string_view path, bool include_subdirs = false, bool include_dir_paths = false);
 	time_t         fileModifiedTime(string_view path);
+	uint64_t       fileSize(string_view path);
 } // namespace fileutil
 
 class SFile : public SeekableData
@@ -55,4 +56,24 @@ private:
 	FILE*       handle_ = nullptr;
 	struct stat stat_;
 };
+
+// A read-only (copy-on-write) memory mapping of a file on disk
+class MappedFile
+{
+public:
+	MappedFile(string_view path);
+	~MappedFile();
+
+	bool     isOpen() const { return data_ != nullptr; }
+	uint8_t* data() const { return data_; }
+	unsigned size() const { return size_; }
+
+private:
+	uint8_t* data_ = nullptr;
+	unsigned size_ = 0;
+#ifdef _WIN32
+	void* file_handle_ = nullptr;
+	void* map_handle_  = nullptr;
+#endif
+};
 } // namespace slade
@@ -34,10 +34,109 @@
 #include "MemChunk.h"
 #include "FileUtils.h"
 #include "General/Misc.h"
+#include <atomic>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Next SharedBuffer id (see MemChunk::sharesData)
+std::atomic<uint64_t> next_buffer_id{ 1 };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Primes used by XXH64
+constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t prime64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ull;
+
+uint64_t rotl64(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t read64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, 8);
+	return wxUINT64_SWAP_ON_BE(value);
+}
+
+uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+	return rotl64(acc + input * prime64_2, 31) * prime64_1;
+}
+
+uint64_t xxhMerge(uint64_t hash, uint64_t acc)
+{
+	return (hash ^ xxhRound(0, acc)) * prime64_1 + prime64_4;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the 64-bit XXH64 hash (with seed 0) of [size] bytes of [data]
+// -----------------------------------------------------------------------------
+uint64_t xxHash64(const uint8_t* data, size_t size)
+{
+	const auto end = data + size;
+	uint64_t   hash;
+
+	// Process 32 byte stripes in 4 independent lanes
+	if (size >= 32)
+	{
+		uint64_t acc[4] = { prime64_1 + prime64_2, prime64_2, 0, 0ull - prime64_1 };
+		for (; data + 32 <= end; data += 32)
+			for (unsigned a = 0; a < 4; a++)
+				acc[a] = xxhRound(acc[a], read64(data + a * 8));
+
+		hash = rotl64(acc[0], 1) + rotl64(acc[1], 7) + rotl64(acc[2], 12) + rotl64(acc[3], 18);
+		for (auto lane : acc)
+			hash = xxhMerge(hash, lane);
+	}
+	else
+		hash = prime64_5;
+
+	hash += size;
+
+	// Remaining bytes
+	for (; data + 8 <= end; data += 8)
+		hash = rotl64(hash ^ xxhRound(0, read64(data)), 27) * prime64_1 + prime64_4;
+	if (data + 4 <= end)
+	{
+		uint32_t value;
+		memcpy(&value, data, 4);
+		hash = rotl64(hash ^ (wxUINT32_SWAP_ON_BE(value) * prime64_1), 23) * prime64_2 + prime64_3;
+		data += 4;
+	}
+	for (; data < end; data++)
+		hash = rotl64(hash ^ (*data * prime64_5), 11) * prime64_1;
+
+	// Final mix
+	hash ^= hash >> 33;
+	hash *= prime64_2;
+	hash ^= hash >> 29;
+	hash *= prime64_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MemChunk Class Functions
@@ -66,13 +165,34 @@ MemChunk::MemChunk(const uint8_t* data, uint32_t size) : size_{ size }
 	importMem(data, size);
 }
 
+// -----------------------------------------------------------------------------
+// MemChunk class copy constructor.
+// The data is shared with [copy] until either is modified (see importMem)
+// -----------------------------------------------------------------------------
+MemChunk::MemChunk(const MemChunk& copy)
+{
+	importMem(copy);
+}
+
 // -----------------------------------------------------------------------------
 // MemChunk class destructor
 // -----------------------------------------------------------------------------
 MemChunk::~MemChunk()
 {
 	// Free memory
-	delete[] data_;
+	freeData();
+}
+
+// -----------------------------------------------------------------------------
+// MemChunk copy assignment operator.
+// The data is shared with [copy] until either is modified
+// -----------------------------------------------------------------------------
+MemChunk& MemChunk::operator=(const MemChunk& copy)
+{
+	if (&copy != this)
+		importMem(copy);
+
+	return *this;
 }
 
 // -----------------------------------------------------------------------------
@@ -83,6 +203,21 @@ bool MemChunk::hasData() const
 	return size_ > 0 && data_;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the chunk references the same (unmodified) data as [other],
+// either by sharing it or by being a copy of it taken from a file mapping
+// -----------------------------------------------------------------------------
+bool MemChunk::sharesData(const MemChunk& other) const
+{
+	if (!data_ || size_ != other.size_)
+		return false;
+
+	if (data_ == other.data_)
+		return true;
+
+	return buffer_ && other.buffer_ && buffer_->id == other.buffer_->id;
+}
+
 // -----------------------------------------------------------------------------
 // Deletes the memory chunk.
 // Returns false if no data exists, true otherwise.
@@ -91,8 +226,7 @@ bool MemChunk::clear()
 {
 	if (hasData())
 	{
-		delete[] data_;
-		data_    = nullptr;
+		freeData();
 		size_    = 0;
 		cur_ptr_ = 0;
 		return true;
@@ -121,21 +255,15 @@ bool MemChunk::reSize(uint32_t new_size, bool preserve_data)
 
 	// Preserve existing data if specified
 	if (!preserve_data)
-	{
 		clear();
-		data_ = ndata;
-	}
 	else if (data_ != nullptr)
 	{
-		memcpy(ndata, data_, size_ * sizeof(uint8_t));
-		delete[] data_;
-		data_ = ndata;
+		memcpy(ndata, data_, std::min(size_, new_size) * sizeof(uint8_t));
+		freeData();
 	}
 	else
-	{
 		memset(ndata, 0, size_ * sizeof(uint8_t));
-		data_ = ndata;
-	}
+	setOwnedData(ndata);
 
 	// Update variables
 	size_ = new_size;
@@ -298,6 +426,122 @@ bool MemChunk::importMem(const uint8_t* start, uint32_t len)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Sets the MemChunk data to [other]'s data. The data is shared between both
+// MemChunks until either is modified, unless [other] references a file
+// mapping, in which case it is copied. Only explicit views (see importShared)
+// reference a mapping, so that copies held elsewhere (caches, clipboard, undo
+// etc.) never keep an archive file mapped
+// -----------------------------------------------------------------------------
+bool MemChunk::importMem(const MemChunk& other)
+{
+	if (!other.isMapped())
+		return importShared(other, 0, other.size_);
+
+	if (!importMem(other.data_, other.size_))
+		return false;
+
+	// Keep the id of the mapped view, so the copy still counts as the same
+	// data (see sharesData) until either is modified
+	if (buffer_)
+		buffer_->id = other.buffer_->id;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Maps the file at [filename] into memory and uses the mapped view as the
+// MemChunk data, rather than reading the whole file into memory.
+// The mapped data is copied before it is modified, so the file (and any other
+// views of the mapping) are never changed. Returns false if the file couldn't
+// be mapped
+// -----------------------------------------------------------------------------
+bool MemChunk::importFileMapped(string_view filename)
+{
+	auto mapping = std::make_shared<MappedFile>(filename);
+	if (!mapping->isOpen())
+	{
+		log::warning("MemChunk::importFileMapped: Unable to map file {}", filename);
+		return false;
+	}
+
+	// Clear current data if it exists
+	clear();
+
+	buffer_  = std::make_shared<SharedBuffer>(mapping->data(), mapping);
+	data_    = buffer_->data;
+	size_    = mapping->size();
+	cur_ptr_ = 0;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the MemChunk data to [len] bytes at [offset] within [other], without
+// copying the data where possible:
+// - If the range covers all of [other], the data buffer is shared between both
+//   MemChunks until either is modified (copy-on-write)
+// - Otherwise the MemChunk references the range within [other]'s data (or the
+//   file mapping it references) directly, keeping it alive for as long as it
+//   is referenced. The range is copied if either is modified
+// -----------------------------------------------------------------------------
+bool MemChunk::importShared(const MemChunk& other, uint32_t offset, uint32_t len)
+{
+	// Check range
+	if (offset > other.size_ || len > other.size_ - offset)
+		return false;
+
+	// Nothing to share
+	if (!other.hasData() || len == 0)
+	{
+		clear();
+		return true;
+	}
+
+	// Get the buffer to share, or create a view of the range within it
+	shared_ptr<SharedBuffer> buffer;
+	if (offset == 0 && len == other.size_)
+		buffer = other.buffer_;
+	else if (other.buffer_->mapping)
+		buffer = std::make_shared<SharedBuffer>(other.data_ + offset, other.buffer_->mapping);
+	else
+	{
+		const auto& source = other.buffer_->source ? other.buffer_->source : other.buffer_;
+		buffer             = std::make_shared<SharedBuffer>(other.data_ + offset, nullptr, source);
+	}
+
+	// Clear current data if it exists
+	clear();
+
+	buffer_  = buffer;
+	data_    = buffer_->data;
+	size_    = len;
+	cur_ptr_ = 0;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// If the MemChunk currently references a shared buffer or file mapping, copies
+// the referenced data into a buffer owned solely by the MemChunk and releases
+// the reference
+// -----------------------------------------------------------------------------
+bool MemChunk::detach()
+{
+	// Nothing to do if this is the only reference to a buffer that owns its data
+	if (!buffer_ || (!buffer_->isView() && buffer_.use_count() == 1))
+		return true;
+
+	auto ndata = allocData(size_, false);
+	if (!ndata)
+		return false;
+
+	memcpy(ndata, data_, size_);
+	setOwnedData(ndata);
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Writes the MemChunk data to a new file of [filename], starting from [start]
 // to [start+size].
@@ -351,9 +595,8 @@ bool MemChunk::exportMemChunk(MemChunk& mc, uint32_t start, uint32_t size) const
 	if (size == 0)
 		size = size_ - start;
 
-	// Write data to MemChunk
-	mc.reSize(size, false);
-	return mc.importMem(data_ + start, size);
+	// Write data to MemChunk (shares the data where possible)
+	return mc.importShared(*this, start, size);
 }
 
 // -----------------------------------------------------------------------------
@@ -376,6 +619,8 @@ bool MemChunk::write(unsigned offset, const void* data, unsigned size, bool expa
 		else
 			return false;
 	}
+	else if (!unshare())
+		return false;
 
 	// Write the data
 	memcpy(data_ + offset, data, size);
@@ -419,6 +664,8 @@ bool MemChunk::write(const void* buffer, uint32_t count)
 	// resize it so we can write at this point
 	if (cur_ptr_ + count > size_)
 		reSize(cur_ptr_ + count, true);
+	else if (!unshare())
+		return false;
 
 	// Write the data and move to the byte after what was written
 	memcpy(data_ + cur_ptr_, buffer, count);
@@ -529,10 +776,10 @@ bool MemChunk::readMC(MemChunk& mc, uint32_t size)
 // Overwrites all data bytes with [val] (basically is memset).
 // Returns false if no data exists, true otherwise
 // -----------------------------------------------------------------------------
-bool MemChunk::fillData(uint8_t val) const
+bool MemChunk::fillData(uint8_t val)
 {
 	// Check data exists
-	if (!hasData())
+	if (!hasData() || !unshare())
 		return false;
 
 	// Fill data with value
@@ -551,6 +798,16 @@ uint32_t MemChunk::crc() const
 	return hasData() ? misc::crc(data_, size_) : 0;
 }
 
+// -----------------------------------------------------------------------------
+// Calculates a fast 64bit (non-cryptographic) hash of the data, for quickly
+// checking if data is (likely to be) identical.
+// Returns the hash or 0 if no data is present
+// -----------------------------------------------------------------------------
+uint64_t MemChunk::hash() const
+{
+	return hasData() ? xxHash64(data_, size_) : 0;
+}
+
 
 // -----------------------------------------------------------------------------
 // Allocates [size] bytes of data and returns it, or null if the allocation
@@ -563,7 +820,7 @@ uint8_t* MemChunk::allocData(uint32_t size, bool set_data)
 	uint8_t* ndata;
 	try
 	{
-		ndata = new uint8_t[size];
+		ndata = alloctracker::allocBytes(size);
 	}
 	catch (std::bad_alloc& ba)
 	{
@@ -579,7 +836,55 @@ uint8_t* MemChunk::allocData(uint32_t size, bool set_data)
 	}
 
 	if (set_data)
-		data_ = ndata;
+		setOwnedData(ndata);
 
 	return ndata;
 }
+
+// -----------------------------------------------------------------------------
+// Sets the MemChunk data to [data] (allocated via allocData), in a new buffer
+// that owns it
+// -----------------------------------------------------------------------------
+void MemChunk::setOwnedData(uint8_t* data)
+{
+	buffer_ = std::make_shared<SharedBuffer>(data);
+	data_   = data;
+}
+
+// -----------------------------------------------------------------------------
+// Releases the buffer the current data is in (freeing the data if nothing else
+// references it)
+// -----------------------------------------------------------------------------
+void MemChunk::freeData()
+{
+	buffer_.reset();
+	data_ = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Ensures the MemChunk data can be modified without affecting any other
+// MemChunk sharing it, copying the data if needed.
+// Mapped data is always copied, since other views of the same mapping (each
+// with their own buffer) can overlap it. A view of another MemChunk's data is
+// also always copied
+// -----------------------------------------------------------------------------
+bool MemChunk::unshare()
+{
+	if (!detach())
+		return false;
+
+	// The data may be about to change, so it no longer counts as the same data
+	// as anything it was copied from (see sharesData)
+	if (buffer_)
+		buffer_->id = SharedBuffer::nextId();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a new unique shared buffer id
+// -----------------------------------------------------------------------------
+uint64_t MemChunk::SharedBuffer::nextId()
+{
+	return next_buffer_id++;
+}
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "General/AllocTracker.h"
 #include "SeekableData.h"
 
 namespace slade
 {
 class SFile;
+class MappedFile;
 
 class MemChunk : public SeekableData
 {
@@ -12,13 +14,25 @@ public:
 	MemChunk() = default;
 	MemChunk(uint32_t size);
 	MemChunk(const uint8_t* data, uint32_t size);
+	MemChunk(const MemChunk& copy);
 	~MemChunk();
 
-	uint8_t& operator[](int a) const { return data_[a]; }
+	MemChunk& operator=(const MemChunk& copy);
+
+	const uint8_t& operator[](int a) const { return data_[a]; }
+	uint8_t&       operator[](int a)
+	{
+		unshare();
+		return data_[a];
+	}
 
 	// Accessors
 	const uint8_t* data() const { return data_; }
-	uint8_t*       data() { return data_; }
+	uint8_t*       data()
+	{
+		unshare();
+		return data_;
+	}
 
 	// SeekableData
 	unsigned size() const override { return size_; }
@@ -29,7 +43,12 @@ public:
 	bool     read(void* buffer, unsigned count) override;
 	bool     write(const void* buffer, unsigned count) override;
 
-	bool hasData() const;
+	bool                 hasData() const;
+	bool                 isMapped() const { return buffer_ && buffer_->mapping; }
+	weak_ptr<MappedFile> mappedFile() const { return buffer_ ? buffer_->mapping : nullptr; }
+	bool                 isShared() const { return buffer_ && buffer_.use_count() > 1; }
+	long                 shareCount() const { return buffer_ ? buffer_.use_count() : 0; }
+	bool                 sharesData(const MemChunk& other) const;
 
 	bool clear();
 	bool reSize(uint32_t new_size, bool preserve_data = true);
@@ -39,7 +58,10 @@ public:
 	bool importFileStreamWx(wxFile& file, uint32_t len = 0);
 	bool importFileStream(SFile& file, unsigned len = 0);
 	bool importMem(const uint8_t* start, uint32_t len);
-	bool importMem(const MemChunk& other) { return importMem(other.data_, other.size_); }
+	bool importMem(const MemChunk& other);
+	bool importFileMapped(string_view filename);
+	bool importShared(const MemChunk& other, uint32_t offset, uint32_t len);
+	bool detach();
 
 	// Data export
 	bool exportFile(string_view filename, uint32_t start = 0, uint32_t size = 0) const;
@@ -58,8 +80,9 @@ public:
 	bool readMC(MemChunk& mc, uint32_t size);
 
 	// Misc
-	bool     fillData(uint8_t val) const;
+	bool     fillData(uint8_t val);
 	uint32_t crc() const;
+	uint64_t hash() const;
 
 	// Platform-independent functions to read values in little (L##) or big (B##) endian
 	uint16_t readL16(unsigned i) const { return data_[i] + (data_[i + 1] << 8); }
@@ -76,10 +99,46 @@ public:
 	}
 
 protected:
+	// Reference-counted data buffer that can be shared between MemChunks.
+	// Either owns [data], or points to the start of a view of [mapping] or of
+	// another (owning) buffer [source]. [id] identifies the buffer contents, a
+	// copy of mapped data keeps the id of the view it was copied from
+	struct SharedBuffer
+	{
+		uint8_t*                 data = nullptr;
+		shared_ptr<MappedFile>   mapping;
+		shared_ptr<SharedBuffer> source;
+		uint64_t                 id = 0;
+
+		SharedBuffer(
+			uint8_t*                 data,
+			shared_ptr<MappedFile>   mapping = nullptr,
+			shared_ptr<SharedBuffer> source  = nullptr) :
+			data{ data }, mapping{ std::move(mapping) }, source{ std::move(source) }, id{ nextId() }
+		{
+		}
+		~SharedBuffer()
+		{
+			if (!mapping && !source)
+				alloctracker::freeBytes(data);
+		}
+		bool isView() const { return mapping || source; }
+
+		static uint64_t nextId();
+	};
+
 	uint8_t* data_    = nullptr;
 	uint32_t cur_ptr_ = 0;
 	uint32_t size_    = 0;
 
+	// The buffer data_ points into (null if there is no data). Copies of the
+	// MemChunk share the buffer (copy-on-write, the data is copied before it is
+	// modified if the buffer is shared or a view)
+	shared_ptr<SharedBuffer> buffer_;
+
 	uint8_t* allocData(uint32_t size, bool set_data = true);
+	void     setOwnedData(uint8_t* data);
+	void     freeData();
+	bool     unshare();
 };
 } // namespace slade
@@ -56,6 +56,21 @@ ParseTreeNode::ParseTreeNode(ParseTreeNode* parent, Parser* parser, ArchiveDir*
 	allowDup(true);
 }
 
+// -----------------------------------------------------------------------------
+// ParseTreeNode class destructor
+// -----------------------------------------------------------------------------
+ParseTreeNode::~ParseTreeNode()
+{
+	// Children allocated by the Parser are deleted along with it, so remove them
+	// before the remaining children are deleted in the STreeNode destructor
+	children_.erase(
+		std::remove_if(
+			children_.begin(),
+			children_.end(),
+			[](STreeNode* child) { return static_cast<ParseTreeNode*>(child)->in_arena_; }),
+		children_.end());
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the node's name matches [name] (case-insensitive)
 // -----------------------------------------------------------------------------
@@ -145,11 +160,25 @@ double ParseTreeNode::floatValue(unsigned index)
 // -----------------------------------------------------------------------------
 ParseTreeNode* ParseTreeNode::addChildPTN(string_view name, string_view type)
 {
-	auto* node  = dynamic_cast<ParseTreeNode*>(addChild(name));
+	auto* node  = static_cast<ParseTreeNode*>(addChild(name));
 	node->type_ = type;
 	return node;
 }
 
+// -----------------------------------------------------------------------------
+// Creates a new child ParseTreeNode of [name], allocated from the parser's node
+// arena if this node belongs to a parser
+// -----------------------------------------------------------------------------
+STreeNode* ParseTreeNode::createChild(string_view name)
+{
+	if (parser_)
+		return parser_->createNode(name);
+
+	auto ret = new ParseTreeNode();
+	ret->setName(name);
+	return ret;
+}
+
 // -----------------------------------------------------------------------------
 // Writes an error log message [error], showing the source and current line
 // from tokenizer [tz]
@@ -517,7 +546,7 @@ void ParseTreeNode::write(string& out, int indent) const
 		out += "\n" + tabs + "{\n";
 
 		for (auto* node : children_)
-			dynamic_cast<ParseTreeNode*>(node)->write(out, indent + 1);
+			static_cast<ParseTreeNode*>(node)->write(out, indent + 1);
 
 		// Closing brace
 		out += tabs + "}\n";
@@ -541,6 +570,19 @@ Parser::Parser(ArchiveDir* dir_root) : archive_dir_root_{ dir_root }
 	pt_root_ = std::make_unique<ParseTreeNode>(nullptr, this, archive_dir_root_);
 }
 
+// -----------------------------------------------------------------------------
+// Creates a new (parentless) ParseTreeNode of [name] belonging to this parser.
+// Nodes are allocated in blocks and all deleted along with the parser, rather
+// than being allocated and deleted individually by their parent node
+// -----------------------------------------------------------------------------
+ParseTreeNode* Parser::createNode(string_view name)
+{
+	auto& node     = nodes_.emplace_back(nullptr, this);
+	node.name_     = name;
+	node.in_arena_ = true;
+	return &node;
+}
+
 // -----------------------------------------------------------------------------
 // Parses the given text data to build a tree of ParseTreeNodes.
 // Example:
@@ -575,7 +617,7 @@ Parser::Parser(ArchiveDir* dir_root) : archive_dir_root_{ dir_root }
 // 		</base>
 // 	</root>
 // -----------------------------------------------------------------------------
-bool Parser::parseText(MemChunk& mc, string_view source) const
+bool Parser::parseText(const MemChunk& mc, string_view source) const
 {
 	Tokenizer tz;
 
@@ -588,6 +630,7 @@ bool Parser::parseText(MemChunk& mc, string_view source) const
 	}
 
 	// Do parsing
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Parser);
 	return pt_root_->parse(tz);
 }
 bool Parser::parseText(string_view text, string_view source) const
@@ -603,6 +646,7 @@ bool Parser::parseText(string_view text, string_view source) const
 	}
 
 	// Do parsing
+	alloctracker::Scope alloc_scope(alloctracker::Subsystem::Parser);
 	return pt_root_->parse(tz);
 }
 
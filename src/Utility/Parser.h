@@ -1,7 +1,9 @@
 #pragma once
 
+#include "General/AllocTracker.h"
 #include "Property.h"
 #include "Tree.h"
+#include <deque>
 
 namespace slade
 {
@@ -9,15 +11,17 @@ class ArchiveDir;
 class Parser;
 class Tokenizer;
 
-class ParseTreeNode : public STreeNode
+class ParseTreeNode : public STreeNode, alloctracker::Counted<ParseTreeNode, alloctracker::Type::ParseTreeNode>
 {
+	friend class Parser;
+
 public:
 	ParseTreeNode(
 		ParseTreeNode* parent      = nullptr,
 		Parser*        parser      = nullptr,
 		ArchiveDir*    archive_dir = nullptr,
 		string_view    type        = "");
-	~ParseTreeNode() = default;
+	~ParseTreeNode() override;
 
 	const string& name() const override { return name_; }
 	void          setName(string_view name) override { name_ = name; }
@@ -38,26 +42,22 @@ public:
 	double         floatValue(unsigned index = 0);
 
 	// To avoid need for casts everywhere
-	ParseTreeNode* childPTN(string_view name) { return dynamic_cast<ParseTreeNode*>(child(name)); }
-	ParseTreeNode* childPTN(unsigned index) { return dynamic_cast<ParseTreeNode*>(child(index)); }
+	// (all children of a ParseTreeNode are ParseTreeNodes, so no RTTI is needed)
+	ParseTreeNode* childPTN(string_view name) { return static_cast<ParseTreeNode*>(child(name)); }
+	ParseTreeNode* childPTN(unsigned index) { return static_cast<ParseTreeNode*>(child(index)); }
 
 	ParseTreeNode* addChildPTN(string_view name, string_view type = "");
 	void           addStringValue(string_view value) { values_.emplace_back(string{ value }); }
 	void           addIntValue(int value) { values_.emplace_back(value); }
 	void           addBoolValue(bool value) { values_.emplace_back(value); }
 	void           addFloatValue(double value) { values_.emplace_back(value); }
+	void           addValue(const Property& value) { values_.push_back(value); }
 
 	bool parse(Tokenizer& tz);
 	void write(string& out, int indent = 0) const;
 
 protected:
-	STreeNode* createChild(string_view name) override
-	{
-		auto ret = new ParseTreeNode();
-		ret->setName(name);
-		ret->parser_ = parser_;
-		return ret;
-	}
+	STreeNode* createChild(string_view name) override;
 
 private:
 	string           name_;
@@ -66,6 +66,7 @@ private:
 	vector<Property> values_;
 	Parser*          parser_      = nullptr;
 	ArchiveDir*      archive_dir_ = nullptr;
+	bool             in_arena_    = false; // Node is owned by its Parser rather than its parent
 
 	void logError(const Tokenizer& tz, string_view error) const;
 	bool parsePreprocessor(Tokenizer& tz);
@@ -82,15 +83,18 @@ public:
 
 	void setCaseSensitive(bool cs) { case_sensitive_ = cs; }
 
-	bool parseText(MemChunk& mc, string_view source = "memory chunk") const;
+	bool parseText(const MemChunk& mc, string_view source = "memory chunk") const;
 	bool parseText(string_view text, string_view source = "string") const;
 	void define(string_view def);
 	bool defined(string_view def);
 
 	// To simplify casts from STreeNode to ParseTreeNode
-	static ParseTreeNode* node(STreeNode* node) { return dynamic_cast<ParseTreeNode*>(node); }
+	static ParseTreeNode* node(STreeNode* node) { return static_cast<ParseTreeNode*>(node); }
+
+	ParseTreeNode* createNode(string_view name);
 
 private:
+	std::deque<ParseTreeNode> nodes_; // Arena for all nodes in the parse tree (other than the root)
 	unique_ptr<ParseTreeNode> pt_root_;
 	vector<string>            defines_;
 	ArchiveDir*               archive_dir_root_ = nullptr;
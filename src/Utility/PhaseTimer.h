@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+
+namespace slade
+{
+// Times a sequence of named phases of an operation (eg. the steps of opening a
+// map), so a breakdown of where the time was spent can be reported
+class PhaseTimer
+{
+public:
+	struct Phase
+	{
+		string name;
+		double ms;
+	};
+
+	PhaseTimer()  = default;
+	~PhaseTimer() = default;
+
+	const vector<Phase>& phases() const { return phases_; }
+	bool                 empty() const { return phases_.empty(); }
+
+	void clear()
+	{
+		phases_.clear();
+		running_ = false;
+	}
+
+	// Ends the current phase (if any) and begins timing a new phase [name]
+	void begin(string_view name)
+	{
+		end();
+		phases_.push_back({ string{ name }, 0. });
+		start_   = Clock::now();
+		running_ = true;
+	}
+
+	// Ends the current phase
+	void end()
+	{
+		if (!running_)
+			return;
+
+		phases_.back().ms = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+		running_          = false;
+	}
+
+	// Returns the total time of all phases, in milliseconds
+	double totalMs() const
+	{
+		double total = 0.;
+		for (const auto& phase : phases_)
+			total += phase.ms;
+		return total;
+	}
+
+	// Returns a single-line summary of all phases, eg. "Parse 12ms, Build 5ms"
+	string summary() const
+	{
+		string text;
+		for (const auto& phase : phases_)
+		{
+			if (!text.empty())
+				text += ", ";
+			text += fmt::format("{} {:1.0f}ms", phase.name, phase.ms);
+		}
+		return text;
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	vector<Phase>     phases_;
+	Clock::time_point start_;
+	bool              running_ = false;
+};
+} // namespace slade
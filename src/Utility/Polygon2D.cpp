@@ -36,11 +36,24 @@
 #include "MathStuff.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "PolygonTriangulator.h"
 #include "SLADEMap/SLADEMap.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, polygon_split_method, 0, CVar::Flag::Save) // 0 = auto, 1 = PolygonSplitter, 2 = PolygonTriangulator
+namespace
+{
+constexpr unsigned triangulate_min_edges = 256; // Sectors with at least this many edges are triangulated in auto mode
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Polygon2D Class Functions
@@ -114,19 +127,37 @@ unsigned Polygon2D::totalVertices()
 	return total;
 }
 
-bool Polygon2D::openSector(MapSector* sector)
+// -----------------------------------------------------------------------------
+// Builds the polygon for [sector], splitting it into convex sub-polygons with
+// [method]. By default, large sectors are split with PolygonTriangulator and
+// others with PolygonSplitter (see the polygon_split_method cvar).
+// Returns false if the sector polygon couldn't be built
+// -----------------------------------------------------------------------------
+bool Polygon2D::openSector(MapSector* sector, SplitMethod method)
 {
 	// Check sector was given
 	if (!sector)
 		return false;
 
 	// Init
-	PolygonSplitter splitter;
+	PolygonSplitter     splitter;
+	PolygonTriangulator triangulator;
 	clear();
 
 	// Get list of sides connected to this sector
 	auto& sides = sector->connectedSides();
 
+	// Determine split method
+	if (method == SplitMethod::Default)
+	{
+		if (polygon_split_method == 1)
+			method = SplitMethod::Splitter;
+		else if (polygon_split_method == 2 || sides.size() >= triangulate_min_edges)
+			method = SplitMethod::Triangulator;
+		else
+			method = SplitMethod::Splitter;
+	}
+
 	// Go through sides
 	MapLine* line;
 	for (auto& side : sides)
@@ -138,14 +169,21 @@ bool Polygon2D::openSector(MapSector* sector)
 			continue;
 
 		// Add the edge to the splitter (direction depends on what side of the line this is)
-		if (line->s1() == side)
-			splitter.addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
+		auto v1 = line->v1();
+		auto v2 = line->v2();
+		if (line->s1() != side)
+			std::swap(v1, v2);
+		if (method == SplitMethod::Triangulator)
+			triangulator.addEdge(v1->xPos(), v1->yPos(), v2->xPos(), v2->yPos());
 		else
-			splitter.addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
+			splitter.addEdge(v1->xPos(), v1->yPos(), v2->xPos(), v2->yPos());
 	}
 
 	// Split the polygon into convex sub-polygons
-	return splitter.doSplitting(this);
+	if (method == SplitMethod::Triangulator)
+		return triangulator.doSplitting(this);
+	else
+		return splitter.doSplitting(this);
 }
 
 void Polygon2D::updateTextureCoords(double scale_x, double scale_y, double offset_x, double offset_y, double rotation)
@@ -209,6 +247,14 @@ unsigned Polygon2D::vboDataSize()
 	return total;
 }
 
+size_t Polygon2D::memoryUsage() const
+{
+	auto size = subpolys_.capacity() * sizeof(SubPoly);
+	for (const auto& subpoly : subpolys_)
+		size += subpoly.vertices.capacity() * sizeof(Vertex);
+	return size;
+}
+
 unsigned Polygon2D::writeToVBO(unsigned offset, unsigned index)
 {
 	// Go through subpolys
@@ -227,12 +273,33 @@ unsigned Polygon2D::writeToVBO(unsigned offset, unsigned index)
 	}
 
 	// Update variables
-	vbo_update_ = 0;
+	vbo_update_      = 0;
+	vbo_slot_offset_ = offset;
+	vbo_slot_index_  = index;
+	vbo_slot_size_   = ofs - offset;
 
 	// Return the offset to the end of the data
 	return ofs;
 }
 
+// -----------------------------------------------------------------------------
+// Rewrites all polygon data (eg. after the polygon was rebuilt) to the VBO
+// range it was last written to, if it still fits.
+// Returns false if the polygon data no longer fits
+// -----------------------------------------------------------------------------
+bool Polygon2D::rewriteVBO()
+{
+	if (vboDataSize() > vbo_slot_size_)
+		return false;
+
+	// Keep the full slot size, in case the polygon grows back into it later
+	auto slot_size = vbo_slot_size_;
+	writeToVBO(vbo_slot_offset_, vbo_slot_index_);
+	vbo_slot_size_ = slot_size;
+
+	return true;
+}
+
 void Polygon2D::updateVBOData()
 {
 	// Go through subpolys
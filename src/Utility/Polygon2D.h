@@ -21,6 +21,14 @@ public:
 		unsigned       vbo_index  = 0;
 	};
 
+	// Algorithm used to split a sector into convex sub-polygons
+	enum class SplitMethod
+	{
+		Default,     // Depends on the polygon_split_method cvar
+		Splitter,    // PolygonSplitter
+		Triangulator // PolygonTriangulator
+	};
+
 	Polygon2D() = default;
 	~Polygon2D() { clear(); }
 
@@ -44,7 +52,7 @@ public:
 	void     clear();
 	unsigned totalVertices();
 
-	bool openSector(MapSector* sector);
+	bool openSector(MapSector* sector, SplitMethod method = SplitMethod::Default);
 	void updateTextureCoords(
 		double scale_x  = 1,
 		double scale_y  = 1,
@@ -53,7 +61,9 @@ public:
 		double rotation = 0);
 
 	unsigned vboDataSize();
+	size_t   memoryUsage() const;
 	unsigned writeToVBO(unsigned offset, unsigned index);
+	bool     rewriteVBO();
 	void     updateVBOData();
 
 	void render();
@@ -70,6 +80,11 @@ private:
 	float           colour_[4] = { 1.f, 1.f, 1.f, 1.f };
 
 	int vbo_update_ = 2;
+
+	// The range of the VBO this polygon was last written to with writeToVBO
+	unsigned vbo_slot_offset_ = 0;
+	unsigned vbo_slot_index_  = 0;
+	unsigned vbo_slot_size_   = 0;
 };
 
 
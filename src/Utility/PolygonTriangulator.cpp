@@ -0,0 +1,1145 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PolygonTriangulator.cpp
+// Description: PolygonTriangulator class, splits a polygon (with holes) into
+//              convex sub-polygons via z-order indexed ear clipping
+//              triangulation. The ear clipping part is based on the 'earcut'
+//              algorithm by Mapbox (https://github.com/mapbox/earcut)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PolygonTriangulator.h"
+#include "MathStuff.h"
+
+using namespace slade;
+
+using Node = PolygonTriangulator::Node;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the (doubled) signed area of the triangle [p],[q],[r].
+// Negative if the triangle is anticlockwise
+// -----------------------------------------------------------------------------
+double area(const Node* p, const Node* q, const Node* r)
+{
+	return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if nodes [a] and [b] are at the same position
+// -----------------------------------------------------------------------------
+bool equals(const Node* a, const Node* b)
+{
+	return a->x == b->x && a->y == b->y;
+}
+
+// -----------------------------------------------------------------------------
+// Returns -1, 0 or 1 depending on the sign of [value]
+// -----------------------------------------------------------------------------
+int sign(double value)
+{
+	return value > 0 ? 1 : value < 0 ? -1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if point [px,py] is within the triangle [a],[b],[c]
+// -----------------------------------------------------------------------------
+bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+	return (cx - px) * (ay - py) >= (ax - px) * (cy - py) && (ax - px) * (by - py) >= (bx - px) * (ay - py)
+		   && (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+bool pointInTriangle(const Node* a, const Node* b, const Node* c, const Node* p)
+{
+	return pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [q] is within the bounding box of collinear points [p],[r]
+// -----------------------------------------------------------------------------
+bool onSegment(const Node* p, const Node* q, const Node* r)
+{
+	return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) && q->y <= std::max(p->y, r->y)
+		   && q->y >= std::min(p->y, r->y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if segments [p1]-[q1] and [p2]-[q2] intersect
+// -----------------------------------------------------------------------------
+bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2)
+{
+	const auto o1 = sign(area(p1, q1, p2));
+	const auto o2 = sign(area(p1, q1, q2));
+	const auto o3 = sign(area(p2, q2, p1));
+	const auto o4 = sign(area(p2, q2, q1));
+
+	if (o1 != o2 && o3 != o4)
+		return true;
+
+	// Collinear cases
+	return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1))
+		   || (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a diagonal from [a] to [b] intersects any edge of the
+// polygon (other than those adjacent to [a] or [b])
+// -----------------------------------------------------------------------------
+bool intersectsPolygon(const Node* a, const Node* b)
+{
+	auto p = a;
+	do
+	{
+		if (p->index != a->index && p->next->index != a->index && p->index != b->index && p->next->index != b->index
+			&& intersects(p, p->next, a, b))
+			return true;
+
+		p = p->next;
+	} while (p != a);
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a diagonal from [a] to [b] is locally inside the polygon
+// (ie. within the angle at [a])
+// -----------------------------------------------------------------------------
+bool locallyInside(const Node* a, const Node* b)
+{
+	return area(a->prev, a, a->next) < 0 ? area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
+										   area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the middle point of a diagonal from [a] to [b] is inside
+// the polygon
+// -----------------------------------------------------------------------------
+bool middleInside(const Node* a, const Node* b)
+{
+	auto       p      = a;
+	bool       inside = false;
+	const auto px     = (a->x + b->x) / 2;
+	const auto py     = (a->y + b->y) / 2;
+	do
+	{
+		if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y
+			&& (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+			inside = !inside;
+
+		p = p->next;
+	} while (p != a);
+
+	return inside;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a diagonal from [a] to [b] can be used to split the polygon
+// -----------------------------------------------------------------------------
+bool isValidDiagonal(const Node* a, const Node* b)
+{
+	// Doesn't intersect other edges, and is locally visible
+	if (a->next->index == b->index || a->prev->index == b->index || intersectsPolygon(a, b))
+		return false;
+
+	if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+		&& (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0))
+		return true;
+
+	// Special zero-length case
+	return equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the angle at [m] contains the angle at [p] (where both are
+// at the same position)
+// -----------------------------------------------------------------------------
+bool sectorContainsSector(const Node* m, const Node* p)
+{
+	return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+}
+
+// -----------------------------------------------------------------------------
+// Removes node [p] from its list(s)
+// -----------------------------------------------------------------------------
+void removeNode(Node* p)
+{
+	p->next->prev = p->prev;
+	p->prev->next = p->next;
+
+	if (p->prev_z)
+		p->prev_z->next_z = p->next_z;
+	if (p->next_z)
+		p->next_z->prev_z = p->prev_z;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the leftmost node of the polygon starting at [start]
+// -----------------------------------------------------------------------------
+Node* leftmost(Node* start)
+{
+	auto p    = start;
+	auto left = start;
+	do
+	{
+		if (p->x < left->x || (p->x == left->x && p->y < left->y))
+			left = p;
+		p = p->next;
+	} while (p != start);
+
+	return left;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the z-order curve value of point [x,y], from 0-32767 on each axis
+// within the bounds starting at [min_x,min_y]
+// -----------------------------------------------------------------------------
+uint32_t zOrder(double x, double y, double min_x, double min_y, double inv_size)
+{
+	auto ix = static_cast<uint32_t>(std::clamp((x - min_x) * inv_size, 0., 32767.));
+	auto iy = static_cast<uint32_t>(std::clamp((y - min_y) * inv_size, 0., 32767.));
+
+	ix = (ix | (ix << 8)) & 0x00FF00FF;
+	ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+	ix = (ix | (ix << 2)) & 0x33333333;
+	ix = (ix | (ix << 1)) & 0x55555555;
+
+	iy = (iy | (iy << 8)) & 0x00FF00FF;
+	iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+	iy = (iy | (iy << 2)) & 0x33333333;
+	iy = (iy | (iy << 1)) & 0x55555555;
+
+	return ix | (iy << 1);
+}
+
+// -----------------------------------------------------------------------------
+// Sorts the z-order linked list starting at [list] by z value (bottom-up
+// merge sort), returning the new start of the list
+// -----------------------------------------------------------------------------
+Node* sortLinked(Node* list)
+{
+	unsigned merges;
+	unsigned in_size = 1;
+	do
+	{
+		auto  p    = list;
+		Node* tail = nullptr;
+		list       = nullptr;
+		merges     = 0;
+
+		while (p)
+		{
+			merges++;
+			auto     q      = p;
+			unsigned p_size = 0;
+			for (unsigned i = 0; i < in_size; i++)
+			{
+				p_size++;
+				q = q->next_z;
+				if (!q)
+					break;
+			}
+
+			unsigned q_size = in_size;
+			while (p_size > 0 || (q_size > 0 && q))
+			{
+				Node* e;
+				if (p_size != 0 && (q_size == 0 || !q || p->z <= q->z))
+				{
+					e = p;
+					p = p->next_z;
+					p_size--;
+				}
+				else
+				{
+					e = q;
+					q = q->next_z;
+					q_size--;
+				}
+
+				if (tail)
+					tail->next_z = e;
+				else
+					list = e;
+
+				e->prev_z = tail;
+				tail      = e;
+			}
+
+			p = q;
+		}
+
+		tail->next_z = nullptr;
+		in_size *= 2;
+	} while (merges > 1);
+
+	return list;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PolygonTriangulator Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Hash function for vertex positions
+// -----------------------------------------------------------------------------
+size_t PolygonTriangulator::PointHash::operator()(const std::pair<double, double>& point) const
+{
+	const auto hx = std::hash<double>()(point.first);
+	const auto hy = std::hash<double>()(point.second);
+	return hx ^ (hy + 0x9E3779B9 + (hx << 6) + (hx >> 2));
+}
+
+// -----------------------------------------------------------------------------
+// Clears all polygon data
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::clear()
+{
+	vertices_.clear();
+	vertex_map_.clear();
+	vertex_edges_out_.clear();
+	edges_.clear();
+	edge_keys_.clear();
+	outlines_.clear();
+	nodes_.clear();
+	triangles_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds an edge from [x1,y1] to [x2,y2], with the inside of the polygon on its
+// right side. Duplicate and zero-length edges are ignored
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::addEdge(double x1, double y1, double x2, double y2)
+{
+	const auto v1 = addVertex(x1, y1);
+	const auto v2 = addVertex(x2, y2);
+	if (v1 == v2 || !edge_keys_.insert(static_cast<uint64_t>(v1) << 32 | static_cast<uint32_t>(v2)).second)
+		return;
+
+	vertex_edges_out_[v1].push_back(edges_.size());
+	edges_.push_back({ v1, v2 });
+}
+
+// -----------------------------------------------------------------------------
+// Splits the polygon into convex sub-polygons and adds them to [poly].
+// Returns false if the edges don't make up any closed outlines
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::doSplitting(Polygon2D* poly)
+{
+	// Trace polygon outlines
+	for (unsigned a = 0; a < edges_.size(); a++)
+		if (!edges_[a].used)
+			traceOutline(a);
+
+	if (outlines_.empty())
+		return false;
+
+	// Get 'outer' (clockwise) outlines, smallest first so holes are assigned to
+	// the innermost outline that contains them
+	vector<unsigned> outers;
+	for (unsigned a = 0; a < outlines_.size(); a++)
+		if (outlines_[a].area < 0)
+			outers.push_back(a);
+	std::sort(outers.begin(), outers.end(), [this](unsigned a, unsigned b) {
+		return outlines_[a].area > outlines_[b].area;
+	});
+
+	// Assign 'inner' (anticlockwise) outlines to the outer outline they are
+	// within, holes that aren't within any outer outline are invalid
+	vector<vector<const Outline*>> holes(outers.size());
+	for (const auto& outline : outlines_)
+	{
+		if (outline.area <= 0)
+			continue;
+
+		// Test the middle of the hole's first edge, since its vertices may be on
+		// the outer outline
+		const auto& v1    = vertices_[outline.vertices[0]];
+		const auto& v2    = vertices_[outline.vertices[1]];
+		const Vec2d point = { (v1.x + v2.x) * 0.5, (v1.y + v2.y) * 0.5 };
+		for (unsigned a = 0; a < outers.size(); a++)
+		{
+			if (outlineContains(outlines_[outers[a]], point))
+			{
+				holes[a].push_back(&outline);
+				break;
+			}
+		}
+	}
+
+	// Triangulate each outer outline with its holes
+	for (unsigned a = 0; a < outers.size(); a++)
+		triangulate(outlines_[outers[a]], holes[a]);
+
+	// Merge triangles into convex polygons
+	buildConvexPolygons(poly);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the vertex at [x,y], adding it if it doesn't exist
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::addVertex(double x, double y)
+{
+	auto i = vertex_map_.find({ x, y });
+	if (i != vertex_map_.end())
+		return i->second;
+
+	const int index        = vertices_.size();
+	vertex_map_[{ x, y }] = index;
+	vertices_.emplace_back(x, y);
+	vertex_edges_out_.emplace_back();
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the unused edge following [edge] with the smallest angle between
+// them, or -1 if there is none. [edge_start] is also considered, even though
+// it is in use, so the outline being traced can be closed
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::nextEdge(int edge, int edge_start) const
+{
+	const auto& e = edges_[edge];
+
+	double min_angle = 2 * math::PI;
+	int    next      = -1;
+	for (auto out : vertex_edges_out_[e.v2])
+	{
+		const auto& oe = edges_[out];
+		if ((oe.used && out != edge_start) || oe.v2 == e.v1)
+			continue;
+
+		const auto angle = math::angle2DRad(vertices_[e.v1], vertices_[e.v2], vertices_[oe.v2]);
+		if (angle < min_angle)
+		{
+			min_angle = angle;
+			next      = out;
+		}
+	}
+
+	return next;
+}
+
+// -----------------------------------------------------------------------------
+// Traces a closed polygon outline starting from [edge_start].
+// Returns false if the outline couldn't be closed, in which case the starting
+// edge is discarded (and any other edges traced are left for other outlines)
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::traceOutline(int edge_start)
+{
+	vector<int> path{ edge_start };
+	edges_[edge_start].used = true;
+
+	auto edge = edge_start;
+	while (true)
+	{
+		const auto next = nextEdge(edge, edge_start);
+
+		// Dead end, release traced edges
+		if (next < 0)
+		{
+			for (unsigned a = 1; a < path.size(); a++)
+				edges_[path[a]].used = false;
+			return false;
+		}
+
+		// Stop if we're back at the start
+		if (next == edge_start)
+			break;
+
+		edges_[next].used = true;
+		path.push_back(next);
+		edge = next;
+	}
+
+	// Ignore outlines with no area
+	if (path.size() < 3)
+		return false;
+
+	// Add outline
+	Outline outline;
+	outline.vertices.reserve(path.size());
+	for (auto e : path)
+	{
+		const auto& v1 = vertices_[edges_[e].v1];
+		const auto& v2 = vertices_[edges_[e].v2];
+		outline.vertices.push_back(edges_[e].v1);
+		outline.area += v1.x * v2.y - v2.x * v1.y;
+
+		// (Not using BBox::extend since it treats a 0,0 vertex as a reset bbox)
+		if (e == edge_start)
+			outline.bbox.min = outline.bbox.max = v1;
+		outline.bbox.min = { std::min(outline.bbox.min.x, v1.x), std::min(outline.bbox.min.y, v1.y) };
+		outline.bbox.max = { std::max(outline.bbox.max.x, v1.x), std::max(outline.bbox.max.y, v1.y) };
+	}
+	outline.area *= 0.5;
+	if (outline.area != 0)
+		outlines_.push_back(std::move(outline));
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [point] is within [outline]
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::outlineContains(const Outline& outline, Vec2d point) const
+{
+	if (!outline.bbox.contains(point))
+		return false;
+
+	bool       inside = false;
+	const auto n      = outline.vertices.size();
+	for (unsigned a = 0, b = n - 1; a < n; b = a++)
+	{
+		const auto& v1 = vertices_[outline.vertices[a]];
+		const auto& v2 = vertices_[outline.vertices[b]];
+		if ((v1.y > point.y) != (v2.y > point.y) && point.x < (v2.x - v1.x) * (point.y - v1.y) / (v2.y - v1.y) + v1.x)
+			inside = !inside;
+	}
+
+	return inside;
+}
+
+// -----------------------------------------------------------------------------
+// Triangulates the [outer] outline with [holes], adding the resulting
+// triangles to the triangles list
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::triangulate(const Outline& outer, const vector<const Outline*>& holes)
+{
+	auto outer_node = linkedList(outer.vertices, true);
+	if (!outer_node || outer_node->next == outer_node->prev)
+		return;
+
+	unsigned n_vertices = outer.vertices.size();
+	if (!holes.empty())
+	{
+		outer_node = eliminateHoles(holes, outer_node);
+		for (auto hole : holes)
+			n_vertices += hole->vertices.size();
+	}
+
+	// Use z-order curve hashing for ear tests if the polygon is large enough
+	double min_x = 0., min_y = 0., inv_size = 0.;
+	if (n_vertices > 80)
+	{
+		min_x    = outer.bbox.min.x;
+		min_y    = outer.bbox.min.y;
+		inv_size = std::max(outer.bbox.width(), outer.bbox.height());
+		inv_size = inv_size != 0 ? 32767. / inv_size : 0.;
+	}
+
+	earcutLinked(outer_node, min_x, min_y, inv_size, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Creates a circular linked list of nodes from outline [vertices], in
+// anticlockwise order if [clockwise] is true (for outer outlines), clockwise
+// otherwise (for holes). Returns the last node in the list
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::linkedList(const vector<int>& vertices, bool clockwise)
+{
+	// Get signed area (positive if anticlockwise)
+	double sum = 0;
+	for (unsigned a = 0, b = vertices.size() - 1; a < vertices.size(); b = a++)
+	{
+		const auto& v1 = vertices_[vertices[a]];
+		const auto& v2 = vertices_[vertices[b]];
+		sum += (v2.x - v1.x) * (v1.y + v2.y);
+	}
+
+	Node* last = nullptr;
+	if (clockwise == (sum > 0))
+		for (auto vertex : vertices)
+			last = insertNode(vertex, last);
+	else
+		for (auto i = vertices.rbegin(); i != vertices.rend(); ++i)
+			last = insertNode(*i, last);
+
+	if (last && equals(last, last->next))
+	{
+		removeNode(last);
+		last = last->next;
+	}
+
+	return last;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a node for vertex [index] and links it after [last]
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::insertNode(int index, Node* last)
+{
+	auto p = &nodes_.emplace_back(index, vertices_[index].x, vertices_[index].y);
+
+	if (!last)
+	{
+		p->prev = p;
+		p->next = p;
+	}
+	else
+	{
+		p->next          = last->next;
+		p->prev          = last;
+		last->next->prev = p;
+		last->next       = p;
+	}
+
+	return p;
+}
+
+// -----------------------------------------------------------------------------
+// Removes duplicate and collinear nodes between [start] and [end]
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::filterPoints(Node* start, Node* end)
+{
+	if (!start)
+		return start;
+	if (!end)
+		end = start;
+
+	auto p = start;
+	bool again;
+	do
+	{
+		again = false;
+
+		if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0))
+		{
+			removeNode(p);
+			p = end = p->prev;
+			if (p == p->next)
+				break;
+			again = true;
+		}
+		else
+			p = p->next;
+	} while (again || p != end);
+
+	return end;
+}
+
+// -----------------------------------------------------------------------------
+// Links all [holes] into the [outer] polygon with bridge edges, returning the
+// new outer node
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::eliminateHoles(const vector<const Outline*>& holes, Node* outer)
+{
+	vector<Node*> queue;
+	for (auto hole : holes)
+	{
+		auto list = linkedList(hole->vertices, false);
+		if (!list)
+			continue;
+		if (list == list->next)
+			list->steiner = true;
+		queue.push_back(leftmost(list));
+	}
+
+	// Process holes from left to right
+	std::sort(queue.begin(), queue.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+	for (auto hole : queue)
+		outer = eliminateHole(hole, outer);
+
+	return outer;
+}
+
+// -----------------------------------------------------------------------------
+// Links [hole] into the [outer] polygon via a bridge edge, returning the new
+// outer node
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::eliminateHole(Node* hole, Node* outer)
+{
+	auto bridge = findHoleBridge(hole, outer);
+	if (!bridge)
+		return outer;
+
+	auto bridge_reverse = splitPolygon(bridge, hole);
+
+	// Filter collinear points around the cuts
+	auto filtered_bridge = filterPoints(bridge, bridge->next);
+	filterPoints(bridge_reverse, bridge_reverse->next);
+
+	return outer == bridge ? filtered_bridge : outer;
+}
+
+// -----------------------------------------------------------------------------
+// Finds a node in the [outer] polygon that can be connected to the leftmost
+// node of [hole] without crossing any edges (David Eberly's algorithm)
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::findHoleBridge(Node* hole, Node* outer) const
+{
+	auto       p  = outer;
+	const auto hx = hole->x;
+	const auto hy = hole->y;
+	auto       qx = -std::numeric_limits<double>::infinity();
+	Node*      m  = nullptr;
+
+	// Find a segment intersected by a ray from the hole's leftmost point to the
+	// left, segment's endpoint with lesser x will be the potential connection
+	do
+	{
+		if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+		{
+			const auto x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+			if (x <= hx && x > qx)
+			{
+				qx = x;
+				m  = p->x < p->next->x ? p : p->next;
+				if (x == hx)
+					return m; // Hole touches outer segment, pick leftmost endpoint
+			}
+		}
+		p = p->next;
+	} while (p != outer);
+
+	if (!m)
+		return nullptr;
+
+	// Look for points inside the triangle of hole point, segment intersection
+	// and endpoint. If there are no points found, we have a valid connection,
+	// otherwise choose the point of the minimum angle with the ray as the
+	// connection point
+	const auto stop    = m;
+	const auto mx      = m->x;
+	const auto my      = m->y;
+	auto       tan_min = std::numeric_limits<double>::infinity();
+	p                  = m;
+	do
+	{
+		if (hx >= p->x && p->x >= mx && hx != p->x
+			&& pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+		{
+			const auto tan = std::abs(hy - p->y) / (hx - p->x);
+			if (locallyInside(p, hole)
+				&& (tan < tan_min || (tan == tan_min && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+			{
+				m       = p;
+				tan_min = tan;
+			}
+		}
+		p = p->next;
+	} while (p != stop);
+
+	return m;
+}
+
+// -----------------------------------------------------------------------------
+// Links [a] and [b] with a bridge, splitting the polygon into two (if they are
+// on the same polygon) or joining them into one (if they are on separate
+// polygons). Returns the duplicated [b] node on the other side of the bridge
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::splitPolygon(Node* a, Node* b)
+{
+	auto a2 = &nodes_.emplace_back(a->index, a->x, a->y);
+	auto b2 = &nodes_.emplace_back(b->index, b->x, b->y);
+	auto an = a->next;
+	auto bp = b->prev;
+
+	a->next = b;
+	b->prev = a;
+
+	a2->next = an;
+	an->prev = a2;
+
+	b2->next = a2;
+	a2->prev = b2;
+
+	bp->next = b2;
+	b2->prev = bp;
+
+	return b2;
+}
+
+// -----------------------------------------------------------------------------
+// Goes through a polygon, clipping off any small self-intersecting loops
+// -----------------------------------------------------------------------------
+Node* PolygonTriangulator::cureLocalIntersections(Node* start)
+{
+	auto p = start;
+	do
+	{
+		auto a = p->prev;
+		auto b = p->next->next;
+
+		if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+		{
+			triangles_.push_back(a->index);
+			triangles_.push_back(p->index);
+			triangles_.push_back(b->index);
+
+			removeNode(p);
+			removeNode(p->next);
+
+			p = start = b;
+		}
+		p = p->next;
+	} while (p != start);
+
+	return filterPoints(p);
+}
+
+// -----------------------------------------------------------------------------
+// Tries splitting the polygon at [start] into two via a valid diagonal, and
+// triangulates them separately
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::splitEarcut(Node* start, double min_x, double min_y, double inv_size)
+{
+	auto a = start;
+	do
+	{
+		auto b = a->next->next;
+		while (b != a->prev)
+		{
+			if (a->index != b->index && isValidDiagonal(a, b))
+			{
+				auto c = splitPolygon(a, b);
+
+				// Filter collinear points around the cuts
+				a = filterPoints(a, a->next);
+				c = filterPoints(c, c->next);
+
+				earcutLinked(a, min_x, min_y, inv_size, 0);
+				earcutLinked(c, min_x, min_y, inv_size, 0);
+				return;
+			}
+			b = b->next;
+		}
+		a = a->next;
+	} while (a != start);
+}
+
+// -----------------------------------------------------------------------------
+// Main ear clipping loop for the polygon at [ear]. If no more ears can be
+// found, tries to fix up the polygon (depending on [pass]) and continues
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::earcutLinked(Node* ear, double min_x, double min_y, double inv_size, int pass)
+{
+	if (!ear)
+		return;
+
+	// Interlink polygon nodes in z-order
+	if (pass == 0 && inv_size != 0)
+		indexCurve(ear, min_x, min_y, inv_size);
+
+	// Iterate through ears, slicing them one by one
+	auto stop = ear;
+	while (ear->prev != ear->next)
+	{
+		auto prev = ear->prev;
+		auto next = ear->next;
+
+		if (inv_size != 0 ? isEarHashed(ear, min_x, min_y, inv_size) : isEar(ear))
+		{
+			triangles_.push_back(prev->index);
+			triangles_.push_back(ear->index);
+			triangles_.push_back(next->index);
+
+			removeNode(ear);
+
+			// Skipping the next vertex leads to less sliver triangles
+			ear  = next->next;
+			stop = next->next;
+			continue;
+		}
+
+		ear = next;
+
+		// If we looped through the whole remaining polygon and can't find any
+		// more ears
+		if (ear == stop)
+		{
+			if (pass == 0)
+			{
+				// Try filtering points and slicing again
+				earcutLinked(filterPoints(ear), min_x, min_y, inv_size, 1);
+			}
+			else if (pass == 1)
+			{
+				// If this didn't work, try curing all small self-intersections
+				// locally
+				ear = cureLocalIntersections(filterPoints(ear));
+				earcutLinked(ear, min_x, min_y, inv_size, 2);
+			}
+			else if (pass == 2)
+			{
+				// As a last resort, try splitting the remaining polygon into two
+				splitEarcut(ear, min_x, min_y, inv_size);
+			}
+
+			break;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [ear] is a valid ear (a convex corner with no other points
+// of the polygon within its triangle)
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::isEar(Node* ear) const
+{
+	const auto a = ear->prev;
+	const auto b = ear;
+	const auto c = ear->next;
+
+	// Reflex, can't be an ear
+	if (area(a, b, c) >= 0)
+		return false;
+
+	// Make sure no other points are inside the potential ear
+	auto p = ear->next->next;
+	while (p != ear->prev)
+	{
+		if (pointInTriangle(a, b, c, p) && area(p->prev, p, p->next) >= 0)
+			return false;
+		p = p->next;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Same as isEar, but only checks points near the ear via the z-order index
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::isEarHashed(Node* ear, double min_x, double min_y, double inv_size) const
+{
+	const auto a = ear->prev;
+	const auto b = ear;
+	const auto c = ear->next;
+
+	// Reflex, can't be an ear
+	if (area(a, b, c) >= 0)
+		return false;
+
+	// Get z-order range for the triangle bbox
+	const auto min_z = zOrder(
+		std::min({ a->x, b->x, c->x }), std::min({ a->y, b->y, c->y }), min_x, min_y, inv_size);
+	const auto max_z = zOrder(
+		std::max({ a->x, b->x, c->x }), std::max({ a->y, b->y, c->y }), min_x, min_y, inv_size);
+
+	auto inside = [a, b, c, ear](const Node* p) {
+		return p != ear->prev && p != ear->next && pointInTriangle(a, b, c, p) && area(p->prev, p, p->next) >= 0;
+	};
+
+	// Look for points inside the triangle in both directions
+	auto p = ear->prev_z;
+	auto n = ear->next_z;
+	while (p && p->z >= min_z && n && n->z <= max_z)
+	{
+		if (inside(p))
+			return false;
+		p = p->prev_z;
+
+		if (inside(n))
+			return false;
+		n = n->next_z;
+	}
+
+	// Look for remaining points in decreasing z-order
+	while (p && p->z >= min_z)
+	{
+		if (inside(p))
+			return false;
+		p = p->prev_z;
+	}
+
+	// Look for remaining points in increasing z-order
+	while (n && n->z <= max_z)
+	{
+		if (inside(n))
+			return false;
+		n = n->next_z;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Interlinks the polygon at [start] in z-order
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::indexCurve(Node* start, double min_x, double min_y, double inv_size) const
+{
+	auto p = start;
+	do
+	{
+		if (p->z == 0)
+			p->z = zOrder(p->x, p->y, min_x, min_y, inv_size);
+		p->prev_z = p->prev;
+		p->next_z = p->next;
+		p         = p->next;
+	} while (p != start);
+
+	p->prev_z->next_z = nullptr;
+	p->prev_z         = nullptr;
+
+	sortLinked(p);
+}
+
+// -----------------------------------------------------------------------------
+// Merges the triangles into convex polygons and adds them to [poly].
+// Triangles are merged greedily across shared edges as long as the result
+// stays convex (Hertel-Mehlhorn), which gives at most 4x the optimal number of
+// convex polygons
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::buildConvexPolygons(Polygon2D* poly) const
+{
+	// A corner of a polygon, (the start of) its edge goes to the next corner
+	struct Corner
+	{
+		int  vertex;
+		int  prev, next;
+		int  twin  = -1; // Corner on the other side of this corner's edge
+		int  group = 0;
+		bool alive = true;
+	};
+
+	// Init corners from triangles
+	const auto     n_triangles = triangles_.size() / 3;
+	vector<Corner> corners(triangles_.size());
+	for (unsigned t = 0; t < n_triangles; t++)
+	{
+		for (unsigned c = 0; c < 3; c++)
+		{
+			auto& corner  = corners[t * 3 + c];
+			corner.vertex = triangles_[t * 3 + c];
+			corner.prev   = t * 3 + (c + 2) % 3;
+			corner.next   = t * 3 + (c + 1) % 3;
+			corner.group  = t;
+		}
+	}
+
+	// Find edges shared between triangles (edges that appear more than once in
+	// the same direction are ambiguous, so can't be merged across)
+	auto edge_key = [&corners](const Corner& c, bool reverse) {
+		const auto v1 = static_cast<uint32_t>(c.vertex);
+		const auto v2 = static_cast<uint32_t>(corners[c.next].vertex);
+		return reverse ? static_cast<uint64_t>(v2) << 32 | v1 : static_cast<uint64_t>(v1) << 32 | v2;
+	};
+	std::unordered_map<uint64_t, int> edge_corners;
+	edge_corners.reserve(corners.size());
+	for (unsigned a = 0; a < corners.size(); a++)
+	{
+		auto i = edge_corners.emplace(edge_key(corners[a], false), a);
+		if (!i.second)
+			i.first->second = -1;
+	}
+	for (auto& corner : corners)
+	{
+		auto i = edge_corners.find(edge_key(corner, true));
+		if (i != edge_corners.end() && edge_corners[edge_key(corner, false)] >= 0)
+			corner.twin = i->second;
+	}
+
+	// Merge polygons across shared edges where the result would be convex
+	vector<int> groups(n_triangles);
+	for (unsigned a = 0; a < n_triangles; a++)
+		groups[a] = a;
+	auto find_group = [&groups](int group) {
+		while (groups[group] != group)
+			group = groups[group] = groups[groups[group]];
+		return group;
+	};
+	auto convex = [this, &corners](int c1, int c2, int c3) {
+		const auto& p1 = vertices_[corners[c1].vertex];
+		const auto& p2 = vertices_[corners[c2].vertex];
+		const auto& p3 = vertices_[corners[c3].vertex];
+		return (p2.x - p1.x) * (p3.y - p2.y) - (p2.y - p1.y) * (p3.x - p2.x) >= 0;
+	};
+	for (unsigned a = 0; a < corners.size(); a++)
+	{
+		auto& ca = corners[a];
+		if (!ca.alive || ca.twin < 0)
+			continue;
+
+		const auto t = ca.twin;
+		if (!corners[t].alive || find_group(ca.group) == find_group(corners[t].group))
+			continue;
+
+		// Check the merged polygon would be convex at both ends of the edge
+		const auto b  = ca.next;
+		const auto tn = corners[t].next;
+		if (!convex(ca.prev, a, corners[tn].next) || !convex(corners[t].prev, b, corners[b].next))
+			continue;
+
+		// Merge, removing the twin edge's corners
+		ca.next                       = corners[tn].next;
+		corners[ca.next].prev         = a;
+		corners[corners[t].prev].next = b;
+		corners[b].prev               = corners[t].prev;
+		ca.twin                       = corners[tn].twin;
+		if (ca.twin >= 0)
+			corners[ca.twin].twin = a;
+		corners[t].alive                     = false;
+		corners[tn].alive                    = false;
+		groups[find_group(corners[t].group)] = find_group(ca.group);
+
+		// Check this corner's new edge next
+		a--;
+	}
+
+	// Build polygons (in clockwise order)
+	vector<bool> done(corners.size(), false);
+	vector<int>  verts;
+	for (unsigned a = 0; a < corners.size(); a++)
+	{
+		if (!corners[a].alive || done[a])
+			continue;
+
+		verts.clear();
+		auto c = static_cast<int>(a);
+		do
+		{
+			done[c] = true;
+			verts.push_back(corners[c].vertex);
+			c = corners[c].next;
+		} while (c != static_cast<int>(a) && !done[c]);
+
+		if (verts.size() < 3)
+			continue;
+
+		poly->addSubPoly();
+		auto subpoly = poly->subPoly(poly->nSubPolys() - 1);
+		subpoly->vertices.resize(verts.size());
+		for (unsigned v = 0; v < verts.size(); v++)
+		{
+			subpoly->vertices[v].x = vertices_[verts[verts.size() - 1 - v]].x;
+			subpoly->vertices[v].y = vertices_[verts[verts.size() - 1 - v]].y;
+		}
+	}
+}
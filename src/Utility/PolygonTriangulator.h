@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Polygon2D.h"
+#include <deque>
+#include <unordered_set>
+
+namespace slade
+{
+// Splits a polygon (which may have holes and multiple separate parts) given as
+// a set of directed edges, with the inside of the polygon on the right of each
+// edge, into convex sub-polygons.
+//
+// The polygon outlines are triangulated by ear clipping (holes are joined to
+// their outline with bridge edges first), using a z-order curve index of the
+// outline vertices for ear tests on large polygons. The triangles are then
+// merged back into convex polygons (Hertel-Mehlhorn). Unlike PolygonSplitter,
+// the time taken grows roughly as O(n log n), so this is much faster for very
+// large and detailed polygons
+class PolygonTriangulator
+{
+public:
+	PolygonTriangulator()  = default;
+	~PolygonTriangulator() = default;
+
+	// A vertex in an outline being triangulated
+	struct Node
+	{
+		int      index;
+		double   x, y;
+		Node*    prev    = nullptr;
+		Node*    next    = nullptr;
+		uint32_t z       = 0;
+		Node*    prev_z  = nullptr;
+		Node*    next_z  = nullptr;
+		bool     steiner = false;
+
+		Node(int index, double x, double y) : index{ index }, x{ x }, y{ y } {}
+	};
+
+	unsigned nEdges() const { return edges_.size(); }
+
+	void clear();
+	void addEdge(double x1, double y1, double x2, double y2);
+	bool doSplitting(Polygon2D* poly);
+
+private:
+	struct Edge
+	{
+		int  v1, v2;
+		bool used = false;
+	};
+	struct PointHash
+	{
+		size_t operator()(const std::pair<double, double>& point) const;
+	};
+
+	// A traced (closed) outline of the polygon
+	struct Outline
+	{
+		vector<int> vertices;
+		double      area = 0.; // Signed, positive if anticlockwise
+		BBox        bbox;
+	};
+
+	vector<Vec2d>                                                 vertices_;
+	std::unordered_map<std::pair<double, double>, int, PointHash> vertex_map_;
+	vector<vector<int>>                                           vertex_edges_out_;
+	vector<Edge>                                                  edges_;
+	std::unordered_set<uint64_t>                                  edge_keys_; // To ignore duplicate edges
+	vector<Outline>                                               outlines_;
+	std::deque<Node>                                              nodes_;
+	vector<int>                                                   triangles_;
+
+	// Outline tracing
+	int  addVertex(double x, double y);
+	int  nextEdge(int edge, int edge_start) const;
+	bool traceOutline(int edge_start);
+	bool outlineContains(const Outline& outline, Vec2d point) const;
+
+	// Triangulation
+	void  triangulate(const Outline& outer, const vector<const Outline*>& holes);
+	Node* linkedList(const vector<int>& vertices, bool clockwise);
+	Node* insertNode(int index, Node* last);
+	Node* filterPoints(Node* start, Node* end = nullptr);
+	Node* eliminateHoles(const vector<const Outline*>& holes, Node* outer);
+	Node* eliminateHole(Node* hole, Node* outer);
+	Node* findHoleBridge(Node* hole, Node* outer) const;
+	Node* splitPolygon(Node* a, Node* b);
+	Node* cureLocalIntersections(Node* start);
+	void  splitEarcut(Node* start, double min_x, double min_y, double inv_size);
+	void  earcutLinked(Node* ear, double min_x, double min_y, double inv_size, int pass);
+	bool  isEar(Node* ear) const;
+	bool  isEarHashed(Node* ear, double min_x, double min_y, double inv_size) const;
+	void  indexCurve(Node* start, double min_x, double min_y, double inv_size) const;
+
+	// Convex polygon building
+	void buildConvexPolygons(Polygon2D* poly) const;
+};
+} // namespace slade
@@ -33,9 +33,49 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Property.h"
+#include <deque>
+#include <shared_mutex>
 
 using namespace slade;
 
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Case-insensitive hash/comparison for property names
+struct KeyHash
+{
+	size_t operator()(string_view name) const
+	{
+		size_t hash = 0xCBF29CE484222325ull;
+		for (auto c : name)
+			hash = (hash ^ static_cast<size_t>(tolower(static_cast<unsigned char>(c)))) * 0x100000001B3ull;
+		return hash;
+	}
+};
+struct KeyEqual
+{
+	bool operator()(string_view left, string_view right) const { return strutil::equalCI(left, right); }
+};
+
+// The table of all interned property names
+struct KeyTable
+{
+	std::deque<string>                                           names; // Indexed by id (a deque so names never move)
+	std::unordered_map<string_view, unsigned, KeyHash, KeyEqual> ids;
+	std::shared_mutex                                            mutex;
+};
+KeyTable& keyTable()
+{
+	static KeyTable table;
+	return table;
+}
+} // namespace
+
 namespace slade::property
 {
 bool asBool(const Property& prop)
@@ -111,6 +151,62 @@ string asString(const Property& prop, int float_precision)
 } // namespace slade::property
 
 
+// -----------------------------------------------------------------------------
+//
+// PropertyKey Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the key's name, as it was first spelt when interned
+// -----------------------------------------------------------------------------
+const string& PropertyKey::name() const
+{
+	auto&            table = keyTable();
+	std::shared_lock lock(table.mutex);
+	return table.names[id_];
+}
+
+// -----------------------------------------------------------------------------
+// Returns the id of the interned property [name] (case-insensitive), adding it
+// to the table if it hasn't been interned yet
+// -----------------------------------------------------------------------------
+unsigned PropertyKey::intern(string_view name)
+{
+	auto& table = keyTable();
+
+	// Check for existing key
+	{
+		std::shared_lock lock(table.mutex);
+		if (auto i = table.ids.find(name); i != table.ids.end())
+			return i->second;
+	}
+
+	// Add new key (checking again in case it was added by another thread in
+	// the meantime)
+	std::unique_lock lock(table.mutex);
+	if (auto i = table.ids.find(name); i != table.ids.end())
+		return i->second;
+
+	const auto id = static_cast<unsigned>(table.names.size());
+	table.names.emplace_back(name);
+	table.ids[table.names.back()] = id;
+	return id;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// PropertyList Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a string representation of all properties in the list, as
+// 'key = value;' lines ('key=value;' if [condensed] is true)
+// -----------------------------------------------------------------------------
 string PropertyList::toString(bool condensed, int float_precision) const
 {
 	// Init return string
@@ -129,9 +225,9 @@ string PropertyList::toString(bool condensed, int float_precision) const
 		}
 
 		if (condensed)
-			ret += fmt::format("{}={};\n", prop.name, val);
+			ret += fmt::format("{}={};\n", prop.name(), val);
 		else
-			ret += fmt::format("{} = {};\n", prop.name, val);
+			ret += fmt::format("{} = {};\n", prop.name(), val);
 	}
 
 	return ret;
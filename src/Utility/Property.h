@@ -1,5 +1,6 @@
 #pragma once
 
+#include "General/AllocTracker.h"
 #include "StringUtils.h"
 #include <variant>
 #undef Bool
@@ -53,15 +54,46 @@ namespace property
 
 } // namespace property
 
+// An interned property name (key). Each distinct (case-insensitive) name is
+// stored once in a global table, so keys can be compared by id only
+class PropertyKey
+{
+public:
+	PropertyKey(string_view name) : id_{ intern(name) } {}
+	PropertyKey(const char* name) : id_{ intern(name) } {}
+	PropertyKey(const string& name) : id_{ intern(name) } {}
+
+	unsigned      id() const { return id_; }
+	const string& name() const;
+
+	bool operator==(const PropertyKey& rhs) const { return id_ == rhs.id_; }
+	bool operator!=(const PropertyKey& rhs) const { return id_ != rhs.id_; }
+
+	static unsigned intern(string_view name);
+
+private:
+	unsigned id_;
+};
+
 class PropertyList
 {
 public:
-	const vector<Named<Property>>& properties() const { return properties_; }
-	
-	Property& operator[](string_view key)
+	struct Entry : alloctracker::Counted<Entry, alloctracker::Type::Property>
+	{
+		PropertyKey key;
+		Property    value;
+
+		Entry(PropertyKey key, Property value) : key{ key }, value{ std::move(value) } {}
+
+		const string& name() const { return key.name(); }
+	};
+
+	const vector<Entry>& properties() const { return properties_; }
+
+	Property& operator[](PropertyKey key)
 	{
 		for (auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
+			if (prop.key == key)
 				return prop.value;
 
 		properties_.emplace_back(key, Property{});
@@ -70,47 +102,36 @@ public:
 
 	bool empty() const { return properties_.empty(); }
 
-	bool contains(string_view key) const
-	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return true;
+	bool contains(PropertyKey key) const { return find(key) != nullptr; }
 
-		return false;
-	}
-
-	template<typename T> T get(string_view key) const
+	template<typename T> T get(PropertyKey key) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return std::get<T>(prop.value);
+		if (auto prop = find(key))
+			return std::get<T>(*prop);
 
 		return T{};
 	}
-	
-	std::optional<Property> getIf(string_view key) const
+
+	std::optional<Property> getIf(PropertyKey key) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return prop.value;
+		if (auto prop = find(key))
+			return *prop;
 
 		return {};
 	}
 
-	template<typename T> std::optional<T> getIf(string_view key) const
+	template<typename T> std::optional<T> getIf(PropertyKey key) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return property::value<T>(prop.value);
+		if (auto prop = find(key))
+			return property::value<T>(*prop);
 
 		return {};
 	}
 
-	template<typename T> T getOr(string_view key, T default_val) const
+	template<typename T> T getOr(PropertyKey key, T default_val) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return property::value<T>(prop.value, default_val);
+		if (auto prop = find(key))
+			return property::value<T>(*prop, default_val);
 
 		return default_val;
 	}
@@ -124,16 +145,27 @@ public:
 	void allPropertyNames(vector<string>& list)
 	{
 		for (const auto& prop : properties_)
-			list.push_back(prop.name);
+			list.push_back(prop.name());
 	}
 
 	void clear() { properties_.clear(); }
 
-	bool remove(string_view key)
+	// Returns the (approximate) heap memory used by the list, in bytes
+	size_t memoryUsage() const
+	{
+		auto size = properties_.capacity() * sizeof(Entry);
+		for (const auto& prop : properties_)
+			if (auto str = std::get_if<string>(&prop.value))
+				size += str->capacity();
+
+		return size;
+	}
+
+	bool remove(PropertyKey key)
 	{
 		const auto count = properties_.size();
 		for (unsigned i = 0; i < count; ++i)
-			if (strutil::equalCI(key, properties_[i].name))
+			if (properties_[i].key == key)
 			{
 				properties_.erase(properties_.begin() + i);
 				return true;
@@ -145,7 +177,16 @@ public:
 	string toString(bool condensed = false, int float_precision = 0) const;
 
 private:
-	vector<Named<Property>> properties_;
+	vector<Entry> properties_;
+
+	const Property* find(PropertyKey key) const
+	{
+		for (const auto& prop : properties_)
+			if (prop.key == key)
+				return &prop.value;
+
+		return nullptr;
+	}
 };
 } // namespace slade
 
@@ -111,6 +111,24 @@ bool strutil::equalCI(string_view left, string_view right)
 	return true;
 }
 
+// Compares [left] and [right] as if both were converted to uppercase, without
+// making uppercase copies. Returns <0, 0 or >0 like string::compare
+int strutil::compareCI(string_view left, string_view right)
+{
+	const auto sz = std::min(left.size(), right.size());
+	for (auto a = 0u; a < sz; ++a)
+	{
+		const auto l = static_cast<unsigned char>(toupper(left[a]));
+		const auto r = static_cast<unsigned char>(toupper(right[a]));
+		if (l != r)
+			return l < r ? -1 : 1;
+	}
+
+	if (left.size() == right.size())
+		return 0;
+	return left.size() < right.size() ? -1 : 1;
+}
+
 // This one is a bit tricky - the string_view == string_view one above should be sufficient
 // bool strutil::equalCI(string_view left, const char* right)
 //{
@@ -38,6 +38,7 @@ namespace strutil
 	bool isHex(string_view str);
 	bool isFloat(string_view str);
 	bool equalCI(string_view left, string_view right);
+	int  compareCI(string_view left, string_view right);
 	// bool equalCI(string_view left, const char* right);
 	bool startsWith(string_view str, string_view check);
 	bool startsWith(string_view str, char check);
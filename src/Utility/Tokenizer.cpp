@@ -191,8 +191,7 @@ const Tokenizer::Token& Tokenizer::next()
 	if (!token_next_.valid)
 		return invalid_token_;
 
-	token_current_ = token_next_;
-	readNext();
+	advanceToken();
 	return token_current_;
 }
 
@@ -207,8 +206,7 @@ void Tokenizer::adv(size_t inc)
 	for (size_t a = 0; a < inc - 1; a++)
 		readNext();
 
-	token_current_ = token_next_;
-	readNext();
+	advanceToken();
 }
 
 // -----------------------------------------------------------------------------
@@ -341,8 +339,7 @@ void Tokenizer::advToNextLine()
 	// If the next token is on the next line just move to it
 	if (token_next_.line_no > token_current_.line_no)
 	{
-		token_current_ = token_next_;
-		readNext();
+		advanceToken();
 		return;
 	}
 
@@ -879,14 +876,23 @@ bool Tokenizer::readNext(Token* target)
 	// Write to target token (if specified)
 	if (target)
 	{
-		target->text.clear();
-		for (unsigned a = state_.current_token.pos_start; a < state_.position; ++a)
+		// Assign to the existing text so its buffer is reused, only quoted
+		// strings with escaped characters need to be copied char-by-char
+		const auto start = state_.current_token.pos_start;
+		target->raw      = { data_.data() + start, state_.position - start };
+		if (state_.current_token.quoted_string && target->raw.find('\\') != string_view::npos)
 		{
-			if (state_.current_token.quoted_string && data_[a] == '\\')
-				++a;
-
-			target->text += data_[a];
+			target->text.clear();
+			for (unsigned a = start; a < state_.position; ++a)
+			{
+				if (data_[a] == '\\')
+					++a;
+
+				target->text += data_[a];
+			}
 		}
+		else
+			target->text.assign(target->raw);
 
 		target->line_no       = state_.current_token.line_no;
 		target->quoted_string = state_.current_token.quoted_string;
@@ -910,6 +916,22 @@ bool Tokenizer::readNext(Token* target)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Moves the 'next' token to the current token and reads the following token.
+// The tokens are swapped rather than copied so their text buffers are reused
+// -----------------------------------------------------------------------------
+void Tokenizer::advanceToken()
+{
+	std::swap(token_current_, token_next_);
+	if (!readNext())
+	{
+		// At the end, the 'next' token is left as it was (ie. the same as
+		// the current token) but invalid
+		token_next_       = token_current_;
+		token_next_.valid = false;
+	}
+}
+
 void Tokenizer::resetToLineStart()
 {
 	// Reset state to start of current token
@@ -16,15 +16,22 @@ public:
 		Default = CStyle | CPPStyle | DoubleHash,
 	};
 
+	// A token read from the source data. [raw] points directly into the
+	// tokenizer's copy of the source data (so is only valid until another
+	// source is opened), and is the token's characters before any unescaping
+	// or lowercasing. [text] is the final token text, read into a buffer that
+	// is reused as the tokenizer advances, so reading tokens doesn't allocate
+	// (unless a token is longer than any read before it)
 	struct Token
 	{
-		string   text;
-		unsigned line_no;
-		bool     quoted_string;
-		unsigned pos_start;
-		unsigned pos_end;
-		unsigned length;
-		bool     valid;
+		string      text;
+		unsigned    line_no;
+		bool        quoted_string;
+		unsigned    pos_start;
+		unsigned    pos_end;
+		unsigned    length;
+		bool        valid;
+		string_view raw;
 
 		explicit operator string() const { return text; }
 		explicit operator const string() const { return text; }
@@ -227,6 +234,7 @@ private:
 	void     tokenizeWhitespace();
 	bool     readNext(Token* target);
 	bool     readNext() { return readNext(&token_next_); }
+	void     advanceToken();
 	void     resetToLineStart();
 };
 } // namespace slade